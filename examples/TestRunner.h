@@ -8,7 +8,7 @@
   version:          0.0.1
   vendor:           Tracktion
   website:          www.tracktion.com
-  description:      This simply runs the unit tests within Tracktion Engine.
+  description:      This runs the unit tests within Tracktion Engine, or benchmarks it with --benchmark.
 
   dependencies:     juce_audio_basics, juce_audio_devices, juce_audio_formats, juce_audio_processors, juce_audio_utils,
                     juce_core, juce_data_structures, juce_dsp, juce_events, juce_graphics,
@@ -204,17 +204,387 @@ namespace TestRunner
 }
 
 
+//==============================================================================
+//==============================================================================
+/**
+    Measures how long representative Edits take to load, build their playback graphs,
+    play back through the HostedAudioDeviceInterface and render offline.
+
+    The Edits are either loaded from the files given or built procedurally, and each
+    one's results are logged and written as JSON so runs can be compared. If a previous
+    results file is given as the baseline, the change in each result is logged too.
+*/
+namespace Benchmarks
+{
+    static constexpr double sampleRate = 44100.0;
+    static constexpr int blockSize = 512;
+    static constexpr double editLengthSeconds = 30.0;
+
+    /** Returns the number of milliseconds a function takes to run. */
+    template<typename Function>
+    double timeInMilliseconds (Function&& f)
+    {
+        const auto start = Time::getMillisecondCounterHiRes();
+        f();
+        return Time::getMillisecondCounterHiRes() - start;
+    }
+
+    //==============================================================================
+    /** Writes a few seconds of sine wave for the audio clips to use. */
+    File createSourceFile (const File& dir)
+    {
+        auto file = dir.getChildFile ("benchmark_source.wav");
+        AudioBuffer<float> buffer (2, roundToInt (sampleRate * 4.0));
+
+        for (int i = 0; i < buffer.getNumSamples(); ++i)
+        {
+            auto sample = 0.25f * (float) std::sin (MathConstants<double>::twoPi * 220.0 * i / sampleRate);
+            buffer.setSample (0, i, sample);
+            buffer.setSample (1, i, sample);
+        }
+
+        file.deleteFile();
+
+        if (auto writer = std::unique_ptr<AudioFormatWriter> (WavAudioFormat().createWriterFor (file.createOutputStream().release(),
+                                                                                                sampleRate, 2, 24, {}, 0)))
+            writer->writeFromAudioSampleBuffer (buffer, 0, buffer.getNumSamples());
+
+        return file;
+    }
+
+    void insertPlugin (AudioTrack& track, const char* type)
+    {
+        if (auto plugin = track.edit.getPluginCache().createNewPlugin (type, {}))
+            track.pluginList.insertPlugin (plugin, std::max (0, track.pluginList.size() - 2), nullptr);
+    }
+
+    void insertLoopingClips (AudioTrack& track, const File& sourceFile)
+    {
+        for (double start = 0.0; start < editLengthSeconds; start += 4.0)
+            track.insertWaveClip (sourceFile.getFileNameWithoutExtension(), sourceFile,
+                                  { { start, std::min (start + 4.0, editLengthSeconds) }, 0.0 }, false);
+    }
+
+    /** 200 audio tracks, each with an EQ, compressor and delay. */
+    std::unique_ptr<Edit> createAudioTracksEdit (Engine& engine, const File& sourceFile)
+    {
+        auto edit = std::make_unique<Edit> (engine, createEmptyEdit (engine), Edit::forEditing, nullptr, 0);
+        edit->ensureNumberOfAudioTracks (200);
+
+        for (auto track : getAudioTracks (*edit))
+        {
+            insertLoopingClips (*track, sourceFile);
+            insertPlugin (*track, EqualiserPlugin::xmlTypeName);
+            insertPlugin (*track, CompressorPlugin::xmlTypeName);
+            insertPlugin (*track, DelayPlugin::xmlTypeName);
+        }
+
+        return edit;
+    }
+
+    /** 32 tracks of dense MIDI, each playing a FourOsc. */
+    std::unique_ptr<Edit> createMidiEdit (Engine& engine)
+    {
+        auto edit = std::make_unique<Edit> (engine, createEmptyEdit (engine), Edit::forEditing, nullptr, 0);
+        edit->ensureNumberOfAudioTracks (32);
+        Random r (1);
+
+        for (auto track : getAudioTracks (*edit))
+        {
+            auto clip = track->insertMIDIClip ({ 0.0, editLengthSeconds }, nullptr);
+            auto numBeats = edit->tempoSequence.timeToBeats (editLengthSeconds);
+            auto& sequence = clip->getSequence();
+
+            // Chords of three notes on every sixteenth
+            for (double beat = 0.0; beat < numBeats; beat += 0.25)
+                for (int i = 0; i < 3; ++i)
+                    sequence.addNote (r.nextInt ({ 36, 96 }), beat, 0.5, r.nextInt ({ 40, 127 }), 0, nullptr);
+
+            insertPlugin (*track, FourOscPlugin::xmlTypeName);
+        }
+
+        return edit;
+    }
+
+    /** 64 audio tracks whose plugins have a point of automation every 10ms. */
+    std::unique_ptr<Edit> createAutomationEdit (Engine& engine, const File& sourceFile)
+    {
+        auto edit = std::make_unique<Edit> (engine, createEmptyEdit (engine), Edit::forEditing, nullptr, 0);
+        edit->ensureNumberOfAudioTracks (64);
+
+        for (auto track : getAudioTracks (*edit))
+        {
+            insertLoopingClips (*track, sourceFile);
+            insertPlugin (*track, EqualiserPlugin::xmlTypeName);
+            insertPlugin (*track, CompressorPlugin::xmlTypeName);
+
+            for (auto plugin : track->pluginList)
+            {
+                for (int i = 0; i < std::min (4, plugin->getNumAutomatableParameters()); ++i)
+                {
+                    auto param = plugin->getAutomatableParameter (i);
+                    auto& curve = param->getCurve();
+                    auto range = param->getValueRange();
+
+                    for (double time = 0.0; time < editLengthSeconds; time += 0.01)
+                        curve.addPoint (time, range.getStart() + range.getLength() * (float) (0.5 + 0.5 * std::sin (time + i)), 0.0f);
+                }
+            }
+        }
+
+        return edit;
+    }
+
+    //==============================================================================
+    /** Calls processBlock on a separate thread, as an audio callback would be, timing each block. */
+    struct BlockProcessor  : public Thread
+    {
+        BlockProcessor (HostedAudioDeviceInterface& i, int numBlocksToProcess)
+            : Thread ("Benchmark"), audioInterface (i), numBlocks (numBlocksToProcess)
+        {
+            blockTimes.reserve ((size_t) numBlocks);
+            startThread (9);
+        }
+
+        ~BlockProcessor() override
+        {
+            stopThread (10000);
+        }
+
+        void run() override
+        {
+            AudioBuffer<float> buffer (2, blockSize);
+            MidiBuffer midi;
+
+            for (int i = 0; i < numBlocks && ! threadShouldExit(); ++i)
+            {
+                buffer.clear();
+                midi.clear();
+
+                const auto start = Time::getHighResolutionTicks();
+                audioInterface.processBlock (buffer, midi);
+                blockTimes.push_back (Time::highResolutionTicksToSeconds (Time::getHighResolutionTicks() - start) * 1000.0);
+            }
+        }
+
+        HostedAudioDeviceInterface& audioInterface;
+        const int numBlocks;
+        std::vector<double> blockTimes;
+    };
+
+    /** Runs the message loop until the processor's finished, so anything it posts gets handled. */
+    std::vector<double> processBlocks (HostedAudioDeviceInterface& audioInterface, int numBlocks)
+    {
+        BlockProcessor processor (audioInterface, numBlocks);
+
+        while (processor.isThreadRunning())
+            if (! MessageManager::getInstance()->runDispatchLoopUntil (10))
+                break;
+
+        processor.waitForThreadToExit (-1);
+        return processor.blockTimes;
+    }
+
+    double getPercentile (const std::vector<double>& sortedTimes, double proportion)
+    {
+        if (sortedTimes.empty())
+            return 0.0;
+
+        auto index = (size_t) std::ceil (proportion * (double) sortedTimes.size());
+        return sortedTimes[std::min (index > 0 ? index - 1 : 0, sortedTimes.size() - 1)];
+    }
+
+    //==============================================================================
+    /** Returns a copy of a built Edit's state, deleting the Edit so it's not using anything whilst the copy is timed. */
+    ValueTree takeState (std::unique_ptr<Edit> edit)
+    {
+        edit->flushState();
+        return edit->state.createCopy();
+    }
+
+    /** Loads an Edit from its state, then times building its graph, playing it and rendering it. */
+    var runBenchmark (Engine& engine, const String& name, const ValueTree& editState, const File& tempDir)
+    {
+        Logger::writeToLog ("Benchmarking: " + name);
+        auto result = new DynamicObject();
+        result->setProperty ("name", name);
+
+        std::unique_ptr<Edit> edit;
+        result->setProperty ("loadMs", timeInMilliseconds ([&] { edit = std::make_unique<Edit> (engine, editState.createCopy(),
+                                                                                              Edit::forEditing, nullptr, 0); }));
+
+        auto& transport = edit->getTransport();
+        result->setProperty ("graphBuildMs", timeInMilliseconds ([&] { transport.ensureContextAllocated (true); }));
+
+        // The first blocks load the files and plugins, so aren't counted
+        transport.setCurrentPosition (0.0);
+        transport.play (false);
+        processBlocks (engine.getDeviceManager().getHostedAudioDeviceInterface(), 100);
+
+        auto numBlocks = roundToInt (10.0 * sampleRate / blockSize);
+        auto blockTimes = processBlocks (engine.getDeviceManager().getHostedAudioDeviceInterface(), numBlocks);
+        transport.stop (false, false);
+
+        std::sort (blockTimes.begin(), blockTimes.end());
+        const auto blockMs = blockSize * 1000.0 / sampleRate;
+
+        result->setProperty ("blockMedianMs", getPercentile (blockTimes, 0.5));
+        result->setProperty ("blockP99Ms", getPercentile (blockTimes, 0.99));
+        result->setProperty ("blockMaxMs", blockTimes.empty() ? 0.0 : blockTimes.back());
+        result->setProperty ("playbackLoad", getPercentile (blockTimes, 0.5) / blockMs);
+
+        BigInteger tracksToDo;
+        tracksToDo.setRange (0, getAllTracks (*edit).size(), true);
+
+        auto renderFile = tempDir.getChildFile ("benchmark_render.wav");
+        auto length = std::min (edit->getLength(), editLengthSeconds);
+        auto renderMs = timeInMilliseconds ([&] { Renderer::renderToFile ("Benchmark", renderFile, *edit, { 0.0, length },
+                                                                         tracksToDo, true, {}, false); });
+        renderFile.deleteFile();
+
+        result->setProperty ("renderMs", renderMs);
+        result->setProperty ("renderSpeed", renderMs > 0.0 ? length * 1000.0 / renderMs : 0.0);
+
+        Logger::writeToLog (JSON::toString (var (result), true));
+        return var (result);
+    }
+
+    /** Logs how much each result has changed since the baseline. */
+    void compareWithBaseline (const Array<var>& results, const File& baselineFile)
+    {
+        auto baseline = JSON::parse (baselineFile);
+
+        if (! baseline.isArray())
+        {
+            Logger::writeToLog ("Unable to read the baseline results from: " + baselineFile.getFullPathName());
+            return;
+        }
+
+        for (auto& result : results)
+        {
+            for (auto& old : *baseline.getArray())
+            {
+                if (old["name"] != result["name"])
+                    continue;
+
+                String changes;
+
+                for (auto& property : result.getDynamicObject()->getProperties())
+                {
+                    auto oldValue = (double) old[property.name];
+
+                    if (property.value.isDouble() && oldValue != 0.0)
+                        changes << " " << property.name.toString() << ": "
+                                << String (((double) property.value / oldValue - 1.0) * 100.0, 1) << "%";
+                }
+
+                Logger::writeToLog ("Change from baseline for " + result["name"].toString() + ":" + changes);
+            }
+        }
+    }
+
+    int runBenchmarks (const StringArray& editFiles, const File& resultsFile, const File& baselineFile)
+    {
+        CoutLogger logger;
+        Logger::setCurrentLogger (&logger);
+
+        int returnValue = 0;
+
+        {
+            tracktion_engine::Engine engine { ProjectInfo::projectName, std::make_unique<TestUIBehaviour>(), std::make_unique<TestEngineBehaviour>() };
+
+            HostedAudioDeviceInterface::Parameters params;
+            params.sampleRate = sampleRate;
+            params.blockSize = blockSize;
+            params.fixedBlockSize = true;
+
+            auto& audioInterface = engine.getDeviceManager().getHostedAudioDeviceInterface();
+            audioInterface.initialise (params);
+            audioInterface.prepareToPlay (sampleRate, blockSize);
+
+            TemporaryFile tempDir;
+            tempDir.getFile().createDirectory();
+
+            Array<var> results;
+
+            if (editFiles.isEmpty())
+            {
+                auto sourceFile = createSourceFile (tempDir.getFile());
+
+                results.add (runBenchmark (engine, "audioTracksWithPlugins", takeState (createAudioTracksEdit (engine, sourceFile)), tempDir.getFile()));
+                results.add (runBenchmark (engine, "midiWithFourOsc", takeState (createMidiEdit (engine)), tempDir.getFile()));
+                results.add (runBenchmark (engine, "automationDense", takeState (createAutomationEdit (engine, sourceFile)), tempDir.getFile()));
+            }
+            else
+            {
+                for (auto& path : editFiles)
+                {
+                    auto file = File::getCurrentWorkingDirectory().getChildFile (path);
+                    auto state = loadEditFromFile (engine, file, {});
+
+                    if (! state.isValid())
+                    {
+                        Logger::writeToLog ("Unable to load Edit: " + file.getFullPathName());
+                        returnValue = 1;
+                        continue;
+                    }
+
+                    results.add (runBenchmark (engine, file.getFileNameWithoutExtension(), state, tempDir.getFile()));
+                }
+            }
+
+            if (baselineFile.existsAsFile())
+                compareWithBaseline (results, baselineFile);
+
+            if (resultsFile != File())
+            {
+                if (resultsFile.replaceWithText (JSON::toString (results)))
+                    Logger::writeToLog ("Wrote benchmark results to: " + resultsFile.getFullPathName());
+                else
+                    returnValue = 1;
+            }
+
+            tempDir.getFile().deleteRecursively();
+        }
+
+        Logger::setCurrentLogger (nullptr);
+        return returnValue;
+    }
+}
+
+
 //==============================================================================
 //==============================================================================
 int main (int argv, char** argc)
 {
-    File junitFile;
+    File junitFile, benchmarkResultsFile, benchmarkBaselineFile;
+    StringArray benchmarkEdits;
+    bool shouldRunBenchmarks = false;
     
     for (int i = 1; i < argv; ++i)
-        if (String (argc[i]) == "--junit-xml-file")
-            if ((i + 1) < argv)
+    {
+        const String arg (argc[i]);
+
+        if (arg == "--benchmark")
+            shouldRunBenchmarks = true;
+
+        if ((i + 1) < argv)
+        {
+            if (arg == "--junit-xml-file")
                 junitFile = String (argc[i + 1]);
+            else if (arg == "--benchmark-edit")
+                benchmarkEdits.add (argc[i + 1]);
+            else if (arg == "--benchmark-results-file")
+                benchmarkResultsFile = File::getCurrentWorkingDirectory().getChildFile (argc[i + 1]);
+            else if (arg == "--benchmark-baseline")
+                benchmarkBaselineFile = File::getCurrentWorkingDirectory().getChildFile (argc[i + 1]);
+        }
+    }
     
     ScopedJuceInitialiser_GUI init;
+
+    if (shouldRunBenchmarks)
+        return Benchmarks::runBenchmarks (benchmarkEdits, benchmarkResultsFile, benchmarkBaselineFile);
+
     return TestRunner::runTests (junitFile);
 }
@@ -13,6 +13,38 @@ namespace tracktion_engine
 
 static int getFloatFileHeaderInt()  { return (int) juce::ByteOrder::littleEndianInt ("TRKF"); }
 
+// The samples start on a page boundary, and so does each block of a planar file
+static constexpr int floatFileHeaderSize = 4096;
+static constexpr int floatFilePlanarBlockFrames = 4096;
+
+/** Planar files are stored as blocks of floatFilePlanarBlockFrames samples, each holding
+    the block's samples for every channel in turn.
+*/
+static juce::int64 getPlanarSamplePosition (juce::int64 dataStart, int numChannels, int framesPerBlock,
+                                            int channel, juce::int64 sample) noexcept
+{
+    auto block = sample / framesPerBlock;
+    return dataStart + 4 * (block * framesPerBlock * numChannels + channel * framesPerBlock + (sample - block * framesPerBlock));
+}
+
+static void convertFromFileByteOrder (float* data, int numSamples, bool fileIsBigEndian) noexcept
+{
+   #if JUCE_LITTLE_ENDIAN
+    if (! fileIsBigEndian)
+        return;
+   #else
+    if (fileIsBigEndian)
+        return;
+   #endif
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        juce::uint32 bits;
+        std::memcpy (&bits, data + i, sizeof (bits));
+        bits = juce::ByteOrder::swap (bits);
+        std::memcpy (data + i, &bits, sizeof (bits));
+    }
+}
 
 //==============================================================================
 class FloatAudioFormatReader  : public juce::AudioFormatReader
@@ -30,9 +62,10 @@ public:
             lengthInSamples = in->readInt();
             numChannels     = (unsigned int) in->readShort();
             bigEndian       = in->readShort() != 0;
+            framesPerBlock  = in->readInt();
             bitsPerSample   = 32;
 
-            if (sampleRate < 32000 || sampleRate > 192000 || numChannels < 1 || numChannels > 16)
+            if (sampleRate < 32000 || sampleRate > 192000 || numChannels < 1 || numChannels > 16 || framesPerBlock < 0)
                 sampleRate = 0;
         }
     }
@@ -46,6 +79,9 @@ public:
         if (numSamples <= 0)
             return true;
 
+        if (isPlanar())
+            return readPlanarSamples (destSamples, numDestChannels, startOffsetInDestBuffer, startSampleInFile, numSamples);
+
         input->setPosition (4 * startSampleInFile * numChannels + dataStartOffset);
         const int bytesPerFrame = 4 * (int) numChannels;
 
@@ -77,8 +113,59 @@ public:
         return true;
     }
 
-    int dataStartOffset;
-    bool bigEndian;
+    bool isPlanar() const noexcept      { return framesPerBlock > 0; }
+
+    juce::int64 getDataLength() const noexcept
+    {
+        if (! isPlanar())
+            return lengthInSamples * 4 * numChannels;
+
+        // The last block is padded out to its full size
+        auto numBlocks = (lengthInSamples + framesPerBlock - 1) / framesPerBlock;
+        return numBlocks * framesPerBlock * 4 * numChannels;
+    }
+
+    int dataStartOffset = 0;
+    int framesPerBlock = 0;
+    bool bigEndian = false;
+
+private:
+    bool readPlanarSamples (int** destSamples, int numDestChannels, int startOffsetInDestBuffer,
+                            juce::int64 startSampleInFile, int numSamples)
+    {
+        while (numSamples > 0)
+        {
+            const int numThisTime = std::min (numSamples, framesPerBlock - (int) (startSampleInFile % framesPerBlock));
+
+            for (int i = 0; i < numDestChannels; ++i)
+            {
+                if (auto dest = reinterpret_cast<float*> (destSamples[i]))
+                {
+                    dest += startOffsetInDestBuffer;
+
+                    if (i >= (int) numChannels)
+                    {
+                        juce::FloatVectorOperations::clear (dest, numThisTime);
+                        continue;
+                    }
+
+                    input->setPosition (getPlanarSamplePosition (dataStartOffset, (int) numChannels, framesPerBlock, i, startSampleInFile));
+                    const int bytesRead = std::max (0, input->read (dest, numThisTime * 4));
+
+                    if (bytesRead < numThisTime * 4)
+                        juce::zeromem (juce::addBytesToPointer (dest, bytesRead), (size_t) (numThisTime * 4 - bytesRead));
+
+                    convertFromFileByteOrder (dest, numThisTime, bigEndian);
+                }
+            }
+
+            startSampleInFile += numThisTime;
+            startOffsetInDestBuffer += numThisTime;
+            numSamples -= numThisTime;
+        }
+
+        return true;
+    }
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (FloatAudioFormatReader)
 };
@@ -87,20 +174,31 @@ public:
 class FloatAudioFormatWriter  : public juce::AudioFormatWriter
 {
 public:
-    FloatAudioFormatWriter (juce::OutputStream* out, double sampleRate_, unsigned int numChannels_)
+    FloatAudioFormatWriter (juce::OutputStream* out, double sampleRate_, unsigned int numChannels_, bool planar)
         : AudioFormatWriter (out,
                              TRANS("Tracktion audio file"),
                              sampleRate_,
                              numChannels_,
                              32),
-          lengthInSamples (0)
+          lengthInSamples (0),
+          framesPerBlock (planar ? floatFilePlanarBlockFrames : 0)
     {
         usesFloatingPointData = true;
+
+        if (planar)
+            planarBlock.setSize ((int) numChannels, framesPerBlock);
+
         writeHeader();
     }
 
     ~FloatAudioFormatWriter()
     {
+        if (numInPlanarBlock > 0)
+        {
+            planarBlock.clear (numInPlanarBlock, framesPerBlock - numInPlanarBlock);
+            writePlanarBlock();
+        }
+
         output->setPosition (0);
         writeHeader();
     }
@@ -110,6 +208,12 @@ public:
     {
         lengthInSamples += numSamps;
 
+        if (framesPerBlock > 0)
+        {
+            writePlanar (data, numSamps);
+            return true;
+        }
+
         for (int j = 0; j < numSamps; ++j)
         {
             for (unsigned int i = 0; i < numChannels; ++i)
@@ -132,18 +236,60 @@ public:
 
 private:
     int lengthInSamples;
+    const int framesPerBlock;
+    juce::AudioBuffer<float> planarBlock;
+    int numInPlanarBlock = 0;
+
+    void writePlanar (const int** data, int numSamps)
+    {
+        for (int done = 0; done < numSamps;)
+        {
+            const int numThisTime = std::min (numSamps - done, framesPerBlock - numInPlanarBlock);
+
+            for (int i = 0; i < (int) numChannels; ++i)
+            {
+                if (auto chan = reinterpret_cast<const float*> (data[i]))
+                    planarBlock.copyFrom (i, numInPlanarBlock, chan + done, numThisTime);
+                else
+                    planarBlock.clear (i, numInPlanarBlock, numThisTime);
+            }
+
+            numInPlanarBlock += numThisTime;
+            done += numThisTime;
+
+            if (numInPlanarBlock == framesPerBlock)
+                writePlanarBlock();
+        }
+    }
+
+    void writePlanarBlock()
+    {
+        for (int i = 0; i < (int) numChannels; ++i)
+        {
+            auto chan = planarBlock.getReadPointer (i);
+
+            for (int j = 0; j < framesPerBlock; ++j)
+            {
+                float val = chan[j];
+                JUCE_UNDENORMALISE (val);
+                output->writeFloat (val);
+            }
+        }
+
+        numInPlanarBlock = 0;
+    }
 
     void writeHeader()
     {
-        const int headerSize = 512;
         output->writeInt (getFloatFileHeaderInt());
-        output->writeInt (headerSize);
+        output->writeInt (floatFileHeaderSize);
         output->writeInt (juce::roundToInt (sampleRate));
         output->writeInt (lengthInSamples);
         output->writeShort ((short)numChannels);
         output->writeShort (0); // big-endian
+        output->writeInt (framesPerBlock);
 
-        while (output->getPosition() < headerSize)
+        while (output->getPosition() < floatFileHeaderSize)
             output->writeByte (0);
     }
 
@@ -157,9 +303,10 @@ public:
     MemoryMappedFloatReader (const juce::File& f, const FloatAudioFormatReader& reader)
         : MemoryMappedAudioFormatReader (f, reader,
                                          reader.dataStartOffset,
-                                         reader.lengthInSamples * 4 * reader.numChannels,
+                                         reader.getDataLength(),
                                          4 * (int) reader.numChannels),
-          bigEndian (reader.bigEndian)
+          bigEndian (reader.bigEndian),
+          framesPerBlock (reader.framesPerBlock)
     {
     }
 
@@ -175,6 +322,9 @@ public:
             return false;
         }
 
+        if (isPlanar())
+            return readPlanarSamples (destSamples, numDestChannels, startOffsetInDestBuffer, startSampleInFile, numSamples);
+
         if (bigEndian)
             ReadHelper<juce::AudioData::Float32, juce::AudioData::Float32, juce::AudioData::BigEndian>
                 ::read (destSamples, startOffsetInDestBuffer, numDestChannels, sampleToPointer (startSampleInFile), (int) numChannels, numSamples);
@@ -195,6 +345,20 @@ public:
             return;
         }
 
+        if (isPlanar())
+        {
+            for (int i = 0; i < (int) numChannels; ++i)
+            {
+                if (auto source = getPlanarPointer (i, sample, 1))
+                    std::memcpy (result + i, source, sizeof (float));
+                else
+                    result[i] = 0.0f;
+            }
+
+            convertFromFileByteOrder (result, (int) numChannels, bigEndian);
+            return;
+        }
+
         const void* sourceData = sampleToPointer (sample);
 
         if (bigEndian)
@@ -207,45 +371,122 @@ public:
 
     void readMaxLevels (juce::int64 startSampleInFile, juce::int64 numSamples, juce::Range<float>* results, int numChannelsToRead) override
     {
-        if (numSamples <= 0)
-        {
-            for (int i = 0; i < numChannelsToRead; ++i)
-                results[i] = {};
+        for (int i = 0; i < numChannelsToRead; ++i)
+            results[i] = {};
 
+        if (numSamples <= 0)
             return;
-        }
 
         if (map == nullptr || ! mappedSection.contains ({ startSampleInFile, startSampleInFile + numSamples }))
         {
             jassertfalse; // you must make sure that the window contains all the samples you're going to attempt to read.
-
-            for (int i = 0; i < numChannelsToRead; ++i)
-                results[i] = {};
-
             return;
         }
 
-        switch (bitsPerSample)
+        for (int i = 0; i < std::min (numChannelsToRead, (int) numChannels); ++i)
         {
-            case 8:     scanMinAndMax<juce::AudioData::UInt8> (startSampleInFile, numSamples, results, numChannelsToRead); break;
-            case 16:    scanMinAndMax<juce::AudioData::Int16> (startSampleInFile, numSamples, results, numChannelsToRead); break;
-            case 24:    scanMinAndMax<juce::AudioData::Int24> (startSampleInFile, numSamples, results, numChannelsToRead); break;
-            case 32:    if (usesFloatingPointData) scanMinAndMax<juce::AudioData::Float32> (startSampleInFile, numSamples, results, numChannelsToRead);
-                        else                       scanMinAndMax<juce::AudioData::Int32>   (startSampleInFile, numSamples, results, numChannelsToRead); break;
-            default:    jassertfalse; break;
+            if (! isPlanar())
+            {
+                auto source = juce::addBytesToPointer (sampleToPointer (startSampleInFile), 4 * i);
+                results[i] = findMinAndMax (source, (int) numChannels, (size_t) numSamples);
+                continue;
+            }
+
+            bool isFirst = true;
+
+            for (auto sample = startSampleInFile; sample < startSampleInFile + numSamples;)
+            {
+                const auto numThisTime = (int) std::min (startSampleInFile + numSamples - sample,
+                                                         (juce::int64) (framesPerBlock - (int) (sample % framesPerBlock)));
+
+                if (auto source = getPlanarPointer (i, sample, numThisTime))
+                {
+                    auto range = findMinAndMax (source, 1, (size_t) numThisTime);
+                    results[i] = isFirst ? range : results[i].getUnionWith (range);
+                    isFirst = false;
+                }
+
+                sample += numThisTime;
+            }
         }
     }
 
+    bool isPlanar() const noexcept      { return framesPerBlock > 0; }
+
+    /** Planar blocks are only all there if the mapped section starts and ends on a block. */
+    juce::Range<juce::int64> getMappableSection (juce::Range<juce::int64> section) const noexcept
+    {
+        if (! isPlanar())
+            return section;
+
+        return { (section.getStart() / framesPerBlock) * framesPerBlock,
+                 ((section.getEnd() + framesPerBlock - 1) / framesPerBlock) * framesPerBlock };
+    }
+
 private:
     const bool bigEndian;
+    const int framesPerBlock;
 
-    template <typename SampleType>
-    void scanMinAndMax (juce::int64 startSampleInFile, juce::int64 numSamples, juce::Range<float>* results, int numChannelsToRead) const
+    const float* getPlanarPointer (int channel, juce::int64 sample, int numSamples) const noexcept
     {
-        typedef juce::AudioData::Pointer<SampleType, juce::AudioData::LittleEndian, juce::AudioData::Interleaved, juce::AudioData::Const> SourceType;
+        auto pos = getPlanarSamplePosition (dataChunkStart, (int) numChannels, framesPerBlock, channel, sample);
+        auto mappedBytes = map->getRange();
 
-        for (int i = 0; i < numChannelsToRead; ++i)
-            results[i] = SourceType (sampleToPointer (startSampleInFile), (int) numChannels).findMinAndMax ((size_t) numSamples);
+        if (! mappedBytes.contains ({ pos, pos + 4 * numSamples }))
+        {
+            jassertfalse; // the mapped section should cover whole blocks
+            return nullptr;
+        }
+
+        return static_cast<const float*> (juce::addBytesToPointer (map->getData(), pos - mappedBytes.getStart()));
+    }
+
+    bool readPlanarSamples (int** destSamples, int numDestChannels, int startOffsetInDestBuffer,
+                            juce::int64 startSampleInFile, int numSamples) const
+    {
+        bool allRead = true;
+
+        while (numSamples > 0)
+        {
+            const int numThisTime = std::min (numSamples, framesPerBlock - (int) (startSampleInFile % framesPerBlock));
+
+            for (int i = 0; i < numDestChannels; ++i)
+            {
+                if (auto dest = reinterpret_cast<float*> (destSamples[i]))
+                {
+                    dest += startOffsetInDestBuffer;
+
+                    auto source = i < (int) numChannels ? getPlanarPointer (i, startSampleInFile, numThisTime) : nullptr;
+
+                    if (source == nullptr)
+                    {
+                        allRead = allRead && i >= (int) numChannels;
+                        juce::FloatVectorOperations::clear (dest, numThisTime);
+                        continue;
+                    }
+
+                    // A channel's samples are contiguous, so a native-endian file is a straight copy
+                    juce::FloatVectorOperations::copy (dest, source, numThisTime);
+                    convertFromFileByteOrder (dest, numThisTime, bigEndian);
+                }
+            }
+
+            startSampleInFile += numThisTime;
+            startOffsetInDestBuffer += numThisTime;
+            numSamples -= numThisTime;
+        }
+
+        return allRead;
+    }
+
+    juce::Range<float> findMinAndMax (const void* source, int numInterleavedChannels, size_t numSamples) const noexcept
+    {
+        using namespace juce::AudioData;
+
+        if (bigEndian)
+            return Pointer<Float32, BigEndian, Interleaved, Const> (source, numInterleavedChannels).findMinAndMax (numSamples);
+
+        return Pointer<Float32, LittleEndian, Interleaved, Const> (source, numInterleavedChannels).findMinAndMax (numSamples);
     }
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MemoryMappedFloatReader)
@@ -261,6 +502,8 @@ juce::Array<int> FloatAudioFormat::getPossibleBitDepths()       { return { 32 };
 bool FloatAudioFormat::canDoStereo()    { return true; }
 bool FloatAudioFormat::canDoMono()      { return true; }
 
+juce::StringArray FloatAudioFormat::getQualityOptions()         { return { TRANS("Interleaved"), TRANS("Planar") }; }
+
 bool FloatAudioFormat::canHandleFile (const juce::File& f)
 {
     return f.hasFileExtension (".trkaudio")
@@ -301,9 +544,18 @@ juce::AudioFormatWriter* FloatAudioFormat::createWriterFor (juce::OutputStream*
                                                             unsigned int numChannels,
                                                             int /*bitsPerSample*/,
                                                             const juce::StringPairArray& /*metadataValues*/,
-                                                            int /*qualityOptionIndex*/)
+                                                            int qualityOptionIndex)
 {
-    return new FloatAudioFormatWriter (out, sampleRate, numChannels);
+    return new FloatAudioFormatWriter (out, sampleRate, numChannels, qualityOptionIndex == planarQualityIndex);
+}
+
+juce::Range<juce::int64> FloatAudioFormat::getMappableSection (const juce::MemoryMappedAudioFormatReader& reader,
+                                                               juce::Range<juce::int64> section)
+{
+    if (auto floatReader = dynamic_cast<const MemoryMappedFloatReader*> (&reader))
+        return floatReader->getMappableSection (section);
+
+    return section;
 }
 
 }
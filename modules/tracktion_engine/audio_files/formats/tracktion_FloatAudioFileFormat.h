@@ -13,6 +13,11 @@ namespace tracktion_engine
 
 /**
     A raw, proprietory, simple floating point format used for freeze files, etc.
+
+    The samples can either be interleaved or planar, which is chosen when the file is
+    written by passing planarQualityIndex as the quality option. Planar files store the
+    channels in separate page-aligned blocks, so a memory-mapped reader can copy each
+    channel straight out of the mapped pages without converting or de-interleaving it.
 */
 class FloatAudioFormat   : public juce::AudioFormat
 {
@@ -26,6 +31,10 @@ public:
     bool canDoStereo() override;
     bool canDoMono() override;
     bool canHandleFile (const juce::File&) override;
+    juce::StringArray getQualityOptions() override;
+
+    /** The quality option that writes planar rather than interleaved files. */
+    static constexpr int planarQualityIndex = 1;
 
     //==============================================================================
     juce::AudioFormatReader* createReaderFor (juce::InputStream*, bool deleteStreamIfOpeningFails) override;
@@ -36,6 +45,13 @@ public:
                                               unsigned int numChannels, int bitsPerSample,
                                               const juce::StringPairArray& metadataValues,
                                               int qualityOptionIndex) override;
+
+    /** Returns the section of samples to map so that a reader can read the given section.
+        A planar file can only be read in whole blocks, so this rounds the section out to
+        them. For any other reader, the section is returned unchanged.
+    */
+    static juce::Range<juce::int64> getMappableSection (const juce::MemoryMappedAudioFormatReader&,
+                                                        juce::Range<juce::int64> section);
 };
 
 } // namespace tracktion_engine
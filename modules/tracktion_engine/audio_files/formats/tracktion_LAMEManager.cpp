@@ -45,6 +45,311 @@ bool LAMEManager::lameIsAvailable()
     return lameEnc.exists() && lameEnc.getFileName().containsIgnoreCase ("lame");
 }
 
+//==============================================================================
+namespace LAMEHelpers
+{
+    static constexpr int samplesPerFrame = 1152;
+    static constexpr int framesEitherSideOfSection = 8;
+    static constexpr double minSecondsPerSection = 30.0;
+
+    /** Returns the size of the MPEG-1 or 2 layer III frame starting at the given header, or 0 if it isn't one. */
+    static int getFrameSize (const juce::uint8* header, int& sampleRate)
+    {
+        if (header[0] != 0xff || (header[1] & 0xe0) != 0xe0)
+            return 0;
+
+        const int version       = (header[1] >> 3) & 3;     // 3 = MPEG-1, 2 = MPEG-2, 0 = MPEG-2.5
+        const int layer         = (header[1] >> 1) & 3;     // 1 = layer III
+        const int bitrateIndex  = header[2] >> 4;
+        const int rateIndex     = (header[2] >> 2) & 3;
+        const int padding       = (header[2] >> 1) & 1;
+
+        if (version == 1 || layer != 1 || bitrateIndex == 0 || bitrateIndex == 15 || rateIndex == 3)
+            return 0;
+
+        static const int mpeg1Bitrates[] = { 0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320 };
+        static const int mpeg2Bitrates[] = { 0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160 };
+        static const int sampleRates[]   = { 44100, 48000, 32000 };
+
+        sampleRate = sampleRates[rateIndex] >> (version == 3 ? 0 : (version == 2 ? 1 : 2));
+        const int bitrate = (version == 3 ? mpeg1Bitrates : mpeg2Bitrates)[bitrateIndex] * 1000;
+
+        return (version == 3 ? 144 : 72) * bitrate / sampleRate + padding;
+    }
+
+    struct EncodedSection
+    {
+        juce::MemoryBlock data;
+        size_t tagSize = 0;
+        juce::Array<juce::Range<size_t>> frames;
+        int sampleRate = 0;
+    };
+
+    /** Finds the frames of an MP3 file, skipping any ID3v2 tag at the start and stopping at anything that isn't a frame. */
+    static void findFrames (EncodedSection& section)
+    {
+        auto data = static_cast<const juce::uint8*> (section.data.getData());
+        const auto size = section.data.getSize();
+        size_t pos = 0;
+
+        if (size > 10 && data[0] == 'I' && data[1] == 'D' && data[2] == '3')
+        {
+            pos = 10 + (size_t) (((data[6] & 0x7f) << 21) | ((data[7] & 0x7f) << 14) | ((data[8] & 0x7f) << 7) | (data[9] & 0x7f));
+
+            if ((data[5] & 0x10) != 0)
+                pos += 10;
+
+            section.tagSize = std::min (pos, size);
+        }
+
+        while (pos + 4 <= size)
+        {
+            int rate = 0;
+            auto frameSize = (size_t) getFrameSize (data + pos, rate);
+
+            if (frameSize == 0 || pos + frameSize > size)
+                break;
+
+            if (section.frames.isEmpty())
+                section.sampleRate = rate;
+
+            section.frames.add ({ pos, pos + frameSize });
+            pos += frameSize;
+        }
+    }
+
+    static juce::StringArray getEncoderArgs (int qualityOptionIndex)
+    {
+        juce::StringArray args;
+        args.add (LAMEManager::getLameEncoderExe().getFullPathName());
+        args.add ("--quiet");
+
+        // This matches the way juce::LAMEEncoderAudioFormat reads its quality options
+        auto quality = juce::LAMEEncoderAudioFormat (LAMEManager::getLameEncoderExe()).getQualityOptions()[qualityOptionIndex];
+
+        if (quality.contains ("VBR") || quality.isEmpty())
+        {
+            args.add ("--vbr-new");
+            args.add ("-V");
+            args.add (juce::String (quality.isEmpty() ? 4 : quality.retainCharacters ("0123456789").getIntValue()));
+        }
+        else
+        {
+            args.add ("--cbr");
+            args.add ("-b");
+            args.add (juce::String (quality.getIntValue()));
+        }
+
+        return args;
+    }
+
+    static void addMetadataArgs (juce::StringArray& args, const juce::StringPairArray& metadata)
+    {
+        const char* keysAndArgs[][2] = { { "id3title", "--tt" }, { "id3artist", "--ta" }, { "id3album", "--tl" },
+                                         { "id3comment", "--tc" }, { "id3date", "--ty" }, { "id3genre", "--tg" },
+                                         { "id3trackNumber", "--tn" } };
+
+        for (auto& keyAndArg : keysAndArgs)
+        {
+            auto value = metadata.getValue (keyAndArg[0], {});
+
+            if (value.isNotEmpty())
+            {
+                args.add (keyAndArg[1]);
+                args.add (value);
+            }
+        }
+    }
+
+    static bool writeSectionWav (juce::AudioFormatReader& reader, juce::Range<juce::int64> range, const juce::File& dest)
+    {
+        juce::WavAudioFormat wav;
+        std::unique_ptr<juce::AudioFormatWriter> writer;
+
+        if (auto out = dest.createOutputStream())
+            writer.reset (wav.createWriterFor (out.release(), reader.sampleRate, reader.numChannels,
+                                               (int) reader.bitsPerSample, {}, 0));
+
+        return writer != nullptr
+                && writer->writeFromAudioReader (reader, range.getStart(), range.getLength());
+    }
+
+    /** Runs the processes, a few at a time, returning false if any failed or the callback cancelled them. */
+    static bool runProcesses (const juce::Array<juce::StringArray>& processArgs,
+                              const std::function<bool (float)>& updateProgress)
+    {
+        juce::OwnedArray<juce::ChildProcess> running;
+        const int maxNumRunning = std::max (1, juce::SystemStats::getNumCpus());
+        int numStarted = 0, numFinished = 0;
+
+        while (numFinished < processArgs.size())
+        {
+            while (running.size() < maxNumRunning && numStarted < processArgs.size())
+            {
+                std::unique_ptr<juce::ChildProcess> cp (new juce::ChildProcess());
+
+                if (! cp->start (processArgs.getReference (numStarted++), 0))
+                    return false;
+
+                running.add (cp.release());
+            }
+
+            for (int i = running.size(); --i >= 0;)
+            {
+                if (! running.getUnchecked (i)->isRunning())
+                {
+                    if (running.getUnchecked (i)->getExitCode() != 0)
+                        return false;
+
+                    running.remove (i);
+                    ++numFinished;
+                }
+            }
+
+            if (updateProgress != nullptr && ! updateProgress (numFinished / (float) processArgs.size()))
+            {
+                for (auto cp : running)
+                    cp->kill();
+
+                return false;
+            }
+
+            if (! running.isEmpty())
+                running.getFirst()->waitForProcessToFinish (20);
+        }
+
+        return true;
+    }
+}
+
+bool LAMEManager::encodeWavFile (const juce::File& sourceWav, const juce::File& destMP3,
+                                 int qualityOptionIndex, const juce::StringPairArray& metadata,
+                                 int maxNumSections, const std::function<bool (float)>& updateProgress)
+{
+    CRASH_TRACER
+    using namespace LAMEHelpers;
+
+    if (! lameIsAvailable())
+        return false;
+
+    juce::WavAudioFormat wav;
+    std::unique_ptr<juce::AudioFormatReader> reader;
+
+    if (auto in = sourceWav.createInputStream())
+        reader.reset (wav.createReaderFor (in.release(), true));
+
+    if (reader == nullptr)
+        return false;
+
+    const auto numSamples = reader->lengthInSamples;
+    const auto sampleRate = juce::roundToInt (reader->sampleRate);
+
+    // Only the rates MPEG-1 layer III can use without resampling have frames of a known length
+    int numSections = 1;
+
+    if (sampleRate == 32000 || sampleRate == 44100 || sampleRate == 48000)
+        numSections = juce::jlimit (1, std::max (1, maxNumSections),
+                                    (int) (numSamples / (minSecondsPerSection * sampleRate)));
+
+    if (numSections == 1)
+    {
+        auto args = getEncoderArgs (qualityOptionIndex);
+        addMetadataArgs (args, metadata);
+        args.add (sourceWav.getFullPathName());
+        args.add (destMP3.getFullPathName());
+
+        return runProcesses ({ args }, updateProgress) && destMP3.getSize() > 0;
+    }
+
+    // The sections start on frame boundaries, with some overlap to give the encoder the audio around them
+    const auto framesPerSection = numSamples / samplesPerFrame / numSections;
+    const juce::int64 overlap = framesEitherSideOfSection * samplesPerFrame;
+
+    juce::OwnedArray<juce::TemporaryFile> wavs, mp3s;
+    juce::Array<juce::StringArray> processArgs;
+
+    for (int i = 0; i < numSections; ++i)
+    {
+        const auto start = i * framesPerSection * samplesPerFrame;
+        const auto end = i == numSections - 1 ? numSamples : start + framesPerSection * samplesPerFrame;
+        const juce::Range<juce::int64> range (std::max ((juce::int64) 0, start - overlap), std::min (numSamples, end + overlap));
+
+        auto sectionWav = wavs.add (new juce::TemporaryFile (destMP3.withFileExtension ("wav")));
+        auto sectionMP3 = mp3s.add (new juce::TemporaryFile (destMP3));
+
+        if (! writeSectionWav (*reader, range, sectionWav->getFile()))
+            return false;
+
+        auto args = getEncoderArgs (qualityOptionIndex);
+        args.add ("-t");
+        args.add ("--nores");
+
+        // The first section writes its tag at the start, so it can be kept
+        if (i == 0)
+        {
+            args.add ("--id3v2-only");
+            addMetadataArgs (args, metadata);
+        }
+
+        args.add (sectionWav->getFile().getFullPathName());
+        args.add (sectionMP3->getFile().getFullPathName());
+        processArgs.add (args);
+    }
+
+    reader = nullptr;
+
+    if (! runProcesses (processArgs, updateProgress))
+        return false;
+
+    juce::OwnedArray<EncodedSection> sections;
+
+    for (auto mp3 : mp3s)
+    {
+        auto s = sections.add (new EncodedSection());
+        mp3->getFile().loadFileAsData (s->data);
+        findFrames (*s);
+
+        if (s->frames.isEmpty())
+            return false;
+    }
+
+    // If LAME resampled it, the frames won't line up with the sections
+    if (sections.getFirst()->sampleRate != sampleRate)
+    {
+        TRACKTION_LOG ("LAME: resampled, so encoding in one go");
+        return encodeWavFile (sourceWav, destMP3, qualityOptionIndex, metadata, 1, updateProgress);
+    }
+
+    destMP3.deleteFile();
+    juce::FileOutputStream out (destMP3);
+
+    if (! out.openedOk())
+        return false;
+
+    auto first = sections.getFirst();
+    out.write (first->data.getData(), first->tagSize);
+
+    for (int i = 0; i < sections.size(); ++i)
+    {
+        auto& s = *sections.getUnchecked (i);
+        auto firstFrame = i == 0 ? 0 : framesEitherSideOfSection;
+        auto numFrames = i == sections.size() - 1 ? s.frames.size() - firstFrame
+                                                  : (int) framesPerSection;
+
+        if (firstFrame + numFrames > s.frames.size())
+            return false;
+
+        auto bytes = s.frames.getReference (firstFrame).getStart();
+        auto numBytes = s.frames.getReference (firstFrame + numFrames - 1).getEnd() - bytes;
+
+        if (! out.write (juce::addBytesToPointer (s.data.getData(), bytes), numBytes))
+            return false;
+    }
+
+    out.flush();
+    return out.getStatus().wasOk();
+}
+
 //==============================================================================
 #else
 
@@ -52,6 +357,12 @@ juce::File LAMEManager::getLameEncoderExe() { return {}; }
 void LAMEManager::registerAudioFormat (AudioFileFormatManager&) {}
 bool LAMEManager::lameIsAvailable()         { return false; }
 
+bool LAMEManager::encodeWavFile (const juce::File&, const juce::File&, int, const juce::StringPairArray&,
+                                 int, const std::function<bool (float)>&)
+{
+    return false;
+}
+
 #endif
 
 }
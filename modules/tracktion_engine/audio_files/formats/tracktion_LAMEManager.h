@@ -29,6 +29,22 @@ public:
     /** Returns true if a valid LAME file is found. */
     static bool lameIsAvailable();
 
+    /** Encodes a WAV file into an MP3 using the LAME encoder, with the given quality option
+        from the LAME format and its ID3 metadata.
+
+        If maxNumSections is more than 1, a long file is split into sections on MP3 frame
+        boundaries which are encoded by separate LAME processes at the same time, and their
+        frames are joined. Each section is encoded a few frames either side of its ends so the
+        joins match up, and without the bit reservoir, so none of its frames depend on another
+        section's. This costs a little quality at lower bitrates and the file has no gapless
+        playback info tag. If LAME resamples the file, it's encoded in one go instead.
+
+        The callback is called with the proportion done, and can return false to cancel.
+    */
+    static bool encodeWavFile (const juce::File& sourceWav, const juce::File& destMP3,
+                               int qualityOptionIndex, const juce::StringPairArray& metadata,
+                               int maxNumSections, const std::function<bool (float)>& updateProgress);
+
 private:
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LAMEManager)
 };
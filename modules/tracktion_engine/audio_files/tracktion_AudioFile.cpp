@@ -179,14 +179,7 @@ bool AudioFileWriter::appendBuffer (juce::AudioBuffer<float>& buffer, int num)
 
     if (writer != nullptr && writer->writeFromAudioSampleBuffer (buffer, 0, num))
     {
-        samplesUntilFlush -= num;
-
-        if (samplesUntilFlush <= 0)
-        {
-            samplesUntilFlush = numSamplesPerFlush;
-            writer->flush();
-        }
-
+        samplesWritten (num);
         return true;
     }
 
@@ -199,6 +192,70 @@ bool AudioFileWriter::appendBuffer (const int** buffer, int num)
     return writer != nullptr && writer->write (buffer, num);
 }
 
+bool AudioFileWriter::appendBuffer (juce::AudioBuffer<float>& buffer, int num, Ditherer& ditherer)
+{
+    num = std::min (num, buffer.getNumSamples());
+    const juce::ScopedLock sl (writerLock);
+
+    if (writer == nullptr)
+        return false;
+
+    auto numChannels = buffer.getNumChannels();
+
+    if (writer->isFloatingPoint())
+    {
+        ditherer.process (buffer.getArrayOfWritePointers(), numChannels, num);
+        return appendBuffer (buffer, num);
+    }
+
+    const float* source[256];
+    jassert (numChannels <= juce::numElementsInArray (source));
+    numChannels = std::min (numChannels, juce::numElementsInArray (source));
+
+    // Converts in chunks so the scratch space stays small however long the buffer is
+    constexpr int chunkSize = 4096;
+    auto neededSize = (size_t) (numChannels * chunkSize);
+
+    if (intDataSize < neededSize)
+    {
+        intData.malloc (neededSize);
+        intChannels.malloc ((size_t) numChannels + 1);
+        intDataSize = neededSize;
+    }
+
+    for (int i = 0; i < numChannels; ++i)
+        intChannels[i] = intData + i * chunkSize;
+
+    intChannels[numChannels] = nullptr;
+
+    for (int start = 0; start < num; start += chunkSize)
+    {
+        auto numThisTime = std::min (chunkSize, num - start);
+
+        for (int i = 0; i < numChannels; ++i)
+            source[i] = buffer.getReadPointer (i, start);
+
+        ditherer.processToInts (source, intChannels, numChannels, numThisTime);
+
+        if (! writer->write (const_cast<const int**> (intChannels.get()), numThisTime))
+            return false;
+    }
+
+    samplesWritten (num);
+    return true;
+}
+
+void AudioFileWriter::samplesWritten (int num)
+{
+    samplesUntilFlush -= num;
+
+    if (samplesUntilFlush <= 0)
+    {
+        samplesUntilFlush = numSamplesPerFlush;
+        writer->flush();
+    }
+}
+
 bool AudioFileWriter::writeFromAudioReader (juce::AudioFormatReader& reader,
                                             juce::int64 startSample,
                                             juce::int64 numSamples)
@@ -227,36 +284,85 @@ juce::ThreadPoolJob::JobStatus AudioProxyGenerator::GeneratorJob::runJob()
     juce::FloatVectorOperations::disableDenormalisedNumberSupport();
     proxy.deleteFile();
 
-    if (render())
-        afm.checkFileForChangesAsync (proxy);
-    else
+    // If the job's been cancelled it may have stopped part-way through
+    const bool renderedOk = render() && ! shouldExit();
+
+    if (! renderedOk)
         proxy.deleteFile();
 
-    progress = 1.0f;
+    // Other proxies that needed exactly the same render can just have a copy, and more may
+    // be added while copying so keep going until there are none left
+    for (;;)
+    {
+        auto proxiesToCopy = afm.proxyGenerator.removeFinishedJob (this);
+
+        if (proxiesToCopy.isEmpty())
+            break;
+
+        for (auto& p : proxiesToCopy)
+        {
+            afm.releaseFile (p);
+            p.deleteFile();
+
+            if (renderedOk && proxy.getFile().copyFileTo (p.getFile()))
+                afm.checkFileForChangesAsync (p);
+        }
+    }
 
-    afm.proxyGenerator.removeFinishedJob (this);
+    if (renderedOk)
+    {
+        if (primaryProxyCancelled)
+            proxy.deleteFile();
+        else
+            afm.checkFileForChangesAsync (proxy);
+    }
+
+    progress = 1.0f;
     return jobHasFinished;
 }
 
 //==============================================================================
 AudioProxyGenerator::AudioProxyGenerator()
+    : maxNumConcurrentJobs (juce::SystemStats::getNumCpus())
 {
 }
 
 AudioProxyGenerator::~AudioProxyGenerator()
 {
     CRASH_TRACER
+    const juce::ScopedLock sl (jobListLock);
+    queuedJobs.clear();
 }
 
 AudioProxyGenerator::GeneratorJob* AudioProxyGenerator::findJob (const AudioFile& proxy) const noexcept
 {
     for (auto j : activeJobs)
-        if (j->proxy == proxy)
+        if ((j->proxy == proxy && ! j->primaryProxyCancelled) || j->sharedProxies.contains (proxy))
+            return j;
+
+    for (auto j : queuedJobs)
+        if ((j->proxy == proxy && ! j->primaryProxyCancelled) || j->sharedProxies.contains (proxy))
             return j;
 
     return {};
 }
 
+AudioProxyGenerator::GeneratorJob* AudioProxyGenerator::findJobWithKey (juce::int64 renderKey) const noexcept
+{
+    if (renderKey != 0)
+    {
+        for (auto j : activeJobs)
+            if (j->renderKey == renderKey && ! j->isCancelled)
+                return j;
+
+        for (auto j : queuedJobs)
+            if (j->renderKey == renderKey && ! j->isCancelled)
+                return j;
+    }
+
+    return {};
+}
+
 static bool checkProxyStatus (const AudioFile& f)
 {
     if (f.getFile().existsAsFile())
@@ -279,14 +385,45 @@ void AudioProxyGenerator::beginJob (GeneratorJob* j)
     {
         const juce::ScopedLock sl (jobListLock);
 
-        if (findJob (job->proxy) == nullptr)
+        if (findJob (job->proxy) != nullptr)
+            return;
+
+        // If another clip needs exactly the same render, share its job
+        if (auto existing = findJobWithKey (job->renderKey))
         {
-            job->proxy.engine->getBackgroundJobs().addJob (j, true);
-            activeJobs.add (job.release());
+            existing->sharedProxies.addIfNotAlreadyThere (job->proxy);
+            return;
         }
+
+        queuedJobs.add (job.release());
+        startQueuedJobs();
+    }
+}
+
+void AudioProxyGenerator::startQueuedJobs()
+{
+    while (activeJobs.size() < maxNumConcurrentJobs && ! queuedJobs.isEmpty())
+    {
+        auto j = queuedJobs.removeAndReturn (0);
+        j->isStarted = true;
+        activeJobs.add (j);
+        j->proxy.engine->getBackgroundJobs().addJob (j, true, ThreadPoolJobWithProgress::Priority::interactive);
     }
 }
 
+void AudioProxyGenerator::setMaxNumConcurrentJobs (int newMax)
+{
+    const juce::ScopedLock sl (jobListLock);
+    maxNumConcurrentJobs = juce::jmax (1, newMax);
+    startQueuedJobs();
+}
+
+int AudioProxyGenerator::getMaxNumConcurrentJobs() const noexcept
+{
+    const juce::ScopedLock sl (jobListLock);
+    return maxNumConcurrentJobs;
+}
+
 bool AudioProxyGenerator::isProxyBeingGenerated (const AudioFile& proxyFile) const noexcept
 {
     const juce::ScopedLock sl (jobListLock);
@@ -303,30 +440,74 @@ float AudioProxyGenerator::getProportionComplete (const AudioFile& proxyFile) co
     return 1.0f;
 }
 
-void AudioProxyGenerator::removeFinishedJob (GeneratorJob* j)
+juce::Array<AudioFile> AudioProxyGenerator::removeFinishedJob (GeneratorJob* j)
 {
     const juce::ScopedLock sl (jobListLock);
-    activeJobs.removeAllInstancesOf (j);
+
+    juce::Array<AudioFile> proxiesToCopy;
+    proxiesToCopy.swapWith (j->sharedProxies);
+
+    // Keep the job in the list until its output has been copied to all the proxies sharing it
+    if (proxiesToCopy.isEmpty())
+    {
+        activeJobs.removeAllInstancesOf (j);
+        startQueuedJobs();
+    }
+
+    return proxiesToCopy;
 }
 
 void AudioProxyGenerator::deleteProxy (const AudioFile& proxyFile)
 {
     CRASH_TRACER
-    GeneratorJob* j = nullptr;
 
     {
         const juce::ScopedLock sl (jobListLock);
-        j = findJob (proxyFile);
-    }
 
-    if (j != nullptr)
-        proxyFile.engine->getBackgroundJobs().removeJob (j, true, 10000);
+        if (auto j = findJob (proxyFile))
+        {
+            if (j->sharedProxies.contains (proxyFile))
+            {
+                j->sharedProxies.removeAllInstancesOf (proxyFile);
+            }
+            else if (! j->sharedProxies.isEmpty())
+            {
+                // Other proxies still need this render, so let it finish but throw this one away
+                j->primaryProxyCancelled = true;
+            }
+            else if (! j->isStarted)
+            {
+                queuedJobs.removeObject (j);
+            }
+            else
+            {
+                auto& jobs = j->proxy.engine->getBackgroundJobs();
+
+                // If the pool hasn't started it yet it'll be deleted straight away
+                if (! j->isRunning())
+                    activeJobs.removeAllInstancesOf (j);
+
+                // Otherwise tell it to stop but don't wait, it'll delete its output when it notices
+                j->isCancelled = true;
+                j->primaryProxyCancelled = true;
+                jobs.removeJob (j, true, 0);
+                startQueuedJobs();
+            }
+        }
+    }
 
     proxyFile.deleteFile();
 }
 
-
 //==============================================================================
+static bool formatNeedsCachedProxy (Engine& engine, juce::AudioFormat* format)
+{
+    return dynamic_cast<juce::WavAudioFormat*> (format) == nullptr
+            && dynamic_cast<juce::AiffAudioFormat*> (format) == nullptr
+            && dynamic_cast<FloatAudioFormat*> (format) == nullptr
+            && ! engine.getEngineBehaviour().shouldStreamCompressedAudioFiles();
+}
+
 AudioFileInfo::AudioFileInfo (Engine& e)
     : engine (&e), loopInfo (e)
 {
@@ -345,9 +526,7 @@ AudioFileInfo::AudioFileInfo (const AudioFile& file, juce::AudioFormatReader* re
         numChannels     = (int) reader->numChannels;
         bitsPerSample   = (int) reader->bitsPerSample;
         isFloatingPoint = reader->usesFloatingPointData;
-        needsCachedProxy = dynamic_cast<juce::WavAudioFormat*> (format) == nullptr
-                              && dynamic_cast<juce::AiffAudioFormat*> (format) == nullptr
-                              && dynamic_cast<FloatAudioFormat*> (format) == nullptr;
+        needsCachedProxy = formatNeedsCachedProxy (*file.engine, format);
         metadata = reader->metadataValues;
     }
     else
@@ -446,11 +625,266 @@ private:
     }
 };
 
+//==============================================================================
+/**
+    Keeps the headers of files that have been parsed in a file in the temp directory, so
+    loading an Edit doesn't have to open every file again.
+    Entries are looked up by the file's hash and are only used if the path, size and
+    modification time still match, so changed files are parsed again.
+*/
+struct AudioFileManager::InfoCache
+{
+    InfoCache (Engine& e) : engine (e) {}
+
+    ~InfoCache()
+    {
+        save();
+    }
+
+    static constexpr int maxNumEntries = 50000;
+
+    bool getInfo (const AudioFile& file, AudioFileInfo& info)
+    {
+        const juce::ScopedLock sl (lock);
+        loadIfNeeded();
+
+        auto found = entries.find (file.getHash());
+
+        if (found == entries.end())
+            return false;
+
+        auto& entry = found->second;
+        auto& f = file.getFile();
+
+        if (entry.path != f.getFullPathName()
+             || entry.size != f.getSize()
+             || entry.modificationTime != f.getLastModificationTime().toMilliseconds())
+        {
+            entries.erase (found);
+            isDirty = true;
+            return false;
+        }
+
+        auto format = engine.getAudioFileFormatManager().getNamedFormat (entry.formatName);
+
+        if (format == nullptr)
+            return false;
+
+        info.wasParsedOk        = true;
+        info.hashCode           = file.getHash();
+        info.format             = format;
+        info.sampleRate         = entry.sampleRate;
+        info.lengthInSamples    = entry.lengthInSamples;
+        info.numChannels        = entry.numChannels;
+        info.bitsPerSample      = entry.bitsPerSample;
+        info.isFloatingPoint    = entry.isFloatingPoint;
+        info.needsCachedProxy   = formatNeedsCachedProxy (engine, format);
+        info.metadata           = entry.metadata;
+        info.fileModificationTime = juce::Time (entry.modificationTime);
+        info.loopInfo           = LoopInfo (engine, entry.loopInfo.createCopy(), nullptr);
+
+        entry.lastUsedTime = juce::Time::currentTimeMillis();
+        return true;
+    }
+
+    void addInfo (const AudioFile& file, const AudioFileInfo& info)
+    {
+        if (! info.wasParsedOk || info.format == nullptr)
+            return;
+
+        auto& f = file.getFile();
+
+        Entry entry;
+        entry.path              = f.getFullPathName();
+        entry.size              = f.getSize();
+        entry.modificationTime  = info.fileModificationTime.toMilliseconds();
+        entry.lastUsedTime      = juce::Time::currentTimeMillis();
+        entry.formatName        = info.format->getFormatName();
+        entry.sampleRate        = info.sampleRate;
+        entry.lengthInSamples   = info.lengthInSamples;
+        entry.numChannels       = info.numChannels;
+        entry.bitsPerSample     = info.bitsPerSample;
+        entry.isFloatingPoint   = info.isFloatingPoint;
+        entry.metadata          = info.metadata;
+        entry.loopInfo          = info.loopInfo.state.createCopy();
+
+        const juce::ScopedLock sl (lock);
+        loadIfNeeded();
+        entries[file.getHash()] = std::move (entry);
+        isDirty = true;
+    }
+
+    void save()
+    {
+        const juce::ScopedLock sl (lock);
+
+        if (! isDirty || cacheFile == juce::File())
+            return;
+
+        removeOldestEntriesIfNeeded();
+
+        juce::TemporaryFile temp (cacheFile);
+
+        if (auto out = std::unique_ptr<juce::FileOutputStream> (temp.getFile().createOutputStream()))
+        {
+            out->writeInt ((int) magicNumber);
+            out->writeInt ((int) entries.size());
+
+            for (auto& e : entries)
+            {
+                out->writeInt64 (e.first);
+                e.second.writeTo (*out);
+            }
+
+            out->flush();
+
+            if (out->getStatus().wasOk())
+            {
+                out.reset();
+
+                if (temp.overwriteTargetFileWithTemporary())
+                    isDirty = false;
+            }
+        }
+    }
+
+private:
+    struct Entry
+    {
+        juce::String path, formatName;
+        juce::int64 size = 0, modificationTime = 0, lastUsedTime = 0, lengthInSamples = 0;
+        double sampleRate = 0;
+        int numChannels = 0, bitsPerSample = 0;
+        bool isFloatingPoint = false;
+        juce::StringPairArray metadata;
+        juce::ValueTree loopInfo;
+
+        void writeTo (juce::OutputStream& out) const
+        {
+            out.writeString (path);
+            out.writeString (formatName);
+            out.writeInt64 (size);
+            out.writeInt64 (modificationTime);
+            out.writeInt64 (lastUsedTime);
+            out.writeInt64 (lengthInSamples);
+            out.writeDouble (sampleRate);
+            out.writeInt (numChannels);
+            out.writeInt (bitsPerSample);
+            out.writeBool (isFloatingPoint);
+
+            auto& keys = metadata.getAllKeys();
+            auto& values = metadata.getAllValues();
+            out.writeInt (keys.size());
+
+            for (int i = 0; i < keys.size(); ++i)
+            {
+                out.writeString (keys[i]);
+                out.writeString (values[i]);
+            }
+
+            loopInfo.writeToStream (out);
+        }
+
+        bool readFrom (juce::InputStream& in)
+        {
+            path                = in.readString();
+            formatName          = in.readString();
+            size                = in.readInt64();
+            modificationTime    = in.readInt64();
+            lastUsedTime        = in.readInt64();
+            lengthInSamples     = in.readInt64();
+            sampleRate          = in.readDouble();
+            numChannels         = in.readInt();
+            bitsPerSample       = in.readInt();
+            isFloatingPoint     = in.readBool();
+
+            auto numMetadataValues = in.readInt();
+
+            if (numMetadataValues < 0 || in.isExhausted())
+                return false;
+
+            for (int i = 0; i < numMetadataValues; ++i)
+            {
+                auto key = in.readString();
+                metadata.set (key, in.readString());
+            }
+
+            loopInfo = juce::ValueTree::readFromStream (in);
+            return loopInfo.isValid();
+        }
+    };
+
+    static constexpr juce::uint32 magicNumber = 0x31494154; // "TAI1"
+
+    Engine& engine;
+    juce::CriticalSection lock;
+    std::unordered_map<juce::int64, Entry> entries;
+    juce::File cacheFile;
+    bool hasLoaded = false, isDirty = false;
+
+    void loadIfNeeded()
+    {
+        if (hasLoaded)
+            return;
+
+        hasLoaded = true;
+
+        // Keep hold of this as the TemporaryFileManager is deleted before us
+        cacheFile = engine.getTemporaryFileManager().getTempFile ("audio_file_info.cache");
+
+        juce::FileInputStream in (cacheFile);
+
+        if (! in.openedOk() || (juce::uint32) in.readInt() != magicNumber)
+            return;
+
+        for (auto numEntries = in.readInt(); --numEntries >= 0 && ! in.isExhausted();)
+        {
+            auto hash = in.readInt64();
+            Entry entry;
+
+            if (! entry.readFrom (in))
+            {
+                // The file's been truncated so just start again
+                entries.clear();
+                return;
+            }
+
+            entries[hash] = std::move (entry);
+        }
+    }
+
+    void removeOldestEntriesIfNeeded()
+    {
+        if ((int) entries.size() <= maxNumEntries)
+            return;
+
+        std::vector<juce::int64> lastUsedTimes;
+        lastUsedTimes.reserve (entries.size());
+
+        for (auto& e : entries)
+            lastUsedTimes.push_back (e.second.lastUsedTime);
+
+        auto cutoff = lastUsedTimes.begin() + (lastUsedTimes.size() - (size_t) maxNumEntries);
+        std::nth_element (lastUsedTimes.begin(), cutoff, lastUsedTimes.end());
+        auto oldestTimeToKeep = *cutoff;
+
+        for (auto i = entries.begin(); i != entries.end();)
+        {
+            if (i->second.lastUsedTime < oldestTimeToKeep)
+                i = entries.erase (i);
+            else
+                ++i;
+        }
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (InfoCache)
+};
+
 //==============================================================================
 struct AudioFileManager::KnownFile
 {
-    KnownFile (const AudioFile& f)
-        : file (f), info (AudioFileInfo::parse (file))
+    KnownFile (const AudioFile& f, const AudioFileInfo& i)
+        : file (f), info (i)
     {
     }
 
@@ -561,6 +995,9 @@ void SmartThumbnail::timerCallback()
     if (getTimerInterval() == initialTimerDelay)
         audioFileChanged();
 
+    // Let the thumbnails that can be seen be generated first
+    setIsVisible (component.isShowing());
+
     const bool isGeneratingNow = proxyGen.isProxyBeingGenerated (file);
 
     if (wasGeneratingProxy != isGeneratingNow || (thumbnailIsInvalid && file.getFile().exists()))
@@ -600,7 +1037,8 @@ void SmartThumbnail::timerCallback()
 
 //==============================================================================
 AudioFileManager::AudioFileManager (Engine& e)
-    : engine (e), cache (e), thumbnailCache (new TracktionThumbnailCache (e))
+    : engine (e), cache (e), infoCache (std::make_unique<InfoCache> (e)),
+      thumbnailCache (new TracktionThumbnailCache (e))
 {
 }
 
@@ -614,7 +1052,7 @@ AudioFileManager::KnownFile& AudioFileManager::findOrCreateKnown (const AudioFil
     if (auto kf = knownFiles[f.getHash()])
         return *kf;
 
-    auto kf = new KnownFile (f);
+    auto kf = new KnownFile (f, parseInfo (f));
     knownFiles.set (f.getHash(), kf);
     return *kf;
 }
@@ -652,12 +1090,29 @@ AudioFileInfo AudioFileManager::getInfo (const AudioFile& file)
     return findOrCreateKnown (file).info;
 }
 
+AudioFileInfo AudioFileManager::parseInfo (const AudioFile& file)
+{
+    AudioFileInfo info (engine);
+
+    if (! file.isNull() && infoCache->getInfo (file, info))
+        return info;
+
+    info = AudioFileInfo::parse (file);
+    infoCache->addInfo (file, info);
+    return info;
+}
+
+void AudioFileManager::saveInfoCache()
+{
+    infoCache->save();
+}
+
 bool AudioFileManager::checkFileTime (KnownFile& f)
 {
     if (! f.info.wasParsedOk
         || f.info.fileModificationTime != f.file.getFile().getLastModificationTime())
     {
-        f.info = AudioFileInfo::parse (f.file);
+        f.info = parseInfo (f.file);
         return true;
     }
 
@@ -680,6 +1135,9 @@ void AudioFileManager::checkFileForChanges (const AudioFile& file)
 
     if (changed)
     {
+        for (auto edit : engine.getActiveEdits().getEdits())
+            edit->getSourceFileCache().refresh (file.getFile());
+
         releaseFile (file);
         callListeners (file);
     }
@@ -700,6 +1158,10 @@ void AudioFileManager::checkFilesForChanges()
                     changedFiles.add (f->file);
     }
 
+    // Files may have been moved or deleted without their sources changing
+    for (auto edit : engine.getActiveEdits().getEdits())
+        edit->getSourceFileCache().refresh();
+
     for (auto& f : changedFiles)
     {
         releaseFile (f);
@@ -707,6 +1169,18 @@ void AudioFileManager::checkFilesForChanges()
     }
 }
 
+juce::int64 AudioFileManager::getThumbnailBytesInUse (const Edit* edit)
+{
+    const juce::ScopedLock sl (activeThumbnailLock);
+    juce::int64 total = 0;
+
+    for (auto t : activeThumbnails)
+        if (edit == nullptr || t->edit == edit)
+            total += (juce::int64) t->getNumBytesUsed();
+
+    return total;
+}
+
 void AudioFileManager::releaseAllFiles()
 {
     cache.releaseAllFiles();
@@ -748,11 +1222,15 @@ void AudioFileManager::forceFileUpdate (const AudioFile& file)
     TRACKTION_ASSERT_MESSAGE_THREAD
 
     // this doesn't check for file time and is used when files are changed rapidly such as when recording
+    for (auto edit : engine.getActiveEdits().getEdits())
+        edit->getSourceFileCache().refresh (file.getFile());
+
     const juce::ScopedLock sl (knownFilesLock);
 
     if (auto f = knownFiles[file.getHash()])
     {
         f->info = AudioFileInfo::parse (f->file);
+        infoCache->addInfo (f->file, f->info);
         releaseFile (file);
         callListeners (file);
     }
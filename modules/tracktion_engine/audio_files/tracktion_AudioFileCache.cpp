@@ -18,6 +18,101 @@ static void clearSetOfChannels (int** channels, int numChannels, int offset, int
             juce::FloatVectorOperations::clear (chan + offset, numSamples);
 }
 
+//==============================================================================
+/** The counters each file keeps for AudioFileCache::getStatistics.
+    These are updated from the audio and background threads so are all atomic.
+*/
+struct AudioFileCache::FileCounters
+{
+    std::atomic<juce::int64> numBlocksLoaded { 0 }, numReads { 0 }, numMisses { 0 }, numSlowReads { 0 };
+    std::atomic<juce::int64> worstReadTimeMicroseconds { 0 }, validationTimeMicroseconds { 0 };
+
+    void addRead (bool succeeded, juce::int64 microseconds, int timeoutMs) noexcept
+    {
+        ++numReads;
+
+        if (! succeeded)
+            ++numMisses;
+
+        if (microseconds > timeoutMs * (juce::int64) 1000)
+            ++numSlowReads;
+
+        auto worst = worstReadTimeMicroseconds.load();
+
+        while (microseconds > worst && ! worstReadTimeMicroseconds.compare_exchange_weak (worst, microseconds))
+        {}
+    }
+
+    void reset() noexcept
+    {
+        numBlocksLoaded = 0;
+        numReads = 0;
+        numMisses = 0;
+        numSlowReads = 0;
+        worstReadTimeMicroseconds = 0;
+        validationTimeMicroseconds = 0;
+    }
+
+    void fillIn (AudioFileCache::FileStatistics& stats) const noexcept
+    {
+        stats.numBlocksLoaded = numBlocksLoaded;
+        stats.numReads = numReads;
+        stats.numMisses = numMisses;
+        stats.numSlowReads = numSlowReads;
+        stats.worstReadTimeMs = (double) worstReadTimeMicroseconds.load() / 1000.0;
+        stats.validationTimeMs = (double) validationTimeMicroseconds.load() / 1000.0;
+    }
+};
+
+static juce::int64 getMicrosecondsSince (juce::int64 startTicks) noexcept
+{
+    const auto ticks = juce::Time::getHighResolutionTicks() - startTicks;
+    return (juce::int64) (juce::Time::highResolutionTicksToSeconds (ticks) * 1000000.0);
+}
+
+/** Returns roughly how many seconds it'll be before any of a file's clients get to it.
+    Clients that haven't reached the file yet have negative read positions.
+*/
+template <typename ClientArray, typename GetReadPositionFn>
+static double getTimeUntilNeeded (const ClientArray& clients, double sampleRate, GetReadPositionFn getReadPosition)
+{
+    auto soonest = std::numeric_limits<juce::int64>::max();
+
+    for (auto r : clients)
+        if (r->getReferenceCount() > 1)
+            soonest = std::min (soonest, std::max ((juce::int64) 0, -getReadPosition (*r)));
+
+    if (soonest == std::numeric_limits<juce::int64>::max())
+        return std::numeric_limits<double>::max();
+
+    return (double) soonest / (sampleRate > 0.0 ? sampleRate : 44100.0);
+}
+
+/** Returns some files ordered so that the ones that will be read soonest come first. */
+template <typename FileType>
+static juce::Array<FileType*> getFilesInOrderOfNeed (const juce::OwnedArray<FileType>& files)
+{
+    std::vector<std::pair<double, FileType*>> times;
+    times.reserve ((size_t) files.size());
+
+    for (auto f : files)
+        times.emplace_back (f->getTimeUntilNeeded(), f);
+
+    std::stable_sort (times.begin(), times.end(),
+                      [] (const std::pair<double, FileType*>& a, const std::pair<double, FileType*>& b)
+                      {
+                          return a.first < b.first;
+                      });
+
+    juce::Array<FileType*> result;
+    result.ensureStorageAllocated ((int) times.size());
+
+    for (auto& t : times)
+        result.add (t.second);
+
+    return result;
+}
+
 class AudioFileCache::CachedFile
 {
 public:
@@ -30,7 +125,7 @@ public:
             mapEntireFile = true;
     }
 
-    enum { readAheadSamples = 48000 };
+    enum { readAheadSamples = 48000, cueReadAheadSamples = 16384 };
 
     void touchFiles()
     {
@@ -47,11 +142,14 @@ public:
 
                 if (r->getReferenceCount() > 1 && readPos > -readAheadSamples)
                 {
+                    // The loop start is kept warm whenever there's a loop, so the wrap never misses
                     if (loopLength > 0)
-                        if (readPos + readAheadSamples > r->loopStart + loopLength)
-                            readPoints.addIfNotAlreadyThere (r->loopStart);
+                        readPoints.addIfNotAlreadyThere (r->loopStart);
 
                     readPoints.addIfNotAlreadyThere (std::max ((juce::int64) 0, readPos));
+
+                    for (int i = 0; i < r->numCuePositions.load(); ++i)
+                        readPoints.addIfNotAlreadyThere (std::max ((juce::int64) 0, r->cuePositions[i].load()));
                 }
             }
         }
@@ -145,8 +243,12 @@ public:
                         for (int i = start; i <= end; ++i)
                             blocksNeeded.addIfNotAlreadyThere (i);
 
-                        if (readPos + readAheadSamples > loopEnd)
-                            blocksNeeded.addIfNotAlreadyThere ((int) (loopStart / blockSize));
+                        // The loop start is pinned for as long as the loop is set, along with
+                        // however much of the read-ahead wraps around past the loop end
+                        auto wrapEnd = loopStart + std::max ((juce::int64) 0, std::min (loopLength, readPos + readAheadSamples - loopEnd));
+
+                        for (int i = (int) (loopStart / blockSize); i <= std::min (lastPossibleBlockIndex, (int) (wrapEnd / blockSize)); ++i)
+                            blocksNeeded.addIfNotAlreadyThere (i);
                     }
                     else
                     {
@@ -156,6 +258,21 @@ public:
                         for (int i = start; i <= end; ++i)
                             blocksNeeded.addIfNotAlreadyThere (i);
                     }
+
+                    // Keeps the places playback might jump to ready, so a relocate doesn't miss
+                    for (int c = 0; c < r->numCuePositions.load(); ++c)
+                    {
+                        auto cue = r->cuePositions[c].load();
+
+                        if (cue < 0 || cue >= info.lengthInSamples)
+                            continue;
+
+                        auto start = (int) (cue / blockSize);
+                        auto end   = std::min (lastPossibleBlockIndex, (int) ((cue + cueReadAheadSamples) / blockSize));
+
+                        for (int i = start; i <= end; ++i)
+                            blocksNeeded.addIfNotAlreadyThere (i);
+                    }
                 }
             }
         }
@@ -234,11 +351,12 @@ public:
         std::unique_ptr<juce::MemoryMappedAudioFormatReader> r (AudioFileUtils::createMemoryMappedReader (cache.engine, file.getFile(), af));
 
         if (r != nullptr
-             && (range != nullptr ? r->mapSectionOfFile (*range)
+             && (range != nullptr ? r->mapSectionOfFile (FloatAudioFormat::getMappableSection (*r, *range))
                                   : r->mapEntireFile())
              && ! r->getMappedSection().isEmpty())
         {
             totalBytesInUse += r->getNumBytesUsed();
+            ++counters.numBlocksLoaded;
             failedToOpenFile = false;
 
             info = AudioFileInfo (file, r.get(), af);
@@ -433,12 +551,33 @@ public:
         clients.add (r);
     }
 
+    double getTimeUntilNeeded() const
+    {
+        const juce::ScopedReadLock sl (clientListLock);
+        return tracktion_engine::getTimeUntilNeeded (clients, info.sampleRate,
+                                                     [] (const Reader& r) { return r.readPos.load(); });
+    }
+
+    /** Touches the pages the clients are about to read, unless another thread is already doing it. */
+    void touchFilesIfNotBusy()
+    {
+        bool expected = false;
+
+        if (isBeingTouched.compare_exchange_strong (expected, true))
+        {
+            touchFiles();
+            isBeingTouched = false;
+        }
+    }
+
     AudioFileCache& cache;
     AudioFile file;
     AudioFileInfo info;
 
     std::atomic<juce::uint32> lastReadTime { juce::Time::getApproximateMillisecondCounter() };
-    juce::int64 totalBytesInUse = 0;
+    std::atomic<juce::int64> totalBytesInUse { 0 };
+    std::atomic<bool> isBeingTouched { false };
+    FileCounters counters;
 
 private:
     juce::OwnedArray<juce::MemoryMappedAudioFormatReader> readers;
@@ -467,244 +606,1164 @@ private:
 };
 
 //==============================================================================
-class AudioFileCache::MapperThread   : public juce::Thread
+/**
+    A directory of decoded blocks that several processes can share.
+
+    Each block is written to its own file, named after the source file and the block's
+    index, and other processes memory-map these rather than decoding the block again, so
+    they share the pages too. Blocks are written to a temporary file and then renamed, so
+    a partly written block is never seen.
+
+    Whichever process gets the inter-process lock keeps the directory below its maximum
+    size by deleting the blocks that were used least recently. Blocks are touched each
+    time they're mapped, so a block that's in use by any process is less likely to go.
+    Unlinking a mapped file doesn't affect the processes that have it mapped.
+*/
+class AudioFileCache::SharedBlockStore
 {
 public:
-    MapperThread (AudioFileCache& c)
-       : juce::Thread ("CacheMapper"), owner (c)
+    SharedBlockStore (const juce::File& dir, juce::int64 maxSize)
+        : directory (dir), maxSizeBytes (maxSize),
+          purgeLock ("tracktion_blocks_" + juce::String::toHexString (dir.getFullPathName().hashCode64()))
     {
+        directory.createDirectory();
     }
 
-    ~MapperThread()
+    /** Returns a name for a file that changes if the file is modified. */
+    static juce::String getKey (const juce::File& f)
     {
-        stopThread (15000);
+        return juce::String::toHexString (f.getFullPathName().hashCode64())
+                + "_" + juce::String::toHexString (f.getLastModificationTime().toMilliseconds() ^ f.getSize());
     }
 
-    void run()
+    /** Maps a block if another process has written it, returning nullptr if it can't. */
+    std::unique_ptr<juce::MemoryMappedFile> loadBlock (const juce::String& key, int index,
+                                                       int numChannels, int numSamples) const
     {
-        juce::FloatVectorOperations::disableDenormalisedNumberSupport();
+        auto f = getBlockFile (key, index);
 
-        juce::uint32 lastOldFlePurge = 0;
+        if (! f.existsAsFile())
+            return {};
 
-        while (! threadShouldExit())
-        {
-            if (owner.serviceNextReader())
-                continue;
-
-            auto now = juce::Time::getApproximateMillisecondCounter();
-
-            if (now > lastOldFlePurge + 2000)
-            {
-                lastOldFlePurge = now;
-                owner.purgeOldFiles();
-                continue;
-            }
+        std::unique_ptr<juce::MemoryMappedFile> mapped (new juce::MemoryMappedFile (f, juce::MemoryMappedFile::readOnly));
+        auto header = static_cast<const juce::uint32*> (mapped->getData());
 
-            wait (20);
+        if (header == nullptr
+             || mapped->getSize() != getFileSize (numChannels, numSamples)
+             || header[0] != magicNumber
+             || header[1] != (juce::uint32) numChannels
+             || header[2] != (juce::uint32) numSamples)
+            return {};
 
-            //DBG ("Total cache mapping: " << owner.getBytesInUse() / (1024 * 1024) << " Mb");
-        }
+        f.setLastAccessTime (juce::Time::getCurrentTime());
+        return mapped;
     }
 
-    AudioFileCache& owner;
-};
-
-//==============================================================================
-class AudioFileCache::RefresherThread   : public juce::Thread
-{
-public:
-    RefresherThread (AudioFileCache& c)  : juce::Thread ("CacheRefresher"), owner (c)
+    static int* getSamples (const juce::MemoryMappedFile& mapped) noexcept
     {
+        return juce::addBytesToPointer (static_cast<int*> (mapped.getData()), headerSize);
     }
 
-    ~RefresherThread()
+    /** Writes a block so that other processes can use it. */
+    void saveBlock (const juce::String& key, int index, int numChannels, int numSamples, const int* samples) const
     {
-        stopThread (15000);
-    }
+        auto f = getBlockFile (key, index);
 
-    void run()
-    {
-        juce::FloatVectorOperations::disableDenormalisedNumberSupport();
+        if (f.existsAsFile())
+            return;
+
+        juce::TemporaryFile temp (f);
 
-        while (! threadShouldExit())
         {
-            {
-                const ScopedCpuMeter cpu (owner.cpuUsage, 0.2);
-                owner.touchReaders();
-            }
+            juce::FileOutputStream out (temp.getFile());
 
-            wait (TransportControl::getNumPlayingTransports (owner.engine) > 0 ? 10 : 250);
+            if (out.failedToOpen())
+                return;
+
+            const juce::uint32 header[headerSize / sizeof (juce::uint32)] = { magicNumber, (juce::uint32) numChannels,
+                                                                               (juce::uint32) numSamples, 0 };
+            out.write (header, sizeof (header));
+            out.write (samples, (size_t) numChannels * (size_t) numSamples * sizeof (int));
+            out.flush();
+
+            if (out.getStatus().failed())
+                return;
         }
-    }
 
-    AudioFileCache& owner;
-};
+        temp.overwriteTargetFileWithTemporary();
+    }
 
-//==============================================================================
-AudioFileCache::AudioFileCache (Engine& e)  : engine (e)
-{
-    CRASH_TRACER
-    const int defaultSize = 6 * 48000;
+    /** Deletes the least recently used blocks if the directory's too big.
+        This does nothing if another process is already doing it.
+    */
+    void purgeIfNeeded()
+    {
+        if (! purgeLock.enter (0))
+            return;
 
-    // TODO: when we drop 32-bit support, delete the cache size and related code
-    setCacheSizeSamples (engine.getPropertyStorage().getProperty (SettingID::cacheSizeSamples, defaultSize));
-}
+        juce::Array<juce::File> files;
+        directory.findChildFiles (files, juce::File::findFiles, false, juce::String ("*") + fileSuffix);
+        juce::int64 totalSize = 0;
 
-AudioFileCache::~AudioFileCache()
-{
-    CRASH_TRACER
-    stopThreads();
-    purgeOrphanReaders();
-    jassert (activeFiles.isEmpty());
-    activeFiles.clear();
-}
+        std::vector<std::pair<juce::Time, juce::File>> filesByAge;
+        filesByAge.reserve ((size_t) files.size());
 
-//==============================================================================
-void AudioFileCache::stopThreads()
-{
-    CRASH_TRACER
+        for (auto& f : files)
+        {
+            totalSize += f.getSize();
+            filesByAge.emplace_back (f.getLastAccessTime(), f);
+        }
 
-    if (mapperThread != nullptr)
-        mapperThread->signalThreadShouldExit();
+        if (totalSize > maxSizeBytes)
+        {
+            std::sort (filesByAge.begin(), filesByAge.end(),
+                       [] (const std::pair<juce::Time, juce::File>& a, const std::pair<juce::Time, juce::File>& b)
+                       {
+                           return a.first < b.first;
+                       });
 
-    if (refresherThread != nullptr)
-        refresherThread->signalThreadShouldExit();
+            for (auto& f : filesByAge)
+            {
+                if (totalSize <= maxSizeBytes)
+                    break;
 
-    mapperThread.reset();
-    refresherThread.reset();
-}
+                const auto size = f.second.getSize();
 
-void AudioFileCache::setCacheSizeSamples (juce::int64 samples)
-{
-    CRASH_TRACER
-    samples = juce::jlimit ((juce::int64) 48000, (juce::int64) 48000 * 60, samples);
+                if (f.second.deleteFile())
+                    totalSize -= size;
+            }
+        }
 
-    if (cacheSizeSamples != samples)
-    {
-        stopThreads();
+        purgeLock.exit();
+    }
 
-        cacheSizeSamples = samples;
-        engine.getPropertyStorage().setProperty (SettingID::cacheSizeSamples, (int) cacheSizeSamples);
+    const juce::File directory;
+    const juce::int64 maxSizeBytes;
 
-        {
-            const juce::ScopedWriteLock sl (fileListLock);
+private:
+    static constexpr juce::uint32 magicNumber = 0x31424554; // "TEB1"
+    static constexpr int headerSize = 16;
+    static constexpr const char* fileSuffix = ".tblk";
 
-            purgeOrphanReaders();
-            releaseAllFiles();
-        }
+    juce::InterProcessLock purgeLock;
 
-        mapperThread.reset (new MapperThread (*this));
-        mapperThread->startThread (5);
+    juce::File getBlockFile (const juce::String& key, int index) const
+    {
+        return directory.getChildFile (key + "_" + juce::String (index) + fileSuffix);
+    }
 
-        refresherThread.reset (new RefresherThread (*this));
-        refresherThread->startThread (6);
+    static juce::int64 getFileSize (int numChannels, int numSamples) noexcept
+    {
+        return headerSize + (juce::int64) numChannels * numSamples * (juce::int64) sizeof (int);
     }
-}
+
+    JUCE_DECLARE_NON_COPYABLE (SharedBlockStore)
+};
 
 //==============================================================================
-AudioFileCache::CachedFile* AudioFileCache::getOrCreateCachedFile (const AudioFile& f)
-{
-    for (auto s : activeFiles)
-        if (s->info.hashCode == f.getHash())
-            return s;
+/** Streams a file that can't be memory-mapped, e.g. a FLAC or Ogg file.
 
-    auto& manager = engine.getAudioFileFormatManager().memoryMappedFormatManager;
+    The file is decoded in blocks by the cache's decode threads, and the blocks are
+    shared between all of its readers. Blocks that haven't been read recently are
+    dropped when the cache goes over its limit, oldest first.
+*/
+class AudioFileCache::DecodedFile
+{
+public:
+    DecodedFile (AudioFileCache& c, const AudioFile& f, juce::AudioFormatReader* r)
+        : cache (c), file (f), info (f.getInfo()), decoder (r),
+          sharedBlockKey (SharedBlockStore::getKey (f.getFile()))
+    {
+        info.numChannels = (int) r->numChannels;
+        info.lengthInSamples = r->lengthInSamples;
+        info.sampleRate = r->sampleRate;
+        info.isFloatingPoint = r->usesFloatingPointData;
+    }
 
-    for (auto af : manager)
+    ~DecodedFile()
     {
-        if (af->canHandleFile (f.getFile()))
-        {
-            auto fs = new CachedFile (*this, f);
-            activeFiles.add (fs);
-            return fs;
-        }
+        jassert (numPendingJobs == 0);
     }
 
-    return {};
-}
+    enum { blockSize = 32768 };
 
-void AudioFileCache::releaseFile (const AudioFile& file)
-{
-    const juce::ScopedReadLock sl (fileListLock);
+    //==============================================================================
+    /** Queues any blocks the clients are about to read to be decoded. */
+    bool updateBlocks()
+    {
+        bool needToPurgeUnusedClients = false;
+        const auto lastPossibleBlockIndex = (int) ((info.lengthInSamples - 1) / blockSize);
+        const auto now = juce::Time::getApproximateMillisecondCounter();
+        juce::Array<int> blocksNeeded;
 
-    for (auto f : activeFiles)
-        if (f->file == file)
-            f->releaseReader();
-}
+        {
+            const juce::ScopedReadLock sl (clientListLock);
 
-void AudioFileCache::releaseAllFiles()
-{
-    CRASH_TRACER
-    const juce::ScopedReadLock sl (fileListLock);
+            for (auto r : clients)
+            {
+                if (r->getReferenceCount() <= 1)
+                {
+                    needToPurgeUnusedClients = true;
+                    continue;
+                }
 
-    for (auto f : activeFiles)
-        f->releaseReader();
-}
+                const auto readPos = r->readPos.load();
+                const auto loopStart = r->loopStart.load();
+                const auto loopLength = r->loopLength.load();
+                auto end = readPos + CachedFile::readAheadSamples + blockSize;
 
-void AudioFileCache::validateFile (const AudioFile& file)
-{
-    const juce::ScopedReadLock sl (fileListLock);
+                if (loopLength > 0)
+                {
+                    const auto loopEnd = loopStart + loopLength;
 
-    for (auto f : activeFiles)
-        if (f->file == file)
-            f->validateFile();
-}
+                    // The loop start is pinned for as long as the loop is set
+                    addBlocksNeeded (blocksNeeded, loopStart, loopStart + std::max ((juce::int64) 0, std::min (loopLength, end - loopEnd)),
+                                     lastPossibleBlockIndex);
 
-void AudioFileCache::purgeOldFiles()
-{
-    CRASH_TRACER
-    auto oldestAllowedTime = juce::Time::getApproximateMillisecondCounter() - 2000;
+                    end = std::min (end, loopEnd);
+                }
 
-    const juce::ScopedWriteLock sl (fileListLock);
+                addBlocksNeeded (blocksNeeded, readPos - 256, end, lastPossibleBlockIndex);
 
-    for (auto f :  activeFiles)
-        f->purgeOrphanReaders();
+                for (int c = 0; c < r->numCuePositions.load(); ++c)
+                {
+                    auto cue = r->cuePositions[c].load();
 
-    for (int i = activeFiles.size(); --i >= 0;)
-    {
-        auto f = activeFiles.getUnchecked (i);
+                    if (cue >= 0)
+                        addBlocksNeeded (blocksNeeded, cue, cue + CachedFile::cueReadAheadSamples, lastPossibleBlockIndex);
+                }
+            }
+        }
 
-        if (f->lastReadTime < oldestAllowedTime && f->isUnused())
-            activeFiles.remove (i);
-    }
-}
+        if (needToPurgeUnusedClients)
+            purgeOrphanReaders();
 
-bool AudioFileCache::serviceNextReader()
-{
-    const juce::ScopedReadLock sl (fileListLock);
+        bool anythingQueued = false;
 
-    for (int i = activeFiles.size(); --i >= 0;)
-    {
-        if (++nextFileToService >= activeFiles.size())
-            nextFileToService = 0;
+        {
+            // Mark the blocks as used so they won't be purged before they're read
+            const juce::ScopedReadLock sl (blockLock);
 
-        auto* f = activeFiles.getUnchecked (nextFileToService);
+            for (auto b : blocks)
+                if (blocksNeeded.contains (b->index))
+                    b->lastUsed = now;
+        }
 
-        if (f->updateBlocks())
-            return true;
+        for (auto index : blocksNeeded)
+            if (queueBlock (index))
+                anythingQueued = true;
+
+        return anythingQueued;
     }
 
-    return false;
-}
+    /** Queues a block to be decoded if it isn't already decoded or queued. */
+    bool queueBlock (int index)
+    {
+        if (hasBlock (index))
+            return false;
 
-void AudioFileCache::touchReaders()
-{
-    juce::int64 totalBytes = 0;
+        {
+            const juce::ScopedLock sl (pendingLock);
 
-    const juce::ScopedReadLock sl (fileListLock);
+            if (pendingBlocks.contains (index))
+                return false;
 
-    for (auto f : activeFiles)
-    {
-        f->touchFiles();
-        totalBytes += f->totalBytesInUse;
+            pendingBlocks.add (index);
+        }
+
+        ++numPendingJobs;
+        cache.decodeThreadPool.addJob (new DecodeJob (*this, index), true);
+        return true;
     }
 
-    totalBytesUsed = totalBytes;
-}
+    bool hasBlock (int index) const
+    {
+        const juce::ScopedReadLock sl (blockLock);
+        return findBlock (index) != nullptr;
+    }
 
-bool AudioFileCache::hasCacheMissed (bool clearMissedFlag)
-{
-    const bool didMiss = cacheMissed;
+    //==============================================================================
+    bool read (juce::int64 startSample, int** destSamples, int numDestChannels,
+               int startOffsetInDestBuffer, int numSamples, int timeoutMs)
+    {
+        jassert (destSamples != nullptr);
+        jassert (startSample >= 0);
+
+        bool allDataRead = true;
+
+        while (numSamples > 0)
+        {
+            if (startSample >= info.lengthInSamples)
+            {
+                clearSetOfChannels (destSamples, numDestChannels, startOffsetInDestBuffer, numSamples);
+                break;
+            }
+
+            const auto blockIndex = (int) (startSample / blockSize);
+            const auto blockStart = blockIndex * (juce::int64) blockSize;
+            const auto offsetInBlock = (int) (startSample - blockStart);
+            const LockedBlockFinder l (*this, blockIndex, timeoutMs);
+            SCOPED_REALTIME_CHECK
+
+            if (l.block == nullptr)
+            {
+                allDataRead = false;
+                clearSetOfChannels (destSamples, numDestChannels, startOffsetInDestBuffer, numSamples);
+                DBG ("*** Cache miss");
+                break;
+            }
+
+            const auto numThisTime = std::min (numSamples, l.block->numSamples - offsetInBlock);
+            l.block->lastUsed = juce::Time::getApproximateMillisecondCounter();
+
+            for (int i = 0; i < numDestChannels; ++i)
+            {
+                if (auto dest = destSamples[i])
+                {
+                    if (i < info.numChannels)
+                        memcpy (dest + startOffsetInDestBuffer, l.block->getChannel (i) + offsetInBlock, (size_t) numThisTime * sizeof (int));
+                    else
+                        juce::zeromem (dest + startOffsetInDestBuffer, (size_t) numThisTime * sizeof (int));
+                }
+            }
+
+            startSample += numThisTime;
+            startOffsetInDestBuffer += numThisTime;
+            numSamples -= numThisTime;
+        }
+
+        lastReadTime = juce::Time::getApproximateMillisecondCounter();
+        return allDataRead;
+    }
+
+    bool getRange (juce::int64 startSample, int numSamples,
+                   float& lmax, float& lmin, float& rmax, float& rmin,
+                   const int timeoutMs)
+    {
+        jassert (startSample >= 0);
+        bool allDataRead = true, isFirst = true;
+        lmin = lmax = rmin = rmax = 0;
+
+        while (numSamples > 0 && startSample < info.lengthInSamples)
+        {
+            const auto blockIndex = (int) (startSample / blockSize);
+            const auto offsetInBlock = (int) (startSample - blockIndex * (juce::int64) blockSize);
+            const LockedBlockFinder l (*this, blockIndex, timeoutMs);
+
+            if (l.block == nullptr)
+            {
+                allDataRead = false;
+                break;
+            }
+
+            const auto numThisTime = std::min (numSamples, l.block->numSamples - offsetInBlock);
+            l.block->lastUsed = juce::Time::getApproximateMillisecondCounter();
+
+            float lmin2, lmax2, rmin2, rmax2;
+            l.block->getRange (info.isFloatingPoint, 0, offsetInBlock, numThisTime, lmin2, lmax2);
+
+            if (info.numChannels > 1)
+                l.block->getRange (info.isFloatingPoint, 1, offsetInBlock, numThisTime, rmin2, rmax2);
+            else
+                rmin2 = lmin2, rmax2 = lmax2;
+
+            if (isFirst)
+            {
+                isFirst = false;
+                lmin = lmin2; lmax = lmax2;
+                rmin = rmin2; rmax = rmax2;
+            }
+            else
+            {
+                lmin = std::min (lmin, lmin2);
+                lmax = std::max (lmax, lmax2);
+                rmin = std::min (rmin, rmin2);
+                rmax = std::max (rmax, rmax2);
+            }
+
+            startSample += numThisTime;
+            numSamples -= numThisTime;
+        }
+
+        lastReadTime = juce::Time::getApproximateMillisecondCounter();
+        return allDataRead;
+    }
+
+    //==============================================================================
+    void addClient (Reader* r)
+    {
+        juce::ScopedWriteLock sl (clientListLock);
+        clients.add (r);
+    }
+
+    double getTimeUntilNeeded() const
+    {
+        const juce::ScopedReadLock sl (clientListLock);
+        return tracktion_engine::getTimeUntilNeeded (clients, info.sampleRate,
+                                                     [] (const Reader& r) { return r.readPos.load(); });
+    }
+
+    void purgeOrphanReaders()
+    {
+        const juce::ScopedWriteLock sl (clientListLock);
+
+        for (int i = clients.size(); --i >= 0;)
+            if (clients.getObjectPointerUnchecked (i)->getReferenceCount() <= 1)
+                clients.remove (i);
+    }
+
+    bool isUnused() const
+    {
+        return clients.isEmpty() && numPendingJobs == 0;
+    }
+
+    /** Drops the decoded blocks and the decoder so the file is opened again, e.g. if it's changed. */
+    void releaseReader()
+    {
+        {
+            const juce::ScopedLock sl (decoderLock);
+            decoder.reset();
+        }
+
+        const juce::ScopedWriteLock sl (blockLock);
+        blocks.clear();
+        totalBytesInUse = 0;
+    }
+
+    void validateFile()
+    {
+        const juce::ScopedLock sl (decoderLock);
+        failedToOpenFile = false;
+    }
+
+    /** Adds the times the blocks were last read to a list of candidates for purging. */
+    void getBlockUsage (std::vector<std::tuple<juce::uint32, DecodedFile*, int>>& usage) const
+    {
+        const juce::ScopedReadLock sl (blockLock);
+
+        for (auto b : blocks)
+            usage.emplace_back (b->lastUsed.load(), const_cast<DecodedFile*> (this), b->index);
+    }
+
+    void removeBlock (int index)
+    {
+        const juce::ScopedWriteLock sl (blockLock);
+
+        for (int i = blocks.size(); --i >= 0;)
+        {
+            if (blocks.getUnchecked (i)->index == index)
+            {
+                totalBytesInUse -= blocks.getUnchecked (i)->getNumBytes();
+                blocks.remove (i);
+                return;
+            }
+        }
+    }
+
+    AudioFileCache& cache;
+    AudioFile file;
+    AudioFileInfo info;
+
+    std::atomic<juce::uint32> lastReadTime { juce::Time::getApproximateMillisecondCounter() };
+    std::atomic<juce::int64> totalBytesInUse { 0 };
+    FileCounters counters;
+
+private:
+    //==============================================================================
+    /** A block of samples in the file's native format, i.e. left-justified ints or floats. */
+    struct Block
+    {
+        Block (int blockIndex, int numChans, int num)
+            : index (blockIndex), numChannels (numChans), numSamples (num),
+              data ((size_t) (numChans * num)), samples (data.get())
+        {
+        }
+
+        /** Creates a block from one that's been mapped from a SharedBlockStore. */
+        Block (int blockIndex, int numChans, int num, std::unique_ptr<juce::MemoryMappedFile> mapped)
+            : index (blockIndex), numChannels (numChans), numSamples (num),
+              mappedFile (std::move (mapped)), samples (SharedBlockStore::getSamples (*mappedFile))
+        {
+        }
+
+        // Mapped blocks are read-only, so only the channels of blocks that have just been
+        // created with the first constructor can be written to
+        int* getChannel (int channel) const noexcept    { return samples + channel * numSamples; }
+        juce::int64 getNumBytes() const noexcept        { return (juce::int64) numChannels * numSamples * (juce::int64) sizeof (int); }
+
+        void getRange (bool isFloatingPoint, int channel, int start, int num, float& low, float& high) const noexcept
+        {
+            auto chan = getChannel (channel) + start;
+
+            if (isFloatingPoint)
+            {
+                auto r = juce::FloatVectorOperations::findMinAndMax ((const float*) chan, num);
+                low = r.getStart();
+                high = r.getEnd();
+            }
+            else
+            {
+                auto r = juce::Range<int>::findMinAndMax (chan, num);
+                low  = r.getStart() / (float) 0x7fffffff;
+                high = r.getEnd()   / (float) 0x7fffffff;
+            }
+        }
+
+        const int index, numChannels, numSamples;
+        juce::HeapBlock<int> data;
+        std::unique_ptr<juce::MemoryMappedFile> mappedFile;
+        int* const samples;
+        std::atomic<juce::uint32> lastUsed { juce::Time::getApproximateMillisecondCounter() };
+
+        JUCE_DECLARE_NON_COPYABLE (Block)
+    };
+
+    struct DecodeJob  : public juce::ThreadPoolJob
+    {
+        DecodeJob (DecodedFile& f, int index)
+            : juce::ThreadPoolJob ("Decode " + f.file.getFile().getFileName()), owner (f), blockIndex (index)
+        {
+        }
+
+        JobStatus runJob() override
+        {
+            owner.decodeBlock (blockIndex);
+
+            {
+                const juce::ScopedLock sl (owner.pendingLock);
+                owner.pendingBlocks.removeFirstMatchingValue (blockIndex);
+            }
+
+            --owner.numPendingJobs;
+            return jobHasFinished;
+        }
+
+        DecodedFile& owner;
+        const int blockIndex;
+    };
+
+    struct LockedBlockFinder
+    {
+        LockedBlockFinder (DecodedFile& f, int blockIndex, int timeoutMs)  : lock (f.blockLock)
+        {
+            bool hasDecoded = false;
+            juce::uint32 startTime = 0;
+
+            for (;;)
+            {
+                if (lock.tryEnterRead())
+                {
+                    block = f.findBlock (blockIndex);
+
+                    if (block != nullptr)
+                        return;
+
+                    lock.exitRead();
+                }
+
+                if (timeoutMs < 0)
+                {
+                    if (hasDecoded)
+                        break;
+
+                    // Callers that can block decode the block themselves
+                    f.decodeBlock (blockIndex);
+                    hasDecoded = true;
+                    continue;
+                }
+
+                if (timeoutMs == 0)
+                    break;
+
+                auto now = juce::Time::getMillisecondCounter();
+
+                if (startTime == 0)
+                {
+                    startTime = now;
+
+                    // Make sure it's on its way rather than waiting for the mapper thread
+                    if (timeoutMs > 50)
+                        f.queueBlock (blockIndex);
+                }
+
+                const int elapsed = (int) (now - startTime);
+
+                if (elapsed > timeoutMs)
+                    break;
+
+                if (elapsed > 0)
+                    juce::Thread::yield();
+            }
+
+            block = nullptr;
+        }
+
+        ~LockedBlockFinder()
+        {
+            if (block != nullptr)
+                lock.exitRead();
+        }
+
+        Block* block = nullptr;
+        juce::ReadWriteLock& lock;
+
+        JUCE_DECLARE_NON_COPYABLE (LockedBlockFinder)
+    };
+
+    juce::CriticalSection decoderLock, pendingLock;
+    std::unique_ptr<juce::AudioFormatReader> decoder;
+    const juce::String sharedBlockKey;
+    bool failedToOpenFile = false;
+    juce::uint32 lastFailedOpenAttempt = 0;
+
+    juce::ReadWriteLock blockLock, clientListLock;
+    juce::OwnedArray<Block> blocks;
+    juce::ReferenceCountedArray<Reader> clients;
+
+    juce::Array<int> pendingBlocks;
+    std::atomic<int> numPendingJobs { 0 };
+
+    static void addBlocksNeeded (juce::Array<int>& blocksNeeded, juce::int64 start, juce::int64 end, int lastPossibleBlockIndex)
+    {
+        const auto first = std::max (0, (int) (std::max ((juce::int64) 0, start) / blockSize));
+        const auto last  = std::min (lastPossibleBlockIndex, (int) (std::max ((juce::int64) 0, end) / blockSize));
+
+        for (int i = first; i <= last; ++i)
+            blocksNeeded.addIfNotAlreadyThere (i);
+    }
+
+    Block* findBlock (int index) const
+    {
+        for (auto b : blocks)
+            if (b->index == index)
+                return b;
+
+        return {};
+    }
+
+    void decodeBlock (int index)
+    {
+        CRASH_TRACER
+        const juce::ScopedLock sl (decoderLock);
+
+        // Another thread may have decoded it while this one was waiting for the lock
+        if (hasBlock (index))
+            return;
+
+        const auto start = index * (juce::int64) blockSize;
+        const auto numSamples = (int) std::min ((juce::int64) blockSize, info.lengthInSamples - start);
+
+        if (numSamples <= 0)
+            return;
+
+        auto sharedStore = cache.getSharedBlockStore();
+
+        if (sharedStore != nullptr)
+        {
+            if (auto mapped = sharedStore->loadBlock (sharedBlockKey, index, info.numChannels, numSamples))
+            {
+                addBlock (new Block (index, info.numChannels, numSamples, std::move (mapped)));
+                return;
+            }
+        }
+
+        if (decoder == nullptr)
+        {
+            if (failedToOpenFile
+                 && juce::Time::getApproximateMillisecondCounter() < lastFailedOpenAttempt + 4000)
+                return;
+
+            decoder.reset (AudioFileUtils::createReaderFor (cache.engine, file.getFile()));
+
+            if (decoder == nullptr)
+            {
+                failedToOpenFile = true;
+                lastFailedOpenAttempt = juce::Time::getApproximateMillisecondCounter();
+                return;
+            }
+
+            failedToOpenFile = false;
+        }
+
+        std::unique_ptr<Block> block (new Block (index, info.numChannels, numSamples));
+
+        int* chans[64] = {};
+        const auto numChans = std::min (info.numChannels, (int) juce::numElementsInArray (chans));
+
+        for (int i = 0; i < numChans; ++i)
+            chans[i] = block->getChannel (i);
+
+        // When blocks are decoded in order the reader carries on from where it was, otherwise
+        // it uses the format's own seeking, e.g. a FLAC file's seek table
+        if (! decoder->read (chans, numChans, start, numSamples, false))
+            return;
+
+        if (sharedStore != nullptr)
+            sharedStore->saveBlock (sharedBlockKey, index, info.numChannels, numSamples, block->samples);
+
+        addBlock (block.release());
+    }
+
+    void addBlock (Block* block)
+    {
+        const auto numBytes = block->getNumBytes();
+
+        {
+            const juce::ScopedWriteLock bl (blockLock);
+            blocks.add (block);
+        }
+
+        totalBytesInUse += numBytes;
+        ++counters.numBlocksLoaded;
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DecodedFile)
+};
+
+//==============================================================================
+class AudioFileCache::MapperThread   : public juce::Thread
+{
+public:
+    MapperThread (AudioFileCache& c)
+       : juce::Thread ("CacheMapper"), owner (c)
+    {
+    }
+
+    ~MapperThread()
+    {
+        stopThread (15000);
+    }
+
+    void run()
+    {
+        juce::FloatVectorOperations::disableDenormalisedNumberSupport();
+
+        juce::uint32 lastOldFlePurge = 0, lastSharedBlockPurge = 0;
+
+        while (! threadShouldExit())
+        {
+            if (owner.serviceNextReader())
+                continue;
+
+            auto now = juce::Time::getApproximateMillisecondCounter();
+
+            if (now > lastOldFlePurge + 2000)
+            {
+                lastOldFlePurge = now;
+                owner.purgeOldFiles();
+                continue;
+            }
+
+            owner.purgeDecodedBlocks (owner.decodedCacheSizeBytes);
+
+            if (now > lastSharedBlockPurge + 10000)
+            {
+                lastSharedBlockPurge = now;
+
+                if (auto store = owner.getSharedBlockStore())
+                    store->purgeIfNeeded();
+            }
+
+            wait (20);
+
+            //DBG ("Total cache mapping: " << owner.getBytesInUse() / (1024 * 1024) << " Mb");
+        }
+    }
+
+    AudioFileCache& owner;
+};
+
+//==============================================================================
+class AudioFileCache::RefresherThread   : public juce::Thread
+{
+public:
+    RefresherThread (AudioFileCache& c)  : juce::Thread ("CacheRefresher"), owner (c)
+    {
+    }
+
+    ~RefresherThread()
+    {
+        stopThread (15000);
+    }
+
+    void run()
+    {
+        juce::FloatVectorOperations::disableDenormalisedNumberSupport();
+
+        while (! threadShouldExit())
+        {
+            {
+                const ScopedCpuMeter cpu (owner.cpuUsage, 0.2);
+                owner.touchReaders();
+            }
+
+            wait (TransportControl::getNumPlayingTransports (owner.engine) > 0 ? 10 : 250);
+        }
+    }
+
+    AudioFileCache& owner;
+};
+
+//==============================================================================
+AudioFileCache::AudioFileCache (Engine& e)  : engine (e)
+{
+    CRASH_TRACER
+    const int defaultSize = 6 * 48000;
+
+    // TODO: when we drop 32-bit support, delete the cache size and related code
+    setCacheSizeSamples (engine.getPropertyStorage().getProperty (SettingID::cacheSizeSamples, defaultSize));
+}
+
+AudioFileCache::~AudioFileCache()
+{
+    CRASH_TRACER
+    stopThreads();
+    purgeOrphanReaders();
+    jassert (activeFiles.isEmpty() && decodedFiles.isEmpty());
+    activeFileIndex.clear();
+    decodedFileIndex.clear();
+    activeFiles.clear();
+    decodedFiles.clear();
+}
+
+//==============================================================================
+void AudioFileCache::stopThreads()
+{
+    CRASH_TRACER
+
+    if (mapperThread != nullptr)
+        mapperThread->signalThreadShouldExit();
+
+    for (auto t : refresherThreads)
+        t->signalThreadShouldExit();
+
+    mapperThread.reset();
+    refresherThreads.clear();
+
+    decodeThreadPool.removeAllJobs (true, 10000);
+}
+
+void AudioFileCache::setCacheSizeSamples (juce::int64 samples)
+{
+    CRASH_TRACER
+    samples = juce::jlimit ((juce::int64) 48000, (juce::int64) 48000 * 60, samples);
+
+    if (cacheSizeSamples != samples)
+    {
+        stopThreads();
+
+        cacheSizeSamples = samples;
+        engine.getPropertyStorage().setProperty (SettingID::cacheSizeSamples, (int) cacheSizeSamples);
+
+        {
+            const juce::ScopedWriteLock sl (fileListLock);
+
+            purgeOrphanReaders();
+            releaseAllFiles();
+        }
+
+        mapperThread.reset (new MapperThread (*this));
+        mapperThread->startThread (5);
+
+        // Several of these run so that a file on slow storage only holds up one of them
+        for (int i = 0; i < numRefresherThreads; ++i)
+        {
+            auto t = refresherThreads.add (new RefresherThread (*this));
+            t->startThread (6);
+        }
+    }
+}
+
+//==============================================================================
+AudioFileCache::CachedFile* AudioFileCache::findCachedFile (const AudioFile& f) const
+{
+    auto found = activeFileIndex.find (f.getHash());
+    return found != activeFileIndex.end() ? found->second : nullptr;
+}
+
+AudioFileCache::DecodedFile* AudioFileCache::findDecodedFile (const AudioFile& f) const
+{
+    auto found = decodedFileIndex.find (f.getHash());
+    return found != decodedFileIndex.end() ? found->second : nullptr;
+}
+
+AudioFileCache::CachedFile* AudioFileCache::createCachedFile (const AudioFile& f)
+{
+    auto& manager = engine.getAudioFileFormatManager().memoryMappedFormatManager;
+
+    for (auto af : manager)
+        if (af->canHandleFile (f.getFile()))
+            return new CachedFile (*this, f);
+
+    return {};
+}
+
+AudioFileCache::DecodedFile* AudioFileCache::createDecodedFile (const AudioFile& f)
+{
+    if (auto reader = AudioFileUtils::createReaderFor (engine, f.getFile()))
+        return new DecodedFile (*this, f, reader);
+
+    return {};
+}
+
+void AudioFileCache::releaseFile (const AudioFile& file)
+{
+    const juce::ScopedReadLock sl (fileListLock);
+
+    if (auto f = findCachedFile (file))
+        f->releaseReader();
+
+    if (auto f = findDecodedFile (file))
+        f->releaseReader();
+}
+
+void AudioFileCache::releaseAllFiles()
+{
+    CRASH_TRACER
+    const juce::ScopedReadLock sl (fileListLock);
+
+    for (auto f : activeFiles)
+        f->releaseReader();
+
+    for (auto f : decodedFiles)
+        f->releaseReader();
+}
+
+void AudioFileCache::validateFile (const AudioFile& file)
+{
+    const juce::ScopedReadLock sl (fileListLock);
+
+    if (auto f = findCachedFile (file))
+    {
+        const auto startTicks = juce::Time::getHighResolutionTicks();
+        f->validateFile();
+        f->counters.validationTimeMicroseconds += getMicrosecondsSince (startTicks);
+    }
+
+    if (auto f = findDecodedFile (file))
+    {
+        const auto startTicks = juce::Time::getHighResolutionTicks();
+        f->validateFile();
+        f->counters.validationTimeMicroseconds += getMicrosecondsSince (startTicks);
+    }
+}
+
+void AudioFileCache::setSharedBlockDirectory (const juce::File& dir, juce::int64 maxSizeBytes)
+{
+    std::shared_ptr<SharedBlockStore> newStore;
+
+    if (dir != juce::File())
+        newStore = std::make_shared<SharedBlockStore> (dir, maxSizeBytes);
+
+    const juce::ScopedLock sl (sharedBlockStoreLock);
+    sharedBlockStore = std::move (newStore);
+}
+
+juce::File AudioFileCache::getSharedBlockDirectory() const
+{
+    if (auto store = getSharedBlockStore())
+        return store->directory;
+
+    return {};
+}
+
+std::shared_ptr<AudioFileCache::SharedBlockStore> AudioFileCache::getSharedBlockStore() const
+{
+    const juce::ScopedLock sl (sharedBlockStoreLock);
+    return sharedBlockStore;
+}
+
+void AudioFileCache::setDecodedCacheSizeBytes (juce::int64 numBytes)
+{
+    decodedCacheSizeBytes = std::max ((juce::int64) 16 * 1024 * 1024, numBytes);
+}
+
+juce::int64 AudioFileCache::releaseDecodedBlocks (juce::int64 bytesToFree)
+{
+    CRASH_TRACER
+    const auto before = getDecodedBytesInUseNow();
+    purgeDecodedBlocks (std::max ((juce::int64) 0, before - bytesToFree));
+
+    const auto after = getDecodedBytesInUseNow();
+    decodedBytesUsed = after;
+    return std::max ((juce::int64) 0, before - after);
+}
+
+juce::int64 AudioFileCache::releaseUnusedFiles()
+{
+    CRASH_TRACER
+    const auto before = getMappedBytesInUseNow();
+    purgeOldFiles (500);
+
+    const auto after = getMappedBytesInUseNow();
+    mappedBytesUsed = after;
+    return std::max ((juce::int64) 0, before - after);
+}
+
+juce::int64 AudioFileCache::getMappedBytesInUseNow() const
+{
+    const juce::ScopedReadLock sl (fileListLock);
+    juce::int64 total = 0;
+
+    for (auto f : activeFiles)
+        total += f->totalBytesInUse;
+
+    return total;
+}
+
+juce::int64 AudioFileCache::getDecodedBytesInUseNow() const
+{
+    const juce::ScopedReadLock sl (fileListLock);
+    juce::int64 total = 0;
+
+    for (auto f : decodedFiles)
+        total += f->totalBytesInUse;
+
+    return total;
+}
+
+void AudioFileCache::purgeDecodedBlocks (juce::int64 maxBytes)
+{
+    CRASH_TRACER
+    const juce::ScopedReadLock sl (fileListLock);
+
+    juce::int64 totalBytes = 0;
+
+    for (auto f : decodedFiles)
+        totalBytes += f->totalBytesInUse;
+
+    if (totalBytes <= maxBytes)
+        return;
+
+    std::vector<std::tuple<juce::uint32, DecodedFile*, int>> usage;
+
+    for (auto f : decodedFiles)
+        f->getBlockUsage (usage);
+
+    std::sort (usage.begin(), usage.end(),
+               [] (const std::tuple<juce::uint32, DecodedFile*, int>& a, const std::tuple<juce::uint32, DecodedFile*, int>& b)
+               {
+                   return std::get<0> (a) < std::get<0> (b);
+               });
+
+    // Don't drop anything that's been read or asked for very recently
+    const auto oldestAllowedTime = juce::Time::getApproximateMillisecondCounter() - 1000;
+
+    for (auto& u : usage)
+    {
+        if (totalBytes <= maxBytes || std::get<0> (u) > oldestAllowedTime)
+            break;
+
+        auto f = std::get<1> (u);
+        const auto bytesBefore = f->totalBytesInUse.load();
+        f->removeBlock (std::get<2> (u));
+        totalBytes -= bytesBefore - f->totalBytesInUse.load();
+    }
+}
+
+void AudioFileCache::purgeOldFiles (juce::uint32 minTimeSinceLastReadMs)
+{
+    CRASH_TRACER
+    auto oldestAllowedTime = juce::Time::getApproximateMillisecondCounter() - minTimeSinceLastReadMs;
+    bool anyToRemove = false;
+
+    {
+        // Each file has its own lock for its clients, so this only needs the read lock and
+        // the write lock is only taken if there's actually something to remove
+        const juce::ScopedReadLock sl (fileListLock);
+
+        for (auto f : activeFiles)
+        {
+            f->purgeOrphanReaders();
+            anyToRemove = anyToRemove || (f->lastReadTime < oldestAllowedTime && f->isUnused());
+        }
+
+        for (auto f : decodedFiles)
+        {
+            f->purgeOrphanReaders();
+            anyToRemove = anyToRemove || (f->lastReadTime < oldestAllowedTime && f->isUnused());
+        }
+    }
+
+    if (! anyToRemove)
+        return;
+
+    const juce::ScopedWriteLock sl (fileListLock);
+
+    // A reader may have been created for one of them in the meantime, so check again
+    for (int i = activeFiles.size(); --i >= 0;)
+    {
+        auto f = activeFiles.getUnchecked (i);
+
+        if (f->lastReadTime < oldestAllowedTime && f->isUnused())
+        {
+            activeFileIndex.erase (f->file.getHash());
+            activeFiles.remove (i);
+        }
+    }
+
+    for (int i = decodedFiles.size(); --i >= 0;)
+    {
+        auto f = decodedFiles.getUnchecked (i);
+
+        if (f->lastReadTime < oldestAllowedTime && f->isUnused())
+        {
+            decodedFileIndex.erase (f->file.getHash());
+            decodedFiles.remove (i);
+        }
+    }
+}
+
+bool AudioFileCache::serviceNextReader()
+{
+    const juce::ScopedReadLock sl (fileListLock);
+
+    // Service the files that will be read soonest first so one that's just about to play
+    // isn't kept waiting behind ones that won't be needed for minutes. A few are done per
+    // call so the order is still fairly fresh and the lock isn't held for too long.
+    constexpr int maxFilesPerCall = 8;
+    int numServiced = 0;
+
+    for (auto f : getFilesInOrderOfNeed (activeFiles))
+        if (f->updateBlocks())
+            if (++numServiced >= maxFilesPerCall)
+                break;
+
+    if (numServiced > 0)
+        return true;
+
+    // These only queue jobs for the decode threads so they can all be done at once
+    bool anythingQueued = false;
+
+    for (auto f : getFilesInOrderOfNeed (decodedFiles))
+        if (f->updateBlocks())
+            anythingQueued = true;
+
+    return anythingQueued;
+}
+
+void AudioFileCache::touchReaders()
+{
+    juce::int64 mappedBytes = 0, decodedBytes = 0;
+
+    const juce::ScopedReadLock sl (fileListLock);
+
+    for (auto f : getFilesInOrderOfNeed (activeFiles))
+    {
+        f->touchFilesIfNotBusy();
+        mappedBytes += f->totalBytesInUse;
+    }
+
+    for (auto f : decodedFiles)
+        decodedBytes += f->totalBytesInUse;
+
+    mappedBytesUsed = mappedBytes;
+    decodedBytesUsed = decodedBytes;
+}
+
+bool AudioFileCache::hasCacheMissed (bool clearMissedFlag)
+{
+    const bool didMiss = cacheMissed;
 
     if (clearMissedFlag)
         cacheMissed = false;
@@ -712,25 +1771,115 @@ bool AudioFileCache::hasCacheMissed (bool clearMissedFlag)
     return didMiss;
 }
 
+AudioFileCache::Statistics AudioFileCache::getStatistics() const
+{
+    Statistics stats;
+    stats.totalNumReads = totalNumReads;
+    stats.totalNumMisses = totalNumMisses;
+    stats.cpuUsage = cpuUsage;
+
+    const juce::ScopedReadLock sl (fileListLock);
+    stats.files.ensureStorageAllocated (activeFiles.size() + decodedFiles.size());
+
+    auto addFile = [&stats] (const AudioFile& file, const FileCounters& counters, juce::int64 bytesInUse, bool isDecoded)
+    {
+        FileStatistics fs;
+        fs.file = file.getFile();
+        fs.isDecoded = isDecoded;
+        fs.bytesInUse = bytesInUse;
+        counters.fillIn (fs);
+
+        stats.totalBytesInUse += bytesInUse;
+        stats.files.add (fs);
+    };
+
+    for (auto f : activeFiles)
+        addFile (f->file, f->counters, f->totalBytesInUse, false);
+
+    for (auto f : decodedFiles)
+        addFile (f->file, f->counters, f->totalBytesInUse, true);
+
+    return stats;
+}
+
+void AudioFileCache::resetStatistics()
+{
+    totalNumReads = 0;
+    totalNumMisses = 0;
+
+    const juce::ScopedReadLock sl (fileListLock);
+
+    for (auto f : activeFiles)
+        f->counters.reset();
+
+    for (auto f : decodedFiles)
+        f->counters.reset();
+}
+
 //==============================================================================
 AudioFileCache::Reader::Ptr AudioFileCache::createReader (const AudioFile& file)
 {
     CRASH_TRACER
+
+    {
+        // Most readers are for files that are already open, and files can't be removed while
+        // the read lock is held, so these don't have to wait for each other
+        const juce::ScopedReadLock sl (fileListLock);
+
+        if (auto r = createReaderForOpenFile (file))
+            return r;
+    }
+
+    // Opening a file can be slow, so do it before taking the write lock
+    std::unique_ptr<CachedFile> newCachedFile (createCachedFile (file));
+    std::unique_ptr<DecodedFile> newDecodedFile;
+
+    if (newCachedFile == nullptr)
+    {
+        newDecodedFile.reset (createDecodedFile (file));
+
+        if (newDecodedFile == nullptr)
+            return {};
+    }
+
     const juce::ScopedWriteLock sl (fileListLock);
 
-    if (auto f = getOrCreateCachedFile (file))
+    // Another thread may have opened it in the meantime
+    if (auto r = createReaderForOpenFile (file))
+        return r;
+
+    if (newCachedFile != nullptr)
     {
+        auto f = activeFiles.add (newCachedFile.release());
+        activeFileIndex[file.getHash()] = f;
+
         auto r = new Reader (*this, f, nullptr);
         f->addClient (r);
         return r;
     }
 
-    if (auto reader = AudioFileUtils::createReaderFor (engine, file.getFile()))
+    auto f = decodedFiles.add (newDecodedFile.release());
+    decodedFileIndex[file.getHash()] = f;
+
+    auto r = new Reader (*this, nullptr, f);
+    f->addClient (r);
+    return r;
+}
+
+AudioFileCache::Reader::Ptr AudioFileCache::createReaderForOpenFile (const AudioFile& file)
+{
+    if (auto f = findCachedFile (file))
     {
-        backgroundReaderThread.startThread (4);
+        auto r = new Reader (*this, f, nullptr);
+        f->addClient (r);
+        return r;
+    }
 
-        return new Reader (*this, nullptr, new juce::BufferingAudioReader (reader, backgroundReaderThread,
-                                                                           48000 * 5));
+    if (auto f = findDecodedFile (file))
+    {
+        auto r = new Reader (*this, nullptr, f);
+        f->addClient (r);
+        return r;
     }
 
     return {};
@@ -741,16 +1890,66 @@ void AudioFileCache::purgeOrphanReaders()
     for (CachedFile* f : activeFiles)
         f->purgeOrphanReaders();
 
+    for (auto f : decodedFiles)
+        f->purgeOrphanReaders();
+
     for (int i = activeFiles.size(); --i >= 0;)
+    {
         if (activeFiles.getUnchecked(i)->isUnused())
+        {
+            activeFileIndex.erase (activeFiles.getUnchecked(i)->file.getHash());
             activeFiles.remove (i);
+        }
+    }
+
+    for (int i = decodedFiles.size(); --i >= 0;)
+    {
+        if (decodedFiles.getUnchecked(i)->isUnused())
+        {
+            decodedFileIndex.erase (decodedFiles.getUnchecked(i)->file.getHash());
+            decodedFiles.remove (i);
+        }
+    }
 }
 
 //==============================================================================
-AudioFileCache::Reader::Reader (AudioFileCache& c, void* f, juce::BufferingAudioReader* fallback)
-    : cache (c), file (f), fallbackReader (fallback)
+//==============================================================================
+/** Smooths over each point in a block of samples where a loop wraps back to its start.
+    The start of the loop is crossfaded with the end of the loop played backwards, which
+    meets it without a jump and only needs the samples that have already been read.
+*/
+static void crossfadeLoopWraps (float* const* chans, int numChans, int numSamples,
+                                juce::int64 firstWrap, juce::int64 loopLength) noexcept
+{
+    constexpr int maxFadeLength = 64;
+
+    for (auto wrap = firstWrap; wrap > 0 && wrap < numSamples; wrap += loopLength)
+    {
+        const auto w = (int) wrap;
+        const auto fadeLength = (int) std::min ({ (juce::int64) maxFadeLength, loopLength / 2,
+                                                  (juce::int64) w, (juce::int64) (numSamples - w) });
+
+        if (fadeLength <= 1)
+            continue;
+
+        for (int chan = 0; chan < numChans; ++chan)
+        {
+            if (auto data = chans[chan])
+            {
+                for (int i = 0; i < fadeLength; ++i)
+                {
+                    const auto alpha = (i + 1) / (float) (fadeLength + 1);
+                    data[w + i] = alpha * data[w + i] + (1.0f - alpha) * data[w - 1 - i];
+                }
+            }
+        }
+    }
+}
+
+AudioFileCache::Reader::Reader (AudioFileCache& c, void* f, void* df)
+    : cache (c), file (f), decodedFile (df)
 {
-    jassert (file != nullptr || fallbackReader != nullptr);
+    jassert (file != nullptr || decodedFile != nullptr);
 }
 
 AudioFileCache::Reader::~Reader()
@@ -758,28 +1957,48 @@ AudioFileCache::Reader::~Reader()
 }
 
 void AudioFileCache::Reader::setReadPosition (juce::int64 pos) noexcept
+{
+    readPos = wrapIntoLoop (pos);
+}
+
+juce::int64 AudioFileCache::Reader::wrapIntoLoop (juce::int64 pos) const noexcept
 {
     const auto localLoopStart = loopStart.load();
     const auto localLoopLength = loopLength.load();
 
-    if (loopLength == 0)
-        readPos = pos;
-    else if (pos >= 0)
-        readPos = localLoopStart + (pos % localLoopLength);
-    else
-        readPos = localLoopStart + juce::negativeAwareModulo (pos, localLoopLength);
+    if (localLoopLength == 0)
+        return pos;
+
+    if (pos >= 0)
+        return localLoopStart + (pos % localLoopLength);
+
+    return localLoopStart + juce::negativeAwareModulo (pos, localLoopLength);
+}
+
+void AudioFileCache::Reader::setCuePositions (const juce::int64* positions, int numPositions) noexcept
+{
+    numPositions = std::min (numPositions, (int) maxNumCuePositions);
+
+    // The background threads only read as many as they're told there are, so
+    // shrinking the count first stops them seeing half-written positions
+    numCuePositions = std::min (numPositions, numCuePositions.load());
+
+    for (int i = 0; i < numPositions; ++i)
+        cuePositions[i] = wrapIntoLoop (positions[i]);
+
+    numCuePositions = numPositions;
 }
 
 int AudioFileCache::Reader::getNumChannels() const noexcept
 {
     return file != nullptr ? static_cast<CachedFile*> (file)->info.numChannels
-                           : (int) fallbackReader->numChannels;
+                           : static_cast<DecodedFile*> (decodedFile)->info.numChannels;
 }
 
 double AudioFileCache::Reader::getSampleRate() const noexcept
 {
     return file != nullptr ? static_cast<CachedFile*> (file)->info.sampleRate
-                           : (int) fallbackReader->sampleRate;
+                           : static_cast<DecodedFile*> (decodedFile)->info.sampleRate;
 }
 
 void AudioFileCache::Reader::setLoopRange (juce::Range<juce::int64> newRange)
@@ -798,6 +2017,11 @@ bool AudioFileCache::Reader::readSamples (int numSamples,
     jassert (numSamples < CachedFile::readAheadSamples); // this method fails unless broken down into chunks smaller than this
     const auto numDestChans = destBuffer.getNumChannels();
 
+    // Where in this block the loop will wrap, if it does
+    const auto localLoopLength = loopLength.load();
+    const auto firstLoopWrap = (localLoopLength > 1 && readPos >= 0) ? loopStart + localLoopLength - readPos
+                                                                     : (juce::int64) -1;
+
     // This may need to deal with the generic surround case if destBuffer number of channels > channelsToUse.size()
     if (cache.engine.getEngineBehaviour().isDescriptionOfWaveDevicesSupported())
     {
@@ -826,13 +2050,14 @@ bool AudioFileCache::Reader::readSamples (int numSamples,
         if (readSamples ((int**) chans, numSourceChans, 0, numSamples, timeoutMs))
         {
             bool isFloatingPoint = (file != nullptr) ? static_cast<CachedFile*> (file)->info.isFloatingPoint
-                                                     : fallbackReader->usesFloatingPointData;
+                                                     : static_cast<DecodedFile*> (decodedFile)->info.isFloatingPoint;
 
             if (! isFloatingPoint)
                 for (int i = 0; i <= highestUsedSourceChan; ++i)
                     if (auto chan = chans[i])
                         juce::FloatVectorOperations::convertFixedToFloat (chan, (const int*) chan, 1.0f / 0x7fffffff, numSamples);
 
+            crossfadeLoopWraps (chans, highestUsedSourceChan + 1, numSamples, firstLoopWrap, localLoopLength);
             return true;
         }
     }
@@ -875,13 +2100,15 @@ bool AudioFileCache::Reader::readSamples (int numSamples,
         if (readSamples ((int**) chans, 2, 0, numSamples, timeoutMs))
         {
             const bool isFloatingPoint = (file != nullptr) ? static_cast<CachedFile*> (file)->info.isFloatingPoint
-                                                           : fallbackReader->usesFloatingPointData;
+                                                           : static_cast<DecodedFile*> (decodedFile)->info.isFloatingPoint;
 
             if (! isFloatingPoint)
                 for (int i = 0; i < 2; ++i)
                     if (auto* chan = chans[i])
                         juce::FloatVectorOperations::convertFixedToFloat (chan, (const int*) chan, 1.0f / 0x7fffffff, numSamples);
 
+            crossfadeLoopWraps (chans, 2, numSamples, firstLoopWrap, localLoopLength);
+
             if (dupeChannel)
             {
                 if (chans[0] == nullptr)
@@ -901,9 +2128,11 @@ bool AudioFileCache::Reader::readSamples (int** destSamples, int numDestChannels
                                           int startOffsetInDestBuffer, int numSamples, int timeoutMs)
 {
     jassert (numSamples < CachedFile::readAheadSamples); // this method fails unless broken down into chunks smaller than this
-    jassert (getReferenceCount() > 1 || file == nullptr); // may be being used after the cache has been deleted
+    jassert (getReferenceCount() > 1); // may be being used after the cache has been deleted
     jassert (timeoutMs >= 0);
 
+    const auto startTicks = juce::Time::getHighResolutionTicks();
+
     if (readPos < 0)
     {
         auto silence = (int) std::min (-readPos, (juce::int64) numSamples);
@@ -917,7 +2146,10 @@ bool AudioFileCache::Reader::readSamples (int** destSamples, int numDestChannels
         readPos += silence;
 
         if (numSamples <= 0)
+        {
+            addReadToStatistics (true, startTicks, timeoutMs);
             return true;
+        }
     }
 
     bool allOk = true;
@@ -925,14 +2157,9 @@ bool AudioFileCache::Reader::readSamples (int** destSamples, int numDestChannels
     if (loopLength == 0)
     {
         if (auto cf = static_cast<CachedFile*> (file))
-        {
             allOk = cf->read (readPos, destSamples, numDestChannels, startOffsetInDestBuffer, numSamples, timeoutMs);
-        }
         else
-        {
-            fallbackReader->setReadTimeout (timeoutMs);
-            allOk = fallbackReader->readSamples (destSamples, numDestChannels, startOffsetInDestBuffer, readPos, numSamples);
-        }
+            allOk = static_cast<DecodedFile*> (decodedFile)->read (readPos, destSamples, numDestChannels, startOffsetInDestBuffer, numSamples, timeoutMs);
 
         readPos += numSamples;
     }
@@ -945,14 +2172,9 @@ bool AudioFileCache::Reader::readSamples (int** destSamples, int numDestChannels
             auto numToRead = (int) std::min ((juce::int64) numSamples, loopStart + loopLength - readPos);
 
             if (auto cf = static_cast<CachedFile*> (file))
-            {
                 allOk = cf->read (readPos, destSamples, numDestChannels, startOffsetInDestBuffer, numToRead, timeoutMs) && allOk;
-            }
             else
-            {
-                fallbackReader->setReadTimeout (timeoutMs);
-                allOk = fallbackReader->readSamples (destSamples, numDestChannels, startOffsetInDestBuffer, readPos, numToRead) && allOk;
-            }
+                allOk = static_cast<DecodedFile*> (decodedFile)->read (readPos, destSamples, numDestChannels, startOffsetInDestBuffer, numToRead, timeoutMs) && allOk;
 
             readPos += numToRead;
 
@@ -962,8 +2184,6 @@ bool AudioFileCache::Reader::readSamples (int** destSamples, int numDestChannels
             startOffsetInDestBuffer += numToRead;
             numSamples -= numToRead;
         }
-
-        return allOk;
     }
     else
     {
@@ -973,25 +2193,35 @@ bool AudioFileCache::Reader::readSamples (int** destSamples, int numDestChannels
     if (! allOk)
         cache.cacheMissed = true;
 
+    addReadToStatistics (allOk, startTicks, timeoutMs);
     return allOk;
 }
 
+void AudioFileCache::Reader::addReadToStatistics (bool succeeded, juce::int64 startTicks, int timeoutMs) noexcept
+{
+    const auto microseconds = getMicrosecondsSince (startTicks);
+
+    ++cache.totalNumReads;
+
+    if (! succeeded)
+        ++cache.totalNumMisses;
+
+    if (auto cf = static_cast<CachedFile*> (file))
+        cf->counters.addRead (succeeded, microseconds, timeoutMs);
+    else if (auto df = static_cast<DecodedFile*> (decodedFile))
+        df->counters.addRead (succeeded, microseconds, timeoutMs);
+}
+
 bool AudioFileCache::Reader::getRange (int numSamples, float& lmax, float& lmin, float& rmax, float& rmin, int timeoutMs)
 {
-    jassert (getReferenceCount() > 1 || file == nullptr); // may be being used after the cache has been deleted
+    jassert (getReferenceCount() > 1); // may be being used after the cache has been deleted
 
     bool ok;
 
     if (auto cf = static_cast<CachedFile*> (file))
-    {
         ok = cf->getRange (readPos, numSamples, lmax, lmin, rmax, rmin, timeoutMs);
-    }
     else
-    {
-        fallbackReader->setReadTimeout (timeoutMs);
-        fallbackReader->readMaxLevels (readPos, numSamples, lmin, lmax, rmin, rmax);
-        ok = true;
-    }
+        ok = static_cast<DecodedFile*> (decodedFile)->getRange (readPos, numSamples, lmax, lmin, rmax, rmin, timeoutMs);
 
     readPos += numSamples;
     return ok;
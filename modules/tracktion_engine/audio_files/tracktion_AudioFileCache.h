@@ -51,6 +51,14 @@ public:
 
         void setLoopRange (juce::Range<juce::int64> newRange);
 
+        /** Sets some positions that playback is likely to jump to, e.g. markers or the start
+            of the Edit's loop, so the cache can keep the audio just after them ready.
+            This is cheap enough to be called on every block.
+        */
+        void setCuePositions (const juce::int64* positions, int numPositions) noexcept;
+
+        static constexpr int maxNumCuePositions = 8;
+
         int getNumChannels() const noexcept;
         double getSampleRate() const noexcept;
 
@@ -59,10 +67,14 @@ public:
 
         AudioFileCache& cache;
         void* file;
+        void* decodedFile;
         std::atomic<juce::int64> readPos { 0 }, loopStart { 0 }, loopLength { 0 };
-        std::unique_ptr<juce::BufferingAudioReader> fallbackReader;
+        std::atomic<juce::int64> cuePositions[maxNumCuePositions];
+        std::atomic<int> numCuePositions { 0 };
 
-        Reader (AudioFileCache&, void*, juce::BufferingAudioReader* fallback);
+        Reader (AudioFileCache&, void* file, void* decodedFile);
+        juce::int64 wrapIntoLoop (juce::int64 pos) const noexcept;
+        void addReadToStatistics (bool succeeded, juce::int64 startTicks, int timeoutMs) noexcept;
 
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Reader)
     };
@@ -73,39 +85,132 @@ public:
     void setCacheSizeSamples (juce::int64 samplesPerFile);
     juce::int64 getCacheSizeSamples() const         { return cacheSizeSamples; }
 
-    juce::int64 getBytesInUse() const               { return totalBytesUsed; }
+    /** Returns the memory that's mapped or decoded for all the files, as of the last time the
+        cache's thread checked. This doesn't take any locks so can be polled.
+    */
+    juce::int64 getBytesInUse() const               { return mappedBytesUsed + decodedBytesUsed; }
+
+    /** Returns the part of getBytesInUse() that's memory-mapped from uncompressed files. */
+    juce::int64 getMappedBytesInUse() const         { return mappedBytesUsed; }
+
+    /** Returns the part of getBytesInUse() that's held in decoded blocks of compressed files. */
+    juce::int64 getDecodedBytesInUse() const        { return decodedBytesUsed; }
 
     bool hasCacheMissed (bool clearMissedFlag);
 
+    /** Sets how much memory the decoded blocks of compressed files can use.
+        Files that can't be memory-mapped, e.g. FLAC or Ogg, are decoded in blocks which
+        are shared between all their readers, and the least recently used blocks are
+        dropped when this is exceeded.
+    */
+    void setDecodedCacheSizeBytes (juce::int64 numBytes);
+    juce::int64 getDecodedCacheSizeBytes() const    { return decodedCacheSizeBytes; }
+
+    /** Drops the least recently used decoded blocks until roughly this many bytes have
+        been freed, e.g. when memory's running low. Blocks that have been read in the last
+        second are kept. Returns the number of bytes freed.
+    */
+    juce::int64 releaseDecodedBlocks (juce::int64 bytesToFree);
+
+    /** Unmaps any files that no readers are using and that haven't been read for a short
+        while, rather than waiting for them to time out. Returns the number of bytes freed.
+    */
+    juce::int64 releaseUnusedFiles();
+
+    /** Lets several processes share the blocks they decode from compressed files.
+        Decoded blocks are written to this directory, and blocks that another process has
+        already written there are memory-mapped rather than decoded again. It should be on
+        a fast local disk, ideally a RAM-backed one such as /dev/shm. Pass File() to stop
+        sharing blocks. Memory-mapped files don't need this as the OS already shares their pages.
+    */
+    void setSharedBlockDirectory (const juce::File&, juce::int64 maxSizeBytes = (juce::int64) 1024 * 1024 * 1024);
+
+    /** Returns the directory set with setSharedBlockDirectory, if there is one. */
+    juce::File getSharedBlockDirectory() const;
+
     /** Returns the amount of time spent reading files. */
     double getCpuUsage()                            { return cpuUsage.load (std::memory_order_relaxed); }
 
+    //==============================================================================
+    /** How one of the cache's files has been used since the statistics were last reset. */
+    struct FileStatistics
+    {
+        juce::File file;
+        bool isDecoded = false;             /**< True if the file is decoded in blocks rather than memory-mapped. */
+        juce::int64 bytesInUse = 0;         /**< The memory currently mapped or decoded for the file. */
+        juce::int64 numBlocksLoaded = 0;    /**< The number of sections that have been mapped or blocks decoded. */
+        juce::int64 numReads = 0;           /**< The number of calls to Reader::readSamples. */
+        juce::int64 numMisses = 0;          /**< Reads that couldn't get all their data and returned silence. */
+        juce::int64 numSlowReads = 0;       /**< Reads that took longer than their timeout. */
+        double worstReadTimeMs = 0;         /**< The longest any single read took. */
+        double validationTimeMs = 0;        /**< The total time spent in validateFile. */
+    };
+
+    /** A snapshot of the cache's statistics. */
+    struct Statistics
+    {
+        juce::int64 totalBytesInUse = 0;
+        juce::int64 totalNumReads = 0;      /**< Includes reads of files that have since been released. */
+        juce::int64 totalNumMisses = 0;     /**< Includes misses of files that have since been released. */
+        double cpuUsage = 0;
+        juce::Array<FileStatistics> files;
+    };
+
+    /** Returns the current statistics for the cache and each file in it.
+        This takes a lock that the background threads use, so shouldn't be called too often.
+    */
+    Statistics getStatistics() const;
+
+    /** Clears the counters returned by getStatistics. */
+    void resetStatistics();
+
 private:
     Engine& engine;
-    juce::int64 totalBytesUsed = 0, cacheSizeSamples = 0;
+    std::atomic<juce::int64> mappedBytesUsed { 0 }, decodedBytesUsed { 0 };
+    juce::int64 cacheSizeSamples = 0;
+    juce::int64 decodedCacheSizeBytes = 256 * 1024 * 1024;
     bool cacheMissed = false;
     std::atomic<double> cpuUsage { 0 };
+    std::atomic<juce::int64> totalNumReads { 0 }, totalNumMisses { 0 };
+
+    struct FileCounters;
 
     class CacheBuffer;
     class CachedFile;
     juce::OwnedArray<CachedFile> activeFiles;
-    int nextFileToService = 0;
+    class DecodedFile;
+    juce::OwnedArray<DecodedFile> decodedFiles;
+    std::unordered_map<juce::int64, CachedFile*> activeFileIndex;
+    std::unordered_map<juce::int64, DecodedFile*> decodedFileIndex;
     juce::ReadWriteLock fileListLock;
 
-    CachedFile* getOrCreateCachedFile (const AudioFile&);
+    CachedFile* findCachedFile (const AudioFile&) const;
+    DecodedFile* findDecodedFile (const AudioFile&) const;
+    CachedFile* createCachedFile (const AudioFile&);
+    DecodedFile* createDecodedFile (const AudioFile&);
+    Reader::Ptr createReaderForOpenFile (const AudioFile&);
     bool serviceNextReader();
     void touchReaders();
 
     class MapperThread;
     std::unique_ptr<MapperThread> mapperThread;
     class RefresherThread;
-    std::unique_ptr<RefresherThread> refresherThread;
+    juce::OwnedArray<RefresherThread> refresherThreads;
+    static constexpr int numRefresherThreads = 4;
+
+    class SharedBlockStore;
+    std::shared_ptr<SharedBlockStore> sharedBlockStore;
+    juce::CriticalSection sharedBlockStoreLock;
+    std::shared_ptr<SharedBlockStore> getSharedBlockStore() const;
 
-    juce::TimeSliceThread backgroundReaderThread { "Preview Buffer" };
+    juce::ThreadPool decodeThreadPool { juce::jmax (1, juce::SystemStats::getNumCpus() / 2) };
 
     void stopThreads();
 
-    void purgeOldFiles();
+    void purgeOldFiles (juce::uint32 minTimeSinceLastReadMs = 2000);
+    void purgeDecodedBlocks (juce::int64 maxBytes);
+    juce::int64 getMappedBytesInUseNow() const;
+    juce::int64 getDecodedBytesInUseNow() const;
     void purgeOrphanReaders();
 
     friend class AudioFileManager;
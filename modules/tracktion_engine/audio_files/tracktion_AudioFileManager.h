@@ -32,8 +32,19 @@ public:
     void releaseFile (const AudioFile&);
     void releaseAllFiles();
 
+    /** Writes the headers of the files that have been parsed to a cache in the temp
+        directory so they don't need parsing again next time. This is also done when the
+        AudioFileManager is deleted.
+    */
+    void saveInfoCache();
+
     juce::AudioThumbnailCache& getAudioThumbnailCache()     { return *thumbnailCache; }
 
+    /** Returns the memory used by the SmartThumbnails that currently exist.
+        If an Edit is given, only the thumbnails created for that Edit are counted.
+    */
+    juce::int64 getThumbnailBytesInUse (const Edit* edit = nullptr);
+
     Engine& engine;
     AudioProxyGenerator proxyGenerator;
     AudioFileCache cache;
@@ -43,7 +54,11 @@ private:
     juce::HashMap<juce::int64, KnownFile*> knownFiles;
     juce::CriticalSection knownFilesLock;
 
+    struct InfoCache;
+    std::unique_ptr<InfoCache> infoCache;
+
     KnownFile& findOrCreateKnown (const AudioFile&);
+    AudioFileInfo parseInfo (const AudioFile&);
     void removeFile (juce::int64 hash);
     void clearFiles();
 
@@ -88,81 +88,128 @@ juce::AudioFormatWriter* AudioFileUtils::createWriterFor (Engine& engine,
     return {};
 }
 
-juce::Range<juce::int64> AudioFileUtils::scanForNonZeroSamples (Engine& engine, const juce::File& file, float maxZeroLevelDb)
+//==============================================================================
+namespace AudioFileUtilsHelpers
 {
-    std::unique_ptr<juce::AudioFormatReader> reader (createReaderFor (engine, file));
-
-    if (reader == nullptr)
-        return {};
-
-    auto numChans = (int) reader->numChannels;
-
-    if (numChans == 0 || reader->lengthInSamples == 0)
-        return {};
-
-    const float floatMaxZeroLevel = 2.0f * dbToGain (maxZeroLevelDb);
-    const int intMaxZeroLevel = 1 + (int) (std::numeric_limits<int>::max() * (double) floatMaxZeroLevel);
-    const int sampsPerBlock = 32768;
-
-    juce::HeapBlock<int*> chans;
-    chans.calloc ((size_t) numChans + 2);
-
-    juce::HeapBlock<int> buffer ((size_t) numChans * sampsPerBlock);
+    /** Returns a memory-mapped reader for the whole file if its format allows it, or a normal one. */
+    static std::unique_ptr<juce::AudioFormatReader> createReaderForScanning (Engine& engine, const juce::File& file)
+    {
+        juce::AudioFormat* format = nullptr;
+        std::unique_ptr<juce::MemoryMappedAudioFormatReader> mappedReader (AudioFileUtils::createMemoryMappedReader (engine, file, format));
 
-    for (int i = 0; i < numChans; ++i)
-        chans[i] = buffer + i * sampsPerBlock;
+        if (mappedReader != nullptr && mappedReader->mapEntireFile())
+            return std::unique_ptr<juce::AudioFormatReader> (mappedReader.release());
 
-    juce::int64 firstNonZero = 0, lastNonZero = 0, n = 0;
-    bool needFirst = true;
+        return std::unique_ptr<juce::AudioFormatReader> (AudioFileUtils::createReaderFor (engine, file));
+    }
 
-    while (n < reader->lengthInSamples)
+    /** Finds the first or last sample louder than a level, or -1 if there isn't one.
+        The whole block is checked with a vectorised min and max first so only a block
+        containing a loud sample is searched sample by sample.
+    */
+    static int findLoudSample (const juce::AudioBuffer<float>& buffer, int numSamples, float maxZeroLevel, bool findLast)
     {
-        for (int j = numChans; --j >= 0;)
-            juce::zeromem (chans[j], sizeof (int) * sampsPerBlock);
+        int found = -1;
 
-        reader->read (chans, numChans, n, sampsPerBlock, false);
-
-        for (int j = numChans; --j >= 0;)
+        for (int chan = 0; chan < buffer.getNumChannels(); ++chan)
         {
-            if (reader->usesFloatingPointData)
-            {
-                const float* const chan = (const float*) chans[j];
+            auto data = buffer.getReadPointer (chan);
+            auto range = juce::FloatVectorOperations::findMinAndMax (data, numSamples);
 
-                for (int i = 0; i < sampsPerBlock; ++i)
+            if (range.getEnd() <= maxZeroLevel && -range.getStart() <= maxZeroLevel)
+                continue;
+
+            if (findLast)
+            {
+                for (int i = numSamples; --i > found;)
                 {
-                    if (std::abs (chan[i]) > floatMaxZeroLevel)
+                    if (std::abs (data[i]) > maxZeroLevel)
                     {
-                        if (needFirst)
-                        {
-                            firstNonZero = n + i;
-                            needFirst = false;
-                        }
-
-                        lastNonZero = std::max (lastNonZero, n + i);
+                        found = i;
+                        break;
                     }
                 }
             }
             else
             {
-                const int* const chan = chans[j];
+                const int end = found < 0 ? numSamples : found;
 
-                for (int i = 0; i < sampsPerBlock; ++i)
+                for (int i = 0; i < end; ++i)
                 {
-                    if (std::abs (chan[i]) > intMaxZeroLevel)
+                    if (std::abs (data[i]) > maxZeroLevel)
                     {
-                        if (needFirst)
-                        {
-                            firstNonZero = n + i;
-                            needFirst = false;
-                        }
-
-                        lastNonZero = std::max (lastNonZero, n + i);
+                        found = i;
+                        break;
                     }
                 }
             }
         }
 
-        n += sampsPerBlock;
+        return found;
+    }
+}
+
+juce::Range<juce::int64> AudioFileUtils::scanForNonZeroSamples (Engine& engine, const juce::File& file, float maxZeroLevelDb)
+{
+    if (auto reader = AudioFileUtilsHelpers::createReaderForScanning (engine, file))
+        return scanForNonZeroSamples (*reader, maxZeroLevelDb);
+
+    return {};
+}
+
+juce::Range<juce::int64> AudioFileUtils::scanForNonZeroSamples (juce::AudioFormatReader& reader, float maxZeroLevelDb)
+{
+    using namespace AudioFileUtilsHelpers;
+    CRASH_TRACER
+
+    const auto numChans = (int) reader.numChannels;
+    const auto length = reader.lengthInSamples;
+
+    if (numChans == 0 || length <= 0)
+        return {};
+
+    const float maxZeroLevel = 2.0f * dbToGain (maxZeroLevelDb);
+    const int sampsPerBlock = 32768;
+    juce::AudioBuffer<float> buffer (numChans, sampsPerBlock);
+
+    auto readBlock = [&] (juce::int64 start, int numSamples)
+    {
+        reader.read (&buffer, 0, numSamples, start, true, true);
+    };
+
+    // Search forwards for the first loud sample
+    juce::int64 firstNonZero = -1;
+
+    for (juce::int64 start = 0; start < length && firstNonZero < 0; start += sampsPerBlock)
+    {
+        const auto numSamples = (int) std::min ((juce::int64) sampsPerBlock, length - start);
+        readBlock (start, numSamples);
+
+        auto index = findLoudSample (buffer, numSamples, maxZeroLevel, false);
+
+        if (index >= 0)
+            firstNonZero = start + index;
+    }
+
+    if (firstNonZero < 0)
+        return {};
+
+    // Then backwards for the last, which can't be before the first
+    juce::int64 lastNonZero = firstNonZero;
+
+    for (juce::int64 end = length; end > firstNonZero; end -= sampsPerBlock)
+    {
+        const auto start = std::max (firstNonZero, end - sampsPerBlock);
+        const auto numSamples = (int) (end - start);
+        readBlock (start, numSamples);
+
+        auto index = findLoudSample (buffer, numSamples, maxZeroLevel, true);
+
+        if (index >= 0)
+        {
+            lastNonZero = start + index;
+            break;
+        }
     }
 
     return { firstNonZero, lastNonZero };
@@ -233,9 +280,15 @@ juce::Range<juce::int64> AudioFileUtils::copyNonSilentSectionToNewFile (Engine&
                                                                         const juce::File& destFile,
                                                                         float maxZeroLevelDb)
 {
-    auto range = scanForNonZeroSamples (e, sourceFile, maxZeroLevelDb);
+    // The mapped reader used for the scan is used for the copy too
+    auto reader = AudioFileUtilsHelpers::createReaderForScanning (e, sourceFile);
+
+    if (reader == nullptr)
+        return {};
 
-    if (copySectionToNewFile (e, sourceFile, destFile, range) >= 0)
+    auto range = scanForNonZeroSamples (*reader, maxZeroLevelDb);
+
+    if (! range.isEmpty() && copySection (e, reader, sourceFile, destFile, range) >= 0)
         return range;
 
     return {};
@@ -256,6 +309,55 @@ juce::Range<juce::int64> AudioFileUtils::trimSilence (Engine& e, const juce::Fil
     return {};
 }
 
+juce::Array<juce::Range<juce::int64>> AudioFileUtils::trimSilence (Engine& e, const juce::Array<juce::File>& files, float maxZeroLevelDb)
+{
+    CRASH_TRACER
+
+    // This is shared with the jobs so it outlives any that are still finishing after the wait
+    struct Batch
+    {
+        juce::Array<juce::File> files;
+        juce::Array<juce::Range<juce::int64>> ranges;
+        std::atomic<int> nextFile { 0 }, numJobsRunning { 0 };
+        juce::WaitableEvent finished;
+    };
+
+    auto batch = std::make_shared<Batch>();
+    batch->files = files;
+    batch->ranges.resize (files.size());
+
+    auto trimFiles = [&e, maxZeroLevelDb] (Batch& b)
+    {
+        for (int i = b.nextFile++; i < b.files.size(); i = b.nextFile++)
+            b.ranges.setUnchecked (i, trimSilence (e, b.files.getReference (i), maxZeroLevelDb));
+    };
+
+    // Each file is read then written in full, so these go on the io lane
+    auto& pool = e.getBackgroundJobs().getPool (ThreadPoolJobWithProgress::Priority::background,
+                                                ThreadPoolJobWithProgress::Lane::io);
+    const int numJobs = juce::jmin (files.size() - 1, pool.getNumThreads());
+    batch->numJobsRunning = juce::jmax (0, numJobs);
+
+    for (int i = 0; i < numJobs; ++i)
+    {
+        pool.addJob ([batch, trimFiles]
+                     {
+                         trimFiles (*batch);
+
+                         if (--batch->numJobsRunning == 0)
+                             batch->finished.signal();
+                     });
+    }
+
+    // This thread trims files too, rather than just waiting
+    trimFiles (*batch);
+
+    if (numJobs > 0)
+        batch->finished.wait();
+
+    return batch->ranges;
+}
+
 bool AudioFileUtils::reverse (Engine& engine,
                               const juce::File& source, const juce::File& destination,
                               std::atomic<float>& progress, juce::ThreadPoolJob* job, bool canCreateWavIntermediate)
@@ -28,8 +28,15 @@ struct AudioFileUtils
                                                      double sampleRate, unsigned int numChannels, int bitsPerSample,
                                                      const juce::StringPairArray& metadata, int quality);
 
+    /** Returns the range from the first to the last sample louder than a level.
+        The file is memory-mapped if its format allows it and is searched from both ends,
+        so the section in between is never read.
+    */
     static juce::Range<juce::int64> scanForNonZeroSamples (Engine&, const juce::File&, float maxZeroLevelDb);
 
+    /** Returns the range from the first to the last sample louder than a level, as above. */
+    static juce::Range<juce::int64> scanForNonZeroSamples (juce::AudioFormatReader&, float maxZeroLevelDb);
+
     static juce::Range<juce::int64> copyNonSilentSectionToNewFile (Engine& e,
                                                                    const juce::File& sourceFile,
                                                                    const juce::File& destFile,
@@ -37,6 +44,12 @@ struct AudioFileUtils
 
     static juce::Range<juce::int64> trimSilence (Engine& e, const juce::File&, float maxZeroLevelDb);
 
+    /** Trims the silence from several files at once on the Engine's background job threads.
+        This blocks until they've all been trimmed so mustn't be called from one of those jobs.
+        @returns the range kept from each file, which is empty if it couldn't be trimmed
+    */
+    static juce::Array<juce::Range<juce::int64>> trimSilence (Engine& e, const juce::Array<juce::File>&, float maxZeroLevelDb);
+
     /** Reverses a file updating a progress value and checking the exit status of a given job. */
     static bool reverse (Engine&, const juce::File& source, const juce::File& destination,
                          std::atomic<float>& progress, juce::ThreadPoolJob* job = nullptr,
@@ -49,6 +49,13 @@ public:
     /** Appends an block of samples to the file. */
     bool appendBuffer (const int** buffer, int numSamples);
 
+    /** Dithers an AudioBuffer to the file's bit depth as it's appended.
+        For integer formats the dithered samples go straight into the writer's integer format
+        rather than being converted a second time, and the buffer isn't changed.
+        The Ditherer should have been reset to the file's bit depth.
+    */
+    bool appendBuffer (juce::AudioBuffer<float>& buffer, int numSamples, Ditherer&);
+
     /** Appends a block of samples to the file from an audio format reader. */
     bool writeFromAudioReader (juce::AudioFormatReader&, juce::int64 startSample, juce::int64 numSamples);
 
@@ -61,6 +68,11 @@ private:
     int samplesUntilFlush;
     std::unique_ptr<juce::AudioFormatWriter> writer;
     juce::CriticalSection writerLock;
+    juce::HeapBlock<int> intData;
+    juce::HeapBlock<int*> intChannels;
+    size_t intDataSize = 0;
+
+    void samplesWritten (int numSamples);
 };
 
 } // namespace tracktion_engine
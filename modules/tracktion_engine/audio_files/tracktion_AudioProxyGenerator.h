@@ -17,11 +17,20 @@ public:
     AudioProxyGenerator();
     ~AudioProxyGenerator();
 
+    /** Cancels any job that's generating this proxy and deletes the file.
+        This doesn't wait for a running job to stop, it'll delete its output when it does.
+    */
     void deleteProxy (const AudioFile& proxyFile);
 
     bool isProxyBeingGenerated (const AudioFile& proxyFile) const noexcept;
     float getProportionComplete (const AudioFile& proxyFile) const noexcept;
 
+    /** Sets how many proxies can be generated at once, the rest are queued.
+        By default this is the number of CPU cores.
+    */
+    void setMaxNumConcurrentJobs (int);
+    int getMaxNumConcurrentJobs() const noexcept;
+
     //==============================================================================
     struct GeneratorJob  : public ThreadPoolJobWithProgress
     {
@@ -39,7 +48,18 @@ public:
         AudioFile proxy;
         std::atomic<float> progress { 0.0f };
 
+        /** If this is set, other jobs with the same key are assumed to render exactly the same
+            audio, so rather than being run they'll just copy this job's output.
+        */
+        juce::int64 renderKey = 0;
+
     private:
+        friend class AudioProxyGenerator;
+
+        // These are guarded by the generator's jobListLock
+        juce::Array<AudioFile> sharedProxies;
+        bool isStarted = false, isCancelled = false, primaryProxyCancelled = false;
+
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (GeneratorJob)
     };
 
@@ -47,10 +67,14 @@ public:
 
 private:
     juce::Array<GeneratorJob*> activeJobs;
+    juce::OwnedArray<GeneratorJob> queuedJobs;
     juce::CriticalSection jobListLock;
+    int maxNumConcurrentJobs;
 
     GeneratorJob* findJob (const AudioFile&) const noexcept;
-    void removeFinishedJob (GeneratorJob*);
+    GeneratorJob* findJobWithKey (juce::int64 renderKey) const noexcept;
+    void startQueuedJobs();
+    juce::Array<AudioFile> removeFinishedJob (GeneratorJob*);
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioProxyGenerator)
 };
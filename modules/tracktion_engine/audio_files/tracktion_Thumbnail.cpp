@@ -61,7 +61,71 @@ private:
 };
 
 //==============================================================================
-class TracktionThumbnail::LevelDataSource   : public juce::TimeSliceClient
+/**
+    The threads that read the levels for all the thumbnails.
+
+    Thumbnails that are visible are read first and the others take turns, a block at a
+    time. Only a few threads are used so that importing lots of files at once doesn't
+    swamp the disk.
+*/
+class TracktionThumbnail::GenerationPool
+{
+public:
+    GenerationPool()
+    {
+        for (int i = juce::jlimit (1, 4, juce::SystemStats::getNumCpus() / 2); --i >= 0;)
+            threads.add (new GenerationThread (*this));
+    }
+
+    ~GenerationPool()
+    {
+        jassert (sources.isEmpty());
+        threads.clear();
+    }
+
+    void addSource (LevelDataSource&);
+
+    /** After this returns, none of the threads will be using the source. */
+    void removeSource (LevelDataSource&);
+
+private:
+    struct GenerationThread  : public juce::Thread
+    {
+        GenerationThread (GenerationPool& p)  : juce::Thread ("Thumbnail generation"), owner (p)
+        {
+            startThread (3);
+        }
+
+        ~GenerationThread() override
+        {
+            stopThread (10000);
+        }
+
+        void run() override
+        {
+            while (! threadShouldExit())
+            {
+                const int msToWait = owner.processNextSource();
+
+                if (msToWait > 0)
+                    wait (msToWait);
+            }
+        }
+
+        GenerationPool& owner;
+    };
+
+    juce::CriticalSection lock;
+    juce::Array<LevelDataSource*> sources;
+    juce::OwnedArray<GenerationThread> threads;
+
+    int processNextSource();
+
+    JUCE_DECLARE_NON_COPYABLE (GenerationPool)
+};
+
+//==============================================================================
+class TracktionThumbnail::LevelDataSource
 {
 public:
     LevelDataSource (TracktionThumbnail& thumb, juce::AudioFormatReader* newReader, juce::int64 hash)
@@ -74,9 +138,9 @@ public:
     {
     }
 
-    ~LevelDataSource() override
+    ~LevelDataSource()
     {
-        owner.cache.getTimeSliceThread().removeTimeSliceClient (this);
+        generationPool->removeSource (*this);
     }
 
     enum { timeBeforeDeletingReader = 3000 };
@@ -98,7 +162,7 @@ public:
             if (lengthInSamples <= 0 || isFullyLoaded())
                 reader = nullptr;
             else
-                owner.cache.getTimeSliceThread().addTimeSliceClient (this);
+                generationPool->addSource (*this);
         }
     }
 
@@ -113,7 +177,7 @@ public:
             if (reader != nullptr)
             {
                 lastReaderUseTime = juce::Time::getMillisecondCounter();
-                owner.cache.getTimeSliceThread().addTimeSliceClient (this);
+                generationPool->addSource (*this);
             }
         }
 
@@ -135,7 +199,10 @@ public:
         reader = nullptr;
     }
 
-    int useTimeSlice() override
+    /** Called by the GenerationPool, returns the number of milliseconds before it should
+        be called again or -1 if it's finished.
+    */
+    int processNextBlock()
     {
         if (isFullyLoaded())
         {
@@ -187,12 +254,20 @@ public:
     unsigned int numChannels = 0;
     juce::int64 hashCode = 0;
 
+    bool isVisible() const noexcept     { return owner.isVisible; }
+
+    // These are only used by the GenerationPool while holding its lock
+    juce::uint32 nextCallTime = 0;
+    bool isBeingProcessed = false;
+
 private:
     TracktionThumbnail& owner;
+    juce::SharedResourcePointer<GenerationPool> generationPool;
     std::unique_ptr<juce::InputSource> source;
     std::unique_ptr<juce::AudioFormatReader> reader;
     juce::CriticalSection readerLock;
     juce::uint32 lastReaderUseTime = 0;
+    juce::AudioBuffer<float> readBuffer;
 
     void createReader()
     {
@@ -221,15 +296,37 @@ private:
                 juce::HeapBlock<MinMaxValue> levelData ((size_t) numThumbSamps * 2);
                 MinMaxValue* levels[2] = { levelData, levelData + numThumbSamps };
 
-                for (int i = 0; i < numThumbSamps; ++i)
+                // Read the whole block at once and find the levels with the vectorised
+                // functions, rather than making the reader read each thumbnail sample
+                const auto spts = owner.samplesPerThumbSample;
+                const auto readStart = firstThumbIndex * (juce::int64) spts;
+                const auto numToRead = (int) juce::jlimit ((juce::int64) 0, (juce::int64) numThumbSamps * spts,
+                                                           lengthInSamples - readStart);
+
+                readBuffer.setSize (2, std::max (1, numToRead), false, false, true);
+                readBuffer.clear();
+
+                if (numToRead > 0)
+                    reader->read (&readBuffer, 0, numToRead, readStart, true, true);
+
+                for (int chan = 0; chan < 2; ++chan)
                 {
-                    float lowestLeft, highestLeft, lowestRight, highestRight;
+                    auto samples = readBuffer.getReadPointer (chan);
 
-                    reader->readMaxLevels ((firstThumbIndex + i) * owner.samplesPerThumbSample, owner.samplesPerThumbSample,
-                                           lowestLeft, highestLeft, lowestRight, highestRight);
+                    for (int i = 0; i < numThumbSamps; ++i)
+                    {
+                        const auto num = std::min (spts, numToRead - i * spts);
 
-                    levels[0][i].setFloat (lowestLeft, highestLeft);
-                    levels[1][i].setFloat (lowestRight, highestRight);
+                        if (num > 0)
+                        {
+                            auto range = juce::FloatVectorOperations::findMinAndMax (samples + i * spts, num);
+                            levels[chan][i].setFloat (range.getStart(), range.getEnd());
+                        }
+                        else
+                        {
+                            levels[chan][i].setFloat (0.0f, 0.0f);
+                        }
+                    }
                 }
 
                 {
@@ -247,6 +344,101 @@ private:
 };
 
 //==============================================================================
+void TracktionThumbnail::GenerationPool::addSource (LevelDataSource& source)
+{
+    {
+        const juce::ScopedLock sl (lock);
+
+        if (sources.contains (&source))
+            return;
+
+        source.nextCallTime = 0;
+        sources.add (&source);
+    }
+
+    for (auto t : threads)
+        t->notify();
+}
+
+void TracktionThumbnail::GenerationPool::removeSource (LevelDataSource& source)
+{
+    for (;;)
+    {
+        {
+            const juce::ScopedLock sl (lock);
+
+            if (! source.isBeingProcessed)
+            {
+                sources.removeFirstMatchingValue (&source);
+                return;
+            }
+        }
+
+        // One of the threads is reading it so wait for it to finish
+        juce::Thread::yield();
+    }
+}
+
+int TracktionThumbnail::GenerationPool::processNextSource()
+{
+    LevelDataSource* next = nullptr;
+
+    {
+        const juce::ScopedLock sl (lock);
+        const auto now = juce::Time::getMillisecondCounter();
+        auto soonest = now + 500;
+
+        for (auto s : sources)
+        {
+            if (s->isBeingProcessed)
+                continue;
+
+            if (s->nextCallTime > now)
+            {
+                soonest = std::min (soonest, s->nextCallTime);
+                continue;
+            }
+
+            if (next == nullptr || (s->isVisible() && ! next->isVisible()))
+                next = s;
+
+            if (next->isVisible())
+                break;
+        }
+
+        if (next == nullptr)
+            return (int) (soonest - now);
+
+        next->isBeingProcessed = true;
+    }
+
+    const int msUntilNextCall = next->processNextBlock();
+
+    {
+        const juce::ScopedLock sl (lock);
+        next->isBeingProcessed = false;
+        sources.removeFirstMatchingValue (next);
+
+        // Put it to the back of the queue so the others get a turn
+        if (msUntilNextCall >= 0)
+        {
+            next->nextCallTime = juce::Time::getMillisecondCounter() + (juce::uint32) msUntilNextCall;
+            sources.add (next);
+        }
+    }
+
+    return 0;
+}
+
+//==============================================================================
+/**
+    The levels for one channel of a thumbnail.
+
+    As well as the full resolution values, this keeps a set of summaries, each with a
+    value for every levelFactor values of the one below it. Finding the min and max of a
+    range only has to read the values at its ends from the finer levels and then uses the
+    coarsest one it can, so drawing takes about the same time at any zoom level.
+*/
 class TracktionThumbnail::ThumbData
 {
 public:
@@ -255,6 +447,9 @@ public:
         ensureSize (numThumbSamples);
     }
 
+    enum { levelFactor = 8, maxNumSummaries = 5 };
+
+    /** If the values are changed with this rather than write(), updateSummaries must be called. */
     inline MinMaxValue* getData (int thumbSampleIndex) noexcept
     {
         jassert (thumbSampleIndex < data.size());
@@ -266,6 +461,16 @@ public:
         return data.size();
     }
 
+    size_t getNumBytesUsed() const noexcept
+    {
+        auto total = (size_t) data.size();
+
+        for (auto& s : summaries)
+            total += (size_t) s.size();
+
+        return total * sizeof (MinMaxValue);
+    }
+
     void getMinMax (int startSample, int endSample, MinMaxValue& result) const noexcept
     {
         if (startSample >= 0)
@@ -273,15 +478,27 @@ public:
             endSample = std::min (endSample, data.size() - 1);
 
             juce::int8 mx = -128, mn = 127;
+            const auto numLevels = 1 + (int) summaries.size();
 
-            while (startSample <= endSample)
+            for (int level = 0; startSample <= endSample; ++level)
             {
-                const MinMaxValue& v = data.getReference (startSample);
+                auto& values = getLevel (level);
+
+                if (level == numLevels - 1 || endSample - startSample < 2 * levelFactor)
+                {
+                    accumulate (values, startSample, endSample, mn, mx);
+                    break;
+                }
 
-                if (v.getMinValue() < mn)  mn = v.getMinValue();
-                    if (v.getMaxValue() > mx)  mx = v.getMaxValue();
+                // Read the ends until they line up with the values of the next level
+                for (; startSample % levelFactor != 0; ++startSample)
+                    accumulate (values, startSample, startSample, mn, mx);
 
-                        ++startSample;
+                for (; (endSample + 1) % levelFactor != 0; --endSample)
+                    accumulate (values, endSample, endSample, mn, mx);
+
+                startSample /= levelFactor;
+                endSample = (endSample + 1) / levelFactor - 1;
             }
 
             if (mn <= mx)
@@ -305,6 +522,28 @@ public:
 
         for (int i = 0; i < numValues; ++i)
             dest[i] = values[i];
+
+        updateSummaries (startIndex, startIndex + numValues);
+    }
+
+    /** Recalculates the summaries for a range of the full resolution values. */
+    void updateSummaries (int startIndex, int endIndex)
+    {
+        for (size_t i = 0; i < summaries.size(); ++i)
+        {
+            auto& source = getLevel ((int) i);
+            auto& dest = summaries[i];
+
+            startIndex /= levelFactor;
+            endIndex = std::min (dest.size(), (endIndex + levelFactor - 1) / levelFactor);
+
+            for (int j = startIndex; j < endIndex; ++j)
+            {
+                juce::int8 mx = -128, mn = 127;
+                accumulate (source, j * levelFactor, std::min (source.size(), (j + 1) * levelFactor) - 1, mn, mx);
+                dest.getReference (j).set (mn, mx);
+            }
+        }
     }
 
     void resetPeak() noexcept
@@ -316,9 +555,11 @@ public:
     {
         if (peakLevel < 0)
         {
-            for (int i = 0; i < data.size(); ++i)
+            auto& values = getLevel ((int) summaries.size());
+
+            for (int i = 0; i < values.size(); ++i)
             {
-                const int peak = data[i].getPeak();
+                const int peak = values.getReference (i).getPeak();
 
                 if (peak > peakLevel)
                     peakLevel = peak;
@@ -330,18 +571,57 @@ public:
 
 private:
     juce::Array<MinMaxValue> data;
+    std::vector<juce::Array<MinMaxValue>> summaries;
     int peakLevel = -1;
 
+    const juce::Array<MinMaxValue>& getLevel (int level) const noexcept
+    {
+        return level == 0 ? data : summaries[(size_t) (level - 1)];
+    }
+
+    static void accumulate (const juce::Array<MinMaxValue>& values, int start, int end,
+                            juce::int8& mn, juce::int8& mx) noexcept
+    {
+        for (int i = start; i <= end; ++i)
+        {
+            const MinMaxValue& v = values.getReference (i);
+
+            if (v.getMinValue() < mn)  mn = v.getMinValue();
+            if (v.getMaxValue() > mx)  mx = v.getMaxValue();
+        }
+    }
+
     void ensureSize (int thumbSamples)
     {
         const int extraNeeded = thumbSamples - data.size();
 
         if (extraNeeded > 0)
+        {
             data.insertMultiple (-1, MinMaxValue(), extraNeeded);
+
+            // Summaries are only worth having when they cover a few values of their own
+            summaries.clear();
+
+            for (int size = data.size(); size > 2 * levelFactor && (int) summaries.size() < maxNumSummaries;)
+            {
+                size = (size + levelFactor - 1) / levelFactor;
+                summaries.emplace_back();
+                summaries.back().insertMultiple (0, MinMaxValue(), size);
+            }
+
+            updateSummaries (0, data.size());
+        }
     }
 };
 
 //==============================================================================
+/**
+    Holds the min and max of each pixel column of the area that was last drawn.
+
+    The columns sit on a grid of the pixel width, rather than starting wherever the
+    area does, so when the view's scrolled at the same zoom only the columns that have
+    come into view need reading. The ones that are still visible are moved across.
+*/
 class TracktionThumbnail::CachedWindow
 {
 public:
@@ -362,7 +642,7 @@ public:
             && juce::isPositiveAndBelow (channelNum, numChannelsCached))
         {
             auto clip = g.getClipBounds().withTrimmedRight (useHighRes ? -1 : 0)
-                                         .getIntersection (area.withWidth (std::min (numSamplesCached, area.getWidth())));
+                                         .getIntersection (area.withWidth (std::min (numVisibleColumns, area.getWidth())));
 
             if (! clip.isEmpty())
             {
@@ -371,7 +651,7 @@ public:
                 auto midY = (topY + bottomY) * 0.5f;
                 auto vscale = verticalZoomFactor * (bottomY - topY) / 256.0f;
 
-                auto* cacheData = getData (channelNum, clip.getX() - area.getX());
+                auto* cacheData = getVisibleData (channelNum, clip.getX() - area.getX());
 
                 auto x = (float) clip.getX();
 
@@ -466,133 +746,215 @@ public:
         }
     }
 
+    int createVertices (std::vector<juce::Point<float>>& vertices, juce::Rectangle<float> area,
+                        EditTimeRange time, int channelNum, float verticalZoomFactor,
+                        double rate, int numChans, int sampsPerThumbSample,
+                        LevelDataSource* levelData, const juce::OwnedArray<ThumbData>& chans)
+    {
+        vertices.clear();
+        const auto width = (int) std::ceil (area.getWidth());
+
+        if (! (refillCache (width, time, rate, numChans, sampsPerThumbSample, levelData, chans)
+                && juce::isPositiveAndBelow (channelNum, numChannelsCached)))
+            return 0;
+
+        const auto topY = area.getY();
+        const auto bottomY = area.getBottom();
+        const auto midY = area.getCentreY();
+        const auto vscale = verticalZoomFactor * area.getHeight() / 256.0f;
+        const auto numColumns = std::min (numVisibleColumns, width);
+        auto* cacheData = getVisibleData (channelNum, 0);
+
+        // A column with nothing in it gets a pair at the centre line, which draws nothing
+        vertices.resize ((size_t) numColumns * 2);
+
+        for (int i = 0; i < numColumns; ++i)
+        {
+            const auto& v = cacheData[i];
+            const auto x = area.getX() + (float) i;
+            auto top = midY, bottom = midY;
+
+            if (v.isNonZero())
+            {
+                top    = std::max (midY - v.getMaxValue() * vscale - 0.3f, topY);
+                bottom = std::min (midY - v.getMinValue() * vscale + 0.3f, bottomY);
+            }
+
+            vertices[(size_t) i * 2]     = { x, top };
+            vertices[(size_t) i * 2 + 1] = { x, bottom };
+        }
+
+        return (int) vertices.size();
+    }
+
 private:
-    juce::Array<MinMaxValue> data;
-    double cachedStart = 0, cachedTimePerPixel = 0;
-    int numChannelsCached = 0, numSamplesCached = 0;
+    std::vector<MinMaxValue> data, newData;
+    juce::int64 firstColumnCached = 0;
+    double cachedTimePerPixel = 0;
+    int numChannelsCached = 0, numColumnsCached = 0;
+    int firstVisibleColumn = 0, numVisibleColumns = 0;
     bool cacheNeedsRefilling = true;
 
-    bool refillCache (int numSamples, EditTimeRange time,
+    bool refillCache (int numColumns, EditTimeRange time,
                       double rate, int numChans, int sampsPerThumbSample,
                       LevelDataSource* levelData, const juce::OwnedArray<ThumbData>& chans)
     {
-        auto timePerPixel = time.getLength() / numSamples;
+        auto timePerPixel = time.getLength() / numColumns;
 
-        if (numSamples <= 0 || timePerPixel <= 0.0 || rate <= 0)
+        if (numColumns <= 0 || timePerPixel <= 0.0 || rate <= 0 || numChans <= 0)
         {
             invalidate();
             return false;
         }
 
-        if (numSamples == numSamplesCached
-             && numChannelsCached == numChans
-             && time.getStart() == cachedStart
-             && timePerPixel == cachedTimePerPixel
-             && ! cacheNeedsRefilling)
+        // The length of a range that's been scrolled can come out very slightly different
+        const bool sameGrid = ! cacheNeedsRefilling
+                               && numChans == numChannelsCached
+                               && std::abs (timePerPixel - cachedTimePerPixel) <= cachedTimePerPixel * 1.0e-9;
+
+        if (sameGrid)
+            timePerPixel = cachedTimePerPixel;
+
+        const auto firstColumn = (juce::int64) std::floor (time.getStart() / timePerPixel + 0.5);
+
+        if (sameGrid && firstColumn >= firstColumnCached
+             && firstColumn + numColumns <= firstColumnCached + numColumnsCached)
         {
-            return ! cacheNeedsRefilling;
+            firstVisibleColumn = (int) (firstColumn - firstColumnCached);
+            numVisibleColumns = numColumns;
+            return true;
         }
 
-        auto startTime = time.getStart();
+        newData.resize ((size_t) (numColumns * numChans));
+        auto overlapStart = firstColumn, overlapEnd = firstColumn;
+
+        if (sameGrid)
+        {
+            overlapStart = juce::jlimit (firstColumn, firstColumn + numColumns, firstColumnCached);
+            overlapEnd   = juce::jlimit (overlapStart, firstColumn + numColumns, firstColumnCached + numColumnsCached);
+
+            if (overlapEnd > overlapStart)
+                for (int chan = 0; chan < numChans; ++chan)
+                    std::copy_n (data.data() + chan * numColumnsCached + (overlapStart - firstColumnCached),
+                                 (size_t) (overlapEnd - overlapStart),
+                                 newData.data() + chan * numColumns + (overlapStart - firstColumn));
+        }
 
-        numSamplesCached = numSamples;
+        std::swap (data, newData);
+        firstColumnCached = firstColumn;
+        numColumnsCached = numColumns;
         numChannelsCached = numChans;
-        cachedStart = startTime;
         cachedTimePerPixel = timePerPixel;
         cacheNeedsRefilling = false;
+        firstVisibleColumn = 0;
+        numVisibleColumns = numColumns;
+
+        if (overlapEnd > overlapStart)
+        {
+            fillColumns (firstColumn, overlapStart, rate, sampsPerThumbSample, levelData, chans);
+            fillColumns (overlapEnd, firstColumn + numColumns, rate, sampsPerThumbSample, levelData, chans);
+        }
+        else
+        {
+            fillColumns (firstColumn, firstColumn + numColumns, rate, sampsPerThumbSample, levelData, chans);
+        }
+
+        return true;
+    }
+
+    /** Reads the levels for some of the cached columns, given as indexes on the grid. */
+    void fillColumns (juce::int64 startColumn, juce::int64 endColumn,
+                      double rate, int sampsPerThumbSample,
+                      LevelDataSource* levelData, const juce::OwnedArray<ThumbData>& chans)
+    {
+        if (endColumn <= startColumn)
+            return;
 
-        ensureSize (numSamples);
+        const auto timePerPixel = cachedTimePerPixel;
+        const auto startIndex = (int) (startColumn - firstColumnCached);
+        const auto numColumns = (int) (endColumn - startColumn);
 
         if (timePerPixel * rate <= sampsPerThumbSample && levelData != nullptr)
         {
-            auto sample = juce::roundToInt (startTime * rate);
+            auto getSample = [=] (juce::int64 column) { return (juce::int64) std::llround (column * timePerPixel * rate); };
+
             juce::Array<float> levels, lastLevels;
             lastLevels.insertMultiple (0, 0.0f, numChannelsCached * 2);
-            int i;
 
-            for (i = 0; i < numSamples; ++i)
+            // Each column joins up with the one before it, so that one's levels are needed too
+            for (auto column = std::max ((juce::int64) 0, startColumn - 1); column < endColumn; ++column)
             {
-                auto nextSample = juce::roundToInt ((startTime + timePerPixel) * rate);
+                auto sample = getSample (column);
+                auto nextSample = getSample (column + 1);
+                const auto index = (int) (column - startColumn) + startIndex;
+                const bool isCached = column >= startColumn;
 
-                if (sample >= 0)
+                if (sample < 0 || sample >= levelData->lengthInSamples)
                 {
-                    if (sample >= levelData->lengthInSamples)
-                    {
+                    if (isCached)
                         for (int chan = 0; chan < numChannelsCached; ++chan)
-                            *getData (chan, i) = MinMaxValue();
-                    }
-                    else
-                    {
-                        levelData->getLevels (sample, std::max (1, nextSample - sample), levels);
+                            *getData (chan, index) = MinMaxValue();
 
-                        auto totalChans = std::min (levels.size() / 2, numChannelsCached);
+                    continue;
+                }
 
-                        for (int chan = 0; chan < totalChans; ++chan)
-                        {
-                            int c1 = chan * 2;
-                            int c2 = chan * 2 + 1;
-                            float chan1 = levels.getUnchecked (c1);
-                            float chan2 = levels.getUnchecked (c2);
+                levelData->getLevels (sample, (int) std::max ((juce::int64) 1, nextSample - sample), levels);
+
+                auto totalChans = std::min (levels.size() / 2, numChannelsCached);
 
-                            getData (chan, i)->setFloat (std::min (chan1, lastLevels[c2]),
+                for (int chan = 0; chan < totalChans; ++chan)
+                {
+                    int c1 = chan * 2;
+                    int c2 = chan * 2 + 1;
+                    float chan1 = levels.getUnchecked (c1);
+                    float chan2 = levels.getUnchecked (c2);
+
+                    if (isCached)
+                        getData (chan, index)->setFloat (std::min (chan1, lastLevels[c2]),
                                                          std::max (chan2, lastLevels[c1]));
 
-                            lastLevels.getReference (c1) = chan1;
-                            lastLevels.getReference (c2) = chan2;
-                        }
-                    }
+                    lastLevels.getReference (c1) = chan1;
+                    lastLevels.getReference (c2) = chan2;
                 }
-
-                startTime += timePerPixel;
-                sample = nextSample;
             }
-
-            numSamplesCached = i;
         }
         else
         {
             jassert (chans.size() == numChannelsCached);
 
+            auto timeToThumbSampleFactor = rate / (double) sampsPerThumbSample;
+            auto getThumbSample = [=] (juce::int64 column) { return juce::roundToInt (column * timePerPixel * timeToThumbSampleFactor); };
+
             for (int channelNum = 0; channelNum < numChannelsCached; ++channelNum)
             {
                 ThumbData* channelData = chans.getUnchecked (channelNum);
-                MinMaxValue* cacheData = getData (channelNum, 0);
+                MinMaxValue* cacheData = getData (channelNum, startIndex);
+                auto sample = getThumbSample (startColumn);
 
-                auto timeToThumbSampleFactor = rate / (double) sampsPerThumbSample;
-
-                startTime = cachedStart;
-                auto sample = juce::roundToInt (startTime * timeToThumbSampleFactor);
-
-                for (int i = numSamples; --i >= 0;)
+                for (int i = 0; i < numColumns; ++i)
                 {
-                    auto nextSample = juce::roundToInt ((startTime + timePerPixel) * timeToThumbSampleFactor);
+                    auto nextSample = getThumbSample (startColumn + i + 1);
 
                     channelData->getMinMax (sample, nextSample, *cacheData);
 
                     ++cacheData;
-                    startTime += timePerPixel;
                     sample = nextSample;
                 }
             }
         }
-
-        return true;
     }
 
     MinMaxValue* getData (int channelNum, int cacheIndex) noexcept
     {
         jassert (juce::isPositiveAndBelow (channelNum, numChannelsCached)
-                  && juce::isPositiveAndBelow (cacheIndex, data.size()));
+                  && juce::isPositiveAndBelow (cacheIndex, numColumnsCached));
 
-        return data.getRawDataPointer() + channelNum * numSamplesCached + cacheIndex;
+        return data.data() + channelNum * numColumnsCached + cacheIndex;
     }
 
-    void ensureSize (int numSamples)
+    const MinMaxValue* getVisibleData (int channelNum, int visibleIndex) noexcept
     {
-        auto itemsRequired = numSamples * numChannelsCached;
-
-        if (data.size() < itemsRequired)
-            data.insertMultiple (-1, MinMaxValue(), itemsRequired - data.size());
+        return getData (channelNum, firstVisibleColumn + visibleIndex);
     }
 };
 
@@ -677,6 +1039,9 @@ bool TracktionThumbnail::loadFrom (juce::InputStream& rawInput)
         for (int chan = 0; chan < numChannels; ++chan)
             channels.getUnchecked(chan)->getData(i)->read (input);
 
+    for (auto c : channels)
+        c->updateSummaries (0, numThumbnailSamples);
+
     return true;
 }
 
@@ -830,6 +1195,11 @@ double TracktionThumbnail::getTotalLength() const noexcept
     return sampleRate > 0 ? (totalSamples / sampleRate) : 0;
 }
 
+void TracktionThumbnail::setIsVisible (bool shouldBeVisible) noexcept
+{
+    isVisible = shouldBeVisible;
+}
+
 bool TracktionThumbnail::isFullyLoaded() const noexcept
 {
     const juce::ScopedLock sl (lock);
@@ -848,6 +1218,17 @@ juce::int64 TracktionThumbnail::getNumSamplesFinished() const noexcept
     return numSamplesFinished;
 }
 
+size_t TracktionThumbnail::getNumBytesUsed() const
+{
+    const juce::ScopedLock sl (lock);
+    size_t total = 0;
+
+    for (auto c : channels)
+        total += c->getNumBytesUsed();
+
+    return total;
+}
+
 float TracktionThumbnail::getApproximatePeak() const
 {
     const juce::ScopedLock sl (lock);
@@ -911,4 +1292,81 @@ void TracktionThumbnail::drawChannels (juce::Graphics& g, juce::Rectangle<int> a
     }
 }
 
+int TracktionThumbnail::createWaveformVertices (std::vector<juce::Point<float>>& vertices, juce::Rectangle<float> area,
+                                                EditTimeRange time, int channelNum, float verticalZoomFactor)
+{
+    const juce::ScopedLock sl2 (sourceLock);
+    const juce::ScopedLock sl (lock);
+
+    return window->createVertices (vertices, area, time, channelNum, verticalZoomFactor,
+                                   sampleRate, numChannels, samplesPerThumbSample, source.get(), channels);
+}
+
+//==============================================================================
+#if TRACKTION_UNIT_TESTS
+
+class ThumbnailWindowTests : public juce::UnitTest
+{
+public:
+    ThumbnailWindowTests() : juce::UnitTest ("TracktionThumbnail", "Tracktion") {}
+
+    void runTest() override
+    {
+        juce::AudioFormatManager formatManager;
+        juce::AudioThumbnailCache thumbnailCache (1);
+
+        const double sampleRate = 44100.0;
+        const int numSamples = (int) sampleRate * 4;
+        juce::AudioBuffer<float> buffer (1, numSamples);
+
+        for (int i = 0; i < numSamples; ++i)
+            buffer.setSample (0, i, std::sin (i * 0.01f) * ((i / 1000) % 2 == 0 ? 0.9f : 0.3f));
+
+        auto createThumbnail = [&]
+        {
+            auto t = std::make_unique<TracktionThumbnail> (256, formatManager, thumbnailCache);
+            t->reset (1, sampleRate, numSamples);
+            t->addBlock (0, buffer, 0, numSamples);
+            return t;
+        };
+
+        const juce::Rectangle<float> area (0.0f, 0.0f, 200.0f, 100.0f);
+        const EditTimeRange time (0.5, 2.5);
+        const double scroll = 37 * time.getLength() / area.getWidth();
+
+        beginTest ("Vertices cover each column");
+        {
+            auto thumbnail = createThumbnail();
+            std::vector<juce::Point<float>> vertices;
+
+            expectEquals (thumbnail->createWaveformVertices (vertices, area, time, 0, 1.0f), 400);
+
+            for (size_t i = 0; i < vertices.size(); i += 2)
+                expect (vertices[i].y <= vertices[i + 1].y);
+        }
+
+        beginTest ("Scrolling gives the same columns as drawing from scratch");
+        {
+            auto scrolled = createThumbnail();
+            auto fresh = createThumbnail();
+            std::vector<juce::Point<float>> scrolledVertices, freshVertices;
+
+            scrolled->createWaveformVertices (scrolledVertices, area, time, 0, 1.0f);
+            scrolled->createWaveformVertices (scrolledVertices, area, time + scroll, 0, 1.0f);
+            fresh->createWaveformVertices (freshVertices, area, time + scroll, 0, 1.0f);
+
+            expect (scrolledVertices == freshVertices);
+
+            scrolled->createWaveformVertices (scrolledVertices, area, time, 0, 1.0f);
+            fresh->createWaveformVertices (freshVertices, area, time, 0, 1.0f);
+
+            expect (scrolledVertices == freshVertices);
+        }
+    }
+};
+
+static ThumbnailWindowTests thumbnailWindowTests;
+
+#endif
+
 }
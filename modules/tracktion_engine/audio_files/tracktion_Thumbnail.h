@@ -51,17 +51,33 @@ public:
     void getApproximateMinMax (double startTime, double endTime, int channelIndex,
                                float& minValue, float& maxValue) const noexcept override;
 
+    /** Returns the memory used by the levels of all the channels. */
+    size_t getNumBytesUsed() const;
+
+    /** Thumbnails that are visible are generated before the ones that aren't. */
+    void setIsVisible (bool) noexcept;
+
     void drawChannel (juce::Graphics&, juce::Rectangle<int> area, bool useHighRes,
                       EditTimeRange time, int channelNum, float verticalZoomFactor);
 
     void drawChannels (juce::Graphics&, juce::Rectangle<int> area, bool useHighRes,
                        EditTimeRange time, float verticalZoomFactor);
 
+    /** Fills a vector with a channel's waveform as a triangle strip, so it can be drawn on the
+        GPU, e.g. by copying it straight into an OpenGL vertex buffer and drawing it with
+        GL_TRIANGLE_STRIP. Each pixel column of the area has two vertices, its top and then
+        its bottom, in the same coordinates as the area. The vector keeps its storage, so
+        reusing it for each frame doesn't allocate. Returns the number of vertices.
+    */
+    int createWaveformVertices (std::vector<juce::Point<float>>& vertices, juce::Rectangle<float> area,
+                                EditTimeRange time, int channelNum, float verticalZoomFactor);
+
 private:
     //==============================================================================
     juce::AudioFormatManager& formatManagerToUse;
     juce::AudioThumbnailCache& cache;
 
+    class GenerationPool;
     class LevelDataSource;
     struct MinMaxValue;
     class ThumbData;
@@ -75,6 +91,7 @@ private:
     juce::int64 totalSamples = 0, numSamplesFinished = 0;
     juce::int32 numChannels = 0;
     double sampleRate = 0;
+    std::atomic<bool> isVisible { true };
     juce::CriticalSection lock, sourceLock;
 
     bool setDataSource (LevelDataSource*);
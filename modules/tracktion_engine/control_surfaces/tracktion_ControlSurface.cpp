@@ -375,10 +375,21 @@ void ControlSurface::userChangedMarkerBank (int deltaMarkers)
 
 void ControlSurface::updateDeviceState()
 {
+    // The surface may have cleared its displays or changed what its faders show, so everything's resent
+    owner->forgetSentState();
     owner->updateDeviceState();
+    owner->flushPendingUpdates();
     owner->changeParamBank (0);
 }
 
+void ControlSurface::channelLevelsChanged (const juce::Array<int>& channels, const juce::Array<float>& levels)
+{
+    jassert (channels.size() == levels.size());
+
+    for (int i = 0; i < channels.size(); ++i)
+        channelLevelChanged (channels.getUnchecked (i), levels.getUnchecked (i));
+}
+
 void ControlSurface::userToggledEtoE()             { performIfNotSafeRecording (&AppFunctions::toggleEndToEnd); }
 void ControlSurface::userPressedSave()             { performIfNotSafeRecording (&AppFunctions::saveEdit); }
 void ControlSurface::userPressedSaveAs()           { performIfNotSafeRecording (&AppFunctions::saveEditAs); }
@@ -116,6 +116,11 @@ public:
     // level is 0 to 1.0
     virtual void channelLevelChanged (int channel, float level) = 0;
 
+    // called with all the meters that have changed since the last update. By default this
+    // calls channelLevelChanged() for each one, but a device whose protocol can send several
+    // meters in one message can override it to do that.
+    virtual void channelLevelsChanged (const juce::Array<int>& channels, const juce::Array<float>& levels);
+
     // when a track is selected or deselected
     virtual void trackSelectionChanged (int channel, bool isSelected) = 0;
 
@@ -165,6 +170,11 @@ public:
     virtual void auxBankChanged (int)                   {}
 
     virtual bool wantsMessage (const juce::MidiMessage&) { return true; }
+
+    // called on the MIDI input thread for each message the device wants. A device that can
+    // deal with a message there, e.g. by queueing up its own work, should return true. Otherwise
+    // the message is passed to acceptMidiMessage() on the message thread
+    virtual bool handleMidiMessageOnMidiThread (const juce::MidiMessage&) { return false; }
     virtual bool eatsAllMessages()                      { return true; }
     virtual bool canSetEatsAllMessages()                { return false; }
     virtual void setEatsAllMessages(bool)               {}
@@ -343,6 +353,10 @@ public:
     int numberOfFaderChannels = 0;
     int numCharactersForTrackNames = 0;
 
+    // limits how many fader, pan and meter values are sent to the device each second, e.g. to fit
+    // the bandwidth of its MIDI port. Values that don't fit are sent later. 0 means there's no limit
+    int maxValueUpdatesPerSecond = 0;
+
     // is banking to the right allowed to show empty tracks
     bool allowBankingOffEnd = false;
 
@@ -86,6 +86,8 @@ void CustomControlSurface::init()
     eatsAllMidi                     = false;
     wantsClock                      = false;
     allowBankingOffEnd              = true;
+
+    queuedActions.resize ((size_t) actionFifo.getTotalSize());
 }
 
 CustomControlSurface::~CustomControlSurface()
@@ -133,6 +135,7 @@ void CustomControlSurface::updateOrCreateMappingForID (int id, String addr, int
     mappingToUpdate->channel    = channel;
     mappingToUpdate->function   = id;
 
+    updateMappingTable();
     sendChangeMessage();
 }
 
@@ -243,6 +246,7 @@ bool CustomControlSurface::loadFromXml (const juce::XmlElement& xml)
         mapping->note     = node->getIntAttribute ("note", -1);
     }
 
+    updateMappingTable();
     return true;
 }
 
@@ -378,21 +382,136 @@ bool CustomControlSurface::wantsMessage (const MidiMessage& m)
 
         if (getEdit() != nullptr)
         {
-            for (auto mapping : mappings)
-            {
-                if (((id == mapping->id && id != 0) || (note == mapping->note && note != -1))
-                     && channel == mapping->channel
-                     && mapping->function)
-                {
-                    return true;
-                }
-            }
+            auto table = getMappingTable();
+            return table != nullptr && table->actionsForKeys.count (MappingTable::getKey (channel, id, note)) > 0;
         }
     }
 
     return false;
 }
 
+bool CustomControlSurface::handleMidiMessageOnMidiThread (const MidiMessage& m)
+{
+    // Anything to do with learning mappings needs the message thread
+    if (listeningOnRow >= 0 || engine.getMidiLearnState().isActive())
+        return false;
+
+    if (! m.isController() && ! m.isNoteOn())
+        return true;
+
+    QueuedAction queued;
+
+    if (m.isController())
+    {
+        int val;
+        midiThreadRpnParser.parseControllerMessage (m, queued.controllerID, queued.channel, val);
+        queued.value = val / 127.0f;
+    }
+    else
+    {
+        queued.note = m.getNoteNumber();
+        queued.channel = m.getChannel();
+        queued.value = 1.0f;
+    }
+
+    auto table = getMappingTable();
+
+    if (table == nullptr)
+        return true;
+
+    auto found = table->actionsForKeys.find (MappingTable::getKey (queued.channel, queued.controllerID, queued.note));
+
+    if (found == table->actionsForKeys.end() || found->second.isEmpty())
+        return true;
+
+    // If the queue's full, the message thread can deal with it the slow way
+    if (actionFifo.getFreeSpace() < found->second.size())
+        return false;
+
+    const auto scope = actionFifo.write (found->second.size());
+    int index = 0;
+
+    for (auto& action : found->second)
+    {
+        queued.action = action;
+        queuedActions[(size_t) (index < scope.blockSize1 ? scope.startIndex1 + index
+                                                         : scope.startIndex2 + index - scope.blockSize1)] = queued;
+        ++index;
+    }
+
+    triggerAsyncUpdate();
+    return true;
+}
+
+void CustomControlSurface::performQueuedActions()
+{
+    CRASH_TRACER
+
+    if (getEdit() == nullptr)
+    {
+        actionFifo.reset();
+        return;
+    }
+
+    const auto scope = actionFifo.read (actionFifo.getNumReady());
+
+    auto perform = [this] (const QueuedAction& q)
+    {
+        lastControllerID = q.controllerID;
+        lastControllerNote = q.note;
+        lastControllerChannel = q.channel;
+        lastControllerValue = q.value;
+
+        (this->*q.action.actionFunc) (q.value, q.action.param);
+    };
+
+    for (int i = 0; i < scope.blockSize1; ++i)
+        perform (queuedActions[(size_t) (scope.startIndex1 + i)]);
+
+    for (int i = 0; i < scope.blockSize2; ++i)
+        perform (queuedActions[(size_t) (scope.startIndex2 + i)]);
+}
+
+//==============================================================================
+int CustomControlSurface::MappingTable::getKey (int channel, int controllerID, int note) noexcept
+{
+    // Controller IDs start at 0x10000 so they can't clash with note numbers
+    return (channel << 18) | (controllerID != 0 ? controllerID : note);
+}
+
+void CustomControlSurface::updateMappingTable()
+{
+    TRACKTION_ASSERT_MESSAGE_THREAD
+    ReferenceCountedObjectPtr<MappingTable> table (new MappingTable());
+
+    for (auto mapping : mappings)
+    {
+        if (mapping->function == 0)
+            continue;
+
+        Array<MappedAction> actions;
+
+        for (auto actionFunction : actionFunctionList)
+            if (actionFunction->id == mapping->function)
+                actions.add ({ actionFunction->actionFunc, actionFunction->param });
+
+        if (mapping->id != 0)
+            table->actionsForKeys[MappingTable::getKey (mapping->channel, mapping->id, -1)].addArray (actions);
+
+        if (mapping->note != -1)
+            table->actionsForKeys[MappingTable::getKey (mapping->channel, 0, mapping->note)].addArray (actions);
+    }
+
+    const SpinLock::ScopedLockType sl (mappingTableLock);
+    std::swap (mappingTable, table);
+}
+
+ReferenceCountedObjectPtr<CustomControlSurface::MappingTable> CustomControlSurface::getMappingTable() const
+{
+    const SpinLock::ScopedLockType sl (mappingTableLock);
+    return mappingTable;
+}
+
 void CustomControlSurface::oscMessageReceived (const juce::OSCMessage& m)
 {
     packetsIn++;
@@ -541,24 +660,13 @@ void CustomControlSurface::acceptMidiMessage (const MidiMessage& m)
             updateOrCreateMappingForID (ed->getParameterChangeHandler().getPendingActionFunctionId (true),
                                         lastControllerAddr, lastControllerChannel, lastControllerNote, lastControllerID);
         }
-        else
+        else if (auto table = getMappingTable())
         {
-            for (auto mapping : mappings)
-            {
-                if (((lastControllerID    == mapping->id   && lastControllerID   != 0) ||
-                    (lastControllerNote   == mapping->note && lastControllerNote != -1)) &&
-                    lastControllerChannel == mapping->channel)
-                {
-                    for (auto actionFunction : actionFunctionList)
-                    {
-                        if (actionFunction->id == mapping->function)
-                        {
-                            auto actionFunc = actionFunction->actionFunc;
-                            (this->*actionFunc) (lastControllerValue, actionFunction->param);
-                        }
-                    }
-                }
-            }
+            auto found = table->actionsForKeys.find (MappingTable::getKey (lastControllerChannel, lastControllerID, lastControllerNote));
+
+            if (found != table->actionsForKeys.end())
+                for (auto& action : found->second)
+                    (this->*action.actionFunc) (lastControllerValue, action.param);
         }
     }
 }
@@ -924,6 +1032,7 @@ void CustomControlSurface::showMappingsListForRow (int row)
             row++;
         }
 
+        updateMappingTable();
         sendChangeMessage();
     }
     else if (r != 0)
@@ -933,6 +1042,7 @@ void CustomControlSurface::showMappingsListForRow (int row)
 
         mappings[row]->function = r;
 
+        updateMappingTable();
         sendChangeMessage();
     }
 }
@@ -1044,6 +1154,7 @@ void CustomControlSurface::setLearntParam (bool keepListening)
             mappings[listeningOnRow]->addr    = lastControllerAddr;
             mappings[listeningOnRow]->note    = lastControllerNote;
             mappings[listeningOnRow]->channel = lastControllerChannel;
+            updateMappingTable();
         }
 
         if (! keepListening)
@@ -1062,11 +1173,18 @@ void CustomControlSurface::setLearntParam (bool keepListening)
 void CustomControlSurface::removeMapping (int index)
 {
     mappings.remove (index);
+    updateMappingTable();
 }
 
 void CustomControlSurface::handleAsyncUpdate()
 {
     CRASH_TRACER
+    performQueuedActions();
+
+    // Actions from the MIDI thread don't change anything that's shown
+    if (listeningOnRow < 0)
+        return;
+
     sendChangeMessage();
 
     if (listeningOnRow >= 0 && listeningOnRow == mappings.size())
@@ -1225,6 +1343,8 @@ void CustomControlSurface::loadFunctions()
         set.add (actionFunctionList[i]->id);
     }
    #endif
+
+    updateMappingTable();
 }
 
 void CustomControlSurface::addAllCommandItem (PopupMenu& menu)
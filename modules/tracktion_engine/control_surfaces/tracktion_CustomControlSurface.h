@@ -158,6 +158,7 @@ public:
     void updateMiscFeatures() override;
     void acceptMidiMessage (const juce::MidiMessage&) override;
     bool wantsMessage(const juce::MidiMessage&) override;
+    bool handleMidiMessageOnMidiThread (const juce::MidiMessage&) override;
     bool eatsAllMessages() override;
     bool canSetEatsAllMessages() override;
     void setEatsAllMessages(bool eatAll) override;
@@ -347,7 +348,7 @@ private:
     int lastControllerID = 0;
     float lastControllerValue = 0;
     int lastControllerChannel = 0;
-    int listeningOnRow = -1;
+    std::atomic<int> listeningOnRow { -1 };
 
     juce::OwnedArray<ActionFunctionInfo> actionFunctionList;
     juce::PopupMenu contextMenu;
@@ -390,7 +391,43 @@ private:
         bool wasNRPN = false;
     };
 
-    RPNParser rpnParser;
+    RPNParser rpnParser, midiThreadRpnParser;
+
+    //==============================================================================
+    struct MappedAction
+    {
+        ActionFunction actionFunc {};
+        int param = 0;
+    };
+
+    /** The mappings compiled into a table keyed on the channel and controller or note,
+        so incoming MIDI can be matched on the MIDI thread without searching the mappings.
+    */
+    struct MappingTable  : public juce::ReferenceCountedObject
+    {
+        static int getKey (int channel, int controllerID, int note) noexcept;
+
+        // A key that's present but has no actions is still mapped, so its messages are eaten
+        std::unordered_map<int, juce::Array<MappedAction>> actionsForKeys;
+    };
+
+    juce::ReferenceCountedObjectPtr<MappingTable> mappingTable;
+    juce::SpinLock mappingTableLock;
+
+    struct QueuedAction
+    {
+        MappedAction action;
+        float value = 0;
+        int controllerID = 0, note = -1, channel = 0;
+    };
+
+    // Filled by the MIDI thread and emptied on the message thread
+    juce::AbstractFifo actionFifo { 1024 };
+    std::vector<QueuedAction> queuedActions;
+
+    void updateMappingTable();
+    juce::ReferenceCountedObjectPtr<MappingTable> getMappingTable() const;
+    void performQueuedActions();
 
     //==============================================================================
     struct CustomControlSurfaceManager
@@ -45,8 +45,10 @@ ExternalController::ExternalController (Engine& e, ControlSurface* c)  : engine
     oscSettingsChanged();
 
     cs.initialiseDevice (isEnabled());
+    forgetSentState();
 
     updateDeviceState();
+    flushPendingUpdates();
     changeParamBank (0);
 }
 
@@ -115,7 +117,9 @@ void ExternalController::setEnabled (bool e)
         engine.getPropertyStorage().setPropertyItem (SettingID::externControlEnable, getName(), e);
 
         getControlSurface().initialiseDevice (isEnabled());
+        forgetSentState();
         updateDeviceState();
+        flushPendingUpdates();
         changeParamBank (0);
     }
 }
@@ -228,7 +232,9 @@ void ExternalController::midiInOutDevicesChanged()
     if (controlSurface != nullptr)
         getControlSurface().initialiseDevice (isEnabled());
 
+    forgetSentState();
     updateDeviceState();
+    flushPendingUpdates();
     changeParamBank (0);
 }
 
@@ -243,7 +249,9 @@ void ExternalController::oscSettingsChanged()
 
     getControlSurface().updateOSCSettings (oscInputPort, oscOutputPort, oscOutputAddr);
 
+    forgetSentState();
     updateDeviceState();
+    flushPendingUpdates();
     changeParamBank (0);
 }
 
@@ -308,19 +316,20 @@ void ExternalController::setShowSelectionColour (bool b)
     }
 }
 
+//==============================================================================
+// The faders, pans and meters are only sent when flushPendingUpdates() is next called
 void ExternalController::moveFader (int channelNum, float newSliderPos)
 {
     int i = getFaderIndexInActiveRegion (channelNum);
 
     if (i >= 0)
-        getControlSurface().moveFader (i, newSliderPos);
+        getShadow (faderShadows, i).pending = newSliderPos;
 }
 
 void ExternalController::moveMasterFaders (float newLeftPos, float newRightPos)
 {
-    CRASH_TRACER
-    if (controlSurface != nullptr)
-        getControlSurface().moveMasterLevelFader (newLeftPos, newRightPos);
+    masterFaderShadows[0].pending = newLeftPos;
+    masterFaderShadows[1].pending = newRightPos;
 }
 
 void ExternalController::movePanPot (int channelNum, float newPan)
@@ -328,7 +337,7 @@ void ExternalController::movePanPot (int channelNum, float newPan)
     int i = getFaderIndexInActiveRegion (channelNum);
 
     if (i >= 0)
-        getControlSurface().movePanPot (i, newPan);
+        getShadow (panShadows, i).pending = newPan;
 }
 
 void ExternalController::updateSoloAndMute (int channelNum, Track::MuteAndSoloLightState state, bool isBright)
@@ -336,7 +345,129 @@ void ExternalController::updateSoloAndMute (int channelNum, Track::MuteAndSoloLi
     int i = getFaderIndexInActiveRegion (channelNum);
 
     if (i >= 0)
-        getControlSurface().updateSoloAndMute (i, state, isBright);
+    {
+        if ((size_t) i >= soloAndMuteShadows.size())
+            soloAndMuteShadows.resize ((size_t) i + 1, -1);
+
+        // Lights are sent straight away, but only if they've actually changed
+        auto newState = ((int) state << 1) | (isBright ? 1 : 0);
+
+        if (soloAndMuteShadows[(size_t) i] != newState)
+        {
+            soloAndMuteShadows[(size_t) i] = newState;
+            getControlSurface().updateSoloAndMute (i, state, isBright);
+        }
+    }
+}
+
+ExternalController::ShadowValue& ExternalController::getShadow (std::vector<ShadowValue>& shadows, int faderIndex)
+{
+    jassert (faderIndex >= 0);
+
+    if ((size_t) faderIndex >= shadows.size())
+        shadows.resize ((size_t) faderIndex + 1);
+
+    return shadows[(size_t) faderIndex];
+}
+
+void ExternalController::forgetSentState()
+{
+    for (auto shadows : { &faderShadows, &panShadows, &levelShadows })
+        for (auto& s : *shadows)
+            s.sent = notSent;
+
+    for (auto& s : masterFaderShadows)  s.sent = notSent;
+    for (auto& s : masterLevelShadows)  s.sent = notSent;
+
+    soloAndMuteShadows.clear();
+    selectionShadows.clear();
+}
+
+void ExternalController::flushPendingUpdates()
+{
+    if (controlSurface == nullptr)
+        return;
+
+    auto& cs = getControlSurface();
+    auto now = Time::getMillisecondCounter();
+
+    // Each value sent uses up one of the allowance, which refills at the surface's rate
+    // and is capped at a quarter of a second's worth, so a backlog can't burst out at once
+    if (cs.maxValueUpdatesPerSecond > 0)
+        updateAllowance = jmin (cs.maxValueUpdatesPerSecond * 0.25,
+                                updateAllowance + (now - lastFlushTime) * cs.maxValueUpdatesPerSecond / 1000.0);
+    else
+        updateAllowance = std::numeric_limits<double>::max();
+
+    lastFlushTime = now;
+
+    auto canSend = [this]
+    {
+        if (updateAllowance < 1.0)
+            return false;
+
+        updateAllowance -= 1.0;
+        return true;
+    };
+
+    int numFaders = getNumFaderChannels();
+
+    // Faders and pans go first, as they're what the user is most likely to be watching
+    for (int i = 0; i < jmin (numFaders, (int) faderShadows.size()); ++i)
+    {
+        auto& s = faderShadows[(size_t) i];
+
+        if (s.needsSending() && canSend())
+        {
+            s.sent = s.pending;
+            cs.moveFader (i, s.pending);
+        }
+    }
+
+    for (int i = 0; i < jmin (numFaders, (int) panShadows.size()); ++i)
+    {
+        auto& s = panShadows[(size_t) i];
+
+        if (s.needsSending() && canSend())
+        {
+            s.sent = s.pending;
+            cs.movePanPot (i, s.pending);
+        }
+    }
+
+    if ((masterFaderShadows[0].needsSending() || masterFaderShadows[1].needsSending()) && canSend())
+    {
+        for (auto& s : masterFaderShadows)
+            s.sent = s.pending;
+
+        cs.moveMasterLevelFader (masterFaderShadows[0].pending, masterFaderShadows[1].pending);
+    }
+
+    juce::Array<int> meterChannels;
+    juce::Array<float> meterLevels;
+
+    for (int i = 0; i < jmin (numFaders, (int) levelShadows.size()); ++i)
+    {
+        auto& s = levelShadows[(size_t) i];
+
+        if (s.needsSending() && canSend())
+        {
+            s.sent = s.pending;
+            meterChannels.add (i);
+            meterLevels.add (s.pending);
+        }
+    }
+
+    if (! meterChannels.isEmpty())
+        cs.channelLevelsChanged (meterChannels, meterLevels);
+
+    if ((masterLevelShadows[0].needsSending() || masterLevelShadows[1].needsSending()) && canSend())
+    {
+        for (auto& s : masterLevelShadows)
+            s.sent = s.pending;
+
+        cs.masterLevelsChanged (masterLevelShadows[0].pending, masterLevelShadows[1].pending);
+    }
 }
 
 void ExternalController::soloCountChanged (bool anySoloTracks)
@@ -389,13 +520,13 @@ void ExternalController::channelLevelChanged (int channelNum, float level)
     int i = getFaderIndexInActiveRegion (channelNum);
 
     if (i >= 0)
-        getControlSurface().channelLevelChanged (i, level);
+        getShadow (levelShadows, i).pending = level;
 }
 
 void ExternalController::masterLevelsChanged (float leftLevel, float rightLevel)
 {
-    if (controlSurface != nullptr)
-        getControlSurface().masterLevelsChanged (leftLevel, rightLevel);
+    masterLevelShadows[0].pending = leftLevel;
+    masterLevelShadows[1].pending = rightLevel;
 }
 
 void ExternalController::timecodeChanged (int barsOrHours,
@@ -415,7 +546,16 @@ void ExternalController::trackSelected (int channelNum, bool isSelected)
     int i = getFaderIndexInActiveRegion (channelNum);
 
     if (i >= 0)
-        getControlSurface().trackSelectionChanged (i, isSelected);
+    {
+        if ((size_t) i >= selectionShadows.size())
+            selectionShadows.resize ((size_t) i + 1, -1);
+
+        if (selectionShadows[(size_t) i] != (int) isSelected)
+        {
+            selectionShadows[(size_t) i] = (int) isSelected;
+            getControlSurface().trackSelectionChanged (i, isSelected);
+        }
+    }
 }
 
 void ExternalController::selectOtherObject (SelectableClass::Relationship relationship, bool moveFromCurrentPlugin)
@@ -975,6 +1115,10 @@ void ExternalController::auxSendLevelsChanged()
 void ExternalController::acceptMidiMessage (const MidiMessage& m)
 {
     CRASH_TRACER
+
+    if (controlSurface != nullptr && getControlSurface().handleMidiMessageOnMidiThread (m))
+        return;
+
     const ScopedLock sl (incomingMidiLock);
     pendingMidiMessages.add (m);
     processMidi = true;
@@ -81,6 +81,13 @@ public:
     void auxSendLevelsChanged();
 
     void updateDeviceState();
+
+    /** Sends the surface any fader, pan and meter values that have changed since they were
+        last sent, as many as its maxValueUpdatesPerSecond allows. The rest wait for the next call.
+        The ExternalControllerManager calls this regularly, so changes made in between are coalesced.
+    */
+    void flushPendingUpdates();
+
     void updateParameters();
     void updateMarkers();
     void selectedPluginChanged();
@@ -181,6 +188,24 @@ private:
     juce::Array<juce::MidiMessage> pendingMidiMessages;
     juce::CriticalSection incomingMidiLock;
 
+    // The values last sent to the surface for each of its faders, so unchanged ones aren't sent again
+    static constexpr float notSent = -1.0e9f;
+
+    struct ShadowValue
+    {
+        float sent = notSent, pending = notSent;
+        bool needsSending() const noexcept      { return pending != sent; }
+    };
+
+    std::vector<ShadowValue> faderShadows, panShadows, levelShadows;
+    ShadowValue masterFaderShadows[2], masterLevelShadows[2];
+    std::vector<int> soloAndMuteShadows, selectionShadows;
+    double updateAllowance = 0;
+    juce::uint32 lastFlushTime = 0;
+
+    ShadowValue& getShadow (std::vector<ShadowValue>&, int faderIndex);
+    void forgetSentState();
+
     void changeFaderBank (int delta, bool moveSelection);
     void changeParamBank (int delta);
     void updateParamList();
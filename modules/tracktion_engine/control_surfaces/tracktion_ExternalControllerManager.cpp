@@ -87,6 +87,7 @@ private:
 ExternalControllerManager::ExternalControllerManager (Engine& e) : engine (e)
 {
     blinkTimer.reset (new BlinkTimer (*this));
+    flushTimer.reset (new FlushTimer (*this));
 }
 
 ExternalControllerManager::~ExternalControllerManager()
@@ -94,6 +95,7 @@ ExternalControllerManager::~ExternalControllerManager()
     jassert (currentEdit == nullptr); // should be cleared by this point.
 
     blinkTimer.reset();
+    flushTimer.reset();
     setCurrentEdit (nullptr, nullptr);
 }
 
@@ -362,6 +364,21 @@ void ExternalControllerManager::BlinkTimer::timerCallback()
     ecm.blinkNow();
 }
 
+//==============================================================================
+ExternalControllerManager::FlushTimer::FlushTimer (ExternalControllerManager& e) : ecm (e)
+{
+    // The values that change in between are coalesced, so each device gets at most one per tick
+    startTimer (40);
+}
+
+void ExternalControllerManager::FlushTimer::timerCallback()
+{
+    CRASH_TRACER
+
+    for (auto c : ecm.devices)
+        c->flushPendingUpdates();
+}
+
 void ExternalControllerManager::blinkNow()
 {
     updateMuteSoloLights (true);
@@ -169,6 +169,15 @@ private:
 
     std::unique_ptr<BlinkTimer> blinkTimer;
 
+    struct FlushTimer : private Timer
+    {
+        FlushTimer (ExternalControllerManager&);
+        void timerCallback() override;
+        ExternalControllerManager& ecm;
+    };
+
+    std::unique_ptr<FlushTimer> flushTimer;
+
     ExternalController* addNewController (ControlSurface*);
 
     void blinkNow();
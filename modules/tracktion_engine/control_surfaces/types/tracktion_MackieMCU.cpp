@@ -18,6 +18,7 @@ MackieMCU::MackieMCU (ExternalControllerManager& ecm)  : ControlSurface (ecm)
     wantsClock = false;
     numberOfFaderChannels = 8;
     numCharactersForTrackNames = 6;
+    maxValueUpdatesPerSecond = 1000; // about what a 31.25k baud MIDI cable can take in 3-byte messages
     numCharactersForAuxLabels = 6;
     numCharactersForParameterLabels = 6;
     numParameterControls = 8;
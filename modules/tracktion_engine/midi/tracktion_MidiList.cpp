@@ -271,7 +271,34 @@ namespace NoteHelpers
     }
 }
 
-void addMidiNoteOnExpressionToSequence (juce::MidiMessageSequence& seq, const juce::ValueTree& state, int midiChannel, double noteOnTime) noexcept
+//==============================================================================
+/**
+    Collects events so they can be sorted and added to a sequence in one go, which is
+    much quicker than inserting lots of out-of-order events into a MidiMessageSequence.
+*/
+struct MidiEventBatch
+{
+    void addEvent (const juce::MidiMessage& m)
+    {
+        events.push_back (m);
+    }
+
+    /** Adds the events in time order, keeping events with the same time in the order they were added. */
+    void addToSequence (juce::MidiMessageSequence& seq)
+    {
+        std::stable_sort (events.begin(), events.end(),
+                          [] (const juce::MidiMessage& a, const juce::MidiMessage& b) { return a.getTimeStamp() < b.getTimeStamp(); });
+
+        for (auto& m : events)
+            seq.addEvent (m);
+
+        events.clear();
+    }
+
+    std::vector<juce::MidiMessage> events;
+};
+
+void addMidiNoteOnExpressionToSequence (MidiEventBatch& seq, const juce::ValueTree& state, int midiChannel, double noteOnTime) noexcept
 {
     using namespace NoteHelpers;
     jassert (state.hasType (IDs::NOTE));
@@ -285,7 +312,7 @@ void addMidiNoteOnExpressionToSequence (juce::MidiMessageSequence& seq, const ju
     seq.addEvent (juce::MidiMessage (createTimbre (midiChannel, timbre), noteOnTime));
 }
 
-static void addMidiExpressionToSequence (juce::MidiMessageSequence& seq, const juce::ValueTree& state, const MidiClip& clip, int midiChannel, double notePlaybackBeat, double notePlaybackEndTime) noexcept
+static void addMidiExpressionToSequence (MidiEventBatch& seq, const juce::ValueTree& state, const MidiClip& clip, int midiChannel, double notePlaybackBeat, double notePlaybackEndTime) noexcept
 {
     using namespace NoteHelpers;
 
@@ -305,7 +332,7 @@ static void addMidiExpressionToSequence (juce::MidiMessageSequence& seq, const j
         jassertfalse;
 }
 
-static void addExpressiveNoteToSequence (juce::MidiMessageSequence& seq, const MidiClip& clip, const MidiNote& note, int midiChannel, const GrooveTemplate* grooveTemplate)
+static void addExpressiveNoteToSequence (MidiEventBatch& seq, const MidiClip& clip, const MidiNote& note, int midiChannel, const GrooveTemplate* grooveTemplate)
 {
     if (note.isMute() || note.getLengthBeats() <= 0.00001)
         return;
@@ -337,24 +364,79 @@ static void addExpressiveNoteToSequence (juce::MidiMessageSequence& seq, const M
 }
 
 //==============================================================================
-static void addToSequence (juce::MidiMessageSequence& seq, const MidiClip& clip,
-                           const MidiNote& note, int channelNumber, bool addNoteUp,
-                           const GrooveTemplate* grooveTemplate)
+/** The notes to add to a playback sequence, with their times worked out in blocks
+    rather than one note at a time as MidiNote::getPlaybackTime does.
+*/
+struct NotePlaybackTimes
 {
-    jassert (channelNumber < 17); // SysEx?
+    struct Note
+    {
+        const MidiNote* note;
+        bool addNoteUp;
+    };
 
-    if (note.isMute() || note.getLengthBeats() <= 0.00001)
-        return;
+    void add (const MidiNote& note, bool addNoteUp)
+    {
+        if (! note.isMute() && note.getLengthBeats() > 0.00001)
+            notes.push_back ({ &note, addNoteUp });
+    }
+
+    /** Quantises, grooves and converts all the notes' edges to times relative to the
+        clip start, in the same way as MidiNote::getPlaybackTime.
+    */
+    void calculate (const MidiClip& clip, const GrooveTemplate* grooveTemplate)
+    {
+        auto& ts = clip.edit.tempoSequence;
+        const auto numNotes = (int) notes.size();
+        const auto contentStartBeat = clip.getContentStartBeat();
+        const auto pos = clip.getPosition();
+
+        downTimes.resize (notes.size());
+        upTimes.resize (notes.size());
+
+        for (size_t i = 0; i < notes.size(); ++i)
+            downTimes[i] = notes[i].note->getStartBeat() + contentStartBeat;
+
+        clip.getQuantisation().roundBeatsToNearest (downTimes.data(), numNotes);
+
+        for (size_t i = 0; i < notes.size(); ++i)
+            upTimes[i] = downTimes[i] + notes[i].note->getLengthBeats();
+
+        ts.beatsToTime (downTimes.data(), numNotes);
+        ts.beatsToTime (upTimes.data(), numNotes);
+
+        // nudge the note-up backwards just a bit to make sure the ordering is correct
+        for (auto& t : upTimes)
+            t = std::min (t, pos.getEnd()) - 0.0001;
+
+        if (grooveTemplate != nullptr)
+        {
+            const auto grooveStrength = clip.getGrooveStrength();
+            grooveTemplate->editTimesToGroovyTimes (downTimes.data(), numNotes, grooveStrength, clip.edit);
+            grooveTemplate->editTimesToGroovyTimes (upTimes.data(), numNotes, grooveStrength, clip.edit);
+        }
+
+        for (size_t i = 0; i < notes.size(); ++i)
+        {
+            downTimes[i] -= pos.getStart();
+            upTimes[i] -= pos.getStart();
+        }
+    }
+
+    std::vector<Note> notes;
+    std::vector<double> downTimes, upTimes;
+};
+
+static void addToSequence (juce::MidiMessageSequence& seq, const MidiNote& note, int channelNumber,
+                           bool addNoteUp, double downTime, double upTime)
+{
+    jassert (channelNumber < 17); // SysEx?
 
-    double downTime = note.getPlaybackTime (MidiNote::startEdge, clip, grooveTemplate);
     auto velocity = (juce::uint8) note.getVelocity();
     int noteNumber = note.getNoteNumber();
 
     if (addNoteUp)
     {
-        // nudge the note-up backwards just a bit to make sure the ordering is correct
-        double upTime = note.getPlaybackTime (MidiNote::endEdge, clip, grooveTemplate);
-
         if (upTime > downTime && upTime > 0.0)
         {
             seq.addEvent (juce::MidiMessage::noteOn (channelNumber, noteNumber, velocity), std::max (0.0, downTime));
@@ -429,7 +511,7 @@ class MPEChannelAssigner
 public:
     //==========================================================================
     /** Constructor. */
-    MPEChannelAssigner (juce::MidiMessageSequence& s, const MidiClip& c, const GrooveTemplate* g)
+    MPEChannelAssigner (MidiEventBatch& s, const MidiClip& c, const GrooveTemplate* g)
         : seq (s), clip (c), groove (g)
     {
         zoneLayout.setLowerZone (15);
@@ -554,7 +636,7 @@ private:
     }
 
     //==========================================================================
-    juce::MidiMessageSequence& seq;
+    MidiEventBatch& seq;
     const MidiClip& clip;
     const GrooveTemplate* groove;
     juce::MPEZoneLayout zoneLayout;
@@ -613,6 +695,11 @@ struct MidiList::EventDelegate<MidiNote>
         return i == IDs::b;
     }
 
+    static bool affectsIndexes (const juce::Identifier& i)
+    {
+        return i == IDs::p || i == IDs::l;
+    }
+
     static void removeFromSelection (MidiNote* m)
     {
         removeMidiEventFromSelection (m);
@@ -820,6 +907,11 @@ struct MidiList::EventDelegate<MidiControllerEvent>
         return i == IDs::b;
     }
 
+    static bool affectsIndexes (const juce::Identifier& i)
+    {
+        return i == IDs::type;
+    }
+
     static void removeFromSelection (MidiControllerEvent* e)
     {
         removeMidiEventFromSelection (e);
@@ -1007,6 +1099,11 @@ struct MidiList::EventDelegate<MidiSysexEvent>
         return false;
     }
 
+    static bool affectsIndexes (const juce::Identifier&)
+    {
+        return false;
+    }
+
     static void removeFromSelection (MidiSysexEvent* m)
     {
         removeMidiEventFromSelection (m);
@@ -1030,6 +1127,94 @@ void MidiSysexEvent::setBeatPosition (double newBeatNumber, juce::UndoManager* u
     state.setProperty (IDs::time, std::max (0.0, newBeatNumber), um);
 }
 
+//==============================================================================
+/** The notes split up by pitch, along with the longest note length, so any note that
+    overlaps a range must start no earlier than the range start minus that length.
+*/
+struct MidiList::NoteIndex
+{
+    struct NoteGroup
+    {
+        juce::Array<MidiNote*> notes; // in getNotes() order
+        double longestNote = 0.0;
+    };
+
+    void rebuild (const juce::Array<MidiNote*>& sortedNotes)
+    {
+        allNotes = {};
+
+        for (auto& group : pitches)
+            group = {};
+
+        for (auto n : sortedNotes)
+        {
+            auto length = n->getLengthBeats();
+            allNotes.notes.add (n);
+            allNotes.longestNote = std::max (allNotes.longestNote, length);
+
+            auto& group = pitches[(size_t) n->getNoteNumber()];
+            group.notes.add (n);
+            group.longestNote = std::max (group.longestNote, length);
+        }
+    }
+
+    static juce::Array<MidiNote*> findNotesInRange (const NoteGroup& group, juce::Range<double> beatRange)
+    {
+        juce::Array<MidiNote*> result;
+
+        auto first = std::lower_bound (group.notes.begin(), group.notes.end(), beatRange.getStart() - group.longestNote,
+                                       [] (const MidiNote* n, double beat) { return n->getStartBeat() < beat; });
+
+        for (auto it = first; it != group.notes.end(); ++it)
+        {
+            auto n = *it;
+
+            if (n->getStartBeat() >= beatRange.getEnd())
+                break;
+
+            if (n->getEndBeat() > beatRange.getStart())
+                result.add (n);
+        }
+
+        return result;
+    }
+
+    NoteGroup allNotes;
+    std::array<NoteGroup, 128> pitches;
+    juce::uint32 version = 0;
+};
+
+/** The controller events grouped by type, each group sorted by beat. */
+struct MidiList::ControllerIndex
+{
+    void rebuild (const juce::Array<MidiControllerEvent*>& sortedEvents)
+    {
+        eventsByType.clear();
+
+        for (auto e : sortedEvents)
+            eventsByType[e->getType()].add (e);
+    }
+
+    const juce::Array<MidiControllerEvent*>& getEventsOfType (int type) const
+    {
+        auto found = eventsByType.find (type);
+        return found != eventsByType.end() ? found->second : noEvents;
+    }
+
+    /** Returns the index of the last event at or before this beat, or -1. */
+    static int indexOfLastBefore (const juce::Array<MidiControllerEvent*>& events, double beatNumber)
+    {
+        auto found = std::upper_bound (events.begin(), events.end(), beatNumber,
+                                       [] (double beat, const MidiControllerEvent* e) { return beat < e->getBeatPosition(); });
+
+        return (int) std::distance (events.begin(), found) - 1;
+    }
+
+    std::unordered_map<int, juce::Array<MidiControllerEvent*>> eventsByType;
+    const juce::Array<MidiControllerEvent*> noEvents;
+    juce::uint32 version = 0;
+};
+
 //==============================================================================
 juce::ValueTree MidiList::createMidiList()
 {
@@ -1092,8 +1277,14 @@ void MidiList::copyFrom (const MidiList& other, juce::UndoManager* um)
 void MidiList::addFrom (const MidiList& other, juce::UndoManager* um)
 {
     if (this != &other)
+    {
+        const EventList<MidiNote>::Batch noteBatch (*noteList);
+        const EventList<MidiControllerEvent>::Batch controllerBatch (*controllerList);
+        const EventList<MidiSysexEvent>::Batch sysexBatch (*sysexList);
+
         for (int i = 0; i < other.state.getNumChildren(); ++i)
             state.addChild (other.state.getChild (i).createCopy(), -1, um);
+    }
 }
 
 void MidiList::setMidiChannel (MidiChannel newChannel)
@@ -1137,6 +1328,58 @@ const juce::Array<MidiSysexEvent*>& MidiList::getSysexEvents() const
     return getEventsChecked (sysexList->getSortedList());
 }
 
+juce::int64 MidiList::getMemoryUsage() const
+{
+    // Each event also has a ValueTree with a handful of properties, which is about this much
+    constexpr juce::int64 bytesPerStateNode = 256;
+
+    auto total = getNotes().size() * (juce::int64) (sizeof (MidiNote) + bytesPerStateNode)
+                  + getControllerEvents().size() * (juce::int64) (sizeof (MidiControllerEvent) + bytesPerStateNode);
+
+    for (auto e : getSysexEvents())
+        total += (juce::int64) sizeof (MidiSysexEvent) + bytesPerStateNode + e->getMessage().getRawDataSize();
+
+    return total;
+}
+
+const MidiList::NoteIndex& MidiList::getNoteIndex() const
+{
+    auto& notes = getNotes();
+
+    if (noteIndex == nullptr)
+    {
+        noteIndex = std::make_unique<NoteIndex>();
+        noteIndex->version = noteList->indexVersion - 1;
+    }
+
+    if (noteIndex->version != noteList->indexVersion)
+    {
+        noteIndex->rebuild (notes);
+        noteIndex->version = noteList->indexVersion;
+    }
+
+    return *noteIndex;
+}
+
+const MidiList::ControllerIndex& MidiList::getControllerIndex() const
+{
+    auto& events = getControllerEvents();
+
+    if (controllerIndex == nullptr)
+    {
+        controllerIndex = std::make_unique<ControllerIndex>();
+        controllerIndex->version = controllerList->indexVersion - 1;
+    }
+
+    if (controllerIndex->version != controllerList->indexVersion)
+    {
+        controllerIndex->rebuild (events);
+        controllerIndex->version = controllerList->indexVersion;
+    }
+
+    return *controllerIndex;
+}
+
 //==============================================================================
 void MidiList::moveAllBeatPositions (double delta, juce::UndoManager* um)
 {
@@ -1171,15 +1414,19 @@ void MidiList::rescale (double factor, juce::UndoManager* um)
 
 void MidiList::trimOutside (double start, double end, juce::UndoManager* um)
 {
-    juce::Array<juce::ValueTree> itemsToRemove;
+    auto isNoteOutside = [start, end] (const MidiNote& n)
+    {
+        return n.getStartBeat() >= (end - 0.0001) || n.getEndBeat() <= (start + 0.0001);
+    };
+
+    auto isBeatOutside = [start, end] (double beat)
+    {
+        return beat < start || beat >= end;
+    };
 
     for (auto n : getNotes())
     {
-        if (n->getStartBeat() >= (end - 0.0001) || n->getEndBeat() <= (start + 0.0001))
-        {
-            itemsToRemove.add (n->state);
-        }
-        else if (n->getStartBeat() < start || n->getEndBeat() > end)
+        if (! isNoteOutside (*n) && (n->getStartBeat() < start || n->getEndBeat() > end))
         {
             auto newStart = std::max (start, n->getStartBeat());
             auto newEnd   = std::min (end, n->getEndBeat());
@@ -1188,16 +1435,22 @@ void MidiList::trimOutside (double start, double end, juce::UndoManager* um)
         }
     }
 
-    for (auto e : getControllerEvents())
-        if (e->getBeatPosition() < start || e->getBeatPosition() >= end)
-            itemsToRemove.add (e->state);
+    // Removing by index, working backwards, avoids searching the children for each one
+    for (int i = state.getNumChildren(); --i >= 0;)
+    {
+        auto v = state.getChild (i);
+        bool shouldRemove = false;
 
-    for (auto s : getSysexEvents())
-        if (s->getBeatPosition() < start || s->getBeatPosition() >= end)
-            itemsToRemove.add (s->state);
+        if (auto n = noteList->getEventFor (v))
+            shouldRemove = isNoteOutside (*n);
+        else if (auto e = controllerList->getEventFor (v))
+            shouldRemove = isBeatOutside (e->getBeatPosition());
+        else if (auto sysex = sysexList->getEventFor (v))
+            shouldRemove = isBeatOutside (sysex->getBeatPosition());
 
-    for (auto& v : itemsToRemove)
-        state.removeChild (v, um);
+        if (shouldRemove)
+            state.removeChild (i, um);
+    }
 }
 
 //==============================================================================
@@ -1225,11 +1478,20 @@ double MidiList::getLastBeatNumber() const
 
 MidiNote* MidiList::getNoteFor (const juce::ValueTree& s)
 {
-    for (auto n : getNotes())
-        if (n->state == s)
-            return n;
+    return noteList->getEventFor (s);
+}
 
-    return {};
+juce::Array<MidiNote*> MidiList::getNotesInRange (juce::Range<double> beatRange) const
+{
+    return NoteIndex::findNotesInRange (getNoteIndex().allNotes, beatRange);
+}
+
+juce::Array<MidiNote*> MidiList::getNotesInRange (juce::Range<double> beatRange, int noteNumber) const
+{
+    if (! juce::isPositiveAndBelow (noteNumber, 128))
+        return {};
+
+    return NoteIndex::findNotesInRange (getNoteIndex().pitches[(size_t) noteNumber], beatRange);
 }
 
 juce::Range<int> MidiList::getNoteNumberRange() const
@@ -1279,26 +1541,18 @@ void MidiList::removeAllNotes (juce::UndoManager* um)
 //==============================================================================
 MidiControllerEvent* MidiList::getControllerEventAt (double beatNumber, int controllerType) const
 {
-    auto& controllerEvents = getControllerEvents();
-
-    for (int i = controllerEvents.size(); --i >= 0;)
-    {
-        auto e = controllerEvents.getUnchecked (i);
-
-        if (e->getBeatPosition() <= beatNumber && e->getType() == controllerType)
-            return controllerEvents.getUnchecked (i);
-    }
+    auto& events = getControllerEventsOfType (controllerType);
+    return events[ControllerIndex::indexOfLastBefore (events, beatNumber)];
+}
 
-    return {};
+const juce::Array<MidiControllerEvent*>& MidiList::getControllerEventsOfType (int controllerType) const
+{
+    return getControllerIndex().getEventsOfType (controllerType);
 }
 
 bool MidiList::containsController (int controllerType) const
 {
-    for (auto e : getControllerEvents())
-        if (e->getType() == controllerType)
-            return true;
-
-    return false;
+    return ! getControllerEventsOfType (controllerType).isEmpty();
 }
 
 void MidiList::addControllerEvent (double beat, int controllerType, int controllerValue, juce::UndoManager* um)
@@ -1326,19 +1580,10 @@ void MidiList::removeAllControllers (juce::UndoManager* um)
 void MidiList::setControllerValueAt (int controllerType, double beatNumber, int newValue, juce::UndoManager* um)
 {
     beatNumber = std::max (0.0, beatNumber);
-    auto& controllerEvents = getControllerEvents();
-
-    for (int i = controllerEvents.size(); --i >= 0;) // N.B.: The order matters!
-    {
-        auto e = controllerEvents.getUnchecked (i);
 
-        if (e->getType() == controllerType
-              && e->getBeatPosition() <= beatNumber) // N.B.: '<=' because we want the event the beat is within
-        {
-            e->setControllerValue (newValue, um);
-            break;
-        }
-    }
+    // N.B.: This is the last event at or before the beat, because we want the event the beat is within
+    if (auto e = getControllerEventAt (beatNumber, controllerType))
+        e->setControllerValue (newValue, um);
 }
 
 static int interpolate (int startValue, int rangeValues, double startBeat, double beat, double rangeBeats) noexcept
@@ -1386,10 +1631,12 @@ void MidiList::insertRepeatedControllerValue (int type, int startVal, int endVal
 void MidiList::removeControllersBetween (int controllerType, double beatStart, double beatEnd, juce::UndoManager* um)
 {
     juce::Array<juce::ValueTree> itemsToRemove;
+    auto& events = getControllerEventsOfType (controllerType);
 
-    for (auto e : getControllerEvents())
-        if (e->getType() == controllerType && e->getBeatPosition() >= beatStart && e->getBeatPosition() < beatEnd)
-            itemsToRemove.add (e->state);
+    for (auto it = std::lower_bound (events.begin(), events.end(), beatStart,
+                                     [] (const MidiControllerEvent* e, double beat) { return e->getBeatPosition() < beat; });
+         it != events.end() && (*it)->getBeatPosition() < beatEnd; ++it)
+        itemsToRemove.add ((*it)->state);
 
     for (auto& v : itemsToRemove)
         state.removeChild (v, um);
@@ -1796,9 +2043,18 @@ void MidiList::exportToPlaybackMidiSequence (juce::MidiMessageSequence& destSequ
 
     if (! generateMPE)
     {
+        NotePlaybackTimes playbackNotes;
+        playbackNotes.notes.reserve ((size_t) numNotes);
+
+        // Tracks where each note is in the list of notes with its pitch
+        auto& notesByPitch = getNoteIndex().pitches;
+        std::array<int, 128> nextIndexForPitch {};
+
         for (int i = 0; i < numNotes; ++i)
         {
             auto& note = *notes.getUnchecked (i);
+            auto noteNum = note.getNoteNumber();
+            auto indexInPitch = nextIndexForPitch[(size_t) noteNum]++;
 
             if (selectedEvents != nullptr && ! selectedEvents->isSelected (&note))
                 continue;
@@ -1810,31 +2066,34 @@ void MidiList::exportToPlaybackMidiSequence (juce::MidiMessageSequence& destSequ
                 break;
 
             auto thisNoteEnd = note.getEndBeat();
-            auto noteNum = note.getNoteNumber();
             bool useNoteUp = true;
 
-            for (int j = i + 1; j < numNotes; ++j)
+            if (auto nextWithSamePitch = notesByPitch[(size_t) noteNum].notes[indexInPitch + 1])
             {
-                const auto& note2 = *notes.getUnchecked (j);
-                const double s = note2.getStartBeat();
+                auto s = nextWithSamePitch->getStartBeat();
 
-                if (s >= lastNoteTime || s >= thisNoteEnd)
-                    break;
-
-                if (note2.getNoteNumber() == noteNum)
-                {
+                if (s < lastNoteTime && s < thisNoteEnd)
                     useNoteUp = false;
-                    break;
-                }
             }
 
             if (thisNoteEnd > firstNoteTime)
-                addToSequence (destSequence, clip, note, channelNumber, useNoteUp, grooveTemplate);
+                playbackNotes.add (note, useNoteUp);
+        }
+
+        playbackNotes.calculate (clip, grooveTemplate);
+
+        for (size_t i = 0; i < playbackNotes.notes.size(); ++i)
+        {
+            auto& n = playbackNotes.notes[i];
+            addToSequence (destSequence, *n.note, channelNumber, n.addNoteUp,
+                           playbackNotes.downTimes[i], playbackNotes.upTimes[i]);
         }
     }
     else
     {
-        MPEChannelAssigner assigner (destSequence, clip, grooveTemplate);
+        MidiEventBatch mpeEvents;
+        mpeEvents.events.reserve ((size_t) numNotes * 8);
+        MPEChannelAssigner assigner (mpeEvents, clip, grooveTemplate);
 
         for (auto note : notes)
         {
@@ -1843,6 +2102,8 @@ void MidiList::exportToPlaybackMidiSequence (juce::MidiMessageSequence& destSequ
 
             assigner.addNote (*note);
         }
+
+        mpeEvents.addToSequence (destSequence);
     }
 
     auto& controllerEvents = getControllerEvents();
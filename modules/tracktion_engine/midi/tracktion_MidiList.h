@@ -40,6 +40,9 @@ public:
     const juce::Array<MidiControllerEvent*>& getControllerEvents() const;
     const juce::Array<MidiSysexEvent*>& getSysexEvents() const;
 
+    /** Returns a rough estimate of the memory used by the events and their state. */
+    juce::int64 getMemoryUsage() const;
+
     //==============================================================================
     bool isAttachedToClip() const noexcept                          { return ! state.getParent().hasType (IDs::NA); }
 
@@ -69,6 +72,12 @@ public:
     MidiNote* getNote (int index) const                             { return getNotes()[index]; }
     MidiNote* getNoteFor (const juce::ValueTree&);
 
+    /** Returns the notes that overlap a range of beats, in the same order as getNotes(). */
+    juce::Array<MidiNote*> getNotesInRange (juce::Range<double> beatRange) const;
+
+    /** Returns the notes of one pitch that overlap a range of beats, in the same order as getNotes(). */
+    juce::Array<MidiNote*> getNotesInRange (juce::Range<double> beatRange, int noteNumber) const;
+
     juce::Range<int> getNoteNumberRange() const;
 
     /** Beat number of first event in the list */
@@ -87,6 +96,9 @@ public:
     MidiControllerEvent* getControllerEvent (int index) const       { return getControllerEvents()[index]; }
     MidiControllerEvent* getControllerEventAt (double beatNumber, int controllerType) const;
 
+    /** Returns the controller events of one type, sorted by beat. */
+    const juce::Array<MidiControllerEvent*>& getControllerEventsOfType (int controllerType) const;
+
     void addControllerEvent (double beat, int controllerType, int controllerValue, juce::UndoManager*);
     void addControllerEvent (double beat, int controllerType, int controllerValue, int metadata, juce::UndoManager*);
 
@@ -181,6 +193,8 @@ private:
         static bool isSuitableType (const juce::ValueTree&);
         /** Return true if the order may have changed. */
         static bool updateObject (EventType&, const juce::Identifier&);
+        /** Return true if a change to this property means the lookup indexes need rebuilding. */
+        static bool affectsIndexes (const juce::Identifier&);
         static void removeFromSelection (EventType*);
     };
 
@@ -200,11 +214,10 @@ private:
 
         EventType* getEventFor (const juce::ValueTree& v)
         {
-            for (auto m : ValueTreeObjectList<EventType>::objects)
-                if (m->state == v)
-                    return m;
+            if (! EventDelegate<EventType>::isSuitableType (v))
+                return {};
 
-            return {};
+            return ValueTreeObjectList<EventType>::objects[ValueTreeObjectList<EventType>::indexOf (v)];
         }
 
         bool isSuitableType (const juce::ValueTree& v) const override   { return EventDelegate<EventType>::isSuitableType (v); }
@@ -213,12 +226,17 @@ private:
         void newObjectAdded (EventType*) override                       { triggerSort(); }
         void objectRemoved (EventType* m) override                      { EventDelegate<EventType>::removeFromSelection (m); triggerSort(); }
         void objectOrderChanged() override                              { triggerSort(); }
+        void objectsChangedInBatch (const juce::Array<EventType*>&, bool) override { triggerSort(); }
 
         void valueTreePropertyChanged (juce::ValueTree& v, const juce::Identifier& i) override
         {
             if (auto e = getEventFor (v))
+            {
                 if (EventDelegate<EventType>::updateObject (*e, i))
                     triggerSort();
+                else if (EventDelegate<EventType>::affectsIndexes (i))
+                    ++indexVersion;
+            }
         }
 
         void triggerSort()
@@ -238,6 +256,7 @@ private:
                 needsSorting = false;
                 sortedEvents = ValueTreeObjectList<EventType>::objects;
                 sortMidiEventsByTime (sortedEvents);
+                ++indexVersion;
             }
 
             return sortedEvents;
@@ -245,6 +264,7 @@ private:
 
         bool needsSorting = true;
         juce::Array<EventType*> sortedEvents;
+        juce::uint32 indexVersion = 0; // changes whenever anything built from the sorted list is out of date
         juce::CriticalSection lock;
 
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (EventList)
@@ -254,6 +274,15 @@ private:
     std::unique_ptr<EventList<MidiControllerEvent>> controllerList;
     std::unique_ptr<EventList<MidiSysexEvent>> sysexList;
 
+    // Lookup indexes built on demand from the sorted lists, for range queries and edits
+    struct NoteIndex;
+    struct ControllerIndex;
+    mutable std::unique_ptr<NoteIndex> noteIndex;
+    mutable std::unique_ptr<ControllerIndex> controllerIndex;
+
+    const NoteIndex& getNoteIndex() const;
+    const ControllerIndex& getControllerIndex() const;
+
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MidiList)
 };
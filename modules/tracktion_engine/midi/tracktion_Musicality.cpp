@@ -872,10 +872,9 @@ void PatternGenerator::valueTreePropertyChanged (juce::ValueTree&, const juce::I
 
 ChordClip* PatternGenerator::getChordClipAt (double t) const
 {
-    for (auto c : clip.edit.getChordTrack()->getClips())
-        if (c->getPosition().time.contains (t))
-            if (auto cc = dynamic_cast<ChordClip*> (c))
-                return cc;
+    for (auto c : clip.edit.getChordTrack()->getClipsAt (t))
+        if (auto cc = dynamic_cast<ChordClip*> (c))
+            return cc;
 
     return {};
 }
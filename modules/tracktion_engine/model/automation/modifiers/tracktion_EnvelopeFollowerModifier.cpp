@@ -263,6 +263,7 @@ EnvelopeFollowerModifier::EnvelopeFollowerModifier (Edit& e, const ValueTree& v)
     highPassEnabled.referTo (state, IDs::highPassEnabled, um, false);
     lowPassFrequency.referTo (state, IDs::lowPassFrequency, um, 2000.0f);
     highPassFrequency.referTo (state, IDs::highPassFrequency, um, 500.0f);
+    controlRate.referTo (state, IDs::controlRate, um, 2000.0f);
 
     auto addDiscreteParam = [this] (const String& paramID, const String& name,
                                     Range<float> valueRange, CachedValue<float>& val, const StringArray& labels) -> AutomatableParameter*
@@ -295,6 +296,7 @@ EnvelopeFollowerModifier::EnvelopeFollowerModifier (Edit& e, const ValueTree& v)
     highPassEnabledParam    = addDiscreteParam  ("highPassEnabled",     TRANS("High-pass Enabled"),     { 0.0f, 1.0f },                     highPassEnabled,    getEnabledNames());
     lowPassFrequencyParam   = addParam          ("lowPassFrequency",    TRANS("Low-pass Frequency"),    freqRange, 700.0f,                  lowPassFrequency,   "Hz");
     highPassFrequencyParam  = addParam          ("highPassFrequency",   TRANS("High-pass Frequency"),   freqRange, 700.0f,                  highPassFrequency,  "Hz");
+    controlRateParam        = addParam          ("controlRate",         TRANS("Control Rate"),          { 100.0f, 20000.0f }, 1000.0f,      controlRate,        "Hz");
 
     changedTimer.setCallback ([this]
                               {
@@ -392,8 +394,22 @@ EnvelopeFollowerModifier::Ptr EnvelopeFollowerModifier::Assignment::getEnvelopeF
 //==============================================================================
 void EnvelopeFollowerModifier::prepareToPlay (double sampleRate)
 {
-    envelopeFollower->setSampleRate ((float) sampleRate);
     currentSampleRate = sampleRate;
+    decimationFactor = 0;
+    updateDecimationFactor();
+}
+
+void EnvelopeFollowerModifier::updateDecimationFactor()
+{
+    const int newFactor = jmax (1, roundToInt (currentSampleRate / controlRateParam->getCurrentValue()));
+
+    if (! setIfDifferent (decimationFactor, newFactor))
+        return;
+
+    // The envelope runs once per control value so is set up for the decimated rate
+    envelopeFollower->setSampleRate ((float) (currentSampleRate / decimationFactor));
+    samplesUntilNextControlValue = decimationFactor;
+    controlPeak = 0.0f;
 }
 
 void EnvelopeFollowerModifier::processBlock (const juce::AudioBuffer<float>& ab)
@@ -405,25 +421,29 @@ void EnvelopeFollowerModifier::processBlock (const juce::AudioBuffer<float>& ab)
     const bool lowPass = getBoolParamValue (*lowPassEnabledParam);
     const bool highPass = getBoolParamValue (*highPassEnabledParam);
 
+    updateDecimationFactor();
+
     const int numChannels = ab.getNumChannels();
     const int numSamples = ab.getNumSamples();
-    const float** samples = ab.getArrayOfReadPointers();
-    float envelope = 0.0f;
 
-    AudioScratchBuffer scratch (1, numSamples);
+    if (numChannels == 0 || numSamples == 0)
+        return;
+
+    AudioScratchBuffer scratch (numChannels > 1 ? 2 : 1, numSamples);
     float* scratchData = scratch.buffer.getWritePointer (0);
 
     // Find max of all channels
-    for (int i = 0; i < numSamples; ++i)
-    {
-        float sample = 0.0f;
+    FloatVectorOperations::abs (scratchData, ab.getReadPointer (0), numSamples);
 
-        for (int c = 0; c < numChannels; ++c)
-            sample = jmax (sample, std::abs (samples[c][i]));
-
-        scratchData[i] = sample * gainVal;
+    for (int c = 1; c < numChannels; ++c)
+    {
+        float* channelData = scratch.buffer.getWritePointer (1);
+        FloatVectorOperations::abs (channelData, ab.getReadPointer (c), numSamples);
+        FloatVectorOperations::max (scratchData, scratchData, channelData, numSamples);
     }
 
+    FloatVectorOperations::multiply (scratchData, gainVal, numSamples);
+
     // Filter if required
     if (setIfDifferent (currentLowPassFrequency, lowPassFrequencyParam->getCurrentValue()))
         lowPassFilter.setCoefficients (IIRCoefficients::makeLowPass (currentSampleRate, currentLowPassFrequency));
@@ -437,9 +457,26 @@ void EnvelopeFollowerModifier::processBlock (const juce::AudioBuffer<float>& ab)
     if (highPass)
         highPassFilter.processSamples (scratchData, numSamples);
 
-    // Process envelope
-    for (int i = 0; i < numSamples; ++i)
-        envelope = envelopeFollower->processSingleSample (scratchData[i]);
+    // Process the envelope at the control rate using the peak of each period, which
+    // can span blocks
+    float envelope = getEnvelopeValue();
+
+    for (int i = 0; i < numSamples;)
+    {
+        const int num = jmin (samplesUntilNextControlValue, numSamples - i);
+        const auto range = FloatVectorOperations::findMinAndMax (scratchData + i, num);
+        controlPeak = jmax (controlPeak, -range.getStart(), range.getEnd());
+
+        i += num;
+        samplesUntilNextControlValue -= num;
+
+        if (samplesUntilNextControlValue == 0)
+        {
+            envelope = envelopeFollower->processSingleSample (controlPeak);
+            controlPeak = 0.0f;
+            samplesUntilNextControlValue = decimationFactor;
+        }
+    }
 
     envelopeValue.store (envelope, std::memory_order_release);
 }
@@ -447,6 +484,9 @@ void EnvelopeFollowerModifier::processBlock (const juce::AudioBuffer<float>& ab)
 void EnvelopeFollowerModifier::reset()
 {
     envelopeFollower->reset();
+    samplesUntilNextControlValue = jmax (1, decimationFactor);
+    controlPeak = 0.0f;
+    envelopeValue.store (0.0f, std::memory_order_release);
 }
 
 //==============================================================================
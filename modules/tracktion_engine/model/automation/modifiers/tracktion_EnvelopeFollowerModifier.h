@@ -57,23 +57,26 @@ public:
     juce::String getSelectableDescription() override    { return getName(); }
 
     //==============================================================================
-    juce::CachedValue<float> gainDb, attack, hold, release, depth, offset, lowPassEnabled, highPassEnabled, lowPassFrequency, highPassFrequency;
+    juce::CachedValue<float> gainDb, attack, hold, release, depth, offset, lowPassEnabled, highPassEnabled, lowPassFrequency, highPassFrequency, controlRate;
     AutomatableParameter::Ptr gainDbParam, attackParam, holdParam, releaseParam, depthParam, offsetParam,
-        lowPassEnabledParam, highPassEnabledParam, lowPassFrequencyParam, highPassFrequencyParam;
+        lowPassEnabledParam, highPassEnabledParam, lowPassFrequencyParam, highPassFrequencyParam, controlRateParam;
 
 private:
     class EnvelopeFollower;
     struct EnvelopeFollowerModifierAudioNode;
 
-    std::atomic<float> envelopeValue;
+    std::atomic<float> envelopeValue { 0.0f };
     std::unique_ptr<EnvelopeFollower> envelopeFollower;
     juce::IIRFilter lowPassFilter, highPassFilter;
     double currentSampleRate = 44100.0;
     float currentLowPassFrequency = 0.0f, currentHighPassFrequency = 0.0f;
+    int decimationFactor = 0, samplesUntilNextControlValue = 0;
+    float controlPeak = 0.0f;
     LambdaTimer changedTimer;
 
     void prepareToPlay (double sampleRate);
     void processBlock (const juce::AudioBuffer<float>&);
+    void updateDecimationFactor();
     void reset();
 
     void valueTreeChanged() override;
@@ -13,29 +13,30 @@ namespace tracktion_engine
 
 namespace PredefinedWavetable
 {
+    // These are the ControlRateWaves shared with the other LFOs, mapped from 0 to 1
     static inline float getSinSample (float phase)
     {
-        return (std::sin (phase * juce::float_Pi * 2.0f) + 1.0f) / 2.0f;
+        return ControlRateWaves::toUnipolar (ControlRateWaves::sine (phase));
     }
 
     static inline float getTriangleSample (float phase)
     {
-        return (phase < 0.5f) ? (2.0f * phase) : (-2.0f * phase + 2.0f);
+        return ControlRateWaves::toUnipolar (ControlRateWaves::triangle (phase));
     }
 
     static inline float getSawUpSample (float phase)
     {
-        return phase;
+        return ControlRateWaves::toUnipolar (ControlRateWaves::sawUp (phase));
     }
 
     static inline float getSawDownSample (float phase)
     {
-        return 1.0f - phase;
+        return ControlRateWaves::toUnipolar (ControlRateWaves::sawDown (phase));
     }
 
     static inline float getSquareSample (float phase)
     {
-        return phase < 0.5f ? 1.0f : 0.0f;
+        return ControlRateWaves::toUnipolar (ControlRateWaves::square (phase, 0.5f));
     }
 
     static inline float getStepsUpSample (float phase, int totalNumSteps)
@@ -16,6 +16,7 @@ AutomatableEditItem::AutomatableEditItem (Edit& ed, const juce::ValueTree& v)
       elementState (v)
 {
     remapOnTempoChange.referTo (elementState, IDs::remapOnTempoChange, &edit.getUndoManager(), false);
+    snapshotAppliedCallback.setFunction ([this] { handleSnapshotApplied(); });
 }
 
 AutomatableEditItem::~AutomatableEditItem()
@@ -142,12 +143,89 @@ void AutomatableEditItem::updateParameterStreams (double time)
         p->updateFromAutomationSources (time);
 }
 
+void AutomatableEditItem::updateParameterStreams (EditTimeRange blockTime)
+{
+    const juce::ScopedLock sl (activeParameterLock);
+
+    for (auto p : activeParameters)
+        p->updateFromAutomationSources (blockTime);
+}
+
 void AutomatableEditItem::resetRecordingStatus()
 {
     for (auto p : automatableParams)
         p->resetRecordingStatus();
 }
 
+//==============================================================================
+AutomatableEditItem::ParameterSnapshot AutomatableEditItem::createParameterSnapshot() const
+{
+    ParameterSnapshot snapshot;
+    snapshot.values.reserve ((size_t) automatableParams.size());
+
+    for (auto p : automatableParams)
+        snapshot.values.push_back ({ p, p->getCurrentExplicitValue() });
+
+    return snapshot;
+}
+
+void AutomatableEditItem::applyParameterSnapshot (ParameterSnapshot snapshot)
+{
+    TRACKTION_ASSERT_MESSAGE_THREAD
+    auto newSnapshot = std::make_unique<ParameterSnapshot> (std::move (snapshot));
+
+    if (! isBeingActivelyPlayed())
+    {
+        {
+            // This replaces anything that was left waiting when playback stopped
+            const juce::SpinLock::ScopedLockType sl (snapshotLock);
+            pendingSnapshot.reset();
+        }
+
+        for (auto& v : newSnapshot->values)
+            v.parameter->setParameterFromSnapshot (v.value);
+
+        snapshotAppliedCallback.cancelPendingUpdate();
+        handleSnapshotApplied();
+        return;
+    }
+
+    {
+        const juce::SpinLock::ScopedLockType sl (snapshotLock);
+        std::swap (pendingSnapshot, newSnapshot);
+    }
+
+    // Any snapshot that was still waiting has been replaced, so gets deleted here
+}
+
+void AutomatableEditItem::applyPendingParameterSnapshot() noexcept
+{
+    const juce::SpinLock::ScopedTryLockType sl (snapshotLock);
+
+    // The last snapshot has to be deleted before another can be applied
+    if (! sl.isLocked() || pendingSnapshot == nullptr || appliedSnapshot != nullptr)
+        return;
+
+    for (auto& v : pendingSnapshot->values)
+        v.parameter->setParameterFromSnapshot (v.value);
+
+    appliedSnapshot = std::move (pendingSnapshot);
+    snapshotAppliedCallback.triggerAsyncUpdate();
+}
+
+void AutomatableEditItem::handleSnapshotApplied()
+{
+    std::unique_ptr<ParameterSnapshot> toDelete;
+
+    {
+        const juce::SpinLock::ScopedLockType sl (snapshotLock);
+        toDelete = std::move (appliedSnapshot);
+    }
+
+    toDelete.reset();
+    parameterSnapshotApplied();
+}
+
 //==============================================================================
 void AutomatableEditItem::buildParameterTree() const
 {
@@ -65,12 +65,49 @@ public:
     */
     void updateParameterStreams (double time);
 
+    /** Updates all the parameter streams to the start of a block and finds the values they'll
+        ramp to by its end. @see AutomatableParameter::getBlockEndValue
+    */
+    void updateParameterStreams (EditTimeRange blockTime);
+
     /** Iterates all the parameters to find out which ones need to be automated. */
     void updateActiveParameters();
 
     /** Marks the end of an automation recording stream. Call this when play stops or starts. */
     void resetRecordingStatus();
 
+    //==============================================================================
+    /** A set of values for some of this item's parameters, e.g. a preset, which can be
+        applied all at once.
+    */
+    struct ParameterSnapshot
+    {
+        struct Value
+        {
+            AutomatableParameter::Ptr parameter;
+            float value;
+        };
+
+        std::vector<Value> values;
+    };
+
+    /** Captures the current explicit values of all the parameters. */
+    ParameterSnapshot createParameterSnapshot() const;
+
+    /** Applies a set of parameter values together.
+        If the item is being played, the values are all set by the audio thread at the start
+        of its next block, so a patch change never gets heard half applied. Otherwise they're
+        set straight away. Either way, parameterSnapshotApplied() gets called once afterwards
+        on the message thread, instead of the usual callbacks for each parameter.
+        This must be called on the message thread.
+    */
+    void applyParameterSnapshot (ParameterSnapshot);
+
+    /** Applies any snapshot waiting for the start of the next block.
+        This is called by the audio thread before processing each block.
+    */
+    void applyPendingParameterSnapshot() noexcept;
+
     //==============================================================================
     juce::ValueTree elementState;
     juce::CachedValue<bool> remapOnTempoChange;
@@ -89,6 +126,9 @@ protected:
     /** Restores the value of any explicitly set parameters. */
     void restoreChangedParametersFromState();
 
+    /** Called on the message thread after a ParameterSnapshot has been applied. */
+    virtual void parameterSnapshotApplied() {}
+
 private:
     juce::CriticalSection activeParameterLock;
     juce::ReferenceCountedArray<AutomatableParameter> automatableParams, activeParameters;
@@ -110,6 +150,12 @@ private:
     std::unique_ptr<ParameterChangeListeners> parameterChangeListeners;
     void sendListChangeMessage() const;
 
+    // Snapshots are passed to the audio thread and back again to be deleted on the message thread
+    juce::SpinLock snapshotLock;
+    std::unique_ptr<ParameterSnapshot> pendingSnapshot, appliedSnapshot;
+    AsyncCaller snapshotAppliedCallback;
+    void handleSnapshotApplied();
+
     //==============================================================================
     juce::ReferenceCountedArray<AutomatableParameter> getFlattenedParameterTree (AutomatableParameterTree::TreeNode&) const;
 
@@ -131,7 +131,7 @@ struct ModifierAutomationSource : public AutomationModifierSource
     float getCurrentValue() override
     {
         const float baseValue = modifier->getCurrentValue();
-        return AutomationScaleHelpers::mapValue (baseValue, assignment->offset, assignment->value, assignment->curve);
+        return assignment->mapValue (baseValue);
     }
 
     const Modifier::Ptr modifier;
@@ -170,19 +170,27 @@ public:
         TRACKTION_ASSERT_MESSAGE_THREAD
 
         std::unique_ptr<AutomationIterator> newStream;
+        CompiledAutomationCurve::Ptr newCompiledCurve;
 
         if (curve.getNumPoints() > 0)
         {
-            auto s = std::make_unique<AutomationIterator> (parameter);
+            newCompiledCurve = CompiledAutomationCurve::create (curve);
+
+            // The stream is only replaced on this thread so it's safe to read its segments
+            // here while the audio thread moves it about
+            auto s = std::make_unique<AutomationIterator> (parameter, parameterStream.get());
 
             if (! s->isEmpty())
                 newStream = std::move (s);
         }
 
+        std::atomic_store (&compiledCurve, std::move (newCompiledCurve));
+        updateFlatness();
+
         {
             const juce::ScopedLock sl (parameterStreamLock);
             automationActive.store (newStream != nullptr, std::memory_order_relaxed);
-            parameterStream = std::move (newStream);
+            std::swap (parameterStream, newStream);
 
             if (! parameterStream)
                 parameter.updateToFollowCurve (lastTime);
@@ -190,6 +198,9 @@ public:
             lastTime = -1.0;
         }
 
+        // The old stream gets deleted here, outside the lock
+        newStream.reset();
+
         parameter.automatableEditElement.updateActiveParameters();
     }
 
@@ -198,10 +209,35 @@ public:
         return automationActive.load (std::memory_order_relaxed);
     }
 
+    /** Returns true if every point on the curve has the same value, so following it
+        can never change the parameter.
+    */
+    bool isFlat() const noexcept
+    {
+        return curveIsFlat.load (std::memory_order_acquire);
+    }
+
+    /** Returns the clipped and snapped value of a flat curve. */
+    float getFlatValue() const noexcept
+    {
+        return flatValue.load (std::memory_order_relaxed);
+    }
+
     float getValueAt (double time) override
     {
-        TRACKTION_ASSERT_MESSAGE_THREAD
-        return curve.getValueAt (time);
+        // The curve itself is always up to date but can only be read on the message thread
+        if (juce::MessageManager::getInstance()->currentThreadHasLockedMessageManager())
+            return curve.getValueAt (time);
+
+        if (auto c = getCompiledCurve())
+            return c->getValueAt (time);
+
+        return parameter.getCurrentBaseValue();
+    }
+
+    CompiledAutomationCurve::Ptr getCompiledCurve() const
+    {
+        return std::atomic_load (&compiledCurve);
     }
 
     bool isEnabledAt (double) override
@@ -211,11 +247,21 @@ public:
 
     void setPosition (double time) override
     {
-        if (! parameter.getEdit().getAutomationRecordManager().isReadingAutomation())
-            if (auto plugin = parameter.getPlugin())
-                if (! plugin->isClipEffectPlugin())
-                    return;
+        if (! isFollowingAutomation())
+            return;
 
+        // Offline renders evaluate the curve exactly rather than reading the pre-rendered stream
+        if (parameter.getEdit().isRendering())
+        {
+            if (auto c = getCompiledCurve())
+            {
+                directValue = c->getValueAt (time);
+                isEvaluatingDirectly = true;
+                return;
+            }
+        }
+
+        isEvaluatingDirectly = false;
         const juce::ScopedLock sl (parameterStreamLock);
 
         if (lastTime.exchange (time) != time)
@@ -229,10 +275,30 @@ public:
 
     float getCurrentValue() override
     {
+        if (isEvaluatingDirectly)
+            return directValue;
+
         const juce::ScopedLock sl (parameterStreamLock);
         return parameterStream->getCurrentValue();
     }
 
+    /** Returns the value at a time later in the block without moving the stream.
+        If the stream isn't being moved because automation reading is disabled, this
+        is just the current value.
+    */
+    float getStreamValueAt (double time)
+    {
+        if (isEvaluatingDirectly)
+            if (auto c = getCompiledCurve())
+                return c->getValueAt (time);
+
+        const bool canMove = isFollowingAutomation();
+        const juce::ScopedLock sl (parameterStreamLock);
+
+        return canMove ? parameterStream->getValueAt (time)
+                       : parameterStream->getCurrentValue();
+    }
+
     AutomatableParameter& parameter;
     AutomationCurve curve;
 
@@ -240,9 +306,36 @@ private:
     LambdaTimer deferredUpdateTimer;
     juce::CriticalSection parameterStreamLock;
     std::unique_ptr<AutomationIterator> parameterStream;
-    std::atomic<bool> automationActive { false };
+    CompiledAutomationCurve::Ptr compiledCurve;
+    std::atomic<bool> automationActive { false }, isEvaluatingDirectly { false }, curveIsFlat { false };
+    std::atomic<float> directValue { 0.0f }, flatValue { 0.0f };
     std::atomic<double> lastTime { -1.0 };
 
+    void updateFlatness()
+    {
+        const auto numPoints = curve.getNumPoints();
+        bool flat = numPoints > 0;
+
+        for (int i = 1; i < numPoints && flat; ++i)
+            flat = curve.getPointValue (i) == curve.getPointValue (0);
+
+        if (flat)
+            flatValue.store (parameter.snapToState (parameter.getValueRange().clipValue (curve.getPointValue (0))),
+                             std::memory_order_relaxed);
+
+        curveIsFlat.store (flat, std::memory_order_release);
+    }
+
+    bool isFollowingAutomation() const
+    {
+        if (! parameter.getEdit().getAutomationRecordManager().isReadingAutomation())
+            if (auto plugin = parameter.getPlugin())
+                if (! plugin->isClipEffectPlugin())
+                    return false;
+
+        return true;
+    }
+
     static juce::ValueTree getState (AutomatableParameter& ap)
     {
         auto v = ap.parentState.getChildWithProperty (IDs::paramID, ap.paramID);
@@ -284,7 +377,7 @@ struct MacroSource : public AutomationModifierSource
     {
         TRACKTION_ASSERT_MESSAGE_THREAD
         auto macroValue = macro->getCurve().getValueAt (time);
-        return AutomationScaleHelpers::mapValue (macroValue, assignment->offset, assignment->value, assignment->curve);
+        return assignment->mapValue (macroValue);
     }
 
     bool isEnabledAt (double) override
@@ -298,8 +391,7 @@ struct MacroSource : public AutomationModifierSource
         macro->updateFromAutomationSources (time);
         auto macroValue = macro->getCurrentValue();
 
-        currentValue.store (AutomationScaleHelpers::mapValue (macroValue, assignment->offset, assignment->value, assignment->curve),
-                            std::memory_order_release);
+        currentValue.store (assignment->mapValue (macroValue), std::memory_order_release);
     }
 
     bool isEnabled() override
@@ -347,6 +439,12 @@ struct AutomatableParameter::AutomationSourceList  : private ValueTreeObjectList
         return numSources.load() > 0;
     }
 
+    /** A quicker version of isActive() that can be called on the audio thread. */
+    bool hasSources() const noexcept
+    {
+        return numSources.load (std::memory_order_relaxed) > 0;
+    }
+
     template<typename Fn>
     void visitSources (Fn f)
     {
@@ -658,6 +756,45 @@ AutomatableParameter::ModifierAssignment::ModifierAssignment (Edit& e, const juc
     offset.referTo (state, IDs::offset, um);
     value.referTo (state, IDs::value, um);
     curve.referTo (state, IDs::curve, um);
+
+    updateMapping();
+    state.addListener (this);
+}
+
+float AutomatableParameter::ModifierAssignment::mapValue (float sourceValue) const noexcept
+{
+    // This is the quadratic bezier that AutomationScaleHelpers::mapValue solves, expanded
+    // with the control point worked out in advance
+    const float x = std::abs (sourceValue);
+    const float curved = x * (2.0f * (1.0f - x) * mappedControl.load (std::memory_order_relaxed)
+                                + x * mappedValue.load (std::memory_order_relaxed));
+    const float o = mappedOffset.load (std::memory_order_relaxed);
+
+    return sourceValue < 0.0f ? o - curved : o + curved;
+}
+
+void AutomatableParameter::ModifierAssignment::updateMapping()
+{
+    const float c = curve.get();
+    const float v = value.get();
+
+    // A linear mapping is the same bezier with its control point half way along
+    mappedControl.store (c == 0.0f ? v / 2.0f
+                                   : AutomationScaleHelpers::getQuadraticBezierControlPoint (0.0f, v, c),
+                         std::memory_order_relaxed);
+    mappedValue.store (v, std::memory_order_relaxed);
+    mappedOffset.store (offset.get(), std::memory_order_relaxed);
+}
+
+void AutomatableParameter::ModifierAssignment::valueTreePropertyChanged (juce::ValueTree& v, const juce::Identifier& i)
+{
+    if (v == state && (i == IDs::offset || i == IDs::value || i == IDs::curve))
+    {
+        offset.forceUpdateOfCachedValue();
+        value.forceUpdateOfCachedValue();
+        curve.forceUpdateOfCachedValue();
+        updateMapping();
+    }
 }
 
 AutomatableParameter::ModifierAssignment::Ptr AutomatableParameter::addModifier (ModifierSource& source, float value, float offset, float curve)
@@ -758,9 +895,20 @@ void AutomatableParameter::updateStream()
     curveSource->updateInterpolatedPoints();
 }
 
+bool AutomatableParameter::isUpToDateWithAutomation() const noexcept
+{
+    // A flat curve with nothing modifying it can't move the parameter once it's been set
+    // to the curve's value, so there's nothing to do until something changes
+    return curveSource->isFlat()
+            && ! (automationSourceList != nullptr && automationSourceList->hasSources())
+            && currentModifierValue.load (std::memory_order_relaxed) == 0.0f
+            && currentBaseValue.load (std::memory_order_relaxed) == curveSource->getFlatValue()
+            && blockEndValue.load (std::memory_order_relaxed) == currentValue.load (std::memory_order_relaxed);
+}
+
 void AutomatableParameter::updateFromAutomationSources (double time)
 {
-    if (updateParametersRecursionCheck)
+    if (updateParametersRecursionCheck || isUpToDateWithAutomation())
         return;
 
     const juce::ScopedValueSetter<bool> svs (updateParametersRecursionCheck, true);
@@ -799,6 +947,42 @@ void AutomatableParameter::updateFromAutomationSources (double time)
     setParameterValue (newBaseValue, true);
 }
 
+void AutomatableParameter::updateFromAutomationSources (EditTimeRange blockTime)
+{
+    if (updateParametersRecursionCheck || isUpToDateWithAutomation())
+        return;
+
+    updateFromAutomationSources (blockTime.getStart());
+
+    if (! curveSource->isActive())
+        return;
+
+    // The modifier amount found for the start of the block is held across it
+    auto endValue = snapToState (valueRange.clipValue (curveSource->getStreamValueAt (blockTime.getEnd())));
+
+    if (currentModifierValue != 0.0f)
+        endValue = snapToState (valueRange.clipValue (endValue + currentModifierValue));
+
+    blockEndValue = endValue;
+}
+
+void AutomatableParameter::fillBlockRamp (float* dest, int numSamples) const noexcept
+{
+    const float start = currentValue;
+    const float end = blockEndValue;
+
+    if (start == end || numSamples <= 1)
+    {
+        juce::FloatVectorOperations::fill (dest, start, numSamples);
+        return;
+    }
+
+    const float delta = (end - start) / (float) numSamples;
+
+    for (int i = 0; i < numSamples; ++i)
+        dest[i] = start + delta * (float) i;
+}
+
 //==============================================================================
 void AutomatableParameter::valueTreePropertyChanged (juce::ValueTree& v, const juce::Identifier& i)
 {
@@ -900,6 +1084,11 @@ AutomationCurve& AutomatableParameter::getCurve() const noexcept
     return curveSource->curve;
 }
 
+CompiledAutomationCurve::Ptr AutomatableParameter::getCompiledCurve() const
+{
+    return curveSource->getCompiledCurve();
+}
+
 Selectable* AutomatableParameter::getOwnerSelectable() const
 {
     if (macroOwner != nullptr)
@@ -969,6 +1158,9 @@ void AutomatableParameter::setParameterValue (float value, bool isFollowingCurve
     if (currentModifierValue != 0.0f)
         value = snapToState (getValueRange().clipValue (value + currentModifierValue));
 
+    // Any ramp for the block is set after this by updateFromAutomationSources
+    blockEndValue = value;
+
     if (currentValue != value)
     {
         parameterChanged (value, isFollowingCurve);
@@ -1034,6 +1226,12 @@ void AutomatableParameter::setParameterValue (float value, bool isFollowingCurve
     }
 }
 
+void AutomatableParameter::setParameterFromSnapshot (float value)
+{
+    currentParameterValue = value;
+    setParameterValue (value, true);
+}
+
 void AutomatableParameter::setParameter (float value, juce::NotificationType nt)
 {
     currentParameterValue = value;
@@ -1187,129 +1385,279 @@ AutomatableParameter* getParameter (AutomatableParameter::ModifierAssignment& as
 }
 
 //==============================================================================
-AutomationIterator::AutomationIterator (const AutomatableParameter& p)
+/** The interpolated points between two points on a curve, which only depend on the shape
+    of the curve between them so can be shared by iterators for different versions of it.
+*/
+struct AutomationIterator::Segment
 {
-    const auto& curve = p.getCurve();
+    struct Shape
+    {
+        double t1 = 0, t2 = 0;
+        float v1 = 0, v2 = 0, c = 0;
+        CurvePoint bp;
+        double x1end = 0, x2end = 0;
+        float y1end = 0, y2end = 0;
+        double minValueDelta = 0;
 
-    jassert (curve.getNumPoints() > 0);
-
-    const double timeDelta      = 1.0 / 100.0;
-    const double minValueDelta  = (p.getValueRange().getLength()) / 256.0;
-
-    int curveIndex = 0;
-    double t = 0.0;
-    float lastValue = 1.0e10;
-    auto lastTime = curve.getPointTime (curve.getNumPoints() - 1) + 1.0;
-    double t1 = 0.0;
-    double t2 = curve.getPointTime (0);
-    float v1 = curve.getValueAt (0.0);
-    float v2 = v1;
-    float c  = 0;
-    CurvePoint bp;
-    double x1end = 0;
-    double x2end = 0;
-    float y1end = 0;
-    float y2end = 0;
-
-    while (t < lastTime)
-    {
-        while (t >= t2)
+        bool operator== (const Shape& o) const noexcept
         {
-            if (curveIndex >= curve.getNumPoints() - 1)
-            {
-                t1 = t2;
-                v1 = v2;
-                t2 = lastTime;
+            return t1 == o.t1 && t2 == o.t2 && v1 == o.v1 && v2 == o.v2 && c == o.c
+                && bp.time == o.bp.time && bp.value == o.bp.value
+                && x1end == o.x1end && x2end == o.x2end && y1end == o.y1end && y2end == o.y2end
+                && minValueDelta == o.minValueDelta;
+        }
+
+        size_t getHash() const noexcept
+        {
+            return std::hash<double>() (t1) ^ (std::hash<double>() (t2) * 31) ^ (std::hash<float>() (v1) * 7919)
+                    ^ (std::hash<float>() (v2) * 104729) ^ (std::hash<float>() (c) * 1299709);
+        }
+    };
+
+    Segment (const Shape& s)  : shape (s)
+    {
+        // Points are rendered on the same grid as the whole curve would be, so the
+        // segments join up seamlessly
+        const double timeDelta = 1.0 / 100.0;
+        float lastValue = 1.0e10;
+
+        for (auto k = (juce::int64) std::ceil (shape.t1 / timeDelta - 1.0e-9);; ++k)
+        {
+            const double t = k * timeDelta;
+
+            if (t >= shape.t2)
                 break;
-            }
 
-            t1 = t2;
-            v1 = v2;
-            c  = curve.getPointCurve (curveIndex);
+            auto v = getValueAt (t);
 
-            if (c != 0.0f)
+            if (std::abs (v - lastValue) >= shape.minValueDelta)
             {
-                bp = curve.getBezierPoint (curveIndex);
-
-                if (c < -0.5 || c > 0.5)
-                    curve.getBezierEnds (curveIndex, x1end, y1end, x2end, y2end);
+                points.add ({ t, v });
+                lastValue = v;
             }
+        }
+    }
+
+    float getValueAt (double t) const noexcept
+    {
+        if (shape.t2 == shape.t1)
+            return shape.v2;
+
+        if (shape.c == 0.0f)
+            return shape.v1 + (shape.v2 - shape.v1) * (float) ((t - shape.t1) / (shape.t2 - shape.t1));
+
+        if (shape.c >= -0.5 && shape.c <= 0.5)
+            return AutomationCurve::getBezierYFromX (t, shape.t1, shape.v1, shape.bp.time, shape.bp.value, shape.t2, shape.v2);
+
+        if (t >= shape.t1 && t <= shape.x1end)
+            return shape.v1;
+
+        if (t >= shape.x2end && t <= shape.t2)
+            return shape.v2;
+
+        return AutomationCurve::getBezierYFromX (t, shape.x1end, shape.y1end, shape.bp.time, shape.bp.value, shape.x2end, shape.y2end);
+    }
+
+    const Shape shape;
+    juce::Array<AutoPoint> points;
+};
+
+//==============================================================================
+/** Keeps track of all the segments in use by any iterator, so Edits that have copies of
+    the same curves, e.g. the copies made for rendering, share them rather than
+    rendering their own. The cache only holds weak references so segments are still
+    deleted when the last iterator using them goes.
+*/
+struct AutomationIterator::SegmentCache
+{
+    std::shared_ptr<const Segment> find (const Segment::Shape& shape)
+    {
+        const juce::ScopedLock sl (lock);
+        auto range = segments.equal_range (shape.getHash());
+
+        for (auto i = range.first; i != range.second; ++i)
+            if (auto seg = i->second.lock())
+                if (seg->shape == shape)
+                    return seg;
+
+        return {};
+    }
+
+    void add (const std::shared_ptr<const Segment>& seg)
+    {
+        const juce::ScopedLock sl (lock);
+        segments.insert ({ seg->shape.getHash(), seg });
 
-            t2 = curve.getPointTime (++curveIndex);
-            v2 = curve.getPointValue (curveIndex);
+        // Clear out the segments that have been deleted whenever the cache has doubled in size
+        if (segments.size() > sizeAfterLastPurge * 2 + 64)
+        {
+            for (auto i = segments.begin(); i != segments.end();)
+                i = i->second.expired() ? segments.erase (i) : std::next (i);
+
+            sizeAfterLastPurge = segments.size();
         }
+    }
+
+private:
+    juce::CriticalSection lock;
+    std::unordered_multimap<size_t, std::weak_ptr<const Segment>> segments;
+    size_t sizeAfterLastPurge = 0;
+};
+
+AutomationIterator::AutomationIterator (const AutomatableParameter& p, const AutomationIterator* previous)
+{
+    CRASH_TRACER
+    const auto& curve = p.getCurve();
+    const auto numCurvePoints = curve.getNumPoints();
+
+    jassert (numCurvePoints > 0);
+
+    const double minValueDelta = (p.getValueRange().getLength()) / 256.0;
+
+    // Segments from the previous version of the curve that can be used again
+    std::unordered_multimap<size_t, std::shared_ptr<const Segment>> previousSegments;
 
-        float v = v2;
+    if (previous != nullptr)
+        for (auto& seg : previous->segments)
+            previousSegments.insert ({ seg->shape.getHash(), seg });
 
-        if (t2 != t1)
+    auto addSegment = [&] (const Segment::Shape& shape)
+    {
+        if (shape.t2 <= shape.t1)
+            return;
+
+        std::shared_ptr<const Segment> seg;
+        auto range = previousSegments.equal_range (shape.getHash());
+
+        for (auto i = range.first; i != range.second; ++i)
         {
-            if (c == 0.0f)
-            {
-                v = v1 + (v2 - v1) * (float) ((t - t1) / (t2 - t1));
-            }
-            else if (c >= -0.5 && c <= 0.5)
-            {
-                v = AutomationCurve::getBezierYFromX (t, t1, v1, bp.time, bp.value, t2, v2);
-            }
-            else
+            if (i->second->shape == shape)
             {
-                if (t >= t1 && t <= x1end)
-                    v = v1;
-                else if (t >= x2end && t <= t2)
-                    v = v2;
-                else
-                    v = AutomationCurve::getBezierYFromX (t, x1end, y1end, bp.time, bp.value, x2end, y2end);
+                seg = i->second;
+                break;
             }
         }
 
-        if (std::abs (v - lastValue) >= minValueDelta)
+        if (seg == nullptr)
+            seg = segmentCache->find (shape);
+
+        if (seg == nullptr)
+        {
+            seg = std::make_shared<const Segment> (shape);
+            segmentCache->add (seg);
+        }
+
+        if (! seg->points.isEmpty())
         {
-            jassert (t >= t1 && t <= t2);
+            numPoints += seg->points.size();
+            segments.push_back (std::move (seg));
+        }
+    };
+
+    segments.reserve ((size_t) numCurvePoints + 1);
 
-            AutoPoint point;
-            point.time = t;
-            point.value = v;
+    // The value before the first point
+    {
+        Segment::Shape shape;
+        shape.t1 = 0.0;
+        shape.t2 = curve.getPointTime (0);
+        shape.v1 = shape.v2 = curve.getValueAt (0.0);
+        shape.minValueDelta = minValueDelta;
+        addSegment (shape);
+    }
 
-            jassert (points.isEmpty() || points.getLast().time <= t);
-            points.add (point);
+    for (int i = 0; i < numCurvePoints - 1; ++i)
+    {
+        Segment::Shape shape;
+        shape.t1 = curve.getPointTime (i);
+        shape.v1 = curve.getPointValue (i);
+        shape.t2 = curve.getPointTime (i + 1);
+        shape.v2 = curve.getPointValue (i + 1);
+        shape.c  = curve.getPointCurve (i);
+        shape.minValueDelta = minValueDelta;
+
+        if (shape.c != 0.0f)
+        {
+            shape.bp = curve.getBezierPoint (i);
 
-            lastValue = v;
+            if (shape.c < -0.5 || shape.c > 0.5)
+                curve.getBezierEnds (i, shape.x1end, shape.y1end, shape.x2end, shape.y2end);
         }
 
-        t += timeDelta;
+        addSegment (shape);
+    }
+
+    // The value holds for a second after the last point
+    {
+        Segment::Shape shape;
+        shape.t1 = curve.getPointTime (numCurvePoints - 1);
+        shape.t2 = shape.t1 + 1.0;
+        shape.v1 = shape.v2 = curve.getPointValue (numCurvePoints - 1);
+        shape.minValueDelta = minValueDelta;
+        addSegment (shape);
     }
 }
 
-void AutomationIterator::setPosition (double newTime) noexcept
+AutomationIterator::~AutomationIterator()
+{
+}
+
+AutomationIterator::Position AutomationIterator::findPosition (double time) const noexcept
 {
-    jassert (points.size() > 0);
+    jassert (! segments.empty());
 
-    auto newIndex = currentIndex;
+    // Find the last segment that starts before the time, then the last point in it before the time
+    const auto numSegments = (int) segments.size();
+    auto newSegment = juce::isPositiveAndBelow (currentSegment, numSegments) ? currentSegment : 0;
+
+    while (newSegment > 0 && segments[(size_t) newSegment]->points.getReference (0).time >= time)
+        --newSegment;
+
+    while (newSegment < numSegments - 1 && segments[(size_t) newSegment + 1]->points.getReference (0).time < time)
+        ++newSegment;
+
+    auto& points = segments[(size_t) newSegment]->points;
+    auto newIndex = newSegment == currentSegment ? currentIndex : 0;
 
     if (! juce::isPositiveAndBelow (newIndex, points.size()))
         newIndex = 0;
 
-    if (newIndex > 0 && points.getReference (newIndex).time >= newTime)
+    if (newIndex > 0 && points.getReference (newIndex).time >= time)
     {
         --newIndex;
 
-        while (newIndex > 0 && points.getReference (newIndex).time >= newTime)
+        while (newIndex > 0 && points.getReference (newIndex).time >= time)
             --newIndex;
     }
     else
     {
-        while (newIndex < points.size() - 1 && points.getReference (newIndex + 1).time < newTime)
+        while (newIndex < points.size() - 1 && points.getReference (newIndex + 1).time < time)
             ++newIndex;
     }
 
-    if (currentIndex != newIndex)
+    jassert (juce::isPositiveAndBelow (newIndex, points.size()));
+    return { newSegment, newIndex };
+}
+
+void AutomationIterator::setPosition (double newTime) noexcept
+{
+    auto pos = findPosition (newTime);
+
+    if (currentSegment != pos.segment || currentIndex != pos.index)
     {
-        jassert (juce::isPositiveAndBelow (newIndex, points.size()));
-        currentIndex = newIndex;
-        currentValue = points.getReference (newIndex).value;
+        currentSegment = pos.segment;
+        currentIndex = pos.index;
+        currentValue = segments[(size_t) pos.segment]->points.getReference (pos.index).value;
     }
 }
 
+float AutomationIterator::getValueAt (double time) const noexcept
+{
+    // This searches from the cursor, so is quickest for times just after the current position
+    auto pos = findPosition (time);
+    return segments[(size_t) pos.segment]->points.getReference (pos.index).value;
+}
+
 //==============================================================================
 const char* AutomationDragDropTarget::automatableDragString = "automatableParamDrag";
 
@@ -1370,4 +1718,62 @@ void AutomationDragDropTarget::itemDropped (const SourceDetails& dragSourceDetai
     }
 }
 
+//==============================================================================
+#if TRACKTION_UNIT_TESTS
+
+class ModifierAssignmentMappingTests : public juce::UnitTest
+{
+public:
+    ModifierAssignmentMappingTests() : juce::UnitTest ("ModifierAssignment Mapping", "Tracktion") {}
+
+    void runTest() override
+    {
+        auto& engine = *Engine::getEngines().getFirst();
+        auto edit = Edit::createSingleTrackEdit (engine);
+
+        beginTest ("Mapped values match the curved mapping");
+        {
+            for (auto curve : { 0.0f, 0.25f, -0.3f, 0.5f, -0.5f })
+            {
+                for (auto value : { 1.0f, 0.4f, -0.7f })
+                {
+                    for (auto offset : { 0.0f, 0.2f })
+                    {
+                        juce::ValueTree v (IDs::LFO);
+                        v.setProperty (IDs::value, value, nullptr);
+                        v.setProperty (IDs::offset, offset, nullptr);
+                        v.setProperty (IDs::curve, curve, nullptr);
+                        TestAssignment ass (*edit, v);
+
+                        for (float x = -1.5f; x <= 1.5f; x += 0.05f)
+                            expectWithinAbsoluteError (ass.mapValue (x), AutomationScaleHelpers::mapValue (x, offset, value, curve), 1.0e-5f);
+                    }
+                }
+            }
+        }
+
+        beginTest ("Changing the assignment updates the mapping");
+        {
+            juce::ValueTree v (IDs::LFO);
+            TestAssignment ass (*edit, v);
+            ass.value = 0.5f;
+            ass.offset = 0.1f;
+
+            expectWithinAbsoluteError (ass.mapValue (1.0f), 0.6f, 1.0e-6f);
+            expectWithinAbsoluteError (ass.mapValue (-1.0f), -0.4f, 1.0e-6f);
+        }
+    }
+
+private:
+    struct TestAssignment  : public AutomatableParameter::ModifierAssignment
+    {
+        using ModifierAssignment::ModifierAssignment;
+        bool isForModifierSource (const AutomatableParameter::ModifierSource&) const override   { return false; }
+    };
+};
+
+static ModifierAssignmentMappingTests modifierAssignmentMappingTests;
+
+#endif
+
 }
@@ -39,6 +39,12 @@ public:
 
     AutomationCurve& getCurve() const noexcept;
 
+    /** Returns the most recently compiled version of the automation curve, which can be
+        evaluated on any thread. This is updated shortly after the curve changes and will
+        be nullptr if the curve has no points.
+    */
+    CompiledAutomationCurve::Ptr getCompiledCurve() const;
+
     void attachToCurrentValue (juce::CachedValue<float>&);
     void attachToCurrentValue (juce::CachedValue<int>&);
     void attachToCurrentValue (juce::CachedValue<bool>&);
@@ -83,6 +89,12 @@ public:
     void setNormalisedParameter (float value, juce::NotificationType);
     void updateToFollowCurve (double time);
 
+    /** Sets the explicit value of the parameter from the audio thread, the same way automation
+        would. This skips the undo and recording bookkeeping of setParameter and doesn't send
+        parameterChanged callbacks. It's used to apply AutomatableEditItem::ParameterSnapshots.
+    */
+    void setParameterFromSnapshot (float value);
+
     /** Call to indicate this parameter is about to be changed. */
     void parameterChangeGestureBegin();
 
@@ -104,7 +116,8 @@ public:
     };
 
     /** Connects a modifier source to an AutomatableParameter. */
-    struct ModifierAssignment : public juce::ReferenceCountedObject
+    struct ModifierAssignment : public juce::ReferenceCountedObject,
+                                private juce::ValueTree::Listener
     {
         using Ptr = juce::ReferenceCountedObjectPtr<ModifierAssignment>;
 
@@ -113,9 +126,21 @@ public:
         /** Must return true if this assigment is for the given source. */
         virtual bool isForModifierSource (const ModifierSource&) const = 0;
 
+        /** Maps a value from the source by the assignment's value, offset and curve.
+            This uses coefficients that are updated whenever the assignment changes, so
+            it's cheap and safe to call on the audio thread for every block.
+        */
+        float mapValue (float sourceValue) const noexcept;
+
         Edit& edit;
         juce::ValueTree state;
         juce::CachedValue<float> value, offset, curve;
+
+    private:
+        std::atomic<float> mappedOffset { 0.0f }, mappedValue { 0.0f }, mappedControl { 0.0f };
+
+        void updateMapping();
+        void valueTreePropertyChanged (juce::ValueTree&, const juce::Identifier&) override;
     };
 
     /** Creates an assignment for a given source.
@@ -165,6 +190,34 @@ public:
     /** Updates the parameter and modifier values from its current automation sources. */
     void updateFromAutomationSources (double);
 
+    /** Updates the parameter and modifier values for the start of a block, and also finds the
+        value the automation curve reaches by the end of it so the block can be ramped.
+        Modifiers are only evaluated at the start of the block and held across it.
+    */
+    void updateFromAutomationSources (EditTimeRange blockTime);
+
+    //==============================================================================
+    /** Returns the value the parameter will reach at the end of the current block.
+        This is only different to getCurrentValue() when automation is being played back
+        and the plugin has been updated with the block's whole time range, so plugins can
+        use it to ramp their parameters smoothly across the block instead of being split
+        into smaller ones to follow the curve.
+    */
+    float getBlockEndValue() const noexcept                     { return blockEndValue; }
+
+    /** Returns true if the parameter will change during the current block. */
+    bool isRampingOverBlock() const noexcept                    { return blockEndValue != currentValue; }
+
+    /** Returns the value a proportion (0 to 1) of the way through the current block. */
+    float getValueInBlock (float proportion) const noexcept
+    {
+        const float start = currentValue;
+        return start + (blockEndValue - start) * proportion;
+    }
+
+    /** Fills a buffer with the parameter's value at each sample of the current block. */
+    void fillBlockRamp (float* dest, int numSamples) const noexcept;
+
     //==============================================================================
     virtual bool isParameterActive() const                          { return true; }
     virtual bool isDiscrete() const                                 { return false; }
@@ -236,9 +289,12 @@ protected:
     MacroParameterList* macroOwner = nullptr;
     std::unique_ptr<AutomationCurveSource> curveSource;
     std::atomic<float> currentValue { 0.0f }, currentParameterValue { 0.0f },  currentBaseValue { 0.0f }, currentModifierValue { 0.0f };
+    std::atomic<float> blockEndValue { 0.0f };
     std::atomic<bool> isRecording { false };
     bool updateParametersRecursionCheck = false;
 
+    bool isUpToDateWithAutomation() const noexcept;
+
     juce::ValueTree modifiersState;
     struct AutomationSourceList;
     mutable std::unique_ptr<AutomationSourceList> automationSourceList;
@@ -392,15 +448,23 @@ public:
 
 //==============================================================================
 // A pre-rendered set of interpolated points along a curve, with a cursor which moves through it.
+// The points are rendered in segments between each pair of curve points, and if an iterator
+// for an earlier version of the curve is supplied, any segments that haven't changed are
+// shared with it rather than rendered again. Segments are also shared with any other iterators
+// that have the same ones, e.g. in copies of the Edit.
 struct AutomationIterator
 {
-    AutomationIterator (const AutomatableParameter&);
+    AutomationIterator (const AutomatableParameter&, const AutomationIterator* previous = nullptr);
+    ~AutomationIterator();
 
-    bool isEmpty() const noexcept               { return points.size() <= 1; }
+    bool isEmpty() const noexcept               { return numPoints <= 1; }
 
     void setPosition (double newTime) noexcept;
     float getCurrentValue() noexcept            { return currentValue; }
 
+    // Returns the value at a time without moving the cursor, so it's safe to call on the audio thread
+    float getValueAt (double time) const noexcept;
+
 private:
     struct AutoPoint
     {
@@ -408,10 +472,17 @@ private:
         float value;
     };
 
-    juce::Array<AutoPoint> points;
-    int currentIndex = -1;
+    struct Segment;
+    struct SegmentCache;
+    juce::SharedResourcePointer<SegmentCache> segmentCache;
+    std::vector<std::shared_ptr<const Segment>> segments;
+    int numPoints = 0;
+    int currentSegment = -1, currentIndex = -1;
     float currentValue = 0.0f;
 
+    struct Position { int segment, index; };
+    Position findPosition (double time) const noexcept;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AutomationIterator)
 };
 
@@ -818,6 +818,105 @@ Range<float> AutomationCurve::getValueLimits() const
     return { 0.0f, 1.0f };
 }
 
+//==============================================================================
+CompiledAutomationCurve::CompiledAutomationCurve (const AutomationCurve& curve)
+{
+    CRASH_TRACER
+    TRACKTION_ASSERT_MESSAGE_THREAD
+
+    const auto numPoints = curve.getNumPoints();
+    const auto numSegments = (size_t) jmax (0, numPoints - 1);
+
+    times.reserve ((size_t) numPoints);
+    values.reserve ((size_t) numPoints);
+    curves.reserve ((size_t) numPoints);
+
+    for (int i = 0; i < numPoints; ++i)
+    {
+        auto p = curve.state.getChild (i);
+        times.push_back (p.getProperty (IDs::t));
+        values.push_back (p.getProperty (IDs::v));
+        curves.push_back (p.getProperty (IDs::c));
+    }
+
+    bezierPoints.resize (numSegments);
+    x1Ends.resize (numSegments);
+    x2Ends.resize (numSegments);
+    y1Ends.resize (numSegments);
+    y2Ends.resize (numSegments);
+
+    for (size_t i = 0; i < numSegments; ++i)
+    {
+        const auto c = curves[i];
+
+        if (c == 0.0f)
+            continue;
+
+        bezierPoints[i] = curve.getBezierPoint ((int) i);
+
+        if (c < -0.5f || c > 0.5f)
+            curve.getBezierEnds ((int) i, x1Ends[i], y1Ends[i], x2Ends[i], y2Ends[i]);
+    }
+
+    if (numPoints == 0)
+        valueWhenEmpty = curve.getPointValue (0);
+}
+
+CompiledAutomationCurve::Ptr CompiledAutomationCurve::create (const AutomationCurve& curve)
+{
+    return std::make_shared<const CompiledAutomationCurve> (curve);
+}
+
+float CompiledAutomationCurve::getValueAt (double time) const noexcept
+{
+    const auto numPoints = getNumPoints();
+
+    if (numPoints == 0)
+        return valueWhenEmpty;
+
+    const auto index = nextIndexAfter (time);
+
+    if (index <= 0)
+        return values.front();
+
+    if (index >= numPoints)
+        return values.back();
+
+    const auto i = (size_t) index - 1;
+    const auto time1 = times[i], time2 = times[i + 1];
+    const auto value1 = values[i], value2 = values[i + 1];
+    const auto curve1 = curves[i];
+
+    if (curve1 == 0.0f)
+    {
+        auto alpha = (float) ((time - time1) / (time2 - time1));
+        return value1 + alpha * (value2 - value1);
+    }
+
+    const auto& bp = bezierPoints[i];
+
+    if (curve1 >= -0.5f && curve1 <= 0.5f)
+        return AutomationCurve::getBezierYFromX (time, time1, value1, bp.time, bp.value, time2, value2);
+
+    if (time >= time1 && time <= x1Ends[i])
+        return value1;
+
+    if (time >= x2Ends[i] && time <= time2)
+        return value2;
+
+    return AutomationCurve::getBezierYFromX (time, x1Ends[i], y1Ends[i], bp.time, bp.value, x2Ends[i], y2Ends[i]);
+}
+
+int CompiledAutomationCurve::indexBefore (double time) const noexcept
+{
+    return (int) (std::upper_bound (times.begin(), times.end(), time) - times.begin()) - 1;
+}
+
+int CompiledAutomationCurve::nextIndexAfter (double time) const noexcept
+{
+    return (int) (std::lower_bound (times.begin(), times.end(), time) - times.begin());
+}
+
 //==============================================================================
 int simplify (AutomationCurve& curve, int strength, EditTimeRange time)
 {
@@ -847,4 +946,69 @@ int simplify (AutomationCurve& curve, int strength, EditTimeRange time)
     return numPointsBefore - numPointsAfter;
 }
 
+//==============================================================================
+#if TRACKTION_UNIT_TESTS
+
+class CompiledAutomationCurveTests : public juce::UnitTest
+{
+public:
+    CompiledAutomationCurveTests() : juce::UnitTest ("CompiledAutomationCurve", "Tracktion") {}
+
+    void runTest() override
+    {
+        juce::ValueTree parent ("PARENT");
+        AutomationCurve curve (parent, {});
+
+        beginTest ("An empty curve compiles");
+        {
+            auto compiled = CompiledAutomationCurve::create (curve);
+            expectEquals (compiled->getNumPoints(), 0);
+            expectEquals (compiled->nextIndexAfter (1.0), 0);
+            expectEquals (compiled->indexBefore (1.0), -1);
+        }
+
+        // Linear, bezier and stepped segments
+        curve.addPoint (1.0, 0.2f, 0.0f);
+        curve.addPoint (2.0, 0.8f, 0.3f);
+        curve.addPoint (3.0, 0.1f, -0.4f);
+        curve.addPoint (4.0, 0.9f, 0.8f);
+        curve.addPoint (5.0, 0.3f, -0.9f);
+        curve.addPoint (6.0, 0.6f, 0.0f);
+
+        beginTest ("Values match the curve");
+        {
+            auto compiled = CompiledAutomationCurve::create (curve);
+            expectEquals (compiled->getNumPoints(), curve.getNumPoints());
+
+            for (double t = 0.0; t < 7.0; t += 0.01)
+                expectWithinAbsoluteError (compiled->getValueAt (t), curve.getValueAt (t), 1.0e-5f);
+        }
+
+        beginTest ("Index lookups match the curve");
+        {
+            auto compiled = CompiledAutomationCurve::create (curve);
+
+            for (double t = 0.0; t < 7.0; t += 0.25)
+            {
+                expectEquals (compiled->nextIndexAfter (t), curve.nextIndexAfter (t));
+                expectEquals (compiled->indexBefore (t), curve.indexBefore (t));
+            }
+        }
+
+        beginTest ("Compiled curves don't change with the curve");
+        {
+            auto compiled = CompiledAutomationCurve::create (curve);
+            const auto valueBefore = compiled->getValueAt (1.5);
+            curve.setPointValue (1, 0.0f);
+
+            expectEquals (compiled->getValueAt (1.5), valueBefore);
+            expect (CompiledAutomationCurve::create (curve)->getValueAt (1.5) != valueBefore);
+        }
+    }
+};
+
+static CompiledAutomationCurveTests compiledAutomationCurveTests;
+
+#endif
+
 }
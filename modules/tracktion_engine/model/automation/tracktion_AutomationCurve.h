@@ -120,6 +120,58 @@ private:
     JUCE_LEAK_DETECTOR (AutomationCurve)
 };
 
+//==============================================================================
+/**
+    An immutable copy of an AutomationCurve, compiled into flat arrays so it can be
+    evaluated quickly from any thread, e.g. by renders or UI drawing, without touching
+    the curve's ValueTree.
+
+    Compiled curves are shared with std::shared_ptr so a reader can keep hold of one
+    while the curve is being edited and a new version is compiled.
+*/
+class CompiledAutomationCurve
+{
+public:
+    using Ptr = std::shared_ptr<const CompiledAutomationCurve>;
+
+    /** Compiles the current state of a curve. This must be called on the message thread. */
+    explicit CompiledAutomationCurve (const AutomationCurve&);
+
+    /** Compiles a curve into a shared, immutable object. */
+    static Ptr create (const AutomationCurve&);
+
+    //==============================================================================
+    int getNumPoints() const noexcept                       { return (int) times.size(); }
+    double getPointTime (int index) const noexcept          { return times[(size_t) index]; }
+    float getPointValue (int index) const noexcept          { return values[(size_t) index]; }
+    float getPointCurve (int index) const noexcept          { return curves[(size_t) index]; }
+
+    /** Returns the value at a time, the same as AutomationCurve::getValueAt().
+        If there are no points, this returns the owner parameter's base value when the
+        curve was compiled.
+    */
+    float getValueAt (double time) const noexcept;
+
+    /** Returns the index of the last point at or before this time, or -1 if there isn't one. */
+    int indexBefore (double time) const noexcept;
+
+    /** Returns the index of the first point at or after this time, or the number of points if there isn't one. */
+    int nextIndexAfter (double time) const noexcept;
+
+private:
+    std::vector<double> times;
+    std::vector<float> values, curves;
+
+    // The bezier control points and curve ends for the segment following each point
+    std::vector<CurvePoint> bezierPoints;
+    std::vector<double> x1Ends, x2Ends;
+    std::vector<float> y1Ends, y2Ends;
+
+    float valueWhenEmpty = 0.0f;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CompiledAutomationCurve)
+};
+
 //==============================================================================
 /** Removes points from the curve to simplfy it and returns the number of points removed. */
 int simplify (AutomationCurve&, int strength, EditTimeRange range);
@@ -146,14 +146,57 @@ void AutomationRecordManager::punchOut (bool toEnd)
     }
 }
 
+//==============================================================================
+void AutomationRecordManager::AutomationParamData::addChange (double time, float value)
+{
+    // Dropped changes must be within this small fraction of the parameter's range from the line
+    const float tolerance = parameter.isDiscrete() ? 0.0f : parameter.getValueRange().getLength() * 0.002f;
+    const int maxDroppedChanges = 256;
+
+    const int num = changes.size();
+
+    if (num >= 2 && droppedChanges.size() < maxDroppedChanges)
+    {
+        auto& anchor = changes.getReference (num - 2);
+        auto& last = changes.getReference (num - 1);
+
+        // Changes that go back in time are from a loop so always start a new run
+        if (time > anchor.time && last.time >= anchor.time && time >= last.time)
+        {
+            auto isCloseToLine = [&] (const Change& c)
+            {
+                auto alpha = (float) ((c.time - anchor.time) / (time - anchor.time));
+                return std::abs (anchor.value + alpha * (value - anchor.value) - c.value) <= tolerance;
+            };
+
+            bool canReplaceLast = isCloseToLine (last);
+
+            for (int i = 0; i < droppedChanges.size() && canReplaceLast; ++i)
+                canReplaceLast = isCloseToLine (droppedChanges.getReference (i));
+
+            if (canReplaceLast)
+            {
+                droppedChanges.add (last);
+                last = Change (time, value);
+                return;
+            }
+        }
+    }
+
+    droppedChanges.clearQuick();
+    changes.add (Change (time, value));
+}
+
+//==============================================================================
 void AutomationRecordManager::applyChangesToParameter (AutomationParamData* parameter, double end, bool toEnd)
 {
     CRASH_TRACER
     OwnedArray<AutomationCurve> newCurves;
 
     {
+        // These curves aren't given the parameter as an owner so the points added to them
+        // aren't put on the Edit's undo stack before they're merged into the real curve
         std::unique_ptr<AutomationCurve> curve (new AutomationCurve());
-        curve->setOwnerParameter (&parameter->parameter);
 
         for (int i = 0; i < parameter->changes.size(); ++i)
         {
@@ -166,13 +209,13 @@ void AutomationRecordManager::applyChangesToParameter (AutomationParamData* para
                 {
                     newCurves.add (curve.release());
                     curve.reset (new AutomationCurve());
-                    curve->setOwnerParameter (&parameter->parameter);
                 }
             }
 
             const float oldVal = (i == 0) ? (parameter->parameter.getCurve().getNumPoints() > 0 ? parameter->parameter.getCurve().getValueAt (change.time)
                                                                                                 : parameter->originalValue)
-                                          : curve->getValueAt (change.time);
+                                          : (curve->getNumPoints() > 0 ? curve->getValueAt (change.time)
+                                                                       : parameter->parameter.getCurrentBaseValue());
 
             const float newVal = parameter->parameter.snapToState (change.value);
 
@@ -255,7 +298,7 @@ void AutomationRecordManager::postAutomationChange (AutomatableParameter& param,
     {
         if (&p->parameter == &param)
         {
-            p->changes.add (AutomationParamData::Change (time, value));
+            p->addChange (time, value);
             break;
         }
     }
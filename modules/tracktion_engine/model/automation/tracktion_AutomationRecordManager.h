@@ -81,9 +81,19 @@ private:
             float value;
         };
 
+        /** Adds a change, thinning out any previous ones that lie close enough to a straight
+            line between the points either side of them, so long recordings stay compact.
+        */
+        void addChange (double time, float value);
+
         AutomatableParameter& parameter;
         juce::Array<Change> changes;
         float originalValue;
+
+    private:
+        // The changes dropped since the last one that was kept, which the line from it to
+        // the newest change must stay close to
+        juce::Array<Change> droppedChanges;
     };
 
     Edit& edit;
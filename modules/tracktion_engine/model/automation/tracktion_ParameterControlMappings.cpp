@@ -68,6 +68,11 @@ ParameterControlMappings* ParameterControlMappings::getCurrentlyFocusedMappings
 }
 
 //==============================================================================
+static juce::int64 getMappingLookupKey (int controllerID, int channel) noexcept
+{
+    return (((juce::int64) channel) << 32) | (juce::uint32) controllerID;
+}
+
 int ParameterControlMappings::addMapping (int controllerID, int channel, const AutomatableParameter::Ptr& param)
 {
     const ScopedLock sl (lock);
@@ -86,6 +91,7 @@ int ParameterControlMappings::addMapping (int controllerID, int channel, const A
     channelIDs.add (channel);
     parameters.add (param);
     parameterFullNames.add (param->getFullName());
+    mappingsChanged();
 
     return controllerIDs.size() - 1;
 }
@@ -98,6 +104,7 @@ void ParameterControlMappings::removeMapping (int index)
     channelIDs.remove (index);
     parameters.remove (index);
     parameterFullNames.remove (index);
+    mappingsChanged();
 
     tellEditAboutChange();
 }
@@ -153,11 +160,14 @@ void ParameterControlMappings::sendChange (int controllerID, float newValue, int
 
     if (! learnActive)
     {
-        for (int index = 0; index < controllerIDs.size(); index++)
+        rebuildMappingLookupIfNeeded();
+        auto found = mappingLookup.find (getMappingLookupKey (controllerID, channel));
+
+        if (found != mappingLookup.end())
         {
-            if (controllerIDs[index] == controllerID && channelIDs[index] == channel)
+            for (auto index : found->second)
             {
-                if (auto p = parameters.getUnchecked (index))
+                if (auto p = parameters[index])
                 {
                     jassert (Selectable::isSelectableValid (p.get()));
                     p->midiControllerMoved (newValue);
@@ -167,6 +177,20 @@ void ParameterControlMappings::sendChange (int controllerID, float newValue, int
     }
 }
 
+void ParameterControlMappings::rebuildMappingLookupIfNeeded()
+{
+    if (! mappingLookupNeedsRebuilding)
+        return;
+
+    mappingLookup.clear();
+
+    for (int i = 0; i < controllerIDs.size(); ++i)
+        if (controllerIDs.getUnchecked (i) != 0)
+            mappingLookup[getMappingLookupKey (controllerIDs.getUnchecked (i), channelIDs[i])].add (i);
+
+    mappingLookupNeedsRebuilding = false;
+}
+
 bool ParameterControlMappings::getParameterMapping (AutomatableParameter& param, int& channel, int& controllerID) const
 {
     auto index = parameters.indexOf (&param);
@@ -241,6 +265,7 @@ void ParameterControlMappings::loadFrom (const ValueTree& state)
     channelIDs.clear();
     parameters.clear();
     parameterFullNames.clear();
+    mappingsChanged();
 
     if (state.hasType (IDs::CONTROLLERMAPPINGS))
     {
@@ -566,6 +591,7 @@ void ParameterControlMappings::showMappingsListForRow (int row)
             }
         }
 
+        mappingsChanged();
         tellEditAboutChange();
         sendChangeMessage();
     }
@@ -638,6 +664,7 @@ void ParameterControlMappings::setLearntParam (bool keepListening)
 
             controllerIDs.set (listeningOnRow, lastControllerID);
             channelIDs.set (listeningOnRow, lastControllerChannel);
+            mappingsChanged();
 
             tellEditAboutChange();
         }
@@ -803,6 +830,7 @@ void ParameterControlMappings::loadPreset (int index)
                         parameters.add (plugin->getAutomatableParameterByID (item->getStringAttribute ("parameter")));
                     }
 
+                    mappingsChanged();
                     tellEditAboutChange();
                     sendChangeMessage();
                 }
@@ -91,6 +91,14 @@ private:
 
     juce::CriticalSection lock;
 
+    // Maps each channel and controller to the rows that use it, so incoming controller
+    // messages don't need to search all the mappings. It's rebuilt when the mappings change.
+    std::unordered_map<juce::int64, juce::Array<int>> mappingLookup;
+    bool mappingLookupNeedsRebuilding = true;
+
+    void mappingsChanged() noexcept         { mappingLookupNeedsRebuilding = true; }
+    void rebuildMappingLookupIfNeeded();
+
     void tellEditAboutChange();
     int addMapping (int id, int channel, const AutomatableParameter::Ptr&);
 
@@ -246,70 +246,436 @@ private:
 };
 
 //==============================================================================
-/**
-    Performs a tempo detection task on a background thread.
+/** AudioNode that plays a clip's AudioSegmentList by timestretching the original
+    file as it goes, rather than playing a proxy that's had to be rendered first.
+
+    Each segment is played by a Voice which is started from wherever the playhead is, with
+    a little pre-roll so the stretcher has settled by the time its output is heard.
+    Two voices are enough to cover the crossfades between neighbouring segments.
+    Its output matches the proxy's, so it takes the same edit range and gets wrapped
+    in the same fade and plugin nodes.
 */
-class AudioClipBase::TempoDetectTask   : public ThreadPoolJobWithProgress
+class AudioClipBase::RealtimeTimeStretchAudioNode  : public AudioNode
 {
 public:
-    /** Creates a task for a given file. */
-    TempoDetectTask (Engine& e, const File& file)
-        : ThreadPoolJobWithProgress (TRANS("Detecting tempo")),
-          engine (e), sourceFile (file)
+    RealtimeTimeStretchAudioNode (AudioClipBase& clip, EditTimeRange editTime, LiveClipLevel level)
+        : engine (clip.edit.engine),
+          file (clip.getAudioFile()),
+          fileInfo (file.getInfo()),
+          renderInfo (clip.createProxyRenderingInfo()),
+          editPosition (editTime),
+          clipLevel (level)
     {
+        jassert (renderInfo != nullptr && renderInfo->audioSegmentList != nullptr);
     }
 
-    /** Returns the bpm after a successful detection. */
-    float getBpm()                                      { return bpm; }
+    void getAudioNodeProperties (AudioNodeProperties& info) override
+    {
+        info.hasAudio           = true;
+        info.hasMidi            = false;
+        info.numberOfChannels   = jmax (1, fileInfo.numChannels);
+    }
 
-    /** Returns true if the result was within a sensible range. */
-    bool isResultSensible()                             { return isSensible; }
+    void visitNodes (const VisitorFn& v) override
+    {
+        v (*this);
+    }
+
+    bool purgeSubNodes (bool keepAudio, bool /*keepMidi*/) override
+    {
+        return keepAudio;
+    }
+
+    void prepareAudioNodeToPlay (const PlaybackInitialisationInfo& info) override
+    {
+        CRASH_TRACER
+        outputSampleRate = info.sampleRate;
+        stretchBlockSize = jmin (info.blockSizeSamples, 512);
+        numChannels = jmax (1, fileInfo.numChannels);
+        crossfadeSamples = (int) (outputSampleRate * renderInfo->audioSegmentList->getCrossfadeLength());
+
+        voices.clear();
+
+        for (int i = 0; i < numVoices; ++i)
+        {
+            auto v = new Voice (numChannels);
+            v->reader = engine.getAudioFileManager().cache.createReader (file);
+            v->stretcher.initialise (outputSampleRate, stretchBlockSize, numChannels,
+                                     renderInfo->mode, renderInfo->options, true);
+
+            // The input's kept topped up ahead of what the stretcher asks for, so that
+            // cache misses are noticed a few blocks before they'd be heard
+            auto maxNeeded = jmax (v->stretcher.getMaxFramesNeeded(), stretchBlockSize) + stretchBlockSize;
+            v->input.setSize (numChannels, maxNeeded * 3);
+            v->output.setSize (numChannels, stretchBlockSize * 2);
+            v->readAheadSamples = maxNeeded * 2;
+            voices.add (v);
+        }
+
+        nextEditTime = -1.0;
+    }
+
+    bool isReadyToRender() override
+    {
+        if (file.isNull())
+            return true;
+
+        for (auto v : voices)
+        {
+            if (v->reader == nullptr)
+                v->reader = engine.getAudioFileManager().cache.createReader (file);
+
+            if (v->reader == nullptr || v->reader->getSampleRate() <= 0.0)
+                return false;
+        }
+
+        return true;
+    }
 
+    void releaseAudioNodeResources() override
+    {
+        voices.clear();
+    }
+
+    void renderOver (const AudioRenderContext& rc) override
+    {
+        callRenderAdding (rc);
+    }
+
+    void renderAdding (const AudioRenderContext& rc) override
+    {
+        invokeSplitRender (rc, *this);
+    }
+
+    void renderSection (const AudioRenderContext& rc, EditTimeRange editTime)
+    {
+        SCOPED_REALTIME_CHECK
+
+        if (rc.destBuffer == nullptr || rc.bufferNumSamples == 0 || voices.isEmpty()
+             || fileInfo.sampleRate <= 0.0 || outputSampleRate <= 0.0)
+            return;
+
+        if (! rc.isContiguousWithPreviousBlock() || std::abs (editTime.getStart() - nextEditTime) > 1.0e-6)
+            for (auto v : voices)
+                v->segmentIndex = -1;
+
+        nextEditTime = editTime.getEnd();
+
+        const EditTimeRange clipTime (editTime - editPosition.getStart());
+        const auto& segments = renderInfo->audioSegmentList->getSegments();
+
+        for (auto v : voices)
+            if (v->segmentIndex >= 0 && ! segments.getReference (v->segmentIndex).getRange().overlaps (clipTime))
+                v->segmentIndex = -1;
+
+        float gains[2];
+
+        // For stereo, use the pan, otherwise ignore it
+        if (rc.destBuffer->getNumChannels() == 2)
+            clipLevel.getLeftAndRightGains (gains[0], gains[1]);
+        else
+            gains[0] = gains[1] = clipLevel.getGainIncludingMute();
+
+        if (rc.playhead.isUserDragging())
+        {
+            gains[0] *= 0.4f;
+            gains[1] *= 0.4f;
+        }
+
+        AudioScratchBuffer scratch (numChannels, rc.bufferNumSamples);
+
+        for (int i = 0; i < segments.size(); ++i)
+        {
+            auto& segment = segments.getReference (i);
+            auto segmentRange = segment.getRange();
+
+            if (segmentRange.getStart() >= clipTime.getEnd())
+                break;
+
+            if (! segmentRange.overlaps (clipTime))
+                continue;
+
+            auto v = getVoiceFor (i, jmax (clipTime.getStart(), segmentRange.getStart()));
+
+            if (v == nullptr)
+                continue;
+
+            auto startSample = jlimit (0, rc.bufferNumSamples, roundToInt ((segmentRange.getStart() - clipTime.getStart()) * outputSampleRate));
+            auto endSample   = jlimit (startSample, rc.bufferNumSamples, roundToInt ((segmentRange.getEnd() - clipTime.getStart()) * outputSampleRate));
+            auto numSamples  = endSample - startSample;
+
+            if (numSamples <= 0)
+                continue;
+
+            readOutput (*v, scratch.buffer, numSamples, rc.isRendering);
+            applyFades (*v, segment, scratch.buffer, numSamples);
+            v->outputPosition += numSamples;
+
+            for (int channel = rc.destBuffer->getNumChannels(); --channel >= 0;)
+                rc.destBuffer->addFrom (channel, rc.bufferStartSample + startSample,
+                                        scratch.buffer, jmin (channel, numChannels - 1), 0, numSamples,
+                                        gains[channel & 1]);
+        }
+
+        for (auto v : voices)
+            if (v->segmentIndex >= 0)
+                readAhead (*v, 0);
+    }
+
+private:
     //==============================================================================
-    /** Performs the actual detection. */
-    JobStatus runJob() override
+    struct Voice
+    {
+        Voice (int numChannels) : input (numChannels, 1), output (numChannels, 1) {}
+
+        AudioFileCache::Reader::Ptr reader;
+        TimeStretcher stretcher;
+        AudioFifo input, output;
+        int segmentIndex = -1, readAheadSamples = 0, numOutputSamplesToSkip = 0;
+        int64 sourcePosition = 0, sourceOffset = 0, outputPosition = 0;
+    };
+
+    static constexpr int numVoices = 2;
+
+    Engine& engine;
+    AudioFile file;
+    AudioFileInfo fileInfo;
+    std::unique_ptr<ProxyRenderingInfo> renderInfo;
+    EditTimeRange editPosition;
+    LiveClipLevel clipLevel;
+
+    juce::OwnedArray<Voice> voices;
+    double outputSampleRate = 44100.0, nextEditTime = -1.0;
+    int stretchBlockSize = 512, numChannels = 1, crossfadeSamples = 0;
+
+    Voice* getVoiceFor (int segmentIndex, double clipTime)
+    {
+        for (auto v : voices)
+            if (v->segmentIndex == segmentIndex)
+                return v;
+
+        for (auto v : voices)
+        {
+            if (v->segmentIndex < 0)
+            {
+                startVoice (*v, segmentIndex, clipTime);
+                return v;
+            }
+        }
+
+        jassertfalse; // more segments are overlapping than there are voices
+        return nullptr;
+    }
+
+    void startVoice (Voice& v, int segmentIndex, double clipTime)
+    {
+        auto& segment = renderInfo->audioSegmentList->getSegments().getReference (segmentIndex);
+        auto sampleRange = segment.getSampleRange();
+        auto timeIntoSegment = jmax (0.0, clipTime - segment.getRange().getStart());
+
+        // Treating the file's samples as if they were at the output rate speeds them up by
+        // this much, which the stretcher has to undo along with the segment's own stretch
+        const auto fileSpeedRatio = fileInfo.sampleRate / outputSampleRate;
+        const auto sourceSamplesPerOutputSample = segment.getStretchRatio() * fileSpeedRatio;
+
+        v.segmentIndex = segmentIndex;
+        v.stretcher.reset();
+        v.stretcher.setSpeedAndPitch ((float) (1.0 / sourceSamplesPerOutputSample),
+                                      segment.getTranspose() + (float) (12.0 * std::log2 (fileSpeedRatio)));
+        v.input.reset();
+        v.output.reset();
+
+        if (v.reader != nullptr)
+        {
+            if (segment.isFollowedBySilence())
+            {
+                v.reader->setLoopRange ({});
+                v.sourceOffset = sampleRange.getStart();
+            }
+            else
+            {
+                v.reader->setLoopRange (sampleRange);
+                v.sourceOffset = 0;
+            }
+        }
+
+        // Starting a little early lets the stretcher fill its window with real audio,
+        // and the output for the pre-roll is skipped
+        auto sourcePosition = (int64) (timeIntoSegment * fileInfo.sampleRate * segment.getStretchRatio());
+        auto preRoll = (int64) jmin ((int64) v.stretcher.getMaxFramesNeeded(), sourcePosition);
+
+        v.sourcePosition = sourcePosition - preRoll;
+        v.numOutputSamplesToSkip = (int) (preRoll / sourceSamplesPerOutputSample);
+        v.outputPosition = roundToInt (timeIntoSegment * outputSampleRate);
+    }
+
+    /** Tops up the voice's input. With a timeout of 0 this is just reading ahead, and if
+        the data isn't in the cache yet it's tried again next block. Otherwise the stretcher
+        needs it now, so a miss becomes silence.
+    */
+    void readAhead (Voice& v, int timeoutMs)
     {
-        std::unique_ptr<AudioFormatReader> reader (AudioFileUtils::createReaderFor (engine, sourceFile));
+        auto reader = v.reader;
 
         if (reader == nullptr)
-            return jobHasFinished;
+            return;
+
+        const auto numToRead = v.readAheadSamples - v.input.getNumReady();
+
+        if (numToRead <= 0)
+            return;
 
-        auto numChannels = (int) reader->numChannels;
-        auto numSamples = reader->lengthInSamples;
-        auto sampleRate = reader->sampleRate;
+        AudioScratchBuffer scratch (numChannels, numToRead);
+        const auto channels = AudioChannelSet::canonicalChannelSet (numChannels);
 
-        if (numSamples <= 0)
-            return jobHasFinished;
+        reader->setReadPosition (v.sourceOffset + v.sourcePosition);
 
-        // main detection loop
+        if (! reader->readSamples (numToRead, scratch.buffer, channels, 0, channels, timeoutMs))
         {
-            TempoDetect detector (numChannels, sampleRate);
-            const int blockSize = 65536;
-            const bool useRightChan = numChannels > 1;
+            if (timeoutMs == 0)
+                return;
+
+            scratch.buffer.clear();
+        }
+
+        v.input.write (scratch.buffer);
+        v.sourcePosition += numToRead;
+    }
+
+    void readOutput (Voice& v, juce::AudioBuffer<float>& dest, int numSamples, bool isRendering)
+    {
+        int start = 0;
 
-            // can't use an AudioScratchBuffer yet
-            AudioBuffer<float> buffer (numChannels, blockSize);
+        while (numSamples > 0)
+        {
+            if (v.output.getNumReady() == 0)
+                processNextBlock (v, isRendering);
 
-            int64 numLeft = numSamples;
-            int64 startSample = 0;
+            auto numReady = jmin (numSamples, v.output.getNumReady());
 
-            while (numLeft > 0)
+            if (numReady <= 0)
             {
-                if (shouldExit())
-                    return jobHasFinished;
+                dest.clear (start, numSamples);
+                break;
+            }
 
-                const int numThisTime = (int) jmin (numLeft, (int64) blockSize);
-                reader->read (&buffer, 0, numThisTime, startSample, true, useRightChan);
-                detector.processSection (buffer, numThisTime);
+            if (v.numOutputSamplesToSkip > 0)
+            {
+                auto numToSkip = jmin (numReady, v.numOutputSamplesToSkip);
+                AudioScratchBuffer skipped (numChannels, numToSkip);
+                v.output.read (skipped.buffer, 0, numToSkip);
+                v.numOutputSamplesToSkip -= numToSkip;
+                continue;
+            }
+
+            v.output.read (dest, start, numReady);
+            start += numReady;
+            numSamples -= numReady;
+        }
+    }
+
+    void processNextBlock (Voice& v, bool isRendering)
+    {
+        CRASH_TRACER
+        const auto needed = v.stretcher.getFramesNeeded();
+
+        AudioScratchBuffer out (numChannels, stretchBlockSize);
+
+        if (needed >= 0)
+        {
+            jassert (needed <= v.input.getFreeSpace() + v.input.getNumReady());
 
-                startSample += numThisTime;
-                numLeft -= numThisTime;
-                progress = numLeft / (float) numSamples;
+            // Renders have to wait for the file rather than coming out silent
+            if (v.input.getNumReady() < needed)
+                readAhead (v, isRendering ? 5000 : 3);
+
+            AudioScratchBuffer in (numChannels, jmax (1, needed));
+
+            if (! v.input.read (in.buffer, 0, needed))
+                in.buffer.clear();
+
+            v.stretcher.processData (in.buffer.getArrayOfReadPointers(), needed,
+                                     out.buffer.getArrayOfWritePointers());
+        }
+        else
+        {
+            jassert (needed == -1);
+            v.stretcher.flush (out.buffer.getArrayOfWritePointers());
+        }
+
+        v.output.write (out.buffer);
+    }
+
+    void applyFades (Voice& v, const AudioSegmentList::Segment& segment,
+                     juce::AudioBuffer<float>& buffer, int numSamples) const
+    {
+        if (crossfadeSamples <= 0)
+            return;
+
+        const auto blockStart = v.outputPosition;
+        const auto blockEnd = blockStart + numSamples;
+
+        auto applyFade = [&] (int64 fadeStart, int64 fadeEnd, bool isFadeOut)
+        {
+            auto start = jmax (fadeStart, blockStart);
+            auto end = jmin (fadeEnd, blockEnd);
+
+            if (end <= start)
+                return;
+
+            auto alpha1 = (start - fadeStart) / (float) (fadeEnd - fadeStart);
+            auto alpha2 = (end - fadeStart) / (float) (fadeEnd - fadeStart);
+
+            if (isFadeOut)
+            {
+                alpha1 = 1.0f - alpha1;
+                alpha2 = 1.0f - alpha2;
             }
 
-            bpm = detector.finishAndDetect();
-            isSensible = bpm > 0;
+            AudioFadeCurve::applyCrossfadeSection (buffer, (int) (start - blockStart), (int) (end - start),
+                                                   AudioFadeCurve::convex, alpha1, alpha2);
+        };
+
+        if (segment.hasFadeIn())
+            applyFade (0, crossfadeSamples, false);
+
+        if (segment.hasFadeOut())
+        {
+            auto segmentLength = (int64) (segment.getRange().getLength() * outputSampleRate);
+            applyFade (segmentLength - crossfadeSamples, segmentLength, true);
         }
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RealtimeTimeStretchAudioNode)
+};
+
+//==============================================================================
+/**
+    Performs a tempo detection task on a background thread.
+*/
+class AudioClipBase::TempoDetectTask   : public ThreadPoolJobWithProgress
+{
+public:
+    /** Creates a task for a given file. */
+    TempoDetectTask (Engine& e, const File& file)
+        : ThreadPoolJobWithProgress (TRANS("Detecting tempo")),
+          engine (e), sourceFile (file)
+    {
+    }
+
+    /** Returns the bpm after a successful detection. */
+    float getBpm()                                      { return bpm; }
+
+    /** Returns true if the result was within a sensible range. */
+    bool isResultSensible()                             { return isSensible; }
+
+    //==============================================================================
+    /** Performs the actual detection. */
+    JobStatus runJob() override
+    {
+        bpm = TempoDetect::detectTempo (engine, AudioFile (engine, sourceFile), &progress,
+                                        [this] { return shouldExit(); });
+        isSensible = bpm > 0;
 
         return jobHasFinished;
     }
@@ -340,7 +706,12 @@ public:
         setName (TRANS("Creating Proxy") + ": " + acb.getName());
 
         if (renderTimestretched)
+        {
             proxyInfo = acb.createProxyRenderingInfo();
+
+            // Clips with the same source and stretch settings render the same audio
+            renderKey = acb.getProxyHash() ^ original.getHash();
+        }
     }
 
 private:
@@ -478,7 +849,7 @@ AudioClipBase::AudioClipBase (const juce::ValueTree& v, EditItemID id, Type t, C
     isReversed.referTo (state, IDs::isReversed, um);
     autoDetectBeats.referTo (state, IDs::autoDetectBeats, um);
 
-    level->pan = jlimit (-1.0f, 1.0f, level->pan.get());
+    level->pan = jlimit (-1.0f, 1.0f, getPan());
     checkFadeLengthsForOverrun();
 
     clipEffectsVisible.referTo (state, IDs::effectsVisible, nullptr);
@@ -517,7 +888,7 @@ void AudioClipBase::initialise()
 
     if (shouldAttemptRender())
     {
-        auto audioFile = RenderManager::getAudioFileForHash (edit.engine, edit.getTempDirectory (false), getHash());
+        auto audioFile = getRenderedSourceFile();
 
         if (currentSourceFile != audioFile.getFile())
             setCurrentSourceFile (audioFile.getFile());
@@ -534,9 +905,9 @@ void AudioClipBase::cloneFrom (Clip* c)
 
         const bool wasLooping = loopLengthBeats.get() > 0 || loopLength.get() > 0;
 
-        level->dbGain       .setValue (other->level->dbGain, nullptr);
-        level->pan          .setValue (other->level->pan, nullptr);
-        level->mute         .setValue (other->level->mute, nullptr);
+        level->dbGain       .setValue (other->level->dbGain.get(), nullptr);
+        level->pan          .setValue (other->level->pan.get(), nullptr);
+        level->mute         .setValue (other->level->mute.get(), nullptr);
         channels            .setValue (other->channels, nullptr);
         fadeIn              .setValue (other->fadeIn, nullptr);
         fadeOut             .setValue (other->fadeOut, nullptr);
@@ -1235,6 +1606,10 @@ void AudioClipBase::pitchTempoTrackChanged()
     clearCachedAudioSegmentList();
     createNewProxyAsync();
 
+    // Sliced loops just need their slices moving, so there's nothing to render
+    if (playsSlicesAtTempo())
+        edit.restartPlayback();
+
     if (melodyneProxy != nullptr)
         melodyneProxy->sourceClipChanged();
 }
@@ -1886,11 +2261,18 @@ AudioNode* AudioClipBase::createFadeInOutNode (AudioNode* node)
 
 AudioNode* AudioClipBase::createNode (EditTimeRange editTime, LiveClipLevel lcl, bool includeMelodyne)
 {
+    if (! (usesTimeStretchedProxy() || isLooping()))
+        if (auto node = createUnrenderedSourceNode (editTime, lcl, getPosition().getOffset(), getSpeedRatio()))
+            return node;
+
     const AudioFile playFile (getPlaybackFile());
 
     if (playFile.isNull())
         return {};
 
+    if (playsSlicesAtTempo())
+        return createSlicedNode (playFile, editTime, lcl);
+
     if (setupARA (edit, false))
     {
         jassert (melodyneProxy != nullptr);
@@ -1937,11 +2319,63 @@ AudioNode* AudioClipBase::createNode (EditTimeRange editTime, LiveClipLevel lcl,
                                            loopRange, lcl, speed,
                                            activeChannels);
 
+    if (usesTimestretchedProxy && shouldTimeStretchInRealtime (playFile))
+        return new RealtimeTimeStretchAudioNode (*this, editTime, lcl);
+
     return new WaveAudioNode (playFile, editTime, nodeOffset,
                               loopRange, lcl, speed,
                               activeChannels);
 }
 
+AudioNode* AudioClipBase::createSlicedNode (const AudioFile& playFile, EditTimeRange editTime, LiveClipLevel lcl)
+{
+    CRASH_TRACER
+    juce::Array<SlicedAudioNode::Slice> slices;
+
+    // The auto-tempo segments are already laid out one per slice at the Edit's tempo
+    if (auto segmentList = getAudioSegmentList())
+    {
+        for (auto& segment : segmentList->getSegments())
+        {
+            auto range = segment.getRange();
+
+            if (range.overlaps (editTime))
+                slices.add ({ range, segment.getSampleRange().getStart(), segment.getSampleRange().getLength() });
+        }
+    }
+
+    return new SlicedAudioNode (playFile, std::move (slices), editTime, lcl, activeChannels);
+}
+
+bool AudioClipBase::shouldTimeStretchInRealtime (const AudioFile& proxy)
+{
+    if (! edit.engine.getEngineBehaviour().shouldTimeStretchAudioClipsInRealtime())
+        return false;
+
+    if (isUsingMelodyne() || ! getAudioFile().isValid())
+        return false;
+
+    // This is the mode the proxy would be rendered with
+    auto mode = timeStretchMode.get();
+
+    if (mode == TimeStretcher::disabled || mode == TimeStretcher::melodyne)
+        mode = TimeStretcher::defaultMode;
+
+    if (! TimeStretcher::canProcessFor (mode))
+        return false;
+
+    // Once the proxy's there, it's cheaper to play that when the CPU's getting busy
+    if (proxy.isValid())
+    {
+        auto& dm = edit.engine.getDeviceManager();
+
+        if (dm.getCpuUsage() > dm.getCpuLimitBeforeMuting() * 0.75)
+            return false;
+    }
+
+    return true;
+}
+
 LiveClipLevel AudioClipBase::getLiveClipLevel()
 {
     return { level };
@@ -1965,7 +2399,7 @@ void AudioClipBase::updateSourceFile()
 
     // check to see if our source file already exists, it may have been created by another clip
     // if it does exist, we will just use that, otherwise we need to start our own render operation
-    const AudioFile audioFile (RenderManager::getAudioFileForHash (edit.engine, edit.getTempDirectory (false), getHash()));
+    const AudioFile audioFile (getRenderedSourceFile());
 
     if (getCurrentSourceFile() != audioFile.getFile())
         setCurrentSourceFile (audioFile.getFile());
@@ -1984,6 +2418,11 @@ void AudioClipBase::updateSourceFile()
     }
 }
 
+AudioFile AudioClipBase::getRenderedSourceFile() const
+{
+    return RenderManager::getAudioFileForHash (edit.engine, edit.getTempDirectory (false), getHash());
+}
+
 void AudioClipBase::renderSource()
 {
     TRACKTION_ASSERT_MESSAGE_THREAD
@@ -2177,6 +2616,9 @@ void AudioClipBase::setUsesProxy (bool canUseProxy) noexcept
 
 bool AudioClipBase::usesTimeStretchedProxy() const
 {
+    if (playsSlicesAtTempo())
+        return false;
+
     return getAutoTempo() || getAutoPitch()
            || getPitchChange() != 0.0f
            || isUsingMelodyne()
@@ -2184,6 +2626,15 @@ bool AudioClipBase::usesTimeStretchedProxy() const
                && TimeStretcher::canProcessFor (timeStretchMode));
 }
 
+bool AudioClipBase::playsSlicesAtTempo() const
+{
+    return getAutoTempo() && ! getAutoPitch()
+            && getPitchChange() == 0.0f
+            && ! isUsingMelodyne()
+            && loopInfo.getNumLoopPoints() > 0
+            && getAudioFile().isRexFile();
+}
+
 AudioClipBase::ProxyRenderingInfo::ProxyRenderingInfo() {}
 AudioClipBase::ProxyRenderingInfo::~ProxyRenderingInfo() {}
 
@@ -2196,13 +2647,16 @@ AudioFile AudioClipBase::getProxyFileToCreate (bool renderTimestretched)
 }
 
 //==============================================================================
+/** Stretches one segment of an AudioSegmentList, starting from startTime seconds into it. */
 struct StretchSegment
 {
     StretchSegment (Engine& engine, const AudioFile& file,
                     const AudioClipBase::ProxyRenderingInfo& info,
-                    double sampleRate, const AudioSegmentList::Segment& s)
+                    double sampleRate, const AudioSegmentList::Segment& s,
+                    double startTime = 0.0)
         : segment (s),
           fileInfo (file.getInfo()),
+          readySampleOutputPos ((int64) (startTime * sampleRate)),
           crossfadeSamples ((int) (sampleRate * info.audioSegmentList->getCrossfadeLength())),
           fifo (jmax (1, fileInfo.numChannels), outputBufferSize)
     {
@@ -2212,15 +2666,16 @@ struct StretchSegment
         if (reader != nullptr)
         {
             auto sampleRange = segment.getSampleRange();
+            auto sourceOffset = (int64) (startTime * sampleRate * segment.getStretchRatio());
 
             if (segment.isFollowedBySilence())
             {
-                reader->setReadPosition (sampleRange.getStart());
+                reader->setReadPosition (sampleRange.getStart() + sourceOffset);
             }
             else
             {
                 reader->setLoopRange (sampleRange);
-                reader->setReadPosition (0);
+                reader->setReadPosition (sourceOffset);
             }
 
             timestretcher.initialise (fileInfo.sampleRate, outputBufferSize, fileInfo.numChannels,
@@ -2376,7 +2831,7 @@ struct StretchSegment
 
     const int outputBufferSize = 1024;
     int readySamplesStart = 0, readySamplesEnd = 0;
-    int64 readySampleOutputPos = 0;
+    int64 readySampleOutputPos;
     const int crossfadeSamples;
     juce::AudioBuffer<float> fifo;
 
@@ -2398,6 +2853,149 @@ std::unique_ptr<AudioClipBase::ProxyRenderingInfo> AudioClipBase::createProxyRen
     return p;
 }
 
+juce::int64 AudioClipBase::ProxyRenderingInfo::getSegmentRenderHash (const AudioFile& sourceFile,
+                                                                     const AudioSegmentList::Segment& segment) const
+{
+    // The segment's own hash doesn't cover its fades or length, or how it's stretched
+    return TemporaryFileManager::getFileContentHash (sourceFile.getFile())
+            ^ (segment.getHashCode() * 7919)
+            ^ ((int64) (segment.getRange().getLength() * 100003.0) * 31)
+            ^ ((int64) (segment.getStretchRatio() * 1000003.0) * 17)
+            ^ ((int64) (segment.getTranspose() * 10007.0) * 13)
+            ^ (segment.hasFadeIn() ? 0x1234 : 0) ^ (segment.hasFadeOut() ? 0x4321 : 0)
+            ^ ((int64) (audioSegmentList->getCrossfadeLength() * 100003.0) * 11)
+            ^ ((int64) mode * 4099)
+            ^ options.toString().hashCode64()
+            ^ ((int64) sourceFile.getSampleRate() * 3);
+}
+
+bool AudioClipBase::ProxyRenderingInfo::renderSegment (Engine& engine, const AudioFile& sourceFile,
+                                                       const AudioSegmentList::Segment& segment,
+                                                       juce::Range<int64> outputRange, int64 preRoll,
+                                                       const AudioFile& destFile, ThreadPoolJob* const& job) const
+{
+    CRASH_TRACER
+    auto sampleRate = sourceFile.getSampleRate();
+    auto range = segment.getRange();
+    auto renderStart = jmax ((int64) 0, outputRange.getStart() - preRoll);
+
+    // Rendered to a temp file first so a cancelled job doesn't leave half a segment behind
+    const AudioFile tempFile (engine, destFile.getFile().getSiblingFile ("temp_" + destFile.getFile().getFileName()));
+
+    {
+        AudioFileWriter writer (tempFile, engine.getAudioFileFormatManager().getWavFormat(),
+                                sourceFile.getNumChannels(), sampleRate, 32, {}, 0);
+
+        if (! writer.isOpen())
+            return false;
+
+        StretchSegment stretchSegment (engine, sourceFile, *this, sampleRate, segment, renderStart / sampleRate);
+
+        const int samplesPerBlock = 1024;
+        juce::AudioBuffer<float> buffer (sourceFile.getNumChannels(), samplesPerBlock);
+
+        for (auto pos = renderStart; pos < outputRange.getEnd();)
+        {
+            if (job != nullptr && job->shouldExit())
+            {
+                writer.closeForWriting();
+                tempFile.deleteFile();
+                return false;
+            }
+
+            // The pre-roll is only there to settle the stretcher, so it ends on a block boundary and isn't written
+            const bool isPreRoll = pos < outputRange.getStart();
+            auto numThisTime = (int) jmin ((int64) samplesPerBlock, (isPreRoll ? outputRange.getStart() : outputRange.getEnd()) - pos);
+            buffer.clear();
+
+            EditTimeRange editTime (range.getStart() + pos / sampleRate,
+                                    range.getStart() + (pos + numThisTime) / sampleRate);
+            stretchSegment.renderNextBlock (buffer, editTime, numThisTime);
+
+            if (! isPreRoll && ! writer.appendBuffer (buffer, numThisTime))
+                return false;
+
+            pos += numThisTime;
+        }
+    }
+
+    destFile.deleteFile();
+    return tempFile.getFile().moveFileTo (destFile.getFile());
+}
+
+bool AudioClipBase::ProxyRenderingInfo::joinChunks (Engine& engine, const AudioFile& sourceFile,
+                                                    const juce::Array<AudioFile>& chunkFiles,
+                                                    const juce::Array<juce::Range<int64>>& chunkRanges,
+                                                    int64 overlap, const AudioFile& destFile) const
+{
+    CRASH_TRACER
+    const AudioFile tempFile (engine, destFile.getFile().getSiblingFile ("temp_" + destFile.getFile().getFileName()));
+
+    {
+        AudioFileWriter writer (tempFile, engine.getAudioFileFormatManager().getWavFormat(),
+                                sourceFile.getNumChannels(), sourceFile.getSampleRate(), 32, {}, 0);
+
+        if (! writer.isOpen())
+            return false;
+
+        std::vector<std::unique_ptr<AudioFormatReader>> readers;
+
+        for (auto& f : chunkFiles)
+        {
+            readers.emplace_back (AudioFileUtils::createReaderFor (engine, f.getFile()));
+
+            if (readers.back() == nullptr)
+                return false;
+        }
+
+        const int samplesPerBlock = 8192;
+        juce::AudioBuffer<float> buffer (sourceFile.getNumChannels(), samplesPerBlock);
+        juce::AudioBuffer<float> nextBuffer (sourceFile.getNumChannels(), samplesPerBlock);
+
+        for (int i = 0; i < chunkRanges.size(); ++i)
+        {
+            auto chunkRange = chunkRanges.getReference (i);
+            const bool hasNext = i + 1 < chunkRanges.size();
+            auto fadeStart = hasNext ? chunkRanges.getReference (i + 1).getStart() : chunkRange.getEnd();
+
+            // Each chunk after the first starts with the overlap, which was mixed in with the one before
+            for (auto pos = chunkRange.getStart() + (i > 0 ? overlap : 0); pos < chunkRange.getEnd();)
+            {
+                const bool inFade = pos >= fadeStart;
+                auto numThisTime = (int) jmin ((int64) samplesPerBlock, (inFade ? chunkRange.getEnd() : fadeStart) - pos);
+
+                if (! readers[(size_t) i]->read (&buffer, 0, numThisTime, pos - chunkRange.getStart(), true, true))
+                    return false;
+
+                if (inFade)
+                {
+                    // Both chunks are the same audio over the overlap, so a linear crossfade keeps the level constant
+                    if (! readers[(size_t) i + 1]->read (&nextBuffer, 0, numThisTime, pos - fadeStart, true, true))
+                        return false;
+
+                    auto alpha1 = (pos - fadeStart) / (float) overlap;
+                    auto alpha2 = (pos + numThisTime - fadeStart) / (float) overlap;
+
+                    for (int channel = buffer.getNumChannels(); --channel >= 0;)
+                    {
+                        buffer.applyGainRamp (channel, 0, numThisTime, 1.0f - alpha1, 1.0f - alpha2);
+                        nextBuffer.applyGainRamp (channel, 0, numThisTime, alpha1, alpha2);
+                        buffer.addFrom (channel, 0, nextBuffer, channel, 0, numThisTime);
+                    }
+                }
+
+                if (! writer.appendBuffer (buffer, numThisTime))
+                    return false;
+
+                pos += numThisTime;
+            }
+        }
+    }
+
+    destFile.deleteFile();
+    return tempFile.getFile().moveFileTo (destFile.getFile());
+}
+
 bool AudioClipBase::ProxyRenderingInfo::render (Engine& engine, const AudioFile& sourceFile, AudioFileWriter& writer,
                                                 ThreadPoolJob* const& job, std::atomic<float>& progress) const
 {
@@ -2406,16 +3004,155 @@ bool AudioClipBase::ProxyRenderingInfo::render (Engine& engine, const AudioFile&
     if (audioSegmentList->getSegments().isEmpty() || ! sourceFile.isValid())
         return false;
 
-    OwnedArray<StretchSegment> segments;
-
     auto sampleRate = sourceFile.getSampleRate();
+    auto& segments = audioSegmentList->getSegments();
+    const float segmentsProportion = 0.9f;
+
+    // Each segment is stretched into its own file in the shared render cache, named after
+    // everything that affects it. Moving one warp marker then only re-stretches the
+    // segments either side of it, and segments that other clips share are only done once.
+    // The proxy is then just the segments mixed together at their positions.
+    auto getNumSegmentSamples = [sampleRate] (const AudioSegmentList::Segment& segment)
+    {
+        return (int64) (segment.getRange().getLength() * sampleRate + 0.5);
+    };
+
+    auto createSegmentReader = [&] (const AudioFile& segmentFile, int64 numSamples) -> std::unique_ptr<AudioFormatReader>
+    {
+        std::unique_ptr<AudioFormatReader> reader (AudioFileUtils::createReaderFor (engine, segmentFile.getFile()));
+
+        if (reader == nullptr || reader->lengthInSamples < numSamples
+             || (int) reader->numChannels != sourceFile.getNumChannels())
+            return {};
+
+        return reader;
+    };
+
+    //==============================================================================
+    // Segments that aren't in the cache are rendered on a pool of threads. Long ones are
+    // split into chunks that each start a little early so their stretcher has settled,
+    // and overlap the next chunk so they can be crossfaded back together.
+    struct ChunkedSegment
+    {
+        int segmentIndex;
+        AudioFile segmentFile;
+        juce::Array<AudioFile> chunkFiles;
+        juce::Array<juce::Range<int64>> chunkRanges;
+    };
+
+    struct Chunk
+    {
+        int segmentIndex;
+        juce::Range<int64> range;
+        AudioFile file;
+    };
+
+    const auto chunkLength = (int64) (30.0 * sampleRate);
+    const auto chunkOverlap = (int64) (0.05 * sampleRate);
+    const auto chunkPreRoll = (int64) (1.0 * sampleRate);
+
+    std::vector<ChunkedSegment> chunkedSegments;
+    std::vector<Chunk> chunks;
+    juce::Array<AudioFile> segmentFiles;
+
+    for (int i = 0; i < segments.size(); ++i)
+    {
+        auto& segment = segments.getReference (i);
+        auto segmentFile = TemporaryFileManager::getFileForCachedSegmentRender (engine, getSegmentRenderHash (sourceFile, segment));
+        auto numSamples = getNumSegmentSamples (segment);
+        segmentFiles.add (segmentFile);
 
-    for (auto& segment : audioSegmentList->getSegments())
-        segments.add (new StretchSegment (engine, sourceFile, *this, sampleRate, segment));
+        if (createSegmentReader (segmentFile, numSamples) != nullptr)
+            continue;
 
+        if (numSamples <= chunkLength + chunkOverlap)
+        {
+            chunks.push_back ({ i, { 0, numSamples }, segmentFile });
+            continue;
+        }
+
+        ChunkedSegment chunked { i, segmentFile, {}, {} };
+
+        for (int64 start = 0; start < numSamples; start += chunkLength)
+        {
+            juce::Range<int64> range (start, jmin (numSamples, start + chunkLength + chunkOverlap));
+            auto chunkFile = segmentFile.getFile().getSiblingFile ("temp_" + segmentFile.getFile().getFileNameWithoutExtension()
+                                                                   + "_" + String (chunked.chunkFiles.size()) + ".wav");
+            chunked.chunkFiles.add (AudioFile (engine, chunkFile));
+            chunked.chunkRanges.add (range);
+            chunks.push_back ({ i, range, chunked.chunkFiles.getLast() });
+
+            if (range.getEnd() == numSamples)
+                break;
+        }
+
+        chunkedSegments.push_back (std::move (chunked));
+    }
+
+    if (! chunks.empty())
+    {
+        std::atomic<int> numFinished { 0 };
+        std::atomic<bool> anyFailed { false };
+
+        {
+            ThreadPool pool (jlimit (1, (int) chunks.size(), SystemStats::getNumCpus() - 1));
+
+            for (auto& chunk : chunks)
+            {
+                pool.addJob ([&, chunk]
+                             {
+                                 if (! anyFailed
+                                      && ! renderSegment (engine, sourceFile, segments.getReference (chunk.segmentIndex),
+                                                          chunk.range, chunk.range.getStart() > 0 ? chunkPreRoll : 0,
+                                                          chunk.file, job))
+                                     anyFailed = true;
+
+                                 ++numFinished;
+                             });
+            }
+
+            while (numFinished < (int) chunks.size())
+            {
+                if (job != nullptr && job->shouldExit())
+                    anyFailed = true;
+
+                progress = segmentsProportion * numFinished / (float) chunks.size();
+                Thread::sleep (10);
+            }
+        }
+
+        bool ok = ! anyFailed;
+
+        for (auto& chunked : chunkedSegments)
+        {
+            ok = ok && joinChunks (engine, sourceFile, chunked.chunkFiles, chunked.chunkRanges, chunkOverlap, chunked.segmentFile);
+
+            for (auto& f : chunked.chunkFiles)
+                f.deleteFile();
+        }
+
+        if (! ok)
+            return false;
+    }
+
+    std::vector<std::unique_ptr<AudioFormatReader>> segmentReaders;
+
+    for (int i = 0; i < segments.size(); ++i)
+    {
+        auto reader = createSegmentReader (segmentFiles.getReference (i), getNumSegmentSamples (segments.getReference (i)));
+
+        if (reader == nullptr)
+            return false;
+
+        segmentReaders.push_back (std::move (reader));
+    }
+
+    progress = segmentsProportion;
+
+    //==============================================================================
     const int samplesPerBlock = 1024;
     juce::AudioBuffer<float> buffer (sourceFile.getNumChannels(), samplesPerBlock);
-    double time = 0.0;
+    juce::AudioBuffer<float> segmentBuffer (sourceFile.getNumChannels(), samplesPerBlock);
 
     auto numBlocks = 1 + (int) (clipTime.getLength() * sampleRate / samplesPerBlock);
 
@@ -2426,17 +3163,34 @@ bool AudioClipBase::ProxyRenderingInfo::render (Engine& engine, const AudioFile&
 
         buffer.clear();
 
-        auto endTime = time + samplesPerBlock / sampleRate;
-        EditTimeRange editTime (time, endTime);
-        time = endTime;
+        auto blockStart = (int64) i * samplesPerBlock;
+        auto blockEnd = blockStart + samplesPerBlock;
+
+        for (int j = 0; j < segments.size(); ++j)
+        {
+            auto& segment = segments.getReference (j);
+            auto segmentStart = (int64) (segment.getRange().getStart() * sampleRate + 0.5);
+            auto segmentEnd = segmentStart + getNumSegmentSamples (segment);
 
-        for (auto s : segments)
-            s->renderNextBlock (buffer, editTime, samplesPerBlock);
+            auto start = jmax (blockStart, segmentStart);
+            auto end = jmin (blockEnd, segmentEnd);
+
+            if (end <= start)
+                continue;
+
+            auto numThisTime = (int) (end - start);
+
+            if (! segmentReaders[(size_t) j]->read (&segmentBuffer, 0, numThisTime, start - segmentStart, true, true))
+                return false;
+
+            for (int channel = buffer.getNumChannels(); --channel >= 0;)
+                buffer.addFrom (channel, (int) (start - blockStart), segmentBuffer, channel, 0, numThisTime);
+        }
 
         if (! writer.appendBuffer (buffer, samplesPerBlock))
             return false;
 
-        progress = i / (float) numBlocks;
+        progress = segmentsProportion + (1.0f - segmentsProportion) * i / (float) numBlocks;
     }
 
     return true;
@@ -104,6 +104,11 @@ public:
     /** Subclasses should override this to return true if they need the rest of the render callbacks. */
     virtual bool needsRender() const                    { return false; }
 
+    /** Returns the file the source gets rendered to when needsRender() is true.
+        By default this is in the Edit's temp folder, named after getHash().
+    */
+    virtual AudioFile getRenderedSourceFile() const;
+
     /** Subclasses should override this to return a RenderJob suitable for rendering
         its source file. Note that because we can only render one source this should
         also check to see if the source should be reversed and do so accordingly.
@@ -133,14 +138,14 @@ public:
 
     //==============================================================================
     void setGainDB (float dB);
-    float getGainDB() const noexcept                    { return level->dbGain; }
-    float getGain() const noexcept                      { return dbToGain (level->dbGain); }
+    float getGainDB() const noexcept                    { return level->dbGain.get(); }
+    float getGain() const noexcept                      { return dbToGain (level->dbGain.get()); }
 
     void setPan (float pan);
-    float getPan() const noexcept                       { return level->pan; }
+    float getPan() const noexcept                       { return level->pan.get(); }
 
     void setMuted (bool shouldBeMuted) override         { level->mute = shouldBeMuted; }
-    bool isMuted() const override                       { return level->mute; }
+    bool isMuted() const override                       { return level->mute.get(); }
 
     LiveClipLevel getLiveClipLevel();
 
@@ -315,6 +320,14 @@ public:
         bool render (Engine&, const AudioFile&, AudioFileWriter&, juce::ThreadPoolJob* const&, std::atomic<float>& progress) const;
 
     private:
+        juce::int64 getSegmentRenderHash (const AudioFile&, const AudioSegmentList::Segment&) const;
+        bool renderSegment (Engine&, const AudioFile&, const AudioSegmentList::Segment&,
+                            juce::Range<juce::int64> outputRange, juce::int64 preRoll,
+                            const AudioFile& destFile, juce::ThreadPoolJob* const&) const;
+        bool joinChunks (Engine&, const AudioFile&, const juce::Array<AudioFile>& chunkFiles,
+                         const juce::Array<juce::Range<juce::int64>>& chunkRanges,
+                         juce::int64 overlap, const AudioFile& destFile) const;
+
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ProxyRenderingInfo)
     };
 
@@ -325,6 +338,11 @@ public:
     void setUsesProxy (bool canUseProxy) noexcept;
     bool canUseProxy() const noexcept               { return proxyAllowed && edit.canRenderProxies(); }
     bool usesTimeStretchedProxy() const;
+
+    /** Returns true if this is a sliced loop, e.g. a REX file, that's played by triggering its
+        slices at the Edit's tempo rather than from a timestretched proxy.
+    */
+    bool playsSlicesAtTempo() const;
     std::unique_ptr<ProxyRenderingInfo> createProxyRenderingInfo();
 
     juce::int64 getProxyHash();
@@ -400,6 +418,14 @@ protected:
     */
     void createNewProxyAsync();
 
+    /** Subclasses can override this to play something other than their source file, e.g. a comp
+        that's played straight from its takes before it's been rendered.
+        This is only called when the clip isn't looping or being timestretched.
+        @returns a node to play in place of the source file, or nullptr to play the file as usual
+    */
+    virtual AudioNode* createUnrenderedSourceNode (EditTimeRange /*editTime*/, LiveClipLevel,
+                                                   double /*offset*/, double /*speed*/)         { return {}; }
+
     void valueTreePropertyChanged (juce::ValueTree&, const juce::Identifier&) override;
     void valueTreeChildAdded (juce::ValueTree& parent, juce::ValueTree&) override;
     void valueTreeChildRemoved (juce::ValueTree& parent, juce::ValueTree&, int) override;
@@ -409,6 +435,7 @@ protected:
 private:
     //==============================================================================
     class TimestretchingPreviewAudioNode;
+    class RealtimeTimeStretchAudioNode;
     class TempoDetectTask;
     class BeatSensitivityComp;
 
@@ -446,6 +473,8 @@ private:
     bool setupARA (Edit&, bool dontPopupErrorMessages);
 
     AudioNode* createNode (EditTimeRange editTime, LiveClipLevel, bool includeMelodyne);
+    AudioNode* createSlicedNode (const AudioFile&, EditTimeRange editTime, LiveClipLevel);
+    bool shouldTimeStretchInRealtime (const AudioFile& proxy);
 
     AudioNode* createFadeInOutNode (AudioNode*);
 
@@ -306,7 +306,8 @@ juce::int64 ClipEffect::getHash() const
 {
     auto parent = state.getParent();
     auto index = parent.indexOf (state);
-    juce::int64 hash = index ^ (juce::int64) clipEffects.clip.itemID.getRawID();
+    // Use the source rather than the clip so the same effects on the same file can share a render
+    juce::int64 hash = index ^ TemporaryFileManager::getFileContentHash (clipEffects.clip.getOriginalFile());
 
     for (int i = 0; i <= index; ++i)
         if (auto ce = clipEffects.getClipEffect (parent.getChild (i)))
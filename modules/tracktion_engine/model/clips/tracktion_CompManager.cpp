@@ -626,6 +626,51 @@ struct WaveCompManager::CompRenderContext
     {
     }
 
+    /** One part of a take that's used in the comp, in the comp's source time. */
+    struct Section
+    {
+        ProjectItemID takeID;
+        EditTimeRange time, fadeIn, fadeOut;
+    };
+
+    juce::Array<Section> getSections() const
+    {
+        juce::Array<Section> sections;
+        auto halfCrossfade = crossfadeLength / 2.0;
+        auto numSegments = takeTree.getNumChildren();
+        auto timeRatio = sourceTimeMultiplier;
+        auto compOffset = offset / timeRatio;
+        double startTime = 0.0;
+
+        for (int i = 0; i < numSegments; ++i)
+        {
+            auto compSegment = takeTree.getChild (i);
+            auto takeIndex = (int) compSegment.getProperty (IDs::takeIndex);
+            auto endTime = double (compSegment.getProperty (IDs::endTime)) / timeRatio;
+
+            if (isPositiveAndBelow (takeIndex, takesIDs.size()))
+            {
+                Section section;
+                section.takeID = takesIDs[takeIndex];
+                jassert (section.takeID.isValid());
+
+                section.time = EditTimeRange (startTime, endTime).expanded (halfCrossfade) + compOffset;
+
+                if (i != 0)
+                    section.fadeIn = { section.time.getStart(), section.time.getStart() + crossfadeLength };
+
+                if (i != (numSegments - 1))
+                    section.fadeOut = { section.time.getEnd() - crossfadeLength, section.time.getEnd() };
+
+                sections.add (section);
+            }
+
+            startTime = endTime;
+        }
+
+        return sections;
+    }
+
     Engine& engine;
     juce::Array<ProjectItemID> takesIDs;
     const juce::ValueTree takeTree;
@@ -810,12 +855,20 @@ void WaveCompManager::triggerCompRender()
     if (isTakeComp (getActiveTakeIndex()))
     {
         keepSectionsSortedAndInRange();
+        renderIsDeferred = false;
         startTimer (compGeneratorDelay);
     }
 }
 
 void WaveCompManager::flattenTake (int takeIndex, bool deleteSourceFiles)
 {
+    // The comp might not have been rendered yet if it's been playing from its takes
+    if (renderIsDeferred)
+    {
+        stopTimer();
+        updateCompFile (true);
+    }
+
     if (getRenderProgress() < 1.0f || ! lastCompFile.isValid())
     {
         if (flattenRetrier == nullptr)
@@ -839,13 +892,18 @@ void WaveCompManager::flattenTake (int takeIndex, bool deleteSourceFiles)
             jassert (destCompFile.getParentDirectory().hasWriteAccess());
             clip.edit.engine.getAudioFileManager().releaseFile (lastCompFile);
 
-            if (lastCompFile.getFile().moveFileTo (destCompFile))
+            // Renders in the shared cache might be used by other Edits so can't be moved
+            const bool isShared = lastCompFile.getFile().isAChildOf (clip.edit.engine.getTemporaryFileManager().getSharedRenderCacheFolder());
+
+            if (! isShared && lastCompFile.getFile().moveFileTo (destCompFile))
             {
                 item->setSourceFile (destCompFile);
             }
             else if (lastCompFile.getFile().copyFileTo (destCompFile))
             {
-                lastCompFile.deleteFile();
+                if (! isShared)
+                    lastCompFile.deleteFile();
+
                 item->setSourceFile (destCompFile);
             }
             else
@@ -1004,48 +1062,20 @@ bool WaveCompManager::renderTake (CompRenderContext& context, AudioFileWriter& w
     CombiningAudioNode compNode;
     const int blockSize = 32768;
     EditTimeRange takeRange (0.0, context.maxLength);
-    auto crossfadeLength = context.crossfadeLength;
-    auto halfCrossfade = crossfadeLength / 2.0;
 
-    auto numSegments = context.takeTree.getNumChildren();
-    auto timeRatio = context.sourceTimeMultiplier;
-    auto offset = context.offset / timeRatio;
-    double startTime = 0.0;
-
-    for (int i = 0; i < numSegments; ++i)
+    for (auto& section : context.getSections())
     {
         if (job.shouldExit())
             return false;
 
-        auto compSegment = context.takeTree.getChild (i);
-        auto takeIndex = (int) compSegment.getProperty (IDs::takeIndex);
-        auto endTime = double (compSegment.getProperty (IDs::endTime)) / timeRatio;
-
-        if (isPositiveAndBelow (takeIndex, context.takesIDs.size()))
-        {
-            const ProjectItemID takeID (context.takesIDs[takeIndex]);
-            jassert (takeID.isValid());
-
-            const AudioFile takeFile (context.engine, context.engine.getProjectManager().findSourceFile (takeID));
-            AudioNode* node = new WaveAudioNode (takeFile, takeRange, 0.0, {}, {},
-                                                 1.0, AudioChannelSet::stereo());
-
-            auto segmentTimes = EditTimeRange (startTime, endTime).expanded (halfCrossfade) + offset;
-            EditTimeRange fadeIn, fadeOut;
+        const AudioFile takeFile (context.engine, context.engine.getProjectManager().findSourceFile (section.takeID));
+        AudioNode* node = new WaveAudioNode (takeFile, takeRange, 0.0, {}, {},
+                                             1.0, AudioChannelSet::stereo());
 
-            if (i != 0)
-                fadeIn = { segmentTimes.getStart(), segmentTimes.getStart() + crossfadeLength };
+        if (! (section.fadeIn.isEmpty() && section.fadeOut.isEmpty()))
+            node = new FadeInOutAudioNode (node, section.fadeIn, section.fadeOut, AudioFadeCurve::convex, AudioFadeCurve::convex);
 
-            if (i != (numSegments - 1))
-                fadeOut = { segmentTimes.getEnd() - crossfadeLength, segmentTimes.getEnd() };
-
-            if (! (fadeIn.isEmpty() && fadeOut.isEmpty()))
-                node = new FadeInOutAudioNode (node, fadeIn, fadeOut, AudioFadeCurve::convex, AudioFadeCurve::convex);
-
-            compNode.addInput ({ jmax (0.0, segmentTimes.getStart()), jmin (segmentTimes.getEnd(), context.maxLength) }, node);
-        }
-
-        startTime = endTime;
+        compNode.addInput ({ jmax (0.0, section.time.getStart()), jmin (section.time.getEnd(), context.maxLength) }, node);
     }
 
     if (job.shouldExit())
@@ -1133,6 +1163,45 @@ bool WaveCompManager::renderTake (CompRenderContext& context, AudioFileWriter& w
     return true;
 }
 
+AudioNode* WaveCompManager::createCompAudioNode (EditTimeRange editTime, LiveClipLevel lcl, double offset, double speed) const
+{
+    CRASH_TRACER
+    std::unique_ptr<CompRenderContext> context (createRenderContext());
+    auto& engine = clip.edit.engine;
+    auto clipStart = clip.getPosition().getStart();
+
+    // Maps the comp's source time to the Edit in the same way the rendered comp would be played
+    auto toEditTime = [clipStart, offset, speed] (EditTimeRange t)
+    {
+        return t.rescaled (0.0, 1.0 / speed) + (clipStart - offset);
+    };
+
+    auto compNode = new CombiningAudioNode();
+
+    for (auto& section : context->getSections())
+    {
+        auto sectionTime = toEditTime (section.time.getIntersectionWith ({ 0.0, context->maxLength }))
+                             .getIntersectionWith (editTime);
+
+        if (sectionTime.isEmpty())
+            continue;
+
+        const AudioFile takeFile (engine, engine.getProjectManager().findSourceFile (section.takeID));
+        AudioNode* node = new WaveAudioNode (takeFile, sectionTime, offset + (sectionTime.getStart() - clipStart),
+                                             {}, lcl, speed, clip.activeChannels);
+
+        if (! (section.fadeIn.isEmpty() && section.fadeOut.isEmpty()))
+            node = new FadeInOutAudioNode (node,
+                                           section.fadeIn.isEmpty() ? EditTimeRange() : toEditTime (section.fadeIn),
+                                           section.fadeOut.isEmpty() ? EditTimeRange() : toEditTime (section.fadeOut),
+                                           AudioFadeCurve::convex, AudioFadeCurve::convex);
+
+        compNode->addInput (sectionTime, node);
+    }
+
+    return compNode;
+}
+
 //==============================================================================
 class CompGeneratorJob  : public AudioProxyGenerator::GeneratorJob
 {
@@ -1223,6 +1292,12 @@ static void beginCompGeneration (WaveAudioClip& clip, int takeIndex)
 void WaveCompManager::timerCallback()
 {
     stopTimer();
+    updateCompFile (renderIsDeferred);
+}
+
+void WaveCompManager::updateCompFile (bool renderNow)
+{
+    renderIsDeferred = false;
 
     if (! clip.hasAnyTakes())
     {
@@ -1233,24 +1308,32 @@ void WaveCompManager::timerCallback()
     auto takeIndex = getActiveTakeIndex();
     auto hash = getTakeHash (takeIndex);
 
-    if (isTakeComp (lastRenderedTake) && hash != lastHash)
-    {
-        // stops the last render job and deletes the source
-        clip.edit.engine.getAudioFileManager().proxyGenerator
-           .deleteProxy (TemporaryFileManager::getFileForCachedCompRender (clip, lastHash));
-    }
+    const bool lastCompChanged = isTakeComp (lastRenderedTake) && hash != lastHash;
+    auto oldCompFile = TemporaryFileManager::getFileForCachedCompRender (clip, lastHash);
 
     lastRenderedTake = takeIndex;
     lastHash = hash;
 
+    // stops the last render job and deletes the source, unless another Edit is sharing it
+    if (lastCompChanged && ! clip.edit.engine.getTemporaryFileManager().isFileInUseByAnyEdit (oldCompFile))
+        clip.edit.engine.getAudioFileManager().proxyGenerator.deleteProxy (oldCompFile);
+
     lastCompFile = TemporaryFileManager::getFileForCachedCompRender (clip, lastHash);
     const bool isComp = isTakeComp (lastRenderedTake);
 
     if (isComp && (! lastCompFile.isValid()))
     {
-        auto takeTree = takesTree.getChild (lastRenderedTake);
-        beginCompGeneration (clip, lastRenderedTake);
-        compUpdater->setCompFile (lastCompFile);
+        if (! renderNow && clip.canPlayCompFromTakes())
+        {
+            // It can be heard straight from the takes, so only render it once it's stopped changing
+            renderIsDeferred = true;
+            startTimer (deferredCompGeneratorDelay);
+        }
+        else
+        {
+            beginCompGeneration (clip, lastRenderedTake);
+            compUpdater->setCompFile (lastCompFile);
+        }
     }
     else if (! isComp)
     {
@@ -286,12 +286,19 @@ public:
     static bool renderTake (CompRenderContext&, AudioFileWriter&,
                             juce::ThreadPoolJob&, std::atomic<float>& progress);
 
+    /** Creates a node that plays the current comp straight from its takes, crossfading
+        between them in the same way as the render would.
+        The offset and speed are used in the same way as for a WaveAudioNode playing the comp file.
+    */
+    AudioNode* createCompAudioNode (EditTimeRange editTime, LiveClipLevel, double offset, double speed) const;
+
 private:
-    enum { compGeneratorDelay = 500 };
+    enum { compGeneratorDelay = 500, deferredCompGeneratorDelay = 10000 };
 
     WaveAudioClip& clip;
     AudioFile lastCompFile;
     juce::String warning;
+    bool renderIsDeferred = false;
 
     //==============================================================================
     struct FlattenRetrier;
@@ -307,6 +314,7 @@ private:
     ProjectItem::Ptr getOrCreateProjectItemForTake (juce::ValueTree& takeTree);
 
     void timerCallback() override;
+    void updateCompFile (bool renderNow);
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (WaveCompManager)
 };
@@ -24,6 +24,7 @@ EditClip::EditClip (const juce::ValueTree& v, EditItemID clipID, ClipTrack& targ
     copyColourFromMarker.referTo (state, IDs::copyColour, um, false);
     trimToMarker.referTo (state, IDs::trimToMarker, um, false);
     renderEnabled.referTo (state, IDs::renderEnabled, um, true);
+    playLive.referTo (state, IDs::playLive, um, false);
 }
 
 EditClip::~EditClip()
@@ -65,6 +66,7 @@ void EditClip::cloneFrom (Clip* c)
         copyColourFromMarker .setValue (other->copyColourFromMarker, nullptr);
         trimToMarker         .setValue (other->trimToMarker, nullptr);
         renderEnabled        .setValue (other->renderEnabled, nullptr);
+        playLive             .setValue (other->playLive, nullptr);
     }
 }
 
@@ -92,12 +94,27 @@ void EditClip::setLoopDefaults()
 //==============================================================================
 bool EditClip::needsRender() const
 {
-    if (! renderEnabled || editSnapshot == nullptr)
+    if (! renderEnabled || editSnapshot == nullptr || isPlayingLive())
         return false;
 
     return editSnapshot->getLength() > 0.0;
 }
 
+AudioFile EditClip::getRenderedSourceFile() const
+{
+    // The hash only uses the Edits' save times, so add the Edits themselves to make
+    // it independent of this clip. Any other clips rendering the same thing can then share it
+    auto sharedHash = hash;
+
+    for (auto snapshot : referencedEdits)
+    {
+        auto id = snapshot->getID();
+        sharedHash ^= ((juce::int64) id.getProjectID() * 7919 + id.getItemID()) * 31;
+    }
+
+    return TemporaryFileManager::getFileForCachedEditRender (edit.engine, sharedHash);
+}
+
 RenderManager::Job::Ptr EditClip::getRenderJob (const AudioFile& destFile)
 {
     TRACKTION_ASSERT_MESSAGE_THREAD
@@ -180,6 +197,7 @@ void EditClip::sourceMediaChanged()
 
     lastSourceId = newID;
     editSnapshot = EditSnapshot::getEditSnapshot (edit.engine, newID);
+    releaseLiveEdit();
     const bool invalidSource = editSnapshot == nullptr || ! editSnapshot->isValid();
 
     if (invalidSource)
@@ -224,9 +242,7 @@ bool EditClip::isUsingFile (const AudioFile& af)
     if (AudioClipBase::isUsingFile (af))
         return true;
 
-    auto audioFile = RenderManager::getAudioFileForHash (edit.engine, edit.getTempDirectory (false), getHash());
-
-    if (audioFile == af)
+    if (getRenderedSourceFile() == af)
         return true;
 
     return false;
@@ -247,6 +263,23 @@ void EditClip::valueTreePropertyChanged (ValueTree& v, const juce::Identifier& i
         else
             cancelCurrentRender();
     }
+    else if (v == state && i == IDs::playLive)
+    {
+        TRACKTION_ASSERT_MESSAGE_THREAD
+        playLive.forceUpdateOfCachedValue();
+
+        if (! playLive)
+            releaseLiveEdit();
+
+        changed();
+
+        if (isPlayingLive())
+            cancelCurrentRender();
+        else if (renderEnabled)
+            updateSourceFile();
+
+        edit.restartPlayback();
+    }
     else
     {
         AudioClipBase::valueTreePropertyChanged (v, i);
@@ -433,6 +466,166 @@ void EditClip::editChanged (EditSnapshot&)
     // If any of the Edit's we are referencing have changed we need to re-check them all
     updateReferencedEdits();
     generateHash();
+
+    // The live Edit is loaded from the saved version so needs reloading
+    if (liveEdit != nullptr)
+    {
+        releaseLiveEdit();
+        edit.restartPlayback();
+    }
 }
 
+//==============================================================================
+/** Plays a nested Edit's playback graph, using a playhead of its own that's kept
+    in line with the clip.
+*/
+class EditClip::LiveEditAudioNode  : public AudioNode
+{
+public:
+    LiveEditAudioNode (std::shared_ptr<Edit> e, AudioNode* n,
+                       EditTimeRange editTime, double timeOffset, LiveClipLevel lcl)
+        : nestedEdit (std::move (e)), input (n),
+          editPosition (editTime), offset (timeOffset), level (std::move (lcl))
+    {
+        input->purgeSubNodes (true, false);
+    }
+
+    ~LiveEditAudioNode() override
+    {
+        // The nodes have to go before the Edit they belong to
+        input = nullptr;
+    }
+
+    //==============================================================================
+    void getAudioNodeProperties (AudioNodeProperties& info) override
+    {
+        input->getAudioNodeProperties (info);
+        info.hasMidi = false;
+    }
+
+    // The nested Edit's nodes belong to a different playhead so they're kept out of the main graph
+    void visitNodes (const VisitorFn& v) override                   { v (*this); }
+    bool purgeSubNodes (bool keepAudio, bool) override              { return keepAudio; }
+
+    void prepareAudioNodeToPlay (const PlaybackInitialisationInfo& info) override
+    {
+        juce::Array<AudioNode*> allNodes;
+        allNodes.add (input.get());
+
+        nestedPlayhead.playLockedToEngine ({ 0.0, Edit::maximumLength });
+
+        PlaybackInitialisationInfo nestedInfo =
+        {
+            info.startTime + (offset - editPosition.getStart()),
+            info.sampleRate,
+            info.blockSizeSamples,
+            &allNodes,
+            nestedPlayhead
+        };
+
+        input->prepareAudioNodeToPlay (nestedInfo);
+    }
+
+    bool isReadyToRender() override                                 { return input->isReadyToRender(); }
+    void releaseAudioNodeResources() override                       { input->releaseAudioNodeResources(); }
+
+    void renderOver (const AudioRenderContext& rc) override
+    {
+        rc.clearAudioBuffer();
+        invokeSplitRender (rc, *this);
+    }
+
+    void renderAdding (const AudioRenderContext& rc) override
+    {
+        invokeSplitRender (rc, *this);
+    }
+
+    void renderSection (const AudioRenderContext& rc, EditTimeRange editTime)
+    {
+        auto clipTime = editTime.getIntersectionWith (editPosition);
+
+        if (rc.destBuffer == nullptr || rc.bufferNumSamples <= 0 || clipTime.isEmpty())
+            return;
+
+        auto samplesPerSecond = rc.bufferNumSamples / editTime.getLength();
+        auto startSample = jlimit (0, rc.bufferNumSamples, roundToInt ((clipTime.getStart() - editTime.getStart()) * samplesPerSecond));
+        auto endSample   = jlimit (0, rc.bufferNumSamples, roundToInt ((clipTime.getEnd() - editTime.getStart()) * samplesPerSecond));
+        auto numSamples = endSample - startSample;
+
+        if (numSamples <= 0)
+            return;
+
+        const int numChannels = rc.destBuffer->getNumChannels();
+        AudioScratchBuffer scratch (numChannels, numSamples);
+
+        // The nested playhead maps stream time straight to the nested Edit's time
+        AudioRenderContext nestedContext (nestedPlayhead, clipTime + (offset - editPosition.getStart()),
+                                          &scratch.buffer, rc.destBufferChannels, 0, numSamples,
+                                          nullptr, 0.0, rc.continuity, rc.isRendering);
+
+        input->prepareForNextBlock (nestedContext);
+        input->renderOver (nestedContext);
+
+        float gains[2];
+        level.getLeftAndRightGains (gains[0], gains[1]);
+
+        for (int i = 0; i < numChannels; ++i)
+            rc.destBuffer->addFrom (i, rc.bufferStartSample + startSample, scratch.buffer, i, 0, numSamples,
+                                    numChannels == 2 ? gains[i] : level.getGainIncludingMute());
+    }
+
+private:
+    std::shared_ptr<Edit> nestedEdit;
+    std::unique_ptr<AudioNode> input;
+    PlayHead nestedPlayhead;
+    const EditTimeRange editPosition;
+    const double offset;
+    LiveClipLevel level;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LiveEditAudioNode)
+};
+
+bool EditClip::isPlayingLive() const
+{
+    return playLive
+        && ! (getIsReversed() || isLooping() || usesTimeStretchedProxy()
+               || std::abs (getSpeedRatio() - 1.0) > 0.00001);
+}
+
+AudioNode* EditClip::createUnrenderedSourceNode (EditTimeRange editTime, LiveClipLevel lcl, double offset, double)
+{
+    if (! isPlayingLive() || editSnapshot == nullptr || ! editSnapshot->isValid())
+        return {};
+
+    CRASH_TRACER
+
+    if (liveEdit == nullptr)
+    {
+        auto editState = loadEditFromProjectManager (edit.engine.getProjectManager(),
+                                                     sourceFileReference.getSourceProjectItemID());
+
+        if (! editState.isValid())
+            return {};
+
+        liveEdit = std::make_shared<Edit> (edit.engine, editState, Edit::forRendering, nullptr, 1); // always use saved version!
+        liveEdit->initialiseAllPlugins();
+    }
+
+    auto params = renderOptions->getRenderParameters (*liveEdit);
+    params.edit = liveEdit.get();
+    params.tracksToDo = renderOptions->getTrackIndexes (*liveEdit);
+
+    if (auto node = Renderer::createRenderingAudioNode (params))
+        return new LiveEditAudioNode (liveEdit, node, editTime, offset, lcl);
+
+    return {};
+}
+
+void EditClip::releaseLiveEdit()
+{
+    // Any nodes still playing it will hold on to it until they're deleted
+    liveEdit = nullptr;
+}
+
+
 }
@@ -58,6 +58,7 @@ public:
 
     //==============================================================================
     bool needsRender() const override;
+    AudioFile getRenderedSourceFile() const override;
     RenderManager::Job::Ptr getRenderJob (const AudioFile& destFile) override;
     void renderComplete() override;
     juce::String getRenderMessage() override;
@@ -78,8 +79,19 @@ public:
 
     juce::CachedValue<bool> copyColourFromMarker, trimToMarker, renderEnabled;
 
+    /** If this is set, the nested Edit is played live as part of the playback graph instead of
+        being rendered first, which saves waiting for renders whilst you're working on it.
+        This only happens when the clip isn't reversed, looped or timestretched, otherwise it's
+        rendered as usual.
+    */
+    juce::CachedValue<bool> playLive;
+
+    /** Returns true if playLive is set and the nested Edit can be played live. */
+    bool isPlayingLive() const;
+
 protected:
     void valueTreePropertyChanged (juce::ValueTree&, const juce::Identifier&) override;
+    AudioNode* createUnrenderedSourceNode (EditTimeRange, LiveClipLevel, double offset, double speed) override;
 
 private:
     //==============================================================================
@@ -95,6 +107,10 @@ private:
     std::unique_ptr<RenderOptions> renderOptions;
     bool sourceMediaReEntrancyCheck = false;
 
+    class LiveEditAudioNode;
+    std::shared_ptr<Edit> liveEdit;
+    void releaseLiveEdit();
+
     //==============================================================================
     void updateWaveInfo();
     void updateReferencedEdits();
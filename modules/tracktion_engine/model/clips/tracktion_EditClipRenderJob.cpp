@@ -172,6 +172,9 @@ EditRenderJob::RenderPass::RenderPass (EditRenderJob& j, Renderer::Parameters& r
 {
     r.category = ProjectItem::Category::none;
     r.destFile = tempFile.getFile();
+
+    for (auto& stem : r.stems)
+        stem.destFile = stemTempFiles.add (new TemporaryFile (stem.destFile, TemporaryFile::useHiddenFile))->getFile();
 }
 
 EditRenderJob::RenderPass::~RenderPass()
@@ -184,18 +187,28 @@ EditRenderJob::RenderPass::~RenderPass()
     if (owner.editDeleter.willDeleteObject())
         callBlocking ([this] { Renderer::turnOffAllPlugins (*r.edit); });
 
+    r.category = originalCategory;
+
+    if (stemTempFiles.isEmpty())
+        finishFile (tempFile, errorMessage, completedOk);
+    else
+        for (auto f : stemTempFiles)
+            finishFile (*f, errorMessage, completedOk);
+}
+
+void EditRenderJob::RenderPass::finishFile (TemporaryFile& temp, const String& errorMessage, bool completedOk)
+{
     // overwite with temp file
     if (! errorMessage.isEmpty() && owner.silenceOnBackup)
-        owner.generateSilence (tempFile.getFile());
+        owner.generateSilence (temp.getFile());
 
-    if (tempFile.getFile().existsAsFile() && (completedOk || owner.silenceOnBackup))
-        tempFile.overwriteTargetFileWithTemporary();
+    if (temp.getFile().existsAsFile() && (completedOk || owner.silenceOnBackup))
+        temp.overwriteTargetFileWithTemporary();
     else
-        tempFile.getTargetFile().deleteFile();
+        temp.getTargetFile().deleteFile();
 
     // swap this back to the original
-    r.destFile = tempFile.getTargetFile();
-    r.category = originalCategory;
+    r.destFile = temp.getTargetFile();
 
     // reverse if needed
     if (owner.reverse)
@@ -279,24 +292,20 @@ bool EditRenderJob::RenderPass::initialise()
                   });
 
     if (r.tracksToDo.countNumberOfSetBits() > 0
-        && r.destFile.hasWriteAccess()
-        && ! r.destFile.isDirectory())
+        && (! r.stems.isEmpty() || (r.destFile.hasWriteAccess() && ! r.destFile.isDirectory())))
     {
         AudioNode* node = nullptr;
+        bool renderMidiFromClips = false;
 
-        CreateAudioNodeParams cnp;
-        cnp.allowedClips = r.allowedClips.isEmpty() ? nullptr : &r.allowedClips;
-        cnp.allowedTracks = &r.tracksToDo;
-        cnp.forRendering = true;
-        cnp.includePlugins = r.usePlugins;
-        cnp.addAntiDenormalisationNoise = r.addAntiDenormalisationNoise;
-
-        callBlocking ([this, &node, &cnp]
+        callBlocking ([this, &node, &renderMidiFromClips]
         {
-            node = createRenderingNodeFromEdit (*r.edit, cnp, r.useMasterPlugins);
+            renderMidiFromClips = r.createMidiFile && Renderer::canRenderMidiFromClips (r);
+
+            if (! renderMidiFromClips)
+                node = Renderer::createRenderingAudioNode (r);
         });
 
-        if (node != nullptr)
+        if (node != nullptr || renderMidiFromClips)
         {
             task.reset (new Renderer::RenderTask (desc, r, node, owner.progress, &owner.thumbnailToUpdate));
             return task->errorMessage.isEmpty();
@@ -317,6 +326,12 @@ void EditRenderJob::renderSeparateTracks()
 
     auto originalTracksToDo = params.tracksToDo;
 
+    // If the stems don't need post-processing separately they can all be rendered in one pass
+    const bool canRenderInOnePass = ! (params.shouldNormalise || params.shouldNormaliseByRMS
+                                        || params.trimSilenceAtEnds || params.useMasterPlugins
+                                        || params.createMidiFile);
+    Array<Renderer::Parameters::Stem> stems;
+
     for (int i = 0; i <= originalTracksToDo.getHighestBit(); ++i)
     {
         if (originalTracksToDo[i])
@@ -365,12 +380,31 @@ void EditRenderJob::renderSeparateTracks()
                 params.tracksToDo = tracksToDo;
 
                 if (Renderer::checkTargetFile (track->edit.engine, params.destFile))
-                    renderPasses.add (new RenderPass (*this, params, getDescription()));
+                {
+                    if (canRenderInOnePass)
+                        stems.add ({ tracksToDo, params.destFile });
+                    else
+                        renderPasses.add (new RenderPass (*this, params, getDescription()));
+                }
             }
         }
     }
 
     params.tracksToDo = originalTracksToDo;
+
+    if (! stems.isEmpty())
+    {
+        params.tracksToDo.clear();
+
+        for (auto& stem : stems)
+            params.tracksToDo |= stem.tracksToDo;
+
+        params.stems = stems;
+        renderPasses.add (new RenderPass (*this, params, TRANS("Rendering Tracks") + "..."));
+
+        params.stems.clear();
+        params.tracksToDo = originalTracksToDo;
+    }
 }
 
 bool EditRenderJob::generateSilence (const File& fileToWriteTo)
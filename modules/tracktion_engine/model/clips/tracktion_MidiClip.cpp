@@ -15,56 +15,79 @@ static std::unique_ptr<MidiList> createLoopRangeDefinesAllRepetitionsSequence (M
 {
     const auto loopStartBeats = clip.getLoopStartBeats();
     const auto loopLengthBeats = clip.getLoopLengthBeats();
+    const auto loopEndBeats = loopStartBeats + loopLengthBeats;
 
     const auto extraLoops = roundToInt (std::ceil (clip.getOffsetInBeats() / loopLengthBeats));
     const auto loopTimes  = roundToInt (std::ceil (clip.getLengthInBeats() / loopLengthBeats)) + extraLoops;
 
-    const auto& notes = sourceSequence.getNotes();
+    // Each repetition holds the same events, so find the ones inside the loop range once,
+    // trimmed to fit it, rather than checking every event in the list for every repetition
+    struct LoopedNote
+    {
+        const MidiNote* note;
+        double start, length;
+    };
+
+    std::vector<LoopedNote> loopedNotes;
+
+    for (auto note : sourceSequence.getNotes())
+    {
+        double start  = note->getStartBeat() - loopStartBeats;
+        double length = note->getLengthBeats();
+
+        if (start >= loopLengthBeats)
+            break;
+
+        if (start < 0.0)
+        {
+            length += start;
+            start = 0.0;
+        }
+
+        if (start + length > loopLengthBeats)
+            length -= (start + length) - loopLengthBeats;
+
+        if (length > 0)
+            loopedNotes.push_back ({ note, start, length });
+    }
+
+    auto getEventsInLoop = [loopStartBeats, loopEndBeats] (const auto& events)
+    {
+        auto first = std::lower_bound (events.begin(), events.end(), loopStartBeats,
+                                       [] (const auto* e, double beat) { return e->getBeatPosition() < beat; });
+        auto last = std::lower_bound (first, events.end(), loopEndBeats,
+                                      [] (const auto* e, double beat) { return e->getBeatPosition() < beat; });
+
+        return juce::Range<int> ((int) (first - events.begin()), (int) (last - events.begin()));
+    };
+
     const auto& sysex = sourceSequence.getSysexEvents();
     const auto& controllers = sourceSequence.getControllerEvents();
+    const auto sysexInLoop = getEventsInLoop (sysex);
+    const auto controllersInLoop = getEventsInLoop (controllers);
 
     auto v = MidiList::createMidiList();
 
     for (int i = 0; i < loopTimes; ++i)
     {
         const double loopPos = loopLengthBeats * i;
-        const double nextLoopPos = loopLengthBeats * (i + 1);
 
         // add the midi notes
-        for (auto note : notes)
-        {
-            double start  = (note->getStartBeat() - loopStartBeats) + loopPos;
-            double length = note->getLengthBeats();
-
-            if (start < loopPos)
-            {
-                length -= loopPos - start;
-                start  += loopPos - start;
-            }
-
-            if (start + length > nextLoopPos)
-                length -= (start + length) - nextLoopPos;
-
-            if (start >= loopPos && start < nextLoopPos && length > 0)
-                v.addChild (MidiNote::createNote (*note, start, length), -1, nullptr);
-        }
+        for (auto& n : loopedNotes)
+            v.addChild (MidiNote::createNote (*n.note, n.start + loopPos, n.length), -1, nullptr);
 
         // add the sysex
-        for (auto oldEvent : sysex)
+        for (int j = sysexInLoop.getStart(); j < sysexInLoop.getEnd(); ++j)
         {
-            const double start = (oldEvent->getBeatPosition() - loopStartBeats) + loopPos;
-
-            if (start >= loopPos && start < nextLoopPos)
-                v.addChild (MidiSysexEvent::createSysexEvent (*oldEvent, start), -1, nullptr);
+            auto oldEvent = sysex.getUnchecked (j);
+            v.addChild (MidiSysexEvent::createSysexEvent (*oldEvent, (oldEvent->getBeatPosition() - loopStartBeats) + loopPos), -1, nullptr);
         }
 
         // add the controller
-        for (auto oldEvent : controllers)
+        for (int j = controllersInLoop.getStart(); j < controllersInLoop.getEnd(); ++j)
         {
-            const double start = (oldEvent->getBeatPosition() - loopStartBeats) + loopPos;
-
-            if (start >= loopPos && start < nextLoopPos)
-                v.addChild (MidiControllerEvent::createControllerEvent (*oldEvent, start), -1, nullptr);
+            auto oldEvent = controllers.getUnchecked (j);
+            v.addChild (MidiControllerEvent::createControllerEvent (*oldEvent, (oldEvent->getBeatPosition() - loopStartBeats) + loopPos), -1, nullptr);
         }
     }
 
@@ -116,6 +139,9 @@ MidiClip::MidiClip (const juce::ValueTree& v, EditItemID id, ClipTrack& targetTr
 
     if (pgen.isValid())
         patternGenerator.reset (new PatternGenerator (*this, pgen));
+
+    sequenceUpdater = std::make_shared<MidiAudioNode::SequenceUpdater>();
+    sequenceUpdateCaller.setFunction ([this] { updatePlayingSequence(); });
 }
 
 MidiClip::~MidiClip()
@@ -247,16 +273,62 @@ bool MidiClip::usesGrooveStrength() const
 AudioNode* MidiClip::createAudioNode (const CreateAudioNodeParams& params)
 {
     CRASH_TRACER
-    MidiMessageSequence sequence;
-    getSequenceLooped().exportToPlaybackMidiSequence (sequence, *this, mpeMode);
+    auto sequence = getPlaybackSequence();
 
     const auto nodeToReplace = getClipIfPresentInNode (params.audioNodeToBeReplaced, *this);
 
     auto channels = mpeMode ? Range<int> (2, 15)
                             : Range<int>::withStartAndLength (getMidiChannel().getChannelNumber(), 0);
 
-    return new MidiAudioNode (std::move (sequence), channels, getEditTimeRange(),
-                              volumeDb, mute, *this, nodeToReplace);
+    auto node = new MidiAudioNode (std::move (sequence), channels, getEditTimeRange(),
+                                   volumeDb, mute, *this, nodeToReplace);
+    node->setSequenceUpdater (sequenceUpdater);
+
+    return node;
+}
+
+void MidiClip::updatePlayingSequence()
+{
+    CRASH_TRACER
+
+    // Only worth re-exporting if a node might be playing the old sequence
+    if (sequenceUpdater.use_count() > 1)
+        sequenceUpdater->setSequences ({ getPlaybackSequence() });
+}
+
+MidiMessageSequence MidiClip::getPlaybackSequence()
+{
+    CRASH_TRACER
+    auto& source = getSequenceLooped();
+
+    // Selections are only used temporarily so don't get cached
+    if (selectedEvents != nullptr)
+    {
+        MidiMessageSequence sequence;
+        source.exportToPlaybackMidiSequence (sequence, *this, mpeMode);
+        return sequence;
+    }
+
+    const auto pos = getPosition();
+    const auto tempoChangeCount = edit.tempoSequence.getChangeCount();
+
+    // The export is only needed if something it depends on has changed since the last
+    // time, rather than every time the playback graph gets rebuilt
+    if (cachedPlaybackSequence == nullptr
+         || cachedPlaybackSequence->source != &source
+         || cachedPlaybackSequence->position != pos
+         || cachedPlaybackSequence->grooveTemplate != grooveTemplate.get()
+         || cachedPlaybackSequence->tempoChangeCount != tempoChangeCount)
+    {
+        cachedPlaybackSequence = std::make_unique<CachedPlaybackSequence>();
+        source.exportToPlaybackMidiSequence (cachedPlaybackSequence->sequence, *this, mpeMode);
+        cachedPlaybackSequence->source = &source;
+        cachedPlaybackSequence->position = pos;
+        cachedPlaybackSequence->grooveTemplate = grooveTemplate;
+        cachedPlaybackSequence->tempoChangeCount = tempoChangeCount;
+    }
+
+    return cachedPlaybackSequence->sequence;
 }
 
 MidiList& MidiClip::getSequence() const noexcept
@@ -794,6 +866,7 @@ void MidiClip::valueTreePropertyChanged (ValueTree& tree, const juce::Identifier
         }
     }
     else if (tree.hasType (IDs::NOTE)
+             || tree.getParent().hasType (IDs::NOTE)
              || tree.hasType (IDs::CONTROL)
              || tree.hasType (IDs::SYSEX)
              || tree.hasType (IDs::QUANTISATION)
@@ -810,7 +883,7 @@ void MidiClip::valueTreePropertyChanged (ValueTree& tree, const juce::Identifier
 
 void MidiClip::valueTreeChildAdded (ValueTree& p, juce::ValueTree& c)
 {
-    if (p.hasType (IDs::SEQUENCE))
+    if (p.hasType (IDs::SEQUENCE) || p.hasType (IDs::NOTE))
         clearCachedLoopSequence();
     else if ((p == state || p.getParent() == state) && c.hasType (IDs::SEQUENCE))
         channelSequence.add (new MidiList (c, getUndoManager()));
@@ -821,7 +894,7 @@ void MidiClip::valueTreeChildAdded (ValueTree& p, juce::ValueTree& c)
 
 void MidiClip::valueTreeChildRemoved (ValueTree& p, juce::ValueTree& c, int)
 {
-    if (p.hasType (IDs::SEQUENCE))
+    if (p.hasType (IDs::SEQUENCE) || p.hasType (IDs::NOTE))
     {
         clearCachedLoopSequence();
     }
@@ -846,7 +919,12 @@ void MidiClip::valueTreeChildRemoved (ValueTree& p, juce::ValueTree& c, int)
 void MidiClip::clearCachedLoopSequence()
 {
     cachedLoopedSequence = nullptr;
+    cachedPlaybackSequence = nullptr;
     changed();
+
+    // Note edits, including patterns regenerated for new chords or pitches, are
+    // picked up by the playing nodes without the graph being rebuilt
+    sequenceUpdateCaller.triggerAsyncUpdate();
 }
 
 //==============================================================================
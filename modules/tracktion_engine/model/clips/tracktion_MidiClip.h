@@ -171,14 +171,30 @@ private:
     SelectedMidiEvents* selectedEvents = nullptr;
 
     mutable std::unique_ptr<MidiList> cachedLoopedSequence;
+
+    struct CachedPlaybackSequence
+    {
+        juce::MidiMessageSequence sequence;
+        const MidiList* source = nullptr;
+        ClipPosition position;
+        juce::String grooveTemplate;
+        juce::uint32 tempoChangeCount = 0;
+    };
+
+    std::unique_ptr<CachedPlaybackSequence> cachedPlaybackSequence;
     MidiCompManager::Ptr midiCompManager;
 
+    std::shared_ptr<MidiAudioNode::SequenceUpdater> sequenceUpdater;
+    AsyncCaller sequenceUpdateCaller;
+
     //==============================================================================
     void setSelectedEvents (SelectedMidiEvents* events)     { selectedEvents = events; }
 
     //==============================================================================
     MidiList* getMidiListForState (const juce::ValueTree&);
     void clearCachedLoopSequence();
+    juce::MidiMessageSequence getPlaybackSequence();
+    void updatePlayingSequence();
 
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MidiClip)
@@ -58,6 +58,9 @@ StepClip::StepClip (const juce::ValueTree& v, EditItemID id, ClipTrack& targetTr
     volumeDb.referTo (state, IDs::volDb, um, 0.0f);
     mute.referTo (state, IDs::mute, um, false);
 
+    sequenceUpdater = std::make_shared<MidiAudioNode::SequenceUpdater>();
+    sequenceUpdateCaller.setFunction ([this] { updatePlayingSequences(); });
+
     if (getChannels().isEmpty())
     {
         for (int i = defaultNumChannels; --i >= 0;)
@@ -159,6 +162,10 @@ void StepClip::valueTreePropertyChanged (ValueTree& v, const juce::Identifier& i
 
     changed();
 
+    // Pattern edits are picked up by the playing nodes without the graph being rebuilt
+    if (v.hasType (IDs::PATTERN) || v.hasType (IDs::CHANNEL))
+        sequenceUpdateCaller.triggerAsyncUpdate();
+
     if (v.hasType (IDs::PATTERN))
     {
         for (auto patternInstance : patternInstanceList)
@@ -178,7 +185,10 @@ void StepClip::valueTreeChildAdded (ValueTree& p, juce::ValueTree& c)
     Clip::valueTreeChildAdded (p, c);
 
     if (p.hasType (IDs::PATTERN))
+    {
         changed();
+        sequenceUpdateCaller.triggerAsyncUpdate();
+    }
 }
 
 void StepClip::valueTreeChildRemoved (ValueTree& p, juce::ValueTree& c, int oldIndex)
@@ -186,7 +196,10 @@ void StepClip::valueTreeChildRemoved (ValueTree& p, juce::ValueTree& c, int oldI
     Clip::valueTreeChildRemoved (p, c, oldIndex);
 
     if (p.hasType (IDs::PATTERN))
+    {
         changed();
+        sequenceUpdateCaller.triggerAsyncUpdate();
+    }
 }
 
 //==============================================================================
@@ -401,33 +414,36 @@ void StepClip::generateMidiSequence (MidiMessageSequence& result,
     result.updateMatchedPairs();
 }
 
-AudioNode* StepClip::createAudioNode (const CreateAudioNodeParams& params)
+std::vector<MidiMessageSequence> StepClip::createPlaybackSequences()
 {
-    CRASH_TRACER
+    // When notes have probabilities, a set of variations is generated and the node cycles through them
+    const int numSequences = usesProbability() ? 64 : 1;
+    std::vector<MidiMessageSequence> sequences ((size_t) numSequences);
 
-    if (usesProbability())
-    {
-        std::vector<MidiMessageSequence> sequences;
+    for (auto& sequence : sequences)
+        generateMidiSequence (sequence);
 
-        for (int i = 0; i < 64; i++)
-        {
-            MidiMessageSequence sequence;
-            generateMidiSequence (sequence);
+    return sequences;
+}
 
-            sequences.push_back (sequence);
-        }
+void StepClip::updatePlayingSequences()
+{
+    CRASH_TRACER
 
-        return new MidiAudioNode (std::move (sequences), { 1, 16 }, getEditTimeRange(), volumeDb, mute, *this,
-                                  getClipIfPresentInNode (params.audioNodeToBeReplaced, *this));
-    }
-    else
-    {
-        MidiMessageSequence sequence;
-        generateMidiSequence (sequence);
+    // Only worth regenerating if a node might be playing the old sequences
+    if (sequenceUpdater.use_count() > 1)
+        sequenceUpdater->setSequences (createPlaybackSequences());
+}
 
-        return new MidiAudioNode (std::move (sequence), { 1, 16 }, getEditTimeRange(), volumeDb, mute, *this,
-                                  getClipIfPresentInNode (params.audioNodeToBeReplaced, *this));
-    }
+AudioNode* StepClip::createAudioNode (const CreateAudioNodeParams& params)
+{
+    CRASH_TRACER
+
+    auto node = new MidiAudioNode (createPlaybackSequences(), { 1, 16 }, getEditTimeRange(), volumeDb, mute, *this,
+                                   getClipIfPresentInNode (params.audioNodeToBeReplaced, *this));
+    node->setSequenceUpdater (sequenceUpdater);
+
+    return node;
 }
 
 //==============================================================================
@@ -266,6 +266,12 @@ private:
     const PatternInstance::Ptr getPatternInstance (int index, bool repeatSequence) const;
     void updatePatternList();
 
+    std::shared_ptr<MidiAudioNode::SequenceUpdater> sequenceUpdater;
+    AsyncCaller sequenceUpdateCaller;
+
+    std::vector<juce::MidiMessageSequence> createPlaybackSequences();
+    void updatePlayingSequences();
+
     void valueTreePropertyChanged (juce::ValueTree&, const juce::Identifier&) override;
     void valueTreeChildAdded (juce::ValueTree&, juce::ValueTree&) override;
     void valueTreeChildRemoved (juce::ValueTree&, juce::ValueTree&, int) override;
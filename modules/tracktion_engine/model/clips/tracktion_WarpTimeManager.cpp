@@ -65,6 +65,33 @@ struct TransientDetectionJob  : public RenderManager::Job
 
     Array<double> getTimes() const                  { return transientTimes; }
 
+    /** Returns the times found by an earlier detection of this file, if they're in the cache. */
+    static bool loadCachedTimes (Engine& e, const AudioFile& file, Config config, Array<double>& times)
+    {
+        MemoryBlock data;
+
+        if (! getCacheFile (e, file, config).loadFileAsData (data))
+            return false;
+
+        MemoryInputStream in (data, false);
+
+        if (in.readInt() != cacheFileMagic)
+            return false;
+
+        auto numTimes = in.readInt();
+
+        if (numTimes < 0 || (size_t) numTimes * sizeof (double) + 2 * sizeof (int) != data.getSize())
+            return false;
+
+        times.clearQuick();
+        times.ensureStorageAllocated (numTimes);
+
+        for (int i = 0; i < numTimes; ++i)
+            times.add (in.readDouble());
+
+        return true;
+    }
+
 protected:
     bool setUpRender() override                     { return reader != nullptr && totalNumSamples > 0; }
 
@@ -96,6 +123,9 @@ protected:
                     break;
         }
 
+        if (! findingNormaliseLevel && numSamplesRead >= totalNumSamples)
+            saveTimesToCache();
+
         return true;
     }
 
@@ -220,6 +250,30 @@ private:
         return sampleRate > 0.0 ? sample / sampleRate : 0.0;
     }
 
+    //==============================================================================
+    static constexpr int cacheFileMagic = 0x31544454; // "TDT1"
+
+    static File getCacheFile (Engine& e, const AudioFile& file, Config config)
+    {
+        auto hash = TemporaryFileManager::getFileContentHash (file.getFile())
+                      ^ (int64) (config.sensitivity * 1000.0f) * 7919
+                      ^ (int64) cacheFileMagic;
+
+        return TemporaryFileManager::getFileForCachedAnalysis (e, hash);
+    }
+
+    void saveTimesToCache()
+    {
+        MemoryOutputStream out;
+        out.writeInt (cacheFileMagic);
+        out.writeInt (transientTimes.size());
+
+        for (auto t : transientTimes)
+            out.writeDouble (t);
+
+        getCacheFile (engine, file, config).replaceWithData (out.getData(), out.getDataSize());
+    }
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TransientDetectionJob)
 };
 
@@ -547,14 +601,43 @@ double WarpTimeManager::getWarpEndMarkerTime() const
     return getSourceLength();
 }
 
-void WarpTimeManager::editFinishedLoading()
+static TransientDetectionJob::Config getDefaultTransientDetectionConfig()
 {
     TransientDetectionJob::Config config;
     config.sensitivity = 0.5f;
-    transientDetectionJob = TransientDetectionJob::getOrCreateDetectionJob (edit.engine, getSourceFile(), config);
+    return config;
+}
 
-    if (transientDetectionJob != nullptr)
-        transientDetectionJob->addListener (this);
+void WarpTimeManager::detectTransientsInBackground (Engine& engine, const Array<AudioFile>& files)
+{
+    TRACKTION_ASSERT_MESSAGE_THREAD
+    auto config = getDefaultTransientDetectionConfig();
+
+    for (auto& f : files)
+    {
+        Array<double> times;
+
+        if (f.isValid() && ! TransientDetectionJob::loadCachedTimes (engine, f, config, times))
+            TransientDetectionJob::getOrCreateDetectionJob (engine, f, config);
+    }
+}
+
+void WarpTimeManager::editFinishedLoading()
+{
+    auto config = getDefaultTransientDetectionConfig();
+    Array<double> cachedTimes;
+
+    if (TransientDetectionJob::loadCachedTimes (edit.engine, getSourceFile(), config, cachedTimes))
+    {
+        transientTimes = { true, cachedTimes };
+    }
+    else
+    {
+        transientDetectionJob = TransientDetectionJob::getOrCreateDetectionJob (edit.engine, getSourceFile(), config);
+
+        if (transientDetectionJob != nullptr)
+            transientDetectionJob->addListener (this);
+    }
 
     editLoadedCallback = nullptr;
 }
@@ -74,6 +74,13 @@ public:
     juce::Array<EditTimeRange> getWarpTimeRegions (EditTimeRange overallTimeRegion) const;
     std::pair<bool, juce::Array<double>> getTransientTimes() const    { return transientTimes; }
 
+    /** Starts detecting the transients of some files in the background, e.g. everything in a
+        folder that's just been imported. The files are analysed in parallel and the results are
+        cached, so WarpTimeManagers using them will have their transient times straight away.
+        Files that have been analysed already are skipped.
+    */
+    static void detectTransientsInBackground (Engine&, const juce::Array<AudioFile>&);
+
     double warpTimeToSourceTime (double warpTime) const;
     double sourceTimeToWarpTime (double sourceTime) const;
 
@@ -99,7 +99,7 @@ bool WaveAudioClip::needsRender() const
 
 int64 WaveAudioClip::getHash() const
 {
-    return AudioFile (edit.engine, getOriginalFile()).getHash()
+    return TemporaryFileManager::getFileContentHash (getOriginalFile())
          ^ (int64) (getWarpTime() ? getWarpTimeManager().getHash() : 0)
          ^ (int64) (getIsReversed() * 768)
          ^ (int64) ((clipEffects == nullptr || ! canHaveEffects())  ? 0 : clipEffects->getHash());
@@ -521,6 +521,22 @@ WaveCompManager& WaveAudioClip::getCompManager()
     return *compManager;
 }
 
+bool WaveAudioClip::canPlayCompFromTakes() const
+{
+    return hasAnyTakes()
+        && ! (isUsingMelodyne() || isReversed || warpTime || (clipEffects != nullptr && canHaveEffects()))
+        && ! (isLooping() || usesTimeStretchedProxy())
+        && ! ((fadeInBehaviour == speedRamp && fadeIn > 0.0) || (fadeOutBehaviour == speedRamp && fadeOut > 0.0));
+}
+
+AudioNode* WaveAudioClip::createUnrenderedSourceNode (EditTimeRange editTime, LiveClipLevel lcl, double offset, double speed)
+{
+    if (! canPlayCompFromTakes() || ! isCurrentTakeComp() || getAudioFile().isValid())
+        return {};
+
+    return getCompManager().createCompAudioNode (editTime, lcl, offset, speed);
+}
+
 //==============================================================================
 RenderManager::Job::Ptr WaveAudioClip::getRenderJob (const AudioFile& destFile)
 {
@@ -59,6 +59,11 @@ public:
 
     WaveCompManager& getCompManager();
 
+    /** Returns true if a comp can be played straight from its takes, which is the case unless
+        the clip needs rendering, looping or timestretching.
+    */
+    bool canPlayCompFromTakes() const;
+
     void reassignReferencedItem (const ReferencedItem&, ProjectItemID newID, double newStartTime) override;
 
     //==============================================================================
@@ -69,6 +74,9 @@ public:
 
     bool isUsingFile (const AudioFile& af) override;
 
+protected:
+    AudioNode* createUnrenderedSourceNode (EditTimeRange, LiveClipLevel, double offset, double speed) override;
+
 private:
     //==============================================================================
     mutable double sourceLength = 0;
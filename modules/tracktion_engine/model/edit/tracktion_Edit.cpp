@@ -59,6 +59,187 @@ struct Edit::UndoTransactionTimer   : private juce::Timer,
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (UndoTransactionTimer)
 };
 
+//==============================================================================
+/**
+    Keeps an estimate of how much memory each transaction in the undo history is holding
+    on to and drops the oldest ones when the total goes over the Edit's limit.
+
+    The UndoManager only counts its actions, not the trees and values they keep, so the
+    sizes are estimated from the changes made to the Edit's state. A change is only
+    counted once the UndoManager's stored units have grown, so changes made without
+    the UndoManager aren't included.
+*/
+struct Edit::UndoMemoryMonitor   : private juce::ValueTree::Listener,
+                                   private juce::ChangeListener
+{
+    UndoMemoryMonitor (Edit& e, int numLevels, juce::int64 maxBytes)
+        : state (e.state), undoManager (e.getUndoManager()),
+          numUndoLevels (numLevels), maxUndoBytes (maxBytes)
+    {
+        lastNumUnits = undoManager.getNumberOfUnitsTakenUpByStoredCommands();
+        undoManager.addChangeListener (this);
+        state.addListener (this);
+    }
+
+    ~UndoMemoryMonitor() override
+    {
+        state.removeListener (this);
+        undoManager.removeChangeListener (this);
+    }
+
+    juce::int64 getTotalBytes() const
+    {
+        return totalBytes;
+    }
+
+private:
+    juce::ValueTree state;
+    juce::UndoManager& undoManager;
+    const int numUndoLevels;
+    const juce::int64 maxUndoBytes;
+
+    std::vector<juce::int64> undoSizes, redoSizes;
+    juce::int64 totalBytes = 0, pendingBytes = 0, lastChangeBytes = 0;
+    int lastNumUnits = 0;
+    bool isLimiting = false, hasUndoneOrRedone = false;
+
+    static juce::int64 estimateSize (const juce::var& v)
+    {
+        if (v.isString())
+            return 32 + v.toString().getNumBytesAsUTF8();
+
+        if (auto mb = v.getBinaryData())
+            return 32 + (juce::int64) mb->getSize();
+
+        return 16;
+    }
+
+    static juce::int64 estimateSize (const juce::ValueTree& v)
+    {
+        juce::int64 size = 64;
+
+        for (int i = v.getNumProperties(); --i >= 0;)
+            size += 16 + estimateSize (v[v.getPropertyName (i)]);
+
+        for (const auto& child : v)
+            size += estimateSize (child);
+
+        return size;
+    }
+
+    /** The last change is only added to the current transaction if the UndoManager kept an action for it. */
+    void resolveLastChange()
+    {
+        auto numUnits = undoManager.getNumberOfUnitsTakenUpByStoredCommands();
+
+        if (numUnits > lastNumUnits)
+            pendingBytes += lastChangeBytes;
+
+        lastNumUnits = numUnits;
+        lastChangeBytes = 0;
+    }
+
+    void changeMade (juce::int64 bytes)
+    {
+        resolveLastChange();
+
+        if (undoManager.isPerformingUndoRedo())
+            hasUndoneOrRedone = true;
+        else
+            lastChangeBytes = bytes;
+    }
+
+    void valueTreePropertyChanged (juce::ValueTree& v, const juce::Identifier& i) override
+    {
+        // The action keeps both the old and new values, but only the new one's available here
+        changeMade (48 + 2 * estimateSize (v[i]));
+    }
+
+    void valueTreeChildAdded (juce::ValueTree&, juce::ValueTree& c) override       { changeMade (48 + estimateSize (c)); }
+    void valueTreeChildRemoved (juce::ValueTree&, juce::ValueTree& c, int) override { changeMade (48 + estimateSize (c)); }
+    void valueTreeChildOrderChanged (juce::ValueTree&, int, int) override          { changeMade (48); }
+
+    void changeListenerCallback (juce::ChangeBroadcaster*) override
+    {
+        resolveLastChange();
+
+        auto numUndo = (size_t) undoManager.getUndoDescriptions().size();
+        auto numRedo = (size_t) undoManager.getRedoDescriptions().size();
+
+        if (hasUndoneOrRedone)
+        {
+            // Undoing or redoing moves transactions between the two lists
+            while (numRedo > redoSizes.size() && ! undoSizes.empty())
+            {
+                redoSizes.push_back (undoSizes.back());
+                undoSizes.pop_back();
+            }
+
+            while (numRedo < redoSizes.size() && numUndo > undoSizes.size())
+            {
+                undoSizes.push_back (redoSizes.back());
+                redoSizes.pop_back();
+            }
+        }
+
+        // Anything new clears the redo list
+        redoSizes.resize (std::min (redoSizes.size(), numRedo), 0);
+        redoSizes.insert (redoSizes.begin(), numRedo - redoSizes.size(), 0);
+
+        // Any transactions missing from the start have been dropped by the UndoManager
+        if (undoSizes.size() > numUndo)
+            undoSizes.erase (undoSizes.begin(), undoSizes.begin() + (std::ptrdiff_t) (undoSizes.size() - numUndo));
+
+        while (undoSizes.size() < numUndo)
+            undoSizes.push_back (0);
+
+        if (! undoSizes.empty())
+            undoSizes.back() += pendingBytes;
+
+        pendingBytes = 0;
+        hasUndoneOrRedone = false;
+
+        totalBytes = std::accumulate (undoSizes.begin(), undoSizes.end(), (juce::int64) 0)
+                      + std::accumulate (redoSizes.begin(), redoSizes.end(), (juce::int64) 0);
+
+        applyLimit();
+    }
+
+    void applyLimit()
+    {
+        if (maxUndoBytes <= 0)
+            return;
+
+        if (totalBytes > maxUndoBytes)
+        {
+            // Find how many of the newest transactions fit and get the UndoManager to drop
+            // the rest the next time something's performed. It always keeps at least one.
+            auto bytes = std::accumulate (redoSizes.begin(), redoSizes.end(), (juce::int64) 0);
+            int numToKeep = 0;
+
+            for (auto i = undoSizes.rbegin(); i != undoSizes.rend(); ++i)
+            {
+                bytes += *i;
+
+                if (bytes > maxUndoBytes || numToKeep >= numUndoLevels)
+                    break;
+
+                ++numToKeep;
+            }
+
+            undoManager.setMaxNumberOfStoredUnits (1, std::max (1, numToKeep));
+            isLimiting = true;
+        }
+        else if (isLimiting)
+        {
+            undoManager.setMaxNumberOfStoredUnits (1000 * numUndoLevels, numUndoLevels);
+            isLimiting = false;
+        }
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (UndoMemoryMonitor)
+};
+
 //==============================================================================
 struct Edit::EditChangeResetterTimer  : private Timer
 {
@@ -141,7 +322,7 @@ struct Edit::TreeWatcher   : public juce::ValueTree::Listener
             {
                 if (i == IDs::start || i == IDs::length || i == IDs::offset)
                 {
-                    clipMovedOrAdded (v);
+                    clipMovedOrAdded (v, v);
                 }
                 else if (i == IDs::linkID)
                 {
@@ -160,60 +341,47 @@ struct Edit::TreeWatcher   : public juce::ValueTree::Listener
                          || i == IDs::currentTake || i == IDs::sequence || i == IDs::repeatSequence
                          || i == IDs::loopedSequenceType || i == IDs::grooveStrength)
                 {
-                    restart();
+                    restartTrack (v);
                 }
             }
             else if (v.hasType (IDs::COMPSECTION))
             {
-                restart();
+                restartTrack (v);
             }
             else if (v.hasType (IDs::WARPMARKER))
             {
                 if (i == IDs::sourceTime || i == IDs::warpTime)
-                    restart();
+                    restartTrack (v);
             }
             else if (v.hasType (IDs::QUANTISATION))
             {
                 if (i == IDs::type || i == IDs::amount)
-                    restart();
+                    restartTrack (v);
             }
             else if (v.hasType (IDs::NOTE) || v.hasType (IDs::CONTROL) || v.hasType (IDs::SYSEX))
             {
-                if (i != IDs::c)
-                    restart();
+                if (i != IDs::c && ! isInMidiClip (v))
+                    restartTrack (v);
             }
             else if (MidiExpression::isExpression (v.getType()))
             {
-                if (i == IDs::b || i == IDs::v)
-                    restart();
-            }
-            else if (v.hasType (IDs::CHANNEL))
-            {
-                if (i == IDs::pattern || i == IDs::channel
-                    || i == IDs::velocities || i == IDs::gates || i == IDs::probabilities 
-                     || i == IDs::note || i == IDs::velocity || i == IDs::groove
-                     || i == IDs::grooveStrength)
-                    restart();
-            }
-            else if (v.hasType (IDs::PATTERN))
-            {
-                if (i == IDs::noteLength || i == IDs::numNotes)
-                    restart();
+                if ((i == IDs::b || i == IDs::v) && ! isInMidiClip (v))
+                    restartTrack (v);
             }
             else if (v.hasType (IDs::SEQUENCE))
             {
                 if (i == IDs::channelNumber)
-                    restart();
+                    restartTrack (v);
             }
             else if (v.hasType (IDs::GROOVE))
             {
                 if (i == IDs::current)
-                    restart();
+                    restartTrack (v);
             }
             else if (v.hasType (IDs::TAKES))
             {
                 if (i == IDs::currentTake)
-                    restart();
+                    restartTrack (v);
             }
             else if (v.hasType (IDs::SIDECHAINCONNECTION))
             {
@@ -236,7 +404,9 @@ struct Edit::TreeWatcher   : public juce::ValueTree::Listener
             }
             else if (v.hasType (IDs::PLUGIN))
             {
-                if (i == IDs::outputDevice || i == IDs::manualAdjustMs || i == IDs::sidechainSourceID || i == IDs::ignoreVca)
+                if (i == IDs::outputDevice || i == IDs::manualAdjustMs || i == IDs::measuredLatencyMs
+                     || i == IDs::oversampling || i == IDs::oversamplingLinearPhase
+                     || i == IDs::sidechainSourceID || i == IDs::ignoreVca)
                     restart();
             }
             else if (v.hasType (IDs::MASTERVOLUME))
@@ -260,7 +430,16 @@ struct Edit::TreeWatcher   : public juce::ValueTree::Listener
 
     void childAddedOrRemoved (juce::ValueTree& p, juce::ValueTree& c)
     {
-        if (c.hasType (IDs::NOTE)
+        if (c.hasType (IDs::SIDECHAINCONNECTION) || isPluginConnectedToOtherTracks (c))
+        {
+            restart();
+        }
+        else if ((c.hasType (IDs::NOTE) || c.hasType (IDs::CONTROL) || c.hasType (IDs::SYSEX) || p.hasType (IDs::NOTE))
+                  && isInMidiClip (p))
+        {
+            // MidiClips hand their new sequences to the playing nodes themselves
+        }
+        else if (c.hasType (IDs::NOTE)
              || c.hasType (IDs::CONTROL)
              || c.hasType (IDs::SYSEX)
              || c.hasType (IDs::PLUGIN)
@@ -268,7 +447,6 @@ struct Edit::TreeWatcher   : public juce::ValueTree::Listener
              || c.hasType (IDs::PLUGININSTANCE)
              || c.hasType (IDs::CONNECTION)
              || c.hasType (IDs::CHANNELS)
-             || c.hasType (IDs::SIDECHAINCONNECTION)
              || c.hasType (IDs::MACROPARAMETERS)
              || c.hasType (IDs::MACROPARAMETER)
              || p.hasType (IDs::MAPPEDPARAMETER)
@@ -278,14 +456,14 @@ struct Edit::TreeWatcher   : public juce::ValueTree::Listener
              || c.hasType (IDs::ENVELOPEFOLLOWER)
              || c.hasType (IDs::RANDOM)
              || c.hasType (IDs::MIDITRACKER)
-             || p.hasType (IDs::LOOPINFO)
-             || p.hasType (IDs::PATTERN))
+             || p.hasType (IDs::LOOPINFO))
         {
-            restart();
+            // The child may have been removed so look for the track from the parent
+            restartTrack (p);
         }
         else if (Clip::isClipState (c))
         {
-            clipMovedOrAdded (c);
+            clipMovedOrAdded (c, p);
             linkedClipsChanged();
         }
         else if (TrackList::isTrack (c))
@@ -295,7 +473,7 @@ struct Edit::TreeWatcher   : public juce::ValueTree::Listener
         }
         else if (c.hasType (IDs::WARPMARKER))
         {
-            restart();
+            restartTrack (p);
         }
         else if (p.hasType (IDs::TRACKCOMP))
         {
@@ -308,14 +486,14 @@ struct Edit::TreeWatcher   : public juce::ValueTree::Listener
         }
         else if (p.hasType (IDs::NOTE))
         {
-            restart();
+            restartTrack (p);
         }
     }
 
     void valueTreeChildOrderChanged (juce::ValueTree&, int, int) override {}
     void valueTreeParentChanged (juce::ValueTree&) override {}
 
-    void clipMovedOrAdded (const juce::ValueTree& v)
+    void clipMovedOrAdded (const juce::ValueTree& v, const juce::ValueTree& treeInTrack)
     {
         edit.invalidateStoredLength();
 
@@ -324,7 +502,7 @@ struct Edit::TreeWatcher   : public juce::ValueTree::Listener
              || v.hasType (IDs::STEPCLIP)
              || v.hasType (IDs::EDITCLIP)
              || v.hasType (IDs::CHORDCLIP))
-            restart();
+            restartTrack (treeInTrack);
     }
 
     void restart()
@@ -332,6 +510,43 @@ struct Edit::TreeWatcher   : public juce::ValueTree::Listener
         edit.restartPlayback();
     }
 
+    /** MidiClips update their playing nodes when their notes change, so those edits don't need a restart. */
+    static bool isInMidiClip (const juce::ValueTree& v)
+    {
+        for (auto p = v; p.isValid(); p = p.getParent())
+            if (Clip::isClipState (p))
+                return p.hasType (IDs::MIDICLIP);
+
+        return false;
+    }
+
+    /** Restarts just the track the tree belongs to, or everything if it's not part of a track. */
+    void restartTrack (const juce::ValueTree& treeInTrack)
+    {
+        for (auto v = treeInTrack; v.isValid(); v = v.getParent())
+        {
+            if (TrackList::isTrack (v))
+            {
+                edit.restartPlaybackForTrack (EditItemID::fromID (v));
+                return;
+            }
+        }
+
+        restart();
+    }
+
+    static bool isPluginConnectedToOtherTracks (const juce::ValueTree& v)
+    {
+        if (! v.hasType (IDs::PLUGIN))
+            return false;
+
+        auto type = v[IDs::type].toString();
+
+        return type == AuxSendPlugin::xmlTypeName
+            || type == AuxReturnPlugin::xmlTypeName
+            || type == InsertPlugin::xmlTypeName;
+    }
+
     void updateTrackStatusesAsync()
     {
         if (trackStatusUpdater == nullptr)
@@ -519,6 +734,7 @@ Edit::Edit (Options options)
             return {};
         };
 
+    sourceFileCache             = std::make_unique<SourceFileCache> (*this);
     pluginCache                 = std::make_unique<PluginCache> (*this);
     mirroredPluginUpdateTimer   = std::make_unique<MirroredPluginUpdateTimer> (*this);
     transportControl            = std::make_unique<TransportControl> (*this, state.getOrCreateChildWithName (IDs::TRANSPORT, nullptr));
@@ -539,6 +755,7 @@ Edit::Edit (Options options)
     initialise();
 
     undoTransactionTimer = std::make_unique<UndoTransactionTimer> (*this);
+    undoMemoryMonitor = std::make_unique<UndoMemoryMonitor> (*this, options.numUndoLevelsToStore, options.maxUndoMemoryBytes);
 
     if (loadContext != nullptr && ! loadContext->shouldExit)
     {
@@ -592,6 +809,7 @@ Edit::~Edit()
     changedPluginsList.reset();
     editInputDevices.reset();
     treeWatcher.reset();
+    undoMemoryMonitor.reset();
 
     notifyListenersOfDeletion();
 
@@ -635,6 +853,9 @@ void Edit::setProjectItemID (ProjectItemID newID)
 {
     editProjectItemID = newID;
     state.setProperty (IDs::projectID, editProjectItemID.toString(), nullptr);
+
+    // Relative sources are resolved against the Edit's file, which may well have moved
+    sourceFileCache->refresh();
 }
 
 Edit::ScopedRenderStatus::ScopedRenderStatus (Edit& ed, bool shouldReallocateOnDestruction)
@@ -689,6 +910,7 @@ void Edit::initialise()
     initialiseMasterPlugins();
     initialiseAuxBusses();
     initialiseAudioDevices();
+    sourceFileCache->prefetch();
     loadTracks();
 
     if (loadContext != nullptr)
@@ -707,6 +929,9 @@ void Edit::initialise()
     initialiseControllerMappings();
     TemporaryFileManager::purgeOrphanFreezeAndProxyFiles (*this);
 
+    // Keep the headers that were parsed so the next load doesn't have to read them again
+    engine.getAudioFileManager().saveInfoCache();
+
     callBlocking ([this]
                   {
                       // Must be set to false before curve updates
@@ -851,6 +1076,19 @@ void Edit::initialiseClickTrack()
     clickTrackDevice.referTo (click, IDs::outputDevice, nullptr);
 }
 
+template<typename Callback>
+static void forEachTrackState (const juce::ValueTree& parent, Callback&& callback)
+{
+    for (auto v : parent)
+    {
+        if (TrackList::isTrack (v))
+        {
+            callback();
+            forEachTrackState (v, callback);
+        }
+    }
+}
+
 void Edit::loadTracks()
 {
     trackCompManager->initialise (state.getOrCreateChildWithName (IDs::TRACKCOMPS, nullptr));
@@ -858,6 +1096,12 @@ void Edit::loadTracks()
     // Make sure tempo + marker tracks are first (their order in the XML may be wrong so sort them now)
     TrackList::sortTracksByType (state, nullptr);
 
+    numTracksLoaded = 0;
+    numTracksToLoad = 0;
+
+    if (loadContext != nullptr)
+        forEachTrackState (state, [this] { ++numTracksToLoad; });
+
     trackList = std::make_unique<TrackList> (*this, state);
     treeWatcher->linkedClipsChanged();
     updateTrackStatuses();
@@ -1036,6 +1280,14 @@ void Edit::restartPlayback()
         startTimer (1);
 }
 
+void Edit::restartPlaybackForTrack (EditItemID trackID)
+{
+    tracksToRestartPlayback.addIfNotAlreadyThere (trackID);
+
+    if (! isTimerRunning())
+        startTimer (1);
+}
+
 EditPlaybackContext* Edit::getCurrentPlaybackContext() const
 {
     return transportControl->getCurrentPlaybackContext();
@@ -1087,6 +1339,11 @@ void Edit::undoOrRedo (bool isUndo)
     }
 }
 
+juce::int64 Edit::getUndoMemoryUsage() const
+{
+    return undoMemoryMonitor != nullptr ? undoMemoryMonitor->getTotalBytes() : 0;
+}
+
 void Edit::undo()           { undoOrRedo (true); }
 void Edit::redo()           { undoOrRedo (false); }
 
@@ -1209,6 +1466,9 @@ Track::Ptr Edit::loadTrackFrom (juce::ValueTree& v)
         if (needsSanityCheck)
             tr->sanityCheckName();
 
+        if (loadContext != nullptr && numTracksToLoad > 0)
+            loadContext->progress = juce::jmin (1.0f, ++numTracksLoaded / (float) numTracksToLoad);
+
         return tr;
     }
 
@@ -1259,6 +1519,7 @@ bool Edit::areAnyTracksSoloIsolate() const
 void Edit::updateMuteSoloStatuses()
 {
     const bool anySolo = areAnyTracksSolo();
+    anyTracksSolo.store (anySolo, std::memory_order_relaxed);
 
     visitAllTracksRecursive ([anySolo] (Track& t)
     {
@@ -1567,10 +1828,19 @@ void Edit::timerCallback()
     if (shouldRestartPlayback && shouldPlay())
     {
         shouldRestartPlayback = false;
+        tracksToRestartPlayback.clear();
         parameterControlMappings->checkForDeletedParams();
 
         getTransport().editHasChanged();
     }
+    else if (! tracksToRestartPlayback.isEmpty() && shouldPlay())
+    {
+        auto trackIDs = std::move (tracksToRestartPlayback);
+        tracksToRestartPlayback.clear();
+        parameterControlMappings->checkForDeletedParams();
+
+        getTransport().tracksHaveChanged (trackIDs);
+    }
 
     stopTimer();
 }
@@ -2261,6 +2531,7 @@ void Edit::updateFrozenTracks()
                 r.tracksToDo = frozen;
                 r.destFile = TemporaryFileManager::getFreezeFileForDevice (*this, *outputDevice);
                 r.audioFormat = engine.getAudioFileFormatManager().getFrozenFileFormat();
+                r.quality = FloatAudioFormat::planarQualityIndex;
                 r.blockSizeForAudio = dm.getBlockSize();
                 r.sampleRateForAudio = dm.getSampleRate();
                 r.time = { 0.0, length };
@@ -69,6 +69,8 @@ public:
 
         std::function<juce::File()> editFileRetriever;                      /**< An optional editFileRetriever to use. */
         std::function<juce::File (const juce::String&)> filePathResolver;   /**< An optional filePathResolver to use. */
+
+        juce::int64 maxUndoMemoryBytes = Edit::getDefaultMaxUndoMemoryBytes(); /**< An estimate of the most memory the undo history should use, or 0 for no limit. */
     };
 
     /** Creates an Edit from a set of Options. */
@@ -216,10 +218,22 @@ public:
     };
 
     static int getDefaultNumUndoLevels() noexcept               { return 30; }
+    static juce::int64 getDefaultMaxUndoMemoryBytes() noexcept  { return 256 * 1024 * 1024; }
+
+    /** Returns an estimate of how much memory the undo history is holding on to.
+        When this goes over Options::maxUndoMemoryBytes, the oldest transactions are dropped
+        the next time something is done that can be undone.
+    */
+    juce::int64 getUndoMemoryUsage() const;
 
     /** use this to tell the play engine to rebuild the audio graph and restart. */
     void restartPlayback();
 
+    /** Like restartPlayback but only rebuilds the part of the graph for this track, if possible.
+        Use this when a change can't affect any other tracks, e.g. when a clip is moved.
+    */
+    void restartPlaybackForTrack (EditItemID trackID);
+
     //==============================================================================
     TrackList& getTrackList()                                   { return *trackList; }
 
@@ -253,6 +267,11 @@ public:
 
     void updateMuteSoloStatuses();
 
+    /** Returns the value areAnyTracksSolo() had when the mute and solo statuses were last updated.
+        Unlike areAnyTracksSolo() this is quick and safe to call from the audio thread.
+    */
+    bool areAnyTracksSoloCached() const noexcept                { return anyTracksSolo.load (std::memory_order_relaxed); }
+
     EditItemID createNewItemID() const;
     EditItemID createNewItemID (const std::vector<EditItemID>& idsToAvoid) const;
 
@@ -300,6 +319,9 @@ public:
     RackTypeList& getRackList() const noexcept                  { jassert (rackTypes != nullptr); return *rackTypes; }
     TrackCompManager& getTrackCompManager() const noexcept      { jassert (trackCompManager != nullptr); return *trackCompManager; }
 
+    /** Returns the cache of the files that clips' sources resolve to. */
+    SourceFileCache& getSourceFileCache() const noexcept        { jassert (sourceFileCache != nullptr); return *sourceFileCache; }
+
     //==============================================================================
     juce::String getAuxBusName (int bus) const;
     void setAuxBusName (int bus, const juce::String& name);
@@ -514,6 +536,8 @@ private:
     std::unique_ptr<MarkerManager> markerManager;
     struct UndoTransactionTimer;
     std::unique_ptr<UndoTransactionTimer> undoTransactionTimer;
+    struct UndoMemoryMonitor;
+    std::unique_ptr<UndoMemoryMonitor> undoMemoryMonitor;
     struct PluginChangeTimer;
     std::unique_ptr<PluginChangeTimer> pluginChangeTimer;
     struct FrozenTrackCallback;
@@ -521,6 +545,7 @@ private:
     std::unique_ptr<ParameterChangeHandler> parameterChangeHandler;
     std::unique_ptr<PluginCache> pluginCache;
     std::unique_ptr<TrackCompManager> trackCompManager;
+    std::unique_ptr<SourceFileCache> sourceFileCache;
     juce::Array<ModifierTimer*, juce::CriticalSection> modifierTimers;
     std::unique_ptr<GlobalMacros> globalMacros;
 
@@ -528,11 +553,13 @@ private:
     std::atomic<bool> isLoadInProgress { true };
     std::atomic<int> performingRenderCount { 0 };
     bool shouldRestartPlayback = false;
+    juce::Array<EditItemID> tracksToRestartPlayback;
     bool blinkBright = false;
     bool lowLatencyMonitoring = false;
     bool hasChanged = false;
     bool ignoreLeftViewLimit;
     LoadContext* loadContext = nullptr;
+    int numTracksToLoad = 0, numTracksLoaded = 0;
     juce::UndoManager undoManager;
     int numUndoTransactionInhibitors = 0;
     mutable juce::File tempDirectory;
@@ -541,6 +568,7 @@ private:
     bool isPreviewEdit = false;
     std::atomic<double> clickMark1Time { 0.0 }, clickMark2Time { 0.0 };
     std::atomic<bool> isFullyConstructed { false };
+    std::atomic<bool> anyTracksSolo { false };
     mutable std::unordered_set<EditItemID> usedIDs;
 
     const EditRole editRole;
@@ -26,9 +26,14 @@ struct ThreadedEditFileWriter   : private Thread
     void writeTreeToFile (ValueTree&& v, const File& f)
     {
         TRACKTION_ASSERT_MESSAGE_THREAD
-        pending.add (std::pair<ValueTree, File> (v, f));
-        waiter.signal();
-        startThread();
+        addJob ({ std::move (v), {}, f, false });
+    }
+
+    /** Adds some data to the end of a file, or replaces its contents if startNewFile is true. */
+    void appendToFile (MemoryBlock&& data, const File& f, bool startNewFile)
+    {
+        TRACKTION_ASSERT_MESSAGE_THREAD
+        addJob ({ {}, std::move (data), f, ! startNewFile });
     }
 
     void flushAllFiles()
@@ -42,6 +47,21 @@ struct ThreadedEditFileWriter   : private Thread
     }
 
 private:
+    struct Job
+    {
+        ValueTree tree;
+        MemoryBlock data;
+        File file;
+        bool append;
+    };
+
+    void addJob (Job&& job)
+    {
+        pending.add (std::move (job));
+        waiter.signal();
+        startThread();
+    }
+
     void run() override
     {
         while (! threadShouldExit())
@@ -53,24 +73,373 @@ private:
         }
     }
 
-    void writeToFile (std::pair<ValueTree, File> item)
+    static void writeToFile (const Job& job)
     {
-        item.second.deleteFile();
-        FileOutputStream os (item.second);
-        item.first.writeToStream (os);
+        if (! job.append)
+            job.file.deleteFile();
+
+        FileOutputStream os (job.file);
+
+        if (job.tree.isValid())
+            job.tree.writeToStream (os);
+        else
+            os.write (job.data.getData(), job.data.getSize());
     }
 
-    juce::Array<std::pair<ValueTree, File>, CriticalSection> pending;
+    juce::Array<Job, CriticalSection> pending;
     WaitableEvent waiter;
 };
 
+//==============================================================================
+/**
+    Records the changes made to an Edit's state so that autosaves can append just what's
+    changed since the last one to a journal file next to the temp file, rather than writing
+    out the whole Edit each time.
+
+    The journal starts with a token which the temp file's snapshot also has, so a journal
+    left over from an older snapshot is never replayed onto a newer one. Each record holds
+    the path of child indexes to the tree it changes, and is prefixed by its size so that
+    one cut short by a crash can be ignored.
+*/
+struct EditJournal  : private ValueTree::Listener
+{
+    EditJournal (const ValueTree& editState)
+        : state (editState)
+    {
+        state.addListener (this);
+    }
+
+    ~EditJournal() override
+    {
+        state.removeListener (this);
+    }
+
+    static File getJournalFileFor (const File& tempFile)
+    {
+        return tempFile != File() ? tempFile.getSiblingFile (tempFile.getFileName() + "_journal")
+                                  : File();
+    }
+
+    /** Returns true if the next autosave should write a whole new snapshot. */
+    bool needsSnapshot() const
+    {
+        return token.isEmpty() || hasOverflowed
+                || bytesSinceSnapshot > maxJournalBytes;
+    }
+
+    /** Forgets any recorded changes and returns the header for a new journal.
+        The snapshot the journal applies to needs to be given the token that's returned.
+    */
+    MemoryBlock startNewJournal (String& newToken)
+    {
+        clearRecords();
+        token = String::toHexString (Random::getSystemRandom().nextInt64());
+        newToken = token;
+
+        MemoryOutputStream os;
+        os.writeInt (magicNumber);
+        os.writeString (token);
+        bytesSinceSnapshot = 0;
+
+        return os.getMemoryBlock();
+    }
+
+    /** Returns the changes recorded since the last call, ready to be appended to the journal. */
+    MemoryBlock takeRecordedChanges()
+    {
+        MemoryOutputStream os;
+
+        for (auto& r : records)
+        {
+            MemoryOutputStream record;
+            record.writeByte ((char) r.type);
+            writePath (record, r.path);
+
+            switch (r.type)
+            {
+                case propertySet:       record.writeString (r.property.toString()); r.value.writeToStream (record); break;
+                case propertyRemoved:   record.writeString (r.property.toString()); break;
+                case childAdded:        record.writeCompressedInt (r.index); r.child.writeToStream (record); break;
+                case childRemoved:      record.writeCompressedInt (r.index); break;
+                case childMoved:        record.writeCompressedInt (r.index); record.writeCompressedInt (r.newIndex); break;
+                default:                jassertfalse; break;
+            }
+
+            os.writeInt ((int) record.getDataSize());
+            os << record;
+        }
+
+        clearRecords();
+        bytesSinceSnapshot += os.getDataSize();
+        return os.getMemoryBlock();
+    }
+
+    /** Stops the journal being used, e.g. after a full save has replaced the temp file. */
+    void invalidate()
+    {
+        clearRecords();
+        token = {};
+    }
+
+    /** Replays a journal onto the snapshot it was started with, stopping at the first record
+        that's incomplete. Returns false if the journal doesn't belong to this snapshot.
+    */
+    static bool replay (ValueTree& snapshot, const MemoryBlock& journal)
+    {
+        MemoryInputStream is (journal, false);
+
+        if (is.readInt() != magicNumber
+             || is.readString() != snapshot[IDs::autosaveJournal].toString())
+            return false;
+
+        while (! is.isExhausted())
+        {
+            auto size = is.readInt();
+
+            if (size <= 0 || size > is.getNumBytesRemaining())
+                break;
+
+            MemoryBlock recordData;
+            is.readIntoMemoryBlock (recordData, size);
+
+            if (! applyRecord (snapshot, recordData))
+                break;
+        }
+
+        return true;
+    }
+
+private:
+    enum RecordType { propertySet = 1, propertyRemoved, childAdded, childRemoved, childMoved };
+
+    struct Record
+    {
+        RecordType type;
+        juce::Array<int> path;
+        Identifier property;
+        var value;
+        ValueTree child;
+        int index = 0, newIndex = 0;
+    };
+
+    static constexpr int magicNumber = 0x314a4554;
+    static constexpr size_t maxJournalBytes = 8 * 1024 * 1024;
+    static constexpr int maxRecords = 100000;
+
+    ValueTree state;
+    String token;
+    size_t bytesSinceSnapshot = 0;
+    bool hasOverflowed = false;
+
+    std::vector<Record> records;
+
+    // Repeated changes to the same property, e.g. from automation, just update the last
+    // record until something changes the structure of the tree
+    std::unordered_map<String, size_t> propertyRecords;
+
+    void clearRecords()
+    {
+        records.clear();
+        propertyRecords.clear();
+        hasOverflowed = false;
+    }
+
+    bool getPath (ValueTree v, juce::Array<int>& path) const
+    {
+        while (v != state)
+        {
+            auto parent = v.getParent();
+
+            if (! parent.isValid())
+                return false;
+
+            path.insert (0, parent.indexOf (v));
+            v = parent;
+        }
+
+        return true;
+    }
+
+    bool isRecording() const
+    {
+        return token.isNotEmpty() && ! hasOverflowed;
+    }
+
+    void addRecord (Record&& r)
+    {
+        if ((int) records.size() >= maxRecords)
+        {
+            // The next autosave will write a snapshot anyway
+            clearRecords();
+            hasOverflowed = true;
+            return;
+        }
+
+        if (r.type != propertySet && r.type != propertyRemoved)
+            propertyRecords.clear();
+
+        records.push_back (std::move (r));
+    }
+
+    void valueTreePropertyChanged (ValueTree& v, const Identifier& property) override
+    {
+        Record r;
+
+        if (! isRecording() || ! getPath (v, r.path))
+            return;
+
+        r.property = property;
+        r.type = v.hasProperty (property) ? propertySet : propertyRemoved;
+        r.value = v[property];
+
+        String key;
+
+        for (auto i : r.path)
+            key << i << '/';
+
+        key << property.toString();
+
+        auto existing = propertyRecords.find (key);
+
+        if (existing != propertyRecords.end())
+        {
+            auto& last = records[existing->second];
+            last.type = r.type;
+            last.value = r.value;
+            return;
+        }
+
+        auto numRecords = records.size();
+        addRecord (std::move (r));
+
+        if (records.size() > numRecords)
+            propertyRecords[key] = records.size() - 1;
+    }
+
+    void valueTreeChildAdded (ValueTree& parent, ValueTree& child) override
+    {
+        Record r;
+
+        if (! isRecording() || ! getPath (parent, r.path))
+            return;
+
+        r.type = childAdded;
+        r.index = parent.indexOf (child);
+        r.child = child.createCopy();
+        addRecord (std::move (r));
+    }
+
+    void valueTreeChildRemoved (ValueTree& parent, ValueTree&, int index) override
+    {
+        Record r;
+
+        if (! isRecording() || ! getPath (parent, r.path))
+            return;
+
+        r.type = childRemoved;
+        r.index = index;
+        addRecord (std::move (r));
+    }
+
+    void valueTreeChildOrderChanged (ValueTree& parent, int oldIndex, int newIndex) override
+    {
+        Record r;
+
+        if (! isRecording() || ! getPath (parent, r.path))
+            return;
+
+        r.type = childMoved;
+        r.index = oldIndex;
+        r.newIndex = newIndex;
+        addRecord (std::move (r));
+    }
+
+    static void writePath (OutputStream& os, const juce::Array<int>& path)
+    {
+        os.writeCompressedInt (path.size());
+
+        for (auto i : path)
+            os.writeCompressedInt (i);
+    }
+
+    static bool applyRecord (ValueTree& root, const MemoryBlock& data)
+    {
+        MemoryInputStream is (data, false);
+        auto type = (int) is.readByte();
+        auto v = root;
+
+        for (int i = is.readCompressedInt(); --i >= 0;)
+        {
+            v = v.getChild (is.readCompressedInt());
+
+            if (! v.isValid())
+                return false;
+        }
+
+        switch (type)
+        {
+            case propertySet:
+            {
+                auto property = is.readString();
+                v.setProperty (Identifier (property), var::readFromStream (is), nullptr);
+                return true;
+            }
+
+            case propertyRemoved:
+                v.removeProperty (Identifier (is.readString()), nullptr);
+                return true;
+
+            case childAdded:
+            {
+                auto index = is.readCompressedInt();
+                auto child = ValueTree::readFromStream (is);
+
+                if (! child.isValid())
+                    return false;
+
+                v.addChild (child, index, nullptr);
+                return true;
+            }
+
+            case childRemoved:
+            {
+                auto index = is.readCompressedInt();
+
+                if (! isPositiveAndBelow (index, v.getNumChildren()))
+                    return false;
+
+                v.removeChild (index, nullptr);
+                return true;
+            }
+
+            case childMoved:
+            {
+                auto oldIndex = is.readCompressedInt();
+                auto newIndex = is.readCompressedInt();
+
+                if (! (isPositiveAndBelow (oldIndex, v.getNumChildren())
+                        && isPositiveAndBelow (newIndex, v.getNumChildren())))
+                    return false;
+
+                v.moveChild (oldIndex, newIndex, nullptr);
+                return true;
+            }
+
+            default:
+                return false;
+        }
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (EditJournal)
+};
+
 //==============================================================================
 struct SharedEditFileDataCache
 {
     struct Data
     {
         Data (Edit& e)
-            : edit (e)
+            : edit (e), journal (e.state)
         {
             jassert (Selectable::isSelectableValid (&edit));
         }
@@ -81,7 +450,11 @@ struct SharedEditFileDataCache
 
             // If we managed to shutdown cleanly (i.e. without crashing) then delete the temp file
             if (auto item = edit.engine.getProjectManager().getProjectItem (edit))
-                EditFileOperations::getTempVersionOfEditFile (item->getSourceFile()).deleteFile();
+            {
+                auto tempFile = EditFileOperations::getTempVersionOfEditFile (item->getSourceFile());
+                tempFile.deleteFile();
+                EditJournal::getJournalFileFor (tempFile).deleteFile();
+            }
         }
 
         void refresh()
@@ -92,6 +465,7 @@ struct SharedEditFileDataCache
         Edit& edit;
         Time timeOfLastSave { Time::getCurrentTime() };
         EditSnapshot::Ptr editSnapshot { EditSnapshot::getEditSnapshot (edit.engine, edit.getProjectItemID()) };
+        EditJournal journal;
     };
 
     SharedEditFileDataCache() = default;
@@ -146,6 +520,44 @@ struct EditFileOperations::SharedDataPimpl
         editFileWriter->writeTreeToFile (std::move (v), f);
     }
 
+    /** Autosaves to the temp file by appending the changes since the last one to its journal,
+        or writes a new snapshot if there isn't one yet or the journal's got too big.
+    */
+    void writeTempVersionToDisk (const ValueTree& editState, const File& tempFile)
+    {
+        auto& journal = data->journal;
+        auto journalFile = EditJournal::getJournalFileFor (tempFile);
+
+        if (journal.needsSnapshot())
+        {
+            String token;
+            auto header = journal.startNewJournal (token);
+
+            auto snapshot = editState.createCopy();
+            snapshot.setProperty (IDs::autosaveJournal, token, nullptr);
+
+            // Written in this order on the same thread, so a crash part way through
+            // leaves a journal that doesn't match the snapshot rather than one that's wrong
+            editFileWriter->writeTreeToFile (std::move (snapshot), tempFile);
+            editFileWriter->appendToFile (std::move (header), journalFile, true);
+        }
+        else
+        {
+            auto changes = journal.takeRecordedChanges();
+
+            if (changes.getSize() > 0)
+                editFileWriter->appendToFile (std::move (changes), journalFile, false);
+        }
+    }
+
+    /** Stops autosaving to the journal, e.g. once a full save has replaced the temp file. */
+    void resetJournal (const File& tempFile)
+    {
+        data->journal.invalidate();
+        editFileWriter->flushAllFiles();
+        EditJournal::getJournalFileFor (tempFile).deleteFile();
+    }
+
     SharedResourcePointer<SharedEditFileDataCache> cache;
     std::shared_ptr<SharedEditFileDataCache::Data> data;
     SharedResourcePointer<ThreadedEditFileWriter> editFileWriter;
@@ -187,10 +599,14 @@ bool EditFileOperations::writeToFile (const File& file, bool writeQuickBinaryVer
     {
         if (writeQuickBinaryVersion)
         {
-            sharedDataPimpl->writeValueTreeToDisk (edit.state.createCopy(), file);
+            if (file == getTempVersionFile())
+                sharedDataPimpl->writeTempVersionToDisk (edit.state, file);
+            else
+                sharedDataPimpl->writeValueTreeToDisk (edit.state.createCopy(), file);
         }
         else
         {
+            sharedDataPimpl->resetJournal (getTempVersionFile());
             edit.flushState();
 
             if (editSnapshot != nullptr)
@@ -411,6 +827,7 @@ File EditFileOperations::getTempVersionFile() const
 
 void EditFileOperations::deleteTempVersion()
 {
+    sharedDataPimpl->resetJournal (getTempVersionFile());
     getTempVersionFile().deleteFile();
 }
 
@@ -429,25 +846,83 @@ ValueTree loadEditFromProjectManager (ProjectManager& pm, ProjectItemID itemID)
     return {};
 }
 
-ValueTree loadEditFromFile (Engine& e, const File& f, ProjectItemID itemID)
+static bool looksLikeXml (const MemoryBlock& data)
+{
+    auto text = static_cast<const char*> (data.getData());
+    size_t i = 0;
+
+    if (data.getSize() >= 3 && (uint8) text[0] == 0xef && (uint8) text[1] == 0xbb && (uint8) text[2] == 0xbf)
+        i = 3;
+
+    while (i < data.getSize() && CharacterFunctions::isWhitespace (text[i]))
+        ++i;
+
+    return i < data.getSize() && text[i] == '<';
+}
+
+ValueTree loadEditStateFromFile (const File& f)
 {
     CRASH_TRACER
     ValueTree state;
 
-    if (auto xml = std::unique_ptr<XmlElement> (XmlDocument::parse (f)))
+    // The file is read in one go and only parsed as XML if it looks like it,
+    // rather than parsing a binary Edit as XML first and then reading it again
+    MemoryBlock data;
+
+    if (f.existsAsFile() && f.loadFileAsData (data) && data.getSize() > 0)
     {
-        updateLegacyEdit (*xml);
-        state = ValueTree::fromXml (*xml);
+        if (looksLikeXml (data))
+        {
+            XmlDocument doc (String::createStringFromData (data.getData(), (int) data.getSize()));
+
+            if (auto xml = doc.getDocumentElement())
+            {
+                updateLegacyEdit (*xml);
+                state = ValueTree::fromXml (*xml);
+            }
+        }
+
+        if (! state.isValid())
+            state = updateLegacyEdit (ValueTree::readFromData (data.getData(), data.getSize()));
     }
 
-    if (! state.isValid())
+    return state;
+}
+
+ValueTree EditFileOperations::loadTempVersionOfEditFile (const File& editFile)
+{
+    CRASH_TRACER
+    auto tempFile = getTempVersionOfEditFile (editFile);
+    MemoryBlock data;
+
+    if (! (tempFile.existsAsFile() && tempFile.loadFileAsData (data) && data.getSize() > 0))
+        return {};
+
+    // Autosaves are binary snapshots with a journal of the changes made since. The journal's
+    // paths refer to the tree as it was saved, so it's replayed before any legacy updates
+    if (! looksLikeXml (data))
     {
-        FileInputStream is (f);
+        auto state = ValueTree::readFromData (data.getData(), data.getSize());
+
+        if (state.isValid())
+        {
+            MemoryBlock journal;
+
+            if (EditJournal::getJournalFileFor (tempFile).loadFileAsData (journal))
+                EditJournal::replay (state, journal);
 
-        if (is.openedOk())
-            state = updateLegacyEdit (ValueTree::readFromStream (is));
+            state.removeProperty (IDs::autosaveJournal, nullptr);
+            return updateLegacyEdit (state);
+        }
     }
 
+    return loadEditStateFromFile (tempFile);
+}
+
+ValueTree loadEditFromFile (Engine& e, const File& f, ProjectItemID itemID)
+{
+    auto state = loadEditStateFromFile (f);
+
     if (! state.isValid())
     {
         state = ValueTree (IDs::EDIT);
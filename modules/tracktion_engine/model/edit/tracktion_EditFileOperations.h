@@ -33,6 +33,13 @@ public:
     void deleteTempVersion();
     juce::File getTempVersionFile() const;
     static juce::File getTempVersionOfEditFile (const juce::File&);
+
+    /** Loads the most recent autosave of an Edit file, e.g. to recover it after a crash.
+        Autosaves made with saveTempVersion (false) only append the changes since the last
+        one to a journal, which this replays onto the temp file's snapshot.
+        Returns an invalid tree if there isn't a temp version.
+    */
+    static juce::ValueTree loadTempVersionOfEditFile (const juce::File& editFile);
     static void updateEditFiles();
 
     juce::Time getTimeOfLastSave() const    { return timeOfLastSave; }
@@ -58,6 +65,11 @@ std::unique_ptr<Edit> createEmptyEdit (Engine&, const juce::File&);
 /** Uses the ProjectManager to find an Edit file and load it as a ValueTree. */
 juce::ValueTree loadEditFromProjectManager (ProjectManager&, ProjectItemID);
 
+/** Reads an Edit's state from a file, which may be in the XML or binary format, and
+    updates it if it's from an older version. Returns an invalid tree if it can't be read.
+*/
+juce::ValueTree loadEditStateFromFile (const juce::File&);
+
 /** Legacy, will be deprecated soon. Use version that returns an edit.
     Loads a ValueTree from a file to load an Edit.
     If the file is empty, a new Edit state will be created with the given ProjectItemID.
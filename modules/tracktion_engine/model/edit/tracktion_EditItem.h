@@ -140,7 +140,7 @@ struct EditItemCache
     }
 
 private:
-    std::map<EditItemID, EditItemType*> knownEditItems;
+    std::unordered_map<EditItemID, EditItemType*> knownEditItems;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (EditItemCache)
 };
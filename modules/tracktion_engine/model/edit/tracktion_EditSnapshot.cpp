@@ -105,21 +105,21 @@ void EditSnapshot::refreshCacheAndNotifyListeners()
     listeners.call (&Listener::editChanged, *this);
 }
 
-void EditSnapshot::addSubTracksRecursively (const juce::XmlElement& parent, int& audioTrackNameNumber)
+void EditSnapshot::addSubTracksRecursively (const juce::ValueTree& parent, int& audioTrackNameNumber)
 {
-    forEachXmlChildElement (parent, track)
+    for (auto track : parent)
     {
-        juce::Identifier trackType (track->getTagName());
+        auto trackType = track.getType();
 
         if (! TrackList::isTrack (trackType))
             continue;
 
-        auto trackName = track->getStringAttribute (IDs::name);
-        trackIDs.add (EditItemID::fromXML (*track, IDs::id));
+        auto trackName = track[IDs::name].toString();
+        trackIDs.add (EditItemID::fromID (track));
 
-        mutedTracks.setBit (numTracks, track->getBoolAttribute (IDs::mute, false));
-        soloedTracks.setBit (numTracks, track->getBoolAttribute (IDs::solo, false));
-        soloIsolatedTracks.setBit (numTracks, track->getBoolAttribute (IDs::soloIsolate, false));
+        mutedTracks.setBit (numTracks, track.getProperty (IDs::mute, false));
+        soloedTracks.setBit (numTracks, track.getProperty (IDs::solo, false));
+        soloIsolatedTracks.setBit (numTracks, track.getProperty (IDs::soloIsolate, false));
 
         if (trackType == IDs::TRACK || trackType == IDs::MARKERTRACK)
         {
@@ -129,71 +129,23 @@ void EditSnapshot::addSubTracksRecursively (const juce::XmlElement& parent, int&
             if (trackType == IDs::TRACK)
             {
                 audioTracks.setBit (numTracks);
-                addEditClips (*track);
-                addClipSources (*track);
+                addEditClips (track);
+                addClipSources (track);
                 ++audioTrackNameNumber;
             }
             else if (trackType == IDs::MARKERTRACK)
             {
-                addMarkers (*track);
+                addMarkers (track);
             }
         }
 
         trackNames.add (trackName);
         ++numTracks;
 
-        addSubTracksRecursively (*track, audioTrackNameNumber);
+        addSubTracksRecursively (track, audioTrackNameNumber);
     }
 }
 
-void EditSnapshot::refreshFromXml (const juce::XmlElement& xml,
-                                   const juce::String& newName, double newLength)
-{
-    clear();
-    name = newName;
-    length = newLength;
-
-    // last significant change
-    auto changeHexString = xml.getStringAttribute (IDs::lastSignificantChange);
-    lastSaveTime = changeHexString.isEmpty() ? sourceFile.getLastModificationTime()
-                                             : Time (changeHexString.getHexValue64());
-
-    // marks
-    if (auto viewState = xml.getChildByName (IDs::TRANSPORT))
-    {
-        auto loopRange = Range<double>::between (viewState->getDoubleAttribute (IDs::loopPoint1),
-                                                 viewState->getDoubleAttribute (IDs::loopPoint2));
-        markIn = loopRange.getStart();
-        markOut = loopRange.getEnd();
-
-        marksActive = markIn != markOut;
-    }
-
-    // tempo, time sig & pitch
-    if (auto tempoSeq = xml.getChildByName (IDs::TEMPOSEQUENCE))
-    {
-        if (auto tempoItem = tempoSeq->getChildByName (IDs::TEMPO))
-            tempo = tempoItem->getDoubleAttribute (IDs::bpm);
-
-        if (auto timeSigItem = tempoSeq->getChildByName (IDs::TIMESIG))
-        {
-            timeSigNumerator    = timeSigItem->getIntAttribute (IDs::numerator);
-            timeSigDenominator  = timeSigItem->getIntAttribute (IDs::denominator);
-        }
-    }
-
-    if (auto pitchSeq = xml.getChildByName (IDs::PITCHSEQUENCE))
-        if (auto pitchItem = pitchSeq->getChildByName (IDs::PITCH))
-            pitch = pitchItem->getIntAttribute (IDs::pitch);
-
-    // tracks
-    trackNames.ensureStorageAllocated (xml.getNumChildElements());
-
-    int audioTrackNameNumber = 1;
-    addSubTracksRecursively (xml, audioTrackNameNumber);
-    numAudioTracks = audioTracks.countNumberOfSetBits();
-}
-
 int EditSnapshot::audioToGlobalTrackIndex (int audioIndex) const
 {
     int audioTrackIndex = 0;
@@ -221,7 +173,7 @@ void EditSnapshot::refreshFromProjectItem (ProjectItem::Ptr pi)
         return;
 
     sourceFile = pi->getSourceFile();
-    auto newState = loadValueTree (sourceFile, true);
+    auto newState = loadEditStateFromFile (sourceFile);
 
     if (! newState.hasType (IDs::EDIT))
         return;
@@ -233,12 +185,66 @@ void EditSnapshot::refreshFromProjectItem (ProjectItem::Ptr pi)
 
 void EditSnapshot::refreshFromState()
 {
+    // This reads the tree directly rather than converting it all to XML first, as
+    // that would mean encoding all the plugin states and MIDI sequences too
     auto editName = name;
     auto editLength = length;
     clear();
+    name = editName;
+    length = editLength;
+
+    // last significant change
+    auto changeHexString = state[IDs::lastSignificantChange].toString();
+    lastSaveTime = changeHexString.isEmpty() ? sourceFile.getLastModificationTime()
+                                             : Time (changeHexString.getHexValue64());
+
+    // marks
+    auto viewState = state.getChildWithName (IDs::TRANSPORT);
+
+    if (viewState.isValid())
+    {
+        auto loopRange = Range<double>::between (viewState[IDs::loopPoint1], viewState[IDs::loopPoint2]);
+        markIn = loopRange.getStart();
+        markOut = loopRange.getEnd();
+
+        marksActive = markIn != markOut;
+    }
+
+    // tempo, time sig & pitch
+    auto tempoSeq = state.getChildWithName (IDs::TEMPOSEQUENCE);
+
+    if (tempoSeq.isValid())
+    {
+        auto tempoItem = tempoSeq.getChildWithName (IDs::TEMPO);
+
+        if (tempoItem.isValid())
+            tempo = tempoItem[IDs::bpm];
 
-    if (auto xml = std::unique_ptr<XmlElement> (state.createXml()))
-        refreshFromXml (*xml, editName, editLength);
+        auto timeSigItem = tempoSeq.getChildWithName (IDs::TIMESIG);
+
+        if (timeSigItem.isValid())
+        {
+            timeSigNumerator    = timeSigItem[IDs::numerator];
+            timeSigDenominator  = timeSigItem[IDs::denominator];
+        }
+    }
+
+    auto pitchSeq = state.getChildWithName (IDs::PITCHSEQUENCE);
+
+    if (pitchSeq.isValid())
+    {
+        auto pitchItem = pitchSeq.getChildWithName (IDs::PITCH);
+
+        if (pitchItem.isValid())
+            pitch = pitchItem[IDs::pitch];
+    }
+
+    // tracks
+    trackNames.ensureStorageAllocated (state.getNumChildren());
+
+    int audioTrackNameNumber = 1;
+    addSubTracksRecursively (state, audioTrackNameNumber);
+    numAudioTracks = audioTracks.countNumberOfSetBits();
 }
 
 void EditSnapshot::clear()
@@ -263,33 +269,33 @@ void EditSnapshot::clear()
     markers.clear();
 }
 
-void EditSnapshot::addEditClips (const juce::XmlElement& track)
+void EditSnapshot::addEditClips (const juce::ValueTree& track)
 {
-    forEachXmlChildElement (track, clip)
-        if (clip->hasTagName (IDs::EDITCLIP))
-            editClipIDs.add (ProjectItemID (clip->getStringAttribute ("source")));
+    for (auto clip : track)
+        if (clip.hasType (IDs::EDITCLIP))
+            editClipIDs.add (ProjectItemID (clip["source"].toString()));
 }
 
-void EditSnapshot::addClipSources (const juce::XmlElement& track)
+void EditSnapshot::addClipSources (const juce::ValueTree& track)
 {
-    forEachXmlChildElement (track, clip)
+    for (auto clip : track)
     {
-        auto sourceID = clip->getStringAttribute ("source");
+        auto sourceID = clip["source"].toString();
 
         if (sourceID.isNotEmpty())
             clipSourceIDs.add (ProjectItemID (sourceID));
     }
 }
 
-void EditSnapshot::addMarkers (const juce::XmlElement& track)
+void EditSnapshot::addMarkers (const juce::ValueTree& track)
 {
-    forEachXmlChildElement (track, clip)
+    for (auto clip : track)
     {
         Marker m;
-        m.name      = clip->getStringAttribute ("name", TRANS("unnamed"));
-        m.colour    = Colour::fromString (clip->getStringAttribute ("colour", TRANS("unnamed")));
-        auto start  = clip->getDoubleAttribute ("start", 0.0);
-        auto len    = clip->getDoubleAttribute ("length", 0.0);
+        m.name      = clip.getProperty ("name", TRANS("unnamed")).toString();
+        m.colour    = Colour::fromString (clip.getProperty ("colour", TRANS("unnamed")).toString());
+        double start  = clip.getProperty ("start", 0.0);
+        double len    = clip.getProperty ("length", 0.0);
         m.time      = { start, start + len };
 
         if (len > 0.0)
@@ -315,4 +321,583 @@ juce::ReferenceCountedArray<EditSnapshot> EditSnapshot::getNestedEditObjects()
     return result;
 }
 
+//==============================================================================
+namespace EditSnapshotHelpers
+{
+    /** What the children of an element are, as far as the Summary is concerned. */
+    enum class Context
+    {
+        none,           /**< Nothing in here is needed, e.g. a clip's contents or a plugin's state. */
+        document,       /**< The root, which should be the EDIT. */
+        editOrTrack,    /**< The EDIT or a track, whose children are tracks, clips and sequences. */
+        markerTrack,
+        tempoSequence,
+        pitchSequence
+    };
+
+    template<typename StringType>
+    static bool isWantedProperty (const StringType& name)
+    {
+        return name == "start" || name == "length" || name == "name" || name == "colour"
+            || name == "loopPoint1" || name == "loopPoint2" || name == "bpm"
+            || name == "numerator" || name == "denominator" || name == "pitch";
+    }
+
+    static bool wantsProperties (Context parent) noexcept
+    {
+        return parent != Context::none && parent != Context::document;
+    }
+
+    /** Fills in a Summary from the elements of an Edit, in the order they appear in the file. */
+    struct SummaryBuilder
+    {
+        SummaryBuilder (EditSnapshot::Summary& s) : summary (s) {}
+
+        /** Adds an element and returns the Context of its children. */
+        Context addElement (Context parent, const juce::String& type, const juce::NamedValueSet& props)
+        {
+            switch (parent)
+            {
+                case Context::document:
+                    summary.isValid = type == IDs::EDIT.toString();
+                    return summary.isValid ? Context::editOrTrack : Context::none;
+
+                case Context::editOrTrack:
+                    if (type == IDs::TRANSPORT.toString())
+                    {
+                        auto loopRange = Range<double>::between (props[IDs::loopPoint1], props[IDs::loopPoint2]);
+                        summary.markIn = loopRange.getStart();
+                        summary.markOut = loopRange.getEnd();
+                        summary.marksActive = summary.markIn != summary.markOut;
+                        return Context::none;
+                    }
+
+                    if (type == IDs::TEMPOSEQUENCE.toString())   return Context::tempoSequence;
+                    if (type == IDs::PITCHSEQUENCE.toString())   return Context::pitchSequence;
+
+                    if (TrackList::isTrack (Identifier (type)))
+                    {
+                        ++summary.numTracks;
+
+                        if (type == IDs::TRACK.toString())
+                            ++summary.numAudioTracks;
+
+                        return type == IDs::MARKERTRACK.toString() ? Context::markerTrack : Context::editOrTrack;
+                    }
+
+                    addClip (props);
+                    return Context::none;
+
+                case Context::markerTrack:
+                    addMarker (props);
+                    addClip (props);
+                    return Context::none;
+
+                case Context::tempoSequence:
+                    if (! foundTempo && type == IDs::TEMPO.toString())
+                    {
+                        foundTempo = true;
+                        summary.tempo = props[IDs::bpm];
+                    }
+                    else if (! foundTimeSig && type == IDs::TIMESIG.toString())
+                    {
+                        foundTimeSig = true;
+                        summary.timeSigNumerator    = props[IDs::numerator];
+                        summary.timeSigDenominator  = props[IDs::denominator];
+                    }
+
+                    return Context::none;
+
+                case Context::pitchSequence:
+                    if (! foundPitch && type == IDs::PITCH.toString())
+                    {
+                        foundPitch = true;
+                        summary.pitch = props[IDs::pitch];
+                    }
+
+                    return Context::none;
+
+                case Context::none:
+                default:
+                    return Context::none;
+            }
+        }
+
+        void addClip (const juce::NamedValueSet& props)
+        {
+            if (props.contains (IDs::length))
+                summary.length = jmax (summary.length, (double) props[IDs::start] + (double) props[IDs::length]);
+        }
+
+        void addMarker (const juce::NamedValueSet& props)
+        {
+            // These match EditSnapshot::addMarkers
+            EditSnapshot::Marker m;
+            m.name      = props.contains (IDs::name) ? props[IDs::name].toString() : TRANS("unnamed");
+            m.colour    = Colour::fromString (props.contains (IDs::colour) ? props[IDs::colour].toString() : TRANS("unnamed"));
+            double start  = props[IDs::start];
+            double len    = props[IDs::length];
+            m.time      = { start, start + len };
+
+            if (len > 0.0)
+                summary.markers.add (m);
+        }
+
+        EditSnapshot::Summary& summary;
+        bool foundTempo = false, foundTimeSig = false, foundPitch = false;
+    };
+
+    //==============================================================================
+    /** Reads a stream a block at a time, for the XML scanner. */
+    struct ByteReader
+    {
+        ByteReader (juce::InputStream& s) : stream (s) {}
+
+        int next()
+        {
+            if (position == numInBuffer)
+            {
+                position = 0;
+                numInBuffer = juce::jmax (0, stream.read (buffer, bufferSize));
+
+                if (numInBuffer == 0)
+                    return -1;
+            }
+
+            return (juce::uint8) buffer[position++];
+        }
+
+        static constexpr int bufferSize = 65536;
+        juce::InputStream& stream;
+        juce::HeapBlock<char> buffer { (size_t) bufferSize };
+        int position = 0, numInBuffer = 0;
+    };
+
+    static bool isXmlSpace (int c) noexcept     { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
+
+    /** Reads up to and including a terminator of up to three characters. */
+    static bool skipPast (ByteReader& in, const char* terminator)
+    {
+        const auto length = (int) std::strlen (terminator);
+        jassert (length > 0 && length <= 3);
+        char last[3] = {};
+
+        for (;;)
+        {
+            auto c = in.next();
+
+            if (c < 0)
+                return false;
+
+            last[0] = last[1];
+            last[1] = last[2];
+            last[2] = (char) c;
+
+            if (std::memcmp (last + 3 - length, terminator, (size_t) length) == 0)
+                return true;
+        }
+    }
+
+    static juce::String decodeXmlText (const std::string& text)
+    {
+        if (text.find ('&') == std::string::npos)
+            return juce::String::fromUTF8 (text.data(), (int) text.size());
+
+        juce::String result;
+        auto decoded = String::fromUTF8 (text.data(), (int) text.size());
+
+        for (int i = 0; i < decoded.length();)
+        {
+            auto end = decoded.indexOfChar (i, ';');
+
+            if (decoded[i] != '&' || end < 0)
+            {
+                result += String::charToString (decoded[i++]);
+                continue;
+            }
+
+            auto entity = decoded.substring (i + 1, end);
+
+            if (entity == "amp")            result << '&';
+            else if (entity == "lt")        result << '<';
+            else if (entity == "gt")        result << '>';
+            else if (entity == "quot")      result << '"';
+            else if (entity == "apos")      result << '\'';
+            else if (entity.startsWith ("#x"))  result += String::charToString ((juce_wchar) entity.substring (2).getHexValue32());
+            else if (entity.startsWith ("#"))   result += String::charToString ((juce_wchar) entity.substring (1).getIntValue());
+            else                            result << decoded.substring (i, end + 1);
+
+            i = end + 1;
+        }
+
+        return result;
+    }
+
+    /** Scans the tags of an XML Edit, only keeping the attributes the builder needs. */
+    static void parseXml (ByteReader& in, SummaryBuilder& builder)
+    {
+        std::vector<Context> openElements;
+        std::string name, attributeName, value;
+
+        for (;;)
+        {
+            int c;
+
+            do c = in.next(); while (c >= 0 && c != '<');
+
+            if ((c = in.next()) < 0)
+                return;
+
+            if (c == '?')
+            {
+                if (! skipPast (in, "?>"))
+                    return;
+
+                continue;
+            }
+
+            if (c == '!')
+            {
+                c = in.next();
+
+                if (! skipPast (in, c == '-' ? "-->" : (c == '[' ? "]]>" : ">")))
+                    return;
+
+                continue;
+            }
+
+            if (c == '/')
+            {
+                if (! skipPast (in, ">") || openElements.empty())
+                    return;
+
+                openElements.pop_back();
+
+                if (openElements.empty())
+                    return;
+
+                continue;
+            }
+
+            name.clear();
+
+            for (; c >= 0 && ! isXmlSpace (c) && c != '/' && c != '>'; c = in.next())
+                name += (char) c;
+
+            const auto parent = openElements.empty() ? Context::document : openElements.back();
+            const bool needsProperties = wantsProperties (parent);
+            juce::NamedValueSet props;
+            bool isEmptyElement = false;
+
+            for (;;)
+            {
+                while (isXmlSpace (c))
+                    c = in.next();
+
+                if (c < 0)
+                    return;
+
+                if (c == '>')
+                    break;
+
+                if (c == '/')
+                {
+                    isEmptyElement = true;
+                    c = in.next();
+                    continue;
+                }
+
+                attributeName.clear();
+
+                for (; c >= 0 && c != '=' && ! isXmlSpace (c) && c != '/' && c != '>'; c = in.next())
+                    attributeName += (char) c;
+
+                while (isXmlSpace (c))
+                    c = in.next();
+
+                if (c != '=')
+                    continue;
+
+                do c = in.next(); while (isXmlSpace (c));
+
+                if (c != '"' && c != '\'')
+                    continue;
+
+                // Most of an Edit is in attributes like plugin states, so only the wanted ones are kept
+                const auto quote = c;
+                const bool isWanted = needsProperties && isWantedProperty (attributeName);
+                value.clear();
+
+                for (c = in.next(); c >= 0 && c != quote; c = in.next())
+                    if (isWanted)
+                        value += (char) c;
+
+                if (isWanted)
+                    props.set (Identifier (attributeName.c_str()), decodeXmlText (value));
+
+                c = in.next();
+            }
+
+            const auto context = builder.addElement (parent, String::fromUTF8 (name.data(), (int) name.size()), props);
+
+            if (openElements.empty() && (context == Context::none || isEmptyElement))
+                return;
+
+            if (! isEmptyElement)
+                openElements.push_back (context);
+        }
+    }
+
+    /** Walks a binary ValueTree as written by ValueTree::writeToStream, skipping the values
+        of the properties the builder doesn't need rather than decoding them.
+    */
+    static bool parseBinaryTree (juce::InputStream& in, Context parent, SummaryBuilder& builder)
+    {
+        auto type = in.readString();
+
+        if (type.isEmpty())
+            return false;
+
+        const auto numProps = in.readCompressedInt();
+
+        if (numProps < 0)
+            return false;
+
+        const bool needsProperties = wantsProperties (parent);
+        juce::NamedValueSet props;
+
+        for (int i = 0; i < numProps; ++i)
+        {
+            auto propName = in.readString();
+
+            if (propName.isEmpty())
+                return false;
+
+            if (needsProperties && isWantedProperty (propName))
+            {
+                props.set (propName, juce::var::readFromStream (in));
+            }
+            else
+            {
+                // Each var is written as its size followed by that many bytes
+                const auto numBytes = in.readCompressedInt();
+
+                if (numBytes < 0 || in.isExhausted())
+                    return false;
+
+                in.skipNextBytes (numBytes);
+            }
+        }
+
+        const auto context = builder.addElement (parent, type, props);
+
+        if (parent == Context::document && context == Context::none)
+            return false;
+
+        const auto numChildren = in.readCompressedInt();
+
+        for (int i = 0; i < numChildren; ++i)
+            if (! parseBinaryTree (in, context, builder))
+                return false;
+
+        return true;
+    }
+
+    static bool looksLikeXml (juce::InputStream& in)
+    {
+        char start[64] = {};
+        const auto numRead = in.read (start, (int) sizeof (start));
+        int i = 0;
+
+        if (numRead >= 3 && (uint8) start[0] == 0xef && (uint8) start[1] == 0xbb && (uint8) start[2] == 0xbf)
+            i = 3;
+
+        while (i < numRead && CharacterFunctions::isWhitespace (start[i]))
+            ++i;
+
+        return i < numRead && start[i] == '<';
+    }
+
+    //==============================================================================
+    static constexpr int summaryCacheMagic = 0x31534554; // "TES1"
+
+    static File getSummaryCacheFile (Engine& e, const File& editFile, Time modificationTime)
+    {
+        auto hash = editFile.getFullPathName().hashCode64()
+                      ^ modificationTime.toMilliseconds() * 7919
+                      ^ (int64) summaryCacheMagic;
+
+        return TemporaryFileManager::getFileForCachedAnalysis (e, hash);
+    }
+
+    static void saveSummaryToCache (Engine& e, const EditSnapshot::Summary& summary)
+    {
+        MemoryOutputStream out;
+        out.writeInt (summaryCacheMagic);
+        out.writeBool (summary.isValid);
+        out.writeDouble (summary.length);
+        out.writeDouble (summary.markIn);
+        out.writeDouble (summary.markOut);
+        out.writeDouble (summary.tempo);
+        out.writeBool (summary.marksActive);
+        out.writeInt (summary.timeSigNumerator);
+        out.writeInt (summary.timeSigDenominator);
+        out.writeInt (summary.pitch);
+        out.writeInt (summary.numTracks);
+        out.writeInt (summary.numAudioTracks);
+        out.writeInt (summary.markers.size());
+
+        for (auto& m : summary.markers)
+        {
+            out.writeString (m.name);
+            out.writeInt ((int) m.colour.getARGB());
+            out.writeDouble (m.time.getStart());
+            out.writeDouble (m.time.getEnd());
+        }
+
+        // This is written again at the end so a truncated file can be spotted
+        out.writeInt (summaryCacheMagic);
+        getSummaryCacheFile (e, summary.file, summary.fileModificationTime).replaceWithData (out.getData(), out.getDataSize());
+    }
+
+    static bool loadSummaryFromCache (Engine& e, EditSnapshot::Summary& summary)
+    {
+        FileInputStream in (getSummaryCacheFile (e, summary.file, summary.fileModificationTime));
+
+        if (! in.openedOk() || in.readInt() != summaryCacheMagic)
+            return false;
+
+        summary.isValid             = in.readBool();
+        summary.length              = in.readDouble();
+        summary.markIn              = in.readDouble();
+        summary.markOut             = in.readDouble();
+        summary.tempo               = in.readDouble();
+        summary.marksActive         = in.readBool();
+        summary.timeSigNumerator    = in.readInt();
+        summary.timeSigDenominator  = in.readInt();
+        summary.pitch               = in.readInt();
+        summary.numTracks           = in.readInt();
+        summary.numAudioTracks      = in.readInt();
+
+        for (int i = in.readInt(); --i >= 0 && ! in.isExhausted();)
+        {
+            EditSnapshot::Marker m;
+            m.name = in.readString();
+            m.colour = Colour ((uint32) in.readInt());
+            auto start = in.readDouble();
+            m.time = { start, jmax (start, in.readDouble()) };
+            summary.markers.add (m);
+        }
+
+        return in.readInt() == summaryCacheMagic;
+    }
+
+    //==============================================================================
+    /** The Summaries that have been read, and the callbacks waiting for the ones being read.
+        This is only used on the message thread.
+    */
+    struct SummaryCache
+    {
+        std::map<String, EditSnapshot::Summary> summaries;
+        std::map<String, std::vector<std::function<void (const EditSnapshot::Summary&)>>> pendingCallbacks;
+    };
+
+    static SummaryCache& getSummaryCache()
+    {
+        static SummaryCache cache;
+        return cache;
+    }
+}
+
+EditSnapshot::Summary EditSnapshot::readSummary (const juce::File& file)
+{
+    CRASH_TRACER
+    using namespace EditSnapshotHelpers;
+
+    Summary summary;
+    summary.file = file;
+    summary.fileModificationTime = file.getLastModificationTime();
+
+    FileInputStream in (file);
+
+    if (! in.openedOk())
+        return summary;
+
+    SummaryBuilder builder (summary);
+    const bool isXml = looksLikeXml (in);
+    in.setPosition (0);
+
+    if (isXml)
+    {
+        ByteReader reader (in);
+        parseXml (reader, builder);
+    }
+    else
+    {
+        BufferedInputStream buffered (in, ByteReader::bufferSize);
+
+        if (! parseBinaryTree (buffered, Context::document, builder))
+            summary.isValid = false;
+    }
+
+    return summary;
+}
+
+void EditSnapshot::getSummaryAsync (Engine& engine, const juce::File& file,
+                                    std::function<void (const Summary&)> callback)
+{
+    TRACKTION_ASSERT_MESSAGE_THREAD
+    using namespace EditSnapshotHelpers;
+
+    auto& cache = getSummaryCache();
+    const auto path = file.getFullPathName();
+    const auto modificationTime = file.getLastModificationTime();
+
+    auto found = cache.summaries.find (path);
+
+    if (found != cache.summaries.end() && found->second.fileModificationTime == modificationTime)
+    {
+        callback (found->second);
+        return;
+    }
+
+    auto& pending = cache.pendingCallbacks[path];
+    pending.push_back (std::move (callback));
+
+    // Another request for this file is already being read, so this one waits for that
+    if (pending.size() > 1)
+        return;
+
+    using Priority = ThreadPoolJobWithProgress::Priority;
+    using Lane = ThreadPoolJobWithProgress::Lane;
+
+    engine.getBackgroundJobs().getPool (Priority::visible, Lane::io).addJob ([&engine, file, path, modificationTime]
+    {
+        Summary summary;
+        summary.file = file;
+        summary.fileModificationTime = modificationTime;
+
+        if (! loadSummaryFromCache (engine, summary))
+        {
+            summary = readSummary (file);
+
+            // If the file's changed whilst it was read, this is cached against the new time
+            if (summary.fileModificationTime == modificationTime)
+                saveSummaryToCache (engine, summary);
+        }
+
+        MessageManager::callAsync ([path, summary]
+        {
+            auto& c = getSummaryCache();
+            c.summaries[path] = summary;
+
+            auto callbacks = std::move (c.pendingCallbacks[path]);
+            c.pendingCallbacks.erase (path);
+
+            for (auto& cb : callbacks)
+                cb (summary);
+        });
+    });
+}
+
 }
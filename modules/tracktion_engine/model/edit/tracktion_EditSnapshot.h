@@ -31,6 +31,37 @@ public:
         EditTimeRange time;
     };
 
+    //==============================================================================
+    /** The header-level details of an Edit file, e.g. for listing it in a browser.
+        These are read without loading the whole Edit, so the length is estimated from
+        the end of the last clip rather than coming from the ProjectItem.
+    */
+    struct Summary
+    {
+        juce::File file;
+        juce::Time fileModificationTime;
+        bool isValid = false;
+
+        double length = 0.0, markIn = 0.0, markOut = 0.0, tempo = 0.0;
+        bool marksActive = false;
+        int timeSigNumerator = 4, timeSigDenominator = 4, pitch = 60;
+        int numTracks = 0, numAudioTracks = 0;
+        juce::Array<Marker> markers;
+    };
+
+    /** Reads the Summary of an Edit file with a streaming parse that skips over the
+        clip and plugin contents. This reads the file, so call it on a background thread.
+    */
+    static Summary readSummary (const juce::File&);
+
+    /** Calls back on the message thread with the Summary of an Edit file.
+        Summaries are cached in memory and on disk against the file's modification time. If
+        there's one in memory for the current version of the file it's passed to the callback
+        before this returns, otherwise it's loaded or read on a background thread. Make sure
+        anything the callback refers to still exists when it's called, e.g. with a SafePointer.
+    */
+    static void getSummaryAsync (Engine&, const juce::File&, std::function<void (const Summary&)>);
+
     //==============================================================================
     ~EditSnapshot();
 
@@ -136,13 +167,12 @@ private:
     //==============================================================================
     EditSnapshot (Engine&, ProjectItemID);
     void refreshFromProjectItem (ProjectItem::Ptr);
-    void refreshFromXml (const juce::XmlElement&, const juce::String&, double newLength);
     void refreshFromState();
     void clear();
-    void addEditClips (const juce::XmlElement& track);
-    void addClipSources (const juce::XmlElement& track);
-    void addMarkers (const juce::XmlElement& track);
-    void addSubTracksRecursively (const juce::XmlElement& parent, int& audioTrackNameNumber);
+    void addEditClips (const juce::ValueTree& track);
+    void addClipSources (const juce::ValueTree& track);
+    void addMarkers (const juce::ValueTree& track);
+    void addSubTracksRecursively (const juce::ValueTree& parent, int& audioTrackNameNumber);
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (EditSnapshot)
 };
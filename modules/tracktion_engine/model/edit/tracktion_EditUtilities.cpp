@@ -94,7 +94,12 @@ int getTotalNumTracks (const Edit& edit)
 
 Track* findTrackForID (const Edit& edit, EditItemID id)
 {
-    return findTrackForPredicate (edit, [id] (Track& t) { return t.itemID == id; });
+    // The cache also holds tracks that have been removed but are still referenced, e.g. by the undo history
+    if (auto t = edit.trackCache.findItem (id))
+        if (t->state.isAChildOf (edit.state))
+            return t;
+
+    return {};
 }
 
 Array<Track*> findTracksForIDs (const Edit& edit, Array<EditItemID> ids)
@@ -114,7 +119,11 @@ Array<Track*> findTracksForIDs (const Edit& edit, Array<EditItemID> ids)
 
 Track* findTrackForState (const Edit& edit, const juce::ValueTree& v)
 {
-    return findTrackForPredicate (edit, [&] (Track& t) { return t.state == v; });
+    if (auto t = findTrackForID (edit, EditItemID::fromID (v)))
+        if (t->state == v)
+            return t;
+
+    return {};
 }
 
 AudioTrack* getFirstAudioTrack (const Edit& edit)
@@ -533,41 +542,22 @@ juce::Array<ClipEffect*> getAllClipEffects (Edit& edit)
 //==============================================================================
 Clip* findClipForID (const Edit& edit, EditItemID clipID)
 {
-    Clip* result = nullptr;
-
-    edit.visitAllTracksRecursive ([&] (Track& t)
-                                  {
-                                      if (auto c = t.findClipForID (clipID))
-                                      {
-                                          result = c;
-                                          return false;
-                                      }
+    // The cache also holds clips that have been removed but are still referenced, so this
+    // checks that it's still directly on a track in this edit
+    if (auto c = edit.clipCache.findItem (clipID))
+        if (TrackList::isTrack (c->state.getParent()) && c->state.isAChildOf (edit.state))
+            return c;
 
-                                      return true;
-                                  });
-
-    return result;
+    return {};
 }
 
 Clip* findClipForState (const Edit& edit, const juce::ValueTree& v)
 {
-    Clip* result = nullptr;
+    if (auto c = findClipForID (edit, EditItemID::fromID (v)))
+        if (c->state == v)
+            return c;
 
-    visitAllTrackItems (edit, [&] (TrackItem& t)
-                        {
-                            if (auto c = dynamic_cast<Clip*> (&t))
-                            {
-                                if (c->state == v)
-                                {
-                                    result = c;
-                                    return false;
-                                }
-                            }
-
-                            return true;
-                        });
-
-    return result;
+    return {};
 }
 
 bool containsClip (const Edit& edit, Clip* clip)
@@ -148,6 +148,51 @@ double GrooveTemplate::editTimeToGroovyTime (double editTime, float strength, Ed
     return edit.tempoSequence.beatsToTime (beats);
 }
 
+void GrooveTemplate::beatsTimesToGroovyTimes (double* beatsTimes, int numTimes, float strength) const
+{
+    if (numTimes <= 0)
+        return;
+
+    auto activeStrength = parameterized ? strength : 1.0f;
+
+    // The start offset and slope of each groove note, worked out as beatsTimeToGroovyTime does
+    struct NoteShape  { double halfLateness, length; };
+    std::vector<NoteShape> shapes ((size_t) numNotes);
+
+    for (int i = 0; i < numNotes; ++i)
+    {
+        const double lateness = latenesses[i] * activeStrength;
+        shapes[(size_t) i] = { 0.5f * lateness,
+                               1.0 + 0.5f * ((latenesses[(i + 1) % numNotes] * activeStrength) - lateness) };
+    }
+
+    for (int i = 0; i < numTimes; ++i)
+    {
+        auto& beatsTime = beatsTimes[i];
+
+        const double beatNum    = std::floor (beatsTime * notesPerBeat);
+        const double offset     = notesPerBeat * (beatsTime - (beatNum / notesPerBeat));
+        const int latenessIndex = roundToInt (beatNum) % numNotes;
+
+        // Negative times wrap differently so leave those to the single value version
+        if (latenessIndex < 0)
+        {
+            beatsTime = beatsTimeToGroovyTime (beatsTime, strength);
+            continue;
+        }
+
+        auto& shape = shapes[(size_t) latenessIndex];
+        beatsTime = ((beatNum + shape.halfLateness) + offset * shape.length) / notesPerBeat;
+    }
+}
+
+void GrooveTemplate::editTimesToGroovyTimes (double* editTimes, int numTimes, float strength, Edit& edit) const
+{
+    edit.tempoSequence.timeToBeats (editTimes, numTimes);
+    beatsTimesToGroovyTimes (editTimes, numTimes, strength);
+    edit.tempoSequence.beatsToTime (editTimes, numTimes);
+}
+
 bool GrooveTemplate::isEmpty() const
 {
     for (int i = latenesses.size(); --i >= 0;)
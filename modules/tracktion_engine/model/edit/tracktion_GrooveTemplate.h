@@ -36,6 +36,17 @@ public:
     /** Apply this groove to a time, in seconds */
     double editTimeToGroovyTime (double editTime, float strength, Edit& edit) const;
 
+    /** Applies this groove to a block of times in beats, replacing them in place.
+        This gives the same results as beatsTimeToGroovyTime but only works out the
+        lateness of each groove note once.
+    */
+    void beatsTimesToGroovyTimes (double* beatsTimes, int numTimes, float strength) const;
+
+    /** Applies this groove to a block of times in seconds, replacing them in place.
+        The tempo lookups are fastest when the times are in order.
+    */
+    void editTimesToGroovyTimes (double* editTimes, int numTimes, float strength, Edit& edit) const;
+
     //==============================================================================
     const juce::String& getName() const                     { return name; }
     void setName (const juce::String&);
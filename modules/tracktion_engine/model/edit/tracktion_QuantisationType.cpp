@@ -180,6 +180,15 @@ double QuantisationType::roundBeatToNearestNonZero (double beatNumber) const
     return t == 0 ? fractionOfBeat : t;
 }
 
+void QuantisationType::roundBeatsToNearest (double* beatNumbers, int numBeats) const
+{
+    if (typeIndex == 0)
+        return;
+
+    for (int i = 0; i < numBeats; ++i)
+        beatNumbers[i] = roundToBeat (beatNumbers[i], 0.5);
+}
+
 double QuantisationType::roundTo (double time, double adjustment, const Edit& edit) const
 {
     if (typeIndex == 0)
@@ -58,6 +58,9 @@ public:
     double roundBeatUp (double beatNumber) const;
     double roundBeatToNearestNonZero (double beatNumber) const;
 
+    /** Rounds a block of beat positions in place, giving the same results as roundBeatToNearest. */
+    void roundBeatsToNearest (double* beatNumbers, int numBeats) const;
+
     double roundToNearest (double time, const Edit& edit) const;
     double roundUp (double time, const Edit& edit) const;
 
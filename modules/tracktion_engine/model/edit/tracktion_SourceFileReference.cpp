@@ -52,10 +52,7 @@ juce::File SourceFileReference::findFileFromString (Edit& edit, const juce::Stri
         return {};
     }
 
-    if (edit.filePathResolver)
-        return edit.filePathResolver (sourceDescription);
-
-    return getEditFileFromProjectManager (edit).getChildFile (sourceDescription);
+    return edit.getSourceFileCache().resolve (sourceDescription);
 }
 
 juce::File SourceFileReference::getFile() const
@@ -88,6 +85,8 @@ ProjectItem::Ptr SourceFileReference::getSourceProjectItem() const
 
 void SourceFileReference::setToDirectFileReference (const juce::File& newFile, bool useRelativePath)
 {
+    // The file has often only just been created, e.g. by recording or rendering
+    edit.getSourceFileCache().refresh (newFile);
     source = findPathFromFile (edit, newFile, useRelativePath);
 }
 
@@ -159,4 +158,206 @@ void SourceFileReference::setToProjectFileReference (ProjectItemID newID)
         edit.restartPlayback();
 }
 
+//==============================================================================
+SourceFileCache::SourceFileCache (Edit& e)  : edit (e)
+{
+}
+
+SourceFileCache::~SourceFileCache()
+{
+}
+
+juce::File SourceFileCache::resolveUncached (const juce::String& source) const
+{
+    if (edit.filePathResolver)
+        return edit.filePathResolver (source);
+
+    return getEditFileFromProjectManager (edit).getChildFile (source);
+}
+
+juce::File SourceFileCache::resolve (const juce::String& source)
+{
+    jassert (! ProjectItemID (source).isValid());
+
+    {
+        const juce::ScopedLock sl (lock);
+        auto found = resolvedFiles.find (source);
+
+        if (found != resolvedFiles.end())
+            return found->second;
+    }
+
+    // The resolver is called without the lock held, as it may well take other locks
+    auto f = resolveUncached (source);
+
+    const juce::ScopedLock sl (lock);
+    resolvedFiles[source] = f;
+    return f;
+}
+
+bool SourceFileCache::exists (const juce::File& f)
+{
+    auto path = f.getFullPathName();
+
+    if (path.isEmpty())
+        return false;
+
+    {
+        const juce::ScopedLock sl (lock);
+        auto found = fileExists.find (path);
+
+        if (found != fileExists.end())
+            return found->second;
+    }
+
+    const bool doesExist = f.exists();
+
+    const juce::ScopedLock sl (lock);
+    fileExists[path] = doesExist;
+    return doesExist;
+}
+
+void SourceFileCache::prefetch()
+{
+    CRASH_TRACER
+    TRACKTION_ASSERT_MESSAGE_THREAD
+
+    juce::StringArray sources;
+
+    std::function<void (const juce::ValueTree&)> findSources = [&] (const juce::ValueTree& v)
+    {
+        if (Clip::isClipState (v) || v.hasType (IDs::TAKE))
+        {
+            auto s = v[IDs::source].toString();
+
+            if (s.isNotEmpty() && ! ProjectItemID (s).isValid())
+                sources.add (s);
+        }
+
+        for (const auto& child : v)
+            findSources (child);
+    };
+
+    findSources (edit.state);
+    sources.removeDuplicates (false);
+
+    // Resolving is quick, but the resolver may not be thread-safe so it's done here
+    juce::Array<juce::File> files;
+
+    for (auto& s : sources)
+    {
+        auto f = resolve (s);
+
+        if (f != juce::File())
+            files.addIfNotAlreadyThere (f);
+    }
+
+    {
+        const juce::ScopedLock sl (lock);
+        files.removeIf ([this] (const juce::File& f) { return fileExists.count (f.getFullPathName()) > 0; });
+    }
+
+    if (files.isEmpty())
+        return;
+
+    // Checking a file can block for a long time on a network drive, so these are done in parallel
+    juce::HeapBlock<bool> results ((size_t) files.size(), true);
+    std::atomic<int> numFinished { 0 };
+
+    {
+        juce::ThreadPool pool (juce::jlimit (1, files.size(), juce::SystemStats::getNumCpus()));
+
+        for (int i = 0; i < files.size(); ++i)
+        {
+            pool.addJob ([&, i]
+                         {
+                             results[i] = files.getReference (i).exists();
+                             ++numFinished;
+                         });
+        }
+
+        while (numFinished < files.size())
+            juce::Thread::sleep (1);
+    }
+
+    const juce::ScopedLock sl (lock);
+
+    for (int i = 0; i < files.size(); ++i)
+        fileExists[files.getReference (i).getFullPathName()] = results[i];
+}
+
+void SourceFileCache::refresh()
+{
+    const juce::ScopedLock sl (lock);
+    resolvedFiles.clear();
+    fileExists.clear();
+}
+
+void SourceFileCache::refresh (const juce::File& f)
+{
+    const juce::ScopedLock sl (lock);
+    fileExists.erase (f.getFullPathName());
+
+    for (auto i = resolvedFiles.begin(); i != resolvedFiles.end();)
+    {
+        if (i->second == f)
+            i = resolvedFiles.erase (i);
+        else
+            ++i;
+    }
+}
+
+//==============================================================================
+#if TRACKTION_UNIT_TESTS
+
+class SourceFileCacheTests : public juce::UnitTest
+{
+public:
+    SourceFileCacheTests() : juce::UnitTest ("SourceFileCache", "Tracktion") {}
+
+    void runTest() override
+    {
+        auto& engine = *Engine::getEngines()[0];
+        auto dir = juce::File::createTempFile ("SourceFileCacheTests");
+        dir.createDirectory();
+        int numResolves = 0;
+
+        Edit::Options options { engine, createEmptyEdit (engine), ProjectItemID::createNewID (0) };
+        options.filePathResolver = [&] (const juce::String& path) { ++numResolves; return dir.getChildFile (path); };
+        auto edit = std::make_unique<Edit> (options);
+        auto& cache = edit->getSourceFileCache();
+
+        beginTest ("Sources are only resolved once");
+        {
+            numResolves = 0;
+            expect (SourceFileReference::findFileFromString (*edit, "test.wav") == dir.getChildFile ("test.wav"));
+            expect (SourceFileReference::findFileFromString (*edit, "test.wav") == dir.getChildFile ("test.wav"));
+            expectEquals (numResolves, 1);
+
+            cache.refresh();
+            SourceFileReference::findFileFromString (*edit, "test.wav");
+            expectEquals (numResolves, 2);
+        }
+
+        beginTest ("Existence is remembered until refreshed");
+        {
+            auto f = dir.getChildFile ("test.wav");
+            expect (! cache.exists (f));
+
+            f.create();
+            expect (! cache.exists (f));
+
+            cache.refresh (f);
+            expect (cache.exists (f));
+        }
+
+        edit.reset();
+        dir.deleteRecursively();
+    }
+};
+
+static SourceFileCacheTests sourceFileCacheTests;
+
+#endif
+
 }
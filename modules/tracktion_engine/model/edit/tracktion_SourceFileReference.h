@@ -52,5 +52,54 @@ private:
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SourceFileReference)
 };
 
+//==============================================================================
+/**
+    Remembers the files that an Edit's source strings resolve to, and whether they exist,
+    so that looking up a clip's file doesn't call the Edit's filePathResolver and stat the
+    file system every time.
+
+    Project item IDs aren't cached here as the ProjectManager already keeps them.
+    When an Edit loads, prefetch() resolves all its clips' sources and checks that they exist
+    on a few threads at once, which is much quicker than one by one on slow or network drives.
+
+    Everything is forgotten whenever the AudioFileManager checks its files for changes, and
+    individual files are forgotten when it sees that they've changed. If the filePathResolver
+    or editFileRetriever are changed, or files are moved outside the engine, call refresh().
+*/
+class SourceFileCache
+{
+public:
+    SourceFileCache (Edit&);
+    ~SourceFileCache();
+
+    /** Returns the file that a source string, which mustn't be a project item ID, resolves to. */
+    juce::File resolve (const juce::String& source);
+
+    /** Returns true if a file exists, using the result of the last check if there's been one. */
+    bool exists (const juce::File&);
+
+    /** Resolves the sources of all the Edit's clips and checks whether their files exist,
+        checking the files in parallel. This should be called on the message thread.
+    */
+    void prefetch();
+
+    /** Forgets everything, so the next lookups go back to the resolver and the file system. */
+    void refresh();
+
+    /** Forgets whether a file exists and any sources that resolved to it. */
+    void refresh (const juce::File&);
+
+    Edit& edit;
+
+private:
+    juce::CriticalSection lock;
+    std::map<juce::String, juce::File> resolvedFiles;
+    std::map<juce::String, bool> fileExists;
+
+    juce::File resolveUncached (const juce::String&) const;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SourceFileCache)
+};
+
 
 } // namespace tracktion_engine
@@ -127,31 +127,108 @@ juce::uint32 TempoSequence::TempoSections::getChangeCount() const
     return changeCounter;
 }
 
-double TempoSequence::TempoSections::timeToBeats (double time) const
+template <typename GetStart>
+static int findTempoSection (const juce::Array<TempoSequence::SectionDetails>& tempos,
+                             double value, int hintIndex, GetStart getStart) noexcept
 {
-    for (int i = tempos.size(); --i > 0;)
+    const int numSections = tempos.size();
+
+    if (numSections <= 1)
+        return 0;
+
+    // The value's usually in or next to the last section, so step a few first
+    if (hintIndex >= 0)
     {
-        auto& it = tempos.getReference (i);
+        auto index = juce::jmin (hintIndex, numSections - 1);
 
-        if (it.startTime <= time)
-            return it.startBeatInEdit + (time - it.startTime) * it.beatsPerSecond;
+        for (int i = 0; i < 4; ++i)
+        {
+            if (index + 1 < numSections && ! (value < getStart (tempos.getReference (index + 1))))
+                ++index;
+            else if (index > 0 && value < getStart (tempos.getReference (index)))
+                --index;
+            else
+                return index;
+        }
     }
 
-    auto& it = tempos.getReference (0);
+    // The sections are in order so find the last one that starts before this value, or the first
+    auto section = std::upper_bound (tempos.begin() + 1, tempos.end(), value,
+                                     [&] (double v, const TempoSequence::SectionDetails& s) { return v < getStart (s); });
+
+    return (int) (section - tempos.begin()) - 1;
+}
+
+int TempoSequence::TempoSections::indexOfTime (double time, int hintIndex) const
+{
+    return findTempoSection (tempos, time, hintIndex, [] (const SectionDetails& s) { return s.startTime; });
+}
+
+int TempoSequence::TempoSections::indexOfBeat (double beats, int hintIndex) const
+{
+    return findTempoSection (tempos, beats, hintIndex, [] (const SectionDetails& s) { return s.startBeatInEdit; });
+}
+
+double TempoSequence::TempoSections::timeToBeats (double time) const
+{
+    auto& it = tempos.getReference (indexOfTime (time));
     return it.startBeatInEdit + (time - it.startTime) * it.beatsPerSecond;
 }
 
 double TempoSequence::TempoSections::beatsToTime (double beats) const
 {
-    for (int i = tempos.size(); --i > 0;)
-    {
-        auto& it = tempos.getReference(i);
+    auto& it = tempos.getReference (indexOfBeat (beats));
+    return it.startTime + it.secondsPerBeat * (beats - it.startBeatInEdit);
+}
 
-        if (beats - it.startBeatInEdit >= 0)
-            return it.startTime + it.secondsPerBeat * (beats - it.startBeatInEdit);
+void TempoSequence::TempoSections::timeToBeats (double* times, int numTimes) const
+{
+    Cursor cursor (*this);
+
+    for (int i = 0; i < numTimes; ++i)
+        times[i] = cursor.timeToBeats (times[i]);
+}
+
+void TempoSequence::TempoSections::beatsToTime (double* beats, int numBeats) const
+{
+    Cursor cursor (*this);
+
+    for (int i = 0; i < numBeats; ++i)
+        beats[i] = cursor.beatsToTime (beats[i]);
+}
+
+//==============================================================================
+TempoSequence::TempoSections::Cursor::Cursor (const TempoSections& s) noexcept
+    : sections (s), changeCount (s.getChangeCount())
+{
+}
+
+void TempoSequence::TempoSections::Cursor::checkForChanges() noexcept
+{
+    auto newChangeCount = sections.getChangeCount();
+
+    if (newChangeCount != changeCount)
+    {
+        changeCount = newChangeCount;
+        index = 0;
     }
+}
+
+double TempoSequence::TempoSections::Cursor::timeToBeats (double time) noexcept
+{
+    checkForChanges();
+    index = sections.indexOfTime (time, index);
+
+    auto& it = sections.getReference (index);
+    return it.startBeatInEdit + (time - it.startTime) * it.beatsPerSecond;
+}
 
-    auto& it = tempos.getReference(0);
+double TempoSequence::TempoSections::Cursor::beatsToTime (double beats) noexcept
+{
+    checkForChanges();
+    index = sections.indexOfBeat (beats, index);
+
+    auto& it = sections.getReference (index);
     return it.startTime + it.secondsPerBeat * (beats - it.startBeatInEdit);
 }
 
@@ -302,14 +379,12 @@ void TempoSequence::removeTempo (int index, bool remapEdit)
         if (getNumTempos() > 1)
         {
             EditTimecodeRemapperSnapshot snap;
-
-            if (remapEdit)
-                snap.savePreChangeState (edit);
+            const bool remapNow = remapEdit && prepareToRemapEdit (snap);
 
             jassert (ts->state.isAChildOf (state));
             state.removeChild (ts->state, getUndoManager());
 
-            if (remapEdit)
+            if (remapNow)
                 snap.remapEdit (edit);
         }
     }
@@ -318,16 +393,14 @@ void TempoSequence::removeTempo (int index, bool remapEdit)
 void TempoSequence::removeTemposBetween (EditTimeRange range, bool remapEdit)
 {
     EditTimecodeRemapperSnapshot snap;
-
-    if (remapEdit)
-        snap.savePreChangeState (edit);
+    const bool remapNow = remapEdit && prepareToRemapEdit (snap);
 
     for (int i = getNumTempos(); --i > 0;)
         if (auto ts = getTempo(i))
             if (range.contains (ts->getStartTime()))
                 removeTempo (i, false);
 
-    if (remapEdit)
+    if (remapNow)
         snap.remapEdit (edit);
 }
 
@@ -598,6 +671,24 @@ juce::Range<double> TempoSequence::timeToBeats (EditTimeRange range) const
              timeToBeats (range.getEnd()) };
 }
 
+void TempoSequence::timeToBeats (double* times, int numTimes) const
+{
+    updateTempoDataIfNeeded();
+    internalTempos.timeToBeats (times, numTimes);
+}
+
+void TempoSequence::beatsToTime (double* beats, int numBeats) const
+{
+    updateTempoDataIfNeeded();
+    internalTempos.beatsToTime (beats, numBeats);
+}
+
+juce::uint32 TempoSequence::getChangeCount() const
+{
+    updateTempoDataIfNeeded();
+    return internalTempos.getChangeCount();
+}
+
 double TempoSequence::beatsToTime (double beats) const
 {
     updateTempoDataIfNeeded();
@@ -891,10 +982,63 @@ void TempoSequence::updateTempoDataIfNeeded() const
 
 void TempoSequence::handleAsyncUpdate()
 {
-    edit.sendTempoOrPitchSequenceChangedUpdates();
+    if (isInChangeGesture())
+        clipsNeedTempoUpdate = true;
+    else
+        edit.sendTempoOrPitchSequenceChangedUpdates();
+
     changed();
 }
 
+//==============================================================================
+TempoSequence::ChangeGesture::ChangeGesture (TempoSequence& ts)
+    : sequence (ts)
+{
+    TRACKTION_ASSERT_MESSAGE_THREAD
+    ++sequence.numChangeGestures;
+}
+
+TempoSequence::ChangeGesture::~ChangeGesture()
+{
+    sequence.endChangeGesture();
+}
+
+bool TempoSequence::prepareToRemapEdit (EditTimecodeRemapperSnapshot& snap)
+{
+    if (isInChangeGesture())
+    {
+        // Only the positions from before the gesture's first change are needed
+        if (changeGestureSnapshot == nullptr)
+        {
+            changeGestureSnapshot = std::make_unique<EditTimecodeRemapperSnapshot>();
+            changeGestureSnapshot->savePreChangeState (edit);
+        }
+
+        return false;
+    }
+
+    snap.savePreChangeState (edit);
+    return true;
+}
+
+void TempoSequence::endChangeGesture()
+{
+    TRACKTION_ASSERT_MESSAGE_THREAD
+    jassert (numChangeGestures > 0);
+
+    if (--numChangeGestures > 0)
+        return;
+
+    if (auto snap = std::move (changeGestureSnapshot))
+        snap->remapEdit (edit);
+
+    if (clipsNeedTempoUpdate)
+    {
+        clipsNeedTempoUpdate = false;
+        triggerAsyncUpdate();
+    }
+}
+
 String TempoSequence::getSelectableDescription()
 {
     return TRANS("Tempo Curve");
@@ -958,23 +1102,7 @@ void TempoSequencePosition::setTime (double t)
 
     if (maxIndex >= 0)
     {
-        if (index > maxIndex)
-        {
-            index = maxIndex;
-            time = sequence.internalTempos.getReference (index).startTime;
-        }
-
-        if (t >= time)
-        {
-            while (index < maxIndex && sequence.internalTempos.getReference (index + 1).startTime <= t)
-                ++index;
-        }
-        else
-        {
-            while (index > 0 && sequence.internalTempos.getReference (index).startTime > t)
-                --index;
-        }
-
+        index = sequence.internalTempos.indexOfTime (t, juce::jmin (index, maxIndex));
         time = t;
     }
 }
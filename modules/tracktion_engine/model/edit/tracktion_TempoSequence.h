@@ -84,6 +84,25 @@ public:
     /** Removes a region in a sequence, shifting TempoSettings and TimeSigs. */
     void deleteRegion (EditTimeRange);
 
+    //==============================================================================
+    /** Whilst one of these exists, the Edit's clips and automation aren't remapped or told
+        about every tempo change. Instead, they're remapped from where they were before the
+        first change when the last one is deleted, e.g. so dragging a tempo only does it once.
+    */
+    struct ChangeGesture
+    {
+        ChangeGesture (TempoSequence&);
+        ~ChangeGesture();
+
+    private:
+        TempoSequence& sequence;
+
+        JUCE_DECLARE_NON_COPYABLE (ChangeGesture)
+    };
+
+    /** Returns true if a ChangeGesture is in progress. */
+    bool isInChangeGesture() const noexcept         { return numChangeGestures > 0; }
+
     //==============================================================================
     double timeToBeats (double time) const;
     juce::Range<double> timeToBeats (EditTimeRange timeRange) const;
@@ -104,6 +123,18 @@ public:
     double beatsToTime (double beats) const;
     EditTimeRange beatsToTime (juce::Range<double> beatsRange) const;
 
+    /** Converts a block of times to beats in place.
+        Each lookup starts from the tempo section of the previous one, so this is
+        quickest when the times are in order.
+    */
+    void timeToBeats (double* times, int numTimes) const;
+
+    /** Converts a block of beat positions to times in place.
+        Each lookup starts from the tempo section of the previous one, so this is
+        quickest when the beats are in order.
+    */
+    void beatsToTime (double* beats, int numBeats) const;
+
     //==============================================================================
     struct SectionDetails
     {
@@ -124,6 +155,38 @@ public:
         double timeToBeats (double time) const;
         double beatsToTime (double beats) const;
 
+        void timeToBeats (double* times, int numTimes) const;
+        void beatsToTime (double* beats, int numBeats) const;
+
+        /** Returns the index of the last section that starts at or before the given time or
+            beat, or 0 if they all start after it. If a hint is given, this starts looking
+            from there, which is quicker if it's the section that was found last time.
+        */
+        int indexOfTime (double time, int hintIndex = -1) const;
+        int indexOfBeat (double beats, int hintIndex = -1) const;
+
+        /** Converts a series of values that mostly move forwards, such as the events in a
+            sequence or successive playback blocks. It carries on from the section the last
+            value was in, so a conversion doesn't usually need to search, and it never
+            locks or allocates.
+            A change to the sections is picked up the next time it's used, but it mustn't
+            be used whilst they're being changed.
+        */
+        struct Cursor
+        {
+            Cursor (const TempoSections&) noexcept;
+
+            double timeToBeats (double time) noexcept;
+            double beatsToTime (double beats) noexcept;
+
+        private:
+            const TempoSections& sections;
+            juce::uint32 changeCount;
+            int index = 0;
+
+            void checkForChanges() noexcept;
+        };
+
         /** The only modifying operation */
         void swapWith (juce::Array<SectionDetails>& newTempos);
 
@@ -137,6 +200,11 @@ public:
 
     const TempoSections& getTempoSections() { return internalTempos; }
 
+    /** Returns a count that changes whenever the tempo data is recalculated, so it can be
+        used to check whether anything derived from it is out of date.
+    */
+    juce::uint32 getChangeCount() const;
+
     //==============================================================================
     juce::String getSelectableDescription() override;
 
@@ -161,10 +229,20 @@ private:
     friend class TempoSequencePosition;
     TempoSections internalTempos;
 
+    int numChangeGestures = 0;
+    std::unique_ptr<EditTimecodeRemapperSnapshot> changeGestureSnapshot;
+    bool clipsNeedTempoUpdate = false;
+
     //==============================================================================
     void updateTempoDataIfNeeded() const;
     void handleAsyncUpdate() override;
 
+    /** Saves the Edit's positions before a tempo change, returning false if a ChangeGesture
+        will do the remapping instead.
+    */
+    bool prepareToRemapEdit (EditTimecodeRemapperSnapshot&);
+    void endChangeGesture();
+
     TempoSetting::Ptr insertTempo (double beatNum, double bpm, float curve, juce::UndoManager*);
     TempoSetting::Ptr insertTempo (double time, juce::UndoManager*);
     TimeSigSetting::Ptr insertTimeSig (double time, juce::UndoManager*);
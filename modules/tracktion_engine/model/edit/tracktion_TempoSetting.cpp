@@ -65,9 +65,7 @@ void TempoSetting::set (double newStartBeat, double newBPM, float newCurve, bool
     if (newBPM != bpm || startBeatNumber != newStartBeat || curve != newCurve)
     {
         EditTimecodeRemapperSnapshot snap;
-
-        if (remapEditPositions)
-            snap.savePreChangeState (getEdit());
+        const bool remapNow = remapEditPositions && ownerSequence.prepareToRemapEdit (snap);
 
         bpm = newBPM;
         curve = newCurve;
@@ -75,7 +73,7 @@ void TempoSetting::set (double newStartBeat, double newBPM, float newCurve, bool
 
         changed();
 
-        if (remapEditPositions)
+        if (remapNow)
             snap.remapEdit (getEdit());
     }
 }
@@ -236,22 +236,75 @@ bool TracktionArchiveFile::extractFile (int index, const File& destDirectory, Fi
     return true;
 }
 
-bool TracktionArchiveFile::extractAll (const File& destDirectory, Array<File>& filesCreated)
+bool TracktionArchiveFile::extractAll (const File& destDirectory, Array<File>& filesCreated, int numThreads)
 {
+    return extractFiles (destDirectory, filesCreated, numThreads, [] { return false; }, nullptr);
+}
+
+bool TracktionArchiveFile::extractFiles (const File& destDirectory, Array<File>& filesCreated, int numThreads,
+                                         const std::function<bool()>& shouldStop, std::atomic<float>* progress)
+{
+    CRASH_TRACER
+
     if (! destDirectory.createDirectory())
         return false;
 
-    for (int i = 0; i < entries.size(); ++i)
+    const int numFiles = entries.size();
+
+    // Entries are extracted without their paths, so any with the same name must be
+    // extracted in order for the last one to win
     {
-        File fileCreated;
+        StringArray names;
 
-        if (! extractFile (i, destDirectory, fileCreated, false))
-            return false;
+        for (int i = 0; i < numFiles; ++i)
+            names.add (getOriginalFileName (i).toLowerCase());
+
+        names.removeDuplicates (false);
 
-        filesCreated.add (fileCreated);
+        if (names.size() != numFiles)
+            numThreads = 1;
     }
 
-    return true;
+    Array<File> results;
+    results.insertMultiple (0, {}, numFiles);
+    std::atomic<bool> failed { false };
+    std::atomic<int> numStarted { 0 }, numFinished { 0 };
+
+    {
+        ThreadPool pool (getNumThreadsToUse (numThreads, numFiles));
+
+        for (int i = 0; i < numFiles; ++i)
+        {
+            pool.addJob ([&, i]
+                         {
+                             // Jobs are started in order so stopping here matches a sequential extraction
+                             if (! failed && ! shouldStop())
+                             {
+                                 ++numStarted;
+                                 File fileCreated;
+
+                                 if (extractFile (i, destDirectory, fileCreated, false))
+                                     results.getReference (i) = fileCreated;
+                                 else
+                                     failed = true;
+                             }
+
+                             if (progress != nullptr)
+                                 *progress = (numFinished + 1) / (float) numFiles;
+
+                             ++numFinished;
+                         });
+        }
+
+        while (numFinished < numFiles)
+            Thread::sleep (5);
+    }
+
+    for (auto& f : results)
+        if (f.exists())
+            filesCreated.add (f);
+
+    return ! failed && numStarted == numFiles;
 }
 
 //==============================================================================
@@ -279,6 +332,23 @@ public:
         if (! destDir.createDirectory())
             return jobHasFinished;
 
+        // Asking about overwriting has to happen one file at a time
+        if (! warnAboutOverwrite)
+        {
+            ok = archive.extractFiles (destDir, filesCreated, 0, [this] { return shouldExit(); }, &progress);
+
+            if (shouldExit())
+            {
+                wasAborted = true;
+                ok = false;
+
+                for (auto& f : filesCreated)
+                    f.deleteFile();
+            }
+
+            return jobHasFinished;
+        }
+
         for (int i = 0; i < archive.getNumFiles(); ++i)
         {
             if (shouldExit())
@@ -315,7 +385,7 @@ public:
     File destDir;
     bool ok = false;
     bool& wasAborted;
-    float progress = 0;
+    std::atomic<float> progress { 0.0f };
     bool warnAboutOverwrite = false;
     Array<File>& filesCreated;
 };
@@ -331,178 +401,283 @@ bool TracktionArchiveFile::extractAllAsTask (const File& destDirectory, bool war
     return task.ok;
 }
 
-bool TracktionArchiveFile::addFile (const File& f, const File& rootDirectory, CompressionType compression)
+String TracktionArchiveFile::getNameInArchive (const File& f, const File& rootDirectory)
 {
-    String name;
-
     if (f.isAChildOf (rootDirectory))
-        name = f.getRelativePathFrom (rootDirectory)
+        return f.getRelativePathFrom (rootDirectory)
                 .replaceCharacter ('\\', '/');
-    else
-        name = f.getFileName();
 
-    return addFile (f, name, compression);
+    return f.getFileName();
+}
+
+int TracktionArchiveFile::getNumThreadsToUse (int numThreads, int numJobs)
+{
+    if (numThreads <= 0)
+        numThreads = SystemStats::getNumCpus();
+
+    return jlimit (1, jmax (1, numJobs), numThreads);
+}
+
+bool TracktionArchiveFile::addFile (const File& f, const File& rootDirectory, CompressionType compression)
+{
+    return addFile (f, getNameInArchive (f, rootDirectory), compression);
 }
 
 bool TracktionArchiveFile::addFile (const File& f, const String& filenameToUse, CompressionType compression)
+{
+    FileInputStream in (f);
+
+    if (! in.openedOk())
+        return false;
+
+    std::unique_ptr<IndexEntry> entry (new IndexEntry());
+    entry->originalName = filenameToUse;
+    entry->storedName = filenameToUse;
+
+    return addEntry (std::move (entry), f.getFileName(),
+                     [&] (OutputStream& out, IndexEntry& e) { return writeCompressedData (f, in, compression, out, e); });
+}
+
+bool TracktionArchiveFile::addFiles (const Array<File>& files, const File& rootDirectory,
+                                     CompressionType compression, int numThreads,
+                                     Array<File>* filesThatFailed)
+{
+    CRASH_TRACER
+
+    // Each file is compressed into its own temporary chunk, then they're appended in order
+    struct CompressedFile
+    {
+        std::unique_ptr<IndexEntry> entry;
+        std::unique_ptr<TemporaryFile> chunk;
+        bool ok = false;
+    };
+
+    OwnedArray<CompressedFile> compressedFiles;
+
+    for (auto& f : files)
+    {
+        auto c = compressedFiles.add (new CompressedFile());
+        c->entry.reset (new IndexEntry());
+        c->entry->originalName = getNameInArchive (f, rootDirectory);
+        c->entry->storedName = c->entry->originalName;
+        c->chunk = std::make_unique<TemporaryFile> (file);
+    }
+
+    {
+        ThreadPool pool (getNumThreadsToUse (numThreads, files.size()));
+        std::atomic<int> numFinished { 0 };
+
+        for (int i = 0; i < files.size(); ++i)
+        {
+            pool.addJob ([&, i]
+                         {
+                             FloatVectorOperations::disableDenormalisedNumberSupport();
+
+                             auto& c = *compressedFiles.getUnchecked (i);
+                             FileInputStream in (files.getReference (i));
+
+                             if (in.openedOk())
+                             {
+                                 FileOutputStream out (c.chunk->getFile());
+
+                                 c.ok = out.openedOk()
+                                         && writeCompressedData (files.getReference (i), in, compression, out, *c.entry);
+                             }
+
+                             ++numFinished;
+                         });
+        }
+
+        while (numFinished < files.size())
+            Thread::sleep (5);
+    }
+
+    bool allAdded = true;
+
+    for (int i = 0; i < files.size(); ++i)
+    {
+        auto& c = *compressedFiles.getUnchecked (i);
+        auto& f = files.getReference (i);
+        bool added = false;
+
+        if (c.ok)
+        {
+            FileInputStream in (c.chunk->getFile());
+
+            added = in.openedOk()
+                     && addEntry (std::move (c.entry), f.getFileName(),
+                                  [&] (OutputStream& out, IndexEntry&) { return out.writeFromInputStream (in, -1) == in.getTotalLength(); });
+        }
+
+        c.chunk = nullptr;
+
+        if (! added)
+        {
+            allAdded = false;
+
+            if (filesThatFailed != nullptr)
+                filesThatFailed->add (f);
+        }
+    }
+
+    return allAdded;
+}
+
+bool TracktionArchiveFile::addEntry (std::unique_ptr<IndexEntry> entry, const String& fileDescription,
+                                     const std::function<bool (OutputStream&, IndexEntry&)>& writeData)
+{
+    FileOutputStream out (file);
+
+    if (! out.openedOk())
+        return false;
+
+    if (! valid)
+    {
+        out.setPosition (0);
+        out.writeInt (getMagicNumber());
+        out.writeInt (int (indexOffset));
+        valid = true;
+    }
+
+    auto initialPosition = out.getPosition();
+
+    out.setPosition (indexOffset);
+    jassert (indexOffset < 2147483648);
+
+    if (indexOffset >= 2147483648)
+    {
+        TRACKTION_LOG_ERROR ("Archive too large when archiving file: " + fileDescription);
+        return false;
+    }
+
+    entry->offset = indexOffset;
+    entry->length = 0;
+
+    if (! writeData (out, *entry))
+    {
+        needToWriteIndex = true;
+        return false;
+    }
+
+    out.flush();
+
+    jassert (out.getPosition() > indexOffset);
+
+    entry->length = jmax (int64 (0), out.getPosition() - indexOffset);
+
+    jassert (indexOffset + entry->length < 2147483648);
+
+    if (indexOffset + entry->length >= 2147483648)
+    {
+        out.setPosition (initialPosition);
+        out.truncate();
+        TRACKTION_LOG_ERROR ("Archive too large when archiving file: " + fileDescription);
+        return false;
+    }
+
+    indexOffset += entry->length;
+    needToWriteIndex = true;
+
+    entries.add (entry.release());
+    return true;
+}
+
+bool TracktionArchiveFile::writeCompressedData (const File& f, InputStream& in, CompressionType compression,
+                                                OutputStream& out, IndexEntry& entry)
 {
     // don't risk using ogg or flac on small audio files
     if (compression != CompressionType::none && f.getSize() <= 16 * 1024)
         compression = CompressionType::zip;
 
-    FileInputStream in (f);
-    bool ok = false;
+    auto filenameRoot = entry.originalName.substring (0, entry.originalName.lastIndexOfChar ('.'));
 
-    if (in.openedOk())
+    switch (compression)
     {
-        FileOutputStream out (file);
+        case CompressionType::none:
+        {
+            out.writeFromInputStream (in, -1);
+            break;
+        }
 
-        if (out.openedOk())
+        case CompressionType::zip:
         {
-            if (! valid)
-            {
-                out.setPosition (0);
-                out.writeInt (getMagicNumber());
-                out.writeInt (int (indexOffset));
-                valid = true;
-            }
+            entry.storedName = filenameRoot + ".gz";
 
-            auto initialPosition = out.getPosition();
+            GZIPCompressorOutputStream deflater (&out, 9, false);
+            deflater.writeFromInputStream (in, -1);
+            break;
+        }
 
-            out.setPosition (indexOffset);
-            jassert (indexOffset < 2147483648);
+        case CompressionType::lossless:
+        {
+            AudioFile af (engine, f);
 
-            if (indexOffset >= 2147483648)
+            if (af.isOggFile() || af.isMp3File() || af.isFlacFile())
             {
-                TRACKTION_LOG_ERROR ("Archive too large when archiving file: " + f.getFileName());
-                return false;
+                out.writeFromInputStream (in, -1); // no point re-compressing these
             }
+            else if (! af.isValid() || af.getBitsPerSample() > 24)
+            {
+                // FLAC can't do higher than 24 bits or non-audio files so just have to zip it instead..
+                entry.storedName = filenameRoot + ".gz";
 
-            auto filenameRoot = filenameToUse.substring (0, filenameToUse.lastIndexOfChar ('.'));
-
-            std::unique_ptr<IndexEntry> entry (new IndexEntry());
-            entry->offset = indexOffset;
-            entry->length = 0;
-            entry->originalName = filenameToUse;
-            entry->storedName = filenameToUse;
-
-            switch (compression)
+                GZIPCompressorOutputStream deflater (&out, 9, false);
+                deflater.writeFromInputStream (in, -1);
+            }
+            else
             {
-                case CompressionType::none:
+                entry.storedName = filenameRoot + ".flac";
+
+                if (! AudioFileUtils::convertToFormat<FlacAudioFormat> (engine, f, out, 0, StringPairArray()))
                 {
-                    out.writeFromInputStream (in, -1);
-                    break;
+                    TRACKTION_LOG_ERROR ("Failed to add file to archive flac: " + f.getFileName());
+                    return false;
                 }
+            }
 
-                case CompressionType::zip:
-                {
-                    entry->storedName = filenameRoot + ".gz";
+            break;
+        }
 
-                    GZIPCompressorOutputStream deflater (&out, 9, false);
-                    deflater.writeFromInputStream (in, -1);
-                    break;
-                }
+        case CompressionType::lossyGoodQuality:
+        case CompressionType::lossyMediumQuality:
+        case CompressionType::lossyLowQuality:
+        {
+            entry.storedName = filenameRoot + ".ogg";
+            entry.originalName = entry.storedName;  // oggs get extracted as oggs, not named back to how they were
 
-                case CompressionType::lossless:
-                {
-                    AudioFile af (engine, f);
-
-                    if (af.isOggFile() || af.isMp3File() || af.isFlacFile())
-                    {
-                        out.writeFromInputStream (in, -1); // no point re-compressing these
-                    }
-                    else
-                    {
-                        if (af.getBitsPerSample() > 24)
-                        {
-                            // FLAC can't do higher than 24 bits so just have to zip it instead..
-                            entry->storedName = filenameRoot + ".gz";
-
-                            GZIPCompressorOutputStream deflater (&out, 9, false);
-                            deflater.writeFromInputStream (in, -1);
-                        }
-                        else
-                        {
-                            entry->storedName = filenameRoot + ".flac";
-
-                            if (! AudioFileUtils::convertToFormat<FlacAudioFormat> (engine, f, out, 0, StringPairArray()))
-                            {
-                                needToWriteIndex = true;
-                                TRACKTION_LOG_ERROR ("Failed to add file to archive flac: " + f.getFileName());
-                                return false;
-                            }
-                        }
-                    }
-
-                    break;
-                }
+            auto quality = getOggQuality (compression);
+            AudioFile af (engine, f);
 
-                case CompressionType::lossyGoodQuality:
-                case CompressionType::lossyMediumQuality:
-                case CompressionType::lossyLowQuality:
-                {
-                    entry->storedName = filenameRoot + ".ogg";
-                    entry->originalName = entry->storedName;  // oggs get extracted as oggs, not named back to how they were
-
-                    auto quality = getOggQuality (compression);
-                    AudioFile af (engine, f);
-
-                    if (! isWorthConvertingToOgg (af, quality))
-                    {
-                        FileInputStream fin (af.getFile());
-
-                        if (! fin.openedOk())
-                        {
-                            needToWriteIndex = true;
-                            TRACKTION_LOG_ERROR ("Failed to add file to archive: " + f.getFileName());
-                            return false;
-                        }
-
-                        out.writeFromInputStream (fin, -1);
-                    }
-                    else if (! AudioFileUtils::convertToFormat<OggVorbisAudioFormat> (engine, f, out, quality, StringPairArray()))
-                    {
-                        needToWriteIndex = true;
-                        TRACKTION_LOG_ERROR ("Failed to add file to archive ogg: " + f.getFileName());
-                        return false;
-                    }
-
-                    break;
-                }
+            if (! isWorthConvertingToOgg (af, quality))
+            {
+                FileInputStream fin (af.getFile());
 
-                default:
+                if (! fin.openedOk())
                 {
-                    TRACKTION_LOG_ERROR ("Unknown compression type when archiving file: " + f.getFileName());
-                    jassertfalse;
-                    break;
+                    TRACKTION_LOG_ERROR ("Failed to add file to archive: " + f.getFileName());
+                    return false;
                 }
-            }
 
-            out.flush();
-
-            jassert (out.getPosition() > indexOffset);
-
-            entry->length = jmax (int64 (0), out.getPosition() - indexOffset);
-
-            jassert (indexOffset + entry->length < 2147483648);
-
-            if (indexOffset + entry->length >= 2147483648)
+                out.writeFromInputStream (fin, -1);
+            }
+            else if (! AudioFileUtils::convertToFormat<OggVorbisAudioFormat> (engine, f, out, quality, StringPairArray()))
             {
-                out.setPosition (initialPosition);
-                out.truncate();
-                TRACKTION_LOG_ERROR ("Archive too large when archiving file: " + f.getFileName());
+                TRACKTION_LOG_ERROR ("Failed to add file to archive ogg: " + f.getFileName());
                 return false;
             }
 
-            indexOffset += entry->length;
-            needToWriteIndex = true;
-            ok = true;
+            break;
+        }
 
-            entries.add (entry.release());
+        default:
+        {
+            TRACKTION_LOG_ERROR ("Unknown compression type when archiving file: " + f.getFileName());
+            jassertfalse;
+            break;
         }
     }
 
-    return ok;
+    return true;
 }
 
 void TracktionArchiveFile::addFileInfo (const String& filename, const String& itemName, const String& itemValue)
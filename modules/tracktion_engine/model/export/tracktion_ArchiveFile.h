@@ -43,8 +43,13 @@ public:
 
     bool extractFile (int index, const juce::File& destDirectory,
                       juce::File& fileCreated, bool askBeforeOverwriting);
+    /** Extracts all the files, decompressing them in parallel on up to numThreads
+        threads, or one per CPU if this is 0. Each item is stored independently so
+        they can be extracted in any order.
+    */
     bool extractAll (const juce::File& destDirectory,
-                     juce::Array<juce::File>& filesCreated);
+                     juce::Array<juce::File>& filesCreated,
+                     int numThreads = 0);
     bool extractAllAsTask (const juce::File& destDirectory,
                            bool warnAboutOverwrite,
                            juce::Array<juce::File>& filesCreated,
@@ -53,6 +58,15 @@ public:
     bool addFile (const juce::File&, const juce::File& rootDirectory, CompressionType);
     bool addFile (const juce::File&, const juce::String& filenameToUse, CompressionType);
 
+    /** Adds a set of files, compressing them in parallel on up to numThreads threads,
+        or one per CPU if this is 0. The files are stored in the order given.
+        Any that can't be added are skipped and added to filesThatFailed if it's supplied.
+        Returns true if all the files were added.
+    */
+    bool addFiles (const juce::Array<juce::File>&, const juce::File& rootDirectory,
+                   CompressionType, int numThreads = 0,
+                   juce::Array<juce::File>* filesThatFailed = nullptr);
+
     void addFileInfo (const juce::String& filename,
                       const juce::String& itemName,
                       const juce::String& itemValue);
@@ -90,6 +104,19 @@ private:
     juce::OwnedArray<IndexEntry> entries;
     void readIndex();
 
+    bool addEntry (std::unique_ptr<IndexEntry>, const juce::String& fileDescription,
+                   const std::function<bool (juce::OutputStream&, IndexEntry&)>& writeData);
+    bool writeCompressedData (const juce::File&, juce::InputStream&, CompressionType,
+                              juce::OutputStream&, IndexEntry&);
+    bool extractFiles (const juce::File& destDirectory, juce::Array<juce::File>& filesCreated,
+                       int numThreads, const std::function<bool()>& shouldStop,
+                       std::atomic<float>* progress);
+
+    friend class ExtractionTask;
+
+    static juce::String getNameInArchive (const juce::File&, const juce::File& rootDirectory);
+    static int getNumThreadsToUse (int numThreads, int numJobs);
+
     static int getOggQuality (CompressionType);
     static int getMagicNumber();
 
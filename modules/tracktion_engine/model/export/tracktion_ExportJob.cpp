@@ -151,6 +151,15 @@ void ExportJob::copyProjectFilesToTempDir()
 }
 
 //==============================================================================
+/** A section of a source file that's being copied to a new file. */
+struct ExportJob::Excerpt
+{
+    ProjectItem::Ptr source, newItem;
+    File sourceFile, destFile;
+    double start = 0.0, length = 0.0;
+    bool isWave = false, isEdit = false, succeeded = false;
+};
+
 void ExportJob::copyEditFilesToTempDir()
 {
     jassert (edit != nullptr);
@@ -184,18 +193,79 @@ void ExportJob::copyEditFilesToTempDir()
         for (auto& i : exportable->getReferencedItems())
             refList.add (i);
 
-    int numThingsCopied = 0;
-    const int totalThingsToCopy = refList.getTotalNumThingsToExport();
+    // Work out which excerpts are needed first, each file is only created once however
+    // many clips use it. Then they can all be extracted at once
+    std::vector<Excerpt> excerpts;
+    std::map<juce::String, size_t> excerptForFile;
+
+    auto isExported = [this] (const ProjectItem::Ptr& item)
+    {
+        return item != nullptr && (includeLibraryFiles || ! item->getProject()->isLibraryProject());
+    };
 
     for (auto exportable : allExportables)
+    {
+        for (auto& ref : exportable->getReferencedItems())
+        {
+            double start = 0.0, length = 0.0;
+            auto newFilename = refList.getReassignedFileName (ref.itemID, ref.firstTimeUsed, start, length);
+
+            if (length <= 0.0 || newFilename.isEmpty() || excerptForFile.count (newFilename) > 0)
+                continue;
+
+            auto source = projectManager.getProjectItem (ref.itemID);
+            auto newFile = destDir.getChildFile (newFilename);
+
+            if (! isExported (source) || newFile.exists())
+                continue;
+
+            Excerpt excerpt;
+            excerpt.source = source;
+            excerpt.sourceFile = source->getSourceFile();
+            excerpt.destFile = newFile;
+            excerpt.isWave = source->isWave();
+            excerpt.isEdit = source->isEdit();
+            excerpt.start = start;
+            excerpt.length = length;
+
+            excerptForFile[newFilename] = excerpts.size();
+            excerpts.push_back (std::move (excerpt));
+        }
+    }
+
+    extractExcerpts (excerpts);
+
+    for (auto& excerpt : excerpts)
     {
         if (shouldExit())
             break;
 
-        for (auto ref : exportable->getReferencedItems())
+        if (! excerpt.succeeded)
         {
-            progress = ((archive != nullptr ? 0.5f : 1.0f) * numThingsCopied) / totalThingsToCopy;
+            failedFiles.add (excerpt.source->getFileName());
+            TRACKTION_LOG_ERROR ("Failed to copy file during edit archive: " + excerpt.destFile.getFullPathName());
+            continue;
+        }
+
+        excerpt.newItem = newProject->createNewItem (excerpt.destFile,
+                                                     excerpt.source->getType(),
+                                                     excerpt.source->getName(),
+                                                     excerpt.source->getDescription(),
+                                                     excerpt.source->getCategory(),
+                                                     true);
+
+        if (excerpt.newItem != nullptr)
+            excerpt.newItem->copyAllPropertiesFrom (*excerpt.source);
+    }
 
+    // Then point everything at the new files, with their start times moved to match
+    for (auto exportable : allExportables)
+    {
+        if (shouldExit())
+            break;
+
+        for (auto ref : exportable->getReferencedItems())
+        {
             if (shouldExit())
                 break;
 
@@ -205,46 +275,15 @@ void ExportJob::copyEditFilesToTempDir()
 
             if (length > 0.0 && newFilename.isNotEmpty())
             {
-                auto oldSourceMedia (projectManager.getProjectItem (ref.itemID));
-
-                if (oldSourceMedia != nullptr
-                     && (includeLibraryFiles || ! oldSourceMedia->getProject()->isLibraryProject()))
+                if (isExported (projectManager.getProjectItem (ref.itemID)))
                 {
                     ProjectItem::Ptr newSourceItem;
+                    auto found = excerptForFile.find (newFilename);
 
-                    // the file we're creating as a section of the whole thing
-                    auto newFile = destDir.getChildFile (newFilename);
-
-                    if (! newFile.exists())
-                    {
-                        File actualNewFile;
-
-                        if (! oldSourceMedia->copySectionToNewFile (newFile, actualNewFile, start, length))
-                        {
-                            failedFiles.add (oldSourceMedia->getFileName());
-                            TRACKTION_LOG_ERROR ("Failed to copy file during edit archive: " + newFile.getFullPathName());
-                        }
-                        else
-                        {
-                            newFile = actualNewFile;
-
-                            newSourceItem = newProject->createNewItem (newFile,
-                                                                       oldSourceMedia->getType(),
-                                                                       oldSourceMedia->getName(),
-                                                                       oldSourceMedia->getDescription(),
-                                                                       oldSourceMedia->getCategory(),
-                                                                       true);
-
-                            if (newSourceItem != nullptr)
-                                newSourceItem->copyAllPropertiesFrom (*oldSourceMedia);
-                        }
-
-                        ++numThingsCopied;
-                    }
+                    if (found != excerptForFile.end())
+                        newSourceItem = excerpts[found->second].newItem;
                     else
-                    {
-                        newSourceItem = newProject->getProjectItemForFile (newFile);
-                    }
+                        newSourceItem = newProject->getProjectItemForFile (destDir.getChildFile (newFilename));
 
                     auto newID = newSourceItem != nullptr ? newSourceItem->getID() : ProjectItemID();
 
@@ -265,6 +304,56 @@ void ExportJob::copyEditFilesToTempDir()
     callBlocking ([this] { EditFileOperations (*edit).save (true, true, false); });
 }
 
+void ExportJob::extractExcerpts (std::vector<Excerpt>& excerpts)
+{
+    CRASH_TRACER
+
+    if (excerpts.empty())
+        return;
+
+    auto& engine = srcProject->engine;
+    const int numExcerpts = (int) excerpts.size();
+    std::atomic<int> nextExcerpt { 0 }, numExtracted { 0 }, numThreadsFinished { 0 };
+
+    // Only the used sections are copied, whole files are only copied if all of them is used
+    auto extract = [&engine] (Excerpt& e)
+    {
+        if (e.isWave)
+            return AudioFileUtils::copySectionToNewFile (engine, e.sourceFile, e.destFile,
+                                                         EditTimeRange (e.start, e.start + e.length)) > 0;
+
+        if (e.isEdit)
+            return e.sourceFile.copyFileTo (e.destFile);
+
+        return false;
+    };
+
+    // Disks are usually the bottleneck so this doesn't use a thread per CPU
+    const int numThreads = jlimit (1, numExcerpts, jmin (4, SystemStats::getNumCpus()));
+    ThreadPool pool (numThreads);
+
+    for (int i = 0; i < numThreads; ++i)
+    {
+        pool.addJob ([&]
+        {
+            for (int index = nextExcerpt++; index < numExcerpts && ! shouldExit(); index = nextExcerpt++)
+            {
+                auto& e = excerpts[(size_t) index];
+                e.succeeded = extract (e);
+                ++numExtracted;
+            }
+
+            ++numThreadsFinished;
+        });
+    }
+
+    while (numThreadsFinished.load() < numThreads)
+    {
+        progress = (archive != nullptr ? 0.5f : 1.0f) * numExtracted.load() / (float) numExcerpts;
+        Thread::sleep (20);
+    }
+}
+
 //==============================================================================
 void ExportJob::createArchiveFromTempFiles()
 {
@@ -278,20 +367,31 @@ void ExportJob::createArchiveFromTempFiles()
 
         destDir.findChildFiles (filesForDeletion, File::findFiles, true);
 
-        for (int i = 0; i < filesForDeletion.size(); ++i)
+        Array<TracktionArchiveFile::CompressionType> compressions;
+
+        for (auto& f : filesForDeletion)
+            compressions.add (AudioFile (srcProject->engine, f).isValid() ? compressionType
+                                                                          : TracktionArchiveFile::CompressionType::zip);
+
+        // Files are compressed in parallel batches, small enough to keep the progress moving
+        const int batchSize = SystemStats::getNumCpus() * 2;
+
+        for (int i = 0; i < filesForDeletion.size();)
         {
             progress = 0.5f + 0.5f * i / filesForDeletion.size();
 
             if (shouldExit())
                 break;
 
-            auto compression = TracktionArchiveFile::CompressionType::zip;
-            const File f (filesForDeletion[i]);
+            Array<File> batch, filesThatFailed;
+            auto compression = compressions[i];
+
+            while (i < filesForDeletion.size() && batch.size() < batchSize && compressions[i] == compression)
+                batch.add (filesForDeletion[i++]);
 
-            if (AudioFile (srcProject->engine, f).isValid())
-                compression = compressionType;
+            archive->addFiles (batch, destDir, compression, 0, &filesThatFailed);
 
-            if (! archive->addFile (f, destDir, compression))
+            for (auto& f : filesThatFailed)
                 failedFiles.add (f.getFileName());
         }
 
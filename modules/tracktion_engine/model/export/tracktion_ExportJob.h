@@ -60,7 +60,10 @@ private:
     bool includeLibraryFiles = false;
     bool includeClips = false;
 
+    struct Excerpt;
+
     void copyEditFilesToTempDir();
+    void extractExcerpts (std::vector<Excerpt>&);
     void copyProjectFilesToTempDir();
     void createArchiveFromTempFiles();
 
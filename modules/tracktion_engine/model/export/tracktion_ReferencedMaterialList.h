@@ -121,7 +121,10 @@ public:
     }
 
     //==============================================================================
-    /** Represents the sections of a wave file that are being used. */
+    /** Represents the sections of a wave file that are being used.
+        The intervals are kept in order and any that overlap or touch are merged, so each
+        one becomes a single excerpt when exporting.
+    */
     struct IntervalList
     {
         IntervalList() {}
@@ -133,32 +136,28 @@ public:
 
         void addInterval (double start, double length)
         {
-            starts.add (start);
-            ends.add (start + length);
+            auto end = start + length;
 
-            // merge all the intervals
-            for (int i = getNumIntervals(); --i >= 0;)
-            {
-                double s1 = getStart(i);
-                double e1 = getEnd(i);
+            // Find the first interval that ends at or after this starts, then swallow
+            // all the ones that start before this ends
+            int first = 0;
 
-                for (int j = getNumIntervals(); --j > i;)
-                {
-                    const double s2 = getStart(j);
-                    const double e2 = getEnd(j);
+            while (first < starts.size() && ends.getUnchecked (first) < start)
+                ++first;
 
-                    if (e1 >= s2 && s1 <= e2)
-                    {
-                        s1 = juce::jmin (s1, s2);
-                        e1 = juce::jmax (e1, e2);
-                        starts.remove (j);
-                        ends.remove (j);
-                    }
-                }
+            int last = first;
 
-                starts.set (i, s1);
-                ends.set (i, e1);
+            while (last < starts.size() && starts.getUnchecked (last) <= end)
+            {
+                start = juce::jmin (start, starts.getUnchecked (last));
+                end = juce::jmax (end, ends.getUnchecked (last));
+                ++last;
             }
+
+            starts.removeRange (first, last - first);
+            ends.removeRange (first, last - first);
+            starts.insert (first, start);
+            ends.insert (first, end);
         }
 
     private:
@@ -261,7 +261,7 @@ void RenderManager::removeJobInternal (Job* j) noexcept
 
 void RenderManager::addJobToPool (Job* j) noexcept
 {
-    engine.getBackgroundJobs().addJob (j, false);
+    engine.getBackgroundJobs().addJob (j, false, ThreadPoolJobWithProgress::Priority::visible);
 }
 
 void RenderManager::deleteJob (Job* j)
@@ -291,7 +291,7 @@ Renderer::Parameters RenderOptions::getRenderParameters (Edit& edit, SelectionMa
     params.audioFormat              = getAudioFormat();
 
     params.bitDepth                 = bitDepth;
-    params.blockSizeForAudio        = edit.engine.getDeviceManager().getBlockSize();
+    params.blockSizeForAudio        = Renderer::getBlockSizeForRendering (edit.engine, realTime);
     params.sampleRateForAudio       = sampleRate;
     params.shouldNormalise          = normalise;
     params.trimSilenceAtEnds        = removeSilence;
@@ -378,7 +378,7 @@ Renderer::Parameters RenderOptions::getRenderParameters (EditClip& clip)
     params.audioFormat              = getAudioFormat();
 
     params.bitDepth                 = bitDepth;
-    params.blockSizeForAudio        = clip.edit.engine.getDeviceManager().getBlockSize();
+    params.blockSizeForAudio        = Renderer::getBlockSizeForRendering (clip.edit.engine, realTime);
     params.sampleRateForAudio       = sampleRate;
     params.shouldNormalise          = normalise;
     params.trimSilenceAtEnds        = removeSilence;
@@ -418,7 +418,7 @@ Renderer::Parameters RenderOptions::getRenderParameters (MidiClip& clip)
     params.audioFormat              = getAudioFormat();
 
     params.bitDepth                 = bitDepth;
-    params.blockSizeForAudio        = clip.edit.engine.getDeviceManager().getBlockSize();
+    params.blockSizeForAudio        = Renderer::getBlockSizeForRendering (clip.edit.engine, realTime);
     params.sampleRateForAudio       = sampleRate;
     params.endAllowance             = endAllowance;
     params.shouldNormalise          = normalise;
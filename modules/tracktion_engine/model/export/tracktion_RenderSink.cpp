@@ -0,0 +1,224 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+
+namespace tracktion_engine
+{
+
+CallbackRenderSink::CallbackRenderSink (Callback c)
+    : callback (std::move (c))
+{
+    jassert (callback);
+}
+
+bool CallbackRenderSink::pushBlock (const juce::AudioBuffer<float>& block, int numSamples, EditTimeRange editTime)
+{
+    return callback (block, numSamples, editTime);
+}
+
+//==============================================================================
+RingBufferRenderSink::RingBufferRenderSink (int capacityInSamples)
+    : capacity (jmax (1, capacityInSamples)),
+      // An AbstractFifo can hold one less than its size
+      fifo (capacity + 1)
+{
+}
+
+RingBufferRenderSink::~RingBufferRenderSink()
+{
+    close();
+}
+
+void RingBufferRenderSink::prepareToRender (int numChans, double newSampleRate, int maxBlockSize)
+{
+    // The render must be able to fit a whole block in the FIFO
+    jassert (maxBlockSize <= capacity);
+    ignoreUnused (maxBlockSize);
+
+    buffer.setSize (numChans, capacity + 1);
+    fifo.reset();
+    finished = false;
+    sampleRate = newSampleRate;
+
+    // Set this last as the reader checks it before reading
+    numChannels = numChans;
+}
+
+bool RingBufferRenderSink::pushBlock (const juce::AudioBuffer<float>& block, int numSamples, EditTimeRange)
+{
+    for (int numDone = 0; numDone < numSamples;)
+    {
+        if (closed)
+            return false;
+
+        auto numToWrite = jmin (numSamples - numDone, fifo.getFreeSpace());
+
+        if (numToWrite == 0)
+        {
+            spaceAvailable.wait (10);
+            continue;
+        }
+
+        int start1, size1, start2, size2;
+        fifo.prepareToWrite (numToWrite, start1, size1, start2, size2);
+
+        for (int i = jmin (block.getNumChannels(), buffer.getNumChannels()); --i >= 0;)
+        {
+            if (size1 > 0)
+                buffer.copyFrom (i, start1, block, i, numDone, size1);
+
+            if (size2 > 0)
+                buffer.copyFrom (i, start2, block, i, numDone + size1, size2);
+        }
+
+        fifo.finishedWrite (size1 + size2);
+        numDone += size1 + size2;
+    }
+
+    return ! closed;
+}
+
+void RingBufferRenderSink::renderFinished()
+{
+    finished = true;
+}
+
+int RingBufferRenderSink::read (juce::AudioBuffer<float>& dest, int startSample, int numSamples)
+{
+    if (numChannels == 0)
+        return 0;
+
+    int start1, size1, start2, size2;
+    fifo.prepareToRead (numSamples, start1, size1, start2, size2);
+
+    for (int i = jmin (dest.getNumChannels(), buffer.getNumChannels()); --i >= 0;)
+    {
+        if (size1 > 0)
+            dest.copyFrom (i, startSample, buffer, i, start1, size1);
+
+        if (size2 > 0)
+            dest.copyFrom (i, startSample + size1, buffer, i, start2, size2);
+    }
+
+    fifo.finishedRead (size1 + size2);
+    spaceAvailable.signal();
+
+    return size1 + size2;
+}
+
+int RingBufferRenderSink::getNumReady() const noexcept
+{
+    return fifo.getNumReady();
+}
+
+void RingBufferRenderSink::close()
+{
+    closed = true;
+    spaceAvailable.signal();
+}
+
+//==============================================================================
+#if TRACKTION_UNIT_TESTS
+
+class RingBufferRenderSinkTests : public juce::UnitTest
+{
+public:
+    RingBufferRenderSinkTests() : juce::UnitTest ("RingBufferRenderSink", "Tracktion") {}
+
+    void runTest() override
+    {
+        beginTest ("Blocks are read back in order");
+        {
+            RingBufferRenderSink sink (64);
+            sink.prepareToRender (2, 44100.0, 16);
+            expectEquals (sink.getNumChannels(), 2);
+
+            juce::AudioBuffer<float> block (2, 16), dest (2, 64);
+
+            for (int i = 0; i < 3; ++i)
+            {
+                fillBlock (block, i * 16);
+                expect (sink.pushBlock (block, 16, {}));
+            }
+
+            expectEquals (sink.getNumReady(), 48);
+            expectEquals (sink.read (dest, 0, 64), 48);
+
+            for (int i = 0; i < 48; ++i)
+                expectEquals (dest.getSample (1, i), (float) i);
+        }
+
+        beginTest ("A full buffer holds up the render until there's space");
+        {
+            RingBufferRenderSink sink (32);
+            sink.prepareToRender (1, 44100.0, 32);
+
+            juce::AudioBuffer<float> block (1, 32);
+            fillBlock (block, 0);
+            expect (sink.pushBlock (block, 32, {}));
+
+            std::atomic<bool> secondBlockPushed { false };
+
+            std::thread writer ([&]
+                                {
+                                    auto b = block;
+                                    fillBlock (b, 32);
+                                    sink.pushBlock (b, 32, {});
+                                    secondBlockPushed = true;
+                                });
+
+            juce::Thread::sleep (50);
+            expect (! secondBlockPushed);
+
+            juce::AudioBuffer<float> dest (1, 64);
+            int numRead = 0;
+
+            for (int i = 0; i < 500 && numRead < 64; ++i)
+            {
+                numRead += sink.read (dest, numRead, 64 - numRead);
+                juce::Thread::sleep (1);
+            }
+
+            writer.join();
+            expect (secondBlockPushed);
+            expectEquals (numRead, 64);
+
+            for (int i = 0; i < 64; ++i)
+                expectEquals (dest.getSample (0, i), (float) i);
+        }
+
+        beginTest ("Closing stops the render");
+        {
+            RingBufferRenderSink sink (16);
+            sink.prepareToRender (1, 44100.0, 16);
+
+            juce::AudioBuffer<float> block (1, 16);
+            block.clear();
+            expect (sink.pushBlock (block, 16, {}));
+
+            std::thread closer ([&] { juce::Thread::sleep (20); sink.close(); });
+            expect (! sink.pushBlock (block, 16, {}));
+            closer.join();
+        }
+    }
+
+    static void fillBlock (juce::AudioBuffer<float>& block, int firstValue)
+    {
+        for (int c = block.getNumChannels(); --c >= 0;)
+            for (int i = 0; i < block.getNumSamples(); ++i)
+                block.setSample (c, i, (float) (firstValue + i));
+    }
+};
+
+static RingBufferRenderSinkTests ringBufferRenderSinkTests;
+
+#endif
+
+} // namespace tracktion_engine
@@ -0,0 +1,122 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+
+namespace tracktion_engine
+{
+
+//==============================================================================
+/**
+    Receives the audio from a Renderer as each block is rendered, so renders can be
+    streamed somewhere other than a file.
+
+    Set Renderer::Parameters::sink to use one. The methods are called on whichever
+    thread is running the RenderTask.
+*/
+class RenderSink
+{
+public:
+    /** Destructor. */
+    virtual ~RenderSink() = default;
+
+    /** Called before the first block with the format the render will produce. */
+    virtual void prepareToRender (int numChannels, double sampleRate, int maxBlockSize) = 0;
+
+    /** Called with each block that's been rendered and the Edit time it covers.
+        This may block to apply backpressure to the render. Return false to stop the render.
+    */
+    virtual bool pushBlock (const juce::AudioBuffer<float>&, int numSamples, EditTimeRange editTime) = 0;
+
+    /** Called when the render has finished or been cancelled. */
+    virtual void renderFinished() {}
+};
+
+//==============================================================================
+/**
+    A RenderSink that calls a function with each block.
+*/
+class CallbackRenderSink   : public RenderSink
+{
+public:
+    using Callback = std::function<bool (const juce::AudioBuffer<float>&, int numSamples, EditTimeRange)>;
+
+    /** Creates a sink that passes each block to the callback. */
+    CallbackRenderSink (Callback);
+
+    void prepareToRender (int, double, int) override {}
+    bool pushBlock (const juce::AudioBuffer<float>&, int numSamples, EditTimeRange) override;
+
+private:
+    Callback callback;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CallbackRenderSink)
+};
+
+//==============================================================================
+/**
+    A RenderSink that writes into a FIFO which can be read by another thread, e.g. one
+    sending a live stream.
+
+    When the FIFO is full, the render waits until there's space for the block, so the
+    render never gets further ahead of the reader than the FIFO's capacity. Real-time
+    renders are paced by the clock, otherwise the reader sets the pace.
+*/
+class RingBufferRenderSink  : public RenderSink
+{
+public:
+    /** Creates a sink that can hold up to capacityInSamples ahead of the reader. */
+    RingBufferRenderSink (int capacityInSamples);
+
+    /** Destructor. */
+    ~RingBufferRenderSink() override;
+
+    //==============================================================================
+    /** Copies up to numSamples into the destination, returning the number read.
+        This doesn't block, so a reader that needs a fixed amount should wait until
+        getNumReady() is large enough.
+    */
+    int read (juce::AudioBuffer<float>& dest, int startSample, int numSamples);
+
+    /** Returns the number of samples that can be read. */
+    int getNumReady() const noexcept;
+
+    /** Returns the number of channels the render is writing. */
+    int getNumChannels() const noexcept             { return numChannels; }
+
+    /** Returns the sample rate the render is writing. */
+    double getSampleRate() const noexcept           { return sampleRate; }
+
+    /** Returns true once the render has finished and written all of its samples. */
+    bool hasFinished() const noexcept               { return finished; }
+
+    /** Stops the render at its next block and releases it if it's waiting for space. */
+    void close();
+
+    //==============================================================================
+    /** @internal */
+    void prepareToRender (int numChannels, double sampleRate, int maxBlockSize) override;
+    /** @internal */
+    bool pushBlock (const juce::AudioBuffer<float>&, int numSamples, EditTimeRange) override;
+    /** @internal */
+    void renderFinished() override;
+
+private:
+    const int capacity;
+    juce::AbstractFifo fifo;
+    juce::AudioBuffer<float> buffer;
+    juce::WaitableEvent spaceAvailable;
+    std::atomic<int> numChannels { 0 };
+    std::atomic<double> sampleRate { 0.0 };
+    std::atomic<bool> finished { false }, closed { false };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RingBufferRenderSink)
+};
+
+} // namespace tracktion_engine
@@ -0,0 +1,384 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+namespace RenderWorkerHelpers
+{
+    /** A 64-bit FNV-1a hash, which unlike the ValueTree hashes used elsewhere depends on the order of the data. */
+    static juce::int64 hashData (const void* data, size_t numBytes) noexcept
+    {
+        auto bytes = static_cast<const juce::uint8*> (data);
+        juce::uint64 hash = 0xcbf29ce484222325ull;
+
+        for (size_t i = 0; i < numBytes; ++i)
+        {
+            hash ^= bytes[i];
+            hash *= 0x100000001b3ull;
+        }
+
+        return (juce::int64) hash;
+    }
+}
+
+//==============================================================================
+RenderWorker::RenderWorker (Engine& e, const File& dir)
+    : engine (e), cacheDirectory (dir)
+{
+    cacheDirectory.createDirectory();
+}
+
+RenderWorker::~RenderWorker()
+{
+}
+
+//==============================================================================
+ValueTree RenderWorker::createRequest (const Renderer::Parameters& r)
+{
+    jassert (r.edit != nullptr);
+    jassert (r.stems.isEmpty() && ! r.separateTracks);
+    TRACKTION_ASSERT_MESSAGE_THREAD
+
+    r.edit->flushState();
+
+    Array<EditItemID> clipIDs;
+
+    for (auto c : r.allowedClips)
+        clipIDs.add (c->itemID);
+
+    ValueTree request (IDs::RENDERREQUEST);
+    request.setProperty (IDs::file, r.edit->editFileRetriever ? r.edit->editFileRetriever().getFullPathName() : String(), nullptr);
+    request.setProperty (IDs::renderTracks, r.tracksToDo.toString (16), nullptr);
+    request.setProperty (IDs::renderClips, EditItemID::listToString (clipIDs), nullptr);
+    request.setProperty (IDs::renderFormat, r.audioFormat != nullptr ? r.audioFormat->getFormatName() : String(), nullptr);
+    request.setProperty (IDs::renderBitDepth, r.bitDepth, nullptr);
+    request.setProperty (IDs::renderBlockSize, r.blockSizeForAudio, nullptr);
+    request.setProperty (IDs::renderSampleRate, r.sampleRateForAudio, nullptr);
+    request.setProperty (IDs::start, r.time.getStart(), nullptr);
+    request.setProperty (IDs::end, r.time.getEnd(), nullptr);
+    request.setProperty (IDs::renderEndAllowance, r.endAllowance, nullptr);
+    request.setProperty (IDs::renderCreateMidiFile, r.createMidiFile, nullptr);
+    request.setProperty (IDs::renderRemoveSilence, r.trimSilenceAtEnds, nullptr);
+    request.setProperty (IDs::renderNormalise, r.shouldNormalise, nullptr);
+    request.setProperty (IDs::renderAdjustBasedOnRMS, r.shouldNormaliseByRMS, nullptr);
+    request.setProperty (IDs::renderPeakLevelDb, r.normaliseToLevelDb, nullptr);
+    request.setProperty (IDs::renderCanRenderInMono, r.canRenderInMono, nullptr);
+    request.setProperty (IDs::renderMustRenderInMono, r.mustRenderInMono, nullptr);
+    request.setProperty (IDs::renderPlugins, r.usePlugins, nullptr);
+    request.setProperty (IDs::renderMasterPlugins, r.useMasterPlugins, nullptr);
+    request.setProperty (IDs::renderRealTime, r.realTimeRender, nullptr);
+    request.setProperty (IDs::renderDither, r.ditheringEnabled, nullptr);
+    request.setProperty (IDs::renderNoiseShaping, (int) r.noiseShaping, nullptr);
+    request.setProperty (IDs::renderAntiDenormalisationNoise, r.addAntiDenormalisationNoise, nullptr);
+    request.setProperty (IDs::renderNumThreads, r.numThreadsForRendering, nullptr);
+    request.setProperty (IDs::renderQualityIndex, r.quality, nullptr);
+
+    ValueTree metadata (IDs::metadata);
+
+    for (auto& key : r.metadata.getAllKeys())
+    {
+        ValueTree item (IDs::metadata);
+        item.setProperty (IDs::name, key, nullptr);
+        item.setProperty (IDs::value, r.metadata[key], nullptr);
+        metadata.addChild (item, -1, nullptr);
+    }
+
+    request.addChild (metadata, -1, nullptr);
+    request.addChild (r.edit->state.createCopy(), -1, nullptr);
+
+    return request;
+}
+
+juce::int64 RenderWorker::getRequestHash (const ValueTree& request)
+{
+    MemoryOutputStream out;
+    request.writeToStream (out);
+
+    return RenderWorkerHelpers::hashData (out.getData(), out.getDataSize());
+}
+
+Renderer::Parameters RenderWorker::getParametersFromRequest (Edit& edit, const ValueTree& request)
+{
+    Renderer::Parameters r (edit);
+
+    r.tracksToDo.parseString (request[IDs::renderTracks].toString(), 16);
+
+    for (auto id : EditItemID::parseStringList (request[IDs::renderClips].toString()))
+        if (auto c = findClipForID (edit, id))
+            r.allowedClips.add (c);
+
+    auto& formatManager = edit.engine.getAudioFileFormatManager();
+    r.audioFormat = formatManager.getNamedFormat (request[IDs::renderFormat].toString());
+
+    if (r.audioFormat == nullptr)
+        r.audioFormat = formatManager.getDefaultFormat();
+
+    r.bitDepth                      = request.getProperty (IDs::renderBitDepth, r.bitDepth);
+    r.blockSizeForAudio             = request.getProperty (IDs::renderBlockSize, r.blockSizeForAudio);
+    r.sampleRateForAudio            = request.getProperty (IDs::renderSampleRate, r.sampleRateForAudio);
+    r.time                          = { (double) request[IDs::start], (double) request[IDs::end] };
+    r.endAllowance                  = request[IDs::renderEndAllowance];
+    r.createMidiFile                = request[IDs::renderCreateMidiFile];
+    r.trimSilenceAtEnds             = request[IDs::renderRemoveSilence];
+    r.shouldNormalise               = request[IDs::renderNormalise];
+    r.shouldNormaliseByRMS          = request[IDs::renderAdjustBasedOnRMS];
+    r.normaliseToLevelDb            = request[IDs::renderPeakLevelDb];
+    r.canRenderInMono               = request.getProperty (IDs::renderCanRenderInMono, r.canRenderInMono);
+    r.mustRenderInMono              = request[IDs::renderMustRenderInMono];
+    r.usePlugins                    = request.getProperty (IDs::renderPlugins, r.usePlugins);
+    r.useMasterPlugins              = request[IDs::renderMasterPlugins];
+    r.realTimeRender                = request[IDs::renderRealTime];
+    r.ditheringEnabled              = request[IDs::renderDither];
+    r.noiseShaping                  = (Ditherer::NoiseShaping) (int) request.getProperty (IDs::renderNoiseShaping, (int) r.noiseShaping);
+    r.addAntiDenormalisationNoise   = request[IDs::renderAntiDenormalisationNoise];
+    r.numThreadsForRendering        = request[IDs::renderNumThreads];
+    r.quality                       = request[IDs::renderQualityIndex];
+
+    for (auto item : request.getChildWithName (IDs::metadata))
+        r.metadata.set (item[IDs::name].toString(), item[IDs::value].toString());
+
+    return r;
+}
+
+std::unique_ptr<Edit> RenderWorker::loadEditFromRequest (Engine& e, const ValueTree& request)
+{
+    auto editState = request.getChildWithName (IDs::EDIT).createCopy();
+
+    if (! editState.isValid())
+        return {};
+
+    auto id = ProjectItemID::fromProperty (editState, IDs::projectID);
+
+    if (! id.isValid())
+        id = ProjectItemID::createNewID (0);
+
+    const File editFile (request[IDs::file].toString());
+
+    Edit::Options options =
+    {
+        e,
+        editState,
+        id,
+
+        Edit::forRendering,
+        nullptr,
+        1,
+
+        [editFile] { return editFile; },
+        {}
+    };
+
+    return std::make_unique<Edit> (options);
+}
+
+bool RenderWorker::writeRequestToFile (const ValueTree& request, const File& file)
+{
+    TemporaryFile temp (file);
+
+    {
+        FileOutputStream out (temp.getFile());
+
+        if (! out.openedOk())
+            return false;
+
+        request.writeToStream (out);
+        out.flush();
+
+        if (out.getStatus().failed())
+            return false;
+    }
+
+    return temp.overwriteTargetFileWithTemporary();
+}
+
+ValueTree RenderWorker::readRequestFromFile (const File& file)
+{
+    FileInputStream in (file);
+
+    if (! in.openedOk())
+        return {};
+
+    auto request = ValueTree::readFromStream (in);
+
+    if (! request.hasType (IDs::RENDERREQUEST))
+        return {};
+
+    return request;
+}
+
+//==============================================================================
+File RenderWorker::getResultFile (const ValueTree& request) const
+{
+    String extension (".wav");
+
+    if (request[IDs::renderCreateMidiFile])
+        extension = ".mid";
+    else if (auto format = engine.getAudioFileFormatManager().getNamedFormat (request[IDs::renderFormat].toString()))
+        extension = format->getFileExtensions()[0];
+
+    return cacheDirectory.getChildFile ("render_" + String::toHexString (getRequestHash (request)))
+                         .withFileExtension (extension);
+}
+
+File RenderWorker::render (const ValueTree& request, String& errorMessage)
+{
+    CRASH_TRACER
+    TRACKTION_ASSERT_MESSAGE_THREAD
+
+    auto resultFile = getResultFile (request);
+
+    if (resultFile.existsAsFile())
+        return resultFile;
+
+    progress = 0.0f;
+    auto edit = loadEditFromRequest (engine, request);
+
+    if (edit == nullptr)
+    {
+        errorMessage = TRANS("The render request didn't contain an Edit");
+        return {};
+    }
+
+    auto r = getParametersFromRequest (*edit, request);
+
+    // Render to a temporary file so other workers never see a partial result
+    TemporaryFile tempFile (resultFile);
+    r.destFile = tempFile.getFile();
+
+    {
+        const Edit::ScopedRenderStatus srs (*edit, false);
+
+        const bool renderMidiFromClips = r.createMidiFile && Renderer::canRenderMidiFromClips (r);
+        auto node = renderMidiFromClips ? nullptr : Renderer::createRenderingAudioNode (r);
+
+        if (node == nullptr && ! renderMidiFromClips)
+        {
+            errorMessage = TRANS("Couldn't render, as the selected region was empty");
+            return {};
+        }
+
+        Renderer::RenderTask task (TRANS("Rendering"), r, node, progress, nullptr);
+
+        while (task.runJob() == ThreadPoolJob::jobNeedsRunningAgain)
+            if (shouldCancel)
+                task.signalJobShouldExit();
+
+        Renderer::turnOffAllPlugins (*edit);
+
+        if (shouldCancel)
+        {
+            errorMessage = TRANS("The render was cancelled");
+            return {};
+        }
+
+        if (task.errorMessage.isNotEmpty())
+        {
+            errorMessage = task.errorMessage;
+            return {};
+        }
+    }
+
+    if (! (tempFile.getFile().existsAsFile() && tempFile.overwriteTargetFileWithTemporary()))
+    {
+        errorMessage = TRANS("Couldn't write to target file");
+        return {};
+    }
+
+    return resultFile;
+}
+
+Result RenderWorker::renderRequestFile (const File& requestFile, const File& outputFile)
+{
+    auto request = readRequestFromFile (requestFile);
+
+    if (! request.isValid())
+        return Result::fail (TRANS("Couldn't read the render request"));
+
+    String errorMessage;
+    auto resultFile = render (request, errorMessage);
+
+    if (resultFile == File())
+        return Result::fail (errorMessage);
+
+    if (outputFile != resultFile && ! resultFile.copyFileTo (outputFile))
+        return Result::fail (TRANS("Couldn't write to target file"));
+
+    return Result::ok();
+}
+
+//==============================================================================
+//==============================================================================
+#if TRACKTION_UNIT_TESTS
+
+class RenderWorkerTests   : public juce::UnitTest
+{
+public:
+    RenderWorkerTests() : juce::UnitTest ("RenderWorker", "Tracktion") {}
+
+    void runTest() override
+    {
+        auto& engine = *Engine::getEngines().getFirst();
+        auto edit = Edit::createSingleTrackEdit (engine);
+
+        Renderer::Parameters r (*edit);
+        r.tracksToDo.setBit (0);
+        r.audioFormat = engine.getAudioFileFormatManager().getFlacFormat();
+        r.bitDepth = 24;
+        r.sampleRateForAudio = 48000.0;
+        r.time = { 1.0, 5.0 };
+        r.shouldNormalise = true;
+        r.normaliseToLevelDb = -1.0f;
+        r.metadata.set ("title", "Test");
+
+        beginTest ("Parameters survive a round trip through a request");
+        {
+            auto request = RenderWorker::createRequest (r);
+            auto loadedEdit = RenderWorker::loadEditFromRequest (engine, request);
+            expect (loadedEdit != nullptr);
+
+            auto p = RenderWorker::getParametersFromRequest (*loadedEdit, request);
+            expect (p.tracksToDo == r.tracksToDo);
+            expect (p.audioFormat == r.audioFormat);
+            expectEquals (p.bitDepth, r.bitDepth);
+            expectEquals (p.sampleRateForAudio, r.sampleRateForAudio);
+            expect (p.time == r.time);
+            expect (p.shouldNormalise);
+            expectEquals (p.normaliseToLevelDb, r.normaliseToLevelDb);
+            expectEquals (p.metadata["title"], String ("Test"));
+            expect (p.destFile == File());
+        }
+
+        beginTest ("Identical requests have the same hash");
+        {
+            auto hash = RenderWorker::getRequestHash (RenderWorker::createRequest (r));
+            expectEquals (RenderWorker::getRequestHash (RenderWorker::createRequest (r)), hash);
+
+            auto r2 = r;
+            r2.bitDepth = 16;
+            expect (RenderWorker::getRequestHash (RenderWorker::createRequest (r2)) != hash);
+        }
+
+        beginTest ("Requests can be written to files");
+        {
+            auto request = RenderWorker::createRequest (r);
+            TemporaryFile file;
+
+            expect (RenderWorker::writeRequestToFile (request, file.getFile()));
+            expect (RenderWorker::readRequestFromFile (file.getFile()).isEquivalentTo (request));
+        }
+    }
+};
+
+static RenderWorkerTests renderWorkerTests;
+
+#endif
+
+} // namespace tracktion_engine
@@ -0,0 +1,91 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+//==============================================================================
+/**
+    Renders Edits that have been serialised as render requests, so renders can be
+    handed off to other processes or machines e.g. a headless render farm.
+
+    A request holds a copy of the Edit's state and the Renderer::Parameters to render
+    it with, apart from the destination file, which is chosen by the worker. Results
+    are kept in a cache directory named after the request's hash, so identical requests
+    are only ever rendered once by workers that share the directory.
+
+    The Edit's media isn't included in the request so it needs to be reachable from
+    the workers, e.g. on shared storage, with relative paths resolved against the
+    original Edit file's location.
+
+    All the methods here must be called on the message thread. A worker process should
+    create its Engine with an EngineBehaviour that returns true from isHeadless(), so it
+    doesn't open any devices or control surfaces.
+*/
+class RenderWorker
+{
+public:
+    /** Creates a worker that keeps its results in the given directory. */
+    RenderWorker (Engine&, const juce::File& cacheDirectory);
+
+    /** Destructor. */
+    ~RenderWorker();
+
+    //==============================================================================
+    /** Creates a render request for a set of parameters, which must have an Edit.
+        Stems and separate track renders aren't supported.
+    */
+    static juce::ValueTree createRequest (const Renderer::Parameters&);
+
+    /** Returns a hash of a request, which will be the same for any identical renders. */
+    static juce::int64 getRequestHash (const juce::ValueTree& request);
+
+    /** Restores the parameters from a request for the Edit it's been loaded into.
+        The destFile will be empty.
+    */
+    static Renderer::Parameters getParametersFromRequest (Edit&, const juce::ValueTree& request);
+
+    /** Creates the Edit from a request, ready for rendering. */
+    static std::unique_ptr<Edit> loadEditFromRequest (Engine&, const juce::ValueTree& request);
+
+    /** Saves a request so it can be passed to another process. */
+    static bool writeRequestToFile (const juce::ValueTree& request, const juce::File&);
+
+    /** Loads a request written by writeRequestToFile, returning an invalid tree if it failed. */
+    static juce::ValueTree readRequestFromFile (const juce::File&);
+
+    //==============================================================================
+    /** Returns the file the result of a request will be cached in. */
+    juce::File getResultFile (const juce::ValueTree& request) const;
+
+    /** Renders a request or returns the cached result if it's already been rendered.
+        If the render fails this will return an empty File and set the errorMessage.
+    */
+    juce::File render (const juce::ValueTree& request, juce::String& errorMessage);
+
+    /** Renders a request from a file written by writeRequestToFile and copies the result
+        to the outputFile. This is the entry point for a headless worker process.
+    */
+    juce::Result renderRequestFile (const juce::File& requestFile, const juce::File& outputFile);
+
+    /** Can be set to cancel any render in progress. */
+    std::atomic<bool> shouldCancel { false };
+
+    /** The progress of the current render. */
+    std::atomic<float> progress { 0.0f };
+
+    Engine& engine;
+    const juce::File cacheDirectory;
+
+private:
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RenderWorker)
+};
+
+} // namespace tracktion_engine
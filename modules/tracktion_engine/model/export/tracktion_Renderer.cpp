@@ -28,29 +28,6 @@ static void resetFPU() noexcept
    #endif
 }
 
-//==============================================================================
-struct Ditherers
-{
-    Ditherers (int num, int bitDepth)
-    {
-        while (ditherers.size() < num)
-            ditherers.add ({});
-
-        for (auto& d : ditherers)
-            d.reset (bitDepth);
-    }
-
-    void apply (juce::AudioBuffer<float>& buffer, int numSamples)
-    {
-        auto numChannels = buffer.getNumChannels();
-
-        for (int i = 0; i < numChannels; ++i)
-            ditherers.getReference (i).process (buffer.getWritePointer (i), numSamples);
-    }
-
-    juce::Array<Ditherer> ditherers;
-};
-
 //==============================================================================
 static bool trackLoopsBackInto (const Array<Track*>& allTracks, AudioTrack& t, const BigInteger* tracksToCheck)
 {
@@ -102,6 +79,246 @@ static Plugin::Array findAllPlugins (AudioNode& node)
     return plugins;
 }
 
+//==============================================================================
+/** Passes its input straight through but keeps a copy of the last block, so the
+    stems in a multi-output render can each be written to their own file.
+*/
+struct StemTapAudioNode  : public SingleInputAudioNode
+{
+    StemTapAudioNode (AudioNode* source, int stem)
+        : SingleInputAudioNode (source), stemIndex (stem)
+    {
+    }
+
+    void prepareAudioNodeToPlay (const PlaybackInitialisationInfo& info) override
+    {
+        SingleInputAudioNode::prepareAudioNodeToPlay (info);
+        buffer.setSize (2, info.blockSizeSamples);
+        numSamplesTapped = 0;
+    }
+
+    void renderOver (const AudioRenderContext& rc) override
+    {
+        input->renderOver (rc);
+        numSamplesTapped = 0;
+
+        if (rc.destBuffer != nullptr)
+        {
+            numSamplesTapped = rc.bufferNumSamples;
+            buffer.setSize (rc.destBuffer->getNumChannels(), numSamplesTapped, false, false, true);
+
+            for (int i = buffer.getNumChannels(); --i >= 0;)
+                buffer.copyFrom (i, 0, *rc.destBuffer, i, rc.bufferStartSample, numSamplesTapped);
+        }
+    }
+
+    void renderAdding (const AudioRenderContext& rc) override
+    {
+        callRenderOver (rc);
+    }
+
+    /** Adds the last block that was rendered to a buffer. */
+    void addTo (juce::AudioBuffer<float>& dest, int numSamples) const
+    {
+        numSamples = jmin (numSamples, numSamplesTapped);
+
+        for (int i = jmin (dest.getNumChannels(), buffer.getNumChannels()); --i >= 0;)
+            dest.addFrom (i, 0, buffer, i, 0, numSamples);
+    }
+
+    const int stemIndex;
+
+private:
+    juce::AudioBuffer<float> buffer;
+    int numSamplesTapped = 0;
+};
+
+#if ENABLE_EXPERIMENTAL_TRACKTION_GRAPH
+//==============================================================================
+/** Renders a set of AudioNode trees concurrently on a tracktion_graph::MultiThreadedNodePlayer
+    and sums them, so the rest of the render can treat them as a single AudioNode.
+    Sidechains between the trees are ordered by the graph, but they mustn't be connected
+    in any other way, e.g. through aux sends.
+*/
+class MultiThreadedRenderAudioNode  : public AudioNode
+{
+public:
+    MultiThreadedRenderAudioNode (const Array<AudioNode*>& inputs, int numThreads, bool use64Bit, bool numaAware)
+        : inputProvider (std::make_shared<InputProvider>()), maxNumThreads (numThreads)
+    {
+        std::vector<std::unique_ptr<tracktion_graph::Node>> nodes;
+        std::map<int, Array<AudioNode*>> treeAudioNodes;
+        std::map<int, std::vector<AudioNodeWrapperNode*>> treeNodes;
+
+        for (auto n : inputs)
+        {
+            std::shared_ptr<AudioNode> audioNode (n);
+            auto wrapper = std::make_unique<AudioNodeWrapperNode> (audioNode, inputProvider);
+
+            // Each tree is its own wrapper
+            treeAudioNodes[audioNodes.size()].add (n);
+            treeNodes[audioNodes.size()].push_back (wrapper.get());
+
+            audioNodes.add (n);
+            nodes.push_back (std::move (wrapper));
+        }
+
+        orderSidechainsInGraph (treeAudioNodes, treeNodes, {});
+
+        auto summingNode = std::make_unique<tracktion_graph::SummingNode> (std::move (nodes));
+        summingNode->setDoubleProcessingPrecision (use64Bit);
+        player = std::make_unique<tracktion_graph::MultiThreadedNodePlayer> (std::move (summingNode));
+        player->setProcessingPrecision (use64Bit ? tracktion_graph::ProcessingPrecision::doublePrecision
+                                                 : tracktion_graph::ProcessingPrecision::singlePrecision);
+        player->setNumaAware (numaAware);
+    }
+
+    void getAudioNodeProperties (AudioNodeProperties& info) override
+    {
+        info.hasAudio = false;
+        info.hasMidi = false;
+        info.numberOfChannels = 0;
+
+        for (auto n : audioNodes)
+        {
+            AudioNodeProperties props;
+            n->getAudioNodeProperties (props);
+
+            info.hasAudio = info.hasAudio || props.hasAudio;
+            info.hasMidi = info.hasMidi || props.hasMidi;
+            info.numberOfChannels = jmax (info.numberOfChannels, props.numberOfChannels);
+        }
+    }
+
+    void visitNodes (const VisitorFn& v) override
+    {
+        for (auto n : audioNodes)
+            n->visitNodes (v);
+
+        v (*this);
+    }
+
+    bool purgeSubNodes (bool keepAudio, bool keepMidi) override
+    {
+        // The nodes can't be removed from the graph so they're all kept
+        bool anyLeft = false;
+
+        for (auto n : audioNodes)
+            if (n->purgeSubNodes (keepAudio, keepMidi))
+                anyLeft = true;
+
+        return anyLeft;
+    }
+
+    void prepareAudioNodeToPlay (const PlaybackInitialisationInfo& info) override
+    {
+        for (auto n : audioNodes)
+            n->prepareAudioNodeToPlay (info);
+
+        sampleRate = info.sampleRate;
+        player->setMaxNumThreads ((size_t) jmax (1, maxNumThreads));
+        player->prepareToPlay (sampleRate, info.blockSizeSamples);
+        midi.reserve (MidiMessageArray::defaultNumMessagesToReserve);
+    }
+
+    bool isReadyToRender() override
+    {
+        for (auto n : audioNodes)
+            if (! n->isReadyToRender())
+                return false;
+
+        return true;
+    }
+
+    void releaseAudioNodeResources() override
+    {
+        for (auto n : audioNodes)
+            n->releaseAudioNodeResources();
+    }
+
+    void prepareForNextBlock (const AudioRenderContext& rc) override
+    {
+        for (auto n : audioNodes)
+            n->prepareForNextBlock (rc);
+    }
+
+    void renderOver (const AudioRenderContext& rc) override
+    {
+        AudioRenderContext context (rc);
+        const auto startSample = (int64_t) llround (rc.streamTime.getStart() * sampleRate);
+        const juce::Range<int64_t> streamSampleRange (startSample, startSample + rc.bufferNumSamples);
+
+        inputProvider->setContext (&context);
+        inputProvider->setStreamSampleRange (streamSampleRange);
+
+        constexpr int maxNumChannels = 64;
+        float* channels[maxNumChannels] = {};
+        int numChannels = 0;
+
+        if (rc.destBuffer != nullptr)
+        {
+            numChannels = jmin (rc.destBuffer->getNumChannels(), maxNumChannels);
+
+            for (int i = 0; i < numChannels; ++i)
+                channels[i] = rc.destBuffer->getWritePointer (i, rc.bufferStartSample);
+        }
+
+        midi.clear();
+        player->process ({ streamSampleRange, { juce::dsp::AudioBlock<float> (channels, (size_t) numChannels, (size_t) rc.bufferNumSamples), midi } });
+
+        if (rc.bufferForMidiMessages != nullptr)
+        {
+            rc.bufferForMidiMessages->clear();
+            rc.bufferForMidiMessages->mergeFromWithOffset (midi, rc.midiBufferOffset);
+        }
+
+        inputProvider->setContext (nullptr);
+    }
+
+    void renderAdding (const AudioRenderContext& rc) override
+    {
+        callRenderOver (rc);
+    }
+
+    /** Returns true if the tree's output can be rendered concurrently with other tracks'. */
+    static bool canBeRenderedConcurrently (AudioNode& node)
+    {
+        bool hasConnections = false;
+
+        node.visitNodes ([&hasConnections] (AudioNode& n)
+                         {
+                             auto plugin = n.getPlugin().get();
+
+                             if (dynamic_cast<AuxSendPlugin*> (plugin) != nullptr
+                                  || dynamic_cast<AuxReturnPlugin*> (plugin) != nullptr)
+                                 hasConnections = true;
+                         });
+
+        return ! hasConnections;
+    }
+
+private:
+    std::shared_ptr<InputProvider> inputProvider;
+    std::unique_ptr<tracktion_graph::MultiThreadedNodePlayer> player;
+    Array<AudioNode*> audioNodes;
+    MidiMessageArray midi;
+    const int maxNumThreads;
+    double sampleRate = 44100.0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MultiThreadedRenderAudioNode)
+};
+#endif
+
+static AudioNode* addStemTapIfNeeded (AudioNode* node, int trackIndex, const Array<Renderer::Parameters::Stem>* stems)
+{
+    if (stems != nullptr && node != nullptr)
+        for (int i = 0; i < stems->size(); ++i)
+            if (stems->getReference (i).tracksToDo[trackIndex])
+                return new StemTapAudioNode (node, i);
+
+    return node;
+}
+
 //==============================================================================
 Renderer::RenderTask::RenderTask (const String& taskDescription, const Renderer::Parameters& rp, AudioNode* n)
    : ThreadPoolJobWithProgress (taskDescription),
@@ -134,6 +351,63 @@ ThreadPoolJob::JobStatus Renderer::RenderTask::runJob()
     return jobHasFinished;
 }
 
+//==============================================================================
+/** Measures the peak, RMS and non-silent section of a render as its blocks are written,
+    so none of these need another pass over the file afterwards.
+*/
+struct RenderStatistics
+{
+    void addBlock (const juce::AudioBuffer<float>& buffer, int numSamples)
+    {
+        const auto numChans = buffer.getNumChannels();
+        peak = jmax (peak, buffer.getMagnitude (0, numSamples));
+
+        for (int i = numChans; --i >= 0;)
+        {
+            rmsTotal += buffer.getRMSLevel (i, 0, numSamples);
+            ++rmsNumSamps;
+        }
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            float mag = 0.0f;
+
+            for (int chan = numChans; --chan >= 0;)
+                mag = jmax (mag, std::abs (buffer.getSample (chan, i)));
+
+            if (mag > 0.0001f)
+                ++numNonZeroSamps;
+
+            if (mag > silenceLevel)
+            {
+                if (firstNonSilentSample < 0)
+                    firstNonSilentSample = numSamplesDone + i;
+
+                lastNonSilentSample = numSamplesDone + i;
+            }
+        }
+
+        numSamplesDone += numSamples;
+    }
+
+    float getRMS() const noexcept       { return rmsNumSamps > 0 ? (float) (rmsTotal / rmsNumSamps) : 0.0f; }
+
+    /** Returns the range of samples above the silence level, or an empty range if it was all silent. */
+    juce::Range<int64> getNonSilentRange() const noexcept
+    {
+        if (firstNonSilentSample < 0)
+            return {};
+
+        return { firstNonSilentSample, lastNonSilentSample + 1 };
+    }
+
+    float peak = 0.0001f;
+    double rmsTotal = 0;
+    int64 rmsNumSamps = 0, numNonZeroSamps = 0, numSamplesDone = 0;
+    int64 firstNonSilentSample = -1, lastNonSilentSample = -1;
+    const float silenceLevel = dbToGain (-70.0f);
+};
+
 //==============================================================================
 /** Holds the state of an audio render procedure so it can be rendered in blocks. */
 struct Renderer::RenderTask::RendererContext
@@ -144,14 +418,13 @@ struct Renderer::RenderTask::RendererContext
           r (p), originalParams (p),
           node (n),
           status (Result::ok()),
-          ditherers (256, r.bitDepth),
           sourceToUpdate (sourceToUpdate_)
     {
         CRASH_TRACER
         TRACKTION_ASSERT_MESSAGE_THREAD
         jassert (r.engine != nullptr);
         jassert (r.edit != nullptr);
-        jassert (r.time.getLength() > 0.0);
+        jassert (r.time.getLength() > 0.0 || r.renderContinuously);
 
         if (r.edit->getTransport().isPlayContextActive())
         {
@@ -159,6 +432,9 @@ struct Renderer::RenderTask::RendererContext
             TRACKTION_LOG_ERROR("Rendering whilst attached to audio device");
         }
 
+        // A continuous render never finishes writing, so there's no second pass
+        jassert (! r.renderContinuously || ! (r.shouldNormalise || r.trimSilenceAtEnds || r.shouldNormaliseByRMS || ! r.stems.isEmpty()));
+
         if (r.shouldNormalise || r.trimSilenceAtEnds || r.shouldNormaliseByRMS)
         {
             needsToNormaliseAndTrim = true;
@@ -193,19 +469,52 @@ struct Renderer::RenderTask::RendererContext
 
         AudioFileUtils::addBWAVStartToMetadata (r.metadata, (int64) (r.time.getStart() * r.sampleRateForAudio));
 
-        writer = std::make_unique<AudioFileWriter> (AudioFile (*originalParams.engine, r.destFile),
-                                                    r.audioFormat, numOutputChans, r.sampleRateForAudio,
-                                                    r.bitDepth, r.metadata, r.quality);
+        if (r.stems.isEmpty())
+        {
+            writer = std::make_unique<AudioFileWriter> (AudioFile (*originalParams.engine, r.destFile),
+                                                        r.audioFormat, numOutputChans, r.sampleRateForAudio,
+                                                        r.bitDepth, r.metadata, r.quality);
 
-        if (r.destFile != File() && ! writer->isOpen())
+            if (r.destFile != File() && ! writer->isOpen())
+            {
+                status = Result::fail (TRANS("Couldn't write to target file"));
+                return;
+            }
+        }
+        else
         {
-            status = Result::fail (TRANS("Couldn't write to target file"));
-            return;
+            // Normalising and trimming need a second pass over each file
+            jassert (! needsToNormaliseAndTrim);
+
+            node->visitNodes ([this] (AudioNode& n)
+                              {
+                                  if (auto tap = dynamic_cast<StemTapAudioNode*> (&n))
+                                      stemTaps.add (tap);
+                              });
+
+            for (auto& stem : r.stems)
+            {
+                auto w = stemWriters.add (new AudioFileWriter (AudioFile (*originalParams.engine, stem.destFile),
+                                                               r.audioFormat, numOutputChans, r.sampleRateForAudio,
+                                                               r.bitDepth, r.metadata, r.quality));
+
+                if (! w->isOpen())
+                {
+                    status = Result::fail (TRANS("Couldn't write to target file"));
+                    return;
+                }
+
+                stemDitherers.add (new Ditherer())->reset (numOutputChans, r.bitDepth, r.noiseShaping);
+            }
+
+            stemBuffer.setSize (numOutputChans, r.blockSizeForAudio + 256);
         }
 
         thresholdForStopping = dbToGain (-70.0f);
 
         renderingBuffer.setSize (numOutputChans, r.blockSizeForAudio + 256);
+        ditherer.reset (numOutputChans, r.bitDepth, r.noiseShaping);
+        AudioScratchBuffer::prepare (numOutputChans, r.blockSizeForAudio + 256);
         blockLength = r.blockSizeForAudio / r.sampleRateForAudio;
 
         // number of blank blocks to play before starting, to give pluginss time to warm up
@@ -218,10 +527,7 @@ struct Renderer::RenderTask::RendererContext
 
         currentTempoPosition = std::make_unique<TempoSequencePosition> (r.edit->tempoSequence);
 
-        peak = 0.0001f;
-        rmsTotal = 0.0;
-        rmsNumSamps = 0;
-        numNonZeroSamps = 0;
+        stats = {};
         streamTime = r.time.getStart();
 
         precount = numPreRenderBlocks;
@@ -261,10 +567,14 @@ struct Renderer::RenderTask::RendererContext
         localPlayhead.stop();
         localPlayhead.setPosition (streamTime);
 
-        samplesToWrite = roundToInt ((r.time.getLength() + r.endAllowance) * r.sampleRateForAudio);
+        samplesToWrite = r.renderContinuously ? std::numeric_limits<int64>::max()
+                                              : roundToInt ((r.time.getLength() + r.endAllowance) * r.sampleRateForAudio);
 
         if (sourceToUpdate != nullptr)
-            sourceToUpdate->reset (numOutputChans, r.sampleRateForAudio, samplesToWrite);
+            sourceToUpdate->reset (numOutputChans, r.sampleRateForAudio, r.renderContinuously ? 0 : samplesToWrite);
+
+        if (r.sink != nullptr)
+            r.sink->prepareToRender (numOutputChans, r.sampleRateForAudio, r.blockSizeForAudio);
 
         auto channels = AudioChannelSet::canonicalChannelSet (numOutputChans);
 
@@ -276,9 +586,9 @@ struct Renderer::RenderTask::RendererContext
     ~RendererContext()
     {
         CRASH_TRACER
-        r.resultMagnitude = owner.params.resultMagnitude = peak;
-        r.resultRMS = owner.params.resultRMS = rmsNumSamps > 0 ? (float) (rmsTotal / rmsNumSamps) : 0.0f;
-        r.resultAudioDuration = owner.params.resultAudioDuration = float (numNonZeroSamps / owner.params.sampleRateForAudio);
+        r.resultMagnitude = owner.params.resultMagnitude = stats.peak;
+        r.resultRMS = owner.params.resultRMS = stats.getRMS();
+        r.resultAudioDuration = owner.params.resultAudioDuration = float (stats.numNonZeroSamps / owner.params.sampleRateForAudio);
 
         localPlayhead.stop();
         setAllPluginsRealtime (plugins, true);
@@ -286,11 +596,17 @@ struct Renderer::RenderTask::RendererContext
         if (writer != nullptr)
             writer->closeForWriting();
 
+        for (auto w : stemWriters)
+            w->closeForWriting();
+
+        if (r.sink != nullptr)
+            r.sink->renderFinished();
+
         if (node != nullptr)
             callBlocking ([this] { node->releaseAudioNodeResources(); });
 
         if (needsToNormaliseAndTrim)
-            owner.performNormalisingAndTrimming (originalParams, r);
+            owner.performNormalisingAndTrimming (originalParams, r, stats.getNonSilentRange());
     }
 
     RenderTask& owner;
@@ -299,11 +615,15 @@ struct Renderer::RenderTask::RendererContext
     AudioNode* node = nullptr;
     int numOutputChans = 0;
     std::unique_ptr<AudioFileWriter> writer;
+    Array<StemTapAudioNode*> stemTaps;
+    OwnedArray<AudioFileWriter> stemWriters;
+    OwnedArray<Ditherer> stemDitherers;
+    juce::AudioBuffer<float> stemBuffer;
     Plugin::Array plugins;
     Result status;
 
     PlayHead localPlayhead;
-    Ditherers ditherers;
+    Ditherer ditherer;
     juce::AudioBuffer<float> renderingBuffer;
     MidiMessageArray midiBuffer;
     std::unique_ptr<AudioRenderContext> rc;
@@ -318,10 +638,7 @@ struct Renderer::RenderTask::RendererContext
     int sleepCounter = 0;
 
     std::unique_ptr<TempoSequencePosition> currentTempoPosition;
-    float peak = 0;
-    double rmsTotal = 0;
-    int64 rmsNumSamps = 0;
-    int64 numNonZeroSamps = 0;
+    RenderStatistics stats;
     int precount = 0;
     double streamTime = 0;
 
@@ -353,9 +670,17 @@ struct Renderer::RenderTask::RendererContext
         {
             node->releaseAudioNodeResources();
 
-            writer->closeForWriting();
+            if (writer != nullptr)
+                writer->closeForWriting();
+
             r.destFile.deleteFile();
 
+            for (int i = stemWriters.size(); --i >= 0;)
+            {
+                stemWriters.getUnchecked (i)->closeForWriting();
+                r.stems.getReference (i).destFile.deleteFile();
+            }
+
             localPlayhead.stop();
             setAllPluginsRealtime (plugins, true);
 
@@ -414,24 +739,10 @@ struct Renderer::RenderTask::RendererContext
             int numSamplesDone = (int) jmin (samplesToWrite, (int64) r.blockSizeForAudio);
             samplesToWrite -= numSamplesDone;
 
-            if (r.ditheringEnabled && r.bitDepth < 32)
-                ditherers.apply (renderingBuffer, r.blockSizeForAudio);
-
-            auto mag = renderingBuffer.getMagnitude (0, numSamplesDone);
-            peak = jmax (peak, mag);
+            stats.addBlock (renderingBuffer, numSamplesDone);
 
             if (! hasStartedSavingToFile)
-                hasStartedSavingToFile = (mag > 0.0f);
-
-            for (int i = renderingBuffer.getNumChannels(); --i >= 0;)
-            {
-                rmsTotal += renderingBuffer.getRMSLevel (i, 0, numSamplesDone);
-                ++rmsNumSamps;
-            }
-
-            for (int i = numSamplesDone; --i >= 0;)
-                if (renderingBuffer.getMagnitude (i, 1) > 0.0001)
-                    numNonZeroSamps++;
+                hasStartedSavingToFile = (renderingBuffer.getMagnitude (0, numSamplesDone) > 0.0f);
 
             if (! hasStartedSavingToFile)
                 samplesTrimmed += r.blockSizeForAudio;
@@ -448,10 +759,19 @@ struct Renderer::RenderTask::RendererContext
                 sourceToUpdate->addBlock (samplesDone, buffer, 0, numSamplesDone);
             }
 
-            // NB buffer gets trashed by this call
+            if (r.sink != nullptr && numSamplesDone > 0
+                 && ! r.sink->pushBlock (renderingBuffer, numSamplesDone, rc->streamTime))
+                return true;
+
+            if (numSamplesDone > 0 && ! stemWriters.isEmpty()
+                 && ! writeStems (numSamplesDone))
+                return true;
+
+            // The float intermediate gets dithered when it's scaled to the target bit depth
             if (numSamplesDone > 0 && hasStartedSavingToFile
-                 && writer->isOpen()
-                 && ! writer->appendBuffer (renderingBuffer, numSamplesDone))
+                 && writer != nullptr && writer->isOpen()
+                 && ! appendToFile (*writer, renderingBuffer, numSamplesDone,
+                                    shouldDither() && ! needsToNormaliseAndTrim ? &ditherer : nullptr))
                 return true;
         }
         else
@@ -460,6 +780,12 @@ struct Renderer::RenderTask::RendererContext
             Thread::sleep ((int) (blockLength * 1000));
         }
 
+        if (r.renderContinuously)
+        {
+            --precount;
+            return false;
+        }
+
         if (streamTime > r.time.getEnd() + r.endAllowance
             || (streamTime > r.time.getEnd()
                 && renderingBuffer.getMagnitude (0, r.blockSizeForAudio) <= thresholdForStopping))
@@ -476,46 +802,133 @@ struct Renderer::RenderTask::RendererContext
 
         return false;
     }
+
+    /** Gathers up the taps for each stem and appends them to its file. */
+    bool writeStems (int numSamples)
+    {
+        for (int i = 0; i < stemWriters.size(); ++i)
+        {
+            stemBuffer.clear();
+
+            for (auto tap : stemTaps)
+                if (tap->stemIndex == i)
+                    tap->addTo (stemBuffer, numSamples);
+
+            if (! appendToFile (*stemWriters.getUnchecked (i), stemBuffer, numSamples,
+                                shouldDither() ? stemDitherers.getUnchecked (i) : nullptr))
+                return false;
+        }
+
+        return true;
+    }
+
+    bool shouldDither() const noexcept      { return r.ditheringEnabled && r.bitDepth < 32; }
+
+    /** NB the buffer may get trashed by this call. */
+    static bool appendToFile (AudioFileWriter& w, juce::AudioBuffer<float>& buffer, int numSamples, Ditherer* d)
+    {
+        return d != nullptr ? w.appendBuffer (buffer, numSamples, *d)
+                            : w.appendBuffer (buffer, numSamples);
+    }
 };
 
 //==============================================================================
-bool Renderer::RenderTask::performNormalisingAndTrimming (const Renderer::Parameters& target,
-                                                          const Renderer::Parameters& intermediate)
+/** Opens an intermediate render, which is floating point so it's mapped into memory
+    if possible rather than decoded through a stream.
+*/
+static std::unique_ptr<AudioFormatReader> createIntermediateReader (Engine& engine, const File& file)
+{
+    AudioFormat* format = nullptr;
+    std::unique_ptr<AudioFormatReader> reader;
+
+    if (auto mappedReader = AudioFileUtils::createMemoryMappedReader (engine, file, format))
+    {
+        reader.reset (mappedReader);
+
+        if (! mappedReader->mapEntireFile())
+            reader = nullptr;
+    }
+
+    if (reader == nullptr)
+        reader.reset (AudioFileUtils::createReaderFor (engine, file));
+
+    return reader;
+}
+
+/** Measures a section of an intermediate render that wasn't measured as it was rendered. */
+static RenderStatistics measureIntermediate (AudioFormatReader& reader, juce::Range<int64> section)
+{
+    RenderStatistics stats;
+
+    const int blockSize = 16384;
+    juce::AudioBuffer<float> tempBuffer ((int) reader.numChannels, blockSize);
+
+    for (auto pos = section.getStart(); pos < section.getEnd();)
+    {
+        auto samps = static_cast<int> (jmin ((int64) blockSize, section.getEnd() - pos));
+
+        reader.read (&tempBuffer, 0, samps, pos, true, reader.numChannels > 1);
+        stats.addBlock (tempBuffer, samps);
+        pos += samps;
+    }
+
+    return stats;
+}
+
+/** Writes the target file from a section of an intermediate render, trimming, normalising,
+    resampling and dithering it as the target asks. The peak, RMS and non-silent range must
+    have been measured over the same section, and the range is relative to the start of the file.
+    The progress callback can return false to stop writing.
+*/
+static bool writeTargetFromIntermediate (Engine& engine, const Renderer::Parameters& target,
+                                         AudioFormatReader& reader, juce::Range<int64> section,
+                                         int64 intermediateStartSample,
+                                         float peak, float rms, juce::Range<int64> nonSilentRange,
+                                         const std::function<bool (float)>& updateProgress,
+                                         String& errorMessage)
 {
     CRASH_TRACER
+    auto rangeToWrite = section.getIntersectionWith ({ 0, reader.lengthInSamples });
 
     if (target.trimSilenceAtEnds)
     {
-        setJobName (TRANS("Trimming silence") + "...");
-        progress = 0.94f;
+        rangeToWrite = rangeToWrite.getIntersectionWith (nonSilentRange);
 
-        auto doneRange = AudioFileUtils::trimSilence (params.edit->engine, intermediate.destFile, -70.0f);
-
-        if (doneRange.getLength() == 0)
+        if (rangeToWrite.isEmpty())
         {
             errorMessage = TRANS("The rendered section was completely silent - no file was produced");
             return false;
         }
-
-        AudioFileUtils::applyBWAVStartTime (intermediate.destFile,
-                                            (int64) (intermediate.time.getStart() * intermediate.sampleRateForAudio)
-                                               + doneRange.getStart());
     }
 
-    if (target.shouldNormalise || target.shouldNormaliseByRMS)
-        setJobName (TRANS("Normalising") + "...");
-
-    std::unique_ptr<AudioFormatReader> reader (AudioFileUtils::createReaderFor (params.edit->engine, intermediate.destFile));
+    // Targets at a different rate are resampled as they're written, so one render can feed them all
+    const auto numChans = (int) reader.numChannels;
+    const auto ratio = reader.sampleRate / target.sampleRateForAudio;
+    std::unique_ptr<SincResampler> resampler;
 
-    if (reader == nullptr)
+    if (std::abs (ratio - 1.0) > 1.0e-9)
     {
-        errorMessage = TRANS("Couldn't read intermediate file");
-        return false;
+        jassert (numChans <= SincResampler::maxNumChannels);
+        resampler = std::make_unique<SincResampler> (ResamplingQuality::sincMastering, ratio);
     }
 
-    AudioFileWriter writer (AudioFile (params.edit->engine, target.destFile),
-                            target.audioFormat, (int) reader->numChannels, target.sampleRateForAudio,
-                            target.bitDepth, target.metadata, target.quality);
+    auto metadata = target.metadata;
+    AudioFileUtils::addBWAVStartToMetadata (metadata, (int64) ((intermediateStartSample + rangeToWrite.getStart()) / ratio));
+
+    // A parallel MP3 encode needs the whole WAV to split up, so that's written first
+    auto& formatManager = engine.getAudioFileFormatManager();
+    std::unique_ptr<TemporaryFile> wavForMP3;
+
+    if (target.audioFormat != nullptr && target.audioFormat == formatManager.getLameFormat()
+         && engine.getEngineBehaviour().shouldEncodeMP3sInParallel())
+        wavForMP3 = std::make_unique<TemporaryFile> (target.destFile.withFileExtension ("wav"));
+
+    const float writeProportion = wavForMP3 != nullptr ? 0.2f : 1.0f;
+
+    AudioFileWriter writer (AudioFile (engine, wavForMP3 != nullptr ? wavForMP3->getFile() : target.destFile),
+                            wavForMP3 != nullptr ? formatManager.getWavFormat() : target.audioFormat,
+                            numChans, target.sampleRateForAudio,
+                            target.bitDepth, metadata, wavForMP3 != nullptr ? 0 : target.quality);
 
     if (! writer.isOpen())
     {
@@ -523,59 +936,156 @@ bool Renderer::RenderTask::performNormalisingAndTrimming (const Renderer::Parame
         return false;
     }
 
-    progress = 0.96f;
     float gain = 1.0f;
 
     if (target.shouldNormaliseByRMS)
-        gain = jlimit (0.0f, 100.0f, dbToGain (target.normaliseToLevelDb) / (intermediate.resultRMS + 2.0f / 32768.0f));
+        gain = jlimit (0.0f, 100.0f, dbToGain (target.normaliseToLevelDb) / (rms + 2.0f / 32768.0f));
     else if (target.shouldNormalise)
-        gain = jlimit (0.0f, 100.0f, dbToGain (target.normaliseToLevelDb) * (1.0f / (intermediate.resultMagnitude * 1.005f + 2.0f / 32768.0f)));
+        gain = jlimit (0.0f, 100.0f, dbToGain (target.normaliseToLevelDb) * (1.0f / (peak * 1.005f + 2.0f / 32768.0f)));
+
+    Ditherer ditherer;
+    ditherer.reset (numChans, target.bitDepth, target.noiseShaping);
+
+    auto writeBlock = [&] (juce::AudioBuffer<float>& buffer, int numSamples)
+    {
+        const bool written = target.ditheringEnabled && target.bitDepth < 32
+                               ? writer.appendBuffer (buffer, numSamples, ditherer)
+                               : writer.appendBuffer (buffer, numSamples);
+
+        if (! written)
+            errorMessage = TRANS("Couldn't write to target file");
 
-    Ditherers ditherers ((int) reader->numChannels, target.bitDepth);
+        return written;
+    };
 
     const int blockSize = 16384;
-    juce::AudioBuffer<float> tempBuffer ((int) reader->numChannels, blockSize + 256);
+    juce::AudioBuffer<float> tempBuffer (numChans, blockSize + 256);
 
-    for (int64 pos = 0; pos < reader->lengthInSamples;)
+    if (resampler != nullptr)
     {
-        auto numLeft = static_cast<int> (reader->lengthInSamples - pos);
-        auto samps = jmin (tempBuffer.getNumSamples(), blockSize, numLeft);
+        // Each block's read position is worked out from the start of the range, so it doesn't drift
+        const auto padding = resampler->getNumPaddingSamples();
+        const auto numOutputSamples = (int64) std::ceil ((double) rangeToWrite.getLength() / ratio);
+        juce::AudioBuffer<float> inputBuffer (numChans, (int) std::ceil (blockSize * ratio) + 2 + 2 * padding);
 
-        reader->read (&tempBuffer, 0, samps, pos, true, reader->numChannels > 1);
+        const float* source[SincResampler::maxNumChannels] = {};
+        float gains[SincResampler::maxNumChannels];
+        std::fill (std::begin (gains), std::end (gains), gain);
 
-        tempBuffer.applyGain (0, samps, gain);
+        for (int chan = 0; chan < jmin (numChans, SincResampler::maxNumChannels); ++chan)
+            source[chan] = inputBuffer.getReadPointer (chan, padding);
 
-        if (target.ditheringEnabled && target.bitDepth < 32)
-            ditherers.apply (tempBuffer, samps);
+        for (int64 outPos = 0; outPos < numOutputSamples;)
+        {
+            auto samps = static_cast<int> (jmin ((int64) blockSize, numOutputSamples - outPos));
+            const auto inputPos = (double) outPos * ratio;
+            const auto firstInputSample = (int64) inputPos;
+            const auto startPosition = inputPos - (double) firstInputSample;
+            const auto numInput = SincResampler::getNumInputSamplesNeeded (samps, startPosition, ratio);
 
-        writer.appendBuffer (tempBuffer, samps);
-        pos += samps;
-    }
+            reader.read (&inputBuffer, 0, numInput + 2 * padding, rangeToWrite.getStart() + firstInputSample - padding,
+                         true, numChans > 1);
 
-    return true;
-}
+            tempBuffer.clear (0, samps);
+            resampler->processAdding (source, tempBuffer.getArrayOfWritePointers(), gains,
+                                      jmin (numChans, SincResampler::maxNumChannels), samps, startPosition, ratio);
 
-//==============================================================================
-bool Renderer::RenderTask::renderAudio (Renderer::Parameters& r)
-{
-    CRASH_TRACER
+            if (! writeBlock (tempBuffer, samps))
+                return false;
 
-    if (context == nullptr)
-    {
-        callBlocking ([&, this] { context.reset (new RendererContext (*this, r, node.get(), sourceToUpdate)); });
+            outPos += samps;
 
-        if (! context->getStatus().wasOk())
-        {
-            errorMessage = context->getStatus().getErrorMessage();
-            return true;
+            if (! updateProgress (writeProportion * (float) (outPos / (double) numOutputSamples)))
+                return false;
         }
     }
+    else
+    {
+        for (auto pos = rangeToWrite.getStart(); pos < rangeToWrite.getEnd();)
+        {
+            auto numLeft = static_cast<int> (jmin ((int64) blockSize, rangeToWrite.getEnd() - pos));
+            auto samps = jmin (tempBuffer.getNumSamples(), numLeft);
 
-    if (! context->renderNextBlock (progress))
-        return false;
+            reader.read (&tempBuffer, 0, samps, pos, true, numChans > 1);
 
-    context = nullptr;
-    progress = 1.0f;
+            tempBuffer.applyGain (0, samps, gain);
+
+            if (! writeBlock (tempBuffer, samps))
+                return false;
+
+            pos += samps;
+
+            if (! updateProgress (writeProportion * (float) ((pos - rangeToWrite.getStart()) / (double) rangeToWrite.getLength())))
+                return false;
+        }
+    }
+
+    if (wavForMP3 != nullptr)
+    {
+        writer.closeForWriting();
+
+        if (! LAMEManager::encodeWavFile (wavForMP3->getFile(), target.destFile, target.quality, metadata,
+                                          SystemStats::getNumCpus(),
+                                          [&] (float p) { return updateProgress (writeProportion + (1.0f - writeProportion) * p); }))
+        {
+            errorMessage = TRANS("Couldn't write to target file");
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool Renderer::RenderTask::performNormalisingAndTrimming (const Renderer::Parameters& target,
+                                                          const Renderer::Parameters& intermediate,
+                                                          juce::Range<int64> nonSilentRange)
+{
+    CRASH_TRACER
+    auto& engine = params.edit->engine;
+    auto reader = createIntermediateReader (engine, intermediate.destFile);
+
+    if (reader == nullptr)
+    {
+        errorMessage = TRANS("Couldn't read intermediate file");
+        return false;
+    }
+
+    if (target.trimSilenceAtEnds)
+        setJobName (TRANS("Trimming silence") + "...");
+
+    if (target.shouldNormalise || target.shouldNormaliseByRMS)
+        setJobName (TRANS("Normalising") + "...");
+
+    progress = 0.9f;
+
+    return writeTargetFromIntermediate (engine, target, *reader, { 0, reader->lengthInSamples },
+                                        (int64) (intermediate.time.getStart() * intermediate.sampleRateForAudio),
+                                        intermediate.resultMagnitude, intermediate.resultRMS, nonSilentRange,
+                                        [this] (float p) { progress = 0.9f + 0.1f * p; return true; },
+                                        errorMessage);
+}
+
+//==============================================================================
+bool Renderer::RenderTask::renderAudio (Renderer::Parameters& r)
+{
+    CRASH_TRACER
+
+    if (context == nullptr)
+    {
+        callBlocking ([&, this] { context.reset (new RendererContext (*this, r, node.get(), sourceToUpdate)); });
+
+        if (! context->getStatus().wasOk())
+        {
+            errorMessage = context->getStatus().getErrorMessage();
+            return true;
+        }
+    }
+
+    if (! context->renderNextBlock (progress))
+        return false;
+
+    context = nullptr;
+    progress = 1.0f;
     Thread::sleep (150); // no idea why this is here..
 
     return true;
@@ -631,7 +1141,7 @@ void Renderer::RenderTask::setAllPluginsRealtime (const Plugin::Array& plugins,
 }
 
 //==============================================================================
-bool Renderer::RenderTask::renderMidi (Renderer::Parameters& r)
+bool Renderer::RenderTask::renderMidiFromAudioNode (Renderer::Parameters& r, MidiMessageSequence& outputSequence)
 {
     CRASH_TRACER
     node->purgeSubNodes (false, true);
@@ -647,7 +1157,6 @@ bool Renderer::RenderTask::renderMidi (Renderer::Parameters& r)
         }
     }
 
-    MidiMessageSequence outputSequence;
     MidiMessageArray midiBuffer;
 
     const int sampleRate = 44100; // use any old sample rate as this shouldn't matter to the midi nodes
@@ -727,6 +1236,31 @@ bool Renderer::RenderTask::renderMidi (Renderer::Parameters& r)
     callBlocking ([this] { node->releaseAudioNodeResources(); });
     localPlayhead.stop();
 
+    return true;
+}
+
+bool Renderer::RenderTask::renderMidi (Renderer::Parameters& r)
+{
+    CRASH_TRACER
+    MidiMessageSequence outputSequence;
+
+    if (node == nullptr)
+    {
+        // Nothing on the tracks can change the MIDI so it comes straight from the clips
+        jassert (canRenderMidiFromClips (r));
+        outputSequence = createMidiSequenceFromClips (r);
+
+        if (outputSequence.getNumEvents() == 0)
+        {
+            errorMessage = TRANS("No MIDI was found within the selected region");
+            return false;
+        }
+    }
+    else if (! renderMidiFromAudioNode (r, outputSequence))
+    {
+        return false;
+    }
+
     outputSequence.updateMatchedPairs();
 
     if (outputSequence.getNumEvents() > 0)
@@ -773,13 +1307,158 @@ bool Renderer::RenderTask::renderMidi (Renderer::Parameters& r)
     return false;
 }
 
+//==============================================================================
+static bool canPluginChangeMidi (Plugin& p)
+{
+    return p.isEnabled()
+            && dynamic_cast<VolumeAndPanPlugin*> (&p) == nullptr
+            && dynamic_cast<LevelMeterPlugin*> (&p) == nullptr;
+}
+
+static bool isTrackIncludedInMidiRender (AudioTrack& at)
+{
+    return at.isProcessing (true)
+            && (at.shouldBePlayed() || at.state.getProperty (IDs::processMidiWhenMuted, false));
+}
+
+bool Renderer::canRenderMidiFromClips (const Parameters& r)
+{
+    CRASH_TRACER
+    jassert (r.edit != nullptr);
+
+    const auto allTracks = getAllTracks (*r.edit);
+
+    for (int i = 0; i < allTracks.size(); ++i)
+    {
+        if (! r.tracksToDo[i])
+            continue;
+
+        auto track = allTracks.getUnchecked (i);
+
+        if (auto ft = dynamic_cast<FolderTrack*> (track))
+        {
+            if (ft->isSubmixFolder())
+                return false;
+
+            continue;
+        }
+
+        auto at = dynamic_cast<AudioTrack*> (track);
+
+        if (at == nullptr || ! isTrackIncludedInMidiRender (*at))
+            continue;
+
+        if (at->isPartOfSubmix() || ! at->getInputTracks().isEmpty()
+             || at->getCompGroup() != -1
+             || ! at->getModifierList().getModifiers().isEmpty())
+            return false;
+
+        if (r.usePlugins)
+            for (auto p : at->pluginList)
+                if (canPluginChangeMidi (*p))
+                    return false;
+
+        for (auto c : at->getClips())
+        {
+            if (! c->getPosition().time.overlaps (r.time))
+                continue;
+
+            if (auto mc = dynamic_cast<MidiClip*> (c))
+            {
+                if (r.usePlugins)
+                    if (auto pl = mc->getPluginList())
+                        for (auto p : *pl)
+                            if (canPluginChangeMidi (*p))
+                                return false;
+            }
+            else if (dynamic_cast<AudioClipBase*> (c) == nullptr)
+            {
+                // Other types of clip, e.g. step clips, create their MIDI while playing
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+MidiMessageSequence Renderer::createMidiSequenceFromClips (const Parameters& r)
+{
+    CRASH_TRACER
+    jassert (r.edit != nullptr);
+
+    MidiMessageSequence outputSequence;
+    TempoSequencePosition eventPos (r.edit->tempoSequence);
+    const auto allTracks = getAllTracks (*r.edit);
+
+    for (int i = 0; i < allTracks.size(); ++i)
+    {
+        auto at = dynamic_cast<AudioTrack*> (allTracks.getUnchecked (i));
+
+        if (at == nullptr || ! r.tracksToDo[i] || ! isTrackIncludedInMidiRender (*at))
+            continue;
+
+        for (auto c : at->getClips())
+        {
+            auto mc = dynamic_cast<MidiClip*> (c);
+
+            if (mc == nullptr || mc->isMuted()
+                 || ! mc->getPosition().time.overlaps (r.time)
+                 || ! (r.allowedClips.isEmpty() || r.allowedClips.contains (mc)))
+                continue;
+
+            // This applies the quantisation, groove and MPE expression
+            MidiMessageSequence clipSequence;
+            mc->getSequenceLooped().exportToPlaybackMidiSequence (clipSequence, *mc, mc->getMPEMode());
+            clipSequence.updateMatchedPairs();
+
+            const auto clipStart = mc->getPosition().getStart();
+            const auto volScale = dbToGain (mc->getVolumeDb());
+
+            for (int j = 0; j < clipSequence.getNumEvents(); ++j)
+            {
+                auto meh = clipSequence.getEventPointer (j);
+                auto editTime = clipStart + meh->message.getTimeStamp();
+
+                // Note-offs are added with their note-ons so notes that carry on past the end are ended there
+                if (meh->message.isNoteOff())
+                    continue;
+
+                if (editTime < r.time.getStart() || editTime >= r.time.getEnd())
+                    continue;
+
+                MidiMessage m (meh->message);
+
+                if (m.isNoteOn())
+                {
+                    m.multiplyVelocity (volScale);
+
+                    auto noteOffTime = meh->noteOffObject != nullptr ? clipStart + meh->noteOffObject->message.getTimeStamp()
+                                                                     : r.time.getEnd();
+
+                    eventPos.setTime (jmin (noteOffTime, r.time.getEnd()) - r.time.getStart());
+                    outputSequence.addEvent (MidiMessage::noteOff (m.getChannel(), m.getNoteNumber()),
+                                             Edit::ticksPerQuarterNote * eventPos.getPPQTime());
+                }
+
+                eventPos.setTime (editTime - r.time.getStart());
+                outputSequence.addEvent (MidiMessage (m, Edit::ticksPerQuarterNote * eventPos.getPPQTime()));
+            }
+        }
+    }
+
+    return outputSequence;
+}
+
 //==============================================================================
 static AudioNode* createRenderingNodeFromEdit (Edit& edit,
                                                const CreateAudioNodeParams& params,
-                                               bool includeMasterPlugins)
+                                               bool includeMasterPlugins,
+                                               const Array<Renderer::Parameters::Stem>* stems = nullptr,
+                                               int numThreadsToUse = 1)
 {
     CRASH_TRACER
-    MixerAudioNode* mixer = nullptr;
+    Array<AudioNode*> inputNodes;
 
     const auto allTracks = getAllTracks (edit);
 
@@ -805,13 +1484,10 @@ static AudioNode* createRenderingNodeFromEdit (Edit& edit,
             {
                 if (! trackLoopsBackInto (allTracks, *at, params.allowedTracks))
                 {
-                    if (mixer == nullptr)
-                        mixer = new MixerAudioNode (true, edit.engine.getEngineBehaviour().getNumberOfCPUsToUseForAudio() > 1);
-
                     auto trackNode = at->createAudioNode (params);
 
                     trackNode = new TrackMutingAudioNode (*at, trackNode, false);
-                    mixer->addInput (trackNode);
+                    inputNodes.add (addStemTapIfNeeded (trackNode, i, stems));
 
                     // find an tracks required to feed sidechains
                     Array<AudioTrack*> todo;
@@ -838,10 +1514,7 @@ static AudioNode* createRenderingNodeFromEdit (Edit& edit,
             {
                 if (auto n = ft->createAudioNode (params))
                 {
-                    if (mixer == nullptr)
-                        mixer = new MixerAudioNode (true, edit.engine.getEngineBehaviour().getNumberOfCPUsToUseForAudio() > 1);
-
-                    mixer->addInput (n);
+                    inputNodes.add (addStemTapIfNeeded (n, i, stems));
 
                     // find an tracks required to feed sidechains
                     auto subTracks = ft->getAllAudioSubTracks (true);
@@ -867,15 +1540,40 @@ static AudioNode* createRenderingNodeFromEdit (Edit& edit,
                 p.allowedClips = nullptr;
 
                 if (auto* n = at->createAudioNode (p))
-                {
-                    n = new MuteAudioNode (n);
-                    mixer->addInput (n);
-                }
+                    inputNodes.add (new MuteAudioNode (n));
             }
         }
     }
 
-    AudioNode* finalNode = mixer;
+    AudioNode* finalNode = nullptr;
+
+    if (! inputNodes.isEmpty())
+    {
+       #if ENABLE_EXPERIMENTAL_TRACKTION_GRAPH
+        bool canUseGraph = numThreadsToUse > 1;
+
+        for (auto n : inputNodes)
+            if (! MultiThreadedRenderAudioNode::canBeRenderedConcurrently (*n))
+                canUseGraph = false;
+
+        if (canUseGraph)
+        {
+            const bool use64Bit = edit.engine.getPropertyStorage().getProperty (SettingID::use64Bit, false);
+            finalNode = new MultiThreadedRenderAudioNode (inputNodes, numThreadsToUse, use64Bit,
+                                                          edit.engine.getEngineBehaviour().shouldUseNumaAwareProcessing());
+        }
+        else
+       #endif
+        {
+            ignoreUnused (numThreadsToUse);
+            auto mixer = new MixerAudioNode (edit, true, edit.engine.getEngineBehaviour().getNumberOfCPUsToUseForAudio() > 1);
+
+            for (auto n : inputNodes)
+                mixer->addInput (n);
+
+            finalNode = mixer;
+        }
+    }
 
     if (includeMasterPlugins && finalNode != nullptr)
     {
@@ -897,7 +1595,36 @@ AudioNode* Renderer::createRenderingAudioNode (const Parameters& r)
     cnp.includePlugins = r.usePlugins;
     cnp.addAntiDenormalisationNoise = r.addAntiDenormalisationNoise;
 
-    return createRenderingNodeFromEdit (*r.edit, cnp, r.useMasterPlugins);
+    // Any plugins still waiting to be loaded in the background would be rendered as bypassed
+    if (r.usePlugins)
+        r.edit->initialiseAllPlugins();
+
+    // Renders don't order the tracks by their aux sends, so the returns have to play a block late
+    AuxSendPlugin::setBusesProcessedInGraphOrder (*r.edit, {});
+
+    const int numThreads = r.numThreadsForRendering > 0 ? r.numThreadsForRendering
+                                                         : r.engine->getEngineBehaviour().getNumberOfCPUsToUseForAudio();
+
+    if (r.stems.isEmpty())
+        return createRenderingNodeFromEdit (*r.edit, cnp, r.useMasterPlugins, nullptr, numThreads);
+
+    // Build a single graph with all the stems' tracks in it, so anything they share is
+    // only rendered once and the mixer can render them in parallel
+    jassert (! r.useMasterPlugins);
+    juce::BigInteger allStemTracks;
+
+    for (auto& stem : r.stems)
+        allStemTracks |= stem.tracksToDo;
+
+    cnp.allowedTracks = &allStemTracks;
+
+    return createRenderingNodeFromEdit (*r.edit, cnp, false, &r.stems, numThreads);
+}
+
+int Renderer::getBlockSizeForRendering (Engine& engine, bool realTime)
+{
+    auto deviceBlockSize = engine.getDeviceManager().getBlockSize();
+    return realTime ? deviceBlockSize : jmax (deviceBlockSize, 2048);
 }
 
 //==============================================================================
@@ -996,8 +1723,10 @@ juce::File Renderer::renderToFile (const String& taskDescription, const Paramete
          && ! r.destFile.isDirectory())
     {
         auto& ui = r.edit->engine.getUIBehaviour();
+        const bool renderMidiFromClips = r.createMidiFile && canRenderMidiFromClips (r);
+        auto node = renderMidiFromClips ? nullptr : createRenderingAudioNode (r);
 
-        if (auto node = createRenderingAudioNode (r))
+        if (node != nullptr || renderMidiFromClips)
         {
             RenderTask task (taskDescription, r, node);
 
@@ -1029,6 +1758,435 @@ juce::File Renderer::renderToFile (const String& taskDescription, const Paramete
     return {};
 }
 
+//==============================================================================
+/** Encodes the targets of a batch render from its intermediate files, several at once. */
+class BatchEncodeTask   : public ThreadPoolJobWithProgress
+{
+public:
+    struct Encode
+    {
+        Renderer::Parameters target;
+        File intermediateFile;
+    };
+
+    BatchEncodeTask (const Renderer::Parameters& r, Array<Encode> encodesToDo)
+        : ThreadPoolJobWithProgress (TRANS("Encoding") + "..."),
+          render (r), encodes (std::move (encodesToDo)), encodeProgress ((size_t) encodes.size())
+    {
+        for (auto& p : encodeProgress)
+            p = 0.0f;
+    }
+
+    JobStatus runJob() override
+    {
+        CRASH_TRACER
+        FloatVectorOperations::disableDenormalisedNumberSupport();
+
+        const int numEncodes = encodes.size();
+        std::atomic<int> numFinished { 0 };
+
+        {
+            ThreadPool pool (jlimit (1, jmax (1, numEncodes), SystemStats::getNumCpus()));
+
+            for (int i = 0; i < numEncodes; ++i)
+                pool.addJob ([this, i, &numFinished]
+                             {
+                                 FloatVectorOperations::disableDenormalisedNumberSupport();
+                                 encode (i);
+                                 ++numFinished;
+                             });
+
+            while (numFinished < numEncodes)
+            {
+                if (shouldExit())
+                    cancelled = true;
+
+                float total = 0.0f;
+
+                for (auto& p : encodeProgress)
+                    total += p;
+
+                progress = total / jmax (1, numEncodes);
+                Thread::sleep (10);
+            }
+        }
+
+        if (cancelled)
+        {
+            for (auto& f : filesCreated)
+                f.deleteFile();
+
+            filesCreated.clear();
+        }
+
+        progress = 1.0f;
+        return jobHasFinished;
+    }
+
+    float getCurrentTaskProgress() override     { return progress; }
+
+    Array<File> filesCreated;
+    String errorMessage;
+
+private:
+    const Renderer::Parameters render;
+    Array<Encode> encodes;
+    std::vector<std::atomic<float>> encodeProgress;
+    std::atomic<float> progress { 0.0f };
+    std::atomic<bool> cancelled { false };
+    CriticalSection lock;
+
+    void encode (int index)
+    {
+        CRASH_TRACER
+        auto& e = encodes.getReference (index);
+        auto& engine = *render.engine;
+        String error;
+
+        if (cancelled)
+            return;
+
+        if (auto reader = createIntermediateReader (engine, e.intermediateFile))
+        {
+            const auto sampleRate = render.sampleRateForAudio;
+            juce::Range<int64> section (0, reader->lengthInSamples);
+
+            // Targets can export a section of the render
+            if (e.target.time.getLength() > 0.0)
+                section = section.getIntersectionWith ({ (int64) ((e.target.time.getStart() - render.time.getStart()) * sampleRate),
+                                                         (int64) ((e.target.time.getEnd() + e.target.endAllowance - render.time.getStart()) * sampleRate) });
+
+            RenderStatistics stats;
+
+            if (e.target.shouldNormalise || e.target.shouldNormaliseByRMS || e.target.trimSilenceAtEnds)
+                stats = measureIntermediate (*reader, section);
+
+            const bool ok = writeTargetFromIntermediate (engine, e.target, *reader, section,
+                                                         (int64) (render.time.getStart() * sampleRate),
+                                                         stats.peak, stats.getRMS(),
+                                                         stats.getNonSilentRange() + section.getStart(),
+                                                         [this, index] (float p)
+                                                         {
+                                                             encodeProgress[(size_t) index] = p;
+                                                             return ! cancelled;
+                                                         },
+                                                         error);
+
+            if (ok)
+            {
+                const ScopedLock sl (lock);
+                filesCreated.add (e.target.destFile);
+                return;
+            }
+
+            reader = nullptr;
+            e.target.destFile.deleteFile();
+        }
+        else
+        {
+            error = TRANS("Couldn't read intermediate file");
+        }
+
+        encodeProgress[(size_t) index] = 1.0f;
+
+        const ScopedLock sl (lock);
+
+        if (errorMessage.isEmpty() && ! cancelled)
+            errorMessage = error;
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (BatchEncodeTask)
+};
+
+Array<File> Renderer::renderToFiles (const String& taskDescription, const Parameters& render,
+                                     const Array<Parameters>& targets)
+{
+    CRASH_TRACER
+    jassert (render.edit != nullptr);
+    jassert (render.engine != nullptr);
+    jassert (! render.createMidiFile);
+
+    if (targets.isEmpty() || render.tracksToDo.countNumberOfSetBits() == 0)
+        return {};
+
+    auto& engine = *render.engine;
+    auto& ui = engine.getUIBehaviour();
+
+    // The Edit is rendered once to floating point files that all the targets are encoded from
+    auto r = render;
+    r.audioFormat = engine.getAudioFileFormatManager().getFrozenFileFormat();
+    r.bitDepth = 32;
+    r.quality = 0;
+    r.ditheringEnabled = false;
+    r.shouldNormalise = false;
+    r.shouldNormaliseByRMS = false;
+    r.trimSilenceAtEnds = false;
+
+    const auto extension = r.audioFormat->getFileExtensions()[0];
+    auto& firstTarget = targets.getReference (0);
+    OwnedArray<TemporaryFile> intermediates;
+
+    if (r.stems.isEmpty())
+    {
+        r.destFile = intermediates.add (new TemporaryFile (firstTarget.destFile.withFileExtension (extension)))->getFile();
+    }
+    else
+    {
+        // Each target must have a file for each of the stems
+        jassert (firstTarget.stems.size() == r.stems.size());
+
+        for (int i = 0; i < r.stems.size(); ++i)
+            r.stems.getReference (i).destFile = intermediates.add (new TemporaryFile (firstTarget.stems[i].destFile.withFileExtension (extension)))->getFile();
+    }
+
+    TransportControl::stopAllTransports (engine, false, true);
+    turnOffAllPlugins (*r.edit);
+
+    {
+        auto node = createRenderingAudioNode (r);
+
+        if (node == nullptr)
+        {
+            ui.showWarningMessage (TRANS("Couldn't render, as the selected region was empty"));
+            return {};
+        }
+
+        RenderTask task (taskDescription, r, node);
+        ui.runTaskWithProgressBar (task);
+        turnOffAllPlugins (*r.edit);
+
+        if (task.errorMessage.isNotEmpty())
+        {
+            ui.showWarningMessage (task.errorMessage);
+            return {};
+        }
+    }
+
+    // A cancelled render deletes its files
+    for (auto tf : intermediates)
+        if (! tf->getFile().existsAsFile())
+            return {};
+
+    Array<BatchEncodeTask::Encode> encodes;
+
+    for (auto& target : targets)
+    {
+        auto t = target;
+
+        if (t.sampleRateForAudio <= 0.0)
+            t.sampleRateForAudio = r.sampleRateForAudio;
+
+        if (r.stems.isEmpty())
+        {
+            encodes.add ({ t, intermediates.getFirst()->getFile() });
+        }
+        else
+        {
+            jassert (target.stems.size() == r.stems.size());
+
+            for (int i = 0; i < jmin (r.stems.size(), target.stems.size()); ++i)
+            {
+                t.destFile = target.stems[i].destFile;
+                encodes.add ({ t, intermediates[i]->getFile() });
+            }
+        }
+    }
+
+    BatchEncodeTask encodeTask (r, std::move (encodes));
+    ui.runTaskWithProgressBar (encodeTask);
+
+    if (encodeTask.errorMessage.isNotEmpty())
+        ui.showWarningMessage (encodeTask.errorMessage);
+
+    return encodeTask.filesCreated;
+}
+
+//==============================================================================
+/** Renders several Edits at once, each on its own thread. */
+class BatchRenderTask   : public ThreadPoolJobWithProgress
+{
+public:
+    BatchRenderTask (const String& taskDescription, Array<Renderer::Parameters> rendersToDo, int numConcurrent)
+        : ThreadPoolJobWithProgress (taskDescription),
+          renders (std::move (rendersToDo)), numConcurrentRenders (numConcurrent),
+          renderProgress ((size_t) renders.size())
+    {
+        for (auto& p : renderProgress)
+            p = 0.0f;
+
+        filesCreated.insertMultiple (0, {}, renders.size());
+    }
+
+    JobStatus runJob() override
+    {
+        CRASH_TRACER
+        const int numRenders = renders.size();
+        std::atomic<int> numFinished { 0 };
+
+        {
+            ThreadPool pool (jlimit (1, jmax (1, numRenders), numConcurrentRenders));
+
+            for (int i = 0; i < numRenders; ++i)
+                pool.addJob ([this, i, &numFinished]
+                             {
+                                 render (i);
+                                 renderProgress[(size_t) i] = 1.0f;
+                                 ++numFinished;
+                             });
+
+            while (numFinished < numRenders)
+            {
+                if (shouldExit())
+                    cancelled = true;
+
+                float total = 0.0f;
+
+                for (auto& p : renderProgress)
+                    total += p;
+
+                progress = total / jmax (1, numRenders);
+                Thread::sleep (10);
+            }
+        }
+
+        if (cancelled)
+        {
+            for (auto& f : filesCreated)
+            {
+                f.deleteFile();
+                f = File();
+            }
+        }
+
+        progress = 1.0f;
+        return jobHasFinished;
+    }
+
+    float getCurrentTaskProgress() override     { return progress; }
+
+    Array<File> filesCreated;
+    String errorMessage;
+
+private:
+    Array<Renderer::Parameters> renders;
+    const int numConcurrentRenders;
+    std::vector<std::atomic<float>> renderProgress;
+    std::atomic<float> progress { 0.0f };
+    std::atomic<bool> cancelled { false };
+    CriticalSection lock;
+
+    void render (int index)
+    {
+        CRASH_TRACER
+        auto& r = renders.getReference (index);
+
+        if (cancelled || r.tracksToDo.isZero())
+            return;
+
+        // Building the graph initialises the plugins, so it's done on the message thread
+        const bool renderMidiFromClips = r.createMidiFile && Renderer::canRenderMidiFromClips (r);
+        AudioNode* node = nullptr;
+
+        if (! renderMidiFromClips)
+            callBlocking ([&] { node = Renderer::createRenderingAudioNode (r); });
+
+        String error;
+
+        if (node != nullptr || renderMidiFromClips)
+        {
+            Renderer::RenderTask task (getJobName(), r, node, renderProgress[(size_t) index], nullptr);
+
+            while (task.runJob() == ThreadPoolJob::jobNeedsRunningAgain)
+                if (cancelled)
+                    task.signalJobShouldExit();
+
+            error = task.errorMessage;
+        }
+        else
+        {
+            error = TRANS("Couldn't render, as the selected region was empty");
+        }
+
+        callBlocking ([&] { Renderer::turnOffAllPlugins (*r.edit); });
+
+        if (r.destFile.existsAsFile())
+        {
+            if (error.isEmpty())
+            {
+                filesCreated.getReference (index) = r.destFile;
+                return;
+            }
+
+            r.destFile.deleteFile();
+        }
+
+        const ScopedLock sl (lock);
+
+        if (errorMessage.isEmpty() && ! cancelled)
+            errorMessage = error;
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (BatchRenderTask)
+};
+
+Array<File> Renderer::renderEdits (const String& taskDescription, const Array<Parameters>& renders,
+                                   int numConcurrentRenders)
+{
+    CRASH_TRACER
+
+    if (renders.isEmpty())
+        return {};
+
+    auto& engine = *renders.getReference (0).engine;
+    auto& ui = engine.getUIBehaviour();
+
+    if (numConcurrentRenders <= 0)
+        numConcurrentRenders = SystemStats::getNumCpus();
+
+    numConcurrentRenders = jlimit (1, renders.size(), numConcurrentRenders);
+
+    // The renders' own threads are shared between them so they don't swamp the CPUs
+    const int numThreadsPerRender = jmax (1, engine.getEngineBehaviour().getNumberOfCPUsToUseForAudio() / numConcurrentRenders);
+
+    TransportControl::stopAllTransports (engine, false, true);
+
+    Array<Parameters> rendersToDo;
+    OwnedArray<Edit::ScopedRenderStatus> renderStatuses;
+    Array<Edit*> edits;
+
+    for (auto& render : renders)
+    {
+        jassert (render.engine == &engine);
+        jassert (render.edit != nullptr);
+        jassert (render.sampleRateForAudio > 7000);
+
+        // Each Edit's plugins and playhead can only take part in one render at a time
+        jassert (! edits.contains (render.edit));
+        edits.add (render.edit);
+
+        auto r = render;
+
+        if (r.numThreadsForRendering <= 0)
+            r.numThreadsForRendering = numThreadsPerRender;
+
+        // Invalid renders are left in so the results line up with the parameters
+        if (r.tracksToDo.countNumberOfSetBits() == 0 || ! r.destFile.hasWriteAccess() || r.destFile.isDirectory())
+            r.tracksToDo.clear();
+
+        renderStatuses.add (new Edit::ScopedRenderStatus (*r.edit, true));
+        turnOffAllPlugins (*r.edit);
+        rendersToDo.add (r);
+    }
+
+    BatchRenderTask task (taskDescription, std::move (rendersToDo), numConcurrentRenders);
+    ui.runTaskWithProgressBar (task);
+
+    if (task.errorMessage.isNotEmpty())
+        ui.showWarningMessage (task.errorMessage);
+
+    return task.filesCreated;
+}
+
 ProjectItem::Ptr Renderer::renderToProjectItem (const String& taskDescription, const Parameters& r)
 {
     CRASH_TRACER
@@ -1162,4 +2320,101 @@ bool Renderer::checkTargetFile (Engine& e, const File& file)
     return true;
 }
 
+//==============================================================================
+#if TRACKTION_UNIT_TESTS
+
+class RendererMidiTests   : public juce::UnitTest
+{
+public:
+    RendererMidiTests() : juce::UnitTest ("Renderer MIDI", "Tracktion") {}
+
+    void runTest() override
+    {
+        auto& engine = *Engine::getEngines().getFirst();
+        auto edit = Edit::createSingleTrackEdit (engine);
+        auto track = getAudioTracks (*edit)[0];
+
+        // At the default 120bpm, a beat is half a second
+        auto clip = track->insertMIDIClip ({ 0.0, 4.0 }, nullptr);
+        clip->getSequence().addNote (60, 0.0, 1.0, 100, 0, nullptr);
+        clip->getSequence().addNote (64, 6.0, 2.0, 100, 0, nullptr);
+
+        Renderer::Parameters r (*edit);
+        r.tracksToDo.setBit (0);
+        r.createMidiFile = true;
+        r.time = { 0.0, 3.5 };
+
+        beginTest ("MIDI can be taken straight from the clips");
+        {
+            expect (Renderer::canRenderMidiFromClips (r));
+
+            auto sequence = Renderer::createMidiSequenceFromClips (r);
+            expectEquals (sequence.getNumEvents(), 4);
+            expectEquals (sequence.getEventTime (0), 0.0);
+            expectEquals (sequence.getEventTime (1), (double) Edit::ticksPerQuarterNote);
+
+            // The second note is ended at the end of the render
+            expect (sequence.getEventPointer (3)->message.isNoteOff());
+            expectEquals (sequence.getEventTime (3), 7.0 * Edit::ticksPerQuarterNote);
+        }
+
+        beginTest ("Muted clips aren't rendered");
+        {
+            clip->setMuted (true);
+            expectEquals (Renderer::createMidiSequenceFromClips (r).getNumEvents(), 0);
+            clip->setMuted (false);
+        }
+    }
+};
+
+static RendererMidiTests rendererMidiTests;
+
+//==============================================================================
+class RenderEditsTests   : public juce::UnitTest
+{
+public:
+    RenderEditsTests() : juce::UnitTest ("Renderer renderEdits", "Tracktion:Longer") {}
+
+    void runTest() override
+    {
+        auto& engine = *Engine::getEngines().getFirst();
+        OwnedArray<Edit> edits;
+        OwnedArray<TemporaryFile> files;
+        Array<Renderer::Parameters> renders;
+
+        for (int i = 0; i < 4; ++i)
+        {
+            auto edit = edits.add (Edit::createSingleTrackEdit (engine).release());
+            auto clip = getAudioTracks (*edit)[0]->insertMIDIClip ({ 0.0, 2.0 }, nullptr);
+            clip->getSequence().addNote (60 + i, 0.0, 1.0, 100, 0, nullptr);
+
+            Renderer::Parameters r (*edit);
+            r.tracksToDo.setBit (0);
+            r.createMidiFile = true;
+            r.time = { 0.0, 1.0 };
+            r.destFile = files.add (new TemporaryFile (".mid"))->getFile();
+            renders.add (r);
+        }
+
+        // A render with nothing to do still gets a result
+        renders.getReference (2).tracksToDo.clear();
+
+        beginTest ("Edits are rendered concurrently");
+        {
+            auto results = Renderer::renderEdits ("Test", renders, 2);
+            expectEquals (results.size(), renders.size());
+
+            for (int i = 0; i < renders.size(); ++i)
+            {
+                expect (results[i] == (i == 2 ? File() : renders[i].destFile));
+                expect (i == 2 || results[i].getSize() > 0);
+            }
+        }
+    }
+};
+
+static RenderEditsTests renderEditsTests;
+
+#endif
+
 }
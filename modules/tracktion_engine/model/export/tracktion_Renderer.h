@@ -55,9 +55,40 @@ public:
         bool useMasterPlugins = false;
         bool realTimeRender = false;
         bool ditheringEnabled = false;
+        Ditherer::NoiseShaping noiseShaping = Ditherer::NoiseShaping::secondOrder;
         bool separateTracks = false;
         bool addAntiDenormalisationNoise = false;
 
+        /** A set of tracks that should be written to its own file. */
+        struct Stem
+        {
+            juce::BigInteger tracksToDo;
+            juce::File destFile;
+        };
+
+        /** If this isn't empty, each stem is written to its own file from a single pass
+            over the Edit instead of rendering destFile. This can't be used with
+            normalising, trimming, master plugins or MIDI files.
+        */
+        juce::Array<Stem> stems;
+
+        /** The number of threads to render on, or 0 to use EngineBehaviour::getNumberOfCPUsToUseForAudio().
+            When ENABLE_EXPERIMENTAL_TRACKTION_GRAPH is on and this is more than 1, the tracks
+            are rendered on a tracktion_graph::MultiThreadedNodePlayer.
+        */
+        int numThreadsForRendering = 0;
+
+        /** If this is set, each block is also pushed to the sink as it's rendered.
+            The destFile can be left empty to only render to the sink.
+        */
+        RenderSink* sink = nullptr;
+
+        /** If this is true, the render carries on past the end of the time range until
+            it's cancelled or the sink stops it, e.g. to feed a live stream. This can't be
+            used with normalising, trimming or stems.
+        */
+        bool renderContinuously = false;
+
         int quality = 0;
         juce::StringPairArray metadata;
         ProjectItem::Category category = ProjectItem::Category::none;
@@ -105,9 +136,11 @@ public:
 
         //==============================================================================
         bool performNormalisingAndTrimming (const Renderer::Parameters& target,
-                                            const Renderer::Parameters& intermediate);
+                                            const Renderer::Parameters& intermediate,
+                                            juce::Range<juce::int64> nonSilentRange);
         bool renderAudio (Renderer::Parameters&);
         bool renderMidi (Renderer::Parameters&);
+        bool renderMidiFromAudioNode (Renderer::Parameters&, juce::MidiMessageSequence&);
 
         static void flushAllPlugins (PlayHead&, const Plugin::Array&, double sampleRate, int samplesPerBlock);
         static void setAllPluginsRealtime (const Plugin::Array&, bool realtime);
@@ -131,6 +164,44 @@ public:
     /** */
     static juce::File renderToFile (const juce::String& taskDescription, const Parameters& params);
 
+    /** Renders the Edit once and encodes each of the targets from the result, so the plugins
+        are only initialised and played through once however many files are needed.
+
+        The render parameters set what's rendered: the tracks, clips, plugins, time range and
+        sample rate. Each target sets how its file is written: its destFile, audioFormat,
+        sampleRateForAudio, bitDepth, quality, dithering, normalising, trimming and metadata.
+        A target's time can be a section of the render's time, or empty to use all of it.
+
+        Targets at a different sample rate to the render are resampled from it with a
+        mastering quality SincResampler before they're dithered, so e.g. 48k/24 and 44.1k/16
+        deliverables only need one pass over the Edit. A target sampleRateForAudio of 0
+        uses the render's rate.
+
+        If the render has stems, each target needs a stem with a destFile for each of them.
+        The targets are encoded concurrently and the files that were written are returned.
+    */
+    static juce::Array<juce::File> renderToFiles (const juce::String& taskDescription,
+                                                  const Parameters& render,
+                                                  const juce::Array<Parameters>& targets);
+
+    /** Renders several Edits at the same time, e.g. for a batch of loops or stem conversions,
+        and returns the file each one wrote, in the same order as the parameters. A render
+        that failed or couldn't be started returns File().
+
+        Each set of parameters must be for a different Edit, all in the same Engine. The Edits
+        are rendered on their own threads, numConcurrentRenders at a time, or as many as
+        there are CPUs if this is 0. Each render thread has its own AudioScratchBuffer arena,
+        and any parallel mixing is shared fairly between the Edits by the Engine's
+        RealtimeWorkerPool. Renders that don't ask for a number of threads are given an even
+        share of them.
+
+        This should be called on the message thread, as the graphs are built and the plugins
+        initialised there whilst the renders run in the background.
+    */
+    static juce::Array<juce::File> renderEdits (const juce::String& taskDescription,
+                                                const juce::Array<Parameters>& renders,
+                                                int numConcurrentRenders = 0);
+
     /** */
     static bool renderToFile (const juce::String& taskDescription,
                               const juce::File& outputFile,
@@ -141,9 +212,30 @@ public:
                               juce::Array<Clip*> clips = {},
                               bool useThread = true);
 
-    /** Creates an AudioNode to render the given Edit i.e. a single graph rather than split over devices. */
+    /** Returns the block size renders should use by default.
+        Real-time renders use the device's block size, offline ones use larger blocks as
+        they're much quicker to process.
+    */
+    static int getBlockSizeForRendering (Engine&, bool realTime);
+
+    /** Creates an AudioNode to render the given Edit i.e. a single graph rather than split over devices.
+        If there are any stems, the output of each one is also kept so they can be written
+        to their own files by a RenderTask.
+    */
     static AudioNode* createRenderingAudioNode (const Parameters&);
 
+    /** Returns true if a MIDI render can be taken straight from the MIDI clips' sequences,
+        without creating an AudioNode or playing the Edit. This is the case if there aren't
+        any plugins, modifiers, comps or routing on the tracks that could change the MIDI.
+        A RenderTask for a MIDI file will do this if it's given a null AudioNode.
+    */
+    static bool canRenderMidiFromClips (const Parameters&);
+
+    /** Creates the MIDI for a render from the MIDI clips' sequences, with their quantisation,
+        groove and MPE expression applied, timestamped in ticks from the start of the render.
+    */
+    static juce::MidiMessageSequence createMidiSequenceFromClips (const Parameters&);
+
     //==============================================================================
     /** @see measureStatistics()
     */
@@ -337,8 +337,13 @@ void AudioTrack::initialise()
 
     ClipTrack::initialise();
 
-    if (frozenIndividually && ! getFreezeFile().existsAsFile())
-        setFrozen (false, individualFreeze);
+    if (frozenIndividually)
+    {
+        auto freezeFiles = getFreezeFiles();
+
+        if (freezeFiles.isEmpty() || ! std::all_of (freezeFiles.begin(), freezeFiles.end(), [] (const File& f) { return f.existsAsFile(); }))
+            setFrozen (false, individualFreeze);
+    }
 
     output->initialise();
 }
@@ -882,6 +887,49 @@ bool AudioTrack::canUseBufferedAudioNode()
     return ! pluginList.needsConstantBufferSize();
 }
 
+bool AudioTrack::canUseAnticipativeAudioNode()
+{
+    // The track gets rendered ahead of the others so it can't have any live inputs, or
+    // send or receive audio from other tracks in the same block
+
+    if (! AnticipativeAudioNode::isAnticipativeProcessingEnabled (edit.engine))
+        return false;
+
+    if (waveInputDevice->isEnabled() || midiInputDevice->isEnabled())
+        return false;
+
+    if (isSidechainSource() || isRackSource() || pluginList.needsConstantBufferSize())
+        return false;
+
+    if (auto dest = getOutput().getOutputDevice (true))
+        if (dest->isMidi())
+            return false;
+
+    for (auto p : pluginList)
+        if (p->getSidechainSourceID().isValid()
+             || dynamic_cast<AuxSendPlugin*> (p) != nullptr
+             || dynamic_cast<AuxReturnPlugin*> (p) != nullptr
+             || dynamic_cast<InsertPlugin*> (p) != nullptr)
+            return false;
+
+    return true;
+}
+
+bool AudioTrack::canUseAnticipativeClipsNode (AudioNode& clipsNode)
+{
+    if (! AnticipativeAudioNode::isAnticipativeProcessingEnabled (edit.engine))
+        return false;
+
+    // Any MIDI from the clips would be lost, and the plugins need it in the same block
+    AudioNodeProperties props;
+    props.hasAudio = false;
+    props.hasMidi = false;
+    props.numberOfChannels = 0;
+    clipsNode.getAudioNodeProperties (props);
+
+    return props.hasAudio && ! props.hasMidi;
+}
+
 static void addTrackInputs (const CreateAudioNodeParams& params,
                             MixerAudioNode& mixer, const juce::Array<Track*>& inputTracks)
 {
@@ -961,6 +1009,7 @@ AudioNode* AudioTrack::createAudioNode (const CreateAudioNodeParams& params)
     {
         CRASH_TRACER
         AudioNode* clipsNode = new PlayHeadAudioNode (clipCombiner.release());
+        bool clipsNeedRenderingLive = false;
 
         {
             juce::Array<AudioClipBase*> araClips;
@@ -972,7 +1021,7 @@ AudioNode* AudioTrack::createAudioNode (const CreateAudioNodeParams& params)
 
             if (araClips.size() > 0)
             {
-                auto mixer = new MixerAudioNode (use64Bit, shouldUseMultiCPU);
+                auto mixer = new MixerAudioNode (edit, use64Bit, shouldUseMultiCPU);
                 mixer->addInput (clipsNode);
 
                 for (auto acb : araClips)
@@ -980,17 +1029,30 @@ AudioNode* AudioTrack::createAudioNode (const CreateAudioNodeParams& params)
                         mixer->addInput (araNode);
 
                 clipsNode = mixer;
+                clipsNeedRenderingLive = true;
             }
         }
 
         for (int i = clips.size(); --i >= 0;)
+        {
             if (auto pl = clips.getUnchecked (i)->getPluginList())
-                clipsNode = pl->attachNodesForPluginsNeedingLivePlay (clipsNode);
+            {
+                auto withPlugins = pl->attachNodesForPluginsNeedingLivePlay (clipsNode);
+                clipsNeedRenderingLive = clipsNeedRenderingLive || withPlugins != clipsNode;
+                clipsNode = withPlugins;
+            }
+        }
 
         if (compGroup != -1)
             if (auto tc = edit.getTrackCompManager().getTrackComp (this))
                 clipsNode = tc->createAudioNode (*this, clipsNode);
 
+        // When monitoring a live input, only the input and the track's plugins have to be
+        // rendered in the callback, so the clips can be rendered ahead like a track without inputs
+        if (! params.forRendering && liveNodes.size() > 0
+             && ! clipsNeedRenderingLive && canUseAnticipativeClipsNode (*clipsNode))
+            clipsNode = new AnticipativeAudioNode (clipsNode, jmax (1024, edit.engine.getDeviceManager().getInternalBufferSize()));
+
         if (! listeners.isEmpty())
             clipsNode = new LiveMidiOutputAudioNode (*this, clipsNode);
 
@@ -1003,7 +1065,7 @@ AudioNode* AudioTrack::createAudioNode (const CreateAudioNodeParams& params)
                 if (! params.forRendering)
                     clipsNode = new TrackMutingAudioNode (*this, clipsNode, true);
 
-                auto mixer = new MixerAudioNode (use64Bit, shouldUseMultiCPU);
+                auto mixer = new MixerAudioNode (edit, use64Bit, shouldUseMultiCPU);
                 mixer->addInput (clipsNode);
 
                 addTrackInputs (params, *mixer, inputTracks);
@@ -1015,7 +1077,7 @@ AudioNode* AudioTrack::createAudioNode (const CreateAudioNodeParams& params)
                 node = new TrackMutingAudioNode (*this, clipsNode, ! params.forRendering);
             }
 
-            auto mixer = new MixerAudioNode (use64Bit, false);
+            auto mixer = new MixerAudioNode (edit, use64Bit, false);
             mixer->addInput (node);
 
             for (int i = liveNodes.size(); --i >= 0;)
@@ -1038,7 +1100,7 @@ AudioNode* AudioTrack::createAudioNode (const CreateAudioNodeParams& params)
                 if (! params.forRendering)
                     clipsNode = new TrackMutingAudioNode (*this, clipsNode, true);
 
-                auto mixer = new MixerAudioNode (use64Bit, shouldUseMultiCPU);
+                auto mixer = new MixerAudioNode (edit, use64Bit, shouldUseMultiCPU);
                 mixer->addInput (clipsNode);
 
                 addTrackInputs (params, *mixer, inputTracks);
@@ -1069,18 +1131,18 @@ AudioNode* AudioTrack::createAudioNode (const CreateAudioNodeParams& params)
 
             if (inputTracks.size() > 0)
             {
-                mixer = new MixerAudioNode (use64Bit, shouldUseMultiCPU);
+                mixer = new MixerAudioNode (edit, use64Bit, shouldUseMultiCPU);
 
                 addTrackInputs (params, *mixer, inputTracks);
 
                 node = new TrackMutingAudioNode (*this, mixer, false);
 
-                mixer = new MixerAudioNode (use64Bit, shouldUseMultiCPU);
+                mixer = new MixerAudioNode (edit, use64Bit, shouldUseMultiCPU);
                 mixer->addInput (node);
             }
             else
             {
-                mixer = new MixerAudioNode (use64Bit, false);
+                mixer = new MixerAudioNode (edit, use64Bit, false);
             }
 
             mixer->addInput (new PlayHeadAudioNode (clipCombiner.release()));
@@ -1102,7 +1164,7 @@ AudioNode* AudioTrack::createAudioNode (const CreateAudioNodeParams& params)
         {
             if (inputTracks.size() > 0)
             {
-                auto mixer = new MixerAudioNode (use64Bit, shouldUseMultiCPU);
+                auto mixer = new MixerAudioNode (edit, use64Bit, shouldUseMultiCPU);
 
                 addTrackInputs (params, *mixer, inputTracks);
 
@@ -1115,7 +1177,7 @@ AudioNode* AudioTrack::createAudioNode (const CreateAudioNodeParams& params)
             }
             else
             {
-                node = new MixerAudioNode (false, false);
+                node = new MixerAudioNode (edit, false, false);
 
                 if (params.includePlugins)
                 {
@@ -1143,8 +1205,13 @@ AudioNode* AudioTrack::createAudioNode (const CreateAudioNodeParams& params)
         if (midiInputDevice->isEnabled())
             node = midiInputDevice->createMidiEventSnifferNode (node);
 
-        if (liveNodes.isEmpty() && inputTracks.isEmpty() && canUseBufferedAudioNode())
-            node = new BufferingAudioNode (node, edit.engine.getDeviceManager().getInternalBufferSize());
+        if (liveNodes.isEmpty() && inputTracks.isEmpty())
+        {
+            if (canUseAnticipativeAudioNode())
+                node = new AnticipativeAudioNode (node, jmax (1024, edit.engine.getDeviceManager().getInternalBufferSize()));
+            else if (canUseBufferedAudioNode())
+                node = new BufferingAudioNode (node, edit.engine.getDeviceManager().getInternalBufferSize());
+        }
     }
 
     return node;
@@ -1192,15 +1259,12 @@ bool AudioTrack::mergeInMidiSequence (const MidiMessageSequence& original, doubl
 
     if (mc == nullptr)
     {
-        for (auto c : getClips())
+        for (auto c : getClipsInRange ({ start, end }))
         {
-            if (c->getPosition().time.overlaps ({ start, end }))
-            {
-                mc = dynamic_cast<MidiClip*> (c);
+            mc = dynamic_cast<MidiClip*> (c);
 
-                if (mc != nullptr)
-                    break;
-            }
+            if (mc != nullptr)
+                break;
         }
     }
 
@@ -1316,6 +1380,10 @@ AudioTrack::FreezePointRemovalInhibitor::~FreezePointRemovalInhibitor()
 void AudioTrack::freezeTrack()
 {
     insertFreezePointIfRequired();
+
+    // This needs to be done before the plugins are disabled so it matches the last freeze
+    auto segmentHashes = createFreezeSegmentHashes();
+
     const FreezePointPlugin::ScopedPluginDisabler spd (*this, Range<int> (getIndexOfFreezePoint(),
                                                                           pluginList.size()));
 
@@ -1327,16 +1395,14 @@ void AudioTrack::freezeTrack()
 
     BigInteger trackNum;
     trackNum.setBit (getIndexInEditTrackList());
-    auto freezeFile = getFreezeFile();
-    freezeFile.deleteFile();
+    getFreezeFile().deleteFile();
 
     Renderer::Parameters r (edit);
     r.tracksToDo = trackNum;
-    r.destFile = freezeFile;
     r.audioFormat = edit.engine.getAudioFileFormatManager().getFrozenFileFormat();
+    r.quality = FloatAudioFormat::planarQualityIndex;
     r.blockSizeForAudio = dm.getBlockSize();
     r.sampleRateForAudio = dm.getSampleRate();
-    r.time = { 0.0, getLengthIncludingInputTracks() };
     r.canRenderInMono = true;
     r.mustRenderInMono = false;
     r.usePlugins = true;
@@ -1345,19 +1411,43 @@ void AudioTrack::freezeTrack()
     r.category = ProjectItem::Category::frozen;
 
     const Edit::ScopedRenderStatus srs (edit, true);
-    auto renderedItem = Renderer::renderToProjectItem (TRANS("Creating track freeze for \"XDVX\"")
-                                                        .replace ("XDVX", getName()) + "...", r);
+    const auto freezeLength = getLengthIncludingInputTracks();
+    StringArray hashStrings;
+    bool renderedAllSegments = ! segmentHashes.isEmpty();
+
+    for (int i = 0; i < segmentHashes.size(); ++i)
+    {
+        hashStrings.add (String::toHexString (segmentHashes[i]));
+        r.destFile = TemporaryFileManager::getFreezeFileForTrackSegment (*this, segmentHashes[i]);
+
+        // Nothing in this segment has changed since it was last rendered
+        if (r.destFile.existsAsFile())
+            continue;
+
+        auto segmentTime = getFreezeSegmentTime (i, freezeLength);
+        r.time = { jmax (0.0, segmentTime.getStart() - freezeSegmentTailLength), segmentTime.getEnd() };
+
+        Renderer::renderToFile (TRANS("Creating track freeze for \"XDVX\"")
+                                    .replace ("XDVX", getName()) + "...", r);
+
+        if (! r.destFile.existsAsFile())
+        {
+            renderedAllSegments = false;
+            break;
+        }
+    }
 
     freezePlugins (Range<int> (0, getIndexOfFreezePoint()));
     setMute (shouldBeMuted);
 
-    if (! r.destFile.existsAsFile())
+    if (! renderedAllSegments)
     {
         edit.engine.getUIBehaviour().showWarningMessage (TRANS("Nothing to freeze"));
         setFrozen (false, individualFreeze);
         return;
     }
 
+    state.setProperty (IDs::freezeSegments, hashStrings.joinIntoString (" "), nullptr);
     changed();
 }
 
@@ -1474,12 +1564,143 @@ File AudioTrack::getFreezeFile() const noexcept
     return TemporaryFileManager::getFreezeFileForTrack (*this);
 }
 
+juce::Array<juce::File> AudioTrack::getFreezeFiles() const
+{
+    juce::Array<juce::File> files;
+
+    for (auto hash : getFreezeSegmentHashes())
+        files.add (TemporaryFileManager::getFreezeFileForTrackSegment (*this, hash));
+
+    // Freezes from before they were split into segments used a single file
+    if (files.isEmpty())
+        files.add (getFreezeFile());
+
+    return files;
+}
+
+namespace FreezeSegmentHelpers
+{
+    /** Hashes a state in order, ignoring any clips outside the range and the frozen
+        flag as that changes when the track is frozen.
+    */
+    static juce::int64 hashState (juce::int64 hash, const juce::ValueTree& v, EditTimeRange range)
+    {
+        if (Clip::isClipState (v))
+        {
+            const double start = v[IDs::start];
+
+            if (! EditTimeRange (start, start + (double) v[IDs::length]).overlaps (range))
+                return hash;
+        }
+
+        hash = hash * 31 + v.getType().toString().hashCode64();
+
+        for (int i = 0; i < v.getNumProperties(); ++i)
+        {
+            auto name = v.getPropertyName (i);
+
+            if (name != IDs::frozen)
+                hash = (hash * 31 + name.toString().hashCode64()) * 31 + v[name].toString().hashCode64();
+        }
+
+        for (const auto& child : v)
+            hash = hashState (hash, child, range);
+
+        return hash;
+    }
+}
+
+juce::Array<juce::int64> AudioTrack::createFreezeSegmentHashes()
+{
+    CRASH_TRACER
+    using namespace FreezeSegmentHelpers;
+
+    juce::Array<juce::int64> hashes;
+    const auto freezeLength = getLengthIncludingInputTracks();
+    const auto freezePointIndex = getIndexOfFreezePoint();
+    const auto sampleRate = edit.engine.getDeviceManager().getSampleRate();
+
+    for (auto p : pluginList)
+        p->flushPluginStateToValueTree();
+
+    for (int i = 0; getFreezeSegmentTime (i, freezeLength).getStart() < freezeLength; ++i)
+    {
+        const auto segmentTime = getFreezeSegmentTime (i, freezeLength);
+        const EditTimeRange renderTime (jmax (0.0, segmentTime.getStart() - freezeSegmentTailLength), segmentTime.getEnd());
+
+        auto hash = (juce::int64) (segmentTime.getStart() * 1000.0) * 31 + (juce::int64) (segmentTime.getEnd() * 1000.0);
+        hash = hash * 31 + (juce::int64) sampleRate;
+        hash = hash * 31 + edit.tempoSequence.createHashForTemposInRange ({ 0.0, segmentTime.getEnd() });
+
+        // Anything after the freeze point isn't rendered
+        for (int j = 0; j < freezePointIndex; ++j)
+            hash = hashState (hash, pluginList[j]->state, renderTime);
+
+        for (auto c : getClipsInRange (renderTime))
+        {
+            hash = hashState (hash, c->state, renderTime);
+
+            // The clip's state won't change if its source file is overwritten
+            if (auto acb = dynamic_cast<AudioClipBase*> (c))
+                hash = hash * 31 + TemporaryFileManager::getFileContentHash (acb->getOriginalFile());
+        }
+
+        for (auto t : getInputTracks())
+            hash = hashState (hash, t->state, renderTime);
+
+        hashes.add (hash);
+    }
+
+    return hashes;
+}
+
+juce::Array<juce::int64> AudioTrack::getFreezeSegmentHashes() const
+{
+    juce::Array<juce::int64> hashes;
+
+    for (auto& s : juce::StringArray::fromTokens (state[IDs::freezeSegments].toString(), false))
+        hashes.add (s.getHexValue64());
+
+    return hashes;
+}
+
+EditTimeRange AudioTrack::getFreezeSegmentTime (int segmentIndex, double freezeLength)
+{
+    return { segmentIndex * freezeSegmentLength,
+             jmin ((segmentIndex + 1) * freezeSegmentLength, freezeLength) };
+}
+
 AudioNode* AudioTrack::createFreezeAudioNode (bool addAntiDenormalisationNoise)
 {
-    AudioNode* node = new WaveAudioNode (AudioFile (edit.engine, getFreezeFile()),
-                                         { 0.0, getLengthIncludingInputTracks() },
-                                         0.0, {}, {},
-                                         1.0, AudioChannelSet::stereo());
+    const auto freezeLength = getLengthIncludingInputTracks();
+    auto segmentHashes = getFreezeSegmentHashes();
+    AudioNode* node = nullptr;
+
+    if (segmentHashes.isEmpty())
+    {
+        node = new WaveAudioNode (AudioFile (edit.engine, getFreezeFile()),
+                                  { 0.0, freezeLength },
+                                  0.0, {}, {},
+                                  1.0, AudioChannelSet::stereo());
+    }
+    else
+    {
+        // Each segment's file starts with the tail from before it, which is skipped
+        auto combiner = new CombiningAudioNode();
+
+        for (int i = 0; i < segmentHashes.size(); ++i)
+        {
+            const auto segmentTime = getFreezeSegmentTime (i, freezeLength);
+            const auto fileStart = jmax (0.0, segmentTime.getStart() - freezeSegmentTailLength);
+
+            combiner->addInput (segmentTime,
+                                new WaveAudioNode (AudioFile (edit.engine, TemporaryFileManager::getFreezeFileForTrackSegment (*this, segmentHashes[i])),
+                                                   segmentTime, segmentTime.getStart() - fileStart, {}, {},
+                                                   1.0, AudioChannelSet::stereo()));
+        }
+
+        node = combiner;
+    }
 
     node = pluginList.createAudioNode (node, addAntiDenormalisationNoise);
 
@@ -81,6 +81,19 @@ public:
     void removeFreezePoint();
     void freezeTrackAsync() const;
 
+    /** Returns the files the frozen track is played from.
+        The freeze is split into segments of freezeSegmentLength seconds, each rendered to
+        a file named after a hash of everything in its range, so re-freezing only has to
+        render the segments that have changed.
+    */
+    juce::Array<juce::File> getFreezeFiles() const;
+
+    /** The length of each segment of a track freeze. */
+    static constexpr double freezeSegmentLength = 30.0;
+
+    /** How far before each freeze segment its render starts, to capture the tails of plugins and clips. */
+    static constexpr double freezeSegmentTailLength = 4.0;
+
     //==============================================================================
     /** creates an audio node to play this track.
         (only creates one if this track doesn't feed into another track)
@@ -215,6 +228,8 @@ private:
 
     //==============================================================================
     bool canUseBufferedAudioNode();
+    bool canUseAnticipativeAudioNode();
+    bool canUseAnticipativeClipsNode (AudioNode&);
 
     void freezeTrack();
     bool insertFreezePointIfRequired();
@@ -223,6 +238,9 @@ private:
     void freezePlugins (juce::Range<int> pluginsToFreeze);
     void unFreezeTrack();
     juce::File getFreezeFile() const noexcept;
+    juce::Array<juce::int64> createFreezeSegmentHashes();
+    juce::Array<juce::int64> getFreezeSegmentHashes() const;
+    static EditTimeRange getFreezeSegmentTime (int segmentIndex, double freezeLength);
     AudioNode* createFreezeAudioNode (bool addAntiDenormalisationNoise);
 
     void updateTracksToGhost();
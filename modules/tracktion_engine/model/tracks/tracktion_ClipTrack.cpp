@@ -21,7 +21,7 @@ struct ClipTrack::ClipList  : public ValueTreeObjectList<Clip>,
         rebuildObjects();
 
         editLoadedCallback.reset (new Edit::LoadFinishedCallback<ClipList> (*this, ct.edit));
-        clipTrack.trackItemsDirty = true;
+        clipTrack.clipsChanged();
     }
 
     ~ClipList() override
@@ -53,7 +53,7 @@ struct ClipTrack::ClipList  : public ValueTreeObjectList<Clip>,
             if (newClip->isGrouped())
                 clipTrack.refreshCollectionClips (*newClip);
 
-            clipTrack.trackItemsDirty = true;
+            clipTrack.clipsChanged();
             newClip->incReferenceCount();
 
             return newClip.get();
@@ -69,7 +69,7 @@ struct ClipTrack::ClipList  : public ValueTreeObjectList<Clip>,
         if (c == nullptr)
             return;
 
-        clipTrack.trackItemsDirty = true;
+        clipTrack.clipsChanged();
         c->decReferenceCount();
     }
 
@@ -87,7 +87,7 @@ struct ClipTrack::ClipList  : public ValueTreeObjectList<Clip>,
             if (! clipTrack.edit.isLoading())
                 triggerAsyncUpdate();
 
-            clipTrack.trackItemsDirty = true;
+            clipTrack.clipsChanged();
         }
     }
 
@@ -101,7 +101,7 @@ struct ClipTrack::ClipList  : public ValueTreeObjectList<Clip>,
             if (id == IDs::start || id == IDs::length)
             {
                 triggerAsyncUpdate();
-                clipTrack.trackItemsDirty = true;
+                clipTrack.clipsChanged();
             }
         }
     }
@@ -156,12 +156,95 @@ struct ClipTrack::ClipList  : public ValueTreeObjectList<Clip>,
             if (auto acb = dynamic_cast<AudioClipBase*> (c))
                 acb->updateAutoCrossfadesAsync (false);
 
-        clipTrack.trackItemsDirty = true;
+        clipTrack.clipsChanged();
     }
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ClipList)
 };
 
+//==============================================================================
+/**
+    Finds the clips near a time range without checking all of them.
+
+    The clips are sorted by their start times, with an implicit tree over them holding
+    the latest end time under each node, so any part of the tree that ends before the
+    range can be skipped. It's rebuilt the next time it's needed after a clip's added,
+    removed or moved.
+*/
+struct ClipTrack::ClipTimeIndex
+{
+    void rebuild (const juce::Array<Clip*>& clips)
+    {
+        entries.clear();
+        entries.reserve ((size_t) clips.size());
+
+        for (auto c : clips)
+        {
+            auto time = c->getPosition().time;
+            entries.push_back ({ time.getStart(), time.getEnd(), c });
+        }
+
+        std::stable_sort (entries.begin(), entries.end(),
+                          [] (const Entry& a, const Entry& b) { return a.start < b.start; });
+
+        maxEnds.assign (entries.size() * 4, 0.0);
+
+        if (! entries.empty())
+            buildNode (0, 0, entries.size());
+    }
+
+    /** Adds the clips that start at or before the range's end and end at or after its start. */
+    void find (EditTimeRange range, juce::Array<Clip*>& results) const
+    {
+        if (entries.empty())
+            return;
+
+        // Nothing starting after the range can be in it
+        auto numStartingBefore = (size_t) (std::upper_bound (entries.begin(), entries.end(), range.getEnd(),
+                                                             [] (double t, const Entry& e) { return t < e.start; })
+                                            - entries.begin());
+
+        findInNode (0, 0, entries.size(), numStartingBefore, range.getStart(), results);
+    }
+
+private:
+    struct Entry
+    {
+        double start, end;
+        Clip* clip;
+    };
+
+    std::vector<Entry> entries;
+    std::vector<double> maxEnds;
+
+    double buildNode (size_t node, size_t begin, size_t end)
+    {
+        if (end - begin == 1)
+            return maxEnds[node] = entries[begin].end;
+
+        auto mid = (begin + end) / 2;
+        return maxEnds[node] = std::max (buildNode (node * 2 + 1, begin, mid),
+                                         buildNode (node * 2 + 2, mid, end));
+    }
+
+    void findInNode (size_t node, size_t begin, size_t end, size_t limit,
+                     double rangeStart, juce::Array<Clip*>& results) const
+    {
+        if (begin >= limit || maxEnds[node] < rangeStart)
+            return;
+
+        if (end - begin == 1)
+        {
+            results.add (entries[begin].clip);
+            return;
+        }
+
+        auto mid = (begin + end) / 2;
+        findInNode (node * 2 + 1, begin, mid, limit, rangeStart, results);
+        findInNode (node * 2 + 2, mid, end, limit, rangeStart, results);
+    }
+};
+
 //==============================================================================
 struct ClipTrack::CollectionClipList  : public ValueTree::Listener
 {
@@ -313,6 +396,7 @@ ClipTrack::ClipTrack (Edit& ed, const ValueTree& v, double defaultHeight, double
 {
     ClipList::sortClips (state, &edit.getUndoManager());
 
+    clipTimeIndex = std::make_unique<ClipTimeIndex>();
     collectionClipList.reset (new CollectionClipList (*this, state));
     clipList.reset (new ClipList (*this, state));
 }
@@ -433,6 +517,35 @@ const juce::Array<Clip*>& ClipTrack::getClips() const noexcept
     return clipList->objects;
 }
 
+void ClipTrack::findClipsNear (EditTimeRange range, juce::Array<Clip*>& results) const
+{
+    TRACKTION_ASSERT_MESSAGE_THREAD
+
+    if (clipTimeIndexDirty)
+    {
+        clipTimeIndexDirty = false;
+        clipTimeIndex->rebuild (clipList->objects);
+    }
+
+    clipTimeIndex->find (range, results);
+}
+
+juce::Array<Clip*> ClipTrack::getClipsInRange (EditTimeRange range) const
+{
+    juce::Array<Clip*> clips;
+    findClipsNear (range, clips);
+    clips.removeIf ([range] (Clip* c) { return ! c->getPosition().time.overlaps (range); });
+    return clips;
+}
+
+juce::Array<Clip*> ClipTrack::getClipsAt (double time) const
+{
+    juce::Array<Clip*> clips;
+    findClipsNear ({ time, time }, clips);
+    clips.removeIf ([time] (Clip* c) { return ! c->getPosition().time.contains (time); });
+    return clips;
+}
+
 Clip* ClipTrack::findClipForID (EditItemID id) const
 {
     for (auto* c : clipList->objects)
@@ -538,7 +651,7 @@ Clip* ClipTrack::insertClipWithState (juce::ValueTree clipState)
         {
             auto sourceFile = SourceFileReference::findFileFromString (edit, clipState[IDs::source]);
 
-            if (sourceFile.exists())
+            if (edit.getSourceFileCache().exists (sourceFile))
             {
                 auto loopInfo = AudioFile (edit.engine, sourceFile).getInfo().loopInfo;
 
@@ -745,9 +858,8 @@ void ClipTrack::deleteRegion (EditTimeRange range, SelectionManager* sm)
     // make a copied list first, as they'll get moved out-of-order..
     Clip::Array clipsToDo;
 
-    for (auto c : getClips())
-        if (c->getPosition().time.overlaps (range))
-            clipsToDo.add (c);
+    for (auto c : getClipsInRange (range))
+        clipsToDo.add (c);
 
     for (int i = clipsToDo.size(); --i >= 0;)
         deleteRegionOfClip (clipsToDo.getUnchecked (i), range, sm);
@@ -909,9 +1021,8 @@ void ClipTrack::splitAt (double time)
     // make a copied list first, as they'll get moved out-of-order..
     Clip::Array clipsToDo;
 
-    for (auto c : *clipList)
-        if (c->getPosition().time.contains (time))
-            clipsToDo.add (c);
+    for (auto c : getClipsAt (time))
+        clipsToDo.add (c);
 
     for (auto c : clipsToDo)
         splitClip (*c, time);
@@ -24,6 +24,14 @@ public:
     const juce::Array<Clip*>& getClips() const noexcept;
     Clip* findClipForID (EditItemID) const override;
 
+    /** Returns the clips that overlap a range, in order of their start times.
+        This uses an index of the clips' positions so it doesn't have to check every clip.
+    */
+    juce::Array<Clip*> getClipsInRange (EditTimeRange) const;
+
+    /** Returns the clips that contain a time, in order of their start times. */
+    juce::Array<Clip*> getClipsAt (double time) const;
+
     //==============================================================================
     void refreshCollectionClips (Clip& newClip);
     CollectionClip* getCollectionClip (int index) const noexcept;
@@ -118,6 +126,13 @@ protected:
     mutable bool trackItemsDirty = false;
     mutable juce::Array<TrackItem*> trackItems;
 
+    struct ClipTimeIndex;
+    std::unique_ptr<ClipTimeIndex> clipTimeIndex;
+    mutable bool clipTimeIndexDirty = true;
+
+    void clipsChanged() noexcept    { trackItemsDirty = true; clipTimeIndexDirty = true; }
+    void findClipsNear (EditTimeRange, juce::Array<Clip*>&) const;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ClipTrack)
 };
 
@@ -134,7 +134,6 @@ AudioNode* FolderTrack::createAudioNode (const CreateAudioNodeParams& params)
     if (! isSubmixFolder())
         return {};
 
-    juce::Array<Track*> allTracks (getAllTracks (edit));
     juce::Array<AudioTrack*> subTracks (getAllAudioSubTracks (false));
 
     juce::Array<FolderTrack*> subFolders;
@@ -152,42 +151,68 @@ AudioNode* FolderTrack::createAudioNode (const CreateAudioNodeParams& params)
     const bool shouldUseMultiCPU = (subTracks.size() + subFolders.size()) > 1
                                     && edit.engine.getEngineBehaviour().getNumberOfCPUsToUseForAudio() > 1;
 
-    auto mixer = new MixerAudioNode (use64Bit, shouldUseMultiCPU);
+    auto mixer = new MixerAudioNode (edit, use64Bit, shouldUseMultiCPU);
 
-    // Create nodes for any submix tracks
-    for (auto t : subFolders)
+    for (auto t : getSubmixInputTracks (params))
     {
-        if (! t->isProcessing (true))
-            continue;
+        if (auto ft = dynamic_cast<FolderTrack*> (t))
+            mixer->addInput (ft->createAudioNode (params));
+        else if (auto at = dynamic_cast<AudioTrack*> (t))
+            mixer->addInput (at->createAudioNode (params));
+    }
 
-        if (t->isSubmixFolder())
-        {
-            mixer->addInput (t->createAudioNode (params));
-        }
-        else
+    return createSubmixOutputAudioNode (mixer, params);
+}
+
+juce::Array<Track*> FolderTrack::getSubmixInputTracks (const CreateAudioNodeParams& params) const
+{
+    juce::Array<Track*> allTracks (getAllTracks (edit));
+    juce::Array<Track*> inputs;
+
+    auto isAllowed = [&] (AudioTrack* at)
+    {
+        return params.allowedTracks == nullptr || (*params.allowedTracks)[allTracks.indexOf (at)];
+    };
+
+    // First any submix tracks
+    for (auto t : getAllSubTracks (false))
+    {
+        if (auto ft = dynamic_cast<FolderTrack*> (t))
         {
-            for (auto at : t->getAllAudioSubTracks (false))
-                if (params.allowedTracks == nullptr || (*params.allowedTracks)[allTracks.indexOf (at)])
-                    mixer->addInput (at->createAudioNode (params));
+            if (! ft->isProcessing (true))
+                continue;
+
+            if (ft->isSubmixFolder())
+            {
+                inputs.add (ft);
+            }
+            else
+            {
+                for (auto at : ft->getAllAudioSubTracks (false))
+                    if (isAllowed (at))
+                        inputs.add (at);
+            }
         }
     }
 
-    // Then add any audio tracks
-    for (auto at : subTracks)
-        if (params.allowedTracks == nullptr || (*params.allowedTracks)[allTracks.indexOf (at)])
-            if (at->isProcessing (true))
-                mixer->addInput (at->createAudioNode (params));
+    // Then any audio tracks
+    for (auto at : getAllAudioSubTracks (false))
+        if (isAllowed (at) && at->isProcessing (true))
+            inputs.add (at);
+
+    return inputs;
+}
 
-    // And finally the effects
-    AudioNode* finalNode = mixer;
+AudioNode* FolderTrack::createSubmixOutputAudioNode (AudioNode* mixNode, const CreateAudioNodeParams& params)
+{
+    CRASH_TRACER
+    AudioNode* finalNode = mixNode;
 
     if (finalNode != nullptr)
         finalNode = params.includePlugins ? pluginList.createAudioNode (finalNode, params.addAntiDenormalisationNoise)
                                           : finalNode;
 
-    finalNode = new TrackMutingAudioNode (*this, finalNode, false);
-
-    return finalNode;
+    return new TrackMutingAudioNode (*this, finalNode, false);
 }
 
 bool FolderTrack::isMuted (bool includeMutingByDestination) const
@@ -42,6 +42,18 @@ public:
 
     AudioNode* createAudioNode (const CreateAudioNodeParams&);
 
+    /** Returns the tracks a submix folder mixes together: any of its sub-folders that are
+        submixes, followed by the audio tracks in its other sub-folders and its own audio tracks.
+        Tracks that aren't processing or aren't in the params' allowedTracks are left out.
+    */
+    juce::Array<Track*> getSubmixInputTracks (const CreateAudioNodeParams&) const;
+
+    /** Adds the folder's plugins and muting on top of a node that mixes its submix inputs.
+        createAudioNode uses this, and it can also be used to build the submix as a bus fed
+        by its inputs' nodes rather than having to nest their trees.
+    */
+    AudioNode* createSubmixOutputAudioNode (AudioNode* mixNode, const CreateAudioNodeParams&);
+
     //==============================================================================
     bool isFrozen (FreezeType) const override;
 
@@ -279,6 +279,16 @@ Plugin::Array Track::getAllPlugins() const
     return pluginList.getPlugins();
 }
 
+double Track::getPluginCpuUsage() const
+{
+    double total = 0.0;
+
+    for (auto p : getAllPlugins())
+        total += p->getCpuUsage();
+
+    return total;
+}
+
 void Track::sendMirrorUpdateToAllPlugins (Plugin& p) const
 {
     pluginList.sendMirrorUpdateToAllPlugins (p);
@@ -148,6 +148,9 @@ public:
 
     juce::Array<AutomatableEditItem*> getAllAutomatableEditItems() const;
     virtual Plugin::Array getAllPlugins() const;
+
+    /** Returns the sum of Plugin::getCpuUsage() for all the plugins in this track. */
+    double getPluginCpuUsage() const;
     virtual void sendMirrorUpdateToAllPlugins (Plugin&) const;
 
     void flipAllPluginsEnablement();
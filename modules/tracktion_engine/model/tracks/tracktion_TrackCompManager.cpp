@@ -648,20 +648,7 @@ AudioNode* TrackCompManager::createTrackCompAudioNode (AudioNode* input, const A
     if (muteTimes.isEmpty())
         return input;
 
-    input = new TimedMutingAudioNode (input, muteTimes);
-
-    for (auto r : nonMuteTimes)
-    {
-        auto fadeIn = r.withLength (crossfadeTime) - 0.0001;
-        auto fadeOut = fadeIn.movedToEndAt (r.getEnd() + 0.0001);
-
-        if (! (fadeIn.isEmpty() && fadeOut.isEmpty()))
-            input = new FadeInOutAudioNode (input, fadeIn, fadeOut,
-                                            AudioFadeCurve::convex,
-                                            AudioFadeCurve::convex, false);
-    }
-
-    return input;
+    return new CompTimelineAudioNode (input, CompTimelineAudioNode::Timeline::create (muteTimes, nonMuteTimes, crossfadeTime));
 }
 
 }
@@ -0,0 +1,346 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+/** The threads that render all the AnticipativeAudioNodes ahead. */
+struct AnticipativeAudioNode::RenderThreadPool
+{
+    RenderThreadPool()
+    {
+        for (int i = jmax (1, SystemStats::getNumCpus() / 2); --i >= 0;)
+            threads.add (new RenderThread (*this));
+    }
+
+    ~RenderThreadPool()
+    {
+        jassert (nodes.isEmpty());
+        threads.clear();
+    }
+
+    void addNode (AnticipativeAudioNode& node)
+    {
+        const ScopedWriteLock sl (lock);
+        nodes.addIfNotAlreadyThere (&node);
+    }
+
+    /** After this returns, none of the threads will be rendering the node. */
+    void removeNode (AnticipativeAudioNode& node)
+    {
+        const ScopedWriteLock sl (lock);
+        nodes.removeAllInstancesOf (&node);
+    }
+
+private:
+    struct RenderThread  : public Thread
+    {
+        RenderThread (RenderThreadPool& p)
+            : Thread ("anticipative render"), owner (p)
+        {
+            // Just below the audio thread
+            startThread (9);
+        }
+
+        ~RenderThread() override
+        {
+            stopThread (5000);
+        }
+
+        void run() override
+        {
+            FloatVectorOperations::disableDenormalisedNumberSupport();
+
+            while (! threadShouldExit())
+                if (! owner.renderNodes())
+                    wait (1);
+        }
+
+        RenderThreadPool& owner;
+    };
+
+    ReadWriteLock lock;
+    Array<AnticipativeAudioNode*> nodes;
+    OwnedArray<RenderThread> threads;
+
+    /** Renders a chunk of any nodes that need it, returning false if there was nothing to do.
+        Each node can only be rendered by one thread at a time, so the threads share them out.
+    */
+    bool renderNodes()
+    {
+        const ScopedReadLock sl (lock);
+        bool didRender = false;
+
+        for (auto node : nodes)
+            if (node->renderAheadIfNeeded())
+                didRender = true;
+
+        return didRender;
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (RenderThreadPool)
+};
+
+//==============================================================================
+AnticipativeAudioNode::AnticipativeAudioNode (AudioNode* source, int minChunk, int numChunks)
+    : SingleInputAudioNode (source), minChunkSize (minChunk), numChunksAhead (jmax (2, numChunks)),
+      tempBuffer (2, 0)
+{
+}
+
+AnticipativeAudioNode::~AnticipativeAudioNode()
+{
+    renderThreadPool->removeNode (*this);
+}
+
+//==============================================================================
+static bool hasCheckedAnticipativeProcessing = false;
+
+bool AnticipativeAudioNode::isAnticipativeProcessingEnabled (Engine& e)
+{
+    static bool enabled;
+
+    if (! hasCheckedAnticipativeProcessing)
+    {
+        enabled = e.getPropertyStorage().getProperty (SettingID::anticipativeProcessing, false);
+        hasCheckedAnticipativeProcessing = true;
+    }
+
+    return enabled;
+}
+
+void AnticipativeAudioNode::setAnticipativeProcessingEnabled (Engine& e, bool b)
+{
+    e.getPropertyStorage().setProperty (SettingID::anticipativeProcessing, b);
+    hasCheckedAnticipativeProcessing = false;
+}
+
+//==============================================================================
+void AnticipativeAudioNode::getAudioNodeProperties (AudioNodeProperties& info)
+{
+    SingleInputAudioNode::getAudioNodeProperties (info);
+
+    const ScopedLock sl (renderLock);
+    tempBuffer.setSize (jmax (1, info.numberOfChannels), tempBuffer.getNumSamples());
+}
+
+void AnticipativeAudioNode::prepareAudioNodeToPlay (const PlaybackInitialisationInfo& info)
+{
+    renderThreadPool->removeNode (*this);
+    isRenderingAhead = false;
+
+    if (input != nullptr)
+    {
+        chunkSize = info.blockSizeSamples;
+
+        while (chunkSize < minChunkSize)
+            chunkSize += info.blockSizeSamples;
+
+        sampleRate = info.sampleRate;
+        tempBuffer.setSize (tempBuffer.getNumChannels(), chunkSize);
+
+        // An AbstractFifo can hold one less than its size
+        const int fifoSize = chunkSize * numChunksAhead + 1;
+        fifoBuffer.setSize (tempBuffer.getNumChannels(), fifoSize);
+        fifo.setTotalSize (fifoSize);
+
+        playHeadState = {};
+        playhead = nullptr;
+
+        auto info2 = info;
+        info2.blockSizeSamples = chunkSize;
+        SingleInputAudioNode::prepareAudioNodeToPlay (info2);
+
+        renderThreadPool->addNode (*this);
+    }
+}
+
+void AnticipativeAudioNode::releaseAudioNodeResources()
+{
+    renderThreadPool->removeNode (*this);
+    isRenderingAhead = false;
+
+    SingleInputAudioNode::releaseAudioNodeResources();
+}
+
+void AnticipativeAudioNode::prepareForNextBlock (const AudioRenderContext&)
+{
+    // override this so our base class doesn't call prepareForNextBlock before each input block
+}
+
+void AnticipativeAudioNode::renderOver (const AudioRenderContext& rc)
+{
+    callRenderAdding (rc);
+}
+
+void AnticipativeAudioNode::renderAdding (const AudioRenderContext& rc)
+{
+    if (input == nullptr)
+        return;
+
+    jassert (rc.bufferNumSamples <= chunkSize);
+    const auto state = getPlayHeadState (rc.playhead);
+    const bool wasRenderingAhead = isRenderingAhead;
+
+    // These locks can only be held by a render thread for the length of a chunk, which is
+    // no longer than the audio thread would spend rendering it itself
+    if (! state.isPlaying || rc.playhead.isUserDragging() || rc.destBuffer == nullptr)
+    {
+        // There's nothing to render ahead so just pass the block straight through
+        isRenderingAhead = false;
+        playHeadState = state;
+
+        const ScopedLock sl (renderLock);
+        input->prepareForNextBlock (rc);
+        input->renderAdding (rc);
+        return;
+    }
+
+    if (! wasRenderingAhead || ! canReadFromFifo (rc, state))
+    {
+        // Throw away anything that's been rendered and start again from this block
+        isRenderingAhead = false;
+        playHeadState = state;
+
+        const ScopedLock sl (renderLock);
+        startRenderingAhead (rc.playhead, rc.destBufferChannels, rc.streamTime.getStart());
+
+        // If this carries on from a block that was passed through, the input hasn't jumped
+        firstChunkContinuity = wasRenderingAhead ? (int) AudioRenderContext::playheadJumped : rc.continuity;
+        isRenderingAhead = true;
+    }
+
+    if (fifo.getNumReady() < rc.bufferNumSamples)
+    {
+        // The render threads haven't got this far yet, so render the next chunk here
+        const ScopedLock sl (renderLock);
+
+        while (fifo.getNumReady() < rc.bufferNumSamples)
+            renderNextChunk();
+    }
+
+    readFromFifo (rc);
+}
+
+//==============================================================================
+bool AnticipativeAudioNode::PlayHeadState::operator== (const PlayHeadState& other) const noexcept
+{
+    return lastUserInteractionTime == other.lastUserInteractionTime
+        && loopTimes == other.loopTimes
+        && isPlaying == other.isPlaying
+        && isLooping == other.isLooping
+        && isRollingIntoLoop == other.isRollingIntoLoop;
+}
+
+AnticipativeAudioNode::PlayHeadState AnticipativeAudioNode::getPlayHeadState (const PlayHead& ph)
+{
+    PlayHeadState state;
+    state.lastUserInteractionTime = ph.getLastUserInteractionTime();
+    state.loopTimes = ph.getLoopTimes();
+    state.isPlaying = ph.isPlaying();
+    state.isLooping = ph.isLooping();
+    state.isRollingIntoLoop = ph.isRollingIntoLoop();
+
+    return state;
+}
+
+bool AnticipativeAudioNode::canReadFromFifo (const AudioRenderContext& rc, const PlayHeadState& state) const noexcept
+{
+    if (state != playHeadState || ! rc.isContiguousWithPreviousBlock() || rc.didPlayheadJump())
+        return false;
+
+    // Check this block starts where the last one that was read finished
+    const auto expectedStart = fifoStartStreamTime + numSamplesRead / sampleRate;
+
+    return std::abs (rc.streamTime.getStart() - expectedStart) < 1.0 / sampleRate;
+}
+
+void AnticipativeAudioNode::readFromFifo (const AudioRenderContext& rc)
+{
+    int start1, size1, start2, size2;
+    fifo.prepareToRead (rc.bufferNumSamples, start1, size1, start2, size2);
+    jassert (size1 + size2 == rc.bufferNumSamples);
+
+    auto& dest = *rc.destBuffer;
+
+    for (int i = jmin (dest.getNumChannels(), fifoBuffer.getNumChannels()); --i >= 0;)
+    {
+        if (size1 > 0)
+            dest.addFrom (i, rc.bufferStartSample, fifoBuffer, i, start1, size1);
+
+        if (size2 > 0)
+            dest.addFrom (i, rc.bufferStartSample + size1, fifoBuffer, i, start2, size2);
+    }
+
+    fifo.finishedRead (size1 + size2);
+    numSamplesRead += size1 + size2;
+}
+
+void AnticipativeAudioNode::startRenderingAhead (PlayHead& ph, const AudioChannelSet& channelSet, double streamTime)
+{
+    fifo.reset();
+    playhead = &ph;
+    channels = channelSet;
+    fifoStartStreamTime = streamTime;
+    numSamplesRendered = 0;
+    numSamplesRead = 0;
+}
+
+void AnticipativeAudioNode::renderNextChunk()
+{
+    jassert (playhead != nullptr);
+
+    const EditTimeRange streamTime (fifoStartStreamTime + numSamplesRendered / sampleRate,
+                                    fifoStartStreamTime + (numSamplesRendered + chunkSize) / sampleRate);
+
+    AudioRenderContext rc (*playhead, streamTime,
+                           &tempBuffer, channels, 0, chunkSize,
+                           &tempMidiBuffer, 0.0,
+                           numSamplesRendered == 0 ? firstChunkContinuity : (int) AudioRenderContext::contiguous,
+                           false);
+
+    rc.clearAll();
+    input->prepareForNextBlock (rc);
+    input->renderAdding (rc);
+    tempMidiBuffer.clear();
+
+    int start1, size1, start2, size2;
+    fifo.prepareToWrite (chunkSize, start1, size1, start2, size2);
+    jassert (size1 + size2 == chunkSize);
+
+    for (int i = jmin (tempBuffer.getNumChannels(), fifoBuffer.getNumChannels()); --i >= 0;)
+    {
+        if (size1 > 0)
+            fifoBuffer.copyFrom (i, start1, tempBuffer, i, 0, size1);
+
+        if (size2 > 0)
+            fifoBuffer.copyFrom (i, start2, tempBuffer, i, size1, size2);
+    }
+
+    fifo.finishedWrite (size1 + size2);
+    numSamplesRendered += chunkSize;
+}
+
+bool AnticipativeAudioNode::renderAheadIfNeeded()
+{
+    if (! isRenderingAhead)
+        return false;
+
+    const ScopedTryLock sl (renderLock);
+
+    // Check again now the lock's held as the audio thread may have just stopped it
+    if (! sl.isLocked() || ! isRenderingAhead || fifo.getFreeSpace() < chunkSize)
+        return false;
+
+    renderNextChunk();
+    return true;
+}
+
+}
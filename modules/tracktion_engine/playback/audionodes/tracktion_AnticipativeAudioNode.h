@@ -0,0 +1,104 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+/**
+    AudioNode that renders its input ahead of the playhead on background threads.
+
+    While the playhead is running normally, the input is rendered in chunks into a
+    FIFO by a shared set of background threads and the audio callback just copies the
+    audio out. If the FIFO runs dry, the playhead jumps or the loop changes, the audio
+    thread renders the next chunk itself, so at worst this behaves like a BufferingAudioNode.
+
+    Because the input is rendered early, it mustn't depend on anything that happens
+    in the same audio callback, e.g. live inputs, sidechains or aux sends, and any
+    MIDI it produces is discarded. Changes to plugin parameters will also be heard
+    up to the lookahead time late.
+*/
+class AnticipativeAudioNode    : public SingleInputAudioNode
+{
+public:
+    /** Creates an AnticipativeAudioNode for a given input AudioNode.
+        The input is rendered in chunks of at least minChunkSize samples, rounded up to a
+        multiple of the block size, and up to numChunksAhead of these are rendered ahead.
+    */
+    AnticipativeAudioNode (AudioNode* input, int minChunkSize, int numChunksAhead = 4);
+
+    /** Destructor. */
+    ~AnticipativeAudioNode() override;
+
+    //==============================================================================
+    /** Enables anticipative processing for tracks that have no live inputs.
+        This is a global setting and takes effect the next time the nodes are rebuilt.
+    */
+    static void setAnticipativeProcessingEnabled (Engine&, bool);
+
+    /** Returns true if anticipative processing is enabled. */
+    static bool isAnticipativeProcessingEnabled (Engine&);
+
+    //==============================================================================
+    void getAudioNodeProperties (AudioNodeProperties&) override;
+    void prepareAudioNodeToPlay (const PlaybackInitialisationInfo&) override;
+    void releaseAudioNodeResources() override;
+    void prepareForNextBlock (const AudioRenderContext&) override;
+    void renderOver (const AudioRenderContext&) override;
+    void renderAdding (const AudioRenderContext&) override;
+
+private:
+    //==============================================================================
+    struct RenderThreadPool;
+    juce::SharedResourcePointer<RenderThreadPool> renderThreadPool;
+
+    const int minChunkSize, numChunksAhead;
+    int chunkSize = 0;
+    double sampleRate = 44100.0;
+
+    // These are only used while holding the renderLock
+    juce::CriticalSection renderLock;
+    juce::AudioBuffer<float> tempBuffer;
+    MidiMessageArray tempMidiBuffer;
+    PlayHead* playhead = nullptr;
+    juce::AudioChannelSet channels;
+    double fifoStartStreamTime = 0;
+    juce::int64 numSamplesRendered = 0;
+    int firstChunkContinuity = 0;
+
+    // The FIFO is written by whichever thread holds the renderLock and read by the audio thread
+    juce::AbstractFifo fifo { 1 };
+    juce::AudioBuffer<float> fifoBuffer;
+    std::atomic<bool> isRenderingAhead { false };
+
+    // This is only used by the audio thread
+    struct PlayHeadState
+    {
+        juce::Time lastUserInteractionTime;
+        EditTimeRange loopTimes;
+        bool isPlaying = false, isLooping = false, isRollingIntoLoop = false;
+
+        bool operator== (const PlayHeadState&) const noexcept;
+        bool operator!= (const PlayHeadState& other) const noexcept     { return ! operator== (other); }
+    };
+
+    PlayHeadState playHeadState;
+    juce::int64 numSamplesRead = 0;
+
+    static PlayHeadState getPlayHeadState (const PlayHead&);
+    bool canReadFromFifo (const AudioRenderContext&, const PlayHeadState&) const noexcept;
+    void readFromFifo (const AudioRenderContext&);
+    void startRenderingAhead (PlayHead&, const juce::AudioChannelSet&, double streamTime);
+    void renderNextChunk();
+    bool renderAheadIfNeeded();
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AnticipativeAudioNode)
+};
+
+} // namespace tracktion_engine
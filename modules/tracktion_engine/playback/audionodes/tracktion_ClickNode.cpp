@@ -11,27 +11,69 @@
 namespace tracktion_engine
 {
 
-ClickNode::ClickNode (bool m, Edit& ed, double endTime)
-   : edit (ed), midi (m)
+namespace ClickNodeHelpers
 {
-    endTime = jmin (endTime, jmax (ed.getLength() * 2, 60.0 * 60.0));
+    /** Works out where the clicks go for an Edit's tempo map, ending with a beat far past the end. */
+    static std::shared_ptr<const ClickNode::BeatList> createBeats (Edit& edit, double endTime)
+    {
+        auto beats = std::make_shared<ClickNode::BeatList>();
+
+        TempoSequencePosition pos (edit.tempoSequence);
+        pos.setTime (1.0e-10);
+        pos.addBars (-8);
+
+        while (pos.getTime() < endTime)
+        {
+            beats->push_back ({ pos.getTime(), pos.getBarsBeatsTime().getWholeBeats() == 0 });
+            pos.addBeats (1.0);
+        }
+
+        beats->push_back ({ 1000000.0, false });
+        return beats;
+    }
+
+    struct BeatListKey
+    {
+        const Edit* edit;
+        juce::uint32 tempoChangeCount;
+        double endTime;
 
-    TempoSequencePosition pos (ed.tempoSequence);
-    pos.setTime (1.0e-10);
-    pos.addBars (-8);
+        bool operator== (const BeatListKey& o) const noexcept
+        {
+            return edit == o.edit && tempoChangeCount == o.tempoChangeCount && endTime == o.endTime;
+        }
+    };
 
-    while (pos.getTime() < endTime)
+    /** Returns the beats for an Edit's current tempo map, sharing them with any other
+        ClickNodes that still have them. An entry can only be found while a ClickNode holds
+        it, so an Edit created later at the same address can't be given a stale list.
+    */
+    static std::shared_ptr<const ClickNode::BeatList> getBeats (Edit& edit, double endTime)
     {
-        auto barsBeats = pos.getBarsBeatsTime();
+        static juce::CriticalSection lock;
+        static std::vector<std::pair<BeatListKey, std::weak_ptr<const ClickNode::BeatList>>> cache;
+
+        const BeatListKey key { &edit, edit.tempoSequence.getChangeCount(), endTime };
+        const juce::ScopedLock sl (lock);
 
-        if (barsBeats.getWholeBeats() == 0)
-            loudBeats.setBit (beatTimes.size());
+        cache.erase (std::remove_if (cache.begin(), cache.end(), [] (auto& e) { return e.second.expired(); }), cache.end());
 
-        beatTimes.add (pos.getTime());
-        pos.addBeats (1.0);
+        for (auto& e : cache)
+            if (e.first == key)
+                if (auto beats = e.second.lock())
+                    return beats;
+
+        auto beats = createBeats (edit, endTime);
+        cache.push_back ({ key, beats });
+        return beats;
     }
+}
 
-    beatTimes.add (1000000.0);
+ClickNode::ClickNode (bool m, Edit& ed, double endTime)
+   : edit (ed), midi (m)
+{
+    endTime = jmin (endTime, jmax (ed.getLength() * 2, 60.0 * 60.0));
+    beats = ClickNodeHelpers::getBeats (ed, endTime);
 }
 
 ClickNode::~ClickNode()
@@ -96,16 +138,49 @@ juce::AudioBuffer<float> loadWavDataIntoMemory (const File& file, double targetS
     return loadWavDataIntoMemory (mb.getData(), mb.getSize(), targetSampleRate);
 }
 
+namespace ClickNodeHelpers
+{
+    /** Returns a click sample loaded and resampled to the given rate, sharing it with any other
+        ClickNodes that are using the same one. If the user's file can't be read, the built-in
+        click is used.
+    */
+    static std::shared_ptr<const ClickNode::ClickSample> getClickSample (Engine& engine, bool big, double sampleRate)
+    {
+        static juce::CriticalSection lock;
+        static std::map<juce::String, std::weak_ptr<const ClickNode::ClickSample>> cache;
+
+        File file (ClickNode::getClickWaveFile (engine, big));
+        const bool useFile = file.existsAsFile();
+
+        // The modification time is included so an edited file gets loaded again
+        auto key = (useFile ? file.getFullPathName() + String (file.getLastModificationTime().toMilliseconds())
+                            : String (big ? "big" : "little"))
+                     + "_" + String (sampleRate);
+
+        const juce::ScopedLock sl (lock);
+
+        if (auto existing = cache[key].lock())
+            return existing;
+
+        auto sample = std::make_shared<ClickNode::ClickSample>();
+
+        if (useFile)
+            *sample = loadWavDataIntoMemory (file, sampleRate);
+
+        if (sample->getNumSamples() == 0)
+            *sample = big ? loadWavDataIntoMemory (TracktionBinaryData::bigclick_wav, TracktionBinaryData::bigclick_wavSize, sampleRate)
+                          : loadWavDataIntoMemory (TracktionBinaryData::littleclick_wav, TracktionBinaryData::littleclick_wavSize, sampleRate);
+
+        cache[key] = sample;
+        return sample;
+    }
+}
+
 void ClickNode::prepareAudioNodeToPlay (const PlaybackInitialisationInfo& info)
 {
     CRASH_TRACER
 
-    if (sampleRate != info.sampleRate)
-    {
-        sampleRate = info.sampleRate;
-        bigClick = {};
-        littleClick = {};
-    }
+    sampleRate = info.sampleRate;
 
     if (midi)
     {
@@ -114,32 +189,21 @@ void ClickNode::prepareAudioNodeToPlay (const PlaybackInitialisationInfo& info)
     }
     else
     {
-        if (bigClick.getNumSamples() == 0)
-        {
-            File file (getClickWaveFile (edit.engine, true));
-
-            if (file.existsAsFile())
-                bigClick = loadWavDataIntoMemory (file, sampleRate);
-
-            if (bigClick.getNumSamples() == 0)
-                bigClick = loadWavDataIntoMemory (TracktionBinaryData::bigclick_wav, TracktionBinaryData::bigclick_wavSize, sampleRate);
-        }
-
-        if (littleClick.getNumSamples() == 0)
-        {
-            File file (getClickWaveFile (edit.engine, false));
+        bigClick    = ClickNodeHelpers::getClickSample (edit.engine, true, sampleRate);
+        littleClick = ClickNodeHelpers::getClickSample (edit.engine, false, sampleRate);
+    }
 
-            if (file.existsAsFile())
-                littleClick = loadWavDataIntoMemory (file, sampleRate);
+    currentBeat = findBeatAfter (info.startTime, false);
+}
 
-            if (littleClick.getNumSamples() == 0)
-                littleClick = loadWavDataIntoMemory (TracktionBinaryData::littleclick_wav, TracktionBinaryData::littleclick_wavSize, sampleRate);
-        }
-    }
+int ClickNode::findBeatAfter (double time, bool includeBeatAtTime) const noexcept
+{
+    auto found = includeBeatAtTime ? std::lower_bound (beats->begin(), beats->end(), time,
+                                                       [] (const Beat& b, double t) { return b.time < t; })
+                                   : std::upper_bound (beats->begin(), beats->end(), time,
+                                                       [] (double t, const Beat& b) { return t < b.time; });
 
-    for (currentBeat = 0; currentBeat < beatTimes.size(); ++currentBeat)
-        if (beatTimes[currentBeat] > info.startTime)
-            break;
+    return (int) std::min (std::distance (beats->begin(), found), (std::ptrdiff_t) beats->size() - 1);
 }
 
 bool ClickNode::isReadyToRender()
@@ -149,8 +213,8 @@ bool ClickNode::isReadyToRender()
 
 void ClickNode::releaseAudioNodeResources()
 {
-    bigClick = {};
-    littleClick = {};
+    bigClick = nullptr;
+    littleClick = nullptr;
 }
 
 void ClickNode::renderOver (const AudioRenderContext& rc)
@@ -171,37 +235,39 @@ void ClickNode::renderSection (const AudioRenderContext& rc, EditTimeRange editT
     auto gain = edit.getClickTrackVolume();
     const bool emphasis = edit.clickTrackEmphasiseBars;
 
-    while (editTime.getStart() > beatTimes[currentBeat])
-        ++currentBeat;
+    auto& beatList = *beats;
 
-    while (currentBeat > 1 && editTime.getStart() < beatTimes[currentBeat - 1])
-        --currentBeat;
+    // Playback usually carries on from the last block, so this only searches after a jump
+    if (editTime.getStart() > beatList[(size_t) currentBeat].time)
+        currentBeat = findBeatAfter (editTime.getStart(), true);
+    else if (currentBeat > 1 && editTime.getStart() < beatList[(size_t) currentBeat - 1].time)
+        currentBeat = std::max (1, findBeatAfter (editTime.getStart(), false));
 
     if (midi && rc.bufferForMidiMessages != nullptr)
     {
-        double t = beatTimes.getUnchecked (currentBeat);
+        double t = beatList[(size_t) currentBeat].time;
 
         while (t < editTime.getEnd())
         {
-            auto note = (emphasis && loudBeats[currentBeat]) ? bigClickMidiNote
-                                                             : littleClickMidiNote;
+            auto note = (emphasis && beatList[(size_t) currentBeat].isBarStart) ? bigClickMidiNote
+                                                                               : littleClickMidiNote;
 
             if (t >= editTime.getStart())
                 rc.bufferForMidiMessages->addMidiMessage (MidiMessage::noteOn (10, note, gain),
                                                           t - editTime.getStart(),
                                                           MidiMessageArray::notMPE);
 
-            t = beatTimes.getUnchecked (++currentBeat);
+            t = beatList[(size_t) ++currentBeat].time;
         }
     }
-    else if (! midi && rc.destBuffer != nullptr)
+    else if (! midi && rc.destBuffer != nullptr && bigClick != nullptr && littleClick != nullptr)
     {
         --currentBeat;
-        double t = beatTimes[currentBeat];
+        double t = beatList[(size_t) currentBeat].time;
 
         while (t < editTime.getEnd())
         {
-            auto& b = (emphasis && loudBeats[currentBeat]) ? bigClick : littleClick;
+            auto& b = (emphasis && beatList[(size_t) currentBeat].isBarStart) ? *bigClick : *littleClick;
 
             if (b.getNumSamples() > 0)
             {
@@ -219,7 +285,7 @@ void ClickNode::renderSection (const AudioRenderContext& rc, EditTimeRange editT
                                                 num, gain);
             }
 
-            t = beatTimes.getUnchecked (++currentBeat);
+            t = beatList[(size_t) ++currentBeat].time;
         }
     }
 }
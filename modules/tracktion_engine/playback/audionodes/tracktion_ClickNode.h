@@ -34,17 +34,31 @@ public:
     static void setMidiClickNote (Engine&, bool big, int noteNum);
     static void setClickWaveFile (Engine&, bool big, const juce::String& filename);
 
+    /** A beat the click plays on. */
+    struct Beat
+    {
+        double time;
+        bool isBarStart;
+    };
+
+    using BeatList = std::vector<Beat>;
+    using ClickSample = juce::AudioBuffer<float>;
+
 private:
     const Edit& edit;
     bool midi = false;
-    juce::Array<double> beatTimes;
-    juce::BigInteger loudBeats;
+
+    // These are shared by all the ClickNodes with the same tempo map or click sample,
+    // so rebuilding the graph doesn't have to work them out or load them again
+    std::shared_ptr<const BeatList> beats;
     int currentBeat = 0;
 
     double sampleRate = 44100.0;
-    juce::AudioBuffer<float> bigClick, littleClick;
+    std::shared_ptr<const ClickSample> bigClick, littleClick;
     int bigClickMidiNote = 37, littleClickMidiNote = 76;
 
+    int findBeatAfter (double time, bool includeBeatAtTime) const noexcept;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ClickNode)
 };
 
@@ -16,6 +16,9 @@ namespace tracktion_engine
 static const double decayTimeAllowance = 5.0;
 static const int secondsPerGroup = 8;
 
+// nodes are added to all the groups within this time of them
+static const int groupOverlap = secondsPerGroup / 2 + 2;
+
 static inline int timeToGroupIndex (double t) noexcept
 {
     return ((int) t) / secondsPerGroup;
@@ -104,8 +107,8 @@ void CombiningAudioNode::addInput (EditTimeRange time, AudioNode* inputNode)
     jassert (time.end <= Edit::maximumLength);
 
     // add the node to any groups it's near to.
-    auto start = jmax (0, timeToGroupIndex (time.start - (secondsPerGroup / 2 + 2)));
-    auto end   = jmax (0, timeToGroupIndex (time.end   + (secondsPerGroup / 2 + 2)));
+    auto start = jmax (0, timeToGroupIndex (time.start - groupOverlap));
+    auto end   = jmax (0, timeToGroupIndex (time.end   + groupOverlap));
 
     while (groups.size() <= end)
         groups.add (new Array<TimedAudioNode*>());
@@ -132,6 +135,17 @@ void CombiningAudioNode::clear()
     hasMidi = false;
 }
 
+void CombiningAudioNode::setPrefetchLookahead (double seconds)
+{
+    prefetchLookahead = jlimit (0.0, getMaxPrefetchLookahead(), seconds);
+}
+
+double CombiningAudioNode::getMaxPrefetchLookahead() noexcept
+{
+    // Any node starting within this time is in the current time's group
+    return (double) groupOverlap;
+}
+
 void CombiningAudioNode::getAudioNodeProperties (AudioNodeProperties& info)
 {
     info.hasAudio = hasAudio;
@@ -227,15 +241,26 @@ void CombiningAudioNode::prepareForNextBlock (const AudioRenderContext& rc)
     auto time = rc.getEditTime().editRange1.getStart();
     prefetchGroup (rc, time);
 
-    if (rc.playhead.isLooping() && time > rc.playhead.getLoopTimes().end - 4.0)
+    if (rc.playhead.isLooping() && time > rc.playhead.getLoopTimes().end - prefetchLookahead)
         prefetchGroup (rc, rc.playhead.getLoopTimes().start);
 }
 
 void CombiningAudioNode::prefetchGroup (const AudioRenderContext& rc, const double time)
 {
     if (auto g = groups[timeToGroupIndex (time)])
+    {
+        const auto lookaheadEnd = time + prefetchLookahead;
+
+        // The groups are sorted by start time, so stop at the first one beyond the lookahead
         for (auto tan : *g)
-            tan->node->prepareForNextBlock (rc);
+        {
+            if (tan->time.start > lookaheadEnd)
+                break;
+
+            if (tan->time.end > time)
+                tan->node->prepareForNextBlock (rc);
+        }
+    }
 }
 
 }
@@ -37,6 +37,16 @@ public:
 
     void clear();
 
+    /** Sets how far ahead of the play position inputs start being prefetched.
+        Inputs are only passed prepareForNextBlock calls when they're playing or start
+        within this time, which gives the file cache time to read their audio before
+        they're needed. This is limited to getMaxPrefetchLookahead().
+    */
+    void setPrefetchLookahead (double seconds);
+
+    /** Returns the maximum time that can be used with setPrefetchLookahead(). */
+    static double getMaxPrefetchLookahead() noexcept;
+
     //==============================================================================
     void getAudioNodeProperties (AudioNodeProperties&) override;
     void visitNodes (const VisitorFn&) override;
@@ -60,6 +70,7 @@ private:
 
     bool hasAudio = false, hasMidi = false;
     int maxNumberOfChannels = 0;
+    double prefetchLookahead = 4.0;
 
     void prefetchGroup (const AudioRenderContext&, double time);
 
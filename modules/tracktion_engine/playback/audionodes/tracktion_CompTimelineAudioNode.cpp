@@ -0,0 +1,205 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+
+namespace tracktion_engine
+{
+
+CompTimelineAudioNode::Timeline CompTimelineAudioNode::Timeline::create (const juce::Array<EditTimeRange>& muteTimes,
+                                                                         const juce::Array<EditTimeRange>& nonMuteTimes,
+                                                                         double crossfadeTime)
+{
+    Timeline t;
+    t.segments.reserve ((size_t) (muteTimes.size() + 2 * nonMuteTimes.size()));
+
+    for (auto r : muteTimes)
+        if (! r.isEmpty())
+            t.segments.push_back ({ r, true, 0.0f, 0.0f });
+
+    // These are the same fades TrackCompManager has always used, nudged just outside the section
+    for (auto r : nonMuteTimes)
+    {
+        auto fadeIn = r.withLength (crossfadeTime) - 0.0001;
+        auto fadeOut = fadeIn.movedToEndAt (r.getEnd() + 0.0001);
+
+        if (fadeIn.getLength() > 0.0)
+        {
+            t.segments.push_back ({ fadeIn, false, 0.0f, 1.0f });
+            t.segments.push_back ({ fadeOut, false, 1.0f, 0.0f });
+        }
+    }
+
+    std::stable_sort (t.segments.begin(), t.segments.end(),
+                      [] (const Segment& a, const Segment& b) { return a.time.getStart() < b.time.getStart(); });
+
+    t.maxEnds.reserve (t.segments.size());
+    double maxEnd = std::numeric_limits<double>::lowest();
+
+    for (auto& s : t.segments)
+    {
+        maxEnd = std::max (maxEnd, s.time.getEnd());
+        t.maxEnds.push_back (maxEnd);
+    }
+
+    return t;
+}
+
+int CompTimelineAudioNode::Timeline::findFirstSegmentEndingAfter (double time) const noexcept
+{
+    return (int) std::distance (maxEnds.begin(), std::upper_bound (maxEnds.begin(), maxEnds.end(), time));
+}
+
+//==============================================================================
+CompTimelineAudioNode::CompTimelineAudioNode (AudioNode* inp, Timeline t)
+    : SingleInputAudioNode (inp), timeline (std::move (t))
+{
+}
+
+CompTimelineAudioNode::~CompTimelineAudioNode()
+{
+}
+
+static int compTimeToSample (const AudioRenderContext& rc, EditTimeRange editTime, double t)
+{
+    return (int) (rc.bufferNumSamples * (t - editTime.getStart()) / editTime.getLength() + 0.5);
+}
+
+int CompTimelineAudioNode::moveCursorTo (double time) noexcept
+{
+    const auto numSegments = (int) timeline.segments.size();
+    auto& maxEnds = timeline.maxEnds;
+
+    // Playback normally moves on by less than a segment, so a couple of steps forward
+    // are tried before searching
+    if (cursor > 0 && maxEnds[(size_t) cursor - 1] > time)
+    {
+        cursor = timeline.findFirstSegmentEndingAfter (time);
+        return cursor;
+    }
+
+    for (int i = 0; i < 2 && cursor < numSegments; ++i, ++cursor)
+        if (maxEnds[(size_t) cursor] > time)
+            return cursor;
+
+    cursor = timeline.findFirstSegmentEndingAfter (time);
+    return cursor;
+}
+
+void CompTimelineAudioNode::renderSection (const AudioRenderContext& rc, EditTimeRange editTime)
+{
+    if (editTime.getLength() <= 0.0)
+        return;
+
+    const auto numSegments = (int) timeline.segments.size();
+
+    for (int i = moveCursorTo (editTime.getStart()); i < numSegments; ++i)
+    {
+        auto& s = timeline.segments[(size_t) i];
+
+        if (s.time.getStart() >= editTime.getEnd())
+            break;
+
+        auto section = s.time.getIntersectionWith (editTime);
+
+        if (section.isEmpty())
+            continue;
+
+        auto startSamp = section.getStart() <= editTime.getStart() ? 0 : compTimeToSample (rc, editTime, section.getStart());
+        auto endSamp = section.getEnd() >= editTime.getEnd() ? rc.bufferNumSamples : compTimeToSample (rc, editTime, section.getEnd());
+
+        if (endSamp <= startSamp)
+            continue;
+
+        if (s.isMute)
+        {
+            rc.destBuffer->clear (rc.bufferStartSample + startSamp, endSamp - startSamp);
+            continue;
+        }
+
+        auto alphaAt = [&s] (double t)
+        {
+            auto proportion = (t - s.time.getStart()) / s.time.getLength();
+            return juce::jlimit (0.0f, 1.0f, (float) (s.startGain + (s.endGain - s.startGain) * proportion));
+        };
+
+        AudioFadeCurve::applyCrossfadeSection (*rc.destBuffer,
+                                               rc.bufferStartSample + startSamp, endSamp - startSamp,
+                                               AudioFadeCurve::convex,
+                                               alphaAt (section.getStart()),
+                                               alphaAt (section.getEnd()));
+    }
+}
+
+bool CompTimelineAudioNode::renderingNeeded (const AudioRenderContext& rc) const
+{
+    return rc.destBuffer != nullptr && rc.playhead.isPlaying() && ! timeline.segments.empty();
+}
+
+void CompTimelineAudioNode::renderOver (const AudioRenderContext& rc)
+{
+    input->renderOver (rc);
+
+    if (renderingNeeded (rc))
+        invokeSplitRender (rc, *this);
+}
+
+void CompTimelineAudioNode::renderAdding (const AudioRenderContext& rc)
+{
+    if (renderingNeeded (rc))
+        callRenderOver (rc);
+    else
+        input->renderAdding (rc);
+}
+
+//==============================================================================
+#if TRACKTION_UNIT_TESTS
+
+class CompTimelineTests : public juce::UnitTest
+{
+public:
+    CompTimelineTests() : juce::UnitTest ("CompTimeline", "Tracktion") {}
+
+    void runTest() override
+    {
+        const juce::Array<EditTimeRange> nonMuteTimes { { 1.0, 2.0 }, { 3.0, 3.01 } };
+        auto timeline = CompTimelineAudioNode::Timeline::create (TrackCompManager::TrackComp::getMuteTimes (nonMuteTimes),
+                                                                 nonMuteTimes, 0.02);
+
+        beginTest ("Segments are sorted and searchable");
+        {
+            expectEquals ((int) timeline.segments.size(), 3 + 4);
+
+            for (size_t i = 1; i < timeline.segments.size(); ++i)
+                expect (timeline.segments[i - 1].time.getStart() <= timeline.segments[i].time.getStart());
+
+            expectEquals (timeline.findFirstSegmentEndingAfter (-1.0), 0);
+            expectEquals (timeline.findFirstSegmentEndingAfter (10.0), (int) timeline.segments.size() - 1);
+        }
+
+        beginTest ("Short sections still find overlapping fades");
+        {
+            // The second section's fade in ends after its fade out starts
+            auto index = timeline.findFirstSegmentEndingAfter (3.005);
+            bool foundFadeIn = false;
+
+            for (auto i = (size_t) index; i < timeline.segments.size() && timeline.segments[i].time.getStart() < 3.005; ++i)
+                if (! timeline.segments[i].isMute && timeline.segments[i].startGain == 0.0f && timeline.segments[i].time.contains (3.005))
+                    foundFadeIn = true;
+
+            expect (foundFadeIn);
+        }
+    }
+};
+
+static CompTimelineTests compTimelineTests;
+
+#endif
+
+} // namespace tracktion_engine
@@ -0,0 +1,75 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+
+namespace tracktion_engine
+{
+
+/**
+    Plays a track's part of a comp, from its mute times and crossfades compiled into a
+    single sorted timeline.
+
+    This does the same job as a TimedMutingAudioNode followed by a FadeInOutAudioNode for
+    each section, but with one node however many sections there are. Each block finds its
+    place in the timeline with a cursor that only needs to move on a segment or two in normal
+    playback, and falls back to a binary search after a jump, so it doesn't check every
+    section every block. The fades are applied with AudioFadeCurve's table-based gains.
+*/
+class CompTimelineAudioNode : public SingleInputAudioNode
+{
+public:
+    //==============================================================================
+    /** A track's comp compiled into mutes and fades, sorted by start time. */
+    struct Timeline
+    {
+        struct Segment
+        {
+            EditTimeRange time;
+            bool isMute = true;
+            float startGain = 0.0f, endGain = 0.0f;     /**< The alpha at each end of a fade. */
+        };
+
+        /** Creates the timeline for the sections of a take that can be heard, and the gaps between them. */
+        static Timeline create (const juce::Array<EditTimeRange>& muteTimes,
+                                const juce::Array<EditTimeRange>& nonMuteTimes,
+                                double crossfadeTime);
+
+        /** Returns the index of the first segment that ends after a time, or the number of segments. */
+        int findFirstSegmentEndingAfter (double time) const noexcept;
+
+        std::vector<Segment> segments;
+
+        /** The latest end of each segment and the ones before it. Fades can overlap the next
+            segment when a section's shorter than the crossfade, so these are what's searched.
+        */
+        std::vector<double> maxEnds;
+    };
+
+    CompTimelineAudioNode (AudioNode* input, Timeline);
+    ~CompTimelineAudioNode() override;
+
+    //==============================================================================
+    void renderOver (const AudioRenderContext&) override;
+    void renderAdding (const AudioRenderContext&) override;
+
+    void renderSection (const AudioRenderContext&, EditTimeRange editTime);
+
+private:
+    //==============================================================================
+    const Timeline timeline;
+    int cursor = 0;
+
+    bool renderingNeeded (const AudioRenderContext&) const;
+    int moveCursorTo (double time) noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CompTimelineAudioNode)
+};
+
+} // namespace tracktion_engine
@@ -30,18 +30,17 @@ MidiAudioNode::MidiAudioNode (MidiMessageSequence sequence,
     if (nodeToReplace != nullptr)
         midiSourceID = nodeToReplace->midiSourceID;
 
-    ms.push_back (std::move (sequence));
-    ms[0].updateMatchedPairs();
+    sequence.updateMatchedPairs();
+    sequences = std::make_shared<const std::vector<juce::MidiMessageSequence>> (1, std::move (sequence));
 }
 
-MidiAudioNode::MidiAudioNode (std::vector<juce::MidiMessageSequence> sequences,
+MidiAudioNode::MidiAudioNode (std::vector<juce::MidiMessageSequence> seqs,
                               Range<int> chans,
                               EditTimeRange editPos,
                               CachedValue<float>& volumeDb_,
                               CachedValue<bool>& mute_,
                               Clip& sourceClip, const MidiAudioNode* nodeToReplace)
-    : ms (std::move (sequences)),
-      editSection (editPos),
+    : editSection (editPos),
       channelNumbers (chans),
       volumeDb (volumeDb_),
       mute (mute_),
@@ -54,15 +53,88 @@ MidiAudioNode::MidiAudioNode (std::vector<juce::MidiMessageSequence> sequences,
     if (nodeToReplace != nullptr)
         midiSourceID = nodeToReplace->midiSourceID;
 
-    for (auto& m : ms)
+    for (auto& m : seqs)
+        m.updateMatchedPairs();
+
+    sequences = std::make_shared<const std::vector<juce::MidiMessageSequence>> (std::move (seqs));
+}
+
+//==============================================================================
+void MidiAudioNode::SequenceUpdater::setSequences (std::vector<juce::MidiMessageSequence> newSequences)
+{
+    TRACKTION_ASSERT_MESSAGE_THREAD
+    jassert (! newSequences.empty());
+
+    for (auto& m : newSequences)
         m.updateMatchedPairs();
+
+    auto newLatest = std::make_shared<const std::vector<juce::MidiMessageSequence>> (std::move (newSequences));
+
+    {
+        const juce::SpinLock::ScopedLockType sl (lock);
+        std::swap (latest, newLatest);
+        ++version;
+    }
+
+    // The previous sequences may still be in use by the audio thread so they're kept
+    // here and only deleted on the message thread once no node refers to them
+    if (newLatest != nullptr)
+        retired.push_back (std::move (newLatest));
+
+    retired.erase (std::remove_if (retired.begin(), retired.end(),
+                                   [] (const Sequences& s) { return s.use_count() == 1; }),
+                   retired.end());
 }
 
+void MidiAudioNode::setSequenceUpdater (std::shared_ptr<SequenceUpdater> updater)
+{
+    sequenceUpdater = std::move (updater);
+
+    if (sequenceUpdater != nullptr)
+        sequenceVersion = sequenceUpdater->version.load();
+}
+
+void MidiAudioNode::updateSequencesIfNeeded (const AudioRenderContext& rc, double localTime)
+{
+    if (sequenceUpdater == nullptr || sequenceUpdater->version.load() == sequenceVersion)
+        return;
+
+    SequenceUpdater::Sequences newSequences;
+
+    {
+        const juce::SpinLock::ScopedTryLockType sl (sequenceUpdater->lock);
+
+        // If the message thread is half-way through an update, pick it up next block
+        if (! sl.isLocked())
+            return;
+
+        newSequences = sequenceUpdater->latest;
+        sequenceVersion = sequenceUpdater->version.load();
+    }
+
+    if (newSequences == nullptr || newSequences->empty())
+        return;
+
+    auto newCurrentSequence = currentSequence % newSequences->size();
+
+    if (rc.bufferForMidiMessages != nullptr && ! mute)
+        createNoteOffsForRemovedNotes (*rc.bufferForMidiMessages, (*sequences)[currentSequence],
+                                       (*newSequences)[newCurrentSequence], localTime, rc.midiBufferOffset);
+
+    // The old sequences are released by the updater on the message thread
+    sequences = std::move (newSequences);
+    currentSequence = newCurrentSequence;
+}
+
+//==============================================================================
+
 void MidiAudioNode::renderSection (const AudioRenderContext& rc, EditTimeRange editTime)
 {
     if (rc.bufferForMidiMessages != nullptr)
     {
         auto localTime = editTime - editSection.getStart();
+        updateSequencesIfNeeded (rc, localTime.getStart());
+        auto& ms = *sequences;
 
         if (mute)
         {
@@ -138,6 +210,7 @@ void MidiAudioNode::renderSection (const AudioRenderContext& rc, EditTimeRange e
 
 void MidiAudioNode::createMessagesForTime (double time, MidiMessageArray& buffer, double midiTimeOffset)
 {
+    auto& ms = *sequences;
     const auto* midiClip = dynamic_cast<MidiClip*> (clip.get());
 
     if (midiClip != nullptr && midiClip->getMPEMode())
@@ -235,6 +308,47 @@ void MidiAudioNode::createNoteOffs (MidiMessageArray& destination, const MidiMes
     }
 }
 
+void MidiAudioNode::createNoteOffsForRemovedNotes (MidiMessageArray& destination, const MidiMessageSequence& oldSequence,
+                                                   const MidiMessageSequence& newSequence, double time, double midiTimeOffset)
+{
+    auto isNoteSounding = [time] (const MidiMessageSequence::MidiEventHolder& meh)
+    {
+        return meh.message.isNoteOn()
+                && meh.message.getTimeStamp() < time
+                && meh.noteOffObject != nullptr
+                && meh.noteOffObject->message.getTimeStamp() > time;
+    };
+
+    for (auto oldNote : oldSequence)
+    {
+        if (oldNote->message.getTimeStamp() >= time)
+            break;
+
+        if (! isNoteSounding (*oldNote))
+            continue;
+
+        bool stillSounding = false;
+
+        for (auto newNote : newSequence)
+        {
+            if (newNote->message.getTimeStamp() >= time)
+                break;
+
+            if (isNoteSounding (*newNote)
+                 && newNote->message.getChannel() == oldNote->message.getChannel()
+                 && newNote->message.getNoteNumber() == oldNote->message.getNoteNumber())
+            {
+                stillSounding = true;
+                break;
+            }
+        }
+
+        // Notes that carry on in the new sequence get their note-off from it instead
+        if (! stillSounding)
+            destination.addMidiMessage (oldNote->noteOffObject->message, midiTimeOffset, midiSourceID);
+    }
+}
+
 void MidiAudioNode::getAudioNodeProperties (AudioNodeProperties& info)
 {
     info.hasAudio = false;
@@ -31,6 +31,38 @@ public:
                    juce::CachedValue<bool>& mute,
                    Clip&, const MidiAudioNode* nodeToReplace);
 
+    //==============================================================================
+    /**
+        Lets a clip replace the sequences its nodes are playing without the playback
+        graph having to be rebuilt.
+
+        Nodes that have been given one of these switch to the latest sequences at the
+        start of their next block, sending note-offs for any notes that were playing
+        and have gone from the new sequences.
+    */
+    struct SequenceUpdater
+    {
+        SequenceUpdater() = default;
+
+        /** Sets the sequences the nodes should switch to. Must be called on the message thread. */
+        void setSequences (std::vector<juce::MidiMessageSequence>);
+
+    private:
+        friend class MidiAudioNode;
+        using Sequences = std::shared_ptr<const std::vector<juce::MidiMessageSequence>>;
+
+        juce::SpinLock lock;
+        Sequences latest;
+        std::vector<Sequences> retired;
+        std::atomic<int> version { 0 };
+
+        JUCE_DECLARE_NON_COPYABLE (SequenceUpdater)
+    };
+
+    /** Sets an updater to take new sequences from. Call this before the node starts playing. */
+    void setSequenceUpdater (std::shared_ptr<SequenceUpdater>);
+
+    //==============================================================================
     void renderSection (const AudioRenderContext&, EditTimeRange editTime);
 
     void getAudioNodeProperties (AudioNodeProperties&) override;
@@ -45,7 +77,9 @@ public:
     Clip& getClip() const noexcept                  { return *clip; }
 
 private:
-    std::vector<juce::MidiMessageSequence> ms;
+    SequenceUpdater::Sequences sequences;
+    std::shared_ptr<SequenceUpdater> sequenceUpdater;
+    int sequenceVersion = 0;
     size_t currentSequence = 0;
     int currentIndex = 0;
     EditTimeRange editSection;
@@ -60,6 +94,9 @@ private:
     void createMessagesForTime (double time, MidiMessageArray&, double midiTimeOffset);
     void createNoteOffs (MidiMessageArray& destination, const juce::MidiMessageSequence& source,
                          double time, double midiTimeOffset, bool isPlaying);
+    void updateSequencesIfNeeded (const AudioRenderContext&, double localTime);
+    void createNoteOffsForRemovedNotes (MidiMessageArray& destination, const juce::MidiMessageSequence& oldSequence,
+                                        const juce::MidiMessageSequence& newSequence, double time, double midiTimeOffset);
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MidiAudioNode)
 };
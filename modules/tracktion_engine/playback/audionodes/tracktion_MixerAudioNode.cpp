@@ -38,13 +38,13 @@ struct MultiCPU
     }
 
     //==============================================================================
-    struct ParallelMixOperation
+    struct ParallelMixOperation  : public RealtimeWorkerPool::Operation
     {
-        ParallelMixOperation (const AudioRenderContext& context, OwnedArray<AudioNode>& inputs)
-            : nodes (inputs), rc (context) {}
-
-        LinkedListPointer<ParallelMixOperation> nextListItem;
+        ParallelMixOperation (RealtimeWorkerPool& pool, const void* owner,
+                              const AudioRenderContext& context, OwnedArray<AudioNode>& inputs)
+            : Operation (owner), threadPool (pool), nodes (inputs), rc (context) {}
 
+        RealtimeWorkerPool& threadPool;
         OwnedArray<AudioNode>& nodes;
         CriticalSection outputBufferLock;
         Atomic<int> nextNodeToPop, pendingNodes;
@@ -53,9 +53,15 @@ struct MultiCPU
         const AudioRenderContext& rc;
         double** buffer64 = nullptr;
 
-        void processNode (AudioNode* node, juce::AudioBuffer<float>& buffer)
+        int popNextJob() override
+        {
+            const int i = --nextNodeToPop;
+            return i >= 0 ? i : -1;
+        }
+
+        void performJob (int nodeIndex, juce::AudioBuffer<float>& buffer) override
         {
-            processNode (*node, buffer);
+            processNode (*nodes.getUnchecked (nodeIndex), buffer);
 
             if (--pendingNodes == 0)
                 pendingNodeChange.signal();
@@ -65,25 +71,18 @@ struct MultiCPU
         {
             pendingNodes = nodes.size();
             nextNodeToPop = nodes.size();
-            auto& threadPool = *MultiCPU::MixerThreadPool::getInstanceWithoutCreating();
 
-            threadPool.addOperation (this);
+            threadPool.addOperation (*this);
 
             AudioScratchBuffer scratchBuffer (rc.destBuffer != nullptr ? rc.destBuffer->getNumChannels() : 256,
                                               rc.destBuffer != nullptr ? rc.destBuffer->getNumSamples()  : 1);
 
-            while (auto node = popNextNode())
-                processNode (node, scratchBuffer.buffer);
+            for (int nodeIndex = popNextJob(); nodeIndex >= 0; nodeIndex = popNextJob())
+                performJob (nodeIndex, scratchBuffer.buffer);
 
             pendingNodeChange.wait();
 
-            threadPool.removeOperation (this);
-        }
-
-        AudioNode* popNextNode()
-        {
-            const int i = --nextNodeToPop;
-            return i >= 0 ? nodes.getUnchecked(i) : nullptr;
+            threadPool.removeOperation (*this);
         }
 
     private:
@@ -120,124 +119,12 @@ struct MultiCPU
                 rc.bufferForMidiMessages->mergeFromAndClear (midiBuffer);
         }
     };
-
-    //==============================================================================
-    struct MixerThreadPool  : private DeletedAtShutdown
-    {
-        MixerThreadPool() {}
-
-        ~MixerThreadPool()
-        {
-            threads.clear();
-            clearSingletonInstance();
-        }
-
-        void addOperation (ParallelMixOperation* op)
-        {
-            {
-                const ScopedLock sl (opLock);
-                opList.insertNext (op);
-            }
-
-            for (auto thread : threads)
-                thread->notify();
-        }
-
-        void removeOperation (ParallelMixOperation* op)
-        {
-            const ScopedLock sl (opLock);
-            opList.remove (op);
-        }
-
-        void setNumThreads (int num)
-        {
-            if (threads.size() != num)
-            {
-                const ScopedLock sl (opLock);
-
-                threads.clear();
-
-                while (threads.size() < num)
-                    threads.add (new MixerThread (*this));
-            }
-        }
-
-        bool process (juce::AudioBuffer<float>& buffer)
-        {
-            ParallelMixOperation* op = nullptr;
-            AudioNode* node = nullptr;
-
-            {
-                const ScopedLock sl (opLock);
-
-                for (op = opList.get(); op != nullptr; op = op->nextListItem)
-                {
-                    if (auto n = op->popNextNode())
-                    {
-                        node = n;
-                        break;
-                    }
-                }
-            }
-
-            if (node != nullptr)
-            {
-                op->processNode (node, buffer);
-                return true;
-            }
-
-            return false;
-        }
-
-        JUCE_DECLARE_SINGLETON_SINGLETHREADED_MINIMAL (MixerThreadPool)
-
-        //==============================================================================
-        struct MixerThread : public Thread
-        {
-            MixerThread (MixerThreadPool& mt)
-               : Thread ("mixer"), owner (mt)
-            {
-                startThread (Thread::realtimeAudioPriority);
-            }
-
-            ~MixerThread() override
-            {
-                stopThread (5000);
-            }
-
-            void run() override
-            {
-                FloatVectorOperations::disableDenormalisedNumberSupport();
-                buffer.setSize (2, 1024);
-
-                while (! threadShouldExit())
-                {
-                    if (! owner.process (buffer))
-                        wait (1000);
-                }
-            }
-
-        private:
-            juce::AudioBuffer<float> buffer;
-            MixerThreadPool& owner;
-        };
-
-        CriticalSection opLock;
-        OwnedArray<MixerThread> threads;
-
-        LinkedListPointer<ParallelMixOperation> opList;
-
-        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MixerThreadPool)
-    };
 };
 
-JUCE_IMPLEMENT_SINGLETON (MultiCPU::MixerThreadPool)
-
-
-
 //==============================================================================
-MixerAudioNode::MixerAudioNode (bool shouldUse64Bit, bool multiCpu)
-    : use64bitMixing (shouldUse64Bit),
+MixerAudioNode::MixerAudioNode (Edit& e, bool shouldUse64Bit, bool multiCpu)
+    : edit (e),
+      use64bitMixing (shouldUse64Bit),
       canUseMultiCpu (multiCpu),
       shouldUseMultiCpu (multiCpu)
 {
@@ -324,7 +211,7 @@ void MixerAudioNode::prepareAudioNodeToPlay (const PlaybackInitialisationInfo& i
 
     shouldUseMultiCpu = canUseMultiCpu
                          && inputs.size() > 1
-                         && MultiCPU::MixerThreadPool::getInstance()->threads.size() > 0;
+                         && edit.engine.getRealtimeWorkerPool().getNumThreads() > 0;
 }
 
 bool MixerAudioNode::isReadyToRender()
@@ -346,7 +233,7 @@ void MixerAudioNode::multiCpuRender (const AudioRenderContext& rc)
 {
     if ((hasAudio || hasMidi) && inputs.size() > 0)
     {
-        MultiCPU::ParallelMixOperation parallelOp (rc, inputs);
+        MultiCPU::ParallelMixOperation parallelOp (edit.engine.getRealtimeWorkerPool(), &edit, rc, inputs);
 
         parallelOp.buffer64 = nullptr;
 
@@ -447,11 +334,4 @@ void MixerAudioNode::set64bitBufferSize (int samples, int numChans)
         temp64bitBuffer.setSize (numChans, samples, false, false, true);
 }
 
-void MixerAudioNode::updateNumCPUs (Engine& e)
-{
-    CRASH_TRACER
-    MultiCPU::MixerThreadPool::getInstance()
-        ->setNumThreads (e.getEngineBehaviour().getNumberOfCPUsToUseForAudio() - 1);
-}
-
 }
@@ -15,9 +15,11 @@ namespace tracktion_engine
 class MixerAudioNode   : public AudioNode
 {
 public:
-    MixerAudioNode (bool shouldUse64Bit, bool multiCpuMode);
-
-    static void updateNumCPUs (Engine&);
+    /** Creates a mixer.
+        In multi-CPU mode, the inputs are rendered in parallel by the Engine's RealtimeWorkerPool
+        which shares its threads fairly between the Edits using it.
+    */
+    MixerAudioNode (Edit&, bool shouldUse64Bit, bool multiCpuMode);
 
     //==============================================================================
     /** Adds an input node.
@@ -48,6 +50,7 @@ private:
     void multiCpuRender (const AudioRenderContext&);
 
     //==============================================================================
+    Edit& edit;
     juce::OwnedArray<AudioNode> inputs;
 
     bool hasAudio = false, hasMidi = false;
@@ -37,6 +37,9 @@ public:
     {
         input->prepareForNextBlock (rc);
 
+        if (processedInGraphOrder)
+            return;
+
         for (int i = currentBlock.getNumChannels(); --i >= 0;)
             lastBlock.copyFrom (i, 0, currentBlock, i, rc.bufferStartSample, currentBlock.getNumSamples());
 
@@ -47,6 +50,15 @@ public:
     {
         input->renderOver (rc);
 
+        if (processedInGraphOrder)
+        {
+            if (rc.destBuffer != nullptr)
+                for (int i = juce::jmin (rc.destBuffer->getNumChannels(), currentBlock.getNumChannels()); --i >= 0;)
+                    currentBlock.copyFrom (i, 0, *rc.destBuffer, i, rc.bufferStartSample, rc.bufferNumSamples);
+
+            return;
+        }
+
         if (rc.bufferForMidiMessages != nullptr)
             currentMidiMessages.swapWith (*rc.bufferForMidiMessages);
 
@@ -76,14 +88,27 @@ public:
         callRenderOver (rc);
     }
 
-    const EditItemID srcTrackID;
+    /** If the playback graph makes sure the trees that receive this sidechain are processed
+        after the one it's in, the audio can be passed on in the same block. Otherwise it has to
+        be delayed by a block so it's ready whichever order they're processed in.
+        This should be set before the node starts playing.
+    */
+    void setProcessedInGraphOrder (bool shouldBeInOrder) noexcept   { processedInGraphOrder = shouldBeInOrder; }
 
-    juce::AudioBuffer<float> lastBlock;
+    /** Returns the block the receivers should read from. */
+    const juce::AudioBuffer<float>& getBlockForReceivers() const noexcept
+    {
+        return processedInGraphOrder ? currentBlock : lastBlock;
+    }
+
+    const EditItemID srcTrackID;
 
 private:
+    juce::AudioBuffer<float> lastBlock;
     MidiMessageArray currentMidiMessages, lastMidiMessages;
     juce::AudioBuffer<float> currentBlock;
     double latencySeconds = 0;
+    std::atomic<bool> processedInGraphOrder { false };
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SidechainSendAudioNode)
 };
@@ -105,6 +130,8 @@ public:
                 routes.add ({ w->sourceChannelIndex, w->destChannelIndex });
     }
 
+    EditItemID getSourceTrackID() const noexcept                    { return sidechainSourceID; }
+
     void getAudioNodeProperties (AudioNodeProperties& info) override
     {
         input->getAudioNodeProperties (info);
@@ -154,7 +181,7 @@ public:
                     return inputBufferCopy.buffer.getReadPointer (idx);
 
                 if (send != nullptr)
-                    return send->lastBlock.getReadPointer (idx - 2);
+                    return send->getBlockForReceivers().getReadPointer (idx - 2);
 
                 return {};
             };
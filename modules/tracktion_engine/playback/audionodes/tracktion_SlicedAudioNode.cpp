@@ -0,0 +1,253 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+// The length of the fade applied when a slice is cut off by the next one
+static constexpr double sliceFadeOutSeconds = 0.003;
+
+SlicedAudioNode::SlicedAudioNode (const AudioFile& af,
+                                  juce::Array<Slice> slicesToPlay,
+                                  EditTimeRange editTime,
+                                  LiveClipLevel level,
+                                  const juce::AudioChannelSet& channelSetToUse)
+    : sourceSlices (std::move (slicesToPlay)),
+      editPosition (editTime),
+      audioFile (af),
+      clipLevel (level),
+      channelsToUse (channelSetToUse)
+{
+}
+
+SlicedAudioNode::~SlicedAudioNode()
+{
+}
+
+//==============================================================================
+void SlicedAudioNode::getAudioNodeProperties (AudioNodeProperties& info)
+{
+    info.hasAudio = true;
+    info.hasMidi = false;
+    info.numberOfChannels = jlimit (1, std::max (channelsToUse.size(), 1), audioFile.getNumChannels());
+}
+
+bool SlicedAudioNode::purgeSubNodes (bool keepAudio, bool)
+{
+    return keepAudio;
+}
+
+void SlicedAudioNode::visitNodes (const VisitorFn& v)
+{
+    v (*this);
+}
+
+//==============================================================================
+void SlicedAudioNode::prepareAudioNodeToPlay (const PlaybackInitialisationInfo&)
+{
+    reader = audioFile.engine->getAudioFileManager().cache.createReader (audioFile);
+    updateFileSampleRate();
+
+    resamplers.clear();
+
+    if (reader != nullptr)
+        for (int i = std::max (channelsToUse.size(), reader->getNumChannels()); --i >= 0;)
+            resamplers.add (new juce::LagrangeInterpolator());
+}
+
+bool SlicedAudioNode::isReadyToRender()
+{
+    // if the hash is 0 it means an empty file path which means a missing file so
+    // this will never return a valid reader and we should just bail
+    if (audioFile.isNull())
+        return true;
+
+    if (reader == nullptr)
+    {
+        reader = audioFile.engine->getAudioFileManager().cache.createReader (audioFile);
+
+        if (reader == nullptr)
+            return false;
+    }
+
+    if (audioFileSampleRate == 0.0 && ! updateFileSampleRate())
+        return false;
+
+    return true;
+}
+
+bool SlicedAudioNode::updateFileSampleRate()
+{
+    if (reader == nullptr)
+        return false;
+
+    audioFileSampleRate = reader->getSampleRate();
+
+    if (audioFileSampleRate <= 0)
+        return false;
+
+    // Each slice plays for its natural length unless the next slice starts first
+    slices.clearQuick();
+
+    for (auto& s : sourceSlices)
+    {
+        auto naturalLength = s.numSamples / audioFileSampleRate;
+
+        PlayedSlice played;
+        played.time = s.time.withLength (std::min (s.time.getLength(), naturalLength));
+        played.startSample = s.startSample;
+        played.isCutShort = naturalLength > s.time.getLength() + 1.0e-6;
+
+        if (! played.time.isEmpty())
+            slices.add (played);
+    }
+
+    return true;
+}
+
+void SlicedAudioNode::releaseAudioNodeResources()
+{
+    reader = nullptr;
+}
+
+void SlicedAudioNode::renderOver (const AudioRenderContext& rc)
+{
+    callRenderAdding (rc);
+}
+
+void SlicedAudioNode::renderAdding (const AudioRenderContext& rc)
+{
+    invokeSplitRender (rc, *this);
+}
+
+void SlicedAudioNode::renderSection (const AudioRenderContext& rc, EditTimeRange editTime)
+{
+    // keep a local copy, because releaseAudioNodeResources may remove the reader halfway through..
+    const auto localReader = reader;
+
+    rc.sanityCheck();
+
+    if (rc.destBuffer == nullptr
+         || rc.bufferNumSamples == 0
+         || localReader == nullptr
+         || audioFileSampleRate <= 0.0)
+        return;
+
+    auto sectionTime = editTime.getIntersectionWith (editPosition);
+
+    if (sectionTime.isEmpty())
+        return;
+
+    SCOPED_REALTIME_CHECK
+
+    // The slices are in order and don't overlap, so their ends are in order too
+    auto slice = std::lower_bound (slices.begin(), slices.end(), sectionTime.getStart(),
+                                   [] (const PlayedSlice& s, double time) { return s.time.getEnd() <= time; });
+
+    for (; slice != slices.end() && slice->time.getStart() < sectionTime.getEnd(); ++slice)
+        renderSlice (rc, *localReader, *slice, editTime, sectionTime);
+}
+
+void SlicedAudioNode::renderSlice (const AudioRenderContext& rc, AudioFileCache::Reader& localReader,
+                                   const PlayedSlice& slice, EditTimeRange blockTime, EditTimeRange sectionTime)
+{
+    auto sliceTime = slice.time.getIntersectionWith (sectionTime);
+
+    if (sliceTime.isEmpty())
+        return;
+
+    const auto samplesPerSecond = rc.bufferNumSamples / blockTime.getLength();
+    const auto startOut = jlimit (0, rc.bufferNumSamples, roundToInt ((sliceTime.getStart() - blockTime.getStart()) * samplesPerSecond));
+    const auto endOut   = jlimit (0, rc.bufferNumSamples, roundToInt ((sliceTime.getEnd()   - blockTime.getStart()) * samplesPerSecond));
+    const auto numOut = endOut - startOut;
+
+    const auto fileStart = slice.startSample + (juce::int64) ((sliceTime.getStart() - slice.time.getStart()) * audioFileSampleRate + 0.5);
+    const auto fileEnd   = slice.startSample + (juce::int64) ((sliceTime.getEnd()   - slice.time.getStart()) * audioFileSampleRate + 0.5);
+    const auto numFileSamples = (int) (fileEnd - fileStart);
+
+    if (numOut <= 0 || numFileSamples <= 0)
+        return;
+
+    const bool needsResampling = numFileSamples != numOut;
+    const int numSamplesToRead = needsResampling ? numFileSamples + 2 : numFileSamples;
+
+    localReader.setReadPosition (fileStart);
+
+    AudioScratchBuffer fileData (rc.destBufferChannels.size(), numSamplesToRead);
+
+    // A cache miss just leaves this bit of the slice silent
+    if (! localReader.readSamples (numSamplesToRead, fileData.buffer, rc.destBufferChannels, 0,
+                                   channelsToUse, rc.isRendering ? 5000 : 3))
+        return;
+
+    auto numChannels = std::min ({ rc.destBuffer->getNumChannels(), fileData.buffer.getNumChannels(), resamplers.size() });
+
+    // Fades out the end of a slice that's being cut off, working in the file's time
+    if (slice.isCutShort)
+    {
+        auto fadeStart = slice.time.getEnd() - sliceFadeOutSeconds;
+
+        if (sliceTime.getEnd() > fadeStart)
+        {
+            for (int i = 0; i < numSamplesToRead; ++i)
+            {
+                auto time = sliceTime.getStart() + i / audioFileSampleRate;
+
+                if (time > fadeStart)
+                {
+                    auto gain = (float) jlimit (0.0, 1.0, (slice.time.getEnd() - time) / sliceFadeOutSeconds);
+
+                    for (int chan = 0; chan < numChannels; ++chan)
+                        fileData.buffer.getWritePointer (chan)[i] *= gain;
+                }
+            }
+        }
+    }
+
+    float gains[2];
+
+    // For stereo, use the pan, otherwise ignore it
+    if (rc.destBuffer->getNumChannels() == 2)
+        clipLevel.getLeftAndRightGains (gains[0], gains[1]);
+    else
+        gains[0] = gains[1] = clipLevel.getGainIncludingMute();
+
+    if (rc.playhead.isUserDragging())
+    {
+        gains[0] *= 0.4f;
+        gains[1] *= 0.4f;
+    }
+
+    const bool isStartOfSlice = sliceTime.getStart() <= slice.time.getStart();
+    const auto ratio = numFileSamples / (double) numOut;
+
+    for (int chan = 0; chan < numChannels; ++chan)
+    {
+        const auto src = fileData.buffer.getReadPointer (chan);
+        const auto dest = rc.destBuffer->getWritePointer (chan, rc.bufferStartSample + startOut);
+
+        if (needsResampling)
+        {
+            auto& resampler = *resamplers.getUnchecked (chan);
+
+            // Each slice starts afresh rather than carrying on from the last one
+            if (isStartOfSlice)
+                resampler.reset();
+
+            resampler.processAdding (ratio, src, dest, numOut, gains[chan & 1]);
+        }
+        else
+        {
+            FloatVectorOperations::addWithMultiply (dest, src, gains[chan & 1], numOut);
+        }
+    }
+}
+
+} // namespace tracktion_engine
@@ -0,0 +1,83 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+/**
+    An AudioNode that plays the slices of a sliced loop, such as a REX file, each one
+    triggered at its own time and played at its original speed.
+
+    This follows the tempo by moving the slices rather than stretching them, so nothing
+    needs to be rendered when the tempo changes. A slice that's cut short by the next one
+    is faded out to avoid a click, and one that's shorter than its gap leaves silence.
+*/
+class SlicedAudioNode final : public AudioNode
+{
+public:
+    struct Slice
+    {
+        EditTimeRange time;             /**< Where the slice starts and the latest it may end in the Edit. */
+        juce::int64 startSample = 0;    /**< The slice's first sample in the file. */
+        juce::int64 numSamples = 0;     /**< The slice's length in the file. */
+    };
+
+    /** The slices must be sorted by time and mustn't overlap. */
+    SlicedAudioNode (const AudioFile& file,
+                     juce::Array<Slice> slices,
+                     EditTimeRange editTime,
+                     LiveClipLevel level,
+                     const juce::AudioChannelSet& channelsToUse);
+
+    ~SlicedAudioNode() override;
+
+    //==============================================================================
+    void getAudioNodeProperties (AudioNodeProperties&) override;
+    void visitNodes (const VisitorFn&) override;
+
+    bool purgeSubNodes (bool keepAudio, bool keepMidi) override;
+
+    void prepareAudioNodeToPlay (const PlaybackInitialisationInfo&) override;
+    bool isReadyToRender() override;
+    void releaseAudioNodeResources() override;
+    void renderOver (const AudioRenderContext&) override;
+    void renderAdding (const AudioRenderContext&) override;
+
+    void renderSection (const AudioRenderContext&, EditTimeRange editTime);
+
+private:
+    //==============================================================================
+    struct PlayedSlice
+    {
+        EditTimeRange time;
+        juce::int64 startSample = 0;
+        bool isCutShort = false;
+    };
+
+    const juce::Array<Slice> sourceSlices;
+    juce::Array<PlayedSlice> slices;
+    EditTimeRange editPosition;
+
+    AudioFile audioFile;
+    LiveClipLevel clipLevel;
+    double audioFileSampleRate = 0;
+    const juce::AudioChannelSet channelsToUse;
+    AudioFileCache::Reader::Ptr reader;
+
+    juce::OwnedArray<juce::LagrangeInterpolator> resamplers;
+
+    bool updateFileSampleRate();
+    void renderSlice (const AudioRenderContext&, AudioFileCache::Reader&, const PlayedSlice&,
+                      EditTimeRange blockTime, EditTimeRange sectionTime);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SlicedAudioNode)
+};
+
+} // namespace tracktion_engine
@@ -55,7 +55,7 @@ public:
         reader = engine.getAudioFileManager().cache.createReader (audioFile);
         outputSampleRate = info.sampleRate;
         updateFileSampleRate();
-        resetResamplers();
+        resetLastSamples();
     }
 
     bool isReadyToRender() override
@@ -96,7 +96,8 @@ public:
 
         // keep a local copy, because releaseAudioNodeResources may remove the reader halfway through..
         if (const auto localReader = reader)
-            localReader->setReadPosition ((juce::int64) (editTimeToFileSample (rc.getEditTime().editRange1.getStart()) + 0.5) - 5);
+            localReader->setReadPosition ((juce::int64) std::floor (editTimeToFileSample (rc.getEditTime().editRange1.getStart()))
+                                            - VariableRateResampler::numPaddingSamplesBefore);
     }
 
     void renderSection (const AudioRenderContext& rc, EditTimeRange editTime)
@@ -120,22 +121,30 @@ public:
         const double fileStart = editTimeToFileSample (editTime.getStart());
         const double fileEnd   = editTimeToFileSample (editTime.getEnd());
 
-        int preRead            = 5;
-        auto fileReadStart     = juce::int64 (std::ceil (fileStart)) - preRead;
-        auto fileReadEnd       = juce::int64 (std::ceil (fileEnd));
-        auto numSamplesToRead  = (int) (fileReadEnd - fileReadStart);
+        // The resampler works from the exact position so it needs the samples either side
+        // and doesn't rely on any history from the previous section
+        const auto firstSample      = (juce::int64) std::floor (fileStart);
+        const auto startPosition    = fileStart - (double) firstSample;
+        const auto ratio            = (fileEnd - fileStart) / (double) rc.bufferNumSamples;
+        const auto numSamplesToRead = VariableRateResampler::getNumInputSamplesNeeded (rc.bufferNumSamples, startPosition, ratio)
+                                        + VariableRateResampler::numPaddingSamplesBefore
+                                        + VariableRateResampler::numPaddingSamplesAfter;
 
-        AudioScratchBuffer scratchBuffer (juce::jmin (2, rc.destBuffer->getNumChannels()), numSamplesToRead + 2);
-        const juce::AudioChannelSet scratchBufferChannels = juce::AudioChannelSet::canonicalChannelSet (scratchBuffer.buffer.getNumChannels());
+        const auto numChannels = std::min ({ rc.destBuffer->getNumChannels(), rc.destBufferChannels.size(),
+                                             juce::numElementsInArray (lastSample) });
 
-        localReader->setReadPosition (fileReadStart);
+        if (ratio <= 0.0 || numChannels <= 0)
+            return;
+
+        AudioScratchBuffer scratchBuffer (rc.destBufferChannels.size(), numSamplesToRead);
+        localReader->setReadPosition (firstSample - VariableRateResampler::numPaddingSamplesBefore);
 
         int lastSampleFadeLength = 0;
 
         {
             SCOPED_REALTIME_CHECK
 
-            if (localReader->readSamples (numSamplesToRead + 2, scratchBuffer.buffer, scratchBufferChannels, 0,
+            if (localReader->readSamples (numSamplesToRead, scratchBuffer.buffer, rc.destBufferChannels, 0,
                                           channelsToUse,
                                           rc.isRendering ? 5000 : 3))
             {
@@ -162,47 +171,34 @@ public:
             gains[1] *= 0.4f;
         }
 
-        // Pre-resampling set-up
-        const double ratio = (fileEnd - fileStart) / (double) rc.bufferNumSamples;
-        const double subSamplePos = fileStart - (int) fileStart;
+        // All the channels share the same positions, so they're resampled in one go
+        const float* sources[VariableRateResampler::maxNumChannels];
+        float* dests[VariableRateResampler::maxNumChannels];
+        float channelGains[VariableRateResampler::maxNumChannels];
 
-        for (int channel = rc.destBuffer->getNumChannels(); --channel >= 0;)
+        for (int channel = 0; channel < numChannels; ++channel)
         {
-            const int srcChan = juce::jmin (channel, scratchBuffer.buffer.getNumChannels() - 1);
-            const float* const src = scratchBuffer.buffer.getReadPointer (srcChan);
-            float dest[5 + 2];
-            const float gain = gains[channel & 1];
-
-            // Stoke interpolator with pre-read samples and set next read position
-            juce::LagrangeInterpolator& li = resampler[channel];
-            li.reset();
-            li.processAdding (1.0, src, dest, preRead - 1, gain);
-            li.processAdding (subSamplePos, src + preRead - 1, dest, 1, gain);
+            sources[channel] = scratchBuffer.buffer.getReadPointer (channel, VariableRateResampler::numPaddingSamplesBefore);
+            dests[channel] = rc.destBuffer->getWritePointer (channel, rc.bufferStartSample);
+            channelGains[channel] = gains[channel & 1];
         }
 
-        if (ratio > 0.0)
-        {
-            for (int channel = rc.destBuffer->getNumChannels(); --channel >= 0;)
-            {
-                const int srcChan = juce::jmin (channel, scratchBuffer.buffer.getNumChannels() - 1);
-                const float* const src = scratchBuffer.buffer.getReadPointer (srcChan, preRead);
-                float* const dest = rc.destBuffer->getWritePointer (channel, rc.bufferStartSample);
+        VariableRateResampler::processAdding (sources, dests, channelGains, numChannels,
+                                              rc.bufferNumSamples, startPosition, ratio);
 
-                resampler[channel].processAdding (ratio, src, dest, rc.bufferNumSamples, gains[channel & 1]);
+        const int fadeSamps = juce::jmin (lastSampleFadeLength, rc.bufferNumSamples);
 
-                if (lastSampleFadeLength > 0)
-                {
-                    const int fadeSamps = juce::jmin (lastSampleFadeLength, rc.bufferNumSamples);
-
-                    for (int i = 0; i < fadeSamps; ++i)
-                    {
-                        const float alpha = i / (float) fadeSamps;
-                        dest[i] = alpha * dest[i] + lastSample[channel] * (1.0f - alpha);
-                    }
-                }
+        for (int channel = 0; channel < numChannels; ++channel)
+        {
+            float* const dest = dests[channel];
 
-                lastSample[channel] = dest[rc.bufferNumSamples - 1];
+            for (int i = 0; i < fadeSamps; ++i)
+            {
+                const float alpha = i / (float) fadeSamps;
+                dest[i] = alpha * dest[i] + lastSample[channel] * (1.0f - alpha);
             }
+
+            lastSample[channel] = dest[rc.bufferNumSamples - 1];
         }
     }
 
@@ -220,8 +216,7 @@ private:
     juce::AudioChannelSet channelsToUse;
     AudioFileCache::Reader::Ptr reader;
 
-    juce::LagrangeInterpolator resampler[8];
-    float lastSample[8];
+    float lastSample[VariableRateResampler::maxNumChannels];
 
     double editTimeToFileSample (double editTime) const noexcept
     {
@@ -247,13 +242,10 @@ private:
         return false;
     }
 
-    void resetResamplers()
+    void resetLastSamples()
     {
-        for (int i = 0; i < juce::numElementsInArray (resampler); ++i)
-            resampler[i].reset();
-
-        for (int i = 0; i < juce::numElementsInArray (lastSample); ++i)
-            lastSample[i] = 0.0f;
+        for (auto& s : lastSample)
+            s = 0.0f;
     }
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SubSampleWaveAudioNode)
@@ -348,6 +340,8 @@ private:
     EditTimeRange fadeIn, fadeOut;
     AudioFadeCurve::Type fadeInType, fadeOutType;
 
+    static constexpr int rampStepSize = 32;
+
     bool renderingNeeded (const AudioRenderContext& rc) const
     {
         if (rc.destBuffer == nullptr || ! rc.playhead.isPlaying())
@@ -391,28 +385,43 @@ private:
 
         if (editTimeIntersection.getLength() > 0.0)
         {
-            auto startAlpha = (editTimeIntersection.getStart() - fade.getStart()) / fade.getLength();
-            auto endAlpha   = (editTimeIntersection.getEnd()   - fade.getStart()) / fade.getLength();
-
             const AudioFadeCurve::Type t = rampUp ? fadeInType : fadeOutType;
-            auto startProp = rescale (t, startAlpha, rampUp);
-            auto endProp   = rescale (t, endAlpha,   rampUp);
+            auto numSamples = juce::roundToInt (editTimeIntersection.getLength() * sampleRate);
+            auto streamDiff = rc.streamTime.getStart() - editTime.getStart();
 
-            jassert (juce::isPositiveAndNotGreaterThan (startProp, 1.0)
-                      && juce::isPositiveAndNotGreaterThan (endProp, 1.0));
+            auto getRampedTime = [&] (int sampleIndex)
+            {
+                auto time = editTimeIntersection.getStart() + editTimeIntersection.getLength() * sampleIndex / (double) numSamples;
+                auto alpha = juce::jlimit (0.0, 1.0, (time - fade.getStart()) / fade.getLength());
+                auto prop = rescale (t, alpha, rampUp);
 
-            EditTimeRange newEditTime (fade.getStart() + fade.getLength() * startProp,
-                                       fade.getStart() + fade.getLength() * endProp);
+                jassert (juce::isPositiveAndNotGreaterThan (prop, 1.0));
+                return fade.getStart() + fade.getLength() * prop;
+            };
 
-            auto numSamples = juce::roundToInt (editTimeIntersection.getLength() * sampleRate);
-            auto streamDiff = rc.streamTime.getStart() - editTime.getStart();
-            AudioRenderContext rc2 (rc);
-            rc2.streamTime = newEditTime + streamDiff;
-            rc2.bufferNumSamples = numSamples;
-            rc2.bufferStartSample = startSample;
-            startSample += numSamples;
+            // The input is rendered in short steps along the curve, so its speed changes
+            // smoothly through the block instead of jumping once per block
+            auto stepStart = getRampedTime (0);
+
+            for (int done = 0; done < numSamples;)
+            {
+                auto numThisStep = std::min (rampStepSize, numSamples - done);
+                auto stepEnd = getRampedTime (done + numThisStep);
+
+                AudioRenderContext rc2 (rc);
+                rc2.streamTime = EditTimeRange (stepStart, stepEnd) + streamDiff;
+                rc2.bufferNumSamples = numThisStep;
+                rc2.bufferStartSample = startSample;
+
+                if (done > 0)
+                    rc2.continuity = AudioRenderContext::contiguous;
 
-            input->renderOver (rc2);
+                input->renderOver (rc2);
+
+                startSample += numThisStep;
+                done += numThisStep;
+                stepStart = stepEnd;
+            }
         }
 
         auto timeAfter = editTime.getEnd() - fade.getEnd();
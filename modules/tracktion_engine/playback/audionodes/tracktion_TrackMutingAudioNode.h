@@ -124,7 +124,7 @@ private:
 
     bool isBeingPlayed() const
     {
-        bool playing = track != nullptr ? track->shouldBePlayed() : ! edit.areAnyTracksSolo();
+        bool playing = track != nullptr ? track->shouldBePlayed() : ! edit.areAnyTracksSoloCached();
 
         if (! playing)
             return false;
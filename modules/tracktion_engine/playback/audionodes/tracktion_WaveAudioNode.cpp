@@ -50,12 +50,41 @@ void WaveAudioNode::visitNodes (const VisitorFn& v)
     v (*this);
 }
 
+double WaveAudioNode::editTimeToExactFileSample (double editTime) const noexcept
+{
+    return (editTime - (editPosition.getStart() - offset)) * originalSpeedRatio * audioFileSampleRate;
+}
+
 int64 WaveAudioNode::editTimeToFileSample (double editTime) const noexcept
 {
-    return (int64) ((editTime - (editPosition.getStart() - offset))
-                      * originalSpeedRatio * audioFileSampleRate + 0.5);
+    return (int64) (editTimeToExactFileSample (editTime) + 0.5);
+}
+
+//==============================================================================
+static bool hasCheckedResamplingQuality = false;
+
+ResamplingQuality WaveAudioNode::getPlaybackResamplingQuality (Engine& e)
+{
+    static ResamplingQuality quality;
+
+    if (! hasCheckedResamplingQuality)
+    {
+        const int value = e.getPropertyStorage().getProperty (SettingID::resamplingQuality, (int) ResamplingQuality::sincDraft);
+        quality = (ResamplingQuality) jlimit ((int) ResamplingQuality::lagrange, (int) ResamplingQuality::sincMastering, value);
+        hasCheckedResamplingQuality = true;
+    }
+
+    return quality;
 }
 
+void WaveAudioNode::setPlaybackResamplingQuality (Engine& e, ResamplingQuality quality)
+{
+    e.getPropertyStorage().setProperty (SettingID::resamplingQuality, (int) quality);
+    hasCheckedResamplingQuality = false;
+}
+
+//==============================================================================
+
 struct WaveAudioNode::PerChannelState
 {
     PerChannelState()    { resampler.reset(); }
@@ -75,6 +104,26 @@ void WaveAudioNode::prepareAudioNodeToPlay (const PlaybackInitialisationInfo& in
     if (reader != nullptr)
         for (int i = std::max (channelsToUse.size(), reader->getNumChannels()); --i >= 0;)
             channelState.add (new PerChannelState());
+
+    createResamplers();
+}
+
+void WaveAudioNode::createResamplers()
+{
+    playbackResampler.reset();
+    renderResampler.reset();
+
+    // If the file's sample rate isn't known yet, this will fall back to the LagrangeInterpolator
+    if (audioFileSampleRate <= 0.0 || outputSampleRate <= 0.0 || originalSpeedRatio <= 0.0)
+        return;
+
+    const auto ratio = originalSpeedRatio * audioFileSampleRate / outputSampleRate;
+    const auto playbackQuality = getPlaybackResamplingQuality (*audioFile.engine);
+
+    if (playbackQuality != ResamplingQuality::lagrange)
+        playbackResampler = std::make_unique<SincResampler> (playbackQuality, ratio);
+
+    renderResampler = std::make_unique<SincResampler> (ResamplingQuality::sincMastering, ratio);
 }
 
 bool WaveAudioNode::isReadyToRender()
@@ -154,16 +203,52 @@ void WaveAudioNode::renderSection (const AudioRenderContext& rc, EditTimeRange e
     const auto fileEnd         = editTimeToFileSample (editTime.getEnd());
     const auto numFileSamples  = (int) (fileEnd - fileStart);
 
-    localReader->setReadPosition (fileStart);
+    // If the file's at the output rate and isn't being sped up, the samples can be mixed
+    // straight in without going through the resampler, which also doesn't need the extra samples
+    const bool needsResampling = numFileSamples != rc.bufferNumSamples
+                                  || originalSpeedRatio != 1.0
+                                  || audioFileSampleRate != outputSampleRate;
+
+    auto sincResampler = needsResampling ? (rc.isRendering ? renderResampler.get() : playbackResampler.get())
+                                         : nullptr;
 
-    AudioScratchBuffer fileData (rc.destBufferChannels.size(), numFileSamples + 2);
+    if (rc.destBufferChannels.size() > SincResampler::maxNumChannels)
+        sincResampler = nullptr;
+
+    auto readStart = fileStart;
+    int numSamplesToRead = needsResampling ? numFileSamples + 2 : numFileSamples;
+    int sincPadding = 0;
+    double sincStartPosition = 0.0, sincRatio = 0.0;
+
+    if (sincResampler != nullptr)
+    {
+        // The sinc filter works from the exact position so it needs the samples either side
+        // and doesn't rely on any history from the previous block
+        const auto exactFileStart = editTimeToExactFileSample (editTime.getStart());
+        const auto exactFileEnd   = editTimeToExactFileSample (editTime.getEnd());
+        const auto firstSample    = (int64) std::floor (exactFileStart);
+
+        sincPadding = sincResampler->getNumPaddingSamples();
+        sincStartPosition = exactFileStart - (double) firstSample;
+        sincRatio = (exactFileEnd - exactFileStart) / rc.bufferNumSamples;
+        readStart = firstSample - sincPadding;
+        numSamplesToRead = SincResampler::getNumInputSamplesNeeded (rc.bufferNumSamples, sincStartPosition, sincRatio)
+                            + 2 * sincPadding;
+    }
+
+    if (numSamplesToRead <= 0)
+        return;
+
+    localReader->setReadPosition (readStart);
+
+    AudioScratchBuffer fileData (rc.destBufferChannels.size(), numSamplesToRead);
 
     int lastSampleFadeLength = 0;
 
     {
         SCOPED_REALTIME_CHECK
 
-        if (localReader->readSamples (numFileSamples + 2, fileData.buffer, rc.destBufferChannels, 0,
+        if (localReader->readSamples (numSamplesToRead, fileData.buffer, rc.destBufferChannels, 0,
                                       channelsToUse,
                                       rc.isRendering ? 5000 : 3))
         {
@@ -191,13 +276,31 @@ void WaveAudioNode::renderSection (const AudioRenderContext& rc, EditTimeRange e
         gains[1] *= 0.4f;
     }
 
-    auto ratio = numFileSamples / (double) rc.bufferNumSamples;
+    auto ratio = sincResampler != nullptr ? sincRatio : numFileSamples / (double) rc.bufferNumSamples;
 
     if (ratio > 0.0)
     {
         auto numDestChannels = std::min (rc.destBuffer->getNumChannels(), fileData.buffer.getNumChannels());
         jassert (numDestChannels <= channelState.size()); // this should always have been made big enough
 
+        if (sincResampler != nullptr)
+        {
+            const float* sources[SincResampler::maxNumChannels];
+            float* dests[SincResampler::maxNumChannels];
+            float channelGains[SincResampler::maxNumChannels];
+            const auto numSincChannels = std::min (numDestChannels, channelState.size());
+
+            for (int channel = 0; channel < numSincChannels; ++channel)
+            {
+                sources[channel] = fileData.buffer.getReadPointer (channel, sincPadding);
+                dests[channel] = rc.destBuffer->getWritePointer (channel, rc.bufferStartSample);
+                channelGains[channel] = gains[channel & 1];
+            }
+
+            sincResampler->processAdding (sources, dests, channelGains, numSincChannels,
+                                          rc.bufferNumSamples, sincStartPosition, sincRatio);
+        }
+
         for (int channel = 0; channel < numDestChannels; ++channel)
         {
             if (channel < channelState.size())
@@ -206,7 +309,27 @@ void WaveAudioNode::renderSection (const AudioRenderContext& rc, EditTimeRange e
                 const auto dest = rc.destBuffer->getWritePointer (channel, rc.bufferStartSample);
 
                 auto& state = *channelState.getUnchecked (channel);
-                state.resampler.processAdding (ratio, src, dest, rc.bufferNumSamples, gains[channel & 1]);
+
+                if (sincResampler != nullptr)
+                {
+                    // This channel's already been added by the SincResampler
+                }
+                else if (needsResampling)
+                {
+                    state.resampler.processAdding (ratio, src, dest, rc.bufferNumSamples, gains[channel & 1]);
+                }
+                else
+                {
+                    FloatVectorOperations::addWithMultiply (dest, src, gains[channel & 1], rc.bufferNumSamples);
+
+                    // Pass the last few samples through the resampler so it has the right
+                    // history if the next block does need resampling
+                    constexpr int maxNumHistorySamples = 5;
+                    float unusedOutput[maxNumHistorySamples] = {};
+                    const auto numHistorySamples = std::min (numFileSamples, maxNumHistorySamples);
+                    state.resampler.processAdding (1.0, src + numFileSamples - numHistorySamples,
+                                                   unusedOutput, numHistorySamples, 0.0f);
+                }
 
                 if (lastSampleFadeLength > 0)
                 {
@@ -233,7 +356,22 @@ void WaveAudioNode::prepareForNextBlock (const AudioRenderContext& rc)
 
     // keep a local copy, because releaseAudioNodeResources may remove the reader halfway through..
     if (auto localReader = reader)
+    {
         localReader->setReadPosition (editTimeToFileSample (rc.getEditTime().editRange1.getStart()));
+
+        // Lets the cache get ready for any jumps into this clip, so a relocate doesn't miss
+        double targets[PlayHead::maxNumJumpTargets + 1];
+        juce::int64 cues[PlayHead::maxNumJumpTargets + 1];
+        auto numTargets = rc.playhead.getLikelyJumpTargets (targets);
+        int numCues = 0;
+
+        if (audioFileSampleRate > 0.0)
+            for (int i = 0; i < numTargets; ++i)
+                if (editPosition.contains (targets[i]))
+                    cues[numCues++] = editTimeToFileSample (targets[i]);
+
+        localReader->setCuePositions (cues, numCues);
+    }
 }
 
 }
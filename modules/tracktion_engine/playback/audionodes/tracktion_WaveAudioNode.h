@@ -11,10 +11,14 @@
 namespace tracktion_engine
 {
 
+/** The level settings of a clip.
+    These are atomic so they can be read by the audio thread while the clip's
+    being edited.
+*/
 struct ClipLevel
 {
-    juce::CachedValue<float> dbGain, pan;
-    juce::CachedValue<bool> mute;
+    juce::CachedValue<AtomicWrapper<float>> dbGain, pan;
+    juce::CachedValue<AtomicWrapper<bool>> mute;
 };
 
 struct LiveClipLevel
@@ -23,8 +27,8 @@ struct LiveClipLevel
     LiveClipLevel (std::shared_ptr<ClipLevel> l) noexcept
         : levels (std::move (l)) {}
 
-    float getGain() const noexcept              { return levels ? dbToGain (levels->dbGain) : 1.0f; }
-    float getPan() const noexcept               { return levels ? levels->pan.get() : 0.0f; }
+    float getGain() const noexcept              { return levels ? dbToGain (levels->dbGain.get()) : 1.0f; }
+    float getPan() const noexcept               { return levels ? static_cast<float> (levels->pan.get()) : 0.0f; }
     bool isMute() const noexcept                { return levels && levels->mute.get(); }
     float getGainIncludingMute() const noexcept { return isMute() ? 0.0f : getGain(); }
 
@@ -78,6 +82,16 @@ public:
 
     void renderSection (const AudioRenderContext&, EditTimeRange editTime);
 
+    //==============================================================================
+    /** Sets the resampling algorithm used for live playback. This is a global setting
+        and only affects nodes that are prepared after it's changed.
+        Renders always use ResamplingQuality::sincMastering.
+    */
+    static void setPlaybackResamplingQuality (Engine&, ResamplingQuality);
+
+    /** Returns the resampling algorithm used for live playback. */
+    static ResamplingQuality getPlaybackResamplingQuality (Engine&);
+
 private:
     //==============================================================================
     EditTimeRange editPosition, loopSection;
@@ -93,7 +107,11 @@ private:
     struct PerChannelState;
     juce::OwnedArray<PerChannelState> channelState;
 
+    std::unique_ptr<SincResampler> playbackResampler, renderResampler;
+
+    double editTimeToExactFileSample (double) const noexcept;
     juce::int64 editTimeToFileSample (double) const noexcept;
+    void createResamplers();
     bool updateFileSampleRate();
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (WaveAudioNode)
@@ -99,8 +99,12 @@ private:
         }
 
         if (auto pcm = ParameterControlMappings::getCurrentlyFocusedMappings (engine))
+        {
+            removeSupersededMessages (messages);
+
             for (const auto& m : messages)
                 pcm->sendChange (m.controllerID, m.newValue, m.channel);
+        }
     }
 
     int lastParamNumber = 0;
@@ -117,61 +121,110 @@ private:
     Engine& engine;
     Array<Message> pendingMessages;
     CriticalSection pendingLock;
+
+    /** A controller that streams values can send lots of them between message thread
+        callbacks, but only the last value for each controller needs setting.
+    */
+    static void removeSupersededMessages (Array<Message>& messages)
+    {
+        if (messages.size() < 2)
+            return;
+
+        std::unordered_set<juce::int64> seen;
+        seen.reserve ((size_t) messages.size());
+        Array<Message> latest;
+
+        for (int i = messages.size(); --i >= 0;)
+        {
+            auto& m = messages.getReference (i);
+
+            if (seen.insert ((((juce::int64) m.channel) << 32) | (juce::uint32) m.controllerID).second)
+                latest.add (m);
+        }
+
+        std::reverse (latest.begin(), latest.end());
+        messages.swapWith (latest);
+    }
 };
 
 //==============================================================================
 struct RetrospectiveMidiBuffer
 {
     RetrospectiveMidiBuffer (Engine& e)
+        : events ((size_t) maxNumEvents)
     {
         lengthInSeconds = e.getPropertyStorage().getProperty (SettingID::retrospectiveRecord, 30);
     }
 
-    void addMessage (const MidiMessage& m, double adjust)
+    /** Called by the MIDI input thread. This just writes to the preallocated ring, so
+        the oldest events are overwritten once it's full. SysEx messages aren't kept.
+    */
+    void addMessage (const MidiMessage& m)
     {
-        auto cutoffTime = Time::getMillisecondCounterHiRes() * 0.001 + adjust - lengthInSeconds;
+        auto size = m.getRawDataSize();
 
-        if (m.getTimeStamp() > cutoffTime)
-            sequence.add (m);
+        if (size > maxMessageSize)
+            return;
 
-        // remove all events that are no longer in the time window
-        int unused = 0;
-        for (int i = 0; i < sequence.size() && sequence[i].getTimeStamp() < cutoffTime; i++)
-            unused = i + 1;
+        auto index = numWritten.load (std::memory_order_relaxed);
+        auto& e = events[(size_t) (index & (maxNumEvents - 1))];
+        e.time = m.getTimeStamp();
+        e.size = (uint8) size;
+        memcpy (e.data, m.getRawData(), (size_t) size);
 
-        if (unused > 0)
-            sequence.removeRange (0, unused);
+        numWritten.store (index + 1, std::memory_order_release);
     }
 
-    juce::MidiMessageSequence getMidiMessages()
+    /** Discards everything that's been captured so far. */
+    void clear()
     {
-        juce::MidiMessageSequence result;
+        numCleared = numWritten.load (std::memory_order_acquire);
+    }
+
+    juce::MidiMessageSequence getMidiMessages (double adjustSecs)
+    {
+        CRASH_TRACER
+        auto cutoffTime = Time::getMillisecondCounterHiRes() * 0.001 + adjustSecs - lengthInSeconds;
 
-        for (auto m : sequence)
-            result.addEvent (m);
+        auto end = numWritten.load (std::memory_order_acquire);
+        auto start = jmax (numCleared.load(), end - (int64) maxNumEvents);
 
-        result.updateMatchedPairs();
+        std::vector<Event> captured;
+        captured.reserve ((size_t) (end - start));
 
-        SortedSet<int> usedIndexes;
+        for (auto i = start; i < end; ++i)
+            captured.push_back (events[(size_t) (i & (maxNumEvents - 1))]);
 
-        // remove all unmatched note on / off from the sequence
-        for (int i = 0; i < result.getNumEvents(); ++i)
+        // Anything the input thread has overwritten while we were copying has to be dropped
+        auto firstIntact = numWritten.load (std::memory_order_acquire) - (int64) maxNumEvents;
+        auto numOverwritten = (size_t) jlimit ((int64) 0, (int64) captured.size(), firstIntact - start);
+
+        juce::MidiMessageSequence sequence;
+
+        for (auto i = numOverwritten; i < captured.size(); ++i)
         {
-            auto evt = result.getEventPointer (i);
+            auto& e = captured[i];
 
-            if (evt->message.isNoteOn() && evt->noteOffObject != nullptr)
-            {
-                usedIndexes.add (i);
-                usedIndexes.add (result.getIndexOfMatchingKeyUp (i));
-            }
+            if (e.time >= cutoffTime)
+                sequence.addEvent (MidiMessage (e.data, e.size, e.time));
         }
 
-        for (int i = result.getNumEvents(); --i >= 0;)
-        {
-            auto evt = result.getEventPointer (i);
+        sequence.updateMatchedPairs();
 
-            if (evt->message.isNoteOnOrOff() && ! usedIndexes.contains (i))
-                result.deleteEvent (i, false);
+        // remove all unmatched note on / off from the sequence
+        std::unordered_set<const MidiMessageSequence::MidiEventHolder*> matchedNoteOffs;
+
+        for (auto evt : sequence)
+            if (evt->message.isNoteOn() && evt->noteOffObject != nullptr)
+                matchedNoteOffs.insert (evt->noteOffObject);
+
+        juce::MidiMessageSequence result;
+
+        for (auto evt : sequence)
+        {
+            if (evt->message.isNoteOn() ? evt->noteOffObject != nullptr
+                                        : (! evt->message.isNoteOff() || matchedNoteOffs.count (evt) > 0))
+                result.addEvent (evt->message);
         }
 
         result.updateMatchedPairs();
@@ -179,8 +232,26 @@ struct RetrospectiveMidiBuffer
         return result;
     }
 
-    Array<MidiMessage> sequence;
     double lengthInSeconds = 0;
+
+private:
+    enum
+    {
+        maxNumEvents = 32768, // must be a power of 2
+        maxMessageSize = 3
+    };
+
+    struct Event
+    {
+        double time;
+        uint8 data[maxMessageSize];
+        uint8 size;
+    };
+
+    std::vector<Event> events;
+    std::atomic<int64> numWritten { 0 }, numCleared { 0 };
+
+    JUCE_DECLARE_NON_COPYABLE (RetrospectiveMidiBuffer)
 };
 
 //==============================================================================
@@ -954,7 +1025,7 @@ public:
 
         for (auto track : getTargetTracks())
         {
-            auto sequence = retrospective->getMidiMessages();
+            auto sequence = retrospective->getMidiMessages (mi.getAdjustSecs());
 
             if (sequence.getNumEvents() == 0)
                 return {};
@@ -1005,7 +1076,7 @@ public:
                 length -= offset;
             }
 
-            retrospective->sequence.clear();
+            retrospective->clear();
 
             if (sequence.getNumEvents() > 0)
             {
@@ -1056,8 +1127,6 @@ private:
         InputAudioNode (MidiInputDeviceInstanceBase& m, MidiMessageArray::MPESourceID msi)
             : owner (m), midiSourceID (msi)
         {
-            for (int i = 256; --i >= 0;)
-                incomingMessages.add (new MidiMessage (0x80, 0, 0));
         }
 
         ~InputAudioNode() override
@@ -1085,13 +1154,13 @@ private:
         void prepareAudioNodeToPlay (const PlaybackInitialisationInfo& info) override
         {
             lastPlayheadTime = 0.0;
-            numMessages = 0;
             maxExpectedMsPerBuffer = (unsigned int) (((info.blockSizeSamples * 1000) / info.sampleRate) * 2 + 100);
             auto& mi = getMidiInput();
 
-            {
-                const ScopedLock sl (bufferLock);
+            // Nothing else can be adding messages until this has been added to the owner
+            incomingFifo.reset();
 
+            {
                 auto channelToUse = mi.getChannelToUse();
                 auto programToUse = mi.getProgramToUse();
 
@@ -1100,7 +1169,7 @@ private:
             }
 
             {
-                const ScopedLock sl (bufferLock);
+                const ScopedLock sl (liveInputLock);
                 liveRecordedMessages.clear();
                 numLiveMessagesToPlay = 0;
             }
@@ -1117,8 +1186,7 @@ private:
         {
             owner.remove (this);
 
-            const ScopedLock sl (bufferLock);
-            numMessages = 0;
+            incomingFifo.reset();
             numLiveMessagesToPlay = 0;
         }
 
@@ -1149,8 +1217,6 @@ private:
             {
                 const auto timeNow = Time::getApproximateMillisecondCounter();
 
-                const ScopedLock sl (bufferLock);
-
                 if (! rc.isContiguousWithPreviousBlock())
                     createProgramChanges (*rc.bufferForMidiMessages);
 
@@ -1159,28 +1225,33 @@ private:
                 if (timeNow > lastReadTime + maxExpectedMsPerBuffer)
                 {
                     //jassertfalse
-                    numMessages = 0;
+                    incomingFifo.finishedRead (incomingFifo.getNumReady());
                 }
 
                 lastReadTime = timeNow;
 
-                jassert (numMessages <= incomingMessages.size());
+                int start1, size1, start2, size2;
+                incomingFifo.prepareToRead (incomingFifo.getNumReady(), start1, size1, start2, size2);
 
-                if (int num = jmin (numMessages, incomingMessages.size()))
+                if (size1 + size2 > 0)
                 {
                     // not quite right as the first event won't be at the start of the buffer, but near enough for live stuff
-                    auto timeAdjust = incomingMessages.getUnchecked (0)->getTimeStamp();
+                    auto timeAdjust = incomingMessages[(size_t) (size1 > 0 ? start1 : start2)].getTimeStamp();
+                    auto maxTime = jmax (0.0, editTime.getLength());
 
-                    for (int i = 0; i < num; ++i)
+                    auto addMessages = [&] (int start, int num)
                     {
-                        auto* m = incomingMessages.getUnchecked (i);
-                        rc.bufferForMidiMessages->addMidiMessage (*m,
-                                                                  jlimit (0.0, jmax (0.0, editTime.getLength()), m->getTimeStamp() - timeAdjust),
-                                                                  midiSourceID);
-                    }
-                }
+                        for (int i = start; i < start + num; ++i)
+                        {
+                            auto& m = incomingMessages[(size_t) i];
+                            rc.bufferForMidiMessages->addMidiMessage (m, jlimit (0.0, maxTime, m.getTimeStamp() - timeAdjust), midiSourceID);
+                        }
+                    };
 
-                numMessages = 0;
+                    addMessages (start1, size1);
+                    addMessages (start2, size2);
+                    incomingFifo.finishedRead (size1 + size2);
+                }
 
                 if (lastPlayheadTime > editTime.getStart())
                     // when we loop, we can assume all the messages in here are now from the previous time round, so are playable
@@ -1216,17 +1287,22 @@ private:
             auto channelToUse = mi.getChannelToUse().getChannelNumber();
 
             {
-                const ScopedLock sl (bufferLock);
+                // The audio thread reads these without locking, this just stops several
+                // threads adding messages at once
+                const SpinLock::ScopedLockType sl (incomingWriteLock);
+
+                int start1, size1, start2, size2;
+                incomingFifo.prepareToWrite (1, start1, size1, start2, size2);
 
-                if (numMessages < incomingMessages.size())
+                if (size1 + size2 > 0)
                 {
-                    auto& m = *incomingMessages.getUnchecked (numMessages);
+                    auto& m = incomingMessages[(size_t) (size1 > 0 ? start1 : start2)];
                     m = message;
 
                     if (channelToUse > 0)
                         m.setChannel (channelToUse);
 
-                    ++numMessages;
+                    incomingFifo.finishedWrite (1);
                 }
             }
 
@@ -1264,9 +1340,10 @@ private:
     private:
         MidiInputDeviceInstanceBase& owner;
 
-        CriticalSection bufferLock;
-        OwnedArray<MidiMessage> incomingMessages;
-        int numMessages = 0;
+        enum { maxIncomingMessages = 256 };
+        AbstractFifo incomingFifo { maxIncomingMessages + 1 };
+        std::vector<MidiMessage> incomingMessages = std::vector<MidiMessage> ((size_t) maxIncomingMessages + 1);
+        SpinLock incomingWriteLock;
         MidiMessageArray liveRecordedMessages;
         int numLiveMessagesToPlay = 0; // the index of the first message that's been recorded in the current loop
         MidiMessageArray::MPESourceID midiSourceID = MidiMessageArray::notMPE;
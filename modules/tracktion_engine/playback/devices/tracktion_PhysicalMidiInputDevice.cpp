@@ -38,7 +38,6 @@ struct MidiTimecodeReader  : private MessageListener,
         if (m.isQuarterFrame())
         {
             const int value = m.getQuarterFrameValue();
-            int speedComp = 0;
 
             startTimer (100);
 
@@ -65,24 +64,22 @@ struct MidiTimecodeReader  : private MessageListener,
                     correctedTime = lastTime - owner.edit.getTimecodeOffset();
 
                     const double drift = correctedTime - owner.context.playhead.getPosition();
+                    double speedComp = 0.0;
 
-                    averageDrift = averageDrift * 0.9 + drift * 0.1;
-                    ++averageDriftNumSamples;
+                    if (driftNeedsResetting.exchange (false))
+                        driftSmoother.reset();
 
                     if (! jumpPending)
                     {
                         if (std::abs (drift) > 2.0)
                         {
                             owner.context.playhead.setPosition (correctedTime);
-                            averageDrift = 0.0;
-                            averageDriftNumSamples = 0;
+                            driftSmoother.reset();
                         }
-                        else if (std::abs (averageDrift) > 0.05
-                                  && averageDriftNumSamples > 50)
+                        else
                         {
-                            speedComp = (averageDrift > 0.0) ? 1 : -1;
-                            averageDrift = 0.0;
-                            averageDriftNumSamples = 0;
+                            // A full timecode arrives every two frames
+                            speedComp = driftSmoother.update (drift, 2.0 / getFPS());
                         }
                     }
 
@@ -123,10 +120,13 @@ private:
 
     int hours = 0, minutes = 0, seconds = 0, frames = 0;
     MidiMessage::SmpteTimecodeType midiTCType;
-    double lastTime = 0, correctedTime = 0, averageDrift = 0;
-    int averageDriftNumSamples = 0;
+    double lastTime = 0, correctedTime = 0;
     bool jumpPending = false;
 
+    // Only used on the MIDI thread, so the message thread asks for it to be reset
+    ClockDriftSmoother driftSmoother;
+    std::atomic<bool> driftNeedsResetting { false };
+
     void timerCallback() override
     {
         stopTimer();
@@ -135,8 +135,7 @@ private:
         {
             transport.stop (false, false, false);
             transport.setCurrentPosition (correctedTime);
-            averageDrift = 0.0;
-            averageDriftNumSamples = 0;
+            driftNeedsResetting = true;
         }
     }
 
@@ -161,8 +160,7 @@ private:
                 {
                     transport.stop (false, false, false);
                     transport.setCurrentPosition (correctedTime);
-                    averageDrift = 0.0;
-                    averageDriftNumSamples = 0;
+                    driftNeedsResetting = true;
                 }
             }
             else if (m->type == 2) // play
@@ -171,16 +169,14 @@ private:
                 {
                     transport.play (false);
                     startTimer (200);
-                    averageDrift = 0.0;
-                    averageDriftNumSamples = 0;
+                    driftNeedsResetting = true;
                 }
             }
             else if (m->type == 3) // goto last time
             {
                 transport.setCurrentPosition (correctedTime);
 
-                averageDrift = 0.0;
-                averageDriftNumSamples = 0;
+                driftNeedsResetting = true;
                 jumpPending = false;
             }
             else if (m->type == 10) // mmc message
@@ -428,7 +424,7 @@ void PhysicalMidiInputDevice::handleIncomingMidiMessage (const MidiMessage& m)
             sendNoteOnToMidiKeyListeners (message);
 
             if (! retrospectiveRecordLock && retrospectiveBuffer != nullptr)
-                retrospectiveBuffer->addMessage (message, adjustSecs);
+                retrospectiveBuffer->addMessage (message);
 
             if (! tryToSendTimecode (message))
             {
@@ -127,7 +127,7 @@ void VirtualMidiInputDevice::handleIncomingMidiMessage (const MidiMessage& m)
         message.addToTimeStamp (adjustSecs);
 
         if (! retrospectiveRecordLock && retrospectiveBuffer != nullptr)
-            retrospectiveBuffer->addMessage (message, adjustSecs);
+            retrospectiveBuffer->addMessage (message);
 
         sendNoteOnToMidiKeyListeners (message);
 
@@ -25,7 +25,7 @@ public:
     ~DiskSpaceCheckTask() override
     {
         stopTimer();
-        engine.getBackgroundJobs().getPool().removeJob (this, true, 10000);
+        getPool().removeJob (this, true, 10000);
     }
 
     JobStatus runJob() override
@@ -47,7 +47,13 @@ public:
     void timerCallback() override
     {
         startTimer (31111);
-        engine.getBackgroundJobs().getPool().addJob (this, false);
+        getPool().addJob (this, false);
+    }
+
+    juce::ThreadPool& getPool()
+    {
+        return engine.getBackgroundJobs().getPool (ThreadPoolJobWithProgress::Priority::interactive,
+                                                   ThreadPoolJobWithProgress::Lane::io);
     }
 
     Engine& engine;
@@ -385,6 +391,8 @@ public:
                     }
                 }
 
+                rc->writerQueue = &edit.engine.getWaveInputRecordingThread().addWriter (*rc->fileWriter, rc->thumbnail);
+
                 const ScopedLock sl (contextLock);
                 recordingContext = std::move (rc);
             }
@@ -495,16 +503,22 @@ public:
         bool hasHitThreshold = false, firstRecCallback = false, recordingWithPunch = false;
         int adjustSamples = 0;
 
+        ~RecordingContext()
+        {
+            if (fileWriter != nullptr)
+                engine.getWaveInputRecordingThread().waitForWriterToFinish (*fileWriter);
+        }
+
         std::unique_ptr<AudioFileWriter> fileWriter;
+        WaveInputRecordingThread::WriterQueue* writerQueue = nullptr;
         DiskSpaceCheckTask diskSpaceChecker;
         RecordingThumbnailManager::Thumbnail::Ptr thumbnail;
         WaveInputRecordingThread::ScopedInitialiser threadInitialiser;
 
         void addBlockToRecord (const juce::AudioBuffer<float>& buffer, int start, int numSamples)
         {
-            if (fileWriter != nullptr)
-                engine.getWaveInputRecordingThread().addBlockToRecord (*fileWriter, buffer,
-                                                                       start, numSamples, thumbnail);
+            if (writerQueue != nullptr)
+                engine.getWaveInputRecordingThread().addBlockToRecord (*writerQueue, buffer, start, numSamples);
         }
     };
 
@@ -1115,6 +1129,8 @@ protected:
     {
         CRASH_TRACER
 
+        rc.writerQueue = nullptr;
+
         if (auto localCopy = std::move (rc.fileWriter))
             rc.engine.getWaveInputRecordingThread().waitForWriterToFinish (*localCopy);
     }
@@ -1710,145 +1726,96 @@ void WaveInputDevice::updateRetrospectiveBufferLength (double length)
 }
 
 //==============================================================================
-struct WaveInputRecordingThread::BlockQueue
+struct WaveInputRecordingThread::WriterQueue
 {
-    BlockQueue()
+    WriterQueue (AudioFileWriter& w, const RecordingThumbnailManager::Thumbnail::Ptr& thumb)
+        : writer (w), thumbnail (thumb),
+          fifo (w.getNumChannels(), (int) (w.getSampleRate() * fifoLengthSeconds) + 1),
+          writeBuffer (w.getNumChannels(), (int) (w.getSampleRate() * maxWriteLengthSeconds)),
+          minSamplesPerWrite ((int) (w.getSampleRate() * minWriteLengthSeconds))
     {
-        for (int i = 32; --i >= 0;)
-            addToFreeQueue (new QueuedBlock());
     }
 
-    struct QueuedBlock
-    {
-        QueuedBlock() = default;
+    // The FIFO can hold a few seconds in case the disk stalls, and blocks are gathered
+    // up so the file gets written in large chunks rather than one per audio callback
+    static constexpr double fifoLengthSeconds = 3.0;
+    static constexpr double minWriteLengthSeconds = 0.1;
+    static constexpr double maxWriteLengthSeconds = 0.5;
 
-        void load (AudioFileWriter& w, const juce::AudioBuffer<float>& newBuffer,
-                   int start, int numSamples, const RecordingThumbnailManager::Thumbnail::Ptr& thumb)
-        {
-            buffer.setSize (newBuffer.getNumChannels(), numSamples);
-
-            for (int i = buffer.getNumChannels(); --i >= 0;)
-                buffer.copyFrom (i, 0, newBuffer, i, start, numSamples);
+    AudioFileWriter& writer;
+    RecordingThumbnailManager::Thumbnail::Ptr thumbnail;
+    AudioFifo fifo;
+    juce::AudioBuffer<float> writeBuffer;
+    const int minSamplesPerWrite;
+    std::atomic<bool> hasOverflowed { false };
 
-            writer = &w;
-            thumbnail = thumb;
-        }
-
-        std::atomic<AudioFileWriter*> writer { nullptr };
-        QueuedBlock* next = nullptr;
-        juce::AudioBuffer<float> buffer { 2, 512 };
-        RecordingThumbnailManager::Thumbnail::Ptr thumbnail;
-
-        JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (QueuedBlock)
-    };
-
-    CriticalSection freeQueueLock, pendingQueueLock;
-    QueuedBlock* firstPending = nullptr;
-    QueuedBlock* lastPending = nullptr;
-    QueuedBlock* firstFree = nullptr;
-    std::atomic<int> numPending { 0 };
-
-    QueuedBlock* findFreeBlock()
+    float getUsage() const noexcept
     {
-        const ScopedLock sl (freeQueueLock);
-
-        if (firstFree == nullptr)
-            return new QueuedBlock();
-
-        auto* b = firstFree;
-        firstFree = b->next;
-        b->next = nullptr;
-        return b;
+        return fifo.getNumReady() / (float) std::max (1, fifo.getNumReady() + fifo.getFreeSpace());
     }
 
-    void addToFreeQueue (QueuedBlock* b) noexcept
-    {
-        jassert (b != nullptr);
-        const ScopedLock sl (freeQueueLock);
-        b->writer = nullptr;
-        b->next = firstFree;
-        firstFree = b;
-    }
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (WriterQueue)
+};
 
-    void addToPendingQueue (QueuedBlock* b) noexcept
+//==============================================================================
+/** Writes the files in its queues to disk. */
+struct WaveInputRecordingThread::WriterThread  : public juce::Thread
+{
+    WriterThread (WaveInputRecordingThread& o, int index)
+        : Thread ("WaveInputRecordingThread " + juce::String (index + 1)), owner (o)
     {
-        jassert (b != nullptr);
-        b->next = nullptr;
-        const ScopedLock sl (pendingQueueLock);
-
-        if (lastPending != nullptr)
-            lastPending->next = b;
-        else
-            firstPending = b;
-
-        lastPending = b;
-        ++numPending;
     }
 
-    QueuedBlock* removeFirstPending() noexcept
+    ~WriterThread() override
     {
-        const ScopedLock sl (pendingQueueLock);
-
-        if (auto b = firstPending)
-        {
-            firstPending = b->next;
-
-            if (firstPending == nullptr)
-                lastPending = nullptr;
-
-            --numPending;
-            return b;
-        }
-
-        return {};
+        stopThread (30000);
+        jassert (queues.isEmpty());
     }
 
-    void moveAnyPendingBlocksToFree() noexcept
+    void run() override
     {
-        while (auto b = removeFirstPending())
-            addToFreeQueue (b);
+        CRASH_TRACER
+        FloatVectorOperations::disableDenormalisedNumberSupport();
 
-        jassert (numPending == 0);
-        numPending = 0;
-    }
+        while (! threadShouldExit())
+        {
+            bool anythingWritten = false;
 
-    bool isWriterInQueue (AudioFileWriter& writer) const
-    {
-        const ScopedLock sl (pendingQueueLock);
+            {
+                const ScopedLock sl (lock);
 
-        for (auto b = firstPending; b != nullptr; b = b->next)
-            if (b->writer == &writer)
-                return true;
+                for (auto q : queues)
+                    if (owner.writeQueuedBlocks (*q, false))
+                        anythingWritten = true;
+            }
 
-        return false;
+            if (! anythingWritten)
+                wait (20);
+        }
     }
 
-    void deleteFreeQueue() noexcept
-    {
-        auto b = firstFree;
-        firstFree = nullptr;
+    WaveInputRecordingThread& owner;
+    juce::CriticalSection lock;
+    juce::OwnedArray<WriterQueue> queues;
 
-        while (b != nullptr)
-        {
-            std::unique_ptr<QueuedBlock> toDelete (b);
-            b = b->next;
-        }
-    }
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (WriterThread)
 };
 
 //==============================================================================
 WaveInputRecordingThread::WaveInputRecordingThread (Engine& e)
-    : Thread ("WaveInputRecordingThread"),
-      engine (e),
-      queue (new BlockQueue())
+    : engine (e)
 {
+    // Writing is mostly waiting for the disk, so a few threads are enough to keep
+    // it busy without taking too many cores away from the audio
+    const int numThreads = jlimit (1, 4, SystemStats::getNumCpus() / 2);
+
+    for (int i = 0; i < numThreads; ++i)
+        writerThreads.add (new WriterThread (*this, i));
 }
 
 WaveInputRecordingThread::~WaveInputRecordingThread()
 {
     flushAndStop();
-    queue->deleteFreeQueue();
-    queue.reset();
 }
 
 void WaveInputRecordingThread::addUser()
@@ -1864,65 +1831,114 @@ void WaveInputRecordingThread::removeUser()
 }
 
 //==============================================================================
-void WaveInputRecordingThread::addBlockToRecord (AudioFileWriter& writer, const juce::AudioBuffer<float>& buffer,
-                                                 int start, int numSamples, const RecordingThumbnailManager::Thumbnail::Ptr& thumbnail)
+WaveInputRecordingThread::WriterQueue& WaveInputRecordingThread::addWriter (AudioFileWriter& writer,
+                                                                           const RecordingThumbnailManager::Thumbnail::Ptr& thumbnail)
 {
-    if (! threadShouldExit())
-    {
-        auto block = queue->findFreeBlock();
-        block->load (writer, buffer, start, numSamples, thumbnail);
-        queue->addToPendingQueue (block);
-        notify();
-    }
+    jassert (writer.isOpen());
+    auto queue = std::make_unique<WriterQueue> (writer, thumbnail);
+
+    const ScopedLock sl (writerThreadLock);
+    WriterThread* leastBusy = nullptr;
+
+    for (auto t : writerThreads)
+        if (leastBusy == nullptr || t->queues.size() < leastBusy->queues.size())
+            leastBusy = t;
+
+    jassert (leastBusy != nullptr);
+    const ScopedLock tsl (leastBusy->lock);
+    return *leastBusy->queues.add (queue.release());
 }
 
-void WaveInputRecordingThread::waitForWriterToFinish (AudioFileWriter& writer)
+void WaveInputRecordingThread::addBlockToRecord (WriterQueue& queue, const juce::AudioBuffer<float>& buffer,
+                                                 int start, int numSamples)
 {
-    while (queue->isWriterInQueue (writer) && isThreadRunning())
-        Thread::sleep (2);
+    // The threads wake up regularly to check the FIFOs, so this doesn't notify them as
+    // that could block the audio thread
+    if (! queue.fifo.write (buffer, start, numSamples))
+    {
+        queue.hasOverflowed = true;
+        ++numOverflows;
+    }
+
+    const auto usage = queue.getUsage();
+    auto peak = peakFifoUsage.load();
+
+    while (usage > peak && ! peakFifoUsage.compare_exchange_weak (peak, usage))
+    {}
 }
 
-void WaveInputRecordingThread::run()
+void WaveInputRecordingThread::waitForWriterToFinish (AudioFileWriter& writer)
 {
     CRASH_TRACER
-    FloatVectorOperations::disableDenormalisedNumberSupport();
+    const ScopedLock sl (writerThreadLock);
 
-    for (;;)
+    for (auto t : writerThreads)
     {
-        if (queue->numPending > 500 && ! hasWarned)
-        {
-            hasWarned = true;
-            TRACKTION_LOG_ERROR ("Audio recording can't keep up!");
-        }
+        const ScopedLock tsl (t->lock);
 
-        if (auto block = queue->removeFirstPending())
+        for (auto q : t->queues)
         {
-            if (! block->writer.load()->appendBuffer (block->buffer, block->buffer.getNumSamples()))
+            if (&q->writer == &writer)
             {
-                if (! hasSentStop)
-                {
-                    hasSentStop = true;
-                    TRACKTION_LOG_ERROR ("Audio recording failed to write to disk!");
-                    startTimer (1);
-                }
+                writeQueuedBlocks (*q, true);
+                t->queues.removeObject (q);
+                return;
             }
+        }
+    }
+}
+
+WaveInputRecordingThread::FifoStatistics WaveInputRecordingThread::getFifoStatistics() const
+{
+    FifoStatistics stats;
+    stats.peakUsage = peakFifoUsage.load();
+    stats.numOverflows = numOverflows.load();
+
+    const ScopedLock sl (writerThreadLock);
+    stats.numWriterThreads = writerThreads.size();
+
+    for (auto t : writerThreads)
+    {
+        const ScopedLock tsl (t->lock);
+        stats.numFilesRecording += t->queues.size();
+
+        for (auto q : t->queues)
+            stats.currentUsage = std::max (stats.currentUsage, q->getUsage());
+    }
+
+    return stats;
+}
+
+bool WaveInputRecordingThread::writeQueuedBlocks (WriterQueue& queue, bool writeEverything)
+{
+    if (queue.hasOverflowed && ! hasWarned.exchange (true))
+        TRACKTION_LOG_ERROR ("Audio recording can't keep up!");
 
-            if (block->thumbnail != nullptr)
+    if (! writeEverything && queue.fifo.getNumReady() < queue.minSamplesPerWrite)
+        return false;
+
+    bool anythingWritten = false;
+
+    while (auto numSamples = juce::jmin (queue.fifo.getNumReady(), queue.writeBuffer.getNumSamples()))
+    {
+        queue.fifo.read (queue.writeBuffer, 0, numSamples);
+        anythingWritten = true;
+
+        if (! queue.writer.appendBuffer (queue.writeBuffer, numSamples))
+        {
+            if (! hasSentStop.exchange (true))
             {
-                block->thumbnail->addBlock (block->buffer, 0, block->buffer.getNumSamples());
-                block->thumbnail = nullptr;
+                TRACKTION_LOG_ERROR ("Audio recording failed to write to disk!");
+                startTimer (1);
             }
-
-            queue->addToFreeQueue (block);
         }
-        else
-        {
-            if (threadShouldExit())
-                break;
 
-            wait (401);
-        }
+        // The peaks are added while the block's still in the cache
+        if (queue.thumbnail != nullptr)
+            queue.thumbnail->addBlock (queue.writeBuffer, 0, numSamples);
     }
+
+    return anythingWritten;
 }
 
 void WaveInputRecordingThread::timerCallback()
@@ -1934,17 +1950,40 @@ void WaveInputRecordingThread::timerCallback()
 void WaveInputRecordingThread::prepareToStart()
 {
     flushAndStop();
-    sleep (2);
-    jassert (! isThreadRunning());
-    startThread (5);
+    Thread::sleep (2);
+
+    peakFifoUsage = 0.0f;
+    numOverflows = 0;
+
+    const ScopedLock sl (writerThreadLock);
+
+    for (auto t : writerThreads)
+    {
+        jassert (! t->isThreadRunning());
+        t->startThread (5);
+    }
 }
 
 void WaveInputRecordingThread::flushAndStop()
 {
-    signalThreadShouldExit();
-    notify();
-    stopThread (30000);
-    queue->moveAnyPendingBlocksToFree();
+    const ScopedLock sl (writerThreadLock);
+
+    for (auto t : writerThreads)
+    {
+        t->signalThreadShouldExit();
+        t->notify();
+    }
+
+    for (auto t : writerThreads)
+    {
+        t->stopThread (30000);
+
+        const ScopedLock tsl (t->lock);
+
+        for (auto q : t->queues)
+            writeQueuedBlocks (*q, true);
+    }
+
     hasSentStop = false;
     hasWarned = false;
 }
@@ -112,8 +112,13 @@ private:
 
 
 //==============================================================================
-class WaveInputRecordingThread  : public juce::Thread,
-                                  private juce::Timer
+/**
+    Writes the audio being recorded to disk on a few background threads.
+
+    Each file being recorded is given to whichever thread has the fewest files, so
+    recording lots of inputs at once doesn't queue everything up behind one disk write.
+*/
+class WaveInputRecordingThread  : private juce::Timer
 {
 public:
     //==============================================================================
@@ -133,21 +138,56 @@ public:
     void removeUser();
 
     //==============================================================================
-    void addBlockToRecord (AudioFileWriter&, const juce::AudioBuffer<float>&,
-                           int start, int numSamples, const RecordingThumbnailManager::Thumbnail::Ptr&);
+    /** Each file being recorded has one of these, which holds a FIFO of the audio that
+        hasn't been written yet.
+    */
+    struct WriterQueue;
+
+    /** Starts queueing audio for a writer, returning the queue to pass to addBlockToRecord.
+        The writer must stay open until waitForWriterToFinish has been called for it.
+        This allocates the FIFO so must not be called on the audio thread.
+    */
+    WriterQueue& addWriter (AudioFileWriter&, const RecordingThumbnailManager::Thumbnail::Ptr&);
+
+    /** Copies a block into a writer's FIFO.
+        This doesn't lock or allocate so can be called on the audio thread, but only one
+        thread at a time should add blocks for each writer.
+    */
+    void addBlockToRecord (WriterQueue&, const juce::AudioBuffer<float>&, int start, int numSamples);
+
+    /** Writes anything that's still queued for a writer and stops queueing for it. */
     void waitForWriterToFinish (AudioFileWriter&);
-    void run() override;
-    void timerCallback() override;
+
+    //==============================================================================
+    /** Describes how close recording is to dropping samples. */
+    struct FifoStatistics
+    {
+        float currentUsage = 0.0f;  /**< How full the fullest FIFO is now, from 0 to 1. */
+        float peakUsage = 0.0f;     /**< The fullest any FIFO has been since recording started. */
+        int numOverflows = 0;       /**< The number of blocks that have been dropped. */
+        int numFilesRecording = 0;
+        int numWriterThreads = 0;
+    };
+
+    /** Returns the current FIFO usage. This can be called from any thread. */
+    FifoStatistics getFifoStatistics() const;
 
     Engine& engine;
 
 private:
+    struct WriterThread;
+
     int activeUsers = 0;
-    bool hasWarned = false, hasSentStop = false;
+    std::atomic<bool> hasWarned { false };
+    std::atomic<bool> hasSentStop { false };
+    std::atomic<float> peakFifoUsage { 0.0f };
+    std::atomic<int> numOverflows { 0 };
 
-    struct BlockQueue;
-    std::unique_ptr<BlockQueue> queue;
+    juce::CriticalSection writerThreadLock;
+    juce::OwnedArray<WriterThread> writerThreads;
 
+    void timerCallback() override;
+    bool writeQueuedBlocks (WriterQueue&, bool writeEverything);
     void prepareToStart();
     void flushAndStop();
 
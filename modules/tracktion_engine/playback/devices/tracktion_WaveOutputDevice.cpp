@@ -117,19 +117,15 @@ void WaveOutputDeviceInstance::prepareToPlay (double, int blockSize)
 
     int ditherDepth = jlimit (16, 32, edit.engine.getDeviceManager().getBitDepth());
 
-    ditherers[0].reset (ditherDepth);
-    ditherers[1].reset (ditherDepth);
+    ditherer.reset (outputBuffer.getNumChannels(), ditherDepth);
 }
 
-void WaveOutputDeviceInstance::fillNextAudioBlock (PlayHead& playhead, EditTimeRange streamTime,
-                                                   float** allChannels, int numSamples)
+void WaveOutputDeviceInstance::renderNextAudioBlock (PlayHead& playhead, EditTimeRange streamTime, int numSamples)
 {
     CRASH_TRACER
     const ScopedLock sl (audioNodeLock);
 
     WaveOutputDevice& wo = getWaveOutput();
-    const auto& channels = wo.getChannels();
-
     const auto& channelSet = wo.getChannelSet();
     midiBuffer.clear();
     outputBuffer.setSize (jmax (2, channelSet.size()), numSamples);
@@ -150,8 +146,7 @@ void WaveOutputDeviceInstance::fillNextAudioBlock (PlayHead& playhead, EditTimeR
         audioNode->renderOver (rc);
 
         if (wo.ditheringEnabled)
-            for (int i = 0; i < outputBuffer.getNumChannels(); ++i)
-                ditherers[i & 1].process (outputBuffer.getWritePointer (i), numSamples);
+            ditherer.process (outputBuffer.getArrayOfWritePointers(), outputBuffer.getNumChannels(), numSamples);
 
         jassert (outputBuffer.getNumSamples() == numSamples);
         outputBuffer.setSize (outputBuffer.getNumChannels(), numSamples, true); // (once had an unreproducible case where this buffer had been resized..)
@@ -162,8 +157,21 @@ void WaveOutputDeviceInstance::fillNextAudioBlock (PlayHead& playhead, EditTimeR
         outputBuffer.clear();
     }
 
+    // Anything below about -100dB counts as silence
+    if (edit.getIsPreviewEdit())
+        lastBlockWasSilent = outputBuffer.getMagnitude (0, numSamples) < 1.0e-5f;
+
+    context.masterLevels.processBuffer (outputBuffer, 0, numSamples);
+}
+
+void WaveOutputDeviceInstance::addToOutputChannels (float** allChannels, int numSamples)
+{
+    const ScopedLock sl (audioNodeLock);
     SCOPED_REALTIME_CHECK
 
+    const auto& channels = getWaveOutput().getChannels();
+    const auto& channelSet = getWaveOutput().getChannelSet();
+
     // This may need to deal with folding surround to stereo etc. but at the moment this us unsupported
     if (edit.engine.getEngineBehaviour().isDescriptionOfWaveDevicesSupported())
     {
@@ -236,8 +244,6 @@ void WaveOutputDeviceInstance::fillNextAudioBlock (PlayHead& playhead, EditTimeR
                 FloatVectorOperations::add (right, outputBuffer.getReadPointer (jmin (outputBuffer.getNumChannels() - 1, 1)), numSamples);
         }
     }
-
-    context.masterLevels.processBuffer (outputBuffer, 0, numSamples);
 }
 
 int WaveOutputDevice::getLeftChannel() const
@@ -77,13 +77,25 @@ public:
     WaveOutputDeviceInstance (WaveOutputDevice&, EditPlaybackContext&);
 
     void prepareToPlay (double sampleRate, int blockSizeSamples);
-    void fillNextAudioBlock (PlayHead&, EditTimeRange streamTime,
-                             float** allChannels, int numSamples);
+
+    /** Renders the next block into this instance's own buffer.
+        Instances belonging to different contexts can be rendered at the same time.
+    */
+    void renderNextAudioBlock (PlayHead&, EditTimeRange streamTime, int numSamples);
+
+    /** Adds the block that was last rendered to the device's channels. */
+    void addToOutputChannels (float** allChannels, int numSamples);
+
+    /** True if the block that was last rendered was inaudible.
+        This is only checked for preview Edits, which stop being rendered once they've gone quiet.
+    */
+    bool wasLastBlockSilent() const noexcept        { return lastBlockWasSilent; }
 
 protected:
-    Ditherer ditherers[2];
+    Ditherer ditherer;
     MidiMessageArray midiBuffer;
     juce::AudioBuffer<float> outputBuffer;
+    bool lastBlockWasSilent = true;
 
     WaveOutputDevice& getWaveOutput() const     { return static_cast<WaveOutputDevice&> (owner); }
 
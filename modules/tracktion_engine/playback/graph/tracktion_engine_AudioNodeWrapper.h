@@ -0,0 +1,389 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+#pragma once
+
+namespace tracktion_engine
+{
+
+//==============================================================================
+//==============================================================================
+/**
+    Processes a tree of AudioNodes as a single tracktion_graph Node.
+
+    This lets the existing track and plugin AudioNodes be connected together in a
+    tracktion_graph graph so independent trees can be processed concurrently.
+
+    The AudioNode tree must have already been prepared and prepareForNextBlock must be
+    called on it before each block is processed, this just renders it.
+    If the tree contains a GraphInputAudioNode, pass the Node it reads from as the input
+    so it's processed first.
+
+    The tree is shared so that it can be moved in to a new graph when only other parts
+    of an Edit have changed.
+
+    Like the MixerAudioNode, this renders regardless of AudioNode::isReadyToRender so the
+    AudioNodes must be safe to render concurrently with the others in the graph.
+*/
+class AudioNodeWrapperNode : public tracktion_graph::Node
+{
+public:
+    AudioNodeWrapperNode (std::shared_ptr<AudioNode> audioNodeToWrap,
+                          std::shared_ptr<InputProvider> contextProvider,
+                          std::unique_ptr<tracktion_graph::Node> inputNode = {})
+        : audioNode (std::move (audioNodeToWrap)),
+          audioRenderContextProvider (std::move (contextProvider)),
+          input (std::move (inputNode))
+    {
+        jassert (audioNode != nullptr);
+        jassert (audioRenderContextProvider != nullptr);
+    }
+
+    AudioNode& getAudioNode()
+    {
+        return *audioNode;
+    }
+
+    /** Makes sure another Node in the graph is processed before this one, without taking
+        ownership of it or using its output. This is used when the AudioNode tree talks to
+        another one directly, e.g. when an aux return needs all its sends to have run first.
+    */
+    void addDependency (tracktion_graph::Node& nodeToProcessFirst)
+    {
+        jassert (&nodeToProcessFirst != this);
+        dependencies.push_back (&nodeToProcessFirst);
+    }
+
+    tracktion_graph::NodeProperties getNodeProperties() override
+    {
+        AudioNodeProperties info;
+        info.hasAudio = false;
+        info.hasMidi = false;
+        info.numberOfChannels = 0;
+        audioNode->getAudioNodeProperties (info);
+
+        tracktion_graph::NodeProperties props;
+        props.hasAudio = info.hasAudio;
+        props.hasMidi = info.hasMidi;
+        props.numberOfChannels = std::max (2, info.numberOfChannels);
+        props.nodeID = nodeID;
+
+        return props;
+    }
+
+    std::vector<Node*> getDirectInputNodes() override
+    {
+        auto inputs = dependencies;
+
+        if (input != nullptr)
+            inputs.push_back (input.get());
+
+        return inputs;
+    }
+
+    bool isReadyToProcess() override
+    {
+        for (auto d : dependencies)
+            if (! d->hasProcessed())
+                return false;
+
+        return input == nullptr || input->hasProcessed();
+    }
+
+    ProcessingCost getProcessingCost() override
+    {
+        return ProcessingCost::expensive;
+    }
+
+    void process (const ProcessContext& pc) override
+    {
+        auto& outputAudioBlock = pc.buffers.audio;
+
+        constexpr size_t maxNumChannels = 64;
+        float* channels[maxNumChannels] = {};
+        const size_t numChannelsToUse = std::min (outputAudioBlock.getNumChannels(), maxNumChannels);
+
+        for (size_t i = 0; i < numChannelsToUse; ++i)
+            channels[i] = outputAudioBlock.getChannelPointer (i);
+
+        AudioBuffer<float> outputAudioBuffer (channels,
+                                              (int) numChannelsToUse,
+                                              (int) outputAudioBlock.getNumSamples());
+
+        auto rc = audioRenderContextProvider->getContextForSubBlock (pc.streamSampleRange);
+        rc.destBuffer = &outputAudioBuffer;
+        rc.destBufferChannels = juce::AudioChannelSet::canonicalChannelSet ((int) numChannelsToUse);
+        rc.bufferStartSample = 0;
+        rc.bufferNumSamples = outputAudioBuffer.getNumSamples();
+        rc.bufferForMidiMessages = &pc.buffers.midi;
+        rc.midiBufferOffset = 0.0;
+
+        audioNode->renderOver (rc);
+    }
+
+private:
+    std::shared_ptr<AudioNode> audioNode;
+    std::shared_ptr<InputProvider> audioRenderContextProvider;
+    std::unique_ptr<tracktion_graph::Node> input;
+    std::vector<tracktion_graph::Node*> dependencies;
+    const size_t nodeID { (size_t) juce::Random::getSystemRandom().nextInt() };
+};
+
+
+//==============================================================================
+//==============================================================================
+/**
+    An AudioNode that renders the processed output of a tracktion_graph Node.
+
+    This is used to build AudioNode chains on top of Nodes, e.g. master plugins on
+    top of a SummingNode, and to give output devices the result of a graph. The
+    Node must have been processed before this is rendered and must outlive it.
+
+    The AudioNodes rendered by the Node can be passed in so they are visited by
+    visitNodes, e.g. to find clip nodes in a tree that's being replaced. They aren't
+    prepared or purged by this.
+*/
+class GraphInputAudioNode  : public AudioNode
+{
+public:
+    GraphInputAudioNode (tracktion_graph::Node& nodeToRead, int numAudioChannels, bool hasMidiInput,
+                         juce::Array<AudioNode*> audioNodesToVisit = {})
+        : node (nodeToRead), numChannels (numAudioChannels), hasMidi (hasMidiInput),
+          nodesToVisit (std::move (audioNodesToVisit))
+    {
+    }
+
+    void getAudioNodeProperties (AudioNodeProperties& info) override
+    {
+        info.hasAudio = numChannels > 0;
+        info.hasMidi = hasMidi;
+        info.numberOfChannels = numChannels;
+    }
+
+    void visitNodes (const VisitorFn& v) override
+    {
+        for (auto n : nodesToVisit)
+            n->visitNodes (v);
+
+        v (*this);
+    }
+
+    void prepareAudioNodeToPlay (const PlaybackInitialisationInfo&) override {}
+    bool purgeSubNodes (bool keepAudio, bool keepMidi) override     { return (keepAudio && numChannels > 0) || (keepMidi && hasMidi); }
+    void releaseAudioNodeResources() override                       {}
+    bool isReadyToRender() override                                 { return node.hasProcessed(); }
+
+    void renderOver (const AudioRenderContext& rc) override
+    {
+        callRenderAdding (rc);
+    }
+
+    void renderAdding (const AudioRenderContext& rc) override
+    {
+        jassert (node.hasProcessed());
+        auto output = node.getProcessedOutput();
+
+        if (auto dest = rc.destBuffer)
+        {
+            const int numSamples = std::min (rc.bufferNumSamples, (int) output.audio.getNumSamples());
+            const int numChannelsToAdd = std::min (dest->getNumChannels(), (int) output.audio.getNumChannels());
+            jassert (numSamples == rc.bufferNumSamples);
+
+            for (int c = 0; c < numChannelsToAdd; ++c)
+                dest->addFrom (c, rc.bufferStartSample, output.audio.getChannelPointer ((size_t) c), numSamples);
+        }
+
+        if (rc.bufferForMidiMessages != nullptr)
+            rc.bufferForMidiMessages->mergeFromWithOffset (output.midi, rc.midiBufferOffset);
+    }
+
+private:
+    tracktion_graph::Node& node;
+    const int numChannels;
+    const bool hasMidi;
+    juce::Array<AudioNode*> nodesToVisit;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (GraphInputAudioNode)
+};
+
+
+//==============================================================================
+//==============================================================================
+/**
+    The root of a graph with several outputs, e.g. one for each output device.
+    This has no output of its own, it just makes sure all its inputs are processed.
+    Their outputs can then be read until the next block is processed.
+*/
+class MultipleOutputsNode  : public tracktion_graph::Node
+{
+public:
+    MultipleOutputsNode (std::vector<std::unique_ptr<tracktion_graph::Node>> outputNodes)
+        : outputs (std::move (outputNodes))
+    {
+    }
+
+    tracktion_graph::NodeProperties getNodeProperties() override
+    {
+        return { false, false, 0 };
+    }
+
+    std::vector<Node*> getDirectInputNodes() override
+    {
+        std::vector<Node*> inputs;
+
+        for (auto& output : outputs)
+            inputs.push_back (output.get());
+
+        return inputs;
+    }
+
+    bool isReadyToProcess() override
+    {
+        for (auto& output : outputs)
+            if (! output->hasProcessed())
+                return false;
+
+        return true;
+    }
+
+    ProcessingCost getProcessingCost() override
+    {
+        return ProcessingCost::cheap;
+    }
+
+    void process (const ProcessContext&) override
+    {
+    }
+
+private:
+    std::vector<std::unique_ptr<tracktion_graph::Node>> outputs;
+};
+
+
+//==============================================================================
+/** Returns true if the connections between a graph's trees make a loop. */
+template<typename TreeID>
+static inline bool hasLoop (const std::map<TreeID, std::vector<TreeID>>& edges)
+{
+    enum { unvisited, visiting, visited };
+    std::map<TreeID, int> states;
+
+    std::function<bool (TreeID)> visit = [&] (TreeID id)
+    {
+        auto& state = states[id];
+
+        if (state != unvisited)
+            return state == visiting;
+
+        state = visiting;
+        auto found = edges.find (id);
+
+        if (found != edges.end())
+            for (auto dest : found->second)
+                if (visit (dest))
+                    return true;
+
+        state = visited;
+        return false;
+    };
+
+    for (auto& e : edges)
+        if (visit (e.first))
+            return true;
+
+    return false;
+}
+
+/** Turns the sidechains between the trees of a graph in to dependencies between their Nodes,
+    so the trees with sidechain receivers wait for the ones with the sources they use and the
+    sources don't have to be delayed by a block. All the receivers read the source's block
+    directly however many there are.
+
+    A source is only passed on in order if this doesn't make a loop with the connections
+    already made between the trees, e.g. for aux buses. Otherwise it's delayed by a block so
+    it's ready whichever order the trees are processed in.
+
+    @param treeAudioNodes   The AudioNodes in each tree
+    @param treeNodes        The wrappers in each tree, the one producing the tree's output last
+    @param connections      The trees each tree has already been made to process before
+*/
+template<typename TreeID>
+static inline void orderSidechainsInGraph (const std::map<TreeID, juce::Array<AudioNode*>>& treeAudioNodes,
+                                           const std::map<TreeID, std::vector<AudioNodeWrapperNode*>>& treeNodes,
+                                           std::map<TreeID, std::vector<TreeID>> connections)
+{
+    struct SidechainTrees
+    {
+        SidechainSendAudioNode* send = nullptr;
+        TreeID sendTree {};
+        std::vector<TreeID> receiveTrees;
+    };
+
+    std::map<EditItemID, SidechainTrees> sidechains;
+
+    for (auto& audioNodes : treeAudioNodes)
+    {
+        auto tree = audioNodes.first;
+
+        for (auto audioNode : audioNodes.second)
+        {
+            audioNode->visitNodes ([&] (AudioNode& n)
+                                   {
+                                       if (auto send = dynamic_cast<SidechainSendAudioNode*> (&n))
+                                       {
+                                           auto& sidechain = sidechains[send->srcTrackID];
+                                           sidechain.send = send;
+                                           sidechain.sendTree = tree;
+                                       }
+                                       else if (auto receive = dynamic_cast<SidechainReceiveAudioNode*> (&n))
+                                       {
+                                           auto& trees = sidechains[receive->getSourceTrackID()].receiveTrees;
+
+                                           if (std::find (trees.begin(), trees.end(), tree) == trees.end())
+                                               trees.push_back (tree);
+                                       }
+                                   });
+        }
+    }
+
+    for (auto& s : sidechains)
+    {
+        auto& sidechain = s.second;
+
+        if (sidechain.send == nullptr)
+            continue;
+
+        auto sendNodes = treeNodes.find (sidechain.sendTree);
+        auto newConnections = connections;
+
+        for (auto r : sidechain.receiveTrees)
+            newConnections[sidechain.sendTree].push_back (r);
+
+        const bool canBeProcessedInOrder = sendNodes != treeNodes.end() && ! hasLoop (newConnections);
+        sidechain.send->setProcessedInGraphOrder (canBeProcessedInOrder);
+
+        if (! canBeProcessedInOrder)
+            continue;
+
+        connections = std::move (newConnections);
+
+        // The sending tree's output Node is last, and all of a receiving tree's Nodes have to wait for it
+        for (auto r : sidechain.receiveTrees)
+        {
+            auto receiveNodes = treeNodes.find (r);
+
+            if (receiveNodes != treeNodes.end())
+                for (auto receiveNode : receiveNodes->second)
+                    receiveNode->addDependency (*sendNodes->second.back());
+        }
+    }
+}
+
+}
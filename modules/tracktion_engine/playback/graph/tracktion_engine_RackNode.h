@@ -44,12 +44,49 @@ struct InputProvider
         jassert (context != nullptr);
         return *context;
     }
+
+    /** Sets the stream range of the block the inputs and context refer to. */
+    void setStreamSampleRange (juce::Range<int64_t> newRange)
+    {
+        streamSampleRange = newRange;
+    }
+
+    /** Returns the number of samples from the start of the inputs a sub-block starts at.
+        If the player has split the block in to sub-blocks, Nodes use this to find their
+        part of the inputs and context.
+    */
+    int64_t getSubBlockOffset (juce::Range<int64_t> subBlockRange) const
+    {
+        if (streamSampleRange.contains (subBlockRange))
+            return subBlockRange.getStart() - streamSampleRange.getStart();
+
+        return 0;
+    }
+
+    /** Returns a copy of the current context with the stream time adjusted to a sub-block.
+        If the range is the whole block, this is the same as the current context.
+    */
+    tracktion_engine::AudioRenderContext getContextForSubBlock (juce::Range<int64_t> subBlockRange) const
+    {
+        jassert (context != nullptr);
+        tracktion_engine::AudioRenderContext rc (*context);
+
+        if (subBlockRange != streamSampleRange && streamSampleRange.contains (subBlockRange))
+        {
+            const double streamTimePerSample = rc.streamTime.getLength() / (double) streamSampleRange.getLength();
+            rc.streamTime = EditTimeRange::withStartAndLength (rc.streamTime.getStart() + getSubBlockOffset (subBlockRange) * streamTimePerSample,
+                                                               subBlockRange.getLength() * streamTimePerSample);
+        }
+
+        return rc;
+    }
     
     int numChannels = 0;
     juce::dsp::AudioBlock<float> audio;
     tracktion_engine::MidiMessageArray midi;
 
     tracktion_engine::AudioRenderContext* context = nullptr;
+    juce::Range<int64_t> streamSampleRange;
 };
 
 
@@ -82,13 +119,15 @@ public:
         return true;
     }
     
-    void prepareToPlay (const tracktion_graph::PlaybackInitialisationInfo&) override
+    void prepareToPlay (const tracktion_graph::PlaybackInitialisationInfo& info) override
     {
+        sampleRate = info.sampleRate;
     }
     
     void process (const ProcessContext& pc) override
     {
         auto inputBuffers = inputProvider->getInputs();
+        const auto subBlockOffset = inputProvider->getSubBlockOffset (pc.streamSampleRange);
 
         if (numChannels > 0)
         {
@@ -99,21 +138,39 @@ public:
             
             // For testing purposes, the last block might be smaller than the InputProvider
             // so we'll just take the number of samples required
-            jassert (inputBuffers.audio.getNumSamples() >= outputBuffers.audio.getNumSamples());
+            jassert (inputBuffers.audio.getNumSamples() >= (size_t) subBlockOffset + outputBuffers.audio.getNumSamples());
             auto inputAudioBlock = inputBuffers.audio.getSubsetChannelBlock (0, numInputChannelsToCopy)
-                                    .getSubBlock (0, outputBuffers.audio.getNumSamples());
+                                    .getSubBlock ((size_t) subBlockOffset, outputBuffers.audio.getNumSamples());
             auto outputAudioBlock = outputBuffers.audio.getSubsetChannelBlock (0, numInputChannelsToCopy);
             outputAudioBlock.add (inputAudioBlock);
         }
         
         if (hasMidi)
-            pc.buffers.midi = inputBuffers.midi;
+        {
+            if (subBlockOffset == 0 && inputProvider->streamSampleRange.getLength() <= pc.streamSampleRange.getLength())
+            {
+                pc.buffers.midi.copyFrom (inputBuffers.midi);
+            }
+            else
+            {
+                // Only take the messages in this sub-block
+                const auto startTime = subBlockOffset / sampleRate;
+                const auto endTime = startTime + pc.streamSampleRange.getLength() / sampleRate;
+                pc.buffers.midi.clear();
+                pc.buffers.midi.isAllNotesOff = inputBuffers.midi.isAllNotesOff;
+
+                for (auto& m : inputBuffers.midi)
+                    if (m.getTimeStamp() >= startTime && m.getTimeStamp() < endTime)
+                        pc.buffers.midi.add (m, m.getTimeStamp() - startTime);
+            }
+        }
     }
     
 private:
     std::shared_ptr<InputProvider> inputProvider;
     const int numChannels;
     const bool hasMidi;
+    double sampleRate = 44100.0;
     const size_t nodeID { (size_t) juce::Random::getSystemRandom().nextInt() };
 };
 
@@ -170,6 +227,26 @@ public:
     {
         return input->hasProcessed();
     }
+
+    ProcessingCost getProcessingCost() override
+    {
+        return ProcessingCost::expensive;
+    }
+
+    bool needsSubBlockBoundaries() override
+    {
+        return canUseFineGrainAutomation;
+    }
+
+    void addSubBlockBoundaries (juce::Range<int64_t> streamSampleRange, std::vector<int64_t>& boundaries) override
+    {
+        // Split the block whilst automation is active so it's applied in small steps
+        if (! plugin->isAutomationNeeded())
+            return;
+
+        for (auto b = streamSampleRange.getStart() + numSamplesPerAutomationBlock; b < streamSampleRange.getEnd(); b += numSamplesPerAutomationBlock)
+            boundaries.push_back (b);
+    }
     
     void prepareToPlay (const tracktion_graph::PlaybackInitialisationInfo& info) override
     {
@@ -211,8 +288,7 @@ public:
         midiMessageArray.copyFrom (inputBuffers.midi);
 
         // Then prepare the AudioRenderContext
-        auto sourceContext = audioRenderContextProvider->getContext();
-        tracktion_engine::AudioRenderContext rc (sourceContext);
+        auto rc = audioRenderContextProvider->getContextForSubBlock (pc.streamSampleRange);
         rc.destBuffer = &outputAudioBuffer;
         rc.bufferStartSample = 0;
         rc.bufferNumSamples = outputAudioBuffer.getNumSamples();
@@ -221,7 +297,7 @@ public:
 
         // Process the plugin
         //TODO: If a plugin is disabled we should probably apply our own latency to the plugin
-        if (plugin->isEnabled())
+        if (plugin->isEnabled() && (rc.isRendering || ! plugin->isBypassedToSaveCpu()))
             plugin->applyToBufferWithAutomation (rc);
         
         // Then copy the buffers to the outputs
@@ -236,6 +312,8 @@ private:
     bool isInitialised = false;
     double sampleRate = 44100.0;
     tracktion_engine::MidiMessageArray midiMessageArray;
+    bool canUseFineGrainAutomation = false;
+    int numSamplesPerAutomationBlock = 128;
 
     void initialisePlugin (double sampleRateToUse, int blockSizeToUse)
     {
@@ -249,6 +327,8 @@ private:
         isInitialised = true;
 
         sampleRate = sampleRateToUse;
+        canUseFineGrainAutomation = plugin->canUseFineGrainAutomation();
+        numSamplesPerAutomationBlock = jmax (128, 128 * roundToInt (sampleRate / 44100.0));
     }
 };
 
@@ -349,8 +429,7 @@ public:
         midiMessageArray.copyFrom (inputBuffers.midi);
 
         // Then prepare the AudioRenderContext
-        auto sourceContext = audioRenderContextProvider->getContext();
-        tracktion_engine::AudioRenderContext rc (sourceContext);
+        auto rc = audioRenderContextProvider->getContextForSubBlock (pc.streamSampleRange);
         rc.destBuffer = &outputAudioBuffer;
         rc.bufferStartSample = 0;
         rc.bufferNumSamples = outputAudioBuffer.getNumSamples();
@@ -403,9 +482,23 @@ public:
     {
         return input->hasProcessed();
     }
+
+    ProcessingCost getProcessingCost() override
+    {
+        return ProcessingCost::cheap;
+    }
+
+    bool canProcessInPlace() override
+    {
+        return true;
+    }
     
     void process (const ProcessContext& pc) override
     {
+        // When processing in-place the input is already in the output buffers
+        if (isProcessingInPlace())
+            return;
+
         auto inputBuffers = input->getProcessedOutput();
         pc.buffers.audio.copyFrom (inputBuffers.audio);
         pc.buffers.midi.copyFrom (inputBuffers.midi);
@@ -483,6 +576,12 @@ public:
         return nodePlayer.getNode().getNodeProperties().latencyNumSamples;
     }
 
+    /** Returns the NodePlayer so it can be configured before it's prepared. */
+    NodePlayerType& getNodePlayer()
+    {
+        return nodePlayer;
+    }
+
     /** Processes a block of audio and MIDI data.
         Returns the number of times a node was checked but unable to be processed.
     */
@@ -499,6 +598,8 @@ public:
         if (overrideInputs)
             inputProvider->setInputs (pc.buffers);
 
+        inputProvider->setStreamSampleRange (pc.streamSampleRange);
+
         // The internal nodes won't be interested in the top level audio/midi inputs
         // They should only be referencing this for time and continuity
         tracktion_engine::AudioRenderContext rc (ph, stream,
@@ -27,13 +27,21 @@ struct AbletonLink::ImplBase  : public Timer
         {
             stopTimer();
             transport.engine.getDeviceManager().setSpeedCompensation (0.0);
+            driftSmoother.reset();
         }
     }
 
     void timerCallback() override
     {
+        const auto timeNowHiRes = juce::Time::getMillisecondCounterHiRes();
+        const auto secondsSinceLastUpdate = (timeNowHiRes - lastUpdateTimeMs) / 1000.0;
+        lastUpdateTimeMs = timeNowHiRes;
+
         if (! transport.isPlaying() || ! isConnected)
+        {
+            driftSmoother.reset();
             return;
+        }
 
         auto& deviceManager = transport.engine.getDeviceManager();
 
@@ -60,14 +68,16 @@ struct AbletonLink::ImplBase  : public Timer
         if (std::abs (offset) >= 0.25 && timeNow > inhibitTimer)
         {
             inhibitTimer = timeNow + 250;
+            driftSmoother.reset();
+            deviceManager.setSpeedCompensation (0.0);
 
             listeners.call (&Listener::linkRequestedPositionChange, offset * tempoDivisor);
         }
-        else
+        else if (std::abs (offset) < 0.25)
         {
-            const double speedComp = jlimit (-10.0, 10.0, offset * 10.0);
-
-            deviceManager.setSpeedCompensation (speedComp);
+            // Small errors are nudged away by slightly changing the speed, which is
+            // inaudible and, unlike relocating, doesn't make the readers seek
+            deviceManager.setSpeedCompensation (driftSmoother.update (offset / bps, secondsSinceLastUpdate));
         }
     }
 
@@ -164,6 +174,8 @@ struct AbletonLink::ImplBase  : public Timer
     bool isConnected = false;
     int customOffsetMs = 0;
     juce::uint32 inhibitTimer = 0;
+    ClockDriftSmoother driftSmoother;
+    double lastUpdateTimeMs = 0;
 
     juce::Range<double> allowedTempos { 0.0, 999.0 };
 };
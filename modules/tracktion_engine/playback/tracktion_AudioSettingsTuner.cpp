@@ -0,0 +1,337 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+AudioSettingsTuner::AudioSettingsTuner (Engine& e)  : engine (e)
+{
+}
+
+AudioSettingsTuner::~AudioSettingsTuner()
+{
+    stopTimer();
+}
+
+void AudioSettingsTuner::setSettings (const Settings& newSettings)
+{
+    TRACKTION_ASSERT_MESSAGE_THREAD
+    jassert (newSettings.minLatencyMs <= newSettings.maxLatencyMs);
+    settings = newSettings;
+    reset();
+}
+
+void AudioSettingsTuner::setEnabled (bool shouldBeEnabled)
+{
+    TRACKTION_ASSERT_MESSAGE_THREAD
+
+    if (shouldBeEnabled == isEnabled())
+        return;
+
+    if (shouldBeEnabled)
+    {
+        reset();
+        startTimer (500);
+    }
+    else
+    {
+        stopTimer();
+        hasPendingBufferSize = false;
+    }
+}
+
+void AudioSettingsTuner::reset()
+{
+    threadMeasurements.clear();
+    bufferSizeMeasurements.clear();
+    hasPendingBufferSize = false;
+    lastBufferSize = 0;
+    lastNumThreads = -1;
+    lastSampleRate = 0.0;
+    recommendation = {};
+    restartMeasuring();
+}
+
+//==============================================================================
+void AudioSettingsTuner::timerCallback()
+{
+    auto& dm = engine.getDeviceManager();
+    auto device = dm.deviceManager.getCurrentAudioDevice();
+
+    if (device == nullptr)
+        return;
+
+    auto sampleRate = device->getCurrentSampleRate();
+    auto bufferSize = device->getCurrentBufferSizeSamples();
+    auto numThreads = engine.getRealtimeWorkerPool().getNumThreads();
+
+    if (sampleRate <= 0.0 || bufferSize <= 0)
+        return;
+
+    // The measurements for one sample rate don't say much about another
+    if (sampleRate != lastSampleRate)
+    {
+        reset();
+        lastSampleRate = sampleRate;
+    }
+
+    // Anything measured since the settings changed is a mixture of the two
+    if (bufferSize != lastBufferSize || numThreads != lastNumThreads)
+    {
+        lastBufferSize = bufferSize;
+        lastNumThreads = numThreads;
+        restartMeasuring();
+        return;
+    }
+
+    if (hasPendingBufferSize)
+    {
+        applyRecommendation (*device);
+        return;
+    }
+
+    // Only the callbacks whilst something's playing are worth judging the graph by
+    if (! isAnyEditPlaying())
+    {
+        restartMeasuring();
+        return;
+    }
+
+    auto snapshot = dm.getCallbackTimingStatistics().getSnapshot();
+
+    if (snapshot.numCallbacks * (double) bufferSize / sampleRate < settings.measurementSeconds)
+        return;
+
+    measureCurrentSettings (*device, snapshot);
+    restartMeasuring();
+}
+
+void AudioSettingsTuner::measureCurrentSettings (juce::AudioIODevice& device, const CallbackTimingStatistics::Snapshot& snapshot)
+{
+    auto bufferSize = device.getCurrentBufferSizeSamples();
+    auto numThreads = engine.getRealtimeWorkerPool().getNumThreads();
+
+    Measurement m;
+    m.load = snapshot.getLoadPercentile (0.99);
+    m.overran = snapshot.numOverruns > 0;
+    m.graphSecondsPerSample = snapshot.stageSeconds[CallbackTimingStatistics::graphStage]
+                                / ((double) snapshot.numCallbacks * bufferSize);
+
+    threadMeasurements[numThreads] = m;
+
+    if (settings.tuneNumWorkerThreads)
+    {
+        auto bestNumThreads = chooseNumThreads (numThreads);
+
+        if (bestNumThreads != numThreads)
+        {
+            // The buffer sizes will need measuring again with the new threads
+            bufferSizeMeasurements.clear();
+            updateRecommendation (bufferSize, bestNumThreads, m.load, false);
+            applyRecommendation (device);
+            return;
+        }
+    }
+
+    bufferSizeMeasurements[bufferSize] = m;
+
+    auto bestBufferSize = settings.tuneBufferSize ? chooseBufferSize (device) : bufferSize;
+    updateRecommendation (bestBufferSize, numThreads, m.load, bestBufferSize == bufferSize);
+    applyRecommendation (device);
+}
+
+int AudioSettingsTuner::chooseNumThreads (int currentNumThreads) const
+{
+    auto& pool = engine.getRealtimeWorkerPool();
+    auto maxNumThreads = settings.maxNumWorkerThreads < 0 ? pool.getMaxNumThreads()
+                                                          : jmin (settings.maxNumWorkerThreads, pool.getMaxNumThreads());
+
+    auto best = currentNumThreads;
+    auto bestTime = threadMeasurements.at (currentNumThreads).graphSecondsPerSample;
+
+    // Fewer threads are tried first, and another thread has to be a clear improvement to be kept
+    for (auto candidate : { currentNumThreads - 1, currentNumThreads + 1 })
+    {
+        if (candidate < 0 || candidate > maxNumThreads)
+            continue;
+
+        auto measured = threadMeasurements.find (candidate);
+
+        if (measured == threadMeasurements.end())
+        {
+            if (settings.applyAutomatically)
+                return candidate;
+
+            continue;
+        }
+
+        auto threshold = candidate > best ? 0.95 : 1.05;
+
+        if (measured->second.graphSecondsPerSample < bestTime * threshold)
+        {
+            best = candidate;
+            bestTime = measured->second.graphSecondsPerSample;
+        }
+    }
+
+    return best;
+}
+
+int AudioSettingsTuner::chooseBufferSize (juce::AudioIODevice& device) const
+{
+    auto current = device.getCurrentBufferSizeSamples();
+
+    // The host decides the block size, so there's nothing to choose from
+    if (engine.getDeviceManager().isHostedAudioDeviceInterfaceInUse())
+        return current;
+
+    auto sizes = getAllowedBufferSizes (device);
+
+    if (sizes.isEmpty())
+        return current;
+
+    if (current < sizes.getFirst())  return sizes.getFirst();
+    if (current > sizes.getLast())   return sizes.getLast();
+
+    auto isStable = [this] (const Measurement& m)  { return ! m.overran && m.load <= settings.targetLoad; };
+    auto& currentMeasurement = bufferSizeMeasurements.at (current);
+
+    if (! isStable (currentMeasurement))
+    {
+        for (auto size : sizes)
+            if (size > current)
+                return size;
+
+        return current;
+    }
+
+    int smaller = 0;
+
+    for (auto size : sizes)
+        if (size < current)
+            smaller = size;
+
+    if (smaller == 0)
+        return current;
+
+    auto measured = bufferSizeMeasurements.find (smaller);
+
+    if (measured != bufferSizeMeasurements.end())
+        return isStable (measured->second) ? smaller : current;
+
+    if (settings.applyAutomatically)
+        return smaller;
+
+    // Without trying it, assume the worst: that the callbacks take just as long in a smaller buffer
+    return currentMeasurement.load * current / (float) smaller <= settings.targetLoad ? smaller : current;
+}
+
+juce::Array<int> AudioSettingsTuner::getAllowedBufferSizes (juce::AudioIODevice& device) const
+{
+    juce::Array<int> sizes;
+    auto sampleRate = device.getCurrentSampleRate();
+
+    for (auto size : device.getAvailableBufferSizes())
+    {
+        auto ms = size * 1000.0 / sampleRate;
+
+        if (ms >= settings.minLatencyMs && ms <= settings.maxLatencyMs)
+            sizes.addIfNotAlreadyThere (size);
+    }
+
+    sizes.sort();
+    return sizes;
+}
+
+void AudioSettingsTuner::updateRecommendation (int bufferSize, int numThreads, float load, bool settled)
+{
+    Recommendation r;
+    r.bufferSize = bufferSize;
+    r.numWorkerThreads = numThreads;
+    r.load = load;
+    r.isSettled = settled;
+
+    auto changed = r.bufferSize != recommendation.bufferSize
+                    || r.numWorkerThreads != recommendation.numWorkerThreads
+                    || r.isSettled != recommendation.isSettled;
+
+    recommendation = r;
+
+    if (changed && onRecommendationChanged != nullptr)
+        onRecommendationChanged();
+}
+
+void AudioSettingsTuner::applyRecommendation (juce::AudioIODevice& device)
+{
+    hasPendingBufferSize = false;
+
+    if (! settings.applyAutomatically || recommendation.bufferSize == 0)
+        return;
+
+    auto& dm = engine.getDeviceManager();
+    auto& pool = engine.getRealtimeWorkerPool();
+
+    if (recommendation.numWorkerThreads != pool.getNumThreads())
+    {
+        TRACKTION_LOG ("Tuning the number of audio worker threads: " + juce::String (recommendation.numWorkerThreads));
+
+        {
+            const ScopedLock sl (dm.deviceManager.getAudioCallbackLock());
+            pool.setNumThreads (recommendation.numWorkerThreads);
+        }
+
+        lastNumThreads = pool.getNumThreads();
+        restartMeasuring();
+    }
+
+    if (recommendation.bufferSize == device.getCurrentBufferSizeSamples()
+         || dm.isHostedAudioDeviceInterfaceInUse())
+        return;
+
+    // Restarting the device would glitch, so this waits for everything to stop
+    if (isAnyEditPlaying())
+    {
+        hasPendingBufferSize = true;
+        return;
+    }
+
+    TRACKTION_LOG ("Tuning the audio buffer size: " + juce::String (recommendation.bufferSize));
+
+    auto setup = dm.deviceManager.getAudioDeviceSetup();
+    setup.bufferSize = recommendation.bufferSize;
+    dm.deviceManager.setAudioDeviceSetup (setup, true);
+
+    // If the device wouldn't take it, don't keep trying
+    auto newDevice = dm.deviceManager.getCurrentAudioDevice();
+
+    if (newDevice == nullptr || newDevice->getCurrentBufferSizeSamples() != recommendation.bufferSize)
+    {
+        Measurement failed;
+        failed.load = 1.0f;
+        failed.overran = true;
+        bufferSizeMeasurements[recommendation.bufferSize] = failed;
+    }
+}
+
+bool AudioSettingsTuner::isAnyEditPlaying() const
+{
+    for (auto edit : engine.getActiveEdits().getEdits())
+        if (edit->getTransport().isPlaying())
+            return true;
+
+    return false;
+}
+
+void AudioSettingsTuner::restartMeasuring()
+{
+    engine.getDeviceManager().getCallbackTimingStatistics().reset();
+}
+
+} // namespace tracktion_engine
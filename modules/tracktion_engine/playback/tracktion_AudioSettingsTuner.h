@@ -0,0 +1,105 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+/**
+    Watches how long the audio callbacks take whilst Edits are playing, and works out
+    the smallest stable buffer size and the best number of worker threads for them.
+
+    It uses the DeviceManager's CallbackTimingStatistics, so it measures the real graph
+    rather than guessing. The number of threads is settled first, by trying the counts
+    either side of the current one and keeping whichever renders the graph quickest. Then
+    the buffer size is stepped down until the callbacks get too close to their deadline,
+    and back up if they overrun.
+
+    By default this only makes recommendations, which can only be based on the current
+    settings. If applyAutomatically is set, it tries the other settings itself. Buffer
+    sizes are only changed whilst nothing is playing, to avoid a glitch, and never for
+    the HostedAudioDeviceInterface, whose block size belongs to the host.
+
+    There's one of these for each Engine, accessed via Engine::getAudioSettingsTuner().
+    It's off until setEnabled() is called and should only be used on the message thread.
+*/
+class AudioSettingsTuner   : private juce::Timer
+{
+public:
+    AudioSettingsTuner (Engine&);
+    ~AudioSettingsTuner() override;
+
+    //==============================================================================
+    struct Settings
+    {
+        double minLatencyMs = 0.0;          /**< The smallest buffer, as a length of time, that may be used. */
+        double maxLatencyMs = 50.0;         /**< The largest buffer, as a length of time, that may be used. */
+        float targetLoad = 0.7f;            /**< How much of the deadline 99% of callbacks should finish within. */
+        double measurementSeconds = 5.0;    /**< How long each setting is played for before it's judged. */
+        int maxNumWorkerThreads = -1;       /**< Limits the threads tried, -1 meaning the pool's maximum. */
+        bool tuneBufferSize = true;
+        bool tuneNumWorkerThreads = true;
+        bool applyAutomatically = false;
+    };
+
+    void setSettings (const Settings&);
+    Settings getSettings() const                        { return settings; }
+
+    void setEnabled (bool);
+    bool isEnabled() const                              { return isTimerRunning(); }
+
+    /** Forgets everything that's been measured, e.g. after the graph has changed a lot. */
+    void reset();
+
+    //==============================================================================
+    struct Recommendation
+    {
+        int bufferSize = 0;                 /**< 0 until something has been measured. */
+        int numWorkerThreads = 0;
+        float load = 0.0f;                  /**< The 99th percentile load measured with the current settings. */
+        bool isSettled = false;             /**< True once there's nothing left worth trying. */
+    };
+
+    Recommendation getRecommendation() const            { return recommendation; }
+
+    /** Called on the message thread whenever the recommendation changes. */
+    std::function<void()> onRecommendationChanged;
+
+private:
+    //==============================================================================
+    struct Measurement
+    {
+        float load = 0.0f;                  // 99th percentile of the callback load
+        double graphSecondsPerSample = 0.0;
+        bool overran = false;
+    };
+
+    Engine& engine;
+    Settings settings;
+    Recommendation recommendation;
+
+    std::map<int, Measurement> threadMeasurements, bufferSizeMeasurements;
+    int lastBufferSize = 0, lastNumThreads = -1;
+    double lastSampleRate = 0.0;
+    bool hasPendingBufferSize = false;
+
+    void timerCallback() override;
+    void measureCurrentSettings (juce::AudioIODevice&, const CallbackTimingStatistics::Snapshot&);
+    int chooseNumThreads (int currentNumThreads) const;
+    int chooseBufferSize (juce::AudioIODevice&) const;
+    juce::Array<int> getAllowedBufferSizes (juce::AudioIODevice&) const;
+    void updateRecommendation (int bufferSize, int numThreads, float load, bool settled);
+    void applyRecommendation (juce::AudioIODevice&);
+    bool isAnyEditPlaying() const;
+    void restartMeasuring();
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioSettingsTuner)
+};
+
+} // namespace tracktion_engine
@@ -0,0 +1,224 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+static constexpr int callbackTimingBinsPerDeadline = 16;
+
+CallbackTimingStatistics::CallbackTimingStatistics()
+{
+    for (auto& b : bins)
+        b = 0;
+
+    for (auto& s : stageSeconds)
+        s = 0;
+
+    for (auto& slot : worstSlots)
+        for (auto& l : slot.stageLoads)
+            l = 0.0f;
+}
+
+void CallbackTimingStatistics::addCallback (double deadlineSeconds, const double (&stages)[numStages],
+                                            double total, double streamTime) noexcept
+{
+    if (deadlineSeconds <= 0)
+        return;
+
+    if (resetPending.exchange (false))
+        for (auto& l : worstLoads)
+            l = 0.0f;
+
+    auto load = (float) (total / deadlineSeconds);
+    auto bin = jlimit (0, numBins - 1, (int) (load * callbackTimingBinsPerDeadline));
+
+    bins[bin].fetch_add (1, std::memory_order_relaxed);
+    numCallbacks.fetch_add (1, std::memory_order_relaxed);
+
+    if (load > 1.0f)
+        numOverruns.fetch_add (1, std::memory_order_relaxed);
+
+    // Nothing else writes these, apart from a reset, so they don't need to be read-modify-write
+    for (int i = 0; i < numStages; ++i)
+        stageSeconds[i].store (stageSeconds[i].load (std::memory_order_relaxed) + stages[i], std::memory_order_relaxed);
+
+    totalSeconds.store (totalSeconds.load (std::memory_order_relaxed) + total, std::memory_order_relaxed);
+
+    // Replaces the least bad of the worst callbacks, if this one's worse
+    auto quietest = (int) (std::min_element (std::begin (worstLoads), std::end (worstLoads)) - std::begin (worstLoads));
+
+    if (load <= worstLoads[quietest])
+        return;
+
+    worstLoads[quietest] = load;
+    auto& slot = worstSlots[quietest];
+
+    // The version is odd whilst the slot's being written, so readers know to try again
+    slot.version.fetch_add (1, std::memory_order_relaxed);
+    std::atomic_thread_fence (std::memory_order_release);
+    slot.timestampMs.store (Time::getMillisecondCounterHiRes(), std::memory_order_relaxed);
+    slot.streamTime.store (streamTime, std::memory_order_relaxed);
+    slot.load.store (load, std::memory_order_relaxed);
+
+    for (int i = 0; i < numStages; ++i)
+        slot.stageLoads[i].store ((float) (stages[i] / deadlineSeconds), std::memory_order_relaxed);
+
+    slot.version.fetch_add (1, std::memory_order_release);
+}
+
+void CallbackTimingStatistics::reset() noexcept
+{
+    for (auto& b : bins)
+        b = 0;
+
+    for (auto& s : stageSeconds)
+        s = 0;
+
+    numCallbacks = 0;
+    numOverruns = 0;
+    totalSeconds = 0;
+
+    // The worst callbacks belong to the thread adding them, so they're hidden from
+    // snapshots here and forgotten by that thread when it next adds one
+    resetTimeMs = Time::getMillisecondCounterHiRes();
+    resetPending = true;
+}
+
+CallbackTimingStatistics::Snapshot CallbackTimingStatistics::getSnapshot() const
+{
+    Snapshot s;
+
+    for (int i = 0; i < numBins; ++i)
+        s.bins[i] = bins[i].load (std::memory_order_relaxed);
+
+    for (int i = 0; i < numStages; ++i)
+        s.stageSeconds[i] = stageSeconds[i].load (std::memory_order_relaxed);
+
+    s.numCallbacks = numCallbacks.load (std::memory_order_relaxed);
+    s.numOverruns = numOverruns.load (std::memory_order_relaxed);
+    s.totalSeconds = totalSeconds.load (std::memory_order_relaxed);
+
+    auto lastReset = resetTimeMs.load();
+
+    for (auto& slot : worstSlots)
+    {
+        CallbackTiming t;
+
+        for (;;)
+        {
+            auto version = slot.version.load (std::memory_order_acquire);
+
+            if ((version & 1) == 0)
+            {
+                t.timestampMs = slot.timestampMs.load (std::memory_order_relaxed);
+                t.streamTime = slot.streamTime.load (std::memory_order_relaxed);
+                t.load = slot.load.load (std::memory_order_relaxed);
+
+                for (int i = 0; i < numStages; ++i)
+                    t.stageLoads[i] = slot.stageLoads[i].load (std::memory_order_relaxed);
+
+                std::atomic_thread_fence (std::memory_order_acquire);
+
+                if (slot.version.load (std::memory_order_relaxed) == version)
+                    break;
+            }
+
+            Thread::yield();
+        }
+
+        if (t.load > 0.0f && t.timestampMs > lastReset)
+            s.worstCallbacks.add (t);
+    }
+
+    std::sort (s.worstCallbacks.begin(), s.worstCallbacks.end(),
+               [] (const CallbackTiming& a, const CallbackTiming& b) { return a.load > b.load; });
+
+    return s;
+}
+
+//==============================================================================
+float CallbackTimingStatistics::Snapshot::getLoadPercentile (double proportionOfCallbacks) const noexcept
+{
+    if (numCallbacks == 0)
+        return 0.0f;
+
+    auto target = (juce::uint64) std::ceil (jlimit (0.0, 1.0, proportionOfCallbacks) * (double) numCallbacks);
+    juce::uint64 count = 0;
+
+    for (int i = 0; i < numBins; ++i)
+    {
+        count += bins[i];
+
+        if (count >= target)
+            return (i + 1) / (float) callbackTimingBinsPerDeadline;
+    }
+
+    return numBins / (float) callbackTimingBinsPerDeadline;
+}
+
+juce::String CallbackTimingStatistics::Snapshot::toString() const
+{
+    static const char* stageNames[] = { "graph", "device", "midi" };
+    static_assert (numElementsInArray (stageNames) == numStages, "Missing a stage name");
+
+    auto percent = [] (double proportion) { return String (proportion * 100.0, 1) + "%"; };
+
+    String s;
+    s << "Callbacks: " << (int64) numCallbacks << ", overruns: " << (int64) numOverruns << newLine
+      << "Load 50%: " << percent (getLoadPercentile (0.5))
+      << ", 99%: " << percent (getLoadPercentile (0.99))
+      << ", 99.9%: " << percent (getLoadPercentile (0.999)) << newLine;
+
+    if (totalSeconds > 0)
+    {
+        s << "Time in";
+
+        for (int i = 0; i < numStages; ++i)
+            s << " " << stageNames[i] << ": " << percent (stageSeconds[i] / totalSeconds);
+
+        s << newLine;
+    }
+
+    s << "Histogram (proportion of deadline: callbacks)" << newLine;
+
+    for (int i = 0; i < numBins; ++i)
+    {
+        if (bins[i] == 0)
+            continue;
+
+        if (i == numBins - 1)
+            s << "  > " << percent ((numBins - 1) / (double) callbackTimingBinsPerDeadline);
+        else
+            s << "  " << percent (i / (double) callbackTimingBinsPerDeadline)
+              << " - " << percent ((i + 1) / (double) callbackTimingBinsPerDeadline);
+
+        s << ": " << (int64) bins[i] << newLine;
+    }
+
+    if (! worstCallbacks.isEmpty())
+    {
+        s << "Worst callbacks" << newLine;
+
+        for (auto& t : worstCallbacks)
+        {
+            s << "  " << percent (t.load) << " at " << String (t.timestampMs, 1) << "ms"
+              << " (stream time " << String (t.streamTime, 3) << "s)";
+
+            for (int i = 0; i < numStages; ++i)
+                s << " " << stageNames[i] << ": " << percent (t.stageLoads[i]);
+
+            s << newLine;
+        }
+    }
+
+    return s;
+}
+
+} // namespace tracktion_engine
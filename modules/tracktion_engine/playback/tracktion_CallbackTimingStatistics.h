@@ -0,0 +1,101 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+/**
+    Collects a histogram of how long each audio callback took compared to its deadline,
+    along with the worst callbacks seen and how their time was split between stages.
+
+    One thread adds the callbacks and any number of others can take snapshots, all
+    without locking, so the stats can be left running to catch intermittent glitches.
+*/
+class CallbackTimingStatistics
+{
+public:
+    //==============================================================================
+    CallbackTimingStatistics();
+
+    /** The parts of a callback that are timed separately. */
+    enum Stage
+    {
+        graphStage = 0,     /**< Rendering the playback graphs. */
+        deviceStage,        /**< Reading the inputs, clearing the outputs and any global output processor. */
+        midiStage,          /**< Dispatching the MIDI timecode and clock to the MIDI devices. */
+        numStages
+    };
+
+    /** Each bin covers 1/16 of the deadline, and the last one holds anything over twice the deadline. */
+    static constexpr int numBins = 33;
+    static constexpr int numWorstCallbacks = 8;
+
+    /** Adds the timings of a callback, in seconds.
+        This must only be called from one thread at a time.
+    */
+    void addCallback (double deadlineSeconds, const double (&stageSeconds)[numStages],
+                      double totalSeconds, double streamTime) noexcept;
+
+    /** Clears everything collected so far. This can be called from any thread. */
+    void reset() noexcept;
+
+    //==============================================================================
+    struct CallbackTiming
+    {
+        double timestampMs = 0;                     /**< When it finished, in Time::getMillisecondCounterHiRes() time. */
+        double streamTime = 0;                      /**< The DeviceManager's stream time at the start of the callback. */
+        float load = 0;                             /**< The time taken as a proportion of the deadline. */
+        float stageLoads[numStages] = {};
+    };
+
+    struct Snapshot
+    {
+        juce::uint64 bins[numBins] = {};
+        juce::uint64 numCallbacks = 0;
+        juce::uint64 numOverruns = 0;               /**< The callbacks that took longer than their deadline. */
+        double stageSeconds[numStages] = {};        /**< The total time spent in each stage. */
+        double totalSeconds = 0;
+
+        /** The slowest callbacks, slowest first. */
+        juce::Array<CallbackTiming> worstCallbacks;
+
+        /** Returns the proportion of the deadline that the given fraction of callbacks finished within. */
+        float getLoadPercentile (double proportionOfCallbacks) const noexcept;
+
+        /** Returns a readable summary, e.g. for logging. */
+        juce::String toString() const;
+    };
+
+    Snapshot getSnapshot() const;
+
+private:
+    //==============================================================================
+    struct WorstSlot
+    {
+        std::atomic<juce::uint32> version { 0 };
+        std::atomic<double> timestampMs { 0 }, streamTime { 0 };
+        std::atomic<float> load { 0 };
+        std::atomic<float> stageLoads[numStages];
+    };
+
+    std::atomic<juce::uint64> bins[numBins];
+    std::atomic<juce::uint64> numCallbacks { 0 }, numOverruns { 0 };
+    std::atomic<double> stageSeconds[numStages], totalSeconds { 0 };
+    WorstSlot worstSlots[numWorstCallbacks];
+    std::atomic<double> resetTimeMs { 0 };
+    std::atomic<bool> resetPending { false };
+
+    // Only used by the thread adding callbacks
+    float worstLoads[numWorstCallbacks] = {};
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CallbackTimingStatistics)
+};
+
+} // namespace tracktion_engine
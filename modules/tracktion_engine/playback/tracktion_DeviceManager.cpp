@@ -171,6 +171,75 @@ private:
 
 
 //==============================================================================
+//==============================================================================
+//==============================================================================
+/** Bypasses the heaviest plugin in any open Edit each time it finds the CPU over the limit. */
+struct DeviceManager::CpuBudgetEnforcer  : private juce::Timer
+{
+    CpuBudgetEnforcer (DeviceManager& dm) : owner (dm)
+    {
+        startTimer (250);
+    }
+
+    void restorePlugins()
+    {
+        for (auto& p : bypassedPlugins)
+        {
+            if (p != nullptr)
+            {
+                p->setBypassedToSaveCpu (false);
+                p->changed();
+            }
+        }
+
+        bypassedPlugins.clear();
+        owner.muteWhenOverloaded = false;
+    }
+
+private:
+    DeviceManager& owner;
+    juce::Array<juce::WeakReference<Plugin>> bypassedPlugins;
+
+    void timerCallback() override
+    {
+        if (owner.currentCpuUsage.load() <= owner.cpuLimitBeforeMuting)
+            return;
+
+        Plugin* heaviest = nullptr;
+        double heaviestUsage = 0.0;
+
+        for (auto edit : owner.engine.getActiveEdits().getEdits())
+        {
+            for (auto p : getAllPlugins (*edit, false))
+            {
+                if (p->isEnabled() && p->canBeDisabled() && ! p->isBypassedToSaveCpu())
+                {
+                    auto usage = p->getCpuUsage();
+
+                    if (usage > heaviestUsage)
+                    {
+                        heaviestUsage = usage;
+                        heaviest = p;
+                    }
+                }
+            }
+        }
+
+        // Nothing left to take out, so fall back to muting
+        owner.muteWhenOverloaded = (heaviest == nullptr);
+
+        if (heaviest != nullptr)
+        {
+            TRACKTION_LOG ("CPU overloaded, bypassing plugin: " + heaviest->getName());
+            heaviest->setBypassedToSaveCpu (true);
+            heaviest->changed();
+            bypassedPlugins.add (heaviest);
+        }
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (CpuBudgetEnforcer)
+};
+
 //==============================================================================
 DeviceManager::DeviceManager (Engine& e) : engine (e)
 {
@@ -383,6 +452,20 @@ void DeviceManager::initialise (int defaultNumInputs, int defaultNumOutputs)
     finishedInitialising = true;
     rebuildWaveDeviceList();
     updateNumCPUs();
+
+    if (engine.getEngineBehaviour().shouldBypassHeaviestPluginsWhenOverloaded())
+    {
+        cpuBudgetEnforcer = std::make_unique<CpuBudgetEnforcer> (*this);
+        muteWhenOverloaded = false;
+    }
+}
+
+void DeviceManager::restorePluginsBypassedToSaveCpu()
+{
+    TRACKTION_ASSERT_MESSAGE_THREAD
+
+    if (cpuBudgetEnforcer != nullptr)
+        cpuBudgetEnforcer->restorePlugins();
 }
 
 void DeviceManager::changeListenerCallback (ChangeBroadcaster*)
@@ -1067,8 +1150,10 @@ void DeviceManager::audioDeviceIOCallback (const float** inputChannelData, int n
        #endif
 
         const auto startTimeTicks = Time::getHighResolutionTicks();
+        const auto callbackStreamTime = streamTime.load();
+        int64 midiTicks = 0, graphTicks = 0;
 
-        if (currentCpuUsage > cpuLimitBeforeMuting)
+        if (currentCpuUsage > cpuLimitBeforeMuting && muteWhenOverloaded)
         {
             for (int i = 0; i < totalNumOutputChannels; ++i)
                 if (auto dest = outputChannelData[i])
@@ -1080,6 +1165,7 @@ void DeviceManager::audioDeviceIOCallback (const float** inputChannelData, int n
         else
         {
             broadcastStreamTimeToMidiDevices (streamTime + outputLatencyTime);
+            midiTicks = Time::getHighResolutionTicks() - startTimeTicks;
             EditTimeRange blockStreamTime;
 
             {
@@ -1100,8 +1186,11 @@ void DeviceManager::audioDeviceIOCallback (const float** inputChannelData, int n
 
                 blockStreamTime = { streamTime, streamTime + blockLength };
 
-                for (auto c : activeContexts)
-                    c->fillNextAudioBlock (blockStreamTime, outputChannelData, numSamples);
+                const auto graphStartTicks = Time::getHighResolutionTicks();
+
+                renderContexts (blockStreamTime, outputChannelData, numSamples);
+
+                graphTicks = Time::getHighResolutionTicks() - graphStartTicks;
             }
 
            #if JUCE_MAC
@@ -1127,7 +1216,16 @@ void DeviceManager::audioDeviceIOCallback (const float** inputChannelData, int n
         {
             const auto timeWindowSec = numSamples / static_cast<float> (currentSampleRate);
 
-            const auto currentCpuUtilisation = float (Time::getHighResolutionTicks() - startTimeTicks) / Time::getHighResolutionTicksPerSecond() / timeWindowSec;
+            const auto totalTicks = Time::getHighResolutionTicks() - startTimeTicks;
+            const auto currentCpuUtilisation = float (totalTicks) / Time::getHighResolutionTicksPerSecond() / timeWindowSec;
+
+            // Anything that isn't the graph or the MIDI is counted as device I/O
+            const double stageSeconds[] = { Time::highResolutionTicksToSeconds (graphTicks),
+                                            Time::highResolutionTicksToSeconds (totalTicks - graphTicks - midiTicks),
+                                            Time::highResolutionTicksToSeconds (midiTicks) };
+
+            callbackTimingStatistics.addCallback (timeWindowSec, stageSeconds,
+                                                  Time::highResolutionTicksToSeconds (totalTicks), callbackStreamTime);
 
             cpuAvg += currentCpuUtilisation;
             cpuMin = jmin (cpuMin, currentCpuUtilisation);
@@ -1152,6 +1250,83 @@ void DeviceManager::audioDeviceIOCallback (const float** inputChannelData, int n
     }
 }
 
+//==============================================================================
+/** Renders several contexts at once on the RealtimeWorkerPool, with the audio thread joining in. */
+struct DeviceManager::ParallelContextRender  : public RealtimeWorkerPool::Operation
+{
+    ParallelContextRender (RealtimeWorkerPool& pool, const void* owner,
+                           const juce::Array<EditPlaybackContext*>& contextsToRender,
+                           EditTimeRange blockStreamTime, int blockNumSamples)
+        : Operation (owner), threadPool (pool), contexts (contextsToRender),
+          streamTime (blockStreamTime), numSamples (blockNumSamples) {}
+
+    int popNextJob() override
+    {
+        const int i = --nextContextToPop;
+        return i >= 0 ? i : -1;
+    }
+
+    void performJob (int contextIndex, juce::AudioBuffer<float>&) override
+    {
+        contexts.getUnchecked (contextIndex)->renderNextAudioBlock (streamTime, numSamples);
+
+        if (--pendingContexts == 0)
+            pendingContextChange.signal();
+    }
+
+    void perform()
+    {
+        pendingContexts = contexts.size();
+        nextContextToPop = contexts.size();
+
+        threadPool.addOperation (*this);
+
+        for (int i = popNextJob(); i >= 0; i = popNextJob())
+        {
+            juce::AudioBuffer<float> unused;
+            performJob (i, unused);
+        }
+
+        pendingContextChange.wait();
+
+        threadPool.removeOperation (*this);
+    }
+
+private:
+    RealtimeWorkerPool& threadPool;
+    const juce::Array<EditPlaybackContext*>& contexts;
+    const EditTimeRange streamTime;
+    const int numSamples;
+    Atomic<int> nextContextToPop, pendingContexts;
+    WaitableEvent pendingContextChange;
+
+    JUCE_DECLARE_NON_COPYABLE (ParallelContextRender)
+};
+
+void DeviceManager::renderContexts (EditTimeRange blockStreamTime, float** outputChannelData, int numSamples)
+{
+    contextsToRender.clearQuick();
+
+    // Anything that a context might read from another, like its playhead when they're
+    // synced, is updated here one context at a time
+    for (auto c : activeContexts)
+        if (c->startNextAudioBlock (blockStreamTime, numSamples))
+            contextsToRender.add (c);
+
+    auto& pool = engine.getRealtimeWorkerPool();
+
+    // The contexts are separate graphs so they can be rendered at once, each mixing into
+    // its own buffers, and then added to the device's channels in order
+    if (contextsToRender.size() > 1 && pool.getNumThreads() > 0)
+        ParallelContextRender (pool, this, contextsToRender, blockStreamTime, numSamples).perform();
+    else
+        for (auto c : contextsToRender)
+            c->renderNextAudioBlock (blockStreamTime, numSamples);
+
+    for (auto c : contextsToRender)
+        c->addNextAudioBlockToOutputs (blockStreamTime, outputChannelData, numSamples);
+}
+
 void DeviceManager::audioDeviceAboutToStart (AudioIODevice* device)
 {
     FloatVectorOperations::disableDenormalisedNumberSupport();
@@ -1159,6 +1334,7 @@ void DeviceManager::audioDeviceAboutToStart (AudioIODevice* device)
 
     streamTime = 0;
     currentCpuUsage = 0.0f;
+    callbackTimingStatistics.reset();
     currentSampleRate = device->getCurrentSampleRate();
     currentLatencyMs  = device->getCurrentBufferSizeSamples() * 1000.0f / currentSampleRate;
     outputLatencyTime = device->getOutputLatencyInSamples() / currentSampleRate;
@@ -1178,6 +1354,10 @@ void DeviceManager::audioDeviceAboutToStart (AudioIODevice* device)
         c->playhead.setPosition (c->transport.getCurrentPosition());
     }
 
+    AudioScratchBuffer::prepare (std::max (device->getActiveInputChannels().countNumberOfSetBits(),
+                                           device->getActiveOutputChannels().countNumberOfSetBits()),
+                                 device->getCurrentBufferSizeSamples());
+
     if (globalOutputAudioProcessor != nullptr)
         globalOutputAudioProcessor->prepareToPlay (currentSampleRate, device->getCurrentBufferSizeSamples());
 
@@ -1200,10 +1380,38 @@ void DeviceManager::audioDeviceStopped()
         globalOutputAudioProcessor->releaseResources();
 }
 
+String DeviceManager::getCallbackTimingReport (int maxNumPluginsToList)
+{
+    TRACKTION_ASSERT_MESSAGE_THREAD
+
+    auto report = callbackTimingStatistics.getSnapshot().toString();
+
+    Array<Plugin*> plugins;
+
+    for (auto edit : engine.getActiveEdits().getEdits())
+        for (auto p : getAllPlugins (*edit, false))
+            if (p->isEnabled() && p->getCpuUsage() > 0.0)
+                plugins.add (p);
+
+    std::sort (plugins.begin(), plugins.end(),
+               [] (Plugin* a, Plugin* b) { return a->getCpuUsage() > b->getCpuUsage(); });
+
+    if (! plugins.isEmpty())
+    {
+        report << "Heaviest plugins (proportion of a block)" << newLine;
+
+        for (int i = 0; i < jmin (maxNumPluginsToList, plugins.size()); ++i)
+            report << "  " << plugins.getUnchecked (i)->getName() << ": "
+                   << String (plugins.getUnchecked (i)->getCpuUsage() * 100.0, 1) << "%" << newLine;
+    }
+
+    return report;
+}
+
 void DeviceManager::updateNumCPUs()
 {
     const ScopedLock sl (deviceManager.getAudioCallbackLock());
-    MixerAudioNode::updateNumCPUs (engine);
+    engine.getRealtimeWorkerPool().setNumThreads (engine.getEngineBehaviour().getNumberOfCPUsToUseForAudio() - 1);
 }
 
 void DeviceManager::addContext (EditPlaybackContext* c)
@@ -1216,6 +1424,7 @@ void DeviceManager::addContext (EditPlaybackContext* c)
         const ScopedLock sl (contextLock);
         lastStreamTime = streamTime;
         activeContexts.addIfNotAlreadyThere (c);
+        contextsToRender.ensureStorageAllocated (activeContexts.size());
     }
 
     for (int i = 200; --i >= 0;)
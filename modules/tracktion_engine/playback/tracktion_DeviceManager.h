@@ -52,6 +52,12 @@ public:
     // Sets an upper limit on the proportion of CPU time being used - if getCpuUsage() exceeds this,
     // the processing will be muted to keep the system running. Defaults to 0.95
     void setCpuLimitBeforeMuting (double newLimit)      { jassert (newLimit > 0); cpuLimitBeforeMuting = newLimit; }
+    double getCpuLimitBeforeMuting() const noexcept     { return cpuLimitBeforeMuting; }
+
+    /** Brings back any plugins that were bypassed to get under the CPU limit.
+        @see EngineBehaviour::shouldBypassHeaviestPluginsWhenOverloaded
+    */
+    void restorePluginsBypassedToSaveCpu();
 
     void updateNumCPUs(); // should be called when active num CPUs is changed
 
@@ -68,6 +74,16 @@ public:
     void addCPUUsageListener (CPUUsageListener* listener)       { cpuUsageListeners.add (listener); }
     void removeCPUUsageListener (CPUUsageListener* listener)    { cpuUsageListeners.remove (listener); }
 
+    /** Returns the timings of every audio callback since the device started or the stats were reset.
+        These are collected all the time, and can be used to track down the occasional glitch.
+    */
+    CallbackTimingStatistics& getCallbackTimingStatistics() noexcept    { return callbackTimingStatistics; }
+
+    /** Returns a summary of the callback timings, followed by the plugins using the most CPU
+        in the open Edits, so the two can be compared. This must be called on the message thread.
+    */
+    juce::String getCallbackTimingReport (int maxNumPluginsToList = 10);
+
     //==============================================================================
     double getSampleRate() const;
     int getBitDepth() const;
@@ -192,6 +208,10 @@ private:
 
     std::atomic<double> currentCpuUsage { 0 }, streamTime { 0 };
     double cpuLimitBeforeMuting = 0.95;
+    std::atomic<bool> muteWhenOverloaded { true };
+
+    struct CpuBudgetEnforcer;
+    std::unique_ptr<CpuBudgetEnforcer> cpuBudgetEnforcer;
     double currentLatencyMs = 0, outputLatencyTime = 0, currentSampleRate = 0;
     double speedCompensation = 0;
     int internalBufferMultiplier = 1;
@@ -207,7 +227,7 @@ private:
     std::unique_ptr<ContextDeviceClearer> contextDeviceClearer;
 
     juce::CriticalSection contextLock;
-    juce::Array<EditPlaybackContext*> activeContexts;
+    juce::Array<EditPlaybackContext*> activeContexts, contextsToRender;
     std::unique_ptr<juce::AudioProcessor> globalOutputAudioProcessor;
 
    #if JUCE_ANDROID
@@ -215,6 +235,7 @@ private:
    #endif
 
     juce::ListenerList<CPUUsageListener> cpuUsageListeners;
+    CallbackTimingStatistics callbackTimingStatistics;
 
     void initialiseMidi();
     void rebuildWaveDeviceList();
@@ -230,6 +251,9 @@ private:
     void audioDeviceAboutToStart (juce::AudioIODevice*) override;
     void audioDeviceStopped() override;
 
+    struct ParallelContextRender;
+    void renderContexts (EditTimeRange streamTime, float** outputChannelData, int numSamples);
+
     //==============================================================================
     int cpuReportingInterval = 1;
     int cpuAvgCounter = 0;
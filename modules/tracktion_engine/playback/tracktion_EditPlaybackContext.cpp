@@ -13,6 +13,74 @@ namespace tracktion_engine
 
 std::function<AudioNode*(AudioNode*)> EditPlaybackContext::insertOptionalLastStageNode = [] (AudioNode* input)    { return input; };
 
+#if ENABLE_EXPERIMENTAL_TRACKTION_GRAPH
+//==============================================================================
+/** Processes the Nodes for all the wave output devices in a single graph.
+    The devices are given GraphInputAudioNodes which read the output of their Node.
+*/
+struct EditPlaybackContext::PlaybackGraph
+{
+    PlaybackGraph (std::unique_ptr<tracktion_graph::Node> rootNode,
+                   std::shared_ptr<InputProvider> inputProviderToUse,
+                   Array<AudioNode*> wrappedAudioNodes)
+        : player (std::move (rootNode)),
+          inputProvider (std::move (inputProviderToUse)),
+          audioNodes (std::move (wrappedAudioNodes))
+    {
+    }
+
+    void prepareToPlay (double sampleRateToUse, int blockSize, int maxNumThreads, bool numaAware)
+    {
+        sampleRate = sampleRateToUse;
+        player.setMaxNumThreads ((size_t) jmax (1, maxNumThreads));
+        player.setNumaAware (numaAware);
+        player.prepareToPlay (sampleRate, blockSize);
+        midi.reserve (MidiMessageArray::defaultNumMessagesToReserve);
+    }
+
+    void process (PlayHead& playhead, EditTimeRange streamTime, int numSamples)
+    {
+        AudioRenderContext rc (playhead, streamTime,
+                               nullptr, juce::AudioChannelSet(), 0, numSamples,
+                               nullptr, 0.0,
+                               AudioRenderContext::contiguous, false);
+
+        // This has to happen for all the AudioNodes before any of them are rendered
+        for (auto node : audioNodes)
+            node->prepareForNextBlock (rc);
+
+        const auto startSample = (int64_t) llround (streamTime.getStart() * sampleRate);
+        const juce::Range<int64_t> streamSampleRange (startSample, startSample + numSamples);
+
+        inputProvider->setContext (&rc);
+        inputProvider->setStreamSampleRange (streamSampleRange);
+
+        // The root Node has no channels, the devices read the outputs of their own Nodes
+        float* noChannels[1] = {};
+        midi.clear();
+        player.process ({ streamSampleRange, { juce::dsp::AudioBlock<float> (noChannels, 0, (size_t) numSamples), midi } });
+
+        inputProvider->setContext (nullptr);
+    }
+
+    tracktion_graph::MultiThreadedNodePlayer player;
+    std::shared_ptr<InputProvider> inputProvider;
+    Array<AudioNode*> audioNodes;
+
+    // The trees for the top level tracks, these can be reused when only other tracks change.
+    // Submix buses are made of several Nodes so aren't kept, they're always rebuilt
+    std::map<EditItemID, std::shared_ptr<AudioNode>> trackAudioNodes;
+
+    // Any trees taken from the previous graph, these have already been prepared
+    Array<AudioNode*> reusedAudioNodes;
+
+    // The aux buses whose sends are all processed before their returns
+    juce::BigInteger auxBusesInGraphOrder;
+    MidiMessageArray midi;
+    double sampleRate = 44100.0;
+};
+#endif
+
 //==============================================================================
 EditPlaybackContext::ScopedDeviceListReleaser::ScopedDeviceListReleaser (EditPlaybackContext& e, bool reallocate)
     : owner (e), shouldReallocate (reallocate)
@@ -172,6 +240,15 @@ void EditPlaybackContext::clearNodes()
     for (auto wo : waveOutputs)
         removedNodes.add (wo->replaceAudioNode (nullptr));
 
+   #if ENABLE_EXPERIMENTAL_TRACKTION_GRAPH
+    std::unique_ptr<PlaybackGraph> removedGraph;
+
+    {
+        ScopedLock sl (edit.engine.getDeviceManager().deviceManager.getAudioCallbackLock());
+        removedGraph = std::move (playbackGraph);
+    }
+   #endif
+
     removedNodes.clear();
     isAllocated = false;
 }
@@ -195,7 +272,8 @@ static AudioNode* prepareNode (AudioNode* node, bool forMidi)
     return node;
 }
 
-static void prepareNodesToPlay (Engine& engine, const Array<AudioNode*>& allNodes, double startTime, PlayHead& playhead)
+static void prepareNodesToPlay (Engine& engine, const Array<AudioNode*>& allNodes, double startTime, PlayHead& playhead,
+                                const Array<AudioNode*>& alreadyPreparedNodes = {})
 {
     Array<AudioNode*> nonNullNodes (allNodes);
     nonNullNodes.removeAllInstancesOf (nullptr);
@@ -214,25 +292,35 @@ static void prepareNodesToPlay (Engine& engine, const Array<AudioNode*>& allNode
     CRASH_TRACER
 
     for (auto n : allNodes)
-        if (n != nullptr)
+        if (n != nullptr && ! alreadyPreparedNodes.contains (n))
             n->prepareAudioNodeToPlay (info);
 }
 
-static AudioNode* createPlaybackAudioNode (Edit& edit, OutputDeviceInstance& deviceInstance,
-                                           std::function<AudioNode*(AudioNode*)> insertOptionalLastStageNode,
-                                           bool addAntiDenormalisationNoise)
+/** One of the inputs to an output device.
+    The trackID is set if this is the node for a top level track, in which case the node
+    can be nullptr if it wasn't asked for.
+*/
+struct OutputDeviceInput
+{
+    AudioNode* node = nullptr;
+    EditItemID trackID;
+};
+
+/** Creates the nodes for the tracks, frozen tracks and insert sends that feed an output device.
+    If shouldCreateTrackNode is set, the top level tracks it returns false for are added without a node.
+*/
+static std::vector<OutputDeviceInput> createInputAudioNodes (Edit& edit, OutputDeviceInstance& deviceInstance,
+                                                             bool addAntiDenormalisationNoise, bool& deviceIsBeingUsedAsInsert,
+                                                             AudioNode* audioNodeToBeReplaced,
+                                                             std::function<bool (Track&)> shouldCreateTrackNode = {})
 {
     CRASH_TRACER
     OutputDevice& device = deviceInstance.owner;
-    auto& engine = edit.engine;
-    MixerAudioNode* mixer = nullptr;
+    std::vector<OutputDeviceInput> inputs;
     bool addedFrozenTracksYet = false;
 
-    const bool shouldUse64Bit = engine.getPropertyStorage().getProperty (SettingID::use64Bit, false);
-    const bool shouldUseMultiCPU = (engine.getEngineBehaviour().getNumberOfCPUsToUseForAudio() > 1);
-
     CreateAudioNodeParams cnp;
-    cnp.audioNodeToBeReplaced = deviceInstance.getAudioNode();
+    cnp.audioNodeToBeReplaced = audioNodeToBeReplaced;
     cnp.forRendering = false;
     cnp.includePlugins = true;
     cnp.addAntiDenormalisationNoise = addAntiDenormalisationNoise;
@@ -274,21 +362,19 @@ static AudioNode* createPlaybackAudioNode (Edit& edit, OutputDeviceInstance& dev
                                 node = new TrackMutingAudioNode (edit, node);
                                 node = new PlayHeadAudioNode (node);
 
-                                if (mixer == nullptr)
-                                    mixer = new MixerAudioNode (shouldUse64Bit, shouldUseMultiCPU);
-
-                                mixer->addInput (node);
+                                inputs.push_back ({ node, {} });
                             }
                         }
                     }
                 }
             }
+            else if (shouldCreateTrackNode && ! shouldCreateTrackNode (*t))
+            {
+                inputs.push_back ({ nullptr, t->itemID });
+            }
             else
             {
-                if (mixer == nullptr)
-                    mixer = new MixerAudioNode (shouldUse64Bit, shouldUseMultiCPU);
-
-                mixer->addInput (t->createAudioNode (cnp));
+                inputs.push_back ({ t->createAudioNode (cnp), t->itemID });
             }
         }
     }
@@ -299,18 +385,15 @@ static AudioNode* createPlaybackAudioNode (Edit& edit, OutputDeviceInstance& dev
         if (t->isSubmixFolder() && (! t->isPartOfSubmix())
             && t->getOutput() != nullptr && &device == t->getOutput()->getOutputDevice (false))
         {
-            if (auto n = t->createAudioNode (cnp))
-            {
-                if (mixer == nullptr)
-                    mixer = new MixerAudioNode (shouldUse64Bit, shouldUseMultiCPU);
-
-                mixer->addInput (n);
-            }
+            if (shouldCreateTrackNode && ! shouldCreateTrackNode (*t))
+                inputs.push_back ({ nullptr, t->itemID });
+            else if (auto n = t->createAudioNode (cnp))
+                inputs.push_back ({ n, t->itemID });
         }
     }
 
     // Create nodes for any insert plugins
-    bool deviceIsBeingUsedAsInsert = false;
+    deviceIsBeingUsedAsInsert = false;
 
     for (auto p : getAllPlugins (edit, false))
     {
@@ -321,49 +404,86 @@ static AudioNode* createPlaybackAudioNode (Edit& edit, OutputDeviceInstance& dev
 
             if (auto sendNode = ins->createSendAudioNode (device))
             {
-                if (mixer == nullptr)
-                    mixer = new MixerAudioNode (shouldUse64Bit, shouldUseMultiCPU);
-
-                mixer->addInput (sendNode);
+                inputs.push_back ({ sendNode, {} });
                 deviceIsBeingUsedAsInsert = true;
             }
         }
     }
 
-    AudioNode* finalNode = mixer;
+    return inputs;
+}
+
+/** Adds the master plugins, fades and metering that are applied to the mix of an output device's inputs. */
+static AudioNode* createOutputStageAudioNode (Edit& edit, OutputDevice& device, AudioNode* finalNode,
+                                              std::function<AudioNode*(AudioNode*)> insertOptionalLastStageNode,
+                                              bool addAntiDenormalisationNoise)
+{
+    CRASH_TRACER
 
     // add any master plugins..
-    if (! deviceIsBeingUsedAsInsert && finalNode != nullptr)
+    if (edit.engine.getDeviceManager().getDefaultWaveOutDevice() == &device)
     {
-        CRASH_TRACER
+        finalNode = edit.getMasterPluginList().createAudioNode (finalNode, addAntiDenormalisationNoise);
+        finalNode = edit.getMasterVolumePlugin()->createAudioNode (finalNode, false);
+    }
 
-        // add any master plugins..
-        if (engine.getDeviceManager().getDefaultWaveOutDevice() == &device)
-        {
-            finalNode = edit.getMasterPluginList().createAudioNode (finalNode, addAntiDenormalisationNoise);
-            finalNode = edit.getMasterVolumePlugin()->createAudioNode (finalNode, false);
-        }
+    finalNode = insertOptionalLastStageNode (finalNode);
+
+    if (finalNode != nullptr)
+        finalNode = FadeInOutAudioNode::createForEdit (edit, finalNode);
+
+    if (edit.getIsPreviewEdit() && finalNode != nullptr)
+        finalNode = new LevelMeasuringAudioNode (edit.getPreviewLevelMeasurer(), finalNode);
+
+    return finalNode;
+}
+
+static AudioNode* createClickAudioNode (Edit& edit, OutputDevice& device)
+{
+    CRASH_TRACER
+    return new ClickMutingNode (new ClickNode (device.isMidi(), edit, Edit::maximumLength), edit);
+}
 
-        finalNode = insertOptionalLastStageNode (finalNode);
+static AudioNode* createPlaybackAudioNode (Edit& edit, OutputDeviceInstance& deviceInstance,
+                                           std::function<AudioNode*(AudioNode*)> insertOptionalLastStageNode,
+                                           bool addAntiDenormalisationNoise)
+{
+    CRASH_TRACER
+    OutputDevice& device = deviceInstance.owner;
+    auto& engine = edit.engine;
+    MixerAudioNode* mixer = nullptr;
+
+    const bool shouldUse64Bit = engine.getPropertyStorage().getProperty (SettingID::use64Bit, false);
+    const bool shouldUseMultiCPU = (engine.getEngineBehaviour().getNumberOfCPUsToUseForAudio() > 1);
 
-        if (finalNode != nullptr)
-            finalNode = FadeInOutAudioNode::createForEdit (edit, finalNode);
+    bool deviceIsBeingUsedAsInsert = false;
+
+    for (auto& input : createInputAudioNodes (edit, deviceInstance, addAntiDenormalisationNoise,
+                                              deviceIsBeingUsedAsInsert, deviceInstance.getAudioNode()))
+    {
+        if (mixer == nullptr)
+            mixer = new MixerAudioNode (edit, shouldUse64Bit, shouldUseMultiCPU);
 
-        if (edit.getIsPreviewEdit() && finalNode != nullptr)
-            finalNode = new LevelMeasuringAudioNode (edit.getPreviewLevelMeasurer(), finalNode);
+        mixer->addInput (input.node);
     }
 
+    AudioNode* finalNode = mixer;
+
+    // add any master plugins..
+    if (! deviceIsBeingUsedAsInsert && finalNode != nullptr)
+        finalNode = createOutputStageAudioNode (edit, device, finalNode, insertOptionalLastStageNode, addAntiDenormalisationNoise);
+
     if (edit.isClickTrackDevice (device))
     {
         CRASH_TRACER
 
-        auto clickNode = new ClickMutingNode (new ClickNode (device.isMidi(), edit, Edit::maximumLength), edit);
+        auto clickNode = createClickAudioNode (edit, device);
 
         auto finalMixer = dynamic_cast<MixerAudioNode*> (finalNode);
 
         if (finalMixer == nullptr)
         {
-            finalMixer = new MixerAudioNode (false, shouldUseMultiCPU);
+            finalMixer = new MixerAudioNode (edit, false, shouldUseMultiCPU);
 
             finalMixer->addInput (clickNode);
             finalMixer->addInput (finalNode);
@@ -379,23 +499,535 @@ static AudioNode* createPlaybackAudioNode (Edit& edit, OutputDeviceInstance& dev
     return finalNode;
 }
 
-void EditPlaybackContext::createAudioNodes (double startTime, bool addAntiDenormalisationNoise)
+#if ENABLE_EXPERIMENTAL_TRACKTION_GRAPH
+/** Returns the AudioNodeWrapperNodes in a graph, inputs first so the given Node's own is last. */
+static std::vector<AudioNodeWrapperNode*> getWrapperNodes (tracktion_graph::Node& node)
+{
+    std::vector<AudioNodeWrapperNode*> wrappers;
+
+    for (auto n : tracktion_graph::getNodes (node, tracktion_graph::VertexOrdering::postordering))
+        if (auto wrapper = dynamic_cast<AudioNodeWrapperNode*> (n))
+            wrappers.push_back (wrapper);
+
+    return wrappers;
+}
+
+static Array<AudioNode*> getWrappedAudioNodes (tracktion_graph::Node& node)
+{
+    Array<AudioNode*> audioNodes;
+
+    for (auto wrapper : getWrapperNodes (node))
+        audioNodes.add (&wrapper->getAudioNode());
+
+    return audioNodes;
+}
+
+static FolderTrack* getSubmixFolder (Track& track)
+{
+    if (auto ft = dynamic_cast<FolderTrack*> (&track))
+        if (ft->isSubmixFolder())
+            return ft;
+
+    return nullptr;
+}
+
+/** Builds a submix folder as a bus in the graph, rather than nesting its inputs' trees in its own.
+    Each of its input tracks and sub-folders gets its own Nodes, so the tracks at every level of
+    nesting can be processed concurrently, and the folder's plugins are processed as soon as the
+    last of its inputs has finished.
+*/
+template<typename WrapFunction, typename SumFunction>
+static std::unique_ptr<tracktion_graph::Node> createSubmixBusNode (FolderTrack& folder, const CreateAudioNodeParams& params,
+                                                                  bool use64Bit, WrapFunction& wrapAudioNode, SumFunction& sumNodes)
+{
+    CRASH_TRACER
+    std::vector<std::unique_ptr<tracktion_graph::Node>> inputNodes;
+
+    for (auto t : folder.getSubmixInputTracks (params))
+    {
+        if (auto ft = dynamic_cast<FolderTrack*> (t))
+        {
+            if (auto busNode = createSubmixBusNode (*ft, params, use64Bit, wrapAudioNode, sumNodes))
+                inputNodes.push_back (std::move (busNode));
+        }
+        else if (auto at = dynamic_cast<AudioTrack*> (t))
+        {
+            if (auto trackNode = at->createAudioNode (params))
+                inputNodes.push_back (wrapAudioNode (std::shared_ptr<AudioNode> (trackNode), {}));
+        }
+    }
+
+    if (inputNodes.empty())
+        return {};
+
+    // As with the nested submixes, there's no point using 64 bit unless there's a lot of tracks to sum up
+    const bool sumIn64Bit = use64Bit && inputNodes.size() > 1;
+    auto mixNode = sumNodes (std::move (inputNodes), sumIn64Bit);
+
+    auto props = mixNode->getNodeProperties();
+    auto mixInput = new GraphInputAudioNode (*mixNode, props.numberOfChannels, props.hasMidi);
+
+    return wrapAudioNode (std::shared_ptr<AudioNode> (folder.createSubmixOutputAudioNode (mixInput, params)),
+                          std::move (mixNode));
+}
+
+/** Returns the top level track whose nodes include those of the given track.
+    This follows submixes and tracks whose output is another track.
+*/
+static Track* getTrackContainingNodes (Track& track)
+{
+    auto t = &track;
+
+    // Limits the search in case the outputs go round in a loop
+    for (int i = 0; i < 128; ++i)
+    {
+        if (t->isPartOfSubmix())
+        {
+            if (auto parent = t->getParentFolderTrack())
+            {
+                t = parent;
+                continue;
+            }
+        }
+
+        AudioTrack* dest = nullptr;
+
+        if (auto at = dynamic_cast<AudioTrack*> (t))
+            dest = at->getOutput().getDestinationTrack();
+        else if (auto ft = dynamic_cast<FolderTrack*> (t))
+            if (auto output = ft->getOutput())
+                dest = output->getDestinationTrack();
+
+        if (dest == nullptr)
+            return t;
+
+        t = dest;
+    }
+
+    return nullptr;
+}
+
+/** Returns true if any of the nodes in a tree are referred to by, or refer to, nodes in
+    other tracks' trees, which means the tree can't be replaced on its own.
+*/
+static bool hasConnectionsToOtherTracks (AudioNode& node)
+{
+    bool hasConnections = false;
+
+    node.visitNodes ([&hasConnections] (AudioNode& n)
+                     {
+                         if (dynamic_cast<SidechainSendAudioNode*> (&n) != nullptr
+                              || dynamic_cast<SidechainReceiveAudioNode*> (&n) != nullptr
+                              || dynamic_cast<AuxReturnPlugin*> (n.getPlugin().get()) != nullptr)
+                             hasConnections = true;
+                     });
+
+    return hasConnections;
+}
+
+/** The top level tracks containing the sends and returns for an aux bus. */
+struct AuxBusTrees
+{
+    std::vector<EditItemID> sendTrees, returnTrees;
+    bool canBeProcessedInOrder = true;
+};
+
+/** Finds the trees that each aux bus's sends and returns are in, and works out which buses can
+    have their sends processed before their returns. This needs all a bus's sends and returns to be
+    in different trees, and the extra connections mustn't make a loop with those of the other buses.
+    The connections that were made are added to the map that's passed in.
+*/
+static std::map<int, AuxBusTrees> findAuxBusTrees (const Edit& edit, std::map<EditItemID, std::vector<EditItemID>>& connections)
+{
+    std::map<int, AuxBusTrees> buses;
+
+    for (auto p : getAllPlugins (edit, false))
+    {
+        auto send = dynamic_cast<AuxSendPlugin*> (p);
+        auto ret  = dynamic_cast<AuxReturnPlugin*> (p);
+
+        if (send == nullptr && ret == nullptr)
+            continue;
+
+        auto& bus = buses[send != nullptr ? send->getBusNumber() : ret->busNumber.get()];
+        auto track = p->getOwnerTrack();
+        auto tree = track != nullptr ? getTrackContainingNodes (*track) : nullptr;
+
+        if (tree == nullptr)
+        {
+            bus.canBeProcessedInOrder = false;
+            continue;
+        }
+
+        auto& trees = send != nullptr ? bus.sendTrees : bus.returnTrees;
+
+        if (std::find (trees.begin(), trees.end(), tree->itemID) == trees.end())
+            trees.push_back (tree->itemID);
+    }
+
+    // The connections go from the send trees to the return trees, so a send and return for
+    // the same bus in one tree makes a loop too
+    for (auto& b : buses)
+    {
+        auto& bus = b.second;
+
+        if (! bus.canBeProcessedInOrder)
+            continue;
+
+        auto newConnections = connections;
+
+        for (auto s : bus.sendTrees)
+            for (auto r : bus.returnTrees)
+                newConnections[s].push_back (r);
+
+        if (hasLoop (newConnections))
+            bus.canBeProcessedInOrder = false;
+        else
+            connections = std::move (newConnections);
+    }
+
+    return buses;
+}
+
+std::unique_ptr<EditPlaybackContext::PlaybackGraph> EditPlaybackContext::createPlaybackGraph (Array<AudioNode*>& deviceNodes,
+                                                                                              bool addAntiDenormalisationNoise,
+                                                                                              const Array<EditItemID>* tracksToRebuild)
+{
+    CRASH_TRACER
+    const bool shouldUse64Bit = edit.engine.getPropertyStorage().getProperty (SettingID::use64Bit, false);
+
+    auto inputProvider = std::make_shared<InputProvider>();
+    std::vector<std::unique_ptr<tracktion_graph::Node>> outputNodes;
+
+    // When only some tracks are being rebuilt, the others keep the trees from the current graph
+    auto graphToReuse = tracksToRebuild != nullptr ? playbackGraph.get() : nullptr;
+    std::map<EditItemID, std::shared_ptr<AudioNode>> trackAudioNodes;
+    Array<AudioNode*> reusedAudioNodes;
+
+    auto findReusableTrackNode = [graphToReuse, tracksToRebuild] (EditItemID trackID) -> std::shared_ptr<AudioNode>
+    {
+        if (graphToReuse == nullptr || tracksToRebuild->contains (trackID))
+            return {};
+
+        auto found = graphToReuse->trackAudioNodes.find (trackID);
+        return found != graphToReuse->trackAudioNodes.end() ? found->second : nullptr;
+    };
+
+    // The sends' latency depends on this, so the reused trees would be out of date if it changed
+    std::map<EditItemID, std::vector<EditItemID>> treeConnections;
+    auto auxBusTrees = findAuxBusTrees (edit, treeConnections);
+    juce::BigInteger auxBusesInGraphOrder;
+
+    for (auto& bus : auxBusTrees)
+        if (bus.second.canBeProcessedInOrder)
+            auxBusesInGraphOrder.setBit (bus.first);
+
+    if (graphToReuse != nullptr && auxBusesInGraphOrder != graphToReuse->auxBusesInGraphOrder)
+        return {};
+
+    AuxSendPlugin::setBusesProcessedInGraphOrder (edit, auxBusesInGraphOrder);
+
+    // The wrappers and AudioNodes in each top level tree. Submix buses have several of each,
+    // with the wrapper for the bus's output last
+    std::map<EditItemID, std::vector<AudioNodeWrapperNode*>> trackNodes;
+    std::map<EditItemID, Array<AudioNode*>> treeAudioNodes;
+
+    auto wrapAudioNode = [&inputProvider] (std::shared_ptr<AudioNode> audioNode, std::unique_ptr<tracktion_graph::Node> input)
+    {
+        return std::unique_ptr<tracktion_graph::Node> (new AudioNodeWrapperNode (std::move (audioNode),
+                                                                                 inputProvider, std::move (input)));
+    };
+
+    auto sumNodes = [] (std::vector<std::unique_ptr<tracktion_graph::Node>> nodes, bool useDoublePrecision)
+    {
+        auto summingNode = std::make_unique<tracktion_graph::SummingNode> (std::move (nodes));
+        summingNode->setDoubleProcessingPrecision (useDoublePrecision);
+        return std::unique_ptr<tracktion_graph::Node> (std::move (summingNode));
+    };
+
+    for (auto wo : waveOutputs)
+    {
+        auto& device = wo->owner;
+        bool deviceIsBeingUsedAsInsert = false;
+
+        // Each of the inputs is wrapped separately so they can be processed concurrently
+        std::vector<std::unique_ptr<tracktion_graph::Node>> inputNodes;
+
+        CreateAudioNodeParams submixParams;
+        submixParams.audioNodeToBeReplaced = wo->getAudioNode();
+        submixParams.includePlugins = true;
+        submixParams.addAntiDenormalisationNoise = addAntiDenormalisationNoise;
+
+        // Submix folders are left for createSubmixBusNode to build
+        auto shouldCreateTrackNode = [&] (Track& t)
+        {
+            return getSubmixFolder (t) == nullptr && findReusableTrackNode (t.itemID) == nullptr;
+        };
+
+        for (auto& input : createInputAudioNodes (edit, *wo, addAntiDenormalisationNoise,
+                                                  deviceIsBeingUsedAsInsert, wo->getAudioNode(), shouldCreateTrackNode))
+        {
+            std::shared_ptr<AudioNode> audioNode (input.node);
+            std::unique_ptr<tracktion_graph::Node> inputNode;
+
+            if (audioNode == nullptr && input.trackID.isValid())
+            {
+                auto track = findTrackForID (edit, input.trackID);
+
+                if (auto folder = track != nullptr ? getSubmixFolder (*track) : nullptr)
+                {
+                    inputNode = createSubmixBusNode (*folder, submixParams, shouldUse64Bit, wrapAudioNode, sumNodes);
+                }
+                else
+                {
+                    audioNode = findReusableTrackNode (input.trackID);
+
+                    if (audioNode != nullptr)
+                        reusedAudioNodes.add (audioNode.get());
+                }
+            }
+
+            if (inputNode == nullptr)
+            {
+                if (audioNode == nullptr)
+                    continue;
+
+                if (input.trackID.isValid())
+                    trackAudioNodes[input.trackID] = audioNode;
+
+                inputNode = wrapAudioNode (std::move (audioNode), {});
+            }
+
+            if (input.trackID.isValid())
+            {
+                trackNodes[input.trackID] = getWrapperNodes (*inputNode);
+                treeAudioNodes[input.trackID] = getWrappedAudioNodes (*inputNode);
+            }
+
+            inputNodes.push_back (std::move (inputNode));
+        }
+
+        std::unique_ptr<tracktion_graph::Node> deviceNode;
+
+        if (! inputNodes.empty())
+        {
+            deviceNode = sumNodes (std::move (inputNodes), shouldUse64Bit);
+
+            if (! deviceIsBeingUsedAsInsert)
+            {
+                auto props = deviceNode->getNodeProperties();
+                auto mixInput = new GraphInputAudioNode (*deviceNode, props.numberOfChannels, props.hasMidi);
+
+                if (auto outputStage = createOutputStageAudioNode (edit, device, mixInput, insertOptionalLastStageNode,
+                                                                   addAntiDenormalisationNoise))
+                    deviceNode = wrapAudioNode (std::shared_ptr<AudioNode> (outputStage), std::move (deviceNode));
+                else
+                    deviceNode = nullptr;
+            }
+        }
+
+        if (edit.isClickTrackDevice (device))
+        {
+            auto clickNode = wrapAudioNode (std::shared_ptr<AudioNode> (createClickAudioNode (edit, device)), {});
+
+            if (deviceNode == nullptr)
+            {
+                deviceNode = std::move (clickNode);
+            }
+            else
+            {
+                std::vector<std::unique_ptr<tracktion_graph::Node>> nodes;
+                nodes.push_back (std::move (deviceNode));
+                nodes.push_back (std::move (clickNode));
+                deviceNode = sumNodes (std::move (nodes), false);
+            }
+        }
+
+        if (deviceNode != nullptr)
+        {
+            auto props = deviceNode->getNodeProperties();
+            deviceNodes.add (new GraphInputAudioNode (*deviceNode, props.numberOfChannels, props.hasMidi,
+                                                      getWrappedAudioNodes (*deviceNode)));
+            outputNodes.push_back (std::move (deviceNode));
+        }
+        else
+        {
+            deviceNodes.add (nullptr);
+        }
+    }
+
+    // Make the trees with aux returns wait for the ones sending to them
+    for (auto& bus : auxBusTrees)
+    {
+        if (! bus.second.canBeProcessedInOrder)
+            continue;
+
+        for (auto returnTree : bus.second.returnTrees)
+        {
+            auto returnNodes = trackNodes.find (returnTree);
+
+            if (returnNodes == trackNodes.end())
+                continue;
+
+            for (auto sendTree : bus.second.sendTrees)
+            {
+                auto sendNodes = trackNodes.find (sendTree);
+
+                if (sendNodes != trackNodes.end())
+                    for (auto returnNode : returnNodes->second)
+                        returnNode->addDependency (*sendNodes->second.back());
+            }
+        }
+    }
+
+    // Tracks that have been connected to others since the last graph was built can't be rebuilt on their own
+    if (graphToReuse != nullptr)
+        for (auto& treeNodes : treeAudioNodes)
+            for (auto audioNode : treeNodes.second)
+                if (! reusedAudioNodes.contains (audioNode) && hasConnectionsToOtherTracks (*audioNode))
+                    return {};
+
+    orderSidechainsInGraph (treeAudioNodes, trackNodes, std::move (treeConnections));
+
+    auto rootNode = std::make_unique<MultipleOutputsNode> (std::move (outputNodes));
+    auto audioNodes = getWrappedAudioNodes (*rootNode);
+
+    for (auto n : audioNodes)
+        if (! reusedAudioNodes.contains (n))
+            prepareNode (n, false);
+
+    auto graph = std::make_unique<PlaybackGraph> (std::move (rootNode), std::move (inputProvider), std::move (audioNodes));
+    graph->trackAudioNodes = std::move (trackAudioNodes);
+    graph->reusedAudioNodes = std::move (reusedAudioNodes);
+    graph->auxBusesInGraphOrder = auxBusesInGraphOrder;
+
+    return graph;
+}
+#endif
+
+/** Opens the files the audio clips will play several at a time, and returns readers which
+    keep them open in the AudioFileCache.
+
+    Building the tracks' nodes has to be done on the message thread, as it initialises plugins
+    and reads the clips' states, but opening files is mostly waiting for the disk and the
+    cache can do that from several threads. Holding these readers whilst the nodes are
+    prepared means their own readers find the files already open.
+*/
+static std::vector<AudioFileCache::Reader::Ptr> openAudioClipFiles (Edit& edit, const Array<EditItemID>* tracksToRebuild)
+{
+    CRASH_TRACER
+    Array<AudioFile> files;
+    std::unordered_set<juce::int64> fileHashes;
+
+    for (auto t : getAudioTracks (edit))
+    {
+        if (! t->isProcessing (true) || t->isFrozen (Track::anyFreeze))
+            continue;
+
+        if (tracksToRebuild != nullptr && ! tracksToRebuild->contains (t->itemID))
+            continue;
+
+        for (auto c : t->getClips())
+        {
+            if (auto acb = dynamic_cast<AudioClipBase*> (c))
+            {
+                auto file = acb->getPlaybackFile();
+
+                if (! file.isNull() && fileHashes.insert (file.getHash()).second)
+                    files.add (file);
+            }
+        }
+    }
+
+    const int numThreads = jmin (files.size(), SystemStats::getNumCpus());
+
+    if (numThreads < 2)
+        return {};
+
+    std::vector<AudioFileCache::Reader::Ptr> readers ((size_t) files.size());
+
+    auto& cache = edit.engine.getAudioFileManager().cache;
+    std::atomic<int> numFinished { 0 };
+
+    {
+        ThreadPool pool (numThreads);
+
+        for (int i = 0; i < files.size(); ++i)
+        {
+            pool.addJob ([&, i]
+                         {
+                             readers[(size_t) i] = cache.createReader (files.getReference (i));
+                             ++numFinished;
+                         });
+        }
+
+        while (numFinished < files.size())
+            Thread::sleep (1);
+    }
+
+    return readers;
+}
+
+bool EditPlaybackContext::createAudioNodes (double startTime, bool addAntiDenormalisationNoise,
+                                            const Array<EditItemID>* tracksToRebuild)
 {
     CRASH_TRACER
 
     isAllocated = true;
 
+    const auto openFiles = openAudioClipFiles (edit, tracksToRebuild);
+
     Array<AudioNode*> allNodes;
 
     for (auto mo : midiOutputs)
         allNodes.add (prepareNode (createPlaybackAudioNode (edit, *mo, insertOptionalLastStageNode,
                                                             addAntiDenormalisationNoise), true));
 
-    for (auto wo : waveOutputs)
-        allNodes.add (prepareNode (createPlaybackAudioNode (edit, *wo, insertOptionalLastStageNode,
-                                                            addAntiDenormalisationNoise), false));
+    Array<AudioNode*> nodesToPrepare, alreadyPreparedNodes;
+
+   #if ENABLE_EXPERIMENTAL_TRACKTION_GRAPH
+    std::unique_ptr<PlaybackGraph> newPlaybackGraph;
 
-    prepareNodesToPlay (edit.engine, allNodes, startTime, playhead);
+    if (isExperimentalGraphProcessingEnabled())
+    {
+        newPlaybackGraph = createPlaybackGraph (allNodes, addAntiDenormalisationNoise, tracksToRebuild);
+
+        if (newPlaybackGraph == nullptr)
+        {
+            for (auto n : allNodes)
+                delete n;
+
+            return false;
+        }
+
+        nodesToPrepare.addArray (newPlaybackGraph->audioNodes);
+        alreadyPreparedNodes.addArray (newPlaybackGraph->reusedAudioNodes);
+    }
+    else
+   #endif
+    {
+        jassert (tracksToRebuild == nullptr);
+
+        // Without the graph the tracks are rendered in no particular order
+        AuxSendPlugin::setBusesProcessedInGraphOrder (edit, {});
+
+        for (auto wo : waveOutputs)
+            allNodes.add (prepareNode (createPlaybackAudioNode (edit, *wo, insertOptionalLastStageNode,
+                                                                addAntiDenormalisationNoise), false));
+    }
+
+    nodesToPrepare.addArray (allNodes);
+    prepareNodesToPlay (edit.engine, nodesToPrepare, startTime, playhead, alreadyPreparedNodes);
+
+   #if ENABLE_EXPERIMENTAL_TRACKTION_GRAPH
+    if (newPlaybackGraph != nullptr)
+    {
+        auto& dm = edit.engine.getDeviceManager();
+        newPlaybackGraph->prepareToPlay (dm.getSampleRate(), dm.getBlockSize(),
+                                         edit.engine.getRealtimeWorkerPool().getNumThreads() + 1,
+                                         edit.engine.getEngineBehaviour().shouldUseNumaAwareProcessing());
+    }
+   #endif
 
     const auto& tempoSections = edit.tempoSequence.getTempoSections();
     const bool hasTempoChanged = tempoSections.getChangeCount() != lastTempoSections.getChangeCount();
@@ -416,6 +1048,10 @@ void EditPlaybackContext::createAudioNodes (double startTime, bool addAntiDenorm
         for (auto wo : waveOutputs)
             removedNodes.add (wo->replaceAudioNode (std::unique_ptr<AudioNode> (allNodes.getUnchecked (i++))));
 
+       #if ENABLE_EXPERIMENTAL_TRACKTION_GRAPH
+        std::swap (playbackGraph, newPlaybackGraph);
+       #endif
+
         if (hasTempoChanged && lastTempoSections.size() > 0)
         {
             auto lastBeats = lastTempoSections.timeToBeats (playhead.getPosition());
@@ -427,6 +1063,8 @@ void EditPlaybackContext::createAudioNodes (double startTime, bool addAntiDenorm
 
     if (hasTempoChanged)
         lastTempoSections = tempoSections;
+
+    return true;
 }
 
 void EditPlaybackContext::createPlayAudioNodes (double startTime)
@@ -446,6 +1084,51 @@ void EditPlaybackContext::reallocate()
     createPlayAudioNodes (playhead.getPosition());
 }
 
+bool EditPlaybackContext::reallocateTracks (const Array<EditItemID>& trackIDs, double startTime)
+{
+   #if ENABLE_EXPERIMENTAL_TRACKTION_GRAPH
+    CRASH_TRACER
+
+    if (! isAllocated || playbackGraph == nullptr)
+        return false;
+
+    Array<EditItemID> tracksToRebuild;
+
+    for (auto trackID : trackIDs)
+    {
+        auto track = findTrackForID (edit, trackID);
+
+        if (track == nullptr)
+            return false;
+
+        auto topLevelTrack = getTrackContainingNodes (*track);
+
+        if (topLevelTrack == nullptr)
+            return false;
+
+        auto found = playbackGraph->trackAudioNodes.find (topLevelTrack->itemID);
+
+        if (found == playbackGraph->trackAudioNodes.end()
+             || hasConnectionsToOtherTracks (*found->second))
+            return false;
+
+        tracksToRebuild.addIfNotAlreadyThere (topLevelTrack->itemID);
+    }
+
+    if (tracksToRebuild.isEmpty())
+        return true;
+
+    if (! createAudioNodes (startTime, shouldAddAntiDenormalisationNoise (edit.engine), &tracksToRebuild))
+        return false;
+
+    startPlaying (startTime);
+    return true;
+   #else
+    juce::ignoreUnused (trackIDs, startTime);
+    return false;
+   #endif
+}
+
 void EditPlaybackContext::startPlaying (double start)
 {
     prepareOutputDevices (start);
@@ -620,14 +1303,15 @@ Array<InputDeviceInstance*> EditPlaybackContext::getAllInputs()
     return allInputs;
 }
 
-void EditPlaybackContext::fillNextAudioBlock (EditTimeRange streamTime, float** allChannels, int numSamples)
+bool EditPlaybackContext::startNextAudioBlock (EditTimeRange streamTime, int numSamples)
 {
     CRASH_TRACER
 
     if (edit.isRendering())
-        return;
+        return false;
 
     SCOPED_REALTIME_CHECK
+    TRACKTION_REALTIME_ALLOCATION_CHECK
 
     // update stream time for track inputs
     for (auto in : midiInputs)
@@ -687,14 +1371,48 @@ void EditPlaybackContext::fillNextAudioBlock (EditTimeRange streamTime, float**
         lastStreamPos = streamPos;
     }
 
+    // A preview that's stopped and gone quiet costs nothing until it's played again
+    if (! edit.getIsPreviewEdit() || playhead.isPlaying())
+        silentSecondsWhilstStopped = 0;
+    else if (silentSecondsWhilstStopped >= silentSecondsBeforeSuspending)
+        return false;
+
     edit.updateModifierTimers (playhead, streamTime, numSamples);
     midiDispatcher.nextBlockStarted (playhead, streamTime, numSamples);
 
     for (auto r : edit.getRackList().getTypes())
         r->newBlockStarted();
 
+    return true;
+}
+
+void EditPlaybackContext::renderNextAudioBlock (EditTimeRange streamTime, int numSamples)
+{
+    CRASH_TRACER
+    TRACKTION_REALTIME_ALLOCATION_CHECK
+
+   #if ENABLE_EXPERIMENTAL_TRACKTION_GRAPH
+    if (playbackGraph != nullptr)
+        playbackGraph->process (playhead, streamTime, numSamples);
+   #endif
+
+    for (auto wo : waveOutputs)
+        wo->renderNextAudioBlock (playhead, streamTime, numSamples);
+}
+
+void EditPlaybackContext::addNextAudioBlockToOutputs (EditTimeRange streamTime, float** allChannels, int numSamples)
+{
+    TRACKTION_REALTIME_ALLOCATION_CHECK
+    bool isSilent = true;
+
     for (auto wo : waveOutputs)
-        wo->fillNextAudioBlock (playhead, streamTime, allChannels, numSamples);
+    {
+        wo->addToOutputChannels (allChannels, numSamples);
+        isSilent = isSilent && wo->wasLastBlockSilent();
+    }
+
+    if (edit.getIsPreviewEdit() && ! playhead.isPlaying())
+        silentSecondsWhilstStopped = isSilent ? silentSecondsWhilstStopped + streamTime.getLength() : 0.0;
 }
 
 InputDeviceInstance* EditPlaybackContext::getInputFor (InputDevice* d) const
@@ -742,6 +1460,40 @@ void EditPlaybackContext::setAddAntiDenormalisationNoise (Engine& e, bool b)
     hasCheckedDenormNoise = false;
 }
 
+//==============================================================================
+namespace
+{
+    bool& getExperimentalGraphProcessingFlag()
+    {
+        static bool enabled = false;
+        return enabled;
+    }
+}
+
+void EditPlaybackContext::enableExperimentalGraphProcessing (bool enable)
+{
+    getExperimentalGraphProcessingFlag() = enable;
+}
+
+juce::int64 EditPlaybackContext::getGraphMemoryUsage() const
+{
+   #if ENABLE_EXPERIMENTAL_TRACKTION_GRAPH
+    if (playbackGraph != nullptr)
+        return (juce::int64) playbackGraph->player.getNumBytesAllocated();
+   #endif
+
+    return 0;
+}
+
+bool EditPlaybackContext::isExperimentalGraphProcessingEnabled()
+{
+   #if ENABLE_EXPERIMENTAL_TRACKTION_GRAPH
+    return getExperimentalGraphProcessingFlag();
+   #else
+    return false;
+   #endif
+}
+
 //==============================================================================
 #if JUCE_WINDOWS
 static int numHighPriorityPlayers = 0, numRealtimeDefeaters = 0;
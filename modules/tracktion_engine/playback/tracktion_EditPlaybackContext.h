@@ -28,6 +28,14 @@ public:
     void createPlayAudioNodesIfNeeded (double startTime);
     void reallocate();
 
+    /** Rebuilds just the parts of the playback graph that belong to these tracks.
+        The nodes for the other tracks are kept, so this is much quicker than reallocating
+        in large Edits. It only works with the experimental graph processing and returns
+        false if the tracks can't be rebuilt on their own, e.g. if they're connected to other
+        tracks with sidechains or aux returns, in which case the caller should reallocate.
+    */
+    bool reallocateTracks (const juce::Array<EditItemID>& trackIDs, double startTime);
+
     // Prepares the graph but doesn't actually start the playhead
     void prepareForPlaying (double startTime);
     void prepareForRecording (double startTime, double punchIn);
@@ -42,6 +50,11 @@ public:
     juce::Array<InputDeviceInstance*> getAllInputs();
     InputDeviceInstance* getInputFor (InputDevice*) const;
 
+    /** Returns the memory allocated for the buffers of the playback graph's Nodes.
+        This is only known for the experimental graph, otherwise it returns 0.
+    */
+    juce::int64 getGraphMemoryUsage() const;
+
     Edit& edit;
     TransportControl& transport;
     PlayHead playhead;
@@ -65,6 +78,13 @@ public:
     static bool shouldAddAntiDenormalisationNoise (Engine&);
     static void setAddAntiDenormalisationNoise (Engine&, bool);
 
+    /** Enables the new tracktion_graph module for processing the wave output devices.
+        The AudioNodes for each track are processed concurrently as a single graph.
+        N.B. This is for development only and this method will be removed in the future.
+    */
+    static void enableExperimentalGraphProcessing (bool);
+    static bool isExperimentalGraphProcessingEnabled();
+
     //==============================================================================
     // Only implemented on Windows
     struct RealtimePriorityDisabler
@@ -97,13 +117,23 @@ private:
     void releaseDeviceList();
     void rebuildDeviceList();
 
-    void createAudioNodes (double startTime, bool addAntiDenormalisationNoise);
+    bool createAudioNodes (double startTime, bool addAntiDenormalisationNoise,
+                           const juce::Array<EditItemID>* tracksToRebuild = nullptr);
     void prepareOutputDevices (double start);
     void startRecording (double start, double punchIn);
     void startPlaying (double start);
 
     friend class DeviceManager;
-    void fillNextAudioBlock (EditTimeRange streamTime, float** allChannels, int numSamples);
+
+    // The DeviceManager calls these in turn for each block. The first and last are called for
+    // each context one after another, but the contexts may be rendered at the same time.
+    bool startNextAudioBlock (EditTimeRange streamTime, int numSamples);
+    void renderNextAudioBlock (EditTimeRange streamTime, int numSamples);
+    void addNextAudioBlockToOutputs (EditTimeRange streamTime, float** allChannels, int numSamples);
+
+    // Preview Edits aren't rendered once they've been stopped and silent for this long
+    static constexpr double silentSecondsBeforeSuspending = 0.5;
+    double silentSecondsWhilstStopped = 0;
 
     juce::WeakReference<EditPlaybackContext> contextToSyncTo;
     double previousBarTime = 0;
@@ -111,6 +141,14 @@ private:
     bool hasSynced = false;
     double lastStreamPos = 0;
 
+   #if ENABLE_EXPERIMENTAL_TRACKTION_GRAPH
+    struct PlaybackGraph;
+    std::unique_ptr<PlaybackGraph> playbackGraph;
+
+    std::unique_ptr<PlaybackGraph> createPlaybackGraph (juce::Array<AudioNode*>& deviceNodes, bool addAntiDenormalisationNoise,
+                                                        const juce::Array<EditItemID>* tracksToRebuild);
+   #endif
+
     JUCE_DECLARE_WEAK_REFERENCEABLE (EditPlaybackContext)
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (EditPlaybackContext)
 };
@@ -154,6 +154,8 @@ public:
     HostedMidiInputDevice (HostedAudioDeviceInterface& aif)
         : MidiInputDevice (aif.engine, TRANS("MIDI Input"), TRANS("MIDI Input")), audioIf (aif)
     {
+        // Enough for dense MIDI without the audio thread having to allocate
+        filteredMidi.ensureSize (8192);
     }
 
     ~HostedMidiInputDevice() override
@@ -186,11 +188,35 @@ public:
         engine.getPropertyStorage().setXmlPropertyItem (SettingID::midiin, getName(), n);
     }
 
-    void processBlock (MidiBuffer& midi)
+    /** Filters the host's MIDI once for the block. Every instance's input node reads the
+        same filtered buffer, so nothing's copied or dispatched per instance or per message.
+    */
+    void processBlock (const MidiBuffer& midi)
     {
-        for (auto instance : instances)
-            if (auto* hostedInstance = dynamic_cast<HostedMidiInputDeviceInstance*> (instance))
-                hostedInstance->processBlock (midi);
+        filteredMidi.clear();
+
+        if (midi.isEmpty())
+            return;
+
+        juce::uint32 allowedChannels = 0;
+
+        for (int chan = 0; chan < 16; ++chan)
+            if (! disallowedChannels[chan])
+                allowedChannels |= 1u << chan;
+
+        for (auto itr : midi)
+        {
+            auto data = itr.data;
+
+            // Active sense is dropped, as are channel messages on disallowed channels
+            if (data[0] == 0xfe)
+                continue;
+
+            if (data[0] < 0xf0 && (allowedChannels & (1u << (data[0] & 0x0f))) == 0)
+                continue;
+
+            filteredMidi.addEvent (data, itr.numBytes, itr.samplePosition);
+        }
     }
 
     void handleIncomingMidiMessage (const juce::MidiMessage&) override {}
@@ -202,7 +228,7 @@ private:
     class HostedMidiInputAudioNode : public AudioNode
     {
     public:
-        HostedMidiInputAudioNode (MidiBuffer& midi_) : midi (midi_) {}
+        HostedMidiInputAudioNode (const MidiBuffer& midi_) : midi (midi_) {}
 
         void getAudioNodeProperties (AudioNodeProperties& p) override
         {
@@ -237,18 +263,14 @@ private:
             if (rc.bufferForMidiMessages != nullptr)
             {
                 for (auto itr : midi)
-                {
-                    auto msg = itr.getMessage();
-                    int pos = itr.samplePosition;
-
-                    msg.setTimeStamp (pos / sampleRate + rc.midiBufferOffset);
-                    rc.bufferForMidiMessages->addMidiMessage (msg, mpeSource);
-                }
+                    rc.bufferForMidiMessages->addMidiMessage (juce::MidiMessage (itr.data, itr.numBytes),
+                                                              itr.samplePosition / sampleRate + rc.midiBufferOffset,
+                                                              mpeSource);
             }
         }
 
     private:
-        MidiBuffer& midi;
+        const MidiBuffer& midi;
         double sampleRate = 44100.0;
         MidiMessageArray::MPESourceID mpeSource { MidiMessageArray::createUniqueMPESourceID() };
     };
@@ -258,20 +280,20 @@ private:
     {
     public:
         HostedMidiInputDeviceInstance (HostedMidiInputDevice& owner_, EditPlaybackContext& epc)
-            : MidiInputDeviceInstanceBase (owner_, epc)
+            : MidiInputDeviceInstanceBase (owner_, epc), hostedOwner (owner_)
         {
         }
 
         bool startRecording() override              { return false; }
-        AudioNode* createLiveInputNode() override   { return new HostedMidiInputAudioNode (midi); }
-        void processBlock (MidiBuffer& m)           { midi = m; }
+        AudioNode* createLiveInputNode() override   { return new HostedMidiInputAudioNode (hostedOwner.filteredMidi); }
 
     private:
-        MidiBuffer midi;
+        HostedMidiInputDevice& hostedOwner;
     };
     
     //==============================================================================
     HostedAudioDeviceInterface& audioIf;
+    MidiBuffer filteredMidi;
 };
 
 //==============================================================================
@@ -393,14 +415,18 @@ void HostedAudioDeviceInterface::prepareToPlay (double sampleRate, int blockSize
         parameters.sampleRate = sampleRate;
         parameters.blockSize  = blockSize;
 
+        // The FIFOs only start being used if the host's blocks don't line up with ours
+        isUsingFifo = false;
+
         if (! parameters.fixedBlockSize)
         {
             inputFifo.setSize (maxChannels, blockSize * 4);
             outputFifo.setSize (maxChannels, blockSize * 4);
-
-            outputFifo.writeSilence (blockSize);
         }
 
+        splitMidiIn.ensureSize (2048);
+        splitMidiOut.ensureSize (2048);
+
         if (deviceType != nullptr)
             deviceType->settingsChanged();
     }
@@ -411,50 +437,82 @@ void HostedAudioDeviceInterface::processBlock (AudioBuffer<float>& buffer, MidiB
     if (parameters.fixedBlockSize)
     {
         jassert (buffer.getNumSamples() == parameters.blockSize);
+        processEngineBlock (buffer, midi);
+        return;
+    }
 
-        for (auto input : midiInputs)
-            if (auto hostedInput = dynamic_cast<HostedMidiInputDevice*> (input))
-                hostedInput->processBlock (midi);
+    if (! isUsingFifo)
+    {
+        if (buffer.getNumSamples() % parameters.blockSize == 0)
+        {
+            processSplit (buffer, midi);
+            return;
+        }
 
-        midi.clear();
+        // From now on the host's blocks have to be buffered to keep the output continuous,
+        // which adds a block of latency
+        isUsingFifo = true;
+        outputFifo.writeSilence (parameters.blockSize);
+    }
 
-        if (deviceType != nullptr)
-            deviceType->processBlock (buffer);
+    inputFifo.writeAudioAndMidi (buffer, midi);
+    midi.clear();
 
-        for (auto output : midiOutputs)
-            if (auto hostedOutput = dynamic_cast<HostedMidiOutputDevice*> (output))
-                hostedOutput->processBlock (midi);
-    }
-    else
+    while (inputFifo.getNumSamplesAvailable() >= parameters.blockSize)
     {
-        inputFifo.writeAudioAndMidi (buffer, midi);
-        midi.clear();
+        MidiBuffer scratchMidi;
+        AudioScratchBuffer scratch (buffer.getNumChannels(), parameters.blockSize);
 
-        while (inputFifo.getNumSamplesAvailable() >= parameters.blockSize)
-        {
-            MidiBuffer scratchMidi;
-            AudioScratchBuffer scratch (buffer.getNumChannels(), parameters.blockSize);
+        inputFifo.readAudioAndMidi (scratch.buffer, scratchMidi);
+        processEngineBlock (scratch.buffer, scratchMidi);
+        outputFifo.writeAudioAndMidi (scratch.buffer, scratchMidi);
+    }
 
-            inputFifo.readAudioAndMidi (scratch.buffer, scratchMidi);
+    outputFifo.readAudioAndMidi (buffer, midi);
+}
 
-            for (auto input : midiInputs)
-                if (auto hostedInput = dynamic_cast<HostedMidiInputDevice*> (input))
-                    hostedInput->processBlock (scratchMidi);
+void HostedAudioDeviceInterface::processSplit (AudioBuffer<float>& buffer, MidiBuffer& midi)
+{
+    const int blockSize = parameters.blockSize;
+
+    if (buffer.getNumSamples() == blockSize)
+    {
+        processEngineBlock (buffer, midi);
+        return;
+    }
 
-            if (deviceType != nullptr)
-                deviceType->processBlock (scratch.buffer);
+    // Renders each block straight into the host's buffer, moving the MIDI along with it
+    splitMidiOut.clear();
 
-            scratchMidi.clear();
+    for (int start = 0; start < buffer.getNumSamples(); start += blockSize)
+    {
+        AudioBuffer<float> section (buffer.getArrayOfWritePointers(), buffer.getNumChannels(), start, blockSize);
 
-            for (auto output : midiOutputs)
-                if (auto hostedOutput = dynamic_cast<HostedMidiOutputDevice*> (output))
-                    hostedOutput->processBlock (scratchMidi);
+        splitMidiIn.clear();
+        splitMidiIn.addEvents (midi, start, blockSize, -start);
 
-            outputFifo.writeAudioAndMidi (scratch.buffer, scratchMidi);
-        }
+        processEngineBlock (section, splitMidiIn);
 
-        outputFifo.readAudioAndMidi (buffer, midi);
+        splitMidiOut.addEvents (splitMidiIn, 0, blockSize, start);
     }
+
+    midi.swapWith (splitMidiOut);
+}
+
+void HostedAudioDeviceInterface::processEngineBlock (AudioBuffer<float>& buffer, MidiBuffer& midi)
+{
+    for (auto input : midiInputs)
+        if (auto hostedInput = dynamic_cast<HostedMidiInputDevice*> (input))
+            hostedInput->processBlock (midi);
+
+    midi.clear();
+
+    if (deviceType != nullptr)
+        deviceType->processBlock (buffer);
+
+    for (auto output : midiOutputs)
+        if (auto hostedOutput = dynamic_cast<HostedMidiOutputDevice*> (output))
+            hostedOutput->processBlock (midi);
 }
 
 juce::StringArray HostedAudioDeviceInterface::getInputChannelNames()
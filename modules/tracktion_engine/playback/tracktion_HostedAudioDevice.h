@@ -48,9 +48,11 @@ public:
         int outputChannels = 2;
 
         /** If the size of the audio buffer passed to processBlock will be fixed or not.
-            If you are creating a plugin, this should be false, and your plguin will have
-            one block of latency. If you are handling the audio device callback yourself,
-            this can be true. */
+            If you are creating a plugin, this should be false. Blocks that are a multiple
+            of the block size are still rendered straight into the host's buffer, but once
+            a block of any other size arrives, audio is buffered from then on and your plugin
+            will have one block of latency. If you are handling the audio device callback
+            yourself, this can be true. */
         bool fixedBlockSize = false;
 
         /** Names of your audio channels. If left empty, names will automatically be generated */
@@ -65,8 +67,14 @@ public:
     // Pass audio and midi buffers to the engine. If fixedBlockSize == true
     // then the buffer must have the same number of samples as specified in
     // the last call to prepareToPlay.
+    // Call getLatencySamples() after this if fixedBlockSize is false, as it may have changed.
     void processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer&);
 
+    /** Returns the number of samples the output is delayed by. This is 0 until the host
+        passes a block whose size isn't a multiple of the block size.
+    */
+    int getLatencySamples() const noexcept      { return isUsingFifo ? parameters.blockSize : 0; }
+
 private:
     friend DeviceManager;
     friend class HostedAudioDevice;
@@ -89,6 +97,11 @@ private:
 
     int maxChannels = 0;
     AudioMidiFifo inputFifo, outputFifo;
+    bool isUsingFifo = false;
+    juce::MidiBuffer splitMidiIn, splitMidiOut;
+
+    void processSplit (juce::AudioBuffer<float>&, juce::MidiBuffer&);
+    void processEngineBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&);
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (HostedAudioDeviceInterface)
 };
@@ -41,9 +41,106 @@ static void getSumAndDiff (const AudioBuffer<FloatType>& buffer,
     }
 }
 
+//==============================================================================
+namespace LevelMeasurerHelpers
+{
+    struct ChannelLevels
+    {
+        float peak = 0, sumOfSquares = 0, truePeak = 0;
+    };
+
+    // The level half way between the middle two of four samples
+    static inline float getMidpoint (const float* s) noexcept
+    {
+        return (9.0f * (s[1] + s[2]) - s[0] - s[3]) * (1.0f / 16.0f);
+    }
+
+    // Finds the peak, the sum of squares and the inter-sample peak in one go over the samples.
+    // The loop keeps a few separate running values so the compiler can vectorise it
+    // without having to reorder the float sums.
+    static ChannelLevels measureChannel (const float* JUCE_RESTRICT data, int numSamples, float* history) noexcept
+    {
+        constexpr int numLanes = 4;
+        float peaks[numLanes] = {}, squares[numLanes] = {}, midpoints[numLanes] = {};
+
+        // The first few midpoints need the end of the last block
+        const int numHead = jmin (numSamples, 3);
+        float head[6] = { history[0], history[1], history[2] };
+
+        for (int i = 0; i < numHead; ++i)
+        {
+            auto s = data[i];
+            head[3 + i] = s;
+            peaks[0] = jmax (peaks[0], std::abs (s));
+            squares[0] += s * s;
+            midpoints[0] = jmax (midpoints[0], std::abs (getMidpoint (head + i)));
+        }
+
+        int i = numHead;
+
+        for (; i + numLanes <= numSamples; i += numLanes)
+        {
+            for (int lane = 0; lane < numLanes; ++lane)
+            {
+                auto s = data[i + lane];
+                peaks[lane] = jmax (peaks[lane], std::abs (s));
+                squares[lane] += s * s;
+                midpoints[lane] = jmax (midpoints[lane], std::abs (getMidpoint (data + i + lane - 3)));
+            }
+        }
+
+        for (; i < numSamples; ++i)
+        {
+            auto s = data[i];
+            peaks[0] = jmax (peaks[0], std::abs (s));
+            squares[0] += s * s;
+            midpoints[0] = jmax (midpoints[0], std::abs (getMidpoint (data + i - 3)));
+        }
+
+        if (numSamples >= 3)
+            std::copy (data + numSamples - 3, data + numSamples, history);
+        else
+            std::copy (head + numHead, head + numHead + 3, history);
+
+        ChannelLevels result;
+
+        for (int lane = 0; lane < numLanes; ++lane)
+        {
+            result.peak = jmax (result.peak, peaks[lane]);
+            result.sumOfSquares += squares[lane];
+            result.truePeak = jmax (result.truePeak, midpoints[lane]);
+        }
+
+        result.truePeak = jmax (result.truePeak, result.peak);
+        return result;
+    }
+
+    static void storeMax (std::atomic<float>& dest, float value) noexcept
+    {
+        auto current = dest.load (std::memory_order_relaxed);
+
+        while (value > current && ! dest.compare_exchange_weak (current, value))
+        {}
+    }
+}
+
 //==============================================================================
 LevelMeasurer::LevelMeasurer()
 {
+    for (auto& w : windows)
+    {
+        for (auto& l : w.audio)
+            l = 0.0f;
+
+        w.midi = 0.0f;
+        w.time = 0;
+    }
+
+    for (auto& l : pendingAudio)
+        l = 0.0f;
+
+    pendingMidi = 0.0f;
+
     clear();
 }
 
@@ -55,158 +152,86 @@ LevelMeasurer::~LevelMeasurer()
 //==============================================================================
 void LevelMeasurer::Client::reset() noexcept
 {
-    juce::SpinLock::ScopedLockType sl (mutex);
-    for (auto& l : audioLevels)
-        l = {};
+    // Anything published before now is ignored
+    auto numPublished = measurer != nullptr ? measurer->numWindowsPublished.load() : 0;
 
-    for (auto& o : overload)
-        o = false;
+    for (auto& l : lastAudioWindowRead)
+        l = numPublished;
 
-    midiLevels = {};
+    lastMidiWindowRead = numPublished;
     clearOverload = true;
 }
 
 bool LevelMeasurer::Client::getAndClearOverload() noexcept
 {
-    juce::SpinLock::ScopedLockType sl (mutex);
-    auto result = clearOverload;
-    clearOverload = false;
-    return result;
+    return clearOverload.exchange (false);
 }
 
 DbTimePair LevelMeasurer::Client::getAndClearMidiLevel() noexcept
 {
-    juce::SpinLock::ScopedLockType sl (mutex);
-    auto result = midiLevels;
-    midiLevels.dB = -100.0f;
-    return result;
+    if (measurer == nullptr)
+        return {};
+
+    return measurer->getLevelSince (lastMidiWindowRead, -1);
 }
 
 DbTimePair LevelMeasurer::Client::getAndClearAudioLevel (int chan) noexcept
 {
-    juce::SpinLock::ScopedLockType sl (mutex);
     jassert (chan >= 0 && chan < maxNumChannels);
-    auto result = audioLevels[chan];
-    audioLevels[chan].dB = -100.0f;
-    return result;
-}
 
-void LevelMeasurer::Client::setNumChannelsUsed (int numChannels) noexcept
-{
-    juce::SpinLock::ScopedLockType sl (mutex);
-    numChannelsUsed = numChannels;
-}
+    if (measurer == nullptr)
+        return {};
 
-void LevelMeasurer::Client::setOverload (int channel, bool hasOverloaded) noexcept
-{
-    juce::SpinLock::ScopedLockType sl (mutex);
-    overload[channel] = hasOverloaded;
-}
-
-void LevelMeasurer::Client::setClearOverload (bool clear) noexcept
-{
-    juce::SpinLock::ScopedLockType sl (mutex);
-    clearOverload = clear;
-}
-
-void LevelMeasurer::Client::updateAudioLevel (int channel, DbTimePair newAudioLevel) noexcept
-{
-    juce::SpinLock::ScopedLockType sl (mutex);
-
-    if (newAudioLevel.dB >= audioLevels[channel].dB)
-        audioLevels[channel] = newAudioLevel;
+    return measurer->getLevelSince (lastAudioWindowRead[chan], chan);
 }
 
-void LevelMeasurer::Client::updateMidiLevel (DbTimePair newMidiLevel) noexcept
-{
-    if (midiLevels.dB >= midiLevels.dB)
-        midiLevels = newMidiLevel;
-}
-
-
 //==============================================================================
 void LevelMeasurer::processBuffer (juce::AudioBuffer<float>& buffer, int start, int numSamples)
 {
-    const ScopedLock sl (clientsMutex);
-
-    if (clients.isEmpty())
+    if (numClients.load() == 0)
         return;
 
-    float newLevel[Client::maxNumChannels] = {};
-    auto numChans = jmin ((int) Client::maxNumChannels, buffer.getNumChannels());
-    auto now = Time::getApproximateMillisecondCounter();
-
-    if (mode == LevelMeasurer::peakMode)
+    if (mode != LevelMeasurer::sumDiffMode)
     {
-        // peak mode
-        for (int i = numChans; --i >= 0;)
-        {
-            auto gain = buffer.getMagnitude (i, start, numSamples);
-            newLevel[i] = gain;
-            bool overloaded = gain > 0.999f;
-            auto newDB = gainToDb (gain);
-
-            for (auto c : clients)
-            {
-                c->updateAudioLevel (i, { now, newDB });
-
-                if (overloaded)
-                    c->setOverload (i, true);
+        float newLevel[Client::maxNumChannels] = {};
+        auto numChans = jmin ((int) Client::maxNumChannels, buffer.getNumChannels());
 
-                c->setNumChannelsUsed (numChans);
-            }
-        }
-    }
-    else if (mode == LevelMeasurer::RMSMode)
-    {
-        // rms mode
         for (int i = numChans; --i >= 0;)
         {
-            auto gain = buffer.getRMSLevel (i, start, numSamples);
-            newLevel[i] = gain;
-            bool overloaded = gain > 0.999f;
-            auto newDB = gainToDb (gain);
-
-            for (auto c : clients)
-            {
-                c->updateAudioLevel (i, { now, newDB });
-
-                if (overloaded)
-                    c->setOverload (i, true);
-
-                c->setNumChannelsUsed (numChans);
-            }
+            auto levels = LevelMeasurerHelpers::measureChannel (buffer.getReadPointer (i, start), numSamples, truePeakHistory[i]);
+
+            if (mode == LevelMeasurer::peakMode)
+                newLevel[i] = levels.peak;
+            else if (mode == LevelMeasurer::RMSMode)
+                newLevel[i] = numSamples > 0 ? std::sqrt (levels.sumOfSquares / numSamples) : 0.0f;
+            else
+                newLevel[i] = levels.truePeak;
         }
+
+        addLevels (newLevel, numChans);
     }
     else
     {
         // sum + diff
-        float sum, diff;
-        getSumAndDiff (buffer, sum, diff, start, numSamples);
-        newLevel[0] = sum;
-        newLevel[1] = diff;
-
-        auto sumDB  = gainToDb (sum);
-        auto diffDB = gainToDb (diff);
+        float levels[2];
+        getSumAndDiff (buffer, levels[0], levels[1], start, numSamples);
+        addLevels (levels, 2);
+    }
+}
 
-        for (auto c : clients)
-        {
-            c->updateAudioLevel (0, { now, sumDB });
-            c->updateAudioLevel (1, { now, diffDB });
+void LevelMeasurer::processLevels (const float* levels, int numChannels)
+{
+    jassert (mode == LevelMeasurer::peakMode || mode == LevelMeasurer::RMSMode);
 
-            if (sum  > 0.999f) c->setOverload (0, true);
-            if (diff > 0.999f) c->setOverload (1, true);
+    if (numClients.load() == 0)
+        return;
 
-            c->setNumChannelsUsed (2);
-        }
-    }
+    addLevels (levels, jmin ((int) Client::maxNumChannels, numChannels));
 }
 
 void LevelMeasurer::processMidi (MidiMessageArray& midiBuffer, const float*)
 {
-    const ScopedLock sl (clientsMutex);
-
-    if (clients.isEmpty() || ! showMidi)
+    if (numClients.load() == 0 || ! showMidi)
         return;
 
     float max = 0.0f;
@@ -215,23 +240,80 @@ void LevelMeasurer::processMidi (MidiMessageArray& midiBuffer, const float*)
         if (m.isNoteOn())
             max = jmax (max, m.getFloatVelocity());
 
-    auto now = Time::getApproximateMillisecondCounter();
-
-    for (auto c : clients)
-        c->updateMidiLevel ({ now, gainToDb (max) });
+    addMidiLevel (max);
 }
 
 void LevelMeasurer::processMidiLevel (float level)
 {
-    const ScopedLock sl (clientsMutex);
-
-    if (clients.isEmpty() || ! showMidi)
+    if (numClients.load() == 0 || ! showMidi)
         return;
 
+    addMidiLevel (level);
+}
+
+void LevelMeasurer::addLevels (const float* gains, int numChannels) noexcept
+{
+    for (int i = numChannels; --i >= 0;)
+        LevelMeasurerHelpers::storeMax (pendingAudio[i], gains[i]);
+
+    numActiveChannels = numChannels;
+    publishIfDue();
+}
+
+void LevelMeasurer::addMidiLevel (float gain) noexcept
+{
+    LevelMeasurerHelpers::storeMax (pendingMidi, gain);
+    publishIfDue();
+}
+
+void LevelMeasurer::publishIfDue() noexcept
+{
+    // This is called by the clients too, so that the last levels still get
+    // published when the audio stops
     auto now = Time::getApproximateMillisecondCounter();
+    auto lastTime = lastPublishTime.load();
 
-    for (auto c : clients)
-        c->updateMidiLevel ({ now, gainToDb (level) });
+    if (now - lastTime < windowLengthMs
+         || ! lastPublishTime.compare_exchange_strong (lastTime, now))
+        return;
+
+    auto& w = windows[numWindowsPublished.load() % numWindows];
+
+    for (int i = 0; i < Client::maxNumChannels; ++i)
+        w.audio[i] = pendingAudio[i].exchange (0.0f);
+
+    w.midi = pendingMidi.exchange (0.0f);
+    w.time = now;
+    ++numWindowsPublished;
+}
+
+DbTimePair LevelMeasurer::getLevelSince (juce::uint32& lastWindowRead, int channel) noexcept
+{
+    publishIfDue();
+
+    auto numPublished = numWindowsPublished.load();
+
+    // If the client hasn't looked for a while, the oldest windows have been reused
+    if (numPublished - lastWindowRead > numWindows)
+        lastWindowRead = numPublished - numWindows;
+
+    DbTimePair result;
+    float maxGain = -1.0f;
+
+    for (auto i = lastWindowRead; i != numPublished; ++i)
+    {
+        auto& w = windows[i % numWindows];
+        auto gain = channel < 0 ? w.midi.load() : w.audio[channel].load();
+
+        if (gain > maxGain)
+        {
+            maxGain = gain;
+            result = { w.time.load(), gainToDb (gain) };
+        }
+    }
+
+    lastWindowRead = numPublished;
+    return result;
 }
 
 void LevelMeasurer::clearOverload()
@@ -239,11 +321,16 @@ void LevelMeasurer::clearOverload()
     const ScopedLock sl (clientsMutex);
 
     for (auto c : clients)
-        c->setClearOverload (true);
+        c->clearOverload = true;
 }
 
 void LevelMeasurer::clear()
 {
+    for (auto& l : pendingAudio)
+        l = 0.0f;
+
+    pendingMidi = 0.0f;
+
     const ScopedLock sl (clientsMutex);
 
     for (auto c : clients)
@@ -263,13 +350,19 @@ void LevelMeasurer::addClient (Client& c)
 {
     const ScopedLock sl (clientsMutex);
     jassert (! clients.contains (&c));
+    jassert (c.measurer == nullptr);
     clients.add (&c);
+    c.measurer = this;
+    c.reset();
+    numClients = clients.size();
 }
 
 void LevelMeasurer::removeClient (Client& c)
 {
     const ScopedLock sl (clientsMutex);
     clients.removeFirstMatchingValue (&c);
+    c.measurer = nullptr;
+    numClients = clients.size();
 }
 
 void LevelMeasurer::setShowMidi (bool show)
@@ -21,6 +21,11 @@ struct DbTimePair
 /**
     Monitors the levels of buffers that are passed in, and keeps peak values,
     overloads, etc., for display in a level meter component.
+
+    The audio thread never touches the clients. Each block's levels are merged into
+    a pending window, and every few milliseconds that window is published into a small
+    ring of atomic slots. Clients poll at whatever rate their display runs at and pick up
+    the loudest level from the windows published since they last looked.
 */
 class LevelMeasurer
 {
@@ -31,6 +36,13 @@ public:
 
     //==============================================================================
     void processBuffer (juce::AudioBuffer<float>& buffer, int start, int numSamples);
+
+    /** Passes on levels that have already been measured, e.g. whilst something else was being
+        done to the audio, to save going over it again. There should be one level per channel,
+        each being a peak or an RMS level to match the current mode. This can't be used in
+        sumDiffMode or truePeakMode, which need the audio.
+    */
+    void processLevels (const float* levels, int numChannels);
     void processMidi (MidiMessageArray& midiBuffer, const float* gains);
     void processMidiLevel (float level);
 
@@ -42,7 +54,8 @@ public:
     {
         peakMode     = 0,
         RMSMode      = 1,
-        sumDiffMode  = 2
+        sumDiffMode  = 2,
+        truePeakMode = 3    /**< Also catches peaks between samples, by interpolating half way between them. */
     };
 
     void setMode (Mode);
@@ -64,22 +77,13 @@ public:
 
         static constexpr auto maxNumChannels = 8;
 
-        /** @internal */
-        void setNumChannelsUsed (int) noexcept;
-        void setOverload (int channel, bool hasOverloaded) noexcept;
-        void setClearOverload (bool) noexcept;
-
-        void updateAudioLevel (int channel, DbTimePair) noexcept;
-        void updateMidiLevel (DbTimePair) noexcept;
-
     private:
-        DbTimePair audioLevels[maxNumChannels];
-        bool overload[maxNumChannels];
-        DbTimePair midiLevels;
-        int numChannelsUsed = 0;
-        bool clearOverload = true;
+        friend class LevelMeasurer;
 
-        juce::SpinLock mutex;
+        LevelMeasurer* measurer = nullptr;
+        juce::uint32 lastAudioWindowRead[maxNumChannels] = {};
+        juce::uint32 lastMidiWindowRead = 0;
+        std::atomic<bool> clearOverload { true };
     };
 
     //==============================================================================
@@ -90,14 +94,38 @@ public:
     float getLevelCache() const noexcept                { return levelCache; }
 
 private:
+    //==============================================================================
+    struct Window
+    {
+        std::atomic<float> audio[Client::maxNumChannels];
+        std::atomic<float> midi;
+        std::atomic<juce::uint32> time;
+    };
+
+    static constexpr juce::uint32 numWindows = 32;
+    static constexpr juce::uint32 windowLengthMs = 5;
+
     Mode mode = peakMode;
-    int numActiveChannels = 1;
+    std::atomic<int> numActiveChannels { 1 };
     bool showMidi = false;
     float levelCache = -100.0f;
 
+    Window windows[numWindows];
+    std::atomic<juce::uint32> numWindowsPublished { 0 }, lastPublishTime { 0 };
+    std::atomic<float> pendingAudio[Client::maxNumChannels], pendingMidi;
+
+    // The last few samples of each channel, so true peaks can be found across block boundaries
+    float truePeakHistory[Client::maxNumChannels][3] = {};
+
     juce::Array<Client*> clients;
+    std::atomic<int> numClients { 0 };
     juce::CriticalSection clientsMutex;
 
+    void addLevels (const float* gains, int numChannels) noexcept;
+    void addMidiLevel (float gain) noexcept;
+    void publishIfDue() noexcept;
+    DbTimePair getLevelSince (juce::uint32& lastWindowRead, int channel) noexcept;
+
     JUCE_DECLARE_WEAK_REFERENCEABLE(LevelMeasurer)
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LevelMeasurer)
 };
@@ -12,12 +12,35 @@ namespace tracktion_engine
 {
 
 MidiNoteDispatcher::MidiNoteDispatcher()
+    : Thread ("MIDI output")
 {
 }
 
 MidiNoteDispatcher::~MidiNoteDispatcher()
 {
-    stopTimer();
+    stopThread (1000);
+}
+
+void MidiNoteDispatcher::DeviceState::addMessages (MidiMessageArray& buffer) noexcept
+{
+    if (buffer.isAllNotesOff)
+    {
+        allNotesOffPending = true;
+        buffer.clear();
+        return;
+    }
+
+    int start1, size1, start2, size2;
+    fifo.prepareToWrite (buffer.size(), start1, size1, start2, size2);
+
+    for (int i = 0; i < size1; ++i)
+        messages[(size_t) (start1 + i)] = buffer[i];
+
+    for (int i = 0; i < size2; ++i)
+        messages[(size_t) (start2 + i)] = buffer[size1 + i];
+
+    fifo.finishedWrite (size1 + size2);
+    buffer.clear();
 }
 
 void MidiNoteDispatcher::nextBlockStarted (PlayHead& playhead, EditTimeRange streamTime, int blockSize)
@@ -31,27 +54,27 @@ void MidiNoteDispatcher::nextBlockStarted (PlayHead& playhead, EditTimeRange str
         state->device->context.masterLevels.processMidi (buffer, nullptr);
         
         if (! state->device->sendMessages (playhead, buffer, streamTime - delay))
-            state->buffer.mergeFromAndClear (buffer);
+            state->addMessages (buffer);
     }
 }
 
 void MidiNoteDispatcher::masterTimeUpdate (PlayHead& playhead, double streamTime)
 {
-    const ScopedLock s (timeLock);
+    const SpinLock::ScopedLockType s (timeLock);
     masterTime = playhead.streamTimeToSourceTime (streamTime);
     hiResClockOfMasterTime = Time::getMillisecondCounterHiRes();
 }
 
 void MidiNoteDispatcher::prepareToPlay (PlayHead& playhead, double start)
 {
-    const ScopedLock s (timeLock);
+    const SpinLock::ScopedLockType s (timeLock);
     masterTime = playhead.streamTimeToSourceTime (start);
     hiResClockOfMasterTime = Time::getMillisecondCounterHiRes();
 }
 
 double MidiNoteDispatcher::getCurrentTime() const
 {
-    const ScopedLock s (timeLock);
+    const SpinLock::ScopedLockType s (timeLock);
     return masterTime + (Time::getMillisecondCounterHiRes() - hiResClockOfMasterTime) * 0.001;
 }
 
@@ -64,74 +87,83 @@ void MidiNoteDispatcher::setMidiDeviceList (const OwnedArray<MidiOutputDeviceIns
         newDevices.add (new DeviceState (d));
 
     if (newList.isEmpty())
-        stopTimer();
+        stopThread (1000);
 
-    bool startTimerFlag = false;
+    bool startThreadFlag = false;
 
     {
         const ScopedLock sl (deviceLock);
+        const ScopedLock sl2 (outputLock);
         newDevices.swapWith (devices);
-        startTimerFlag = ! devices.isEmpty();
+        startThreadFlag = ! devices.isEmpty();
     }
 
-    if (startTimerFlag)
-        startTimer (1);
+    if (startThreadFlag)
+        startThread (9); // Just below the audio thread
 }
 
-void MidiNoteDispatcher::hiResTimerCallback()
+double MidiNoteDispatcher::sendDueMessages()
 {
-    struct MessageToSend
-    {
-        MidiOutputDeviceInstance* device;
-        MidiMessage message;
-    };
-
-    Array<MessageToSend> messagesToSend;
-    messagesToSend.ensureStorageAllocated (32);
+    const ScopedLock sl (outputLock);
+    const auto currentTime = getCurrentTime();
+    double timeUntilNextMessage = -1.0;
 
+    for (auto d : devices)
     {
-        const ScopedLock sl (deviceLock);
+        auto& fifo = d->fifo;
+        auto& midiOut = d->device->getMidiOutput();
 
-        for (auto d : devices)
+        if (d->allNotesOffPending.exchange (false))
         {
-            auto* device = d->device;
-            auto& buffer = d->buffer;
-            auto& midiOut = device->getMidiOutput();
+            fifo.finishedRead (fifo.getNumReady());
+            midiOut.sendNoteOffMessages();
+            continue;
+        }
+
+        while (fifo.getNumReady() > 0)
+        {
+            int start1, size1, start2, size2;
+            fifo.prepareToRead (1, start1, size1, start2, size2);
+            auto& message = d->messages[(size_t) (size1 > 0 ? start1 : start2)];
+            auto noteTime = message.getTimeStamp();
 
-            if (buffer.isAllNotesOff)
+            if (noteTime > currentTime + 0.2)
             {
-                buffer.clear();
-                midiOut.sendNoteOffMessages();
+                fifo.finishedRead (1);
+            }
+            else if (noteTime <= currentTime)
+            {
+                midiOut.fireMessage (message);
+                fifo.finishedRead (1);
             }
             else
             {
-                while (buffer.isNotEmpty())
-                {
-                    auto& message = buffer[0];
-
-                    auto noteTime = message.getTimeStamp();
-                    auto currentTime = getCurrentTime();
-
-                    if (noteTime > currentTime + 0.2)
-                    {
-                        buffer.remove (0);
-                    }
-                    else if (noteTime <= currentTime)
-                    {
-                        messagesToSend.add ({ device, message });
-                        buffer.remove (0);
-                    }
-                    else
-                    {
-                        break;
-                    }
-                }
+                auto timeUntilMessage = noteTime - currentTime;
+
+                if (timeUntilNextMessage < 0 || timeUntilMessage < timeUntilNextMessage)
+                    timeUntilNextMessage = timeUntilMessage;
+
+                break;
             }
         }
     }
 
-    for (auto& m : messagesToSend)
-        m.device->getMidiOutput().fireMessage (m.message);
+    return timeUntilNextMessage;
+}
+
+void MidiNoteDispatcher::run()
+{
+    while (! threadShouldExit())
+    {
+        auto timeUntilNextMessage = sendDueMessages();
+
+        // New messages can arrive at any time so this never sleeps for more than a
+        // millisecond, and if one's due sooner than that it waits for it without sleeping
+        if (timeUntilNextMessage >= 0 && timeUntilNextMessage < 0.001)
+            Thread::yield();
+        else
+            wait (1);
+    }
 }
 
 }
@@ -11,7 +11,15 @@
 namespace tracktion_engine
 {
 
-class MidiNoteDispatcher   : private juce::HighResolutionTimer
+/**
+    Sends the MIDI generated by the audio thread to the MIDI output devices at the
+    times it's due.
+
+    Each device has a lock-free FIFO that the audio thread adds its messages to and
+    a background thread takes them out of and sends them as they become due, so the
+    audio thread never has to wait for the output thread.
+*/
+class MidiNoteDispatcher   : private juce::Thread
 {
 public:
     MidiNoteDispatcher();
@@ -24,25 +32,37 @@ public:
     void masterTimeUpdate (PlayHead& playhead, double streamTime);
     void prepareToPlay (PlayHead& playhead, double start);
 
-    void hiResTimerCallback() override;
-
 private:
     //==============================================================================
     struct DeviceState
     {
         DeviceState (MidiOutputDeviceInstance* d) : device (d) {}
 
+        /** Called by the audio thread. Any messages that don't fit in the FIFO are dropped. */
+        void addMessages (MidiMessageArray&) noexcept;
+
         MidiOutputDeviceInstance* device;
-        MidiMessageArray buffer;
+
+        enum { fifoSize = 2048 };
+        juce::AbstractFifo fifo { fifoSize };
+        std::vector<juce::MidiMessage> messages = std::vector<juce::MidiMessage> ((size_t) fifoSize);
+        std::atomic<bool> allNotesOffPending { false };
     };
 
     //==============================================================================
     juce::OwnedArray<DeviceState> devices;
-    juce::CriticalSection timeLock, deviceLock;
+    juce::CriticalSection deviceLock, outputLock;
+    juce::SpinLock timeLock;
     double masterTime = 0, hiResClockOfMasterTime = 0;
 
     double getCurrentTime() const;
 
+    /** Sends any messages that are due, returning the number of seconds until the next
+        one is, or -1 if there aren't any waiting.
+    */
+    double sendDueMessages();
+    void run() override;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MidiNoteDispatcher)
 };
 
@@ -218,6 +218,45 @@ public:
         playoutSyncTime = juce::jmin (t, playRange.end);
     }
 
+    //==============================================================================
+    static constexpr int maxNumJumpTargets = 7;
+
+    /** Sets some times that the playhead is likely to be moved to, such as the markers around
+        it, so anything that's playing can get ready for a jump there.
+        The loop start doesn't need to be included, as getLikelyJumpTargets() adds it.
+    */
+    void setLikelyJumpTargets (const juce::Array<double>& times) noexcept
+    {
+        auto num = std::min (times.size(), (int) maxNumJumpTargets);
+
+        // A reader might see a mixture of the old and new times, but they're only hints
+        numJumpTargets = std::min (num, numJumpTargets.load());
+
+        for (int i = 0; i < num; ++i)
+            jumpTargets[i] = times.getUnchecked (i);
+
+        numJumpTargets = num;
+    }
+
+    /** Fills the array with the times the playhead is likely to be moved to, and returns
+        how many there are. This is safe to call from the audio thread.
+    */
+    int getLikelyJumpTargets (double (&dest)[maxNumJumpTargets + 1]) const noexcept
+    {
+        int num = 0;
+
+        if (looping.load (std::memory_order_relaxed) || rollInToLoop.load (std::memory_order_relaxed))
+        {
+            const juce::ScopedLock sl (lock);
+            dest[num++] = playRange.start;
+        }
+
+        for (int i = 0; i < numJumpTargets.load(); ++i)
+            dest[num++] = jumpTargets[i].load();
+
+        return num;
+    }
+
     //==============================================================================
     /** called by the DeviceManager */
     void deviceManagerPositionUpdate (double newTime, double newTimeEnd)
@@ -239,6 +278,8 @@ private:
     juce::Time userInteractionTime;
     juce::CriticalSection lock;
     std::atomic<bool> looping { false }, userDragging { false }, rollInToLoop { false };
+    std::atomic<double> jumpTargets[maxNumJumpTargets];
+    std::atomic<int> numJumpTargets { 0 };
 
     /** the length of the small looped blocks to play while scrubbing */
     static constexpr double getScrubbingBlockLengthSeconds()      { return 0.08; }
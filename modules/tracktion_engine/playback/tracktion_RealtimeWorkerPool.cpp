@@ -0,0 +1,237 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+struct RealtimeWorkerPool::WorkerThread  : public Thread
+{
+    WorkerThread (RealtimeWorkerPool& p, int threadIndex)
+       : Thread ("mixer"), owner (p), index (threadIndex)
+    {
+        startThread (Thread::realtimeAudioPriority);
+    }
+
+    ~WorkerThread() override
+    {
+        stopThread (5000);
+    }
+
+    void run() override
+    {
+        FloatVectorOperations::disableDenormalisedNumberSupport();
+
+        // The buffer's allocated after pinning so it's in the node's memory
+        if (owner.numaAware)
+        {
+            auto& topology = tracktion_graph::NumaTopology::getSystemTopology();
+            topology.setCurrentThreadAffinity ((size_t) index % topology.getNumNodes());
+        }
+
+        buffer.setSize (2, 1024);
+
+        while (! threadShouldExit())
+        {
+            if (! owner.performNextJob (buffer))
+                wait (1000);
+        }
+    }
+
+private:
+    RealtimeWorkerPool& owner;
+    const int index;
+    juce::AudioBuffer<float> buffer;
+};
+
+//==============================================================================
+RealtimeWorkerPool::RealtimeWorkerPool()
+    : maxNumThreads (jmax (0, SystemStats::getNumCpus() - 1))
+{
+    // These are added to on the audio thread so make sure there's room to avoid allocating
+    operations.ensureStorageAllocated (64);
+    owners.reserve (64);
+}
+
+RealtimeWorkerPool::~RealtimeWorkerPool()
+{
+    jassert (operations.isEmpty());
+    threads.clear();
+}
+
+void RealtimeWorkerPool::addOperation (Operation& op)
+{
+    {
+        const ScopedLock sl (lock);
+        operations.add (&op);
+
+        if (auto state = getOwnerState (op.owner))
+        {
+            ++state->numOperations;
+        }
+        else
+        {
+            OwnerState newState;
+            newState.owner = op.owner;
+            newState.numOperations = 1;
+            owners.push_back (newState);
+        }
+    }
+
+    for (auto thread : threads)
+        thread->notify();
+}
+
+void RealtimeWorkerPool::removeOperation (Operation& op)
+{
+    const ScopedLock sl (lock);
+    operations.removeFirstMatchingValue (&op);
+
+    if (auto state = getOwnerState (op.owner))
+        --state->numOperations;
+
+    removeOwnerIfUnused (op.owner);
+}
+
+//==============================================================================
+void RealtimeWorkerPool::setNumThreads (int num)
+{
+    numThreadsRequested = num;
+    updateThreads();
+}
+
+int RealtimeWorkerPool::getNumThreads() const
+{
+    return threads.size();
+}
+
+void RealtimeWorkerPool::setMaxNumThreads (int num)
+{
+    maxNumThreads = jmax (0, num);
+    updateThreads();
+}
+
+int RealtimeWorkerPool::getMaxNumThreads() const
+{
+    return maxNumThreads;
+}
+
+void RealtimeWorkerPool::setNumaAware (bool shouldBeNumaAware)
+{
+    if (numaAware == shouldBeNumaAware)
+        return;
+
+    {
+        const ScopedLock sl (lock);
+        threads.clear();
+        numaAware = shouldBeNumaAware;
+    }
+
+    updateThreads();
+}
+
+void RealtimeWorkerPool::updateThreads()
+{
+    const int num = jlimit (0, maxNumThreads, numThreadsRequested);
+
+    if (threads.size() != num)
+    {
+        const ScopedLock sl (lock);
+
+        threads.clear();
+
+        while (threads.size() < num)
+            threads.add (new WorkerThread (*this, threads.size()));
+    }
+}
+
+//==============================================================================
+bool RealtimeWorkerPool::performNextJob (juce::AudioBuffer<float>& buffer)
+{
+    Operation* op = nullptr;
+    int jobIndex = -1;
+
+    {
+        const ScopedLock sl (lock);
+
+        // Try the owners with the fewest threads working for them first
+        uint64 ownersTried = 0;
+        const int numOwners = jmin ((int) owners.size(), 64);
+        jassert ((int) owners.size() <= 64);
+
+        while (op == nullptr)
+        {
+            int ownerIndex = -1;
+
+            for (int i = 0; i < numOwners; ++i)
+                if ((ownersTried & ((uint64) 1 << i)) == 0
+                     && (ownerIndex < 0 || owners[(size_t) i].numActiveThreads < owners[(size_t) ownerIndex].numActiveThreads))
+                    ownerIndex = i;
+
+            if (ownerIndex < 0)
+                return false;
+
+            ownersTried |= (uint64) 1 << ownerIndex;
+            auto& state = owners[(size_t) ownerIndex];
+
+            for (auto o : operations)
+            {
+                if (o->owner == state.owner)
+                {
+                    jobIndex = o->popNextJob();
+
+                    if (jobIndex >= 0)
+                    {
+                        op = o;
+                        ++state.numActiveThreads;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+
+    // The Operation may be removed as soon as this returns so only use the owner after it
+    auto opOwner = op->owner;
+
+    {
+        TRACKTION_REALTIME_ALLOCATION_CHECK
+        op->performJob (jobIndex, buffer);
+    }
+
+    const ScopedLock sl (lock);
+
+    if (auto state = getOwnerState (opOwner))
+        --state->numActiveThreads;
+
+    removeOwnerIfUnused (opOwner);
+
+    return true;
+}
+
+RealtimeWorkerPool::OwnerState* RealtimeWorkerPool::getOwnerState (const void* owner)
+{
+    for (auto& state : owners)
+        if (state.owner == owner)
+            return &state;
+
+    return {};
+}
+
+void RealtimeWorkerPool::removeOwnerIfUnused (const void* owner)
+{
+    owners.erase (std::remove_if (owners.begin(), owners.end(),
+                                  [owner] (const OwnerState& state)
+                                  {
+                                      return state.owner == owner && state.numOperations <= 0 && state.numActiveThreads <= 0;
+                                  }),
+                  owners.end());
+}
+
+}
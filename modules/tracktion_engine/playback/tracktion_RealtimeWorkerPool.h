@@ -0,0 +1,109 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+/**
+    A pool of realtime priority threads that help the audio thread render in parallel.
+
+    There's one of these for each Engine, accessed via Engine::getRealtimeWorkerPool(),
+    so separate Engines in the same process don't contend for the same threads.
+
+    Work is added as Operations, each of which has an owner, usually the Edit it's
+    rendering. When several Operations are running at once, free threads are given to
+    the owner with the fewest threads currently working for it so a single busy
+    Edit can't starve the others.
+*/
+class RealtimeWorkerPool
+{
+public:
+    RealtimeWorkerPool();
+    ~RealtimeWorkerPool();
+
+    //==============================================================================
+    /** A set of jobs that can be performed concurrently by the pool's threads.
+
+        The thread that adds an Operation should also pop and perform jobs until there
+        are none left and then wait for any still being performed by the pool's threads
+        before removing it.
+    */
+    struct Operation
+    {
+        Operation (const void* ownerOfOperation) : owner (ownerOfOperation) {}
+        virtual ~Operation() = default;
+
+        /** Returns the index of the next job to perform or -1 if they've all been started.
+            This must be thread safe and quick as it's called with the pool's lock held.
+        */
+        virtual int popNextJob() = 0;
+
+        /** Performs one of the jobs returned by popNextJob.
+            The Operation can be removed as soon as the last job has finished.
+        */
+        virtual void performJob (int jobIndex, juce::AudioBuffer<float>& scratchBuffer) = 0;
+
+        /** Threads are shared fairly between the different owners. */
+        const void* const owner;
+    };
+
+    /** Adds an Operation for the threads to help with. */
+    void addOperation (Operation&);
+
+    /** Removes an Operation. None of its jobs must still be being performed. */
+    void removeOperation (Operation&);
+
+    //==============================================================================
+    /** Sets the number of threads to use, this is limited by the maximum number of threads. */
+    void setNumThreads (int);
+
+    /** Returns the number of threads currently running. */
+    int getNumThreads() const;
+
+    /** Sets a cap on the number of threads.
+        By default this is one less than the number of CPUs as the audio thread renders too.
+    */
+    void setMaxNumThreads (int);
+
+    /** Returns the cap on the number of threads. */
+    int getMaxNumThreads() const;
+
+    /** Pins each thread to one of the machine's NUMA nodes, in turn, so its scratch buffer
+        is in that node's memory. This does nothing on a machine with a single node.
+        @see EngineBehaviour::shouldUseNumaAwareProcessing
+    */
+    void setNumaAware (bool);
+
+private:
+    struct WorkerThread;
+    friend struct WorkerThread;
+
+    struct OwnerState
+    {
+        const void* owner = nullptr;
+        int numOperations = 0, numActiveThreads = 0;
+    };
+
+    juce::CriticalSection lock;
+    juce::OwnedArray<WorkerThread> threads;
+    juce::Array<Operation*> operations;
+    std::vector<OwnerState> owners;
+    int numThreadsRequested = 0, maxNumThreads = 0;
+    bool numaAware = false;
+
+    bool performNextJob (juce::AudioBuffer<float>&);
+    OwnerState* getOwnerState (const void*);
+    void removeOwnerIfUnused (const void*);
+    void updateThreads();
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RealtimeWorkerPool)
+};
+
+} // namespace tracktion_engine
@@ -0,0 +1,464 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+
+namespace tracktion_engine
+{
+
+namespace ReplayHarnessHelpers
+{
+    static const char* getTypeName (ReplayHarness::Event::Type t)
+    {
+        switch (t)
+        {
+            case ReplayHarness::Event::Type::play:          return "play";
+            case ReplayHarness::Event::Type::stop:          return "stop";
+            case ReplayHarness::Event::Type::setPosition:   return "setPosition";
+            case ReplayHarness::Event::Type::midi:          return "midi";
+            case ReplayHarness::Event::Type::parameter:     return "parameter";
+            default:                                        jassertfalse; return "";
+        }
+    }
+
+    static ReplayHarness::Event::Type getTypeForName (const juce::String& name)
+    {
+        for (auto t : { ReplayHarness::Event::Type::play, ReplayHarness::Event::Type::stop,
+                        ReplayHarness::Event::Type::setPosition, ReplayHarness::Event::Type::midi,
+                        ReplayHarness::Event::Type::parameter })
+            if (name == getTypeName (t))
+                return t;
+
+        jassertfalse;
+        return ReplayHarness::Event::Type::play;
+    }
+
+    static constexpr juce::uint64 fnvOffsetBasis = 14695981039346656037ull;
+    static constexpr juce::uint64 fnvPrime = 1099511628211ull;
+
+    /** FNV-1a over the bit patterns of the samples, so any change at all shows up. */
+    static juce::uint64 hashBuffer (const juce::AudioBuffer<float>& buffer) noexcept
+    {
+        auto hash = fnvOffsetBasis;
+
+        for (int chan = 0; chan < buffer.getNumChannels(); ++chan)
+        {
+            auto* data = buffer.getReadPointer (chan);
+
+            for (int i = 0; i < buffer.getNumSamples(); ++i)
+            {
+                juce::uint32 bits;
+                std::memcpy (&bits, data + i, sizeof (bits));
+                hash = (hash ^ bits) * fnvPrime;
+            }
+        }
+
+        return hash;
+    }
+
+    static double ticksToMs (juce::int64 ticks)
+    {
+        return juce::Time::highResolutionTicksToSeconds (ticks) * 1000.0;
+    }
+}
+
+//==============================================================================
+void ReplayHarness::Script::addEvent (const Event& e)
+{
+    // Events at the same position stay in the order they were added
+    int index = 0;
+
+    while (index < events.size() && events.getReference (index).samplePosition <= e.samplePosition)
+        ++index;
+
+    events.insert (index, e);
+}
+
+void ReplayHarness::Script::addPlay (juce::int64 samplePosition)
+{
+    Event e;
+    e.type = Event::Type::play;
+    e.samplePosition = samplePosition;
+    addEvent (e);
+}
+
+void ReplayHarness::Script::addStop (juce::int64 samplePosition)
+{
+    Event e;
+    e.type = Event::Type::stop;
+    e.samplePosition = samplePosition;
+    addEvent (e);
+}
+
+void ReplayHarness::Script::addSetPosition (juce::int64 samplePosition, double newTime)
+{
+    Event e;
+    e.type = Event::Type::setPosition;
+    e.samplePosition = samplePosition;
+    e.time = newTime;
+    addEvent (e);
+}
+
+void ReplayHarness::Script::addMidi (juce::int64 samplePosition, const juce::MidiMessage& message)
+{
+    Event e;
+    e.type = Event::Type::midi;
+    e.samplePosition = samplePosition;
+    e.message = message;
+    addEvent (e);
+}
+
+void ReplayHarness::Script::addParameterChange (juce::int64 samplePosition, AutomatableParameter& param, float newValue)
+{
+    Event e;
+    e.type = Event::Type::parameter;
+    e.samplePosition = samplePosition;
+    e.parameterOwnerID = param.getOwnerID();
+    e.parameterID = param.paramID;
+    e.value = newValue;
+    addEvent (e);
+}
+
+juce::ValueTree ReplayHarness::Script::toValueTree() const
+{
+    juce::ValueTree v ("REPLAYSCRIPT");
+    v.setProperty ("sampleRate", sampleRate, nullptr);
+    v.setProperty ("blockSize", blockSize, nullptr);
+    v.setProperty ("length", lengthInSamples, nullptr);
+    v.setProperty ("inputs", numInputChannels, nullptr);
+    v.setProperty ("outputs", numOutputChannels, nullptr);
+
+    for (auto& e : events)
+    {
+        juce::ValueTree ev ("EVENT");
+        ev.setProperty ("type", ReplayHarnessHelpers::getTypeName (e.type), nullptr);
+        ev.setProperty ("position", e.samplePosition, nullptr);
+
+        if (e.type == Event::Type::setPosition)
+        {
+            ev.setProperty ("time", e.time, nullptr);
+        }
+        else if (e.type == Event::Type::midi)
+        {
+            ev.setProperty ("data", juce::MemoryBlock (e.message.getRawData(), (size_t) e.message.getRawDataSize()).toBase64Encoding(), nullptr);
+        }
+        else if (e.type == Event::Type::parameter)
+        {
+            ev.setProperty ("owner", e.parameterOwnerID.toString(), nullptr);
+            ev.setProperty ("param", e.parameterID, nullptr);
+            ev.setProperty ("value", e.value, nullptr);
+        }
+
+        v.appendChild (ev, nullptr);
+    }
+
+    return v;
+}
+
+ReplayHarness::Script ReplayHarness::Script::fromValueTree (const juce::ValueTree& v)
+{
+    Script s;
+    s.sampleRate = v.getProperty ("sampleRate", s.sampleRate);
+    s.blockSize = v.getProperty ("blockSize", s.blockSize);
+    s.lengthInSamples = v.getProperty ("length", s.lengthInSamples);
+    s.numInputChannels = v.getProperty ("inputs", s.numInputChannels);
+    s.numOutputChannels = v.getProperty ("outputs", s.numOutputChannels);
+
+    for (const auto& ev : v)
+    {
+        Event e;
+        e.type = ReplayHarnessHelpers::getTypeForName (ev.getProperty ("type").toString());
+        e.samplePosition = ev.getProperty ("position");
+        e.time = ev.getProperty ("time");
+        e.parameterOwnerID = EditItemID::fromVar (ev.getProperty ("owner"));
+        e.parameterID = ev.getProperty ("param").toString();
+        e.value = ev.getProperty ("value");
+
+        if (e.type == Event::Type::midi)
+        {
+            juce::MemoryBlock data;
+            data.fromBase64Encoding (ev.getProperty ("data").toString());
+
+            if (data.getSize() > 0)
+                e.message = juce::MidiMessage (data.getData(), (int) data.getSize());
+        }
+
+        s.events.add (e);
+    }
+
+    return s;
+}
+
+//==============================================================================
+double ReplayHarness::Results::getTotalTimeMs() const
+{
+    return std::accumulate (blockTimesMs.begin(), blockTimesMs.end(), 0.0);
+}
+
+double ReplayHarness::Results::getMeanBlockTimeMs() const
+{
+    return blockTimesMs.empty() ? 0.0 : getTotalTimeMs() / (double) blockTimesMs.size();
+}
+
+double ReplayHarness::Results::getPercentileBlockTimeMs (double proportion) const
+{
+    if (blockTimesMs.empty())
+        return 0.0;
+
+    auto sorted = blockTimesMs;
+    std::sort (sorted.begin(), sorted.end());
+    auto index = (size_t) juce::jlimit (0.0, (double) sorted.size() - 1.0, std::ceil (proportion * (double) sorted.size()) - 1.0);
+
+    return sorted[index];
+}
+
+bool ReplayHarness::Results::isBitIdenticalTo (const Results& other) const
+{
+    return outputHash == other.outputHash && blockHashes == other.blockHashes;
+}
+
+int ReplayHarness::Results::getFirstDifferentBlock (const Results& other) const
+{
+    const auto num = std::min (blockHashes.size(), other.blockHashes.size());
+
+    for (size_t i = 0; i < num; ++i)
+        if (blockHashes[i] != other.blockHashes[i])
+            return (int) i;
+
+    return blockHashes.size() != other.blockHashes.size() ? (int) num : -1;
+}
+
+juce::String ReplayHarness::Results::toString() const
+{
+    juce::String s;
+    s << (int) blockTimesMs.size() << " blocks in " << juce::String (getTotalTimeMs(), 2) << " ms"
+      << ", mean " << juce::String (getMeanBlockTimeMs(), 4) << " ms"
+      << ", 99th percentile " << juce::String (getPercentileBlockTimeMs (0.99), 4) << " ms"
+      << ", max " << juce::String (getPercentileBlockTimeMs (1.0), 4) << " ms"
+      << ", output hash " << juce::String::toHexString ((juce::int64) outputHash);
+
+    if (numEventsSkipped > 0)
+        s << ", " << numEventsSkipped << " events skipped";
+
+    return s;
+}
+
+juce::String ReplayHarness::Results::compare (const Results& baseline) const
+{
+    auto percentChange = [] (double now, double before)
+    {
+        if (before <= 0.0)
+            return juce::String ("n/a");
+
+        auto change = (now - before) * 100.0 / before;
+        return (change >= 0.0 ? "+" : "") + juce::String (change, 1) + "%";
+    };
+
+    juce::String s;
+    s << "Baseline: " << baseline.toString() << juce::newLine
+      << "Current:  " << toString() << juce::newLine
+      << "Total time " << percentChange (getTotalTimeMs(), baseline.getTotalTimeMs())
+      << ", mean " << percentChange (getMeanBlockTimeMs(), baseline.getMeanBlockTimeMs())
+      << ", 99th percentile " << percentChange (getPercentileBlockTimeMs (0.99), baseline.getPercentileBlockTimeMs (0.99))
+      << juce::newLine;
+
+    const auto firstDifferent = getFirstDifferentBlock (baseline);
+
+    if (firstDifferent < 0)
+        s << "Output is bit-identical";
+    else
+        s << "Output differs, starting at block " << firstDifferent;
+
+    return s;
+}
+
+//==============================================================================
+ReplayHarness::ReplayHarness (Edit& e)
+    : edit (e)
+{
+}
+
+ReplayHarness::Results ReplayHarness::run (const Script& script)
+{
+    CRASH_TRACER
+    jassert (script.blockSize > 0 && script.sampleRate > 0.0);
+
+    auto& deviceManager = edit.engine.getDeviceManager();
+    auto& audioIO = deviceManager.getHostedAudioDeviceInterface();
+
+    HostedAudioDeviceInterface::Parameters params;
+    params.sampleRate = script.sampleRate;
+    params.blockSize = script.blockSize;
+    params.inputChannels = script.numInputChannels;
+    params.outputChannels = script.numOutputChannels;
+    params.useMidiDevices = false;
+    params.fixedBlockSize = true;
+
+    audioIO.initialise (params);
+    audioIO.prepareToPlay (params.sampleRate, params.blockSize);
+
+    // A new context picks up the hosted devices and starts from a freshly built graph
+    auto& transport = edit.getTransport();
+    transport.stop (false, false);
+    transport.freePlaybackContext();
+    transport.ensureContextAllocated (true);
+
+    Results results;
+    auto* context = transport.getCurrentPlaybackContext();
+
+    if (context == nullptr)
+    {
+        jassertfalse;
+        results.numEventsSkipped = script.events.size();
+        return results;
+    }
+
+    auto& playhead = context->playhead;
+    playhead.stop();
+    playhead.setPosition (0.0);
+
+    const auto allParams = edit.getAllAutomatableParams (true);
+    const auto numBlocks = (size_t) ((script.lengthInSamples + script.blockSize - 1) / script.blockSize);
+    results.blockTimesMs.reserve (numBlocks);
+    results.blockHashes.reserve (numBlocks);
+
+    juce::AudioBuffer<float> buffer (std::max (script.numInputChannels, script.numOutputChannels), script.blockSize);
+    juce::MidiBuffer midi;
+    int nextEvent = 0;
+    results.outputHash = ReplayHarnessHelpers::fnvOffsetBasis;
+
+    for (juce::int64 blockStart = 0; blockStart < script.lengthInSamples; blockStart += script.blockSize)
+    {
+        const auto blockEnd = blockStart + script.blockSize;
+        buffer.clear();
+        midi.clear();
+
+        for (; nextEvent < script.events.size(); ++nextEvent)
+        {
+            auto& e = script.events.getReference (nextEvent);
+
+            if (e.samplePosition >= blockEnd)
+                break;
+
+            if (e.type == Event::Type::midi)
+                midi.addEvent (e.message, (int) std::max ((juce::int64) 0, e.samplePosition - blockStart));
+            else if (! applyEvent (e, *context, allParams))
+                ++results.numEventsSkipped;
+        }
+
+        const auto startTicks = juce::Time::getHighResolutionTicks();
+        audioIO.processBlock (buffer, midi);
+        const auto endTicks = juce::Time::getHighResolutionTicks();
+
+        const auto hash = ReplayHarnessHelpers::hashBuffer (buffer);
+        results.blockTimesMs.push_back (ReplayHarnessHelpers::ticksToMs (endTicks - startTicks));
+        results.blockHashes.push_back (hash);
+        results.outputHash = (results.outputHash ^ hash) * ReplayHarnessHelpers::fnvPrime;
+    }
+
+    results.numEventsSkipped += script.events.size() - nextEvent;
+    playhead.stop();
+
+    return results;
+}
+
+void ReplayHarness::releaseDevice()
+{
+    auto& deviceManager = edit.engine.getDeviceManager();
+    edit.getTransport().freePlaybackContext();
+    deviceManager.closeDevices();
+    deviceManager.removeHostedAudioDeviceInterface();
+    deviceManager.deviceManager.closeAudioDevice();
+}
+
+bool ReplayHarness::applyEvent (const Event& e, EditPlaybackContext& context,
+                                const juce::Array<AutomatableParameter*>& params)
+{
+    switch (e.type)
+    {
+        case Event::Type::play:         context.playhead.play(); return true;
+        case Event::Type::stop:         context.playhead.stop(); return true;
+        case Event::Type::setPosition:  context.playhead.setPosition (e.time); return true;
+
+        case Event::Type::parameter:
+            for (auto p : params)
+            {
+                if (p->paramID == e.parameterID && p->getOwnerID() == e.parameterOwnerID)
+                {
+                    p->setParameter (e.value, juce::dontSendNotification);
+                    return true;
+                }
+            }
+
+            return false;
+
+        case Event::Type::midi:
+        default:
+            return false;
+    }
+}
+
+//==============================================================================
+#if TRACKTION_UNIT_TESTS
+
+class ReplayHarnessTests    : public juce::UnitTest
+{
+public:
+    ReplayHarnessTests()
+        : juce::UnitTest ("ReplayHarness", "Tracktion:Longer") {}
+
+    void runTest() override
+    {
+        auto& engine = *Engine::getEngines()[0];
+        auto edit = std::make_unique<Edit> (Edit::Options { engine, createEmptyEdit (engine), ProjectItemID::createNewID (0) });
+
+        ReplayHarness::Script script;
+        script.sampleRate = 44100.0;
+        script.blockSize = 256;
+        script.lengthInSamples = 44100;
+        script.addPlay (0);
+        script.addMidi (1000, juce::MidiMessage::noteOn (1, 60, 0.8f));
+        script.addSetPosition (20000, 0.5);
+        script.addStop (40000);
+        script.addMidi (1100, juce::MidiMessage::noteOff (1, 60));
+
+        beginTest ("Scripts stay sorted and survive saving");
+        {
+            expectEquals (script.events.size(), 5);
+            expect (std::is_sorted (script.events.begin(), script.events.end(),
+                                    [] (auto& a, auto& b) { return a.samplePosition < b.samplePosition; }));
+
+            auto reloaded = ReplayHarness::Script::fromValueTree (script.toValueTree());
+            expectEquals (reloaded.events.size(), script.events.size());
+            expect (reloaded.events[1].message.isNoteOn());
+            expectEquals (reloaded.events[3].time, 0.5);
+        }
+
+        beginTest ("Replays are bit-identical");
+        {
+            ReplayHarness harness (*edit);
+            auto first = harness.run (script);
+            auto second = harness.run (script);
+
+            expectEquals ((int) first.blockTimesMs.size(), (44100 + 255) / 256);
+            expectEquals (first.numEventsSkipped, 0);
+            expect (second.isBitIdenticalTo (first), second.compare (first));
+
+            harness.releaseDevice();
+        }
+
+        edit.reset();
+    }
+};
+
+static ReplayHarnessTests replayHarnessTests;
+
+#endif
+
+} // namespace tracktion_engine
@@ -0,0 +1,133 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+
+namespace tracktion_engine
+{
+
+/**
+    Plays an Edit through the HostedAudioDeviceInterface with a script of transport moves,
+    MIDI input and parameter changes, timing each block and hashing the output.
+
+    Everything happens on the calling thread, one fixed-size block at a time, so the same
+    script played through the same Edit should always produce exactly the same output. Run
+    it before and after a change to the scheduler, the caches or the DSP, then compare() the
+    two Results to see whether it got faster or slower and whether the output changed at all.
+
+    MIDI is sent to the hosted MIDI input at the exact sample it's scripted for. Transport
+    and parameter events are applied at the start of the block that contains them, which is
+    still repeatable as long as the block size doesn't change.
+
+    This opens the hosted audio device, so it's meant for test and benchmark apps rather
+    than for use alongside real audio devices.
+*/
+class ReplayHarness
+{
+public:
+    //==============================================================================
+    struct Event
+    {
+        enum class Type
+        {
+            play,
+            stop,
+            setPosition,
+            midi,
+            parameter
+        };
+
+        Type type = Type::play;
+        juce::int64 samplePosition = 0;
+
+        double time = 0.0;              /**< The new position for setPosition events. */
+        juce::MidiMessage message;      /**< The message for midi events. */
+        EditItemID parameterOwnerID;    /**< The plugin or other item that owns the parameter for parameter events. */
+        juce::String parameterID;       /**< The AutomatableParameter::paramID for parameter events. */
+        float value = 0.0f;             /**< The new value for parameter events. */
+    };
+
+    /** A list of events and how long to play them for. */
+    struct Script
+    {
+        double sampleRate = 44100.0;
+        int blockSize = 512;
+        juce::int64 lengthInSamples = 0;
+        int numInputChannels = 0, numOutputChannels = 2;
+
+        /** The events, which addEvent() keeps sorted by position. */
+        juce::Array<Event> events;
+
+        void addEvent (const Event&);
+        void addPlay (juce::int64 samplePosition);
+        void addStop (juce::int64 samplePosition);
+        void addSetPosition (juce::int64 samplePosition, double newTime);
+        void addMidi (juce::int64 samplePosition, const juce::MidiMessage&);
+        void addParameterChange (juce::int64 samplePosition, AutomatableParameter&, float newValue);
+
+        /** Saves and loads scripts, e.g. to keep them alongside the Edits they play. */
+        juce::ValueTree toValueTree() const;
+        static Script fromValueTree (const juce::ValueTree&);
+    };
+
+    //==============================================================================
+    /** What happened when a Script was run. */
+    struct Results
+    {
+        /** The time each block took to process, in milliseconds. */
+        std::vector<double> blockTimesMs;
+
+        /** A hash of each block's output. */
+        std::vector<juce::uint64> blockHashes;
+
+        /** A hash of all the output. */
+        juce::uint64 outputHash = 0;
+
+        /** The number of events that couldn't be applied, e.g. parameters that weren't found. */
+        int numEventsSkipped = 0;
+
+        double getTotalTimeMs() const;
+        double getMeanBlockTimeMs() const;
+
+        /** Returns the time that this proportion of the blocks took no longer than, e.g. 0.99. */
+        double getPercentileBlockTimeMs (double proportion) const;
+
+        /** True if every block's output is bit-identical to the other Results. */
+        bool isBitIdenticalTo (const Results&) const;
+
+        /** Returns the index of the first block whose output differs, or -1. */
+        int getFirstDifferentBlock (const Results&) const;
+
+        /** Returns a readable summary of these Results. */
+        juce::String toString() const;
+
+        /** Returns a readable comparison of these Results against some earlier ones. */
+        juce::String compare (const Results& baseline) const;
+    };
+
+    //==============================================================================
+    ReplayHarness (Edit&);
+
+    /** Plays the script from the start and returns the results.
+        The Edit's playback graph is rebuilt first, so each run starts from the same state.
+    */
+    Results run (const Script&);
+
+    /** Closes the hosted audio device again. */
+    void releaseDevice();
+
+private:
+    Edit& edit;
+
+    bool applyEvent (const Event&, EditPlaybackContext&, const juce::Array<AutomatableParameter*>&);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ReplayHarness)
+};
+
+} // namespace tracktion_engine
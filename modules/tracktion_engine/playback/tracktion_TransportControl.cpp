@@ -566,6 +566,20 @@ void TransportControl::editHasChanged()
     engine.getExternalControllerManager().updateAllDevices();
 }
 
+void TransportControl::tracksHaveChanged (const juce::Array<EditItemID>& changedTrackIDs)
+{
+    if (transportState->reallocationInhibitors > 0
+         || playbackContext == nullptr
+         || ! edit.shouldPlay()
+         || ! playbackContext->reallocateTracks (changedTrackIDs, position))
+    {
+        editHasChanged();
+        return;
+    }
+
+    engine.getExternalControllerManager().updateAllDevices();
+}
+
 int TransportControl::isAllowedToReallocate() const noexcept
 {
     return transportState->reallocationInhibitors <= 0;
@@ -856,6 +870,7 @@ void TransportControl::timerCallback()
         if (--loopUpdateCounter == 0)
         {
             loopUpdateCounter = 10;
+            updateLikelyJumpTargets();
 
             if (looping)
             {
@@ -1141,6 +1156,7 @@ void TransportControl::performPlay()
         if (playbackContext)
         {
             playbackContext->playhead.play ({ transportState->startTime, transportState->endTime }, looping);
+            updateLikelyJumpTargets();
 
             if (looping)
             {
@@ -1400,6 +1416,41 @@ void TransportControl::performPositionChange()
     sendMMC (MidiMessage::midiMachineControlGoto (hours, minutes, seconds, frames));
 }
 
+void TransportControl::updateLikelyJumpTargets()
+{
+    if (playbackContext == nullptr)
+        return;
+
+    // The places a user is most likely to jump to whilst playing: back to where playback
+    // started, the start of the Edit and the markers either side
+    Array<double> targets;
+    targets.add (0.0);
+
+    if (transportState->cursorPosAtPlayStart >= 0)
+        targets.addIfNotAlreadyThere (transportState->cursorPosAtPlayStart);
+
+    auto& markerManager = edit.getMarkerManager();
+    auto now = playbackContext->playhead.getPosition();
+
+    if (auto next = markerManager.getNextMarker (now))
+    {
+        targets.addIfNotAlreadyThere (next->getPosition().getStart());
+
+        if (auto afterNext = markerManager.getNextMarker (next->getPosition().getStart()))
+            targets.addIfNotAlreadyThere (afterNext->getPosition().getStart());
+    }
+
+    if (auto prev = markerManager.getPrevMarker (now))
+    {
+        targets.addIfNotAlreadyThere (prev->getPosition().getStart());
+
+        if (auto beforePrev = markerManager.getPrevMarker (prev->getPosition().getStart()))
+            targets.addIfNotAlreadyThere (beforePrev->getPosition().getStart());
+    }
+
+    playbackContext->playhead.setLikelyJumpTargets (targets);
+}
+
 void TransportControl::performRewindButtonChanged()
 {
     const bool isDown = transportState->rewindButtonDown;
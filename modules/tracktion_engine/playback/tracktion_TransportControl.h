@@ -115,6 +115,10 @@ public:
     // Called by edit objects to rebuild the node graph when things change
     void editHasChanged();
 
+    // Called by edit objects when the changes only affect some tracks. If the playback
+    // graph can't be partially rebuilt this falls back to editHasChanged()
+    void tracksHaveChanged (const juce::Array<EditItemID>& changedTrackIDs);
+
     // prevents the nodes being regenerated while one of these exists, e.g. while
     // dragging clips around, etc
     struct ReallocationInhibitor
@@ -212,6 +216,7 @@ private:
     void performStop();
 
     void performPositionChange();
+    void updateLikelyJumpTargets();
     void performRewindButtonChanged();
     void performFastForwardButtonChanged();
     void performNudgeLeft();
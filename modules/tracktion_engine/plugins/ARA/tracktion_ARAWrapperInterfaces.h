@@ -45,6 +45,7 @@ public:
     ~ARADocument()
     {
         CRASH_TRACER
+        analysisProgress->documentDeleted = true;
 
         if (musicalContext != nullptr)
         {
@@ -151,9 +152,65 @@ public:
         }
     }
 
+    //==============================================================================
+    /** Counts the audio sources whose content is still being analysed. This is shared with
+        the background job that shows the analysis progress, which can outlive the document.
+    */
+    struct AnalysisProgress  : public ReferenceCountedObject
+    {
+        std::atomic<int> numAnalysing { 0 }, numStarted { 0 };
+        std::atomic<bool> documentDeleted { false };
+    };
+
+    struct AnalysisJob  : public ThreadPoolJobWithProgress
+    {
+        AnalysisJob (ReferenceCountedObjectPtr<AnalysisProgress> p)
+            : ThreadPoolJobWithProgress (TRANS("Analysing audio") + "..."), progress (std::move (p))
+        {
+        }
+
+        ~AnalysisJob() override
+        {
+            prepareForJobDeletion();
+        }
+
+        JobStatus runJob() override
+        {
+            while (! shouldExit() && ! progress->documentDeleted && progress->numAnalysing > 0)
+                Thread::sleep (100);
+
+            return jobHasFinished;
+        }
+
+        float getCurrentTaskProgress() override
+        {
+            auto numStarted = progress->numStarted.load();
+            return numStarted > 0 ? 1.0f - progress->numAnalysing / (float) numStarted : 1.0f;
+        }
+
+        const ReferenceCountedObjectPtr<AnalysisProgress> progress;
+
+        JUCE_DECLARE_NON_COPYABLE (AnalysisJob)
+    };
+
+    /** Called when an audio source starts being analysed, to show the progress whilst any are. */
+    void analysisStarted()
+    {
+        TRACKTION_ASSERT_MESSAGE_THREAD
+
+        if (analysisProgress->numAnalysing++ == 0)
+        {
+            analysisProgress->numStarted = 0;
+            edit.engine.getBackgroundJobs().addJob (new AnalysisJob (analysisProgress), true);
+        }
+
+        ++analysisProgress->numStarted;
+    }
+
     Edit& edit;
     const ARADocumentControllerInterface* dci;
     ARADocumentControllerRef dcRef;
+    const ReferenceCountedObjectPtr<AnalysisProgress> analysisProgress { new AnalysisProgress() };
     std::unique_ptr<MusicalContextWrapper> musicalContext;
     std::map<Track*, std::unique_ptr<RegionSequenceWrapper>> regionSequences;
     std::map<Track*, int> regionSequencePlaybackRegionCount;
@@ -250,20 +250,62 @@ struct ARAClipPlayer  : private SelectableListener
     void startProcessing()  { TRACKTION_ASSERT_MESSAGE_THREAD if (playbackRegionAndSource != nullptr) playbackRegionAndSource->enable(); }
     void stopProcessing()   { TRACKTION_ASSERT_MESSAGE_THREAD if (playbackRegionAndSource != nullptr) playbackRegionAndSource->disable(); }
 
-    class ContentAnalyser
+    /** Requests the analysis and then polls it on the message thread until it's finished,
+        so the render threads asking whether it's done don't have to wait for the message thread.
+    */
+    class ContentAnalyser  : private Timer
     {
     public:
         ContentAnalyser (const ARAClipPlayer& p)  : pimpl (p)
         {
+            TRACKTION_ASSERT_MESSAGE_THREAD
+            updateAnalysingContent();
+
+            if (analysingContent)
+            {
+                if (auto doc = pimpl.getDocument())
+                {
+                    progress = doc->analysisProgress;
+                    doc->analysisStarted();
+                }
+
+                startTimer (100);
+            }
         }
 
-        bool isAnalysing()
+        ~ContentAnalyser() override
         {
-            callBlocking ([this] { updateAnalysingContent(); });
+            stopTimer();
+            stopCountingProgress();
+        }
 
+        /** This can be called from any thread. */
+        bool isAnalysing() const noexcept
+        {
             return analysingContent;
         }
 
+    private:
+        void timerCallback() override
+        {
+            updateAnalysingContent();
+
+            if (! analysingContent)
+            {
+                stopTimer();
+                stopCountingProgress();
+                pimpl.owner.sendChangeMessage();
+            }
+        }
+
+        void stopCountingProgress()
+        {
+            if (progress != nullptr)
+                --progress->numAnalysing;
+
+            progress = nullptr;
+        }
+
         void updateAnalysingContent()
         {
             CRASH_TRACER
@@ -321,11 +363,11 @@ struct ARAClipPlayer  : private SelectableListener
             }
         }
 
-    private:
         const ARAClipPlayer& pimpl;
         std::vector<ARAContentType> typesBeingAnalyzed;
-        volatile bool analysingContent = false;
+        std::atomic<bool> analysingContent { false };
         bool firstCall = true;
+        ReferenceCountedObjectPtr<ARADocument::AnalysisProgress> progress;
 
         ContentAnalyser() = delete;
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ContentAnalyser)
@@ -337,7 +379,7 @@ struct ARAClipPlayer  : private SelectableListener
 
     bool isAnalysingContent() const
     {
-        return contentAnalyserChecker->isAnalysing();
+        return contentAnalyserChecker != nullptr && contentAnalyserChecker->isAnalysing();
     }
 
     ARADocument* getDocument() const;
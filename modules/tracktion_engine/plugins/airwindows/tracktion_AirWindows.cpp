@@ -142,6 +142,7 @@ AirWindowsPlugin::AirWindowsPlugin (PluginCreationInfo info, std::unique_ptr<Air
 
         addAutomatableParameter (param);
         parameters.add (param);
+        algorithmParameters.add (param);
     }
 
     restorePluginStateFromValueTree (state);
@@ -154,6 +155,9 @@ AirWindowsPlugin::AirWindowsPlugin (PluginCreationInfo info, std::unique_ptr<Air
 
     dryGain->attachToCurrentValue (dryValue);
     wetGain->attachToCurrentValue (wetValue);
+
+    oversamplingFactor.referTo (state, IDs::oversampling, um, 1);
+    oversamplingLinearPhase.referTo (state, IDs::oversamplingLinearPhase, um);
 }
 
 AirWindowsPlugin::~AirWindowsPlugin()
@@ -187,11 +191,46 @@ int AirWindowsPlugin::getNumOutputChannelsGivenInputs (int)
 
 void AirWindowsPlugin::initialise (const PlaybackInitialisationInfo& info)
 {
-    sampleRate = info.sampleRate;
+    useDoublePrecision = engine.getEngineBehaviour().shouldProcessAirWindowsInDoublePrecision();
+
+    const int numChans = jmax (2, impl->getNumOutputs(), impl->getNumInputs());
+    const int factor = Oversampler::isValidFactor (oversamplingFactor) ? oversamplingFactor.get() : 1;
+
+    oversampler.prepare (numChans, factor,
+                         oversamplingLinearPhase ? Oversampler::FilterType::linearPhase
+                                                 : Oversampler::FilterType::minimumPhase,
+                         info.blockSizeSamples, info.sampleRate);
+
+    // The algorithm reads this through the callback, so it sees the oversampled rate
+    sampleRate = info.sampleRate * factor;
+
+    // Allocate the buffers up front so the audio thread doesn't need the AudioScratchBuffer
+    const int maxSamples = info.blockSizeSamples * factor;
+    dryBuffer.setSize (numChans, maxSamples);
+
+    if (useDoublePrecision)
+    {
+        inputBufferDouble.setSize (numChans, maxSamples);
+        outputBufferDouble.setSize (numChans, maxSamples);
+    }
+    else
+    {
+        inputBuffer.setSize (numChans, maxSamples);
+        outputBuffer.setSize (numChans, maxSamples);
+    }
+
+    lastDry = dryGain->getCurrentValue();
+    lastWet = wetGain->getCurrentValue();
 }
 
 void AirWindowsPlugin::deinitialise()
 {
+    oversampler.release();
+}
+
+void AirWindowsPlugin::reset()
+{
+    oversampler.reset();
 }
 
 void AirWindowsPlugin::applyToBuffer (const AudioRenderContext& fc)
@@ -206,40 +245,49 @@ void AirWindowsPlugin::applyToBuffer (const AudioRenderContext& fc)
 
     SCOPED_REALTIME_CHECK
 
-    for (auto p : parameters)
-        if (auto awp = dynamic_cast<AirWindowsAutomatableParameter*> (p))
-            impl->setParameter (awp->index, awp->getCurrentValue());
-
-    juce::AudioBuffer<float> asb (fc.destBuffer->getArrayOfWritePointers(), fc.destBuffer->getNumChannels(),
-                                  fc.bufferStartSample, fc.bufferNumSamples);
+    for (auto awp : algorithmParameters)
+        impl->setParameter (awp->index, awp->getCurrentValue());
 
+    // The dry and wet levels are ramped from the last block's values to avoid zipper noise.
+    // The dry signal goes through the oversampling filters too, so it lines up with the wet one
     auto dry = dryGain->getCurrentValue();
     auto wet = wetGain->getCurrentValue();
 
-    if (dry <= 0.00004f)
+    oversampler.process (*fc.destBuffer, fc.bufferStartSample, fc.bufferNumSamples,
+                         [this, dry, wet] (juce::AudioBuffer<float>& buffer) { processWithDryWet (buffer, dry, wet); });
+
+    lastDry = dry;
+    lastWet = wet;
+}
+
+void AirWindowsPlugin::processWithDryWet (juce::AudioBuffer<float>& asb, float dry, float wet)
+{
+    const int numSamples = asb.getNumSamples();
+
+    if (dry <= 0.00004f && lastDry <= 0.00004f)
     {
         processBlock (asb);
         zeroDenormalisedValuesIfNeeded (asb);
 
-        if (wet < 0.999f)
-            asb.applyGain (0, fc.bufferNumSamples, wet);
+        if (wet < 0.999f || lastWet < 0.999f)
+            asb.applyGainRamp (0, numSamples, lastWet, wet);
     }
     else
     {
         auto numChans = asb.getNumChannels();
-        AudioScratchBuffer dryAudio (numChans, fc.bufferNumSamples);
+        dryBuffer.setSize (numChans, numSamples, false, false, true);
 
         for (int i = 0; i < numChans; ++i)
-            dryAudio.buffer.copyFrom (i, 0, asb, i, 0, fc.bufferNumSamples);
+            dryBuffer.copyFrom (i, 0, asb, i, 0, numSamples);
 
         processBlock (asb);
         zeroDenormalisedValuesIfNeeded (asb);
 
-        if (wet < 0.999f)
-            asb.applyGain (0, fc.bufferNumSamples, wet);
+        if (wet < 0.999f || lastWet < 0.999f)
+            asb.applyGainRamp (0, numSamples, lastWet, wet);
 
         for (int i = 0; i < numChans; ++i)
-            asb.addFrom (i, 0, dryAudio.buffer.getReadPointer (i), fc.bufferNumSamples, dry);
+            asb.addFromWithRamp (i, 0, dryBuffer.getReadPointer (i), numSamples, lastDry, dry);
     }
 }
 
@@ -249,33 +297,54 @@ void AirWindowsPlugin::processBlock (juce::AudioBuffer<float>& buffer)
     const int samps       = buffer.getNumSamples();
     const int pluginChans = jmax (impl->getNumOutputs(), impl->getNumInputs());
 
-    if (pluginChans > numChans)
+    // If the plugin needs more channels than we have, only the first is passed through it
+    const int numChansToCopy = pluginChans > numChans ? 1 : numChans;
+    const int numBufferChans = jmax (pluginChans, numChans);
+
+    if (useDoublePrecision)
     {
-        AudioScratchBuffer input (pluginChans, samps);
-        AudioScratchBuffer output (pluginChans, samps);
+        // The buffers are only reallocated if the block is bigger than the one we were initialised with
+        inputBufferDouble.setSize (numBufferChans, samps, false, false, true);
+        outputBufferDouble.setSize (numBufferChans, samps, false, false, true);
+        inputBufferDouble.clear();
+        outputBufferDouble.clear();
+
+        for (int i = 0; i < numChansToCopy; ++i)
+            convertSamples (buffer.getReadPointer (i), inputBufferDouble.getWritePointer (i), samps);
 
-        input.buffer.clear();
-        output.buffer.clear();
+        impl->processDoubleReplacing (inputBufferDouble.getArrayOfWritePointers(),
+                                      outputBufferDouble.getArrayOfWritePointers(),
+                                      samps);
+
+        for (int i = 0; i < numChansToCopy; ++i)
+            convertSamples (outputBufferDouble.getReadPointer (i), buffer.getWritePointer (i), samps);
+    }
+    else if (pluginChans > numChans)
+    {
+        inputBuffer.setSize (numBufferChans, samps, false, false, true);
+        outputBuffer.setSize (numBufferChans, samps, false, false, true);
+        inputBuffer.clear();
+        outputBuffer.clear();
 
-        input.buffer.copyFrom (0, 0, buffer, 0, 0, samps);
+        inputBuffer.copyFrom (0, 0, buffer, 0, 0, samps);
 
-        impl->processReplacing (input.buffer.getArrayOfWritePointers(),
-                                output.buffer.getArrayOfWritePointers(),
+        impl->processReplacing (inputBuffer.getArrayOfWritePointers(),
+                                outputBuffer.getArrayOfWritePointers(),
                                 samps);
 
-        buffer.copyFrom (0, 0, output.buffer, 0, 0, samps);
+        buffer.copyFrom (0, 0, outputBuffer, 0, 0, samps);
     }
     else
     {
-        AudioScratchBuffer output (numChans, samps);
-        output.buffer.clear();
+        outputBuffer.setSize (numBufferChans, samps, false, false, true);
+        outputBuffer.clear();
 
         impl->processReplacing (buffer.getArrayOfWritePointers(),
-                                output.buffer.getArrayOfWritePointers(),
+                                outputBuffer.getArrayOfWritePointers(),
                                 samps);
 
         for (int i = 0; i < numChans; ++i)
-            buffer.copyFrom (i, 0, output.buffer, i, 0, samps);
+            buffer.copyFrom (i, 0, outputBuffer, i, 0, samps);
     }
 }
 
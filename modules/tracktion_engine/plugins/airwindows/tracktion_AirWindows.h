@@ -58,6 +58,8 @@ public:
     void initialise (const PlaybackInitialisationInfo&) override;
     void deinitialise() override;
     void applyToBuffer (const AudioRenderContext&) override;
+    void reset() override;
+    double getLatencySeconds() override                 { return oversampler.getLatencySeconds(); }
 
     void resetToDefault();
 
@@ -80,12 +82,27 @@ protected:
 
     void setConversionRange (int param, juce::NormalisableRange<float> range);
     void processBlock (juce::AudioBuffer<float>& buffer);
+    void processWithDryWet (juce::AudioBuffer<float>& buffer, float dry, float wet);
 
     juce::CriticalSection lock;
     AirWindowsCallback callback;
     std::unique_ptr<AirWindowsBase> impl;
 
     double sampleRate = 44100.0;
+    bool useDoublePrecision = false;
+    Oversampler oversampler;
+
+    juce::Array<AirWindowsAutomatableParameter*> algorithmParameters;
+    juce::AudioBuffer<float> inputBuffer, outputBuffer, dryBuffer;
+    juce::AudioBuffer<double> inputBufferDouble, outputBufferDouble;
+    float lastDry = 0.0f, lastWet = 1.0f;
+
+    template<typename SourceType, typename DestType>
+    static void convertSamples (const SourceType* source, DestType* dest, int numSamples) noexcept
+    {
+        for (int i = 0; i < numSamples; ++i)
+            dest[i] = static_cast<DestType> (source[i]);
+    }
 
 public:
     //==============================================================================
@@ -94,6 +111,12 @@ public:
     juce::CachedValue<float> dryValue, wetValue;
     AutomatableParameter::Ptr dryGain, wetGain;
 
+    /** Runs the algorithm at 1, 2, 4 or 8 times the sample rate to reduce aliasing.
+        Changing these restarts playback as the latency changes.
+    */
+    juce::CachedValue<int> oversamplingFactor;
+    juce::CachedValue<bool> oversamplingLinearPhase;
+
 private:
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AirWindowsPlugin)
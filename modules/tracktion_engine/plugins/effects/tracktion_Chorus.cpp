@@ -28,19 +28,26 @@ ChorusPlugin::~ChorusPlugin()
 
 const char* ChorusPlugin::xmlTypeName = "chorus";
 
+static const float chorusDelayMs = 20.0f;
+
 void ChorusPlugin::initialise (const PlaybackInitialisationInfo& info)
 {
-    const float delayMs = 20.0f;
-    const int maxLengthMs = 1 + roundToInt (delayMs + depthMs);
-    int bufferSizeSamples = roundToInt ((maxLengthMs * info.sampleRate) / 1000.0);
-    delayBuffer.ensureMaxBufferSize (bufferSizeSamples);
-    delayBuffer.clearBuffer();
+    const int maxLengthMs = 1 + roundToInt (chorusDelayMs + getMaxDepthMs());
+    const int bufferSizeSamples = roundToInt ((maxLengthMs * info.sampleRate) / 1000.0);
+
+    for (auto& l : delayLines)
+        l.setMaxDelaySamples (bufferSizeSamples);
+
+    scratchBuffer.setSize (2, info.blockSizeSamples);
     phase = 0.0f;
 }
 
 void ChorusPlugin::deinitialise()
 {
-    delayBuffer.releaseBuffer();
+    for (auto& l : delayLines)
+        l.release();
+
+    scratchBuffer.setSize (2, 0);
 }
 
 void ChorusPlugin::applyToBuffer (const AudioRenderContext& fc)
@@ -51,59 +58,54 @@ void ChorusPlugin::applyToBuffer (const AudioRenderContext& fc)
     SCOPED_REALTIME_CHECK
 
     float ph = 0.0f;
-    int bufPos = 0;
 
-    const float delayMs = 20.0f;
-    const float minSweepSamples = (float) ((delayMs * sampleRate) / 1000.0);
-    const float maxSweepSamples = (float) (((delayMs + depthMs) * sampleRate) / 1000.0);
+    const float depth = jlimit (0.0f, getMaxDepthMs(), depthMs.get());
+    const float minSweepSamples = (float) ((chorusDelayMs * sampleRate) / 1000.0);
+    const float maxSweepSamples = (float) (((chorusDelayMs + depth) * sampleRate) / 1000.0);
     const float speed = (float)((double_Pi * 2.0) / (sampleRate / speedHz));
-    const int maxLengthMs = 1 + roundToInt (delayMs + depthMs);
-    const int lengthInSamples = roundToInt ((maxLengthMs * sampleRate) / 1000.0);
 
-    delayBuffer.ensureMaxBufferSize (lengthInSamples);
-
-    const float feedbackGain = 0.0f; // xxx not sure why this value was here..
     const float lfoFactor = 0.5f * (maxSweepSamples - minSweepSamples);
     const float lfoOffset = minSweepSamples + lfoFactor;
 
+    // Each chunk has to be shorter than the shortest delay so it's all been written before it's read
+    const int maxChunkSize = jmax (1, (int) minSweepSamples - 2);
+
     AudioFadeCurve::CrossfadeLevels wetDry (mixProportion);
 
+    if (scratchBuffer.getNumSamples() < fc.bufferNumSamples)
+        scratchBuffer.setSize (2, fc.bufferNumSamples, false, false, true);
+
     clearChannels (*fc.destBuffer, 2, -1, fc.bufferStartSample, fc.bufferNumSamples);
 
     for (int chan = jmin (2, fc.destBuffer->getNumChannels()); --chan >= 0;)
     {
-        float* const d = fc.destBuffer->getWritePointer (chan, fc.bufferStartSample);
-        float* const buf = (float*) delayBuffer.buffers[chan].getData();
+        float* d = fc.destBuffer->getWritePointer (chan, fc.bufferStartSample);
+        auto& delayLine = delayLines[chan];
+        auto sweep = scratchBuffer.getWritePointer (0);
+        auto wet = scratchBuffer.getWritePointer (1);
 
         ph = phase;
         if (chan > 0)
             ph += float_Pi * width;
 
-        bufPos = delayBuffer.bufferPos;
-
-        for (int i = 0; i < fc.bufferNumSamples; ++i)
+        for (int numLeft = fc.bufferNumSamples; numLeft > 0;)
         {
-            const float in = d[i];
-
-            const float sweep = lfoOffset + lfoFactor * sinf (ph);
-            ph += speed;
-
-            int intSweepPos = roundToInt (sweep);
-            const float interp = sweep - intSweepPos;
-            intSweepPos = bufPos + lengthInSamples - intSweepPos;
+            const int num = jmin (numLeft, maxChunkSize);
 
-            const float out = buf[(intSweepPos - 1) % lengthInSamples] * interp
-                              + buf[intSweepPos % lengthInSamples] * (1.0f - interp);
+            for (int i = 0; i < num; ++i)
+            {
+                sweep[i] = lfoOffset + lfoFactor * sinf (ph);
+                ph += speed;
+            }
 
-            float n = in + out * feedbackGain;
+            delayLine.readInterpolatedBlock (wet, sweep, num);
+            delayLine.pushBlock (d, num);
 
-            JUCE_UNDENORMALISE (n);
+            FloatVectorOperations::multiply (d, wetDry.gain2, num);
+            FloatVectorOperations::addWithMultiply (d, wet, wetDry.gain1, num);
 
-            buf[bufPos] = n;
-
-            d[i] = out * wetDry.gain1 + in * wetDry.gain2;
-
-            bufPos = (bufPos + 1) % lengthInSamples;
+            d += num;
+            numLeft -= num;
         }
     }
 
@@ -113,8 +115,6 @@ void ChorusPlugin::applyToBuffer (const AudioRenderContext& fc)
     phase = ph;
     if (phase >= MathConstants<float>::pi * 2)
         phase -= MathConstants<float>::pi * 2;
-
-    delayBuffer.bufferPos = bufPos;
 }
 
 void ChorusPlugin::restorePluginStateFromValueTree (const juce::ValueTree& v)
@@ -36,9 +36,12 @@ public:
 
     juce::CachedValue<float> depthMs, width, mixProportion, speedHz;
 
+    static float getMaxDepthMs()                        { return 20.0f; }
+
 private:
     //==============================================================================
-    DelayBufferBase delayBuffer;
+    DelayLine delayLines[2];
+    juce::AudioBuffer<float> scratchBuffer;
     float phase = 0;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ChorusPlugin)
@@ -59,6 +59,15 @@ CompressorPlugin::CompressorPlugin (PluginCreationInfo info)  : Plugin (info)
 
     sidechainValue.referTo (state, IDs::inputDb, um);
     sidechainDb->attachToCurrentValue (sidechainValue);
+
+    lookaheadMs.setConstrainer ([] (float in) { return jlimit (0.0f, getMaxLookaheadMs(), in); });
+    lookaheadMs.referTo (state, IDs::lookahead, um, 0.0f);
+
+    playbackRestartTimer.setCallback ([this]
+                                      {
+                                          edit.restartPlayback();
+                                          playbackRestartTimer.stopTimer();
+                                      });
 }
 
 CompressorPlugin::~CompressorPlugin()
@@ -83,18 +92,40 @@ void CompressorPlugin::getChannelNames (StringArray* ins, StringArray* outs)
         ins->add (TRANS("Sidechain Trigger"));
 }
 
-void CompressorPlugin::initialise (const PlaybackInitialisationInfo&)
+void CompressorPlugin::initialise (const PlaybackInitialisationInfo& info)
 {
     currentLevel = 0.0;
     lastSamp = 0.0f;
+
+    gainBuffer.setSize (1, info.blockSizeSamples);
+
+    lookaheadSamples = roundToInt (getLatencySeconds() * info.sampleRate);
+    lookaheadPosition = 0;
+    lookaheadBuffer.setSize (2, jmax (1, lookaheadSamples));
+    lookaheadBuffer.clear();
 }
 
 void CompressorPlugin::deinitialise()
 {
+    gainBuffer.setSize (1, 0);
+    lookaheadBuffer.setSize (2, 0);
 }
 
 static const float preFilterAmount = 0.9f; // more = smoother level detection
 
+static void delaySamples (float* data, float* delayLine, int delayLength, int startPosition, int numSamples) noexcept
+{
+    for (int i = 0; i < numSamples; ++i)
+    {
+        auto delayed = delayLine[startPosition];
+        delayLine[startPosition] = data[i];
+        data[i] = delayed;
+
+        if (++startPosition == delayLength)
+            startPosition = 0;
+    }
+}
+
 void CompressorPlugin::applyToBuffer (const AudioRenderContext& fc)
 {
     if (fc.destBuffer == nullptr)
@@ -111,80 +142,74 @@ void CompressorPlugin::applyToBuffer (const AudioRenderContext& fc)
     const bool useSidechain = useSidechainTrigger.get();
     const float sidechainGain = dbToGain (sidechainDb->getCurrentValue());
 
-    float* b1 = fc.destBuffer->getWritePointer (0, fc.bufferStartSample);
+    auto& buffer = *fc.destBuffer;
+    const int numSamples = fc.bufferNumSamples;
+    const int numChannels = jmin (2, buffer.getNumChannels());
 
-    if (fc.destBuffer->getNumChannels() >= 2)
-    {
-        float* b2 = fc.destBuffer->getWritePointer (1, fc.bufferStartSample);
-        float* b3 = fc.destBuffer->getNumChannels() > 2 ? fc.destBuffer->getWritePointer (2, fc.bufferStartSample) : nullptr;
+    if (gainBuffer.getNumSamples() < numSamples)
+        gainBuffer.setSize (1, numSamples, false, false, true);
 
-        for (int i = fc.bufferNumSamples; --i >= 0;)
+    // First the rectified detector input is worked out for the whole block, scaled by the
+    // amount the pre-filter lets through
+    auto gains = gainBuffer.getWritePointer (0);
+    auto b1 = buffer.getReadPointer (0, fc.bufferStartSample);
+
+    if (numChannels >= 2)
+    {
+        if (useSidechain && buffer.getNumChannels() > 2)
+        {
+            FloatVectorOperations::multiply (gains, buffer.getReadPointer (2, fc.bufferStartSample),
+                                             sidechainGain * (1.0f - preFilterAmount), numSamples);
+        }
+        else
         {
-            float samp1 = *b1 + 1.0f;
-            samp1 -= 1.0f;
-            float samp2 = *b2 + 1.0f;
-            samp2 -= 1.0f;
-
-            float sampAvg = 0.0f;
-
-            if (useSidechain && b3 != nullptr)
-            {
-                sampAvg = lastSamp * preFilterAmount
-                            + std::abs (*b3++ * sidechainGain) * ((1.0f - preFilterAmount));
-            }
-            else
-            {
-                sampAvg = lastSamp * preFilterAmount
-                            + std::abs (samp1 + samp2) * ((1.0f - preFilterAmount) * 0.5f);
-            }
-
-            JUCE_UNDENORMALISE (sampAvg);
-
-            lastSamp = sampAvg;
-
-            if (sampAvg > thresh)
-                currentLevel = (currentLevel - sampAvg) * attackFactor + sampAvg;
-            else
-                currentLevel = (currentLevel - sampAvg) * releaseFactor + sampAvg;
-
-            float r = outputGain;
-
-            if (currentLevel > thresh)
-            {
-                r *= (float)((thresh + (currentLevel - thresh) * rat)
-                              / currentLevel);
-            }
-
-            *b1++ = samp1 * r;
-            *b2++ = samp2 * r;
+            FloatVectorOperations::add (gains, b1, buffer.getReadPointer (1, fc.bufferStartSample), numSamples);
+            FloatVectorOperations::multiply (gains, (1.0f - preFilterAmount) * 0.5f, numSamples);
         }
     }
     else
     {
-        for (int i = fc.bufferNumSamples; --i >= 0;)
-        {
-            const float samp = *b1;
-            const float sampAvg = lastSamp * preFilterAmount
-                                    + std::abs (samp) * (1.0f - preFilterAmount);
-            lastSamp = sampAvg;
+        FloatVectorOperations::multiply (gains, b1, 1.0f - preFilterAmount, numSamples);
+    }
 
-            JUCE_UNDENORMALISE (lastSamp);
+    FloatVectorOperations::abs (gains, gains, numSamples);
 
-            if (sampAvg > thresh)
-                currentLevel = (currentLevel - sampAvg) * attackFactor + sampAvg;
-            else
-                currentLevel = (currentLevel - sampAvg) * releaseFactor + sampAvg;
+    // The filter and envelope depend on the previous sample so they have to be done one at a
+    // time, but this loop turns the detector input into gains in place, without touching the audio
+    for (int i = 0; i < numSamples; ++i)
+    {
+        float sampAvg = lastSamp * preFilterAmount + gains[i];
+        JUCE_UNDENORMALISE (sampAvg);
+        lastSamp = sampAvg;
 
-            float r = outputGain;
+        if (sampAvg > thresh)
+            currentLevel = (currentLevel - sampAvg) * attackFactor + sampAvg;
+        else
+            currentLevel = (currentLevel - sampAvg) * releaseFactor + sampAvg;
 
-            if (currentLevel > thresh)
-                r *= (float)((thresh + (currentLevel - thresh) * rat) / currentLevel);
+        float r = outputGain;
 
-            *b1++ = samp * r;
-        }
+        if (currentLevel > thresh)
+            r *= (float) ((thresh + (currentLevel - thresh) * rat) / currentLevel);
+
+        gains[i] = r;
+    }
+
+    for (int i = 0; i < numChannels; ++i)
+    {
+        auto dest = buffer.getWritePointer (i, fc.bufferStartSample);
+
+        // Delaying the audio but not the detector lets the gain react ahead of the signal
+        if (lookaheadSamples > 0)
+            delaySamples (dest, lookaheadBuffer.getWritePointer (i), lookaheadSamples, lookaheadPosition, numSamples);
+
+        FloatVectorOperations::multiply (dest, gains, numSamples);
     }
 
-    clearChannels (*fc.destBuffer, 2, -1, fc.bufferStartSample, fc.bufferNumSamples);
+    if (lookaheadSamples > 0)
+        lookaheadPosition = (lookaheadPosition + numSamples) % lookaheadSamples;
+
+    clearChannels (buffer, 2, -1, fc.bufferStartSample, fc.bufferNumSamples);
 }
 
 float CompressorPlugin::getThreshold() const
@@ -214,6 +239,9 @@ void CompressorPlugin::restorePluginStateFromValueTree (const juce::ValueTree& v
     copyPropertiesToNullTerminatedCachedValues (v, cvsFloat);
     copyPropertiesToNullTerminatedCachedValues (v, cvsBool);
 
+    if (v.hasProperty (IDs::lookahead))
+        lookaheadMs = v[IDs::lookahead];
+
     for (auto p : getAutomatableParameters())
         p->updateFromAttachedValue();
 }
@@ -223,6 +251,9 @@ void CompressorPlugin::valueTreePropertyChanged (ValueTree& v, const juce::Ident
     if (v == state && id == IDs::sidechainTrigger)
         propertiesChanged();
 
+    if (v == state && id == IDs::lookahead)
+        playbackRestartTimer.startTimer (50);
+
     Plugin::valueTreePropertyChanged (v, id);
 }
 
@@ -33,6 +33,7 @@ public:
     int getNumOutputChannelsGivenInputs (int numInputChannels) override { return juce::jmin (numInputChannels, 2); }
     void getChannelNames (juce::StringArray*, juce::StringArray*) override;
     bool needsConstantBufferSize() override                             { return false; }
+    double getLatencySeconds() override                                 { return lookaheadMs.get() / 1000.0; }
 
     void initialise (const PlaybackInitialisationInfo&) override;
     void deinitialise() override;
@@ -43,6 +44,11 @@ public:
     juce::CachedValue<float> thresholdValue, ratioValue, attackValue,
                              releaseValue, outputValue, sidechainValue;
     juce::CachedValue<bool> useSidechainTrigger;
+
+    /** Delays the audio so the gain can start coming down before a transient arrives.
+        This is reported as latency, so changing it restarts playback.
+    */
+    ConstrainedCachedValue<float> lookaheadMs;
     AutomatableParameter::Ptr thresholdGain, ratio, attackMs,
                               releaseMs, outputDb, sidechainDb;
 
@@ -50,11 +56,16 @@ public:
 
     static float getMinThreshold()      { return 0.01f; }
     static float getMaxThreshold()      { return 1.0f; }
+    static float getMaxLookaheadMs()    { return 10.0f; }
 
 private:
     double currentLevel = 0.0;
     float lastSamp = 0.0f;
 
+    juce::AudioBuffer<float> gainBuffer, lookaheadBuffer;
+    int lookaheadSamples = 0, lookaheadPosition = 0;
+    LambdaTimer playbackRestartTimer;
+
     void valueTreePropertyChanged (juce::ValueTree&, const juce::Identifier&) override;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CompressorPlugin)
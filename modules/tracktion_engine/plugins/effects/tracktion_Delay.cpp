@@ -29,6 +29,12 @@ DelayPlugin::DelayPlugin (PluginCreationInfo info) : Plugin (info)
 
     feedbackDb->attachToCurrentValue (feedbackValue);
     mixProportion->attachToCurrentValue (mixValue);
+
+    playbackRestartTimer.setCallback ([this]
+                                      {
+                                          edit.restartPlayback();
+                                          playbackRestartTimer.stopTimer();
+                                      });
 }
 
 DelayPlugin::~DelayPlugin()
@@ -41,21 +47,36 @@ DelayPlugin::~DelayPlugin()
 
 const char* DelayPlugin::xmlTypeName = "delay";
 
+// Delays up to this long can be set without restarting playback
+static const int minDelayCapacityMs = 1000;
+
 void DelayPlugin::initialise (const PlaybackInitialisationInfo& info)
 {
-    const int lengthInSamples = (int) (lengthMs * info.sampleRate / 1000.0);
-    delayBuffer.ensureMaxBufferSize (lengthInSamples);
-    delayBuffer.clearBuffer();
+    const int maxLengthInSamples = (int) (jmax (lengthMs.get(), minDelayCapacityMs) * info.sampleRate / 1000.0);
+
+    for (auto& l : delayLines)
+        l.setMaxDelaySamples (maxLengthInSamples);
+
+    scratchBuffer.setSize (2, info.blockSizeSamples);
 }
 
 void DelayPlugin::deinitialise()
 {
-    delayBuffer.releaseBuffer();
+    for (auto& l : delayLines)
+        l.release();
+
+    scratchBuffer.setSize (2, 0);
 }
 
 void DelayPlugin::reset()
 {
-    delayBuffer.clearBuffer();
+    for (auto& l : delayLines)
+        l.clear();
+}
+
+int DelayPlugin::getLengthInSamples() const
+{
+    return (int) (lengthMs * sampleRate / 1000.0);
 }
 
 void DelayPlugin::applyToBuffer (const AudioRenderContext& fc)
@@ -70,35 +91,58 @@ void DelayPlugin::applyToBuffer (const AudioRenderContext& fc)
 
     const AudioFadeCurve::CrossfadeLevels wetDry (mixProportion->getCurrentValue());
 
-    const int lengthInSamples = (int) (lengthMs * sampleRate / 1000.0);
-    delayBuffer.ensureMaxBufferSize (lengthInSamples);
+    // If the length has grown past what was allocated, this plays the longest it can until playback restarts
+    const int lengthInSamples = jlimit (1, delayLines[0].getMaxDelaySamples(), getLengthInSamples());
 
-    const int offset = delayBuffer.bufferPos;
+    if (scratchBuffer.getNumSamples() < fc.bufferNumSamples)
+        scratchBuffer.setSize (2, fc.bufferNumSamples, false, false, true);
 
     clearChannels (*fc.destBuffer, 2, -1, fc.bufferStartSample, fc.bufferNumSamples);
 
     for (int chan = jmin (2, fc.destBuffer->getNumChannels()); --chan >= 0;)
     {
-        float* const d = fc.destBuffer->getWritePointer (chan, fc.bufferStartSample);
-        float* const buf = (float*) delayBuffer.buffers[chan].getData();
+        float* d = fc.destBuffer->getWritePointer (chan, fc.bufferStartSample);
+        auto& delayLine = delayLines[chan];
+        auto wet = scratchBuffer.getWritePointer (0);
+        auto feedback = scratchBuffer.getWritePointer (1);
 
-        for (int i = 0; i < fc.bufferNumSamples; ++i)
+        // The line is read in chunks no longer than the delay so that each one has already been written
+        for (int numLeft = fc.bufferNumSamples; numLeft > 0;)
         {
-            float* const b = buf + ((i + offset) % lengthInSamples);
+            const int num = jmin (numLeft, lengthInSamples);
+
+            delayLine.readBlock (wet, lengthInSamples, num);
+
+            FloatVectorOperations::copy (feedback, d, num);
+            FloatVectorOperations::addWithMultiply (feedback, wet, feedbackGain, num);
+            delayLine.pushBlock (feedback, num);
+
+            FloatVectorOperations::multiply (d, wetDry.gain2, num);
+            FloatVectorOperations::addWithMultiply (d, wet, wetDry.gain1, num);
 
-            float in = d[i];
-            d[i] = wetDry.gain2 * in + wetDry.gain1 * *b;
-            in += *b * feedbackGain;
-            JUCE_UNDENORMALISE (in);
-            *b = in;
+            d += num;
+            numLeft -= num;
         }
     }
 
-    delayBuffer.bufferPos = (delayBuffer.bufferPos + fc.bufferNumSamples) % lengthInSamples;
-
     zeroDenormalisedValuesIfNeeded (*fc.destBuffer);
 }
 
+double DelayPlugin::getTailLength() const
+{
+    const double lengthSeconds = lengthMs.get() / 1000.0;
+    const float feedback = feedbackDb->getCurrentValue();
+
+    if (feedback <= getMinDelayFeedbackDb())
+        return lengthSeconds;
+
+    if (feedback >= 0.0f)
+        return std::numeric_limits<double>::infinity();
+
+    // Time for the repeats to decay by 120dB
+    return lengthSeconds * (1.0 + 120.0 / -feedback);
+}
+
 void DelayPlugin::restorePluginStateFromValueTree (const juce::ValueTree& v)
 {
     CachedValue<float>* cvsFloat[]  = { &feedbackValue, &mixValue, nullptr };
@@ -110,6 +154,15 @@ void DelayPlugin::restorePluginStateFromValueTree (const juce::ValueTree& v)
         p->updateFromAttachedValue();
 }
 
+void DelayPlugin::valueTreePropertyChanged (ValueTree& v, const juce::Identifier& id)
+{
+    if (v == state && id == IDs::length && ! baseClassNeedsInitialising()
+         && getLengthInSamples() > delayLines[0].getMaxDelaySamples())
+        playbackRestartTimer.startTimer (50);
+
+    Plugin::valueTreePropertyChanged (v, id);
+}
+
 #if TRACKTION_UNIT_TESTS
 
 //==============================================================================
@@ -11,42 +11,128 @@
 namespace tracktion_engine
 {
 
-struct DelayBufferBase
+/**
+    A ring buffer of samples for delay and modulation effects.
+
+    The buffer is a power of two long so the positions wrap with a mask instead of a
+    modulo or a branch. It's only allocated by setMaxDelaySamples(), so the delay time
+    can be changed whilst playing without ever allocating.
+*/
+class DelayLine
 {
-    DelayBufferBase()  {}
+public:
+    DelayLine() = default;
 
-    void ensureMaxBufferSize (int size)
+    /** Allocates and clears enough space for delays of up to the given number of samples.
+        This allocates so shouldn't be called from the audio thread.
+    */
+    void setMaxDelaySamples (int maxDelaySamples)
     {
-        if (++size > bufferSamples)
-        {
-            bufferSamples = size;
-            buffers[0].ensureSize ((size_t) bufferSamples * sizeof (float) + 32, true);
-            buffers[1].ensureSize ((size_t) bufferSamples * sizeof (float) + 32, true);
+        // Interpolating needs one sample more than the delay
+        auto size = juce::nextPowerOfTwo (juce::jmax (2, maxDelaySamples + 2));
 
-            if (bufferPos >= bufferSamples)
-                bufferPos = 0;
+        if (size != mask + 1)
+        {
+            buffer.allocate ((size_t) size, true);
+            mask = size - 1;
         }
+
+        clear();
+    }
+
+    /** Returns the longest delay that can be read, which may be more than was asked for. */
+    int getMaxDelaySamples() const noexcept             { return juce::jmax (0, mask - 1); }
+
+    void clear() noexcept
+    {
+        if (buffer != nullptr)
+            juce::FloatVectorOperations::clear (buffer, mask + 1);
+
+        writePos = 0;
+    }
+
+    void release()
+    {
+        buffer.free();
+        mask = -1;
+        writePos = 0;
+    }
+
+    //==============================================================================
+    /** Adds a sample to the end of the line. */
+    void push (float sample) noexcept
+    {
+        buffer[writePos] = sample;
+        writePos = (writePos + 1) & mask;
     }
 
-    void clearBuffer()
+    /** Returns the sample that was pushed this many samples ago, where 1 is the last one. */
+    float read (int delaySamples) const noexcept
     {
-        buffers[0].fillWith (0);
-        buffers[1].fillWith (0);
+        jassert (delaySamples > 0 && delaySamples <= getMaxDelaySamples());
+        return buffer[(writePos - delaySamples) & mask];
     }
 
-    void releaseBuffer()
+    /** Returns a fractional delay, linearly interpolated between the two nearest samples. */
+    float readInterpolated (float delaySamples) const noexcept
     {
-        bufferSamples = 0;
-        bufferPos = 0;
-        buffers[0].setSize (0);
-        buffers[1].setSize (0);
+        jassert (delaySamples >= 1.0f && delaySamples <= (float) getMaxDelaySamples());
+        auto whole = (int) delaySamples;
+        auto fraction = delaySamples - (float) whole;
+        auto pos = writePos - whole;
+
+        return buffer[pos & mask] * (1.0f - fraction) + buffer[(pos - 1) & mask] * fraction;
+    }
+
+    //==============================================================================
+    /** Adds a block of samples to the end of the line. */
+    void pushBlock (const float* samples, int numSamples) noexcept
+    {
+        jassert (numSamples <= mask + 1);
+        auto numBeforeWrap = juce::jmin (numSamples, mask + 1 - writePos);
+
+        juce::FloatVectorOperations::copy (buffer + writePos, samples, numBeforeWrap);
+        juce::FloatVectorOperations::copy (buffer, samples + numBeforeWrap, numSamples - numBeforeWrap);
+        writePos = (writePos + numSamples) & mask;
+    }
+
+    /** Reads the block of samples that was pushed this many samples ago, before the next
+        block is pushed. The delay can't be shorter than the block.
+    */
+    void readBlock (float* dest, int delaySamples, int numSamples) const noexcept
+    {
+        jassert (numSamples <= delaySamples && delaySamples <= getMaxDelaySamples());
+        auto start = (writePos - delaySamples) & mask;
+        auto numBeforeWrap = juce::jmin (numSamples, mask + 1 - start);
+
+        juce::FloatVectorOperations::copy (dest, buffer + start, numBeforeWrap);
+        juce::FloatVectorOperations::copy (dest + numBeforeWrap, buffer, numSamples - numBeforeWrap);
     }
 
-    int bufferPos = 0, bufferSamples = 0;
-    juce::MemoryBlock buffers[2];
+    /** Reads a block of samples with a fractional delay for each one, e.g. for a modulated delay,
+        before the next block is pushed. Each delay is measured from the sample that will be pushed
+        at the same index, so they all have to be more than a sample longer than the block.
+    */
+    void readInterpolatedBlock (float* JUCE_RESTRICT dest, const float* JUCE_RESTRICT delaySamples, int numSamples) const noexcept
+    {
+        const float* JUCE_RESTRICT data = buffer;
+
+        // This is kept free of branches so the compiler can vectorise it
+        for (int i = 0; i < numSamples; ++i)
+        {
+            auto whole = (int) delaySamples[i];
+            auto fraction = delaySamples[i] - (float) whole;
+            auto pos = writePos + i - whole;
+
+            dest[i] = data[pos & mask] * (1.0f - fraction) + data[(pos - 1) & mask] * fraction;
+        }
+    }
 
 private:
-    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DelayBufferBase)
+    juce::HeapBlock<float> buffer;
+    int mask = -1, writePos = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DelayLine)
 };
 
 
@@ -71,6 +157,8 @@ public:
     void deinitialise() override;
     void reset() override;
     void applyToBuffer (const AudioRenderContext&) override;
+    bool noTail() override                              { return false; }
+    double getTailLength() const override;
 
     void restorePluginStateFromValueTree (const juce::ValueTree&) override;
 
@@ -83,7 +171,12 @@ public:
 
 
 private:
-    DelayBufferBase delayBuffer;
+    DelayLine delayLines[2];
+    juce::AudioBuffer<float> scratchBuffer;
+    LambdaTimer playbackRestartTimer;
+
+    int getLengthInSamples() const;
+    void valueTreePropertyChanged (juce::ValueTree&, const juce::Identifier&) override;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (DelayPlugin)
 };
@@ -193,53 +193,131 @@ static float convertEQLevelToGain (double db)
     return (float) pow (10.0, db / 20.0);
 }
 
-void EqualiserPlugin::updateIIRFilters()
+void EqualiserPlugin::setBandCoefficients (int band, float proportionThroughBlock)
 {
-    const ScopedLock sl (filterLock);
+    auto getValue = [proportionThroughBlock] (const AutomatableParameter::Ptr& p)
+    {
+        return p->getValueInBlock (proportionThroughBlock);
+    };
 
-    if (needToUpdateFilters[0])
+    switch (band)
     {
-        needToUpdateFilters[0] = false;
+        case 0:
+        {
+            IIRCoefficients c = IIRCoefficients::makeLowShelf (lastSampleRate, getValue (loFreq), getValue (loQ),
+                                                               convertEQLevelToGain (getValue (loGain)));
 
-        IIRCoefficients c = IIRCoefficients::makeLowShelf (lastSampleRate, loFreq->getCurrentValue(), loQ->getCurrentValue(),
-                                                           convertEQLevelToGain (loGain->getCurrentValue()));
+            for (int i = EQ_CHANS; --i >= 0;)
+                low[i].setCoefficients (c);
 
-        for (int i = EQ_CHANS; --i >= 0;)
-            low[i].setCoefficients (c);
-    }
+            break;
+        }
 
-    if (needToUpdateFilters[1])
-    {
-        needToUpdateFilters[1] = false;
+        case 1:
+        {
+            IIRCoefficients c = IIRCoefficients::makePeakFilter (lastSampleRate, getValue (midFreq1), getValue (midQ1),
+                                                                 convertEQLevelToGain (getValue (midGain1)));
+
+            for (int i = EQ_CHANS; --i >= 0;)
+                mid1[i].setCoefficients (c);
+
+            break;
+        }
+
+        case 2:
+        {
+            IIRCoefficients c = IIRCoefficients::makePeakFilter (lastSampleRate, getValue (midFreq2), getValue (midQ2),
+                                                                 convertEQLevelToGain (getValue (midGain2)));
+
+            for (int i = EQ_CHANS; --i >= 0;)
+                mid2[i].setCoefficients (c);
+
+            break;
+        }
+
+        case 3:
+        {
+            IIRCoefficients c = IIRCoefficients::makeHighShelf (lastSampleRate, getValue (hiFreq), getValue (hiQ),
+                                                                convertEQLevelToGain (getValue (hiGain)));
 
-        IIRCoefficients c = IIRCoefficients::makePeakFilter (lastSampleRate, midFreq1->getCurrentValue(), midQ1->getCurrentValue(),
-                                                             convertEQLevelToGain (midGain1->getCurrentValue()));
+            for (int i = EQ_CHANS; --i >= 0;)
+                high[i].setCoefficients (c);
 
-        for (int i = EQ_CHANS; --i >= 0;)
-            mid1[i].setCoefficients (c);
+            break;
+        }
+
+        default:
+            jassertfalse;
+            break;
     }
+}
 
-    if (needToUpdateFilters[2])
-    {
-        needToUpdateFilters[2] = false;
+void EqualiserPlugin::updateIIRFilters()
+{
+    const ScopedLock sl (filterLock);
 
-        IIRCoefficients c = IIRCoefficients::makePeakFilter (lastSampleRate, midFreq2->getCurrentValue(), midQ2->getCurrentValue(),
-                                                             convertEQLevelToGain (midGain2->getCurrentValue()));
+    for (int band = 0; band < 4; ++band)
+    {
+        if (needToUpdateFilters[band])
+        {
+            needToUpdateFilters[band] = false;
+            setBandCoefficients (band, 0.0f);
+        }
+    }
+}
 
-        for (int i = EQ_CHANS; --i >= 0;)
-            mid2[i].setCoefficients (c);
+bool EqualiserPlugin::isBandRampingOverBlock (int band) const
+{
+    switch (band)
+    {
+        case 0:     return loFreq->isRampingOverBlock()   || loGain->isRampingOverBlock()   || loQ->isRampingOverBlock();
+        case 1:     return midFreq1->isRampingOverBlock() || midGain1->isRampingOverBlock() || midQ1->isRampingOverBlock();
+        case 2:     return midFreq2->isRampingOverBlock() || midGain2->isRampingOverBlock() || midQ2->isRampingOverBlock();
+        case 3:     return hiFreq->isRampingOverBlock()   || hiGain->isRampingOverBlock()   || hiQ->isRampingOverBlock();
+        default:    jassertfalse; return false;
     }
+}
+
+void EqualiserPlugin::applyToBufferWithRamps (const AudioRenderContext& fc)
+{
+    // A band is processed if its gain is non-zero at either end of the block
+    const bool bandActive[] = { loGain->getCurrentValue() != 0   || loGain->getBlockEndValue() != 0,
+                                midGain1->getCurrentValue() != 0 || midGain1->getBlockEndValue() != 0,
+                                midGain2->getCurrentValue() != 0 || midGain2->getBlockEndValue() != 0,
+                                hiGain->getCurrentValue() != 0   || hiGain->getBlockEndValue() != 0 };
+
+    const bool bandRamping[] = { isBandRampingOverBlock (0), isBandRampingOverBlock (1),
+                                 isBandRampingOverBlock (2), isBandRampingOverBlock (3) };
 
-    if (needToUpdateFilters[3])
+    juce::IIRFilter* const filters[] = { low, mid1, mid2, high };
+
+    // The coefficients of any bands that are moving are stepped along their ramps in short
+    // chunks, which is much cheaper than having the whole plugin called for sub-blocks
+    for (int pos = 0; pos < fc.bufferNumSamples;)
     {
-        needToUpdateFilters[3] = false;
+        const int num = jmin ((int) automationRampChunkSize, fc.bufferNumSamples - pos);
+        const float proportion = (pos + num) / (float) fc.bufferNumSamples;
+
+        for (int band = 0; band < 4; ++band)
+            if (bandActive[band] && bandRamping[band])
+                setBandCoefficients (band, proportion);
+
+        for (int i = jmin ((int) EQ_CHANS, fc.destBuffer->getNumChannels()); --i >= 0;)
+        {
+            float* const data = fc.destBuffer->getWritePointer (i, fc.bufferStartSample + pos);
 
-        IIRCoefficients c = IIRCoefficients::makeHighShelf (lastSampleRate, hiFreq->getCurrentValue(), hiQ->getCurrentValue(),
-                                                            convertEQLevelToGain (hiGain->getCurrentValue()));
+            for (int band = 0; band < 4; ++band)
+                if (bandActive[band])
+                    filters[band][i].processSamples (data, num);
+        }
 
-        for (int i = EQ_CHANS; --i >= 0;)
-            high[i].setCoefficients (c);
+        pos += num;
     }
+
+    // Make sure the filters get set back to the parameters' current values next time
+    for (int band = 0; band < 4; ++band)
+        if (bandRamping[band])
+            needToUpdateFilters[band] = true;
 }
 
 void EqualiserPlugin::initialise (const PlaybackInitialisationInfo&)
@@ -283,14 +361,22 @@ void EqualiserPlugin::applyToBuffer (const AudioRenderContext& fc)
 
         addAntiDenormalisationNoise (*fc.destBuffer, fc.bufferStartSample, fc.bufferNumSamples);
 
-        for (int i = jmin ((int) EQ_CHANS, fc.destBuffer->getNumChannels()); --i >= 0;)
+        if (isBandRampingOverBlock (0) || isBandRampingOverBlock (1)
+             || isBandRampingOverBlock (2) || isBandRampingOverBlock (3))
         {
-            float* const data = fc.destBuffer->getWritePointer (i, fc.bufferStartSample);
-
-            if (loGain->getCurrentValue() != 0)       low[i] .processSamples (data, fc.bufferNumSamples);
-            if (midGain1->getCurrentValue() != 0)     mid1[i].processSamples (data, fc.bufferNumSamples);
-            if (midGain2->getCurrentValue() != 0)     mid2[i].processSamples (data, fc.bufferNumSamples);
-            if (hiGain->getCurrentValue() != 0)       high[i].processSamples (data, fc.bufferNumSamples);
+            applyToBufferWithRamps (fc);
+        }
+        else
+        {
+            for (int i = jmin ((int) EQ_CHANS, fc.destBuffer->getNumChannels()); --i >= 0;)
+            {
+                float* const data = fc.destBuffer->getWritePointer (i, fc.bufferStartSample);
+
+                if (loGain->getCurrentValue() != 0)       low[i] .processSamples (data, fc.bufferNumSamples);
+                if (midGain1->getCurrentValue() != 0)     mid1[i].processSamples (data, fc.bufferNumSamples);
+                if (midGain2->getCurrentValue() != 0)     mid2[i].processSamples (data, fc.bufferNumSamples);
+                if (hiGain->getCurrentValue() != 0)       high[i].processSamples (data, fc.bufferNumSamples);
+            }
         }
 
         if (phaseInvert)
@@ -321,7 +407,7 @@ float EqualiserPlugin::getDBGainAtFrequency (float f)
         if (midGain2->getCurrentValue() != 0)   IIRFilter (mid2[0]).processSamples (samps, sampSize);
         if (hiGain->getCurrentValue() != 0)     IIRFilter (high[0]).processSamples (samps, sampSize);
 
-        fft.performRealOnlyForwardTransform (samps);
+        fft->performRealOnlyForwardTransform (samps);
 
         for (int i = 0; i < sampSize / 2;)
         {
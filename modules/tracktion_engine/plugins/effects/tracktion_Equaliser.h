@@ -30,6 +30,7 @@ public:
     juce::String getShortName (int) override        { return "EQ"; }
     juce::String getTooltip() override;
     bool needsConstantBufferSize() override         { return false; }
+    bool rampsAutomationAcrossBlocks() override     { return true; }
 
     int getNumOutputChannelsGivenInputs (int numInputChannels) override { return juce::jmin (numInputChannels, (int) EQ_CHANS); }
 
@@ -82,12 +83,18 @@ private:
     bool curveNeedsUpdating = true;
 
     enum { EQ_CHANS = 2 };
+
+    // The filters are processed in chunks of this many samples while their automation ramps
+    enum { automationRampChunkSize = 32 };
     juce::IIRFilter low[EQ_CHANS], mid1[EQ_CHANS], mid2[EQ_CHANS], high[EQ_CHANS];
 
     enum { fftOrder = 10 };
-    juce::dsp::FFT fft { fftOrder };
+    std::shared_ptr<const juce::dsp::FFT> fft { getSharedFFT (fftOrder) };
 
     void updateIIRFilters();
+    void setBandCoefficients (int band, float proportionThroughBlock);
+    bool isBandRampingOverBlock (int band) const;
+    void applyToBufferWithRamps (const AudioRenderContext&);
     std::atomic<bool> needToUpdateFilters[4];
     juce::CriticalSection filterLock;
 
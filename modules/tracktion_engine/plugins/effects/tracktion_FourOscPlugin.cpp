@@ -43,75 +43,6 @@ inline void clip (float* data, int numSamples)
     }
 }
 
-//==============================================================================
-class FODelayLine
-{
-public:
-    FODelayLine (float maximumDelay = 0.001f, float sr = 44100.0f)
-    {
-        resize (maximumDelay, sr);
-    }
-
-    void resize (float maximumDelay, float sr)
-    {
-        sampleRate = sr;
-        numSamples = (int) std::ceil (maximumDelay * sampleRate);
-        sampleBuffer.resize ((size_t) numSamples);
-        memset (sampleBuffer.data(), 0, sizeof(float) * (size_t) numSamples);
-        currentPos = 0;
-    }
-
-    void reset()
-    {
-        memset (sampleBuffer.data(), 0, sizeof(float) * (size_t) numSamples);
-    }
-
-    inline float samplesToSeconds (float numSamplesIn, float sampleRateIn)
-    {
-        return numSamplesIn / sampleRateIn;
-    }
-
-    inline float read (float atTime)
-    {
-        jassert (atTime >= 0.0f && atTime < samplesToSeconds (float (numSamples), sampleRate));
-
-        float pos = jmax (1.0f, atTime * (sampleRate - 1));
-
-        int intPos = (int) std::floor (pos);
-        float f = pos - intPos;
-
-        int n1 = currentPos - intPos;
-        while (n1 < 0)
-            n1 += numSamples;
-        while (n1 >= numSamples)
-            n1 -= numSamples;
-
-        int n2 = n1 - 1;
-        if (n2 < 0)
-            n2 += numSamples;
-
-        jassert (n1 >= 0 && n1 < numSamples);
-        jassert (n2 >= 0 && n2 < numSamples);
-
-        return (1.0f - f) * sampleBuffer[(size_t) n1] + f * sampleBuffer[(size_t) n2];
-    }
-
-    inline void write (const float input)
-    {
-        sampleBuffer[(size_t) currentPos] = input;
-        currentPos++;
-
-        if (currentPos >= numSamples)
-            currentPos = 0;
-    }
-
-protected:
-    int numSamples {0};
-    float sampleRate {44100};
-    int currentPos {0};
-    std::vector<float> sampleBuffer;
-};
-
 //==============================================================================
 class FODelay
 {
@@ -129,13 +60,16 @@ public:
         FloatVectorOperations::copy (lWork, lOut, numSamples);
         FloatVectorOperations::copy (rWork, rOut, numSamples);
 
+        // The tempo can make this longer than the lines, so it's limited rather than reallocating them
+        const float delaySamples = jlimit (1.0f, (float) leftDelay.getMaxDelaySamples(), delay * float (sampleRate));
+
         for (int i = 0; i < numSamples; i++)
         {
-            const float lVal = leftDelay.read  (delay);
-            const float rVal = rightDelay.read (delay);
+            const float lVal = leftDelay.readInterpolated  (delaySamples);
+            const float rVal = rightDelay.readInterpolated (delaySamples);
 
-            leftDelay.write  (lWork[i] + (feedback * lVal) + (crossfeed * rVal));
-            rightDelay.write (rWork[i] + (feedback * rVal) + (crossfeed * lVal));
+            leftDelay.push  (lWork[i] + (feedback * lVal) + (crossfeed * rVal));
+            rightDelay.push (rWork[i] + (feedback * rVal) + (crossfeed * lVal));
 
             lWork[i] = lVal;
             rWork[i] = rVal;
@@ -153,8 +87,9 @@ public:
 
     void setSampleRate (double sr)
     {
-        leftDelay.resize (5.1f, float (sr));
-        rightDelay.resize (5.1f, float (sr));
+        sampleRate = sr;
+        leftDelay.setMaxDelaySamples ((int) std::ceil (5.1 * sr));
+        rightDelay.setMaxDelaySamples ((int) std::ceil (5.1 * sr));
     }
 
     void setParams (float delayIn, float feedbackIn, float crossfeedIn, float mixIn)
@@ -167,12 +102,13 @@ public:
 
     void reset()
     {
-        leftDelay.reset();
-        rightDelay.reset();
+        leftDelay.clear();
+        rightDelay.clear();
     }
 
 private:
-    FODelayLine leftDelay, rightDelay;
+    DelayLine leftDelay, rightDelay;
+    double sampleRate = 44100.0;
 
     float mix = 0, feedback = 0, delay = 0, crossfeed = 0;
 };
@@ -184,53 +120,46 @@ public:
     void process (AudioSampleBuffer& buffer, int numSamples)
     {
         float ph = 0.0f;
-        int bufPos = 0;
 
-        const float delayMs = 20.0f;
         const float minSweepSamples = (float) ((delayMs * sampleRate) / 1000.0);
-        const float maxSweepSamples = (float) (((delayMs + depthMs) * sampleRate) / 1000.0);
+        const float maxSweepSamples = (float) (((delayMs + jmin (depthMs, maxDepthMs)) * sampleRate) / 1000.0);
         const float speed = (float)((double_Pi * 2.0) / (sampleRate / speedHz));
-        const int maxLengthMs = 1 + roundToInt (delayMs + depthMs);
-        const int lengthInSamples = roundToInt ((maxLengthMs * sampleRate) / 1000.0);
-
-        delayBuffer.ensureMaxBufferSize (lengthInSamples);
 
         const float lfoFactor = 0.5f * (maxSweepSamples - minSweepSamples);
         const float lfoOffset = minSweepSamples + lfoFactor;
 
+        // Each chunk has to be shorter than the shortest delay so it's all been written before it's read
+        const int maxChunkSize = jlimit (1, (int) numElementsInArray (sweep), (int) minSweepSamples - 2);
+
         AudioFadeCurve::CrossfadeLevels wetDry (mix);
 
         for (int chan = buffer.getNumChannels(); --chan >= 0;)
         {
-            float* const d = buffer.getWritePointer (chan, 0);
-            float* const buf = (float*) delayBuffer.buffers[chan].getData();
+            float* d = buffer.getWritePointer (chan, 0);
+            auto& delayLine = delayLines[jmin (chan, 1)];
 
             ph = phase;
             if (chan > 0)
                 ph += float_Pi * width;
 
-            bufPos = delayBuffer.bufferPos;
-
-            for (int i = 0; i < numSamples; ++i)
+            for (int numLeft = numSamples; numLeft > 0;)
             {
-                const float in = d[i];
-
-                const float sweep = lfoOffset + lfoFactor * sinf (ph);
-                ph += speed;
+                const int num = jmin (numLeft, maxChunkSize);
 
-                int intSweepPos = roundToInt (sweep);
-                const float interp = sweep - intSweepPos;
-                intSweepPos = bufPos + lengthInSamples - intSweepPos;
-
-                const float out = buf[(intSweepPos - 1) % lengthInSamples] * interp + buf[intSweepPos % lengthInSamples] * (1.0f - interp);
+                for (int i = 0; i < num; ++i)
+                {
+                    sweep[i] = lfoOffset + lfoFactor * sinf (ph);
+                    ph += speed;
+                }
 
-                float n = in;
+                delayLine.readInterpolatedBlock (wet, sweep, num);
+                delayLine.pushBlock (d, num);
 
-                JUCE_UNDENORMALISE (n);
+                FloatVectorOperations::multiply (d, wetDry.gain2, num);
+                FloatVectorOperations::addWithMultiply (d, wet, wetDry.gain1, num);
 
-                buf[bufPos] = n;
-                d[i] = out * wetDry.gain1 + in * wetDry.gain2;
-                bufPos = (bufPos + 1) % lengthInSamples;
+                d += num;
+                numLeft -= num;
             }
         }
 
@@ -240,19 +169,19 @@ public:
         phase = ph;
         if (phase >= MathConstants<float>::pi * 2)
             phase -= MathConstants<float>::pi * 2;
-
-        delayBuffer.bufferPos = bufPos;
     }
 
     void setSampleRate (double sr)
     {
         sampleRate = sr;
 
-        const float delayMs = 20.0f;
-        const int maxLengthMs = 1 + roundToInt (delayMs + depthMs);
+        // This is sized for the deepest setting so changing the depth doesn't need to reallocate
+        const int maxLengthMs = 1 + roundToInt (delayMs + maxDepthMs);
         int bufferSizeSamples = roundToInt ((maxLengthMs * sr) / 1000.0);
-        delayBuffer.ensureMaxBufferSize (bufferSizeSamples);
-        delayBuffer.clearBuffer();
+
+        for (auto& l : delayLines)
+            l.setMaxDelaySamples (bufferSizeSamples);
+
         phase = 0.0f;
     }
 
@@ -266,11 +195,15 @@ public:
 
     void reset()
     {
-        delayBuffer.clearBuffer();
+        for (auto& l : delayLines)
+            l.clear();
     }
 
 private:
-    DelayBufferBase delayBuffer;
+    static constexpr float delayMs = 20.0f, maxDepthMs = 20.0f;
+
+    DelayLine delayLines[2];
+    float sweep[256], wet[256];
     double sampleRate = 0;
 
     float phase = 0, speedHz = 1.0f, depthMs = 3.0f, width = 0.5f, mix = 0;
@@ -961,6 +894,8 @@ FourOscPlugin::FourOscPlugin (PluginCreationInfo info)  : Plugin (info)
     // Effects: Distortion
     distortionOnValue.referTo (state, IDs::distortionOn, um);
     distortionValue.referTo (state, IDs::distortion, um, 0.0f);
+    oversamplingFactor.referTo (state, IDs::oversampling, um, 1);
+    oversamplingLinearPhase.referTo (state, IDs::oversamplingLinearPhase, um);
 
     distortion = addParam ("distortion", TRANS("Distortion"), {0.0f, 1.0f});
 
@@ -1414,6 +1349,12 @@ void FourOscPlugin::initialise (const PlaybackInitialisationInfo& info)
 {
     setCurrentPlaybackSampleRate (info.sampleRate);
 
+    // The effects are applied to 32 sample blocks
+    distortionOversampler.prepare (2, Oversampler::isValidFactor (oversamplingFactor) ? oversamplingFactor.get() : 1,
+                                   oversamplingLinearPhase ? Oversampler::FilterType::linearPhase
+                                                           : Oversampler::FilterType::minimumPhase,
+                                   32, info.sampleRate);
+
     reverb.setSampleRate (info.sampleRate);
     delay->setSampleRate (info.sampleRate);
     chorus->setSampleRate (info.sampleRate);
@@ -1428,12 +1369,14 @@ void FourOscPlugin::initialise (const PlaybackInitialisationInfo& info)
 
 void FourOscPlugin::deinitialise()
 {
+    distortionOversampler.release();
 }
 
 //==============================================================================
 void FourOscPlugin::reset()
 {
     turnOffAllVoices (false);
+    distortionOversampler.reset();
 }
 
 void FourOscPlugin::applyToBuffer (const AudioRenderContext& fc)
@@ -1513,13 +1456,20 @@ void FourOscPlugin::applyEffects (AudioSampleBuffer& buffer)
 {
     int numSamples = buffer.getNumSamples();
 
-    // Apply Distortion
-    if (distortionOnValue)
+    // Apply Distortion. When oversampling, the filters are run even if it's off to keep the latency constant
+    if (distortionOnValue || distortionOversampler.getFactor() > 1)
     {
-        float drive = paramValue (distortion);
-        float clip = 1.0f / (2.0f * drive);
-        Distortion::distortion (buffer.getWritePointer (0), numSamples, drive, -clip, clip);
-        Distortion::distortion (buffer.getWritePointer (1), numSamples, drive, -clip, clip);
+        distortionOversampler.process (buffer, 0, numSamples, [this] (AudioSampleBuffer& b)
+        {
+            if (! distortionOnValue)
+                return;
+
+            float drive = paramValue (distortion);
+            float clip = 1.0f / (2.0f * drive);
+
+            for (int i = 0; i < b.getNumChannels(); ++i)
+                Distortion::distortion (b.getWritePointer (i), b.getNumSamples(), drive, -clip, clip);
+        });
     }
 
     // Apply Chorus
@@ -84,56 +84,39 @@ public:
     void setParameters (Parameters newParameters)   { parameters = newParameters; }
     void reset()                                    { phase = 0; }
 
+    /** Moves the LFO on by a block. The value's only read once a block, so rather than
+        stepping through each sample this just works out where the phase ends up.
+    */
     void process (int numSamples)
     {
         double step = 0.0;
         if (parameters.frequency > 0.001f)
             step = parameters.frequency / sampleRate;
 
-        for (int i = 0; i < numSamples; i++)
-        {
-            phase += step;
-            if (phase >= 1.0)
-                phase -= 1.0;
-
-            float localPhase = 0.0f;
+        const double advance = step * numSamples;
+        phase += advance;
+        phase -= std::floor (phase);
 
-            if (parameters.phaseOffset != 0)
-                localPhase = wrapValue ((float) std::fmod (phase + parameters.phaseOffset, 1.0f), 1.0f);
-            else
-                localPhase = wrapValue ((float) phase, 1.0f);
+        // The random value changes each time the phase wraps around
+        if (parameters.waveShape == random && (advance >= 1.0 || getLocalPhase() < lastLocalPhase))
+            lastRandomVal = randomSource.nextFloat() * 2.0f - 1.0f;
 
-            jassert (localPhase >= 0.0f && localPhase <= 1.0f);
-
-            if (parameters.waveShape == random)
-            {
-                if (localPhase < lastLocalPhase)
-                    lastRandomVal = randomSource.nextFloat() * 2.0f - 1.0f;
-
-                lastLocalPhase = localPhase;
-            }
-        }
+        lastLocalPhase = getLocalPhase();
     }
 
     float getCurrentValue()
     {
-        float val = 0.0f, localPhase = 0.0f;
-
-        if (parameters.phaseOffset != 0)
-            localPhase = wrapValue ((float) std::fmod (phase + parameters.phaseOffset, 1.0f), 1.0f);
-        else
-            localPhase = wrapValue ((float) phase, 1.0f);
-
-        jassert (localPhase >= 0.0f && localPhase <= 1.0f);
+        float val = 0.0f;
+        const float localPhase = getLocalPhase();
 
         switch (parameters.waveShape)
         {
             case none:      val = 0; break;
-            case sine:      val = std::sin (localPhase * juce::float_Pi * 2); break;
-            case triangle:  val = (localPhase < 0.5f) ? (4.0f * localPhase - 1.0f) : (-4.0f * localPhase + 3.0f); break;
-            case sawUp:     val = localPhase * 2.0f - 1.0f; break;
-            case sawDown:   val = (1.0f - localPhase) * 2.0f - 1.0f; break;
-            case square:    val = (localPhase < parameters.pulseWidth) ? 1.0f : -1.0f; break;
+            case sine:      val = ControlRateWaves::sine (localPhase); break;
+            case triangle:  val = ControlRateWaves::triangle (localPhase); break;
+            case sawUp:     val = ControlRateWaves::sawUp (localPhase); break;
+            case sawDown:   val = ControlRateWaves::sawDown (localPhase); break;
+            case square:    val = ControlRateWaves::square (localPhase, parameters.pulseWidth); break;
             case random:    val = lastRandomVal; break;
         }
 
@@ -148,6 +131,19 @@ private:
 
     juce::Random randomSource {1};
 
+    float getLocalPhase()
+    {
+        float localPhase = 0.0f;
+
+        if (parameters.phaseOffset != 0)
+            localPhase = wrapValue ((float) std::fmod (phase + parameters.phaseOffset, 1.0f), 1.0f);
+        else
+            localPhase = wrapValue ((float) phase, 1.0f);
+
+        jassert (localPhase >= 0.0f && localPhase <= 1.0f);
+        return localPhase;
+    }
+
     inline float wrapValue (float v, float range)
     {
         while (v >= range) v -= range;
@@ -186,6 +182,7 @@ public:
     void deinitialise() override;
 
     void reset() override;
+    double getLatencySeconds() override                 { return distortionOversampler.getLatencySeconds(); }
 
     void applyToBuffer (const AudioRenderContext&) override;
 
@@ -292,6 +289,12 @@ public:
     juce::CachedValue<float> distortionValue;
     AutomatableParameter::Ptr distortion;
 
+    /** Runs the distortion at 1, 2, 4 or 8 times the sample rate to reduce aliasing.
+        Whilst this is above 1 the latency stays the same whether the distortion is on or not.
+    */
+    juce::CachedValue<int> oversamplingFactor;
+    juce::CachedValue<bool> oversamplingLinearPhase;
+
     juce::CachedValue<float> reverbSizeValue, reverbDampingValue, reverbWidthValue, reverbMixValue;
     AutomatableParameter::Ptr reverbSize, reverbDamping, reverbWidth, reverbMix;
 
@@ -390,6 +393,7 @@ private:
     float paramValue (AutomatableParameter::Ptr param);
 
     TempoSequencePosition currentPos {edit.tempoSequence};
+    Oversampler distortionOversampler;
     juce::Reverb reverb;
     std::unique_ptr<FODelay> delay;
     std::unique_ptr<FOChorus> chorus;
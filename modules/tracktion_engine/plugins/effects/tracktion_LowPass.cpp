@@ -36,7 +36,11 @@ const char* LowPassPlugin::xmlTypeName = "lowpass";
 
 void LowPassPlugin::updateFilters()
 {
-    const float newFreq = frequency->getCurrentValue();
+    updateFilters (frequency->getCurrentValue());
+}
+
+void LowPassPlugin::updateFilters (float newFreq)
+{
     const bool nowLowPass = isLowPass();
 
     if (currentFilterFreq != newFreq || nowLowPass != isCurrentlyLowPass)
@@ -73,12 +77,31 @@ void LowPassPlugin::applyToBuffer (const AudioRenderContext& fc)
     {
         SCOPED_REALTIME_CHECK
 
-        updateFilters();
-
         clearChannels (*fc.destBuffer, 2, -1, fc.bufferStartSample, fc.bufferNumSamples);
-
-        for (int i = jmin (2, fc.destBuffer->getNumChannels()); --i >= 0;)
-            filter[i].processSamples (fc.destBuffer->getWritePointer (i, fc.bufferStartSample), fc.bufferNumSamples);
+        const int numChans = jmin (2, fc.destBuffer->getNumChannels());
+
+        if (frequency->isRampingOverBlock())
+        {
+            // Step the coefficients along the automation ramp in short chunks, which is much
+            // cheaper than having the whole plugin called for sub-blocks
+            for (int pos = 0; pos < fc.bufferNumSamples;)
+            {
+                const int num = jmin ((int) automationRampChunkSize, fc.bufferNumSamples - pos);
+                updateFilters (frequency->getValueInBlock ((pos + num) / (float) fc.bufferNumSamples));
+
+                for (int i = numChans; --i >= 0;)
+                    filter[i].processSamples (fc.destBuffer->getWritePointer (i, fc.bufferStartSample + pos), num);
+
+                pos += num;
+            }
+        }
+        else
+        {
+            updateFilters();
+
+            for (int i = numChans; --i >= 0;)
+                filter[i].processSamples (fc.destBuffer->getWritePointer (i, fc.bufferStartSample), fc.bufferNumSamples);
+        }
 
         sanitiseValues (*fc.destBuffer, fc.bufferStartSample, fc.bufferNumSamples, 3.0f);
     }
@@ -26,6 +26,7 @@ public:
     juce::String getShortName (int) override            { return "HP/LP"; }
     juce::String getSelectableDescription() override    { return TRANS("Low/High-Pass Filter"); }
     bool needsConstantBufferSize() override             { return false; }
+    bool rampsAutomationAcrossBlocks() override         { return true; }
 
     void initialise (const PlaybackInitialisationInfo&) override;
     void deinitialise() override;
@@ -44,7 +45,11 @@ private:
     float currentFilterFreq = 0;
     bool isCurrentlyLowPass = false;
 
+    // The filters are processed in chunks of this many samples while their automation ramps
+    enum { automationRampChunkSize = 32 };
+
     void updateFilters();
+    void updateFilters (float frequency);
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LowPassPlugin)
 };
@@ -43,6 +43,7 @@ struct PatchBayPlugin::WireList  : public ValueTreeObjectList<PatchBayPlugin::Wi
 
     void handleAsyncUpdate() override
     {
+        patchbay.updateRouting();
         patchbay.changed();
     }
 
@@ -57,6 +58,8 @@ PatchBayPlugin::PatchBayPlugin (PluginCreationInfo info) : Plugin (info)
     if (info.isNewPlugin)
         for (int i = 0; i < 2; ++i)
             makeConnection (i, i, 0.0f, nullptr);
+
+    updateRouting();
 }
 
 PatchBayPlugin::~PatchBayPlugin()
@@ -108,12 +111,45 @@ void PatchBayPlugin::getChannelNames (StringArray* ins, StringArray* outs)
     }
 }
 
-void PatchBayPlugin::initialise (const PlaybackInitialisationInfo&)
+void PatchBayPlugin::initialise (const PlaybackInitialisationInfo& info)
 {
+    routingBuffer.setSize (2, info.blockSizeSamples);
 }
 
 void PatchBayPlugin::deinitialise()
 {
+    routingBuffer.setSize (2, 0);
+}
+
+void PatchBayPlugin::updateRouting()
+{
+    Routing newRouting;
+    int maxOutputChan = 1;
+
+    for (auto w : list->objects)
+    {
+        maxOutputChan = jmax (w->destChannelIndex.get(), maxOutputChan);
+
+        if (isPositiveAndBelow (w->destChannelIndex.get(), 2) && w->sourceChannelIndex >= 0)
+            newRouting.sources[w->destChannelIndex].add ({ w->sourceChannelIndex, dbToGain (w->gainDb.get()) });
+    }
+
+    newRouting.numOutputChannels = jmin (2, maxOutputChan + 1);
+    newRouting.isIdentity = true;
+
+    for (int i = 0; i < newRouting.numOutputChannels; ++i)
+    {
+        auto& sources = newRouting.sources[i];
+
+        if (sources.size() != 1 || sources.getReference (0).channel != i || sources.getReference (0).gain != 1.0f)
+            newRouting.isIdentity = false;
+    }
+
+    // Swapping the arrays doesn't allocate, and the old ones get freed here on the message thread
+    {
+        const ScopedLock sl (list->arrayLock);
+        std::swap (routing, newRouting);
+    }
 }
 
 void PatchBayPlugin::applyToBuffer (const AudioRenderContext& fc)
@@ -122,31 +158,48 @@ void PatchBayPlugin::applyToBuffer (const AudioRenderContext& fc)
     {
         SCOPED_REALTIME_CHECK
 
-        int maxOutputChan = 1;
-        AudioScratchBuffer scratch (2, fc.bufferNumSamples);
-        auto& outputBuffer = scratch.buffer;
-        outputBuffer.clear();
+        const ScopedLock sl (list->arrayLock);
+        auto& buffer = *fc.destBuffer;
+        const int numInputChans = buffer.getNumChannels();
+        const int numOutputChans = routing.numOutputChannels;
+
+        // Straight-through wiring at unity gain leaves the audio where it is
+        if (routing.isIdentity && numInputChans >= numOutputChans)
+        {
+            if (numInputChans != numOutputChans)
+                buffer.setSize (numOutputChans, buffer.getNumSamples(), true, false, true);
+
+            return;
+        }
+
+        if (routingBuffer.getNumSamples() < fc.bufferNumSamples)
+            routingBuffer.setSize (2, fc.bufferNumSamples, false, false, true);
 
+        for (int i = 0; i < numOutputChans; ++i)
         {
-            const ScopedLock sl (list->arrayLock);
+            bool isFirstSource = true;
 
-            for (auto w : list->objects)
+            for (auto& source : routing.sources[i])
             {
-                maxOutputChan = jmax (w->destChannelIndex.get(), maxOutputChan);
+                if (source.channel >= numInputChans)
+                    continue;
+
+                if (isFirstSource)
+                    routingBuffer.copyFrom (i, 0, buffer.getReadPointer (source.channel, fc.bufferStartSample), fc.bufferNumSamples, source.gain);
+                else
+                    routingBuffer.addFrom (i, 0, buffer, source.channel, fc.bufferStartSample, fc.bufferNumSamples, source.gain);
 
-                if (w->destChannelIndex < 2 && w->sourceChannelIndex < fc.destBuffer->getNumChannels())
-                    outputBuffer.addFrom (w->destChannelIndex, 0,
-                                          *fc.destBuffer, w->sourceChannelIndex, fc.bufferStartSample,
-                                          fc.bufferNumSamples,
-                                          dbToGain (w->gainDb));
+                isFirstSource = false;
             }
+
+            if (isFirstSource)
+                routingBuffer.clear (i, 0, fc.bufferNumSamples);
         }
 
-        maxOutputChan = jmin (2, maxOutputChan + 1);
-        fc.destBuffer->setSize (maxOutputChan, fc.destBuffer->getNumSamples(), false);
+        buffer.setSize (numOutputChans, buffer.getNumSamples(), false, false, true);
 
-        for (int i = maxOutputChan; --i >= 0;)
-            fc.destBuffer->copyFrom (i, fc.bufferStartSample, outputBuffer, i, 0, fc.bufferNumSamples);
+        for (int i = numOutputChans; --i >= 0;)
+            buffer.copyFrom (i, fc.bufferStartSample, routingBuffer, i, 0, fc.bufferNumSamples);
     }
 }
 
@@ -58,6 +58,27 @@ private:
     std::unique_ptr<WireList> list;
     bool recursionCheck = false;
 
+    /** The wires compiled into the sources and gains for each output channel,
+        so the audio thread doesn't have to walk the wire list.
+    */
+    struct Routing
+    {
+        struct Source
+        {
+            int channel;
+            float gain;
+        };
+
+        juce::Array<Source> sources[2];
+        int numOutputChannels = 1;
+        bool isIdentity = false;
+    };
+
+    Routing routing;
+    juce::AudioBuffer<float> routingBuffer;
+
+    void updateRouting();
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PatchBayPlugin)
 };
 
@@ -11,6 +11,99 @@
 namespace tracktion_engine
 {
 
+/**
+    A pitch shifter made of two taps sweeping through a delay line half a window apart,
+    crossfaded so that each one is silent as it jumps back to the other end.
+
+    Everything is allocated in prepare(), and the latency only depends on the sample rate,
+    so the pitch can be automated freely.
+*/
+class RealtimePitchShifter
+{
+public:
+    RealtimePitchShifter() = default;
+
+    void prepare (double sampleRate)
+    {
+        windowSize = juce::jmax (64, juce::roundToInt (sampleRate * windowMs / 1000.0));
+
+        for (auto& l : delayLines)
+            l.setMaxDelaySamples (windowSize + 2);
+
+        reset();
+    }
+
+    void reset() noexcept
+    {
+        for (auto& l : delayLines)
+            l.clear();
+
+        phase = 0.0f;
+    }
+
+    /** The taps average half a window behind the input. */
+    int getLatencySamples() const noexcept      { return windowSize / 2; }
+
+    void process (juce::AudioBuffer<float>& buffer, int startSample, int numSamples, float semitonesUp) noexcept
+    {
+        const int numChannels = juce::jmin (buffer.getNumChannels(), (int) numElementsInArray (delayLines));
+        const float ratio = std::pow (2.0f, semitonesUp / 12.0f);
+
+        // The taps' delays change by (1 - ratio) samples each sample, which resamples by the ratio
+        const float phaseIncrement = (1.0f - ratio) / (float) windowSize;
+        const float window = (float) windowSize;
+
+        while (numSamples > 0)
+        {
+            // The delays and gains are worked out once for all the channels
+            const int num = juce::jmin (numSamples, (int) numElementsInArray (gainsA));
+
+            for (int i = 0; i < num; ++i)
+            {
+                phase += phaseIncrement;
+                phase -= std::floor (phase);
+
+                auto phaseB = phase + 0.5f;
+                phaseB -= std::floor (phaseB);
+
+                delaysA[i] = 1.0f + phase * window;
+                delaysB[i] = 1.0f + phaseB * window;
+
+                // sin^2 and cos^2 always add up to one
+                auto s = std::sin (juce::MathConstants<float>::pi * phase);
+                gainsA[i] = s * s;
+            }
+
+            for (int chan = 0; chan < numChannels; ++chan)
+            {
+                auto& delayLine = delayLines[chan];
+                auto data = buffer.getWritePointer (chan, startSample);
+
+                for (int i = 0; i < num; ++i)
+                {
+                    delayLine.push (data[i]);
+                    data[i] = delayLine.readInterpolated (delaysA[i]) * gainsA[i]
+                                + delayLine.readInterpolated (delaysB[i]) * (1.0f - gainsA[i]);
+                }
+            }
+
+            startSample += num;
+            numSamples -= num;
+        }
+    }
+
+private:
+    static constexpr double windowMs = 40.0;
+
+    DelayLine delayLines[2];
+    int windowSize = 0;
+    float phase = 0.0f;
+    float delaysA[256], delaysB[256], gainsA[256];
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (RealtimePitchShifter)
+};
+
+//==============================================================================
 struct PitchShiftPlugin::Pimpl
 {
     static constexpr int samplesPerBlock = 512;
@@ -19,8 +112,20 @@ struct PitchShiftPlugin::Pimpl
     {
     }
 
-    void initialise (double sr, float semitonesUp, TimeStretcher::Mode newMode, TimeStretcher::ElastiqueProOptions newOptions)
+    void initialise (double sr, float semitonesUp, bool shouldUseRealtimeShifter,
+                     TimeStretcher::Mode newMode, TimeStretcher::ElastiqueProOptions newOptions)
     {
+        usingRealtimeShifter = shouldUseRealtimeShifter;
+
+        if (usingRealtimeShifter)
+        {
+            timestretcher.reset();
+            realtimeShifter.prepare (sr);
+            latencySamples = realtimeShifter.getLatencySamples();
+            latencySeconds = latencySamples / sr;
+            return;
+        }
+
         if (timestretcher == nullptr || mode != newMode || elastiqueOptions != newOptions)
         {
             mode = newMode;
@@ -57,14 +162,20 @@ struct PitchShiftPlugin::Pimpl
     {
         SCOPED_REALTIME_CHECK
 
-        if (timestretcher->isInitialised())
+        if (usingRealtimeShifter)
         {
-            auto newMode = (TimeStretcher::Mode) owner.mode.get();
-            auto newOptions = owner.elastiqueOptions.get();
+            realtimeShifter.process (*fc.destBuffer, fc.bufferStartSample, fc.bufferNumSamples, semis);
 
-            if (newMode != mode || newOptions != elastiqueOptions)
-                initialise (owner.sampleRate, semis, newMode, newOptions);
+            if (fc.bufferForMidiMessages != nullptr)
+                fc.bufferForMidiMessages->addToNoteNumbers (roundToInt (semis));
 
+            return;
+        }
+
+        // Changes to the mode or options restart playback, so they're picked up by initialise
+        // rather than reallocating the stretcher here
+        if (timestretcher != nullptr && timestretcher->isInitialised())
+        {
             inputFifo.write (*fc.destBuffer, fc.bufferStartSample, fc.bufferNumSamples);
 
             int needed = timestretcher->getFramesNeeded();
@@ -101,6 +212,9 @@ struct PitchShiftPlugin::Pimpl
 
     AudioFifo inputFifo { 2, 2000 }, outputFifo { 2, 2000 };
 
+    RealtimePitchShifter realtimeShifter;
+    bool usingRealtimeShifter = false;
+
     double latencySeconds = 0.0;
     int latencySamples = 0;
 
@@ -125,8 +239,15 @@ PitchShiftPlugin::PitchShiftPlugin (PluginCreationInfo info) : Plugin (info)
     semitonesValue.referTo (state, IDs::semitonesUp, um);
     mode.referTo (state, IDs::mode, um, (int) TimeStretcher::defaultMode);
     elastiqueOptions.referTo (state, IDs::elastiqueOptions, um);
+    lowLatency.referTo (state, IDs::lowLatency, um);
 
     semitones->attachToCurrentValue (semitonesValue);
+
+    playbackRestartTimer.setCallback ([this]
+                                      {
+                                          edit.restartPlayback();
+                                          playbackRestartTimer.stopTimer();
+                                      });
 }
 
 PitchShiftPlugin::PitchShiftPlugin (Edit& ed, const juce::ValueTree& v)
@@ -153,7 +274,7 @@ const char* PitchShiftPlugin::xmlTypeName = "pitchShifter";
 //==============================================================================
 void PitchShiftPlugin::initialise (const PlaybackInitialisationInfo& info)
 {
-    pimpl->initialise (info.sampleRate, semitones->getCurrentValue(),
+    pimpl->initialise (info.sampleRate, semitones->getCurrentValue(), lowLatency.get(),
                        (TimeStretcher::Mode) mode.get(), elastiqueOptions.get());
 }
 
@@ -182,11 +303,22 @@ void PitchShiftPlugin::restorePluginStateFromValueTree (const juce::ValueTree& v
 {
     CachedValue<float>* cvsFloat[]  = { &semitonesValue, nullptr };
     CachedValue<int>* cvsInt[]      = { &mode, nullptr };
+    CachedValue<bool>* cvsBool[]    = { &lowLatency, nullptr };
     copyPropertiesToNullTerminatedCachedValues (v, cvsFloat);
     copyPropertiesToNullTerminatedCachedValues (v, cvsInt);
+    copyPropertiesToNullTerminatedCachedValues (v, cvsBool);
 
     for (auto p : getAutomatableParameters())
         p->updateFromAttachedValue();
 }
 
+void PitchShiftPlugin::valueTreePropertyChanged (ValueTree& v, const juce::Identifier& id)
+{
+    // These change the latency, so the graph needs rebuilding
+    if (v == state && (id == IDs::mode || id == IDs::elastiqueOptions || id == IDs::lowLatency))
+        playbackRestartTimer.startTimer (50);
+
+    Plugin::valueTreePropertyChanged (v, id);
+}
+
 }
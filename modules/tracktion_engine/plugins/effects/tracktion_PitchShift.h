@@ -40,6 +40,12 @@ public:
     juce::CachedValue<float> semitonesValue;
     juce::CachedValue<int> mode;
     juce::CachedValue<TimeStretcher::ElastiqueProOptions> elastiqueOptions;
+
+    /** If this is true, a built-in granular pitch shifter is used instead of the TimeStretcher.
+        It has a short, fixed latency and works on polyphonic material, but doesn't preserve formants,
+        which needs the elastique modes. Changing this, the mode or the options restarts playback.
+    */
+    juce::CachedValue<bool> lowLatency;
     AutomatableParameter::Ptr semitones;
 
     static float getMaximumSemitones()   { return 2.0f * 12.0f; }
@@ -47,6 +53,9 @@ public:
 private:
     struct Pimpl;
     std::unique_ptr<Pimpl> pimpl;
+    LambdaTimer playbackRestartTimer;
+
+    void valueTreePropertyChanged (juce::ValueTree&, const juce::Identifier&) override;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PitchShiftPlugin)
 };
@@ -151,6 +151,17 @@ void ReverbPlugin::applyToBuffer (const AudioRenderContext& fc)
     }
 }
 
+double ReverbPlugin::getTailLength() const
+{
+    if (modeParam->getCurrentValue() >= 0.5f)
+        return std::numeric_limits<double>::infinity();
+
+    // juce::Reverb's longest comb filter is 1617 samples at 44.1kHz, with a feedback of
+    // roomSize * 0.28 + 0.7, so this is roughly how long it takes to decay by 120dB
+    const double combFeedback = roomSizeParam->getCurrentValue() * 0.28 + 0.7;
+    return (1617.0 / 44100.0) * std::log (1.0e-6) / std::log (combFeedback);
+}
+
 void ReverbPlugin::restorePluginStateFromValueTree (const juce::ValueTree& v)
 {
     CachedValue<float>* cvsFloat[]  = { &roomSizeValue, &dampValue, &wetValue, &dryValue, &widthValue, &modeValue, nullptr };
@@ -30,6 +30,8 @@ public:
     void reset() override;
     int getNumOutputChannelsGivenInputs (int numInputChannels) override { return juce::jmin (numInputChannels, 2); }
     void applyToBuffer (const AudioRenderContext&) override;
+    bool noTail() override                              { return false; }
+    double getTailLength() const override;
     juce::String getSelectableDescription() override    { return TRANS("Reverb Plugin"); }
     void restorePluginStateFromValueTree (const juce::ValueTree&) override;
 
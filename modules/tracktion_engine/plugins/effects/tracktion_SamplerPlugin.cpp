@@ -15,40 +15,53 @@ namespace tracktion_engine
 static constexpr int minimumSamplesToPlayWhenStopping = 8;
 static constexpr int maximumSimultaneousNotes = 32;
 
+// when streaming, this much of the start of each sound is kept in memory, which
+// gives the cache time to read ahead before a note needs the rest of the file
+static constexpr int streamingHeadSamples = 32768;
 
-struct SamplerPlugin::SampledNote   : public ReferenceCountedObject
+
+struct SamplerPlugin::SampledNote
 {
 public:
-    SampledNote (int midiNote, int keyNote,
-                 float velocity,
-                 const AudioFile& file,
-                 double sampleRate,
-                 int sampleDelayFromBufferStart,
-                 const juce::AudioBuffer<float>& data,
-                 int lengthInSamples,
-                 float gainDb,
-                 float pan,
-                 bool openEnded_)
-       : note (midiNote),
-         offset (-sampleDelayFromBufferStart),
-         audioData (data),
-         openEnded (openEnded_)
+    SampledNote() = default;
+
+    /** Starts the voice playing a sound. The sound must stay alive until the voice is stopped. */
+    void start (int midiNote, float velocity, const SamplerSound& s,
+                double sampleRate, int sampleDelayFromBufferStart,
+                AudioFileCache::Reader* streamReader)
     {
+        sound = &s;
+        reader = streamReader;
+        note = midiNote;
+        offset = -sampleDelayFromBufferStart;
+        openEnded = s.openEnded;
+        startFade = 1.0f;
+        isFinished = false;
+        isActive = true;
+
         resampler[0].reset();
         resampler[1].reset();
 
-        const float volumeSliderPos = decibelsToVolumeFaderPosition (gainDb - (20.0f * (1.0f - velocity)));
-        getGainsFromVolumeFaderPositionAndPan (volumeSliderPos, pan, getDefaultPanLaw(), gains[0], gains[1]);
+        const float volumeSliderPos = decibelsToVolumeFaderPosition (s.gainDb - (20.0f * (1.0f - velocity)));
+        getGainsFromVolumeFaderPositionAndPan (volumeSliderPos, s.pan, getDefaultPanLaw(), gains[0], gains[1]);
 
         const double hz = MidiMessage::getMidiNoteInHertz (midiNote);
-        playbackRatio = hz / MidiMessage::getMidiNoteInHertz (keyNote);
-        playbackRatio *= file.getSampleRate() / sampleRate;
-        samplesLeftToPlay = playbackRatio > 0 ? (1 + (int) (lengthInSamples / playbackRatio)) : 0;
+        playbackRatio = hz / MidiMessage::getMidiNoteInHertz (s.keyNote);
+        playbackRatio *= s.audioFile.getSampleRate() / sampleRate;
+        samplesLeftToPlay = playbackRatio > 0 ? (1 + (int) (s.fileLengthSamples / playbackRatio)) : 0;
     }
 
-    void addNextBlock (juce::AudioBuffer<float>& outBuffer, int startSamp, int numSamples)
+    void stop()
     {
-        jassert (! isFinished);
+        isActive = false;
+        sound = nullptr;
+        reader = nullptr;
+    }
+
+    void addNextBlock (juce::AudioBuffer<float>& outBuffer, int startSamp, int numSamples, bool isRendering)
+    {
+        jassert (isActive && ! isFinished);
+        auto& audioData = sound->audioData;
 
         if (offset < 0)
         {
@@ -62,22 +75,22 @@ public:
 
         if (numSamps > 0)
         {
-            int numUsed = 0;
+            const int numSampsNeeded = 4 + (int) std::ceil (numSamps * playbackRatio);
 
-            for (int i = jmin (2, outBuffer.getNumChannels()); --i >= 0;)
+            // Preloaded sounds and the head of streamed ones can be resampled directly from memory
+            if (reader == nullptr || offset + numSampsNeeded <= audioData.getNumSamples())
+            {
+                renderFrom (audioData, offset, outBuffer, startSamp, numSamps);
+                jassert (offset <= audioData.getNumSamples());
+            }
+            else
             {
-                numUsed = resampler[i]
-                            .processAdding (playbackRatio,
-                                            audioData.getReadPointer (jmin (i, audioData.getNumChannels() - 1), offset),
-                                            outBuffer.getWritePointer (i, startSamp),
-                                            numSamps,
-                                            gains[i]);
+                AudioScratchBuffer scratch (audioData.getNumChannels(), numSampsNeeded);
+                readSourceSamples (scratch.buffer, numSampsNeeded, isRendering);
+                renderFrom (scratch.buffer, 0, outBuffer, startSamp, numSamps);
             }
 
-            offset += numUsed;
             samplesLeftToPlay -= numSamps;
-
-            jassert (offset <= audioData.getNumSamples());
         }
 
         if (numSamples > numSamps && startFade > 0.0f)
@@ -99,7 +112,12 @@ public:
             const int numSampsNeeded = 2 + roundToInt ((numSamps + 2) * playbackRatio);
             AudioScratchBuffer scratch (audioData.getNumChannels(), numSampsNeeded + 8);
 
-            if (offset + numSampsNeeded < audioData.getNumSamples())
+            if (reader != nullptr)
+            {
+                scratch.buffer.clear();
+                readSourceSamples (scratch.buffer, numSampsNeeded, isRendering);
+            }
+            else if (offset + numSampsNeeded < audioData.getNumSamples())
             {
                 for (int i = scratch.buffer.getNumChannels(); --i >= 0;)
                     scratch.buffer.copyFrom (i, 0, audioData, i, offset, numSampsNeeded);
@@ -114,16 +132,7 @@ public:
                                                        AudioFadeCurve::linear, startFade, endFade);
 
             startFade = endFade;
-
-            int numUsed = 0;
-
-            for (int i = jmin (2, outBuffer.getNumChannels()); --i >= 0;)
-                numUsed = resampler[i].processAdding (playbackRatio,
-                                                      scratch.buffer.getReadPointer (jmin (i, scratch.buffer.getNumChannels() - 1)),
-                                                      outBuffer.getWritePointer (i, startSamp),
-                                                      numSamps, gains[i]);
-
-            offset += numUsed;
+            renderFrom (scratch.buffer, 0, outBuffer, startSamp, numSamps);
 
             if (startFade <= 0.0f)
                 isFinished = true;
@@ -131,22 +140,76 @@ public:
     }
 
     LagrangeInterpolator resampler[2];
-    int note;
-    int offset, samplesLeftToPlay = 0;
-    float gains[2];
+    const SamplerSound* sound = nullptr;
+    AudioFileCache::Reader* reader = nullptr;
+    int note = 0;
+    int offset = 0, samplesLeftToPlay = 0;
+    float gains[2] = { 0, 0 };
     double playbackRatio = 1.0;
-    const juce::AudioBuffer<float>& audioData;
-    float lastVals[4] = { 0, 0, 0, 0 };
     float startFade = 1.0f;
-    bool openEnded, isFinished = false;
+    bool openEnded = false, isFinished = false, isActive = false;
 
 private:
+    void renderFrom (const juce::AudioBuffer<float>& source, int sourceOffset,
+                     juce::AudioBuffer<float>& outBuffer, int startSamp, int numSamps)
+    {
+        int numUsed = 0;
+
+        for (int i = jmin (2, outBuffer.getNumChannels()); --i >= 0;)
+            numUsed = resampler[i].processAdding (playbackRatio,
+                                                  source.getReadPointer (jmin (i, source.getNumChannels() - 1), sourceOffset),
+                                                  outBuffer.getWritePointer (i, startSamp),
+                                                  numSamps, gains[i]);
+
+        offset += numUsed;
+    }
+
+    /** Fills the start of a buffer with the sound's samples from the current offset,
+        taking them from the preloaded head and then the stream.
+    */
+    void readSourceSamples (juce::AudioBuffer<float>& dest, int numSamples, bool isRendering)
+    {
+        auto& head = sound->audioData;
+        const int numFromHead = jlimit (0, numSamples, head.getNumSamples() - offset);
+
+        if (numFromHead > 0)
+            for (int i = dest.getNumChannels(); --i >= 0;)
+                dest.copyFrom (i, 0, head, jmin (i, head.getNumChannels() - 1), offset, numFromHead);
+
+        if (numFromHead == numSamples)
+            return;
+
+        reader->setReadPosition (sound->fileStartSample + offset + numFromHead);
+
+        for (int done = numFromHead; done < numSamples;)
+        {
+            const int numThisTime = jmin (8192, numSamples - done);
+
+            if (! reader->readSamples (numThisTime, dest, sound->audioDataChannels, done,
+                                       AudioChannelSet::stereo(), isRendering ? 5000 : 3))
+            {
+                // The cache couldn't keep up, so this will be a drop-out rather than a stall
+                for (int i = dest.getNumChannels(); --i >= 0;)
+                    dest.clear (i, done, numSamples - done);
+
+                break;
+            }
+
+            done += numThisTime;
+        }
+    }
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SampledNote)
 };
 
 //==============================================================================
 SamplerPlugin::SamplerPlugin (PluginCreationInfo info)  : Plugin (info)
 {
+    streamFromDisk.referTo (state, IDs::streamFromDisk, getUndoManager(), false);
+
+    for (int i = 0; i < maximumSimultaneousNotes; ++i)
+        voices.add (new SampledNote());
+
     triggerAsyncUpdate();
 }
 
@@ -169,6 +232,7 @@ void SamplerPlugin::handleAsyncUpdate()
 
     auto numSounds = state.getNumChildren();
 
+    // The sounds are loaded before taking the lock, so the audio thread is only kept out for the swap
     for (int i = 0; i < numSounds; ++i)
     {
         auto v = getSound (i);
@@ -192,28 +256,10 @@ void SamplerPlugin::handleAsyncUpdate()
         }
     }
 
-    for (auto newSound : newSounds)
-    {
-        for (auto s : soundList)
-        {
-            if (s->source == newSound->source
-                && s->startTime == newSound->startTime
-                && s->length == newSound->length)
-            {
-                newSound->audioFile = s->audioFile;
-                newSound->fileStartSample = s->fileStartSample;
-                newSound->fileLengthSamples = s->fileLengthSamples;
-                newSound->audioData = s->audioData;
-            }
-        }
-    }
-
     {
         const ScopedLock sl (lock);
         allNotesOff();
         soundList.swapWith (newSounds);
-
-        sourceMediaChanged();
     }
 
     newSounds.clear();
@@ -222,7 +268,6 @@ void SamplerPlugin::handleAsyncUpdate()
 
 void SamplerPlugin::initialise (const PlaybackInitialisationInfo&)
 {
-    const ScopedLock sl (lock);
     allNotesOff();
 }
 
@@ -233,73 +278,101 @@ void SamplerPlugin::deinitialise()
 
 //==============================================================================
 void SamplerPlugin::playNotes (const BigInteger& keysDown)
+{
+    // The voices are only started and stopped on the audio thread, so this just passes the keys on
+    const SpinLock::ScopedLockType sl (requestedKeysLock);
+    requestedKeysDown = keysDown;
+    requestedKeysChanged = true;
+}
+
+void SamplerPlugin::allNotesOff()
 {
     const ScopedLock sl (lock);
 
+    for (auto v : voices)
+        v->stop();
+
+    highlightedNotes.clear();
+}
+
+SamplerPlugin::SampledNote* SamplerPlugin::startVoice (int note, float velocity, const SamplerSound& sound,
+                                                       int sampleDelayFromBufferStart)
+{
+    for (int i = 0; i < voices.size(); ++i)
+    {
+        auto v = voices.getUnchecked (i);
+
+        if (! v->isActive)
+        {
+            v->start (note, velocity, sound, sampleRate, sampleDelayFromBufferStart,
+                      sound.streamReaders.getObjectPointer (i));
+            return v;
+        }
+    }
+
+    return nullptr;
+}
+
+void SamplerPlugin::applyRequestedKeys()
+{
+    if (! requestedKeysChanged.load())
+        return;
+
+    BigInteger keysDown;
+
+    {
+        const SpinLock::ScopedTryLockType sl (requestedKeysLock);
+
+        if (! sl.isLocked())
+            return;
+
+        keysDown = requestedKeysDown;
+        requestedKeysChanged = false;
+    }
+
     if (highlightedNotes != keysDown)
     {
-        for (int i = playingNotes.size(); --i >= 0;)
-            if ((! keysDown [playingNotes.getUnchecked(i)->note])
-                 && highlightedNotes [playingNotes.getUnchecked(i)->note]
-                 && ! playingNotes.getUnchecked(i)->openEnded)
-                playingNotes.getUnchecked(i)->samplesLeftToPlay = minimumSamplesToPlayWhenStopping;
+        for (auto v : voices)
+            if (v->isActive
+                 && (! keysDown [v->note])
+                 && highlightedNotes [v->note]
+                 && ! v->openEnded)
+                v->samplesLeftToPlay = minimumSamplesToPlayWhenStopping;
 
         for (int note = 128; --note >= 0;)
-        {
             if (keysDown [note] && ! highlightedNotes [note])
-            {
                 for (auto ss : soundList)
-                {
                     if (ss->minNote <= note
                          && ss->maxNote >= note
                          && ss->audioData.getNumSamples() > 0
-                         && (! ss->audioFile.isNull())
-                         && playingNotes.size() < maximumSimultaneousNotes)
-                    {
-                        playingNotes.add (new SampledNote (note,
-                                                           ss->keyNote,
-                                                           0.75f,
-                                                           ss->audioFile,
-                                                           sampleRate,
-                                                           0,
-                                                           ss->audioData,
-                                                           ss->fileLengthSamples,
-                                                           ss->gainDb,
-                                                           ss->pan,
-                                                           ss->openEnded));
-                    }
-                }
-            }
-        }
+                         && (! ss->audioFile.isNull()))
+                        startVoice (note, 0.75f, *ss, 0);
 
         highlightedNotes = keysDown;
     }
 }
 
-void SamplerPlugin::allNotesOff()
-{
-    const ScopedLock sl (lock);
-    playingNotes.clear();
-    highlightedNotes.clear();
-}
-
 void SamplerPlugin::applyToBuffer (const AudioRenderContext& fc)
 {
     if (fc.destBuffer != nullptr)
     {
         SCOPED_REALTIME_CHECK
 
-        const ScopedLock sl (lock);
-
         clearChannels (*fc.destBuffer, 2, -1, fc.bufferStartSample, fc.bufferNumSamples);
 
+        // The lock is only held by the message thread while the sounds are being swapped,
+        // which stops all the voices anyway, so rather than wait this block is left silent
+        const ScopedTryLock sl (lock);
+
+        if (! sl.isLocked())
+            return;
+
+        applyRequestedKeys();
+
         if (fc.bufferForMidiMessages != nullptr)
         {
             if (fc.bufferForMidiMessages->isAllNotesOff)
-            {
-                playingNotes.clear();
-                highlightedNotes.clear();
-            }
+                allNotesOff();
 
             for (auto& m : *fc.bufferForMidiMessages)
             {
@@ -308,12 +381,12 @@ void SamplerPlugin::applyToBuffer (const AudioRenderContext& fc)
                     const int note = m.getNoteNumber();
                     const int noteTimeSample = roundToInt (m.getTimeStamp() * sampleRate);
 
-                    for (auto playingNote : playingNotes)
+                    for (auto v : voices)
                     {
-                        if (playingNote->note == note && ! playingNote->openEnded)
+                        if (v->isActive && v->note == note && ! v->openEnded)
                         {
-                            playingNote->samplesLeftToPlay = jmin (playingNote->samplesLeftToPlay,
-                                                                   jmax (minimumSamplesToPlayWhenStopping, noteTimeSample));
+                            v->samplesLeftToPlay = jmin (v->samplesLeftToPlay,
+                                                         jmax (minimumSamplesToPlayWhenStopping, noteTimeSample));
                             highlightedNotes.clearBit (note);
                         }
                     }
@@ -322,22 +395,10 @@ void SamplerPlugin::applyToBuffer (const AudioRenderContext& fc)
                     {
                         if (ss->minNote <= note
                             && ss->maxNote >= note
-                            && ss->audioData.getNumSamples() > 0
-                            && playingNotes.size() < maximumSimultaneousNotes)
+                            && ss->audioData.getNumSamples() > 0)
                         {
-                            highlightedNotes.setBit (note);
-
-                            playingNotes.add (new SampledNote (note,
-                                                               ss->keyNote,
-                                                               m.getVelocity() / 127.0f,
-                                                               ss->audioFile,
-                                                               sampleRate,
-                                                               noteTimeSample,
-                                                               ss->audioData,
-                                                               ss->fileLengthSamples,
-                                                               ss->gainDb,
-                                                               ss->pan,
-                                                               ss->openEnded));
+                            if (startVoice (note, m.getVelocity() / 127.0f, *ss, noteTimeSample) != nullptr)
+                                highlightedNotes.setBit (note);
                         }
                     }
                 }
@@ -346,12 +407,12 @@ void SamplerPlugin::applyToBuffer (const AudioRenderContext& fc)
                     const int note = m.getNoteNumber();
                     const int noteTimeSample = roundToInt (m.getTimeStamp() * sampleRate);
 
-                    for (auto playingNote : playingNotes)
+                    for (auto v : voices)
                     {
-                        if (playingNote->note == note && ! playingNote->openEnded)
+                        if (v->isActive && v->note == note && ! v->openEnded)
                         {
-                            playingNote->samplesLeftToPlay = jmin (playingNote->samplesLeftToPlay,
-                                                                   jmax (minimumSamplesToPlayWhenStopping, noteTimeSample));
+                            v->samplesLeftToPlay = jmin (v->samplesLeftToPlay,
+                                                         jmax (minimumSamplesToPlayWhenStopping, noteTimeSample));
 
                             highlightedNotes.clearBit (note);
                         }
@@ -359,20 +420,22 @@ void SamplerPlugin::applyToBuffer (const AudioRenderContext& fc)
                 }
                 else if (m.isAllNotesOff() || m.isAllSoundOff())
                 {
-                    playingNotes.clear();
-                    highlightedNotes.clear();
+                    allNotesOff();
                 }
             }
         }
 
-        for (int i = playingNotes.size(); --i >= 0;)
+        for (int i = voices.size(); --i >= 0;)
         {
-            auto sn = playingNotes.getUnchecked (i);
+            auto v = voices.getUnchecked (i);
 
-            sn->addNextBlock (*fc.destBuffer, fc.bufferStartSample, fc.bufferNumSamples);
+            if (v->isActive)
+            {
+                v->addNextBlock (*fc.destBuffer, fc.bufferStartSample, fc.bufferNumSamples, fc.isRendering);
 
-            if (sn->isFinished)
-                playingNotes.remove (i);
+                if (v->isFinished)
+                    v->stop();
+            }
         }
     }
 }
@@ -417,6 +480,17 @@ bool SamplerPlugin::hasNameForMidiNoteNumber (int note, int, String& noteName)
     return true;
 }
 
+juce::int64 SamplerPlugin::getMemoryUsage()
+{
+    const ScopedLock sl (lock);
+    juce::int64 total = 0;
+
+    for (auto s : soundList)
+        total += s->audioData.getNumChannels() * (juce::int64) s->audioData.getNumSamples() * (juce::int64) sizeof (float);
+
+    return total;
+}
+
 AudioFile SamplerPlugin::getSoundFile (int index) const
 {
     const ScopedLock sl (lock);
@@ -485,10 +559,7 @@ String SamplerPlugin::addSound (const juce::String& source, const String& name,
 void SamplerPlugin::removeSound (int index)
 {
     state.removeChild (index, getUndoManager());
-
-    const ScopedLock sl (lock);
-    playingNotes.clear();
-    highlightedNotes.clear();
+    allNotesOff();
 }
 
 void SamplerPlugin::setSoundParams (int index, int keyNote, int minNote, int maxNote)
@@ -586,10 +657,9 @@ void SamplerPlugin::reassignReferencedItem (const ReferencedItem& item, ProjectI
 
 void SamplerPlugin::sourceMediaChanged()
 {
-    const ScopedLock sl (lock);
-
-    for (auto s : soundList)
-        s->refreshFile();
+    // Reloading the sounds replaces them all, without holding the lock while the files are read
+    triggerAsyncUpdate();
+    handleUpdateNowIfNeeded();
 }
 
 void SamplerPlugin::restorePluginStateFromValueTree (const juce::ValueTree& v)
@@ -651,15 +721,28 @@ void SamplerPlugin::SamplerSound::setExcerpt (double startTime_, double length_)
         fileStartSample = roundToInt (startTime * audioFile.getSampleRate());
         fileLengthSamples = roundToInt (length * audioFile.getSampleRate());
 
-        if (auto reader = owner.engine.getAudioFileManager().cache.createReader (audioFile))
+        auto& cache = owner.engine.getAudioFileManager().cache;
+        streamReaders.clear();
+
+        if (auto reader = cache.createReader (audioFile))
         {
-            audioData.setSize (audioFile.getNumChannels(), fileLengthSamples + 32);
+            // When streaming, only the head of long sounds is loaded and the voices read the
+            // rest through their own readers, so the cache can read ahead for each of them
+            const bool stream = owner.streamFromDisk && fileLengthSamples > streamingHeadSamples;
+            const int numSamplesToLoad = stream ? streamingHeadSamples : fileLengthSamples;
+
+            audioData.setSize (audioFile.getNumChannels(), stream ? numSamplesToLoad : numSamplesToLoad + 32);
             audioData.clear();
 
-            auto audioDataChannelSet = AudioChannelSet::canonicalChannelSet (audioFile.getNumChannels());
+            audioDataChannels = AudioChannelSet::canonicalChannelSet (audioFile.getNumChannels());
+            auto audioDataChannelSet = audioDataChannels;
             auto channelsToUse = AudioChannelSet::stereo();
 
-            int total = fileLengthSamples;
+            if (stream)
+                for (int i = 0; i < maximumSimultaneousNotes; ++i)
+                    streamReaders.add (cache.createReader (audioFile));
+
+            int total = numSamplesToLoad;
             int offset = 0;
 
             while (total > 0)
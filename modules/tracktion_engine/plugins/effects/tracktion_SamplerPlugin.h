@@ -46,6 +46,11 @@ public:
     void playNotes (const juce::BigInteger& keysDown);
     void allNotesOff();
 
+    /** If this is enabled, only the start of long sounds is kept in memory and the
+        rest is streamed from disk as the notes play.
+    */
+    juce::CachedValue<bool> streamFromDisk;
+
     //==============================================================================
     static const char* getPluginName()                  { return NEEDS_TRANS("Sampler"); }
     static const char* xmlTypeName;
@@ -71,6 +76,7 @@ public:
     juce::Array<ReferencedItem> getReferencedItems() override;
     void reassignReferencedItem (const ReferencedItem&, ProjectItemID newID, double newStartTime) override;
     void sourceMediaChanged() override;
+    juce::int64 getMemoryUsage() override;
 
     void restorePluginStateFromValueTree (const juce::ValueTree&) override;
 
@@ -92,7 +98,9 @@ public:
         float gainDb = 0, pan = 0;
         double startTime = 0, length = 0;
         AudioFile audioFile;
-        juce::AudioBuffer<float> audioData { 2, 64 };
+        juce::AudioBuffer<float> audioData { 2, 64 }; // just the head of the sound when it's streamed
+        juce::AudioChannelSet audioDataChannels;
+        juce::ReferenceCountedArray<AudioFileCache::Reader> streamReaders; // one per voice when streaming
 
     private:
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SamplerSound)
@@ -104,12 +112,19 @@ private:
 
     juce::Colour colour;
     juce::CriticalSection lock;
-    juce::ReferenceCountedArray<SampledNote> playingNotes;
+    juce::OwnedArray<SampledNote> voices;
     juce::OwnedArray<SamplerSound> soundList;
     juce::BigInteger highlightedNotes;
 
+    juce::SpinLock requestedKeysLock;
+    juce::BigInteger requestedKeysDown;
+    std::atomic<bool> requestedKeysChanged { false };
+
     juce::ValueTree getSound (int index) const;
 
+    SampledNote* startVoice (int note, float velocity, const SamplerSound&, int sampleDelayFromBufferStart);
+    void applyRequestedKeys();
+
     void valueTreeChanged() override;
     void handleAsyncUpdate() override;
 
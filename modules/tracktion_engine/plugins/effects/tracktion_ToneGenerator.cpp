@@ -21,8 +21,6 @@ StringArray ToneGeneratorPlugin::getOscTypeNames()
 ToneGeneratorPlugin::ToneGeneratorPlugin (PluginCreationInfo info)
     : Plugin (info)
 {
-    initialiseOscilators();
-    
     auto um = getUndoManager();
 
     oscType.referTo (state, IDs::oscType, um, static_cast<float> (OscType::sin));
@@ -51,14 +49,9 @@ const char* ToneGeneratorPlugin::xmlTypeName = "toneGenerator";
 void ToneGeneratorPlugin::initialise (const PlaybackInitialisationInfo& info)
 {
     scratch.setSize (1, info.blockSizeSamples);
-    auto samplesPerBlock = uint32 (info.blockSizeSamples);
-
-    sine.prepare        ({ sampleRate, uint32 (samplesPerBlock), 1 });
-    triangle.prepare    ({ sampleRate, uint32 (samplesPerBlock), 1 });
-    sawUp.prepare       ({ sampleRate, uint32 (samplesPerBlock), 1 });
-    sawDown.prepare     ({ sampleRate, uint32 (samplesPerBlock), 1 });
-    square.prepare      ({ sampleRate, uint32 (samplesPerBlock), 1 });
-    noise.prepare       ({ sampleRate, uint32 (samplesPerBlock), 1 });
+    oscillator.setSampleRate (sampleRate);
+    oscillator.start (0.0f);
+    aliasedPhase = 0;
 }
 
 void ToneGeneratorPlugin::deinitialise()
@@ -82,27 +75,37 @@ void ToneGeneratorPlugin::applyToBuffer (const AudioRenderContext& fc)
     int numSamples = fc.bufferNumSamples;
     scratch.setSize (1, numSamples, false, false, true);
 
-    bandLimitOsc = getBoolParamValue (*bandLimitParam);
-    float freq = frequencyParam->getCurrentValue();
-    sine.setFrequency (freq);
-    triangle.setFrequency (freq);
-    sawUp.setFrequency (freq);
-    sawDown.setFrequency (freq);
-    square.setFrequency (freq);
-
     scratch.clear();
-    juce::dsp::AudioBlock<float> block (scratch);
-    juce::dsp::ProcessContextReplacing<float> context (block);
 
-    switch (getTypedParamValue<OscType> (*oscTypeParam))
+    const auto type = getTypedParamValue<OscType> (*oscTypeParam);
+    const float freq = juce::jlimit (1.0f, (float) sampleRate * 0.5f, frequencyParam->getCurrentValue());
+
+    // Sine and noise are the same whether they're band-limited or not
+    if (getBoolParamValue (*bandLimitParam) || type == OscType::sin || type == OscType::noise)
     {
-        case OscType::sin:      sine.process (context);     break;
-        case OscType::triangle: triangle.process (context); break;
-        case OscType::sawUp:    sawUp.process (context);    break;
-        case OscType::sawDown:  sawDown.process (context);  break;
-        case OscType::square:   square.process (context);   break;
-        case OscType::noise:    noise.process (context);    break;
-    };
+        auto getWave = [type]
+        {
+            switch (type)
+            {
+                case OscType::sin:      return Oscillator::sine;
+                case OscType::triangle: return Oscillator::triangle;
+                case OscType::sawUp:    return Oscillator::saw;
+                case OscType::sawDown:  return Oscillator::sawDown;
+                case OscType::square:   return Oscillator::square;
+                case OscType::noise:    return Oscillator::noise;
+            }
+
+            return Oscillator::none;
+        };
+
+        oscillator.setWave (getWave());
+        oscillator.setFrequency (freq);
+        oscillator.process (scratch, 0, numSamples);
+    }
+    else
+    {
+        renderAliased (type, scratch.getWritePointer (0), freq, numSamples);
+    }
 
     scratch.applyGain (gain);
 
@@ -117,126 +120,27 @@ void ToneGeneratorPlugin::restorePluginStateFromValueTree (const juce::ValueTree
 }
 
 //==============================================================================
-namespace ToneGenHelpers
+void ToneGeneratorPlugin::renderAliased (OscType type, float* dest, float freq, int numSamples) noexcept
 {
-    inline int oddEven (int x)
-    {
-        return (x % 2 == 0) ? 1 : -1;
-    }
-}
+    const auto delta = freq / (float) sampleRate;
 
-void ToneGeneratorPlugin::initialiseOscilators()
-{
-    auto sineFunc = [&] (float in) -> float
+    for (int i = 0; i < numSamples; ++i)
     {
-        return std::sin (in);
-    };
-
-    auto triangleFunc = [&] (float in) -> float
-    {
-        if (bandLimitOsc.load())
+        switch (type)
         {
-            const double f = frequencyParam->getCurrentValue();
-            const double sr = sampleRate;
-
-            double sum = 0;
-            int k = 1;
-
-            while (f * k < sr / 2)
-            {
-                sum += std::pow (-1, (k - 1) / 2.0f) / (k * k) * sin (k * in);
-                k += 2;
-            }
-
-            return float (8.0f / (float_Pi * float_Pi) * sum);
+            case OscType::triangle: dest[i] = ControlRateWaves::triangle (aliasedPhase);        break;
+            case OscType::sawUp:    dest[i] = ControlRateWaves::sawUp (aliasedPhase);           break;
+            case OscType::sawDown:  dest[i] = ControlRateWaves::sawDown (aliasedPhase);         break;
+            case OscType::square:   dest[i] = ControlRateWaves::square (aliasedPhase, 0.5f);    break;
+            case OscType::sin:
+            case OscType::noise:    break;
         }
 
-        return (in < 0 ? in / -float_Pi : in / float_Pi) * 2 - 1;
-    };
-
-    auto sawUpFunc = [&] (float in) -> float
-    {
-        if (bandLimitOsc.load())
-        {
-            const double f = frequencyParam->getCurrentValue();
-            const double sr = sampleRate;
-
-            double sum = 0;
-            int k = 1;
-
-            while (f * k < sr / 2)
-            {
-                sum += ToneGenHelpers::oddEven (k) * std::sin (k * in) / k;
-                k++;
-            }
+        aliasedPhase += delta;
 
-            return float (-2.0f / float_Pi * sum);
-        }
-
-        return ((in + float_Pi) / (2 * float_Pi)) * 2 - 1;
-    };
-
-    auto sawDownFunc = [&] (float in) -> float
-    {
-        if (bandLimitOsc.load())
-        {
-            const double f = frequencyParam->getCurrentValue();
-            const double sr = sampleRate;
-
-            double sum = 0;
-            int k = 1;
-
-            while (f * k < sr / 2)
-            {
-                sum += ToneGenHelpers::oddEven (k) * std::sin (k * in) / k;
-                k++;
-            }
-
-            return float (2.0f / float_Pi * sum);
-        }
-
-        return -(((in + float_Pi) / (2 * float_Pi)) * 2 - 1);
-    };
-
-    auto squareFunc = [&] (float in) -> float
-    {
-        if (bandLimitOsc.load())
-        {
-            const double f = frequencyParam->getCurrentValue();
-            const double sr = sampleRate;
-
-            double sum = 0;
-            int i = 1;
-
-            while (f * (2 * i - 1) < sr / 2)
-            {
-                sum += std::sin ((2 * i - 1) * in) / ((2 * i - 1));
-                i++;
-            }
-
-            return float (4.0f / float_Pi * sum);
-        }
-
-        return in < 0 ? -1.0f : 1.0f;
-    };
-
-    auto noiseFunc = [&] (float) -> float
-    {
-        const float mean = 0.0f;
-        const float stddev = 0.1f;
-
-        static std::default_random_engine generator;
-        static std::normal_distribution<float> dist (mean, stddev);
-
-        return dist (generator);
-    };
-
-    sine.initialise (sineFunc);
-    triangle.initialise (triangleFunc);
-    sawUp.initialise (sawUpFunc);
-    sawDown.initialise (sawDownFunc);
-    square.initialise (squareFunc);
-    noise.initialise (noiseFunc);
+        while (aliasedPhase >= 1.0f)
+            aliasedPhase -= 1.0f;
+    }
 }
 
 }
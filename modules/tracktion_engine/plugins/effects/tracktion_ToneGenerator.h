@@ -54,16 +54,13 @@ public:
 private:
     //==============================================================================
     juce::AudioSampleBuffer scratch;
-    std::atomic<bool> bandLimitOsc { false };
 
-    juce::dsp::Oscillator<float> sine;
-    juce::dsp::Oscillator<float> triangle;
-    juce::dsp::Oscillator<float> sawUp;
-    juce::dsp::Oscillator<float> sawDown;
-    juce::dsp::Oscillator<float> square;
-    juce::dsp::Oscillator<float> noise;
+    // The band-limited waves come from the wavetables every Oscillator shares,
+    // and the aliased ones are simply worked out from this phase
+    Oscillator oscillator;
+    float aliasedPhase = 0;
 
-    void initialiseOscilators();
+    void renderAliased (OscType, float* dest, float frequency, int numSamples) noexcept;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ToneGeneratorPlugin)
 };
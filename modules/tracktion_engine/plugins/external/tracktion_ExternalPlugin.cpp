@@ -31,10 +31,13 @@ struct ExternalPlugin::ProcessorChangedManager  : public juce::AudioProcessorLis
 
     void audioProcessorParameterChanged (AudioProcessor*, int, float) override
     {
+        plugin.stateMayHaveChanged = true;
     }
 
     void audioProcessorChanged (AudioProcessor* ap) override
     {
+        plugin.stateMayHaveChanged = true;
+
         if (plugin.edit.isLoading())
             return;
 
@@ -450,10 +453,72 @@ namespace
     }
 }
 
+//==============================================================================
+//==============================================================================
+/** Resets ExternalPlugins after a playhead jump, so that a slow reset doesn't hold up the audio thread. */
+class ExternalPlugin::ResetThread  : public juce::Thread
+{
+public:
+    ResetThread() : Thread ("Plugin Reset") {}
+
+    ~ResetThread() override
+    {
+        stopThread (5000);
+    }
+
+    void add (ExternalPlugin& p)
+    {
+        {
+            const juce::ScopedLock sl (lock);
+            plugins.addIfNotAlreadyThere (&p);
+        }
+
+        startThread (5);
+    }
+
+    /** Once this returns, the thread won't touch the plugin again. */
+    void remove (ExternalPlugin& p)
+    {
+        const juce::ScopedLock sl (lock);
+        plugins.removeFirstMatchingValue (&p);
+    }
+
+    void run() override
+    {
+        while (! threadShouldExit())
+        {
+            wait (-1);
+
+            // Keep going until there's nothing left, as more jumps may have happened whilst we were busy
+            for (;;)
+            {
+                bool anyReset = false;
+
+                {
+                    const juce::ScopedLock sl (lock);
+
+                    for (auto p : plugins)
+                        anyReset = p->runPendingReset() || anyReset;
+                }
+
+                if (! anyReset || threadShouldExit())
+                    break;
+            }
+        }
+    }
+
+private:
+    juce::CriticalSection lock;
+    juce::Array<ExternalPlugin*> plugins;
+
+    JUCE_DECLARE_NON_COPYABLE (ResetThread)
+};
+
 //==============================================================================
 ExternalPlugin::ExternalPlugin (PluginCreationInfo info)  : Plugin (info)
 {
     CRASH_TRACER
+    resetThread->add (*this);
 
     auto um = getUndoManager();
 
@@ -473,7 +538,16 @@ ExternalPlugin::ExternalPlugin (PluginCreationInfo info)  : Plugin (info)
     desc.manufacturerName = state[IDs::manufacturer];
     identiferString = desc.createIdentifierString();
 
-    initialiseFully();
+    if (edit.isLoading() && engine.getEngineBehaviour().shouldLoadPluginsAfterEditOpens())
+    {
+        // Leave the plugin bypassed until the message loop gets round to it, so the Edit can open straight away
+        deferredInitialiser.setFunction ([this] { initialiseDeferred(); });
+        deferredInitialiser.triggerAsyncUpdate();
+    }
+    else
+    {
+        initialiseFully();
+    }
 }
 
 ValueTree ExternalPlugin::create (Engine& e, const PluginDescription& desc)
@@ -500,6 +574,7 @@ void ExternalPlugin::initialiseFully()
     {
         CRASH_TRACER_PLUGIN (getDebugName());
         fullyInitialised = true;
+        deferredInitialiser.cancelPendingUpdate();
 
         doFullInitialisation();
         restorePluginStateFromValueTree (state);
@@ -508,6 +583,19 @@ void ExternalPlugin::initialiseFully()
     }
 }
 
+void ExternalPlugin::initialiseDeferred()
+{
+    if (fullyInitialised)
+        return;
+
+    initialiseFully();
+
+    // The plugin's been playing as bypassed, so the graph needs rebuilding to pick up its latency
+    changed();
+    edit.restartPlayback();
+    SelectionManager::refreshAllPropertyPanelsShowing (*this);
+}
+
 void ExternalPlugin::forceFullReinitialise()
 {
     TransportControl::ScopedPlaybackRestarter restarter (edit.getTransport());
@@ -772,6 +860,7 @@ ExternalPlugin::~ExternalPlugin()
 {
     TRACKTION_ASSERT_MESSAGE_THREAD
     CRASH_TRACER_PLUGIN (getDebugName());
+    resetThread->remove (*this);
     notifyListenersOfDeletion();
     windowState->hideWindowForShutdown();
     deinitialise();
@@ -814,24 +903,72 @@ void ExternalPlugin::flushPluginStateToValueTree()
 			state.setProperty (IDs::programNum,  pluginInstance->getCurrentProgram(), um);
 
         TRACKTION_ASSERT_MESSAGE_THREAD
-        MemoryBlock chunk;
 
-        pluginInstance->suspendProcessing (true);
-        pluginInstance->getStateInformation (chunk);
-        saveChangedParametersToState();
-        pluginInstance->suspendProcessing (false);
+        // Asking for the chunk can be slow, so it's skipped if nothing's told us the plugin has changed since
+        // last time. Some plugins change their state from their editors without saying so, so it's always
+        // asked for while the window is open
+        const bool isWindowOpen = windowState != nullptr && windowState->isWindowShowing();
+        const bool needsChunk = stateMayHaveChanged.exchange (false) || isWindowOpen
+                                  || ! isFlushedChunkStillInState();
 
-        engine.getEngineBehaviour().saveCustomPluginProperties (state, *pluginInstance, um);
+        if (needsChunk)
+        {
+            MemoryBlock chunk;
 
-        if (chunk.getSize() > 0)
-            state.setProperty (IDs::state, chunk.toBase64Encoding(), um);
+            pluginInstance->suspendProcessing (true);
+            pluginInstance->getStateInformation (chunk);
+            saveChangedParametersToState();
+            pluginInstance->suspendProcessing (false);
+
+            engine.getEngineBehaviour().saveCustomPluginProperties (state, *pluginInstance, um);
+
+            // Only re-encode the chunk if it's actually different from the one we last stored
+            const auto chunkHash = hashChunk (chunk);
+
+            if (chunk.getSize() == 0)
+            {
+                state.removeProperty (IDs::state, um);
+                lastFlushedChunk = {};
+                lastFlushedChunkNumBytes = 0;
+            }
+            else if (chunkHash != lastFlushedChunkHash || ! isFlushedChunkStillInState())
+            {
+                lastFlushedChunk = chunk.toBase64Encoding();
+                lastFlushedChunkNumBytes = lastFlushedChunk.getNumBytesAsUTF8();
+                state.setProperty (IDs::state, lastFlushedChunk, um);
+            }
+
+            lastFlushedChunkHash = chunkHash;
+        }
         else
-            state.removeProperty (IDs::state, um);
+        {
+            saveChangedParametersToState();
+            engine.getEngineBehaviour().saveCustomPluginProperties (state, *pluginInstance, um);
+        }
 
         flushBusesLayoutToValueTree();
     }
 }
 
+bool ExternalPlugin::isFlushedChunkStillInState() const
+{
+    // The strings share their text, so comparing the pointers is enough to spot an undo or a preset load
+    auto current = state.getProperty (IDs::state).toString();
+    return current.isNotEmpty() && current.getCharPointer() == lastFlushedChunk.getCharPointer();
+}
+
+uint64 ExternalPlugin::hashChunk (const MemoryBlock& chunk) noexcept
+{
+    // FNV-1a
+    uint64 hash = 14695981039346656037ull;
+    auto data = static_cast<const uint8*> (chunk.getData());
+
+    for (size_t i = 0; i < chunk.getSize(); ++i)
+        hash = (hash ^ data[i]) * 1099511628211ull;
+
+    return hash;
+}
+
 void ExternalPlugin::flushBusesLayoutToValueTree()
 {
     const ScopedValueSetter<bool> svs (isFlushingLayoutToState, true);
@@ -871,6 +1008,8 @@ void ExternalPlugin::restorePluginStateFromValueTree (const juce::ValueTree& v)
         }
     }
 
+    stateMayHaveChanged = true;
+
     if (pluginInstance != nullptr && s.isNotEmpty())
     {
         CRASH_TRACER_PLUGIN (getDebugName());
@@ -881,6 +1020,13 @@ void ExternalPlugin::restorePluginStateFromValueTree (const juce::ValueTree& v)
         MemoryBlock chunk;
         chunk.fromBase64Encoding (s);
 
+        if (v == state)
+        {
+            lastFlushedChunk = s;
+            lastFlushedChunkNumBytes = s.getNumBytesAsUTF8();
+            lastFlushedChunkHash = hashChunk (chunk);
+        }
+
         if (chunk.getSize() > 0)
             callBlocking ([this, &chunk]() { pluginInstance->setStateInformation (chunk.getData(), (int) chunk.getSize()); });
     }
@@ -909,7 +1055,10 @@ void ExternalPlugin::updateFromMirroredPluginIfNeeded (Plugin& changedPlugin)
                 other->pluginInstance->getStateInformation (chunk);
 
                 if (chunk.getSize() > 0)
+                {
                     pluginInstance->setStateInformation (chunk.getData(), (int) chunk.getSize());
+                    stateMayHaveChanged = true;
+                }
             }
         }
     }
@@ -1038,6 +1187,8 @@ void ExternalPlugin::initialise (const PlaybackInitialisationInfo& info)
 		lastSampleRate = info.sampleRate;
 		lastBlockSizeSamples = info.blockSizeSamples;
 
+        prepareProcessingBuffers (info.blockSizeSamples);
+
         latencySamples = pluginInstance->getLatencySamples();
         latencySeconds = latencySamples / info.sampleRate;
 
@@ -1084,6 +1235,23 @@ void ExternalPlugin::reset()
     }
 }
 
+void ExternalPlugin::resetAfterPlayheadJump()
+{
+    // Whilst the background thread holds the lock, applyToBuffer leaves the
+    // audio unprocessed rather than waiting for it
+    isResetPending = true;
+    resetThread->notify();
+}
+
+bool ExternalPlugin::runPendingReset()
+{
+    if (! isResetPending.exchange (false))
+        return false;
+
+    reset();
+    return true;
+}
+
 void ExternalPlugin::setEnabled (bool shouldEnable)
 {
     Plugin::setEnabled (shouldEnable);
@@ -1098,6 +1266,26 @@ void ExternalPlugin::setEnabled (bool shouldEnable)
 }
 
 //==============================================================================
+void ExternalPlugin::prepareProcessingBuffers (int blockSizeSamples)
+{
+    numInputChannels = pluginInstance->getTotalNumInputChannels();
+    numOutputChannels = pluginInstance->getTotalNumOutputChannels();
+    numChannelsToProcess = jmax (1, numInputChannels, numOutputChannels);
+
+    channelMappingBuffer.setSize (numChannelsToProcess, blockSizeSamples, false, false, true);
+    dryBuffer.setSize (numChannelsToProcess, blockSizeSamples, false, false, true);
+
+    // Each event takes its data plus a 6 byte header, so this leaves space for plenty of short messages
+    midiBuffer.ensureSize ((size_t) MidiMessageArray::defaultNumMessagesToReserve * 16);
+
+    if (mpeZoneLayoutMessages.isEmpty())
+    {
+        MPEZoneLayout layout;
+        layout.setLowerZone (15);
+        mpeZoneLayoutMessages = MPEMessages::setZoneLayout (layout);
+    }
+}
+
 void ExternalPlugin::prepareIncomingMidiMessages (MidiMessageArray& incoming, int numSamples, bool isPlaying)
 {
     if (incoming.isAllNotesOff)
@@ -1136,19 +1324,7 @@ void ExternalPlugin::prepareIncomingMidiMessages (MidiMessageArray& incoming, in
 
         // Reset MPE zone to match MIDI generated by clip
         if (supportsMPE)
-        {
-            MPEZoneLayout layout;
-            layout.setLowerZone (15);
-
-            auto layoutBuffer = MPEMessages::setZoneLayout (layout);
-            for (auto itr : layoutBuffer)
-            {
-                auto result = itr.getMessage();
-                int samplePosition = itr.samplePosition;
-
-                midiBuffer.addEvent (result, samplePosition);
-            }
-        }
+            midiBuffer.addEvents (mpeZoneLayoutMessages, 0, -1, 0);
     }
 
     for (auto& m : incoming)
@@ -1167,6 +1343,11 @@ void ExternalPlugin::prepareIncomingMidiMessages (MidiMessageArray& incoming, in
         {
             activeNotes.clearNote (m.getChannel(), m.getNoteNumber());
         }
+        else if (m.isProgramChange() || m.isController() || m.isSysEx())
+        {
+            // These can change the plugin's state without it telling us
+            stateMayHaveChanged = true;
+        }
 
         auto sample = jlimit (0, numSamples - 1, (int) (m.getTimeStamp() * sampleRate));
         midiBuffer.addEvent (m, sample);
@@ -1193,7 +1374,14 @@ void ExternalPlugin::applyToBuffer (const AudioRenderContext& fc)
     if (pluginInstance != nullptr && isEnabled())
     {
         CRASH_TRACER_PLUGIN (getDebugName());
-        const ScopedLock sl (lock);
+
+        // The lock is only held elsewhere while the instance is being initialised or reset, so rather
+        // than blocking the audio thread, the buffer is left unprocessed as if it was bypassed
+        const ScopedTryLock sl (lock);
+
+        if (! sl.isLocked())
+            return;
+
         jassert (isInstancePrepared);
 
         if (playhead != nullptr)
@@ -1209,9 +1397,7 @@ void ExternalPlugin::applyToBuffer (const AudioRenderContext& fc)
             auto destNumChans = fc.destBuffer->getNumChannels();
             jassert (destNumChans > 0);
 
-            auto numInputChannels = pluginInstance->getTotalNumInputChannels();
-            auto numOutputChannels = pluginInstance->getTotalNumOutputChannels();
-            auto numChansToProcess = jmax (1, numInputChannels, numOutputChannels);
+            auto numChansToProcess = numChannelsToProcess;
 
             if (destNumChans == numChansToProcess)
             {
@@ -1219,8 +1405,10 @@ void ExternalPlugin::applyToBuffer (const AudioRenderContext& fc)
             }
             else
             {
-                AudioScratchBuffer asb (numChansToProcess, fc.bufferNumSamples);
-                auto& buffer = asb.buffer;
+                auto& buffer = channelMappingBuffer;
+
+                // Only reallocates if the block is bigger than the one we were initialised with
+                buffer.setSize (numChansToProcess, fc.bufferNumSamples, false, false, true);
 
                 // Copy or existing channel or clear data
                 for (int i = 0; i < numChansToProcess; ++i)
@@ -1244,7 +1432,7 @@ void ExternalPlugin::applyToBuffer (const AudioRenderContext& fc)
                 }
 
                 AudioRenderContext fc2 (fc);
-                fc2.destBuffer = &asb.buffer;
+                fc2.destBuffer = &buffer;
                 fc2.bufferStartSample = 0;
 
                 processPluginBlock (fc2);
@@ -1263,9 +1451,9 @@ void ExternalPlugin::applyToBuffer (const AudioRenderContext& fc)
         }
         else
         {
-            AudioScratchBuffer asb (jmax (pluginInstance->getTotalNumInputChannels(),
-                                          pluginInstance->getTotalNumOutputChannels()), fc.bufferNumSamples);
-            pluginInstance->processBlock (asb.buffer, midiBuffer);
+            channelMappingBuffer.setSize (numChannelsToProcess, fc.bufferNumSamples, false, false, true);
+            channelMappingBuffer.clear();
+            pluginInstance->processBlock (channelMappingBuffer, midiBuffer);
         }
 
         if (fc.bufferForMidiMessages != nullptr)
@@ -1309,10 +1497,10 @@ void ExternalPlugin::processPluginBlock (const AudioRenderContext& fc)
     else
     {
         auto numChans = asb.getNumChannels();
-        AudioScratchBuffer dryAudio (numChans, fc.bufferNumSamples);
+        dryBuffer.setSize (numChans, fc.bufferNumSamples, false, false, true);
 
         for (int i = 0; i < numChans; ++i)
-            dryAudio.buffer.copyFrom (i, 0, asb, i, 0, fc.bufferNumSamples);
+            dryBuffer.copyFrom (i, 0, asb, i, 0, fc.bufferNumSamples);
 
         pluginInstance->processBlock (asb, midiBuffer);
         zeroDenormalisedValuesIfNeeded (asb);
@@ -1321,7 +1509,7 @@ void ExternalPlugin::processPluginBlock (const AudioRenderContext& fc)
             asb.applyGain (0, fc.bufferNumSamples, wet);
 
         for (int i = 0; i < numChans; ++i)
-            asb.addFrom (i, 0, dryAudio.buffer.getReadPointer (i), fc.bufferNumSamples, dry);
+            asb.addFrom (i, 0, dryBuffer.getReadPointer (i), fc.bufferNumSamples, dry);
     }
 }
 
@@ -1470,6 +1658,7 @@ void ExternalPlugin::setCurrentProgram (int index, bool sendChangeMessage)
         {
             pluginInstance->setCurrentProgram (index);
             state.setProperty (IDs::programNum, index, nullptr);
+            stateMayHaveChanged = true;
 
             if (sendChangeMessage)
             {
@@ -1654,6 +1843,12 @@ void ExternalPlugin::deleteFromParent()
     Plugin::deleteFromParent();
 }
 
+juce::int64 ExternalPlugin::getMemoryUsage()
+{
+    // The plugin's own memory can't be seen from here, so this is just the state it's saved
+    return (juce::int64) lastFlushedChunkNumBytes;
+}
+
 AudioPluginInstance* ExternalPlugin::getAudioPluginInstance() const
 {
     return pluginInstance.get();
@@ -43,6 +43,7 @@ public:
     void initialise (const PlaybackInitialisationInfo&) override;
     void deinitialise() override;
     void reset() override;
+    void resetAfterPlayheadJump() override;
     void setEnabled (bool enabled) override;
 
     void applyToBuffer (const AudioRenderContext&) override;
@@ -70,6 +71,7 @@ public:
 
     juce::AudioProcessor* getWrappedAudioProcessor() const override     { return pluginInstance.get(); }
     void deleteFromParent() override;
+    juce::int64 getMemoryUsage() override;
 
     //==============================================================================
     // selectable stuff
@@ -129,7 +131,7 @@ private:
 	double lastSampleRate = 0.0;
 	int lastBlockSizeSamples = 0;
 
-    juce::MidiBuffer midiBuffer;
+    juce::MidiBuffer midiBuffer, mpeZoneLayoutMessages;
     MidiMessageArray::MPESourceID midiSourceID = MidiMessageArray::createUniqueMPESourceID();
 
     ActiveNoteList activeNotes;
@@ -139,11 +141,32 @@ private:
 
     bool fullyInitialised = false, supportsMPE = false, isFlushingLayoutToState = false;
 
+    // Lets flushPluginStateToValueTree() skip fetching and encoding the chunk when nothing has changed
+    std::atomic<bool> stateMayHaveChanged { true };
+    juce::String lastFlushedChunk;
+    juce::uint64 lastFlushedChunkHash = 0;
+    size_t lastFlushedChunkNumBytes = 0;
+    bool isFlushedChunkStillInState() const;
+    static juce::uint64 hashChunk (const juce::MemoryBlock&) noexcept;
+    AsyncCaller deferredInitialiser;
+
+    // Resets after a playhead jump are done by a background thread shared by all the plugins
+    class ResetThread;
+    juce::SharedResourcePointer<ResetThread> resetThread;
+    std::atomic<bool> isResetPending { false };
+    bool runPendingReset();
+
     struct MPEChannelRemapper;
     std::unique_ptr<MPEChannelRemapper> mpeRemapper;
 
     void prepareIncomingMidiMessages (MidiMessageArray& incoming, int numSamples, bool isPlaying);
 
+    // These are all set up in initialise() so that applyToBuffer() doesn't need to allocate
+    // anything or use an AudioScratchBuffer, unless it gets a larger block than it was prepared for
+    int numInputChannels = 0, numOutputChannels = 0, numChannelsToProcess = 1;
+    juce::AudioBuffer<float> channelMappingBuffer, dryBuffer;
+    void prepareProcessingBuffers (int blockSizeSamples);
+
     juce::Array<ExternalAutomatableParameter*> autoParamForParamNumbers;
 
     //==============================================================================
@@ -156,6 +179,7 @@ private:
 
     //==============================================================================
     void doFullInitialisation();
+    void initialiseDeferred();
     void buildParameterList();
     void refreshParameterValues();
     void updateDebugName();
@@ -0,0 +1,1130 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+#if JUCE_LINUX
+ #include <linux/futex.h>
+ #include <sys/syscall.h>
+ #include <unistd.h>
+#endif
+
+namespace tracktion_engine
+{
+
+static const char* sandboxCommandLineUID = "PluginSandbox";
+
+static MemoryBlock createSandboxMessage (const juce::XmlElement& xml)
+{
+    MemoryOutputStream mo;
+    xml.writeTo (mo, juce::XmlElement::TextFormat().withoutHeader().singleLine());
+    return mo.getMemoryBlock();
+}
+
+//==============================================================================
+/** The block of memory that the host and the child process share for each plugin.
+    It lives in a memory-mapped file, so the layout mustn't contain anything but plain data.
+*/
+struct SandboxSharedBlock
+{
+    enum
+    {
+        maxChannels = 32,
+        maxSamples = 2048,
+        maxParameterChanges = 512,
+        midiBytes = 32768
+    };
+
+    struct ParameterChange
+    {
+        juce::int32 index;
+        float value;
+    };
+
+    struct Transport
+    {
+        double bpm, timeInSeconds, ppqPosition, ppqPositionOfLastBarStart, ppqLoopStart, ppqLoopEnd;
+        juce::int64 timeInSamples;
+        juce::int32 timeSigNumerator, timeSigDenominator;
+        juce::int32 isValid, isPlaying, isRecording, isLooping;
+    };
+
+    // The host bumps requestCount when a block is ready, the child sets replyCount to match when it's done
+    std::atomic<juce::uint32> requestCount, replyCount;
+
+    // Written by the host before each request
+    juce::int32 numSamples, numChannels, numMidiInBytes, numParameterChanges, resetRequested;
+    Transport transport;
+    ParameterChange parameterChanges[maxParameterChanges];
+    juce::uint8 midiIn[midiBytes];
+
+    // Written by the child process before each reply
+    juce::int32 numMidiOutBytes, latencySamples;
+    juce::uint8 midiOut[midiBytes];
+
+    float audio[maxChannels * maxSamples];
+
+    float* getChannel (int channel) noexcept        { return audio + channel * maxSamples; }
+};
+
+static_assert (sizeof (std::atomic<juce::uint32>) == sizeof (juce::uint32),
+               "The counters are shared between processes so must be plain lock-free integers");
+
+static void wakeSandboxWaiters (std::atomic<juce::uint32>& value)
+{
+   #if JUCE_LINUX
+    syscall (SYS_futex, reinterpret_cast<juce::uint32*> (&value), FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+   #else
+    juce::ignoreUnused (value);
+   #endif
+}
+
+static void waitForSandboxChange (std::atomic<juce::uint32>& value, juce::uint32 oldValue, double timeoutMs)
+{
+    // The other side usually answers within a few microseconds, so spin for a moment before blocking
+    for (int i = 0; i < 256; ++i)
+        if (value.load (std::memory_order_acquire) != oldValue)
+            return;
+
+   #if JUCE_LINUX
+    timespec ts;
+    ts.tv_sec  = (time_t) (timeoutMs / 1000.0);
+    ts.tv_nsec = (long) (std::fmod (timeoutMs, 1000.0) * 1000000.0);
+    syscall (SYS_futex, reinterpret_cast<juce::uint32*> (&value), FUTEX_WAIT, oldValue, &ts, nullptr, 0);
+   #else
+    auto endTime = Time::getMillisecondCounterHiRes() + timeoutMs;
+
+    while (value.load (std::memory_order_acquire) == oldValue
+            && Time::getMillisecondCounterHiRes() < endTime)
+        Thread::yield();
+   #endif
+}
+
+/** Packs the events in a range of samples as [position, size, data] with each event padded to 4 bytes. */
+static int packSandboxMidi (const MidiBuffer& source, juce::uint8* dest, int startSample, int numSamples)
+{
+    int numBytes = 0;
+
+    for (auto itr : source)
+    {
+        if (itr.samplePosition < startSample)
+            continue;
+
+        if (itr.samplePosition >= startSample + numSamples)
+            break;
+
+        const int eventBytes = 8 + ((itr.numBytes + 3) & ~3);
+
+        if (numBytes + eventBytes > SandboxSharedBlock::midiBytes)
+            break;
+
+        auto header = reinterpret_cast<juce::int32*> (dest + numBytes);
+        header[0] = itr.samplePosition - startSample;
+        header[1] = itr.numBytes;
+        memcpy (dest + numBytes + 8, itr.data, (size_t) itr.numBytes);
+        numBytes += eventBytes;
+    }
+
+    return numBytes;
+}
+
+static void unpackSandboxMidi (const juce::uint8* source, int numBytes, MidiBuffer& dest, int sampleOffset)
+{
+    for (int pos = 0; pos + 8 <= numBytes;)
+    {
+        auto header = reinterpret_cast<const juce::int32*> (source + pos);
+        const int size = header[1];
+
+        if (size <= 0 || pos + 8 + size > numBytes)
+            break;
+
+        dest.addEvent (source + pos + 8, size, header[0] + sampleOffset);
+        pos += 8 + ((size + 3) & ~3);
+    }
+}
+
+static File createSandboxSharedFile()
+{
+   #if JUCE_LINUX
+    File dir ("/dev/shm");
+
+    if (! dir.isDirectory())
+        dir = File::getSpecialLocation (File::tempDirectory);
+   #else
+    auto dir = File::getSpecialLocation (File::tempDirectory);
+   #endif
+
+    auto file = dir.getNonexistentChildFile ("tracktion_sandbox_", ".shm", false);
+    MemoryBlock zeros (sizeof (SandboxSharedBlock), true);
+
+    if (! file.replaceWithData (zeros.getData(), zeros.getSize()))
+        return {};
+
+    return file;
+}
+
+static SandboxSharedBlock* getSandboxSharedBlock (const MemoryMappedFile& mappedFile)
+{
+    if (mappedFile.getData() == nullptr || mappedFile.getSize() < sizeof (SandboxSharedBlock))
+        return nullptr;
+
+    return static_cast<SandboxSharedBlock*> (mappedFile.getData());
+}
+
+//==============================================================================
+/** A child process that hosts the plugins in one sandbox group. */
+class SandboxProcess  : public juce::ReferenceCountedObject,
+                        private ChildProcessMaster
+{
+public:
+    using Ptr = juce::ReferenceCountedObjectPtr<SandboxProcess>;
+
+    /** Returns the running process for a group, launching one if needed. */
+    static Ptr getOrLaunch (const String& group)
+    {
+        const ScopedLock sl (getProcessListLock());
+
+        for (auto p : getProcessList())
+            if (p->group == group && ! p->crashed)
+                return p;
+
+        Ptr p (new SandboxProcess (group));
+
+        if (! p->launched)
+            return {};
+
+        return p;
+    }
+
+    ~SandboxProcess() override
+    {
+        const ScopedLock sl (getProcessListLock());
+        getProcessList().removeFirstMatchingValue (this);
+    }
+
+    /** Sends a message to the child and waits for its reply, returning nullptr on a timeout or crash. */
+    std::unique_ptr<XmlElement> sendAndWait (XmlElement& message, int timeoutMs)
+    {
+        const int requestID = ++lastRequestID;
+        message.setAttribute ("req", requestID);
+
+        if (crashed || ! sendMessageToSlave (createSandboxMessage (message)))
+            return {};
+
+        auto endTime = Time::getMillisecondCounter() + (juce::uint32) timeoutMs;
+
+        while (! crashed)
+        {
+            if (auto reply = findReply (requestID))
+                return reply;
+
+            if (Time::getMillisecondCounter() > endTime)
+            {
+                TRACKTION_LOG_ERROR ("Sandboxed plugin process timed out: " + group);
+                break;
+            }
+
+            Thread::sleep (1);
+        }
+
+        return {};
+    }
+
+    const String group;
+    std::atomic<bool> crashed { false };
+
+private:
+    bool launched = false;
+    std::atomic<int> lastRequestID { 0 };
+    OwnedArray<XmlElement> replies;
+    CriticalSection replyLock;
+
+    SandboxProcess (const String& g) : group (g)
+    {
+        // don't get stdout or strerr from the child process. We don't do anything with it and it fills up the pipe and hangs
+        launched = launchSlaveProcess (File::getSpecialLocation (File::currentExecutableFile), sandboxCommandLineUID, 0, 0);
+
+        if (launched)
+        {
+            TRACKTION_LOG ("----- Launched Plugin Sandbox Process: " + group);
+            getProcessList().add (this);
+        }
+        else
+        {
+            TRACKTION_LOG_ERROR ("Failed to launch plugin sandbox process");
+        }
+    }
+
+    static Array<SandboxProcess*>& getProcessList()
+    {
+        static Array<SandboxProcess*> processes;
+        return processes;
+    }
+
+    static CriticalSection& getProcessListLock()
+    {
+        static CriticalSection lock;
+        return lock;
+    }
+
+    std::unique_ptr<XmlElement> findReply (int requestID)
+    {
+        const ScopedLock sl (replyLock);
+
+        for (int i = replies.size(); --i >= 0;)
+        {
+            auto replyID = replies.getUnchecked (i)->getIntAttribute ("req");
+
+            if (replyID == requestID)
+                return std::unique_ptr<XmlElement> (replies.removeAndReturn (i));
+
+            // Anything older was for a request that has already timed out
+            if (replyID < requestID)
+                replies.remove (i);
+        }
+
+        return {};
+    }
+
+    void handleMessageFromSlave (const MemoryBlock& mb) override
+    {
+        if (auto xml = std::unique_ptr<XmlElement> (XmlDocument::parse (mb.toString())))
+        {
+            const ScopedLock sl (replyLock);
+            replies.add (xml.release());
+        }
+    }
+
+    void handleConnectionLost() override
+    {
+        crashed = true;
+        TRACKTION_LOG_ERROR ("Plugin sandbox process crashed: " + group);
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SandboxProcess)
+};
+
+//==============================================================================
+/** The host-side stand-in for a plugin running in a SandboxProcess. */
+class SandboxedPluginInstance  : public juce::AudioPluginInstance
+{
+public:
+    SandboxedPluginInstance (SandboxProcess::Ptr p, const PluginDescription& d, const XmlElement& loaded,
+                             int id, const File& file, std::unique_ptr<MemoryMappedFile> mapped)
+        : AudioPluginInstance (createBuses (loaded)),
+          process (std::move (p)), description (d), instanceID (id),
+          sharedFile (file), mappedFile (std::move (mapped))
+    {
+        block = getSandboxSharedBlock (*mappedFile);
+        jassert (block != nullptr);
+
+        numInputs  = loaded.getIntAttribute ("numIns");
+        numOutputs = loaded.getIntAttribute ("numOuts");
+        midiIn     = loaded.getBoolAttribute ("acceptsMidi");
+        midiOut    = loaded.getBoolAttribute ("producesMidi");
+        mpe        = loaded.getBoolAttribute ("supportsMPE");
+
+        forEachXmlChildElementWithTagName (loaded, e, "PROGRAM")
+            programNames.add (e->getStringAttribute ("name"));
+
+        forEachXmlChildElementWithTagName (loaded, e, "PARAM")
+            addParameter (new RemoteParameter (*this, *e));
+
+        updateFromReply (loaded);
+        midiOutScratch.ensureSize (SandboxSharedBlock::midiBytes);
+    }
+
+    ~SandboxedPluginInstance() override
+    {
+        XmlElement m ("UNLOAD");
+        m.setAttribute ("id", instanceID);
+        process->sendAndWait (m, messageTimeoutMs);
+
+        block = nullptr;
+        mappedFile.reset();
+        sharedFile.deleteFile();
+    }
+
+    //==============================================================================
+    const String getName() const override                       { return description.name; }
+    void fillInPluginDescription (PluginDescription& d) const override  { d = description; }
+
+    void prepareToPlay (double sampleRate, int blockSize) override
+    {
+        setRateAndBufferSizeDetails (sampleRate, blockSize);
+
+        XmlElement m ("PREPARE");
+        m.setAttribute ("id", instanceID);
+        m.setAttribute ("rate", sampleRate);
+        m.setAttribute ("blockSize", blockSize);
+
+        if (auto reply = process->sendAndWait (m, messageTimeoutMs))
+            updateFromReply (*reply);
+
+        if (block != nullptr)
+            lastRequest = block->replyCount.load (std::memory_order_acquire);
+    }
+
+    void releaseResources() override
+    {
+        XmlElement m ("RELEASE");
+        m.setAttribute ("id", instanceID);
+        process->sendAndWait (m, messageTimeoutMs);
+    }
+
+    void reset() override
+    {
+        resetPending = true;
+    }
+
+    void processBlock (AudioBuffer<float>& buffer, MidiBuffer& midi) override
+    {
+        const int numSamples = buffer.getNumSamples();
+
+        if (process->crashed || block == nullptr)
+        {
+            buffer.clear();
+            midi.clear();
+            return;
+        }
+
+        updateTransport();
+        midiOutScratch.clear();
+
+        for (int start = 0; start < numSamples; start += SandboxSharedBlock::maxSamples)
+        {
+            const int numThisTime = jmin ((int) SandboxSharedBlock::maxSamples, numSamples - start);
+
+            if (! processChunk (buffer, midi, start, numThisTime))
+                buffer.clear (start, numThisTime);
+        }
+
+        midi.swapWith (midiOutScratch);
+    }
+
+    double getTailLengthSeconds() const override                { return tailLengthSeconds; }
+    bool acceptsMidi() const override                           { return midiIn; }
+    bool producesMidi() const override                          { return midiOut; }
+    bool supportsMPE() const override                           { return mpe; }
+
+    // The plugin's editor would have to be shown by the child process, which isn't supported yet
+    AudioProcessorEditor* createEditor() override               { return nullptr; }
+    bool hasEditor() const override                             { return false; }
+
+    bool isBusesLayoutSupported (const BusesLayout& layouts) const override
+    {
+        return layouts.getMainInputChannels() == numInputs
+                && layouts.getMainOutputChannels() == numOutputs;
+    }
+
+    //==============================================================================
+    int getNumPrograms() override                               { return programNames.size(); }
+    int getCurrentProgram() override                            { return currentProgram; }
+    const String getProgramName (int index) override            { return programNames[index]; }
+
+    void setCurrentProgram (int index) override
+    {
+        XmlElement m ("PROGRAM");
+        m.setAttribute ("id", instanceID);
+        m.setAttribute ("index", index);
+
+        if (auto reply = process->sendAndWait (m, messageTimeoutMs))
+            updateFromReply (*reply);
+    }
+
+    void changeProgramName (int index, const String& newName) override
+    {
+        if (! isPositiveAndBelow (index, programNames.size()))
+            return;
+
+        programNames.set (index, newName);
+
+        XmlElement m ("PROGRAMNAME");
+        m.setAttribute ("id", instanceID);
+        m.setAttribute ("index", index);
+        m.setAttribute ("name", newName);
+        process->sendAndWait (m, messageTimeoutMs);
+    }
+
+    void getStateInformation (MemoryBlock& destData) override
+    {
+        XmlElement m ("GETSTATE");
+        m.setAttribute ("id", instanceID);
+
+        if (auto reply = process->sendAndWait (m, messageTimeoutMs))
+        {
+            destData.reset();
+            destData.fromBase64Encoding (reply->getStringAttribute ("state"));
+        }
+    }
+
+    void setStateInformation (const void* data, int sizeInBytes) override
+    {
+        XmlElement m ("SETSTATE");
+        m.setAttribute ("id", instanceID);
+        m.setAttribute ("state", MemoryBlock (data, (size_t) sizeInBytes).toBase64Encoding());
+
+        if (auto reply = process->sendAndWait (m, messageTimeoutMs))
+            updateFromReply (*reply);
+    }
+
+private:
+    //==============================================================================
+    struct RemoteParameter  : public juce::AudioProcessorParameter
+    {
+        RemoteParameter (SandboxedPluginInstance& o, const XmlElement& e)
+            : owner (o),
+              name (e.getStringAttribute ("name")),
+              label (e.getStringAttribute ("label")),
+              defaultValue ((float) e.getDoubleAttribute ("default")),
+              numSteps (e.getIntAttribute ("steps", AudioProcessor::getDefaultNumParameterSteps())),
+              automatable (e.getBoolAttribute ("automatable", true)),
+              discrete (e.getBoolAttribute ("discrete"))
+        {
+            value = (float) e.getDoubleAttribute ("value");
+        }
+
+        float getValue() const override                         { return value; }
+
+        void setValue (float newValue) override
+        {
+            value = newValue;
+            needsSending = true;
+            owner.anyParameterNeedsSending = true;
+        }
+
+        /** Updates the value after the child process has changed it, without sending it back. */
+        void setValueFromProcess (float newValue)
+        {
+            if (value.exchange (newValue) != newValue)
+                sendValueChangedMessageToListeners (newValue);
+        }
+
+        float getDefaultValue() const override                  { return defaultValue; }
+        String getName (int maximumLength) const override       { return name.substring (0, maximumLength); }
+        String getLabel() const override                        { return label; }
+        int getNumSteps() const override                        { return numSteps; }
+        bool isAutomatable() const override                     { return automatable; }
+        bool isDiscrete() const override                        { return discrete; }
+        float getValueForText (const String& text) const override   { return text.getFloatValue(); }
+
+        SandboxedPluginInstance& owner;
+        const String name, label;
+        const float defaultValue;
+        const int numSteps;
+        const bool automatable, discrete;
+        std::atomic<float> value { 0.0f };
+        std::atomic<bool> needsSending { false };
+    };
+
+    //==============================================================================
+    enum { messageTimeoutMs = 5000 };
+
+    SandboxProcess::Ptr process;
+    const PluginDescription description;
+    const int instanceID;
+    File sharedFile;
+    std::unique_ptr<MemoryMappedFile> mappedFile;
+    SandboxSharedBlock* block = nullptr;
+    juce::uint32 lastRequest = 0;
+
+    int numInputs = 0, numOutputs = 0, currentProgram = 0;
+    bool midiIn = false, midiOut = false, mpe = false;
+    double tailLengthSeconds = 0.0;
+    StringArray programNames;
+
+    SandboxSharedBlock::Transport transport {};
+    MidiBuffer midiOutScratch;
+    std::atomic<bool> resetPending { false }, anyParameterNeedsSending { false };
+
+    //==============================================================================
+    static BusesProperties createBuses (const XmlElement& loaded)
+    {
+        BusesProperties buses;
+
+        if (auto numIns = loaded.getIntAttribute ("numIns"))
+            buses = buses.withInput ("Input", AudioChannelSet::canonicalChannelSet (numIns), true);
+
+        if (auto numOuts = loaded.getIntAttribute ("numOuts"))
+            buses = buses.withOutput ("Output", AudioChannelSet::canonicalChannelSet (numOuts), true);
+
+        return buses;
+    }
+
+    void updateFromReply (const XmlElement& reply)
+    {
+        if (reply.hasAttribute ("latency"))
+            setLatencySamples (reply.getIntAttribute ("latency"));
+
+        tailLengthSeconds = reply.getDoubleAttribute ("tail", tailLengthSeconds);
+        currentProgram = reply.getIntAttribute ("program", currentProgram);
+
+        auto& params = getParameters();
+
+        forEachXmlChildElementWithTagName (reply, e, "VALUE")
+            if (auto p = dynamic_cast<RemoteParameter*> (params[e->getIntAttribute ("index")]))
+                p->setValueFromProcess ((float) e->getDoubleAttribute ("value"));
+    }
+
+    void updateTransport()
+    {
+        transport.isValid = 0;
+
+        if (auto ph = getPlayHead())
+        {
+            AudioPlayHead::CurrentPositionInfo info;
+
+            if (ph->getCurrentPosition (info))
+            {
+                transport.bpm                       = info.bpm;
+                transport.timeInSeconds             = info.timeInSeconds;
+                transport.ppqPosition               = info.ppqPosition;
+                transport.ppqPositionOfLastBarStart = info.ppqPositionOfLastBarStart;
+                transport.ppqLoopStart              = info.ppqLoopStart;
+                transport.ppqLoopEnd                = info.ppqLoopEnd;
+                transport.timeInSamples             = info.timeInSamples;
+                transport.timeSigNumerator          = info.timeSigNumerator;
+                transport.timeSigDenominator        = info.timeSigDenominator;
+                transport.isPlaying                 = info.isPlaying ? 1 : 0;
+                transport.isRecording               = info.isRecording ? 1 : 0;
+                transport.isLooping                 = info.isLooping ? 1 : 0;
+                transport.isValid                   = 1;
+            }
+        }
+    }
+
+    int collectParameterChanges (SandboxSharedBlock::ParameterChange* changes)
+    {
+        if (! anyParameterNeedsSending.exchange (false))
+            return 0;
+
+        auto& params = getParameters();
+        int numChanges = 0;
+
+        for (int i = 0; i < params.size(); ++i)
+        {
+            auto p = static_cast<RemoteParameter*> (params.getUnchecked (i));
+
+            if (p->needsSending.exchange (false))
+            {
+                changes[numChanges++] = { i, p->value.load() };
+
+                if (numChanges == SandboxSharedBlock::maxParameterChanges)
+                {
+                    // Send the rest with the next block
+                    anyParameterNeedsSending = true;
+                    break;
+                }
+            }
+        }
+
+        return numChanges;
+    }
+
+    bool waitForReply (juce::uint32 request, double timeoutMs)
+    {
+        auto endTime = Time::getMillisecondCounterHiRes() + timeoutMs;
+
+        for (;;)
+        {
+            auto reply = block->replyCount.load (std::memory_order_acquire);
+
+            if (reply == request)
+                return true;
+
+            auto remaining = endTime - Time::getMillisecondCounterHiRes();
+
+            if (remaining <= 0)
+                return false;
+
+            waitForSandboxChange (block->replyCount, reply, remaining);
+        }
+    }
+
+    bool processChunk (AudioBuffer<float>& buffer, const MidiBuffer& midi, int startSample, int numSamples)
+    {
+        auto& b = *block;
+
+        // If the last block timed out the child may still be working on it, so this one has to be dropped
+        if (b.replyCount.load (std::memory_order_acquire) != lastRequest)
+            return false;
+
+        const int numChannels = jmin (buffer.getNumChannels(), (int) SandboxSharedBlock::maxChannels);
+
+        for (int i = 0; i < numChannels; ++i)
+            FloatVectorOperations::copy (b.getChannel (i), buffer.getReadPointer (i, startSample), numSamples);
+
+        b.numSamples = numSamples;
+        b.numChannels = numChannels;
+        b.numMidiInBytes = packSandboxMidi (midi, b.midiIn, startSample, numSamples);
+        b.numParameterChanges = collectParameterChanges (b.parameterChanges);
+        b.resetRequested = resetPending.exchange (false) ? 1 : 0;
+        b.transport = transport;
+
+        b.requestCount.store (++lastRequest, std::memory_order_release);
+        wakeSandboxWaiters (b.requestCount);
+
+        // Waiting any longer than the block lasts would make the device miss its deadline anyway
+        auto timeoutMs = isNonRealtime() ? 10000.0 : jmax (1.0, 1000.0 * numSamples / getSampleRate());
+
+        if (! waitForReply (lastRequest, timeoutMs))
+            return false;
+
+        for (int i = 0; i < numChannels; ++i)
+            FloatVectorOperations::copy (buffer.getWritePointer (i, startSample), b.getChannel (i), numSamples);
+
+        unpackSandboxMidi (b.midiOut, jmin (b.numMidiOutBytes, (juce::int32) SandboxSharedBlock::midiBytes),
+                           midiOutScratch, startSample);
+
+        if (b.latencySamples != getLatencySamples())
+            setLatencySamples (b.latencySamples);
+
+        return true;
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SandboxedPluginInstance)
+};
+
+//==============================================================================
+std::unique_ptr<AudioPluginInstance> createSandboxedPluginInstance (AudioPluginFormatManager& formatManager,
+                                                                    const String& group,
+                                                                    const PluginDescription& description,
+                                                                    double sampleRate, int blockSize,
+                                                                    String& errorMessage)
+{
+    CRASH_TRACER
+
+    auto process = SandboxProcess::getOrLaunch (group);
+
+    if (process == nullptr)
+    {
+        // panic! Can't run the child process for some reason, so just load it here..
+        TRACKTION_LOG_ERROR ("Falling back to loading " + description.name + " in main process..");
+        return std::unique_ptr<AudioPluginInstance> (formatManager.createPluginInstance (description, sampleRate, blockSize, errorMessage));
+    }
+
+    auto sharedFile = createSandboxSharedFile();
+    auto mappedFile = std::make_unique<MemoryMappedFile> (sharedFile, MemoryMappedFile::readWrite);
+
+    if (sharedFile == File() || getSandboxSharedBlock (*mappedFile) == nullptr)
+    {
+        sharedFile.deleteFile();
+        errorMessage = TRANS("Couldn't create the shared memory for the plugin");
+        return {};
+    }
+
+    static std::atomic<int> lastInstanceID { 0 };
+    const int instanceID = ++lastInstanceID;
+
+    XmlElement m ("LOAD");
+    m.setAttribute ("id", instanceID);
+    m.setAttribute ("file", sharedFile.getFullPathName());
+    m.setAttribute ("rate", sampleRate);
+    m.setAttribute ("blockSize", blockSize);
+    m.addChildElement (description.createXml().release());
+
+    auto reply = process->sendAndWait (m, 30000);
+
+    if (reply == nullptr || reply->hasAttribute ("error"))
+    {
+        if (reply != nullptr)
+            errorMessage = reply->getStringAttribute ("error");
+        else if (process->crashed)
+            errorMessage = TRANS("The plugin crashed while loading");
+        else
+            errorMessage = TRANS("The plugin took too long to load");
+
+        mappedFile.reset();
+        sharedFile.deleteFile();
+        return {};
+    }
+
+    return std::make_unique<SandboxedPluginInstance> (process, description, *reply, instanceID,
+                                                      sharedFile, std::move (mappedFile));
+}
+
+//==============================================================================
+/** A plugin loaded by the child process, processing the blocks the host puts in its shared memory. */
+struct SandboxHostedPlugin  : private juce::Thread
+{
+    SandboxHostedPlugin (int id, std::unique_ptr<AudioPluginInstance> p, std::unique_ptr<MemoryMappedFile> f)
+        : Thread ("Sandboxed Plugin"), instanceID (id), instance (std::move (p)), mappedFile (std::move (f))
+    {
+        block = getSandboxSharedBlock (*mappedFile);
+        jassert (block != nullptr);
+
+        instance->setPlayHead (&playHead);
+        midi.ensureSize (SandboxSharedBlock::midiBytes);
+    }
+
+    ~SandboxHostedPlugin() override
+    {
+        release();
+        instance->setPlayHead (nullptr);
+    }
+
+    void prepare (double sampleRate, int blockSize)
+    {
+        release();
+
+        instance->prepareToPlay (sampleRate, jmin (blockSize, (int) SandboxSharedBlock::maxSamples));
+        prepared = true;
+
+        lastRequest = block->requestCount.load (std::memory_order_acquire);
+        block->replyCount.store (lastRequest, std::memory_order_release);
+        startThread (9);
+    }
+
+    void release()
+    {
+        stopThread (2000);
+
+        if (prepared)
+        {
+            prepared = false;
+            instance->releaseResources();
+        }
+    }
+
+    const int instanceID;
+    std::unique_ptr<AudioPluginInstance> instance;
+
+private:
+    struct SandboxPlayHead  : public AudioPlayHead
+    {
+        bool getCurrentPosition (CurrentPositionInfo& result) override
+        {
+            if (transport.isValid == 0)
+                return false;
+
+            result.resetToDefault();
+            result.bpm                          = transport.bpm;
+            result.timeInSeconds                = transport.timeInSeconds;
+            result.ppqPosition                  = transport.ppqPosition;
+            result.ppqPositionOfLastBarStart    = transport.ppqPositionOfLastBarStart;
+            result.ppqLoopStart                 = transport.ppqLoopStart;
+            result.ppqLoopEnd                   = transport.ppqLoopEnd;
+            result.timeInSamples                = transport.timeInSamples;
+            result.timeSigNumerator             = transport.timeSigNumerator;
+            result.timeSigDenominator           = transport.timeSigDenominator;
+            result.isPlaying                    = transport.isPlaying != 0;
+            result.isRecording                  = transport.isRecording != 0;
+            result.isLooping                    = transport.isLooping != 0;
+            return true;
+        }
+
+        SandboxSharedBlock::Transport transport {};
+    };
+
+    std::unique_ptr<MemoryMappedFile> mappedFile;
+    SandboxSharedBlock* block = nullptr;
+    SandboxPlayHead playHead;
+    MidiBuffer midi;
+    juce::uint32 lastRequest = 0;
+    bool prepared = false;
+
+    void run() override
+    {
+        while (! threadShouldExit())
+        {
+            auto request = block->requestCount.load (std::memory_order_acquire);
+
+            if (request == lastRequest)
+            {
+                waitForSandboxChange (block->requestCount, lastRequest, 100.0);
+                continue;
+            }
+
+            lastRequest = request;
+            processRequest();
+
+            block->replyCount.store (request, std::memory_order_release);
+            wakeSandboxWaiters (block->replyCount);
+        }
+    }
+
+    void processRequest()
+    {
+        auto& b = *block;
+        const int numSamples  = jlimit (0, (int) SandboxSharedBlock::maxSamples, (int) b.numSamples);
+        const int numChannels = jlimit (0, (int) SandboxSharedBlock::maxChannels, (int) b.numChannels);
+
+        if (b.resetRequested != 0)
+            instance->reset();
+
+        auto& params = instance->getParameters();
+
+        for (int i = 0; i < jmin ((int) b.numParameterChanges, (int) SandboxSharedBlock::maxParameterChanges); ++i)
+            if (auto p = params[b.parameterChanges[i].index])
+                p->setValue (b.parameterChanges[i].value);
+
+        playHead.transport = b.transport;
+
+        float* channels[SandboxSharedBlock::maxChannels];
+
+        for (int i = 0; i < numChannels; ++i)
+            channels[i] = b.getChannel (i);
+
+        AudioBuffer<float> buffer (channels, numChannels, numSamples);
+
+        midi.clear();
+        unpackSandboxMidi (b.midiIn, jmin ((int) b.numMidiInBytes, (int) SandboxSharedBlock::midiBytes), midi, 0);
+
+        {
+            const ScopedLock sl (instance->getCallbackLock());
+
+            if (instance->isSuspended())
+            {
+                buffer.clear();
+                midi.clear();
+            }
+            else
+            {
+                instance->processBlock (buffer, midi);
+            }
+        }
+
+        b.numMidiOutBytes = packSandboxMidi (midi, b.midiOut, 0, numSamples);
+        b.latencySamples = instance->getLatencySamples();
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SandboxHostedPlugin)
+};
+
+//==============================================================================
+struct SandboxSlaveProcess  : public ChildProcessSlave,
+                              private AsyncUpdater
+{
+    SandboxSlaveProcess()
+    {
+        pluginFormatManager.addDefaultFormats();
+    }
+
+    void handleConnectionMade() override {}
+
+    void handleConnectionLost() override
+    {
+        std::exit (0);
+    }
+
+    void handleMessage (const juce::XmlElement& m)
+    {
+        juce::XmlElement reply ("REPLY");
+        reply.setAttribute ("req", m.getIntAttribute ("req"));
+
+        const int instanceID = m.getIntAttribute ("id");
+
+        if (m.hasTagName ("LOAD"))
+        {
+            loadPlugin (m, reply);
+        }
+        else if (auto p = findPlugin (instanceID))
+        {
+            auto& instance = *p->instance;
+
+            if (m.hasTagName ("UNLOAD"))
+            {
+                plugins.removeObject (p);
+            }
+            else if (m.hasTagName ("PREPARE"))
+            {
+                p->prepare (m.getDoubleAttribute ("rate"), m.getIntAttribute ("blockSize"));
+                addPluginState (instance, reply);
+            }
+            else if (m.hasTagName ("RELEASE"))
+            {
+                p->release();
+            }
+            else if (m.hasTagName ("PROGRAM"))
+            {
+                {
+                    const ScopedLock sl (instance.getCallbackLock());
+                    instance.setCurrentProgram (m.getIntAttribute ("index"));
+                }
+
+                addPluginState (instance, reply);
+                addParameterValues (instance, reply);
+            }
+            else if (m.hasTagName ("PROGRAMNAME"))
+            {
+                instance.changeProgramName (m.getIntAttribute ("index"), m.getStringAttribute ("name"));
+            }
+            else if (m.hasTagName ("GETSTATE"))
+            {
+                MemoryBlock state;
+                instance.getStateInformation (state);
+                reply.setAttribute ("state", state.toBase64Encoding());
+            }
+            else if (m.hasTagName ("SETSTATE"))
+            {
+                MemoryBlock state;
+                state.fromBase64Encoding (m.getStringAttribute ("state"));
+
+                {
+                    const ScopedLock sl (instance.getCallbackLock());
+                    instance.setStateInformation (state.getData(), (int) state.getSize());
+                }
+
+                addPluginState (instance, reply);
+                addParameterValues (instance, reply);
+            }
+        }
+        else
+        {
+            reply.setAttribute ("error", "Unknown plugin");
+        }
+
+        sendMessageToMaster (createSandboxMessage (reply));
+    }
+
+private:
+    AudioPluginFormatManager pluginFormatManager;
+    OwnedArray<SandboxHostedPlugin> plugins;
+    OwnedArray<XmlElement, CriticalSection> pendingMessages;
+
+    SandboxHostedPlugin* findPlugin (int instanceID) const
+    {
+        for (auto p : plugins)
+            if (p->instanceID == instanceID)
+                return p;
+
+        return {};
+    }
+
+    void loadPlugin (const juce::XmlElement& m, juce::XmlElement& reply)
+    {
+        PluginDescription desc;
+
+        if (auto e = m.getChildByName ("PLUGIN"))
+            desc.loadFromXml (*e);
+
+        String error;
+        auto instance = std::unique_ptr<AudioPluginInstance> (pluginFormatManager.createPluginInstance (desc, m.getDoubleAttribute ("rate"),
+                                                                                                        m.getIntAttribute ("blockSize"), error));
+
+        if (instance == nullptr)
+        {
+            reply.setAttribute ("error", error.isNotEmpty() ? error : String ("Couldn't load the plugin"));
+            return;
+        }
+
+        instance->enableAllBuses();
+
+        if (jmax (instance->getTotalNumInputChannels(), instance->getTotalNumOutputChannels()) > SandboxSharedBlock::maxChannels)
+        {
+            reply.setAttribute ("error", "Too many channels to run in a sandbox");
+            return;
+        }
+
+        auto mappedFile = std::make_unique<MemoryMappedFile> (File (m.getStringAttribute ("file")), MemoryMappedFile::readWrite);
+
+        if (getSandboxSharedBlock (*mappedFile) == nullptr)
+        {
+            reply.setAttribute ("error", "Couldn't open the shared memory");
+            return;
+        }
+
+        reply.setAttribute ("numIns", instance->getTotalNumInputChannels());
+        reply.setAttribute ("numOuts", instance->getTotalNumOutputChannels());
+        reply.setAttribute ("acceptsMidi", instance->acceptsMidi());
+        reply.setAttribute ("producesMidi", instance->producesMidi());
+        reply.setAttribute ("supportsMPE", instance->supportsMPE());
+        addPluginState (*instance, reply);
+
+        for (int i = 0; i < instance->getNumPrograms(); ++i)
+            reply.createNewChildElement ("PROGRAM")->setAttribute ("name", instance->getProgramName (i));
+
+        for (auto p : instance->getParameters())
+        {
+            auto e = reply.createNewChildElement ("PARAM");
+            e->setAttribute ("name", p->getName (1024));
+            e->setAttribute ("label", p->getLabel());
+            e->setAttribute ("default", p->getDefaultValue());
+            e->setAttribute ("value", p->getValue());
+            e->setAttribute ("steps", p->getNumSteps());
+            e->setAttribute ("automatable", p->isAutomatable());
+            e->setAttribute ("discrete", p->isDiscrete());
+        }
+
+        plugins.add (new SandboxHostedPlugin (m.getIntAttribute ("id"), std::move (instance), std::move (mappedFile)));
+    }
+
+    static void addPluginState (AudioPluginInstance& instance, juce::XmlElement& reply)
+    {
+        reply.setAttribute ("latency", instance.getLatencySamples());
+        reply.setAttribute ("tail", instance.getTailLengthSeconds());
+        reply.setAttribute ("program", instance.getCurrentProgram());
+    }
+
+    static void addParameterValues (AudioPluginInstance& instance, juce::XmlElement& reply)
+    {
+        auto& params = instance.getParameters();
+
+        for (int i = 0; i < params.size(); ++i)
+        {
+            auto e = reply.createNewChildElement ("VALUE");
+            e->setAttribute ("index", i);
+            e->setAttribute ("value", params.getUnchecked (i)->getValue());
+        }
+    }
+
+    void handleMessageFromMaster (const MemoryBlock& mb) override
+    {
+        if (auto xml = std::unique_ptr<XmlElement> (XmlDocument::parse (mb.toString())))
+        {
+            pendingMessages.add (xml.release());
+            triggerAsyncUpdate();
+        }
+    }
+
+    void handleMessageSafely (const juce::XmlElement& m)
+    {
+       #if JUCE_WINDOWS
+        __try
+        {
+       #endif
+
+            handleMessage (m);
+
+       #if JUCE_WINDOWS
+        }
+        __except (1)
+        {
+            Process::terminate();
+        }
+       #endif
+    }
+
+    void handleAsyncUpdate() override
+    {
+        while (pendingMessages.size() > 0)
+            if (auto xml = pendingMessages.removeAndReturn (0))
+                handleMessageSafely (*xml);
+    }
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SandboxSlaveProcess)
+};
+
+bool PluginManager::startChildProcessPluginHost (const String& commandLine)
+{
+    auto slave = std::make_unique<SandboxSlaveProcess>();
+
+    if (slave->initialiseFromCommandLine (commandLine, sandboxCommandLineUID))
+    {
+       #if JUCE_MAC
+        setupSignalHandling();
+       #endif
+
+        slave.release(); // allow the slave object to stay alive - it'll handle its own deletion.
+        return true;
+    }
+
+    return false;
+}
+
+} // namespace tracktion_engine
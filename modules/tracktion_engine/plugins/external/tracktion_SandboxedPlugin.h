@@ -0,0 +1,32 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+/** Creates an AudioPluginInstance that proxies a plugin loaded in a child process.
+
+    All the plugins created with the same group name share one child process, so if a
+    plugin crashes it only takes down the others in its group, which then output silence.
+    Audio, MIDI and parameter changes are passed through shared memory once per block.
+
+    If the child process can't be launched at all, the plugin is loaded in this process
+    using the format manager instead. If it fails to load in the child process, this
+    returns nullptr and sets the error message.
+
+    @see EngineBehaviour::getSandboxProcessGroup, PluginManager::startChildProcessPluginHost
+*/
+std::unique_ptr<juce::AudioPluginInstance> createSandboxedPluginInstance (juce::AudioPluginFormatManager&,
+                                                                          const juce::String& group,
+                                                                          const juce::PluginDescription&,
+                                                                          double sampleRate, int blockSize,
+                                                                          juce::String& errorMessage);
+
+} // namespace tracktion_engine
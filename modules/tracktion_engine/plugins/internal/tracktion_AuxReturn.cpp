@@ -170,6 +170,11 @@ void AuxReturnPlugin::applyAudioFromSend (const juce::AudioBuffer<float>& buffer
     }
 }
 
+void AuxReturnPlugin::setProcessedInGraphOrder (bool b)
+{
+    processedInGraphOrder = b;
+}
+
 void AuxReturnPlugin::applyToBuffer (const AudioRenderContext& fc)
 {
     if (fc.destBuffer == nullptr)
@@ -177,28 +182,34 @@ void AuxReturnPlugin::applyToBuffer (const AudioRenderContext& fc)
 
     SCOPED_REALTIME_CHECK
 
-    if (samplesInPreviousBuffer > 0)
+    // When the sends have all been processed already, this block's audio can be played
+    // now, otherwise the previous block is played as the sends may not have run yet
+    const bool useCurrentBlock = processedInGraphOrder;
+    auto& sourceBuffer = useCurrentBlock ? currentBuffer : previousBuffer;
+    const int samplesInSource = useCurrentBlock ? samplesInCurrentBuffer : samplesInPreviousBuffer;
+
+    if (samplesInSource > 0)
     {
-        const int sampsToCopy = jmin (fc.bufferNumSamples, samplesInPreviousBuffer);
+        const int sampsToCopy = jmin (fc.bufferNumSamples, samplesInSource);
 
-        if (fc.destBuffer->getNumChannels() == 1 && previousBuffer->getNumChannels() >= 1)
+        if (fc.destBuffer->getNumChannels() == 1 && sourceBuffer->getNumChannels() >= 1)
         {
             // stereo -> mono
-            for (int i = previousBuffer->getNumChannels(); --i >= 0;)
+            for (int i = sourceBuffer->getNumChannels(); --i >= 0;)
             {
                 // stereo -> mono
-                fc.destBuffer->addFrom (0, fc.bufferStartSample, *previousBuffer, i, 0, sampsToCopy);
+                fc.destBuffer->addFrom (0, fc.bufferStartSample, *sourceBuffer, i, 0, sampsToCopy);
             }
         }
         else
         {
-            for (int i = jmin (previousBuffer->getNumChannels(),
+            for (int i = jmin (sourceBuffer->getNumChannels(),
                                fc.destBuffer->getNumChannels()); --i >= 0;)
             {
                 // stereo -> stereo
                 // mono   -> mono
                 // mono   -> stereo
-                fc.destBuffer->addFrom (i, fc.bufferStartSample, *previousBuffer, i, 0, sampsToCopy);
+                fc.destBuffer->addFrom (i, fc.bufferStartSample, *sourceBuffer, i, 0, sampsToCopy);
             }
         }
     }
@@ -43,12 +43,19 @@ public:
 
     void restorePluginStateFromValueTree (const juce::ValueTree&) override;
 
+    /** If this is true, all the sends to this bus are processed before this in each block,
+        so the audio they send is played straight away rather than in the next block.
+        @see AuxSendPlugin::setBusesProcessedInGraphOrder
+    */
+    void setProcessedInGraphOrder (bool);
+
     juce::CachedValue<int> busNumber;
 
 private:
     std::unique_ptr<juce::AudioBuffer<float>> previousBuffer, currentBuffer;
     int samplesInPreviousBuffer, samplesInCurrentBuffer;
     bool initialised = false;
+    std::atomic<bool> processedInGraphOrder { false };
     juce::CriticalSection addingAudioLock;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AuxReturnPlugin)
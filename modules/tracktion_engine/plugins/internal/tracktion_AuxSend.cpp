@@ -70,12 +70,28 @@ String AuxSendPlugin::getShortName (int)
     return TRANS("Send") + ":" + String (busNumber + 1);
 }
 
+void AuxSendPlugin::setBusesProcessedInGraphOrder (Edit& edit, const juce::BigInteger& busNumbers)
+{
+    for (auto p : getAllPlugins (edit, false))
+    {
+        if (auto send = dynamic_cast<AuxSendPlugin*> (p))
+            send->setProcessedInGraphOrder (busNumbers[send->getBusNumber()]);
+        else if (auto ret = dynamic_cast<AuxReturnPlugin*> (p))
+            ret->setProcessedInGraphOrder (busNumbers[ret->busNumber]);
+    }
+}
+
+void AuxSendPlugin::setProcessedInGraphOrder (bool b)
+{
+    processedInGraphOrder = b;
+}
+
 void AuxSendPlugin::initialise (const PlaybackInitialisationInfo& info)
 {
     delayBuffer.setSize (2, info.blockSizeSamples, false);
     delayBuffer.clear();
     lastGain = volumeFaderPositionToGain (gain->getCurrentValue());
-    latencySeconds = info.blockSizeSamples / info.sampleRate;
+    latencySeconds = processedInGraphOrder ? 0.0 : info.blockSizeSamples / info.sampleRate;
 
     initialiseWithoutStopping (info);
 }
@@ -131,6 +147,10 @@ void AuxSendPlugin::applyToBuffer (const AudioRenderContext& fc)
         }
     }
 
+    // The returns play this block straight away so there's nothing to line up with
+    if (processedInGraphOrder)
+        return;
+
     delayBuffer.setSize (jmax (fc.destBuffer->getNumChannels(), delayBuffer.getNumChannels()),
                          jmax (fc.bufferNumSamples, delayBuffer.getNumSamples()),
                          true);
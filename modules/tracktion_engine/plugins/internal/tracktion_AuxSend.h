@@ -31,6 +31,16 @@ public:
     static juce::StringArray getBusNames (Edit&);
     static juce::String getDefaultBusName (int busIndex);
 
+    /** Tells all the sends and returns in an Edit which buses have all their sends processed
+        before their returns in each block. The playback graph does this by adding the sends'
+        trees as inputs to the returns' trees.
+        For these buses the returns play the current block and the sends don't need to delay
+        their own output by a block to stay in time with them.
+        This needs to be called before the plugins are initialised.
+    */
+    static void setBusesProcessedInGraphOrder (Edit&, const juce::BigInteger& busNumbers);
+    void setProcessedInGraphOrder (bool);
+
     //==============================================================================
     static const char* getPluginName()              { return NEEDS_TRANS("Aux Send"); }
     static const char* xmlTypeName;
@@ -52,6 +62,7 @@ public:
     bool canBeAddedToRack() override                 { return false; }
     double getLatencySeconds() override              { return latencySeconds; }
     bool needsConstantBufferSize() override          { return true; }
+    bool canBeBypassedWhenSilent() override          { return false; }
 
     void restorePluginStateFromValueTree (const juce::ValueTree&) override;
 
@@ -68,6 +79,7 @@ private:
     float lastGain = 1.0f;
     juce::AudioBuffer<float> delayBuffer { 2, 32 };
     double latencySeconds = 0.0;
+    std::atomic<bool> processedInGraphOrder { false };
     Track* ownerTrack = nullptr;
 
     //==============================================================================
@@ -141,12 +141,16 @@ public:
         const int numChans = rc.destBuffer->getNumChannels();
         const int numSamples = rc.destBuffer->getNumSamples();
 
-        AudioRenderContext rc2 (rc);
-        AudioScratchBuffer scratch (numChans, numSamples);
+        // The input is rendered straight into the buffer the plugin reads from, rather than into
+        // a scratch buffer that then has to be copied. It was sized at initialise so this won't
+        // normally allocate.
+        auto& returnBuffer = owner.returnBuffer;
+        returnBuffer.setSize (numChans, numSamples, false, false, true);
+        returnBuffer.clear();
 
-        rc2.destBuffer = &scratch.buffer;
+        AudioRenderContext rc2 (rc);
+        rc2.destBuffer = &returnBuffer;
         rc2.bufferStartSample = 0;
-        scratch.buffer.clear();
 
         rc2.bufferForMidiMessages = &midiScratch;
         midiScratch.clear();
@@ -176,6 +180,21 @@ InsertPlugin::InsertPlugin (PluginCreationInfo info)  : Plugin (info)
     inputDevice.referTo (state, IDs::inputDevice, um);
     outputDevice.referTo (state, IDs::outputDevice, um);
     manualAdjustMs.referTo (state, IDs::manualAdjustMs, um);
+    measuredLatencyMs.referTo (state, IDs::measuredLatencyMs, um, -1.0);
+
+    latencyMeasurementTimer.setCallback ([this]
+                                         {
+                                             auto measurementState = latencyMeasurementState.load();
+
+                                             if (measurementState == measurementFinished)
+                                                 measuredLatencyMs = measuredLatencySamples.load() * 1000.0 / sampleRate;
+
+                                             if (measurementState == measurementFinished || measurementState == measurementFailed)
+                                             {
+                                                 latencyMeasurementState = notMeasuring;
+                                                 latencyMeasurementTimer.stopTimer();
+                                             }
+                                         });
 
     updateDeviceTypes();
 }
@@ -206,7 +225,7 @@ AudioNode* InsertPlugin::createSendAudioNode (OutputDevice& device)
 
         if (AudioNode* returnNode = getReturnNode())
         {
-            MixerAudioNode* mixer = new MixerAudioNode (false, false);
+            MixerAudioNode* mixer = new MixerAudioNode (edit, false, false);
             mixer->addInput (node);
             mixer->addInput (returnNode);
 
@@ -243,8 +262,11 @@ void InsertPlugin::initialise (const PlaybackInitialisationInfo& info)
 
 void InsertPlugin::initialiseWithoutStopping (const PlaybackInitialisationInfo& info)
 {
-    // This latency number is from trial and error, may need more testing
-    latencySeconds = manualAdjustMs / 1000.0 + (double)info.blockSizeSamples / info.sampleRate;
+    // If it hasn't been measured, this latency number is from trial and error, may need more testing
+    if (measuredLatencyMs >= 0.0)
+        latencySeconds = (manualAdjustMs + measuredLatencyMs) / 1000.0;
+    else
+        latencySeconds = manualAdjustMs / 1000.0 + (double)info.blockSizeSamples / info.sampleRate;
 }
 
 void InsertPlugin::deinitialise()
@@ -259,6 +281,13 @@ void InsertPlugin::deinitialise()
 void InsertPlugin::applyToBuffer (const AudioRenderContext& fc)
 {
     CRASH_TRACER
+
+    if (latencyMeasurementState.load() != notMeasuring)
+    {
+        processLatencyMeasurement (fc);
+        return;
+    }
+
     // Fill send buffer with data
     if (sendDeviceType == audioDevice && fc.destBuffer != nullptr)
     {
@@ -300,6 +329,80 @@ void InsertPlugin::applyToBuffer (const AudioRenderContext& fc)
     }
 }
 
+void InsertPlugin::startLatencyMeasurement()
+{
+    TRACKTION_ASSERT_MESSAGE_THREAD
+
+    if (sendDeviceType != audioDevice || returnDeviceType != audioDevice || isMeasuringLatency())
+        return;
+
+    samplesInMeasurementState = 0;
+    latencyMeasurementState = waitingForSilence;
+    latencyMeasurementTimer.startTimer (50);
+}
+
+void InsertPlugin::processLatencyMeasurement (const AudioRenderContext& fc)
+{
+    auto measurementState = latencyMeasurementState.load();
+    const int numReturnSamples = jmin (returnBuffer.getNumSamples(), fc.bufferNumSamples);
+
+    auto findFirstSampleAbove = [this, numReturnSamples] (float threshold)
+    {
+        for (int i = 0; i < numReturnSamples; ++i)
+            for (int chan = returnBuffer.getNumChannels(); --chan >= 0;)
+                if (std::abs (returnBuffer.getSample (chan, i)) > threshold)
+                    return i;
+
+        return -1;
+    };
+
+    sendBuffer.clear();
+
+    if (measurementState == waitingForSilence)
+    {
+        // Anything that was sent before the measurement started has to come back first,
+        // otherwise it could be mistaken for the impulse
+        if (findFirstSampleAbove (0.01f) >= 0)
+            samplesInMeasurementState = 0;
+        else
+            samplesInMeasurementState += fc.bufferNumSamples;
+
+        if (samplesInMeasurementState > sampleRate / 4)
+        {
+            for (int i = sendBuffer.getNumChannels(); --i >= 0;)
+                sendBuffer.setSample (i, 0, 0.5f);
+
+            // The impulse is at the start of this block, and can't come back until the next one
+            samplesInMeasurementState = fc.bufferNumSamples;
+            latencyMeasurementState = waitingForImpulse;
+        }
+    }
+    else if (measurementState == waitingForImpulse)
+    {
+        // The return for each block gets to the plugin at the same time as its send goes out,
+        // so this is how long the plugin's output is delayed by
+        auto impulseIndex = findFirstSampleAbove (0.1f);
+
+        if (impulseIndex >= 0)
+        {
+            measuredLatencySamples = samplesInMeasurementState + impulseIndex;
+            latencyMeasurementState = measurementFinished;
+        }
+        else if (samplesInMeasurementState > sampleRate)
+        {
+            latencyMeasurementState = measurementFailed;
+        }
+
+        samplesInMeasurementState += fc.bufferNumSamples;
+    }
+
+    if (fc.bufferForMidiMessages != nullptr)
+        fc.bufferForMidiMessages->clear();
+
+    if (fc.destBuffer != nullptr)
+        fc.destBuffer->clear (fc.bufferStartSample, fc.bufferNumSamples);
+}
+
 String InsertPlugin::getSelectableDescription()
 {
     return TRANS("Insert Plugin");
@@ -316,6 +419,9 @@ void InsertPlugin::restorePluginStateFromValueTree (const juce::ValueTree& v)
     if (v.hasProperty (IDs::inputDevice))
         inputDevice = v.getProperty (IDs::inputDevice).toString();
 
+    if (v.hasProperty (IDs::measuredLatencyMs))
+        measuredLatencyMs = v.getProperty (IDs::measuredLatencyMs);
+
     for (auto p : getAutomatableParameters())
         p->updateFromAttachedValue();
 }
@@ -386,19 +492,8 @@ void InsertPlugin::fillSendBuffer (const AudioRenderContext& rc)
 void InsertPlugin::fillReturnBuffer (const AudioRenderContext& rc)
 {
     CRASH_TRACER
-    if (returnDeviceType == audioDevice)
-    {
-        if (rc.destBuffer == nullptr)
-            return;
-
-        auto& src = *rc.destBuffer;
-        const int numChans      = jmin (returnBuffer.getNumChannels(), src.getNumChannels());
-        const int numSamples    = jmin (returnBuffer.getNumSamples(), src.getNumSamples());
-
-        for (int i = numChans; --i >= 0;)
-            returnBuffer.copyFrom (i, 0, src, i, rc.bufferStartSample, numSamples);
-    }
-    else if (returnDeviceType == midiDevice)
+    // The audio has already been rendered into the returnBuffer
+    if (returnDeviceType == midiDevice)
     {
         if (rc.bufferForMidiMessages != nullptr)
             returnMidiBuffer.mergeFromAndClear (*rc.bufferForMidiMessages);
@@ -37,6 +37,7 @@ public:
     void getChannelNames (juce::StringArray*, juce::StringArray*) override;
     bool takesAudioInput() override;
     bool takesMidiInput() override;
+    bool canBeBypassedWhenSilent() override                 { return false; }
     bool canBeAddedToClip() override;
     bool needsConstantBufferSize() override;
 
@@ -54,9 +55,22 @@ public:
     juce::CachedValue<juce::String> name, inputDevice, outputDevice;
     juce::CachedValue<double> manualAdjustMs;
 
+    /** The round trip through the devices, as last measured by startLatencyMeasurement(), or a
+        negative number if it hasn't been. This includes the engine's own buffering, so it should be
+        measured again if the device's buffer size changes. manualAdjustMs is added on top.
+    */
+    juce::CachedValue<double> measuredLatencyMs;
+
     void updateDeviceTypes();
     void showLatencyTester();
 
+    /** Sends an impulse out through the insert whilst playing, and times how long it takes to come
+        back, which is then set as measuredLatencyMs. The insert's output is silent whilst measuring.
+        If nothing comes back within a second, the previous measurement is kept.
+    */
+    void startLatencyMeasurement();
+    bool isMeasuringLatency() const noexcept    { return latencyMeasurementState.load() != notMeasuring; }
+
     static void getPossibleDeviceNames (Engine&,
                                         juce::StringArray& devices,
                                         juce::StringArray& aliases,
@@ -72,6 +86,14 @@ private:
     double latencySeconds = 0.0;
     DeviceType sendDeviceType = noDevice, returnDeviceType = noDevice;
 
+    enum LatencyMeasurementState { notMeasuring, waitingForSilence, waitingForImpulse, measurementFinished, measurementFailed };
+    std::atomic<int> latencyMeasurementState { notMeasuring };
+    std::atomic<int> measuredLatencySamples { 0 };
+    int samplesInMeasurementState = 0;
+    LambdaTimer latencyMeasurementTimer;
+
+    void processLatencyMeasurement (const AudioRenderContext&);
+
     bool hasAudio() const;
     bool hasMidi() const;
 
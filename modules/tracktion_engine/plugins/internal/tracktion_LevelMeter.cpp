@@ -61,7 +61,10 @@ void LevelMeterPlugin::applyToBuffer (const AudioRenderContext& fc)
 {
     SCOPED_REALTIME_CHECK
 
-    if (fc.destBuffer != nullptr)
+    // The VolumeAndPanPlugin before this may have measured the block already
+    const bool alreadyMeasured = audioAlreadyMeasured.exchange (false);
+
+    if (fc.destBuffer != nullptr && ! alreadyMeasured)
         measurer.processBuffer (*fc.destBuffer, fc.bufferStartSample, fc.bufferNumSamples);
 
     if (fc.bufferForMidiMessages != nullptr)
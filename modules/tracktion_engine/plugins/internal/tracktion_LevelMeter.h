@@ -30,6 +30,7 @@ public:
     juce::String getTooltip() override              { return TRANS("Level meter plugin") + "$levelmeterplugin"; }
     bool canBeDisabled() override                   { return false; }
     bool needsConstantBufferSize() override         { return false; }
+    bool canBeBypassedWhenSilent() override         { return false; }
 
     int getNumOutputChannelsGivenInputs (int numInputChannels) override     { return juce::jmin (numInputChannels, 2); }
 
@@ -45,10 +46,16 @@ public:
     //==============================================================================
     LevelMeasurer measurer;
 
+    /** Called by a VolumeAndPanPlugin just before this to say it's already passed the levels of the
+        current block on to the measurer.
+    */
+    void setAudioAlreadyMeasured() noexcept         { audioAlreadyMeasured = true; }
+
     juce::CachedValue<bool> showMidiActivity;
 
 private:
     int controllerTrack = -1;
+    std::atomic<bool> audioAlreadyMeasured { false };
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LevelMeterPlugin)
 };
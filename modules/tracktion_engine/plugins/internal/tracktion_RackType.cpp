@@ -484,12 +484,10 @@ struct RackType::WindowStateList  : public ValueTreeObjectList<WindowState>
 //==============================================================================
 struct RackType::RenderContext
 {
-    RenderContext (RackType& type, bool useExperimentalProcessing)
+    RenderContext (RackType& type)
     {
-        juce::ignoreUnused (useExperimentalProcessing);
-        
        #if ENABLE_EXPERIMENTAL_TRACKTION_GRAPH
-        if (useExperimentalProcessing)
+        if (type.usesGraphProcessing())
             createExperiemntalProcessor (type);
         else
        #endif
@@ -515,7 +513,7 @@ struct RackType::RenderContext
                   bool isRendering)
     {
        #if ENABLE_EXPERIMENTAL_TRACKTION_GRAPH
-        if (processor)
+        if (processor != nullptr || parallelProcessor != nullptr)
         {
             processExperiemntal (playhead, playheadOutputTime,
                                  outputBuffer, inputBuffer,
@@ -547,7 +545,8 @@ private:
 
    #if ENABLE_EXPERIMENTAL_TRACKTION_GRAPH
     std::shared_ptr<InputProvider> inputProvider;
-    std::unique_ptr<RackNodePlayer<NodePlayer>> processor;
+    std::unique_ptr<RackNodePlayer<tracktion_graph::NodePlayer>> processor;
+    std::unique_ptr<RackNodePlayer<tracktion_graph::MultiThreadedNodePlayer>> parallelProcessor;
    #endif
 
    #if ENABLE_EXPERIMENTAL_TRACKTION_GRAPH
@@ -557,6 +556,7 @@ private:
             || type.numActiveInstances.load() == 0)
         {
             processor.reset();
+            parallelProcessor.reset();
             inputProvider.reset();
            return;
         }
@@ -565,9 +565,22 @@ private:
         auto rackNode = RackNodeBuilder::createRackNode (type, type.sampleRate, type.blockSize, inputProvider);
         jassert (tracktion_graph::test_utilities::areNodeIDsUnique (*rackNode, true));
 
-        processor = std::make_unique<RackNodePlayer<NodePlayer>> (std::move (rackNode), inputProvider, false);
-        processor->prepareToPlay (type.sampleRate, type.blockSize);
-        latencySeconds = processor->getLatencySamples() / type.sampleRate;
+        auto& behaviour = type.edit.engine.getEngineBehaviour();
+
+        if (behaviour.shouldProcessRacksInParallel())
+        {
+            parallelProcessor = std::make_unique<RackNodePlayer<tracktion_graph::MultiThreadedNodePlayer>> (std::move (rackNode), inputProvider, false);
+            parallelProcessor->getNodePlayer().setMaxNumThreads ((size_t) behaviour.getNumberOfCPUsToUseForAudio());
+            parallelProcessor->getNodePlayer().setNumaAware (behaviour.shouldUseNumaAwareProcessing());
+            parallelProcessor->prepareToPlay (type.sampleRate, type.blockSize);
+            latencySeconds = parallelProcessor->getLatencySamples() / type.sampleRate;
+        }
+        else
+        {
+            processor = std::make_unique<RackNodePlayer<tracktion_graph::NodePlayer>> (std::move (rackNode), inputProvider, false);
+            processor->prepareToPlay (type.sampleRate, type.blockSize);
+            latencySeconds = processor->getLatencySamples() / type.sampleRate;
+        }
     }
    #endif
 
@@ -632,7 +645,11 @@ private:
         //TODO: This probably should be the master stream time
         auto streamSampleRange = juce::Range<int64_t>::withStartAndLength (0, inputBuffer.getNumSamples());
         juce::dsp::AudioBlock<float> outputBlock (outputBuffer);
-        processor->process ({ streamSampleRange, { outputBlock, midiOut } }, playhead, playheadOutputTime);
+
+        if (parallelProcessor != nullptr)
+            parallelProcessor->process ({ streamSampleRange, { outputBlock, midiOut } }, playhead, playheadOutputTime);
+        else
+            processor->process ({ streamSampleRange, { outputBlock, midiOut } }, playhead, playheadOutputTime);
     }
    #endif
 };
@@ -684,7 +701,7 @@ RackType::RackType (const juce::ValueTree& v, Edit& owner)
     renderContextBuilder.setFunction ([this]
                                       {
                                           std::atomic_exchange (&renderContext,
-                                                                std::make_shared<RenderContext> (*this, isExperimentalGraphProcessingEnabled()));
+                                                                std::make_shared<RenderContext> (*this));
                                       });
 }
 
@@ -1533,7 +1550,7 @@ void RackType::initialisePluginsIfNeeded (const PlaybackInitialisationInfo& info
 {
     latencyCalculation.reset();
 
-    if (! RackType::isExperimentalGraphProcessingEnabled())
+    if (! usesGraphProcessing())
     {
         for (auto f : getPlugins())
             f->baseClassInitialise (info);
@@ -1565,7 +1582,7 @@ void RackType::deregisterInstance (RackInstance* instance)
     {
         renderContextBuilder.handleUpdateNowIfNeeded();
         
-        if (! RackType::isExperimentalGraphProcessingEnabled())
+        if (! usesGraphProcessing())
         {
             for (auto f : getPlugins())
                 f->baseClassDeinitialise();
@@ -2142,6 +2159,16 @@ ModifierList& RackType::getModifierList() const noexcept
     #endif
  }
 
+ bool RackType::usesGraphProcessing() const
+ {
+    #if ENABLE_EXPERIMENTAL_TRACKTION_GRAPH
+     return isExperimentalGraphProcessingEnabled()
+             || edit.engine.getEngineBehaviour().shouldProcessRacksInParallel();
+    #else
+     return false;
+    #endif
+ }
+
 //==============================================================================
 struct RackTypeList::ValueTreeList  : public ValueTreeObjectList<RackType>
 {
@@ -161,6 +161,12 @@ public:
     static bool isExperimentalGraphProcessingEnabled();
 
 private:
+    /** True if this rack is processed by a tracktion_graph RackNodePlayer rather than
+        the legacy PluginRenderingInfo wrappers.
+        @see EngineBehaviour::shouldProcessRacksInParallel
+    */
+    bool usesGraphProcessing() const;
+
     struct PluginInfo
     {
         Plugin::Ptr plugin;
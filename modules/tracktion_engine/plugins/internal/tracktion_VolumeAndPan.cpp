@@ -180,6 +180,40 @@ static float getParentVcaDb (Track& track, double time)
     return volumeFaderPositionToDB (decibelsToVolumeFaderPosition (0) + posOffset);
 }
 
+/** Applies a gain ramp to a channel and returns its peak or RMS level afterwards, in a single pass.
+    The gain is worked out from the index rather than accumulated so the loops can be vectorised.
+*/
+static float applyGainRampAndMeasure (float* JUCE_RESTRICT data, int numSamples,
+                                      float startGain, float endGain, bool measureRMS) noexcept
+{
+    if (numSamples <= 0)
+        return 0.0f;
+
+    const float increment = (endGain - startGain) / (float) numSamples;
+    float level = 0.0f;
+
+    if (measureRMS)
+    {
+        for (int i = 0; i < numSamples; ++i)
+        {
+            auto sample = data[i] * (startGain + increment * (float) i);
+            data[i] = sample;
+            level += sample * sample;
+        }
+
+        return std::sqrt (level / (float) numSamples);
+    }
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        auto sample = data[i] * (startGain + increment * (float) i);
+        data[i] = sample;
+        level = jmax (level, std::abs (sample));
+    }
+
+    return level;
+}
+
 void VolumeAndPanPlugin::applyToBuffer (const AudioRenderContext& fc)
 {
     if (isEnabled())
@@ -188,21 +222,43 @@ void VolumeAndPanPlugin::applyToBuffer (const AudioRenderContext& fc)
 
         if (fc.destBuffer != nullptr)
         {
-            const int numChansIn = fc.destBuffer->getNumChannels();
+            auto& buffer = *fc.destBuffer;
+            const int numChansIn = buffer.getNumChannels();
             const float vcaPosDelta = vcaTrack != nullptr
-                                    ? decibelsToVolumeFaderPosition (getParentVcaDb (*vcaTrack, fc.getEditTime().editRange1.getStart()))
+                                    ? decibelsToVolumeFaderPosition (getParentVcaDb (*vcaTrack, fc.getEditTime().editRange1.getEnd()))
                                         - decibelsToVolumeFaderPosition (0.0f)
                                     : 0.0f;
 
+            // If the track's meter comes next, its levels are measured whilst the gains are applied
+            auto meter = followingLevelMeter.load();
+            const bool measureLevels = meter != nullptr && meter->isEnabled()
+                                        && (meter->measurer.getMode() == LevelMeasurer::peakMode
+                                             || meter->measurer.getMode() == LevelMeasurer::RMSMode);
+            const bool measureRMS = measureLevels && meter->measurer.getMode() == LevelMeasurer::RMSMode;
+            float levels[LevelMeasurer::Client::maxNumChannels] = {};
+
+            auto applyGainRamp = [&] (int chan, float startGain, float endGain)
+            {
+                if (measureLevels && chan < LevelMeasurer::Client::maxNumChannels)
+                    levels[chan] = applyGainRampAndMeasure (buffer.getWritePointer (chan, fc.bufferStartSample), fc.bufferNumSamples,
+                                                            startGain, endGain, measureRMS);
+                else
+                    buffer.applyGainRamp (chan, fc.bufferStartSample, fc.bufferNumSamples, startGain, endGain);
+            };
+
+            // The gains ramp from where the last block finished to where any automation
+            // reaches by the end of this one, so they follow the curve without lagging a block
+            const float endSliderPos = volParam->getBlockEndValue();
+
             float lgain, rgain;
-            getGainsFromVolumeFaderPositionAndPan (getSliderPos() + vcaPosDelta, getPan(), getPanLaw(), lgain, rgain);
+            getGainsFromVolumeFaderPositionAndPan (endSliderPos + vcaPosDelta, panParam->getBlockEndValue(), getPanLaw(), lgain, rgain);
             lgain *= (polarity ? -1 : 1);
             rgain *= (polarity ? -1 : 1);
 
-            fc.destBuffer->applyGainRamp (0, fc.bufferStartSample, fc.bufferNumSamples, lastGainL, lgain);
+            applyGainRamp (0, lastGainL, lgain);
 
             if (numChansIn > 1)
-                fc.destBuffer->applyGainRamp (1, fc.bufferStartSample, fc.bufferNumSamples, lastGainR, rgain);
+                applyGainRamp (1, lastGainR, rgain);
 
             lastGainL = lgain;
             lastGainR = rgain;
@@ -210,13 +266,19 @@ void VolumeAndPanPlugin::applyToBuffer (const AudioRenderContext& fc)
             // If the number of channels is greater than two, just apply volume
             if (numChansIn > 2)
             {
-                const float gain = volumeFaderPositionToGain (getSliderPos() + vcaPosDelta) * (polarity ? -1 : 1);
+                const float gain = volumeFaderPositionToGain (endSliderPos + vcaPosDelta) * (polarity ? -1 : 1);
 
                 for (int i = 2; i < numChansIn; ++i)
-                    fc.destBuffer->applyGainRamp (i, fc.bufferStartSample, fc.bufferNumSamples, lastGainS, gain);
+                    applyGainRamp (i, lastGainS, gain);
 
                 lastGainS = gain;
             }
+
+            if (measureLevels)
+            {
+                meter->measurer.processLevels (levels, numChansIn);
+                meter->setAudioAlreadyMeasured();
+            }
         }
 
         if (applyToMidi && fc.bufferForMidiMessages != nullptr)
@@ -224,6 +286,11 @@ void VolumeAndPanPlugin::applyToBuffer (const AudioRenderContext& fc)
     }
 }
 
+void VolumeAndPanPlugin::setFollowingLevelMeter (LevelMeterPlugin* meter) noexcept
+{
+    followingLevelMeter = meter;
+}
+
 void VolumeAndPanPlugin::refreshVCATrack()
 {
     vcaTrack = ignoreVca ? nullptr : dynamic_cast<AudioTrack*> (getOwnerTrack());
@@ -43,6 +43,12 @@ public:
 
     void muteOrUnmute();
 
+    /** Lets this measure the levels for a LevelMeterPlugin that comes straight after it whilst it
+        applies its gains, so the meter doesn't need another pass over the audio.
+        The PluginList sets this up when it creates the nodes, which keep both plugins alive.
+    */
+    void setFollowingLevelMeter (LevelMeterPlugin*) noexcept;
+
     //==============================================================================
     static const char* xmlTypeName;
 
@@ -51,6 +57,7 @@ public:
     juce::String getShortName (int) override                { return "VolPan"; }
     juce::String getSelectableDescription() override        { return getName(); }
     bool needsConstantBufferSize() override                 { return false; }
+    bool rampsAutomationAcrossBlocks() override             { return true; }
 
     void initialise (const PlaybackInitialisationInfo&) override;
     void initialiseWithoutStopping (const PlaybackInitialisationInfo&) override;
@@ -72,6 +79,7 @@ private:
     float lastGainL = 0.0f, lastGainR = 0.0f, lastGainS = 0.0f, lastVolumeBeforeMute = 0.0f;
 
     juce::ReferenceCountedObjectPtr<AudioTrack> vcaTrack;
+    std::atomic<LevelMeterPlugin*> followingLevelMeter { nullptr };
 
     void refreshVCATrack();
 
@@ -108,6 +108,8 @@ public:
             hasInitialised = true;
             plugin->baseClassInitialise (info);
             latencySeconds = plugin->getLatencySeconds();
+            bypassWhenSilent = plugin->engine.getEngineBehaviour().shouldBypassPluginsWhenSilent();
+            idleSeconds = 0.0;
 
             if (input != nullptr)
                 input->prepareAudioNodeToPlay (info);
@@ -146,14 +148,14 @@ public:
 
     void renderAdding (const AudioRenderContext& rc) override
     {
-        if (plugin->isEnabled() && (rc.isRendering || (! plugin->isFrozen())))
+        if (plugin->isEnabled() && (rc.isRendering || (! (plugin->isFrozen() || plugin->isBypassedToSaveCpu()))))
         {
             callRenderOver (rc);
         }
         else
         {
             if (rc.didPlayheadJump())
-                plugin->reset();
+                plugin->resetAfterPlayheadJump();
 
             if (input != nullptr)
                 input->renderAdding (rc);
@@ -163,9 +165,9 @@ public:
     void renderOver (const AudioRenderContext& rc) override
     {
         if (rc.didPlayheadJump())
-            plugin->reset();
+            plugin->resetAfterPlayheadJump();
 
-        if (plugin->isEnabled() && (rc.isRendering || (! plugin->isFrozen())))
+        if (plugin->isEnabled() && (rc.isRendering || (! (plugin->isFrozen() || plugin->isBypassedToSaveCpu()))))
         {
             if (latencySeconds > 0)
             {
@@ -173,12 +175,12 @@ public:
                 rc2.streamTime = rc2.streamTime + latencySeconds;
 
                 input->renderOver (rc2);
-                renderPlugin (rc2);
+                renderPluginUnlessIdle (rc2);
             }
             else
             {
                 input->renderOver (rc);
-                renderPlugin (rc);
+                renderPluginUnlessIdle (rc);
             }
         }
         else
@@ -188,6 +190,32 @@ public:
         }
     }
 
+    /** Skips the plugin while it's idle, i.e. its input and output have been silent for longer than its tail. */
+    void renderPluginUnlessIdle (const AudioRenderContext& rc)
+    {
+        if (! bypassWhenSilent)
+            return renderPlugin (rc);
+
+        const bool inputSilent = isSilent (rc) && ! rc.didPlayheadJump();
+
+        if (! inputSilent)
+        {
+            idleSeconds = 0.0;
+        }
+        else if (idleSeconds > minimumIdleSeconds && canBypassAfter (idleSeconds))
+        {
+            plugin->cpuUsageMs = 0.0;
+            return;
+        }
+
+        renderPlugin (rc);
+
+        if (inputSilent && isAudioSilent (rc))
+            idleSeconds += rc.streamTime.getLength();
+        else
+            idleSeconds = 0.0;
+    }
+
     virtual void renderPlugin (const AudioRenderContext& rc)
     {
         SCOPED_REALTIME_CHECK
@@ -212,7 +240,36 @@ protected:
     std::unique_ptr<AudioNode> input;
 
     bool hasAudioInput = false, hasMidiInput = false, applyAntiDenormalisationNoise = false, hasInitialised = false;
-    double latencySeconds = 0.0;
+    bool bypassWhenSilent = false;
+    double latencySeconds = 0.0, idleSeconds = 0.0;
+
+    // Anything quieter than -120dB counts as silence, which is well above the anti-denormalisation noise
+    static constexpr float silenceThreshold = 1.0e-6f;
+    static constexpr double minimumIdleSeconds = 0.1;
+
+    static bool isAudioSilent (const AudioRenderContext& rc)
+    {
+        return rc.destBuffer == nullptr
+                || rc.destBuffer->getMagnitude (rc.bufferStartSample, rc.bufferNumSamples) < silenceThreshold;
+    }
+
+    static bool isSilent (const AudioRenderContext& rc)
+    {
+        if (auto midi = rc.bufferForMidiMessages)
+            if (! midi->isEmpty() || midi->isAllNotesOff)
+                return false;
+
+        return isAudioSilent (rc);
+    }
+
+    bool canBypassAfter (double silentSeconds) const
+    {
+        if (plugin->isAutomationNeeded() || ! plugin->canBeBypassedWhenSilent())
+            return false;
+
+        auto tailLength = plugin->noTail() ? 0.0 : plugin->getTailLength();
+        return std::isfinite (tailLength) && silentSeconds > tailLength;
+    }
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PluginAudioNode)
 };
@@ -228,17 +285,7 @@ public:
 
     static bool needsFineGrainAutomation (Plugin& p)
     {
-        if (! p.isAutomationNeeded())
-            return false;
-
-        if (auto pl = p.getOwnerList())
-            if (pl->needsConstantBufferSize())
-                return false;
-
-        if (p.engine.getPluginManager().canUseFineGrainAutomation)
-            return p.engine.getPluginManager().canUseFineGrainAutomation (p);
-
-        return true;
+        return p.isAutomationNeeded() && p.canUseFineGrainAutomation();
     }
 
     void prepareAudioNodeToPlay (const PlaybackInitialisationInfo& info) override
@@ -279,6 +326,9 @@ public:
         if (rc.bufferForMidiMessages != nullptr)
             midiInputScratch.isAllNotesOff = rc.bufferForMidiMessages->isAllNotesOff;
 
+        // This only ever refers to the destination buffer's channels so doesn't allocate
+        juce::AudioBuffer<float> asb;
+
         while (numSamplesLeft > 0)
         {
             const int numThisTime = jmin (blockSizeToUse, numSamplesLeft);
@@ -303,8 +353,6 @@ public:
                 }
             }
 
-            juce::AudioBuffer<float> asb;
-
             if (rc.destBuffer != nullptr)
             {
                 asb.setDataToReferTo (rc.destBuffer->getArrayOfWritePointers(), rc.destBuffer->getNumChannels(),
@@ -669,6 +717,21 @@ bool Plugin::isClipEffectPlugin() const
     return isClipEffect;
 }
 
+bool Plugin::canUseFineGrainAutomation()
+{
+    if (rampsAutomationAcrossBlocks())
+        return false;
+
+    if (auto pl = getOwnerList())
+        if (pl->needsConstantBufferSize())
+            return false;
+
+    if (engine.getPluginManager().canUseFineGrainAutomation)
+        return engine.getPluginManager().canUseFineGrainAutomation (*this);
+
+    return true;
+}
+
 void Plugin::valueTreePropertyChanged (ValueTree&, const juce::Identifier& i)
 {
     if (i == IDs::process)
@@ -759,6 +822,8 @@ void Plugin::baseClassInitialise (const PlaybackInitialisationInfo& info)
     blockSizeSamples = info.blockSizeSamples;
     cpuUsageMs = 0.0;
 
+    AudioScratchBuffer::prepare (getNumOutputChannelsGivenInputs (2), blockSizeSamples);
+
     {
         const double msPerBlock = (sampleRate > 0.0) ? (1000.0 * (blockSizeSamples / sampleRate)) : 0.0;
         timeToCpuScale = (msPerBlock > 0.0) ? (1.0 / msPerBlock) : 0.0;
@@ -954,6 +1019,7 @@ void Plugin::applyToBufferWithAutomation (const AudioRenderContext& fc)
     jassert (initialiseCount > 0);
 
     updateLastPlaybackTime();
+    applyPendingParameterSnapshot();
 
     if (isAutomationNeeded()
         && (arm.isReadingAutomation() || isClipEffect.load()))
@@ -970,7 +1036,14 @@ void Plugin::applyToBufferWithAutomation (const AudioRenderContext& fc)
         else
         {
             SCOPED_REALTIME_CHECK
-            updateParameterStreams (fc.getEditTime().editRange1.getStart());
+            const auto editTime = fc.getEditTime();
+
+            // Only ramp if the block isn't split by a loop, otherwise it just follows the start
+            if (rampsAutomationAcrossBlocks() && ! editTime.isSplit)
+                updateParameterStreams (editTime.editRange1);
+            else
+                updateParameterStreams (editTime.editRange1.getStart());
+
             applyToBuffer (fc);
         }
     }
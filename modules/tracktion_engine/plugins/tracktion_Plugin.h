@@ -75,12 +75,19 @@ public:
     //==============================================================================
     /** Enable/disable the plugin.  */
     virtual void setEnabled (bool);
-    bool isEnabled() const noexcept                         { return enabled; }
+    bool isEnabled() const noexcept                         { return enabled.get(); }
 
     /** This is a bit different to being enabled as when frozen a plugin can't be interacted with. */
     void setFrozen (bool shouldBeFrozen)                    { frozen = shouldBeFrozen; }
     bool isFrozen() const noexcept                          { return frozen; }
 
+    /** Bypasses the plugin during live playback without changing its state, e.g. when the
+        DeviceManager is taking plugins out to keep the CPU under its limit. Renders still process it.
+        @see EngineBehaviour::shouldBypassHeaviestPluginsWhenOverloaded
+    */
+    void setBypassedToSaveCpu (bool shouldBeBypassed)       { bypassedToSaveCpu = shouldBeBypassed; }
+    bool isBypassedToSaveCpu() const noexcept               { return bypassedToSaveCpu; }
+
     /** Enable/Disable processing. If processing is disabled, plugin should minimize memory usage
         and release any resources possilbe */
     void setProcessingEnabled (bool p)                      { processing = p; }
@@ -112,6 +119,12 @@ public:
     /** Should reset synth voices, tails, clear delay buffers, etc. */
     virtual void reset();
 
+    /** Called on the audio thread when the playhead jumps, to clear out anything left playing.
+        By default this calls reset() straight away, but a plugin whose reset could be slow
+        can override this to do it somewhere else, so a relocate doesn't stutter.
+    */
+    virtual void resetAfterPlayheadJump()           { reset(); }
+
     //==============================================================================
     /** Process the next block of data.
 
@@ -135,6 +148,7 @@ public:
     /** Creates a new audio node that will render this plugin. */
     AudioNode* createAudioNode (AudioNode* input, bool applyAntiDenormalisationNoise);
 
+    /** Returns the proportion of each block's time that this plugin took to process, smoothed over a few blocks. */
     double getCpuUsage() const noexcept     { return juce::jlimit (0.0, 1.0, timeToCpuScale * cpuUsageMs.load()); }
 
     //==============================================================================
@@ -157,6 +171,14 @@ public:
     virtual double getLatencySeconds()                  { return 0.0; }
     virtual double getTailLength() const                { return 0.0; }
     virtual bool mustBePlayedLiveWhenOnAClip() const    { return false; }
+
+    /** Returns true if playback may stop calling applyToBuffer once the plugin's input and output
+        have been silent for longer than its tail, which only happens if
+        EngineBehaviour::shouldBypassPluginsWhenSilent() is enabled.
+        Plugins that must see every block, such as meters and sends, should return false.
+    */
+    virtual bool canBeBypassedWhenSilent()              { return (! producesAudioWhenNoAudioInput() || isSynth() || ! noTail())
+                                                                    && (isSynth() || ! takesMidiInput()); }
     virtual bool canSidechain();
 
     juce::StringArray getInputChannelNames();
@@ -202,6 +224,17 @@ public:
     virtual bool canBeMoved()                                           { return true; }
     virtual bool needsConstantBufferSize() = 0;
 
+    /** Returns true if this plugin's automation can be applied by splitting blocks in to
+        smaller sub-blocks. This doesn't check whether any automation is actually active.
+    */
+    bool canUseFineGrainAutomation();
+
+    /** Plugins that ramp their parameters across each block using
+        AutomatableParameter::getBlockEndValue() can return true here, so they get their
+        automation for the whole block at once instead of being split into sub-blocks.
+    */
+    virtual bool rampsAutomationAcrossBlocks()                          { return false; }
+
     /** for things like VSTs where the DLL is missing.    */
     virtual bool isMissing()                                            { return false; }
 
@@ -255,6 +288,11 @@ public:
     /** Called when ProjectItem sources are re-assigned so you can reload from the new source. */
     virtual void sourceMediaChanged()  {}
 
+    /** Should return roughly how many bytes this plugin is holding on to, e.g. for samples or
+        its saved state. This is polled by MemoryUsage so should be quick to call.
+    */
+    virtual juce::int64 getMemoryUsage()    { return 0; }
+
     //==============================================================================
     static bool areSelectedPluginsRackable (SelectionManager&);
     static RackInstance* wrapSelectedPluginsInRack (SelectionManager&);
@@ -308,7 +346,8 @@ public:
 
 protected:
     //==============================================================================
-    juce::CachedValue<bool> enabled, frozen, processing;
+    juce::CachedValue<AtomicWrapper<bool>> enabled;
+    juce::CachedValue<bool> frozen, processing;
     juce::CachedValue<juce::String> quickParamName;
     juce::CachedValue<EditItemID> masterPluginID, sidechainSourceID;
 
@@ -317,6 +356,7 @@ protected:
 
     void valueTreePropertyChanged (juce::ValueTree&, const juce::Identifier&) override;
     void valueTreeChanged() override;
+    void parameterSnapshotApplied() override            { changed(); }
 
     void valueTreeChildAdded (juce::ValueTree&, juce::ValueTree&) override;
     void valueTreeChildRemoved (juce::ValueTree&, juce::ValueTree&, int) override;
@@ -344,6 +384,7 @@ private:
     double timeToCpuScale = 0;
     std::atomic<double> cpuUsageMs { 0 };
     std::atomic<bool> isClipEffect { false };
+    std::atomic<bool> bypassedToSaveCpu { false };
 
     juce::ValueTree getConnectionsTree();
     struct WireList;
@@ -315,9 +315,29 @@ AudioNode* PluginList::createAudioNode (AudioNode* n, bool addNoise)
     int i = 0;
 
     if (list != nullptr)
+    {
+        Plugin* previous = nullptr;
+
         for (auto f : list->objects)
-            if (! f->mustBePlayedLiveWhenOnAClip())
-                n = f->createAudioNode (n, (i++ == 0) && addNoise);
+        {
+            if (f->mustBePlayedLiveWhenOnAClip())
+                continue;
+
+            n = f->createAudioNode (n, (i++ == 0) && addNoise);
+
+            if (f->isDisabled())
+                continue;
+
+            // A volume plugin can measure the levels for a meter straight after it
+            if (auto volume = dynamic_cast<VolumeAndPanPlugin*> (f))
+                volume->setFollowingLevelMeter (nullptr);
+
+            if (auto volume = dynamic_cast<VolumeAndPanPlugin*> (previous))
+                volume->setFollowingLevelMeter (dynamic_cast<LevelMeterPlugin*> (f));
+
+            previous = f;
+        }
+    }
 
     return n;
 }
@@ -60,7 +60,8 @@ struct PluginScanMasterProcess  : private ChildProcessMaster
     }
 
     bool waitForReply (int requestID, const String& fileOrIdentifier,
-                       OwnedArray<PluginDescription>& result, KnownPluginList::CustomScanner& scanner)
+                       OwnedArray<PluginDescription>& result, KnownPluginList::CustomScanner& scanner,
+                       int timeoutSeconds)
     {
       #if ! TRACKTION_LOG_ENABLED
         juce::ignoreUnused (fileOrIdentifier);
@@ -88,6 +89,15 @@ struct PluginScanMasterProcess  : private ChildProcessMaster
                     return false;
                 }
 
+                if (timeoutSeconds > 0 && elapsed.inSeconds() > timeoutSeconds)
+                {
+                    // Treat a hang like a crash so this process gets killed rather than reused
+                    TRACKTION_LOG_ERROR ("Plugin scan timed out:  " + fileOrIdentifier);
+                    timedOut = true;
+                    crashed = true;
+                    return false;
+                }
+
                 Thread::sleep (10);
                 continue;
             }
@@ -131,7 +141,7 @@ struct PluginScanMasterProcess  : private ChildProcessMaster
         crashed = true;
     }
 
-    volatile bool launched = false, crashed = false;
+    volatile bool launched = false, crashed = false, timedOut = false;
 
 private:
     Engine& engine;
@@ -310,50 +320,46 @@ struct CustomScanner  : public KnownPluginList::CustomScanner
         if (engine.getPluginManager().usesSeparateProcessForScanning()
              && shouldUseSeparateProcessToScan (format))
         {
-            if (masterProcess != nullptr && masterProcess->crashed)
-                masterProcess = nullptr;
-
-            if (masterProcess == nullptr)
-                masterProcess = std::make_unique<PluginScanMasterProcess> (engine);
+            // Each scanning thread gets a child process of its own, so they can work in parallel
+            auto masterProcess = acquireProcess();
 
             if (masterProcess->ensureSlaveIsLaunched())
             {
                 auto requestID = Random().nextInt();
+                bool ok = scanInProcess (*masterProcess, format, fileOrIdentifier, requestID, result);
 
-                if (! shouldExit()
-                     && masterProcess->sendScanRequest (format, fileOrIdentifier, requestID)
-                     && ! shouldExit())
+                // if there's a crash, give it a second chance with a fresh child process,
+                // in case the real culprit was whatever plugin preceded this one.
+                if (! ok && masterProcess->crashed && ! masterProcess->timedOut && ! shouldExit())
                 {
-                    if (masterProcess->waitForReply (requestID, fileOrIdentifier, result, *this))
-                        return true;
-
-                    // if there's a crash, give it a second chance with a fresh child process,
-                    // in case the real culprit was whatever plugin preceded this one.
-                    if (masterProcess->crashed && ! shouldExit())
-                    {
-                        masterProcess = nullptr;
-                        masterProcess = std::make_unique<PluginScanMasterProcess> (engine);
-
-                        return masterProcess->ensureSlaveIsLaunched()
-                                 && ! shouldExit()
-                                 && masterProcess->sendScanRequest (format, fileOrIdentifier, requestID)
-                                 && ! shouldExit()
-                                 && masterProcess->waitForReply (requestID, fileOrIdentifier, result, *this);
-                    }
+                    masterProcess = std::make_unique<PluginScanMasterProcess> (engine);
+
+                    ok = masterProcess->ensureSlaveIsLaunched()
+                           && scanInProcess (*masterProcess, format, fileOrIdentifier, requestID, result);
                 }
 
-                return false;
+                releaseProcess (std::move (masterProcess));
+                return ok;
             }
 
             // panic! Can't run the slave for some reason, so just do it here..
             TRACKTION_LOG_ERROR ("Falling back to scanning in main process..");
-            masterProcess.reset();
         }
 
         format.findAllTypesForFile (result, fileOrIdentifier);
         return true;
     }
 
+    bool scanInProcess (PluginScanMasterProcess& masterProcess, AudioPluginFormat& format, const String& fileOrIdentifier,
+                        int requestID, OwnedArray<PluginDescription>& result)
+    {
+        return ! shouldExit()
+                && masterProcess.sendScanRequest (format, fileOrIdentifier, requestID)
+                && ! shouldExit()
+                && masterProcess.waitForReply (requestID, fileOrIdentifier, result, *this,
+                                               engine.getEngineBehaviour().getPluginScanTimeoutSeconds());
+    }
+
     static bool shouldUseSeparateProcessToScan (AudioPluginFormat& format)
     {
         auto name = format.getName();
@@ -366,14 +372,47 @@ struct CustomScanner  : public KnownPluginList::CustomScanner
     void scanFinished() override
     {
         TRACKTION_LOG ("----- Ended Plugin Scan");
-        masterProcess.reset();
+
+        {
+            const ScopedLock sl (processLock);
+            idleProcesses.clear();
+        }
 
         if (auto callback = engine.getPluginManager().scanCompletedCallback)
             callback();
     }
 
     Engine& engine;
-    std::unique_ptr<PluginScanMasterProcess> masterProcess;
+
+private:
+    CriticalSection processLock;
+    std::vector<std::unique_ptr<PluginScanMasterProcess>> idleProcesses;
+
+    std::unique_ptr<PluginScanMasterProcess> acquireProcess()
+    {
+        const ScopedLock sl (processLock);
+
+        while (! idleProcesses.empty())
+        {
+            auto p = std::move (idleProcesses.back());
+            idleProcesses.pop_back();
+
+            if (! p->crashed)
+                return p;
+        }
+
+        return std::make_unique<PluginScanMasterProcess> (engine);
+    }
+
+    void releaseProcess (std::unique_ptr<PluginScanMasterProcess> p)
+    {
+        // A process that crashed or hung is deleted, which kills it
+        if (p->crashed)
+            return;
+
+        const ScopedLock sl (processLock);
+        idleProcesses.push_back (std::move (p));
+    }
 };
 
 //==============================================================================
@@ -396,6 +435,11 @@ PluginManager::PluginManager (Engine& e)
 {
     createPluginInstance = [this] (const PluginDescription& description, double rate, int blockSize, String& errorMessage)
                            {
+                               auto group = engine.getEngineBehaviour().getSandboxProcessGroup (description);
+
+                               if (group.isNotEmpty())
+                                   return createSandboxedPluginInstance (pluginFormatManager, group, description, rate, blockSize, errorMessage);
+
                                return std::unique_ptr<AudioPluginInstance> (pluginFormatManager.createPluginInstance (description, rate, blockSize, errorMessage));
                            };
 }
@@ -744,7 +788,8 @@ void PluginManager::setDoubleClickToOpenWindows (bool b)
 int PluginManager::getNumberOfThreadsForScanning()
 {
     return jlimit (1, SystemStats::getNumCpus(),
-                   static_cast<int> (engine.getPropertyStorage().getProperty (SettingID::numThreadsForPluginScanning, 1)));
+                   static_cast<int> (engine.getPropertyStorage().getProperty (SettingID::numThreadsForPluginScanning,
+                                                                              jlimit (1, 8, SystemStats::getNumCpus() / 2))));
 }
 
 void PluginManager::setNumberOfThreadsForScanning (int numThreads)
@@ -797,6 +842,7 @@ PluginCache::PluginCache (Edit& ed) : edit (ed)
 
 PluginCache::~PluginCache()
 {
+    pluginsByID.clear();
     activePlugins.clear();
 }
 
@@ -806,10 +852,10 @@ Plugin::Ptr PluginCache::getPluginFor (EditItemID pluginID) const
         return {};
 
     const ScopedLock sl (lock);
+    auto found = pluginsByID.find (pluginID);
 
-    for (auto p : activePlugins)
-        if (EditItemID::fromProperty (p->state, IDs::id) == pluginID)
-            return *p;
+    if (found != pluginsByID.end())
+        return *found->second;
 
     return {};
 }
@@ -817,14 +863,10 @@ Plugin::Ptr PluginCache::getPluginFor (EditItemID pluginID) const
 Plugin::Ptr PluginCache::getPluginFor (const juce::ValueTree& v) const
 {
     const ScopedLock sl (lock);
+    auto found = pluginsByID.find (EditItemID::fromID (v));
 
-    for (auto p : activePlugins)
-    {
-        if (p->state == v)
-            return *p;
-
-        //jassert (v[IDs::id].toString() != p->itemID.toString());
-    }
+    if (found != pluginsByID.end() && found->second->state == v)
+        return *found->second;
 
     return {};
 }
@@ -903,7 +945,9 @@ Plugin::Ptr PluginCache::addPluginToCache (Plugin::Ptr p)
     }
 
     jassert (! activePlugins.contains (p));
+    jassert (EditItemID::fromID (p->state) == p->itemID);
     activePlugins.add (p);
+    pluginsByID[p->itemID] = p.get();
 
     return p;
 }
@@ -920,6 +964,11 @@ void PluginCache::timerCallback()
         {
             if (f->getReferenceCount() == 1)
             {
+                auto found = pluginsByID.find (f->itemID);
+
+                if (found != pluginsByID.end() && found->second == f)
+                    pluginsByID.erase (found);
+
                 toDelete.add (f);
                 activePlugins.remove (i);
             }
@@ -26,6 +26,12 @@ public:
     //==============================================================================
     static bool startChildProcessPluginScan (const juce::String& commandLine);
 
+    /** Call this from your JUCEApplication::initialise() in the same way as startChildProcessPluginScan()
+        if EngineBehaviour::getSandboxProcessGroup() returns anything, so the child processes that
+        host sandboxed plugins can start up.
+    */
+    static bool startChildProcessPluginHost (const juce::String& commandLine);
+
     bool areGUIsLockedByDefault();
     void setGUIsLockedByDefault (bool);
 
@@ -125,6 +131,7 @@ public:
 private:
     Edit& edit;
     Plugin::Array activePlugins;
+    std::unordered_map<EditItemID, Plugin*> pluginsByID;
     juce::CriticalSection lock;
 
     Plugin::Ptr addPluginToCache (Plugin::Ptr);
@@ -14,6 +14,21 @@ namespace tracktion_engine
 // a combined version number and file identifier for the project file
 static const char* magicNumberV1 = "TP01";
 
+// marks the table of item file names that's appended to the end of the project file
+static const char* fileKeyMarker = "TPFK";
+
+// The file names are looked up without their extensions, as an item may be using
+// a compressed substitute for a missing file (see ProjectItem::getSourceFile())
+static String getFileKey (const String& path)
+{
+    auto name = path.replaceCharacter ('\\', '/').fromLastOccurrenceOf ("/", false, false);
+
+    if (name.containsChar ('.'))
+        name = name.upToLastOccurrenceOf (".", false, false);
+
+    return name.toLowerCase();
+}
+
 //==============================================================================
 Project::Project (Engine& e, ProjectManager& pm, const File& projectFile)
    : engine (e), projectManager (pm), file (projectFile)
@@ -34,6 +49,7 @@ Project::Project (Engine& e, ProjectManager& pm, const File& projectFile)
 
 Project::~Project()
 {
+    libraryIndexer.reset();
     projectManager.openProjects.removeFirstMatchingValue (this);
     save();
     notifyListenersOfDeletion();
@@ -63,10 +79,14 @@ void Project::load()
         in->setPosition (objectOffset);
         int num = in->readInt();
 
-        jassert (num >= 0 && num < 20000); // vague sanity check
+        // each entry takes 8 bytes, so a count that wouldn't fit in the file must be garbage
+        auto isSane = num >= 0 && objectOffset + 4 + num * (int64) 8 <= in->getTotalLength();
+        jassert (isSane);
 
-        if (num < 20000)
+        if (isSane)
         {
+            objects.ensureStorageAllocated (num);
+
             while (--num >= 0)
             {
                 ObjectInfo o;
@@ -103,7 +123,12 @@ bool Project::readProjectHeader (InputStream& in, bool clearObjectInfo)
     CRASH_TRACER
 
     if (clearObjectInfo)
+    {
         objects.clear();
+        itemIndexesNeedRebuilding = true;
+        fileKeysNeedLoading = true;
+        itemIDsForFileKeys.clear();
+    }
 
     char n[4] = { 0 };
     in.read (n, 4);
@@ -279,6 +304,19 @@ void Project::saveTo (FileOutputStream& out)
 
     searchIndex.writeToStream (out);
 
+    // The file names go at the end, where older versions won't notice them
+    auto fileKeyOffset = (int) out.getPosition();
+    out.writeInt (objects.size());
+
+    for (auto& o : objects)
+    {
+        out.writeInt (o.itemID);
+        out.writeString (o.item != nullptr ? o.item->getRawFileName() : String());
+    }
+
+    out.writeInt (fileKeyOffset);
+    out.write (fileKeyMarker, 4);
+
     out.setPosition (8);
     out.writeInt (objectOffset);
     out.writeInt (indexOffset);
@@ -473,8 +511,24 @@ ProjectItem::Ptr Project::getProjectItemForFile (const File& fileToFind)
 {
     const ScopedLock sl (objectLock);
 
-    for (auto& o : objects)
+    if (fileKeysNeedLoading)
+        loadFileKeys();
+
+    auto found = itemIDsForFileKeys.find (getFileKey (fileToFind.getFullPathName()));
+
+    if (found == itemIDsForFileKeys.end())
+        return {};
+
+    // Only the items with a matching name need loading and checking
+    for (auto itemID : found->second)
     {
+        auto index = getIndexOfItemID (itemID);
+
+        if (index < 0)
+            continue;
+
+        auto& o = objects.getReference (index);
+
         if (o.item == nullptr)
             if (! loadProjectItem (o))
                 continue;
@@ -487,19 +541,94 @@ ProjectItem::Ptr Project::getProjectItemForFile (const File& fileToFind)
 }
 
 int Project::getIndexOf (ProjectItemID mo) const
+{
+    if (mo.getProjectID() == getProjectID())
+        return getIndexOfItemID (mo.getItemID());
+
+    return -1;
+}
+
+int Project::getIndexOfItemID (int itemID) const
 {
     const ScopedLock sl (objectLock);
 
-    if (mo.getProjectID() == getProjectID())
+    if (itemIndexesNeedRebuilding)
     {
-        auto itemID = mo.getItemID();
+        itemIndexes.clear();
+        itemIndexes.reserve ((size_t) objects.size());
 
-        for (int i = objects.size(); --i >= 0;)
-            if (objects.getReference(i).itemID == itemID)
-                return i;
+        // If an ID appears twice, the last one wins, as it always has
+        for (int i = 0; i < objects.size(); ++i)
+            itemIndexes[objects.getReference (i).itemID] = i;
+
+        itemIndexesNeedRebuilding = false;
     }
 
-    return -1;
+    auto found = itemIndexes.find (itemID);
+    return found != itemIndexes.end() ? found->second : -1;
+}
+
+void Project::loadFileKeys()
+{
+    CRASH_TRACER
+    const ScopedLock sl (objectLock);
+
+    fileKeysNeedLoading = false;
+    itemIDsForFileKeys.clear();
+    bool hasReadTable = false;
+
+    if (auto in = getInputStream())
+    {
+        auto size = in->getTotalLength();
+
+        if (indexOffset > 0 && size > indexOffset + 8)
+        {
+            in->setPosition (size - 8);
+            auto tableOffset = in->readInt();
+
+            char marker[4] = { 0 };
+            in->read (marker, 4);
+
+            if (strncmp (marker, fileKeyMarker, 4) == 0 && tableOffset >= indexOffset && tableOffset < size - 8)
+            {
+                in->setPosition (tableOffset);
+
+                for (int num = in->readInt(); --num >= 0 && ! in->isExhausted();)
+                {
+                    auto itemID = in->readInt();
+                    addFileKey (in->readString(), itemID);
+                }
+
+                hasReadTable = true;
+            }
+        }
+    }
+
+    // Items that have been added or changed since the last save aren't in the table,
+    // and projects saved by older versions don't have one
+    for (auto& o : objects)
+    {
+        if (o.item == nullptr && ! hasReadTable)
+            loadProjectItem (o);
+
+        if (o.item != nullptr)
+            addFileKey (o.item->getRawFileName(), o.itemID);
+    }
+}
+
+void Project::addFileKey (const String& rawFileName, int itemID)
+{
+    if (rawFileName.isNotEmpty())
+        itemIDsForFileKeys[getFileKey (rawFileName)].addIfNotAlreadyThere (itemID);
+}
+
+void Project::itemFileChanged (const ProjectItem& item)
+{
+    const ScopedLock sl (objectLock);
+
+    // Any entry for the old name is left, as the items found are always checked
+    if (! fileKeysNeedLoading)
+        addFileKey (item.getRawFileName(), item.getID().getItemID());
 }
 
 void Project::moveProjectItem (int indexToMoveFrom, int indexToMoveTo)
@@ -511,6 +640,7 @@ void Project::moveProjectItem (int indexToMoveFrom, int indexToMoveTo)
         if (indexToMoveFrom >= 0 && indexToMoveFrom < objects.size())
         {
             objects.move (indexToMoveFrom, jlimit (0, objects.size(), indexToMoveTo));
+            itemIndexesNeedRebuilding = true;
             changed();
         }
     }
@@ -541,9 +671,15 @@ ProjectItem::Ptr Project::createNewItem (const File& fileToReference,
             const ScopedLock sl (objectLock);
 
             if (atTopOfList)
+            {
                 objects.insert (0, o);
+                itemIndexesNeedRebuilding = true;
+            }
             else
+            {
                 objects.add (o);
+                itemIndexes[o.itemID] = objects.size() - 1;
+            }
         }
 
         o.item->setSourceFile (fileToReference);
@@ -572,6 +708,8 @@ ProjectItem::Ptr Project::quickAddProjectItem (const String& relPathName,
     {
         const ScopedLock sl (objectLock);
         objects.add (o);
+        itemIndexes[o.itemID] = objects.size() - 1;
+        itemFileChanged (*o.item);
     }
 
     changed();
@@ -602,6 +740,7 @@ bool Project::removeProjectItem (ProjectItemID item, bool deleteSourceMaterial)
                 }
 
                 objects.remove (index);
+                itemIndexesNeedRebuilding = true;
             }
         }
 
@@ -680,9 +819,12 @@ void Project::searchFor (Array<ProjectItemID>& results, SearchOperation& searchO
     {
         ProjectSearchIndex psi (*this);
 
-        {
-            const ScopedLock sl (objectLock);
+        // The index can be searched straight from the file, but older ones have to be read in.
+        // The lock stops the file being replaced by a save whilst it's mapped
+        const ScopedLock sl (objectLock);
 
+        if (! psi.mapFromFile (file, indexOffset))
+        {
             if (auto in = getInputStream())
             {
                 in->setPosition (indexOffset);
@@ -694,6 +836,16 @@ void Project::searchFor (Array<ProjectItemID>& results, SearchOperation& searchO
     }
 }
 
+ProjectLibraryIndexer& Project::getLibraryIndexer()
+{
+    TRACKTION_ASSERT_MESSAGE_THREAD
+
+    if (libraryIndexer == nullptr)
+        libraryIndexer = std::make_unique<ProjectLibraryIndexer> (*this);
+
+    return *libraryIndexer;
+}
+
 void Project::mergeArchiveContents (const File& archiveFile)
 {
     TracktionArchiveFile archive (engine, archiveFile);
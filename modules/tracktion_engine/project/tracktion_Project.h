@@ -130,6 +130,9 @@ public:
     /** this will load the keyword table, and do a search */
     void searchFor (juce::Array<ProjectItemID>& results, SearchOperation&);
 
+    /** Returns the service that keeps the details of the project's audio files indexed. */
+    ProjectLibraryIndexer& getLibraryIndexer();
+
     //==============================================================================
     juce::String getSelectableDescription() override;
 
@@ -154,6 +157,7 @@ private:
 
     std::unique_ptr<juce::BufferedInputStream> stream;
     std::unique_ptr<juce::FileInputStream> fileLockingStream;
+    std::unique_ptr<ProjectLibraryIndexer> libraryIndexer;
 
     struct ObjectInfo
     {
@@ -163,6 +167,12 @@ private:
 
     juce::Array<ObjectInfo> objects;
     int objectOffset = 0, indexOffset = 0;
+
+    // These are built when they're first needed, so opening a project only reads the item offsets
+    mutable std::unordered_map<int, int> itemIndexes;
+    mutable bool itemIndexesNeedRebuilding = true;
+    std::unordered_map<juce::String, juce::Array<int>> itemIDsForFileKeys;
+    bool fileKeysNeedLoading = true;
     bool readOnly = false, hasChanged = false, temporary = false;
 
     Project (Engine&, ProjectManager&, const juce::File&);
@@ -175,6 +185,10 @@ private:
     void loadAllProjectItems();
     bool loadProjectItem (ObjectInfo&);
     void ensureFolderCreated (ProjectItem::Category);
+    int getIndexOfItemID (int itemID) const;
+    void loadFileKeys();
+    void addFileKey (const juce::String& rawFileName, int itemID);
+    void itemFileChanged (const ProjectItem&);
     void changed() override;
 
     /** adds an item without checking */
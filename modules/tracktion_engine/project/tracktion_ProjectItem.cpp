@@ -278,8 +278,20 @@ String ProjectItem::getSelectableDescription()
 
 void ProjectItem::selectionStatusChanged (bool isNowSelected)
 {
-    if (isNowSelected && getLength() == 0)
-        verifyLength();
+    if (! isNowSelected || getLength() != 0)
+        return;
+
+    // Reading a wave file here could hold up the UI, so the indexer fills its length in later
+    if (isWave())
+    {
+        if (auto p = getProject())
+        {
+            p->getLibraryIndexer().requestInfo ({ getID() });
+            return;
+        }
+    }
+
+    verifyLength();
 }
 
 //==============================================================================
@@ -357,6 +369,7 @@ void ProjectItem::setSourceFile (const File& f)
 
         sourceFile = File();
 
+        pp->itemFileChanged (*this);
         changed();
         pp->changed();
 
@@ -0,0 +1,518 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+namespace IndexerHelpers
+{
+    // How many items are looked over in each timer callback, so a big library doesn't stall the UI
+    static constexpr int itemsPerBatch = 500;
+
+    static const char* modTimeProperty  = "indexedModTime";
+    static const char* sizeProperty     = "indexedSize";
+    static const char* lengthProperty   = "indexedLength";
+    static const char* rateProperty     = "indexedRate";
+    static const char* channelsProperty = "indexedChannels";
+    static const char* bpmProperty      = "indexedBpm";
+    static const char* rootProperty     = "indexedRoot";
+    static const char* loopProperty     = "indexedLoop";
+    static const char* peakProperty     = "indexedPeak";
+
+    static const ProjectItem::Category watchedCategories[] =
+    {
+        ProjectItem::Category::recorded,
+        ProjectItem::Category::imported,
+        ProjectItem::Category::rendered,
+        ProjectItem::Category::exports,
+        ProjectItem::Category::frozen
+    };
+
+    static void setIfDifferent (ProjectItem& item, const char* name, const String& value)
+    {
+        // Each change marks the project as changed, so the unchanged ones are left alone
+        if (item.getNamedProperty (name) != value)
+            item.setNamedProperty (name, value);
+    }
+}
+
+//==============================================================================
+ProjectLibraryIndexer::ProjectLibraryIndexer (Project& p)
+    : juce::Thread ("Library Indexer"), project (p)
+{
+    shouldAddNewFiles = project.isLibraryProject();
+}
+
+ProjectLibraryIndexer::~ProjectLibraryIndexer()
+{
+    stopTimer();
+    cancelPendingUpdate();
+    signalThreadShouldExit();
+    notify();
+    stopThread (10000);
+}
+
+void ProjectLibraryIndexer::setEnabled (bool shouldBeEnabled)
+{
+    TRACKTION_ASSERT_MESSAGE_THREAD
+
+    if (shouldBeEnabled == isEnabled())
+        return;
+
+    if (shouldBeEnabled)
+    {
+        startThread (2);
+        scanNow();
+        startTimer (100);
+    }
+    else
+    {
+        stopTimer();
+
+        {
+            const ScopedLock sl (lock);
+            jobs.clear();
+            requestedJobs.clear();
+            foldersToScan.clear();
+        }
+
+        signalThreadShouldExit();
+        notify();
+        stopThread (10000);
+        handleUpdateNowIfNeeded();
+    }
+}
+
+void ProjectLibraryIndexer::setAddsNewFiles (bool shouldAdd)
+{
+    shouldAddNewFiles = shouldAdd;
+}
+
+void ProjectLibraryIndexer::setScanIntervalSeconds (double seconds)
+{
+    scanIntervalMs = jmax (100, roundToInt (seconds * 1000.0));
+}
+
+void ProjectLibraryIndexer::scanNow()
+{
+    TRACKTION_ASSERT_MESSAGE_THREAD
+    nextItemIndex = 0;
+    nextScanTime = 0;
+}
+
+bool ProjectLibraryIndexer::isBusy() const
+{
+    const ScopedLock sl (lock);
+    return isAnalysing || ! jobs.empty() || ! requestedJobs.empty() || ! foldersToScan.empty();
+}
+
+void ProjectLibraryIndexer::requestInfo (const juce::Array<ProjectItemID>& itemIDs)
+{
+    TRACKTION_ASSERT_MESSAGE_THREAD
+    using namespace IndexerHelpers;
+
+    std::vector<Job> requested;
+
+    for (auto& itemID : itemIDs)
+    {
+        auto item = project.getProjectItemForID (itemID);
+
+        if (item == nullptr || ! item->isWave())
+            continue;
+
+        Job job;
+        job.itemID = itemID;
+        job.file = item->getSourceFile();
+        job.indexedModTime = item->getNamedProperty (modTimeProperty).getLargeIntValue();
+        job.indexedSize = item->getNamedProperty (sizeProperty).getLargeIntValue();
+        job.headerOnly = true;
+
+        if (job.file != File())
+            requested.push_back (job);
+    }
+
+    if (requested.empty())
+        return;
+
+    {
+        const ScopedLock sl (lock);
+
+        // A list that's being scrolled asks for the same rows repeatedly, so they're only queued once
+        for (auto& job : requested)
+            if (std::none_of (requestedJobs.begin(), requestedJobs.end(),
+                              [&job] (const Job& j) { return j.itemID == job.itemID; }))
+                requestedJobs.push_back (job);
+    }
+
+    startThread (2);
+    notify();
+}
+
+//==============================================================================
+ProjectLibraryIndexer::ItemInfo ProjectLibraryIndexer::getInfo (const ProjectItem& item)
+{
+    using namespace IndexerHelpers;
+
+    ItemInfo info;
+    auto length = item.getNamedProperty (lengthProperty);
+
+    if (length.isEmpty())
+        return info;
+
+    info.isIndexed      = true;
+    info.lengthSeconds  = length.getDoubleValue();
+    info.sampleRate     = item.getNamedProperty (rateProperty).getDoubleValue();
+    info.numChannels    = item.getNamedProperty (channelsProperty).getIntValue();
+    info.bpm            = item.getNamedProperty (bpmProperty).getDoubleValue();
+    info.isLoop         = item.getNamedProperty (loopProperty).getIntValue() != 0;
+    info.peakLevel      = item.getNamedProperty (peakProperty).getFloatValue();
+
+    auto root = item.getNamedProperty (rootProperty);
+    info.rootNote = root.isEmpty() ? -1 : root.getIntValue();
+
+    return info;
+}
+
+juce::Array<ProjectItemID> ProjectLibraryIndexer::findItems (const Filter& filter)
+{
+    TRACKTION_ASSERT_MESSAGE_THREAD
+    juce::Array<ProjectItemID> found;
+
+    for (int i = 0; i < project.getNumProjectItems(); ++i)
+    {
+        auto item = project.getProjectItemAt (i);
+
+        if (item == nullptr || ! item->isWave())
+            continue;
+
+        auto info = getInfo (*item);
+
+        if (! info.isIndexed
+             || info.lengthSeconds < filter.lengthSeconds.getStart()
+             || info.lengthSeconds > filter.lengthSeconds.getEnd()
+             || (filter.loopsOnly && ! info.isLoop))
+            continue;
+
+        if (! filter.bpm.isEmpty() && (info.bpm < filter.bpm.getStart() || info.bpm > filter.bpm.getEnd()))
+            continue;
+
+        if (filter.rootNote >= 0 && (info.rootNote < 0 || info.rootNote % 12 != filter.rootNote % 12))
+            continue;
+
+        found.add (item->getID());
+    }
+
+    return found;
+}
+
+//==============================================================================
+void ProjectLibraryIndexer::timerCallback()
+{
+    if (Time::getMillisecondCounter() < nextScanTime || isBusy())
+        return;
+
+    queueNextBatch();
+}
+
+void ProjectLibraryIndexer::queueNextBatch()
+{
+    CRASH_TRACER
+    using namespace IndexerHelpers;
+
+    std::vector<Job> batch;
+    auto numItems = project.getNumProjectItems();
+    auto endIndex = jmin (numItems, nextItemIndex + itemsPerBatch);
+
+    for (; nextItemIndex < endIndex; ++nextItemIndex)
+    {
+        auto item = project.getProjectItemAt (nextItemIndex);
+
+        if (item == nullptr || ! item->isWave())
+            continue;
+
+        Job job;
+        job.itemID = item->getID();
+        job.file = item->getSourceFile();
+        job.indexedModTime = item->getNamedProperty (modTimeProperty).getLargeIntValue();
+        job.indexedSize = item->getNamedProperty (sizeProperty).getLargeIntValue();
+
+        if (job.file != File())
+            batch.push_back (job);
+    }
+
+    std::vector<Folder> folders;
+    std::vector<File> files;
+
+    if (nextItemIndex >= numItems)
+    {
+        // That's everything, so the folders get checked for new files before starting again
+        nextItemIndex = 0;
+        nextScanTime = Time::getMillisecondCounter() + (juce::uint32) scanIntervalMs;
+
+        if (shouldAddNewFiles && ! project.isReadOnly())
+        {
+            for (auto category : watchedCategories)
+            {
+                auto dir = project.getDirectoryForMedia (category);
+
+                if (dir.isDirectory())
+                    folders.push_back ({ dir, category });
+            }
+
+            for (int i = 0; i < numItems; ++i)
+                if (auto item = project.getProjectItemAt (i))
+                    if (item->isWave())
+                        files.push_back (item->getSourceFile());
+
+            std::sort (files.begin(), files.end());
+        }
+    }
+
+    if (batch.empty() && folders.empty())
+        return;
+
+    {
+        const ScopedLock sl (lock);
+        jobs.insert (jobs.end(), batch.begin(), batch.end());
+        foldersToScan = std::move (folders);
+        knownFiles = std::move (files);
+    }
+
+    notify();
+}
+
+//==============================================================================
+void ProjectLibraryIndexer::run()
+{
+    while (! threadShouldExit())
+    {
+        Job job;
+        std::vector<Folder> folders;
+        std::vector<File> known;
+        bool hasJob = false;
+
+        {
+            const ScopedLock sl (lock);
+
+            if (! requestedJobs.empty())
+            {
+                job = requestedJobs.front();
+                requestedJobs.erase (requestedJobs.begin());
+                hasJob = true;
+            }
+            else if (! jobs.empty())
+            {
+                job = jobs.front();
+                jobs.erase (jobs.begin());
+                hasJob = true;
+            }
+            else
+            {
+                std::swap (folders, foldersToScan);
+                std::swap (known, knownFiles);
+            }
+
+            isAnalysing = hasJob || ! folders.empty();
+        }
+
+        if (hasJob)
+            analyse (job);
+        else if (! folders.empty())
+            scanFolders (folders, known);
+        else
+            wait (-1);
+
+        const ScopedLock sl (lock);
+        isAnalysing = false;
+    }
+}
+
+void ProjectLibraryIndexer::analyse (const Job& job)
+{
+    if (! job.file.existsAsFile())
+        return;
+
+    Result r;
+    r.itemID = job.itemID;
+    r.file = job.file;
+    r.modTime = job.file.getLastModificationTime().toMilliseconds();
+    r.size = job.file.getSize();
+    r.headerOnly = job.headerOnly;
+
+    // The details are only read again if the file looks like it's changed
+    if (r.modTime == job.indexedModTime && r.size == job.indexedSize)
+        return;
+
+    if (job.headerOnly ? ! readHeader (job.file, r.info)
+                       : (! readDetails (job.file, r.info) && threadShouldExit()))
+        return;
+
+    {
+        const ScopedLock sl (lock);
+        results.push_back (r);
+    }
+
+    triggerAsyncUpdate();
+}
+
+void ProjectLibraryIndexer::scanFolders (const std::vector<Folder>& folders, const std::vector<File>& known)
+{
+    auto wildcards = project.engine.getAudioFileFormatManager().readFormatManager.getWildcardForAllFormats();
+
+    for (auto& folder : folders)
+    {
+        for (auto entry : RangedDirectoryIterator (folder.dir, true, wildcards, File::findFiles))
+        {
+            if (threadShouldExit())
+                return;
+
+            auto file = entry.getFile();
+
+            if (std::binary_search (known.begin(), known.end(), file))
+                continue;
+
+            Result r;
+            r.file = file;
+            r.category = folder.category;
+            r.modTime = entry.getModificationTime().toMilliseconds();
+            r.size = entry.getFileSize();
+
+            // Anything that can't be read, e.g. because it's still being written, is left for next time
+            if (! readDetails (file, r.info))
+                continue;
+
+            {
+                const ScopedLock sl (lock);
+                results.push_back (r);
+            }
+
+            triggerAsyncUpdate();
+        }
+    }
+}
+
+bool ProjectLibraryIndexer::readDetails (const File& file, ItemInfo& info)
+{
+    CRASH_TRACER
+    auto& engine = project.engine;
+    AudioFormat* format = nullptr;
+    std::unique_ptr<AudioFormatReader> reader (AudioFileUtils::createReaderFindingFormat (engine, file, format));
+
+    if (reader == nullptr)
+        return false;
+
+    AudioFileInfo afi (AudioFile (engine, file), reader.get(), format);
+
+    info.isIndexed      = true;
+    info.lengthSeconds  = afi.getLengthInSeconds();
+    info.sampleRate     = afi.sampleRate;
+    info.numChannels    = afi.numChannels;
+    info.bpm            = afi.loopInfo.getBpm (afi);
+    info.rootNote       = afi.loopInfo.getRootNote();
+    info.isLoop         = afi.loopInfo.isLoopable();
+    info.peakLevel      = 0.0f;
+
+    // Reading in chunks lets a long file be abandoned if the indexer's stopped
+    const int chunkSize = 65536;
+
+    for (juce::int64 pos = 0; pos < reader->lengthInSamples; pos += chunkSize)
+    {
+        if (threadShouldExit())
+            return false;
+
+        float lmin = 0, lmax = 0, rmin = 0, rmax = 0;
+        auto numThisTime = (int) jmin ((juce::int64) chunkSize, reader->lengthInSamples - pos);
+        reader->readMaxLevels (pos, numThisTime, lmin, lmax, rmin, rmax);
+
+        info.peakLevel = jmax (info.peakLevel, -lmin, lmax, jmax (-rmin, rmax));
+    }
+
+    return true;
+}
+
+bool ProjectLibraryIndexer::readHeader (const File& file, ItemInfo& info)
+{
+    CRASH_TRACER
+    // Going through the AudioFileManager leaves the details cached for the clips that use the file
+    auto afi = AudioFile (project.engine, file).getInfo();
+
+    if (! afi.wasParsedOk)
+        return false;
+
+    info.isIndexed      = true;
+    info.lengthSeconds  = afi.getLengthInSeconds();
+    info.sampleRate     = afi.sampleRate;
+    info.numChannels    = afi.numChannels;
+    info.bpm            = afi.loopInfo.getBpm (afi);
+    info.rootNote       = afi.loopInfo.getRootNote();
+    info.isLoop         = afi.loopInfo.isLoopable();
+    info.peakLevel      = 0.0f;
+
+    return true;
+}
+
+//==============================================================================
+void ProjectLibraryIndexer::handleAsyncUpdate()
+{
+    CRASH_TRACER
+    using namespace IndexerHelpers;
+
+    std::vector<Result> newResults;
+
+    {
+        const ScopedLock sl (lock);
+        std::swap (newResults, results);
+    }
+
+    if (newResults.empty())
+        return;
+
+    for (auto& r : newResults)
+    {
+        ProjectItem::Ptr item;
+
+        if (r.itemID.isValid())
+            item = project.getProjectItemForID (r.itemID);
+        else if (! project.isReadOnly())
+            item = project.createNewItem (r.file, ProjectItem::waveItemType(),
+                                          r.file.getFileNameWithoutExtension(),
+                                          {}, r.category, false);
+
+        if (item == nullptr)
+            continue;
+
+        // Without a peak level, the item isn't marked as indexed so that the scan still reads all of it
+        if (! r.headerOnly)
+        {
+            setIfDifferent (*item, modTimeProperty, String (r.modTime));
+            setIfDifferent (*item, sizeProperty, String (r.size));
+        }
+
+        if (! r.info.isIndexed)
+            continue;
+
+        setIfDifferent (*item, lengthProperty, String (r.info.lengthSeconds));
+        setIfDifferent (*item, rateProperty, String (r.info.sampleRate));
+        setIfDifferent (*item, channelsProperty, String (r.info.numChannels));
+        setIfDifferent (*item, bpmProperty, String (r.info.bpm));
+        setIfDifferent (*item, rootProperty, String (r.info.rootNote));
+        setIfDifferent (*item, loopProperty, r.info.isLoop ? "1" : "0");
+
+        if (! r.headerOnly)
+            setIfDifferent (*item, peakProperty, String (r.info.peakLevel));
+
+        item->setLength (r.info.lengthSeconds);
+    }
+
+    if (onItemsIndexed != nullptr)
+        onItemsIndexed();
+}
+
+} // namespace tracktion_engine
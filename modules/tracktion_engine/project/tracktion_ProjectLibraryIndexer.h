@@ -0,0 +1,147 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+/**
+    Keeps the details of a Project's audio files up to date in the background.
+
+    The items are looked over a batch at a time on the message thread, and any wave item
+    whose file is new or has changed since it was last indexed is handed to a background
+    thread. That opens the file and works out its length, format, tempo, key and peak level,
+    which are then stored in the item's named properties. They're saved with the project,
+    so browsing and filtering a large library doesn't need to open any of the files.
+
+    It can also watch the project's media folders and add any audio files that appear in
+    them as new items, which is on by default for library projects.
+
+    Get the one for a Project with Project::getLibraryIndexer(). It does nothing until
+    it's enabled, and should only be used on the message thread.
+*/
+class ProjectLibraryIndexer  : private juce::Thread,
+                               private juce::Timer,
+                               private juce::AsyncUpdater
+{
+public:
+    ProjectLibraryIndexer (Project&);
+    ~ProjectLibraryIndexer() override;
+
+    //==============================================================================
+    void setEnabled (bool);
+    bool isEnabled() const                          { return isTimerRunning(); }
+
+    /** Sets whether audio files that appear in the media folders are added to the project. */
+    void setAddsNewFiles (bool);
+    bool addsNewFiles() const noexcept              { return shouldAddNewFiles; }
+
+    /** Sets how long to wait after looking over everything before starting again. */
+    void setScanIntervalSeconds (double);
+
+    /** Starts looking over everything again straight away, e.g. after importing files. */
+    void scanNow();
+
+    /** Returns true if there are files waiting to be indexed. */
+    bool isBusy() const;
+
+    /** Asks for some items' details to be read as soon as possible, e.g. the rows of a list
+        that have just scrolled into view.
+
+        These go ahead of the regular scan, and only read the files' headers, via the
+        AudioFileManager's cache, so their peak levels are left for the scan to fill in.
+        Items whose files haven't changed since they were indexed are skipped. This works
+        whether or not the indexer's enabled, and onItemsIndexed is called once the details
+        have been stored, so nothing here waits for the disk.
+    */
+    void requestInfo (const juce::Array<ProjectItemID>&);
+
+    /** Called on the message thread when some items have been indexed or added. */
+    std::function<void()> onItemsIndexed;
+
+    //==============================================================================
+    /** The details stored for an item when it was indexed. */
+    struct ItemInfo
+    {
+        bool isIndexed = false;
+        double lengthSeconds = 0, sampleRate = 0;
+        int numChannels = 0;
+        double bpm = 0;                 /**< 0 if the file doesn't say. */
+        int rootNote = -1;              /**< A MIDI note number, or -1 if the file doesn't say. */
+        bool isLoop = false;
+        float peakLevel = 0;            /**< The highest absolute sample value. */
+    };
+
+    static ItemInfo getInfo (const ProjectItem&);
+
+    /** Limits which indexed items findItems() returns. */
+    struct Filter
+    {
+        juce::Range<double> lengthSeconds { 0.0, 1.0e12 };
+        juce::Range<double> bpm;        /**< An empty range matches any tempo. */
+        int rootNote = -1;              /**< Matches this note in any octave, or any key if -1. */
+        bool loopsOnly = false;
+    };
+
+    /** Returns the indexed items matching a filter, only using what's been stored. */
+    juce::Array<ProjectItemID> findItems (const Filter&);
+
+private:
+    //==============================================================================
+    struct Job
+    {
+        ProjectItemID itemID;
+        juce::File file;
+        juce::int64 indexedModTime = 0, indexedSize = 0;
+        bool headerOnly = false;
+    };
+
+    struct Result
+    {
+        ProjectItemID itemID;           // Invalid for a new file that needs adding
+        juce::File file;
+        ProjectItem::Category category = ProjectItem::Category::imported;
+        juce::int64 modTime = 0, size = 0;
+        ItemInfo info;
+        bool headerOnly = false;
+    };
+
+    struct Folder
+    {
+        juce::File dir;
+        ProjectItem::Category category;
+    };
+
+    Project& project;
+    bool shouldAddNewFiles = false;
+    int scanIntervalMs = 10000;
+    int nextItemIndex = 0;
+    juce::uint32 nextScanTime = 0;
+
+    juce::CriticalSection lock;
+    std::vector<Job> jobs, requestedJobs;
+    std::vector<Result> results;
+    std::vector<Folder> foldersToScan;
+    std::vector<juce::File> knownFiles;         // Sorted, for the folder scan
+    bool isAnalysing = false;
+
+    void timerCallback() override;
+    void run() override;
+    void handleAsyncUpdate() override;
+
+    void queueNextBatch();
+    void analyse (const Job&);
+    void scanFolders (const std::vector<Folder>&, const std::vector<juce::File>& known);
+    bool readDetails (const juce::File&, ItemInfo&);
+    bool readHeader (const juce::File&, ItemInfo&);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ProjectLibraryIndexer)
+};
+
+} // namespace tracktion_engine
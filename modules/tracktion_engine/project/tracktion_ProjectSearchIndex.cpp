@@ -11,50 +11,80 @@
 namespace tracktion_engine
 {
 
-struct IndexedWord
+namespace SearchIndexHelpers
 {
-    String word;
-    int numIDs;
-    HeapBlock<int> ids;
+    // The old format started with the number of words, so a negative number marks this one
+    static constexpr int formatMarker = -2;
+    static constexpr int numHeaderInts = 3;     // marker, number of words, size in bytes
+    static constexpr int numEntryInts = 3;      // word offset, list offset, number of IDs
 
-    IndexedWord (InputStream& in)  : word (in.readString())
+    static void writeVarInt (MemoryOutputStream& out, uint32 value)
     {
-        numIDs = in.readShort();
-        ids.malloc ((size_t) numIDs);
-        in.read (ids, (int) sizeof (int) * numIDs);
+        while (value >= 0x80)
+        {
+            out.writeByte ((char) (value | 0x80));
+            value >>= 7;
+        }
+
+        out.writeByte ((char) value);
     }
 
-    IndexedWord (const String& w, int mid) : word (w), numIDs (1)
+    static uint32 readVarInt (const uint8*& p, const uint8* end) noexcept
     {
-        ids.malloc (1);
-        *ids = mid;
+        uint32 value = 0;
+
+        for (int shift = 0; p < end && shift < 32; shift += 7)
+        {
+            auto byte = *p++;
+            value |= (uint32) (byte & 0x7f) << shift;
+
+            if ((byte & 0x80) == 0)
+                break;
+        }
+
+        return value;
     }
 
-    void writeToStream (OutputStream& out)
+    static int readInt (const uint8* data, size_t index) noexcept
     {
-        out.writeString (word);
-        out.writeShort ((short) numIDs);
-        out.write (ids, (size_t) numIDs * sizeof (int));
+        // The index may start anywhere in a file so these might not be aligned
+        return (int) ByteOrder::swapIfBigEndian (readUnaligned<uint32> (data + index * sizeof (int)));
     }
 
-    void addMediaId (int mid)
+    /** Returns true if the two words are the same apart from one character being
+        added, removed, changed, or swapped with its neighbour.
+    */
+    static bool isWithinOneTypo (const char* a, size_t lenA, const char* b, size_t lenB) noexcept
     {
-        for (int i = numIDs; --i >= 0;)
-            if (ids[i] == mid)
-                return;
+        if (lenA > lenB)
+        {
+            std::swap (a, b);
+            std::swap (lenA, lenB);
+        }
 
-        if (numIDs > 32766)
+        if (lenB - lenA > 1)
+            return false;
+
+        size_t i = 0;
+
+        while (i < lenA && a[i] == b[i])
+            ++i;
+
+        if (i == lenA)
+            return true;
+
+        if (lenA == lenB)
         {
-            jassertfalse;
-            return;
+            if (std::strcmp (a + i + 1, b + i + 1) == 0)
+                return true;
+
+            return i + 1 < lenA && a[i] == b[i + 1] && a[i + 1] == b[i]
+                    && std::strcmp (a + i + 2, b + i + 2) == 0;
         }
 
-        ids.realloc ((size_t) ++numIDs);
-        ids[numIDs - 1] = mid;
+        return std::strcmp (a + i, b + i + 1) == 0;
     }
-
-    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (IndexedWord)
-};
+}
 
 //==============================================================================
 ProjectSearchIndex::ProjectSearchIndex (Project& p) : project (p)
@@ -101,66 +131,307 @@ void ProjectSearchIndex::addClip (const ProjectItem::Ptr& item)
             auto word = newWord.toLowerCase().retainCharacters ("abcdefghijklmnopqrstuvwxyz0123456789");
 
             if (! (word.isEmpty() || isNoiseWord (word)))
-            {
-                if (auto w = findWordMatch (word))
-                {
-                    w->addMediaId (item->getID().getItemID());
-                }
-                else
-                {
-                    index.add (new IndexedWord (word, item->getID().getItemID()));
+                wordsToPack[word].push_back (item->getID().getItemID());
+        }
+    }
+}
 
-                    std::sort (index.begin(), index.end(),
-                               [] (IndexedWord* a, IndexedWord* b) { return a->word < b->word; });
-                }
-            }
+void ProjectSearchIndex::packWordsIfNeeded()
+{
+    using namespace SearchIndexHelpers;
+
+    if (wordsToPack.empty())
+        return;
+
+    // Any words already packed, e.g. read from a file, are merged with the new ones
+    for (int i = 0; i < numWords; ++i)
+    {
+        Array<int> packedIDs;
+        addItemsForWord (i, packedIDs);
+
+        auto& ids = wordsToPack[String::fromUTF8 (getWord (i))];
+        ids.insert (ids.end(), packedIDs.begin(), packedIDs.end());
+    }
+
+    // The map's already sorted in the same order as strcmp on the UTF-8 bytes
+    MemoryOutputStream words, lists;
+    std::vector<int> entries;
+    entries.reserve (wordsToPack.size() * numEntryInts);
+
+    for (auto& w : wordsToPack)
+    {
+        auto& ids = w.second;
+        std::sort (ids.begin(), ids.end());
+        ids.erase (std::unique (ids.begin(), ids.end()), ids.end());
+
+        entries.push_back ((int) words.getDataSize());
+        entries.push_back ((int) lists.getDataSize());
+        entries.push_back ((int) ids.size());
+
+        words.write (w.first.toRawUTF8(), w.first.getNumBytesAsUTF8() + 1);
+
+        uint32 last = 0;
+
+        for (auto id : ids)
+        {
+            writeVarInt (lists, (uint32) id - last);
+            last = (uint32) id;
         }
     }
+
+    // The offsets are relative to the start, so the words and lists follow the entries
+    const auto wordsStart = (int) ((numHeaderInts + entries.size()) * sizeof (int));
+    const auto listsStart = wordsStart + (int) words.getDataSize();
+
+    for (size_t i = 0; i < entries.size(); i += numEntryInts)
+    {
+        entries[i] += wordsStart;
+        entries[i + 1] += listsStart;
+    }
+
+    MemoryOutputStream out;
+    out.writeInt (formatMarker);
+    out.writeInt ((int) wordsToPack.size());
+    out.writeInt (listsStart + (int) lists.getDataSize());
+
+    for (auto e : entries)
+        out.writeInt (e);
+
+    out << words << lists;
+
+    wordsToPack.clear();
+    mappedFile.reset();
+    packedIndex = out.getMemoryBlock();
+    useIndexData (packedIndex.getData(), packedIndex.getSize());
+}
+
+bool ProjectSearchIndex::useIndexData (const void* data, size_t availableSize)
+{
+    using namespace SearchIndexHelpers;
+
+    indexData = nullptr;
+    indexSize = 0;
+    numWords = 0;
+
+    auto d = static_cast<const uint8*> (data);
+
+    if (d == nullptr || availableSize < numHeaderInts * sizeof (int) || readInt (d, 0) != formatMarker)
+        return false;
+
+    auto count = readInt (d, 1);
+    auto size = (size_t) readInt (d, 2);
+
+    if (count < 0 || size > availableSize || (numHeaderInts + (size_t) count * numEntryInts) * sizeof (int) > size)
+        return false;
+
+    indexData = d;
+    indexSize = size;
+    numWords = count;
+    return true;
 }
 
 void ProjectSearchIndex::writeToStream (OutputStream& out)
 {
-    out.writeInt (index.size());
+    packWordsIfNeeded();
 
-    for (auto&& i : index)
-        i->writeToStream (out);
+    if (indexSize > 0)
+    {
+        out.write (indexData, indexSize);
+    }
+    else
+    {
+        out.writeInt (SearchIndexHelpers::formatMarker);
+        out.writeInt (0);
+        out.writeInt (SearchIndexHelpers::numHeaderInts * (int) sizeof (int));
+    }
 }
 
 void ProjectSearchIndex::readFromStream (InputStream& in)
 {
-    index.clear();
+    using namespace SearchIndexHelpers;
+
+    wordsToPack.clear();
+    mappedFile.reset();
+    packedIndex.reset();
+    useIndexData (nullptr, 0);
+
+    auto first = in.readInt();
 
-    for (int i = in.readInt(); --i >= 0;)
-        index.add (new IndexedWord (in));
+    if (first == formatMarker)
+    {
+        auto count = in.readInt();
+        auto size = in.readInt();
+
+        if (size >= numHeaderInts * (int) sizeof (int))
+        {
+            packedIndex.setSize ((size_t) size);
+            auto d = static_cast<int*> (packedIndex.getData());
+            d[0] = (int) ByteOrder::swapIfBigEndian ((uint32) formatMarker);
+            d[1] = (int) ByteOrder::swapIfBigEndian ((uint32) count);
+            d[2] = (int) ByteOrder::swapIfBigEndian ((uint32) size);
+
+            const auto remaining = size - numHeaderInts * (int) sizeof (int);
+
+            if (in.read (d + numHeaderInts, remaining) == remaining)
+                useIndexData (packedIndex.getData(), packedIndex.getSize());
+        }
+
+        return;
+    }
+
+    // The old format is a list of words, each with a 16-bit count of IDs
+    for (int i = first; --i >= 0 && ! in.isExhausted();)
+    {
+        auto word = in.readString();
+        auto numIDs = (int) (uint16) in.readShort();
+        auto& ids = wordsToPack[word];
+
+        for (int j = 0; j < numIDs; ++j)
+            ids.push_back (in.readInt());
+    }
+
+    packWordsIfNeeded();
 }
 
-IndexedWord* ProjectSearchIndex::findWordMatch (const String& word) const
+bool ProjectSearchIndex::mapFromFile (const File& file, int64 indexPosition)
 {
-    int start = 0;
-    int end = index.size();
+    wordsToPack.clear();
+    packedIndex.reset();
+    useIndexData (nullptr, 0);
 
-    for (;;)
-    {
-        if (start >= end)
-            break;
+    mappedFile = std::make_unique<MemoryMappedFile> (file, Range<int64> (indexPosition, file.getSize()),
+                                                     MemoryMappedFile::readOnly);
+
+    // The mapping may have been started earlier, on a page boundary
+    auto offset = (size_t) (indexPosition - mappedFile->getRange().getStart());
+
+    if (mappedFile->getData() != nullptr
+         && offset < mappedFile->getSize()
+         && useIndexData (static_cast<const uint8*> (mappedFile->getData()) + offset, mappedFile->getSize() - offset))
+        return true;
 
-        auto w = index.getUnchecked (start);
+    mappedFile.reset();
+    return false;
+}
 
-        if (word == w->word)
-            return w;
+//==============================================================================
+const char* ProjectSearchIndex::getWord (int wordIndex) const noexcept
+{
+    using namespace SearchIndexHelpers;
+    auto offset = (size_t) readInt (indexData, numHeaderInts + (size_t) wordIndex * numEntryInts);
+    return offset < indexSize ? reinterpret_cast<const char*> (indexData + offset) : "";
+}
 
-        const int halfway = (start + end) >> 1;
+int ProjectSearchIndex::findFirstWordNotBefore (const char* word) const noexcept
+{
+    int start = 0, end = numWords;
 
-        if (halfway == start)
-            break;
+    while (start < end)
+    {
+        auto halfway = (start + end) / 2;
 
-        if (word.compare (index[halfway]->word) >= 0)
-            start = halfway;
+        if (std::strcmp (getWord (halfway), word) < 0)
+            start = halfway + 1;
         else
             end = halfway;
     }
 
-    return {};
+    return start;
+}
+
+void ProjectSearchIndex::addItemsForWord (int wordIndex, Array<int>& dest) const
+{
+    using namespace SearchIndexHelpers;
+
+    auto entry = numHeaderInts + (size_t) wordIndex * numEntryInts;
+    auto offset = (size_t) readInt (indexData, entry + 1);
+    auto numIDs = readInt (indexData, entry + 2);
+
+    if (offset >= indexSize || numIDs <= 0)
+        return;
+
+    auto p = indexData + offset;
+    auto end = indexData + indexSize;
+    uint32 id = 0;
+
+    dest.ensureStorageAllocated (dest.size() + numIDs);
+
+    for (int i = 0; i < numIDs && p < end; ++i)
+    {
+        id += readVarInt (p, end);
+        dest.add ((int) id);
+    }
+}
+
+Array<int> ProjectSearchIndex::findItemsWithWord (const String& word)
+{
+    packWordsIfNeeded();
+
+    Array<int> found;
+    auto w = word.toRawUTF8();
+    auto i = findFirstWordNotBefore (w);
+
+    if (i < numWords && std::strcmp (getWord (i), w) == 0)
+        addItemsForWord (i, found);
+
+    return found;
+}
+
+Array<int> ProjectSearchIndex::findItemsWithWordsStartingWith (const String& prefix)
+{
+    packWordsIfNeeded();
+
+    Array<int> found;
+    auto p = prefix.toRawUTF8();
+    auto prefixLength = std::strlen (p);
+    int numMatchingWords = 0;
+
+    for (int i = findFirstWordNotBefore (p); i < numWords && std::strncmp (getWord (i), p, prefixLength) == 0; ++i)
+    {
+        addItemsForWord (i, found);
+        ++numMatchingWords;
+    }
+
+    if (numMatchingWords > 1)
+    {
+        std::sort (found.begin(), found.end());
+        found.removeRange ((int) (std::unique (found.begin(), found.end()) - found.begin()), found.size());
+    }
+
+    return found;
+}
+
+Array<int> ProjectSearchIndex::findItemsWithSimilarWords (const String& word)
+{
+    packWordsIfNeeded();
+
+    // Very short words are similar to too many others to be any use
+    if (word.length() < 3)
+        return findItemsWithWord (word);
+
+    Array<int> found;
+    auto w = word.toRawUTF8();
+    auto length = std::strlen (w);
+    int numMatchingWords = 0;
+
+    for (int i = 0; i < numWords; ++i)
+    {
+        auto candidate = getWord (i);
+
+        if (SearchIndexHelpers::isWithinOneTypo (w, length, candidate, std::strlen (candidate)))
+        {
+            addItemsForWord (i, found);
+            ++numMatchingWords;
+        }
+    }
+
+    if (numMatchingWords > 1)
+    {
+        std::sort (found.begin(), found.end());
+        found.removeRange ((int) (std::unique (found.begin(), found.end()) - found.begin()), found.size());
+    }
+
+    return found;
 }
 
 void ProjectSearchIndex::findMatches (SearchOperation& search, Array<ProjectItemID>& results)
@@ -180,19 +451,85 @@ SearchOperation::~SearchOperation()
 }
 
 //==============================================================================
+// The matches are always kept sorted, so they can be combined in a single pass
+namespace SearchIndexHelpers
+{
+    static Array<int> getUnion (const Array<int>& a, const Array<int>& b)
+    {
+        std::vector<int> result ((size_t) (a.size() + b.size()));
+        auto end = std::set_union (a.begin(), a.end(), b.begin(), b.end(), result.begin());
+        return Array<int> (result.data(), (int) (end - result.begin()));
+    }
+
+    static Array<int> getIntersection (const Array<int>& a, const Array<int>& b)
+    {
+        auto& smaller = a.size() <= b.size() ? a : b;
+        auto& larger  = a.size() <= b.size() ? b : a;
+
+        // When one list is much shorter, it's quicker to search the longer one for each of its IDs
+        if (smaller.size() * 16 < larger.size())
+        {
+            Array<int> result;
+            auto pos = larger.begin();
+
+            for (auto id : smaller)
+            {
+                pos = std::lower_bound (pos, larger.end(), id);
+
+                if (pos == larger.end())
+                    break;
+
+                if (*pos == id)
+                    result.add (id);
+            }
+
+            return result;
+        }
+
+        std::vector<int> result ((size_t) smaller.size());
+        auto end = std::set_intersection (a.begin(), a.end(), b.begin(), b.end(), result.begin());
+        return Array<int> (result.data(), (int) (end - result.begin()));
+    }
+
+    static Array<int> getDifference (const Array<int>& a, const Array<int>& b)
+    {
+        std::vector<int> result ((size_t) a.size());
+        auto end = std::set_difference (a.begin(), a.end(), b.begin(), b.end(), result.begin());
+        return Array<int> (result.data(), (int) (end - result.begin()));
+    }
+}
+
 struct WordMatchOperation : public SearchOperation
 {
     WordMatchOperation (const String& w) : word (w.toLowerCase().trim()) {}
 
     Array<int> getMatches (ProjectSearchIndex& psi) override
     {
-        Array<int> found;
+        return psi.findItemsWithWord (word);
+    }
+
+    String word;
+};
 
-        if (auto w = psi.findWordMatch (word))
-            for (int j = 0; j < w->numIDs; ++j)
-                found.add (w->ids[j]);
+struct PrefixMatchOperation : public SearchOperation
+{
+    PrefixMatchOperation (const String& p) : prefix (p.toLowerCase().trim()) {}
 
-        return found;
+    Array<int> getMatches (ProjectSearchIndex& psi) override
+    {
+        return psi.findItemsWithWordsStartingWith (prefix);
+    }
+
+    String prefix;
+};
+
+struct SimilarWordMatchOperation : public SearchOperation
+{
+    SimilarWordMatchOperation (const String& w) : word (w.toLowerCase().trim()) {}
+
+    Array<int> getMatches (ProjectSearchIndex& psi) override
+    {
+        return psi.findItemsWithSimilarWords (word);
     }
 
     String word;
@@ -213,10 +550,7 @@ struct OrOperation : public SearchOperation
         if (i2.isEmpty())
             return i1;
 
-        for (int i = i2.size(); --i >= 0;)
-            i1.addIfNotAlreadyThere (i2[i]);
-
-        return i1;
+        return SearchIndexHelpers::getUnion (i1, i2);
     }
 };
 
@@ -236,8 +570,7 @@ struct AndOperation : public SearchOperation
         if (i2.isEmpty())
             return i2;
 
-        i1.removeValuesNotIn (i2);
-        return i1;
+        return SearchIndexHelpers::getIntersection (i1, i2);
     }
 };
 
@@ -245,14 +578,12 @@ struct NotOperation : public SearchOperation
 {
     NotOperation (SearchOperation* in) : SearchOperation (in, nullptr) {}
 
-    Array<int> getMatches (ProjectSearchIndex& psi)
+    Array<int> getMatches (ProjectSearchIndex& psi) override
     {
-        Array<int> i1;
-
-        i1 = psi.project.getAllItemIDs();
-        i1.removeValuesIn (in1->getMatches (psi));
+        auto all = psi.project.getAllItemIDs();
+        std::sort (all.begin(), all.end());
 
-        return i1;
+        return SearchIndexHelpers::getDifference (all, in1->getMatches (psi));
     }
 };
 
@@ -362,6 +693,13 @@ SearchOperation* createCondition (const StringArray& words, int start, int lengt
         if (words[start] == TRANS("All"))
             return new NotOperation (new FalseOperation());
 
+        // "drum*" matches any word starting with "drum", and "snair~" anything one typo from "snair"
+        if (words[start].length() > 1 && words[start].endsWithChar ('*'))
+            return new PrefixMatchOperation (words[start].dropLastCharacters (1));
+
+        if (words[start].length() > 1 && words[start].endsWithChar ('~'))
+            return new SimilarWordMatchOperation (words[start].dropLastCharacters (1));
+
         return createPluralOptions (words[start]);
     }
 
@@ -397,7 +735,7 @@ SearchOperation* createSearchForKeywords (const String& keywords)
     const String k (keywords.toLowerCase()
                             .replace ("-", " " + TRANS("Not") + " ")
                             .replace ("+", " " + TRANS("And") + " ")
-                            .retainCharacters (CharPointer_UTF8 ("abcdefghijklmnopqrstuvwxyz0123456789\xc3\xa0\xc3\xa1\xc3\xa2\xc3\xa3\xc3\xa4\xc3\xa5\xc3\xa6\xc3\xa7\xc3\xa8\xc3\xa9\xc3\xaa\xc3\xab\xc3\xac\xc3\xad\xc3\xae\xc3\xaf\xc3\xb0\xc3\xb1\xc3\xb2\xc3\xb3\xc3\xb4\xc3\xb5\xc3\xb6\xc3\xb8\xc3\xb9\xc3\xba\xc3\xbb\xc3\xbc\xc3\xbd\xc3\xbf\xc3\x9f"))
+                            .retainCharacters (CharPointer_UTF8 ("abcdefghijklmnopqrstuvwxyz0123456789*~\xc3\xa0\xc3\xa1\xc3\xa2\xc3\xa3\xc3\xa4\xc3\xa5\xc3\xa6\xc3\xa7\xc3\xa8\xc3\xa9\xc3\xaa\xc3\xab\xc3\xac\xc3\xad\xc3\xae\xc3\xaf\xc3\xb0\xc3\xb1\xc3\xb2\xc3\xb3\xc3\xb4\xc3\xb5\xc3\xb6\xc3\xb8\xc3\xb9\xc3\xba\xc3\xbb\xc3\xbc\xc3\xbd\xc3\xbf\xc3\x9f"))
                             .trim());
 
     StringArray words;
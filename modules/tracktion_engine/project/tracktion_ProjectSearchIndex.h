@@ -11,10 +11,17 @@
 namespace tracktion_engine
 {
 
-struct IndexedWord;
 class SearchOperation;
 
 //==============================================================================
+/**
+    An inverted index of the words in a Project's items, used for keyword searches.
+
+    Each word maps to a sorted list of the IDs of the items containing it. When written,
+    the words are sorted so they can be binary searched, and each list is stored as
+    varint-encoded differences between IDs. The written index can be searched where it
+    lies, e.g. in a memory-mapped file, without being read into objects first.
+*/
 class ProjectSearchIndex
 {
 public:
@@ -26,10 +33,42 @@ public:
     void writeToStream (juce::OutputStream&);
     void readFromStream (juce::InputStream&);
 
-    IndexedWord* findWordMatch (const juce::String& word) const;
+    /** Searches an index that was written to a file at the given position straight from a
+        memory-mapped copy of the file. Returns false if it can't, e.g. if the index is in
+        the old format, in which case readFromStream() should be used instead.
+    */
+    bool mapFromFile (const juce::File&, juce::int64 indexPosition);
+
+    //==============================================================================
+    // These all return the IDs of the matching items in ascending order, without duplicates
+
+    /** Finds the items containing this word. */
+    juce::Array<int> findItemsWithWord (const juce::String&);
+
+    /** Finds the items containing any word starting with this prefix. */
+    juce::Array<int> findItemsWithWordsStartingWith (const juce::String& prefix);
+
+    /** Finds the items containing this word or any word one typo away from it, i.e.
+        with one character added, removed, changed or swapped with its neighbour.
+    */
+    juce::Array<int> findItemsWithSimilarWords (const juce::String&);
 
     Project& project;
-    juce::OwnedArray<IndexedWord> index;
+
+private:
+    // Words collected by addClip are packed into the same format that's written
+    std::map<juce::String, std::vector<int>> wordsToPack;
+    juce::MemoryBlock packedIndex;
+    std::unique_ptr<juce::MemoryMappedFile> mappedFile;
+    const juce::uint8* indexData = nullptr;
+    size_t indexSize = 0;
+    int numWords = 0;
+
+    void packWordsIfNeeded();
+    bool useIndexData (const void* data, size_t availableSize);
+    const char* getWord (int wordIndex) const noexcept;
+    int findFirstWordNotBefore (const char* word) const noexcept;
+    void addItemsForWord (int wordIndex, juce::Array<int>& dest) const;
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ProjectSearchIndex)
 };
@@ -33,16 +33,35 @@ struct BeatDetect
         double blockEnergy = 0;
 
         for (int chan = numChans; --chan >= 0;)
-        {
-            const float* const c = inputs[chan];
-
-            for (int i = 0; i < blockSize; ++i)
-                blockEnergy += c[i] * c[i];
-        }
+            blockEnergy += getSumOfSquares (inputs[chan], blockSize);
 
         pushEnergy (blockEnergy);
     }
 
+    /** Returns the sum of the squares of some samples.
+        This keeps several independent sums so that the compiler can vectorise it.
+    */
+    static double getSumOfSquares (const float* JUCE_RESTRICT samples, int numSamples) noexcept
+    {
+        constexpr int numSums = 8;
+        float sums[numSums] = {};
+        int i = 0;
+
+        for (; i + numSums <= numSamples; i += numSums)
+            for (int j = 0; j < numSums; ++j)
+                sums[j] += samples[i + j] * samples[i + j];
+
+        double total = 0;
+
+        for (; i < numSamples; ++i)
+            total += samples[i] * samples[i];
+
+        for (auto sum : sums)
+            total += sum;
+
+        return total;
+    }
+
     int getBlockSize()                      { return blockSize; }
     int getNumBeats()                       { return beatBlocks.size(); }
     juce::int64 getBeat (int idx) const     { return beatBlocks[idx] * blockSize; }
@@ -50,6 +69,7 @@ struct BeatDetect
 private:
     enum { historyLength = 43 };
     double energy [historyLength];
+    double energySum = 0;
     int curBlock = 0;
     int lastBlock = -2;
     int blockSize = 0;
@@ -61,6 +81,7 @@ private:
         if (curBlock < historyLength)
         {
             energy [curBlock++] = e;
+            energySum += e;
 
             if (curBlock == historyLength)
             {
@@ -73,7 +94,13 @@ private:
         }
         else
         {
-            energy[curBlock % historyLength] = e;
+            auto& oldest = energy[curBlock % historyLength];
+            energySum += e - oldest;
+            oldest = e;
+
+            // The running sum is recalculated now and then so rounding errors can't build up
+            if (curBlock % historyLength == 0)
+                energySum = std::accumulate (std::begin (energy), std::end (energy), 0.0);
 
             if (e > sensitivity * getAverageEnergy())
                 addBlock(curBlock);
@@ -92,12 +119,7 @@ private:
 
     double getAverageEnergy() const noexcept
     {
-        double avEnergy = 0;
-
-        for (int i = 0; i < historyLength; ++i)
-            avEnergy += energy[i];
-
-        return avEnergy / historyLength;
+        return energySum / historyLength;
     }
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BeatDetect)
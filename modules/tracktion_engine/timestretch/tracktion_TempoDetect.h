@@ -34,13 +34,18 @@ namespace tracktion_engine
 
 /**
     Uses the SoundTouch BPMDetect class to guess the tempo of some audio.
+
+    Tempo doesn't need the full bandwidth, so the audio is mixed to mono and decimated
+    before it's handed to BPMDetect.
 */
 class TempoDetect
 {
 public:
     TempoDetect (int numChannels_, double sampleRate)
         : numChannels (numChannels_),
-          bpmDetect (numChannels, (int) sampleRate)
+          decimationFactor (getDecimationFactor (sampleRate)),
+          decimatedSampleRate (sampleRate / decimationFactor),
+          bpmDetect (1, (int) decimatedSampleRate)
     {
     }
 
@@ -58,9 +63,9 @@ public:
         juce::AudioBuffer<float> buffer (numChannels, blockSize);
 
         juce::int64 numLeft = reader.lengthInSamples;
-        int startSample = 0;
+        juce::int64 startSample = 0;
 
-        while (numLeft > 0)
+        while (numLeft > 0 && ! hasConverged())
         {
             const int numThisTime = (int) juce::jmin (numLeft, (juce::int64) blockSize);
             reader.read (&buffer, 0, numThisTime, startSample, true, useRightChan);
@@ -73,6 +78,86 @@ public:
         return finishAndDetect();
     }
 
+    /** Detects the tempo of a file, reading it through the AudioFileCache.
+        This stops reading once the estimate has settled, so long files don't have to be read to the end.
+        @param progress     if this isn't nullptr, it's updated with the proportion of the file read so far
+        @param shouldStop   if this is set, it's called between blocks and returning true abandons the detection
+        @returns the tempo in BPM, or 0 if it couldn't be found
+    */
+    static float detectTempo (Engine& engine, const AudioFile& file,
+                              float* progress = nullptr, std::function<bool()> shouldStop = {})
+    {
+        CRASH_TRACER
+        auto reader = engine.getAudioFileManager().cache.createReader (file);
+        auto numSamples = file.getLengthInSamples();
+        auto numFileChannels = juce::jlimit (1, 2, file.getNumChannels());
+
+        if (reader == nullptr || numSamples <= 0)
+            return 0.0f;
+
+        TempoDetect detector (numFileChannels, reader->getSampleRate());
+
+        const int blockSize = 32768;
+        juce::AudioBuffer<float> buffer (numFileChannels, blockSize);
+        auto channels = juce::AudioChannelSet::canonicalChannelSet (numFileChannels);
+
+        reader->setReadPosition (0);
+        juce::int64 numDone = 0;
+
+        while (numDone < numSamples && ! detector.hasConverged())
+        {
+            if (shouldStop != nullptr && shouldStop())
+                return 0.0f;
+
+            auto numThisTime = (int) juce::jmin ((juce::int64) blockSize, numSamples - numDone);
+            reader->readSamples (numThisTime, buffer, channels, 0, juce::AudioChannelSet::stereo(), 5000);
+            detector.processSection (buffer, numThisTime);
+            numDone += numThisTime;
+
+            if (progress != nullptr)
+                *progress = numDone / (float) numSamples;
+        }
+
+        if (progress != nullptr)
+            *progress = 1.0f;
+
+        return detector.finishAndDetect();
+    }
+
+    /** Detects the tempos of several files at once, using a thread for each CPU.
+        @returns the tempo of each file in the same order, with 0 for any that couldn't be found
+    */
+    static juce::Array<float> detectTempos (Engine& engine, const juce::Array<AudioFile>& files)
+    {
+        CRASH_TRACER
+        juce::Array<float> tempos;
+        tempos.insertMultiple (0, 0.0f, files.size());
+
+        if (files.isEmpty())
+            return tempos;
+
+        std::atomic<int> nextFile { 0 }, numThreadsFinished { 0 };
+        const int numThreads = juce::jlimit (1, files.size(), juce::SystemStats::getNumCpus() - 1);
+
+        juce::ThreadPool pool (numThreads);
+
+        for (int i = 0; i < numThreads; ++i)
+        {
+            pool.addJob ([&]
+            {
+                for (int index = nextFile++; index < files.size(); index = nextFile++)
+                    tempos.setUnchecked (index, detectTempo (engine, files.getReference (index)));
+
+                ++numThreadsFinished;
+            });
+        }
+
+        while (numThreadsFinished.load() < numThreads)
+            juce::Thread::sleep (5);
+
+        return tempos;
+    }
+
     /** Processes a block of audio returning the tempo for it.
         @returns the tempo in BPM for the block.
     */
@@ -89,6 +174,11 @@ public:
     bool isBpmSensible() const                      { return getSensibleRange().contains (bpm); }
     static juce::Range<float> getSensibleRange()    { return { 29, 200 }; }
 
+    /** Returns true once the estimated tempo has stopped changing, so there's little
+        point feeding in any more audio.
+    */
+    bool hasConverged() const noexcept              { return numStableChecks >= numStableChecksNeeded; }
+
     //==============================================================================
     /** Processes a non-interleaved buffer section.  */
     void processSection (juce::AudioBuffer<float>& buffer, int numSamplesToProcess)
@@ -104,19 +194,82 @@ public:
 
     void processSection (const float** const inputSamples, int numSamples)
     {
-        AudioScratchBuffer scratch (1, numChannels * numSamples);
-        float* interleaved = scratch.buffer.getWritePointer (0);
-        juce::AudioDataConverters::interleaveSamples (inputSamples, interleaved, numSamples, numChannels);
+        const int maxNumDecimated = numSamples / decimationFactor + 1;
+
+        if (maxNumDecimated > decimatedSize)
+        {
+            decimatedSize = maxNumDecimated;
+            decimated.allocate ((size_t) decimatedSize, false);
+        }
+
+        // Averages all the channels over each decimation period. This is the same filter
+        // BPMDetect uses for its own decimation, so it doesn't change the result
+        const float scale = 1.0f / (float) (numChannels * decimationFactor);
+        int numDecimated = 0;
+
+        for (int i = 0; i < numSamples; ++i)
+        {
+            for (int chan = 0; chan < numChannels; ++chan)
+                decimationSum += inputSamples[chan][i];
+
+            if (++decimationCount == decimationFactor)
+            {
+                decimated[numDecimated++] = decimationSum * scale;
+                decimationSum = 0.0f;
+                decimationCount = 0;
+            }
+        }
 
-        bpmDetect.inputSamples (interleaved, numSamples);
+        bpmDetect.inputSamples (decimated, numDecimated);
+        updateConvergence (numSamples);
     }
 
 private:
     //==============================================================================
     int numChannels;
+    const int decimationFactor;
+    const double decimatedSampleRate;
     soundtouch::BPMDetect bpmDetect;
     float bpm = -1.0f;
 
+    juce::HeapBlock<float> decimated;
+    int decimatedSize = 0;
+    float decimationSum = 0.0f;
+    int decimationCount = 0;
+
+    static constexpr double minSecondsBeforeConverging = 30.0, secondsBetweenChecks = 5.0;
+    static constexpr float maxStableBpmChange = 0.1f;
+    static constexpr int numStableChecksNeeded = 3;
+    double secondsProcessed = 0.0, secondsSinceCheck = 0.0;
+    float lastCheckedBpm = 0.0f;
+    int numStableChecks = 0;
+
+    static int getDecimationFactor (double sampleRate) noexcept
+    {
+        // BPMDetect needs at least 9kHz for its own fixed-size decimation blocks
+        return juce::jmax (1, (int) (sampleRate / 11025.0));
+    }
+
+    void updateConvergence (int numSamples)
+    {
+        auto numSeconds = numSamples / (decimatedSampleRate * decimationFactor);
+        secondsProcessed += numSeconds;
+        secondsSinceCheck += numSeconds;
+
+        if (secondsProcessed < minSecondsBeforeConverging || secondsSinceCheck < secondsBetweenChecks)
+            return;
+
+        secondsSinceCheck = 0.0;
+        auto newBpm = bpmDetect.getBpm();
+
+        if (newBpm > 0.0f && std::abs (newBpm - lastCheckedBpm) < maxStableBpmChange)
+            ++numStableChecks;
+        else
+            numStableChecks = 0;
+
+        lastCheckedBpm = newBpm;
+    }
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TempoDetect)
 };
 
@@ -327,9 +327,264 @@ private:
 };
 #endif
 
+//==============================================================================
+/** Everything a Stretcher is constructed with, so a spare one can be matched up. */
+struct TimeStretcher::PoolKey
+{
+    double sampleRate = 0;
+    int samplesPerBlock = 0, numChannels = 0;
+    Mode mode = disabled;
+    ElastiqueProOptions options;
+    bool realtime = false;
+
+    bool operator== (const PoolKey& other) const
+    {
+        return sampleRate == other.sampleRate
+            && samplesPerBlock == other.samplesPerBlock
+            && numChannels == other.numChannels
+            && mode == other.mode
+            && options == other.options
+            && realtime == other.realtime;
+    }
+};
+
+static std::unique_ptr<TimeStretcher::Stretcher> createStretcher (const TimeStretcher::PoolKey& key)
+{
+    CRASH_TRACER
+    std::unique_ptr<TimeStretcher::Stretcher> stretcher;
+
+   #if TRACKTION_ENABLE_TIMESTRETCH_ELASTIQUE || TRACKTION_ENABLE_TIMESTRETCH_SOUNDTOUCH
+    switch (key.mode)
+    {
+       #if TRACKTION_ENABLE_TIMESTRETCH_ELASTIQUE
+        case TimeStretcher::elastiquePro:
+        case TimeStretcher::elastiqueEfficient:
+        case TimeStretcher::elastiqueMobile:
+        case TimeStretcher::elastiqueMonophonic:
+            stretcher.reset (new ElastiqueStretcher (key.sampleRate, key.samplesPerBlock, key.numChannels,
+                                                     key.mode, key.options, key.realtime ? 0.25f : 0.1f));
+            break;
+       #endif
+
+       #if TRACKTION_ENABLE_TIMESTRETCH_SOUNDTOUCH
+        case TimeStretcher::soundtouchNormal:
+        case TimeStretcher::soundtouchBetter:
+            stretcher.reset (new SoundTouchStretcher (key.sampleRate, key.samplesPerBlock, key.numChannels,
+                                                      key.mode == TimeStretcher::soundtouchBetter));
+            break;
+       #endif
+
+        default:
+            break;
+    }
+   #else
+    juce::ignoreUnused (key);
+   #endif
+
+    if (stretcher != nullptr && ! stretcher->isOk())
+        stretcher.reset();
+
+    return stretcher;
+}
+
+//==============================================================================
+/**
+    Keeps spare Stretchers for the settings that have been asked for, so initialising
+    a TimeStretcher doesn't have to construct one.
+
+    Stretchers are created on a background thread, and ones that are finished with are
+    reset and kept for the next TimeStretcher with the same settings. Taking one only
+    locks a SpinLock and pops it from a pre-allocated list.
+*/
+class TimeStretcher::Pool  : private juce::Thread,
+                            private juce::DeletedAtShutdown
+{
+public:
+    Pool() : Thread ("TimeStretcher Pool") {}
+
+    ~Pool() override
+    {
+        stopThread (10000);
+        clearSingletonInstance();
+    }
+
+    JUCE_DECLARE_SINGLETON (Pool, false)
+
+    /** Returns a spare Stretcher with these settings, or nullptr if there aren't any ready.
+        Either way, more get created in the background for next time.
+    */
+    std::unique_ptr<Stretcher> take (const PoolKey& key, int numToKeepReady)
+    {
+        std::unique_ptr<Stretcher> stretcher;
+
+        {
+            const juce::SpinLock::ScopedLockType sl (lock);
+
+            if (auto entry = findEntry (key))
+            {
+                if (! entry->spares.empty())
+                {
+                    stretcher = std::move (entry->spares.back());
+                    entry->spares.pop_back();
+                }
+
+                entry->numToKeep = juce::jmax (entry->numToKeep, numToKeepReady);
+            }
+        }
+
+        if (stretcher == nullptr)
+            ensureReady (key, numToKeepReady);
+        else
+            notify();
+
+        return stretcher;
+    }
+
+    /** Keeps a Stretcher that's finished with if there's room for it. */
+    void giveBack (const PoolKey& key, std::unique_ptr<Stretcher> stretcher)
+    {
+        stretcher->reset();
+
+        {
+            const juce::SpinLock::ScopedLockType sl (lock);
+
+            if (auto entry = findEntry (key))
+            {
+                if ((int) entry->spares.size() < maxNumSpares)
+                {
+                    entry->spares.push_back (std::move (stretcher));
+                    return;
+                }
+            }
+        }
+
+        // Deleted outside the lock as this could take a while
+        stretcher.reset();
+    }
+
+    /** Makes sure at least this many Stretchers with these settings will be kept ready. */
+    void ensureReady (const PoolKey& key, int numToKeepReady)
+    {
+        numToKeepReady = juce::jlimit (0, maxNumSpares, numToKeepReady);
+
+        {
+            const juce::SpinLock::ScopedLockType sl (lock);
+
+            if (auto entry = findEntry (key))
+            {
+                entry->numToKeep = juce::jmax (entry->numToKeep, numToKeepReady);
+            }
+            else
+            {
+                auto newEntry = std::make_unique<Entry>();
+                newEntry->key = key;
+                newEntry->numToKeep = numToKeepReady;
+                newEntry->spares.reserve ((size_t) maxNumSpares);
+                entries.push_back (std::move (newEntry));
+            }
+        }
+
+        startThread (3);
+        notify();
+    }
+
+private:
+    struct Entry
+    {
+        PoolKey key;
+        int numToKeep = 0;
+        std::vector<std::unique_ptr<Stretcher>> spares;
+    };
+
+    static constexpr int maxNumSpares = 4;
+
+    juce::SpinLock lock;
+    std::vector<std::unique_ptr<Entry>> entries;
+
+    Entry* findEntry (const PoolKey& key) const
+    {
+        for (auto& e : entries)
+            if (e->key == key)
+                return e.get();
+
+        return nullptr;
+    }
+
+    void run() override
+    {
+        while (! threadShouldExit())
+        {
+            PoolKey keyToCreate;
+            bool needsCreating = false;
+
+            {
+                const juce::SpinLock::ScopedLockType sl (lock);
+
+                for (auto& e : entries)
+                {
+                    if ((int) e->spares.size() < e->numToKeep)
+                    {
+                        keyToCreate = e->key;
+                        needsCreating = true;
+                        break;
+                    }
+                }
+            }
+
+            if (! needsCreating)
+            {
+                wait (-1);
+                continue;
+            }
+
+            auto stretcher = createStretcher (keyToCreate);
+
+            if (stretcher == nullptr)
+            {
+                // These settings can't be created so don't keep trying
+                const juce::SpinLock::ScopedLockType sl (lock);
+
+                if (auto entry = findEntry (keyToCreate))
+                    entry->numToKeep = 0;
+
+                continue;
+            }
+
+            giveBack (keyToCreate, std::move (stretcher));
+        }
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (Pool)
+};
+
+JUCE_IMPLEMENT_SINGLETON (TimeStretcher::Pool)
+
 //==============================================================================
 TimeStretcher::TimeStretcher() {}
-TimeStretcher::~TimeStretcher() {}
+
+TimeStretcher::~TimeStretcher()
+{
+    returnStretcherToPool();
+}
+
+void TimeStretcher::returnStretcherToPool()
+{
+    if (stretcher != nullptr)
+        if (auto pool = Pool::getInstanceWithoutCreating())
+            pool->giveBack (*poolKey, std::move (stretcher));
+
+    stretcher.reset();
+}
+
+void TimeStretcher::prepareStretchers (double sourceSampleRate, int samplesPerBlock, int numChannels,
+                                       Mode mode, ElastiqueProOptions options, bool realtime, int numToKeepReady)
+{
+    if (! canProcessFor (mode) || isMelodyne (mode))
+        return;
+
+    PoolKey key { sourceSampleRate, samplesPerBlock, numChannels, mode, options, realtime };
+    Pool::getInstance()->ensureReady (key, numToKeepReady);
+}
 
 static juce::String getMelodyne()             { return "Melodyne"; }
 static juce::String getElastiquePro()         { return "Elastique (" + TRANS("Pro") + ")"; }
@@ -456,44 +711,24 @@ bool TimeStretcher::isInitialised() const
 void TimeStretcher::initialise (double sourceSampleRate, int samplesPerBlock,
                                 int numChannels, Mode mode, ElastiqueProOptions options, bool realtime)
 {
-    juce::ignoreUnused (sourceSampleRate, numChannels, mode, options, realtime);
     jassert (! isMelodyne (mode));
 
     samplesPerBlockRequested = samplesPerBlock;
 
     CRASH_TRACER
     jassert (stretcher == nullptr);
+    returnStretcherToPool();
 
-   #if TRACKTION_ENABLE_TIMESTRETCH_ELASTIQUE || TRACKTION_ENABLE_TIMESTRETCH_SOUNDTOUCH
-    switch (mode)
-    {
-       #if TRACKTION_ENABLE_TIMESTRETCH_ELASTIQUE
-        case elastiquePro:
-        case elastiqueEfficient:
-        case elastiqueMobile:
-        case elastiqueMonophonic:
-            stretcher.reset (new ElastiqueStretcher (sourceSampleRate, samplesPerBlock, numChannels,
-                                                     mode, options, realtime ? 0.25f : 0.1f));
-            break;
-       #endif
+    if (! canProcessFor (mode) || isMelodyne (mode))
+        return;
 
-       #if TRACKTION_ENABLE_TIMESTRETCH_SOUNDTOUCH
-        case soundtouchNormal:
-        case soundtouchBetter:
-            juce::ignoreUnused (options, realtime);
-            stretcher.reset (new SoundTouchStretcher (sourceSampleRate, samplesPerBlock, numChannels,
-                                                      mode == soundtouchBetter));
-            break;
-       #endif
+    poolKey = std::make_unique<PoolKey> (PoolKey { sourceSampleRate, samplesPerBlock, numChannels, mode, options, realtime });
 
-        default:
-            break;
-    }
-   #endif
+    // Nodes tend to be rebuilt with the same settings, so a couple are kept ready after the first one
+    stretcher = Pool::getInstance()->take (*poolKey, 2);
 
-    if (stretcher != nullptr)
-        if (! stretcher->isOk())
-            stretcher.reset();
+    if (stretcher == nullptr)
+        stretcher = createStretcher (*poolKey);
 }
 
 bool TimeStretcher::canProcessFor (const Mode mode)
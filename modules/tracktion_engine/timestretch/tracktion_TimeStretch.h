@@ -61,9 +61,19 @@ public:
     static juce::String getNameOfMode (Mode mode);
     static bool isMelodyne (Mode mode);
 
+    /** Gets the stretcher ready to use.
+        If a spare one with the same settings has already been created by the pool it's used,
+        otherwise one is created here and the pool starts keeping some ready for next time.
+    */
     void initialise (double sourceSampleRate, int samplesPerBlock,
                      int numChannels, Mode mode, ElastiqueProOptions options, bool realtime);
 
+    /** Asks for this many stretchers with the given settings to be created on a background
+        thread, so that TimeStretchers initialised with them later don't have to allocate.
+    */
+    static void prepareStretchers (double sourceSampleRate, int samplesPerBlock, int numChannels,
+                                   Mode, ElastiqueProOptions, bool realtime, int numToKeepReady);
+
     bool isInitialised() const;
     void reset();
     bool setSpeedAndPitch (float speedRatio, float semitones);
@@ -77,11 +87,16 @@ public:
     void flush (float* const* outChannels);
 
     struct Stretcher;
+    struct PoolKey;
+    class Pool;
 
 private:
+    std::unique_ptr<PoolKey> poolKey;
     std::unique_ptr<Stretcher> stretcher;
     int samplesPerBlockRequested = 0;
 
+    void returnStretcherToPool();
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TimeStretcher)
 };
 
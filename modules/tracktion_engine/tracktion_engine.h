@@ -142,13 +142,40 @@
  #define TRACKTION_UNIT_TESTS 0
 #endif
 
+/** Config: TRACKTION_ENABLE_CRASH_TRACER
+    Keeps a stack of the CRASH_TRACER locations on each thread, which is logged if a crash happens.
+    Each thread has its own preallocated stack, so this is cheap enough to leave on in release builds.
+*/
+#ifndef TRACKTION_ENABLE_CRASH_TRACER
+ #define TRACKTION_ENABLE_CRASH_TRACER 1
+#endif
+
+/** Config: TRACKTION_TRACE_EVENTS
+    Lets the SCOPED_REALTIME_CHECK, CRASH_TRACER and TRACKTION_TRACE_SCOPE scopes be recorded
+    with TraceEvents. Nothing is recorded until TraceEvents::start() is called, so this can
+    be left on, but disabling it removes the scopes' checks altogether.
+*/
+#ifndef TRACKTION_TRACE_EVENTS
+ #define TRACKTION_TRACE_EVENTS 1
+#endif
+
 /** Config: TRACKTION_CHECK_FOR_SLOW_RENDERING
     Enabling this adds additional checks to the audio pipeline to help debug performance problems if operations take longer than real time.
+    The SCOPED_REALTIME_CHECK scopes that overrun are logged whilst TraceEvents are being recorded.
 */
 #ifndef TRACKTION_CHECK_FOR_SLOW_RENDERING
  #define TRACKTION_CHECK_FOR_SLOW_RENDERING 0
 #endif
 
+/** Config: TRACKTION_TRACK_REALTIME_ALLOCATIONS
+    Replaces the global operator new and delete so that RealtimeAllocationTracker can record
+    the call stacks of any allocations made whilst rendering audio. This is slow, so is only
+    intended for debugging and profiling builds.
+*/
+#ifndef TRACKTION_TRACK_REALTIME_ALLOCATIONS
+ #define TRACKTION_TRACK_REALTIME_ALLOCATIONS 0
+#endif
+
 /** Config: TRACKTION_AIR_WINDOWS
     Adds AirWindows effect plugins. Requires complaiance with AirWindows MIT license.
  */
@@ -185,6 +212,7 @@ namespace tracktion_engine
 {
     class Engine;
     class DeviceManager;
+    class RealtimeWorkerPool;
     class MidiProgramManager;
     class GrooveTemplateManager;
     class Edit;
@@ -196,6 +224,7 @@ namespace tracktion_engine
     class AudioFile;
     class PlayHead;
     class Project;
+    class ProjectLibraryIndexer;
     class InputDevice;
     class OutputDevice;
     class WaveInputDevice;
@@ -210,15 +239,18 @@ namespace tracktion_engine
     struct TrackInsertPoint;
     struct TrackList;
     class TrackCompManager;
+    class SourceFileCache;
     class CompFactory;
     class WarpTimeFactory;
     class TempoSequence;
     class TempoSequencePosition;
+    struct EditTimecodeRemapperSnapshot;
     class WarpTimeManager;
     class ControlSurface;
     struct AudioFileInfo;
     class LoopInfo;
     class RenderOptions;
+    class RenderSink;
     class AutomatableParameter;
     class AutomatableParameterTree;
     class MacroParameterList;
@@ -267,6 +299,8 @@ namespace tracktion_engine
     class AutomatableEditItem;
     class RecordingThumbnailManager;
     class WaveInputRecordingThread;
+    class MemoryGovernor;
+    class AudioSettingsTuner;
     class SearchOperation;
     class ProjectManager;
     class ExternalAutomatableParameter;
@@ -301,9 +335,13 @@ namespace tracktion_engine
 #include "utilities/tracktion_AppFunctions.h"
 #include "utilities/tracktion_Identifiers.h"
 #include "utilities/tracktion_ValueTreeUtilities.h"
+#include "utilities/tracktion_TraceEvents.h"
 #include "utilities/tracktion_CrashTracer.h"
 #include "utilities/tracktion_AsyncFunctionUtils.h"
 #include "utilities/tracktion_CpuMeasurement.h"
+#include "utilities/tracktion_RealtimeAllocationTracker.h"
+#include "utilities/tracktion_MemoryUsage.h"
+#include "utilities/tracktion_MemoryGovernor.h"
 #include "utilities/tracktion_ConstrainedCachedValue.h"
 #include "utilities/tracktion_FileUtilities.h"
 #include "utilities/tracktion_AudioUtilities.h"
@@ -311,6 +349,9 @@ namespace tracktion_engine
 #include "utilities/tracktion_AudioFadeCurve.h"
 #include "utilities/tracktion_Spline.h"
 #include "utilities/tracktion_Ditherer.h"
+#include "utilities/tracktion_SincResampler.h"
+#include "utilities/tracktion_VariableRateResampler.h"
+#include "utilities/tracktion_ClockDriftSmoother.h"
 #include "utilities/tracktion_ExternalPlayheadSynchroniser.h"
 #include "selection/tracktion_Selectable.h"
 #include "selection/tracktion_SelectableClass.h"
@@ -326,6 +367,8 @@ namespace tracktion_engine
 #include "utilities/tracktion_CurveEditor.h"
 #include "utilities/tracktion_Envelope.h"
 #include "utilities/tracktion_Oscillators.h"
+#include "utilities/tracktion_Convolution.h"
+#include "utilities/tracktion_Oversampler.h"
 
 #include "project/tracktion_ProjectItemID.h"
 
@@ -366,6 +409,7 @@ namespace tracktion_engine
 #include "project/tracktion_ProjectItem.h"
 #include "project/tracktion_ProjectSearchIndex.h"
 #include "project/tracktion_Project.h"
+#include "project/tracktion_ProjectLibraryIndexer.h"
 #include "project/tracktion_ProjectManager.h"
 
 #include "utilities/tracktion_PropertyStorage.h"
@@ -454,10 +498,13 @@ namespace tracktion_engine
 #include "model/export/tracktion_ArchiveFile.h"
 #include "model/export/tracktion_ExportJob.h"
 #include "model/export/tracktion_ReferencedMaterialList.h"
+#include "model/export/tracktion_RenderSink.h"
 #include "model/export/tracktion_Renderer.h"
 #include "model/export/tracktion_RenderManager.h"
 
 #include "playback/audionodes/tracktion_WaveAudioNode.h"
+#include "playback/audionodes/tracktion_SlicedAudioNode.h"
+#include "playback/audionodes/tracktion_MidiAudioNode.h"
 
 #include "model/edit/tracktion_QuantisationType.h"
 
@@ -483,6 +530,7 @@ namespace tracktion_engine
 
 #include "playback/audionodes/tracktion_FadeInOutAudioNode.h"
 #include "playback/audionodes/tracktion_TimedMutingAudioNode.h"
+#include "playback/audionodes/tracktion_CompTimelineAudioNode.h"
 
 #include "model/tracks/tracktion_TrackUtils.h"
 #include "model/tracks/tracktion_ArrangerTrack.h"
@@ -493,6 +541,7 @@ namespace tracktion_engine
 #include "model/tracks/tracktion_TempoTrack.h"
 #include "model/tracks/tracktion_TrackCompManager.h"
 #include "model/export/tracktion_RenderOptions.h"
+#include "model/export/tracktion_RenderWorker.h"
 #include "model/clips/tracktion_EditClipRenderJob.h"
 
 #include "playback/devices/tracktion_InputDevice.h"
@@ -507,18 +556,23 @@ namespace tracktion_engine
  #include "playback/tracktion_ScopedSteadyLoad.h"
 #endif
 
+#include "../tracktion_graph/utilities/tracktion_ThreadUtilities.h"
+#include "playback/tracktion_RealtimeWorkerPool.h"
+#include "playback/tracktion_CallbackTimingStatistics.h"
 #include "playback/tracktion_DeviceManager.h"
+#include "playback/tracktion_AudioSettingsTuner.h"
 #include "playback/tracktion_HostedAudioDevice.h"
 #include "playback/tracktion_MidiNoteDispatcher.h"
 #include "playback/tracktion_EditPlaybackContext.h"
 #include "playback/tracktion_EditInputDevices.h"
+#include "playback/tracktion_ReplayHarness.h"
 
+#include "playback/audionodes/tracktion_AnticipativeAudioNode.h"
 #include "playback/audionodes/tracktion_BufferingAudioNode.h"
 #include "playback/audionodes/tracktion_ClickNode.h"
 #include "playback/audionodes/tracktion_ClickMutingNode.h"
 #include "playback/audionodes/tracktion_CombiningAudioNode.h"
 #include "playback/audionodes/tracktion_HissingAudioNode.h"
-#include "playback/audionodes/tracktion_MidiAudioNode.h"
 #include "playback/audionodes/tracktion_MixerAudioNode.h"
 #include "playback/audionodes/tracktion_PlayHeadAudioNode.h"
 #include "playback/audionodes/tracktion_SidechainAudioNode.h"
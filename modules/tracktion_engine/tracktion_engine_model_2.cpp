@@ -11,10 +11,20 @@
 #if ! JUCE_PROJUCER_LIVE_BUILD
 
 #include <future>
+
+#if ENABLE_EXPERIMENTAL_TRACKTION_GRAPH
+ #include <tracktion_graph/tracktion_graph.h>
+#endif
+
 #include "tracktion_engine.h"
 
 using namespace juce;
 
+#if ENABLE_EXPERIMENTAL_TRACKTION_GRAPH
+ #include "playback/graph/tracktion_engine_RackNode.h"
+ #include "playback/graph/tracktion_engine_AudioNodeWrapper.h"
+#endif
+
 #include "model/tracks/tracktion_TrackUtils.cpp"
 #include "model/tracks/tracktion_Track.cpp"
 #include "model/tracks/tracktion_FolderTrack.cpp"
@@ -45,10 +55,12 @@ using namespace juce;
 
 #include "model/export/tracktion_Exportable.cpp"
 #include "model/export/tracktion_ExportJob.cpp"
+#include "model/export/tracktion_RenderSink.cpp"
 #include "model/export/tracktion_Renderer.cpp"
 #include "model/export/tracktion_RenderManager.cpp"
 #include "model/export/tracktion_ArchiveFile.cpp"
 #include "model/export/tracktion_RenderOptions.cpp"
+#include "model/export/tracktion_RenderWorker.cpp"
 #include "model/clips/tracktion_EditClipRenderJob.cpp"
 #include "model/clips/tracktion_AudioSegmentList.cpp"
 #include "audio_files/tracktion_LoopInfo.cpp"
@@ -58,5 +70,6 @@ using namespace juce;
 #include "project/tracktion_Project.cpp"
 #include "project/tracktion_ProjectManager.cpp"
 #include "project/tracktion_ProjectSearchIndex.cpp"
+#include "project/tracktion_ProjectLibraryIndexer.cpp"
 
 #endif
@@ -40,6 +40,10 @@ extern "C"
 
 #define JUCE_CORE_INCLUDE_JNI_HELPERS 1 // Required for Ableton Link on Android
 
+#if ENABLE_EXPERIMENTAL_TRACKTION_GRAPH
+ #include <tracktion_graph/tracktion_graph.h>
+#endif
+
 #include "tracktion_engine.h"
 
 #if JUCE_LINUX || JUCE_WINDOWS
@@ -50,7 +54,15 @@ extern "C"
 
 using namespace juce;
 
+#if ENABLE_EXPERIMENTAL_TRACKTION_GRAPH
+ #include "playback/graph/tracktion_engine_RackNode.h"
+ #include "playback/graph/tracktion_engine_AudioNodeWrapper.h"
+#endif
+
+#include "playback/tracktion_RealtimeWorkerPool.cpp"
+#include "playback/tracktion_CallbackTimingStatistics.cpp"
 #include "playback/tracktion_DeviceManager.cpp"
+#include "playback/tracktion_AudioSettingsTuner.cpp"
 #include "playback/tracktion_EditPlaybackContext.cpp"
 #include "playback/tracktion_EditInputDevices.cpp"
 #include "playback/tracktion_LevelMeasurer.cpp"
@@ -61,15 +73,18 @@ using namespace juce;
 
 #include "playback/tracktion_MPEStartTrimmer.h"
 
+#include "playback/audionodes/tracktion_AnticipativeAudioNode.cpp"
 #include "playback/audionodes/tracktion_AudioNode.cpp"
 #include "playback/audionodes/tracktion_BufferingAudioNode.cpp"
 #include "playback/audionodes/tracktion_ClickNode.cpp"
 #include "playback/audionodes/tracktion_CombiningAudioNode.cpp"
+#include "playback/audionodes/tracktion_CompTimelineAudioNode.cpp"
 #include "playback/audionodes/tracktion_FadeInOutAudioNode.cpp"
 #include "playback/audionodes/tracktion_HissingAudioNode.cpp"
 #include "playback/audionodes/tracktion_MidiAudioNode.cpp"
 #include "playback/audionodes/tracktion_MixerAudioNode.cpp"
 #include "playback/audionodes/tracktion_PlayHeadAudioNode.cpp"
+#include "playback/audionodes/tracktion_SlicedAudioNode.cpp"
 #include "playback/audionodes/tracktion_WaveAudioNode.cpp"
 
 #include "playback/devices/tracktion_InputDevice.cpp"
@@ -83,6 +98,7 @@ using namespace juce;
 #include "playback/devices/tracktion_WaveOutputDevice.cpp"
 
 #include "playback/tracktion_HostedAudioDevice.cpp"
+#include "playback/tracktion_ReplayHarness.cpp"
 
 static inline void sprintf (char* dest, size_t maxLength, const char* format, ...) noexcept
 {
@@ -42,12 +42,14 @@ using namespace juce;
 
 #include "plugins/tracktion_Plugin.cpp"
 #include "plugins/tracktion_PluginList.cpp"
+#include "plugins/external/tracktion_SandboxedPlugin.h"
 #include "plugins/tracktion_PluginManager.cpp"
 #include "plugins/tracktion_PluginWindowState.cpp"
 
 #include "plugins/external/tracktion_ExternalAutomatableParameter.h"
 #include "plugins/external/tracktion_ExternalPluginBlacklist.h"
 #include "plugins/external/tracktion_ExternalPlugin.cpp"
+#include "plugins/external/tracktion_SandboxedPlugin.cpp"
 
 #include "plugins/internal/tracktion_AuxReturn.cpp"
 #include "plugins/internal/tracktion_AuxSend.cpp"
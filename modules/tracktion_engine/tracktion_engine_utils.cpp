@@ -61,16 +61,24 @@ using namespace juce;
 
 #include "utilities/tracktion_AppFunctions.cpp"
 #include "utilities/tracktion_AudioUtilities.cpp"
+#include "utilities/tracktion_ClockDriftSmoother.cpp"
 #include "utilities/tracktion_ConstrainedCachedValue.cpp"
 #include "utilities/tracktion_CrashTracer.cpp"
+#include "utilities/tracktion_Convolution.cpp"
 #include "utilities/tracktion_CurveEditor.cpp"
 #include "utilities/tracktion_ExternalPlayheadSynchroniser.cpp"
 #include "utilities/tracktion_Envelope.cpp"
 #include "utilities/tracktion_FileUtilities.cpp"
+#include "utilities/tracktion_MemoryGovernor.cpp"
+#include "utilities/tracktion_MemoryUsage.cpp"
 #include "utilities/tracktion_Oscillators.cpp"
+#include "utilities/tracktion_Oversampler.cpp"
 #include "utilities/tracktion_PropertyStorage.cpp"
+#include "utilities/tracktion_RealtimeAllocationTracker.cpp"
+#include "utilities/tracktion_SincResampler.cpp"
 #include "utilities/tracktion_UIBehaviour.cpp"
 #include "utilities/tracktion_TemporaryFileManager.cpp"
+#include "utilities/tracktion_TraceEvents.cpp"
 #include "utilities/tracktion_Engine.cpp"
 #include "utilities/tracktion_BinaryData.cpp"
 
@@ -112,6 +112,12 @@ struct AudioFadeCurve
         }
     }
 
+    /** Fills an array with the gains along a curve between two alpha-positions, in the same
+        steps as renderBlock(). Rather than calling sin and cos each sample, the curved shapes
+        are interpolated from lookup tables shared by every fade, in a loop that vectorises.
+    */
+    static void getGains (Type, float* gains, int numSamples, float startAlpha, float endAlpha) noexcept;
+
     /** Calculates the two gain multipliers to use for mixing between two sources, given a position
         alpha from 0 to 1.0.
 
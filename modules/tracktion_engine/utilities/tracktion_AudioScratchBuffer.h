@@ -11,11 +11,25 @@
 namespace tracktion_engine
 {
 
+/**
+    A temporary audio buffer for use whilst rendering.
+
+    Each thread has its own arena that these are taken from and given back to in
+    order, so creating one doesn't take a lock or allocate. They must be created on
+    the stack and not passed between threads.
+
+    The arena grows to the size set by prepare() when a thread's arena is next empty,
+    so that's the only time it allocates. Anything that doesn't fit falls back to a
+    shared pool of larger buffers.
+*/
 class AudioScratchBuffer
 {
     struct BufferList;
     struct Buffer;
-    Buffer* allocatedBuffer; // NB: keep this member first, as it needs to be initialised before buffer.
+    struct Arena;
+    Buffer* allocatedBuffer = nullptr; // NB: keep these members first, as they need to be initialised before buffer.
+    size_t numArenaFloats = 0;
+    juce::AudioBuffer<float> arenaBuffer;
 
 public:
     AudioScratchBuffer (int numChans, int numSamples);
@@ -24,7 +38,18 @@ public:
 
     juce::AudioBuffer<float>& buffer;
 
+    /** Makes sure the arenas can hold a few nested buffers of this size.
+        Call this when preparing to play, not from the audio thread.
+        The size only ever goes up.
+    */
+    static void prepare (int maxNumChannels, int maxBlockSize);
+
+    /** Returns the memory allocated for all the threads' arenas and the shared pool. */
+    static size_t getNumBytesAllocated();
+
 private:
+    juce::AudioBuffer<float>& getBuffer (int numChans, int numSamples);
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AudioScratchBuffer)
 };
 
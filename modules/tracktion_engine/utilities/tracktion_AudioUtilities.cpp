@@ -330,27 +330,95 @@ void convertFloatsToInts (juce::AudioBuffer<float>& buffer)
 }
 
 //==============================================================================
-struct OneChannelDestination
+namespace FadeCurveHelpers
 {
-    float* channel0;
+    /** The curved fade shapes, sampled at evenly spaced alphas. */
+    struct Tables
+    {
+        static constexpr int size = 1024;
+
+        Tables() noexcept
+        {
+            for (int i = 0; i <= size; ++i)
+            {
+                const auto alpha = i / (float) size;
+                convex[i]  = AudioFadeCurve::alphaToGain<AudioFadeCurve::Convex>  (alpha);
+                concave[i] = AudioFadeCurve::alphaToGain<AudioFadeCurve::Concave> (alpha);
+                sCurve[i]  = AudioFadeCurve::alphaToGain<AudioFadeCurve::SCurve>  (alpha);
+            }
+
+            // An extra point past the end means interpolating at an alpha of 1 doesn't need a check
+            convex[size + 1]  = convex[size];
+            concave[size + 1] = concave[size];
+            sCurve[size + 1]  = sCurve[size];
+        }
+
+        const float* get (AudioFadeCurve::Type type) const noexcept
+        {
+            switch (type)
+            {
+                case AudioFadeCurve::convex:    return convex;
+                case AudioFadeCurve::concave:   return concave;
+                case AudioFadeCurve::sCurve:    return sCurve;
+                case AudioFadeCurve::linear:
+                default:                        return nullptr;
+            }
+        }
 
-    inline void apply (float value) noexcept
+        float convex[size + 2], concave[size + 2], sCurve[size + 2];
+    };
+
+    static const Tables& getTables() noexcept
     {
-        *channel0++ *= value;
+        static const Tables tables;
+        return tables;
     }
-};
 
-struct TwoChannelDestination
+    /** The fades are applied in chunks of this many gains, so they fit on the stack. */
+    static constexpr int chunkSize = 256;
+
+    /** Calls fn with each chunk's gains and its offset from the start. */
+    template<typename Fn>
+    static void forEachChunk (AudioFadeCurve::Type type, int numSamples, float startAlpha, float endAlpha, Fn&& fn) noexcept
+    {
+        float gains[chunkSize];
+        const auto delta = (endAlpha - startAlpha) / (float) numSamples;
+
+        for (int offset = 0; offset < numSamples; offset += chunkSize)
+        {
+            const int num = std::min (chunkSize, numSamples - offset);
+            AudioFadeCurve::getGains (type, gains, num, startAlpha + delta * (float) offset, startAlpha + delta * (float) (offset + num));
+            fn (gains, offset, num);
+        }
+    }
+}
+
+void AudioFadeCurve::getGains (Type type, float* gains, int numSamples, float startAlpha, float endAlpha) noexcept
 {
-    float* channel0;
-    float* channel1;
+    jassert (numSamples > 0);
+    const auto delta = (endAlpha - startAlpha) / (float) numSamples;
+    auto table = FadeCurveHelpers::getTables().get (type);
+
+    if (table == nullptr)
+    {
+        jassert (type == linear);
 
-    inline void apply (float value) noexcept
+        for (int i = 0; i < numSamples; ++i)
+            gains[i] = startAlpha + delta * (float) i;
+
+        return;
+    }
+
+    constexpr auto size = (float) FadeCurveHelpers::Tables::size;
+
+    for (int i = 0; i < numSamples; ++i)
     {
-        *channel0++ *= value;
-        *channel1++ *= value;
+        const auto pos = jlimit (0.0f, size, (startAlpha + delta * (float) i) * size);
+        const auto index = (int) pos;
+        const auto proportion = pos - (float) index;
+        gains[i] = table[index] + proportion * (table[index + 1] - table[index]);
     }
-};
+}
 
 void AudioFadeCurve::applyCrossfadeSection (juce::AudioBuffer<float>& buffer,
                                             int channel, int startSample, int numSamples,
@@ -358,10 +426,14 @@ void AudioFadeCurve::applyCrossfadeSection (juce::AudioBuffer<float>& buffer,
 {
     jassert (startSample >= 0 && startSample + numSamples <= buffer.getNumSamples());
 
-    if (! buffer.hasBeenCleared())
+    if (! buffer.hasBeenCleared() && numSamples > 0)
     {
-        OneChannelDestination d = { buffer.getWritePointer (channel, startSample) };
-        AudioFadeCurve::renderBlockForType (d, numSamples, startAlpha, endAlpha, type);
+        auto dest = buffer.getWritePointer (channel, startSample);
+
+        FadeCurveHelpers::forEachChunk (type, numSamples, startAlpha, endAlpha, [dest] (const float* gains, int offset, int num)
+        {
+            FloatVectorOperations::multiply (dest + offset, gains, num);
+        });
     }
 }
 
@@ -371,34 +443,20 @@ void AudioFadeCurve::applyCrossfadeSection (juce::AudioBuffer<float>& buffer,
 {
     jassert (startSample >= 0 && startSample + numSamples <= buffer.getNumSamples() && numSamples > 0);
 
-    if (! buffer.hasBeenCleared())
+    if (! buffer.hasBeenCleared() && numSamples > 0)
     {
-        if (buffer.getNumChannels() == 2)
-        {
-            TwoChannelDestination d = { buffer.getWritePointer (0, startSample),
-                                        buffer.getWritePointer (1, startSample) };
+        // Each chunk's gains are worked out once and applied to all the channels
+        auto channels = buffer.getArrayOfWritePointers();
+        const int numChannels = buffer.getNumChannels();
 
-            AudioFadeCurve::renderBlockForType (d, numSamples, startAlpha, endAlpha, type);
-        }
-        else
+        FadeCurveHelpers::forEachChunk (type, numSamples, startAlpha, endAlpha, [=] (const float* gains, int offset, int num)
         {
-            for (int i = buffer.getNumChannels(); --i >= 0;)
-                applyCrossfadeSection (buffer, i, startSample, numSamples, type, startAlpha, endAlpha);
-        }
+            for (int i = 0; i < numChannels; ++i)
+                FloatVectorOperations::multiply (channels[i] + startSample + offset, gains, num);
+        });
     }
 }
 
-struct AddingFadeApplier
-{
-    float* dest;
-    const float* src;
-
-    inline void apply (float value) noexcept
-    {
-        *dest++ += *src++ * value;
-    }
-};
-
 void AudioFadeCurve::addWithCrossfade (juce::AudioBuffer<float>& dest,
                                        const juce::AudioBuffer<float>& src,
                                        int destChannel, int destStartIndex,
@@ -414,12 +472,15 @@ void AudioFadeCurve::addWithCrossfade (juce::AudioBuffer<float>& dest,
         {
             dest.addFrom (destChannel, destStartIndex, src, sourceChannel, sourceStartIndex, numSamples, endAlpha);
         }
-        else
+        else if (numSamples > 0)
         {
-            AddingFadeApplier d = { dest.getWritePointer (destChannel, destStartIndex),
-                                    src.getReadPointer (sourceChannel, sourceStartIndex) };
+            auto d = dest.getWritePointer (destChannel, destStartIndex);
+            auto s = src.getReadPointer (sourceChannel, sourceStartIndex);
 
-            AudioFadeCurve::renderBlockForType (d, numSamples, startAlpha, endAlpha, type);
+            FadeCurveHelpers::forEachChunk (type, numSamples, startAlpha, endAlpha, [d, s] (const float* gains, int offset, int num)
+            {
+                FloatVectorOperations::addWithMultiply (d + offset, s + offset, gains, num);
+            });
         }
     }
 }
@@ -466,13 +527,15 @@ struct AudioScratchBuffer::Buffer
 {
     juce::AudioBuffer<float> buffer { 2, 41000 };
     std::atomic<bool> isFree { true };
+    std::atomic<size_t> numBytes { 2 * 41000 * sizeof (float) };
 };
 
 struct AudioScratchBuffer::BufferList   : private DeletedAtShutdown
 {
     BufferList()
     {
-        for (int i = 8; --i >= 0;)
+        // These are only used for buffers that won't fit in a thread's arena
+        for (int i = 2; --i >= 0;)
             buffers.add (new Buffer());
     }
 
@@ -506,6 +569,17 @@ struct AudioScratchBuffer::BufferList   : private DeletedAtShutdown
         return newBuffer;
     }
 
+    size_t getNumBytes()
+    {
+        const ScopedLock sl (lock);
+        size_t total = 0;
+
+        for (auto b : buffers)
+            total += b->numBytes;
+
+        return total;
+    }
+
     CriticalSection lock;
     OwnedArray<Buffer> buffers;
 
@@ -514,29 +588,136 @@ struct AudioScratchBuffer::BufferList   : private DeletedAtShutdown
 
 JUCE_IMPLEMENT_SINGLETON (AudioScratchBuffer::BufferList)
 
+//==============================================================================
+/** A stack of samples that a thread's scratch buffers are taken from in order. */
+struct AudioScratchBuffer::Arena
+{
+    // Channels start on 64-byte boundaries so they suit SIMD loads
+    static size_t getChannelStride (int numSamples) noexcept    { return ((size_t) numSamples + 15) & ~(size_t) 15; }
+
+    static Arena& getForThisThread() noexcept
+    {
+        static thread_local Arena arena;
+        return arena;
+    }
+
+    Arena() = default;
+
+    ~Arena()
+    {
+        totalBytes -= getNumBytes();
+    }
+
+    float* allocate (size_t numFloats) noexcept
+    {
+        if (used == 0 && capacity < requiredSize.load())
+        {
+            totalBytes -= getNumBytes();
+            capacity = requiredSize.load();
+            totalBytes += getNumBytes();
+            data.malloc (capacity + 16);
+            start = reinterpret_cast<float*> ((reinterpret_cast<juce::pointer_sized_uint> (data.get()) + 63) & ~(juce::pointer_sized_uint) 63);
+        }
+
+        if (used + numFloats > capacity)
+            return nullptr;
+
+        auto d = start + used;
+        used += numFloats;
+        return d;
+    }
+
+    void release (const float* d, size_t numFloats) noexcept
+    {
+        juce::ignoreUnused (d);
+        jassert (used >= numFloats && d == start + (used - numFloats)); // scratch buffers must be released in the reverse order to which they were created
+        used -= numFloats;
+    }
+
+    size_t getNumBytes() const noexcept     { return capacity > 0 ? (capacity + 16) * sizeof (float) : 0; }
+
+    static std::atomic<size_t> requiredSize, totalBytes;
+
+    juce::HeapBlock<float> data;
+    float* start = nullptr;
+    size_t capacity = 0, used = 0;
+};
+
+std::atomic<size_t> AudioScratchBuffer::Arena::requiredSize { 8 * 2 * getChannelStride (4096 + 512) };
+std::atomic<size_t> AudioScratchBuffer::Arena::totalBytes { 0 };
+
+void AudioScratchBuffer::prepare (int maxNumChannels, int maxBlockSize)
+{
+    // Enough for a handful of buffers in use at once, with some room for the
+    // extra samples that resamplers ask for
+    constexpr size_t maxNumNestedBuffers = 8;
+    const auto size = maxNumNestedBuffers * (size_t) std::max (2, maxNumChannels)
+                        * Arena::getChannelStride (std::max (0, maxBlockSize) + 512);
+
+    auto current = Arena::requiredSize.load();
+
+    while (current < size && ! Arena::requiredSize.compare_exchange_weak (current, size))
+    {}
+}
+
+size_t AudioScratchBuffer::getNumBytesAllocated()
+{
+    return Arena::totalBytes.load() + BufferList::getInstance()->getNumBytes();
+}
+
+juce::AudioBuffer<float>& AudioScratchBuffer::getBuffer (int numChans, int numSamples)
+{
+    constexpr int maxNumArenaChannels = 32; // the most an AudioBuffer can refer to without allocating
+    const auto stride = Arena::getChannelStride (numSamples);
+    float* channels[maxNumArenaChannels];
+
+    if (numChans <= maxNumArenaChannels)
+    {
+        if (auto d = Arena::getForThisThread().allocate (stride * (size_t) numChans))
+        {
+            numArenaFloats = stride * (size_t) numChans;
+
+            for (int i = 0; i < numChans; ++i)
+                channels[i] = d + stride * (size_t) i;
+
+            arenaBuffer.setDataToReferTo (channels, numChans, numSamples);
+            return arenaBuffer;
+        }
+    }
+
+    allocatedBuffer = BufferList::getInstance()->get();
+    allocatedBuffer->buffer.setSize (numChans, numSamples, false, false, true);
+
+    // The buffer never shrinks, so this only needs updating when it grows
+    const auto numBytes = (size_t) numChans * (size_t) numSamples * sizeof (float);
+
+    if (numBytes > allocatedBuffer->numBytes)
+        allocatedBuffer->numBytes = numBytes;
+
+    return allocatedBuffer->buffer;
+}
+
 AudioScratchBuffer::AudioScratchBuffer (int numChans, int numSamples)
-    : allocatedBuffer (BufferList::getInstance()->get()),
-      buffer (allocatedBuffer->buffer)
+    : buffer (getBuffer (numChans, numSamples))
 {
-    buffer.setSize (numChans, numSamples, false, false, true);
 }
 
 AudioScratchBuffer::AudioScratchBuffer (const juce::AudioBuffer<float>& srcBuffer)
-  : allocatedBuffer (BufferList::getInstance()->get()),
-    buffer (allocatedBuffer->buffer)
+  : buffer (getBuffer (srcBuffer.getNumChannels(), srcBuffer.getNumSamples()))
 {
     const int chans = srcBuffer.getNumChannels();
     const int samps = srcBuffer.getNumSamples();
 
-    buffer.setSize (chans, samps, false, false, true);
-
     for (int i = 0; i < chans; ++i)
         buffer.copyFrom (i, 0, srcBuffer.getReadPointer (i), samps);
 }
 
 AudioScratchBuffer::~AudioScratchBuffer() noexcept
 {
-    allocatedBuffer->isFree = true;
+    if (allocatedBuffer != nullptr)
+        allocatedBuffer->isFree = true;
+    else if (numArenaFloats > 0)
+        Arena::getForThisThread().release (arenaBuffer.getReadPointer (0), numArenaFloats);
 }
 
 }
@@ -12,6 +12,39 @@ namespace tracktion_engine
 {
 
 class BackgroundJobManager;
+class ThreadPoolJobWithProgress;
+
+//==============================================================================
+/**
+    A flag that can be shared between a number of jobs so they can all be stopped at once,
+    e.g. all the renders started by one operation.
+
+    Copies refer to the same flag. Cancelling it signals every job it's been given to to
+    exit, so anything that checks the job's shouldExit() will see it, including jobs that are
+    given the token after it's been cancelled.
+*/
+class CancellationToken
+{
+public:
+    CancellationToken()  : state (std::make_shared<State>()) {}
+
+    /** Signals all the jobs using this token to exit. */
+    void cancel();
+
+    bool isCancelled() const noexcept               { return state->cancelled; }
+
+private:
+    struct State
+    {
+        std::atomic<bool> cancelled { false };
+        juce::CriticalSection lock;
+        juce::Array<ThreadPoolJobWithProgress*> jobs;
+    };
+
+    std::shared_ptr<State> state;
+
+    friend class ThreadPoolJobWithProgress;
+};
 
 //==============================================================================
 class ThreadPoolJobWithProgress  : public juce::ThreadPoolJob
@@ -23,6 +56,32 @@ public:
     virtual float getCurrentTaskProgress() = 0;
     virtual bool canCancel() const                  { return false; }
 
+    /** How soon a job needs to finish. The manager runs each on its own threads, with
+        higher OS priorities for the more urgent ones, so a long background job such as an
+        export can't hold up the ones the user is waiting for.
+    */
+    enum class Priority
+    {
+        interactive,    /**< The user's waiting for it, e.g. a proxy that's needed to play. */
+        visible,        /**< The result will be shown or used soon, e.g. a clip render. */
+        background      /**< Anything that can take as long as it needs, e.g. an export. */
+    };
+
+    /** Whether a job mostly uses the CPU or mostly waits for the disk. These are run on
+        separate threads so disk-bound jobs don't take up threads the CPU-bound ones could use.
+    */
+    enum class Lane
+    {
+        cpu,
+        io
+    };
+
+    Priority getPriority() const noexcept           { return priority; }
+    Lane getLane() const noexcept                   { return lane; }
+
+    /** Makes this job exit when the token is cancelled. A job can only use one token. */
+    void setCancellationToken (const CancellationToken&);
+
     void setManager (BackgroundJobManager&);
 
     /** Sets the job's name but also updates the manager so the list will reflect it. */
@@ -35,48 +94,67 @@ public:
 
 private:
     BackgroundJobManager* manager = nullptr;
+    std::shared_ptr<CancellationToken::State> cancellationState;
+    Priority priority = Priority::background;
+    Lane lane = Lane::cpu;
+
+    void removeCancellationToken();
+
+    friend class BackgroundJobManager;
 };
 
 //==============================================================================
 /**
     Manages a set of background tasks that can be run concurrently on a background thread.
-    This is essentially a wrapper around a ThreadPool which adds a listener interface so
-    you can create UI elements to represent the list.
+    This is essentially a wrapper around a set of ThreadPools which adds a listener interface
+    so you can create UI elements to represent the list.
+
+    Each combination of ThreadPoolJobWithProgress::Priority and Lane gets its own pool,
+    created when it's first needed. Jobs in a pool are run in the order they're added, but the
+    pools don't wait for each other and the more urgent ones run at higher thread priorities.
 */
 class BackgroundJobManager  : private juce::AsyncUpdater,
                               private juce::Timer
 {
 public:
-    BackgroundJobManager()
-        : pool (8)
-    {
-    }
+    using Priority = ThreadPoolJobWithProgress::Priority;
+    using Lane = ThreadPoolJobWithProgress::Lane;
+
+    BackgroundJobManager() = default;
 
     ~BackgroundJobManager() override
     {
-        pool.removeAllJobs (true, 30000);
+        forEachPool ([] (juce::ThreadPool& p) { p.removeAllJobs (true, 30000); });
     }
 
-    void addJob (ThreadPoolJobWithProgress* job, bool takeOwnership)
+    void addJob (ThreadPoolJobWithProgress* job, bool takeOwnership,
+                 Priority priority = Priority::background, Lane lane = Lane::cpu)
     {
         if (job == nullptr)
             return;
 
+        job->priority = priority;
+        job->lane = lane;
         job->setManager (*this);
-        pool.addJob (job, takeOwnership);
+        getPool (priority, lane).addJob (job, takeOwnership);
     }
 
     void removeJob (ThreadPoolJobWithProgress* job, bool interruptIfRunning, int timeOutMilliseconds)
     {
-        pool.removeJob (job, interruptIfRunning, timeOutMilliseconds);
+        if (job != nullptr)
+            if (auto p = getPoolIfCreated (job->priority, job->lane))
+                p->removeJob (job, interruptIfRunning, timeOutMilliseconds);
     }
 
     void stopAndDeleteAllRunningJobs()
     {
-        // Call this twice as the first call may only stop (and not delete) running jobs
-        pool.removeAllJobs (true, 30000);
-        pool.removeAllJobs (true, 5000);
-        jassert (pool.getNumJobs() == 0);
+        forEachPool ([] (juce::ThreadPool& p)
+                     {
+                         // Call this twice as the first call may only stop (and not delete) running jobs
+                         p.removeAllJobs (true, 30000);
+                         p.removeAllJobs (true, 5000);
+                         jassert (p.getNumJobs() == 0);
+                     });
     }
 
     //==============================================================================
@@ -85,15 +163,17 @@ public:
         JobInfo() {}
 
         JobInfo (ThreadPoolJobWithProgress& j, int id)
-            : name (j.getJobName()), progress (j.getCurrentTaskProgress()), jobId (id), canCancel (j.canCancel()) {}
+            : name (j.getJobName()), progress (j.getCurrentTaskProgress()), jobId (id), canCancel (j.canCancel()),
+              priority (j.getPriority()) {}
 
-        JobInfo (const JobInfo& o)              : name (o.name), progress (o.progress), jobId (o.jobId), canCancel (o.canCancel) {}
-        JobInfo& operator= (const JobInfo& o)   { name = o.name; progress = o.progress; jobId = o.jobId; canCancel = o.canCancel; return *this; }
+        JobInfo (const JobInfo& o)              : name (o.name), progress (o.progress), jobId (o.jobId), canCancel (o.canCancel), priority (o.priority) {}
+        JobInfo& operator= (const JobInfo& o)   { name = o.name; progress = o.progress; jobId = o.jobId; canCancel = o.canCancel; priority = o.priority; return *this; }
 
         juce::String name;
         float progress = 0;
         int jobId = -1;
         bool canCancel = false;
+        Priority priority = Priority::background;
     };
 
     void signalJobShouldExit (const JobInfo& info)
@@ -118,7 +198,33 @@ public:
 
     int getNumJobs() const noexcept                 { const juce::ScopedLock sl (jobsLock); return jobs.size(); }
     float getTotalProgress() const noexcept         { return totalProgress; }
-    juce::ThreadPool& getPool() noexcept            { return pool; }
+
+    /** Returns the pool that runs jobs of a given priority and lane, creating it if needed.
+        This can be used to run plain ThreadPoolJobs that don't need to show their progress.
+    */
+    juce::ThreadPool& getPool (Priority priority = Priority::background, Lane lane = Lane::cpu)
+    {
+        const juce::ScopedLock sl (poolLock);
+        auto& p = pools[(int) lane][(int) priority];
+
+        if (p == nullptr)
+        {
+            const int numCpus = juce::SystemStats::getNumCpus();
+            const int numThreads = lane == Lane::io ? 4
+                                                    : (priority == Priority::background ? juce::jmax (8, numCpus) : numCpus);
+
+            p = std::make_unique<juce::ThreadPool> (numThreads);
+
+            switch (priority)
+            {
+                case Priority::interactive:     p->setThreadPriorities (7); break;
+                case Priority::visible:         p->setThreadPriorities (5); break;
+                case Priority::background:      p->setThreadPriorities (3); break;
+            }
+        }
+
+        return *p;
+    }
 
     //==============================================================================
     class Listener
@@ -144,8 +250,8 @@ private:
 
     friend class ThreadPoolJobWithProgress;
     juce::OwnedArray<JobInfoPair> jobs;
-    juce::CriticalSection jobsLock;
-    juce::ThreadPool pool;
+    juce::CriticalSection jobsLock, poolLock;
+    std::unique_ptr<juce::ThreadPool> pools[2][3];
     juce::ListenerList<Listener> listeners;
     float totalProgress = 1.0f;
     int nextJobId = 0;
@@ -170,6 +276,21 @@ private:
         triggerAsyncUpdate();
     }
 
+    juce::ThreadPool* getPoolIfCreated (Priority priority, Lane lane) const
+    {
+        const juce::ScopedLock sl (poolLock);
+        return pools[(int) lane][(int) priority].get();
+    }
+
+    template<typename Fn>
+    void forEachPool (Fn&& fn)
+    {
+        for (auto lane : { Lane::cpu, Lane::io })
+            for (auto priority : { Priority::interactive, Priority::visible, Priority::background })
+                if (auto p = getPoolIfCreated (priority, lane))
+                    fn (*p);
+    }
+
     int getNextJobId() noexcept                     { return ++nextJobId &= 0xffffff; }
 
     void updateJobs()
@@ -217,14 +338,48 @@ private:
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BackgroundJobManager)
 };
 
+inline void CancellationToken::cancel()
+{
+    const juce::ScopedLock sl (state->lock);
+    state->cancelled = true;
+
+    for (auto j : state->jobs)
+        j->signalJobShouldExit();
+}
+
+//==============================================================================
 inline ThreadPoolJobWithProgress::~ThreadPoolJobWithProgress()
 {
     jassert (manager == nullptr); // You haven't called prepareForJobDeletion!
+    removeCancellationToken();
 
     if (manager != nullptr)
         manager->removeJobInternal (*this);
 }
 
+inline void ThreadPoolJobWithProgress::setCancellationToken (const CancellationToken& token)
+{
+    removeCancellationToken();
+    cancellationState = token.state;
+
+    const juce::ScopedLock sl (cancellationState->lock);
+    cancellationState->jobs.add (this);
+
+    if (cancellationState->cancelled)
+        signalJobShouldExit();
+}
+
+inline void ThreadPoolJobWithProgress::removeCancellationToken()
+{
+    if (cancellationState != nullptr)
+    {
+        const juce::ScopedLock sl (cancellationState->lock);
+        cancellationState->jobs.removeAllInstancesOf (this);
+    }
+
+    cancellationState = nullptr;
+}
+
 inline void ThreadPoolJobWithProgress::setManager (BackgroundJobManager& m)
 {
     manager = &m;
@@ -246,6 +401,7 @@ inline void ThreadPoolJobWithProgress::prepareForJobDeletion()
         manager->removeJobInternal (*this);
 
     manager = nullptr;
+    removeCancellationToken();
 }
 
 } // namespace tracktion_engine
@@ -0,0 +1,49 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+void ClockDriftSmoother::reset() noexcept
+{
+    smoothedError = 0;
+    driftEstimate = 0;
+    hasMeasurement = false;
+}
+
+double ClockDriftSmoother::update (double phaseErrorSeconds, double secondsSinceLastUpdate) noexcept
+{
+    const auto maxRate = settings.maxSpeedCompensationPercent / 100.0;
+    const auto dt = jlimit (0.0, 1.0, secondsSinceLastUpdate);
+    const auto correctionTime = jmax (1.0e-3, settings.correctionTimeSeconds);
+    const auto trackingTime = jmax (1.0e-3, settings.driftTrackingTimeSeconds);
+
+    if (! hasMeasurement)
+    {
+        smoothedError = phaseErrorSeconds;
+        hasMeasurement = true;
+    }
+    else
+    {
+        const auto smoothing = std::exp (-dt / jmax (1.0e-3, settings.jitterSmoothingTimeSeconds));
+        smoothedError = smoothing * smoothedError + (1.0 - smoothing) * phaseErrorSeconds;
+    }
+
+    const auto proportional = smoothedError / correctionTime;
+    const auto rate = driftEstimate + proportional;
+
+    // Stops the drift estimate winding up whilst the speed's being held at its limit
+    if (std::abs (rate) < maxRate || (rate > 0) != (smoothedError > 0))
+        driftEstimate = jlimit (-maxRate, maxRate, driftEstimate + smoothedError * dt / (correctionTime * trackingTime));
+
+    return jlimit (-maxRate, maxRate, driftEstimate + proportional) * 100.0;
+}
+
+} // namespace tracktion_engine
@@ -0,0 +1,68 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+/**
+    Keeps a local clock locked to an external one by nudging its speed, rather than
+    jumping whenever the two drift apart.
+
+    It's a simple phase-locked loop: each measurement of the phase error is filtered to
+    take out the jitter, the filtered error is integrated to estimate the difference in
+    clock rates, and the speed change returned is that estimate plus a proportion of the
+    remaining error. The speed is limited to a range small enough not to be heard.
+
+    Big errors, like the external clock being relocated, can't be nudged away quickly
+    enough, so callers should still jump for those and then call reset().
+
+    This isn't thread safe, so it should only be used by one thread at a time.
+*/
+class ClockDriftSmoother
+{
+public:
+    //==============================================================================
+    struct Settings
+    {
+        double maxSpeedCompensationPercent = 0.3;   /**< About 5 cents, which is inaudible. */
+        double correctionTimeSeconds = 2.0;         /**< Roughly how long a phase error takes to be corrected. */
+        double driftTrackingTimeSeconds = 20.0;     /**< How slowly the estimate of the difference in clock rates moves. */
+        double jitterSmoothingTimeSeconds = 0.1;    /**< How long the measurements are averaged over. */
+    };
+
+    ClockDriftSmoother() = default;
+    ClockDriftSmoother (const Settings& s) : settings (s) {}
+
+    void setSettings (const Settings& s)                { settings = s; }
+    const Settings& getSettings() const noexcept        { return settings; }
+
+    /** Forgets the error and drift, e.g. after a relocate or when playback stops. */
+    void reset() noexcept;
+
+    /** Adds a measurement and returns the speed compensation to use until the next one.
+        @param phaseErrorSeconds        how far the local clock is behind the external one
+        @param secondsSinceLastUpdate   the time since the previous measurement
+        @returns a speed change as a percentage, as used by DeviceManager::setSpeedCompensation()
+    */
+    double update (double phaseErrorSeconds, double secondsSinceLastUpdate) noexcept;
+
+    /** Returns how much faster, as a percentage, the external clock seems to be running. */
+    double getEstimatedDriftPercent() const noexcept    { return driftEstimate * 100.0; }
+
+    /** Returns the phase error after the jitter has been filtered out. */
+    double getSmoothedPhaseError() const noexcept       { return smoothedError; }
+
+private:
+    Settings settings;
+    double smoothedError = 0, driftEstimate = 0;
+    bool hasMeasurement = false;
+};
+
+} // namespace tracktion_engine
@@ -0,0 +1,327 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+std::shared_ptr<const juce::dsp::FFT> getSharedFFT (int order)
+{
+    static juce::CriticalSection lock;
+    static std::map<int, std::weak_ptr<const juce::dsp::FFT>> ffts;
+
+    const juce::ScopedLock sl (lock);
+    auto& cached = ffts[order];
+
+    if (auto fft = cached.lock())
+        return fft;
+
+    auto fft = std::make_shared<const juce::dsp::FFT> (order);
+    cached = fft;
+    return fft;
+}
+
+//==============================================================================
+/** One uniformly partitioned overlap-save convolution which takes a block of
+    blockSize samples at a time. The FFTs are twice the block size.
+*/
+struct PartitionedConvolver::Stage
+{
+    Stage (const float* impulseResponse, int numImpulseSamples, int blockSizeToUse)
+        : blockSize (blockSizeToUse),
+          numPartitions (juce::jmax (1, (numImpulseSamples + blockSizeToUse - 1) / blockSizeToUse)),
+          spectrumSize ((blockSizeToUse + 1) * 2),
+          fft (getSharedFFT (juce::roundToInt (std::log2 (blockSizeToUse * 2))))
+    {
+        jassert (juce::isPowerOfTwo (blockSize));
+
+        impulseSpectra.allocate ((size_t) (numPartitions * spectrumSize), true);
+        inputSpectra.allocate ((size_t) (numPartitions * spectrumSize), true);
+        inputWindow.allocate ((size_t) blockSize * 2, true);
+        fftBuffer.allocate ((size_t) blockSize * 4, true);
+
+        for (int i = 0; i < numPartitions; ++i)
+        {
+            auto start = i * blockSize;
+            auto num = juce::jmin (blockSize, numImpulseSamples - start);
+
+            juce::FloatVectorOperations::clear (fftBuffer, blockSize * 4);
+            juce::FloatVectorOperations::copy (fftBuffer, impulseResponse + start, num);
+            fft->performRealOnlyForwardTransform (fftBuffer, true);
+            juce::FloatVectorOperations::copy (impulseSpectra + i * spectrumSize, fftBuffer, spectrumSize);
+        }
+    }
+
+    void reset() noexcept
+    {
+        juce::FloatVectorOperations::clear (inputSpectra, numPartitions * spectrumSize);
+        juce::FloatVectorOperations::clear (inputWindow, blockSize * 2);
+        newestSpectrum = 0;
+    }
+
+    /** Takes blockSize new input samples and writes blockSize output samples. */
+    void process (const float* input, float* output) noexcept
+    {
+        // The FFT sees the previous block followed by the new one
+        juce::FloatVectorOperations::copy (inputWindow, inputWindow + blockSize, blockSize);
+        juce::FloatVectorOperations::copy (inputWindow + blockSize, input, blockSize);
+
+        juce::FloatVectorOperations::copy (fftBuffer, inputWindow, blockSize * 2);
+        juce::FloatVectorOperations::clear (fftBuffer + blockSize * 2, blockSize * 2);
+        fft->performRealOnlyForwardTransform (fftBuffer, true);
+
+        newestSpectrum = (newestSpectrum + 1) % numPartitions;
+        juce::FloatVectorOperations::copy (inputSpectra + newestSpectrum * spectrumSize, fftBuffer, spectrumSize);
+
+        // Each partition of the impulse is applied to the input from that many blocks ago
+        juce::FloatVectorOperations::clear (fftBuffer, blockSize * 4);
+
+        for (int i = 0; i < numPartitions; ++i)
+        {
+            auto inputIndex = (newestSpectrum + numPartitions - i) % numPartitions;
+            multiplyAndAdd (fftBuffer, inputSpectra + inputIndex * spectrumSize,
+                            impulseSpectra + i * spectrumSize, blockSize + 1);
+        }
+
+        fft->performRealOnlyInverseTransform (fftBuffer);
+
+        // Only the second half is free of wrapped-around samples
+        juce::FloatVectorOperations::copy (output, fftBuffer + blockSize, blockSize);
+    }
+
+    const int blockSize, numPartitions, spectrumSize;
+
+private:
+    std::shared_ptr<const juce::dsp::FFT> fft;
+    juce::HeapBlock<float> impulseSpectra, inputSpectra, inputWindow, fftBuffer;
+    int newestSpectrum = 0;
+
+    // Multiplies interleaved complex values. This is kept to a simple loop over
+    // restrict pointers so the compiler can vectorise it
+    static void multiplyAndAdd (float* JUCE_RESTRICT dest, const float* JUCE_RESTRICT a,
+                                const float* JUCE_RESTRICT b, int numBins) noexcept
+    {
+        for (int i = 0; i < numBins * 2; i += 2)
+        {
+            dest[i]     += a[i] * b[i]     - a[i + 1] * b[i + 1];
+            dest[i + 1] += a[i] * b[i + 1] + a[i + 1] * b[i];
+        }
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (Stage)
+};
+
+//==============================================================================
+/** Runs the tail blocks for all the PartitionedConvolvers. */
+class PartitionedConvolver::TailThread  : public juce::Thread
+{
+public:
+    TailThread() : Thread ("Convolution Tail") {}
+
+    ~TailThread() override
+    {
+        stopThread (5000);
+    }
+
+    void add (PartitionedConvolver& c)
+    {
+        {
+            const juce::ScopedLock sl (lock);
+            convolvers.addIfNotAlreadyThere (&c);
+        }
+
+        startThread (8);
+    }
+
+    /** Once this returns, the thread won't touch the convolver again. */
+    void remove (PartitionedConvolver& c)
+    {
+        const juce::ScopedLock sl (lock);
+        convolvers.removeFirstMatchingValue (&c);
+    }
+
+    void run() override
+    {
+        while (! threadShouldExit())
+        {
+            wait (-1);
+
+            // Keep going until there's nothing left, as several convolvers
+            // may have notified us whilst we were busy
+            for (;;)
+            {
+                bool anyProcessed = false;
+
+                {
+                    const juce::ScopedLock sl (lock);
+
+                    for (auto c : convolvers)
+                        anyProcessed = c->runTailJobIfQueued() || anyProcessed;
+                }
+
+                if (! anyProcessed || threadShouldExit())
+                    break;
+            }
+        }
+    }
+
+private:
+    juce::CriticalSection lock;
+    juce::Array<PartitionedConvolver*> convolvers;
+
+    JUCE_DECLARE_NON_COPYABLE (TailThread)
+};
+
+//==============================================================================
+PartitionedConvolver::PartitionedConvolver() = default;
+
+PartitionedConvolver::~PartitionedConvolver()
+{
+    tailThread->remove (*this);
+}
+
+void PartitionedConvolver::prepare (const float* impulseResponse, int numImpulseSamples, int maxBlockSize)
+{
+    CRASH_TRACER
+    tailThread->remove (*this);
+    tailJobState = idle;
+
+    headSize = juce::nextPowerOfTwo (juce::jmax (16, maxBlockSize));
+    numHeadBlocksPerTailBlock = juce::jmax (8, 1024 / headSize);
+    headPosition = 0;
+    numHeadBlocksInTailBlock = 0;
+
+    headInput.allocate ((size_t) headSize, true);
+    headOutput.allocate ((size_t) headSize, true);
+
+    // The head has to cover two tail blocks: one for collecting the tail's input
+    // and one for the background thread to process it in
+    const int tailSize = headSize * numHeadBlocksPerTailBlock;
+    const int headLength = juce::jmin (numImpulseSamples, tailSize * 2);
+
+    head = std::make_unique<Stage> (impulseResponse, headLength, headSize);
+    tail.reset();
+
+    if (numImpulseSamples > headLength)
+    {
+        tail = std::make_unique<Stage> (impulseResponse + headLength, numImpulseSamples - headLength, tailSize);
+
+        tailBuffers.allocate ((size_t) tailSize * 4, true);
+        tailInputBeingWritten   = tailBuffers;
+        tailInputBeingProcessed = tailBuffers + tailSize;
+        tailOutputBeingRead     = tailBuffers + tailSize * 2;
+        tailOutputBeingWritten  = tailBuffers + tailSize * 3;
+
+        tailThread->add (*this);
+    }
+}
+
+void PartitionedConvolver::reset()
+{
+    if (tail != nullptr)
+    {
+        waitForTailBlock();
+        tail->reset();
+        juce::FloatVectorOperations::clear (tailBuffers, tail->blockSize * 4);
+    }
+
+    if (head != nullptr)
+    {
+        head->reset();
+        juce::FloatVectorOperations::clear (headInput, headSize);
+        juce::FloatVectorOperations::clear (headOutput, headSize);
+    }
+
+    headPosition = 0;
+    numHeadBlocksInTailBlock = 0;
+}
+
+void PartitionedConvolver::process (const float* input, float* output, int numSamples) noexcept
+{
+    if (head == nullptr)
+    {
+        juce::FloatVectorOperations::clear (output, numSamples);
+        return;
+    }
+
+    while (numSamples > 0)
+    {
+        auto num = juce::jmin (numSamples, headSize - headPosition);
+
+        // The input is copied before the output is written in case they're the same buffer
+        juce::FloatVectorOperations::copy (headInput + headPosition, input, num);
+        juce::FloatVectorOperations::copy (output, headOutput + headPosition, num);
+
+        input += num;
+        output += num;
+        numSamples -= num;
+        headPosition += num;
+
+        if (headPosition == headSize)
+        {
+            processHeadBlock();
+            headPosition = 0;
+        }
+    }
+}
+
+void PartitionedConvolver::processHeadBlock() noexcept
+{
+    head->process (headInput, headOutput);
+
+    if (tail == nullptr)
+        return;
+
+    auto offset = numHeadBlocksInTailBlock * headSize;
+    juce::FloatVectorOperations::add (headOutput, tailOutputBeingRead + offset, headSize);
+    juce::FloatVectorOperations::copy (tailInputBeingWritten + offset, headInput, headSize);
+
+    if (++numHeadBlocksInTailBlock == numHeadBlocksPerTailBlock)
+    {
+        numHeadBlocksInTailBlock = 0;
+        waitForTailBlock();
+        submitTailBlock();
+    }
+}
+
+void PartitionedConvolver::submitTailBlock() noexcept
+{
+    std::swap (tailInputBeingWritten, tailInputBeingProcessed);
+    tailJobState = queued;
+    tailThread->notify();
+}
+
+void PartitionedConvolver::waitForTailBlock() noexcept
+{
+    if (tailJobState.load() == idle)
+        return;
+
+    // If the background thread hasn't got to it yet, it's quicker to do it here than wait
+    runTailJobIfQueued();
+
+    while (tailJobState.load() != finished)
+        juce::Thread::yield();
+
+    tailJobState = idle;
+    std::swap (tailOutputBeingRead, tailOutputBeingWritten);
+}
+
+bool PartitionedConvolver::runTailJobIfQueued() noexcept
+{
+    int expected = queued;
+
+    if (! tailJobState.compare_exchange_strong (expected, running))
+        return false;
+
+    tail->process (tailInputBeingProcessed, tailOutputBeingWritten);
+    tailJobState = finished;
+    return true;
+}
+
+} // namespace tracktion_engine
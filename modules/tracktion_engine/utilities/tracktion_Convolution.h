@@ -0,0 +1,85 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+/** Returns an FFT of the given order that's shared with anything else asking for the same size.
+    The FFT's transforms are const so it can be used from several threads at once.
+    Each size is only kept alive while somebody is holding on to it.
+*/
+std::shared_ptr<const juce::dsp::FFT> getSharedFFT (int order);
+
+//==============================================================================
+/**
+    Convolves a mono signal with an impulse response, using uniformly partitioned
+    overlap-save convolution in two stages.
+
+    The start of the impulse response is handled by small partitions on the audio
+    thread, which sets the latency. The rest is handled by partitions several times
+    larger, which are computed on a shared background thread whilst the next block of
+    input is collected. If the background thread falls behind, the audio thread
+    does the work itself rather than glitching.
+
+    Use one of these per channel.
+*/
+class PartitionedConvolver
+{
+public:
+    PartitionedConvolver();
+    ~PartitionedConvolver();
+
+    /** Loads an impulse response and prepares to process blocks of up to maxBlockSize samples.
+        This allocates so shouldn't be called whilst process might be.
+        The head partition size is maxBlockSize rounded up to a power of two, and that's also the latency.
+    */
+    void prepare (const float* impulseResponse, int numImpulseSamples, int maxBlockSize);
+
+    /** Clears any audio left in the convolver. */
+    void reset();
+
+    /** Returns the number of samples the output is delayed by. */
+    int getLatencySamples() const noexcept          { return headSize; }
+
+    /** Convolves a block of samples. The input and output can be the same buffer. */
+    void process (const float* input, float* output, int numSamples) noexcept;
+
+private:
+    //==============================================================================
+    struct Stage;
+    class TailThread;
+
+    std::unique_ptr<Stage> head, tail;
+    juce::SharedResourcePointer<TailThread> tailThread;
+
+    int headSize = 0, numHeadBlocksPerTailBlock = 1;
+    int headPosition = 0, numHeadBlocksInTailBlock = 0;
+    juce::HeapBlock<float> headInput, headOutput;
+
+    // The tail's input and output are double buffered so one block can be collected
+    // and played whilst the background thread works on the other
+    juce::HeapBlock<float> tailBuffers;
+    float* tailInputBeingWritten = nullptr;
+    float* tailInputBeingProcessed = nullptr;
+    float* tailOutputBeingRead = nullptr;
+    float* tailOutputBeingWritten = nullptr;
+
+    enum JobState { idle, queued, running, finished };
+    std::atomic<int> tailJobState { idle };
+
+    void processHeadBlock() noexcept;
+    void submitTailBlock() noexcept;
+    void waitForTailBlock() noexcept;
+    bool runTailJobIfQueued() noexcept;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PartitionedConvolver)
+};
+
+} // namespace tracktion_engine
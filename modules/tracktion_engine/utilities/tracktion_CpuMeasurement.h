@@ -21,7 +21,7 @@ struct ScopedCpuMeter
     ~ScopedCpuMeter() noexcept
     {
         const double msTaken = juce::Time::getMillisecondCounterHiRes() - callbackStartTime;
-        valueToUpdate.store (filterAmount * (msTaken - valueToUpdate));
+        valueToUpdate.store (valueToUpdate + filterAmount * (msTaken - valueToUpdate));
     }
 
 private:
@@ -33,43 +33,51 @@ private:
 //==============================================================================
 struct StopwatchTimer
 {
-    StopwatchTimer() noexcept    : time (juce::Time::getCurrentTime()) {}
+    StopwatchTimer() noexcept    : startTicks (juce::Time::getHighResolutionTicks()) {}
 
-    juce::RelativeTime getTime() const noexcept  { return juce::Time::getCurrentTime() - time; }
+    juce::RelativeTime getTime() const noexcept  { return juce::RelativeTime (getSeconds()); }
     juce::String getDescription() const          { return getTime().getDescription(); }
-    double getSeconds() const noexcept           { return getTime().inSeconds(); }
+    double getSeconds() const noexcept           { return juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks); }
 
 private:
-    const juce::Time time;
+    // The high resolution ticks are monotonic, unlike the wall-clock time
+    const juce::int64 startTicks;
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (StopwatchTimer)
 };
 
 //==============================================================================
-#if TRACKTION_CHECK_FOR_SLOW_RENDERING
- struct RealtimeCheck
- {
-    RealtimeCheck (const char* f, int l, double maxMillisecs) noexcept
-        : start (juce::Time::getMillisecondCounterHiRes()),
-          end (start + maxMillisecs),
-          file (f), line (l)
+/**
+    Records a scope on the audio thread with TraceEvents, noting whether it took
+    longer than it should have. Use the SCOPED_REALTIME_CHECK macros rather than this.
+*/
+struct RealtimeCheck
+{
+    RealtimeCheck (const char* fn, const char* f, int l, double maxMillisecs) noexcept
+        : function (fn), file (f), line (l), maxMs (maxMillisecs),
+          start (TraceEvents::isRecording() ? juce::Time::getHighResolutionTicks() : 0)
     {
     }
 
     ~RealtimeCheck() noexcept
     {
-        const double now = juce::Time::getMillisecondCounterHiRes();
+        if (start == 0 || ! TraceEvents::isRecording())
+            return;
 
-        if (now > end)
-            juce::Logger::outputDebugString (juce::String (now - start) + " " + file + ":" + juce::String (line));
+        const auto end = juce::Time::getHighResolutionTicks();
+        const bool overran = juce::Time::highResolutionTicksToSeconds (end - start) * 1000.0 > maxMs;
+        TraceEvents::record ({ function, file, "realtime", line, start, end, overran });
     }
 
-    double start, end;
+    const char* function;
     const char* file;
     int line;
- };
+    double maxMs;
+    const juce::int64 start;
+};
 
- #define SCOPED_REALTIME_CHECK           const RealtimeCheck JUCE_JOIN_MACRO(__realtimeCheck, __LINE__) (__FILE__, __LINE__, 1.5);
- #define SCOPED_REALTIME_CHECK_LONGER    const RealtimeCheck JUCE_JOIN_MACRO(__realtimeCheck, __LINE__) (__FILE__, __LINE__, 200 / 44.1);
+#if TRACKTION_TRACE_EVENTS
+ #define SCOPED_REALTIME_CHECK           const RealtimeCheck JUCE_JOIN_MACRO(__realtimeCheck, __LINE__) (__FUNCTION__, __FILE__, __LINE__, 1.5);
+ #define SCOPED_REALTIME_CHECK_LONGER    const RealtimeCheck JUCE_JOIN_MACRO(__realtimeCheck, __LINE__) (__FUNCTION__, __FILE__, __LINE__, 200 / 44.1);
 #else
  #define SCOPED_REALTIME_CHECK
  #define SCOPED_REALTIME_CHECK_LONGER
@@ -11,52 +11,175 @@
 namespace tracktion_engine
 {
 
+/**
+    Each thread claims one of a fixed set of stacks the first time it uses a CRASH_TRACER,
+    so pushing and popping an entry is just a store to memory only that thread writes to,
+    with no locking or looking up which thread it is. If they've all been claimed, a
+    thread falls back to a shared, locked list.
+*/
 struct CrashStackTracer::CrashTraceThreads
 {
+    static constexpr int maxNumThreads = 128;
+    static constexpr int maxDepth = 128;
+
+    struct ThreadStack
+    {
+        std::atomic<bool> isClaimed { false };
+        std::atomic<Thread::ThreadID> threadID { nullptr };
+        std::atomic<int> depth { 0 };
+        CrashStackTracer* entries[maxDepth] = {};
+    };
+
+    /** Gives the calling thread's stack back when the thread ends. */
+    struct ThreadClaim
+    {
+        ~ThreadClaim()
+        {
+            if (stack != nullptr)
+            {
+                stack->depth = 0;
+                stack->threadID = nullptr;
+                stack->isClaimed.store (false, std::memory_order_release);
+            }
+
+            // Anything traced after this, e.g. during static destruction, uses the shared list
+            stack = nullptr;
+            hasTriedToClaim = true;
+        }
+
+        ThreadStack* stack = nullptr;
+        bool hasTriedToClaim = false;
+    };
+
     CrashTraceThreads()
     {
-        entries.ensureStorageAllocated (64);
+        sharedEntries.ensureStorageAllocated (64);
+    }
+
+    inline ThreadStack* getStackForThisThread() noexcept
+    {
+        static thread_local ThreadClaim claim;
+
+        if (claim.stack != nullptr || claim.hasTriedToClaim)
+            return claim.stack;
+
+        claim.hasTriedToClaim = true;
+
+        for (auto& stack : stacks)
+        {
+            bool expected = false;
+
+            if (stack.isClaimed.compare_exchange_strong (expected, true, std::memory_order_acquire))
+            {
+                stack.depth = 0;
+                stack.threadID = Thread::getCurrentThreadId();
+                claim.stack = &stack;
+                break;
+            }
+        }
+
+        return claim.stack;
     }
 
     inline void push (CrashStackTracer* c)
     {
-        entries.add (c);
+        if (auto stack = getStackForThisThread())
+        {
+            // Anything deeper than this isn't stored but is still counted, so the pops match up
+            auto depth = stack->depth.load (std::memory_order_relaxed);
+
+            if (depth < maxDepth)
+                stack->entries[depth] = c;
+
+            stack->depth.store (depth + 1, std::memory_order_release);
+            return;
+        }
+
+        c->threadID = Thread::getCurrentThreadId();
+        sharedEntries.add (c);
     }
 
     inline void pop (CrashStackTracer* c)
     {
-        entries.removeFirstMatchingValue (c);
+        if (auto stack = getStackForThisThread())
+        {
+            stack->depth.store (stack->depth.load (std::memory_order_relaxed) - 1, std::memory_order_release);
+            return;
+        }
+
+        sharedEntries.removeFirstMatchingValue (c);
+    }
+
+    //==============================================================================
+    /** A thread's entries, the most recent first. */
+    struct ThreadEntries
+    {
+        Thread::ThreadID threadID;
+        Array<const CrashStackTracer*> entries;
+    };
+
+    /** Collects the entries for each thread, as they were when this was called. */
+    Array<ThreadEntries> getThreadEntries() const
+    {
+        Array<ThreadEntries> threads;
+
+        for (auto& stack : stacks)
+        {
+            if (! stack.isClaimed.load (std::memory_order_acquire))
+                continue;
+
+            auto depth = jmin (stack.depth.load (std::memory_order_acquire), maxDepth);
+
+            if (depth <= 0)
+                continue;
+
+            ThreadEntries t { stack.threadID.load(), {} };
+
+            for (int i = depth; --i >= 0;)
+                t.entries.add (stack.entries[i]);
+
+            threads.add (t);
+        }
+
+        const ScopedLock sl (sharedEntries.getLock());
+
+        for (int i = sharedEntries.size(); --i >= 0;)
+        {
+            auto entry = sharedEntries.getUnchecked (i);
+            auto existing = std::find_if (threads.begin(), threads.end(),
+                                          [entry] (const ThreadEntries& t) { return t.threadID == entry->threadID; });
+
+            if (existing != threads.end())
+                existing->entries.add (entry);
+            else
+                threads.add ({ entry->threadID, { entry } });
+        }
+
+        return threads;
+    }
+
+    static String getDescription (const CrashStackTracer& s)
+    {
+        return File::createFileWithoutCheckingPath (s.file).getFileName()
+                + ":" + String (s.function) + ":" + String (s.line);
     }
 
     void dump() const
     {
       #if TRACKTION_LOG_ENABLED
-        Array<Thread::ThreadID> threads;
-
-        for (int i = entries.size(); --i >= 0;)
-            threads.addIfNotAlreadyThere (entries.getUnchecked (i)->threadID);
+        auto threads = getThreadEntries();
 
         for (int j = 0; j < threads.size(); ++j)
         {
             TRACKTION_LOG ("Thread " + String (j) + ":");
-
-            auto thread = threads.getUnchecked(j);
             int n = 0;
 
-            for (int i = entries.size(); --i >= 0;)
+            for (auto s : threads.getReference (j).entries)
             {
-                auto& s = *entries.getUnchecked (i);
-
-                if (s.threadID == thread)
-                {
-                    if (s.pluginName != nullptr)
-                        TRACKTION_LOG ("  ** Plugin crashed: " + String (s.pluginName));
-
-                    TRACKTION_LOG ("  " + String (n++) + ": "
-                                    + File::createFileWithoutCheckingPath (s.file).getFileName()
-                                    + ":" + String (s.function) + ":" + String (s.line));
+                if (s->pluginName != nullptr)
+                    TRACKTION_LOG ("  ** Plugin crashed: " + String (s->pluginName));
 
-                }
+                TRACKTION_LOG ("  " + String (n++) + ": " + getDescription (*s));
             }
         }
       #endif
@@ -64,37 +187,22 @@ struct CrashStackTracer::CrashTraceThreads
 
     void dump (OutputStream& os, juce::Thread::ThreadID threadIDToDump) const
     {
-        Array<Thread::ThreadID> threads;
+        int j = 0;
 
-        for (int i = entries.size(); --i >= 0;)
+        for (auto& thread : getThreadEntries())
         {
-            auto entryThreadID = entries.getUnchecked (i)->threadID;
-
-            if (entryThreadID == threadIDToDump || entryThreadID == juce::Thread::ThreadID())
-                threads.addIfNotAlreadyThere (entryThreadID);
-        }
+            if (thread.threadID != threadIDToDump && thread.threadID != juce::Thread::ThreadID())
+                continue;
 
-        for (int j = 0; j < threads.size(); ++j)
-        {
-            os.writeText ("Thread " + String (j) + ":\n", false, false, nullptr);
-
-            auto thread = threads.getUnchecked (j);
+            os.writeText ("Thread " + String (j++) + ":\n", false, false, nullptr);
             int n = 0;
 
-            for (int i = entries.size(); --i >= 0;)
+            for (auto s : thread.entries)
             {
-                auto& s = *entries.getUnchecked (i);
-
-                if (s.threadID == thread)
-                {
-                    if (s.pluginName != nullptr)
-                        os.writeText ("  ** Plugin crashed: " + String (s.pluginName) + "\n", false, false, nullptr);
+                if (s->pluginName != nullptr)
+                    os.writeText ("  ** Plugin crashed: " + String (s->pluginName) + "\n", false, false, nullptr);
 
-                    os.writeText ("  " + String (n++) + ": "
-                                   + File::createFileWithoutCheckingPath (s.file).getFileName()
-                                   + ":" + String (s.function) + ":" + String (s.line) + "\n", false, false, nullptr);
-
-                }
+                os.writeText ("  " + String (n++) + ": " + getDescription (*s) + "\n", false, false, nullptr);
             }
         }
     }
@@ -103,48 +211,43 @@ struct CrashStackTracer::CrashTraceThreads
     {
         StringArray plugins;
 
-        for (auto s : entries)
-            if (s->pluginName != nullptr)
-                plugins.add (s->pluginName);
+        for (auto& thread : getThreadEntries())
+            for (int i = thread.entries.size(); --i >= 0;)
+                if (auto name = thread.entries.getUnchecked (i)->pluginName)
+                    plugins.add (name);
 
         return plugins;
     }
 
-    String getCrashedPlugin (Thread::ThreadID thread)
+    String getCrashedPlugin (Thread::ThreadID threadID)
     {
-        for (int i = entries.size(); --i >= 0;)
-        {
-            auto& s = *entries.getUnchecked (i);
-
-            if (s.threadID == thread)
-                if (s.pluginName != nullptr)
-                    return s.pluginName;
-        }
+        for (auto& thread : getThreadEntries())
+            if (thread.threadID == threadID)
+                for (auto s : thread.entries)
+                    if (s->pluginName != nullptr)
+                        return s->pluginName;
 
         return {};
     }
 
-    String getCrashLocation (Thread::ThreadID thread)
+    String getCrashLocation (Thread::ThreadID threadID)
     {
-        for (int i = entries.size(); --i >= 0;)
-        {
-            auto& s = *entries.getUnchecked (i);
-
-            if (s.threadID == thread)
-                return File::createFileWithoutCheckingPath (s.file).getFileName()
-                     + ":" + String (s.function) + ":" + String (s.line);
-        }
+        for (auto& thread : getThreadEntries())
+            if (thread.threadID == threadID && ! thread.entries.isEmpty())
+                return getDescription (*thread.entries.getFirst());
 
         return "UnknownLocation";
     }
 
-    Array<CrashStackTracer*, CriticalSection, 100> entries;
+    ThreadStack stacks[maxNumThreads];
+    Array<CrashStackTracer*, CriticalSection, 100> sharedEntries;
 };
 
 static CrashStackTracer::CrashTraceThreads crashStack;
 
 CrashStackTracer::CrashStackTracer (const char* f, const char* fn, int l, const char* plugin)
-    : file (f), function (fn), pluginName (plugin), line (l), threadID (Thread::getCurrentThreadId())
+    : file (f), function (fn), pluginName (plugin), line (l),
+      startTicks (TRACKTION_TRACE_EVENTS && TraceEvents::isRecording() ? Time::getHighResolutionTicks() : 0)
 {
     crashStack.push (this);
 
@@ -156,6 +259,9 @@ CrashStackTracer::CrashStackTracer (const char* f, const char* fn, int l, const
 CrashStackTracer::~CrashStackTracer()
 {
     crashStack.pop (this);
+
+    if (startTicks != 0 && TraceEvents::isRecording())
+        TraceEvents::record ({ function, file, "crashTracer", line, startTicks, Time::getHighResolutionTicks(), false });
 }
 
 StringArray CrashStackTracer::getCrashedPlugins()
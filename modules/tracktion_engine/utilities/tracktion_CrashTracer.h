@@ -34,14 +34,20 @@ private:
     const char* function;
     const char* pluginName;
     int line;
-    juce::Thread::ThreadID threadID;
+    juce::Thread::ThreadID threadID = {};      // Only set for the threads that use the shared list
+    juce::int64 startTicks;
 };
 
-/** This macro adds the current location to a stack which gets logged if a crash happens. */
-#define CRASH_TRACER            const CrashStackTracer JUCE_JOIN_MACRO (__crashTrace, __LINE__) (__FILE__, __FUNCTION__, __LINE__, nullptr);
+#if TRACKTION_ENABLE_CRASH_TRACER
+ /** This macro adds the current location to a stack which gets logged if a crash happens. */
+ #define CRASH_TRACER            const CrashStackTracer JUCE_JOIN_MACRO (__crashTrace, __LINE__) (__FILE__, __FUNCTION__, __LINE__, nullptr);
 
-/** This macro adds the current location and the name of a plugin to a stack which gets logged if a crash happens. */
-#define CRASH_TRACER_PLUGIN(p)  const CrashStackTracer JUCE_JOIN_MACRO (__crashTrace, __LINE__) (__FILE__, __FUNCTION__, __LINE__, p);
+ /** This macro adds the current location and the name of a plugin to a stack which gets logged if a crash happens. */
+ #define CRASH_TRACER_PLUGIN(p)  const CrashStackTracer JUCE_JOIN_MACRO (__crashTrace, __LINE__) (__FILE__, __FUNCTION__, __LINE__, p);
+#else
+ #define CRASH_TRACER
+ #define CRASH_TRACER_PLUGIN(p)
+#endif
 
 
 //==============================================================================
@@ -140,57 +140,35 @@ void CurveEditor::paint (juce::Graphics& g)
     }
 
     // draw the line to the first point, or all the way across if there are no points
-    const int start = jmax (0, nextIndexAfter (leftTime) - 1);
-    const int numPoints = getNumPoints();
+    updateShapeIfNeeded (true);
+
+    const int start = jmax (0, getShapeIndexAfter (leftTime) - 1);
+    const int numPoints = (int) shape.points.size();
 
     auto clipBounds = g.getClipBounds();
 
     {
-        auto lastY = valueToY (getValueAt (leftTime));
+        auto lastY = valueToY (getShapeValueAt (leftTime));
 
         Path curvePath;
         curvePath.startNewSubPath (jmax (0.0f, timeToX (0)), lastY);
-        curvePath.preallocateSpace (numPoints * 5 + 1);
 
         if (numPoints > 0)
         {
-            for (int index = start; index < numPoints - 1; ++index)
-            {
-                if (index == start)
-                    curvePath.lineTo (getPosition (index));
-
-                auto p2 = getPosition (index + 1);
-                auto c = getPointCurve (index);
-
-                if (c == 0)
-                {
-                    curvePath.lineTo (p2);
-                }
-                else
-                {
-                    auto bp = getPosition (getBezierPoint (index));
+            // Only the vertices up to the first one past the right of the clip are needed
+            const auto firstVertex = shape.pointVertices[(size_t) start];
+            auto lastVertex = firstVertex;
+            const auto rightTimeOfClip = xToTime (clipBounds.getRight());
 
-                    if (c >= -0.5 && c <= 0.5)
-                    {
-                        curvePath.quadraticTo (bp, p2);
-                    }
-                    else
-                    {
-                        double lineX1, lineX2;
-                        float lineY1, lineY2;
-                        getBezierEnds (index, lineX1, lineY1, lineX2, lineY2);
+            while (lastVertex + 1 < shape.vertices.size() && shape.vertices[lastVertex].time <= rightTimeOfClip)
+                ++lastVertex;
 
-                        curvePath.lineTo (getPosition ({ lineX1, lineY1 }));
-                        curvePath.quadraticTo (bp, getPosition ({ lineX2, lineY2 }));
-                        curvePath.lineTo (p2);
-                    }
-                }
+            curvePath.preallocateSpace ((int) (lastVertex - firstVertex) * 3 + 6);
 
-                lastY = p2.y;
+            for (auto v = firstVertex; v <= lastVertex; ++v)
+                curvePath.lineTo (getPosition (shape.vertices[v]));
 
-                if (p2.x > clipBounds.getRight())
-                    break;
-            }
+            lastY = valueToY (shape.vertices[lastVertex].value);
         }
 
         curvePath.lineTo ((float) getWidth(), lastY);
@@ -213,7 +191,8 @@ void CurveEditor::paint (juce::Graphics& g)
         // draw the white points
         for (int i = start; i < numPoints; ++i)
         {
-            auto pos = getPosition (i);
+            auto& point = shape.points[(size_t) i];
+            auto pos = getPosition ({ point.time, point.value });
 
             juce::Rectangle<float> r (pos.x - pointRadius,
                                       pos.y - pointRadius,
@@ -246,7 +225,7 @@ void CurveEditor::paint (juce::Graphics& g)
         // draw the curve points
         for (int i = start; i < numPoints - 1; ++i)
         {
-            auto pos = getPosition (getBezierHandle (i));
+            auto pos = getPosition (shape.points[(size_t) i].handle);
 
             juce::Rectangle<float> r (pos.x - pointRadius,
                                       pos.y - pointRadius,
@@ -270,21 +249,29 @@ void CurveEditor::paint (juce::Graphics& g)
 
 bool CurveEditor::hitTest (int x, int y)
 {
-    auto py1 = valueToY (getValueAt (xToTime (x - 3.0f)));
-    auto py2 = valueToY (getValueAt (xToTime (x + 3.0f)));
+    updateShapeIfNeeded (false);
+
+    auto py1 = valueToY (getShapeValueAt (xToTime (x - 3.0f)));
+    auto py2 = valueToY (getShapeValueAt (xToTime (x + 3.0f)));
 
     if (y > jmin (py1, py2) - 4.0f && y < jmax (py1, py2) + 4.0f)
         return true;
 
-    for (int i = firstIndexOnScreen; i < getNumPoints(); ++i)
+    // Only the points within a radius either side can be hit
+    const int numPoints = (int) shape.points.size();
+
+    for (int i = jmax (firstIndexOnScreen, getShapeIndexAfter (xToTime (x - pointRadius))); i < numPoints; ++i)
     {
-        auto t = getPointTime (i);
+        auto t = shape.points[(size_t) i].time;
 
         if (t >= rightTime)
             break;
 
         auto px = timeToX (t);
-        auto py = valueToY (getPointValue (i));
+        auto py = valueToY (shape.points[(size_t) i].value);
+
+        if (px - x >= pointRadius)
+            break;
 
         if (std::abs (x - px) < pointRadius
              && std::abs (y - py) < pointRadius + 2)
@@ -519,6 +506,7 @@ void CurveEditor::mouseDrag (const MouseEvent& e)
     }
 
     CRASH_TRACER
+    curveChanged();
     updateLineThickness();
     repaint();
 
@@ -546,6 +534,7 @@ void CurveEditor::mouseUp (const MouseEvent& e)
                 {
                     // too near to an existing point - so remove it..
                     removePoint (pointBeingMoved);
+                    curveChanged();
                     break;
                 }
             }
@@ -578,6 +567,7 @@ void CurveEditor::mouseDoubleClick (const MouseEvent& e)
             p->deselect();
 
         removePoint (pointUnderMouse);
+        curveChanged();
     }
     else if (pointUnderMouse < 0)
     {
@@ -590,6 +580,7 @@ void CurveEditor::mouseDoubleClick (const MouseEvent& e)
             undoManager.beginNewTransaction();
 
             auto pnt = addPoint (t, value, defaultCurve);
+            curveChanged();
 
             if (pnt >= 0)
                 selectPoint (pnt, false);
@@ -644,28 +635,33 @@ void CurveEditor::updatePointUnderMouse (juce::Point<float> pos)
         return;
 
     pos.x = jmax (timeToX (0), pos.x);
+    updateShapeIfNeeded (false);
 
     const auto captureRadius = pointRadius * pointRadius;
+    const int numPoints = (int) shape.points.size();
     int point = -1;
     int curvePoint = -1;
 
-    for (int i = firstIndexOnScreen; i < getNumPoints(); ++i)
+    // A curve dragger is always between its points so only the segments around the mouse need checking
+    const auto timeAfterMouse = xToTime (pos.x + pointRadius);
+
+    for (int i = jmax (firstIndexOnScreen, getShapeIndexAfter (xToTime (pos.x - pointRadius)) - 1); i < numPoints; ++i)
     {
-        auto t = getPointTime (i);
+        auto& p = shape.points[(size_t) i];
 
-        if (t >= rightTime)
+        if (p.time >= rightTime || p.time > timeAfterMouse)
             break;
 
         // check if there is a point under the mouse
-        if (getPosition ({ t, getPointValue (i) }).getDistanceSquaredFrom (pos) < captureRadius)
+        if (getPosition ({ p.time, p.value }).getDistanceSquaredFrom (pos) < captureRadius)
         {
             point = i;
             break;
         }
 
         // check if there is a curve dragger under the mouse
-        if (i < getNumPoints() - 1)
-            if (getPosition (getBezierHandle (i)).getDistanceSquaredFrom (pos) < captureRadius)
+        if (i < numPoints - 1)
+            if (getPosition (p.handle).getDistanceSquaredFrom (pos) < captureRadius)
                 curvePoint = i;
    }
 
@@ -690,15 +686,12 @@ void CurveEditor::updatePointUnderMouse (juce::Point<float> pos)
 
         if (pointUnderMouse == -1 && curveUnderMouse == -1)
         {
-            auto numPoints = getNumPoints();
+            auto t = xToTime (pos.x);
+            auto next = getShapeIndexAfter (t);
 
-            for (int i = 0; i < numPoints - 1; ++i)
-            {
-                auto t = xToTime (pos.x);
-
-                if (t > getPointTime(i) && t < getPointTime (i + 1))
-                    newLineUnderMouse = i;
-            }
+            if (next > 0 && next < numPoints
+                 && t > shape.points[(size_t) next - 1].time && t < shape.points[(size_t) next].time)
+                newLineUnderMouse = next - 1;
         }
 
         if (newLineUnderMouse != lineUnderMouse)
@@ -747,6 +740,7 @@ juce::Point<float> CurveEditor::getPosition (int index)
 
 void CurveEditor::selectableObjectChanged (Selectable*)
 {
+    curveChanged();
     updateLineThickness();
 }
 
@@ -769,6 +763,7 @@ void CurveEditor::changeListenerCallback (ChangeBroadcaster* cb)
     }
     else
     {
+        curveChanged();
         updatePointUnderMouse (getMouseXYRelative().toFloat());
         repaint();
     }
@@ -776,6 +771,195 @@ void CurveEditor::changeListenerCallback (ChangeBroadcaster* cb)
     updateLineThickness();
 }
 
+//==============================================================================
+void CurveEditor::curveChanged()
+{
+    shapeNeedsUpdating = true;
+    repaint();
+}
+
+double CurveEditor::getSecondsPerVertex() const
+{
+    // A vertex every couple of pixels can't be told apart from the true curve
+    return jmax (1.0e-6, 2.0 * (rightTime - leftTime) / jmax (1, getWidth()));
+}
+
+void CurveEditor::updateShapeIfNeeded (bool checkVisiblePoints)
+{
+    const auto numPoints = getNumPoints();
+    const auto secondsPerVertex = getSecondsPerVertex();
+
+    if (numPoints != (int) shape.points.size()
+         || secondsPerVertex < shape.secondsPerVertex * 0.5
+         || secondsPerVertex > shape.secondsPerVertex * 2.0)
+        shapeNeedsUpdating = true;
+
+    // Catch any changes to the points on screen that the editor wasn't told about
+    if (checkVisiblePoints && ! shapeNeedsUpdating)
+    {
+        for (int i = jmax (0, getShapeIndexAfter (leftTime) - 1); i < numPoints; ++i)
+        {
+            auto& p = shape.points[(size_t) i];
+
+            if (p.time != getPointTime (i) || p.value != getPointValue (i) || p.curve != getPointCurve (i))
+            {
+                shapeNeedsUpdating = true;
+                break;
+            }
+
+            if (p.time > rightTime)
+                break;
+        }
+    }
+
+    if (shapeNeedsUpdating)
+        updateShape();
+}
+
+void CurveEditor::updateShape()
+{
+    CRASH_TRACER
+    shapeNeedsUpdating = false;
+
+    // The segments are only reused if they were flattened for a similar zoom level
+    const auto numPoints = (size_t) jmax (0, getNumPoints());
+    const auto secondsPerVertex = getSecondsPerVertex();
+    const bool canReuseSegments = secondsPerVertex >= shape.secondsPerVertex * 0.5
+                                    && secondsPerVertex <= shape.secondsPerVertex * 2.0;
+
+    Shape newShape;
+    newShape.secondsPerVertex = canReuseSegments ? shape.secondsPerVertex : secondsPerVertex;
+    newShape.points.resize (numPoints);
+    newShape.pointVertices.resize (numPoints);
+    newShape.vertices.reserve (jmax (numPoints, shape.vertices.size()));
+
+    for (size_t i = 0; i < numPoints; ++i)
+    {
+        auto& p = newShape.points[i];
+        p.time = getPointTime ((int) i);
+        p.value = getPointValue ((int) i);
+        p.curve = getPointCurve ((int) i);
+    }
+
+    auto isSameSegment = [&] (size_t newIndex, size_t oldIndex)
+    {
+        auto& n1 = newShape.points[newIndex];
+        auto& n2 = newShape.points[newIndex + 1];
+        auto& o1 = shape.points[oldIndex];
+        auto& o2 = shape.points[oldIndex + 1];
+
+        return n1.time == o1.time && n1.value == o1.value && n1.curve == o1.curve
+            && n2.time == o2.time && n2.value == o2.value;
+    };
+
+    // Both sets of points are in time order so the unchanged segments can be found in one pass
+    size_t oldIndex = 0;
+
+    for (size_t i = 0; i < numPoints; ++i)
+    {
+        auto& p = newShape.points[i];
+        newShape.pointVertices[i] = newShape.vertices.size();
+        newShape.vertices.push_back ({ p.time, p.value });
+
+        if (i + 1 == numPoints)
+            break;
+
+        while (oldIndex + 1 < shape.points.size() && shape.points[oldIndex].time < p.time)
+            ++oldIndex;
+
+        if (canReuseSegments && oldIndex + 1 < shape.points.size() && isSameSegment (i, oldIndex))
+        {
+            p.handle = shape.points[oldIndex].handle;
+            newShape.vertices.insert (newShape.vertices.end(),
+                                      shape.vertices.begin() + (std::ptrdiff_t) shape.pointVertices[oldIndex] + 1,
+                                      shape.vertices.begin() + (std::ptrdiff_t) shape.pointVertices[oldIndex + 1]);
+        }
+        else
+        {
+            p.handle = getBezierHandle ((int) i);
+
+            if (p.curve != 0.0f)
+                addCurvedSegment (newShape, i, newShape.vertices);
+        }
+    }
+
+    shape = std::move (newShape);
+}
+
+void CurveEditor::addCurvedSegment (const Shape& s, size_t index, std::vector<CurvePoint>& vertices)
+{
+    auto& p1 = s.points[index];
+    auto& p2 = s.points[index + 1];
+    const auto bp = getBezierPoint ((int) index);
+
+    auto addQuadratic = [&] (CurvePoint start, CurvePoint end)
+    {
+        const auto numSteps = jlimit (2, 256, (int) ((end.time - start.time) / s.secondsPerVertex));
+
+        for (int step = 1; step < numSteps; ++step)
+        {
+            const auto t = step / (double) numSteps;
+            const auto a = (1.0 - t) * (1.0 - t), b = 2.0 * (1.0 - t) * t, c = t * t;
+
+            vertices.push_back ({ a * start.time + b * bp.time + c * end.time,
+                                  (float) (a * start.value + b * bp.value + c * end.value) });
+        }
+    };
+
+    if (p1.curve >= -0.5f && p1.curve <= 0.5f)
+    {
+        addQuadratic ({ p1.time, p1.value }, { p2.time, p2.value });
+        return;
+    }
+
+    double x1, x2;
+    float y1, y2;
+    getBezierEnds ((int) index, x1, y1, x2, y2);
+
+    vertices.push_back ({ x1, y1 });
+    addQuadratic ({ x1, y1 }, { x2, y2 });
+    vertices.push_back ({ x2, y2 });
+}
+
+int CurveEditor::getShapeIndexAfter (double time) const
+{
+    return (int) (std::lower_bound (shape.points.begin(), shape.points.end(), time,
+                                    [] (const CachedPoint& p, double t) { return p.time < t; })
+                    - shape.points.begin());
+}
+
+float CurveEditor::getShapeValueAt (double time)
+{
+    if (shape.points.empty())
+        return getValueAt (time);
+
+    const auto index = (size_t) getShapeIndexAfter (time);
+
+    if (index == 0)
+        return shape.points.front().value;
+
+    if (index >= shape.points.size())
+        return shape.points.back().value;
+
+    // Interpolate between the vertices of the segment either side
+    auto first = shape.vertices.begin() + (std::ptrdiff_t) shape.pointVertices[index - 1];
+    auto last = shape.vertices.begin() + (std::ptrdiff_t) shape.pointVertices[index] + 1;
+    auto next = std::upper_bound (first, last, time, [] (double t, const CurvePoint& v) { return t < v.time; });
+
+    if (next == first)
+        return first->value;
+
+    if (next == last)
+        return (last - 1)->value;
+
+    auto prev = next - 1;
+
+    if (next->time <= prev->time)
+        return next->value;
+
+    return prev->value + (float) ((time - prev->time) / (next->time - prev->time)) * (next->value - prev->value);
+}
+
 Edit& CurveEditor::getEdit() const
 {
     return edit;
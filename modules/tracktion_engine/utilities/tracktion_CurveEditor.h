@@ -124,6 +124,13 @@ public:
 
     void selectPoint (int pointIdx, bool addToSelection);
 
+    /** Tells the editor its curve has changed so the cached shape is updated before it's
+        next drawn or hit-tested. Subclasses should call this when the curve is changed by
+        something other than the editor, e.g. an undo. Changes to the points on screen are
+        also spotted when the editor repaints.
+    */
+    void curveChanged();
+
 protected:
     void updatePointUnderMouse (juce::Point<float>);
     virtual void showBubbleForPointUnderMouse() = 0;
@@ -156,6 +163,38 @@ protected:
     float defaultCurve = 0;
     float lineThickness = 1.0f;
 
+private:
+    //==============================================================================
+    struct CachedPoint
+    {
+        double time = 0;
+        float value = 0, curve = 0;
+        CurvePoint handle;      /**< The bezier handle of the segment following this point. */
+    };
+
+    /** A copy of the curve with each segment flattened in to a polyline, in time and value
+        so it doesn't change when scrolling. Curved segments have a vertex every few pixels,
+        at the zoom level they were calculated for. Everything can then be drawn and
+        hit-tested by only looking at the points on screen and without calling the getters.
+    */
+    struct Shape
+    {
+        std::vector<CachedPoint> points;
+        std::vector<CurvePoint> vertices;
+        std::vector<size_t> pointVertices;      /**< The index in vertices of each point. */
+        double secondsPerVertex = 0;
+    };
+
+    Shape shape;
+    bool shapeNeedsUpdating = true;
+
+    void updateShapeIfNeeded (bool checkVisiblePoints);
+    void updateShape();
+    void addCurvedSegment (const Shape&, size_t index, std::vector<CurvePoint>& vertices);
+    double getSecondsPerVertex() const;
+    int getShapeIndexAfter (double time) const;
+    float getShapeValueAt (double time);
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CurveEditor)
 };
 
@@ -12,53 +12,168 @@ namespace tracktion_engine
 {
 
 /**
-    An extremely naive ditherer.
-    TODO: this could be done much better!
+    Adds triangular (TPDF) dither to a set of channels and quantises them to a lower bit
+    depth, optionally shaping the quantisation noise so less of it is audible.
+
+    All the channels are processed in one call, either in place as floats that land exactly
+    on the target bit depth's steps, or straight into the 32-bit ints that
+    juce::AudioFormatWriter::write() takes, which saves a separate conversion pass.
+
+    The random numbers come from several independent generators per channel, so they're
+    produced a block at a time in loops the compiler can vectorise. Without noise shaping
+    the rest of the work vectorises too. The noise-shaping filters feed the error back sample
+    by sample, so that part runs one channel at a time.
+
+    Near-silent samples aren't dithered, so digital silence stays silent.
 */
-struct Ditherer
+class Ditherer
 {
-    void reset (int numBits) noexcept
+public:
+    enum class NoiseShaping
+    {
+        none,           /**< Plain TPDF dither with a flat noise spectrum. */
+        secondOrder,    /**< A gentle second-order high-pass shape, which is what this has always used. */
+        weighted        /**< Wannamaker's three-tap F-weighted filter, which moves the noise to where the ear is least sensitive. */
+    };
+
+    Ditherer() = default;
+
+    /** Prepares for a number of channels and a target bit depth, clearing the filters.
+        This allocates so shouldn't be called on the audio thread.
+    */
+    void reset (int numChannelsToUse, int numBits, NoiseShaping shapingToUse = NoiseShaping::secondOrder)
     {
-        auto wordLen = std::pow (2.0f, (float)(numBits - 1));
-        auto invWordLen = 1.0f / wordLen;
-        amp = invWordLen / RAND_MAX;
-        offset = invWordLen * 0.5f;
+        // A float can't hold any more than 24 bits, so deeper targets don't need dithering
+        const bool needsDither = numBits <= 24;
+        numBits = juce::jlimit (2, 24, numBits);
+
+        scale = (float) (1 << (numBits - 1));
+        invScale = 1.0f / scale;
+        intShift = 32 - numBits;
+        shaping = shapingToUse;
+
+        channels.resize (needsDither ? (size_t) juce::jmax (0, numChannelsToUse) : 0);
+        juce::uint32 seed = 0x12345678;
+
+        for (auto& c : channels)
+        {
+            c = {};
+
+            for (auto& s : c.randomState)
+                s = (seed = seed * 747796405u + 2891336453u);
+        }
     }
 
+    int getNumChannels() const noexcept     { return (int) channels.size(); }
+
     //==============================================================================
-    void process (float* samps, int num) noexcept
+    /** Dithers and quantises the channels in place. Channels beyond getNumChannels() are left alone. */
+    void process (float* const* channelData, int numChannels, int numSamples) noexcept
+    {
+        numChannels = std::min (numChannels, getNumChannels());
+
+        for (int chan = 0; chan < numChannels; ++chan)
+            processChannel (channels[(size_t) chan], channelData[chan], numSamples,
+                            [this, d = channelData[chan]] (int i, float q) noexcept { d[i] = q * invScale; });
+    }
+
+    /** Dithers the source channels and writes them as full-scale 32-bit ints, ready for
+        juce::AudioFormatWriter::write(). Channels beyond getNumChannels() are converted without dither.
+    */
+    void processToInts (const float* const* source, int* const* dest, int numChannels, int numSamples) noexcept
     {
-        while (--num >= 0)
+        const auto numDithered = std::min (numChannels, getNumChannels());
+
+        for (int chan = 0; chan < numDithered; ++chan)
+            processChannel (channels[(size_t) chan], source[chan], numSamples,
+                            [this, d = dest[chan]] (int i, float q) noexcept { d[i] = ((int) q) * (1 << intShift); });
+
+        for (int chan = numDithered; chan < numChannels; ++chan)
+            for (int i = 0; i < numSamples; ++i)
+                dest[chan][i] = ((int) clampToRange (std::round (source[chan][i] * scale))) * (1 << intShift);
+    }
+
+private:
+    //==============================================================================
+    static constexpr int numGenerators = 8;
+    static constexpr int blockSize = 64;
+
+    struct ChannelState
+    {
+        juce::uint32 randomState[numGenerators] = {};
+        float error[3] = {};
+    };
+
+    std::vector<ChannelState> channels;
+    float scale = 32768.0f, invScale = 1.0f / 32768.0f;
+    int intShift = 16;
+    NoiseShaping shaping = NoiseShaping::secondOrder;
+
+    float clampToRange (float q) const noexcept     { return juce::jlimit (-scale, scale - 1.0f, q); }
+
+    /** Fills the block with TPDF noise between -1 and 1 step. num must be a multiple of numGenerators. */
+    static void createNoise (ChannelState& state, float* noise, int num) noexcept
+    {
+        constexpr float toUnit = 1.0f / 4294967296.0f;
+
+        for (int i = 0; i < num; i += numGenerators)
+        {
+            for (int g = 0; g < numGenerators; ++g)
+            {
+                // Two steps of an LCG give two independent uniform values which sum to a triangular one
+                auto a = state.randomState[g] * 1664525u + 1013904223u;
+                auto b = a * 1664525u + 1013904223u;
+                state.randomState[g] = b;
+                noise[i + g] = (float) a * toUnit - (float) b * toUnit;
+            }
+        }
+    }
+
+    template<typename WriteFn>
+    void processChannel (ChannelState& state, const float* input, int numSamples, WriteFn&& write) noexcept
+    {
+        float noise[blockSize];
+
+        for (int start = 0; start < numSamples; start += blockSize)
         {
-            random2 = random1;
-            random1 = rand();
+            const int num = std::min (blockSize, numSamples - start);
+            const auto* in = input + start;
+            createNoise (state, noise, (num + numGenerators - 1) / numGenerators * numGenerators);
 
-            auto in = *samps;
+            for (int i = 0; i < num; ++i)
+                noise[i] = std::abs (in[i]) > 0.000001f ? noise[i] : 0.0f;
 
-            // check for dodgy numbers coming in..
-            if (in < -0.000001f || in > 0.000001f)
+            if (shaping == NoiseShaping::none)
             {
-                in += 0.5f * (s1 + s1 - s2);
-                auto out = in + offset + amp * (float)(random1 - random2);
-                *samps++ = out;
-                s2 = s1;
-                s1 = in - out;
+                for (int i = 0; i < num; ++i)
+                    write (start + i, clampToRange (std::round (in[i] * scale + noise[i])));
+
+                continue;
             }
-            else
+
+            // Error feedback: the shaped error from previous samples is subtracted before quantising
+            const float c0 = shaping == NoiseShaping::weighted ? 1.623f : 1.0f;
+            const float c1 = shaping == NoiseShaping::weighted ? -0.982f : -0.5f;
+            const float c2 = shaping == NoiseShaping::weighted ? 0.109f : 0.0f;
+            auto e0 = state.error[0], e1 = state.error[1], e2 = state.error[2];
+
+            for (int i = 0; i < num; ++i)
             {
-                *samps++ = in;
-                in += 0.5f * (s1 + s1 - s2);
-                auto out = in + offset + amp * (float)(random1 - random2);
-                s2 = s1;
-                s1 = in - out;
+                const auto v = in[i] * scale - (c0 * e0 + c1 * e1 + c2 * e2);
+                const auto q = clampToRange (std::round (v + noise[i]));
+
+                e2 = e1;
+                e1 = e0;
+                e0 = noise[i] != 0.0f ? q - v : 0.0f;    // Let the filter settle in silence
+
+                write (start + i, q);
             }
+
+            state.error[0] = e0;
+            state.error[1] = e1;
+            state.error[2] = e2;
         }
     }
-
-    //==============================================================================
-    int random1 = 0, random2 = 0;
-    float amp = 0, offset = 0;
-    float s1 = 0, s2 = 0;
 };
 
 } // namespace tracktion_engine
@@ -48,46 +48,49 @@ void Engine::initialise()
 {
     Selectable::initialise();
 
-    projectManager.reset (new ProjectManager (*this));
     activeEdits.reset (new ActiveEdits());
-    temporaryFileManager.reset (new TemporaryFileManager (*this));
-    recordingThumbnailManager.reset (new RecordingThumbnailManager (*this));
-    waveInputRecordingThread.reset (new WaveInputRecordingThread (*this));
     editDeleter.reset (new EditDeleter());
     audioFileFormatManager.reset (new AudioFileFormatManager());
     midiLearnState.reset (new MidiLearnState (*this));
     renderManager.reset (new RenderManager (*this));
-    audioFileManager.reset (new AudioFileManager (*this));
+    realtimeWorkerPool.reset (new RealtimeWorkerPool());
+    realtimeWorkerPool->setNumaAware (engineBehaviour->shouldUseNumaAwareProcessing());
     deviceManager.reset (new DeviceManager (*this));
-    midiProgramManager.reset (new MidiProgramManager (*this));
-
-    externalControllerManager.reset (new ExternalControllerManager (*this));
     backgroundJobManager.reset (new BackgroundJobManager());
-    pluginManager.reset (new PluginManager (*this));
-
-    if (engineBehaviour->autoInitialiseDeviceManager())
-        deviceManager->initialise();
 
-    pluginManager->initialise();
-    getProjectManager().initialise();
+    // Everything else is created when it's first used, apart from the devices and
+    // control surfaces, which need to be running from the start
+    if (! engineBehaviour->isHeadless())
+    {
+        if (engineBehaviour->autoInitialiseDeviceManager())
+            deviceManager->initialise();
 
-    externalControllerManager->initialise();
+        getExternalControllerManager();
+    }
 }
 
 Engine::~Engine()
 {
-    getProjectManager().saveList();
+    // This uses the caches, so it needs to go first
+    memoryGovernor.reset();
+
+    if (auto pm = projectManager.getIfCreated())
+        pm->saveList();
+
+    if (auto ecm = externalControllerManager.getIfCreated())
+        ecm->shutdown();
 
-    getExternalControllerManager().shutdown();
     getDeviceManager().closeDevices();
     getBackgroundJobs().stopAndDeleteAllRunningJobs();
 
-    temporaryFileManager->cleanUp();
+    if (auto tfm = temporaryFileManager.getIfCreated())
+        tfm->cleanUp();
 
     editDeleter.reset();
 
     getRenderManager().cleanUp();
     backgroundJobManager.reset();
+    audioSettingsTuner.reset();
     deviceManager.reset();
     midiProgramManager.reset();
 
@@ -98,6 +101,7 @@ Engine::~Engine()
     projectManager.reset();
 
     renderManager.reset();
+    realtimeWorkerPool.reset();
     externalControllerManager.reset();
     propertyStorage.reset();
     uiBehaviour.reset();
@@ -125,8 +129,9 @@ Engine& Engine::getInstance()
 
 ProjectManager& Engine::getProjectManager() const
 {
-    jassert (projectManager != nullptr);
-    return *projectManager;
+    return projectManager.get (subsystemCreationLock,
+                               [this] { return std::unique_ptr<ProjectManager> (new ProjectManager (const_cast<Engine&> (*this))); },
+                               [] (ProjectManager& pm) { pm.initialise(); });
 }
 
 AudioFileFormatManager& Engine::getAudioFileFormatManager() const
@@ -141,16 +146,35 @@ DeviceManager& Engine::getDeviceManager() const
     return *deviceManager;
 }
 
+AudioSettingsTuner& Engine::getAudioSettingsTuner() const
+{
+    return audioSettingsTuner.get (subsystemCreationLock,
+                                   [this] { return std::unique_ptr<AudioSettingsTuner> (new AudioSettingsTuner (const_cast<Engine&> (*this))); },
+                                   [] (AudioSettingsTuner&) {});
+}
+
+RealtimeWorkerPool& Engine::getRealtimeWorkerPool() const
+{
+    jassert (realtimeWorkerPool != nullptr);
+    return *realtimeWorkerPool;
+}
+
 MidiProgramManager& Engine::getMidiProgramManager() const
 {
-    jassert (midiProgramManager);
-    return *midiProgramManager;
+    return midiProgramManager.get (subsystemCreationLock,
+                                   [this] { return std::unique_ptr<MidiProgramManager> (new MidiProgramManager (const_cast<Engine&> (*this))); },
+                                   [] (MidiProgramManager&) {});
 }
 
 ExternalControllerManager& Engine::getExternalControllerManager() const
 {
-    jassert (externalControllerManager != nullptr);
-    return *externalControllerManager;
+    return externalControllerManager.get (subsystemCreationLock,
+                                          [this] { return std::unique_ptr<ExternalControllerManager> (new ExternalControllerManager (const_cast<Engine&> (*this))); },
+                                          [this] (ExternalControllerManager& ecm)
+                                          {
+                                              if (! getEngineBehaviour().isHeadless())
+                                                  ecm.initialise();
+                                          });
 }
 
 RenderManager& Engine::getRenderManager() const
@@ -185,8 +209,9 @@ EngineBehaviour& Engine::getEngineBehaviour() const
 
 AudioFileManager& Engine::getAudioFileManager() const
 {
-    jassert (audioFileManager != nullptr);
-    return *audioFileManager;
+    return audioFileManager.get (subsystemCreationLock,
+                                 [this] { return std::unique_ptr<AudioFileManager> (new AudioFileManager (const_cast<Engine&> (*this))); },
+                                 [] (AudioFileManager&) {});
 }
 
 MidiLearnState& Engine::getMidiLearnState() const
@@ -197,8 +222,9 @@ MidiLearnState& Engine::getMidiLearnState() const
 
 PluginManager& Engine::getPluginManager() const
 {
-    jassert (pluginManager != nullptr);
-    return *pluginManager;
+    return pluginManager.get (subsystemCreationLock,
+                              [this] { return std::unique_ptr<PluginManager> (new PluginManager (const_cast<Engine&> (*this))); },
+                              [] (PluginManager& pm) { pm.initialise(); });
 }
 
 EditDeleter& Engine::getEditDeleter() const
@@ -209,20 +235,30 @@ EditDeleter& Engine::getEditDeleter() const
 
 TemporaryFileManager& Engine::getTemporaryFileManager() const
 {
-    jassert (temporaryFileManager != nullptr);
-    return *temporaryFileManager;
+    return temporaryFileManager.get (subsystemCreationLock,
+                                     [this] { return std::unique_ptr<TemporaryFileManager> (new TemporaryFileManager (const_cast<Engine&> (*this))); },
+                                     [] (TemporaryFileManager&) {});
 }
 
 RecordingThumbnailManager& Engine::getRecordingThumbnailManager() const
 {
-    jassert (recordingThumbnailManager != nullptr);
-    return *recordingThumbnailManager;
+    return recordingThumbnailManager.get (subsystemCreationLock,
+                                          [this] { return std::unique_ptr<RecordingThumbnailManager> (new RecordingThumbnailManager (const_cast<Engine&> (*this))); },
+                                          [] (RecordingThumbnailManager&) {});
 }
 
 WaveInputRecordingThread& Engine::getWaveInputRecordingThread() const
 {
-    jassert (waveInputRecordingThread != nullptr);
-    return *waveInputRecordingThread;
+    return waveInputRecordingThread.get (subsystemCreationLock,
+                                         [this] { return std::unique_ptr<WaveInputRecordingThread> (new WaveInputRecordingThread (const_cast<Engine&> (*this))); },
+                                         [] (WaveInputRecordingThread&) {});
+}
+
+MemoryGovernor& Engine::getMemoryGovernor() const
+{
+    return memoryGovernor.get (subsystemCreationLock,
+                               [this] { return std::make_unique<MemoryGovernor> (const_cast<Engine&> (*this)); },
+                               [] (MemoryGovernor&) {});
 }
 
 ActiveEdits& Engine::getActiveEdits() const noexcept
@@ -18,6 +18,11 @@ namespace tracktion_engine
     customise how the engine behaves or pass nullptr to use the defaults.
     To get going quickly, just use the constructor that takes an application name,
     which uses default settings.
+
+    Most of the subsystems, such as the PluginManager and ProjectManager, aren't created
+    until they're first asked for, so an Engine that's only used for a few things, e.g.
+    in a render worker, starts quickly. Return true from EngineBehaviour::isHeadless() to
+    also stop it opening any devices or control surfaces.
 */
 class Engine
 {
@@ -39,6 +44,8 @@ public:
     UIBehaviour& getUIBehaviour() const;
     EngineBehaviour& getEngineBehaviour() const;
     DeviceManager& getDeviceManager() const;
+    AudioSettingsTuner& getAudioSettingsTuner() const;
+    RealtimeWorkerPool& getRealtimeWorkerPool() const;
     MidiProgramManager& getMidiProgramManager() const;
     ExternalControllerManager& getExternalControllerManager() const;
     RenderManager& getRenderManager() const;
@@ -49,6 +56,7 @@ public:
     EditDeleter& getEditDeleter() const;
     RecordingThumbnailManager& getRecordingThumbnailManager() const;
     WaveInputRecordingThread& getWaveInputRecordingThread() const;
+    MemoryGovernor& getMemoryGovernor() const;
     ActiveEdits& getActiveEdits() const noexcept;
     GrooveTemplateManager& getGrooveTemplateManager();
     CompFactory& getCompFactory() const;
@@ -60,23 +68,70 @@ public:
 private:
     void initialise();
 
-    std::unique_ptr<ProjectManager> projectManager;
-    std::unique_ptr<TemporaryFileManager> temporaryFileManager;
+    //==============================================================================
+    /** Holds a subsystem that's created the first time it's asked for.
+        That can happen on any thread, so it's created under a lock and only published to
+        other threads once it's been initialised. The thread creating it can use it whilst
+        it's being initialised, in case that needs it.
+    */
+    template<typename Type>
+    struct LazySubsystem
+    {
+        template<typename CreateFn, typename InitialiseFn>
+        Type& get (juce::CriticalSection& lock, CreateFn&& create, InitialiseFn&& initialise) const
+        {
+            if (auto o = published.load (std::memory_order_acquire))
+                return *o;
+
+            const juce::ScopedLock sl (lock);
+
+            if (object == nullptr)
+            {
+                object = create();
+                initialise (*object);
+                published.store (object.get(), std::memory_order_release);
+            }
+
+            return *object;
+        }
+
+        /** Returns the subsystem if it's been created. This should only be used on
+            shutdown when nothing else can be creating it.
+        */
+        Type* getIfCreated() const noexcept     { return object.get(); }
+
+        void reset()
+        {
+            published = nullptr;
+            object.reset();
+        }
+
+        mutable std::unique_ptr<Type> object;
+        mutable std::atomic<Type*> published { nullptr };
+    };
+
+    mutable juce::CriticalSection subsystemCreationLock;
+
+    LazySubsystem<ProjectManager> projectManager;
+    LazySubsystem<TemporaryFileManager> temporaryFileManager;
     std::unique_ptr<AudioFileFormatManager> audioFileFormatManager;
+    std::unique_ptr<RealtimeWorkerPool> realtimeWorkerPool;
     std::unique_ptr<DeviceManager> deviceManager;
-    std::unique_ptr<MidiProgramManager> midiProgramManager;
+    LazySubsystem<AudioSettingsTuner> audioSettingsTuner;
+    LazySubsystem<MidiProgramManager> midiProgramManager;
     std::unique_ptr<PropertyStorage> propertyStorage;
     std::unique_ptr<EngineBehaviour> engineBehaviour;
     std::unique_ptr<UIBehaviour> uiBehaviour;
-    std::unique_ptr<ExternalControllerManager> externalControllerManager;
+    LazySubsystem<ExternalControllerManager> externalControllerManager;
     std::unique_ptr<BackgroundJobManager> backgroundJobManager;
     std::unique_ptr<RenderManager> renderManager;
-    std::unique_ptr<AudioFileManager> audioFileManager;
+    LazySubsystem<AudioFileManager> audioFileManager;
     std::unique_ptr<MidiLearnState> midiLearnState;
-    std::unique_ptr<PluginManager> pluginManager;
+    LazySubsystem<PluginManager> pluginManager;
     std::unique_ptr<EditDeleter> editDeleter;
-    std::unique_ptr<RecordingThumbnailManager> recordingThumbnailManager;
-    std::unique_ptr<WaveInputRecordingThread> waveInputRecordingThread;
+    LazySubsystem<RecordingThumbnailManager> recordingThumbnailManager;
+    LazySubsystem<WaveInputRecordingThread> waveInputRecordingThread;
+    LazySubsystem<MemoryGovernor> memoryGovernor;
     std::unique_ptr<ActiveEdits> activeEdits;
     mutable std::unique_ptr<GrooveTemplateManager> grooveTemplateManager;
     mutable std::unique_ptr<CompFactory> compFactory;
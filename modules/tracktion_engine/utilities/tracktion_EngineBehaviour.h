@@ -59,10 +59,38 @@ public:
       */
     virtual bool canScanPluginsOutOfProcess()                                       { return false; }
 
+    /** The longest a child process may take to scan one plugin file before it's killed and the
+        file gets blacklisted. Return 0 to wait forever, e.g. if plugins may show registration dialogs.
+    */
+    virtual int getPluginScanTimeoutSeconds()                                       { return 120; }
+
+    /** Return a group name to run an external plugin in a child process instead of this one.
+
+        Plugins given the same group share a process, so a crash only silences that group.
+        Return an empty string to load the plugin in this process as usual.
+        Sandboxed plugins can't show their editors yet.
+
+        This needs PluginManager::startChildProcessPluginHost() to be called from your
+        JUCEApplication::initialise() function, in the same way as for scanning.
+    */
+    virtual juce::String getSandboxProcessGroup (const juce::PluginDescription&)    { return {}; }
+
+    /** If this returns true, external plugins in an Edit that's being loaded are created one at a
+        time from the message loop after it opens, instead of all at once while it loads.
+        Until then they're bypassed, and the graph is rebuilt with their latency once they're ready.
+    */
+    virtual bool shouldLoadPluginsAfterEditOpens()                                  { return false; }
+
     // You may want to disable auto initialisation of the device manager if you
     // are using the engine in a plugin
     virtual bool autoInitialiseDeviceManager()                                      { return true; }
 
+    /** Return true for an Engine that's only used to render offline, e.g. in a render
+        worker process. The devices aren't opened, even if autoInitialiseDeviceManager()
+        returns true, and no control surfaces are created.
+    */
+    virtual bool isHeadless()                                                       { return false; }
+
     // some debate surrounds whether middle-C is C3, C4 or C5. In Tracktion we
     // default this value to 4
     virtual int getMiddleCOctave()                                                  { return 4; }
@@ -84,6 +112,14 @@ public:
 
     virtual int getNumberOfCPUsToUseForAudio()                                      { return juce::jmax (1, juce::SystemStats::getNumCpus()); }
 
+    /** If this returns true on a machine with more than one NUMA node, i.e. socket, the
+        RealtimeWorkerPool's threads and the graph players' threads are pinned to the nodes
+        in turn and the graph players keep independent parts of the graph, with their
+        buffers, on one node. This is only supported on Linux.
+        @see tracktion_graph::NumaTopology
+    */
+    virtual bool shouldUseNumaAwareProcessing()                                     { return false; }
+
     virtual bool areAudioClipsRemappedWhenTempoChanges()                            { return true; }
     virtual void setAudioClipsRemappedWhenTempoChanges (bool)                       {}
     virtual bool areAutoTempoClipsRemappedWhenTempoChanges()                        { return true; }
@@ -138,6 +174,55 @@ public:
         1: loopRangeDefinesSubsequentRepetitions    // The first section is the whole sequence, subsequent repitions are determined by the loop range.
     */
     virtual int getDefaultLoopedSequenceType()                                      { return 0; }
+
+    /** If this returns true, compressed audio files such as FLAC or Ogg are streamed straight from
+        the file by the AudioFileCache. If it returns false, clips using them play a proxy WAV copy.
+    */
+    virtual bool shouldStreamCompressedAudioFiles()                                 { return true; }
+
+    /** If this returns true, audio clips that need timestretching are stretched from their
+        source file as they play, so tempo and warp changes can be heard straight away rather
+        than after their proxy has been rendered. The proxy is still rendered, and is played
+        instead when a playback graph is built whilst the CPU is busy.
+    */
+    virtual bool shouldTimeStretchAudioClipsInRealtime()                            { return false; }
+
+    /** If this returns true, plugins whose input and output have been silent for longer than their
+        tail stop being processed until they get some audio or MIDI again.
+        This can save a lot of CPU in large, mostly silent Edits, but relies on plugins
+        reporting their tail lengths correctly, so it's off by default.
+        @see Plugin::canBeBypassedWhenSilent, Plugin::getTailLength
+    */
+    virtual bool shouldBypassPluginsWhenSilent()                                    { return false; }
+
+    /** If this returns true, when the CPU goes over DeviceManager::setCpuLimitBeforeMuting()
+        the plugins using the most CPU are bypassed one at a time until it's back under, rather
+        than muting all the output. Everything is only muted if there's nothing left to bypass.
+        @see Plugin::isBypassedToSaveCpu, DeviceManager::restorePluginsBypassedToSaveCpu
+    */
+    virtual bool shouldBypassHeaviestPluginsWhenOverloaded()                        { return false; }
+
+    /** If this returns true, racks are played by a tracktion_graph MultiThreadedNodePlayer so
+        that parallel branches inside them, such as the bands of a multiband split, are
+        processed on separate threads. It's limited to getNumberOfCPUsToUseForAudio() threads.
+        This needs ENABLE_EXPERIMENTAL_TRACKTION_GRAPH to be on, and shouldn't change
+        whilst racks are playing.
+    */
+    virtual bool shouldProcessRacksInParallel()                                     { return false; }
+
+    /** If this returns true, AirWindows plugins use their 64-bit processing code, converting
+        to and from doubles around each block. This costs a little more CPU but can reduce the
+        rounding error that builds up across long chains of them, e.g. when mastering.
+        This is read when the plugins are initialised.
+    */
+    virtual bool shouldProcessAirWindowsInDoublePrecision()                         { return false; }
+
+    /** If this returns true, long MP3 exports are split into sections that are encoded by
+        several LAME processes at once. The sections are encoded without the bit reservoir,
+        which costs a little quality at lower bitrates, so it's off by default.
+        @see LAMEManager::encodeWavFile
+    */
+    virtual bool shouldEncodeMP3sInParallel()                                       { return false; }
 };
 
 } // namespace tracktion_engine
@@ -53,7 +53,8 @@ juce::AudioPlayHead::CurrentPositionInfo getCurrentPositionInfo (Edit& edit)
 }
 
 //==============================================================================
-void synchroniseEditPosition (Edit& edit, const juce::AudioPlayHead::CurrentPositionInfo& info)
+void synchroniseEditPosition (Edit& edit, const juce::AudioPlayHead::CurrentPositionInfo& info,
+                              ClockDriftSmoother* driftSmoother)
 {
     if (info.bpm == 0.0)
         return;
@@ -77,9 +78,24 @@ void synchroniseEditPosition (Edit& edit, const juce::AudioPlayHead::CurrentPosi
         
         if (info.isPlaying)
         {
-            if (std::abs (timeOffset - currentPositionInSeconds) > (blockSizeInSeconds / 2.0))
+            const double error = timeOffset - currentPositionInSeconds;
+            auto& dm = edit.engine.getDeviceManager();
+
+            if (std::abs (error) > (blockSizeInSeconds / 2.0))
+            {
                 playhead->overridePosition (timeOffset);
-            
+
+                if (driftSmoother != nullptr)
+                {
+                    driftSmoother->reset();
+                    dm.setSpeedCompensation (0.0);
+                }
+            }
+            else if (driftSmoother != nullptr)
+            {
+                dm.setSpeedCompensation (driftSmoother->update (error, blockSizeInSeconds));
+            }
+
             if (! playhead->isPlaying())
                 playhead->play();
         }
@@ -89,6 +105,12 @@ void synchroniseEditPosition (Edit& edit, const juce::AudioPlayHead::CurrentPosi
             
             if (! playhead->isStopped())
                 playhead->stop();
+
+            if (driftSmoother != nullptr)
+            {
+                driftSmoother->reset();
+                edit.engine.getDeviceManager().setSpeedCompensation (0.0);
+            }
         }
     }
     
@@ -143,7 +165,7 @@ bool ExternalPlayheadSynchroniser::synchronise (juce::AudioPlayHead& playhead)
         if (sucess)
         {
             // Synchronise the Edit's position and tempo info based on the host
-            synchroniseEditPosition (edit, positionInfo);
+            synchroniseEditPosition (edit, positionInfo, &driftSmoother);
             
             return true;
         }
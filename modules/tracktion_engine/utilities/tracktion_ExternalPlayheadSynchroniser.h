@@ -15,8 +15,13 @@ namespace tracktion_engine
 /** Converts an Edit's internal transport information to a juce::AudioPlayHead::CurrentPositionInfo. */
 juce::AudioPlayHead::CurrentPositionInfo getCurrentPositionInfo (Edit&);
 
-/** Syncs an Edit's transport and tempo sequence to a juce AudioPlayHead. */
-void synchroniseEditPosition (Edit&, const juce::AudioPlayHead::CurrentPositionInfo&);
+/** Syncs an Edit's transport and tempo sequence to a juce AudioPlayHead.
+    If a ClockDriftSmoother is supplied, errors smaller than half a block are nudged away
+    by adjusting the DeviceManager's speed compensation instead of being left to build up
+    until the playhead has to jump.
+*/
+void synchroniseEditPosition (Edit&, const juce::AudioPlayHead::CurrentPositionInfo&,
+                              ClockDriftSmoother* driftSmoother = nullptr);
 
 
 //==============================================================================
@@ -59,6 +64,7 @@ private:
     Edit& edit;
     juce::AudioPlayHead::CurrentPositionInfo positionInfo;
     mutable juce::SpinLock positionInfoLock;
+    ClockDriftSmoother driftSmoother;
 };
 
 } // namespace tracktion_engine
@@ -108,6 +108,7 @@ namespace IDs
     DECLARE_ID (appVersion)
     DECLARE_ID (modifiedBy)
     DECLARE_ID (creationTime)
+    DECLARE_ID (autosaveJournal)
     DECLARE_ID (lastSignificantChange)
     DECLARE_ID (TEMPO)
     DECLARE_ID (TIMESIG)
@@ -212,6 +213,7 @@ namespace IDs
     DECLARE_ID (minNote)
     DECLARE_ID (maxNote)
     DECLARE_ID (openEnded)
+    DECLARE_ID (streamFromDisk)
     DECLARE_ID (SOUND)
     DECLARE_ID (threshold)
     DECLARE_ID (inputDb)
@@ -219,6 +221,7 @@ namespace IDs
     DECLARE_ID (ratio)
     DECLARE_ID (attack)
     DECLARE_ID (release)
+    DECLARE_ID (lookahead)
     DECLARE_ID (SIDECHAINCONNECTION)
     DECLARE_ID (SIDECHAINCONNECTIONS)
     DECLARE_ID (sidechainTrigger)
@@ -257,11 +260,15 @@ namespace IDs
     DECLARE_ID (showingTakes)
     DECLARE_ID (markerID)
     DECLARE_ID (semitonesUp)
+    DECLARE_ID (lowLatency)
     DECLARE_ID (mappings)
     DECLARE_ID (device)
     DECLARE_ID (channelL)
     DECLARE_ID (channelR)
     DECLARE_ID (manualAdjustMs)
+    DECLARE_ID (measuredLatencyMs)
+    DECLARE_ID (oversampling)
+    DECLARE_ID (oversamplingLinearPhase)
     DECLARE_ID (STEPCLIPVIEWSTATE)
     DECLARE_ID (PATTERN)
     DECLARE_ID (CHANNEL)
@@ -430,6 +437,7 @@ namespace IDs
     DECLARE_ID (copyColour)
     DECLARE_ID (trimToMarker)
     DECLARE_ID (renderEnabled)
+    DECLARE_ID (playLive)
     DECLARE_ID (RENDER)
     DECLARE_ID (renderType)
     DECLARE_ID (renderTracks)
@@ -445,6 +453,7 @@ namespace IDs
     DECLARE_ID (renderRemoveSilence)
     DECLARE_ID (renderNormalise)
     DECLARE_ID (renderDither)
+    DECLARE_ID (renderNoiseShaping)
     DECLARE_ID (renderAdjustBasedOnRMS)
     DECLARE_ID (renderMarkedRegion)
     DECLARE_ID (renderSelectedTracks)
@@ -456,6 +465,15 @@ namespace IDs
     DECLARE_ID (addRenderToLibrary)
     DECLARE_ID (reverseRender)
     DECLARE_ID (renderAddMetadata)
+    DECLARE_ID (RENDERREQUEST)
+    DECLARE_ID (renderClips)
+    DECLARE_ID (renderBlockSize)
+    DECLARE_ID (renderEndAllowance)
+    DECLARE_ID (renderCanRenderInMono)
+    DECLARE_ID (renderMustRenderInMono)
+    DECLARE_ID (renderMasterPlugins)
+    DECLARE_ID (renderAntiDenormalisationNoise)
+    DECLARE_ID (renderNumThreads)
     DECLARE_ID (height)
     DECLARE_ID (currentAutoParamPluginID)
     DECLARE_ID (currentAutoParamTag)
@@ -465,6 +483,7 @@ namespace IDs
     DECLARE_ID (soloIsolate)
     DECLARE_ID (frozen)
     DECLARE_ID (frozenIndividually)
+    DECLARE_ID (freezeSegments)
     DECLARE_ID (maxInputs)
     DECLARE_ID (compGroup)
     DECLARE_ID (midiVProp)
@@ -512,6 +531,7 @@ namespace IDs
     DECLARE_ID (highPassEnabled)
     DECLARE_ID (lowPassFrequency)
     DECLARE_ID (highPassFrequency)
+    DECLARE_ID (controlRate)
     DECLARE_ID (shape)
     DECLARE_ID (numActivePoints)
     DECLARE_ID (stageZeroValue)
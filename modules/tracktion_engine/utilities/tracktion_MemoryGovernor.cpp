@@ -0,0 +1,250 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+namespace MemoryGovernorHelpers
+{
+   #if JUCE_LINUX
+    /** Returns the value of a "name value" line in a /proc or cgroup file, or -1 if it's not there. */
+    static juce::int64 findValue (const juce::StringArray& lines, const juce::String& name)
+    {
+        for (auto& l : lines)
+            if (l.startsWith (name) && juce::CharacterFunctions::isWhitespace (l[name.length()]))
+                return l.substring (name.length()).trim().getLargeIntValue();
+
+        return -1;
+    }
+
+    static juce::int64 readNumber (const juce::File& f)
+    {
+        auto s = f.loadFileAsString().trim();
+
+        // cgroup v2 uses "max" for no limit
+        if (s.isEmpty() || ! s.containsOnly ("0123456789"))
+            return -1;
+
+        return s.getLargeIntValue();
+    }
+
+    /** Returns the memory available in the process's cgroup, if it has a limit. */
+    static bool getCgroupMemory (MemoryGovernor::SystemMemory& result)
+    {
+        const juce::File v2 ("/sys/fs/cgroup"), v1 ("/sys/fs/cgroup/memory");
+        const bool isV2 = v2.getChildFile ("memory.max").existsAsFile();
+        const auto& dir = isV2 ? v2 : v1;
+
+        const auto limit = readNumber (dir.getChildFile (isV2 ? "memory.max" : "memory.limit_in_bytes"));
+        const auto usage = readNumber (dir.getChildFile (isV2 ? "memory.current" : "memory.usage_in_bytes"));
+
+        // cgroup v1 reports no limit as a huge number, so anything bigger than the machine doesn't count
+        if (limit <= 0 || usage < 0 || (result.total > 0 && limit >= result.total))
+            return false;
+
+        // The page cache is counted in the usage but can be reclaimed, as the kernel does before OOM-killing
+        juce::StringArray stats;
+        stats.addLines (dir.getChildFile ("memory.stat").loadFileAsString());
+        const auto inactiveFile = std::max ((juce::int64) 0, findValue (stats, isV2 ? "inactive_file" : "total_inactive_file"));
+
+        result.total = limit;
+        result.available = std::max ((juce::int64) 0, limit - std::max ((juce::int64) 0, usage - inactiveFile));
+        return true;
+    }
+   #endif
+}
+
+//==============================================================================
+MemoryGovernor::MemoryGovernor (Engine& e)  : engine (e)
+{
+    addBuiltInCaches();
+}
+
+MemoryGovernor::~MemoryGovernor()
+{
+    stopTimer();
+}
+
+void MemoryGovernor::addBuiltInCaches()
+{
+    // These look the subsystems up each time as they're created lazily
+    addCache ({ "Thumbnail cache", thumbnailCachePriority,
+                [] { return (juce::int64) 0; },
+                [this] (juce::int64)
+                {
+                    // The thumbnails are saved to disk as they're finished, so these can be reloaded
+                    engine.getAudioFileManager().getAudioThumbnailCache().clear();
+                    return (juce::int64) 0;
+                } });
+
+    addCache ({ "Decoded audio", decodedAudioPriority,
+                [this] { return engine.getAudioFileManager().cache.getDecodedBytesInUse(); },
+                [this] (juce::int64 bytesToFree) { return engine.getAudioFileManager().cache.releaseDecodedBlocks (bytesToFree); } });
+
+    addCache ({ "Mapped audio", mappedAudioPriority,
+                [this] { return engine.getAudioFileManager().cache.getMappedBytesInUse(); },
+                [this] (juce::int64) { return engine.getAudioFileManager().cache.releaseUnusedFiles(); } });
+
+    // Proxies and renders only use memory if the temp folder's on a RAM disk, and walking
+    // the folders is too slow to do here, so this just trims them to their limits
+    addCache ({ "Temporary files", temporaryFilesPriority,
+                [] { return (juce::int64) 0; },
+                [this] (juce::int64)
+                {
+                    auto& tfm = engine.getTemporaryFileManager();
+
+                    if (! tfm.isCleaningUp())
+                        tfm.cleanUpInBackground();
+
+                    return (juce::int64) 0;
+                } });
+}
+
+void MemoryGovernor::addCache (Cache newCache)
+{
+    TRACKTION_ASSERT_MESSAGE_THREAD
+    jassert (newCache.getBytesInUse != nullptr && newCache.release != nullptr);
+
+    removeCache (newCache.name);
+
+    auto pos = std::upper_bound (caches.begin(), caches.end(), newCache.priority,
+                                 [] (int priority, const Cache& c) { return priority < c.priority; });
+    caches.insert (pos, std::move (newCache));
+}
+
+void MemoryGovernor::removeCache (const juce::String& name)
+{
+    TRACKTION_ASSERT_MESSAGE_THREAD
+    caches.erase (std::remove_if (caches.begin(), caches.end(), [&name] (const Cache& c) { return c.name == name; }),
+                  caches.end());
+}
+
+//==============================================================================
+void MemoryGovernor::setBudget (juce::int64 maxBytes)
+{
+    budget = std::max ((juce::int64) 0, maxBytes);
+    updateTimer();
+}
+
+void MemoryGovernor::setLowMemoryThreshold (juce::int64 minAvailableBytes)
+{
+    lowMemoryThreshold = std::max ((juce::int64) 0, minAvailableBytes);
+    updateTimer();
+}
+
+void MemoryGovernor::setCheckInterval (int milliseconds)
+{
+    checkIntervalMs = std::max (10, milliseconds);
+    updateTimer();
+}
+
+void MemoryGovernor::updateTimer()
+{
+    if (budget > 0 || lowMemoryThreshold > 0)
+        startTimer (checkIntervalMs);
+    else
+        stopTimer();
+}
+
+void MemoryGovernor::timerCallback()
+{
+    checkNow();
+}
+
+juce::int64 MemoryGovernor::getBytesInUse() const
+{
+    juce::int64 total = 0;
+
+    for (auto& c : caches)
+        total += c.getBytesInUse();
+
+    return total;
+}
+
+juce::int64 MemoryGovernor::checkNow()
+{
+    CRASH_TRACER
+    TRACKTION_ASSERT_MESSAGE_THREAD
+    juce::int64 bytesNeeded = 0;
+
+    if (budget > 0)
+        bytesNeeded = getBytesInUse() - budget;
+
+    if (lowMemoryThreshold > 0)
+    {
+        const auto memory = getSystemMemory();
+
+        if (memory.total > 0 && memory.available < lowMemoryThreshold)
+            bytesNeeded = std::max (bytesNeeded, lowMemoryThreshold - memory.available);
+    }
+
+    if (bytesNeeded <= 0)
+        return 0;
+
+    return shrinkCaches (bytesNeeded);
+}
+
+juce::int64 MemoryGovernor::shrinkCaches (juce::int64 bytesToFree)
+{
+    CRASH_TRACER
+    TRACKTION_ASSERT_MESSAGE_THREAD
+    juce::int64 bytesFreed = 0;
+
+    for (auto& c : caches)
+    {
+        if (bytesFreed >= bytesToFree)
+            break;
+
+        bytesFreed += std::max ((juce::int64) 0, c.release (bytesToFree - bytesFreed));
+    }
+
+    if (bytesFreed > 0)
+    {
+        TRACKTION_LOG ("Freed " + juce::File::descriptionOfSizeInBytes (bytesFreed) + " from caches");
+
+        if (onCachesShrunk != nullptr)
+            onCachesShrunk (bytesFreed);
+    }
+
+    return bytesFreed;
+}
+
+//==============================================================================
+MemoryGovernor::SystemMemory MemoryGovernor::getSystemMemory()
+{
+    SystemMemory result;
+
+   #if JUCE_LINUX
+    using namespace MemoryGovernorHelpers;
+
+    juce::StringArray lines;
+    lines.addLines (juce::File ("/proc/meminfo").loadFileAsString());
+
+    // These are in kB
+    const auto total = findValue (lines, "MemTotal:");
+    const auto available = findValue (lines, "MemAvailable:");
+
+    if (total > 0 && available >= 0)
+    {
+        result.total = total * 1024;
+        result.available = available * 1024;
+    }
+
+    SystemMemory cgroup;
+    cgroup.total = result.total;
+
+    if (getCgroupMemory (cgroup) && (result.total == 0 || cgroup.available < result.available))
+        result = cgroup;
+   #endif
+
+    return result;
+}
+
+} // namespace tracktion_engine
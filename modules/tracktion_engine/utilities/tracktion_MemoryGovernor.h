@@ -0,0 +1,119 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+/**
+    Keeps the Engine's caches within a memory budget, and shrinks them when the system
+    starts to run out of memory.
+
+    Each cache that can give memory back is registered with a priority. When the caches
+    add up to more than the budget, or the memory available falls below the low memory
+    threshold, they're asked to free what's needed in priority order, lowest first, until
+    enough has been freed. The audio file cache, the thumbnail cache and the temporary
+    files are registered to start with; others can be added with addCache().
+
+    The check happens regularly on the message thread once a budget or threshold has been
+    set. On Linux the available memory takes the limits of the process's cgroup into
+    account, so containers are shrunk before they're OOM-killed. Elsewhere only the budget
+    is used.
+
+    @see Engine::getMemoryGovernor
+*/
+class MemoryGovernor  : private juce::Timer
+{
+public:
+    //==============================================================================
+    /** A cache that can give memory back. */
+    struct Cache
+    {
+        juce::String name;
+
+        /** Caches with lower priorities are asked to shrink first. */
+        int priority = 0;
+
+        /** Should return the bytes the cache is using, or 0 if that isn't known. */
+        std::function<juce::int64()> getBytesInUse;
+
+        /** Should free roughly this many bytes if it can and return how many it did. */
+        std::function<juce::int64 (juce::int64 bytesToFree)> release;
+    };
+
+    /** The priorities of the built-in caches. */
+    enum BuiltInPriority
+    {
+        thumbnailCachePriority  = 100,
+        decodedAudioPriority    = 200,
+        mappedAudioPriority     = 300,
+        temporaryFilesPriority  = 400
+    };
+
+    //==============================================================================
+    MemoryGovernor (Engine&);
+    ~MemoryGovernor() override;
+
+    /** Adds a cache, replacing any that's already been added with the same name. */
+    void addCache (Cache);
+
+    /** Removes a cache that was added with addCache(). */
+    void removeCache (const juce::String& name);
+
+    //==============================================================================
+    /** Sets the most memory the caches should use between them. 0 means there's no budget. */
+    void setBudget (juce::int64 maxBytes);
+    juce::int64 getBudget() const noexcept                      { return budget; }
+
+    /** Sets how little available memory is treated as memory pressure. 0 turns this off. */
+    void setLowMemoryThreshold (juce::int64 minAvailableBytes);
+    juce::int64 getLowMemoryThreshold() const noexcept          { return lowMemoryThreshold; }
+
+    /** Sets how often the budget and available memory are checked. */
+    void setCheckInterval (int milliseconds);
+
+    /** Checks the budget and available memory now, shrinking the caches if needed.
+        This must be called on the message thread. Returns the number of bytes freed.
+    */
+    juce::int64 checkNow();
+
+    /** Asks the caches to free this many bytes, in priority order. Returns how many they did. */
+    juce::int64 shrinkCaches (juce::int64 bytesToFree);
+
+    /** Returns the total of what the caches say they're using. */
+    juce::int64 getBytesInUse() const;
+
+    //==============================================================================
+    /** The memory available to this process, taking any cgroup limit into account. */
+    struct SystemMemory
+    {
+        juce::int64 total = 0;          /**< 0 if this isn't known. */
+        juce::int64 available = 0;
+    };
+
+    static SystemMemory getSystemMemory();
+
+    /** Called after the caches have been shrunk, with the number of bytes freed. */
+    std::function<void (juce::int64)> onCachesShrunk;
+
+private:
+    //==============================================================================
+    Engine& engine;
+    std::vector<Cache> caches;
+    juce::int64 budget = 0, lowMemoryThreshold = 0;
+    int checkIntervalMs = 1000;
+
+    void addBuiltInCaches();
+    void updateTimer();
+    void timerCallback() override;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (MemoryGovernor)
+};
+
+} // namespace tracktion_engine
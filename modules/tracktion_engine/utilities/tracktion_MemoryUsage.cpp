@@ -0,0 +1,116 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+MemoryUsage MemoryUsage::getForEdit (Edit& edit)
+{
+    CRASH_TRACER
+    TRACKTION_ASSERT_MESSAGE_THREAD
+    MemoryUsage usage;
+
+    usage[Category::thumbnails] = edit.engine.getAudioFileManager().getThumbnailBytesInUse (&edit);
+    usage[Category::undoHistory] = edit.getUndoMemoryUsage();
+
+    if (auto context = edit.getTransport().getCurrentPlaybackContext())
+        usage[Category::playbackGraph] = context->getGraphMemoryUsage();
+
+    for (auto p : getAllPlugins (edit, false))
+    {
+        if (dynamic_cast<SamplerPlugin*> (p) != nullptr)
+            usage[Category::samplerSamples] += p->getMemoryUsage();
+        else
+            usage[Category::pluginState] += p->getMemoryUsage();
+    }
+
+    visitAllTrackItems (edit, [&usage] (TrackItem& t)
+                        {
+                            if (auto c = dynamic_cast<MidiClip*> (&t))
+                                if (c->hasValidSequence())
+                                    usage[Category::midiLists] += c->getSequence().getMemoryUsage();
+
+                            return true;
+                        });
+
+    return usage;
+}
+
+MemoryUsage MemoryUsage::getForEngine (Engine& engine)
+{
+    CRASH_TRACER
+    TRACKTION_ASSERT_MESSAGE_THREAD
+    MemoryUsage usage;
+
+    for (auto edit : engine.getActiveEdits().getEdits())
+        usage += getForEdit (*edit);
+
+    auto& afm = engine.getAudioFileManager();
+    usage[Category::audioFileCache] = afm.cache.getMappedBytesInUse();
+    usage[Category::decodedAudio] = afm.cache.getDecodedBytesInUse();
+    usage[Category::scratchBuffers] = (juce::int64) AudioScratchBuffer::getNumBytesAllocated();
+
+    // This also counts thumbnails that don't belong to an Edit, e.g. in a browser
+    usage[Category::thumbnails] = afm.getThumbnailBytesInUse();
+
+    return usage;
+}
+
+//==============================================================================
+juce::int64 MemoryUsage::getTotal() const noexcept
+{
+    juce::int64 total = 0;
+
+    for (auto b : bytes)
+        total += b;
+
+    return total;
+}
+
+MemoryUsage& MemoryUsage::operator+= (const MemoryUsage& other) noexcept
+{
+    for (int i = 0; i < (int) Category::numCategories; ++i)
+        bytes[i] += other.bytes[i];
+
+    return *this;
+}
+
+juce::String MemoryUsage::getName (Category c)
+{
+    switch (c)
+    {
+        case Category::audioFileCache:  return "Audio file cache";
+        case Category::decodedAudio:    return "Decoded audio";
+        case Category::thumbnails:      return "Thumbnails";
+        case Category::samplerSamples:  return "Sampler sounds";
+        case Category::playbackGraph:   return "Playback graph";
+        case Category::scratchBuffers:  return "Scratch buffers";
+        case Category::midiLists:       return "MIDI";
+        case Category::undoHistory:     return "Undo history";
+        case Category::pluginState:     return "Plugin state";
+        case Category::numCategories:   break;
+    }
+
+    jassertfalse;
+    return {};
+}
+
+juce::String MemoryUsage::toString() const
+{
+    juce::String s;
+
+    for (int i = 0; i < (int) Category::numCategories; ++i)
+        s << getName ((Category) i) << ": " << juce::File::descriptionOfSizeInBytes (bytes[i]) << juce::newLine;
+
+    s << "Total: " << juce::File::descriptionOfSizeInBytes (getTotal());
+    return s;
+}
+
+} // namespace tracktion_engine
@@ -0,0 +1,69 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+/**
+    A breakdown of the memory that an Edit, or the whole Engine, is holding on to.
+
+    Each number comes from a running total or a quick walk of what's loaded, so these can
+    be polled, e.g. once a second from a memory meter, from the message thread. Some of
+    them are estimates, e.g. MIDI lists are counted by their number of events, and the
+    memory that external plugins allocate themselves can't be seen, only the state they've
+    saved.
+
+    The audio file cache and scratch buffers are shared between all Edits so are only
+    included in getForEngine(). Proxy files are read through the audio file cache so are
+    included in its numbers.
+*/
+struct MemoryUsage
+{
+    enum class Category
+    {
+        audioFileCache,     /**< Memory-mapped sections of uncompressed audio files and proxies. */
+        decodedAudio,       /**< Decoded blocks of compressed audio files. */
+        thumbnails,         /**< The levels of SmartThumbnails. */
+        samplerSamples,     /**< The sounds loaded by SamplerPlugins. */
+        playbackGraph,      /**< The buffers of the Nodes in the playback graph. */
+        scratchBuffers,     /**< The arenas and pool that AudioScratchBuffers are taken from. */
+        midiLists,          /**< The events of MIDI clips. */
+        undoHistory,        /**< The transactions held by the Edit's UndoManager. */
+        pluginState,        /**< The state saved by other plugins. */
+        numCategories
+    };
+
+    /** Returns the usage for one Edit.
+        This doesn't include anything that's shared between Edits, e.g. the audio file cache.
+    */
+    static MemoryUsage getForEdit (Edit&);
+
+    /** Returns the usage for all the open Edits plus everything that's shared between them. */
+    static MemoryUsage getForEngine (Engine&);
+
+    //==============================================================================
+    juce::int64& operator[] (Category c) noexcept           { return bytes[(int) c]; }
+    juce::int64 operator[] (Category c) const noexcept      { return bytes[(int) c]; }
+
+    /** Returns the sum of all the categories. */
+    juce::int64 getTotal() const noexcept;
+
+    MemoryUsage& operator+= (const MemoryUsage&) noexcept;
+
+    /** Returns a readable name for a category. */
+    static juce::String getName (Category);
+
+    /** Returns a list of the categories and their sizes, e.g. to log. */
+    juce::String toString() const;
+
+    juce::int64 bytes[(int) Category::numCategories] = {};
+};
+
+} // namespace tracktion_engine
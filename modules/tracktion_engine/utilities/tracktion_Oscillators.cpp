@@ -74,36 +74,62 @@ void Oscillator::setSampleRate (double sr)
 }
 
 void Oscillator::process (AudioSampleBuffer& buffer, int startSample, int numSamples)
+{
+    auto* channels = buffer.getArrayOfWritePointers();
+    const int numChannels = buffer.getNumChannels();
+
+    render (numSamples, [&] (int samp, float value)
+    {
+        value *= gain;
+
+        for (int ch = 0; ch < numChannels; ch++)
+            channels[ch][startSample + samp] += value;
+    });
+}
+
+void Oscillator::processStereo (float* left, float* right, float leftGain, float rightGain, int numSamples)
+{
+    render (numSamples, [=] (int samp, float value)
+    {
+        left[samp]  += value * leftGain;
+        right[samp] += value * rightGain;
+    });
+}
+
+float Oscillator::getPhaseDelta() const
+{
+    const float frequency = jmin (float (sampleRate) / 2.0f, 440.0f * std::pow (2.0f, (note - 69.0f) / 12.0f));
+    const float period = 1.0f / float (frequency);
+    const float periodInSamples = float (period * sampleRate);
+    return 1.0f / periodInSamples;
+}
+
+template <typename AddSampleFn>
+void Oscillator::render (int numSamples, AddSampleFn&& addSample)
 {
     if (lookupTables != nullptr)
     {
         switch (wave)
         {
             case none:      break;
-            case sine:      processSine (buffer, startSample, numSamples);  break;
-            case square:    processSquare (buffer, startSample, numSamples);  break;
-            case saw:       processLookup (buffer, startSample, numSamples, lookupTables->sawUpFunctions);    break;
-            case triangle:  processLookup (buffer, startSample, numSamples, lookupTables->triangleFunctions); break;
-            case noise:     processNoise (buffer, startSample, numSamples); break;
+            case sine:      renderSine (numSamples, addSample);  break;
+            case square:    renderSquare (numSamples, addSample);  break;
+            case saw:       renderLookup (numSamples, addSample, lookupTables->sawUpFunctions);    break;
+            case triangle:  renderLookup (numSamples, addSample, lookupTables->triangleFunctions); break;
+            case noise:     renderNoise (numSamples, addSample); break;
+            case sawDown:   renderLookup (numSamples, addSample, lookupTables->sawDownFunctions);  break;
         }
     }
 }
 
-void Oscillator::processSine (AudioSampleBuffer& buffer, int startSample, int numSamples)
+template <typename AddSampleFn>
+void Oscillator::renderSine (int numSamples, AddSampleFn& addSample)
 {
-    const float frequency = jmin (float (sampleRate) / 2.0f, 440.0f * std::pow (2.0f, (note - 69.0f) / 12.0f));
-    const float period = 1.0f / float (frequency);
-    const float periodInSamples = float (period * sampleRate);
-    const float delta = 1.0f / periodInSamples;
-
-    auto* channels = buffer.getArrayOfWritePointers();
-    const int numChannels = buffer.getNumChannels();
+    const float delta = getPhaseDelta();
 
     for (int samp = 0; samp < numSamples; samp++)
     {
-        float value = lookupTables->sineFunction[phase] * gain;
-        for (int ch = 0; ch < numChannels; ch++)
-            channels[ch][startSample + samp] += value;
+        addSample (samp, lookupTables->sineFunction[phase]);
 
         phase += delta;
         while (phase >= 1.0f)
@@ -111,42 +137,27 @@ void Oscillator::processSine (AudioSampleBuffer& buffer, int startSample, int nu
     }
 }
 
-void Oscillator::processNoise (AudioSampleBuffer& buffer, int startSample, int numSamples)
+template <typename AddSampleFn>
+void Oscillator::renderNoise (int numSamples, AddSampleFn& addSample)
 {
-    auto* channels = buffer.getArrayOfWritePointers();
-    const int numChannels = buffer.getNumChannels();
-
     for (int samp = 0; samp < numSamples; samp++)
-    {
-        float value = normalDistribution (generator) * gain;
-        for (int ch = 0; ch < numChannels; ch++)
-            channels[ch][startSample + samp] += value;
-    }
+        addSample (samp, normalDistribution (generator));
 }
 
-void Oscillator::processLookup (juce::AudioSampleBuffer& buffer, int startSample, int numSamples,
-                                const juce::OwnedArray<juce::dsp::LookupTableTransform<float>>& tableSet)
+template <typename AddSampleFn>
+void Oscillator::renderLookup (int numSamples, AddSampleFn& addSample,
+                               const juce::OwnedArray<juce::dsp::LookupTableTransform<float>>& tableSet)
 {
-    const float frequency = jmin (float (sampleRate) / 2.0f, 440.0f * std::pow (2.0f, (note - 69.0f) / 12.0f));
-    const float period = 1.0f / float (frequency);
-    const float periodInSamples = float (period * sampleRate);
-    const float delta = 1.0f / periodInSamples;
-
-    auto* channels = buffer.getArrayOfWritePointers();
-    const int numChannels = buffer.getNumChannels();
+    const float delta = getPhaseDelta();
 
-    int tableIndex = jlimit (0, tableSet.size() - 1, int ((note - 0.5) / lookupTables->tablePerNumNotes));
-
-    auto table = tableSet[tableIndex];
+    auto table = tableSet[lookupTables->getTableIndex (note)];
     jassert (table != nullptr);
 
     if (table != nullptr)
     {
         for (int samp = 0; samp < numSamples; samp++)
         {
-            float value = table->processSampleUnchecked (phase) * gain;
-            for (int ch = 0; ch < numChannels; ch++)
-                channels[ch][startSample + samp] += value;
+            addSample (samp, table->processSampleUnchecked (phase));
 
             phase += delta;
             while (phase >= 1.0f)
@@ -155,17 +166,12 @@ void Oscillator::processLookup (juce::AudioSampleBuffer& buffer, int startSample
     }
 }
 
-void Oscillator::processSquare (juce::AudioSampleBuffer& buffer, int startSample, int numSamples)
+template <typename AddSampleFn>
+void Oscillator::renderSquare (int numSamples, AddSampleFn& addSample)
 {
-    const float frequency = jmin (float (sampleRate) / 2.0f, 440.0f * std::pow (2.0f, (note - 69.0f) / 12.0f));
-    const float period = 1.0f / float (frequency);
-    const float periodInSamples = float (period * sampleRate);
-    const float delta = 1.0f / periodInSamples;
+    const float delta = getPhaseDelta();
 
-    auto* channels = buffer.getArrayOfWritePointers();
-    const int numChannels = buffer.getNumChannels();
-
-    int tableIndex = jlimit (0, lookupTables->sawUpFunctions.size() - 1, int ((note - 0.5) / lookupTables->tablePerNumNotes));
+    const int tableIndex = lookupTables->getTableIndex (note);
 
     auto saw1 = lookupTables->sawUpFunctions[tableIndex];
     auto saw2 = lookupTables->sawDownFunctions[tableIndex];
@@ -182,11 +188,7 @@ void Oscillator::processSquare (juce::AudioSampleBuffer& buffer, int startSample
             if (phaseUp   > 1.0f) phaseUp   -= 1.0f;
             if (phaseDown < 0.0f) phaseDown += 1.0f;
 
-            float value = (saw1->processSampleUnchecked (phaseUp) +
-                           saw2->processSampleUnchecked (phaseDown)) * gain;
-
-            for (int ch = 0; ch < numChannels; ch++)
-                channels[ch][startSample + samp] += value;
+            addSample (samp, saw1->processSampleUnchecked (phaseUp) + saw2->processSampleUnchecked (phaseDown));
 
             phase += delta;
             while (phase >= 1.0f)
@@ -264,64 +266,68 @@ void MultiVoiceOscillator::setSpread (float s)
 
 void MultiVoiceOscillator::process (juce::AudioSampleBuffer& buffer, int startSample, int numSamples)
 {
-    if (voices == 1)
-    {
-        float leftGain  = 1.0f - pan;
-        float rightGain = 1.0f + pan;
-
-        for (int i = 0; i < 2; i++)
-        {
-            bool left = (i % 2) == 0;
-            float panGain = left ? leftGain : rightGain;
+    jassert (buffer.getNumChannels() >= 2);
 
-            float* data = buffer.getWritePointer (left ? 0 : 1, startSample);
-            float* dataPointers[] = {data};
+    float* left  = buffer.getWritePointer (0, startSample);
+    float* right = buffer.getWritePointer (1, startSample);
 
-            juce::AudioSampleBuffer channelBuffer (dataPointers, 1, numSamples);
+    const int numVoices = jmin (voices, oscillators.size() / 2);
 
-            oscillators[i]->setGain (gain * panGain / voices);
-            oscillators[i]->setNote (note);
-            oscillators[i]->process (channelBuffer, 0, numSamples);
-        }
-    }
-    else
+    for (int voiceIndex = 0; voiceIndex < numVoices; voiceIndex++)
     {
-        for (int i = 0; i < voices * 2; i++)
-        {
-            int voiceIndex = (i / 2);
-            float localPan = jlimit (-1.0f, 1.0f, ((voiceIndex % 2 == 0) ? 1 : -1) * spread);
+        float localPan = pan;
+        float voiceNote = note;
 
-            float leftGain  = 1.0f - localPan;
-            float rightGain = 1.0f + localPan;
+        if (voices > 1)
+        {
+            localPan = jlimit (-1.0f, 1.0f, ((voiceIndex % 2 == 0) ? 1 : -1) * spread);
+            voiceNote = (note - detune / 2) + detune / (voices - 1) * voiceIndex;
+        }
 
-            float base = note - detune / 2;
-            float delta = detune / (voices - 1);
-            bool left = (i % 2) == 0;
-            float panGain = left ? leftGain : rightGain;
+        const float leftGain  = gain * (1.0f - localPan) / voices;
+        const float rightGain = gain * (1.0f + localPan) / voices;
 
-            float* data = buffer.getWritePointer (left ? 0 : 1, startSample);
-            float* dataPointers[] = {data};
+        auto& l = *oscillators.getUnchecked (voiceIndex * 2 + 0);
+        auto& r = *oscillators.getUnchecked (voiceIndex * 2 + 1);
 
-            juce::AudioSampleBuffer channelBuffer (dataPointers, 1, numSamples);
+        l.setNote (voiceNote);
+        r.setNote (voiceNote);
 
-            oscillators[i]->setGain (gain * panGain / voices);
-            oscillators[i]->setNote (base + delta * (i / 2));
-            oscillators[i]->process (channelBuffer, 0, numSamples);
+        if (l.getWave() == Oscillator::noise)
+        {
+            // Noise must stay uncorrelated between the channels, so each one gets its own generator
+            float* leftPointers[]  = { left };
+            float* rightPointers[] = { right };
+            juce::AudioSampleBuffer leftBuffer (leftPointers, 1, numSamples), rightBuffer (rightPointers, 1, numSamples);
+
+            l.setGain (leftGain);
+            r.setGain (rightGain);
+            l.process (leftBuffer, 0, numSamples);
+            r.process (rightBuffer, 0, numSamples);
+        }
+        else
+        {
+            // Both oscillators of a voice share a phase and note, so the left one renders for both
+            l.processStereo (left, right, leftGain, rightGain, numSamples);
         }
     }
 }
 
 //==============================================================================
-static Array<BandlimitedWaveLookupTables*> tableCache;
+// Once built, a set is kept for good as they're slow to build and there are only ever a few sample rates
+static ReferenceCountedArray<BandlimitedWaveLookupTables> tableCache;
+static CriticalSection tableCacheLock;
 
 BandlimitedWaveLookupTables::Ptr BandlimitedWaveLookupTables::getLookupTables (double sampleRate)
 {
+    // The lock is held whilst a new set is built so two instances never build the same one
+    const ScopedLock sl (tableCacheLock);
+
     for (auto table : tableCache)
         if (table->sampleRate == sampleRate)
             return table;
 
-    Ptr table = new BandlimitedWaveLookupTables (sampleRate, 1024);
-    return table;
+    return tableCache.add (new BandlimitedWaveLookupTables (sampleRate, 1024));
 }
 
 BandlimitedWaveLookupTables::BandlimitedWaveLookupTables (double sr, int tableSize)
@@ -351,13 +357,10 @@ BandlimitedWaveLookupTables::BandlimitedWaveLookupTables (double sr, int tableSi
 
     RelativeTime elapsed (Time::getCurrentTime() - start);
     DBG ("Generating waves: " + String (elapsed.inMilliseconds()) + "ms");
-
-    tableCache.add (this);
 }
 
 BandlimitedWaveLookupTables::~BandlimitedWaveLookupTables()
 {
-    tableCache.removeFirstMatchingValue (this);
 }
 
 }
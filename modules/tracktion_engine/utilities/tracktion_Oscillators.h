@@ -11,6 +11,28 @@ namespace tracktion_engine
 {
 
 //==============================================================================
+/**
+    Simple waveforms for control-rate sources such as LFOs, which are evaluated once a block
+    so don't need band-limiting. The phase goes from 0 to 1 and the values from -1 to 1.
+*/
+namespace ControlRateWaves
+{
+    inline float sine (float phase) noexcept                     { return std::sin (phase * juce::MathConstants<float>::twoPi); }
+    inline float triangle (float phase) noexcept                 { return phase < 0.5f ? 4.0f * phase - 1.0f : -4.0f * phase + 3.0f; }
+    inline float sawUp (float phase) noexcept                    { return phase * 2.0f - 1.0f; }
+    inline float sawDown (float phase) noexcept                  { return (1.0f - phase) * 2.0f - 1.0f; }
+    inline float square (float phase, float pulseWidth) noexcept { return phase < pulseWidth ? 1.0f : -1.0f; }
+
+    /** Maps a value from -1 to 1 onto 0 to 1. */
+    inline float toUnipolar (float value) noexcept               { return (value + 1.0f) * 0.5f; }
+}
+
+//==============================================================================
+/**
+    Band-limited wavetables, mip-mapped with one table for every few notes, each with only the
+    harmonics that fit below Nyquist for the highest note it's used for.
+    They're expensive to build so there's one set per sample rate, shared by every Oscillator.
+*/
 class BandlimitedWaveLookupTables : public juce::ReferenceCountedObject
 {
 public:
@@ -29,6 +51,9 @@ public:
 
     const int tablePerNumNotes = 3;
 
+    /** Returns the index of the table in each set to use for a MIDI note. */
+    int getTableIndex (float note) const noexcept   { return juce::jlimit (0, sawUpFunctions.size() - 1, int ((note - 0.5f) / tablePerNumNotes)); }
+
 private:
     BandlimitedWaveLookupTables (double sampleRate, int tableSize);
 };
@@ -46,6 +71,7 @@ public:
         saw,
         triangle,
         noise,
+        sawDown
     };
 
     //==============================================================================
@@ -57,19 +83,32 @@ public:
     void setSampleRate (double sr);
     void setWave (Waves w)          { wave  = w;        }
     void setNote (float n)          { note = n;         }
+    void setFrequency (float hz)    { note = 69.0f + 12.0f * std::log2 (hz / 440.0f); }
     void setGain (float g)          { gain = g;         }
     void setPulseWidth (float p)    { pulseWidth = p;   }
 
+    Waves getWave() const           { return wave;      }
+
     void process (juce::AudioSampleBuffer& buffer, int startSample, int numSamples);
 
+    /** Adds the wave to a pair of channels, with a separate gain for each.
+        The wave is only generated once, so this is cheaper than processing two
+        oscillators with the same phase and note. The oscillator's own gain is ignored.
+    */
+    void processStereo (float* left, float* right, float leftGain, float rightGain, int numSamples);
+
 private:
     //==============================================================================
-    void processSine (juce::AudioSampleBuffer& buffer, int startSample, int numSamples);
-    void processSquare (juce::AudioSampleBuffer& buffer, int startSample, int numSamples);
-    void processNoise (juce::AudioSampleBuffer& buffer, int startSample, int numSamples);
+    float getPhaseDelta() const;
+
+    template <typename AddSampleFn> void render (int numSamples, AddSampleFn&&);
+    template <typename AddSampleFn> void renderSine (int numSamples, AddSampleFn&);
+    template <typename AddSampleFn> void renderSquare (int numSamples, AddSampleFn&);
+    template <typename AddSampleFn> void renderNoise (int numSamples, AddSampleFn&);
 
-    void processLookup (juce::AudioSampleBuffer& buffer, int startSample, int numSamples,
-                        const juce::OwnedArray<juce::dsp::LookupTableTransform<float>>& tableSet);
+    template <typename AddSampleFn>
+    void renderLookup (int numSamples, AddSampleFn&,
+                       const juce::OwnedArray<juce::dsp::LookupTableTransform<float>>& tableSet);
 
     //==============================================================================
     Waves wave = sine;
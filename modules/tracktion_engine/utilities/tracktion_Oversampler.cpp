@@ -0,0 +1,54 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+void Oversampler::prepare (int numChannelsToUse, int newFactor, FilterType filterType, int maxBlockSizeToUse, double sampleRate)
+{
+    CRASH_TRACER
+    jassert (isValidFactor (newFactor));
+
+    release();
+    numChannels = numChannelsToUse;
+    maxBlockSize = juce::jmax (1, maxBlockSizeToUse);
+    factor = isValidFactor (newFactor) ? newFactor : 1;
+
+    if (factor == 1)
+        return;
+
+    const auto juceFilterType = filterType == FilterType::linearPhase
+                                    ? juce::dsp::Oversampling<float>::filterHalfBandFIREquiripple
+                                    : juce::dsp::Oversampling<float>::filterHalfBandPolyphaseIIR;
+
+    oversampling = std::make_unique<juce::dsp::Oversampling<float>> ((size_t) numChannels,
+                                                                     (size_t) std::log2 (factor),
+                                                                     juceFilterType);
+    oversampling->initProcessing ((size_t) maxBlockSize);
+    channelPointers.resize ((size_t) numChannels);
+
+    latencySeconds = sampleRate > 0.0 ? static_cast<double> (oversampling->getLatencyInSamples()) / sampleRate
+                                      : 0.0;
+}
+
+void Oversampler::release()
+{
+    oversampling.reset();
+    factor = 1;
+    latencySeconds = 0.0;
+}
+
+void Oversampler::reset()
+{
+    if (oversampling != nullptr)
+        oversampling->reset();
+}
+
+} // namespace tracktion_engine
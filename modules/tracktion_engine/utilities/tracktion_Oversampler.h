@@ -0,0 +1,106 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+/**
+    Runs some processing at 2, 4 or 8 times the sample rate to reduce the aliasing
+    caused by nonlinear processing such as distortion.
+
+    This wraps juce::dsp::Oversampling with cascaded half-band filters. The
+    minimum-phase ones are polyphase IIRs, which are cheaper and have less latency.
+    The linear-phase ones are FIRs, which don't smear transients.
+
+    A plugin using one of these should return getLatencySeconds() from its own
+    Plugin::getLatencySeconds() so it can be compensated for.
+*/
+class Oversampler
+{
+public:
+    Oversampler() = default;
+
+    enum class FilterType
+    {
+        minimumPhase,
+        linearPhase
+    };
+
+    /** Returns true if the given factor is one that can be used. */
+    static bool isValidFactor (int factor) noexcept     { return factor == 1 || factor == 2 || factor == 4 || factor == 8; }
+
+    /** Sets up the filters for blocks of up to maxBlockSize samples.
+        A factor of 1 turns oversampling off, so process just calls its function directly.
+        This allocates so shouldn't be called whilst process might be.
+    */
+    void prepare (int numChannels, int factor, FilterType, int maxBlockSize, double sampleRate);
+
+    /** Frees the filters. */
+    void release();
+
+    /** Clears any audio left in the filters. */
+    void reset();
+
+    /** Returns the factor the audio is oversampled by. */
+    int getFactor() const noexcept                      { return factor; }
+
+    /** Returns the base-rate delay that the filters add. */
+    double getLatencySeconds() const noexcept           { return latencySeconds; }
+
+    /** Upsamples the given section of the buffer, calls the function with the upsampled
+        audio and then downsamples the result back into the buffer.
+        Blocks longer than the prepared size are processed in several parts.
+        When oversampling, only the number of channels it was prepared with are passed to the function.
+    */
+    template<typename ProcessFunction>
+    void process (juce::AudioBuffer<float>& buffer, int startSample, int numSamples, ProcessFunction&& processOversampled)
+    {
+        if (oversampling == nullptr)
+        {
+            juce::AudioBuffer<float> section (buffer.getArrayOfWritePointers(), buffer.getNumChannels(), startSample, numSamples);
+            processOversampled (section);
+            return;
+        }
+
+        const int numChans = juce::jmin (buffer.getNumChannels(), numChannels);
+
+        juce::dsp::AudioBlock<float> block (buffer);
+
+        while (numSamples > 0)
+        {
+            const int numThisTime = juce::jmin (numSamples, maxBlockSize);
+            auto subBlock = block.getSubsetChannelBlock (0, (size_t) numChans)
+                                 .getSubBlock ((size_t) startSample, (size_t) numThisTime);
+
+            auto upsampled = oversampling->processSamplesUp (subBlock);
+
+            for (int i = 0; i < numChans; ++i)
+                channelPointers[(size_t) i] = upsampled.getChannelPointer ((size_t) i);
+
+            juce::AudioBuffer<float> upsampledBuffer (channelPointers.data(), numChans, (int) upsampled.getNumSamples());
+            processOversampled (upsampledBuffer);
+
+            oversampling->processSamplesDown (subBlock);
+
+            startSample += numThisTime;
+            numSamples -= numThisTime;
+        }
+    }
+
+private:
+    std::unique_ptr<juce::dsp::Oversampling<float>> oversampling;
+    std::vector<float*> channelPointers;
+    int numChannels = 0, factor = 1, maxBlockSize = 0;
+    double latencySeconds = 0.0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Oversampler)
+};
+
+} // namespace tracktion_engine
@@ -49,6 +49,7 @@ String PropertyStorage::settingToString (SettingID setting)
         case SettingID::audio_device_setup:            return "audio_device_setup";
         case SettingID::audiosettings:                 return "audiosettings";
         case SettingID::addAntiDenormalNoise:          return "addAntiDenormalNoise";
+        case SettingID::anticipativeProcessing:        return "anticipativeProcessing";
         case SettingID::autoFreeze:                    return "autoFreeze";
         case SettingID::autoTempoMatch:                return "AutoTempoMatch";
         case SettingID::autoTempoDetect:               return "AutoTempoDetect";
@@ -109,6 +110,7 @@ String PropertyStorage::settingToString (SettingID setting)
         case SettingID::renameMode:                    return "renameMode";
         case SettingID::renderRecentFilesList:         return "renderRecentFilesList";
         case SettingID::safeRecord:                    return "safeRecord";
+        case SettingID::resamplingQuality:             return "resamplingQuality";
         case SettingID::resetCursorOnStop:             return "resetCursorOnStop";
         case SettingID::retrospectiveRecord:           return "retrospectiveRecord";
         case SettingID::reWireEnabled:                 return "ReWireEnabled";
@@ -0,0 +1,194 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+namespace RealtimeAllocationHelpers
+{
+    static std::atomic<bool> isTracking { false };
+    static thread_local int realtimeDepth = 0;
+    static thread_local bool isRecording = false;
+
+    struct Offences
+    {
+        juce::CriticalSection lock;
+        std::map<juce::String, RealtimeAllocationTracker::Offence> byStackTrace;
+    };
+
+    // Created on first use, as operator new can be called before any statics are constructed
+    static Offences& getOffences()
+    {
+        static Offences offences;
+        return offences;
+    }
+}
+
+//==============================================================================
+void RealtimeAllocationTracker::setEnabled (bool shouldBeEnabled)
+{
+    RealtimeAllocationHelpers::isTracking = shouldBeEnabled;
+}
+
+bool RealtimeAllocationTracker::isEnabled() noexcept
+{
+    return RealtimeAllocationHelpers::isTracking;
+}
+
+juce::Array<RealtimeAllocationTracker::Offence> RealtimeAllocationTracker::getOffences()
+{
+    auto& offences = RealtimeAllocationHelpers::getOffences();
+    juce::Array<Offence> result;
+
+    {
+        const juce::ScopedLock sl (offences.lock);
+
+        for (auto& o : offences.byStackTrace)
+            result.add (o.second);
+    }
+
+    std::sort (result.begin(), result.end(), [] (const Offence& a, const Offence& b)
+               {
+                   return a.numAllocations + a.numDeallocations > b.numAllocations + b.numDeallocations;
+               });
+
+    return result;
+}
+
+juce::String RealtimeAllocationTracker::createReport()
+{
+    auto offences = getOffences();
+
+    if (offences.isEmpty())
+        return "No allocations were made whilst rendering audio";
+
+    juce::String report;
+    report << "Allocations made whilst rendering audio, from " << offences.size() << " places:" << juce::newLine;
+
+    for (auto& o : offences)
+        report << juce::newLine << o.numAllocations << " allocations and " << o.numDeallocations << " deallocations from:"
+               << juce::newLine << o.stackTrace << juce::newLine;
+
+    return report;
+}
+
+void RealtimeAllocationTracker::clear()
+{
+    auto& offences = RealtimeAllocationHelpers::getOffences();
+    const juce::ScopedLock sl (offences.lock);
+    offences.byStackTrace.clear();
+}
+
+//==============================================================================
+RealtimeAllocationTracker::ScopedRealtimeSection::ScopedRealtimeSection() noexcept
+{
+    ++RealtimeAllocationHelpers::realtimeDepth;
+}
+
+RealtimeAllocationTracker::ScopedRealtimeSection::~ScopedRealtimeSection() noexcept
+{
+    --RealtimeAllocationHelpers::realtimeDepth;
+}
+
+void RealtimeAllocationTracker::allocationMade (bool isDeallocation) noexcept
+{
+    using namespace RealtimeAllocationHelpers;
+
+    // Recording allocates too, so those allocations are ignored
+    if (realtimeDepth == 0 || isRecording || ! isTracking.load (std::memory_order_relaxed))
+        return;
+
+    isRecording = true;
+
+    try
+    {
+        auto stackTrace = juce::SystemStats::getStackBacktrace();
+        auto& offences = getOffences();
+
+        const juce::ScopedLock sl (offences.lock);
+        auto& o = offences.byStackTrace[stackTrace];
+        o.stackTrace = stackTrace;
+
+        if (isDeallocation)
+            ++o.numDeallocations;
+        else
+            ++o.numAllocations;
+    }
+    catch (...)
+    {
+    }
+
+    isRecording = false;
+}
+
+} // namespace tracktion_engine
+
+//==============================================================================
+#if TRACKTION_TRACK_REALTIME_ALLOCATIONS
+
+void* operator new (std::size_t size)
+{
+    tracktion_engine::RealtimeAllocationTracker::allocationMade (false);
+
+    if (auto p = std::malloc (size > 0 ? size : 1))
+        return p;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[] (std::size_t size)
+{
+    tracktion_engine::RealtimeAllocationTracker::allocationMade (false);
+
+    if (auto p = std::malloc (size > 0 ? size : 1))
+        return p;
+
+    throw std::bad_alloc();
+}
+
+void* operator new (std::size_t size, const std::nothrow_t&) noexcept
+{
+    tracktion_engine::RealtimeAllocationTracker::allocationMade (false);
+    return std::malloc (size > 0 ? size : 1);
+}
+
+void* operator new[] (std::size_t size, const std::nothrow_t&) noexcept
+{
+    tracktion_engine::RealtimeAllocationTracker::allocationMade (false);
+    return std::malloc (size > 0 ? size : 1);
+}
+
+void operator delete (void* p) noexcept
+{
+    if (p != nullptr)
+        tracktion_engine::RealtimeAllocationTracker::allocationMade (true);
+
+    std::free (p);
+}
+
+void operator delete[] (void* p) noexcept
+{
+    if (p != nullptr)
+        tracktion_engine::RealtimeAllocationTracker::allocationMade (true);
+
+    std::free (p);
+}
+
+void operator delete (void* p, std::size_t) noexcept
+{
+    operator delete (p);
+}
+
+void operator delete[] (void* p, std::size_t) noexcept
+{
+    operator delete[] (p);
+}
+
+#endif
@@ -0,0 +1,66 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+/**
+    Catches heap allocations made whilst rendering audio, so they can be tracked down
+    and removed.
+
+    When TRACKTION_TRACK_REALTIME_ALLOCATIONS is enabled, the global operator new and
+    delete are replaced with versions that check whether the calling thread is inside a
+    TRACKTION_REALTIME_ALLOCATION_CHECK scope, i.e. is rendering an Edit. If it is and the
+    tracker's enabled, the call stack is recorded. Each distinct call stack is recorded once,
+    with a count of how many times it's happened, and createReport() lists them, worst first.
+
+    This is for debugging and profiling builds only: recording a call stack is slow, and
+    allocations made directly with malloc, e.g. by juce::HeapBlock, aren't seen.
+*/
+class RealtimeAllocationTracker
+{
+public:
+    /** Starts or stops recording. It's off to start with. */
+    static void setEnabled (bool);
+    static bool isEnabled() noexcept;
+
+    struct Offence
+    {
+        juce::String stackTrace;
+        int numAllocations = 0, numDeallocations = 0;
+    };
+
+    /** Returns the call stacks recorded, the most frequent first. */
+    static juce::Array<Offence> getOffences();
+
+    /** Returns a readable list of the call stacks recorded, e.g. to log or save to a file. */
+    static juce::String createReport();
+
+    /** Forgets everything that's been recorded. */
+    static void clear();
+
+    /** Marks the calling thread as rendering audio whilst this exists. These can be nested. */
+    struct ScopedRealtimeSection
+    {
+        ScopedRealtimeSection() noexcept;
+        ~ScopedRealtimeSection() noexcept;
+    };
+
+    /** @internal */
+    static void allocationMade (bool isDeallocation) noexcept;
+};
+
+#if TRACKTION_TRACK_REALTIME_ALLOCATIONS
+ #define TRACKTION_REALTIME_ALLOCATION_CHECK    const RealtimeAllocationTracker::ScopedRealtimeSection JUCE_JOIN_MACRO (__realtimeAllocationCheck, __LINE__);
+#else
+ #define TRACKTION_REALTIME_ALLOCATION_CHECK
+#endif
+
+} // namespace tracktion_engine
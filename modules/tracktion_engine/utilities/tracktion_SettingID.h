@@ -16,6 +16,7 @@ enum class SettingID
 {
     invalid,
     addAntiDenormalNoise,
+    anticipativeProcessing,
     audio_device_setup,
     audiosettings,
     autoFreeze,
@@ -77,6 +78,7 @@ enum class SettingID
     renameClipRenamesSource,
     renameMode,
     renderRecentFilesList,
+    resamplingQuality,
     resetCursorOnStop,
     retrospectiveRecord,
     reWireEnabled,
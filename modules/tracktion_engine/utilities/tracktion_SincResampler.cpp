@@ -0,0 +1,333 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+namespace SincResamplerHelpers
+{
+    struct QualitySettings
+    {
+        int numTaps, numPhases;
+        double cutoff, kaiserBeta;
+    };
+
+    static QualitySettings getQualitySettings (ResamplingQuality quality) noexcept
+    {
+        if (quality == ResamplingQuality::sincMastering)
+            return { 64, 256, 0.96, 10.0 };
+
+        return { 16, 64, 0.90, 7.0 };
+    }
+
+    // The cutoff is lowered for downsampling, up to this factor
+    static constexpr double maxDownsamplingFactor = 8.0;
+    static constexpr int maxNumTaps = 64 * (int) maxDownsamplingFactor;
+
+    // Tables are shared between ratios that round up to the same multiple of this
+    static constexpr double downsamplingFactorResolution = 1.0 / 16.0;
+
+    static double getDownsamplingFactor (double ratio) noexcept
+    {
+        return juce::jlimit (1.0, maxDownsamplingFactor,
+                             std::ceil (ratio / downsamplingFactorResolution) * downsamplingFactorResolution);
+    }
+
+    static double sinc (double x) noexcept
+    {
+        if (x == 0.0)
+            return 1.0;
+
+        const auto px = juce::MathConstants<double>::pi * x;
+        return std::sin (px) / px;
+    }
+
+    /** The zeroth order modified Bessel function of the first kind. */
+    static double besselI0 (double x) noexcept
+    {
+        double sum = 1.0, term = 1.0;
+
+        for (int k = 1; k < 100; ++k)
+        {
+            const auto t = x / (2.0 * k);
+            term *= t * t;
+            sum += term;
+
+            if (term < sum * 1.0e-12)
+                break;
+        }
+
+        return sum;
+    }
+
+    /** A Kaiser window, for x in the range [-1, 1]. */
+    static double kaiser (double x, double beta) noexcept
+    {
+        if (std::abs (x) > 1.0)
+            return 0.0;
+
+        return besselI0 (beta * std::sqrt (1.0 - x * x)) / besselI0 (beta);
+    }
+
+    /** Written with independent sums so the compiler can vectorise it. numValues must be a multiple of 4. */
+    static inline float dotProduct (const float* a, const float* b, int numValues) noexcept
+    {
+        float sums[4] = {};
+
+        for (int i = 0; i < numValues; i += 4)
+        {
+            sums[0] += a[i]     * b[i];
+            sums[1] += a[i + 1] * b[i + 1];
+            sums[2] += a[i + 2] * b[i + 2];
+            sums[3] += a[i + 3] * b[i + 3];
+        }
+
+        return (sums[0] + sums[1]) + (sums[2] + sums[3]);
+    }
+}
+
+//==============================================================================
+/** The coefficients for each of the filter's phases.
+    Row p has the coefficients for an output sample p / numPhases of the way between two
+    input samples, there's an extra row at the end so adjacent rows can be interpolated.
+*/
+struct SincResampler::Table
+{
+    Table (ResamplingQuality quality, double downsamplingFactor)
+    {
+        using namespace SincResamplerHelpers;
+        const auto settings = getQualitySettings (quality);
+        const auto cutoff = settings.cutoff / downsamplingFactor;
+
+        // The filter needs to be longer as the cutoff is lowered to keep the same transition band
+        numTaps = juce::jmin (maxNumTaps, (int) std::ceil (settings.numTaps * downsamplingFactor / 4.0) * 4);
+        numPhases = settings.numPhases;
+        coefficients.resize ((size_t) ((numPhases + 1) * numTaps));
+
+        const auto halfLength = numTaps / 2;
+
+        for (int phase = 0; phase <= numPhases; ++phase)
+        {
+            auto row = coefficients.data() + phase * numTaps;
+            const auto fraction = phase / (double) numPhases;
+            double sum = 0.0;
+
+            for (int tap = 0; tap < numTaps; ++tap)
+            {
+                const auto x = (tap + 1 - halfLength) - fraction;
+                const auto c = cutoff * sinc (cutoff * x) * kaiser (x / halfLength, settings.kaiserBeta);
+                row[tap] = (float) c;
+                sum += c;
+            }
+
+            // Normalise each phase so the gain at DC doesn't depend on the position
+            for (int tap = 0; tap < numTaps; ++tap)
+                row[tap] = (float) (row[tap] / sum);
+        }
+    }
+
+    int numTaps = 0, numPhases = 0;
+    std::vector<float> coefficients;
+};
+
+//==============================================================================
+SincResampler::SincResampler (ResamplingQuality quality, double ratio)
+    : table (getTable (quality, ratio))
+{
+    jassert (quality != ResamplingQuality::lagrange);
+    jassert (ratio > 0.0);
+}
+
+SincResampler::~SincResampler()
+{
+}
+
+std::shared_ptr<const SincResampler::Table> SincResampler::getTable (ResamplingQuality quality, double ratio)
+{
+    static juce::CriticalSection lock;
+    static std::map<std::pair<int, int>, std::weak_ptr<const Table>> tables;
+
+    const auto factor = SincResamplerHelpers::getDownsamplingFactor (ratio);
+    const auto key = std::make_pair ((int) quality, (int) std::lround (factor / SincResamplerHelpers::downsamplingFactorResolution));
+
+    const juce::ScopedLock sl (lock);
+
+    if (auto existing = tables[key].lock())
+        return existing;
+
+    auto newTable = std::make_shared<const Table> (quality, factor);
+    tables[key] = newTable;
+
+    return newTable;
+}
+
+int SincResampler::getNumPaddingSamples() const noexcept
+{
+    return table->numTaps / 2;
+}
+
+int SincResampler::getNumInputSamplesNeeded (int numOutputSamples, double startPosition, double ratio) noexcept
+{
+    if (numOutputSamples <= 0)
+        return 0;
+
+    return (int) (startPosition + (numOutputSamples - 1) * ratio) + 1;
+}
+
+void SincResampler::processAdding (const float* const* source, float* const* dest, const float* gains,
+                                   int numChannels, int numOutputSamples,
+                                   double startPosition, double ratio) const noexcept
+{
+    using namespace SincResamplerHelpers;
+    jassert (numChannels <= maxNumChannels);
+    jassert (startPosition >= 0.0);
+
+    const auto numTaps = table->numTaps;
+    const auto numPhases = table->numPhases;
+    const auto firstTapOffset = 1 - numTaps / 2;
+    const auto coefficients = table->coefficients.data();
+
+    float interpolatedCoefficients[maxNumTaps];
+
+    for (int i = 0; i < numOutputSamples; ++i)
+    {
+        const auto position = startPosition + i * ratio;
+        const auto inputIndex = (int) position;
+        const auto phasePosition = (position - inputIndex) * numPhases;
+        const auto phase = std::min ((int) phasePosition, numPhases - 1);
+        const auto alpha = (float) (phasePosition - phase);
+
+        // Interpolate between the two nearest phases once, then apply it to all the channels
+        const auto row0 = coefficients + phase * numTaps;
+        const auto row1 = row0 + numTaps;
+
+        for (int tap = 0; tap < numTaps; ++tap)
+            interpolatedCoefficients[tap] = row0[tap] + alpha * (row1[tap] - row0[tap]);
+
+        const auto firstInput = inputIndex + firstTapOffset;
+
+        for (int channel = 0; channel < numChannels; ++channel)
+            dest[channel][i] += gains[channel] * dotProduct (source[channel] + firstInput, interpolatedCoefficients, numTaps);
+    }
+}
+
+
+//==============================================================================
+//==============================================================================
+#if TRACKTION_UNIT_TESTS
+
+class SincResamplerTests   : public juce::UnitTest
+{
+public:
+    SincResamplerTests()
+        : juce::UnitTest ("SincResampler", "Tracktion") {}
+
+    void runTest() override
+    {
+        beginTest ("Upsampling a sine wave");
+        {
+            expectLessThan (getMaxError (ResamplingQuality::sincDraft, 44100.0, 48000.0, 1000.0), 1.0e-3);
+            expectLessThan (getMaxError (ResamplingQuality::sincMastering, 44100.0, 48000.0, 1000.0), 1.0e-5);
+        }
+
+        beginTest ("Downsampling a sine wave");
+        {
+            expectLessThan (getMaxError (ResamplingQuality::sincDraft, 96000.0, 44100.0, 1000.0), 1.0e-3);
+            expectLessThan (getMaxError (ResamplingQuality::sincMastering, 96000.0, 44100.0, 1000.0), 1.0e-5);
+        }
+
+        beginTest ("Downsampling removes frequencies above the new Nyquist");
+        {
+            expectLessThan (getMaxOutputLevel (ResamplingQuality::sincMastering, 96000.0, 44100.0, 30000.0), 1.0e-3);
+        }
+
+        beginTest ("Downsampling uses longer filters");
+        {
+            SincResampler r1 (ResamplingQuality::sincDraft, 0.5), r2 (ResamplingQuality::sincDraft, 0.9);
+            SincResampler r3 (ResamplingQuality::sincMastering, 0.5), r4 (ResamplingQuality::sincMastering, 2.0);
+            expectEquals (r1.getNumPaddingSamples(), r2.getNumPaddingSamples());
+            expect (r1.getNumPaddingSamples() < r3.getNumPaddingSamples());
+            expect (r4.getNumPaddingSamples() > r3.getNumPaddingSamples());
+        }
+    }
+
+private:
+    /** Resamples a sine in blocks and returns the output and the expected output. */
+    void resampleSine (ResamplingQuality quality, double inputRate, double outputRate, double frequency,
+                       std::vector<float>& output, std::vector<float>& expected)
+    {
+        const auto ratio = inputRate / outputRate;
+        SincResampler resampler (quality, ratio);
+        const auto padding = resampler.getNumPaddingSamples();
+
+        const int blockSize = 256, numBlocks = 16;
+        output.assign ((size_t) (blockSize * numBlocks), 0.0f);
+        expected.resize (output.size());
+
+        auto inputSample = [=] (juce::int64 i)
+        {
+            return (float) std::sin (2.0 * juce::MathConstants<double>::pi * frequency * (double) i / inputRate);
+        };
+
+        for (int block = 0; block < numBlocks; ++block)
+        {
+            // Work out each block's position from the start, as the WaveAudioNode does
+            const auto exactStart = block * blockSize * ratio;
+            const auto firstSample = (juce::int64) std::floor (exactStart);
+            const auto startPosition = exactStart - (double) firstSample;
+            const auto numInput = SincResampler::getNumInputSamplesNeeded (blockSize, startPosition, ratio);
+
+            std::vector<float> input ((size_t) (numInput + 2 * padding));
+
+            for (size_t i = 0; i < input.size(); ++i)
+                input[i] = inputSample (firstSample - padding + (juce::int64) i);
+
+            const float* source = input.data() + padding;
+            float* dest = output.data() + block * blockSize;
+            const float gain = 1.0f;
+            resampler.processAdding (&source, &dest, &gain, 1, blockSize, startPosition, ratio);
+        }
+
+        for (size_t i = 0; i < expected.size(); ++i)
+            expected[i] = (float) std::sin (2.0 * juce::MathConstants<double>::pi * frequency * (double) i / outputRate);
+    }
+
+    double getMaxError (ResamplingQuality quality, double inputRate, double outputRate, double frequency)
+    {
+        std::vector<float> output, expected;
+        resampleSine (quality, inputRate, outputRate, frequency, output, expected);
+
+        double maxError = 0.0;
+
+        for (size_t i = 0; i < output.size(); ++i)
+            maxError = std::max (maxError, (double) std::abs (output[i] - expected[i]));
+
+        return maxError;
+    }
+
+    double getMaxOutputLevel (ResamplingQuality quality, double inputRate, double outputRate, double frequency)
+    {
+        std::vector<float> output, expected;
+        resampleSine (quality, inputRate, outputRate, frequency, output, expected);
+
+        double maxLevel = 0.0;
+
+        for (auto s : output)
+            maxLevel = std::max (maxLevel, (double) std::abs (s));
+
+        return maxLevel;
+    }
+};
+
+static SincResamplerTests sincResamplerTests;
+
+#endif
+
+} // namespace tracktion_engine
@@ -0,0 +1,84 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+/** The algorithms that can be used to resample audio files. */
+enum class ResamplingQuality
+{
+    lagrange        = 0,    /**< A juce::LagrangeInterpolator, the fastest but lowest quality. */
+    sincDraft       = 1,    /**< A short windowed-sinc filter that's good enough for playback. */
+    sincMastering   = 2     /**< A long windowed-sinc filter for final renders. */
+};
+
+//==============================================================================
+/**
+    Resamples audio with a polyphase windowed-sinc filter.
+
+    The filter coefficients are precomputed in tables that are shared between all the
+    resamplers with the same quality and a similar ratio, so creating one allocates and
+    may be slow the first time but processing doesn't.
+
+    Unlike juce::LagrangeInterpolator, this doesn't keep any history between calls.
+    Instead it's given the input either side of the section being resampled and the exact
+    position to start at, so sections can be resampled independently and in any order.
+*/
+class SincResampler
+{
+public:
+    /** Creates a resampler for a ratio of input samples to output samples.
+        When the ratio is greater than 1, i.e. downsampling, the filter's cutoff is lowered
+        to avoid aliasing. The ratio passed to processAdding should be close to this.
+        This must not be called on the audio thread.
+    */
+    SincResampler (ResamplingQuality, double ratio);
+
+    /** Destructor. */
+    ~SincResampler();
+
+    /** The maximum number of channels processAdding can process at once. */
+    static constexpr int maxNumChannels = 32;
+
+    /** Returns the number of input samples that are needed before and after a section. */
+    int getNumPaddingSamples() const noexcept;
+
+    /** Returns the number of input samples, not including the padding, that will be read to
+        produce some output samples.
+    */
+    static int getNumInputSamplesNeeded (int numOutputSamples, double startPosition, double ratio) noexcept;
+
+    /** Resamples some channels and adds them to the destination.
+
+        @param source           the first input sample for each channel. The getNumPaddingSamples()
+                                samples before this must also be valid, as must the padding after
+                                the getNumInputSamplesNeeded() samples that are read.
+        @param dest             where to add the output for each channel
+        @param gains            the gain to apply to each channel
+        @param numChannels      the number of channels, up to maxNumChannels
+        @param numOutputSamples the number of samples to add to each destination channel
+        @param startPosition    the position of the first output sample relative to the first input
+                                sample, this should be in the range [0, 1)
+        @param ratio            the number of input samples for each output sample
+    */
+    void processAdding (const float* const* source, float* const* dest, const float* gains,
+                        int numChannels, int numOutputSamples,
+                        double startPosition, double ratio) const noexcept;
+
+private:
+    struct Table;
+    std::shared_ptr<const Table> table;
+
+    static std::shared_ptr<const Table> getTable (ResamplingQuality, double ratio);
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SincResampler)
+};
+
+} // namespace tracktion_engine
@@ -11,13 +11,113 @@
 namespace tracktion_engine
 {
 
-TemporaryFileManager::TemporaryFileManager (Engine& e)  : engine (e)
+//==============================================================================
+/** Does the slow parts of the clean-ups, i.e. walking the folders and deleting files,
+    on a thread of its own, so that a big temp folder on a slow drive can't hold anything up.
+*/
+class TemporaryFileManager::Cleaner  : private juce::Thread
+{
+public:
+    Cleaner()  : juce::Thread ("Temp File Cleanup") {}
+
+    ~Cleaner() override
+    {
+        signalThreadShouldExit();
+        notify();
+        stopThread (10000);
+    }
+
+    using Task = std::function<void (Cleaner&)>;
+
+    void addTask (Task task)
+    {
+        {
+            const ScopedLock sl (lock);
+            tasks.push_back (std::move (task));
+
+            if (! isThreadRunning())
+                startThread (1);
+        }
+
+        notify();
+    }
+
+    bool isBusy() const
+    {
+        const ScopedLock sl (lock);
+        return isRunningTask || ! tasks.empty();
+    }
+
+    bool shouldStop()       { return threadShouldExit(); }
+
+    /** Deletes a file, or a folder and its contents, waiting first if it's going too quickly. */
+    void deleteFile (const juce::File& f)
+    {
+        if (auto maxPerSecond = maxDeletionsPerSecond.load())
+        {
+            auto now = Time::getMillisecondCounterHiRes();
+
+            while (now < nextDeletionTime && ! threadShouldExit())
+            {
+                wait (jmax (1, roundToInt (nextDeletionTime - now)));
+                now = Time::getMillisecondCounterHiRes();
+            }
+
+            nextDeletionTime = jmax (now, nextDeletionTime) + 1000.0 / maxPerSecond;
+        }
+
+        if (f.isDirectory())
+            f.deleteRecursively();
+        else
+            f.deleteFile();
+    }
+
+    std::atomic<int> maxDeletionsPerSecond { 100 };
+
+private:
+    juce::CriticalSection lock;
+    std::vector<Task> tasks;
+    bool isRunningTask = false;
+    double nextDeletionTime = 0;
+
+    void run() override
+    {
+        while (! threadShouldExit())
+        {
+            Task task;
+
+            {
+                const ScopedLock sl (lock);
+
+                if (! tasks.empty())
+                {
+                    task = std::move (tasks.front());
+                    tasks.erase (tasks.begin());
+                }
+
+                isRunningTask = task != nullptr;
+            }
+
+            if (task != nullptr)
+                task (*this);
+            else
+                wait (-1);
+        }
+    }
+
+    JUCE_DECLARE_NON_COPYABLE (Cleaner)
+};
+
+//==============================================================================
+TemporaryFileManager::TemporaryFileManager (Engine& e)
+    : engine (e), cleaner (std::make_unique<Cleaner>())
 {
     updateDir();
 }
 
 TemporaryFileManager::~TemporaryFileManager()
 {
+    cleaner.reset();
 }
 
 static juce::File getDefaultTempFolder (Engine& engine)
@@ -104,9 +204,41 @@ int TemporaryFileManager::getMaxNumTempFiles() const
     return 500;
 }
 
-static bool shouldDeleteTempFile (const File& f, bool spaceIsShort)
+//==============================================================================
+struct TempFileInfo
+{
+    juce::File file;
+    juce::int64 size, lastAccessMs;
+};
+
+static juce::Array<TempFileInfo> listTempFiles (const juce::File& dir, bool recursive,
+                                                const std::function<bool()>& shouldStop)
 {
-    auto fileName = f.getFileName();
+    juce::Array<TempFileInfo> files;
+
+    for (auto entry : juce::RangedDirectoryIterator (dir, recursive, "*", File::findFiles))
+    {
+        if (shouldStop != nullptr && shouldStop())
+            break;
+
+        files.add ({ entry.getFile(), entry.getFileSize(), entry.getFile().getLastAccessTime().toMilliseconds() });
+    }
+
+    return files;
+}
+
+static void sortLeastRecentlyUsedFirst (juce::Array<TempFileInfo>& files)
+{
+    std::sort (files.begin(), files.end(),
+               [] (const TempFileInfo& first, const TempFileInfo& second)
+               {
+                   return first.lastAccessMs < second.lastAccessMs;
+               });
+}
+
+static bool shouldDeleteTempFile (const TempFileInfo& f, bool spaceIsShort)
+{
+    auto fileName = f.file.getFileName();
 
     if (fileName.startsWith ("preview_"))
         return false;
@@ -114,32 +246,114 @@ static bool shouldDeleteTempFile (const File& f, bool spaceIsShort)
     if (fileName.startsWith ("temp_"))
         return true;
 
-    auto daysOld = (Time::getCurrentTime() - f.getLastAccessTime()).inDays();
+    auto daysOld = (Time::getCurrentTime() - Time (f.lastAccessMs)).inDays();
 
     return daysOld > 10.0 || (spaceIsShort && daysOld > 1.0);
 }
 
-static void deleteEditPreviewsNotInUse (Engine& engine, juce::Array<juce::File>& files)
+static std::unordered_set<juce::String> getPreviewIDsInUse (Engine& engine)
 {
     auto& pm = engine.getProjectManager();
-    juce::StringArray ids;
+    std::unordered_set<juce::String> ids;
 
     for (auto& p : pm.getAllProjects (pm.folders))
         for (auto& itemID : p->getAllProjectItemIDs())
-            ids.add (itemID.toStringSuitableForFilename());
+            ids.insert (itemID.toStringSuitableForFilename());
+
+    return ids;
+}
+
+/** Picks the temp files to delete, which is safe to do on any thread as it only looks at the listing. */
+static juce::Array<juce::File> chooseTempFilesToDelete (juce::Array<TempFileInfo> files,
+                                                        const std::unordered_set<juce::String>& previewIDsInUse,
+                                                        juce::int64 maxSizeToKeep, int maxNumFiles)
+{
+    juce::Array<juce::File> filesToDelete;
 
     for (int i = files.size(); --i >= 0;)
     {
-        auto fileName = files.getUnchecked (i).getFileNameWithoutExtension();
+        auto fileName = files.getReference (i).file.getFileNameWithoutExtension();
 
         if (! fileName.startsWith ("preview_"))
             continue;
 
         auto itemID = fileName.fromFirstOccurrenceOf ("preview_", false, false);
 
-        if (itemID.isNotEmpty() && ! ids.contains (itemID))
-            files.removeAndReturn (i).deleteFile();
+        if (itemID.isNotEmpty() && previewIDsInUse.count (itemID) == 0)
+            filesToDelete.add (files.removeAndReturn (i).file);
+    }
+
+    juce::int64 totalBytes = 0;
+
+    for (auto& f : files)
+        totalBytes += f.size;
+
+    sortLeastRecentlyUsedFirst (files);
+    auto numFiles = files.size();
+
+    for (auto& f : files)
+    {
+        if (shouldDeleteTempFile (f, totalBytes > maxSizeToKeep || numFiles > maxNumFiles))
+        {
+            totalBytes -= f.size;
+            filesToDelete.add (f.file);
+            --numFiles;
+        }
+    }
+
+    return filesToDelete;
+}
+
+/** Picks the shared renders to evict. This has to be called on the message thread as it checks the open Edits. */
+static juce::Array<juce::File> chooseSharedRendersToEvict (Engine& engine, juce::Array<TempFileInfo> files, juce::int64 maxSizeToKeep)
+{
+    juce::Array<juce::File> filesToDelete;
+
+    // Any partial renders this old must have been left behind by a crash
+    for (int i = files.size(); --i >= 0;)
+        if (files.getReference (i).file.getFileName().startsWith ("temp_")
+             && (Time::getCurrentTime() - files.getReference (i).file.getLastModificationTime()).inDays() > 1.0)
+            filesToDelete.add (files.removeAndReturn (i).file);
+
+    juce::int64 totalBytes = 0;
+
+    for (auto& f : files)
+        totalBytes += f.size;
+
+    if (totalBytes <= maxSizeToKeep)
+        return filesToDelete;
+
+    // Files are touched each time an Edit starts using them so the access time gives the LRU order
+    sortLeastRecentlyUsedFirst (files);
+
+    for (auto& f : files)
+    {
+        if (totalBytes <= maxSizeToKeep)
+            break;
+
+        const AudioFile af (engine, f.file);
+
+        if (engine.getTemporaryFileManager().isFileInUseByAnyEdit (af)
+             || engine.getRenderManager().isProxyBeingGenerated (af)
+             || engine.getAudioFileManager().proxyGenerator.isProxyBeingGenerated (af))
+            continue;
+
+        totalBytes -= f.size;
+        filesToDelete.add (f.file);
     }
+
+    return filesToDelete;
+}
+
+static juce::Array<juce::File> findEmptyEditFolders (const juce::File& tempDir)
+{
+    juce::Array<juce::File> folders;
+
+    for (auto entry : juce::RangedDirectoryIterator (tempDir, false, "edit_*", juce::File::findDirectories))
+        if (entry.getFile().getNumberOfChildFiles (juce::File::findFilesAndDirectories) == 0)
+            folders.add (entry.getFile());
+
+    return folders;
 }
 
 void TemporaryFileManager::cleanUp()
@@ -147,39 +361,104 @@ void TemporaryFileManager::cleanUp()
     CRASH_TRACER
     TRACKTION_LOG ("Cleaning up temp files..");
 
-    juce::Array<juce::File> tempFiles;
-    tempDir.findChildFiles (tempFiles, File::findFiles, true);
+    trimSharedRenderCache();
 
-    deleteEditPreviewsNotInUse (engine, tempFiles);
+    auto tempFiles = listTempFiles (tempDir, true, nullptr);
 
-    juce::int64 totalBytes = 0;
+    // The shared renders are evicted by trimSharedRenderCache as they might be in use
+    auto sharedRenderFolder = getSharedRenderCacheFolder();
+    tempFiles.removeIf ([&] (const TempFileInfo& f) { return f.file.isAChildOf (sharedRenderFolder); });
 
-    for (auto& f : tempFiles)
-        totalBytes += f.getSize();
+    for (auto& f : chooseTempFilesToDelete (tempFiles, getPreviewIDsInUse (engine),
+                                            getMaxSpaceAllowedForTempFiles(), getMaxNumTempFiles()))
+        f.deleteFile();
 
-    std::sort (tempFiles.begin(), tempFiles.end(),
-               [] (const juce::File& first, const juce::File& second) -> bool
-               {
-                   return first.getLastAccessTime().toMilliseconds() < second.getLastAccessTime().toMilliseconds();
-               });
+    for (auto& f : findEmptyEditFolders (tempDir))
+        f.deleteRecursively();
+}
 
-    auto numFiles = tempFiles.size();
-    auto maxNumFiles = getMaxNumTempFiles();
-    auto maxSizeToKeep = getMaxSpaceAllowedForTempFiles();
+void TemporaryFileManager::cleanUpInBackground()
+{
+    TRACKTION_ASSERT_MESSAGE_THREAD
+    TRACKTION_LOG ("Cleaning up temp files in the background..");
 
-    for (auto& f : tempFiles)
+    auto dir = tempDir;
+    auto sharedRenderFolder = getSharedRenderCacheFolder();
+    auto previewIDsInUse = getPreviewIDsInUse (engine);
+
+    cleaner->addTask ([this, sharedRenderFolder] (Cleaner& c)
     {
-        if (shouldDeleteTempFile (f, totalBytes > maxSizeToKeep || numFiles > maxNumFiles))
+        auto files = listTempFiles (sharedRenderFolder, false, [&c] { return c.shouldStop(); });
+        auto maxSizeToKeep = getMaxSpaceAllowedForSharedRenders();
+
+        MessageManager::callAsync ([engineRef = WeakReference<Engine> (&engine), files, maxSizeToKeep]
         {
-            totalBytes -= f.getSize();
-            f.deleteFile();
-            --numFiles;
+            if (auto e = engineRef.get())
+                e->getTemporaryFileManager().deleteAudioFilesInBackground (chooseSharedRendersToEvict (*e, files, maxSizeToKeep));
+        });
+    });
+
+    cleaner->addTask ([this, dir, sharedRenderFolder, previewIDsInUse] (Cleaner& c)
+    {
+        auto shouldStop = [&c] { return c.shouldStop(); };
+        auto tempFiles = listTempFiles (dir, true, shouldStop);
+        tempFiles.removeIf ([&] (const TempFileInfo& f) { return f.file.isAChildOf (sharedRenderFolder); });
+
+        for (auto& f : chooseTempFilesToDelete (tempFiles, previewIDsInUse,
+                                                getMaxSpaceAllowedForTempFiles(), getMaxNumTempFiles()))
+        {
+            if (shouldStop())
+                return;
+
+            c.deleteFile (f);
         }
-    }
 
-    for (auto entry : juce::RangedDirectoryIterator (getTempDirectory(), false, "edit_*", juce::File::findDirectories))
-        if (entry.getFile().getNumberOfChildFiles (juce::File::findFilesAndDirectories) == 0)
-            entry.getFile().deleteRecursively();
+        for (auto& f : findEmptyEditFolders (dir))
+            c.deleteFile (f);
+    });
+}
+
+bool TemporaryFileManager::isCleaningUp() const
+{
+    return cleaner->isBusy();
+}
+
+void TemporaryFileManager::setMaxFileDeletionsPerSecond (int maxPerSecond)
+{
+    cleaner->maxDeletionsPerSecond = jmax (0, maxPerSecond);
+}
+
+void TemporaryFileManager::deleteAudioFilesInBackground (const juce::Array<juce::File>& files)
+{
+    TRACKTION_ASSERT_MESSAGE_THREAD
+
+    if (files.isEmpty())
+        return;
+
+    // The readers have to be let go of here, but the deleting itself can wait
+    auto& afm = engine.getAudioFileManager();
+
+    for (auto& f : files)
+        afm.releaseFile (AudioFile (engine, f));
+
+    cleaner->addTask ([engineRef = WeakReference<Engine> (&engine), files] (Cleaner& c)
+    {
+        for (auto& f : files)
+        {
+            if (c.shouldStop())
+                return;
+
+            DBG ("Purging temp file: " << f.getFileName());
+            c.deleteFile (f);
+        }
+
+        MessageManager::callAsync ([engineRef, files]
+        {
+            if (auto e = engineRef.get())
+                for (auto& f : files)
+                    e->getAudioFileManager().checkFileForChangesAsync (AudioFile (*e, f));
+        });
+    });
 }
 
 juce::File TemporaryFileManager::getTempFile (const juce::String& filename) const
@@ -199,12 +478,53 @@ juce::File TemporaryFileManager::getThumbnailsFolder() const
     return getTempDirectory().getChildFile ("thumbnails");
 }
 
+//==============================================================================
+juce::File TemporaryFileManager::getSharedRenderCacheFolder() const
+{
+    return getTempDirectory().getChildFile ("shared_renders");
+}
+
+juce::int64 TemporaryFileManager::getFileContentHash (const juce::File& f)
+{
+    return f.getFullPathName().hashCode64()
+            ^ (f.getSize() * 1337)
+            ^ f.getLastModificationTime().toMilliseconds();
+}
+
+bool TemporaryFileManager::isFileInUseByAnyEdit (const AudioFile& af) const
+{
+    for (auto edit : engine.getActiveEdits().getEdits())
+        if (edit->areAnyClipsUsingFile (af))
+            return true;
+
+    return false;
+}
+
+juce::int64 TemporaryFileManager::getMaxSpaceAllowedForSharedRenders() const
+{
+    return getMaxSpaceAllowedForTempFiles() / 2;
+}
+
+void TemporaryFileManager::trimSharedRenderCache()
+{
+    CRASH_TRACER
+    TRACKTION_ASSERT_MESSAGE_THREAD
+
+    auto files = listTempFiles (getSharedRenderCacheFolder(), false, nullptr);
+
+    for (auto& f : chooseSharedRendersToEvict (engine, files, getMaxSpaceAllowedForSharedRenders()))
+        AudioFile (engine, f).deleteFile();
+}
+
 //==============================================================================
 static juce::String getClipProxyPrefix()                { return "clip_"; }
 static juce::String getFileProxyPrefix()                { return "proxy_"; }
 static juce::String getDeviceFreezePrefix (Edit& edit)  { return "freeze_" + edit.getProjectItemID().toStringSuitableForFilename() + "_"; }
 static juce::String getTrackFreezePrefix()              { return "trackFreeze_"; }
 static juce::String getCompPrefix()                     { return "comp_"; }
+static juce::String getSegmentPrefix()                  { return "segment_"; }
+static juce::String getAnalysisPrefix()                 { return "analysis_"; }
+static juce::String getEditRenderPrefix()               { return "edit_"; }
 
 static AudioFile getCachedEditFile (Edit& edit, const juce::String& prefix, juce::int64 hash)
 {
@@ -221,14 +541,55 @@ AudioFile TemporaryFileManager::getFileForCachedClipRender (const AudioClipBase&
     return getCachedClipFileWithPrefix (clip, getClipProxyPrefix(), hash);
 }
 
+static juce::File getSharedCacheFile (Engine& engine, const juce::String& prefix, juce::int64 hash, const char* extension)
+{
+    auto folder = engine.getTemporaryFileManager().getSharedRenderCacheFolder();
+    folder.createDirectory();
+
+    auto file = folder.getChildFile (prefix + String::toHexString (hash) + extension);
+
+    // Mark it as recently used so it's the last to be evicted
+    if (file.existsAsFile())
+        file.setLastAccessTime (Time::getCurrentTime());
+
+    return file;
+}
+
+static AudioFile getSharedRenderFile (Engine& engine, const juce::String& prefix, juce::int64 hash)
+{
+    return AudioFile (engine, getSharedCacheFile (engine, prefix, hash, ".wav"));
+}
+
 AudioFile TemporaryFileManager::getFileForCachedCompRender (const AudioClipBase& clip, juce::int64 takeHash)
 {
-    return getCachedClipFileWithPrefix (clip, getCompPrefix(), takeHash);
+    // The take hash only uses the take indexes so add the takes themselves to make it independent of the clip
+    auto hash = takeHash;
+    int index = 0;
+
+    for (auto& takeID : clip.getTakes())
+        hash ^= ((juce::int64) takeID.getProjectID() * 7919 + takeID.getItemID()) * (++index);
+
+    return getSharedRenderFile (clip.edit.engine, getCompPrefix(), hash);
 }
 
 AudioFile TemporaryFileManager::getFileForCachedFileRender (Edit& edit, juce::int64 hash)
 {
-    return getCachedEditFile (edit, getFileProxyPrefix(), hash);
+    return getSharedRenderFile (edit.engine, getFileProxyPrefix(), hash);
+}
+
+AudioFile TemporaryFileManager::getFileForCachedSegmentRender (Engine& engine, juce::int64 hash)
+{
+    return getSharedRenderFile (engine, getSegmentPrefix(), hash);
+}
+
+AudioFile TemporaryFileManager::getFileForCachedEditRender (Engine& engine, juce::int64 hash)
+{
+    return getSharedRenderFile (engine, getEditRenderPrefix(), hash);
+}
+
+juce::File TemporaryFileManager::getFileForCachedAnalysis (Engine& engine, juce::int64 hash)
+{
+    return getSharedCacheFile (engine, getAnalysisPrefix(), hash, ".dat");
 }
 
 juce::File TemporaryFileManager::getFreezeFileForDevice (Edit& edit, OutputDevice& device)
@@ -253,6 +614,12 @@ juce::File TemporaryFileManager::getFreezeFileForTrack (const AudioTrack& track)
              .getChildFile (getTrackFreezePrefix() + "0_" + track.itemID.toString() + ".freeze");
 }
 
+juce::File TemporaryFileManager::getFreezeFileForTrackSegment (const AudioTrack& track, juce::int64 segmentHash)
+{
+    return track.edit.getTempDirectory (true)
+             .getChildFile (getTrackFreezePrefix() + "0_" + track.itemID.toString() + "_" + String::toHexString (segmentHash) + ".freeze");
+}
+
 juce::Array<juce::File> TemporaryFileManager::getFrozenTrackFiles (Edit& edit)
 {
     return edit.getTempDirectory (false)
@@ -272,38 +639,67 @@ static ProjectItemID getProjectItemIDFromFilename (const juce::String& name)
 void TemporaryFileManager::purgeOrphanEditTempFolders (ProjectManager& pm)
 {
     CRASH_TRACER
-    juce::Array<juce::File> filesToDelete;
-    juce::StringArray reasonsForDeletion;
+    auto dir = getTempDirectory();
 
-    for (auto entry : juce::RangedDirectoryIterator (getTempDirectory(), false, "edit_*", juce::File::findDirectories))
+    cleaner->addTask ([engineRef = WeakReference<Engine> (&engine), dir, &pm] (Cleaner& c)
     {
-        auto itemID = getProjectItemIDFromFilename (entry.getFile().getFileName());
+        juce::Array<juce::File> editFolders;
+
+        for (auto entry : juce::RangedDirectoryIterator (dir, false, "edit_*", juce::File::findDirectories))
+        {
+            if (c.shouldStop())
+                return;
+
+            editFolders.add (entry.getFile());
+        }
 
-        if (itemID.isValid())
+        if (editFolders.isEmpty())
+            return;
+
+        // The projects can only be looked at on the message thread
+        MessageManager::callAsync ([engineRef, editFolders, &pm]
         {
-            if (pm.getProjectItem (itemID) == nullptr)
+            if (engineRef == nullptr)
+                return;
+
+            juce::Array<juce::File> filesToDelete;
+
+            for (auto& folder : editFolders)
             {
-                filesToDelete.add (entry.getFile());
+                auto itemID = getProjectItemIDFromFilename (folder.getFileName());
+
+                if (! itemID.isValid() || pm.getProjectItem (itemID) != nullptr)
+                    continue;
 
                 auto pp = pm.getProject (itemID.getProjectID());
+                juce::String reason;
 
                 if (itemID.getProjectID() == 0)
-                    reasonsForDeletion.add ("Invalid project ID");
+                    reason = "Invalid project ID";
                 else if (pp == nullptr)
-                    reasonsForDeletion.add ("Can't find project");
+                    reason = "Can't find project";
                 else if (pp->getProjectItemForID (itemID) == nullptr)
-                    reasonsForDeletion.add ("Can't find source media");
+                    reason = "Can't find source media";
                 else
-                    reasonsForDeletion.add ("Unknown");
+                    reason = "Unknown";
+
+                TRACKTION_LOG ("Purging edit folder: " + folder.getFileName() + " - " + reason);
+                filesToDelete.add (folder);
             }
-        }
-    }
 
-    for (int i = filesToDelete.size(); --i >= 0;)
-    {
-        TRACKTION_LOG ("Purging edit folder: " + filesToDelete.getReference (i).getFileName() + " - " + reasonsForDeletion[i]);
-        filesToDelete.getReference (i).deleteRecursively();
-    }
+            if (! filesToDelete.isEmpty())
+                engineRef->getTemporaryFileManager().cleaner->addTask ([filesToDelete] (Cleaner& deleter)
+                {
+                    for (auto& f : filesToDelete)
+                    {
+                        if (deleter.shouldStop())
+                            return;
+
+                        deleter.deleteFile (f);
+                    }
+                });
+        });
+    });
 }
 
 static EditItemID getEditItemIDFromFilename (const juce::String& name)
@@ -318,31 +714,32 @@ static EditItemID getEditItemIDFromFilename (const juce::String& name)
     return EditItemID::fromVar (tokens[0] + tokens[1]);
 }
 
-void TemporaryFileManager::purgeOrphanFreezeAndProxyFiles (Edit& edit)
+static juce::Array<juce::File> findOrphanFreezeAndProxyFiles (Edit& edit,
+                                                               const std::unordered_map<EditItemID, juce::Array<juce::File>>& filesForItems,
+                                                               const juce::Array<juce::File>& renderFiles)
 {
-    CRASH_TRACER
-    juce::Array<juce::File> filesToDelete;
+    juce::Array<juce::File> orphans;
 
-    for (auto entry : juce::RangedDirectoryIterator (edit.getTempDirectory (false), false, "*"))
+    for (auto& item : filesForItems)
     {
-        auto name = entry.getFile().getFileName();
-        auto itemID = getEditItemIDFromFilename (name);
+        auto clip = findClipForID (edit, item.first);
+        auto at = dynamic_cast<AudioTrack*> (findTrackForID (edit, item.first));
 
-        if (itemID.isValid())
+        for (auto& f : item.second)
         {
+            auto name = f.getFileName();
+
             if (name.startsWith (getClipProxyPrefix())
                  || name.startsWith (getCompPrefix()))
             {
-                auto clip = findClipForID (edit, itemID);
-
                 if (auto acb = dynamic_cast<AudioClipBase*> (clip))
                 {
-                    if (! acb->isUsingFile (AudioFile (edit.engine, entry.getFile())))
-                        filesToDelete.add (entry.getFile());
+                    if (! acb->isUsingFile (AudioFile (edit.engine, f)))
+                        orphans.add (f);
                 }
                 else if (clip == nullptr)
                 {
-                    filesToDelete.add (entry.getFile());
+                    orphans.add (f);
                 }
             }
             else if (name.startsWith (getFileProxyPrefix()))
@@ -351,23 +748,67 @@ void TemporaryFileManager::purgeOrphanFreezeAndProxyFiles (Edit& edit)
             }
             else if (name.startsWith (getTrackFreezePrefix()))
             {
-                if (auto at = dynamic_cast<AudioTrack*> (findTrackForID (edit, itemID)))
-                    if (! at->isFrozen (Track::individualFreeze))
-                        filesToDelete.add (entry.getFile());
+                if (at != nullptr)
+                {
+                    // Segments are kept while unfrozen so re-freezing can reuse any that haven't changed
+                    if (at->isFrozen (Track::individualFreeze))
+                    {
+                        if (! at->getFreezeFiles().contains (f))
+                            orphans.add (f);
+                    }
+                    else if (f == TemporaryFileManager::getFreezeFileForTrack (*at))
+                    {
+                        orphans.add (f);
+                    }
+                }
             }
         }
-        else if (name.startsWith (RenderManager::getFileRenderPrefix()))
-        {
-            if (! edit.areAnyClipsUsingFile (AudioFile (edit.engine, entry.getFile())))
-                filesToDelete.add (entry.getFile());
-        }
     }
 
-    for (auto& f : filesToDelete)
+    for (auto& f : renderFiles)
+        if (! edit.areAnyClipsUsingFile (AudioFile (edit.engine, f)))
+            orphans.add (f);
+
+    return orphans;
+}
+
+void TemporaryFileManager::purgeOrphanFreezeAndProxyFiles (Edit& edit)
+{
+    CRASH_TRACER
+    auto dir = edit.getTempDirectory (false);
+
+    edit.engine.getTemporaryFileManager().cleaner->addTask ([editRef = Edit::WeakRef (&edit), dir] (Cleaner& c)
     {
-        DBG ("Purging temp file: " << f.getFileName());
-        AudioFile (edit.engine, f).deleteFile();
-    }
+        // The files are grouped by the clip or track they belong to, so each only has to be found once
+        std::unordered_map<EditItemID, juce::Array<juce::File>> filesForItems;
+        juce::Array<juce::File> renderFiles;
+
+        for (auto entry : juce::RangedDirectoryIterator (dir, false, "*"))
+        {
+            if (c.shouldStop())
+                return;
+
+            auto name = entry.getFile().getFileName();
+            auto itemID = getEditItemIDFromFilename (name);
+
+            if (itemID.isValid())
+                filesForItems[itemID].add (entry.getFile());
+            else if (name.startsWith (RenderManager::getFileRenderPrefix()))
+                renderFiles.add (entry.getFile());
+        }
+
+        if (filesForItems.empty() && renderFiles.isEmpty())
+            return;
+
+        MessageManager::callAsync ([editRef, filesForItems, renderFiles]
+        {
+            // If it's still loading, it'll be purged again when its transport is next deactivated
+            if (auto e = editRef.get())
+                if (! e->isLoading())
+                    e->engine.getTemporaryFileManager()
+                        .deleteAudioFilesInBackground (findOrphanFreezeAndProxyFiles (*e, filesForItems, renderFiles));
+        });
+    });
 }
 
 } // namespace tracktion_engine
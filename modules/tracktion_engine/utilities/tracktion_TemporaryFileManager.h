@@ -43,9 +43,25 @@ public:
     /** */
     int getMaxNumTempFiles() const;
 
-    /** */
+    /** Deletes old temp files until they fit within getMaxSpaceAllowedForTempFiles(),
+        least recently used first. This blocks whilst the folders are walked, so it's
+        best kept for shutdown; use cleanUpInBackground() at other times.
+    */
     void cleanUp();
 
+    /** Does the same as cleanUp(), but lists and deletes the files on a background thread.
+        Only the decisions that need to look at open Edits are made on the message thread.
+    */
+    void cleanUpInBackground();
+
+    /** Returns true if any of the background clean-ups are still running. */
+    bool isCleaningUp() const;
+
+    /** Limits how quickly the background clean-ups delete files, so that they don't hog a
+        slow or network drive. 0 means there's no limit.
+    */
+    void setMaxFileDeletionsPerSecond (int);
+
     /** */
     const juce::File& getTempDirectory() const;
 
@@ -64,16 +80,58 @@ public:
     /** */
     juce::File getUniqueTempFile (const juce::String& prefix, const juce::String& ext) const;
 
+    //==============================================================================
+    /** Returns the folder that renders shared between all Edits are kept in.
+        Files here are named after a hash of their content, so any Edit that needs the
+        same render will find it, and they're only deleted by trimSharedRenderCache().
+    */
+    juce::File getSharedRenderCacheFolder() const;
+
+    /** Returns a hash that changes whenever a source file is modified, for use in shared render hashes.
+        This uses the file's path, size and modification time rather than reading its content.
+    */
+    static juce::int64 getFileContentHash (const juce::File&);
+
+    /** Returns true if any of the open Edits is using the given file. */
+    bool isFileInUseByAnyEdit (const AudioFile&) const;
+
+    /** Returns the maximum size the shared render cache can grow to before renders are evicted. */
+    juce::int64 getMaxSpaceAllowedForSharedRenders() const;
+
+    /** Deletes the least recently used shared renders until the cache fits within
+        getMaxSpaceAllowedForSharedRenders(). Renders that any open Edit is using are never deleted.
+        This is called by cleanUp() and must be called on the message thread.
+    */
+    void trimSharedRenderCache();
+
     //==============================================================================
     /** */
     static AudioFile getFileForCachedClipRender (const AudioClipBase&, juce::int64 hash);
 
-    /** */
+    /** Returns the shared render of a comp, keyed by the take hash and the takes it's made from. */
     static AudioFile getFileForCachedCompRender (const AudioClipBase& clip, juce::int64 takeHash);
 
-    /** */
+    /** Returns the shared render for a whole-file render such as a reverse or a set of clip effects.
+        The hash must only depend on the content of the render, not the Edit or clip it's for.
+    */
     static AudioFile getFileForCachedFileRender (Edit&, juce::int64 hash);
 
+    /** Returns the shared render of one timestretched AudioSegmentList::Segment.
+        Clip proxies are put together from these so unchanged segments don't need stretching again.
+    */
+    static AudioFile getFileForCachedSegmentRender (Engine&, juce::int64 hash);
+
+    /** Returns the shared render of a nested Edit used by EditClips.
+        The hash should identify the Edits involved, so clips in any Edit that play the same
+        nested Edit with the same options can share it.
+    */
+    static AudioFile getFileForCachedEditRender (Engine&, juce::int64 hash);
+
+    /** Returns a file in the shared render cache for storing the results of analysing an
+        audio file, such as its transients. The hash should include the file's content hash.
+    */
+    static juce::File getFileForCachedAnalysis (Engine&, juce::int64 hash);
+
     /** */
     static juce::File getFreezeFileForDevice (Edit&, OutputDevice&);
 
@@ -83,21 +141,33 @@ public:
     /** */
     static juce::File getFreezeFileForTrack (const AudioTrack&);
 
+    /** Returns the file for one segment of a track freeze, named after the segment's hash. */
+    static juce::File getFreezeFileForTrackSegment (const AudioTrack&, juce::int64 segmentHash);
+
     /** */
     static juce::Array<juce::File> getFrozenTrackFiles (Edit&);
 
-    /** */
+    /** Deletes any files in the Edit's temp folder that its clips and tracks aren't using.
+        The folder is listed and the files are deleted in the background, so this returns
+        straight away and can be called whilst an Edit is being opened.
+    */
     static void purgeOrphanFreezeAndProxyFiles (Edit&);
 
-    /** */
+    /** Deletes the temp folders of any Edits that can't be found in a project.
+        Like purgeOrphanFreezeAndProxyFiles(), this happens in the background.
+    */
     void purgeOrphanEditTempFolders (ProjectManager&);
 
     //==============================================================================
 private:
+    class Cleaner;
+
     Engine& engine;
     juce::File tempDir;
+    std::unique_ptr<Cleaner> cleaner;
 
     void updateDir();
+    void deleteAudioFilesInBackground (const juce::Array<juce::File>&);
 
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TemporaryFileManager)
 };
@@ -0,0 +1,273 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+std::atomic<bool> TraceEvents::recording { false };
+
+//==============================================================================
+/** A single-producer, single-consumer ring of events, claimed by one thread at a time. */
+struct TraceEvents::ThreadBuffer
+{
+    std::unique_ptr<Event[]> events { new Event[(size_t) eventsPerThread] };
+    std::atomic<juce::uint32> writeIndex { 0 }, readIndex { 0 }, numDropped { 0 };
+    std::atomic<bool> isClaimed { false };
+    std::atomic<bool> isMessageThread { false };
+    int threadNumber = 0;
+};
+
+static_assert ((TraceEvents::eventsPerThread & (TraceEvents::eventsPerThread - 1)) == 0,
+               "The indexes wrap around, so this must be a power of two");
+
+namespace TraceEventHelpers
+{
+    // These are allocated when recording first starts and then kept, as the
+    // threads that have claimed them may still be using them after it stops
+    static std::unique_ptr<TraceEvents::ThreadBuffer[]> buffers;
+    static std::atomic<TraceEvents::ThreadBuffer*> bufferStorage { nullptr };
+
+    /** Releases the calling thread's buffer when the thread ends, so another can use it. */
+    struct ThreadClaim
+    {
+        ~ThreadClaim()
+        {
+            if (buffer != nullptr)
+                buffer->isClaimed.store (false, std::memory_order_release);
+        }
+
+        TraceEvents::ThreadBuffer* buffer = nullptr;
+        bool hasTriedToClaim = false;
+    };
+
+    static thread_local ThreadClaim threadClaim;
+
+    static juce::String escape (const char* text)
+    {
+        return juce::String (text).replace ("\\", "\\\\").replace ("\"", "\\\"");
+    }
+}
+
+//==============================================================================
+/** Empties the buffers in the background, writing the events to the trace file. */
+struct TraceEvents::Writer  : public juce::Thread
+{
+    Writer (const juce::File& f)
+        : juce::Thread ("Trace Event Writer"),
+          startTicks (juce::Time::getHighResolutionTicks()),
+          ticksPerMicrosecond (juce::Time::getHighResolutionTicksPerSecond() / 1.0e6)
+    {
+        if (f != juce::File())
+        {
+            f.deleteFile();
+            out = f.createOutputStream();
+
+            if (out != nullptr)
+                *out << "{\"traceEvents\":[";
+            else
+                TRACKTION_LOG_ERROR ("Unable to write the trace file: " + f.getFullPathName());
+        }
+
+        startThread (1);
+    }
+
+    ~Writer() override
+    {
+        stopThread (10000);
+        writeEvents();
+
+        for (int i = 0; i < maxNumThreads; ++i)
+            numDropped += TraceEventHelpers::bufferStorage.load()[i].numDropped.exchange (0);
+
+        if (numDropped > 0)
+            TRACKTION_LOG ("Trace events dropped: " + juce::String (numDropped));
+
+        if (out != nullptr)
+        {
+            writeThreadNames();
+            *out << "]}";
+            out->flush();
+        }
+    }
+
+    void run() override
+    {
+        while (! threadShouldExit())
+        {
+            writeEvents();
+            wait (50);
+        }
+    }
+
+    void writeEvents()
+    {
+        auto buffers = TraceEventHelpers::bufferStorage.load();
+
+        for (int i = 0; i < maxNumThreads; ++i)
+        {
+            auto& buffer = buffers[i];
+            auto read = buffer.readIndex.load (std::memory_order_relaxed);
+            auto write = buffer.writeIndex.load (std::memory_order_acquire);
+
+            if (read != write)
+                seenThreads.addIfNotAlreadyThere (i);
+
+            for (; read != write; ++read)
+                writeEvent (buffer, buffer.events[read % (juce::uint32) eventsPerThread]);
+
+            buffer.readIndex.store (read, std::memory_order_release);
+        }
+
+        if (out != nullptr)
+            out->flush();
+    }
+
+    void writeEvent (const ThreadBuffer& buffer, const Event& e)
+    {
+       #if TRACKTION_CHECK_FOR_SLOW_RENDERING
+        // This used to be logged on the audio thread when the scope ended
+        if (e.overran)
+            juce::Logger::outputDebugString (juce::String ((e.endTicks - e.startTicks) / (ticksPerMicrosecond * 1000.0))
+                                              + " " + e.file + ":" + juce::String (e.line));
+       #endif
+
+        if (out == nullptr || e.startTicks < startTicks)
+            return;
+
+        auto& os = *out;
+
+        if (numWritten++ > 0)
+            os << ",";
+
+        os << "\n{\"name\":\"" << TraceEventHelpers::escape (e.name)
+           << "\",\"cat\":\"" << e.category
+           << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer.threadNumber
+           << ",\"ts\":" << juce::String ((e.startTicks - startTicks) / ticksPerMicrosecond, 3)
+           << ",\"dur\":" << juce::String ((e.endTicks - e.startTicks) / ticksPerMicrosecond, 3)
+           << ",\"args\":{\"file\":\"" << TraceEventHelpers::escape (juce::File::createFileWithoutCheckingPath (e.file).getFileName().toRawUTF8())
+           << "\",\"line\":" << e.line
+           << (e.overran ? ",\"overran\":true" : "") << "}}";
+    }
+
+    void writeThreadNames()
+    {
+        auto buffers = TraceEventHelpers::bufferStorage.load();
+
+        for (auto i : seenThreads)
+        {
+            auto& buffer = buffers[i];
+            auto name = buffer.isMessageThread ? juce::String ("Message Thread")
+                                               : "Thread " + juce::String (buffer.threadNumber);
+
+            if (numWritten++ > 0)
+                *out << ",";
+
+            *out << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer.threadNumber
+                 << ",\"args\":{\"name\":\"" << name << "\"}}";
+        }
+    }
+
+    const juce::int64 startTicks;
+    const double ticksPerMicrosecond;
+    std::unique_ptr<juce::FileOutputStream> out;
+    juce::Array<int> seenThreads;
+    juce::int64 numWritten = 0;
+    juce::uint32 numDropped = 0;
+};
+
+static std::unique_ptr<TraceEvents::Writer> traceEventWriter;
+
+//==============================================================================
+void TraceEvents::start (const juce::File& traceFile)
+{
+    TRACKTION_ASSERT_MESSAGE_THREAD
+    using namespace TraceEventHelpers;
+
+    stop();
+
+    if (buffers == nullptr)
+    {
+        buffers.reset (new ThreadBuffer[(size_t) maxNumThreads]);
+
+        for (int i = 0; i < maxNumThreads; ++i)
+            buffers[i].threadNumber = i + 1;
+
+        bufferStorage = buffers.get();
+    }
+
+    // Anything recorded after the last trace stopped is thrown away
+    for (int i = 0; i < maxNumThreads; ++i)
+    {
+        buffers[i].readIndex.store (buffers[i].writeIndex.load());
+        buffers[i].numDropped = 0;
+    }
+
+    traceEventWriter = std::make_unique<Writer> (traceFile);
+    recording = true;
+}
+
+void TraceEvents::stop()
+{
+    TRACKTION_ASSERT_MESSAGE_THREAD
+    recording = false;
+    traceEventWriter.reset();
+}
+
+TraceEvents::ThreadBuffer* TraceEvents::getBufferForThisThread() noexcept
+{
+    using namespace TraceEventHelpers;
+    auto& claim = threadClaim;
+
+    if (claim.buffer != nullptr || claim.hasTriedToClaim)
+        return claim.buffer;
+
+    auto storage = bufferStorage.load (std::memory_order_acquire);
+
+    if (storage == nullptr)
+        return nullptr;
+
+    // A thread only tries once, so if they're all in use its events are never recorded
+    claim.hasTriedToClaim = true;
+
+    for (int i = 0; i < maxNumThreads; ++i)
+    {
+        bool expected = false;
+
+        if (storage[i].isClaimed.compare_exchange_strong (expected, true, std::memory_order_acquire))
+        {
+            storage[i].isMessageThread = juce::MessageManager::existsAndIsCurrentThread();
+            claim.buffer = &storage[i];
+            break;
+        }
+    }
+
+    return claim.buffer;
+}
+
+void TraceEvents::record (const Event& e) noexcept
+{
+    auto buffer = getBufferForThisThread();
+
+    if (buffer == nullptr)
+        return;
+
+    auto write = buffer->writeIndex.load (std::memory_order_relaxed);
+
+    if (write - buffer->readIndex.load (std::memory_order_acquire) >= (juce::uint32) eventsPerThread)
+    {
+        buffer->numDropped.fetch_add (1, std::memory_order_relaxed);
+        return;
+    }
+
+    buffer->events[write % (juce::uint32) eventsPerThread] = e;
+    buffer->writeIndex.store (write + 1, std::memory_order_release);
+}
+
+} // namespace tracktion_engine
@@ -0,0 +1,104 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+/**
+    Records when scopes start and end on any thread, cheaply enough to be left in the
+    audio code, so a trace can be viewed in chrome://tracing or Perfetto.
+
+    Nothing is recorded until start() is called, and until then each scope only costs
+    a check of a flag. Each thread that records gets its own fixed-size ring buffer, which
+    only it writes to, so recording never locks or allocates. A background thread empties
+    the buffers regularly and writes the events to the trace file. If a buffer fills up
+    before it's emptied, the newest events are dropped.
+
+    The SCOPED_REALTIME_CHECK and CRASH_TRACER macros record their scopes, and
+    TRACKTION_TRACE_SCOPE can be used to add others. The timestamps come from
+    juce::Time::getHighResolutionTicks(), which is monotonic.
+*/
+class TraceEvents
+{
+public:
+    //==============================================================================
+    /** A scope that's been recorded. The strings must be literals, or last as long. */
+    struct Event
+    {
+        const char* name = nullptr;
+        const char* file = nullptr;
+        const char* category = nullptr;
+        int line = 0;
+        juce::int64 startTicks = 0, endTicks = 0;
+        bool overran = false;       /**< True if a SCOPED_REALTIME_CHECK took longer than it should have. */
+    };
+
+    /** Starts recording events and writing them to a Chrome trace file.
+        If the file is File(), the events are recorded but not written, which is useful with
+        TRACKTION_CHECK_FOR_SLOW_RENDERING as that logs the scopes that overran.
+        This should only be called on the message thread.
+    */
+    static void start (const juce::File& traceFile);
+
+    /** Stops recording and finishes writing the trace file. */
+    static void stop();
+
+    static bool isRecording() noexcept          { return recording.load (std::memory_order_relaxed); }
+
+    /** Adds an event to the calling thread's buffer. This is real-time safe. */
+    static void record (const Event&) noexcept;
+
+    /** The most threads that can record at the same time, and how many events each can hold. */
+    static constexpr int maxNumThreads = 64;
+    static constexpr int eventsPerThread = 4096;
+
+    /** @internal */
+    struct ThreadBuffer;
+    /** @internal */
+    struct Writer;
+
+private:
+    static std::atomic<bool> recording;
+    static ThreadBuffer* getBufferForThisThread() noexcept;
+};
+
+//==============================================================================
+/** Records the lifetime of a scope as a TraceEvents event. */
+struct ScopedTraceEvent
+{
+    ScopedTraceEvent (const char* nameToUse, const char* fileToUse, int lineToUse) noexcept
+        : name (nameToUse), file (fileToUse), line (lineToUse),
+          startTicks (TraceEvents::isRecording() ? juce::Time::getHighResolutionTicks() : 0)
+    {
+    }
+
+    ~ScopedTraceEvent() noexcept
+    {
+        if (startTicks != 0 && TraceEvents::isRecording())
+            TraceEvents::record ({ name, file, "trace", line, startTicks, juce::Time::getHighResolutionTicks(), false });
+    }
+
+private:
+    const char* name;
+    const char* file;
+    int line;
+    const juce::int64 startTicks;
+
+    JUCE_DECLARE_NON_COPYABLE (ScopedTraceEvent)
+};
+
+#if TRACKTION_TRACE_EVENTS
+ /** Records the current scope with the given name, which must be a string literal. */
+ #define TRACKTION_TRACE_SCOPE(name)    const ScopedTraceEvent JUCE_JOIN_MACRO (__traceEvent, __LINE__) (name, __FILE__, __LINE__);
+#else
+ #define TRACKTION_TRACE_SCOPE(name)
+#endif
+
+} // namespace tracktion_engine
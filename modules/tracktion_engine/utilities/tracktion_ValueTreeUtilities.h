@@ -52,6 +52,49 @@ inline void forEachItem (const juce::Array<Type*>& items, const UnaryFunction& f
         fn (f);
 }
 
+//==============================================================================
+/**
+    Wraps a std::atomic so it can be used as the type of a juce::CachedValue.
+
+    The value can then be read from the audio thread without racing with the message
+    thread updating it when the tree changes, e.g.
+    @code
+    juce::CachedValue<AtomicWrapper<float>> gain;
+
+    float g = gain.get();
+    @endcode
+*/
+template<typename Type>
+struct AtomicWrapper
+{
+    AtomicWrapper() = default;
+
+    template<typename OtherType>
+    AtomicWrapper (const OtherType& other)
+    {
+        value.store (static_cast<Type> (other), std::memory_order_relaxed);
+    }
+
+    AtomicWrapper (const AtomicWrapper& other)
+    {
+        value.store (other.value.load (std::memory_order_relaxed), std::memory_order_relaxed);
+    }
+
+    AtomicWrapper& operator= (const AtomicWrapper& other) noexcept
+    {
+        value.store (other.value.load (std::memory_order_relaxed), std::memory_order_relaxed);
+        return *this;
+    }
+
+    bool operator== (const AtomicWrapper& other) const noexcept     { return value.load (std::memory_order_relaxed) == other.value.load (std::memory_order_relaxed); }
+    bool operator!= (const AtomicWrapper& other) const noexcept     { return ! operator== (other); }
+
+    operator juce::var() const noexcept                             { return value.load (std::memory_order_relaxed); }
+    operator Type() const noexcept                                  { return value.load (std::memory_order_relaxed); }
+
+    std::atomic<Type> value { Type() };
+};
+
 //==============================================================================
 template<typename ObjectType, typename CriticalSectionType = juce::DummyCriticalSection>
 class ValueTreeObjectList   : public juce::ValueTree::Listener
@@ -103,24 +146,66 @@ public:
     virtual void objectRemoved (ObjectType*) = 0;
     virtual void objectOrderChanged() = 0;
 
+    /** Called once at the end of a Batch, instead of newObjectAdded and objectOrderChanged
+        being called for each change. By default it just calls those.
+    */
+    virtual void objectsChangedInBatch (const juce::Array<ObjectType*>& newObjects, bool orderChanged)
+    {
+        for (auto o : newObjects)
+            newObjectAdded (o);
+
+        if (orderChanged)
+            objectOrderChanged();
+    }
+
+    //==============================================================================
+    /** Whilst one of these exists, children that are added or moved still get their objects
+        created straight away, but the objects array is only put back into the tree's
+        order, and the subclass told about the changes, when the last one's deleted.
+        Use this around bulk changes such as pasting lots of items. Objects being removed are
+        still dealt with immediately, and the order of the objects array isn't meaningful
+        until it finishes.
+    */
+    struct Batch
+    {
+        Batch (ValueTreeObjectList& l) : list (l)     { ++list.batchDepth; }
+        ~Batch()                                        { if (--list.batchDepth == 0) list.finishBatch(); }
+
+    private:
+        ValueTreeObjectList& list;
+
+        JUCE_DECLARE_NON_COPYABLE (Batch)
+    };
+
     //==============================================================================
     void valueTreeChildAdded (juce::ValueTree&, juce::ValueTree& tree) override
     {
         if (isChildTree (tree))
         {
-            auto index = parent.indexOf (tree);
-            juce::ignoreUnused (index);
-            jassert (index >= 0);
+            jassert (parent.indexOf (tree) >= 0);
 
             if (auto* newObject = createNewObject (tree))
             {
+                if (batchDepth > 0)
+                {
+                    {
+                        const ScopedLockType sl (arrayLock);
+                        objects.add (newObject);
+                    }
+
+                    objectsAddedInBatch.add (newObject);
+                    batchOrderChanged = true;
+                    return;
+                }
+
                 {
                     const ScopedLockType sl (arrayLock);
 
-                    if (index == parent.getNumChildren() - 1)
+                    // Checking the last child first avoids a search when children are appended
+                    if (parent.getChild (parent.getNumChildren() - 1) == tree)
                         objects.add (newObject);
                     else
-                        objects.addSorted (*this, newObject);
+                        objects.insert (getObjectIndexAfterPreviousSibling (tree, -1), newObject);
                 }
 
                 newObjectAdded (newObject);
@@ -145,19 +230,30 @@ public:
                     o = objects.removeAndReturn (oldIndex);
                 }
 
+                objectsAddedInBatch.removeFirstMatchingValue (o);
                 objectRemoved (o);
                 deleteObject (o);
             }
         }
     }
 
-    void valueTreeChildOrderChanged (juce::ValueTree& tree, int, int) override
+    void valueTreeChildOrderChanged (juce::ValueTree& tree, int oldIndex, int newIndex) override
     {
         if (tree == parent)
         {
+            if (batchDepth > 0)
+            {
+                batchOrderChanged = true;
+                return;
+            }
+
             {
                 const ScopedLockType sl (arrayLock);
-                sortArray();
+
+                // A single child being moved only needs its own object moving, but a
+                // tree that's been sorted in one go says nothing about what's changed
+                if (oldIndex == newIndex || ! moveObjectToMatchTree (newIndex))
+                    sortArray();
             }
 
             objectOrderChanged();
@@ -175,6 +271,7 @@ public:
 
 protected:
     juce::ValueTree parent;
+    mutable std::atomic<int> lastIndexFound { 0 };
 
     void deleteAllObjects()
     {
@@ -191,18 +288,118 @@ protected:
 
     int indexOf (const juce::ValueTree& v) const noexcept
     {
-        for (int i = 0; i < objects.size(); ++i)
-            if (objects.getUnchecked(i)->state == v)
-                return i;
+        // Lookups tend to come from working through the children in order, so this
+        // searches outwards from the last match rather than from the start
+        const int num = objects.size();
+        const int hint = juce::jlimit (0, juce::jmax (0, num - 1), lastIndexFound.load (std::memory_order_relaxed));
+
+        for (int distance = 0; hint - distance >= 0 || hint + distance < num; ++distance)
+        {
+            const int after = hint + distance;
+
+            if (after < num && objects.getUnchecked (after)->state == v)
+            {
+                lastIndexFound.store (after, std::memory_order_relaxed);
+                return after;
+            }
+
+            const int before = hint - distance;
+
+            if (distance > 0 && before >= 0 && objects.getUnchecked (before)->state == v)
+            {
+                lastIndexFound.store (before, std::memory_order_relaxed);
+                return before;
+            }
+        }
 
         return -1;
     }
 
+    /** Puts the objects into the same order as their trees. */
     void sortArray()
     {
-        objects.sort (*this);
+        // Each object's found by searching out from where the last one was, so
+        // this is quick when most of the objects are already in order
+        juce::Array<ObjectType*> newOrder;
+        newOrder.ensureStorageAllocated (objects.size());
+
+        for (const auto& v : parent)
+            if (isSuitableType (v))
+                if (auto o = objects[indexOf (v)])
+                    newOrder.add (o);
+
+        jassert (newOrder.size() == objects.size());
+
+        if (newOrder.size() == objects.size())
+            objects.swapWith (newOrder);
+    }
+
+    /** Returns the index just after the object for the nearest suitable child before this
+        one, which is where its object should go. The object at ignoreIndex is treated as
+        if it's been removed.
+    */
+    int getObjectIndexAfterPreviousSibling (const juce::ValueTree& v, int ignoreIndex) const
+    {
+        for (int i = parent.indexOf (v); --i >= 0;)
+        {
+            auto sibling = parent.getChild (i);
+
+            if (isSuitableType (sibling))
+            {
+                auto index = indexOf (sibling);
+
+                if (index >= 0)
+                    return (ignoreIndex >= 0 && index > ignoreIndex) ? index : index + 1;
+            }
+        }
+
+        return 0;
+    }
+
+    /** Moves the object for the child at the given index to match the tree.
+        Returns false if that didn't work and the whole array needs sorting.
+    */
+    bool moveObjectToMatchTree (int childIndex)
+    {
+        auto moved = parent.getChild (childIndex);
+
+        if (! moved.isValid())
+            return false;
+
+        if (! isSuitableType (moved))
+            return true;
+
+        auto currentIndex = indexOf (moved);
+
+        if (currentIndex < 0)
+            return false;
+
+        objects.move (currentIndex, getObjectIndexAfterPreviousSibling (moved, currentIndex));
+        return true;
     }
 
+    void finishBatch()
+    {
+        {
+            const ScopedLockType sl (arrayLock);
+
+            if (batchOrderChanged)
+                sortArray();
+        }
+
+        juce::Array<ObjectType*> newObjects;
+        newObjects.swapWith (objectsAddedInBatch);
+        const bool orderChanged = batchOrderChanged;
+        batchOrderChanged = false;
+
+        if (! newObjects.isEmpty() || orderChanged)
+            objectsChangedInBatch (newObjects, orderChanged);
+    }
+
+    int batchDepth = 0;
+    juce::Array<ObjectType*> objectsAddedInBatch;
+    bool batchOrderChanged = false;
+
 public:
     int compareElements (ObjectType* first, ObjectType* second) const
     {
@@ -0,0 +1,113 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+namespace tracktion_engine
+{
+
+/**
+    Resamples audio at a rate that can change from one section to the next, e.g. for tape
+    starts and stops or scrubbing.
+
+    Like SincResampler, this doesn't keep any history between calls. It's given the input
+    either side of the section and the exact position to start at, so the ratio can be
+    different for every section, e.g. to follow a speed curve in short steps, without the
+    output jumping. It has no state and never allocates, so it can be shared by any number
+    of nodes. The read position of every output sample is worked out from the start,
+    rather than accumulated, so it doesn't drift.
+
+    The positions and the 4-point Lagrange coefficients are calculated a block at a time
+    in loops the compiler can vectorise, then used for all the channels in turn.
+*/
+struct VariableRateResampler
+{
+    /** The maximum number of channels processAdding can process at once. */
+    static constexpr int maxNumChannels = 32;
+
+    /** The number of input samples that are needed before and after the ones that are read. */
+    static constexpr int numPaddingSamplesBefore = 1;
+    static constexpr int numPaddingSamplesAfter = 2;
+
+    /** Returns the number of input samples, not including the padding, that will be read to
+        produce some output samples.
+    */
+    static int getNumInputSamplesNeeded (int numOutputSamples, double startPosition, double ratio) noexcept
+    {
+        if (numOutputSamples <= 0)
+            return 0;
+
+        return (int) std::floor (startPosition + (numOutputSamples - 1) * ratio) + 1;
+    }
+
+    /** Resamples some channels and adds them to the destination.
+
+        @param source           the first input sample for each channel. The numPaddingSamplesBefore
+                                samples before this must also be valid, as must the numPaddingSamplesAfter
+                                samples after the getNumInputSamplesNeeded() samples that are read.
+        @param dest             where to add the output for each channel
+        @param gains            the gain to apply to each channel
+        @param numChannels      the number of channels, up to maxNumChannels
+        @param numOutputSamples the number of samples to add to each destination channel
+        @param startPosition    the position of the first output sample relative to the first input
+                                sample, this should be in the range [0, 1)
+        @param ratio            the number of input samples for each output sample
+    */
+    static void processAdding (const float* const* source, float* const* dest, const float* gains,
+                               int numChannels, int numOutputSamples,
+                               double startPosition, double ratio) noexcept
+    {
+        jassert (numChannels <= maxNumChannels);
+        jassert (ratio >= 0.0);
+
+        int index[blockSize];
+        float c0[blockSize], c1[blockSize], c2[blockSize], c3[blockSize];
+
+        for (int start = 0; start < numOutputSamples; start += blockSize)
+        {
+            const int num = std::min (blockSize, numOutputSamples - start);
+
+            for (int i = 0; i < num; ++i)
+            {
+                const auto pos = startPosition + (start + i) * ratio;
+                const auto whole = std::floor (pos);
+                const auto t = (float) (pos - whole);
+
+                // Lagrange polynomial through the samples at -1, 0, 1 and 2
+                const auto tp1 = t + 1.0f, tm1 = t - 1.0f, tm2 = t - 2.0f;
+                index[i] = (int) whole;
+                c0[i] = -t * tm1 * tm2 * (1.0f / 6.0f);
+                c1[i] = tp1 * tm1 * tm2 * 0.5f;
+                c2[i] = -tp1 * t * tm2 * 0.5f;
+                c3[i] = tp1 * t * tm1 * (1.0f / 6.0f);
+            }
+
+            for (int chan = 0; chan < numChannels; ++chan)
+            {
+                const auto gain = gains[chan];
+
+                if (gain == 0.0f)
+                    continue;
+
+                const auto* src = source[chan] - 1;
+                auto* d = dest[chan] + start;
+
+                for (int i = 0; i < num; ++i)
+                {
+                    const auto* s = src + index[i];
+                    d[i] += gain * (c0[i] * s[0] + c1[i] * s[1] + c2[i] * s[2] + c3[i] * s[3]);
+                }
+            }
+        }
+    }
+
+private:
+    static constexpr int blockSize = 64;
+};
+
+} // namespace tracktion_engine
@@ -25,3 +25,6 @@
 
 #include "tracktion_graph/tracktion_graph_tests_Node.cpp"
 #include "tracktion_graph/tracktion_graph_tests_NodeVisiting.cpp"
+#include "tracktion_graph/tracktion_graph_tests_NodeProfiler.cpp"
+#include "tracktion_graph/tracktion_graph_tests_Summing.cpp"
+#include "tracktion_graph/tracktion_graph_tests_Benchmarks.cpp"
@@ -46,6 +46,15 @@
 #pragma once
 #define TRACKTION_GRAPH_H_INCLUDED
 
+//==============================================================================
+/** Config: TRACKTION_GRAPH_PROFILING
+    Enables recording how long each Node takes to process in the NodePlayer and
+    MultiThreadedNodePlayer. @see NodeProfiler
+*/
+#ifndef TRACKTION_GRAPH_PROFILING
+ #define TRACKTION_GRAPH_PROFILING 0
+#endif
+
 //==============================================================================
 #include <juce_audio_processors/juce_audio_processors.h>
 #include <juce_dsp/juce_dsp.h>
@@ -54,9 +63,14 @@
 //==============================================================================
 #include "utilities/tracktion_AudioFifo.h"
 #include "utilities/tracktion_MidiMessageArray.h"
+#include "utilities/tracktion_ThreadUtilities.h"
+#include "utilities/tracktion_AudioSumming.h"
 
 #include "tracktion_graph/tracktion_graph_Utility.h"
 #include "tracktion_graph/tracktion_graph_Node.h"
+#include "tracktion_graph/tracktion_graph_GraphPlan.h"
+#include "tracktion_graph/tracktion_graph_SubBlockSplitter.h"
+#include "tracktion_graph/tracktion_graph_NodeProfiler.h"
 #include "tracktion_graph/tracktion_graph_NodePlayer.h"
 #include "tracktion_graph/tracktion_graph_MultiThreadedNodePlayer.h"
 #include "tracktion_graph/tracktion_graph_UtilityNodes.h"
@@ -0,0 +1,546 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+#pragma once
+
+#include <numeric>
+#include <unordered_map>
+
+namespace tracktion_graph
+{
+
+//==============================================================================
+//==============================================================================
+/**
+    A compiled, flattened description of a Node graph's topology.
+
+    This is built once after a graph has been initialised and can then be used
+    by players to iterate the graph without having to walk the Node pointers or
+    make virtual calls to Node::getDirectInputNodes() during processing.
+
+    Nodes are referred to by their index in the nodes array which is in
+    topological (postordering) order so a Node's inputs always have a lower index
+    than the Node itself and the root Node is always last.
+    Inputs and outputs are stored in a compressed sparse row layout, i.e. the
+    inputs of Node i are inputIndices[inputOffsets[i]] to inputIndices[inputOffsets[i + 1]].
+
+    Each Node is also assigned a level, leaf Nodes are level 0 and every other
+    Node is one level higher than its highest input. All Nodes on the same level
+    can therefore be processed concurrently.
+*/
+struct GraphPlan
+{
+    /** Creates an empty plan. */
+    GraphPlan() = default;
+
+    /** Creates a plan for a graph.
+        This should be called after the graph has been transformed and initialised
+        as it is only valid whilst the topology remains unchanged.
+    */
+    explicit GraphPlan (Node& rootNode);
+
+    //==============================================================================
+    /** A range of Node indices within one of the plan's index arrays. */
+    struct IndexRange
+    {
+        const size_t* first = nullptr;
+        const size_t* last = nullptr;
+
+        const size_t* begin() const noexcept    { return first; }
+        const size_t* end() const noexcept      { return last; }
+        size_t size() const noexcept            { return (size_t) (last - first); }
+        bool empty() const noexcept             { return first == last; }
+    };
+
+    /** Returns the number of Nodes in the plan. */
+    size_t size() const noexcept                                    { return nodes.size(); }
+
+    /** Returns the Node at a given index. */
+    Node& getNode (size_t nodeIndex) const                          { return *nodes[nodeIndex]; }
+
+    /** Returns the indices of the Nodes directly feeding in to a Node. */
+    IndexRange getInputs (size_t nodeIndex) const noexcept          { return getRange (inputIndices, inputOffsets, nodeIndex); }
+
+    /** Returns the indices of the Nodes that directly use a Node as an input. */
+    IndexRange getOutputs (size_t nodeIndex) const noexcept         { return getRange (outputIndices, outputOffsets, nodeIndex); }
+
+    /** Returns the number of levels in the plan. */
+    size_t getNumLevels() const noexcept                            { return levelOffsets.empty() ? 0 : levelOffsets.size() - 1; }
+
+    /** Returns the indices of the Nodes on a given level. */
+    IndexRange getNodesOnLevel (size_t level) const noexcept        { return getRange (nodesByLevel, levelOffsets, level); }
+
+    /** Returns the maximum number of Nodes on any one level.
+        This is the maximum number of Nodes that could ever be processed concurrently.
+    */
+    size_t getMaxLevelWidth() const noexcept                        { return maxLevelWidth; }
+
+    //==============================================================================
+    /** Describes which shared buffer, or slot, each Node should use for its output. */
+    struct BufferAssignment
+    {
+        std::vector<size_t> slotForNode;
+        std::vector<int> numChannelsForSlot;
+        std::vector<bool> processesInPlace;
+        std::vector<int> domainForSlot;     /**< Only filled in if a partition was used, -1 means any domain. */
+
+        size_t getNumSlots() const noexcept                         { return numChannelsForSlot.size(); }
+    };
+
+    /** Works out which Nodes can share output buffers, in the same way as register allocation.
+        A Node's buffer is reused once all the Nodes reading from it have been processed.
+        The root Node's buffer is never reused as it is read after the graph has been processed.
+        Nodes that can process in-place are given their input's buffer if they are its only reader.
+
+        @param processedSequentially If true, Nodes are assumed to be processed in plan order.
+                                     If false, buffers are only reused by Nodes that depend on
+                                     all the readers so it is safe for concurrent processing.
+        @param domainForNode         An optional partition from createNumaPartition. If this is
+                                     given, buffers are only shared between Nodes in the same domain
+                                     so each domain's buffers can be kept in its own memory.
+    */
+    BufferAssignment createBufferAssignment (bool processedSequentially,
+                                             const std::vector<int>& domainForNode = {}) const;
+
+    /** Splits the graph in to independent sub-graphs and spreads them across a number of
+        domains, e.g. the NUMA nodes of a machine, so each can be processed by threads on
+        the same socket.
+
+        A sub-graph is a Node and all of its inputs that aren't used by anything outside it,
+        e.g. a track feeding a summing Node. Nodes shared between sub-graphs, and the chain
+        from the root down to the first Node with more than one input, aren't in any domain
+        and are given -1. The sub-graphs are balanced across the domains by their number of Nodes.
+
+        @returns the domain for each Node in the plan
+    */
+    std::vector<int> createNumaPartition (size_t numDomains) const;
+
+    //==============================================================================
+    std::vector<Node*> nodes;
+    std::vector<size_t> inputOffsets, inputIndices;
+    std::vector<size_t> outputOffsets, outputIndices;
+    std::vector<size_t> levels, levelOffsets, nodesByLevel;
+    size_t maxLevelWidth = 0;
+
+private:
+    static IndexRange getRange (const std::vector<size_t>& indices, const std::vector<size_t>& offsets, size_t index) noexcept
+    {
+        jassert (index + 1 < offsets.size());
+        return { indices.data() + offsets[index], indices.data() + offsets[index + 1] };
+    }
+};
+
+
+//==============================================================================
+//==============================================================================
+inline GraphPlan::GraphPlan (Node& rootNode)
+    : nodes (getNodes (rootNode, VertexOrdering::postordering))
+{
+    const size_t numNodes = nodes.size();
+
+    std::unordered_map<Node*, size_t> nodeIndices;
+    nodeIndices.reserve (numNodes);
+
+    for (size_t i = 0; i < numNodes; ++i)
+        nodeIndices[nodes[i]] = i;
+
+    // Find the inputs, this is the only time getDirectInputNodes needs to be called
+    inputOffsets.reserve (numNodes + 1);
+    inputOffsets.push_back (0);
+    levels.resize (numNodes, 0);
+    std::vector<size_t> numOutputs (numNodes, 0);
+
+    for (size_t i = 0; i < numNodes; ++i)
+    {
+        const auto firstInput = inputIndices.size();
+
+        for (auto input : nodes[i]->getDirectInputNodes())
+        {
+            auto found = nodeIndices.find (input);
+            jassert (found != nodeIndices.end());
+
+            if (found == nodeIndices.end())
+                continue;
+
+            const auto inputIndex = found->second;
+
+            // Postordering means inputs must come first, anything else would be a cycle
+            jassert (inputIndex < i);
+
+            if (inputIndex >= i
+                || std::find (inputIndices.begin() + (std::ptrdiff_t) firstInput, inputIndices.end(), inputIndex) != inputIndices.end())
+                continue;
+
+            inputIndices.push_back (inputIndex);
+            ++numOutputs[inputIndex];
+            levels[i] = std::max (levels[i], levels[inputIndex] + 1);
+        }
+
+        inputOffsets.push_back (inputIndices.size());
+    }
+
+    // Then invert the inputs to get the outputs
+    outputOffsets.resize (numNodes + 1, 0);
+
+    for (size_t i = 0; i < numNodes; ++i)
+        outputOffsets[i + 1] = outputOffsets[i] + numOutputs[i];
+
+    outputIndices.resize (inputIndices.size());
+    std::vector<size_t> outputsAdded (outputOffsets.begin(), outputOffsets.end() - 1);
+
+    for (size_t i = 0; i < numNodes; ++i)
+        for (auto inputIndex : getInputs (i))
+            outputIndices[outputsAdded[inputIndex]++] = i;
+
+    // Finally bucket the nodes by level
+    const size_t numLevels = numNodes > 0 ? *std::max_element (levels.begin(), levels.end()) + 1 : 0;
+    levelOffsets.resize (numLevels + 1, 0);
+
+    for (auto level : levels)
+        ++levelOffsets[level + 1];
+
+    for (size_t i = 0; i < numLevels; ++i)
+    {
+        maxLevelWidth = std::max (maxLevelWidth, levelOffsets[i + 1]);
+        levelOffsets[i + 1] += levelOffsets[i];
+    }
+
+    nodesByLevel.resize (numNodes);
+    std::vector<size_t> nodesAdded (levelOffsets.begin(), levelOffsets.end() - 1);
+
+    for (size_t i = 0; i < numNodes; ++i)
+        nodesByLevel[nodesAdded[levels[i]]++] = i;
+}
+
+inline GraphPlan::BufferAssignment GraphPlan::createBufferAssignment (bool processedSequentially,
+                                                                     const std::vector<int>& domainForNode) const
+{
+    const size_t numNodes = size();
+    BufferAssignment assignment;
+    assignment.slotForNode.resize (numNodes);
+    assignment.processesInPlace.resize (numNodes, false);
+
+    jassert (domainForNode.empty() || domainForNode.size() == numNodes);
+    const bool usesDomains = domainForNode.size() == numNodes;
+
+    // When processing concurrently, a buffer can only be reused by a Node that depends on
+    // all the readers of it so we need to know all the transitive inputs of each Node.
+    // This is stored as a bitset per Node which gets quite big for huge graphs so above
+    // a certain size buffers simply aren't shared
+    constexpr size_t maxNumNodesToShareConcurrently = 8192;
+    const bool canShare = processedSequentially || numNodes <= maxNumNodesToShareConcurrently;
+    const size_t numWords = (numNodes + 63) / 64;
+    std::vector<uint64_t> ancestors ((processedSequentially || ! canShare) ? 0 : numNodes * numWords, 0);
+
+    if (! ancestors.empty())
+    {
+        for (size_t i = 0; i < numNodes; ++i)
+        {
+            auto nodeAncestors = ancestors.data() + i * numWords;
+
+            for (auto inputIndex : getInputs (i))
+            {
+                auto inputAncestors = ancestors.data() + inputIndex * numWords;
+                nodeAncestors[inputIndex / 64] |= (uint64_t) 1 << (inputIndex % 64);
+
+                for (size_t w = 0; w < numWords; ++w)
+                    nodeAncestors[w] |= inputAncestors[w];
+            }
+        }
+    }
+
+    auto dependsOn = [&] (size_t nodeIndex, size_t possibleInputIndex)
+    {
+        return ((ancestors[nodeIndex * numWords + possibleInputIndex / 64] >> (possibleInputIndex % 64)) & 1) != 0;
+    };
+
+    auto hasFinishedWith = [&] (size_t ownerIndex, size_t nodeIndex)
+    {
+        if (! canShare || ownerIndex == numNodes - 1)
+            return false;
+
+        for (auto readerIndex : getOutputs (ownerIndex))
+        {
+            if (processedSequentially ? readerIndex >= nodeIndex
+                                      : ! dependsOn (nodeIndex, readerIndex))
+                return false;
+        }
+
+        return true;
+    };
+
+    std::vector<int> numChannelsForNode (numNodes);
+
+    for (size_t i = 0; i < numNodes; ++i)
+        numChannelsForNode[i] = nodes[i]->getNodeProperties().numberOfChannels;
+
+    auto canProcessInPlace = [&] (size_t nodeIndex)
+    {
+        auto inputs = getInputs (nodeIndex);
+
+        // Double precision Nodes process in to their own buffers so can't take over their input's
+        if (inputs.size() != 1 || ! nodes[nodeIndex]->canProcessInPlace()
+             || nodes[nodeIndex]->isProcessingInDoublePrecision())
+            return false;
+
+        const auto inputIndex = *inputs.begin();
+
+        return getOutputs (inputIndex).size() == 1
+            && numChannelsForNode[inputIndex] == numChannelsForNode[nodeIndex];
+    };
+
+    std::vector<size_t> slotOwners;
+
+    for (size_t i = 0; i < numNodes; ++i)
+    {
+        const int numChannels = numChannelsForNode[i];
+
+        // The input's buffer is only read by this Node so it can simply take it over
+        if (canShare && canProcessInPlace (i))
+        {
+            const auto slot = assignment.slotForNode[*getInputs (i).begin()];
+            slotOwners[slot] = i;
+            assignment.slotForNode[i] = slot;
+            assignment.processesInPlace[i] = true;
+            continue;
+        }
+
+        size_t freeSlot = slotOwners.size();
+
+        // Look for a free slot, preferably one that won't need to grow
+        for (size_t slot = 0; slot < slotOwners.size(); ++slot)
+        {
+            if (usesDomains && assignment.domainForSlot[slot] != domainForNode[i])
+                continue;
+
+            if (! hasFinishedWith (slotOwners[slot], i))
+                continue;
+
+            if (freeSlot == slotOwners.size())
+                freeSlot = slot;
+
+            if (assignment.numChannelsForSlot[slot] >= numChannels)
+            {
+                freeSlot = slot;
+                break;
+            }
+        }
+
+        if (freeSlot == slotOwners.size())
+        {
+            slotOwners.push_back (i);
+            assignment.numChannelsForSlot.push_back (numChannels);
+
+            if (usesDomains)
+                assignment.domainForSlot.push_back (domainForNode[i]);
+        }
+        else
+        {
+            slotOwners[freeSlot] = i;
+            assignment.numChannelsForSlot[freeSlot] = std::max (assignment.numChannelsForSlot[freeSlot], numChannels);
+        }
+
+        assignment.slotForNode[i] = freeSlot;
+    }
+
+    return assignment;
+}
+
+inline std::vector<int> GraphPlan::createNumaPartition (size_t numDomains) const
+{
+    const size_t numNodes = size();
+    constexpr int noDomain = -1;
+    std::vector<int> domainForNode (numNodes, noDomain);
+
+    if (numDomains < 2 || numNodes < 2)
+        return domainForNode;
+
+    // Walk back from the root finding the sub-graphs. A Node belongs to its outputs' sub-graph
+    // if they're all in the same one. If they're in different ones it's shared. If none are in
+    // one, it starts a new sub-graph unless it's just continuing a chain of shared Nodes
+    std::vector<int> groupForNode (numNodes, noDomain);
+    std::vector<size_t> groupSizes;
+
+    for (size_t i = numNodes - 1; i-- > 0;)
+    {
+        auto outputs = getOutputs (i);
+        int group = noDomain;
+        bool isShared = false, hasSharedOutput = false;
+
+        for (auto outputIndex : outputs)
+        {
+            const auto outputGroup = groupForNode[outputIndex];
+
+            if (outputGroup == noDomain)
+                hasSharedOutput = true;
+            else if (group == noDomain)
+                group = outputGroup;
+            else if (outputGroup != group)
+                isShared = true;
+        }
+
+        if (isShared || (hasSharedOutput && group != noDomain))
+            continue;
+
+        if (group == noDomain)
+        {
+            if (outputs.size() == 1 && getInputs (*outputs.begin()).size() == 1)
+                continue;
+
+            group = (int) groupSizes.size();
+            groupSizes.push_back (0);
+        }
+
+        groupForNode[i] = group;
+        ++groupSizes[(size_t) group];
+    }
+
+    // Then give the biggest sub-graphs to the least loaded domains first
+    std::vector<size_t> groupOrder (groupSizes.size());
+    std::iota (groupOrder.begin(), groupOrder.end(), (size_t) 0);
+    std::stable_sort (groupOrder.begin(), groupOrder.end(),
+                      [&] (size_t a, size_t b) { return groupSizes[a] > groupSizes[b]; });
+
+    std::vector<int> domainForGroup (groupSizes.size(), noDomain);
+    std::vector<size_t> domainLoads (numDomains, 0);
+
+    for (auto group : groupOrder)
+    {
+        const auto domain = (size_t) std::distance (domainLoads.begin(), std::min_element (domainLoads.begin(), domainLoads.end()));
+        domainForGroup[group] = (int) domain;
+        domainLoads[domain] += groupSizes[group];
+    }
+
+    for (size_t i = 0; i < numNodes; ++i)
+        if (groupForNode[i] != noDomain)
+            domainForNode[i] = domainForGroup[(size_t) groupForNode[i]];
+
+    return domainForNode;
+}
+
+
+//==============================================================================
+//==============================================================================
+/**
+    Owns the buffers that are shared between the Nodes in a GraphPlan.
+    Keep this alive for as long as the Nodes in the plan are being processed.
+*/
+class SharedNodeBuffers
+{
+public:
+    SharedNodeBuffers() = default;
+
+    /** Allocates the buffers for a BufferAssignment and tells the Nodes to use them.
+        If the assignment has a domain for each slot, these are taken to be indices of
+        the NumaTopology's nodes and each domain's buffers are allocated together and
+        moved to that node's memory.
+    */
+    void assign (const GraphPlan& plan, const GraphPlan::BufferAssignment& assignment, int blockSize)
+    {
+        jassert (assignment.slotForNode.size() == plan.size());
+        slots.clear();
+        domainBlocks.clear();
+
+        for (size_t i = 0; i < assignment.getNumSlots(); ++i)
+            slots.push_back (std::make_unique<Slot>());
+
+        if (assignment.domainForSlot.size() == assignment.getNumSlots()
+             && NumaTopology::getSystemTopology().nodes.size() > 1)
+            allocateInDomains (assignment, blockSize);
+        else
+            for (size_t i = 0; i < assignment.getNumSlots(); ++i)
+                slots[i]->audio.setSize (assignment.numChannelsForSlot[i], blockSize);
+
+        for (size_t i = 0; i < plan.size(); ++i)
+        {
+            auto& slot = *slots[assignment.slotForNode[i]];
+
+            if (plan.getNode (i).getNodeProperties().hasMidi && slot.midi.getCapacity() == 0)
+                slot.midi.reserve (tracktion_engine::MidiMessageArray::defaultNumMessagesToReserve);
+
+            plan.getNode (i).setSharedBuffers (juce::dsp::AudioBlock<float> (slot.audio), slot.midi,
+                                               assignment.processesInPlace[i]);
+        }
+    }
+
+    /** Returns the number of buffers in use. */
+    size_t getNumBuffers() const noexcept       { return slots.size(); }
+
+    /** Returns the number of bytes allocated for the buffers. */
+    size_t getNumBytesAllocated() const noexcept
+    {
+        size_t total = 0;
+
+        for (auto& slot : slots)
+            total += (size_t) slot->audio.getNumChannels() * (size_t) slot->audio.getNumSamples() * sizeof (float)
+                       + (size_t) slot->midi.getCapacity() * sizeof (tracktion_engine::MidiMessageArray::MidiMessageWithSource);
+
+        return total;
+    }
+
+private:
+    struct Slot
+    {
+        juce::AudioBuffer<float> audio;
+        tracktion_engine::MidiMessageArray midi;
+    };
+
+    std::vector<std::unique_ptr<Slot>> slots;
+    std::vector<juce::HeapBlock<char>> domainBlocks;
+
+    /** Puts the channels of all the slots in each domain in one page-aligned block so the
+        pages can be moved without taking any other domain's buffers with them.
+    */
+    void allocateInDomains (const GraphPlan::BufferAssignment& assignment, int blockSize)
+    {
+        const auto& topology = NumaTopology::getSystemTopology();
+        constexpr size_t pageSize = 4096;
+        const auto channelSize = (size_t) (blockSize + 15) / 16 * 16;    // Keeps each channel 64-byte aligned
+        std::vector<float*> channels;
+
+        for (int domain = -1; domain < (int) topology.nodes.size(); ++domain)
+        {
+            size_t numFloats = 0;
+
+            for (size_t i = 0; i < assignment.getNumSlots(); ++i)
+                if (assignment.domainForSlot[i] == domain)
+                    numFloats += (size_t) assignment.numChannelsForSlot[i] * channelSize;
+
+            if (numFloats == 0)
+                continue;
+
+            domainBlocks.emplace_back (numFloats * sizeof (float) + pageSize, true);
+            auto data = reinterpret_cast<float*> (((uintptr_t) domainBlocks.back().get() + pageSize - 1) & ~(uintptr_t) (pageSize - 1));
+
+            // Shared slots stay wherever they're first touched
+            if (domain >= 0)
+                topology.moveMemoryToNode (data, numFloats * sizeof (float), (size_t) domain);
+
+            for (size_t i = 0; i < assignment.getNumSlots(); ++i)
+            {
+                if (assignment.domainForSlot[i] != domain)
+                    continue;
+
+                const auto numChannels = assignment.numChannelsForSlot[i];
+                channels.clear();
+
+                for (int c = 0; c < numChannels; ++c)
+                {
+                    channels.push_back (data);
+                    data += channelSize;
+                }
+
+                slots[i]->audio.setDataToReferTo (channels.data(), numChannels, blockSize);
+            }
+        }
+    }
+};
+
+}
@@ -11,109 +11,521 @@
 #pragma once
 
 #include <thread>
-#include <emmintrin.h>
+#include <mutex>
+#include <condition_variable>
 
 namespace tracktion_graph
 {
 
 /**
     Plays back a node with mutiple threads.
+
+    This uses a dependency counted, work-stealing scheduler. Each Node has a
+    counter of the number of inputs still to be processed and a Node is only
+    queued for processing once all of its inputs have been processed.
+    Each thread has its own queue of ready Nodes which it processes in LIFO order
+    (to keep recently produced buffers hot in the cache). When a thread runs out
+    of work it steals Nodes from the opposite end of the other threads' queues.
+
+    When a Node makes other Nodes ready, the thread processing it carries straight
+    on with one of them rather than queueing it. This means chains of Nodes are
+    processed serially as a single task with no scheduling overhead. Each Node's
+    ProcessingCost determines which Node is carried on with: cheap ones are
+    preferred whilst expensive ones are always queued so idle threads can steal them.
+
+    When there is no work available, worker threads will spin for a while, then
+    yield and finally park until the next block is processed. How long each of
+    these stages lasts is determined by the WaitPolicy.
+
+    New Nodes can be set whilst the player is running. These are prepared on the
+    calling thread and swapped in at the start of the next block without stopping
+    the worker threads.
 */
 class MultiThreadedNodePlayer
 {
 public:
-    MultiThreadedNodePlayer (std::unique_ptr<Node> node)
-        : rootNode (std::move (node))
+    //==============================================================================
+    /** Determines how worker threads wait when they have no Nodes to process. */
+    struct WaitPolicy
+    {
+        int numSpinsBeforeYielding = 2000;   /**< The number of times to pause before yielding. */
+        int numYieldsBeforeParking = 200;    /**< The number of times to yield before parking, -1 never parks. */
+
+        /** Threads spin or yield and never park.
+            This gives the lowest latency when work becomes available but uses all the CPU cores all the time.
+        */
+        static WaitPolicy lowLatency()      { return { 20000, -1 }; }
+
+        /** Threads spin and yield for a short while and then park. */
+        static WaitPolicy balanced()        { return { 2000, 200 }; }
+
+        /** Threads park almost immediately, this uses the least CPU but will take longer to wake up. */
+        static WaitPolicy powerSaving()     { return { 100, 10 }; }
+    };
+
+    //==============================================================================
+    MultiThreadedNodePlayer (std::unique_ptr<Node> node, WaitPolicy waitPolicyToUse = WaitPolicy::balanced())
+        : currentGraph (std::make_unique<PreparedGraph>()), waitPolicy (waitPolicyToUse)
     {
+        currentGraph->rootNode = std::move (node);
+        latestGraph = currentGraph.get();
     }
     
     ~MultiThreadedNodePlayer()
     {
         clearThreads();
+        freeRetiredGraph();
+        std::unique_ptr<PreparedGraph> unusedGraph (pendingGraph.exchange (nullptr));
     }
     
+    /** Returns the most recently set Node.
+        This may not have been swapped in to the audio thread yet.
+    */
     Node& getNode()
     {
-        return *rootNode;
+        return *latestGraph->rootNode;
+    }
+
+    /** Returns the number of bytes allocated for the audio and MIDI buffers of the most
+        recently prepared Nodes. Call this from the same thread that sets the Nodes.
+    */
+    size_t getNumBytesAllocated() const noexcept
+    {
+        auto total = latestGraph->sharedBuffers.getNumBytesAllocated();
+
+        for (auto node : latestGraph->plan.nodes)
+            total += node->getNumBytesAllocated();
+
+        return total;
+    }
+
+    /** Sets the WaitPolicy to use.
+        If the player is already prepared, this will restart the threads.
+    */
+    void setWaitPolicy (WaitPolicy newPolicy)
+    {
+        const bool wasRunning = ! threads.empty();
+        clearThreads();
+        waitPolicy = newPolicy;
+
+        if (wasRunning)
+            createThreads (readyQueues.size() - 1);
     }
     
-    void setNode (std::unique_ptr<Node> newNode)
+   #if TRACKTION_GRAPH_PROFILING
+    /** Returns the profiler recording the time Nodes take to process. */
+    NodeProfiler& getProfiler()
     {
+        return profiler;
+    }
+   #endif
+
+    /** Sets the maximum number of threads to use, including the thread calling process.
+        The number of threads will also be limited by the number of CPUs and the maximum
+        number of Nodes that can be processed concurrently. 0 means no limit.
+        This takes effect the next time prepareToPlay is called.
+    */
+    void setMaxNumThreads (size_t newMaxNumThreads)
+    {
+        maxNumThreads = newMaxNumThreads;
+    }
+
+    /** Sets a mask of the CPUs to pin the worker threads to.
+        Each worker thread is pinned to one of the CPUs in the mask, in turn. The thread
+        calling process isn't pinned as it is owned by the caller. 0 means don't pin the threads.
+        If the player is already prepared, this will restart the threads.
+    */
+    void setThreadAffinityMask (juce::uint32 newAffinityMask)
+    {
+        const bool wasRunning = ! threads.empty();
         clearThreads();
+        affinityMask = newAffinityMask;
 
-        auto oldNode = std::move (rootNode);
-        rootNode = std::move (newNode);
-        prepareToPlay (sampleRate, blockSize, oldNode.get());
+        if (wasRunning)
+            createThreads (readyQueues.size() - 1);
+    }
+
+    /** Enables NUMA aware scheduling for machines with more than one socket.
+        When this is on, the graph is split in to independent sub-graphs which are spread
+        across the NUMA nodes. Each sub-graph's buffers are allocated in its node's memory,
+        its leaf Nodes are queued on threads running on that node and idle threads steal
+        from threads on the same node first. If no thread affinity mask is set, the worker
+        threads are pinned to their nodes' CPUs.
+        This does nothing on machines with a single NUMA node and takes effect the next
+        time prepareToPlay is called.
+        @see NumaTopology
+    */
+    void setNumaAware (bool shouldBeNumaAware)
+    {
+        numaAware = shouldBeNumaAware;
+    }
+
+    /** Sets the precision the Nodes should process in, if they support it.
+        This takes effect the next time a Node is prepared, i.e. by setNode or prepareToPlay.
+        @see Node::supportsDoublePrecision
+    */
+    void setProcessingPrecision (ProcessingPrecision newPrecision)
+    {
+        precision = newPrecision;
+    }
+
+    /** Sets a new Node to be processed.
+        If the player has been prepared, the new Node is prepared on the calling thread,
+        inheriting any state from the previous Node, and is then swapped in at the start
+        of the next call to process. The worker threads keep running throughout.
+        The previous Node is never deleted on the audio thread, it will be deleted by the
+        next call to setNode or prepareToPlay, or when the player is destroyed.
+
+        Note that this means Nodes may be prepared whilst the Node they are inheriting
+        state from is still being processed.
+    */
+    void setNode (std::unique_ptr<Node> newNode)
+    {
+        freeRetiredGraph();
+
+        if (readyQueues.empty())
+        {
+            // Not prepared yet so there's nothing to swap with
+            auto oldGraph = std::move (currentGraph);
+            currentGraph = std::make_unique<PreparedGraph>();
+            currentGraph->rootNode = std::move (newNode);
+            latestGraph = currentGraph.get();
+            prepareToPlay (sampleRate, blockSize, oldGraph->rootNode.get());
+            return;
+        }
+
+        auto newGraph = prepareGraph (std::move (newNode), latestGraph->rootNode.get());
+        allocateQueueStorage (*newGraph, readyQueues.size());
+        latestGraph = newGraph.get();
+
+        // If the previous pending graph hasn't been swapped in yet, it never will be so can be deleted here
+        std::unique_ptr<PreparedGraph> unusedGraph (pendingGraph.exchange (newGraph.release()));
     }
 
     void prepareToPlay (double sampleRateToUse, int blockSizeToUse, Node* oldNode = nullptr)
     {
+        clearThreads();
+        freeRetiredGraph();
+
+        // Any graph waiting to be swapped in supersedes the current one
+        if (auto newGraph = pendingGraph.exchange (nullptr))
+            currentGraph.reset (newGraph);
+
         sampleRate = sampleRateToUse;
         blockSize = blockSizeToUse;
-        
-        // First give the Nodes a chance to transform
-        transformNodes (*rootNode);
-        
-        // First, initiliase all the nodes, this will call prepareToPlay on them and also
-        // give them a chance to do things like balance latency
-        const PlaybackInitialisationInfo info { sampleRate, blockSize, *rootNode, oldNode };
-        visitNodes (*rootNode, [&] (Node& n) { n.initialise (info); }, false);
-        
-        // Then find all the nodes as it might have changed after initialisation
-        allNodes = tracktion_graph::getNodes (*rootNode, tracktion_graph::VertexOrdering::postordering);
+        numDomains = numaAware ? NumaTopology::getSystemTopology().getNumNodes() : 1;
+
+        auto previousGraph = std::move (currentGraph);
+        currentGraph = prepareGraph (std::move (previousGraph->rootNode), oldNode);
+        latestGraph = currentGraph.get();
 
-        createThreads();
+        // There's no point in using more threads than the maximum number of Nodes that can be processed concurrently
+        size_t numThreadsToUse = std::min (currentGraph->plan.getMaxLevelWidth(), (size_t) std::thread::hardware_concurrency());
+
+        if (maxNumThreads > 0)
+            numThreadsToUse = std::min (numThreadsToUse, maxNumThreads);
+
+        numThreadsToUse = numThreadsToUse > 0 ? numThreadsToUse - 1 : 0;
+
+        // One queue for each worker thread plus one for the thread calling process
+        readyQueues.clear();
+
+        for (size_t i = 0; i < numThreadsToUse + 1; ++i)
+            readyQueues.push_back (std::make_unique<ReadyQueue>());
+
+        allocateQueueStorage (*currentGraph, readyQueues.size());
+        setQueueStorage (*currentGraph);
+        createQueueDomains();
+
+        createThreads (numThreadsToUse);
     }
 
     int process (const Node::ProcessContext& pc)
     {
-        // Reset the stream range
-        streamSampleRange = pc.streamSampleRange;
-        
-        // Prepare all the nodes to be played back
-        for (auto node : allNodes)
-            node->prepareForNextBlock();
+        // Swap in any new graph. The old one can't be deleted here so is retired to be
+        // deleted later, if the last retired graph hasn't been deleted yet, wait for the next block
+        if (retiredGraph.load() == nullptr)
+            if (auto newGraph = pendingGraph.exchange (nullptr))
+                swapToGraph (newGraph);
 
-        // Then set the vector to be processed
-        // Threads are always running so will process as soon numNodesLeftToProcess is non-zero
-        numNodesLeftToProcess = allNodes.size();
-        
-        // Try to process Nodes until they're all processed
-        for (;;)
-        {
-            if (! processNextFreeNode())
-                break;
-        }
-        
-        // Wait for any threads to finish processing
-        while (! rootNode->hasProcessed())
-            pause();
+        auto& graph = *currentGraph;
 
-        auto output = rootNode->getProcessedOutput();
-        pc.buffers.audio.copyFrom (output.audio);
-        pc.buffers.midi.copyFrom (output.midi);
-        
-        return -1;
+        return graph.subBlockSplitter.process (pc, [this, &graph] (const Node::ProcessContext& subBlock)
+                                               {
+                                                   return processBlock (graph, subBlock);
+                                               });
     }
     
 private:
     //==============================================================================
-    std::unique_ptr<Node> rootNode;
+    /** Holds a Node and the information about its connections needed to schedule it. */
+    struct PlaybackNode
+    {
+        Node* node = nullptr;
+        GraphPlan::IndexRange outputs;
+        size_t numInputs = 0;
+        Node::ProcessingCost cost = Node::ProcessingCost::normal;
+        std::atomic<size_t> numInputsToBeProcessed { 0 };
+
+       #if TRACKTION_GRAPH_PROFILING
+        const char* nodeName = nullptr;
+        size_t nodeID = 0;
+        juce::int64 readyTicks = 0;
+       #endif
+    };
+
+    //==============================================================================
+    /**
+        A fixed capacity double-ended queue of Node indices.
+        The owning thread pushes and pops from the back whilst other threads steal
+        from the front. Each Node is only queued once per block so a capacity of the
+        total number of Nodes means this never needs to allocate during processing.
+        The storage is owned by the PreparedGraph so it can be swapped along with it.
+    */
+    class ReadyQueue
+    {
+    public:
+        ReadyQueue() = default;
+
+        /** Sets the storage to use, this must only be called when the queue is empty. */
+        void setStorage (std::vector<size_t>& storageToUse)
+        {
+            const juce::SpinLock::ScopedLockType sl (lock);
+            jassert (numQueued == 0);
+            jassert (! storageToUse.empty());
+            indices = &storageToUse;
+            head = 0;
+        }
+
+        void push (size_t nodeIndex)
+        {
+            const juce::SpinLock::ScopedLockType sl (lock);
+            auto& storage = *indices;
+            jassert (numQueued < storage.size());
+            storage[(head + numQueued) % storage.size()] = nodeIndex;
+            ++numQueued;
+        }
+
+        bool pop (size_t& nodeIndex)
+        {
+            const juce::SpinLock::ScopedLockType sl (lock);
+
+            if (numQueued == 0)
+                return false;
+
+            auto& storage = *indices;
+            --numQueued;
+            nodeIndex = storage[(head + numQueued) % storage.size()];
+            return true;
+        }
+
+        bool steal (size_t& nodeIndex)
+        {
+            const juce::SpinLock::ScopedLockType sl (lock);
+
+            if (numQueued == 0)
+                return false;
+
+            auto& storage = *indices;
+            nodeIndex = storage[head];
+            head = (head + 1) % storage.size();
+            --numQueued;
+            return true;
+        }
+
+    private:
+        juce::SpinLock lock;
+        std::vector<size_t>* indices = nullptr;
+        size_t head = 0, numQueued = 0;
+    };
+
+    //==============================================================================
+    /** Everything needed to process a Node graph, this is swapped as a whole when a new Node is set. */
+    struct PreparedGraph
+    {
+        std::unique_ptr<Node> rootNode;
+        GraphPlan plan;
+        SharedNodeBuffers sharedBuffers;
+        SubBlockSplitter subBlockSplitter;
+        std::vector<PlaybackNode> playbackNodes;
+        std::vector<std::vector<size_t>> queueStorage;
+        std::vector<int> domainForNode;
+    };
+
+    //==============================================================================
+    std::unique_ptr<PreparedGraph> currentGraph;
+    PreparedGraph* latestGraph = nullptr;
+    std::atomic<PreparedGraph*> pendingGraph { nullptr }, retiredGraph { nullptr };
+
     std::vector<std::thread> threads;
-    std::vector<Node*> allNodes;
+    std::vector<std::unique_ptr<ReadyQueue>> readyQueues;
     
     juce::Range<int64_t> streamSampleRange;
     std::atomic<bool> threadsShouldExit { false };
     std::atomic<size_t> numNodesLeftToProcess { 0 };
 
+    WaitPolicy waitPolicy;
+    size_t maxNumThreads = 0;
+    juce::uint32 affinityMask = 0;
+
+    bool numaAware = false;
+    size_t numDomains = 1;
+    std::vector<int> domainForQueue;
+    std::vector<std::vector<size_t>> queuesForDomain, stealOrder;
+    std::vector<size_t> nextQueueForDomain;
+
+   #if TRACKTION_GRAPH_PROFILING
+    NodeProfiler profiler;
+   #endif
+    std::mutex parkingMutex;
+    std::condition_variable parkingCondition;
+    std::atomic<uint32_t> wakeCount { 0 };
+    std::atomic<int> numParkedThreads { 0 };
+
     //==============================================================================
     double sampleRate = 44100.0;
     int blockSize = 512;
+    ProcessingPrecision precision = ProcessingPrecision::singlePrecision;
     
     //==============================================================================
+    /** Processes the whole graph once for a block or sub-block. */
+    int processBlock (PreparedGraph& graph, const Node::ProcessContext& pc)
+    {
+        // Reset the stream range
+        streamSampleRange = pc.streamSampleRange;
+        
+        // Prepare all the nodes to be played back
+       #if TRACKTION_GRAPH_PROFILING
+        const auto blockStartTicks = NodeProfiler::getCurrentTicks();
+       #endif
+
+        for (auto& playbackNode : graph.playbackNodes)
+        {
+            playbackNode.node->prepareForNextBlock();
+            playbackNode.numInputsToBeProcessed.store (playbackNode.numInputs, std::memory_order_relaxed);
+
+           #if TRACKTION_GRAPH_PROFILING
+            playbackNode.readyTicks = blockStartTicks;
+           #endif
+        }
+
+        // Set the number of nodes to process before any are queued so the count can't
+        // drop to zero before all of them have been processed
+        numNodesLeftToProcess = graph.playbackNodes.size();
+
+        // Then queue all the leaf nodes, spreading them across the threads, or the threads of
+        // the Node's domain. Threads are always running so will start processing as soon as the Nodes are queued
+        if (graph.plan.getNumLevels() > 0)
+        {
+            size_t queueIndex = 0;
+
+            for (auto leafIndex : graph.plan.getNodesOnLevel (0))
+            {
+                const auto domain = graph.domainForNode.empty() ? -1 : graph.domainForNode[leafIndex];
+
+                if (domain >= 0 && ! queuesForDomain[(size_t) domain].empty())
+                {
+                    auto& domainQueues = queuesForDomain[(size_t) domain];
+                    auto& next = nextQueueForDomain[(size_t) domain];
+                    readyQueues[domainQueues[next]]->push (leafIndex);
+                    next = (next + 1) % domainQueues.size();
+                    continue;
+                }
+
+                readyQueues[queueIndex]->push (leafIndex);
+                queueIndex = (queueIndex + 1) % readyQueues.size();
+            }
+        }
+
+        wakeParkedThreads();
+        
+        // Try to process Nodes until they're all processed
+        // The calling thread always uses the first queue
+        while (numNodesLeftToProcess > 0)
+            if (! processNextFreeNode (0))
+                pause();
+
+        copyProcessedOutput (graph.rootNode->getProcessedOutput(), pc.buffers);
+        
+        return -1;
+    }
+
+    //==============================================================================
+    std::unique_ptr<PreparedGraph> prepareGraph (std::unique_ptr<Node> node, Node* oldNode)
+    {
+        auto graph = std::make_unique<PreparedGraph>();
+        graph->rootNode = std::move (node);
+        auto& root = *graph->rootNode;
+
+        // First give the Nodes a chance to transform
+        transformNodes (root);
+        
+        // First, initiliase all the nodes, this will call prepareToPlay on them and also
+        // give them a chance to do things like balance latency
+        const PlaybackInitialisationInfo info { sampleRate, blockSize, root, oldNode, precision };
+        visitNodes (root, [&] (Node& n) { n.initialise (info); }, false);
+        
+        // Then build the plan as the topology might have changed after initialisation
+        auto& plan = graph->plan;
+        plan = GraphPlan (root);
+
+        if (numDomains > 1)
+            graph->domainForNode = plan.createNumaPartition (numDomains);
+
+        graph->sharedBuffers.assign (plan, plan.createBufferAssignment (false, graph->domainForNode), blockSize);
+        graph->subBlockSplitter.prepare (plan.nodes, sampleRate);
+
+        graph->playbackNodes = std::vector<PlaybackNode> (plan.size());
+
+        for (size_t i = 0; i < plan.size(); ++i)
+        {
+            auto& playbackNode = graph->playbackNodes[i];
+            playbackNode.node = &plan.getNode (i);
+            playbackNode.outputs = plan.getOutputs (i);
+            playbackNode.numInputs = plan.getInputs (i).size();
+            playbackNode.cost = playbackNode.node->getProcessingCost();
+
+           #if TRACKTION_GRAPH_PROFILING
+            playbackNode.nodeName = NodeProfiler::getNodeName (*playbackNode.node);
+            playbackNode.nodeID = playbackNode.node->getNodeProperties().nodeID;
+           #endif
+        }
+
+        return graph;
+    }
+
+    static void allocateQueueStorage (PreparedGraph& graph, size_t numQueues)
+    {
+        graph.queueStorage.assign (numQueues, std::vector<size_t> (std::max ((size_t) 1, graph.playbackNodes.size())));
+    }
+
+    void setQueueStorage (PreparedGraph& graph)
+    {
+        jassert (graph.queueStorage.size() == readyQueues.size());
+
+        for (size_t i = 0; i < readyQueues.size(); ++i)
+            readyQueues[i]->setStorage (graph.queueStorage[i]);
+    }
+
+    /** Called on the audio thread at the start of a block, before any Nodes are queued. */
+    void swapToGraph (PreparedGraph* newGraph)
+    {
+        // The queues are all empty at this point and the worker threads only access
+        // the current graph after popping a Node from a queue so it's safe to swap here
+        setQueueStorage (*newGraph);
+        retiredGraph.store (currentGraph.release());
+        currentGraph.reset (newGraph);
+    }
+
+    void freeRetiredGraph()
+    {
+        std::unique_ptr<PreparedGraph> graphToDelete (retiredGraph.exchange (nullptr));
+    }
+
     void clearThreads()
     {
         threadsShouldExit = true;
+        wakeParkedThreads();
 
         for (auto& t : threads)
             t.join();
@@ -121,71 +533,236 @@ private:
         threads.clear();
     }
     
-    void createThreads()
+    void createThreads (size_t numThreadsToUse)
     {
-        size_t numThreadsToUse = 0;
-        
-        for (auto node : allNodes)
-            if (node->isReadyToProcess())
-                ++numThreadsToUse;
-        
-        numThreadsToUse = std::min (numThreadsToUse, (size_t) std::thread::hardware_concurrency()) - 1;
-             
+        jassert (numThreadsToUse + 1 == readyQueues.size());
+        threadsShouldExit = false;
+
         for (size_t i = 0; i < numThreadsToUse; ++i)
-            threads.emplace_back ([this] { processNextFreeNodeOrWait(); });
+        {
+            threads.emplace_back ([this, i, cpuMask = getAffinityMaskForThread (i)]
+                                  {
+                                      if (cpuMask != 0)
+                                          juce::Thread::setCurrentThreadAffinityMask (cpuMask);
+                                      else if (numDomains > 1)
+                                          NumaTopology::getSystemTopology().setCurrentThreadAffinity ((size_t) domainForQueue[i + 1]);
+
+                                      processNextFreeNodeOrWait (i + 1);
+                                  });
+        }
     }
-    
-    inline void pause()
+
+    /** Works out which domain each queue's thread is in and the order they should steal in.
+        The thread calling process isn't in any domain, the worker threads are spread across them.
+    */
+    void createQueueDomains()
     {
-        _mm_pause();
-        _mm_pause();
-        _mm_pause();
-        _mm_pause();
-        _mm_pause();
-        _mm_pause();
-        _mm_pause();
-        _mm_pause();
+        const auto numQueues = readyQueues.size();
+        domainForQueue.assign (numQueues, -1);
+        queuesForDomain.assign (numDomains, {});
+        nextQueueForDomain.assign (numDomains, 0);
+        stealOrder.assign (numQueues, {});
+
+        for (size_t i = 1; i < numQueues; ++i)
+        {
+            domainForQueue[i] = numDomains > 1 ? (int) ((i - 1) % numDomains) : -1;
+
+            if (domainForQueue[i] >= 0)
+                queuesForDomain[(size_t) domainForQueue[i]].push_back (i);
+        }
+
+        // Steal from the threads in the same domain first, then in turn from the next queue on
+        for (size_t i = 0; i < numQueues; ++i)
+        {
+            for (int pass = 0; pass < 2; ++pass)
+            {
+                for (size_t j = 1; j < numQueues; ++j)
+                {
+                    const auto other = (i + j) % numQueues;
+                    const bool isSameDomain = domainForQueue[i] >= 0 && domainForQueue[other] == domainForQueue[i];
+
+                    if (isSameDomain == (pass == 0))
+                        stealOrder[i].push_back (other);
+                }
+            }
+        }
     }
 
+    /** Returns the mask with only the CPU a given worker thread should be pinned to set. */
+    juce::uint32 getAffinityMaskForThread (size_t threadIndex) const
+    {
+        const int numCPUs = juce::countNumberOfBits (affinityMask);
+
+        if (numCPUs == 0)
+            return 0;
+
+        auto cpuIndex = (int) (threadIndex % (size_t) numCPUs);
+
+        for (int bit = 0; bit < 32; ++bit)
+            if ((affinityMask & (1u << bit)) != 0 && cpuIndex-- == 0)
+                return 1u << bit;
+
+        return 0;
+    }
+    
     //==============================================================================
-    void processNextFreeNodeOrWait()
+    void processNextFreeNodeOrWait (size_t queueIndex)
     {
+        int numTimesWaited = 0;
+
         for (;;)
         {
             if (threadsShouldExit)
                 return;
             
-            if (! processNextFreeNode())
-                pause();
+            if (processNextFreeNode (queueIndex))
+                numTimesWaited = 0;
+            else
+                waitForWork (numTimesWaited++);
         }
     }
 
-    bool processNextFreeNode()
+    /** Spins, yields or parks the calling thread depending on how many times it's been called in a row. */
+    void waitForWork (int numTimesWaited)
     {
-        size_t expectedNumNodesLeft = numNodesLeftToProcess;
-        
-        if (expectedNumNodesLeft == 0)
-            return false;
+        if (numTimesWaited < waitPolicy.numSpinsBeforeYielding)
+        {
+            pause();
+            return;
+        }
 
-        const size_t nodeToReserve = expectedNumNodesLeft - 1;
+        const int numYields = numTimesWaited - waitPolicy.numSpinsBeforeYielding;
 
-        if (numNodesLeftToProcess.compare_exchange_strong (expectedNumNodesLeft, nodeToReserve))
+        if (waitPolicy.numYieldsBeforeParking < 0 || numYields < waitPolicy.numYieldsBeforeParking)
         {
-            const size_t nodeIndex = allNodes.size() - nodeToReserve - 1;
-            auto node = allNodes[nodeIndex];
+            std::this_thread::yield();
+            return;
+        }
 
-            // Wait until this node is actually ready to be processed
-            // It might be waiting for other Nodes
-            while (! node->isReadyToProcess())
-                pause();
-            
-            node->process (streamSampleRange);
-            
-            return true;
+        // Park until the next wake, checking the wake count after registering as parked
+        // means a wake from process() can't be missed
+        const auto wakeCountBeforeParking = wakeCount.load();
+        ++numParkedThreads;
+
+        {
+            std::unique_lock<std::mutex> lock (parkingMutex);
+            parkingCondition.wait (lock, [this, wakeCountBeforeParking]
+                                         {
+                                             return wakeCount.load() != wakeCountBeforeParking
+                                                || threadsShouldExit;
+                                         });
         }
-        
+
+        --numParkedThreads;
+    }
+
+    /** Wakes any parked threads. This is lock-free if no threads are parked. */
+    void wakeParkedThreads()
+    {
+        ++wakeCount;
+
+        if (numParkedThreads.load() > 0)
+        {
+            std::lock_guard<std::mutex> lock (parkingMutex);
+            parkingCondition.notify_all();
+        }
+    }
+
+    bool processNextFreeNode (size_t queueIndex)
+    {
+        size_t nodeIndex = 0;
+
+        if (! getNextReadyNode (queueIndex, nodeIndex))
+            return false;
+
+        processNode (queueIndex, nodeIndex);
+
+        return true;
+    }
+
+    bool getNextReadyNode (size_t queueIndex, size_t& nodeIndex)
+    {
+        if (readyQueues[queueIndex]->pop (nodeIndex))
+            return true;
+
+        // Nothing queued on this thread so try and steal from the others
+        for (auto otherQueueIndex : stealOrder[queueIndex])
+            if (readyQueues[otherQueueIndex]->steal (nodeIndex))
+                return true;
+
         return false;
     }
+
+    void processNode (size_t queueIndex, size_t nodeIndex)
+    {
+        auto& playbackNodes = currentGraph->playbackNodes;
+        constexpr auto noNode = std::numeric_limits<size_t>::max();
+
+        for (;;)
+        {
+            auto& playbackNode = playbackNodes[nodeIndex];
+            jassert (playbackNode.node->isReadyToProcess());
+
+           #if TRACKTION_GRAPH_PROFILING
+            const auto startTicks = NodeProfiler::getCurrentTicks();
+           #endif
+
+            playbackNode.node->process (streamSampleRange);
+
+           #if TRACKTION_GRAPH_PROFILING
+            const auto endTicks = NodeProfiler::getCurrentTicks();
+            profiler.addEvent ({ playbackNode.nodeName, playbackNode.nodeID, queueIndex,
+                                 playbackNode.readyTicks, startTicks, endTicks });
+           #endif
+
+            // Carry on with one of the outputs that are now ready on this thread as its inputs
+            // will be hot in the cache, preferably a cheap one. Queue the others, expensive ones
+            // are always queued so they can be stolen by idle threads
+            size_t nextNodeIndex = noNode;
+            size_t numNodesQueued = 0;
+
+            for (auto outputIndex : playbackNode.outputs)
+            {
+                auto& output = playbackNodes[outputIndex];
+
+                if (output.numInputsToBeProcessed.fetch_sub (1, std::memory_order_acq_rel) != 1)
+                    continue;
+
+               #if TRACKTION_GRAPH_PROFILING
+                output.readyTicks = endTicks;
+               #endif
+
+                if (output.cost != Node::ProcessingCost::expensive)
+                {
+                    if (nextNodeIndex == noNode)
+                    {
+                        nextNodeIndex = outputIndex;
+                        continue;
+                    }
+
+                    if (output.cost == Node::ProcessingCost::cheap
+                        && playbackNodes[nextNodeIndex].cost != Node::ProcessingCost::cheap)
+                        std::swap (outputIndex, nextNodeIndex);
+                }
+
+                readyQueues[queueIndex]->push (outputIndex);
+                ++numNodesQueued;
+            }
+
+            // If there's more work than this thread can do, wake any others to steal it
+            if (numNodesQueued > (nextNodeIndex == noNode ? 1u : 0u))
+                wakeParkedThreads();
+
+            // This must be decremented last so that process can't return whilst
+            // this thread is still updating the counters of the outputs
+            --numNodesLeftToProcess;
+
+            if (nextNodeIndex == noNode)
+                return;
+
+            nodeIndex = nextNodeIndex;
+        }
+    }
 };
 
 }
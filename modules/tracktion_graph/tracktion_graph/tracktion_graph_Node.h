@@ -10,6 +10,8 @@
 
 #pragma once
 
+#include <unordered_set>
+
 //==============================================================================
 //==============================================================================
 /**
@@ -75,6 +77,13 @@ namespace tracktion_graph
 
 class Node;
 
+/** The precision a graph is processed in. */
+enum class ProcessingPrecision
+{
+    singlePrecision,    /**< Every Node processes floats. This is the default and what should be used for real-time playback. */
+    doublePrecision     /**< Nodes that support it process doubles, e.g. for rendering. */
+};
+
 //==============================================================================
 /** Passed into Nodes when they are being initialised, to give them useful
     contextual information that they may need
@@ -85,6 +94,7 @@ struct PlaybackInitialisationInfo
     int blockSize;
     Node& rootNode;
     Node* rootNodeToReplace = nullptr;
+    ProcessingPrecision precision = ProcessingPrecision::singlePrecision;
 };
 
 /** Holds some really basic properties of a node */
@@ -134,11 +144,16 @@ public:
     /** Returns true if this node has processed and its outputs can be retrieved. */
     bool hasProcessed() const;
     
-    /** Contains the buffers for a processing operation. */
+    /** Contains the buffers for a processing operation.
+        When a Node is processing in double precision, audio64 holds its audio and the
+        float audio is filled in from it once the Node has processed. Otherwise audio64
+        has no channels.
+    */
     struct AudioAndMidiBuffer
     {
         juce::dsp::AudioBlock<float> audio;
         tracktion_engine::MidiMessageArray& midi;
+        juce::dsp::AudioBlock<double> audio64 = {};
     };
 
     /** Returns the processed audio and MIDI output.
@@ -146,6 +161,35 @@ public:
     */
     AudioAndMidiBuffer getProcessedOutput();
 
+    /** Sets the buffers this Node should process in to instead of the ones it owns.
+        This is used by players to share buffers between Nodes whose outputs are
+        never needed at the same time. The audio block must have at least as many
+        channels as this Node's NodeProperties and enough samples for the block size
+        it was initialised with. Both must outlive any processing of this Node.
+        Call initialise again to go back to using the Node's own buffers.
+
+        @param isSharedWithInput If true, the buffers are the ones the Node's sole input
+                                 processes in to so won't be cleared before this Node is
+                                 processed. Only use this if canProcessInPlace returns true.
+    */
+    void setSharedBuffers (juce::dsp::AudioBlock<float> audioToUse, tracktion_engine::MidiMessageArray& midiToUse,
+                           bool isSharedWithInput = false);
+
+    /** Returns true if this Node has been set to process in-place on its input's buffers.
+        @see canProcessInPlace
+    */
+    bool isProcessingInPlace() const noexcept       { return processesInPlace; }
+
+    /** Returns true if this Node has been initialised to process in double precision.
+        @see supportsDoublePrecision
+    */
+    bool isProcessingInDoublePrecision() const noexcept     { return usesDoublePrecision; }
+
+    /** Returns the number of bytes allocated for this Node's own audio and MIDI buffers.
+        This doesn't include any shared buffers it's been given or anything its subclass allocates.
+    */
+    size_t getNumBytesAllocated() const noexcept;
+
     //==============================================================================
     /** Called after construction to give the node a chance to modify its topology.
         This should return true if any changes were made to the topology as this
@@ -166,6 +210,54 @@ public:
         This is usually when its input's output buffers are ready.
     */
     virtual bool isReadyToProcess() = 0;
+
+    /** Should return true if this Node can process in-place on its input's buffers.
+        This only applies to Nodes with a single input and the same number of channels.
+        If the Node is its input's only consumer, the player may then give it the same
+        buffers as the input to avoid a copy. In this case the ProcessContext buffers
+        will contain the input's output rather than being cleared so the Node must be
+        able to handle them aliasing the input's getProcessedOutput().
+        @see isProcessingInPlace
+    */
+    virtual bool canProcessInPlace() { return false; }
+
+    /** Should return true if this Node can process in double precision.
+        If it does and the graph is initialised with ProcessingPrecision::doublePrecision,
+        the Node should write its audio to the ProcessContext's audio64 block and read
+        its inputs' audio64 blocks where they have them.
+        This is called when the Node is initialised, after its inputs have been, so it
+        can depend on whether they are processing in double precision. Nodes processing
+        in double precision are never processed in-place.
+    */
+    virtual bool supportsDoublePrecision() { return false; }
+
+    /** Describes roughly how expensive a Node is to process. */
+    enum class ProcessingCost
+    {
+        cheap,      /**< Trivial Nodes that should be processed inline by whichever thread made them ready. */
+        normal,     /**< The default. */
+        expensive   /**< Nodes that should be made available to other threads as soon as they are ready. */
+    };
+
+    /** Should return how expensive this Node is to process.
+        Multi-threaded players use this to decide how to schedule Nodes.
+    */
+    virtual ProcessingCost getProcessingCost() { return ProcessingCost::normal; }
+
+    /** Should return true if this Node may want blocks to be split in to sub-blocks.
+        This is called when the graph is prepared. If it returns true, addSubBlockBoundaries
+        will be called before each block is processed.
+    */
+    virtual bool needsSubBlockBoundaries() { return false; }
+
+    /** Should add any stream sample positions inside streamSampleRange that the block
+        should be split at e.g. automation breakpoints, loop ends or tempo changes.
+        The player will then process the whole graph once for each sub-block so every
+        Node sees the same ranges. Positions outside the range are ignored.
+        This is called on the audio thread so shouldn't allocate.
+    */
+    virtual void addSubBlockBoundaries (juce::Range<int64_t> /*streamSampleRange*/,
+                                        std::vector<int64_t>& /*boundaries*/) {}
     
     /** Struct to describe a single iteration of a process call. */
     struct ProcessContext
@@ -190,8 +282,13 @@ protected:
 
 private:
     std::atomic<bool> hasBeenProcessed { false };
+    bool processesInPlace = false, usesDoublePrecision = false;
     juce::AudioBuffer<float> audioBuffer;
+    juce::AudioBuffer<double> audioBuffer64;
     tracktion_engine::MidiMessageArray midiBuffer;
+    juce::dsp::AudioBlock<float> audioView;
+    juce::dsp::AudioBlock<double> audioView64;
+    tracktion_engine::MidiMessageArray* midiView = &midiBuffer;
     int numSamplesProcessed = 0;
 };
 
@@ -250,10 +347,33 @@ static inline void transformNodes (Node& rootNode)
 //==============================================================================
 inline void Node::initialise (const PlaybackInitialisationInfo& info)
 {
+    // This is set first so prepareToPlay can allocate for the right precision
+    usesDoublePrecision = info.precision == ProcessingPrecision::doublePrecision && supportsDoublePrecision();
     prepareToPlay (info);
     
     auto props = getNodeProperties();
     audioBuffer.setSize (props.numberOfChannels, info.blockSize);
+    audioView = juce::dsp::AudioBlock<float> (audioBuffer);
+
+    if (usesDoublePrecision)
+        audioBuffer64.setSize (props.numberOfChannels, info.blockSize);
+    else
+        audioBuffer64.setSize (0, 0);
+
+    audioView64 = juce::dsp::AudioBlock<double> (audioBuffer64);
+    midiView = &midiBuffer;
+    processesInPlace = false;
+
+    // Reserve MIDI storage up front so the audio thread doesn't allocate for typical streams
+    if (props.hasMidi)
+        midiBuffer.reserve (tracktion_engine::MidiMessageArray::defaultNumMessagesToReserve);
+}
+
+inline size_t Node::getNumBytesAllocated() const noexcept
+{
+    return (size_t) audioBuffer.getNumChannels() * (size_t) audioBuffer.getNumSamples() * sizeof (float)
+            + (size_t) audioBuffer64.getNumChannels() * (size_t) audioBuffer64.getNumSamples() * sizeof (double)
+            + (size_t) midiBuffer.getCapacity() * sizeof (tracktion_engine::MidiMessageArray::MidiMessageWithSource);
 }
 
 inline void Node::prepareForNextBlock()
@@ -263,27 +383,45 @@ inline void Node::prepareForNextBlock()
 
 inline void Node::process (juce::Range<int64_t> streamSampleRange)
 {
-    audioBuffer.clear();
-    midiBuffer.clear();
-    const int numChannelsBeforeProcessing = audioBuffer.getNumChannels();
-    const int numSamplesBeforeProcessing = audioBuffer.getNumSamples();
+    // In-place Nodes share their input's buffers so these will contain its output.
+    // The float audio of double precision Nodes is overwritten after processing so isn't cleared
+    if (! processesInPlace)
+    {
+        if (usesDoublePrecision)
+            audioView64.clear();
+        else
+            audioView.clear();
+
+        midiView->clear();
+    }
+
+    const auto numChannelsBeforeProcessing = audioView.getNumChannels();
+    const auto numSamplesBeforeProcessing = audioView.getNumSamples();
     juce::ignoreUnused (numChannelsBeforeProcessing, numSamplesBeforeProcessing);
 
     const int numSamples = (int) streamSampleRange.getLength();
     jassert (numSamples > 0); // This must be a valid number of samples to process
+    jassert (numSamples <= (int) numSamplesBeforeProcessing); // Blocks can be smaller but not larger than the initialised block size
     
-    auto inputBlock = numChannelsBeforeProcessing > 0 ? juce::dsp::AudioBlock<float> (audioBuffer).getSubBlock (0, (size_t) numSamples)
+    auto inputBlock = numChannelsBeforeProcessing > 0 ? audioView.getSubBlock (0, (size_t) numSamples)
                                                       : juce::dsp::AudioBlock<float>();
+    auto inputBlock64 = audioView64.getNumChannels() > 0 ? audioView64.getSubBlock (0, (size_t) numSamples)
+                                                         : juce::dsp::AudioBlock<double>();
     ProcessContext pc {
                         streamSampleRange,
-                        { inputBlock , midiBuffer }
+                        { inputBlock , *midiView, inputBlock64 }
                       };
     process (pc);
+
+    // Keep the float output up to date for any Nodes that only read that
+    if (usesDoublePrecision)
+        audio_summing::convert (inputBlock, inputBlock64);
+
     numSamplesProcessed = numSamples;
     hasBeenProcessed = true;
     
-    jassert (numChannelsBeforeProcessing == audioBuffer.getNumChannels());
-    jassert (numSamplesBeforeProcessing == audioBuffer.getNumSamples());
+    jassert (numChannelsBeforeProcessing == audioView.getNumChannels());
+    jassert (numSamplesBeforeProcessing == audioView.getNumSamples());
 }
 
 inline bool Node::hasProcessed() const
@@ -294,7 +432,50 @@ inline bool Node::hasProcessed() const
 inline Node::AudioAndMidiBuffer Node::getProcessedOutput()
 {
     jassert (hasProcessed());
-    return { juce::dsp::AudioBlock<float> (audioBuffer).getSubBlock (0, (size_t) numSamplesProcessed), midiBuffer };
+
+    if (audioView64.getNumChannels() > 0)
+        return { audioView.getSubBlock (0, (size_t) numSamplesProcessed), *midiView,
+                 audioView64.getSubBlock (0, (size_t) numSamplesProcessed) };
+
+    return { audioView.getSubBlock (0, (size_t) numSamplesProcessed), *midiView };
+}
+
+inline void Node::setSharedBuffers (juce::dsp::AudioBlock<float> audioToUse, tracktion_engine::MidiMessageArray& midiToUse,
+                                    bool isSharedWithInput)
+{
+    jassert (! isSharedWithInput || (canProcessInPlace() && ! usesDoublePrecision));
+
+    const auto numChannels = (size_t) getNodeProperties().numberOfChannels;
+    jassert (audioToUse.getNumChannels() >= numChannels);
+    jassert (audioToUse.getNumSamples() >= audioView.getNumSamples());
+
+    const auto numSamples = audioView.getNumSamples();
+    audioView = numChannels > 0 ? audioToUse.getSubsetChannelBlock (0, numChannels).getSubBlock (0, numSamples)
+                                : juce::dsp::AudioBlock<float> (static_cast<float* const*> (nullptr), 0, numSamples);
+    midiView = &midiToUse;
+    processesInPlace = isSharedWithInput;
+
+    // Free the Node's own storage as it won't be used any more
+    audioBuffer.setSize (0, 0);
+    midiBuffer = {};
+}
+
+/** Copies a Node's processed output in to the buffers passed to a player.
+    If the destination has an audio64 block, it's filled from the Node's double precision
+    output when it has one so none of the precision is lost.
+*/
+static inline void copyProcessedOutput (const Node::AudioAndMidiBuffer& source, const Node::AudioAndMidiBuffer& dest)
+{
+    dest.audio.copyFrom (source.audio);
+    dest.midi.copyFrom (source.midi);
+
+    if (dest.audio64.getNumChannels() == 0)
+        return;
+
+    if (source.audio64.getNumChannels() > 0)
+        dest.audio64.copyFrom (source.audio64);
+    else
+        audio_summing::convert (dest.audio64, source.audio);
 }
 
 
@@ -304,26 +485,25 @@ namespace detail
 {
     struct VisitNodesWithRecord
     {
+        /** Visits the nodes in the graph.
+            The visited set is used to check if a node has already been visited in
+            constant time and a node is added to this before its inputs are visited
+            so cycles in the graph won't cause infinite recursion.
+        */
         template<typename Visitor>
-        static void visit (std::vector<Node*>& visitedNodes, Node& visitingNode, Visitor&& visitor, bool preordering)
+        static void visit (std::unordered_set<Node*>& visitedNodes, Node& visitingNode, Visitor&& visitor, bool preordering)
         {
-            if (std::find (visitedNodes.begin(), visitedNodes.end(), &visitingNode) != visitedNodes.end())
+            if (! visitedNodes.insert (&visitingNode).second)
                 return;
             
             if (preordering)
-            {
-                visitedNodes.push_back (&visitingNode);
                 visitor (visitingNode);
-            }
 
             for (auto n : visitingNode.getDirectInputNodes())
                 visit  (visitedNodes, *n, visitor, preordering);
 
             if (! preordering)
-            {
-                visitedNodes.push_back (&visitingNode);
                 visitor (visitingNode);
-            }
         }
     };
 }
@@ -331,7 +511,7 @@ namespace detail
 template<typename Visitor>
 inline void visitNodes (Node& node, Visitor&& visitor, bool preordering)
 {
-    std::vector<Node*> visitedNodes;
+    std::unordered_set<Node*> visitedNodes;
     detail::VisitNodesWithRecord::visit (visitedNodes, node, visitor, preordering);
 }
 
@@ -341,7 +521,7 @@ inline std::vector<Node*> getNodes (Node& node, VertexOrdering vertexOrdering)
                     || vertexOrdering == VertexOrdering::reversePreordering;
     
     std::vector<Node*> visitedNodes;
-    detail::VisitNodesWithRecord::visit (visitedNodes, node, [](auto&){}, preordering);
+    visitNodes (node, [&] (Node& n) { visitedNodes.push_back (&n); }, preordering);
 
     if (vertexOrdering == VertexOrdering::reversePreordering
         || vertexOrdering == VertexOrdering::reversePostordering)
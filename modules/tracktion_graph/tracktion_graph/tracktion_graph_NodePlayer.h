@@ -10,10 +10,6 @@
 
 #pragma once
 
-#include <thread>
-#include <emmintrin.h>
-
-
 namespace tracktion_graph
 {
 
@@ -37,6 +33,17 @@ public:
         return *input;
     }
 
+    /** Returns the number of bytes allocated for the audio and MIDI buffers of the prepared Nodes. */
+    size_t getNumBytesAllocated() const noexcept
+    {
+        auto total = sharedBuffers.getNumBytesAllocated();
+
+        for (auto node : plan.nodes)
+            total += node->getNumBytesAllocated();
+
+        return total;
+    }
+
     void setNode (std::unique_ptr<Node> newNode)
     {
         auto oldNode = std::move (input);
@@ -44,6 +51,15 @@ public:
         prepareToPlay (sampleRate, blockSize, oldNode.get());
     }
     
+    /** Sets the precision the Nodes should process in, if they support it.
+        This takes effect the next time prepareToPlay is called.
+        @see Node::supportsDoublePrecision
+    */
+    void setProcessingPrecision (ProcessingPrecision newPrecision)
+    {
+        precision = newPrecision;
+    }
+
     /** Prepares the processor to be played. */
     void prepareToPlay (double sampleRateToUse, int blockSizeToUse, Node* oldNode = nullptr)
     {
@@ -55,31 +71,62 @@ public:
         
         // Next, initialise all the nodes, this will call prepareToPlay on them and also
         // give them a chance to do things like balance latency
-        const PlaybackInitialisationInfo info { sampleRate, blockSize, *input, oldNode };
+        const PlaybackInitialisationInfo info { sampleRate, blockSize, *input, oldNode, precision };
         visitNodes (*input, [&] (Node& n) { n.initialise (info); }, false);
         
-        // Then find all the nodes as it might have changed after initialisation
-        allNodes = tracktion_graph::getNodes (*input, tracktion_graph::VertexOrdering::postordering);
+        // Then build the plan as the topology might have changed after initialisation
+        plan = GraphPlan (*input);
+
+        // Nodes are always processed in plan order so buffers can be reused as soon as they've been read
+        sharedBuffers.assign (plan, plan.createBufferAssignment (true), blockSize);
+        subBlockSplitter.prepare (plan.nodes, sampleRate);
+
+       #if TRACKTION_GRAPH_PROFILING
+        profiledNodes.clear();
+
+        for (auto node : plan.nodes)
+            profiledNodes.push_back ({ NodeProfiler::getNodeName (*node), node->getNodeProperties().nodeID });
+       #endif
     }
 
     /** Processes a block of audio and MIDI data.
+        If the ProcessContext has an audio64 block, that's filled as well as the float audio.
         Returns the number of times a node was checked but unable to be processed.
     */
     int process (const Node::ProcessContext& pc)
     {
-        return processPostorderedNodes (*input, allNodes, pc);
+        return subBlockSplitter.process (pc, [this] (const Node::ProcessContext& subBlock)
+                                         {
+                                             return processPostorderedNodes (*input, plan.nodes, subBlock);
+                                         });
+    }
+
+   #if TRACKTION_GRAPH_PROFILING
+    /** Returns the profiler recording the time Nodes take to process. */
+    NodeProfiler& getProfiler()
+    {
+        return profiler;
     }
+   #endif
     
 private:
     std::unique_ptr<Node> input;
-    std::vector<Node*> allNodes;
+    GraphPlan plan;
+    SharedNodeBuffers sharedBuffers;
+    SubBlockSplitter subBlockSplitter;
     double sampleRate = 44100.0;
     int blockSize = 512;
+    ProcessingPrecision precision = ProcessingPrecision::singlePrecision;
+
+   #if TRACKTION_GRAPH_PROFILING
+    NodeProfiler profiler { 1 };
+    std::vector<std::pair<const char*, size_t>> profiledNodes;
+   #endif
 
     /** Processes a group of Nodes assuming a postordering VertexOrdering.
         If these conditions are met the Nodes should be processed in a single loop iteration.
     */
-    static int processPostorderedNodes (Node& rootNode, const std::vector<Node*>& allNodes, const Node::ProcessContext& pc)
+    int processPostorderedNodes (Node& rootNode, const std::vector<Node*>& allNodes, const Node::ProcessContext& pc)
     {
         for (auto node : allNodes)
             node->prepareForNextBlock();
@@ -89,12 +136,24 @@ private:
 
         for (;;)
         {
-            for (auto node : allNodes)
+            for (size_t i = 0; i < allNodes.size(); ++i)
             {
+                auto node = allNodes[i];
+
                 if (! node->hasProcessed() && node->isReadyToProcess())
                 {
+                   #if TRACKTION_GRAPH_PROFILING
+                    const auto startTicks = NodeProfiler::getCurrentTicks();
+                   #endif
+
                     node->process (pc.streamSampleRange);
                     ++numNodesProcessed;
+
+                   #if TRACKTION_GRAPH_PROFILING
+                    // Nodes are processed as soon as they're ready so there's no wait time
+                    profiler.addEvent ({ profiledNodes[i].first, profiledNodes[i].second, 0,
+                                         startTicks, startTicks, NodeProfiler::getCurrentTicks() });
+                   #endif
                 }
                 else
                 {
@@ -104,9 +163,7 @@ private:
 
             if (numNodesProcessed == allNodes.size())
             {
-                auto output = rootNode.getProcessedOutput();
-                pc.buffers.audio.copyFrom (output.audio);
-                pc.buffers.midi.copyFrom (output.midi);
+                copyProcessedOutput (rootNode.getProcessedOutput(), pc.buffers);
 
                 break;
             }
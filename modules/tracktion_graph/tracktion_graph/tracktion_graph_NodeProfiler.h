@@ -0,0 +1,225 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+#pragma once
+
+#include <typeinfo>
+#include <map>
+
+namespace tracktion_graph
+{
+
+//==============================================================================
+//==============================================================================
+/**
+    Records how long each Node takes to process and which thread processed it.
+
+    Players only record events when TRACKTION_GRAPH_PROFILING is enabled, otherwise
+    all the instrumentation compiles out.
+
+    Each processing thread has its own lock-free ring buffer so recording never blocks
+    and events can be read on the message thread whilst processing. If the events aren't
+    read quickly enough, new ones will be dropped.
+*/
+class NodeProfiler
+{
+public:
+    //==============================================================================
+    /** Describes a single Node being processed. Times are in high resolution ticks. */
+    struct Event
+    {
+        const char* nodeName = nullptr;     /**< The type name of the Node, this is always valid. */
+        size_t nodeID = 0;                  /**< The nodeID from the Node's NodeProperties. */
+        size_t threadIndex = 0;             /**< 0 is the thread calling process, the others are worker threads. */
+        juce::int64 readyTicks = 0;         /**< When the Node's inputs had all been processed. */
+        juce::int64 startTicks = 0;         /**< When the Node started processing. */
+        juce::int64 endTicks = 0;           /**< When the Node finished processing. */
+    };
+
+    //==============================================================================
+    /** Creates a profiler for a number of threads. */
+    NodeProfiler (size_t numThreads = std::thread::hardware_concurrency(), int numEventsPerThread = 8192)
+    {
+        for (size_t i = 0; i < std::max ((size_t) 1, numThreads); ++i)
+            rings.push_back (std::make_unique<Ring> (numEventsPerThread));
+    }
+
+    /** Returns the number of threads events can be recorded from. */
+    size_t getNumThreads() const noexcept       { return rings.size(); }
+
+    /** Returns the name to use for a Node in Events. */
+    static const char* getNodeName (Node& node)
+    {
+        return typeid (node).name();
+    }
+
+    /** Returns the current time in ticks. */
+    static juce::int64 getCurrentTicks() noexcept
+    {
+        return juce::Time::getHighResolutionTicks();
+    }
+
+    /** Records an Event. This is lock-free and won't allocate.
+        Only one thread can record events for a given threadIndex.
+    */
+    void addEvent (const Event& newEvent) noexcept
+    {
+        const auto threadIndex = newEvent.threadIndex;
+        jassert (threadIndex < rings.size());
+
+        if (threadIndex >= rings.size())
+            return;
+
+        auto& ring = *rings[threadIndex];
+        int start1, size1, start2, size2;
+        ring.fifo.prepareToWrite (1, start1, size1, start2, size2);
+
+        if (size1 == 0)
+        {
+            ring.numDropped.fetch_add (1, std::memory_order_relaxed);
+            return;
+        }
+
+        ring.events[(size_t) start1] = newEvent;
+        ring.fifo.finishedWrite (1);
+    }
+
+    /** Moves all the recorded events in to an array.
+        This should only be called from one thread, usually the message thread.
+        @returns the number of events that were dropped since the last call.
+    */
+    int readEvents (std::vector<Event>& destEvents)
+    {
+        int numDropped = 0;
+
+        for (auto& ring : rings)
+        {
+            int start1, size1, start2, size2;
+            ring->fifo.prepareToRead (ring->fifo.getNumReady(), start1, size1, start2, size2);
+
+            destEvents.insert (destEvents.end(), ring->events.begin() + start1, ring->events.begin() + start1 + size1);
+            destEvents.insert (destEvents.end(), ring->events.begin() + start2, ring->events.begin() + start2 + size2);
+
+            ring->fifo.finishedRead (size1 + size2);
+            numDropped += ring->numDropped.exchange (0, std::memory_order_relaxed);
+        }
+
+        return numDropped;
+    }
+
+    //==============================================================================
+    /** Accumulates statistics for each Node from a set of Events. */
+    struct Statistics
+    {
+        /** The number of histogram buckets, bucket n counts durations between 2^(n - 1) and 2^n microseconds. */
+        static constexpr int numHistogramBuckets = 16;
+
+        struct NodeStatistics
+        {
+            const char* nodeName = nullptr;
+            int numCalls = 0;
+            double totalProcessSeconds = 0.0, maxProcessSeconds = 0.0;
+            double totalWaitSeconds = 0.0, maxWaitSeconds = 0.0;
+            std::array<int, numHistogramBuckets> histogram {};
+            std::vector<int> numCallsPerThread;
+        };
+
+        /** Adds some events to the statistics. */
+        void addEvents (const std::vector<Event>& events)
+        {
+            const auto ticksPerSecond = (double) juce::Time::getHighResolutionTicksPerSecond();
+
+            for (auto& event : events)
+            {
+                auto& stats = nodes[event.nodeID];
+                stats.nodeName = event.nodeName;
+                ++stats.numCalls;
+
+                const double processSeconds = (event.endTicks - event.startTicks) / ticksPerSecond;
+                const double waitSeconds = std::max (0.0, (event.startTicks - event.readyTicks) / ticksPerSecond);
+                stats.totalProcessSeconds += processSeconds;
+                stats.maxProcessSeconds = std::max (stats.maxProcessSeconds, processSeconds);
+                stats.totalWaitSeconds += waitSeconds;
+                stats.maxWaitSeconds = std::max (stats.maxWaitSeconds, waitSeconds);
+
+                int bucket = 0;
+
+                for (double micros = processSeconds * 1.0e6; micros >= 1.0 && bucket < numHistogramBuckets - 1; micros /= 2.0)
+                    ++bucket;
+
+                ++stats.histogram[(size_t) bucket];
+
+                if (stats.numCallsPerThread.size() <= event.threadIndex)
+                    stats.numCallsPerThread.resize (event.threadIndex + 1, 0);
+
+                ++stats.numCallsPerThread[event.threadIndex];
+            }
+        }
+
+        /** The statistics for each nodeID. */
+        std::map<size_t, NodeStatistics> nodes;
+    };
+
+    //==============================================================================
+    /** Creates a Chrome trace event format JSON string from a set of events.
+        This can be opened in chrome://tracing or Perfetto.
+    */
+    static juce::String createChromeTraceJSON (const std::vector<Event>& events)
+    {
+        if (events.empty())
+            return "{\"traceEvents\":[]}";
+
+        auto firstTicks = events.front().startTicks;
+
+        for (auto& event : events)
+            firstTicks = std::min (firstTicks, event.startTicks);
+
+        const auto ticksPerMicrosecond = juce::Time::getHighResolutionTicksPerSecond() / 1.0e6;
+        juce::MemoryOutputStream json;
+        json << "{\"traceEvents\":[";
+
+        for (size_t i = 0; i < events.size(); ++i)
+        {
+            auto& event = events[i];
+
+            if (i > 0)
+                json << ",";
+
+            json << "{\"name\":" << juce::JSON::toString (juce::String (event.nodeName))
+                 << ",\"ph\":\"X\",\"pid\":0,\"tid\":" << (int) event.threadIndex
+                 << ",\"ts\":" << juce::String ((event.startTicks - firstTicks) / ticksPerMicrosecond, 3)
+                 << ",\"dur\":" << juce::String ((event.endTicks - event.startTicks) / ticksPerMicrosecond, 3)
+                 << ",\"args\":{\"nodeID\":\"" << juce::String::toHexString ((juce::int64) event.nodeID)
+                 << "\",\"wait_us\":" << juce::String (std::max ((juce::int64) 0, event.startTicks - event.readyTicks) / ticksPerMicrosecond, 3)
+                 << "}}";
+        }
+
+        json << "]}";
+
+        return json.toString();
+    }
+
+private:
+    struct Ring
+    {
+        Ring (int numEvents)
+            : fifo (numEvents), events ((size_t) numEvents)
+        {
+        }
+
+        juce::AbstractFifo fifo;
+        std::vector<Event> events;
+        std::atomic<int> numDropped { 0 };
+    };
+
+    std::vector<std::unique_ptr<Ring>> rings;
+};
+
+}
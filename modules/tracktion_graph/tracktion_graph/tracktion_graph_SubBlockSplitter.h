@@ -0,0 +1,112 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+#pragma once
+
+namespace tracktion_graph
+{
+
+//==============================================================================
+//==============================================================================
+/**
+    Used by players to split blocks in to sub-blocks at the boundaries their Nodes ask for.
+
+    Call prepare when the graph is prepared, then process for each block. If none of
+    the Nodes add any boundaries, the block is processed in one go.
+*/
+class SubBlockSplitter
+{
+public:
+    SubBlockSplitter() = default;
+
+    /** Finds the Nodes that may want to split blocks and allocates space for the boundaries. */
+    void prepare (const std::vector<Node*>& nodes, double sampleRateToUse, int maxNumBoundariesPerBlock = 256)
+    {
+        sampleRate = sampleRateToUse;
+        nodesWithBoundaries.clear();
+
+        for (auto node : nodes)
+            if (node->needsSubBlockBoundaries())
+                nodesWithBoundaries.push_back (node);
+
+        boundaries.clear();
+        boundaries.reserve ((size_t) maxNumBoundariesPerBlock);
+        subBlockMidi.reserve (tracktion_engine::MidiMessageArray::defaultNumMessagesToReserve);
+    }
+
+    /** Returns true if any of the Nodes may want to split blocks. */
+    bool hasNodesWithBoundaries() const noexcept    { return ! nodesWithBoundaries.empty(); }
+
+    /** Calls processSubBlock once for each sub-block of the ProcessContext.
+        Each call is given a ProcessContext referring to that part of the audio and an
+        empty MIDI buffer which is then merged back in to the ProcessContext's MIDI, offset
+        by the start time of the sub-block. processSubBlock should overwrite the buffers it's
+        given, in the same way players copy the root Node's output.
+
+        @param processSubBlock  Has the signature @code int (const Node::ProcessContext&) @endcode
+        @returns the sum of the values returned by processSubBlock
+    */
+    template<typename ProcessFunction>
+    int process (const Node::ProcessContext& pc, ProcessFunction&& processSubBlock)
+    {
+        if (nodesWithBoundaries.empty())
+            return processSubBlock (pc);
+
+        const auto blockRange = pc.streamSampleRange;
+        jassert ((int64_t) pc.buffers.audio.getNumSamples() == blockRange.getLength());
+        boundaries.clear();
+
+        for (auto node : nodesWithBoundaries)
+            node->addSubBlockBoundaries (blockRange, boundaries);
+
+        boundaries.erase (std::remove_if (boundaries.begin(), boundaries.end(),
+                                          [blockRange] (int64_t b) { return b <= blockRange.getStart() || b >= blockRange.getEnd(); }),
+                          boundaries.end());
+
+        if (boundaries.empty())
+            return processSubBlock (pc);
+
+        std::sort (boundaries.begin(), boundaries.end());
+        boundaries.erase (std::unique (boundaries.begin(), boundaries.end()), boundaries.end());
+        boundaries.push_back (blockRange.getEnd());
+
+        auto& destMidi = pc.buffers.midi;
+        destMidi.clear();
+
+        int result = 0;
+        auto subBlockStart = blockRange.getStart();
+
+        for (auto subBlockEnd : boundaries)
+        {
+            const auto offset = (size_t) (subBlockStart - blockRange.getStart());
+            const auto numSamples = (size_t) (subBlockEnd - subBlockStart);
+            subBlockMidi.clear();
+
+            auto subBlockAudio64 = pc.buffers.audio64.getNumChannels() > 0 ? pc.buffers.audio64.getSubBlock (offset, numSamples)
+                                                                           : juce::dsp::AudioBlock<double>();
+
+            result += processSubBlock (Node::ProcessContext { { subBlockStart, subBlockEnd },
+                                                              { pc.buffers.audio.getSubBlock (offset, numSamples), subBlockMidi, subBlockAudio64 } });
+            destMidi.mergeFromAndClearWithOffset (subBlockMidi, offset / sampleRate);
+
+            subBlockStart = subBlockEnd;
+        }
+
+        return result;
+    }
+
+private:
+    std::vector<Node*> nodesWithBoundaries;
+    std::vector<int64_t> boundaries;
+    tracktion_engine::MidiMessageArray subBlockMidi;
+    double sampleRate = 44100.0;
+};
+
+}
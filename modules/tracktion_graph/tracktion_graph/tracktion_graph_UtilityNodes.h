@@ -51,6 +51,18 @@ public:
         return props;
     }
     
+    /** Returns the Node being delayed. */
+    Node* getInputNode() const noexcept
+    {
+        return input;
+    }
+
+    /** Returns the number of samples this Node delays its input by. */
+    int getNumSamplesToDelay() const noexcept
+    {
+        return latencyStorage->latencyNumSamples;
+    }
+
     std::vector<Node*> getDirectInputNodes() override
     {
         return { input };
@@ -60,42 +72,56 @@ public:
     {
         return input->hasProcessed();
     }
+
+    bool canProcessInPlace() override
+    {
+        return true;
+    }
+
+    bool supportsDoublePrecision() override
+    {
+        // There's no point delaying a float input in double precision
+        return input->isProcessingInDoublePrecision();
+    }
+
+    ProcessingCost getProcessingCost() override
+    {
+        return ProcessingCost::cheap;
+    }
     
     void prepareToPlay (const PlaybackInitialisationInfo& info) override
     {
         latencyStorage->sampleRate = info.sampleRate;
         latencyStorage->latencyTimeSeconds = latencyStorage->latencyNumSamples / info.sampleRate;
         
-        latencyStorage->fifo.setSize (getNodeProperties().numberOfChannels, latencyStorage->latencyNumSamples + info.blockSize + 1);
-        latencyStorage->fifo.writeSilence (latencyStorage->latencyNumSamples);
-        jassert (latencyStorage->fifo.getNumReady() == latencyStorage->latencyNumSamples);
+        // Only the FIFO for the precision being processed in has any channels
+        const int numChannels = getNodeProperties().numberOfChannels;
+        const bool isDouble = isProcessingInDoublePrecision();
+        prepareFifo (latencyStorage->fifo, isDouble ? 0 : numChannels, info.blockSize);
+        prepareFifo (latencyStorage->fifo64, isDouble ? numChannels : 0, info.blockSize);
         
         replaceLatencyStorageIfPossible (info.rootNodeToReplace);
     }
     
     void process (const ProcessContext& pc) override
     {
-        auto& outputBlock = pc.buffers.audio;
-        auto inputBuffer = input->getProcessedOutput().audio;
-        auto& inputMidi = input->getProcessedOutput().midi;
+        auto inputBuffers = input->getProcessedOutput();
+        auto& inputMidi = inputBuffers.midi;
         const int numSamples = (int) pc.streamSampleRange.getLength();
 
-        if (latencyStorage->fifo.getNumChannels() > 0)
-        {
-            jassert (numSamples == (int) outputBlock.getNumSamples());
-            jassert (latencyStorage->fifo.getNumChannels() == (int) inputBuffer.getNumChannels());
-            
-            // Write to audio delay buffer
-            latencyStorage->fifo.write (inputBuffer);
-
-            // Then read from them
-            jassert (latencyStorage->fifo.getNumReady() >= (int) outputBlock.getNumSamples());
-            latencyStorage->fifo.readAdding (outputBlock);
-        }
+        // Delay the audio
+        if (isProcessingInDoublePrecision())
+            delayAudio (latencyStorage->fifo64, inputBuffers.audio64, pc.buffers.audio64);
+        else
+            delayAudio (latencyStorage->fifo, inputBuffers.audio, pc.buffers.audio);
 
         // Then write to MIDI delay buffer
         latencyStorage->midi.mergeFromWithOffset (inputMidi, latencyStorage->latencyTimeSeconds);
 
+        // When processing in-place the output still contains the input which has been consumed now
+        if (isProcessingInPlace())
+            pc.buffers.midi.clear();
+
 
         // And read out any delayed items
         const double blockTimeSeconds = numSamples / latencyStorage->sampleRate;
@@ -133,10 +159,37 @@ private:
         double sampleRate = 44100.0;
         double latencyTimeSeconds = 0.0;
         AudioFifo fifo { 1, 32 };
+        AudioFifo64 fifo64 { 0, 32 };
         tracktion_engine::MidiMessageArray midi;
     };
     
     std::shared_ptr<LatencyStorage> latencyStorage { std::make_shared<LatencyStorage>() };
+
+    template<typename FifoType>
+    void prepareFifo (FifoType& fifo, int numChannels, int blockSize)
+    {
+        fifo.setSize (numChannels, latencyStorage->latencyNumSamples + blockSize + 1);
+        fifo.writeSilence (latencyStorage->latencyNumSamples);
+        jassert (fifo.getNumReady() == latencyStorage->latencyNumSamples);
+    }
+
+    template<typename FifoType, typename BlockType>
+    void delayAudio (FifoType& fifo, const BlockType& inputBlock, const BlockType& outputBlock)
+    {
+        if (fifo.getNumChannels() == 0)
+            return;
+
+        jassert (inputBlock.getNumSamples() == outputBlock.getNumSamples());
+        jassert (fifo.getNumChannels() == (int) inputBlock.getNumChannels());
+        fifo.write (inputBlock);
+
+        // When processing in-place the output still contains the input which has been consumed now
+        if (isProcessingInPlace())
+            outputBlock.clear();
+
+        jassert (fifo.getNumReady() >= (int) outputBlock.getNumSamples());
+        fifo.readAdding (outputBlock);
+    }
     
     void replaceLatencyStorageIfPossible (Node* rootNodeToReplace)
     {
@@ -150,7 +203,8 @@ private:
                 if (other->getNodeProperties().nodeID == nodeIDToLookFor
                     && other->latencyStorage->latencyNumSamples == latencyStorage->latencyNumSamples
                     && other->latencyStorage->sampleRate == latencyStorage->sampleRate
-                    && other->latencyStorage->fifo.getNumChannels() == latencyStorage->fifo.getNumChannels())
+                    && other->latencyStorage->fifo.getNumChannels() == latencyStorage->fifo.getNumChannels()
+                    && other->latencyStorage->fifo64.getNumChannels() == latencyStorage->fifo64.getNumChannels())
                 {
                     latencyStorage = other->latencyStorage;
                 }
@@ -166,6 +220,11 @@ private:
 /**
     An Node which sums together the multiple inputs adding additional latency
     to provide a coherent output.
+
+    Latency is only added to the inputs with less than the maximum latency. If an
+    input is already delayed elsewhere in the graph, that delay line is shared
+    rather than creating a new one, either directly if the delay is the same or by
+    adding the remaining delay on to it.
 */
 class SummingNode : public Node
 {
@@ -197,6 +256,17 @@ public:
         nodes.push_back (newInput.get());
         ownedNodes.push_back (std::move (newInput));
     }
+
+    /** Enables or disables summing with a double precision accumulator.
+        This is more accurate when summing a lot of inputs but slower.
+        This must be called before the Node is initialised.
+        If the graph is processed in double precision, the inputs are always summed in
+        double precision and this has no effect.
+    */
+    void setDoubleProcessingPrecision (bool shouldSumInDoublePrecision)
+    {
+        useDoublePrecision = shouldSumInDoublePrecision;
+    }
     
     NodeProperties getNodeProperties() override
     {
@@ -231,13 +301,23 @@ public:
         return inputNodes;
     }
     
-    bool transform (Node&) override
+    bool transform (Node& rootNode) override
     {
-        return createLatencyNodes();
+        return createLatencyNodes (rootNode);
     }
 
-    void prepareToPlay (const PlaybackInitialisationInfo&) override
+    bool supportsDoublePrecision() override
     {
+        return true;
+    }
+
+    void prepareToPlay (const PlaybackInitialisationInfo& info) override
+    {
+        inputBlocks.reserve (nodes.size());
+        inputBlocks64.reserve (nodes.size());
+        sourceChannels.resize (nodes.size());
+        sourceChannels64.resize (nodes.size());
+        doubleSum.resize (useDoublePrecision && ! isProcessingInDoublePrecision() ? (size_t) info.blockSize : 0);
     }
 
     bool isReadyToProcess() override
@@ -251,32 +331,120 @@ public:
     
     void process (const ProcessContext& pc) override
     {
-        const auto numChannels = pc.buffers.audio.getNumChannels();
+        auto& outputBlock = pc.buffers.audio;
+        const auto numChannels = outputBlock.getNumChannels();
+        const auto numSamples = outputBlock.getNumSamples();
+
+        // Get each of the inputs and merge their MIDI
+        inputBlocks.clear();
+        inputBlocks64.clear();
 
-        // Get each of the inputs and add them to dest
         for (auto& node : nodes)
         {
             auto inputFromNode = node->getProcessedOutput();
-            
-            const auto numChannelsToAdd = std::min (inputFromNode.audio.getNumChannels(), numChannels);
-
-            if (numChannelsToAdd > 0)
-                pc.buffers.audio.getSubsetChannelBlock (0, numChannelsToAdd)
-                    .add (node->getProcessedOutput().audio.getSubsetChannelBlock (0, numChannelsToAdd));
-            
+            inputBlocks.push_back (inputFromNode.audio);
+            inputBlocks64.push_back (inputFromNode.audio64);
             pc.buffers.midi.mergeFrom (inputFromNode.midi);
         }
+
+        if (isProcessingInDoublePrecision())
+        {
+            sumInDoublePrecision (pc.buffers.audio64);
+            return;
+        }
+
+        // Then sum the inputs to each channel several at a time
+        for (size_t channel = 0; channel < numChannels; ++channel)
+        {
+            size_t numSources = 0;
+
+            for (auto& inputBlock : inputBlocks)
+                if (channel < inputBlock.getNumChannels())
+                    sourceChannels[numSources++] = inputBlock.getChannelPointer (channel);
+
+            auto dest = outputBlock.getChannelPointer (channel);
+
+            if (useDoublePrecision)
+            {
+                jassert (doubleSum.size() >= numSamples);
+                std::fill_n (doubleSum.begin(), numSamples, 0.0);
+                audio_summing::addSources (doubleSum.data(), sourceChannels.data(), numSources, numSamples);
+                audio_summing::addDoubleToFloat (dest, doubleSum.data(), numSamples);
+            }
+            else
+            {
+                audio_summing::addSources (dest, sourceChannels.data(), numSources, numSamples);
+            }
+        }
     }
 
 private:
     std::vector<std::unique_ptr<Node>> ownedNodes;
     std::vector<Node*> nodes;
+
+    bool useDoublePrecision = false;
+    std::vector<juce::dsp::AudioBlock<float>> inputBlocks;
+    std::vector<juce::dsp::AudioBlock<double>> inputBlocks64;
+    std::vector<const float*> sourceChannels;
+    std::vector<const double*> sourceChannels64;
+    std::vector<double> doubleSum;
+
+    /** Sums straight in to the double output, reading the double output of any inputs that have it. */
+    void sumInDoublePrecision (const juce::dsp::AudioBlock<double>& outputBlock)
+    {
+        for (size_t channel = 0; channel < outputBlock.getNumChannels(); ++channel)
+        {
+            size_t numSources = 0, numSources64 = 0;
+
+            for (size_t i = 0; i < inputBlocks.size(); ++i)
+            {
+                if (channel < inputBlocks64[i].getNumChannels())
+                    sourceChannels64[numSources64++] = inputBlocks64[i].getChannelPointer (channel);
+                else if (channel < inputBlocks[i].getNumChannels())
+                    sourceChannels[numSources++] = inputBlocks[i].getChannelPointer (channel);
+            }
+
+            auto dest = outputBlock.getChannelPointer (channel);
+            audio_summing::addSources (dest, sourceChannels64.data(), numSources64, outputBlock.getNumSamples());
+            audio_summing::addSources (dest, sourceChannels.data(), numSources, outputBlock.getNumSamples());
+        }
+    }
     
-    bool createLatencyNodes()
+    bool createLatencyNodes (Node& rootNode)
     {
         bool topologyChanged = false;
         const int maxLatency = getNodeProperties().latencyNumSamples;
         std::vector<std::unique_ptr<Node>> ownedNodesToAdd;
+        std::vector<Node*> referencedNodesToAdd;
+
+        // Only look for the existing LatencyNodes if any latency needs to be added
+        std::vector<LatencyNode*> existingLatencyNodes;
+        bool hasFoundExistingLatencyNodes = false;
+
+        auto findLatencyNodeToShare = [&] (Node* inputNode, int latencyToAdd)
+        {
+            if (! hasFoundExistingLatencyNodes)
+            {
+                visitNodes (rootNode, [&] (Node& n)
+                            {
+                                if (auto latencyNode = dynamic_cast<LatencyNode*> (&n))
+                                    existingLatencyNodes.push_back (latencyNode);
+                            }, true);
+
+                hasFoundExistingLatencyNodes = true;
+            }
+
+            // Use the one with the longest delay that isn't longer than needed
+            LatencyNode* nodeToShare = nullptr;
+
+            for (auto latencyNode : existingLatencyNodes)
+                if (latencyNode->getInputNode() == inputNode
+                    && latencyNode->getNumSamplesToDelay() <= latencyToAdd
+                    && (nodeToShare == nullptr || latencyNode->getNumSamplesToDelay() > nodeToShare->getNumSamplesToDelay()))
+                    nodeToShare = latencyNode;
+
+            return nodeToShare;
+        };
 
         for (auto& node : nodes)
         {
@@ -285,6 +453,22 @@ private:
             
             if (latencyToAdd == 0)
                 continue;
+
+            // If the input is already delayed, share that delay line. Any owned input is
+            // left in the owned nodes so it stays alive for the shared LatencyNode
+            if (auto nodeToShare = findLatencyNodeToShare (node, latencyToAdd))
+            {
+                const int remainingLatency = latencyToAdd - nodeToShare->getNumSamplesToDelay();
+
+                if (remainingLatency == 0)
+                    referencedNodesToAdd.push_back (nodeToShare);
+                else
+                    ownedNodesToAdd.push_back (makeNode<LatencyNode> (nodeToShare, remainingLatency));
+
+                node = nullptr;
+                topologyChanged = true;
+                continue;
+            }
             
             auto getOwnedNode = [this] (auto nodeToFind)
             {
@@ -316,6 +500,8 @@ private:
             ownedNodes.push_back (std::move (newNode));
         }
 
+        nodes.insert (nodes.end(), referencedNodesToAdd.begin(), referencedNodesToAdd.end());
+
         nodes.erase (std::remove_if (nodes.begin(), nodes.end(),
                                      [] (auto& n) { return n == nullptr; }),
                      nodes.end());
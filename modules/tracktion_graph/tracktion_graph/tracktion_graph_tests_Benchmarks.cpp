@@ -0,0 +1,277 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+
+namespace tracktion_graph
+{
+
+//==============================================================================
+//==============================================================================
+/**
+    Times NodePlayer and MultiThreadedNodePlayer processing synthetic graphs of different
+    shapes and sizes, with different numbers of threads and block sizes.
+
+    Each result is logged, along with the median and worst per-block times and how well
+    the threads scale compared to the NodePlayer. A JSON array of all the results is logged
+    at the end, and written to the file named by the TRACKTION_GRAPH_BENCHMARK_RESULTS
+    environment variable if it's set, so runs can be compared to catch regressions.
+
+    This is in the tracktion_graph_performance category so isn't run with the other tests.
+*/
+class GraphBenchmarks : public juce::UnitTest
+{
+public:
+    GraphBenchmarks()
+        : juce::UnitTest ("Graph benchmarks", "tracktion_graph_performance")
+    {
+    }
+
+    void runTest() override
+    {
+        juce::Array<juce::var> results;
+
+        for (auto shape : { GraphShape::fanIn, GraphShape::chain, GraphShape::randomWithSends })
+            for (int numNodes : { 1, 10, 100, 1000, 10000 })
+                for (int blockSize : { 64, 512 })
+                    runBenchmarks (shape, numNodes, blockSize, results);
+
+        auto json = juce::JSON::toString (results);
+        logMessage (json);
+
+        auto resultsPath = juce::SystemStats::getEnvironmentVariable ("TRACKTION_GRAPH_BENCHMARK_RESULTS", {});
+
+        if (resultsPath.isNotEmpty())
+            juce::File::getCurrentWorkingDirectory().getChildFile (resultsPath).replaceWithText (json);
+    }
+
+private:
+    //==============================================================================
+    enum class GraphShape
+    {
+        fanIn,              // Lots of sources summed by one node
+        chain,              // One source followed by a long chain of gain nodes
+        randomWithSends     // Tracks of random lengths, grouped in sub-mixes, with sends, returns and latency
+    };
+
+    static const char* getName (GraphShape shape)
+    {
+        switch (shape)
+        {
+            case GraphShape::fanIn:             return "fanIn";
+            case GraphShape::chain:             return "chain";
+            case GraphShape::randomWithSends:   return "randomWithSends";
+        }
+
+        return "";
+    }
+
+    struct Timings
+    {
+        double medianMicroseconds = 0, p99Microseconds = 0, p999Microseconds = 0, maxMicroseconds = 0;
+        double realTimeLoad = 0;    // The median block time as a proportion of the block's duration
+    };
+
+    static constexpr double sampleRate = 44100.0;
+    static constexpr int numChannels = 2;
+
+    //==============================================================================
+    std::unique_ptr<Node> createGraph (GraphShape shape, int numNodes)
+    {
+        size_t nextNodeID = 1;
+        auto createSource = [&nextNodeID] { return makeNode<SinNode> (220.0f, (int) numChannels, nextNodeID++); };
+
+        if (numNodes <= 1)
+            return createSource();
+
+        if (shape == GraphShape::fanIn)
+        {
+            std::vector<std::unique_ptr<Node>> inputs;
+
+            for (int i = 1; i < numNodes; ++i)
+                inputs.push_back (createSource());
+
+            return makeNode<BasicSummingNode> (std::move (inputs));
+        }
+
+        if (shape == GraphShape::chain)
+        {
+            // The Nodes are visited recursively so a chain this long would risk overflowing the stack
+            auto node = createSource();
+
+            for (int i = 1; i < std::min (numNodes, 1000); ++i)
+                node = makeGainNode (std::move (node), 0.999f);
+
+            return node;
+        }
+
+        // A random arrangement, seeded by the number of Nodes so each run gets the same graph
+        juce::Random r (numNodes);
+        const int numBuses = std::max (1, numNodes / 100);
+        std::vector<std::unique_ptr<Node>> groups, currentGroup;
+        int numCreated = 1;
+
+        while (numCreated < numNodes)
+        {
+            auto track = createSource();
+            ++numCreated;
+
+            for (int i = r.nextInt (8); --i >= 0 && numCreated < numNodes;)
+            {
+                track = makeGainNode (std::move (track), 0.999f);
+                ++numCreated;
+            }
+
+            if (numCreated < numNodes && r.nextInt (10) == 0)
+            {
+                track = makeNode<LatencyNode> (std::move (track), r.nextInt ({ 1, 1024 }));
+                ++numCreated;
+            }
+
+            // A quarter of the tracks send to a bus and a few of the others return one, which
+            // can't create a cycle as the tracks that send never return
+            if (numCreated < numNodes)
+            {
+                auto choice = r.nextInt (20);
+
+                if (choice < 5)
+                {
+                    track = makeNode<SendNode> (std::move (track), r.nextInt (numBuses));
+                    ++numCreated;
+                }
+                else if (choice == 5)
+                {
+                    track = makeNode<ReturnNode> (std::move (track), r.nextInt (numBuses));
+                    ++numCreated;
+                }
+            }
+
+            currentGroup.push_back (std::move (track));
+
+            if ((int) currentGroup.size() >= 16 && numCreated < numNodes)
+            {
+                groups.push_back (makeNode<BasicSummingNode> (std::move (currentGroup)));
+                currentGroup.clear();
+                ++numCreated;
+            }
+        }
+
+        for (auto& track : currentGroup)
+            groups.push_back (std::move (track));
+
+        return makeNode<BasicSummingNode> (std::move (groups));
+    }
+
+    //==============================================================================
+    void runBenchmarks (GraphShape shape, int numNodes, int blockSize, juce::Array<juce::var>& results)
+    {
+        beginTest (juce::String ("Graph benchmark: ") + getName (shape) + ", nodes: " + juce::String (numNodes)
+                    + ", block size: " + juce::String (blockSize));
+
+        auto addResult = [&] (const juce::String& playerName, int numThreads, const Timings& t, double singleThreadedMedian)
+        {
+            auto efficiency = singleThreadedMedian / (t.medianMicroseconds * numThreads);
+
+            logMessage (playerName + ", threads: " + juce::String (numThreads)
+                        + ", median: " + juce::String (t.medianMicroseconds, 2) + " us"
+                        + ", 99%: " + juce::String (t.p99Microseconds, 2) + " us"
+                        + ", 99.9%: " + juce::String (t.p999Microseconds, 2) + " us"
+                        + ", max: " + juce::String (t.maxMicroseconds, 2) + " us"
+                        + ", load: " + juce::String (t.realTimeLoad * 100.0, 1) + "%"
+                        + ", efficiency: " + juce::String (efficiency * 100.0, 1) + "%");
+
+            auto result = new juce::DynamicObject();
+            result->setProperty ("graph", getName (shape));
+            result->setProperty ("numNodes", numNodes);
+            result->setProperty ("blockSize", blockSize);
+            result->setProperty ("player", playerName);
+            result->setProperty ("numThreads", numThreads);
+            result->setProperty ("medianUs", t.medianMicroseconds);
+            result->setProperty ("p99Us", t.p99Microseconds);
+            result->setProperty ("p999Us", t.p999Microseconds);
+            result->setProperty ("maxUs", t.maxMicroseconds);
+            result->setProperty ("load", t.realTimeLoad);
+            result->setProperty ("scalingEfficiency", efficiency);
+            results.add (juce::var (result));
+        };
+
+        auto singleThreaded = timePlayer (std::make_unique<NodePlayer> (createGraph (shape, numNodes)), blockSize);
+        addResult ("NodePlayer", 1, singleThreaded, singleThreaded.medianMicroseconds);
+
+        const int maxNumThreads = std::max (1, (int) std::thread::hardware_concurrency());
+
+        for (int numThreads = 1;; numThreads = std::min (numThreads * 2, maxNumThreads))
+        {
+            auto player = std::make_unique<MultiThreadedNodePlayer> (createGraph (shape, numNodes));
+            player->setMaxNumThreads ((size_t) numThreads);
+
+            addResult ("MultiThreadedNodePlayer", numThreads, timePlayer (std::move (player), blockSize),
+                       singleThreaded.medianMicroseconds);
+
+            if (numThreads == maxNumThreads)
+                break;
+        }
+
+        expect (singleThreaded.medianMicroseconds > 0.0);
+    }
+
+    template<typename NodePlayerType>
+    Timings timePlayer (std::unique_ptr<NodePlayerType> player, int blockSize)
+    {
+        player->prepareToPlay (sampleRate, blockSize);
+
+        juce::AudioBuffer<float> buffer (numChannels, blockSize);
+        tracktion_engine::MidiMessageArray midi;
+        int64_t position = 0;
+
+        auto processBlock = [&]
+        {
+            buffer.clear();
+            midi.clear();
+            player->process ({ juce::Range<int64_t>::withStartAndLength (position, (int64_t) blockSize), { { buffer }, midi } });
+            position += blockSize;
+        };
+
+        // The first blocks allocate and warm up the caches, so aren't counted
+        for (int i = 0; i < 50; ++i)
+            processBlock();
+
+        const auto numBlocks = std::max (200, juce::roundToInt (5.0 * sampleRate / blockSize));
+        std::vector<double> blockTimes;
+        blockTimes.reserve ((size_t) numBlocks);
+
+        for (int i = 0; i < numBlocks; ++i)
+        {
+            const auto start = juce::Time::getHighResolutionTicks();
+            processBlock();
+            blockTimes.push_back (juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - start) * 1.0e6);
+        }
+
+        std::sort (blockTimes.begin(), blockTimes.end());
+
+        auto percentile = [&blockTimes] (double proportion)
+        {
+            auto index = (size_t) std::ceil (proportion * (double) blockTimes.size()) - 1;
+            return blockTimes[std::min (index, blockTimes.size() - 1)];
+        };
+
+        Timings t;
+        t.medianMicroseconds = percentile (0.5);
+        t.p99Microseconds = percentile (0.99);
+        t.p999Microseconds = percentile (0.999);
+        t.maxMicroseconds = blockTimes.back();
+        t.realTimeLoad = t.medianMicroseconds / (blockSize * 1.0e6 / sampleRate);
+
+        return t;
+    }
+};
+
+static GraphBenchmarks graphBenchmarks;
+
+}
@@ -25,6 +25,54 @@ public:
     }
     
     void runTest() override
+    {
+        runMidiStorageTests();
+        runAllTests<NodePlayer>();
+        runAllTests<MultiThreadedNodePlayer>();
+    }
+
+private:
+    //==============================================================================
+    void runMidiStorageTests()
+    {
+        beginTest ("MIDI storage");
+        {
+            using tracktion_engine::MidiMessageArray;
+
+            MidiMessageArray dest, source;
+            dest.reserve (8);
+            source.reserve (8);
+
+            for (int i = 0; i < 8; ++i)
+                source.addMidiMessage (juce::MidiMessage::controllerEvent (1, 1, i), i * 0.001, MidiMessageArray::notMPE);
+
+            dest.mergeFromWithOffset (source, 1.0);
+            expectEquals (dest.size(), 8);
+            expectEquals (dest.getCapacity(), 8);
+            expectWithinAbsoluteError (dest[7].getTimeStamp(), 1.007, 1.0e-9);
+
+            // Removing and clearing mustn't release the storage
+            for (int i = 0; i < 6; ++i)
+                dest.remove (0);
+
+            dest.removeNoteOnsAndOffs();
+            expectEquals (dest.size(), 2);
+            expectEquals (dest.getCapacity(), 8);
+
+            dest.clear();
+            expect (dest.isEmpty());
+            expectEquals (dest.getCapacity(), 8);
+
+            dest.mergeFromAndClearWithOffsetAndLimit (source, 0.0, 3);
+            expectEquals (dest.size(), 3);
+            expectEquals (source.size(), 5);
+            expectEquals (source.getCapacity(), 8);
+        }
+    }
+
+    //==============================================================================
+    template<typename NodePlayerType>
+    void runAllTests()
     {
         for (auto setup : getTestSetups (*this))
         {
@@ -34,38 +82,50 @@ public:
                         .replace ("RND", setup.randomiseBlockSizes ? "Y" : "N"));
 
             // Mono tests
-            runSinTests (setup);
-            runSinCancellingTests (setup);
-            runSinOctaveTests (setup);
-            runSendReturnTests (setup);
-            runLatencyTests (setup);
+            runSinTests<NodePlayerType> (setup);
+            runSinCancellingTests<NodePlayerType> (setup);
+            runSinOctaveTests<NodePlayerType> (setup);
+            runSendReturnTests<NodePlayerType> (setup);
+            runLatencyTests<NodePlayerType> (setup);
+            runDoublePrecisionTests<NodePlayerType> (setup);
 
             // MIDI tests
-            runMidiTests (setup);
+            runMidiTests<NodePlayerType> (setup);
 
             // Multi channel tests
-            runStereoTests (setup);
+            runStereoTests<NodePlayerType> (setup);
             
+            // Tests splitting blocks in to sub-blocks
+            runSubBlockTests<NodePlayerType> (setup);
+
             // Tests rebuilding the graph mid render
-            runRebuildTests (setup);
-            runCycleTests (setup);
+            runRebuildTests<NodePlayerType> (setup);
+            runCycleTests<NodePlayerType> (setup);
         }
     }
 
-private:
     //==============================================================================
     //==============================================================================
+    template<typename NodePlayerType>
     void runSinTests (TestSetup testSetup)
     {
         beginTest ("Sin");
         {
             auto sinNode = std::make_unique<SinNode> (220.0f);
             
-            auto testContext = createBasicTestContext (std::move (sinNode), testSetup, 1, 5.0);
+            auto testContext = createPlayerAndTestContext<NodePlayerType> (std::move (sinNode), testSetup, 1, 5.0);
             test_utilities::expectAudioBuffer (*this, testContext->buffer, 0, 1.0f, 0.707f);
         }
+
+        beginTest ("Sin buffer memory");
+        {
+            NodePlayerType player (std::make_unique<SinNode> (220.0f));
+            player.prepareToPlay (testSetup.sampleRate, testSetup.blockSize);
+            expectGreaterOrEqual (player.getNumBytesAllocated(), (size_t) testSetup.blockSize * sizeof (float));
+        }
     }
 
+    template<typename NodePlayerType>
     void runSinCancellingTests (TestSetup testSetup)
     {
         beginTest ("Sin cancelling");
@@ -79,11 +139,12 @@ private:
 
             auto sumNode = std::make_unique<BasicSummingNode> (std::move (nodes));
             
-            auto testContext = createBasicTestContext (std::move (sumNode), testSetup, 1, 5.0);
+            auto testContext = createPlayerAndTestContext<NodePlayerType> (std::move (sumNode), testSetup, 1, 5.0);
             test_utilities::expectAudioBuffer (*this, testContext->buffer, 0, 0.0f, 0.0f);
         }
     }
 
+    template<typename NodePlayerType>
     void runSinOctaveTests (TestSetup testSetup)
     {
         beginTest ("Sin octave");
@@ -95,11 +156,12 @@ private:
             auto sumNode = std::make_unique<BasicSummingNode> (std::move (nodes));
             auto node = std::make_unique<FunctionNode> (std::move (sumNode), [] (float s) { return s * 0.5f; });
             
-            auto testContext = createBasicTestContext (std::move (node), testSetup, 1, 5.0);
+            auto testContext = createPlayerAndTestContext<NodePlayerType> (std::move (node), testSetup, 1, 5.0);
             test_utilities::expectAudioBuffer (*this, testContext->buffer, 0, 0.885f, 0.5f);
         }
     }
     
+    template<typename NodePlayerType>
     void runSendReturnTests (TestSetup testSetup)
     {
         beginTest ("Sin send/return");
@@ -117,7 +179,7 @@ private:
             // Track 1 & 2 then get summed together
             auto node = makeBaicSummingNode ({ track1Node.release(), track2Node.release() });
 
-            auto testContext = createBasicTestContext (std::move (node), testSetup, 1, 5.0);
+            auto testContext = createPlayerAndTestContext<NodePlayerType> (std::move (node), testSetup, 1, 5.0);
             test_utilities::expectAudioBuffer (*this, testContext->buffer, 0, 1.0f, 0.707f);
         }
 
@@ -138,7 +200,7 @@ private:
             // Track 1 & 2 then get summed together
             auto node = makeBaicSummingNode ({ track1Node.release(), track2Node.release() });
 
-            auto testContext = createBasicTestContext (std::move (node), testSetup, 1, 5.0);
+            auto testContext = createPlayerAndTestContext<NodePlayerType> (std::move (node), testSetup, 1, 5.0);
             test_utilities::expectAudioBuffer (*this, testContext->buffer, 0, 0.0f, 0.0f);
         }
         
@@ -157,11 +219,12 @@ private:
             // Track 1 & 2 then get summed together
             auto node = makeBaicSummingNode ({ track1Node.release(), track2Node.release() });
             
-            auto testContext = createBasicTestContext (std::move (node), testSetup, 1, 5.0);
+            auto testContext = createPlayerAndTestContext<NodePlayerType> (std::move (node), testSetup, 1, 5.0);
             test_utilities::expectAudioBuffer (*this, testContext->buffer, 0, 0.885f, 0.5f);
         }
     }
     
+    template<typename NodePlayerType>
     void runLatencyTests (TestSetup testSetup)
     {
         beginTest ("Basic latency test cancelling sin");
@@ -184,7 +247,7 @@ private:
 
             auto sumNode = std::make_unique<BasicSummingNode> (std::move (nodes));
 
-            auto testContext = createBasicTestContext (std::move (sumNode), testSetup, 1, 5.0);
+            auto testContext = createPlayerAndTestContext<NodePlayerType> (std::move (sumNode), testSetup, 1, 5.0);
 
             // Start of buffer is +-1, after latency comp kicks in, the second half will be silent
             test_utilities::expectAudioBuffer (*this, testContext->buffer, 0, numLatencySamples, 1.0f, 0.707f, 0.0f, 0.0f);
@@ -211,7 +274,7 @@ private:
 
             auto sumNode = makeNode<SummingNode> (std::move (nodes));
 
-            auto testContext = createBasicTestContext (std::move (sumNode), testSetup, 1, 5.0);
+            auto testContext = createPlayerAndTestContext<NodePlayerType> (std::move (sumNode), testSetup, 1, 5.0);
             // Start of buffer which should be silent
             // Part of buffer after latency which should be all sin +-1.0
             test_utilities::expectAudioBuffer (*this, testContext->buffer, 0, numLatencySamples, 0.0f, 0.0f, 1.0f, 0.707f);
@@ -238,7 +301,7 @@ private:
             
             auto node = makeSummingNode ({ track1.release(), track2.release() });
 
-            auto testContext = createBasicTestContext (std::move (node), testSetup, 1, 5.0);
+            auto testContext = createPlayerAndTestContext<NodePlayerType> (std::move (node), testSetup, 1, 5.0);
 
             // Start of buffer which should be silent
             // Part of buffer after latency which should be all sin +-1.0
@@ -272,7 +335,7 @@ private:
 
             auto node = makeSummingNode ({ track1.release(), track2.release(), track3.release() });
 
-            auto testContext = createBasicTestContext (std::move (node), testSetup, 1, 5.0);
+            auto testContext = createPlayerAndTestContext<NodePlayerType> (std::move (node), testSetup, 1, 5.0);
 
             // Start of buffer which should be silent
             // Part of buffer after latency which should be all sin +-1.0
@@ -305,7 +368,7 @@ private:
 
             auto node = makeSummingNode ({ track1.release(), track2.release(), track3.release() });
 
-            auto testContext = createBasicTestContext (std::move (node), testSetup, 1, 5.0);
+            auto testContext = createPlayerAndTestContext<NodePlayerType> (std::move (node), testSetup, 1, 5.0);
 
             // Start of buffer which should be silent
             // Part of buffer after latency which should be all sin +-1.0
@@ -313,6 +376,46 @@ private:
         }
     }
         
+    template<typename NodePlayerType>
+    void runDoublePrecisionTests (TestSetup testSetup)
+    {
+        beginTest ("Double precision latency test doubling sin");
+        {
+            /*  This is the same as the latency doubling test but processed in double precision.
+                The delayed sin is summed and delayed in double precision and the other one is
+                converted when they're summed, so both paths between float and double Nodes are used.
+            */
+            const double sampleRate = testSetup.sampleRate;
+            const double sinFrequency = sampleRate / 100.0;
+            const double numSamplesPerCycle = sampleRate / sinFrequency;
+            const int numLatencySamples = juce::roundToInt (numSamplesPerCycle / 2.0);
+
+            std::vector<std::unique_ptr<Node>> nodes;
+            nodes.push_back (makeGainNode (makeNode<SinNode> ((float) sinFrequency), 0.5f));
+
+            std::vector<std::unique_ptr<Node>> delayedNodes;
+            delayedNodes.push_back (makeGainNode (makeNode<SinNode> ((float) sinFrequency), 0.5f));
+            auto delayedSumNode = makeNode<SummingNode> (std::move (delayedNodes));
+            auto delayedSumNodePtr = delayedSumNode.get();
+
+            auto latencyNode = makeNode<LatencyNode> (std::move (delayedSumNode), numLatencySamples);
+            auto latencyNodePtr = latencyNode.get();
+            nodes.push_back (std::move (latencyNode));
+
+            auto player = std::make_unique<NodePlayerType> (makeNode<SummingNode> (std::move (nodes)));
+            player->setProcessingPrecision (ProcessingPrecision::doublePrecision);
+            player->prepareToPlay (testSetup.sampleRate, testSetup.blockSize);
+
+            expect (delayedSumNodePtr->isProcessingInDoublePrecision());
+            expect (latencyNodePtr->isProcessingInDoublePrecision());
+            expect (player->getNode().isProcessingInDoublePrecision());
+
+            auto testContext = createTestContext (std::move (player), testSetup, 1, 5.0);
+            test_utilities::expectAudioBuffer (*this, testContext->buffer, 0, numLatencySamples, 0.0f, 0.0f, 1.0f, 0.707f);
+        }
+    }
+
+    template<typename NodePlayerType>
     void runMidiTests (TestSetup testSetup)
     {
         const double sampleRate = 44100.0;
@@ -325,7 +428,7 @@ private:
         {
             auto node = std::make_unique<MidiNode> (sequence);
             
-            auto testContext = createBasicTestContext (std::move (node), testSetup, 1, duration);
+            auto testContext = createPlayerAndTestContext<NodePlayerType> (std::move (node), testSetup, 1, duration);
 
             expectGreaterThan (sequence.getNumEvents(), 0);
             test_utilities::expectMidiBuffer (*this, testContext->midi, sampleRate, sequence);
@@ -340,7 +443,7 @@ private:
             auto midiNode = std::make_unique<MidiNode> (sequence);
             auto delayedNode = makeNode<LatencyNode> (std::move (midiNode), latencyNumSamples);
 
-            auto testContext = createBasicTestContext (std::move (delayedNode), testSetup, 1, duration);
+            auto testContext = createPlayerAndTestContext<NodePlayerType> (std::move (delayedNode), testSetup, 1, duration);
             
             auto extectedSequence = sequence;
             extectedSequence.addTimeToMessages (delayedTime);
@@ -362,7 +465,7 @@ private:
             auto midiNode = makeNode<MidiNode> (sequence);
             auto summedNode = makeSummingNode ({ delayedNode.release(), midiNode.release() });
 
-            auto testContext = createBasicTestContext (std::move (summedNode), testSetup, 1, duration);
+            auto testContext = createPlayerAndTestContext<NodePlayerType> (std::move (summedNode), testSetup, 1, duration);
             
             auto extectedSequence = sequence;
             extectedSequence.addTimeToMessages (delayedTime);
@@ -382,7 +485,7 @@ private:
             
             auto sumNode = makeSummingNode ({ track1.release(), track2.release() });
 
-            auto testContext = createBasicTestContext (std::move (sumNode), testSetup, 1, duration);
+            auto testContext = createPlayerAndTestContext<NodePlayerType> (std::move (sumNode), testSetup, 1, duration);
 
             expectGreaterThan (sequence.getNumEvents(), 0);
             test_utilities::expectMidiBuffer (*this, testContext->midi, sampleRate, sequence);
@@ -401,20 +504,54 @@ private:
 
             auto sumNode = makeSummingNode ({ track1.release(), track2.release() });
 
-            auto testContext = createBasicTestContext (std::move (sumNode), testSetup, 1, duration);
+            auto testContext = createPlayerAndTestContext<NodePlayerType> (std::move (sumNode), testSetup, 1, duration);
 
             expectGreaterThan (sequence.getNumEvents(), 0);
             test_utilities::expectMidiBuffer (*this, testContext->midi, sampleRate, sequence);
         }
     }
     
+    template<typename NodePlayerType>
+    void runSubBlockTests (TestSetup testSetup)
+    {
+        beginTest ("Sin split in to sub-blocks");
+        {
+            auto splitNode = makeNode<SubBlockNode> (makeNode<SinNode> (220.0f), 100);
+            auto splitContext = createPlayerAndTestContext<NodePlayerType> (std::move (splitNode), testSetup, 1, 5.0);
+            test_utilities::expectAudioBuffer (*this, splitContext->buffer, 0, 1.0f, 0.707f);
+
+            // The output should be identical to processing whole blocks
+            auto testContext = createPlayerAndTestContext<NodePlayerType> (makeNode<SinNode> (220.0f), testSetup, 1, 5.0);
+            expectEquals (splitContext->buffer.getNumSamples(), testContext->buffer.getNumSamples());
+
+            float maxDifference = 0.0f;
+
+            for (int i = 0; i < testContext->buffer.getNumSamples(); ++i)
+                maxDifference = std::max (maxDifference, std::abs (splitContext->buffer.getSample (0, i) - testContext->buffer.getSample (0, i)));
+
+            expectEquals (maxDifference, 0.0f);
+        }
+
+        beginTest ("MIDI split in to sub-blocks");
+        {
+            const auto sequence = test_utilities::createRandomMidiMessageSequence (4.5, testSetup.random);
+            auto splitNode = makeNode<SubBlockNode> (makeNode<MidiNode> (sequence), 64);
+
+            auto testContext = createPlayerAndTestContext<NodePlayerType> (std::move (splitNode), testSetup, 1, 5.0);
+
+            expectGreaterThan (sequence.getNumEvents(), 0);
+            test_utilities::expectMidiBuffer (*this, testContext->midi, testSetup.sampleRate, sequence);
+        }
+    }
+
+    template<typename NodePlayerType>
     void runStereoTests (TestSetup testSetup)
     {
         beginTest ("Stereo sin");
         {
             auto node = makeNode<SinNode> (220.0f, 2);
 
-            auto testContext = createBasicTestContext (std::move (node), testSetup, 2, 5.0);
+            auto testContext = createPlayerAndTestContext<NodePlayerType> (std::move (node), testSetup, 2, 5.0);
             auto& buffer = testContext->buffer;
 
             expectWithinAbsoluteError (buffer.getMagnitude (0, 0, buffer.getNumSamples()), 1.0f, 0.001f);
@@ -435,7 +572,7 @@ private:
 
             expectEquals (node->getNodeProperties().numberOfChannels, 2);
 
-            auto testContext = createBasicTestContext (std::move (node), testSetup, 2, 5.0);
+            auto testContext = createPlayerAndTestContext<NodePlayerType> (std::move (node), testSetup, 2, 5.0);
             auto& buffer = testContext->buffer;
 
             for (int channel : { 0, 1 })
@@ -459,7 +596,7 @@ private:
 
             expectEquals (node->getNodeProperties().numberOfChannels, 1);
 
-            auto testContext = createBasicTestContext (std::move (node), testSetup, 1, 5.0);
+            auto testContext = createPlayerAndTestContext<NodePlayerType> (std::move (node), testSetup, 1, 5.0);
             auto& buffer = testContext->buffer;
 
             expectWithinAbsoluteError (buffer.getMagnitude (0, 0, buffer.getNumSamples()), 1.0f, 0.001f);
@@ -482,7 +619,7 @@ private:
 
             expectEquals (node->getNodeProperties().numberOfChannels, 1);
 
-            auto testContext = createBasicTestContext (std::move (node), testSetup, 1, 5.0);
+            auto testContext = createPlayerAndTestContext<NodePlayerType> (std::move (node), testSetup, 1, 5.0);
             auto& buffer = testContext->buffer;
 
             expectWithinAbsoluteError (buffer.getMagnitude (0, 0, buffer.getNumSamples()), 0.0f, 0.001f);
@@ -499,7 +636,7 @@ private:
 
             expectEquals (node->getNodeProperties().numberOfChannels, 6);
 
-            auto testContext = createBasicTestContext (std::move (node), testSetup, 6, 5.0);
+            auto testContext = createPlayerAndTestContext<NodePlayerType> (std::move (node), testSetup, 6, 5.0);
             auto& buffer = testContext->buffer;
 
             for (int channel : { 0, 1, 2, 3, 4, 5 })
@@ -510,13 +647,14 @@ private:
         }
     }
     
+    template<typename NodePlayerType>
     void runRebuildTests (TestSetup testSetup)
     {
         beginTest ("Sin rebuild");
         {
             const double totalDuration = 5.0;
             const int totalNumSamples = (int) std::floor (totalDuration * testSetup.sampleRate);
-            TestProcess<NodePlayer> playerContext (std::make_unique<NodePlayer> (std::make_unique<SinNode> (220.0f)),
+            TestProcess<NodePlayerType> playerContext (std::make_unique<NodePlayerType> (std::make_unique<SinNode> (220.0f)),
                                                    testSetup, 1, totalDuration);
             const int firstHalfNumSamples = totalNumSamples / 2;
             
@@ -551,7 +689,7 @@ private:
             const int totalNumSamples = (int) std::floor (totalDuration * testSetup.sampleRate);
             auto node = makeSinNode();
             const size_t expectedNodeID = node->getNodeProperties().nodeID;
-            TestProcess<NodePlayer> playerContext (std::make_unique<NodePlayer> (std::move (node)),
+            TestProcess<NodePlayerType> playerContext (std::make_unique<NodePlayerType> (std::move (node)),
                                                    testSetup, 1, totalDuration);
             const int firstHalfNumSamples = totalNumSamples / 2;
             
@@ -564,7 +702,7 @@ private:
             // Make a new sin node and switch that in to the test context
             node = makeSinNode();
             expectEquals (node->getNodeProperties().nodeID, expectedNodeID);
-            playerContext.setPlayer (std::make_unique<NodePlayer> (std::move (node)));
+            playerContext.setPlayer (std::make_unique<NodePlayerType> (std::move (node)));
             const int secondHalfNumSamples = totalNumSamples - firstHalfNumSamples;
             playerContext.process (secondHalfNumSamples);
             testContext = playerContext.getTestResult();
@@ -595,7 +733,7 @@ private:
             const int totalNumSamples = (int) std::floor (totalDuration * testSetup.sampleRate);
             auto node = makeSinNode();
             const size_t expectedNodeID = node->getNodeProperties().nodeID;
-            TestProcess<NodePlayer> playerContext (std::make_unique<NodePlayer> (std::move (node)),
+            TestProcess<NodePlayerType> playerContext (std::make_unique<NodePlayerType> (std::move (node)),
                                                    testSetup, 1, totalDuration);
             const int firstHalfNumSamples = totalNumSamples / 2;
             
@@ -618,8 +756,38 @@ private:
             test_utilities::expectAudioBuffer (*this, testContext->buffer, 0, latencyNumSamples,
                                                0.0f, 0.0f, 1.0f, 0.707f);
         }
+
+        beginTest ("Sin with latency rebuild, replacing multiple times");
+        {
+            // This sets several new nodes in a row before processing, only the last one should
+            // get played back but it should still inherit the latency buffer from the first
+            const int latencyNumSamples = (int) std::floor (testSetup.sampleRate / 2.0);
+            auto makeSinNode = [latencyNumSamples]
+            {
+                size_t nodeID = 1234;
+                return makeNode<LatencyNode> (makeNode<SinNode> (220.0f, 1, nodeID), latencyNumSamples);
+            };
+
+            const double totalDuration = 5.0;
+            const int totalNumSamples = (int) std::floor (totalDuration * testSetup.sampleRate);
+            TestProcess<NodePlayerType> playerContext (std::make_unique<NodePlayerType> (makeSinNode()),
+                                                   testSetup, 1, totalDuration);
+            const int firstHalfNumSamples = totalNumSamples / 2;
+            playerContext.process (firstHalfNumSamples);
+
+            for (int i = 0; i < 3; ++i)
+                playerContext.setNode (makeSinNode());
+
+            playerContext.process (totalNumSamples - firstHalfNumSamples);
+            auto testContext = playerContext.getTestResult();
+
+            expectEquals (testContext->buffer.getNumSamples(), totalNumSamples);
+            test_utilities::expectAudioBuffer (*this, testContext->buffer, 0, latencyNumSamples,
+                                               0.0f, 0.0f, 1.0f, 0.707f);
+        }
     }
-    
+
+    template<typename NodePlayerType>
     void runCycleTests (TestSetup testSetup)
     {
         beginTest ("Cycles");
@@ -640,7 +808,7 @@ private:
 
             expectEquals (node->getNodeProperties().numberOfChannels, 1);
 
-            auto testContext = createBasicTestContext (std::move (node), testSetup, 1, 5.0);
+            auto testContext = createPlayerAndTestContext<NodePlayerType> (std::move (node), testSetup, 1, 5.0);
             expectAudioBuffer (*this, testContext->buffer, 0, 1.0f, 0.707f);
         }
     }
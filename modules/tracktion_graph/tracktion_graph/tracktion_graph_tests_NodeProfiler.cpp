@@ -0,0 +1,80 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+
+namespace tracktion_graph
+{
+
+//==============================================================================
+//==============================================================================
+class NodeProfilerTests : public juce::UnitTest
+{
+public:
+    NodeProfilerTests()
+        : juce::UnitTest ("NodeProfiler", "tracktion_graph")
+    {
+    }
+
+    void runTest() override
+    {
+        beginTest ("Recording events");
+        {
+            NodeProfiler profiler (2, 4);
+            const auto ticksPerMicrosecond = juce::Time::getHighResolutionTicksPerSecond() / 1000000;
+
+            for (int i = 0; i < 6; ++i)
+                profiler.addEvent ({ "TestNode", 1234, (size_t) (i % 2), 0, 0, ticksPerMicrosecond * 3 });
+
+            std::vector<NodeProfiler::Event> events;
+            expectEquals (profiler.readEvents (events), 0);
+            expectEquals (events.size(), (size_t) 6);
+
+            // Each ring can only hold three events
+            for (int i = 0; i < 10; ++i)
+                profiler.addEvent ({ "TestNode", 1234, 0, 0, 0, 1 });
+
+            events.clear();
+            expectEquals (profiler.readEvents (events), 7);
+            expectEquals (events.size(), (size_t) 3);
+            expectEquals (profiler.readEvents (events), 0);
+        }
+
+        beginTest ("Statistics");
+        {
+            const auto ticksPerMicrosecond = juce::Time::getHighResolutionTicksPerSecond() / 1000000;
+            std::vector<NodeProfiler::Event> events;
+            events.push_back ({ "TestNode", 1, 0, 0, 0, ticksPerMicrosecond * 3 });
+            events.push_back ({ "TestNode", 1, 1, 0, ticksPerMicrosecond * 2, ticksPerMicrosecond * 12 });
+            events.push_back ({ "OtherNode", 2, 1, 0, 0, ticksPerMicrosecond });
+
+            NodeProfiler::Statistics stats;
+            stats.addEvents (events);
+            expectEquals (stats.nodes.size(), (size_t) 2);
+
+            auto& testNodeStats = stats.nodes[1];
+            expectEquals (testNodeStats.numCalls, 2);
+            expectWithinAbsoluteError (testNodeStats.maxProcessSeconds, 10.0e-6, 1.0e-7);
+            expectWithinAbsoluteError (testNodeStats.maxWaitSeconds, 2.0e-6, 1.0e-7);
+            expectEquals (testNodeStats.histogram[2], 1);
+            expectEquals (testNodeStats.histogram[4], 1);
+            expectEquals (testNodeStats.numCallsPerThread[0], 1);
+            expectEquals (testNodeStats.numCallsPerThread[1], 1);
+
+            auto json = NodeProfiler::createChromeTraceJSON (events);
+            auto parsed = juce::JSON::parse (json);
+            expectEquals (parsed["traceEvents"].size(), 3);
+            expectEquals (parsed["traceEvents"][0]["name"].toString(), juce::String ("TestNode"));
+        }
+    }
+};
+
+static NodeProfilerTests nodeProfilerTests;
+
+}
@@ -140,6 +140,214 @@ private:
             expectNodeOrder (allNodes, trimEndNodes (getNodes (*A, VertexOrdering::reversePostordering)),
                              { A, C, G, B, F, E, D });
         }
+
+        beginTest ("Graph plan");
+        {
+            GraphPlan plan (*A);
+            auto postorderedNodes = getNodes (*A, VertexOrdering::postordering);
+
+            expect (plan.nodes == postorderedNodes, "Plan not in postordering");
+            expect (&plan.getNode (plan.size() - 1) == A, "Root node not last");
+
+            auto getIndex = [&] (Node* node)
+            {
+                return (size_t) std::distance (plan.nodes.begin(), std::find (plan.nodes.begin(), plan.nodes.end(), node));
+            };
+
+            auto getPlanNodes = [&] (GraphPlan::IndexRange indices)
+            {
+                std::vector<Node*> nodes;
+
+                for (auto index : indices)
+                    nodes.push_back (&plan.getNode (index));
+
+                return nodes;
+            };
+
+            expectNodeOrder (allNodes, getPlanNodes (plan.getInputs (getIndex (A))), { B, C, E });
+            expectNodeOrder (allNodes, getPlanNodes (plan.getInputs (getIndex (B))), { D, F });
+            expectNodeOrder (allNodes, trimEndNodes (getPlanNodes (plan.getOutputs (getIndex (E)))), { A });
+            expect (plan.getInputs (getIndex (D)).empty());
+
+            size_t numIndicesOnLevels = 0;
+
+            for (size_t level = 0; level < plan.getNumLevels(); ++level)
+            {
+                numIndicesOnLevels += plan.getNodesOnLevel (level).size();
+                expect (plan.getNodesOnLevel (level).size() <= plan.getMaxLevelWidth());
+
+                for (auto index : plan.getNodesOnLevel (level))
+                {
+                    expectEquals (plan.levels[index], level);
+
+                    for (auto inputIndex : plan.getInputs (index))
+                    {
+                        expect (inputIndex < index, "Input doesn't precede Node");
+                        expect (plan.levels[inputIndex] < level, "Input not on a lower level");
+                    }
+                }
+            }
+
+            expectEquals (numIndicesOnLevels, plan.size());
+            expectEquals (plan.levels[getIndex (D)], (size_t) 0);
+            expectEquals (plan.levels[getIndex (A)], plan.getNumLevels() - 1);
+        }
+
+        beginTest ("Graph plan buffer assignment");
+        {
+            GraphPlan plan (*A);
+
+            for (bool processedSequentially : { true, false })
+            {
+                auto assignment = plan.createBufferAssignment (processedSequentially);
+                expectEquals (assignment.slotForNode.size(), plan.size());
+                expect (assignment.getNumSlots() < plan.size(), "No buffers shared");
+
+                for (size_t i = 0; i < plan.size(); ++i)
+                {
+                    const auto slot = assignment.slotForNode[i];
+                    expect (assignment.numChannelsForSlot[slot] >= plan.getNode (i).getNodeProperties().numberOfChannels);
+
+                    for (auto inputIndex : plan.getInputs (i))
+                        expect (assignment.slotForNode[inputIndex] != slot, "Node shares a buffer with its input");
+
+                    // Nothing else can use the root's buffer as it's read after processing
+                    if (i != plan.size() - 1)
+                        expect (assignment.slotForNode[plan.size() - 1] != slot, "Node shares a buffer with the root");
+                }
+            }
+        }
+
+        beginTest ("Graph plan in-place processing");
+        {
+            auto latencyNode = makeNode<LatencyNode> (makeNode<LatencyNode> (makeNode<SinNode> (220.0f), 10), 20);
+            auto& root = *latencyNode;
+            transformNodes (root);
+
+            for (auto n : getNodes (root, VertexOrdering::postordering))
+                n->initialise ({ 44100.0, 512, root });
+
+            GraphPlan plan (root);
+            expectEquals (plan.size(), (size_t) 3);
+
+            for (bool processedSequentially : { true, false })
+            {
+                auto assignment = plan.createBufferAssignment (processedSequentially);
+                expectEquals (assignment.getNumSlots(), (size_t) 1);
+                expect (! assignment.processesInPlace[0]);
+                expect (assignment.processesInPlace[1]);
+                expect (assignment.processesInPlace[2]);
+            }
+        }
+
+        beginTest ("Graph plan NUMA partition");
+        {
+            std::vector<std::unique_ptr<Node>> tracks;
+
+            for (int i = 0; i < 4; ++i)
+                tracks.push_back (makeNode<FunctionNode> (makeNode<SinNode> (220.0f * (i + 1)), [] (float s) { return s * 0.5f; }));
+
+            auto sumNode = makeNode<FunctionNode> (makeNode<BasicSummingNode> (std::move (tracks)), [] (float s) { return s; });
+            auto& root = *sumNode;
+            transformNodes (root);
+
+            for (auto n : getNodes (root, VertexOrdering::postordering))
+                n->initialise ({ 44100.0, 512, root });
+
+            GraphPlan plan (root);
+            expectEquals (plan.size(), (size_t) 10);
+
+            auto domainForNode = plan.createNumaPartition (2);
+            expectEquals (domainForNode.size(), plan.size());
+
+            // The summing chain isn't in a domain, each track is wholly in one and they're balanced
+            expectEquals (domainForNode[plan.size() - 1], -1);
+            expectEquals (domainForNode[plan.size() - 2], -1);
+            int numNodesInDomain[2] = {};
+
+            for (size_t i = 0; i + 2 < plan.size(); ++i)
+            {
+                expect (domainForNode[i] == 0 || domainForNode[i] == 1);
+
+                for (auto inputIndex : plan.getInputs (i))
+                    expectEquals (domainForNode[inputIndex], domainForNode[i]);
+
+                if (domainForNode[i] >= 0)
+                    ++numNodesInDomain[domainForNode[i]];
+            }
+
+            expectEquals (numNodesInDomain[0], 4);
+            expectEquals (numNodesInDomain[1], 4);
+
+            auto assignment = plan.createBufferAssignment (false, domainForNode);
+            expectEquals (assignment.domainForSlot.size(), assignment.getNumSlots());
+
+            for (size_t i = 0; i < plan.size(); ++i)
+                expectEquals (assignment.domainForSlot[assignment.slotForNode[i]], domainForNode[i]);
+
+            // A single domain leaves the graph as it is
+            for (auto domain : plan.createNumaPartition (1))
+                expectEquals (domain, -1);
+        }
+
+        beginTest ("Shared latency compensation");
+        {
+            /* S is summed with a 100 sample latency input in sum1 and sum2 and a 150 sample
+               latency input in sum3. Only one 100 sample delay line for S should be created
+               with a further 50 samples added on to it for sum3.
+            */
+            auto s = makeNode<SinNode> (220.0f);
+            auto S = s.get();
+
+            auto makeLatentSumNode = [S] (int latencyNumSamples, std::unique_ptr<Node> ownedInput)
+            {
+                std::vector<std::unique_ptr<Node>> ownedNodes;
+                ownedNodes.push_back (makeNode<LatencyNode> (makeNode<SinNode> (440.0f), latencyNumSamples));
+                std::vector<Node*> referencedNodes;
+
+                if (ownedInput != nullptr)
+                    ownedNodes.push_back (std::move (ownedInput));
+                else
+                    referencedNodes.push_back (S);
+
+                return makeNode<SummingNode> (std::move (ownedNodes), std::move (referencedNodes));
+            };
+
+            std::vector<std::unique_ptr<Node>> sumNodes;
+            sumNodes.push_back (makeLatentSumNode (100, {}));
+            sumNodes.push_back (makeLatentSumNode (100, std::move (s)));
+            sumNodes.push_back (makeLatentSumNode (150, {}));
+            auto root = makeNode<SummingNode> (std::move (sumNodes));
+
+            transformNodes (*root);
+            expectEquals (root->getNodeProperties().latencyNumSamples, 150);
+
+            auto getLatencyNodesFor = [&] (Node* input)
+            {
+                std::vector<LatencyNode*> latencyNodes;
+
+                for (auto n : getNodes (*root, VertexOrdering::postordering))
+                    if (auto latencyNode = dynamic_cast<LatencyNode*> (n))
+                        if (latencyNode->getInputNode() == input)
+                            latencyNodes.push_back (latencyNode);
+
+                return latencyNodes;
+            };
+
+            auto sDelays = getLatencyNodesFor (S);
+            expectEquals (sDelays.size(), (size_t) 1);
+
+            if (sDelays.size() == 1)
+            {
+                expectEquals (sDelays[0]->getNumSamplesToDelay(), 100);
+
+                auto chainedDelays = getLatencyNodesFor (sDelays[0]);
+                expectEquals (chainedDelays.size(), (size_t) 1);
+
+                if (chainedDelays.size() == 1)
+                    expectEquals (chainedDelays[0]->getNumSamplesToDelay(), 50);
+            }
+        }
     }
     
     static std::string getNodeLetter (const std::vector<Node*>& nodes, Node* node)
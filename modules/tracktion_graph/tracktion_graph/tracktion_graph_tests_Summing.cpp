@@ -0,0 +1,166 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+
+namespace tracktion_graph
+{
+
+//==============================================================================
+//==============================================================================
+class AudioSummingTests : public juce::UnitTest
+{
+public:
+    AudioSummingTests()
+        : juce::UnitTest ("AudioSumming", "tracktion_graph")
+    {
+    }
+
+    void runTest() override
+    {
+        for (int numSources : { 1, 3, 4, 7, 16 })
+            for (int numSamples : { 1, 7, 64, 509 })
+                runKernelTests (numSources, numSamples);
+    }
+
+private:
+    //==============================================================================
+    struct Sources
+    {
+        Sources (juce::Random& r, int numSources, int numSamples)
+            : buffer (numSources, numSamples + 1)
+        {
+            for (int c = 0; c < numSources; ++c)
+                for (int i = 0; i < buffer.getNumSamples(); ++i)
+                    buffer.setSample (c, i, r.nextFloat() * 2.0f - 1.0f);
+
+            // Offset the channels by one sample to check unaligned access
+            for (int c = 0; c < numSources; ++c)
+                channels.push_back (buffer.getReadPointer (c, 1));
+        }
+
+        juce::AudioBuffer<float> buffer;
+        std::vector<const float*> channels;
+    };
+
+    void runKernelTests (int numSources, int numSamples)
+    {
+        beginTest ("Summing kernels, sources: " + juce::String (numSources) + ", samples: " + juce::String (numSamples));
+        {
+            Sources sources (getRandom(), numSources, numSamples);
+            std::vector<double> expected ((size_t) numSamples, 0.5);
+
+            for (auto channel : sources.channels)
+                for (size_t i = 0; i < expected.size(); ++i)
+                    expected[i] += (double) channel[i];
+
+            std::vector<float> floatDest ((size_t) numSamples, 0.5f);
+            audio_summing::addSources (floatDest.data(), sources.channels.data(), sources.channels.size(), (size_t) numSamples);
+
+            std::vector<double> doubleDest ((size_t) numSamples, 0.5);
+            audio_summing::addSources (doubleDest.data(), sources.channels.data(), sources.channels.size(), (size_t) numSamples);
+
+            for (size_t i = 0; i < expected.size(); ++i)
+            {
+                expectWithinAbsoluteError ((double) floatDest[i], expected[i], 1.0e-5);
+                expectWithinAbsoluteError (doubleDest[i], expected[i], 1.0e-12);
+            }
+        }
+    }
+};
+
+static AudioSummingTests audioSummingTests;
+
+
+//==============================================================================
+//==============================================================================
+/**
+    Compares the summing kernels with summing each source in turn with AudioBlock::add.
+    This is in the tracktion_graph_performance category so isn't run with the other tests.
+*/
+class AudioSummingBenchmarks : public juce::UnitTest
+{
+public:
+    AudioSummingBenchmarks()
+        : juce::UnitTest ("AudioSumming benchmarks", "tracktion_graph_performance")
+    {
+    }
+
+    void runTest() override
+    {
+        for (int numSources : { 2, 8, 32, 128 })
+            runBenchmark (numSources, 512);
+    }
+
+private:
+    template<typename Function>
+    double timeInMicroseconds (int numIterations, Function&& f)
+    {
+        const auto start = juce::Time::getMillisecondCounterHiRes();
+
+        for (int i = 0; i < numIterations; ++i)
+            f();
+
+        return (juce::Time::getMillisecondCounterHiRes() - start) * 1000.0 / numIterations;
+    }
+
+    void runBenchmark (int numSources, int numSamples)
+    {
+        beginTest ("Summing benchmark, sources: " + juce::String (numSources));
+        {
+            juce::AudioBuffer<float> sourceBuffer (numSources, numSamples);
+            std::vector<const float*> sourceChannels;
+
+            for (int c = 0; c < numSources; ++c)
+            {
+                juce::FloatVectorOperations::fill (sourceBuffer.getWritePointer (c), 1.0f / (float) (c + 1), numSamples);
+                sourceChannels.push_back (sourceBuffer.getReadPointer (c));
+            }
+
+            juce::AudioBuffer<float> destBuffer (1, numSamples);
+            std::vector<double> doubleSum ((size_t) numSamples);
+            auto dest = destBuffer.getWritePointer (0);
+            const int numIterations = 20000;
+
+            const auto blockAddTime = timeInMicroseconds (numIterations, [&]
+            {
+                juce::dsp::AudioBlock<float> destBlock (destBuffer);
+                destBlock.clear();
+
+                for (int c = 0; c < numSources; ++c)
+                    destBlock.add (juce::dsp::AudioBlock<float> (sourceBuffer).getSingleChannelBlock ((size_t) c));
+            });
+
+            const auto kernelTime = timeInMicroseconds (numIterations, [&]
+            {
+                juce::FloatVectorOperations::clear (dest, numSamples);
+                audio_summing::addSources (dest, sourceChannels.data(), sourceChannels.size(), (size_t) numSamples);
+            });
+
+            const auto doubleKernelTime = timeInMicroseconds (numIterations, [&]
+            {
+                std::fill (doubleSum.begin(), doubleSum.end(), 0.0);
+                audio_summing::addSources (doubleSum.data(), sourceChannels.data(), sourceChannels.size(), (size_t) numSamples);
+                juce::FloatVectorOperations::clear (dest, numSamples);
+                audio_summing::addDoubleToFloat (dest, doubleSum.data(), (size_t) numSamples);
+            });
+
+            logMessage (juce::String ("AudioBlock::add: X us, kernel: Y us, double kernel: Z us")
+                        .replace ("X", juce::String (blockAddTime, 3))
+                        .replace ("Y", juce::String (kernelTime, 3))
+                        .replace ("Z", juce::String (doubleKernelTime, 3)));
+
+            expect (kernelTime > 0.0);
+        }
+    }
+};
+
+static AudioSummingBenchmarks audioSummingBenchmarks;
+
+}
@@ -304,6 +304,67 @@ static inline std::unique_ptr<Node> makeGainNode (std::unique_ptr<Node> input, f
 }
 
 
+//==============================================================================
+//==============================================================================
+/** Passes its input through but asks for blocks to be split every few samples. */
+class SubBlockNode : public Node
+{
+public:
+    SubBlockNode (std::unique_ptr<Node> input, int numSamplesPerSubBlockToUse)
+        : node (std::move (input)),
+          numSamplesPerSubBlock (numSamplesPerSubBlockToUse)
+    {
+        jassert (numSamplesPerSubBlock > 0);
+    }
+
+    NodeProperties getNodeProperties() override
+    {
+        return node->getNodeProperties();
+    }
+
+    std::vector<Node*> getDirectInputNodes() override
+    {
+        return { node.get() };
+    }
+
+    bool isReadyToProcess() override
+    {
+        return node->hasProcessed();
+    }
+
+    bool needsSubBlockBoundaries() override
+    {
+        return true;
+    }
+
+    void addSubBlockBoundaries (juce::Range<int64_t> streamSampleRange, std::vector<int64_t>& boundaries) override
+    {
+        // Split on multiples of the sub-block size so the boundaries don't depend on the block size
+        for (auto b = (streamSampleRange.getStart() / numSamplesPerSubBlock + 1) * numSamplesPerSubBlock;
+             b < streamSampleRange.getEnd(); b += numSamplesPerSubBlock)
+            boundaries.push_back (b);
+    }
+
+    void process (const ProcessContext& pc) override
+    {
+        auto inputBuffers = node->getProcessedOutput();
+        jassert (inputBuffers.audio.getNumSamples() == pc.buffers.audio.getNumSamples());
+        jassert (pc.streamSampleRange.getLength() <= numSamplesPerSubBlock);
+
+        const auto numChannels = std::min (inputBuffers.audio.getNumChannels(), pc.buffers.audio.getNumChannels());
+
+        if (numChannels > 0)
+            pc.buffers.audio.getSubsetChannelBlock (0, numChannels).copyFrom (inputBuffers.audio.getSubsetChannelBlock (0, numChannels));
+
+        pc.buffers.midi.copyFrom (inputBuffers.midi);
+    }
+
+private:
+    std::unique_ptr<Node> node;
+    const int numSamplesPerSubBlock;
+};
+
+
 //==============================================================================
 //==============================================================================
 class SendNode : public Node
@@ -364,11 +364,18 @@ namespace test_utilities
         return TestProcess<NodeProcessorType> (std::move (processor), ts, numChannels, durationInSeconds).processAll();
     }
 
+    template<typename NodePlayerType>
+    static inline std::shared_ptr<TestContext> createPlayerAndTestContext (std::unique_ptr<Node> node, const TestSetup ts,
+                                                                           const int numChannels, const double durationInSeconds)
+    {
+        auto player = std::make_unique<NodePlayerType> (std::move (node));
+        return createTestContext (std::move (player), ts, numChannels, durationInSeconds);
+    }
+
     static inline std::shared_ptr<TestContext> createBasicTestContext (std::unique_ptr<Node> node, const TestSetup ts,
                                                                        const int numChannels, const double durationInSeconds)
     {
-        auto player = std::make_unique<NodePlayer> (std::move (node));
-        return createTestContext (std::move (player), ts, numChannels, durationInSeconds);
+        return createPlayerAndTestContext<NodePlayer> (std::move (node), ts, numChannels, durationInSeconds);
     }
 }
 
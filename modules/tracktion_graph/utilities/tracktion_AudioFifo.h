@@ -12,12 +12,14 @@ namespace tracktion_graph
 {
 
 //==============================================================================
-/**
+/** A multi-channel FIFO of float or double samples.
+    @see AudioFifo, AudioFifo64
 */
-class AudioFifo
+template<typename SampleType>
+class BasicAudioFifo
 {
 public:
-    AudioFifo (int channels, int numSamples)
+    BasicAudioFifo (int channels, int numSamples)
         : fifo (numSamples), buffer (channels, numSamples)
     {
     }
@@ -45,7 +47,7 @@ public:
         }
     }
 
-    bool write (juce::dsp::AudioBlock<float> block)
+    bool write (juce::dsp::AudioBlock<SampleType> block)
     {
         jassert (buffer.getNumChannels() <= (int) block.getNumChannels());
         int numSamples = (int) block.getNumSamples();
@@ -84,7 +86,7 @@ public:
         return true;
     }
 
-    bool readAdding (const juce::dsp::AudioBlock<float>& dest)
+    bool readAdding (const juce::dsp::AudioBlock<SampleType>& dest)
     {
         jassert ((int) dest.getNumChannels() == buffer.getNumChannels());
         const int numSamples = (int) dest.getNumSamples();
@@ -94,7 +96,7 @@ public:
         if ((size1 + size2) < numSamples)
             return false;
 
-        juce::dsp::AudioBlock<float> sourceBlock (buffer);
+        juce::dsp::AudioBlock<SampleType> sourceBlock (buffer);
         dest.add (sourceBlock.getSubBlock ((size_t) start1, (size_t) size1));
 
         if (size2 > 0)
@@ -106,9 +108,12 @@ public:
 
 private:
     juce::AbstractFifo fifo;
-    juce::AudioBuffer<float> buffer;
+    juce::AudioBuffer<SampleType> buffer;
 
-    JUCE_DECLARE_NON_COPYABLE (AudioFifo)
+    JUCE_DECLARE_NON_COPYABLE (BasicAudioFifo)
 };
 
+using AudioFifo = BasicAudioFifo<float>;
+using AudioFifo64 = BasicAudioFifo<double>;
+
 } // namespace tracktion_graph
@@ -0,0 +1,157 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+#pragma once
+
+#if JUCE_INTEL
+ #include <immintrin.h>
+#elif JUCE_ARM && defined (__ARM_NEON)
+ #include <arm_neon.h>
+#endif
+
+namespace tracktion_graph
+{
+
+//==============================================================================
+/**
+    Kernels for summing a number of source channels in to a destination channel.
+
+    These sum up to four sources per pass over the destination which means the
+    destination only has to be loaded and stored once for every four sources.
+    AVX, SSE or NEON are used when available, otherwise this falls back to scalar code.
+    The sources must not alias the destination.
+*/
+namespace audio_summing
+{
+    namespace detail
+    {
+        inline void addFour (float* dest, const float* s0, const float* s1, const float* s2, const float* s3, size_t numSamples) noexcept
+        {
+            size_t i = 0;
+
+           #if JUCE_INTEL && defined (__AVX__)
+            for (; i + 8 <= numSamples; i += 8)
+            {
+                auto sum = _mm256_add_ps (_mm256_add_ps (_mm256_loadu_ps (s0 + i), _mm256_loadu_ps (s1 + i)),
+                                          _mm256_add_ps (_mm256_loadu_ps (s2 + i), _mm256_loadu_ps (s3 + i)));
+                _mm256_storeu_ps (dest + i, _mm256_add_ps (_mm256_loadu_ps (dest + i), sum));
+            }
+           #endif
+
+           #if JUCE_INTEL
+            for (; i + 4 <= numSamples; i += 4)
+            {
+                auto sum = _mm_add_ps (_mm_add_ps (_mm_loadu_ps (s0 + i), _mm_loadu_ps (s1 + i)),
+                                       _mm_add_ps (_mm_loadu_ps (s2 + i), _mm_loadu_ps (s3 + i)));
+                _mm_storeu_ps (dest + i, _mm_add_ps (_mm_loadu_ps (dest + i), sum));
+            }
+           #elif JUCE_ARM && defined (__ARM_NEON)
+            for (; i + 4 <= numSamples; i += 4)
+            {
+                auto sum = vaddq_f32 (vaddq_f32 (vld1q_f32 (s0 + i), vld1q_f32 (s1 + i)),
+                                      vaddq_f32 (vld1q_f32 (s2 + i), vld1q_f32 (s3 + i)));
+                vst1q_f32 (dest + i, vaddq_f32 (vld1q_f32 (dest + i), sum));
+            }
+           #endif
+
+            for (; i < numSamples; ++i)
+                dest[i] += (s0[i] + s1[i]) + (s2[i] + s3[i]);
+        }
+
+        inline void addOne (float* dest, const float* s0, size_t numSamples) noexcept
+        {
+            size_t i = 0;
+
+           #if JUCE_INTEL
+            for (; i + 4 <= numSamples; i += 4)
+                _mm_storeu_ps (dest + i, _mm_add_ps (_mm_loadu_ps (dest + i), _mm_loadu_ps (s0 + i)));
+           #elif JUCE_ARM && defined (__ARM_NEON)
+            for (; i + 4 <= numSamples; i += 4)
+                vst1q_f32 (dest + i, vaddq_f32 (vld1q_f32 (dest + i), vld1q_f32 (s0 + i)));
+           #endif
+
+            for (; i < numSamples; ++i)
+                dest[i] += s0[i];
+        }
+
+        inline void addFour (double* dest, const float* s0, const float* s1, const float* s2, const float* s3, size_t numSamples) noexcept
+        {
+            for (size_t i = 0; i < numSamples; ++i)
+                dest[i] += ((double) s0[i] + (double) s1[i]) + ((double) s2[i] + (double) s3[i]);
+        }
+
+        inline void addOne (double* dest, const float* s0, size_t numSamples) noexcept
+        {
+            for (size_t i = 0; i < numSamples; ++i)
+                dest[i] += (double) s0[i];
+        }
+
+        inline void addFour (double* dest, const double* s0, const double* s1, const double* s2, const double* s3, size_t numSamples) noexcept
+        {
+            for (size_t i = 0; i < numSamples; ++i)
+                dest[i] += (s0[i] + s1[i]) + (s2[i] + s3[i]);
+        }
+
+        inline void addOne (double* dest, const double* s0, size_t numSamples) noexcept
+        {
+            for (size_t i = 0; i < numSamples; ++i)
+                dest[i] += s0[i];
+        }
+    }
+
+    //==============================================================================
+    /** Adds a number of source channels to a destination channel.
+        The destination can either be a float or a double channel, the latter giving
+        higher precision when summing a lot of sources. Double sources can only be
+        added to a double destination.
+    */
+    template<typename DestType, typename SourceType>
+    inline void addSources (DestType* dest, const SourceType* const* sources, size_t numSources, size_t numSamples) noexcept
+    {
+        size_t sourceIndex = 0;
+
+        for (; sourceIndex + 4 <= numSources; sourceIndex += 4)
+            detail::addFour (dest, sources[sourceIndex], sources[sourceIndex + 1],
+                             sources[sourceIndex + 2], sources[sourceIndex + 3], numSamples);
+
+        for (; sourceIndex < numSources; ++sourceIndex)
+            detail::addOne (dest, sources[sourceIndex], numSamples);
+    }
+
+    /** Adds a double channel to a float channel, used to write back a double precision sum. */
+    inline void addDoubleToFloat (float* dest, const double* source, size_t numSamples) noexcept
+    {
+        for (size_t i = 0; i < numSamples; ++i)
+            dest[i] += (float) source[i];
+    }
+
+    /** Copies a channel to one of a different precision, replacing its contents. */
+    template<typename DestType, typename SourceType>
+    inline void convert (DestType* dest, const SourceType* source, size_t numSamples) noexcept
+    {
+        for (size_t i = 0; i < numSamples; ++i)
+            dest[i] = static_cast<DestType> (source[i]);
+    }
+
+    /** Copies the channels of one block to another of a different precision.
+        Like AudioBlock::copyFrom, this only copies as many channels and samples as both have.
+    */
+    template<typename DestType, typename SourceType>
+    inline void convert (const juce::dsp::AudioBlock<DestType>& dest, const juce::dsp::AudioBlock<SourceType>& source) noexcept
+    {
+        const auto numChannels = std::min (dest.getNumChannels(), source.getNumChannels());
+        const auto numSamples = std::min (dest.getNumSamples(), source.getNumSamples());
+
+        for (size_t channel = 0; channel < numChannels; ++channel)
+            convert (dest.getChannelPointer (channel), source.getChannelPointer (channel), numSamples);
+    }
+}
+
+} // namespace tracktion_graph
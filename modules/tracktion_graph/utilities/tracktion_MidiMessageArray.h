@@ -38,74 +38,78 @@ struct MidiMessageArray
         MPESourceID mpeSourceID = 0;
     };
 
-    bool isEmpty() const noexcept                                   { return messages.isEmpty(); }
-    bool isNotEmpty() const noexcept                                { return ! messages.isEmpty(); }
+    /** The number of messages Nodes reserve space for when they're initialised. */
+    static constexpr int defaultNumMessagesToReserve = 512;
 
-    int size() const noexcept                                       { return messages.size(); }
-    MidiMessageWithSource& operator[] (int i)                       { return messages.getReference (i); }
-    const MidiMessageWithSource& operator[] (int i) const           { return messages.getReference (i); }
+    bool isEmpty() const noexcept                                   { return messages.empty(); }
+    bool isNotEmpty() const noexcept                                { return ! messages.empty(); }
 
-    MidiMessageWithSource* begin() noexcept                         { return messages.begin(); }
-    const MidiMessageWithSource* begin() const noexcept             { return messages.begin(); }
-    MidiMessageWithSource* end() noexcept                           { return messages.end(); }
-    const MidiMessageWithSource* end() const noexcept               { return messages.end(); }
+    int size() const noexcept                                       { return (int) messages.size(); }
+    MidiMessageWithSource& operator[] (int i)                       { return messages[(size_t) i]; }
+    const MidiMessageWithSource& operator[] (int i) const           { return messages[(size_t) i]; }
 
-    void remove (int index)                                         { messages.remove (index); }
+    MidiMessageWithSource* begin() noexcept                         { return messages.data(); }
+    const MidiMessageWithSource* begin() const noexcept             { return messages.data(); }
+    MidiMessageWithSource* end() noexcept                           { return messages.data() + messages.size(); }
+    const MidiMessageWithSource* end() const noexcept               { return messages.data() + messages.size(); }
+
+    void remove (int index)                                         { messages.erase (messages.begin() + index); }
 
     void swapWith (MidiMessageArray& other) noexcept
     {
         std::swap (isAllNotesOff, other.isAllNotesOff);
-        messages.swapWith (other.messages);
+        messages.swap (other.messages);
     }
 
+    /** Removes all the messages but keeps the storage so adding messages again won't allocate. */
     void clear() noexcept
     {
         isAllNotesOff = false;
-        messages.clearQuick();
+        messages.clear();
     }
 
     void addMidiMessage (const juce::MidiMessage& m, MPESourceID mpeSourceID)
     {
-        messages.add ({ m, mpeSourceID });
+        messages.push_back ({ m, mpeSourceID });
     }
 
     void addMidiMessage (juce::MidiMessage&& m, MPESourceID mpeSourceID)
     {
-        messages.add ({ std::move (m), mpeSourceID });
+        messages.push_back ({ std::move (m), mpeSourceID });
     }
 
     void addMidiMessage (const juce::MidiMessage& m, double time, MPESourceID mpeSourceID)
     {
-        messages.add ({ m, mpeSourceID });
-        messages.getReference (messages.size() - 1).setTimeStamp (time);
+        messages.push_back ({ m, mpeSourceID });
+        messages.back().setTimeStamp (time);
     }
 
     void addMidiMessage (juce::MidiMessage&& m, double time, MPESourceID mpeSourceID)
     {
-        messages.add ({ std::move (m), mpeSourceID });
-        messages.getReference (messages.size() - 1).setTimeStamp (time);
+        messages.push_back ({ std::move (m), mpeSourceID });
+        messages.back().setTimeStamp (time);
     }
 
     void add (const MidiMessageWithSource& m)
     {
-        messages.add (m);
+        messages.push_back (m);
     }
 
     void add (MidiMessageWithSource&& m)
     {
-        messages.add (std::move (m));
+        messages.push_back (std::move (m));
     }
 
     void add (const MidiMessageWithSource& m, double time)
     {
-        messages.add (m);
-        messages.getReference (messages.size() - 1).setTimeStamp (time);
+        messages.push_back (m);
+        messages.back().setTimeStamp (time);
     }
 
     void add (MidiMessageWithSource&& m, double time)
     {
-        messages.add (std::move (m));
-        messages.getReference (messages.size() - 1).setTimeStamp (time);
+        messages.push_back (std::move (m));
+        messages.back().setTimeStamp (time);
     }
 
     void copyFrom (const MidiMessageArray& source)
@@ -121,10 +125,10 @@ struct MidiMessageArray
         if (source.isEmpty())
             return;
 
-        messages.ensureStorageAllocated (messages.size() + source.size());
+        ensureCapacity (messages.size() + (size_t) source.size());
 
         for (auto& m : source)
-            messages.add (m);
+            messages.push_back (m);
     }
     
     void mergeFromWithOffset (const MidiMessageArray& source, double delta)
@@ -134,12 +138,12 @@ struct MidiMessageArray
         if (source.isEmpty())
             return;
 
-        messages.ensureStorageAllocated (messages.size() + source.size());
+        ensureCapacity (messages.size() + (size_t) source.size());
 
         for (auto& m : source)
         {
-            messages.add (m);
-            messages.getReference (messages.size() - 1).addToTimeStamp (delta);
+            messages.push_back (m);
+            messages.back().addToTimeStamp (delta);
         }
     }
 
@@ -152,10 +156,10 @@ struct MidiMessageArray
         else
         {
             isAllNotesOff = isAllNotesOff || source.isAllNotesOff;
-            messages.ensureStorageAllocated (messages.size() + source.size());
+            ensureCapacity (messages.size() + (size_t) source.size());
 
             for (auto& m : source)
-                messages.add (std::move (m));
+                messages.push_back (std::move (m));
 
             source.clear();
         }
@@ -171,12 +175,12 @@ struct MidiMessageArray
         else
         {
             isAllNotesOff = isAllNotesOff || source.isAllNotesOff;
-            messages.ensureStorageAllocated (messages.size() + source.size());
+            ensureCapacity (messages.size() + (size_t) source.size());
 
             for (auto& m : source)
             {
-                messages.add (std::move (m));
-                messages.getReference (messages.size() - 1).addToTimeStamp (delta);
+                messages.push_back (std::move (m));
+                messages.back().addToTimeStamp (delta);
             }
 
             source.clear();
@@ -189,20 +193,20 @@ struct MidiMessageArray
             return mergeFromAndClearWithOffset (source, delta);
 
         isAllNotesOff = isAllNotesOff || source.isAllNotesOff;
-        messages.ensureStorageAllocated (messages.size() + numItemsToTake);
+        ensureCapacity (messages.size() + (size_t) numItemsToTake);
 
         for (int i = 0; i < numItemsToTake; ++i)
         {
-            messages.add (std::move (source.messages.getReference(i)));
-            messages.getReference (messages.size() - 1).addToTimeStamp (delta);
+            messages.push_back (std::move (source.messages[(size_t) i]));
+            messages.back().addToTimeStamp (delta);
         }
 
-        source.messages.removeRange (0, numItemsToTake);
+        source.messages.erase (source.messages.begin(), source.messages.begin() + numItemsToTake);
     }
 
     void mergeFromAndClear (juce::Array<juce::MidiMessage>& source, MPESourceID mpeSourceID)
     {
-        messages.ensureStorageAllocated (messages.size() + source.size());
+        ensureCapacity (messages.size() + (size_t) source.size());
 
         for (auto& m : source)
             addMidiMessage (m, mpeSourceID);
@@ -212,9 +216,9 @@ struct MidiMessageArray
 
     void removeNoteOnsAndOffs()
     {
-        for (int i = messages.size(); --i >= 0;)
-            if (messages.getReference (i).isNoteOnOrOff())
-                messages.remove (i);
+        messages.erase (std::remove_if (messages.begin(), messages.end(),
+                                        [] (const MidiMessageWithSource& m) { return m.isNoteOnOrOff(); }),
+                        messages.end());
     }
 
     void addToTimestamps (double delta) noexcept
@@ -241,15 +245,31 @@ struct MidiMessageArray
                    [] (const juce::MidiMessage& a, const juce::MidiMessage& b) { return a.getTimeStamp() < b.getTimeStamp(); });
     }
 
+    /** Allocates space for a number of messages.
+        Short messages are stored inline so as long as the number of messages stays
+        below this capacity, adding, merging and removing them won't allocate.
+        Only sysex messages will still need to allocate when copied.
+    */
     void reserve (int size)
     {
-        messages.ensureStorageAllocated (size);
+        messages.reserve ((size_t) std::max (0, size));
     }
 
+    /** Returns the number of messages that can be held without allocating. */
+    int getCapacity() const noexcept                                { return (int) messages.capacity(); }
+
     bool isAllNotesOff = false;
 
 private:
-    juce::Array<MidiMessageWithSource> messages;
+    // std::vector never shrinks its storage when elements are removed, unlike juce::Array
+    std::vector<MidiMessageWithSource> messages;
+
+    void ensureCapacity (size_t numMessages)
+    {
+        // Grow geometrically so repeatedly merging in to an array that's too small doesn't reallocate every time
+        if (numMessages > messages.capacity())
+            messages.reserve (std::max (numMessages, messages.capacity() * 2));
+    }
 };
 
 } // namespace tracktion_engine
@@ -0,0 +1,182 @@
+/*
+    ,--.                     ,--.     ,--.  ,--.
+  ,-'  '-.,--.--.,--,--.,---.|  |,-.,-'  '-.`--' ,---. ,--,--,      Copyright 2018
+  '-.  .-'|  .--' ,-.  | .--'|     /'-.  .-',--.| .-. ||      \   Tracktion Software
+    |  |  |  |  \ '-'  \ `--.|  \  \  |  |  |  |' '-' '|  ||  |       Corporation
+    `---' `--'   `--`--'`---'`--'`--' `---' `--' `---' `--''--'    www.tracktion.com
+
+    Tracktion Engine uses a GPL/commercial licence - see LICENCE.md for details.
+*/
+
+#pragma once
+
+#include <thread>
+
+#if JUCE_INTEL
+ #include <emmintrin.h>
+#endif
+
+#if JUCE_LINUX
+ #include <pthread.h>
+ #include <sched.h>
+ #include <unistd.h>
+ #include <sys/syscall.h>
+#endif
+
+namespace tracktion_graph
+{
+
+//==============================================================================
+/** Hints to the CPU that the calling thread is in a spin-wait loop.
+    This will use the pause instruction on x86, yield on ARM or simply yield the
+    thread on any other platform.
+*/
+inline void pause()
+{
+   #if JUCE_INTEL
+    _mm_pause();
+    _mm_pause();
+    _mm_pause();
+    _mm_pause();
+    _mm_pause();
+    _mm_pause();
+    _mm_pause();
+    _mm_pause();
+   #elif JUCE_ARM && (JUCE_GCC || JUCE_CLANG)
+    __asm__ __volatile__ ("yield");
+    __asm__ __volatile__ ("yield");
+    __asm__ __volatile__ ("yield");
+    __asm__ __volatile__ ("yield");
+   #elif JUCE_ARM && JUCE_MSVC
+    __yield();
+    __yield();
+    __yield();
+    __yield();
+   #else
+    std::this_thread::yield();
+   #endif
+}
+
+//==============================================================================
+/**
+    Describes which CPUs belong to which NUMA node, i.e. socket, so threads and their
+    memory can be kept together on machines with more than one.
+
+    Only Linux is supported at the moment, everywhere else this has a single node with
+    all the CPUs. Only the CPUs the process is allowed to run on are included, so it
+    respects any cpuset a container has been given.
+*/
+struct NumaTopology
+{
+    /** A NUMA node and the CPUs it contains. */
+    struct NumaNode
+    {
+        int osNodeID = 0;           /**< The ID the OS uses for this node. */
+        std::vector<int> cpus;
+    };
+
+    std::vector<NumaNode> nodes;
+
+    /** Returns the number of nodes, this is always at least 1. */
+    size_t getNumNodes() const noexcept     { return std::max ((size_t) 1, nodes.size()); }
+
+    /** Returns the topology of the machine. This is only detected once. */
+    static const NumaTopology& getSystemTopology()
+    {
+        static const NumaTopology topology (detect());
+        return topology;
+    }
+
+    /** Pins the calling thread to the CPUs of one of the nodes. Returns false if it couldn't. */
+    bool setCurrentThreadAffinity (size_t nodeIndex) const
+    {
+        if (nodeIndex >= nodes.size())
+            return false;
+
+       #if JUCE_LINUX
+        cpu_set_t set;
+        CPU_ZERO (&set);
+
+        for (auto cpu : nodes[nodeIndex].cpus)
+            CPU_SET (cpu, &set);
+
+        return pthread_setaffinity_np (pthread_self(), sizeof (set), &set) == 0;
+       #else
+        return false;
+       #endif
+    }
+
+    /** Asks the OS to keep some memory on one of the nodes, moving any pages that are
+        already somewhere else. The whole pages containing the range are moved, so it's
+        best used on page-aligned blocks. This does nothing on a machine with one node.
+    */
+    void moveMemoryToNode (const void* data, size_t numBytes, size_t nodeIndex) const
+    {
+        if (nodes.size() < 2 || nodeIndex >= nodes.size() || data == nullptr || numBytes == 0)
+            return;
+
+       #if JUCE_LINUX && defined (SYS_mbind)
+        constexpr int mpolPreferred = 1;        // From <numaif.h>, which needs libnuma
+        constexpr unsigned int mpolMfMove = 2;
+        const auto osNodeID = (size_t) nodes[nodeIndex].osNodeID;
+        constexpr size_t bitsPerWord = sizeof (unsigned long) * 8;
+
+        if (osNodeID >= 64 * bitsPerWord)
+            return;
+
+        unsigned long nodeMask[64] = {};
+        nodeMask[osNodeID / bitsPerWord] = 1ul << (osNodeID % bitsPerWord);
+
+        const auto pageSize = (uintptr_t) sysconf (_SC_PAGESIZE);
+        const auto start = (uintptr_t) data & ~(pageSize - 1);
+        const auto end = ((uintptr_t) data + numBytes + pageSize - 1) & ~(pageSize - 1);
+
+        // This is only a hint so it doesn't matter if it fails
+        syscall (SYS_mbind, start, end - start, mpolPreferred, nodeMask, 64 * bitsPerWord, mpolMfMove);
+       #endif
+    }
+
+private:
+    static NumaTopology detect()
+    {
+        NumaTopology topology;
+
+       #if JUCE_LINUX
+        cpu_set_t allowed;
+        CPU_ZERO (&allowed);
+        const bool knowsAllowed = sched_getaffinity (0, sizeof (allowed), &allowed) == 0;
+
+        for (auto& dir : juce::File ("/sys/devices/system/node").findChildFiles (juce::File::findDirectories, false, "node*"))
+        {
+            auto idString = dir.getFileName().fromFirstOccurrenceOf ("node", false, false);
+
+            if (idString.isEmpty() || ! idString.containsOnly ("0123456789"))
+                continue;
+
+            NumaNode node;
+            node.osNodeID = idString.getIntValue();
+
+            // The list is made of ranges, e.g. "0-15,32-47"
+            for (auto range : juce::StringArray::fromTokens (dir.getChildFile ("cpulist").loadFileAsString().trim(), ",", {}))
+            {
+                const auto first = range.upToFirstOccurrenceOf ("-", false, false).getIntValue();
+                const auto last = range.contains ("-") ? range.fromFirstOccurrenceOf ("-", false, false).getIntValue() : first;
+
+                for (int cpu = first; cpu <= last && cpu < CPU_SETSIZE; ++cpu)
+                    if (! knowsAllowed || CPU_ISSET (cpu, &allowed))
+                        node.cpus.push_back (cpu);
+            }
+
+            if (! node.cpus.empty())
+                topology.nodes.push_back (std::move (node));
+        }
+
+        std::sort (topology.nodes.begin(), topology.nodes.end(),
+                   [] (const NumaNode& a, const NumaNode& b) { return a.osNodeID < b.osNodeID; });
+       #endif
+
+        return topology;
+    }
+};
+
+} // namespace tracktion_graph